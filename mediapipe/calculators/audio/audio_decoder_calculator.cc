@@ -45,6 +45,11 @@ namespace mediapipe {
 //   }
 // }
 //
+// Setting target_sample_rate and target_num_channels in the audio_stream
+// options resamples and remixes the audio while decoding, which saves a
+// RationalFactorResampleCalculator and an
+// AverageTimeSeriesAcrossChannelsCalculator downstream.
+//
 // TODO: support decoding multiple streams.
 class AudioDecoderCalculator : public CalculatorBase {
  public:
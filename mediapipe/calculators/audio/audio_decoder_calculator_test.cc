@@ -12,9 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
+#include <string>
+#include <vector>
+
 #include "absl/flags/flag.h"
+#include "absl/strings/substitute.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/time_series_header.pb.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -27,6 +33,58 @@ namespace {
 
 constexpr char kTestPackageRoot[] = "mediapipe/calculators/audio";
 
+// The audio of a whole file, decoded by AudioDecoderCalculator.
+struct DecodedAudio {
+  TimeSeriesHeader header;
+  // All the samples, with a row per channel.
+  Matrix samples;
+  // The timestamp and the index of the first sample of each packet.
+  std::vector<Timestamp> packet_timestamps;
+  std::vector<int> packet_offsets;
+};
+
+// Decodes `file_name` from the test data with the given AudioStreamOptions
+// fields.
+void DecodeAudio(const std::string& file_name,
+                 const std::string& audio_stream_options,
+                 DecodedAudio* decoded) {
+  const std::string node_config = absl::Substitute(
+      R"pb(
+        calculator: "AudioDecoderCalculator"
+        input_side_packet: "INPUT_FILE_PATH:input_file_path"
+        output_stream: "AUDIO:audio"
+        output_stream: "AUDIO_HEADER:audio_header"
+        node_options {
+          [type.googleapis.com/mediapipe.AudioDecoderOptions]: {
+            audio_stream { stream_index: 0 $0 }
+          }
+        })pb",
+      audio_stream_options);
+  CalculatorRunner runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(node_config));
+  runner.MutableSidePackets()->Tag("INPUT_FILE_PATH") = MakePacket<std::string>(
+      file::JoinPath(GetTestDataDir(kTestPackageRoot), file_name));
+  MP_ASSERT_OK(runner.Run());
+  decoded->header =
+      runner.Outputs().Tag("AUDIO_HEADER").header.Get<TimeSeriesHeader>();
+
+  const auto& packets = runner.Outputs().Tag("AUDIO").packets;
+  int num_samples = 0;
+  for (const Packet& packet : packets) {
+    const Matrix& matrix = packet.Get<Matrix>();
+    ASSERT_EQ(matrix.rows(), decoded->header.num_channels());
+    decoded->packet_timestamps.push_back(packet.Timestamp());
+    decoded->packet_offsets.push_back(num_samples);
+    num_samples += matrix.cols();
+  }
+  decoded->samples.resize(decoded->header.num_channels(), num_samples);
+  for (int i = 0; i < packets.size(); ++i) {
+    const Matrix& matrix = packets[i].Get<Matrix>();
+    decoded->samples.middleCols(decoded->packet_offsets[i], matrix.cols()) =
+        matrix;
+  }
+}
+
 TEST(AudioDecoderCalculatorTest, TestWAV) {
   CalculatorGraphConfig::Node node_config =
       ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
@@ -147,5 +205,66 @@ TEST(AudioDecoderCalculatorTest, TestAAC) {
               std::ceil(44100.0 * 2 / 1024));
 }
 
+TEST(AudioDecoderCalculatorTest, MixesDownToAverageOfChannels) {
+  DecodedAudio stereo;
+  ASSERT_NO_FATAL_FAILURE(DecodeAudio(
+      "sine_wave_1k_48000_stereo_2_sec_wav.audio", "", &stereo));
+  ASSERT_EQ(2, stereo.header.num_channels());
+
+  DecodedAudio mono;
+  ASSERT_NO_FATAL_FAILURE(
+      DecodeAudio("sine_wave_1k_48000_stereo_2_sec_wav.audio",
+                  "target_num_channels: 1", &mono));
+  EXPECT_EQ(48000, mono.header.sample_rate());
+  EXPECT_EQ(1, mono.header.num_channels());
+
+  // Without resampling, the packets and their timestamps are unchanged.
+  EXPECT_EQ(mono.packet_timestamps, stereo.packet_timestamps);
+  EXPECT_EQ(mono.packet_offsets, stereo.packet_offsets);
+  ASSERT_EQ(mono.samples.cols(), stereo.samples.cols());
+  EXPECT_GT(stereo.samples.cwiseAbs().maxCoeff(), 0.1f);
+  const Matrix average = stereo.samples.colwise().mean();
+  EXPECT_TRUE(mono.samples.isApprox(average, 1e-6f));
+}
+
+TEST(AudioDecoderCalculatorTest, ResamplesToTargetRate) {
+  DecodedAudio original;
+  ASSERT_NO_FATAL_FAILURE(DecodeAudio(
+      "sine_wave_1k_44100_mono_2_sec_wav.audio", "", &original));
+  ASSERT_EQ(44100, original.header.sample_rate());
+
+  DecodedAudio resampled;
+  ASSERT_NO_FATAL_FAILURE(
+      DecodeAudio("sine_wave_1k_44100_mono_2_sec_wav.audio",
+                  "target_sample_rate: 22050", &resampled));
+  EXPECT_EQ(22050, resampled.header.sample_rate());
+  EXPECT_EQ(1, resampled.header.num_channels());
+
+  // The samples held back by the resampler are output on flush.
+  const int num_samples = resampled.samples.cols();
+  EXPECT_NEAR(num_samples, original.samples.cols() / 2, 32);
+
+  // Packet timestamps follow the number of samples output before them, up
+  // to the rounding of the resampler delay to an input sample.
+  ASSERT_FALSE(resampled.packet_timestamps.empty());
+  EXPECT_EQ(resampled.packet_timestamps[0], Timestamp(0));
+  for (int i = 0; i < resampled.packet_timestamps.size(); ++i) {
+    EXPECT_NEAR(resampled.packet_timestamps[i].Value(),
+                resampled.packet_offsets[i] * 1e6 / 22050, 50)
+        << "packet " << i;
+  }
+
+  // The 1 kHz tone is well below the new Nyquist frequency, so every other
+  // original sample is kept, away from the edges.
+  const float amplitude = original.samples.cwiseAbs().maxCoeff();
+  EXPECT_GT(amplitude, 0.1f);
+  const int margin = 22050 / 10;
+  for (int j = margin; j < num_samples - margin; ++j) {
+    ASSERT_NEAR(resampled.samples(0, j), original.samples(0, 2 * j),
+                0.02f * amplitude)
+        << "sample " << j;
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -19,6 +19,7 @@
 #include <memory>
 
 #include "Eigen/Core"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/time_series_util.h"
@@ -68,7 +69,16 @@ absl::Status BasicTimeSeriesCalculatorBase::Process(CalculatorContext* cc) {
   MP_RETURN_IF_ERROR(time_series_util::IsMatrixShapeConsistentWithHeader(
       input, cc->Inputs().Index(0).Header().Get<TimeSeriesHeader>()));
 
-  std::unique_ptr<Matrix> output(new Matrix(ProcessMatrix(input)));
+  std::unique_ptr<Matrix> output;
+  auto consumed = cc->Inputs().Index(0).Value().Consume<Matrix>();
+  if (consumed.ok()) {
+    output = std::move(consumed).value();
+    if (!ProcessMatrixInPlace(output.get())) {
+      output = absl::make_unique<Matrix>(ProcessMatrix(*output));
+    }
+  } else {
+    output = absl::make_unique<Matrix>(ProcessMatrix(input));
+  }
   MP_RETURN_IF_ERROR(time_series_util::IsMatrixShapeConsistentWithHeader(
       *output, cc->Outputs().Index(0).Header().Get<TimeSeriesHeader>()));
 
@@ -152,6 +162,11 @@ class ReverseChannelOrderCalculator : public BasicTimeSeriesCalculatorBase {
   Matrix ProcessMatrix(const Matrix& input_matrix) final {
     return input_matrix.colwise().reverse();
   }
+
+  bool ProcessMatrixInPlace(Matrix* matrix) final {
+    matrix->colwise().reverseInPlace();
+    return true;
+  }
 };
 REGISTER_CALCULATOR(ReverseChannelOrderCalculator);
 
@@ -203,6 +218,12 @@ class SubtractMeanCalculator : public BasicTimeSeriesCalculatorBase {
     Matrix mean = input_matrix.rowwise().mean();
     return input_matrix - mean.replicate(1, input_matrix.cols());
   }
+
+  bool ProcessMatrixInPlace(Matrix* matrix) final {
+    Eigen::VectorXf mean = matrix->rowwise().mean();
+    matrix->colwise() -= mean;
+    return true;
+  }
 };
 REGISTER_CALCULATOR(SubtractMeanCalculator);
 
@@ -217,6 +238,11 @@ class SubtractMeanAcrossChannelsCalculator
     auto mean = input_matrix.mean();
     return (input_matrix.array() - mean).matrix();
   }
+
+  bool ProcessMatrixInPlace(Matrix* matrix) final {
+    matrix->array() -= matrix->mean();
+    return true;
+  }
 };
 REGISTER_CALCULATOR(SubtractMeanAcrossChannelsCalculator);
 
@@ -247,6 +273,16 @@ class DivideByMeanAcrossChannelsCalculator
       return Matrix::Ones(input_matrix.rows(), input_matrix.cols());
     }
   }
+
+  bool ProcessMatrixInPlace(Matrix* matrix) final {
+    const float mean = matrix->mean();
+    if (mean != 0) {
+      *matrix /= mean;
+    } else {
+      matrix->setOnes();
+    }
+    return true;
+  }
 };
 REGISTER_CALCULATOR(DivideByMeanAcrossChannelsCalculator);
 
@@ -351,6 +387,15 @@ class L2NormalizeCalculator : public BasicTimeSeriesCalculatorBase {
     }
     return input_matrix / rms;
   }
+
+  bool ProcessMatrixInPlace(Matrix* matrix) final {
+    constexpr double kEpsilon = 1e-8;
+    double rms = std::sqrt(matrix->array().square().mean());
+    if (rms > kEpsilon) {
+      *matrix /= rms;
+    }
+    return true;
+  }
 };
 REGISTER_CALCULATOR(L2NormalizeCalculator);
 
@@ -368,6 +413,15 @@ class PeakNormalizeCalculator : public BasicTimeSeriesCalculatorBase {
     }
     return input_matrix / max_pcm;
   }
+
+  bool ProcessMatrixInPlace(Matrix* matrix) final {
+    constexpr double kEpsilon = 1e-8;
+    double max_pcm = matrix->cwiseAbs().maxCoeff();
+    if (max_pcm > kEpsilon) {
+      *matrix /= max_pcm;
+    }
+    return true;
+  }
 };
 REGISTER_CALCULATOR(PeakNormalizeCalculator);
 
@@ -379,6 +433,11 @@ class ElementwiseSquareCalculator : public BasicTimeSeriesCalculatorBase {
   Matrix ProcessMatrix(const Matrix& input_matrix) final {
     return input_matrix.array().square();
   }
+
+  bool ProcessMatrixInPlace(Matrix* matrix) final {
+    matrix->array() = matrix->array().square();
+    return true;
+  }
 };
 REGISTER_CALCULATOR(ElementwiseSquareCalculator);
 
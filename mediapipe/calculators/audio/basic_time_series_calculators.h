@@ -41,6 +41,12 @@ class BasicTimeSeriesCalculatorBase : public CalculatorBase {
 
   // Process() calls this method on each packet to compute the output matrix.
   virtual Matrix ProcessMatrix(const Matrix& input_matrix) = 0;
+
+  // When the input packet is not shared, Process() calls this method first to
+  // compute the output over the input matrix, avoiding an allocation.
+  // Subclasses whose output has the same shape as their input should override
+  // it. Returns false if the output must be computed with ProcessMatrix.
+  virtual bool ProcessMatrixInPlace(Matrix* matrix) { return false; }
 };
 
 }  // namespace mediapipe
@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "Eigen/Core"
+#include "absl/memory/memory.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/matrix.h"
@@ -25,6 +26,7 @@
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
 #include "mediapipe/util/time_series_test_util.h"
 
 namespace mediapipe {
@@ -451,6 +453,43 @@ TEST_F(ElementwiseSquareCalculatorTest, SinglePacket) {
   Test(input_header, {input}, output_header, {output});
 }
 
+TEST(ElementwiseSquareCalculatorInPlaceTest, ReusesUnsharedInputMatrix) {
+  CalculatorGraphConfig config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "input"
+    node {
+      calculator: "ElementwiseSquareCalculator"
+      input_stream: "input"
+      output_stream: "output"
+    }
+  )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  std::vector<Packet> outputs;
+  MP_ASSERT_OK(graph.ObserveOutputStream("output", [&](const Packet& packet) {
+    outputs.push_back(packet);
+    return absl::OkStatus();
+  }));
+  const TimeSeriesHeader header = ParseTextProtoOrDie<TimeSeriesHeader>(
+      "sample_rate: 8000.0  packet_rate: 5.0  num_channels: 2  num_samples: 3");
+  MP_ASSERT_OK(graph.StartRun(
+      {}, {{"input", Adopt(new TimeSeriesHeader(header))}}));
+
+  auto input = absl::make_unique<Matrix>(2, 3);
+  *input << 3, 5, 8, 4, 12, -15;
+  const float* input_data = input->data();
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input", Adopt(input.release()).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(outputs.size(), 1);
+  const Matrix& output = outputs[0].Get<Matrix>();
+  Matrix expected(2, 3);
+  expected << 9, 25, 64, 16, 144, 225;
+  EXPECT_EQ(output, expected);
+  EXPECT_EQ(output.data(), input_data);
+}
+
 class FirstHalfSlicerCalculatorTest : public BasicTimeSeriesCalculatorTestBase {
  protected:
   void SetUp() override { calculator_name_ = "FirstHalfSlicerCalculator"; }
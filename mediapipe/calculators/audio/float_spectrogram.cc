@@ -0,0 +1,217 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/audio/float_spectrogram.h"
+
+#include <complex>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "pffft.h"
+
+namespace mediapipe {
+namespace {
+
+// pffft requires real transforms of at least 32 points.
+constexpr int kMinFftLength = 32;
+
+int NextPowerOfTwo(int value) {
+  int result = 1;
+  while (result < value) result <<= 1;
+  return result;
+}
+
+// Returns the real FFT plan for `fft_length`. Plans are immutable once
+// created and pffft allows sharing them between threads, so every
+// spectrogram with the same FFT length uses the same plan. Audio graphs use
+// only a handful of lengths, so plans are never released.
+std::shared_ptr<PFFFT_Setup> GetFftSetup(int fft_length) {
+  static NoDestructor<absl::Mutex> mutex;
+  static NoDestructor<
+      absl::flat_hash_map<int, std::shared_ptr<PFFFT_Setup>>>
+      setups;
+  absl::MutexLock lock(mutex.get());
+  std::shared_ptr<PFFFT_Setup>& setup = (*setups)[fft_length];
+  if (setup == nullptr) {
+    PFFFT_Setup* new_setup = pffft_new_setup(fft_length, PFFFT_REAL);
+    if (new_setup != nullptr) setup.reset(new_setup, pffft_destroy_setup);
+  }
+  return setup;
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<FloatSpectrogram>> FloatSpectrogram::Create(
+    const std::vector<double>& window, int step_length, int num_channels) {
+  if (window.empty()) {
+    return absl::InvalidArgumentError("Window must not be empty.");
+  }
+  if (step_length <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Step length must be positive, got ", step_length, "."));
+  }
+  if (num_channels <= 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Number of channels must be positive, got ", num_channels, "."));
+  }
+  const int fft_length = NextPowerOfTwo(window.size());
+  if (fft_length < kMinFftLength) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "FFT length ", fft_length, " is below the minimum of ", kMinFftLength,
+        " supported by pffft; use a longer frame."));
+  }
+  std::shared_ptr<PFFFT_Setup> fft_setup = GetFftSetup(fft_length);
+  if (fft_setup == nullptr) {
+    return absl::InternalError(
+        absl::StrCat("Failed to create a pffft plan of length ", fft_length));
+  }
+  return std::unique_ptr<FloatSpectrogram>(new FloatSpectrogram(
+      std::vector<float>(window.begin(), window.end()), step_length,
+      num_channels, fft_length, std::move(fft_setup)));
+}
+
+FloatSpectrogram::FloatSpectrogram(std::vector<float> window, int step_length,
+                                   int num_channels, int fft_length,
+                                   std::shared_ptr<PFFFT_Setup> fft_setup)
+    : window_(std::move(window)),
+      step_length_(step_length),
+      num_channels_(num_channels),
+      fft_length_(fft_length),
+      fft_setup_(std::move(fft_setup)),
+      // The tail past the window is never written, so it stays zero.
+      fft_input_(fft_length, 0.0f),
+      fft_output_(fft_length),
+      fft_work_(fft_length) {}
+
+FloatSpectrogram::~FloatSpectrogram() = default;
+
+int FloatSpectrogram::AppendInput(const Matrix& input) {
+  const int num_input_samples = input.cols();
+  if (signal_.rows() < num_samples_ + num_input_samples) {
+    signal_.conservativeResize(num_samples_ + num_input_samples,
+                               num_channels_);
+  }
+  signal_.middleRows(num_samples_, num_input_samples) = input.transpose();
+  num_samples_ += num_input_samples;
+
+  const int window_length = window_.size();
+  if (num_samples_ - frame_start_ < window_length) return 0;
+  return (num_samples_ - frame_start_ - window_length) / step_length_ + 1;
+}
+
+void FloatSpectrogram::TransformFrame(int channel) {
+  const int window_length = window_.size();
+  const float* samples = signal_.col(channel).data() + frame_start_;
+  for (int i = 0; i < window_length; ++i) {
+    fft_input_[i] = samples[i] * window_[i];
+  }
+  pffft_transform_ordered(fft_setup_.get(), fft_input_.data(),
+                          fft_output_.data(), fft_work_.data(),
+                          PFFFT_FORWARD);
+}
+
+void FloatSpectrogram::DiscardConsumedSamples() {
+  if (frame_start_ >= num_samples_) {
+    // With a step longer than the window, the next frame can start past the
+    // samples seen so far.
+    frame_start_ -= num_samples_;
+    num_samples_ = 0;
+    return;
+  }
+  const int num_remaining = num_samples_ - frame_start_;
+  if (frame_start_ > 0) {
+    // The source and destination rows may overlap, so copy through a
+    // temporary.
+    signal_.topRows(num_remaining) =
+        signal_.middleRows(frame_start_, num_remaining).eval();
+  }
+  num_samples_ = num_remaining;
+  frame_start_ = 0;
+}
+
+int FloatSpectrogram::ComputeSquaredMagnitudeSpectrogram(
+    const Matrix& input, std::vector<Matrix>* output) {
+  const int num_frames = AppendInput(input);
+  const int num_bins = output_frequency_channels();
+  output->resize(num_channels_);
+  for (Matrix& channel_output : *output) {
+    if (channel_output.rows() != num_bins ||
+        channel_output.cols() != num_frames) {
+      channel_output.resize(num_bins, num_frames);
+    }
+  }
+  const int first_frame_start = frame_start_;
+  for (int channel = 0; channel < num_channels_; ++channel) {
+    Matrix& channel_output = (*output)[channel];
+    frame_start_ = first_frame_start;
+    for (int frame = 0; frame < num_frames; ++frame) {
+      TransformFrame(channel);
+      float* bins = channel_output.col(frame).data();
+      // pffft stores the real-valued DC and Nyquist bins in the first two
+      // entries, followed by interleaved real and imaginary parts.
+      bins[0] = fft_output_[0] * fft_output_[0];
+      bins[num_bins - 1] = fft_output_[1] * fft_output_[1];
+      for (int k = 1; k < num_bins - 1; ++k) {
+        const float re = fft_output_[2 * k];
+        const float im = fft_output_[2 * k + 1];
+        bins[k] = re * re + im * im;
+      }
+      frame_start_ += step_length_;
+    }
+  }
+  DiscardConsumedSamples();
+  return num_frames;
+}
+
+int FloatSpectrogram::ComputeComplexSpectrogram(
+    const Matrix& input, std::vector<Eigen::MatrixXcf>* output) {
+  const int num_frames = AppendInput(input);
+  const int num_bins = output_frequency_channels();
+  output->resize(num_channels_);
+  for (Eigen::MatrixXcf& channel_output : *output) {
+    if (channel_output.rows() != num_bins ||
+        channel_output.cols() != num_frames) {
+      channel_output.resize(num_bins, num_frames);
+    }
+  }
+  const int first_frame_start = frame_start_;
+  for (int channel = 0; channel < num_channels_; ++channel) {
+    Eigen::MatrixXcf& channel_output = (*output)[channel];
+    frame_start_ = first_frame_start;
+    for (int frame = 0; frame < num_frames; ++frame) {
+      TransformFrame(channel);
+      std::complex<float>* bins = channel_output.col(frame).data();
+      bins[0] = std::complex<float>(fft_output_[0], 0.0f);
+      bins[num_bins - 1] = std::complex<float>(fft_output_[1], 0.0f);
+      // pffft computes sum(x[n] * exp(-2i * pi * k * n / N)); negate the
+      // imaginary parts to match the audio_dsp convention.
+      for (int k = 1; k < num_bins - 1; ++k) {
+        bins[k] = std::complex<float>(fft_output_[2 * k],
+                                      -fft_output_[2 * k + 1]);
+      }
+      frame_start_ += step_length_;
+    }
+  }
+  DiscardConsumedSamples();
+  return num_frames;
+}
+
+}  // namespace mediapipe
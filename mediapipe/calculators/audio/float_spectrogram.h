@@ -0,0 +1,102 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_AUDIO_FLOAT_SPECTROGRAM_H_
+#define MEDIAPIPE_CALCULATORS_AUDIO_FLOAT_SPECTROGRAM_H_
+
+#include <memory>
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/formats/matrix.h"
+
+struct PFFFT_Setup;
+
+namespace mediapipe {
+
+// Computes the short-time Fourier transform of a multichannel signal that
+// arrives in chunks, in single precision. All channels are framed together,
+// and every frame is transformed with a pffft real FFT plan that is shared
+// by all instances with the same FFT length.
+//
+// Framing matches audio_dsp::Spectrogram: the first frame ends with the
+// window-length-th sample, and each later frame starts step_length samples
+// after the previous one. Frames are zero-padded to the FFT length, the
+// smallest power of two that holds the window.
+class FloatSpectrogram {
+ public:
+  // Fails if step_length is not positive or if the FFT length is below the
+  // minimum of 32 supported by pffft.
+  static absl::StatusOr<std::unique_ptr<FloatSpectrogram>> Create(
+      const std::vector<double>& window, int step_length, int num_channels);
+
+  ~FloatSpectrogram();
+
+  int fft_length() const { return fft_length_; }
+  // The number of frequency bins per frame, fft_length / 2 + 1.
+  int output_frequency_channels() const { return fft_length_ / 2 + 1; }
+
+  // Appends `input`, which has one row per channel, to the signal and
+  // computes the frames it completes. output->at(c) receives a matrix with
+  // one column of squared magnitudes per frame of channel c. Matrices already
+  // in `output` are only reallocated if their size changes. Returns the
+  // number of frames.
+  int ComputeSquaredMagnitudeSpectrogram(const Matrix& input,
+                                         std::vector<Matrix>* output);
+
+  // Like above, but outputs the complex spectrum. As in
+  // audio_dsp::Spectrogram, the imaginary parts have the sign of
+  // sum(x[n] * sin(2 * pi * k * n / fft_length)).
+  int ComputeComplexSpectrogram(const Matrix& input,
+                                std::vector<Eigen::MatrixXcf>* output);
+
+ private:
+  FloatSpectrogram(std::vector<float> window, int step_length,
+                   int num_channels, int fft_length,
+                   std::shared_ptr<PFFFT_Setup> fft_setup);
+
+  // Appends `input` to signal_ and returns the number of frames that are
+  // complete.
+  int AppendInput(const Matrix& input);
+  // Transforms the next frame of `channel`, starting at frame_start_.
+  // Leaves the result in fft_output_, in pffft's ordered layout.
+  void TransformFrame(int channel);
+  // Drops the samples that no future frame needs.
+  void DiscardConsumedSamples();
+
+  using AlignedVector = std::vector<float, Eigen::aligned_allocator<float>>;
+
+  const std::vector<float> window_;
+  const int step_length_;
+  const int num_channels_;
+  const int fft_length_;
+  const std::shared_ptr<PFFFT_Setup> fft_setup_;
+
+  // Buffered signal, one column per channel, so that every channel's frames
+  // are contiguous. Rows [0, num_samples_) are valid.
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>
+      signal_;
+  int num_samples_ = 0;
+  // Start of the next frame in signal_.
+  int frame_start_ = 0;
+
+  AlignedVector fft_input_;
+  AlignedVector fft_output_;
+  AlignedVector fft_work_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_AUDIO_FLOAT_SPECTROGRAM_H_
@@ -19,10 +19,16 @@
 // commonly used as acoustic features in speech and other audio tasks.
 // Both calculators expect as input the SQUARED_MAGNITUDE-domain outputs
 // from the MediaPipe SpectrogramCalculator object.
+//
+// The audio_dsp objects are only used to derive the filterbank weights; the
+// transforms themselves are applied to whole packets with float Eigen
+// operations.
+#include <cmath>
 #include <memory>
 #include <vector>
 
 #include "Eigen/Core"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
@@ -54,6 +60,74 @@ std::string PortableDebugString(const TimeSeriesHeader& header) {
                           header.packet_rate(), header.audio_sample_rate());
 }
 
+// The mel filterbank of audio_dsp::MelFilterbank as a banded float matrix.
+// MelFilterbank::Compute() sums the square roots of the spectrogram bins with
+// triangular weights, so that each mel channel only depends on a contiguous
+// range of bins. Each channel is stored as that range and its weights, and
+// applied to all the frames of a packet at once.
+class BandedMelFilterbank {
+ public:
+  // Derives the weights from an initialized `filterbank` by computing the
+  // mel spectrum of each unit spectrogram frame.
+  void Initialize(const audio_dsp::MelFilterbank& filterbank,
+                  int input_length, int num_channels) {
+    Eigen::MatrixXd weights(num_channels, input_length);
+    std::vector<double> unit(input_length, 0.0);
+    std::vector<double> channels;
+    for (int bin = 0; bin < input_length; ++bin) {
+      unit[bin] = 1.0;
+      filterbank.Compute(unit, &channels);
+      unit[bin] = 0.0;
+      CHECK_EQ(channels.size(), num_channels);
+      weights.col(bin) =
+          Eigen::Map<const Eigen::VectorXd>(channels.data(), num_channels);
+    }
+    bands_.clear();
+    bands_.reserve(num_channels);
+    for (int channel = 0; channel < num_channels; ++channel) {
+      int first_bin = 0;
+      while (first_bin < input_length && weights(channel, first_bin) == 0) {
+        ++first_bin;
+      }
+      int end_bin = input_length;
+      while (end_bin > first_bin && weights(channel, end_bin - 1) == 0) {
+        --end_bin;
+      }
+      bands_.push_back(
+          {first_bin, weights.row(channel)
+                          .segment(first_bin, end_bin - first_bin)
+                          .cast<float>()});
+    }
+  }
+
+  int num_channels() const { return bands_.size(); }
+
+  // Computes the mel spectrum of each column of `squared_magnitudes`.
+  void Compute(const Matrix& squared_magnitudes, Matrix* output) const {
+    // Rows are transposed so that each band multiplies contiguous memory.
+    const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        magnitudes = squared_magnitudes.cwiseSqrt();
+    output->resize(bands_.size(), squared_magnitudes.cols());
+    for (int channel = 0; channel < bands_.size(); ++channel) {
+      const Band& band = bands_[channel];
+      if (band.weights.size() == 0) {
+        output->row(channel).setZero();
+        continue;
+      }
+      output->row(channel).noalias() =
+          band.weights *
+          magnitudes.middleRows(band.first_bin, band.weights.size());
+    }
+  }
+
+ private:
+  struct Band {
+    int first_bin;
+    Eigen::RowVectorXf weights;
+  };
+  std::vector<Band> bands_;
+};
+
 }  // namespace
 
 // Abstract base class for Calculators that transform feature vectors on a
@@ -93,10 +167,9 @@ class FramewiseTransformCalculatorBase : public CalculatorBase {
   virtual absl::Status ConfigureTransform(const TimeSeriesHeader& header,
                                           CalculatorContext* cc) = 0;
 
-  // Takes a vector<double> corresponding to an input frame, and
-  // perform the specific transformation to produce an output frame.
-  virtual void TransformFrame(const std::vector<double>& input,
-                              std::vector<double>* output) const = 0;
+  // Takes a matrix of input frames, one per column, and performs the
+  // specific transformation on each of them to produce the output frames.
+  virtual void TransformFrames(const Matrix& input, Matrix* output) const = 0;
 
  private:
   int num_output_channels_;
@@ -120,29 +193,10 @@ absl::Status FramewiseTransformCalculatorBase::Open(CalculatorContext* cc) {
 
 absl::Status FramewiseTransformCalculatorBase::Process(CalculatorContext* cc) {
   const Matrix& input = cc->Inputs().Index(0).Get<Matrix>();
-  const int num_frames = input.cols();
-  std::unique_ptr<Matrix> output(new Matrix(num_output_channels_, num_frames));
-  // The main work here is converting each column of the float Matrix
-  // into a vector of doubles, which is what our target functions from
-  // dsp_core consume, and doing the reverse with their output.
-  std::vector<double> input_frame(input.rows());
-  std::vector<double> output_frame(num_output_channels_);
-
-  for (int frame = 0; frame < num_frames; ++frame) {
-    // Copy input from Eigen::Matrix column to vector<float>.
-    Eigen::Map<Eigen::MatrixXd> input_frame_map(&input_frame[0],
-                                                input_frame.size(), 1);
-    input_frame_map = input.col(frame).cast<double>();
-
-    // Perform the actual transformation.
-    TransformFrame(input_frame, &output_frame);
-
-    // Copy output from vector<float> to Eigen::Vector.
-    CHECK_EQ(output_frame.size(), num_output_channels_);
-    Eigen::Map<const Eigen::MatrixXd> output_frame_map(&output_frame[0],
-                                                       output_frame.size(), 1);
-    output->col(frame) = output_frame_map.cast<float>();
-  }
+  auto output = absl::make_unique<Matrix>();
+  TransformFrames(input, output.get());
+  CHECK_EQ(output->rows(), num_output_channels_);
+  CHECK_EQ(output->cols(), input.cols());
   cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
 
   return absl::OkStatus();
@@ -178,16 +232,16 @@ class MfccCalculator : public FramewiseTransformCalculatorBase {
   absl::Status ConfigureTransform(const TimeSeriesHeader& header,
                                   CalculatorContext* cc) override {
     MfccCalculatorOptions mfcc_options = cc->Options<MfccCalculatorOptions>();
-    mfcc_.reset(new audio_dsp::Mfcc());
+    audio_dsp::Mfcc mfcc;
     int input_length = header.num_channels();
     // Set up the parameters to the Mfcc object.
     set_num_output_channels(mfcc_options.mfcc_count());
-    mfcc_->set_dct_coefficient_count(num_output_channels());
-    mfcc_->set_upper_frequency_limit(
+    mfcc.set_dct_coefficient_count(num_output_channels());
+    mfcc.set_upper_frequency_limit(
         mfcc_options.mel_spectrum_params().max_frequency_hertz());
-    mfcc_->set_lower_frequency_limit(
+    mfcc.set_lower_frequency_limit(
         mfcc_options.mel_spectrum_params().min_frequency_hertz());
-    mfcc_->set_filterbank_channel_count(
+    mfcc.set_filterbank_channel_count(
         mfcc_options.mel_spectrum_params().channel_count());
     // An upstream calculator (such as SpectrogramCalculator) must store
     // the sample rate of its input audio waveform in the TimeSeries Header.
@@ -200,23 +254,52 @@ class MfccCalculator : public FramewiseTransformCalculatorBase {
     }
     // Now we can initialize the Mfcc object.
     bool initialized =
-        mfcc_->Initialize(input_length, header.audio_sample_rate());
+        mfcc.Initialize(input_length, header.audio_sample_rate());
 
-    if (initialized) {
-      return absl::OkStatus();
-    } else {
+    if (!initialized) {
       return absl::Status(absl::StatusCode::kInternal,
                           "Mfcc::Initialize returned uninitialized");
     }
+
+    // Mfcc validates the options but does not expose its filterbank, so an
+    // identical one is built to derive the mel weights.
+    const int channel_count =
+        mfcc_options.mel_spectrum_params().channel_count();
+    audio_dsp::MelFilterbank mel_filterbank;
+    if (!mel_filterbank.Initialize(
+            input_length, header.audio_sample_rate(), channel_count,
+            mfcc_options.mel_spectrum_params().min_frequency_hertz(),
+            mfcc_options.mel_spectrum_params().max_frequency_hertz())) {
+      return absl::Status(absl::StatusCode::kInternal,
+                          "MelFilterbank::Initialize returned uninitialized");
+    }
+    mel_filterbank_.Initialize(mel_filterbank, input_length, channel_count);
+
+    // The DCT-II of audio_dsp::MfccDct, which Mfcc applies to the log mel
+    // spectrum.
+    dct_.resize(num_output_channels(), channel_count);
+    const double norm = std::sqrt(2.0 / channel_count);
+    const double arg = std::atan(1) * 4 / channel_count;
+    for (int i = 0; i < dct_.rows(); ++i) {
+      for (int j = 0; j < channel_count; ++j) {
+        dct_(i, j) = norm * std::cos(i * arg * (j + 0.5));
+      }
+    }
+    return absl::OkStatus();
   }
 
-  void TransformFrame(const std::vector<double>& input,
-                      std::vector<double>* output) const override {
-    mfcc_->Compute(input, output);
+  void TransformFrames(const Matrix& input, Matrix* output) const override {
+    // Same floor as audio_dsp::Mfcc.
+    constexpr float kFilterbankFloor = 1e-12;
+    Matrix mel;
+    mel_filterbank_.Compute(input, &mel);
+    mel = mel.array().max(kFilterbankFloor).log();
+    output->noalias() = dct_ * mel;
   }
 
  private:
-  std::unique_ptr<audio_dsp::Mfcc> mfcc_;
+  BandedMelFilterbank mel_filterbank_;
+  Matrix dct_;
 };
 REGISTER_CALCULATOR(MfccCalculator);
 
@@ -254,21 +337,22 @@ class MelSpectrumCalculator : public FramewiseTransformCalculatorBase {
         mel_spectrum_options.min_frequency_hertz(),
         mel_spectrum_options.max_frequency_hertz());
 
-    if (initialized) {
-      return absl::OkStatus();
-    } else {
+    if (!initialized) {
       return absl::Status(absl::StatusCode::kInternal,
                           "mfcc::Initialize returned uninitialized");
     }
+    banded_mel_filterbank_.Initialize(*mel_filterbank_, input_length,
+                                      num_output_channels());
+    return absl::OkStatus();
   }
 
-  void TransformFrame(const std::vector<double>& input,
-                      std::vector<double>* output) const override {
-    mel_filterbank_->Compute(input, output);
+  void TransformFrames(const Matrix& input, Matrix* output) const override {
+    banded_mel_filterbank_.Compute(input, output);
   }
 
  private:
   std::unique_ptr<audio_dsp::MelFilterbank> mel_filterbank_;
+  BandedMelFilterbank banded_mel_filterbank_;
 };
 REGISTER_CALCULATOR(MelSpectrumCalculator);
 
@@ -0,0 +1,271 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/audio/polyphase_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+
+namespace mediapipe {
+namespace {
+
+// Upsample factor, downsample factor, radius and cutoff in input samples,
+// and Kaiser beta.
+using FilterBankKey = std::tuple<int, int, double, double, double>;
+
+// Approximates `value` by the continued fraction convergent with the largest
+// denominator not exceeding `max_denominator`.
+void RationalApproximation(double value, int max_denominator, int* numerator,
+                           int* denominator) {
+  int64_t h_prev = 0, h = 1;
+  int64_t k_prev = 1, k = 0;
+  double remainder = value;
+  for (int i = 0; i < 64; ++i) {
+    const int64_t term = static_cast<int64_t>(std::floor(remainder));
+    const int64_t h_next = term * h + h_prev;
+    const int64_t k_next = term * k + k_prev;
+    if (k_next > max_denominator) break;
+    h_prev = h;
+    h = h_next;
+    k_prev = k;
+    k = k_next;
+    const double fraction = remainder - term;
+    if (fraction < 1e-9) break;
+    remainder = 1.0 / fraction;
+  }
+  *numerator = h;
+  *denominator = k;
+}
+
+// Zeroth-order modified Bessel function of the first kind.
+double BesselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  const double quarter_x_squared = 0.25 * x * x;
+  for (int k = 1; k < 100 && term > 1e-12 * sum; ++k) {
+    term *= quarter_x_squared / (k * k);
+    sum += term;
+  }
+  return sum;
+}
+
+// Lowpass kernel with `cutoff` in cycles per input sample, evaluated at `x`
+// input samples from its center.
+double Kernel(double x, double radius, double cutoff, double kaiser_beta) {
+  const double normalized = x / radius;
+  if (std::abs(normalized) >= 1.0) return 0.0;
+  const double window =
+      BesselI0(kaiser_beta * std::sqrt(1.0 - normalized * normalized)) /
+      BesselI0(kaiser_beta);
+  const double arg = 2.0 * cutoff * x;
+  const double sinc =
+      arg == 0.0 ? 1.0 : std::sin(M_PI * arg) / (M_PI * arg);
+  return 2.0 * cutoff * sinc * window;
+}
+
+std::shared_ptr<const PolyphaseFilterBank> DesignFilterBank(
+    const FilterBankKey& key) {
+  const auto [upsample_factor, downsample_factor, radius, cutoff,
+              kaiser_beta] = key;
+  auto bank = std::make_shared<PolyphaseFilterBank>();
+  bank->upsample_factor = upsample_factor;
+  bank->downsample_factor = downsample_factor;
+  bank->radius_samples = static_cast<int>(std::ceil(radius));
+  const int num_taps = 2 * bank->radius_samples;
+  bank->coefficients.resize(num_taps, upsample_factor);
+  for (int phase = 0; phase < upsample_factor; ++phase) {
+    const double offset = static_cast<double>(phase) / upsample_factor;
+    for (int tap = 0; tap < num_taps; ++tap) {
+      const int input_offset = tap - bank->radius_samples + 1;
+      bank->coefficients(tap, phase) =
+          Kernel(input_offset - offset, radius, cutoff, kaiser_beta);
+    }
+  }
+  return bank;
+}
+
+}  // namespace
+
+// static
+absl::StatusOr<std::shared_ptr<const PolyphaseFilterBank>>
+PolyphaseResampler::GetFilterBank(double input_sample_rate,
+                                  double output_sample_rate,
+                                  const audio_dsp::QResamplerParams& params) {
+  if (!(input_sample_rate > 0.0) || !(output_sample_rate > 0.0)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Sample rates must be positive, got ", input_sample_rate,
+                     " and ", output_sample_rate, "."));
+  }
+  if (!(params.filter_radius_factor > 0.0) ||
+      !(params.cutoff_proportion > 0.0) || params.max_denominator < 1) {
+    return absl::InvalidArgumentError("Invalid resampler parameters.");
+  }
+  int upsample_factor;
+  int downsample_factor;
+  RationalApproximation(output_sample_rate / input_sample_rate,
+                        params.max_denominator, &upsample_factor,
+                        &downsample_factor);
+  if (upsample_factor < 1 || downsample_factor < 1) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Cannot resample from ", input_sample_rate, " to ", output_sample_rate,
+        " Hz with a denominator of at most ", params.max_denominator, "."));
+  }
+  const double factor = static_cast<double>(upsample_factor) /
+                        static_cast<double>(downsample_factor);
+  const FilterBankKey key(
+      upsample_factor, downsample_factor,
+      params.filter_radius_factor * std::max(1.0, 1.0 / factor),
+      0.5 * params.cutoff_proportion * std::min(1.0, factor),
+      params.kaiser_beta);
+
+  static NoDestructor<absl::Mutex> mutex;
+  static NoDestructor<absl::flat_hash_map<
+      FilterBankKey, std::weak_ptr<const PolyphaseFilterBank>>>
+      filter_banks;
+  absl::MutexLock lock(mutex.get());
+  std::weak_ptr<const PolyphaseFilterBank>& cached = (*filter_banks)[key];
+  std::shared_ptr<const PolyphaseFilterBank> bank = cached.lock();
+  if (bank == nullptr) {
+    bank = DesignFilterBank(key);
+    cached = bank;
+  }
+  return bank;
+}
+
+// static
+absl::StatusOr<std::unique_ptr<PolyphaseResampler>> PolyphaseResampler::Create(
+    double input_sample_rate, double output_sample_rate, int num_channels,
+    const audio_dsp::QResamplerParams& params) {
+  if (num_channels <= 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Number of channels must be positive, got ", num_channels, "."));
+  }
+  auto filter_bank =
+      GetFilterBank(input_sample_rate, output_sample_rate, params);
+  if (!filter_bank.ok()) return filter_bank.status();
+  return std::unique_ptr<PolyphaseResampler>(
+      new PolyphaseResampler(*std::move(filter_bank), num_channels));
+}
+
+PolyphaseResampler::PolyphaseResampler(
+    std::shared_ptr<const PolyphaseFilterBank> filter_bank, int num_channels)
+    : filter_bank_(std::move(filter_bank)), num_channels_(num_channels) {
+  Reset();
+}
+
+void PolyphaseResampler::Reset() {
+  // The signal is zero before the first input sample.
+  const int radius = filter_bank_->radius_samples;
+  num_buffered_ = 0;
+  Append(nullptr, radius - 1);
+  next_column_ = radius - 1;
+  next_phase_ = 0;
+  num_input_samples_ = 0;
+  num_output_samples_ = 0;
+}
+
+void PolyphaseResampler::Append(const Matrix* input, int num_samples) {
+  const int required_columns = num_buffered_ + num_samples;
+  if (buffer_.cols() < required_columns) {
+    buffer_.conservativeResize(
+        num_channels_, std::max<Eigen::Index>(required_columns,
+                                              2 * buffer_.cols()));
+  }
+  if (input != nullptr) {
+    buffer_.middleCols(num_buffered_, num_samples) = *input;
+  } else {
+    buffer_.middleCols(num_buffered_, num_samples).setZero();
+  }
+  num_buffered_ = required_columns;
+}
+
+void PolyphaseResampler::ComputeOutput(int64_t max_outputs, Matrix* output) {
+  const PolyphaseFilterBank& bank = *filter_bank_;
+  const int radius = bank.radius_samples;
+  const int column_step = bank.downsample_factor / bank.upsample_factor;
+  const int phase_step = bank.downsample_factor % bank.upsample_factor;
+
+  // Count the complete output samples first so that they can be written
+  // directly into `output`.
+  int num_outputs = 0;
+  for (int column = next_column_, phase = next_phase_;
+       num_outputs < max_outputs && column + radius < num_buffered_;
+       ++num_outputs) {
+    column += column_step;
+    phase += phase_step;
+    if (phase >= bank.upsample_factor) {
+      phase -= bank.upsample_factor;
+      ++column;
+    }
+  }
+
+  output->resize(num_channels_, num_outputs);
+  for (int i = 0; i < num_outputs; ++i) {
+    output->col(i).noalias() =
+        buffer_.middleCols(next_column_ - radius + 1, 2 * radius) *
+        bank.coefficients.col(next_phase_);
+    next_column_ += column_step;
+    next_phase_ += phase_step;
+    if (next_phase_ >= bank.upsample_factor) {
+      next_phase_ -= bank.upsample_factor;
+      ++next_column_;
+    }
+  }
+  num_output_samples_ += num_outputs;
+
+  // Drop the samples that no later output sample needs.
+  const int num_consumed =
+      std::min(next_column_ - radius + 1, num_buffered_);
+  if (num_consumed > 0) {
+    const int num_remaining = num_buffered_ - num_consumed;
+    // The source and destination columns may overlap, so copy through a
+    // temporary.
+    buffer_.leftCols(num_remaining) =
+        buffer_.middleCols(num_consumed, num_remaining).eval();
+    num_buffered_ = num_remaining;
+    next_column_ -= num_consumed;
+  }
+}
+
+void PolyphaseResampler::ProcessSamples(const Matrix& input, Matrix* output) {
+  Append(&input, input.cols());
+  num_input_samples_ += input.cols();
+  ComputeOutput(std::numeric_limits<int64_t>::max(), output);
+}
+
+void PolyphaseResampler::Flush(Matrix* output) {
+  const PolyphaseFilterBank& bank = *filter_bank_;
+  // Output samples are due up to the time of the last input sample.
+  const int64_t total_outputs =
+      (num_input_samples_ * bank.upsample_factor + bank.downsample_factor -
+       1) /
+      bank.downsample_factor;
+  Append(nullptr, bank.radius_samples);
+  ComputeOutput(total_outputs - num_output_samples_, output);
+  Reset();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,104 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_AUDIO_POLYPHASE_RESAMPLER_H_
+#define MEDIAPIPE_CALCULATORS_AUDIO_POLYPHASE_RESAMPLER_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/status/statusor.h"
+#include "audio/dsp/resampler_q.h"
+#include "mediapipe/framework/formats/matrix.h"
+
+namespace mediapipe {
+
+// Kaiser-windowed sinc filters for every phase of a rational resampling
+// factor. Banks are immutable and shared by all resamplers with the same
+// rates and parameters.
+struct PolyphaseFilterBank {
+  // The resampling factor is upsample_factor / downsample_factor: output
+  // sample n is interpolated at input time n * downsample_factor /
+  // upsample_factor.
+  int upsample_factor;
+  int downsample_factor;
+  // Output samples depend on input samples within radius_samples of their
+  // time, so each phase has 2 * radius_samples taps.
+  int radius_samples;
+  // Column p holds the taps of phase p, for input offsets
+  // 1 - radius_samples, ..., radius_samples.
+  Matrix coefficients;
+};
+
+// Resamples a multichannel signal by a rational factor with a polyphase FIR
+// filter, processing all channels of a Matrix at once: each output column is
+// the product of a block of input columns with the taps of one phase.
+//
+// Filters are designed from the same parameters as audio_dsp::QResampler,
+// but the two implementations do not produce identical output.
+class PolyphaseResampler {
+ public:
+  static absl::StatusOr<std::unique_ptr<PolyphaseResampler>> Create(
+      double input_sample_rate, double output_sample_rate, int num_channels,
+      const audio_dsp::QResamplerParams& params);
+
+  // Returns the filter bank for the given rates, designing it if no live
+  // resampler uses it yet.
+  static absl::StatusOr<std::shared_ptr<const PolyphaseFilterBank>>
+  GetFilterBank(double input_sample_rate, double output_sample_rate,
+                const audio_dsp::QResamplerParams& params);
+
+  // Resamples `input`, which has one row per channel, and replaces `output`
+  // with the output samples that are complete.
+  void ProcessSamples(const Matrix& input, Matrix* output);
+
+  // Outputs the remaining samples, treating the signal as zero after the
+  // input so far, and resets the resampler.
+  void Flush(Matrix* output);
+
+  // Clears the signal history.
+  void Reset();
+
+  const PolyphaseFilterBank& filter_bank() const { return *filter_bank_; }
+
+ private:
+  PolyphaseResampler(std::shared_ptr<const PolyphaseFilterBank> filter_bank,
+                     int num_channels);
+
+  // Appends `num_samples` columns to buffer_, from `input` or zeros if it is
+  // null.
+  void Append(const Matrix* input, int num_samples);
+  // Computes up to `max_outputs` output samples from buffer_ into `output`.
+  void ComputeOutput(int64_t max_outputs, Matrix* output);
+
+  const std::shared_ptr<const PolyphaseFilterBank> filter_bank_;
+  const int num_channels_;
+
+  // Buffered input, one column per sample. Columns [0, num_buffered_) are
+  // valid.
+  Matrix buffer_;
+  int num_buffered_;
+  // Column of buffer_ at or before the time of the next output sample, and
+  // the phase of that sample between this column and the next one.
+  int next_column_;
+  int next_phase_;
+  // Totals since the last reset, used by Flush to stop at the end of the
+  // signal.
+  int64_t num_input_samples_;
+  int64_t num_output_samples_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_AUDIO_POLYPHASE_RESAMPLER_H_
@@ -0,0 +1,115 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/audio/polyphase_resampler.h"
+
+#include <math.h>
+
+#include <memory>
+#include <vector>
+
+#include "Eigen/Core"
+#include "audio/dsp/resampler_q.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Resamples `input` in packets of the given sizes, and returns the
+// concatenated output including the flushed samples.
+Matrix ResampleInPackets(PolyphaseResampler* resampler, const Matrix& input,
+                         const std::vector<int>& packet_sizes) {
+  Matrix result(input.rows(), 0);
+  Matrix output;
+  int start = 0;
+  auto append_output = [&result, &output]() {
+    result.conservativeResize(result.rows(), result.cols() + output.cols());
+    result.rightCols(output.cols()) = output;
+  };
+  for (int size : packet_sizes) {
+    resampler->ProcessSamples(input.middleCols(start, size), &output);
+    append_output();
+    start += size;
+  }
+  resampler->Flush(&output);
+  append_output();
+  return result;
+}
+
+TEST(PolyphaseResamplerTest, ResamplesSinusoidAndConstant) {
+  constexpr double kInputRate = 48000.0;
+  constexpr double kOutputRate = 16000.0;
+  constexpr double kFrequency = 1000.0;
+  constexpr int kNumSamples = 4800;
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto resampler,
+      PolyphaseResampler::Create(kInputRate, kOutputRate, /*num_channels=*/2,
+                                 audio_dsp::QResamplerParams()));
+  EXPECT_EQ(resampler->filter_bank().upsample_factor, 1);
+  EXPECT_EQ(resampler->filter_bank().downsample_factor, 3);
+
+  Matrix input(2, kNumSamples);
+  for (int i = 0; i < kNumSamples; ++i) {
+    input(0, i) = sin(2 * M_PI * kFrequency * i / kInputRate);
+    input(1, i) = 1.0f;
+  }
+  const Matrix output =
+      ResampleInPackets(resampler.get(), input, {7, 1000, 1, 3792});
+  ASSERT_EQ(output.cols(), kNumSamples / 3);
+  // Away from the ends, the output matches the signal at the output rate.
+  for (int i = 50; i < output.cols() - 50; ++i) {
+    EXPECT_NEAR(output(0, i), sin(2 * M_PI * kFrequency * i / kOutputRate),
+                1e-2)
+        << " where i=" << i;
+    EXPECT_NEAR(output(1, i), 1.0f, 1e-2) << " where i=" << i;
+  }
+}
+
+TEST(PolyphaseResamplerTest, PacketSizesDoNotChangeOutput) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto resampler,
+      PolyphaseResampler::Create(4000.0, 4000.0 * 1.9, /*num_channels=*/3,
+                                 audio_dsp::QResamplerParams()));
+  const Matrix input = Matrix::Random(3, 500);
+  const Matrix expected = ResampleInPackets(resampler.get(), input, {500});
+  // Flush resets the resampler, so it can be reused.
+  const Matrix actual =
+      ResampleInPackets(resampler.get(), input, {1, 49, 0, 300, 150});
+  ASSERT_EQ(expected.cols(), actual.cols());
+  EXPECT_EQ(expected.cols(), 950);
+  EXPECT_TRUE(expected.isApprox(actual));
+}
+
+TEST(PolyphaseResamplerTest, SharesFilterBanks) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto first, PolyphaseResampler::Create(44100.0, 16000.0, 1,
+                                             audio_dsp::QResamplerParams()));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto second, PolyphaseResampler::Create(44100.0, 16000.0, 2,
+                                              audio_dsp::QResamplerParams()));
+  EXPECT_EQ(&first->filter_bank(), &second->filter_bank());
+  EXPECT_EQ(first->filter_bank().upsample_factor, 160);
+  EXPECT_EQ(first->filter_bank().downsample_factor, 441);
+}
+
+TEST(PolyphaseResamplerTest, FailsOnInvalidRates) {
+  EXPECT_FALSE(PolyphaseResampler::Create(-1.0, 16000.0, 1,
+                                          audio_dsp::QResamplerParams())
+                   .ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -17,6 +17,7 @@
 #include "mediapipe/calculators/audio/rational_factor_resample_calculator.h"
 
 #include "audio/dsp/resampler_q.h"
+#include "mediapipe/framework/port/status_macros.h"
 
 using audio_dsp::Resampler;
 
@@ -71,7 +72,19 @@ absl::Status RationalFactorResampleCalculator::Open(CalculatorContext* cc) {
   num_channels_ = input_header.num_channels();
 
   // Don't create resamplers for pass-thru (sample rates are equal).
-  if (source_sample_rate_ != target_sample_rate_) {
+  resampler_.clear();
+  polyphase_resampler_.reset();
+  if (source_sample_rate_ != target_sample_rate_ &&
+      resample_options.backend() ==
+          RationalFactorResampleCalculatorOptions::POLYPHASE) {
+    ASSIGN_OR_RETURN(polyphase_resampler_,
+                     PolyphaseResampler::Create(
+                         source_sample_rate_, target_sample_rate_,
+                         num_channels_,
+                         ResamplerParamsFromOptions(source_sample_rate_,
+                                                    target_sample_rate_,
+                                                    resample_options)));
+  } else if (source_sample_rate_ != target_sample_rate_) {
     resampler_.resize(num_channels_);
     for (auto& r : resampler_) {
       r = ResamplerFromOptions(source_sample_rate_, target_sample_rate_,
@@ -116,7 +129,15 @@ absl::Status RationalFactorResampleCalculator::ProcessInternal(
 
   cumulative_input_samples_ += input_frame.cols();
   std::unique_ptr<Matrix> output_frame(new Matrix(num_channels_, 0));
-  if (resampler_.empty()) {
+  if (polyphase_resampler_) {
+    RET_CHECK_EQ(input_frame.rows(), num_channels_)
+        << "Inconsistent number of input channels.";
+    if (should_flush) {
+      polyphase_resampler_->Flush(output_frame.get());
+    } else {
+      polyphase_resampler_->ProcessSamples(input_frame, output_frame.get());
+    }
+  } else if (resampler_.empty()) {
     // Sample rates were same for input and output; pass-thru.
     *output_frame = input_frame;
   } else {
@@ -150,11 +171,10 @@ bool RationalFactorResampleCalculator::Resample(const Matrix& input_frame,
 }
 
 // static
-std::unique_ptr<Resampler<float>>
-RationalFactorResampleCalculator::ResamplerFromOptions(
+audio_dsp::QResamplerParams
+RationalFactorResampleCalculator::ResamplerParamsFromOptions(
     const double source_sample_rate, const double target_sample_rate,
     const RationalFactorResampleCalculatorOptions& options) {
-  std::unique_ptr<Resampler<float>> resampler;
   const auto& rational_factor_options =
       options.resampler_rational_factor_options();
   audio_dsp::QResamplerParams params;
@@ -174,6 +194,17 @@ RationalFactorResampleCalculator::ResamplerFromOptions(
   // rates (e.g. 8kHz, 16kHz, 22.05kHz, 32kHz, 44.1kHz, 48kHz) is exact, and
   // that any factor is represented with error less than 0.025%.
   params.max_denominator = 2000;
+  return params;
+}
+
+// static
+std::unique_ptr<Resampler<float>>
+RationalFactorResampleCalculator::ResamplerFromOptions(
+    const double source_sample_rate, const double target_sample_rate,
+    const RationalFactorResampleCalculatorOptions& options) {
+  std::unique_ptr<Resampler<float>> resampler;
+  const audio_dsp::QResamplerParams params = ResamplerParamsFromOptions(
+      source_sample_rate, target_sample_rate, options);
 
   // NOTE: QResampler supports multichannel resampling, so the code might be
   // simplified using a single instance rather than one per channel.
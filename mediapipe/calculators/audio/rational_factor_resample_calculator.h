@@ -22,6 +22,8 @@
 #include "Eigen/Core"
 #include "absl/strings/str_cat.h"
 #include "audio/dsp/resampler.h"
+#include "audio/dsp/resampler_q.h"
+#include "mediapipe/calculators/audio/polyphase_resampler.h"
 #include "mediapipe/calculators/audio/rational_factor_resample_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
@@ -65,6 +67,12 @@ class RationalFactorResampleCalculator : public CalculatorBase {
  protected:
   typedef audio_dsp::Resampler<float> ResamplerType;
 
+  // Returns the QResampler parameters specified by the
+  // RationalFactorResampleCalculatorOptions proto.
+  static audio_dsp::QResamplerParams ResamplerParamsFromOptions(
+      const double source_sample_rate, const double target_sample_rate,
+      const RationalFactorResampleCalculatorOptions& options);
+
   // Returns a Resampler<float> implementation specified by the
   // RationalFactorResampleCalculatorOptions proto. Returns null if the options
   // specify an invalid resampler.
@@ -92,6 +100,8 @@ class RationalFactorResampleCalculator : public CalculatorBase {
   bool check_inconsistent_timestamps_;
   int num_channels_;
   std::vector<std::unique_ptr<ResamplerType>> resampler_;
+  // Used instead of resampler_ for the POLYPHASE backend.
+  std::unique_ptr<PolyphaseResampler> polyphase_resampler_;
 };
 
 // Test-only access to RationalFactorResampleCalculator methods.
@@ -102,6 +112,17 @@ struct RationalFactorResampleCalculator::TestAccess {
     return RationalFactorResampleCalculator::ResamplerFromOptions(
         source_sample_rate, target_sample_rate, options);
   }
+
+  static absl::StatusOr<std::unique_ptr<PolyphaseResampler>>
+  PolyphaseResamplerFromOptions(
+      const double source_sample_rate, const double target_sample_rate,
+      const int num_channels,
+      const RationalFactorResampleCalculatorOptions& options) {
+    return PolyphaseResampler::Create(
+        source_sample_rate, target_sample_rate, num_channels,
+        RationalFactorResampleCalculator::ResamplerParamsFromOptions(
+            source_sample_rate, target_sample_rate, options));
+  }
 };
 
 }  // namespace mediapipe
@@ -142,6 +142,11 @@ class RationalFactorResampleCalculatorTest
   // packet-by-packet) are consistent with resampling the entire
   // signal at once.
   void CheckOutputValues(double output_sample_rate) {
+    if (options_.backend() ==
+        RationalFactorResampleCalculatorOptions::POLYPHASE) {
+      CheckPolyphaseOutputValues(output_sample_rate);
+      return;
+    }
     for (int i = 0; i < num_input_channels_; ++i) {
       auto verification_resampler =
           RationalFactorResampleCalculator::TestAccess::ResamplerFromOptions(
@@ -169,6 +174,41 @@ class RationalFactorResampleCalculatorTest
     }
   }
 
+  // Like CheckOutputValues, for the POLYPHASE backend.
+  void CheckPolyphaseOutputValues(double output_sample_rate) {
+    MP_ASSERT_OK_AND_ASSIGN(
+        auto verification_resampler,
+        RationalFactorResampleCalculator::TestAccess::
+            PolyphaseResamplerFromOptions(input_sample_rate_,
+                                          output_sample_rate,
+                                          num_input_channels_, options_));
+    Matrix expected_resampled_data;
+    Matrix flushed;
+    verification_resampler->ProcessSamples(concatenated_input_samples_,
+                                           &expected_resampled_data);
+    verification_resampler->Flush(&flushed);
+    const int num_processed = expected_resampled_data.cols();
+    expected_resampled_data.conservativeResize(
+        num_input_channels_, num_processed + flushed.cols());
+    expected_resampled_data.rightCols(flushed.cols()) = flushed;
+
+    int num_output_samples = 0;
+    for (const Packet& packet : output().packets) {
+      const Matrix& output_frame = packet.Get<Matrix>();
+      ASSERT_LE(num_output_samples + output_frame.cols(),
+                expected_resampled_data.cols());
+      for (int i = 0; i < output_frame.cols(); ++i) {
+        for (int c = 0; c < num_input_channels_; ++c) {
+          EXPECT_FLOAT_EQ(expected_resampled_data(c, num_output_samples + i),
+                          output_frame(c, i))
+              << " where c=" << c << ", i=" << num_output_samples + i << ".";
+        }
+      }
+      num_output_samples += output_frame.cols();
+    }
+    EXPECT_EQ(num_output_samples, expected_resampled_data.cols());
+  }
+
   void CheckOutputHeaders(double output_sample_rate) {
     const TimeSeriesHeader& output_header =
         output().header.Get<TimeSeriesHeader>();
@@ -224,6 +264,27 @@ TEST_F(RationalFactorResampleCalculatorTest, UsesRationalFactorResampler) {
   CheckOutput(kUpsampleRate);
 }
 
+TEST_F(RationalFactorResampleCalculatorTest, PolyphaseUpsample) {
+  options_.set_backend(RationalFactorResampleCalculatorOptions::POLYPHASE);
+  const double kUpsampleRate = input_sample_rate_ * 1.9;
+  MP_ASSERT_OK(Run(kUpsampleRate));
+  CheckOutput(kUpsampleRate);
+}
+
+TEST_F(RationalFactorResampleCalculatorTest, PolyphaseDownsample) {
+  options_.set_backend(RationalFactorResampleCalculatorOptions::POLYPHASE);
+  const double kDownsampleRate = input_sample_rate_ / 3;
+  MP_ASSERT_OK(Run(kDownsampleRate));
+  CheckOutput(kDownsampleRate);
+}
+
+TEST_F(RationalFactorResampleCalculatorTest,
+       PolyphasePassthroughIfSampleRateUnchanged) {
+  options_.set_backend(RationalFactorResampleCalculatorOptions::POLYPHASE);
+  MP_ASSERT_OK(Run(input_sample_rate_));
+  CheckOutputUnchanged();
+}
+
 TEST_F(RationalFactorResampleCalculatorTest, PassthroughIfSampleRateUnchanged) {
   const double kUpsampleRate = input_sample_rate_;
   MP_ASSERT_OK(Run(kUpsampleRate));
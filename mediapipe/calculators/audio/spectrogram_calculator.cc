@@ -19,15 +19,19 @@
 #include <deque>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "audio/dsp/spectrogram/spectrogram.h"
 #include "audio/dsp/window_functions.h"
+#include "mediapipe/calculators/audio/float_spectrogram.h"
 #include "mediapipe/calculators/audio/spectrogram_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/util/time_series_util.h"
 
 namespace mediapipe {
@@ -172,6 +176,19 @@ class SpectrogramCalculator : public CalculatorBase {
       const OutputMatrixType postprocess_output_fn(const OutputMatrixType&),
       CalculatorContext* cc);
 
+  // Processes the input with float_spectrogram_, which writes every
+  // channel's frames directly into the output matrices.
+  absl::Status ProcessVectorWithFloatSpectrogram(const Matrix& input_stream,
+                                                 CalculatorContext* cc);
+
+  // Emits the spectrogram of one input packet, consisting of num_frames
+  // frames in each of the channel matrices, and advances the output
+  // timestamp.
+  template <class OutputMatrixType>
+  void OutputSpectrogram(
+      std::unique_ptr<std::vector<OutputMatrixType>> spectrogram_matrices,
+      int num_frames, CalculatorContext* cc);
+
   // Use the MediaPipe timestamp instead of the estimated one. Useful when the
   // data is intermittent.
   bool use_local_timestamp_;
@@ -198,6 +215,8 @@ class SpectrogramCalculator : public CalculatorBase {
   bool allow_multichannel_input_;
   // Vector of Spectrogram objects, one for each channel.
   std::vector<std::unique_ptr<audio_dsp::Spectrogram>> spectrogram_generators_;
+  // Used instead of spectrogram_generators_ for the PFFFT backend.
+  std::unique_ptr<FloatSpectrogram> float_spectrogram_;
   // Fixed scale factor applied to output values (regardless of type).
   double output_scale_;
 
@@ -284,14 +303,22 @@ absl::Status SpectrogramCalculator::Open(CalculatorContext* cc) {
 
   // Propagate settings down to the actual Spectrogram object.
   spectrogram_generators_.clear();
-  for (int i = 0; i < num_input_channels_; i++) {
-    spectrogram_generators_.push_back(
-        std::unique_ptr<audio_dsp::Spectrogram>(new audio_dsp::Spectrogram()));
-    spectrogram_generators_[i]->Initialize(window, frame_step_samples());
-  }
+  float_spectrogram_.reset();
+  if (spectrogram_options.backend() == SpectrogramCalculatorOptions::PFFFT) {
+    ASSIGN_OR_RETURN(float_spectrogram_,
+                     FloatSpectrogram::Create(window, frame_step_samples(),
+                                              num_input_channels_));
+    num_output_channels_ = float_spectrogram_->output_frequency_channels();
+  } else {
+    for (int i = 0; i < num_input_channels_; i++) {
+      spectrogram_generators_.push_back(std::unique_ptr<audio_dsp::Spectrogram>(
+          new audio_dsp::Spectrogram()));
+      spectrogram_generators_[i]->Initialize(window, frame_step_samples());
+    }
 
-  num_output_channels_ =
-      spectrogram_generators_[0]->output_frequency_channels();
+    num_output_channels_ =
+        spectrogram_generators_[0]->output_frequency_channels();
+  }
   std::unique_ptr<TimeSeriesHeader> output_header(
       new TimeSeriesHeader(input_header));
   // Store the actual sample rate of the input audio in the TimeSeriesHeader
@@ -403,28 +430,85 @@ absl::Status SpectrogramCalculator::ProcessVectorToOutput(
   if (!spectrogram_matrices->empty()) {
     RET_CHECK_EQ(spectrogram_matrices->size(), input_stream.rows())
         << "Inconsistent number of spectrogram channels.";
-    if (allow_multichannel_input_) {
-      cc->Outputs().Index(0).Add(spectrogram_matrices.release(),
-                                 CurrentOutputTimestamp(cc));
-    } else {
-      cc->Outputs().Index(0).Add(
-          new OutputMatrixType(spectrogram_matrices->at(0)),
-          CurrentOutputTimestamp(cc));
+    OutputSpectrogram(std::move(spectrogram_matrices), output_vectors.size(),
+                      cc);
+  }
+  return absl::OkStatus();
+}
+
+template <class OutputMatrixType>
+void SpectrogramCalculator::OutputSpectrogram(
+    std::unique_ptr<std::vector<OutputMatrixType>> spectrogram_matrices,
+    int num_frames, CalculatorContext* cc) {
+  if (allow_multichannel_input_) {
+    cc->Outputs().Index(0).Add(spectrogram_matrices.release(),
+                               CurrentOutputTimestamp(cc));
+  } else {
+    cc->Outputs().Index(0).Add(
+        new OutputMatrixType(std::move(spectrogram_matrices->at(0))),
+        CurrentOutputTimestamp(cc));
+  }
+  cumulative_completed_frames_ += num_frames;
+  last_completed_frames_ = num_frames;
+  if (!use_local_timestamp_) {
+    // In non-local timestamp mode the timestamp of the next packet will be
+    // equal to CumulativeOutputTimestamp(). Inform the framework about this
+    // fact to enable packet queueing optimizations.
+    cc->Outputs().Index(0).SetNextTimestampBound(CumulativeOutputTimestamp());
+  }
+}
+
+absl::Status SpectrogramCalculator::ProcessVectorWithFloatSpectrogram(
+    const Matrix& input_stream, CalculatorContext* cc) {
+  RET_CHECK_EQ(input_stream.rows(), num_input_channels_)
+      << "Inconsistent number of input channels.";
+  if (output_type_ == SpectrogramCalculatorOptions::COMPLEX) {
+    auto spectrogram_matrices =
+        std::make_unique<std::vector<Eigen::MatrixXcf>>();
+    const int num_frames = float_spectrogram_->ComputeComplexSpectrogram(
+        input_stream, spectrogram_matrices.get());
+    if (num_frames > 0) {
+      if (output_scale_ != 1.0) {
+        for (Eigen::MatrixXcf& frames : *spectrogram_matrices) {
+          frames *= static_cast<float>(output_scale_);
+        }
+      }
+      OutputSpectrogram(std::move(spectrogram_matrices), num_frames, cc);
     }
-    cumulative_completed_frames_ += output_vectors.size();
-    last_completed_frames_ = output_vectors.size();
-    if (!use_local_timestamp_) {
-      // In non-local timestamp mode the timestamp of the next packet will be
-      // equal to CumulativeOutputTimestamp(). Inform the framework about this
-      // fact to enable packet queueing optimizations.
-      cc->Outputs().Index(0).SetNextTimestampBound(CumulativeOutputTimestamp());
+    return absl::OkStatus();
+  }
+
+  auto spectrogram_matrices = std::make_unique<std::vector<Matrix>>();
+  const int num_frames = float_spectrogram_->ComputeSquaredMagnitudeSpectrogram(
+      input_stream, spectrogram_matrices.get());
+  if (num_frames == 0) return absl::OkStatus();
+  // The frames hold squared magnitudes; translate them in place.
+  const float scale = output_scale_;
+  for (Matrix& frames : *spectrogram_matrices) {
+    switch (output_type_) {
+      case SpectrogramCalculatorOptions::SQUARED_MAGNITUDE:
+        if (scale != 1.0f) frames *= scale;
+        break;
+      case SpectrogramCalculatorOptions::LINEAR_MAGNITUDE:
+        frames = scale * frames.array().sqrt();
+        break;
+      case SpectrogramCalculatorOptions::DECIBELS:
+        frames = (scale * kLnSquaredMagnitudeToDb) * frames.array().log();
+        break;
+      default:
+        return absl::Status(absl::StatusCode::kInvalidArgument,
+                            "Unrecognized spectrogram output type.");
     }
   }
+  OutputSpectrogram(std::move(spectrogram_matrices), num_frames, cc);
   return absl::OkStatus();
 }
 
 absl::Status SpectrogramCalculator::ProcessVector(const Matrix& input_stream,
                                                   CalculatorContext* cc) {
+  if (float_spectrogram_) {
+    return ProcessVectorWithFloatSpectrogram(input_stream, cc);
+  }
   switch (output_type_) {
     // These blocks deliberately ignore clang-format to preserve the
     // "silhouette" of the different cases.
@@ -14,6 +14,7 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <cmath>
 #include <complex>
 #include <memory>
@@ -164,7 +165,46 @@ class SpectrogramCalculatorTest
     }
   }
 
-  // Return vector of the numbers of frames in each output packet.
+  // Runs the graph on multichannel input using `backend`, and returns the
+  // output packets.
+  std::vector<Packet> RunWithBackend(
+      SpectrogramCalculatorOptions::Backend backend,
+      const std::vector<int>& packet_sizes_samples) {
+    options_.set_backend(backend);
+    InitializeGraph();
+    FillInputHeader();
+    SetupMultichannelInputPackets(packet_sizes_samples, 440.0);
+    MP_EXPECT_OK(Run());
+    return output().packets;
+  }
+
+  // Expects the spectrograms computed by both backends to agree to within a
+  // small fraction of the largest value.
+  template <class OutputMatrixType>
+  void ExpectBackendsMatch(const std::vector<int>& packet_sizes_samples) {
+    const std::vector<Packet> audio_dsp_packets = RunWithBackend(
+        SpectrogramCalculatorOptions::AUDIO_DSP, packet_sizes_samples);
+    const std::vector<Packet> pffft_packets = RunWithBackend(
+        SpectrogramCalculatorOptions::PFFFT, packet_sizes_samples);
+    ASSERT_EQ(audio_dsp_packets.size(), pffft_packets.size());
+    for (int i = 0; i < audio_dsp_packets.size(); ++i) {
+      EXPECT_EQ(audio_dsp_packets[i].Timestamp(), pffft_packets[i].Timestamp());
+      const auto& expected =
+          audio_dsp_packets[i].Get<std::vector<OutputMatrixType>>();
+      const auto& actual = pffft_packets[i].Get<std::vector<OutputMatrixType>>();
+      ASSERT_EQ(expected.size(), actual.size());
+      for (int channel = 0; channel < expected.size(); ++channel) {
+        ASSERT_EQ(expected[channel].rows(), actual[channel].rows());
+        ASSERT_EQ(expected[channel].cols(), actual[channel].cols());
+        const float tolerance =
+            1e-5 * std::max(1.0f, expected[channel].cwiseAbs().maxCoeff());
+        EXPECT_LE((expected[channel] - actual[channel]).cwiseAbs().maxCoeff(),
+                  tolerance)
+            << "packet " << i << ", channel " << channel;
+      }
+    }
+  }
+
   std::vector<int> OutputFramesPerPacket() {
     std::vector<int> frame_counts;
     for (const Packet& packet : output().packets) {
@@ -846,6 +886,38 @@ TEST_F(SpectrogramCalculatorTest,
   }
 }
 
+TEST_F(SpectrogramCalculatorTest, PffftMatchesAudioDspSquaredMagnitude) {
+  options_.set_frame_duration_seconds(100.0 / input_sample_rate_);
+  options_.set_frame_overlap_seconds(60.0 / input_sample_rate_);
+  options_.set_pad_final_packet(true);
+  options_.set_allow_multichannel_input(true);
+  num_input_channels_ = 4;
+  // Packets that end both mid-frame and between frames.
+  ExpectBackendsMatch<Matrix>({50, 230, 180, 10});
+}
+
+TEST_F(SpectrogramCalculatorTest, PffftMatchesAudioDspComplex) {
+  options_.set_frame_duration_seconds(100.0 / input_sample_rate_);
+  options_.set_frame_overlap_seconds(60.0 / input_sample_rate_);
+  options_.set_pad_final_packet(true);
+  options_.set_allow_multichannel_input(true);
+  options_.set_output_type(SpectrogramCalculatorOptions::COMPLEX);
+  options_.set_output_scale(0.5);
+  num_input_channels_ = 3;
+  ExpectBackendsMatch<Eigen::MatrixXcf>({50, 230, 180, 10});
+}
+
+TEST_F(SpectrogramCalculatorTest, PffftRejectsShortFrames) {
+  // A 20-sample frame needs a 32-point FFT at least.
+  options_.set_frame_duration_seconds(20.0 / input_sample_rate_);
+  options_.set_frame_overlap_seconds(0.0);
+  options_.set_backend(SpectrogramCalculatorOptions::PFFFT);
+  InitializeGraph();
+  FillInputHeader();
+  SetupConstantInputPackets({100});
+  EXPECT_FALSE(Run().ok());
+}
+
 void BM_ProcessDC(benchmark::State& state) {
   CalculatorGraphConfig::Node node_config;
   node_config.set_calculator("SpectrogramCalculator");
@@ -18,6 +18,7 @@
 #include <memory>
 #include <string>
 
+#include "absl/memory/memory.h"
 #include "mediapipe/calculators/audio/stabilized_log_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
@@ -74,7 +75,7 @@ class StabilizedLogCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    auto input_matrix = cc->Inputs().Index(0).Get<Matrix>();
+    const Matrix& input_matrix = cc->Inputs().Index(0).Get<Matrix>();
     if (input_matrix.array().isNaN().any()) {
       return absl::InvalidArgumentError("NaN input to log operation.");
     }
@@ -83,8 +84,17 @@ class StabilizedLogCalculator : public CalculatorBase {
         return absl::OutOfRangeError("Negative input to log operation.");
       }
     }
-    std::unique_ptr<Matrix> output_frame(new Matrix(
-        output_scale_ * (input_matrix.array() + stabilizer_).log().matrix()));
+    // Reuses the input matrix for the output when no one else holds it.
+    std::unique_ptr<Matrix> output_frame;
+    auto consumed = cc->Inputs().Index(0).Value().Consume<Matrix>();
+    if (consumed.ok()) {
+      output_frame = std::move(consumed).value();
+      output_frame->array() =
+          output_scale_ * (output_frame->array() + stabilizer_).log();
+    } else {
+      output_frame = absl::make_unique<Matrix>(
+          output_scale_ * (input_matrix.array() + stabilizer_).log().matrix());
+    }
     cc->Outputs().Index(0).Add(output_frame.release(), cc->InputTimestamp());
     return absl::OkStatus();
   }
@@ -15,6 +15,7 @@
 // Defines TimeSeriesFramerCalculator.
 #include <math.h>
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <string>
@@ -92,6 +93,10 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
   void EnqueueInput(CalculatorContext* cc);
   // Constructs and emits framed output packets.
   void FrameOutput(CalculatorContext* cc);
+  // Removes the oldest num_samples samples from the internal buffer.
+  void DropSamples(int num_samples);
+  // Returns the timestamp of the buffered sample at `offset`.
+  Timestamp BufferedSampleTimestamp(int offset) const;
 
   Timestamp CurrentOutputTimestamp() {
     if (use_local_timestamp_) {
@@ -109,7 +114,7 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
   // Returns the timestamp of a sample on a base, which is usually the time
   // stamp of a packet.
   Timestamp CurrentSampleTimestamp(const Timestamp& timestamp_base,
-                                   int64 number_of_samples) {
+                                   int64 number_of_samples) const {
     return timestamp_base + round(number_of_samples / sample_rate_ *
                                   Timestamp::kTimestampUnitsPerSecond);
   }
@@ -144,9 +149,16 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
   Timestamp current_timestamp_;
   int num_channels_;
 
-  // Each entry in this deque consists of a single sample, i.e. a
-  // single column vector, and its timestamp.
-  std::deque<std::pair<Matrix, Timestamp>> sample_buffer_;
+  // The buffered input samples, one column per sample.
+  time_series_util::TimeSeriesRingBuffer sample_buffer_;
+  // Holds frames that wrap around the end of sample_buffer_.
+  Matrix frame_scratch_;
+  // The timestamp and index of the first sample of each input packet that
+  // still has samples in sample_buffer_. Sample indices count all samples
+  // received.
+  std::deque<std::pair<Timestamp, int64>> input_packet_starts_;
+  // Index of the oldest sample in sample_buffer_.
+  int64 buffer_start_sample_;
 
   bool use_window_;
   Matrix window_;
@@ -157,42 +169,57 @@ REGISTER_CALCULATOR(TimeSeriesFramerCalculator);
 
 void TimeSeriesFramerCalculator::EnqueueInput(CalculatorContext* cc) {
   const Matrix& input_frame = cc->Inputs().Index(0).Get<Matrix>();
+  if (input_frame.cols() == 0) return;
+  input_packet_starts_.emplace_back(
+      cc->InputTimestamp(), buffer_start_sample_ + sample_buffer_.size());
+  sample_buffer_.Push(input_frame);
+}
 
-  for (int i = 0; i < input_frame.cols(); ++i) {
-    sample_buffer_.emplace_back(std::make_pair(
-        input_frame.col(i), CurrentSampleTimestamp(cc->InputTimestamp(), i)));
+void TimeSeriesFramerCalculator::DropSamples(int num_samples) {
+  sample_buffer_.Pop(num_samples);
+  buffer_start_sample_ += num_samples;
+  while (input_packet_starts_.size() > 1 &&
+         input_packet_starts_[1].second <= buffer_start_sample_) {
+    input_packet_starts_.pop_front();
   }
 }
 
+Timestamp TimeSeriesFramerCalculator::BufferedSampleTimestamp(
+    int offset) const {
+  const int64 sample = buffer_start_sample_ + offset;
+  // The sample is usually in one of the most recent packets.
+  for (auto it = input_packet_starts_.rbegin();
+       it != input_packet_starts_.rend(); ++it) {
+    if (it->second <= sample) {
+      return CurrentSampleTimestamp(it->first, sample - it->second);
+    }
+  }
+  LOG(DFATAL) << "Sample " << sample << " is not buffered.";
+  return Timestamp::Unset();
+}
+
 void TimeSeriesFramerCalculator::FrameOutput(CalculatorContext* cc) {
   while (sample_buffer_.size() >=
          frame_duration_samples_ + samples_still_to_drop_) {
-    while (samples_still_to_drop_ > 0) {
-      sample_buffer_.pop_front();
-      --samples_still_to_drop_;
-    }
+    DropSamples(samples_still_to_drop_);
+    samples_still_to_drop_ = 0;
     const int frame_step_samples = next_frame_step_samples();
+    const Eigen::Map<const Matrix> frame =
+        sample_buffer_.GetFrame(0, frame_duration_samples_, &frame_scratch_);
     std::unique_ptr<Matrix> output_frame(
         new Matrix(num_channels_, frame_duration_samples_));
-    for (int i = 0; i < std::min(frame_step_samples, frame_duration_samples_);
-         ++i) {
-      output_frame->col(i) = sample_buffer_.front().first;
-      current_timestamp_ = sample_buffer_.front().second;
-      sample_buffer_.pop_front();
-    }
-    const int frame_overlap_samples =
-        frame_duration_samples_ - frame_step_samples;
-    if (frame_overlap_samples > 0) {
-      for (int i = 0; i < frame_overlap_samples; ++i) {
-        output_frame->col(i + frame_step_samples) = sample_buffer_[i].first;
-        current_timestamp_ = sample_buffer_[i].second;
-      }
+    // Apply the window while copying the frame out of the buffer.
+    if (use_window_) {
+      output_frame->array() = frame.array() * window_.array();
     } else {
-      samples_still_to_drop_ = -frame_overlap_samples;
+      *output_frame = frame;
     }
-
-    if (use_window_) {
-      *output_frame = (output_frame->array() * window_.array()).matrix();
+    current_timestamp_ = BufferedSampleTimestamp(frame_duration_samples_ - 1);
+    if (frame_step_samples > frame_duration_samples_) {
+      DropSamples(frame_duration_samples_);
+      samples_still_to_drop_ = frame_step_samples - frame_duration_samples_;
+    } else {
+      DropSamples(frame_step_samples);
     }
 
     cc->Outputs().Index(0).Add(output_frame.release(),
@@ -221,17 +248,17 @@ absl::Status TimeSeriesFramerCalculator::Process(CalculatorContext* cc) {
 }
 
 absl::Status TimeSeriesFramerCalculator::Close(CalculatorContext* cc) {
-  while (samples_still_to_drop_ > 0 && !sample_buffer_.empty()) {
-    sample_buffer_.pop_front();
-    --samples_still_to_drop_;
-  }
+  const int num_dropped =
+      std::min(samples_still_to_drop_, sample_buffer_.size());
+  DropSamples(num_dropped);
+  samples_still_to_drop_ -= num_dropped;
   if (!sample_buffer_.empty() && pad_final_packet_) {
     std::unique_ptr<Matrix> output_frame(new Matrix);
     output_frame->setZero(num_channels_, frame_duration_samples_);
-    for (int i = 0; i < sample_buffer_.size(); ++i) {
-      output_frame->col(i) = sample_buffer_[i].first;
-      current_timestamp_ = sample_buffer_[i].second;
-    }
+    const int num_samples = sample_buffer_.size();
+    output_frame->leftCols(num_samples) =
+        sample_buffer_.GetFrame(0, num_samples, &frame_scratch_);
+    current_timestamp_ = BufferedSampleTimestamp(num_samples - 1);
 
     cc->Outputs().Index(0).Add(output_frame.release(),
                                CurrentOutputTimestamp());
@@ -291,6 +318,9 @@ absl::Status TimeSeriesFramerCalculator::Open(CalculatorContext* cc) {
   cumulative_completed_samples_ = 0;
   cumulative_output_frames_ = 0;
   samples_still_to_drop_ = 0;
+  sample_buffer_.Reset(num_channels_);
+  input_packet_starts_.clear();
+  buffer_start_sample_ = 0;
   initial_input_timestamp_ = Timestamp::Unstarted();
   current_timestamp_ = Timestamp::Unstarted();
 
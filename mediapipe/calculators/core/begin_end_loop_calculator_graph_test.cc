@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/calculators/core/begin_loop_calculator.h"
 #include "mediapipe/calculators/core/end_loop_calculator.h"
 #include "mediapipe/framework/calculator_contract.h"
@@ -26,6 +29,7 @@
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"  // NOLINT
+#include "mediapipe/framework/subgraph.h"
 
 namespace mediapipe {
 namespace {
@@ -444,5 +448,96 @@ TEST_F(BeginEndLoopCalculatorGraphWithClonedInputsTest, MultipleVectors) {
                   PacketOfIntsEq(input_timestamp2, std::vector<int>{6, 9})));
 }
 
+// Increments its input after a delay that decreases with the input, so that
+// concurrent invocations finish in reverse order.
+class SlowIncrementCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    const int& input_int = cc->Inputs().Index(0).Get<int>();
+    absl::SleepFor(absl::Milliseconds(10 * std::max(0, 4 - input_int)));
+    auto output_int = absl::make_unique<int>(input_int + 1);
+    cc->Outputs().Index(0).Add(output_int.release(), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+};
+
+REGISTER_CALCULATOR(SlowIncrementCalculator);
+
+class SlowIncrementSubgraph : public Subgraph {
+ public:
+  absl::StatusOr<CalculatorGraphConfig> GetConfig(
+      const SubgraphOptions& options) override {
+    return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+      input_stream: "in"
+      output_stream: "out"
+      node {
+        calculator: "SlowIncrementCalculator"
+        input_stream: "in"
+        output_stream: "out"
+      }
+    )pb");
+  }
+};
+
+REGISTER_MEDIAPIPE_GRAPH(SlowIncrementSubgraph);
+
+// The iterations of a loop body subgraph with max_in_flight run concurrently,
+// and are still collected in order.
+TEST(BeginEndLoopCalculatorParallelGraphTest, CollectsIterationsInOrder) {
+  auto graph_config = ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        num_threads: 4
+        input_stream: "ints"
+        node {
+          calculator: "BeginLoopIntegerCalculator"
+          input_stream: "ITERABLE:ints"
+          output_stream: "ITEM:int"
+          output_stream: "BATCH_END:timestamp"
+        }
+        node {
+          calculator: "SlowIncrementSubgraph"
+          input_stream: "int"
+          output_stream: "int_plus_one"
+          max_in_flight: 4
+        }
+        node {
+          calculator: "EndLoopIntegersCalculator"
+          input_stream: "ITEM:int_plus_one"
+          input_stream: "BATCH_END:timestamp"
+          output_stream: "ITERABLE:ints_plus_one"
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("ints_plus_one", &graph_config, &output_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "ints", MakePacket<std::vector<int>>(std::vector<int>{0, 1, 2, 3, i})
+                    .At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  EXPECT_THAT(
+      output_packets,
+      testing::ElementsAre(
+          PacketOfIntsEq(Timestamp(0), std::vector<int>{1, 2, 3, 4, 1}),
+          PacketOfIntsEq(Timestamp(1), std::vector<int>{1, 2, 3, 4, 2}),
+          PacketOfIntsEq(Timestamp(2), std::vector<int>{1, 2, 3, 4, 3})));
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -52,6 +52,13 @@ namespace mediapipe {
 //   output_stream: "OUTPUT:aggregated_result"     # IterableU @ext_ts
 // }
 //
+// All the elements are emitted at once, so the loop body can process them in
+// parallel: if its nodes, or the subgraph node wrapping it, set max_in_flight
+// greater than 1, up to that many iterations run concurrently. Their outputs
+// are still propagated in timestamp order, so the EndLoopCalculator collects
+// them in the order of the collection. Only stateless nodes can run in
+// parallel.
+//
 // Input streams tagged with "CLONE" are cloned to the corresponding output
 // streams at loop timestamps. This ensures that a MediaPipe graph or sub-graph
 // can run multiple times, once per element in the "ITERABLE" for each pakcet
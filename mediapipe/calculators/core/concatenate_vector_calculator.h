@@ -15,11 +15,13 @@
 #ifndef MEDIAPIPE_CALCULATORS_CORE_CONCATENATE_VECTOR_CALCULATOR_H_
 #define MEDIAPIPE_CALCULATORS_CORE_CONCATENATE_VECTOR_CALCULATOR_H_
 
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <vector>
 
 #include "mediapipe/calculators/core/concatenate_vector_calculator.pb.h"
+#include "mediapipe/calculators/core/sliceable.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -93,19 +95,45 @@ class ConcatenateVectorCalculator : public api2::Node {
     auto output = std::vector<U>();
     for (auto input : kIn(cc)) {
       if (input.IsEmpty()) continue;
-      MP_RETURN_IF_ERROR(input.ConsumeAndVisit(
+      absl::Status status = input.ConsumeAndVisit(
           [&output](std::unique_ptr<U> value) {
             output.push_back(std::move(*value));
           },
           [&output](std::unique_ptr<std::vector<U>> value) {
             output.insert(output.end(), std::make_move_iterator(value->begin()),
                           std::make_move_iterator(value->end()));
-          }));
+          });
+      if (!status.ok()) {
+        // Other consumers share the input, but sliceable elements can still
+        // be output without copies.
+        if constexpr (IsSliceable<U>::value) {
+          AppendSlices<U>(api2::ToOldPacket(input.packet()), &output);
+          continue;
+        }
+        return status;
+      }
     }
     kOut(cc).Send(std::move(output));
     return absl::OkStatus();
   }
 
+  // Appends slices sharing the element or the elements of the vector held by
+  // `packet`, which stays alive as long as the slices.
+  template <typename U>
+  static void AppendSlices(const mediapipe::Packet& packet,
+                           std::vector<U>* output) {
+    if (packet.ValidateAsType<U>().ok()) {
+      output->push_back(U::CreateSlice(SharedPtrWithPacket<U>(packet)));
+      return;
+    }
+    std::shared_ptr<const std::vector<U>> vector =
+        SharedPtrWithPacket<std::vector<U>>(packet);
+    for (const U& element : *vector) {
+      output->push_back(
+          U::CreateSlice(std::shared_ptr<const U>(vector, &element)));
+    }
+  }
+
   template <typename U>
   absl::Status ConsumeAndConcatenateVectors(std::false_type,
                                             CalculatorContext* cc) {
@@ -20,6 +20,7 @@
 
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -545,4 +546,48 @@ TEST(TestConcatenateUniqueIntVectorCalculatorTest, OneEmptyStreamNoOutput) {
   EXPECT_EQ(0, outputs.size());
 }
 
+TEST(ConcatenateTensorVectorCalculatorTest, SharedInputsAreSliced) {
+  // CalculatorRunner keeps copies of the input packets, so the tensors can't
+  // be moved out of them and are output as slices instead.
+  CalculatorRunner runner("ConcatenateTensorVectorCalculator",
+                          /*options_string=*/"", /*num_inputs=*/2,
+                          /*num_outputs=*/1, /*num_side_packets=*/0);
+  auto input_vector = absl::make_unique<std::vector<Tensor>>();
+  for (int i = 0; i < 2; ++i) {
+    input_vector->emplace_back(Tensor::ElementType::kFloat32,
+                               Tensor::Shape{1, 2});
+    auto view = input_vector->back().GetCpuWriteView();
+    view.buffer<float>()[0] = i;
+    view.buffer<float>()[1] = i;
+  }
+  auto input_item = absl::make_unique<Tensor>(Tensor::ElementType::kFloat32,
+                                              Tensor::Shape{1, 2});
+  {
+    auto view = input_item->GetCpuWriteView();
+    view.buffer<float>()[0] = 2;
+    view.buffer<float>()[1] = 2;
+  }
+  runner.MutableInputs()->Index(0).packets.push_back(
+      Adopt(input_vector.release()).At(Timestamp(1)));
+  runner.MutableInputs()->Index(1).packets.push_back(
+      Adopt(input_item.release()).At(Timestamp(1)));
+
+  MP_ASSERT_OK(runner.Run());
+
+  const std::vector<Packet>& outputs = runner.Outputs().Index(0).packets;
+  ASSERT_EQ(1, outputs.size());
+  const std::vector<Tensor>& result = outputs[0].Get<std::vector<Tensor>>();
+  ASSERT_EQ(3, result.size());
+  const std::vector<Tensor>& inputs =
+      runner.MutableInputs()->Index(0).packets[0].Get<std::vector<Tensor>>();
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(result[i].is_slice());
+    if (i < 2) {
+      const float* input_data = inputs[i].GetCpuReadView().buffer<float>();
+      EXPECT_EQ(input_data, result[i].GetCpuReadView().buffer<float>());
+    }
+    EXPECT_EQ(i, result[i].GetCpuReadView().buffer<float>()[1]);
+  }
+}
+
 }  // namespace mediapipe
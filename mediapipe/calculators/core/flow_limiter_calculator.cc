@@ -17,7 +17,9 @@
 #include <vector>
 
 #include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/clock.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/util/header_util.h"
 
@@ -25,6 +27,7 @@ namespace mediapipe {
 
 constexpr char kFinishedTag[] = "FINISHED";
 constexpr char kAllowTag[] = "ALLOW";
+constexpr char kClockTag[] = "CLOCK";
 constexpr char kMaxInFlightTag[] = "MAX_IN_FLIGHT";
 constexpr char kOptionsTag[] = "OPTIONS";
 
@@ -64,6 +67,34 @@ constexpr char kOptionsTag[] = "OPTIONS";
 // including the current timestamp, and "ALLOW = false" indicates the start of
 // dropping frames including the current timestamp.
 //
+// With `adaptive` options, the number of frames in flight adapts to the
+// device and load, between 1 and `max_in_flight`.  It grows while frames
+// finish within `adaptive.target_latency` of their release, and shrinks
+// while they don't.  So a phone that is already busy keeps 1 frame in flight
+// for the lowest latency, while a server with spare cores overlaps more
+// frames for throughput.  The optional "CLOCK" side packet (a
+// mediapipe::Clock*) replaces the real clock for measuring latency.
+//
+// With several "FINISHED" input streams, the graph is treated as a pipeline
+// of stages, e.g. palm detection on one accelerator followed by hand landmarks
+// on another.  "FINISHED:k" signals when a frame is done with stage k, and
+// a frame is released only while each stage 0..k holds fewer than
+// (k + 1) * max_in_flight frames.  So with `max_in_flight: 1` a new frame
+// enters the pipeline as soon as the first stage is free, and each stage
+// works on a frame of its own, which keeps accelerators assigned to
+// different stages busy at the same time.  The last stage signals the end
+// of processing like the single "FINISHED" stream.
+//
+// node {
+//   calculator: "FlowLimiterCalculator"
+//   input_stream: "raw_frames"
+//   input_stream: "FINISHED:0:detections"
+//   input_stream: "FINISHED:1:landmarks"
+//   input_stream_info: { tag_index: 'FINISHED:0' back_edge: true }
+//   input_stream_info: { tag_index: 'FINISHED:1' back_edge: true }
+//   output_stream: "sampled_frames"
+// }
+//
 // FlowLimiterCalculator provides limited support for multiple input streams.
 // The first input stream is treated as the main input stream and successive
 // input streams are treated as auxiliary input streams.  The auxiliary input
@@ -83,8 +114,12 @@ class FlowLimiterCalculator : public CalculatorBase {
       cc->Inputs().Get("", i).SetAny();
       cc->Outputs().Get("", i).SetSameAs(&(cc->Inputs().Get("", i)));
     }
-    cc->Inputs().Get("FINISHED", 0).SetAny();
+    RET_CHECK_GE(cc->Inputs().NumEntries(kFinishedTag), 1);
+    for (int i = 0; i < cc->Inputs().NumEntries(kFinishedTag); ++i) {
+      cc->Inputs().Get(kFinishedTag, i).SetAny();
+    }
     cc->InputSidePackets().Tag(kMaxInFlightTag).Set<int>().Optional();
+    cc->InputSidePackets().Tag(kClockTag).Set<mediapipe::Clock*>().Optional();
     cc->Outputs().Tag(kAllowTag).Set<bool>().Optional();
     cc->SetInputStreamHandler("ImmediateInputStreamHandler");
     cc->SetProcessTimestampBounds(true);
@@ -98,6 +133,17 @@ class FlowLimiterCalculator : public CalculatorBase {
       options_.set_max_in_flight(
           cc->InputSidePackets().Tag(kMaxInFlightTag).Get<int>());
     }
+    if (options_.has_adaptive()) {
+      RET_CHECK_GE(options_.max_in_flight(), 1)
+          << "Adaptive flow limiting requires max_in_flight >= 1.";
+      RET_CHECK_GT(options_.adaptive().target_latency(), 0);
+      in_flight_limit_ = 1;
+    }
+    clock_ = mediapipe::Clock::RealClock();
+    if (cc->InputSidePackets().HasTag(kClockTag)) {
+      clock_ = cc->InputSidePackets().Tag(kClockTag).Get<mediapipe::Clock*>();
+    }
+    num_stages_ = cc->Inputs().NumEntries(kFinishedTag);
     input_queues_.resize(cc->Inputs().NumEntries(""));
     allowed_[Timestamp::Unset()] = true;
     RET_CHECK_OK(CopyInputHeadersToOutputs(cc->Inputs(), &(cc->Outputs())));
@@ -108,14 +154,21 @@ class FlowLimiterCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) final {
     options_ = tool::RetrieveOptions(options_, cc->Inputs());
 
-    // Process the FINISHED input stream.
-    Packet finished_packet = cc->Inputs().Tag(kFinishedTag).Value();
-    if (finished_packet.Timestamp() == cc->InputTimestamp()) {
-      while (!frames_in_flight_.empty() &&
-             frames_in_flight_.front() <= finished_packet.Timestamp()) {
-        frames_in_flight_.pop_front();
+    // Process the FINISHED input streams.
+    for (int stage = 0; stage < num_stages_; ++stage) {
+      Packet finished_packet = cc->Inputs().Get(kFinishedTag, stage).Value();
+      if (finished_packet.Timestamp() != cc->InputTimestamp()) continue;
+      for (FrameInFlight& frame : frames_in_flight_) {
+        if (frame.timestamp > finished_packet.Timestamp()) break;
+        frame.stages_finished = std::max(frame.stages_finished, stage + 1);
       }
     }
+    while (!frames_in_flight_.empty() &&
+           frames_in_flight_.front().stages_finished == num_stages_) {
+      AdaptInFlightLimit(clock_->TimeNow() -
+                         frames_in_flight_.front().release_time);
+      frames_in_flight_.pop_front();
+    }
 
     // Process the frame input streams.
     for (int i = 0; i < cc->Inputs().NumEntries(""); ++i) {
@@ -132,7 +185,8 @@ class FlowLimiterCalculator : public CalculatorBase {
     if (timeout > 0 && latest_ts == cc->InputTimestamp() &&
         latest_ts < Timestamp::Max()) {
       while (!frames_in_flight_.empty() &&
-             (latest_ts - frames_in_flight_.front()) > timeout) {
+             (latest_ts - frames_in_flight_.front().timestamp) > timeout) {
+        AdaptInFlightLimit(absl::InfiniteDuration());
         frames_in_flight_.pop_front();
       }
     }
@@ -144,7 +198,7 @@ class FlowLimiterCalculator : public CalculatorBase {
       input_queue.pop_front();
       cc->Outputs().Get("", 0).AddPacket(packet);
       SendAllow(true, packet.Timestamp(), cc);
-      frames_in_flight_.push_back(packet.Timestamp());
+      frames_in_flight_.push_back({packet.Timestamp(), clock_->TimeNow()});
     }
 
     // Limit the number of queued frames.
@@ -190,7 +244,33 @@ class FlowLimiterCalculator : public CalculatorBase {
   // Returns true if an additional frame can be released for processing.
   // The "ALLOW" output stream indicates this condition at each input frame.
   bool ProcessingAllowed() {
-    return frames_in_flight_.size() < options_.max_in_flight();
+    const int max_in_flight = options_.has_adaptive()
+                                  ? std::min(in_flight_limit_,
+                                             options_.max_in_flight())
+                                  : options_.max_in_flight();
+    // The frames in stages 0..k are those that haven't finished stage k.
+    for (int stage = 0; stage < num_stages_ - 1; ++stage) {
+      int in_stages = 0;
+      for (const FrameInFlight& frame : frames_in_flight_) {
+        in_stages += frame.stages_finished <= stage;
+      }
+      if (in_stages >= (stage + 1) * max_in_flight) return false;
+    }
+    return frames_in_flight_.size() < num_stages_ * max_in_flight;
+  }
+
+  // Grows or shrinks the adaptive limit on frames in flight by one, depending
+  // on whether a frame finished within the target latency.
+  void AdaptInFlightLimit(absl::Duration latency) {
+    if (!options_.has_adaptive()) {
+      return;
+    }
+    if (latency <= absl::Microseconds(options_.adaptive().target_latency())) {
+      in_flight_limit_ = std::min(in_flight_limit_ + 1,
+                                  std::max(options_.max_in_flight(), 1));
+    } else {
+      in_flight_limit_ = std::max(in_flight_limit_ - 1, 1);
+    }
   }
 
   // Outputs a packet indicating whether a frame was sent or dropped.
@@ -257,9 +337,22 @@ class FlowLimiterCalculator : public CalculatorBase {
   }
 
  private:
+  // A frame released for processing.
+  struct FrameInFlight {
+    Timestamp timestamp;
+    absl::Time release_time;
+    // The number of pipeline stages the frame is done with.
+    int stages_finished = 0;
+  };
+
   FlowLimiterCalculatorOptions options_;
   std::vector<std::deque<Packet>> input_queues_;
-  std::deque<Timestamp> frames_in_flight_;
+  std::deque<FrameInFlight> frames_in_flight_;
+  // The number of pipeline stages, one per FINISHED stream.
+  int num_stages_ = 1;
+  // The adaptive limit on frames in flight, within [1, max_in_flight].
+  int in_flight_limit_ = 1;
+  mediapipe::Clock* clock_ = nullptr;
   std::map<Timestamp, bool> allowed_;
 };
 REGISTER_CALCULATOR(FlowLimiterCalculator);
@@ -430,6 +430,161 @@ TEST_F(FlowLimiterCalculatorTest, FinishedTimestamps) {
   EXPECT_EQ(out_1_packets_, expected_output);
 }
 
+// Shows that adaptive flow limiting releases more frames at once while
+// frames finish within the target latency, up to max_in_flight, and fewer
+// once they don't.  SleepCalculator processes one frame at a time, so each
+// additional frame in flight adds 22 ms of latency.
+TEST_F(FlowLimiterCalculatorTest, AdaptiveInFlight) {
+  // Configure the test.
+  SetUpInputData();
+  SetUpSimulationClock();
+  CalculatorGraphConfig graph_config = InflightGraphConfig();
+  graph_config.mutable_node(0)->add_input_side_packet("CLOCK:clock");
+  auto limiter_options = ParseTextProtoOrDie<FlowLimiterCalculatorOptions>(R"pb(
+    max_in_flight: 3
+    max_in_queue: 0
+    adaptive { target_latency: 50000 }
+  )pb");
+  std::map<std::string, Packet> side_packets = {
+      {"limiter_options",
+       MakePacket<FlowLimiterCalculatorOptions>(limiter_options)},
+      {"warmup_time", MakePacket<int64>(22000)},
+      {"sleep_time", MakePacket<int64>(22000)},
+      {"drop_timesamps", MakePacket<bool>(false)},
+      {"clock", MakePacket<mediapipe::Clock*>(clock_)},
+  };
+
+  // Start the graph.
+  MP_ASSERT_OK(graph_.Initialize(graph_config));
+  MP_EXPECT_OK(graph_.ObserveOutputStream("allow", [this](Packet p) {
+    allow_packets_.push_back(p);
+    return absl::OkStatus();
+  }));
+  simulation_clock_->ThreadStart();
+  MP_ASSERT_OK(graph_.StartRun(side_packets));
+
+  // Adds a burst of input packets and waits for them to finish.
+  auto add_burst = [&](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      MP_EXPECT_OK(graph_.AddPacketToInputStream("in_1", input_packets_[i]));
+      clock_->Sleep(absl::Microseconds(1));
+    }
+    clock_->Sleep(absl::Microseconds(100000));
+  };
+
+  // packet-0 finishes after 22 ms, raising the limit to 2.
+  add_burst(0, 1);
+  // packet-1 and packet-2 finish after 22 and 44 ms, raising the limit to 3.
+  add_burst(1, 3);
+  // packet-3 to packet-5 are released and packet-6 is dropped.  packet-5
+  // finishes after 66 ms, lowering the limit to 2.
+  add_burst(3, 7);
+  // packet-7 and packet-8 are released and packet-9 is dropped.
+  add_burst(7, 10);
+
+  // Finish the graph.
+  MP_EXPECT_OK(graph_.CloseAllPacketSources());
+  clock_->Sleep(absl::Microseconds(40000));
+  MP_EXPECT_OK(graph_.WaitUntilDone());
+  simulation_clock_->ThreadFinish();
+
+  // Validate the ALLOW stream output.
+  std::vector<bool> allowed;
+  for (const Packet& packet : allow_packets_) {
+    allowed.push_back(packet.Get<bool>());
+  }
+  EXPECT_THAT(allowed, testing::ElementsAre(true, true, true, true, true, true,
+                                            false, true, true, false));
+}
+
+// Shows that with a FINISHED stream per pipeline stage, a frame is released
+// as soon as the first stage is free, so that both stages work at the same
+// time.  Each SleepCalculator stage takes 22 ms and frames arrive every 10 ms,
+// so every third frame is released instead of every fifth.
+TEST_F(FlowLimiterCalculatorTest, PipelineStages) {
+  // Configure the test.
+  SetUpInputData();
+  SetUpSimulationClock();
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in_1'
+        node {
+          calculator: 'FlowLimiterCalculator'
+          input_side_packet: 'OPTIONS:limiter_options'
+          input_stream: 'in_1'
+          input_stream: 'FINISHED:0:stage_1'
+          input_stream: 'FINISHED:1:out_1'
+          input_stream_info: { tag_index: 'FINISHED:0' back_edge: true }
+          input_stream_info: { tag_index: 'FINISHED:1' back_edge: true }
+          output_stream: 'in_1_sampled'
+          output_stream: 'ALLOW:allow'
+        }
+        node {
+          calculator: 'SleepCalculator'
+          input_side_packet: 'WARMUP_TIME:sleep_time'
+          input_side_packet: 'SLEEP_TIME:sleep_time'
+          input_side_packet: 'CLOCK:clock'
+          input_stream: 'PACKET:in_1_sampled'
+          output_stream: 'PACKET:stage_1'
+        }
+        node {
+          calculator: 'SleepCalculator'
+          input_side_packet: 'WARMUP_TIME:sleep_time'
+          input_side_packet: 'SLEEP_TIME:sleep_time'
+          input_side_packet: 'CLOCK:clock'
+          input_stream: 'PACKET:stage_1'
+          output_stream: 'PACKET:out_1'
+        }
+      )pb");
+  auto limiter_options = ParseTextProtoOrDie<FlowLimiterCalculatorOptions>(R"pb(
+    max_in_flight: 1
+    max_in_queue: 0
+  )pb");
+  std::map<std::string, Packet> side_packets = {
+      {"limiter_options",
+       MakePacket<FlowLimiterCalculatorOptions>(limiter_options)},
+      {"sleep_time", MakePacket<int64>(22000)},
+      {"clock", MakePacket<mediapipe::Clock*>(clock_)},
+  };
+
+  // Start the graph.
+  MP_ASSERT_OK(graph_.Initialize(graph_config));
+  MP_EXPECT_OK(graph_.ObserveOutputStream("out_1", [this](Packet p) {
+    out_1_packets_.push_back(p);
+    return absl::OkStatus();
+  }));
+  MP_EXPECT_OK(graph_.ObserveOutputStream("allow", [this](Packet p) {
+    allow_packets_.push_back(p);
+    return absl::OkStatus();
+  }));
+  simulation_clock_->ThreadStart();
+  MP_ASSERT_OK(graph_.StartRun(side_packets));
+
+  // packet-0 leaves the first stage at 22 ms, so packet-3 is released at
+  // 30 ms while packet-0 is in the second stage, and so forth.
+  for (int i = 0; i < 10; ++i) {
+    MP_EXPECT_OK(graph_.AddPacketToInputStream("in_1", input_packets_[i]));
+    clock_->Sleep(absl::Microseconds(10000));
+  }
+
+  // Finish the graph.
+  MP_EXPECT_OK(graph_.CloseAllPacketSources());
+  clock_->Sleep(absl::Microseconds(100000));
+  MP_EXPECT_OK(graph_.WaitUntilDone());
+  simulation_clock_->ThreadFinish();
+
+  // Validate the output.
+  std::vector<bool> allowed;
+  for (const Packet& packet : allow_packets_) {
+    allowed.push_back(packet.Get<bool>());
+  }
+  EXPECT_THAT(allowed, testing::ElementsAre(true, false, false, true, false,
+                                            false, true, false, false, true));
+  std::vector<Packet> expected_output = {input_packets_[0], input_packets_[3],
+                                         input_packets_[6], input_packets_[9]};
+  EXPECT_EQ(out_1_packets_, expected_output);
+}
+
 // Shows that an output packet can be lost completely, and the
 // FlowLimiterCalculator will stop waiting for it after in_flight_timeout.
 // DropCalculator completely loses one packet including its timestamp bound.
@@ -137,6 +137,8 @@ class GateCalculator : public CalculatorBase {
     if (cc->Outputs().HasTag(kStateChangeTag)) {
       cc->Outputs().Tag(kStateChangeTag).Set<bool>();
     }
+    cc->SetInlineSafe(true);
+    cc->SetWorkload(CalculatorContract::Workload::kLight);
 
     return absl::OkStatus();
   }
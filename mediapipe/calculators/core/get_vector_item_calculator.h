@@ -64,6 +64,11 @@ class GetVectorItemCalculator : public Node {
 
   MEDIAPIPE_NODE_CONTRACT(kIn, kIdx, kOut);
 
+  static absl::Status UpdateContract(CalculatorContract* cc) {
+    cc->SetInlineSafe(true);
+    return absl::OkStatus();
+  }
+
   absl::Status Open(CalculatorContext* cc) final {
     cc->SetOffset(mediapipe::TimestampDiff(0));
     auto& options = cc->Options<mediapipe::GetVectorItemCalculatorOptions>();
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+
 #include "Eigen/Core"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -73,6 +75,25 @@ absl::Status MatrixSubtractCalculator::Process(CalculatorContext* cc) {
     return absl::InvalidArgumentError(
         "Minuend and subtrahend must have the same dimensions.");
   }
+  // Writes the difference over the input stream's matrix when no one else
+  // holds it.
+  if (kMinuend(cc).IsStream()) {
+    auto consumed = kMinuend(cc).Consume();
+    if (consumed.ok()) {
+      std::unique_ptr<Matrix> output = std::move(consumed).value();
+      *output -= subtrahend;
+      kOut(cc).Send(std::move(output));
+      return absl::OkStatus();
+    }
+  } else {
+    auto consumed = kSubtrahend(cc).Consume();
+    if (consumed.ok()) {
+      std::unique_ptr<Matrix> output = std::move(consumed).value();
+      *output = minuend - *output;
+      kOut(cc).Send(std::move(output));
+      return absl::OkStatus();
+    }
+  }
   kOut(cc).Send(minuend - subtrahend);
   return absl::OkStatus();
 }
@@ -0,0 +1,181 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mediapipe/calculators/core/motion_gate_calculator.pb.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace api2 {
+
+namespace {
+
+// Cells get up to this many samples along each axis; more pixels than that
+// are skipped, which keeps the cost low on large frames.
+constexpr int kMaxSamplesPerCell = 8;
+
+// Computes the mean luminance, in [0, 1], of each cell of a grid_width x
+// grid_height grid covering the frame.
+absl::Status ComputeLuminanceGrid(const ImageFrame& frame, int grid_width,
+                                  int grid_height, std::vector<float>* grid) {
+  RET_CHECK_EQ(frame.ByteDepth(), 1) << "Only 8-bit frames are supported.";
+  const int channels = frame.NumberOfChannels();
+  RET_CHECK(channels == 1 || channels == 3 || channels == 4)
+      << "Unsupported number of channels: " << channels;
+  const int width = frame.Width();
+  const int height = frame.Height();
+  RET_CHECK(width > 0 && height > 0);
+  const int step_x = std::max(1, width / (grid_width * kMaxSamplesPerCell));
+  const int step_y = std::max(1, height / (grid_height * kMaxSamplesPerCell));
+
+  std::vector<float> sums(grid_width * grid_height, 0.0f);
+  std::vector<int> counts(grid_width * grid_height, 0);
+  for (int y = 0; y < height; y += step_y) {
+    const uint8* row = frame.PixelData() + y * frame.WidthStep();
+    const int cell_row = y * grid_height / height * grid_width;
+    for (int x = 0; x < width; x += step_x) {
+      const uint8* pixel = row + x * channels;
+      // Rec. 601 luma, as computed by LuminanceCalculator.
+      const float luminance =
+          channels == 1 ? pixel[0]
+                        : 0.299f * pixel[0] + 0.587f * pixel[1] +
+                              0.114f * pixel[2];
+      const int cell = cell_row + x * grid_width / width;
+      sums[cell] += luminance;
+      ++counts[cell];
+    }
+  }
+
+  grid->resize(sums.size());
+  for (int i = 0; i < sums.size(); ++i) {
+    // Cells smaller than a pixel get no sample, and compare as unchanged.
+    (*grid)[i] = counts[i] > 0 ? sums[i] / (counts[i] * 255.0f) : 0.0f;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// Passes IMAGE frames through only when the scene changed since the last frame
+// it let through, so that expensive processing such as inference can be
+// skipped on static scenes, e.g. from a fixed camera.
+//
+// The change is measured on a coarse grid of mean luminance: a frame is
+// allowed when enough cells differ from the last allowed frame. Comparing with
+// the last allowed frame, rather than with the previous one, also catches slow
+// changes. The first frame is always allowed.
+//
+// Disallowed frames only advance the timestamp bound of the IMAGE output. The
+// results of the skipped processing can be re-emitted for every frame with a
+// PacketClonerCalculator ticked by the input frames, as in the example below.
+//
+// Inputs:
+//   IMAGE - ImageFrame in SRGB, SRGBA or GRAY8 format.
+// Outputs:
+//   IMAGE - The input frames where the scene changed.
+//   ALLOW (optional) - bool, for every frame, whether it was let through.
+//   MOTION_SCORE (optional) - float, for every frame, the fraction of the
+//     grid cells that changed.
+//
+// Example config:
+// node {
+//   calculator: "MotionGateCalculator"
+//   input_stream: "IMAGE:input_video"
+//   output_stream: "IMAGE:changed_video"
+//   options {
+//     [mediapipe.MotionGateCalculatorOptions.ext] {
+//       min_changed_fraction: 0.02
+//     }
+//   }
+// }
+// node {
+//   calculator: "FaceDetectionShortRangeCpu"
+//   input_stream: "IMAGE:changed_video"
+//   output_stream: "DETECTIONS:changed_detections"
+// }
+// node {
+//   calculator: "PacketClonerCalculator"
+//   input_stream: "changed_detections"
+//   input_stream: "TICK:input_video"
+//   output_stream: "detections"
+// }
+class MotionGateCalculator : public Node {
+ public:
+  static constexpr Input<ImageFrame> kInImage{"IMAGE"};
+  static constexpr Output<ImageFrame> kOutImage{"IMAGE"};
+  static constexpr Output<bool>::Optional kOutAllow{"ALLOW"};
+  static constexpr Output<float>::Optional kOutMotionScore{"MOTION_SCORE"};
+
+  MEDIAPIPE_NODE_CONTRACT(kInImage, kOutImage, kOutAllow, kOutMotionScore);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    options_ = cc->Options<MotionGateCalculatorOptions>();
+    RET_CHECK_GT(options_.grid_width(), 0);
+    RET_CHECK_GT(options_.grid_height(), 0);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kInImage(cc).IsEmpty()) return absl::OkStatus();
+
+    MP_RETURN_IF_ERROR(ComputeLuminanceGrid(*kInImage(cc),
+                                            options_.grid_width(),
+                                            options_.grid_height(), &grid_));
+    float motion_score = 1.0f;
+    if (!reference_grid_.empty()) {
+      int changed_cells = 0;
+      for (int i = 0; i < grid_.size(); ++i) {
+        if (std::abs(grid_[i] - reference_grid_[i]) >
+            options_.cell_change_threshold()) {
+          ++changed_cells;
+        }
+      }
+      motion_score = static_cast<float>(changed_cells) / grid_.size();
+    }
+
+    const bool allow =
+        motion_score >= options_.min_changed_fraction() ||
+        (options_.max_disallowed_frames() > 0 &&
+         disallowed_frames_ >= options_.max_disallowed_frames());
+    if (allow) {
+      reference_grid_.swap(grid_);
+      disallowed_frames_ = 0;
+      kOutImage(cc).Send(kInImage(cc).packet().As<ImageFrame>());
+    } else {
+      ++disallowed_frames_;
+    }
+    kOutAllow(cc).Send(allow);
+    kOutMotionScore(cc).Send(motion_score);
+    return absl::OkStatus();
+  }
+
+ private:
+  MotionGateCalculatorOptions options_;
+  // Luminance grid of the current frame, and of the last allowed one.
+  std::vector<float> grid_;
+  std::vector<float> reference_grid_;
+  int disallowed_frames_ = 0;
+};
+MEDIAPIPE_REGISTER_NODE(MotionGateCalculator);
+
+}  // namespace api2
+}  // namespace mediapipe
@@ -0,0 +1,114 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 48;
+
+// A gray frame, with a white square of the given size in the top left corner.
+Packet MakeFrame(int square_size, int64 timestamp) {
+  auto frame = std::make_unique<ImageFrame>(ImageFormat::GRAY8, kWidth,
+                                            kHeight, /*alignment_boundary=*/1);
+  for (int y = 0; y < kHeight; ++y) {
+    uint8* row = frame->MutablePixelData() + y * frame->WidthStep();
+    for (int x = 0; x < kWidth; ++x) {
+      row[x] = x < square_size && y < square_size ? 255 : 128;
+    }
+  }
+  return Adopt(frame.release()).At(Timestamp(timestamp));
+}
+
+class MotionGateCalculatorTest : public ::testing::Test {
+ protected:
+  void CreateRunner(const std::string& options) {
+    runner_ = std::make_unique<CalculatorRunner>(
+        ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::StrCat(R"pb(
+          calculator: "MotionGateCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "IMAGE:gated_image"
+          output_stream: "ALLOW:allow"
+          options {
+            [mediapipe.MotionGateCalculatorOptions.ext] {)pb",
+                                                                     options,
+                                                                     "}}")));
+  }
+
+  void AddFrame(int square_size, int64 timestamp) {
+    runner_->MutableInputs()->Tag("IMAGE").packets.push_back(
+        MakeFrame(square_size, timestamp));
+  }
+
+  std::vector<int64> GatedTimestamps() {
+    std::vector<int64> timestamps;
+    for (const Packet& packet : runner_->Outputs().Tag("IMAGE").packets) {
+      timestamps.push_back(packet.Timestamp().Value());
+    }
+    return timestamps;
+  }
+
+  std::unique_ptr<CalculatorRunner> runner_;
+};
+
+TEST_F(MotionGateCalculatorTest, DisallowsStaticFrames) {
+  CreateRunner("grid_width: 8 grid_height: 6 max_disallowed_frames: 0");
+  for (int t = 0; t < 5; ++t) AddFrame(/*square_size=*/0, t);
+  MP_ASSERT_OK(runner_->Run());
+
+  EXPECT_EQ(GatedTimestamps(), std::vector<int64>({0}));
+  const auto& allow = runner_->Outputs().Tag("ALLOW").packets;
+  ASSERT_EQ(allow.size(), 5);
+  EXPECT_TRUE(allow[0].Get<bool>());
+  for (int t = 1; t < 5; ++t) EXPECT_FALSE(allow[t].Get<bool>());
+}
+
+TEST_F(MotionGateCalculatorTest, AllowsChangedFrames) {
+  CreateRunner(
+      "grid_width: 8 grid_height: 6 min_changed_fraction: 0.05 "
+      "max_disallowed_frames: 0");
+  AddFrame(/*square_size=*/0, 0);
+  // A change of 1 cell in 48 is below min_changed_fraction.
+  AddFrame(/*square_size=*/4, 1);
+  // A 16x16 square changes 4 cells.
+  AddFrame(/*square_size=*/16, 2);
+  AddFrame(/*square_size=*/16, 3);
+  AddFrame(/*square_size=*/0, 4);
+  MP_ASSERT_OK(runner_->Run());
+
+  EXPECT_EQ(GatedTimestamps(), std::vector<int64>({0, 2, 4}));
+}
+
+TEST_F(MotionGateCalculatorTest, AllowsFramesPeriodically) {
+  CreateRunner("grid_width: 8 grid_height: 6 max_disallowed_frames: 2");
+  for (int t = 0; t < 7; ++t) AddFrame(/*square_size=*/0, t);
+  MP_ASSERT_OK(runner_->Run());
+
+  EXPECT_EQ(GatedTimestamps(), std::vector<int64>({0, 3, 6}));
+}
+
+}  // namespace
+}  // namespace mediapipe
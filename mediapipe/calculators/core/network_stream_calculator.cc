@@ -0,0 +1,295 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/core/network_stream_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/packet_recording.h"
+#include "mediapipe/framework/tool/packet_recording.pb.h"
+#include "mediapipe/framework/tool/status_util.h"
+#include "mediapipe/util/message_socket.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kInTag[] = "IN";
+constexpr char kOutTag[] = "OUT";
+
+// The first byte of a message, followed by the serialized NetworkStreamBatch,
+// or by its uint32 little-endian size and its zlib compressed bytes.
+enum MessageFormat : uint8_t {
+  kUncompressed = 0,
+  kZlib = 1,
+};
+
+constexpr size_t kSizeBytes = sizeof(uint32_t);
+
+// How long a source waits for a batch before returning from Process, so that
+// the graph can be stopped.
+constexpr absl::Duration kReadTimeout = absl::Milliseconds(10);
+
+// How long a sink waits between attempts to connect.
+constexpr absl::Duration kConnectInterval = absl::Milliseconds(100);
+
+absl::StatusOr<std::string> EncodeBatch(
+    const NetworkStreamBatch& batch,
+    const NetworkStreamSinkCalculatorOptions& options) {
+  const std::string serialized = batch.SerializeAsString();
+  if (options.compression() == NetworkStreamSinkCalculatorOptions::NONE) {
+    return absl::StrCat(absl::string_view("\0", 1), serialized);
+  }
+  RET_CHECK_EQ(options.compression(), NetworkStreamSinkCalculatorOptions::ZLIB);
+  uLongf compressed_size = compressBound(serialized.size());
+  std::string message(1 + kSizeBytes + compressed_size, '\0');
+  message[0] = kZlib;
+  for (int i = 0; i < kSizeBytes; ++i) {
+    message[1 + i] = static_cast<char>((serialized.size() >> (8 * i)) & 0xff);
+  }
+  const int result = compress2(
+      reinterpret_cast<Bytef*>(&message[1 + kSizeBytes]), &compressed_size,
+      reinterpret_cast<const Bytef*>(serialized.data()), serialized.size(),
+      options.compression_level());
+  RET_CHECK_EQ(result, Z_OK) << "zlib compression failed.";
+  message.resize(1 + kSizeBytes + compressed_size);
+  return message;
+}
+
+absl::Status DecodeBatch(absl::string_view message,
+                         NetworkStreamBatch* batch) {
+  RET_CHECK(!message.empty());
+  const uint8_t format = message[0];
+  message.remove_prefix(1);
+  if (format == kUncompressed) {
+    RET_CHECK(batch->ParseFromArray(message.data(), message.size()));
+    return absl::OkStatus();
+  }
+  RET_CHECK_EQ(format, kZlib) << "Unknown message format.";
+  RET_CHECK_GE(message.size(), kSizeBytes);
+  uint32_t size = 0;
+  for (int i = 0; i < kSizeBytes; ++i) {
+    size |= static_cast<uint32_t>(static_cast<uint8_t>(message[i])) << (8 * i);
+  }
+  message.remove_prefix(kSizeBytes);
+  RET_CHECK_LE(size, MessageSocket::kMaxMessageSize);
+  std::string serialized(size, '\0');
+  uLongf uncompressed_size = size;
+  const int result = uncompress(
+      reinterpret_cast<Bytef*>(serialized.data()), &uncompressed_size,
+      reinterpret_cast<const Bytef*>(message.data()), message.size());
+  RET_CHECK(result == Z_OK && uncompressed_size == size)
+      << "zlib decompression failed.";
+  RET_CHECK(batch->ParseFromString(serialized));
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// Sends the IN stream to the NetworkStreamSourceCalculator listening at
+// address, usually in a graph on another host, over TCP. The timestamp
+// bounds of the stream are sent too. See tool::PartitionGraph(), which
+// splits a graph into graphs joined by these calculators.
+//
+// Packets are sent with the packet recording encoding: ImageFrames, CPU
+// Images and Tensors, proto messages, and the types registered with
+// serialization functions. They can be sent in batches, and compressed.
+//
+// Sending waits while the source doesn't read, once the socket buffers are
+// full. A source reads as fast as its graph takes the packets, so the flow
+// control of the receiving graph, such as its max_queue_size, holds back the
+// sink, and through it the flow control of the sending graph.
+//
+// Connects in the first Process, or in Close for an empty stream, retrying
+// until the source listens.
+//
+// Inputs:
+//   IN - The packets to send.
+//
+// Example config:
+// node {
+//   calculator: "NetworkStreamSinkCalculator"
+//   input_stream: "IN:detections"
+//   options {
+//     [mediapipe.NetworkStreamSinkCalculatorOptions.ext] {
+//       address: "tracking-host:7600"
+//       compression: ZLIB
+//     }
+//   }
+// }
+class NetworkStreamSinkCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Tag(kInTag).SetAny();
+    cc->SetProcessTimestampBounds(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<NetworkStreamSinkCalculatorOptions>();
+    RET_CHECK(!options_.address().empty()) << "An address is required.";
+    RET_CHECK_GT(options_.max_batch_packets(), 0);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    const Packet& packet = cc->Inputs().Tag(kInTag).Value();
+    if (packet.IsEmpty()) {
+      batch_.set_timestamp_bound(
+          cc->InputTimestamp().NextAllowedInStream().Value());
+      return SendBatch();
+    }
+    if (batch_.packet_size() == 0) batch_start_ = absl::Now();
+    MP_RETURN_IF_ERROR(tool::EncodeRecordedPacket(packet, batch_.add_packet()));
+    if (batch_.packet_size() >= options_.max_batch_packets() ||
+        absl::Now() - batch_start_ >=
+            absl::Milliseconds(options_.max_batch_delay_ms())) {
+      return SendBatch();
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Close(CalculatorContext* cc) override {
+    batch_.set_done(true);
+    MP_RETURN_IF_ERROR(SendBatch());
+    socket_.reset();
+    return absl::OkStatus();
+  }
+
+ private:
+  absl::Status SendBatch() {
+    if (!socket_) MP_RETURN_IF_ERROR(Connect());
+    ASSIGN_OR_RETURN(const std::string message, EncodeBatch(batch_, options_));
+    batch_.Clear();
+    return socket_->Send(message);
+  }
+
+  absl::Status Connect() {
+    const absl::Time deadline =
+        options_.connect_timeout_ms() > 0
+            ? absl::Now() + absl::Milliseconds(options_.connect_timeout_ms())
+            : absl::InfiniteFuture();
+    while (true) {
+      absl::StatusOr<std::unique_ptr<MessageSocket>> socket =
+          MessageSocket::Connect(options_.address());
+      if (socket.ok()) {
+        socket_ = *std::move(socket);
+        return absl::OkStatus();
+      }
+      if (!absl::IsUnavailable(socket.status()) || absl::Now() >= deadline) {
+        return socket.status();
+      }
+      absl::SleepFor(kConnectInterval);
+    }
+  }
+
+  NetworkStreamSinkCalculatorOptions options_;
+  std::unique_ptr<MessageSocket> socket_;
+  NetworkStreamBatch batch_;
+  // When the first packet of batch_ arrived.
+  absl::Time batch_start_;
+};
+REGISTER_CALCULATOR(NetworkStreamSinkCalculator);
+
+// Outputs the packets and timestamp bounds sent by the
+// NetworkStreamSinkCalculator connecting to port, usually from a graph on
+// another host. Accepts a single connection, and closes OUT once the sink
+// closed the stream. Fails if the connection is lost before.
+//
+// Only reads from the connection while the graph takes packets from the
+// source, which holds back the sink when the graph is throttled.
+//
+// Outputs:
+//   OUT - The packets received.
+//
+// Example config:
+// node {
+//   calculator: "NetworkStreamSourceCalculator"
+//   output_stream: "OUT:detections"
+//   options {
+//     [mediapipe.NetworkStreamSourceCalculatorOptions.ext] { port: 7600 }
+//   }
+// }
+class NetworkStreamSourceCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Outputs().Tag(kOutTag).SetAny();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    const auto& options = cc->Options<NetworkStreamSourceCalculatorOptions>();
+    RET_CHECK_GT(options.port(), 0) << "A port is required.";
+    ASSIGN_OR_RETURN(listener_, MessageSocket::Listen(options.port()));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (!socket_) {
+      ASSIGN_OR_RETURN(socket_, listener_->Accept(kReadTimeout));
+      if (!socket_) return absl::OkStatus();
+      listener_.reset();
+    }
+    std::string message;
+    absl::StatusOr<bool> received = socket_->Receive(kReadTimeout, &message);
+    if (absl::IsOutOfRange(received.status())) {
+      return absl::UnavailableError(
+          "The sink closed the connection before the end of the stream.");
+    }
+    MP_RETURN_IF_ERROR(received.status());
+    if (!*received) return absl::OkStatus();
+
+    NetworkStreamBatch batch;
+    MP_RETURN_IF_ERROR(DecodeBatch(message, &batch));
+    OutputStream& output = cc->Outputs().Tag(kOutTag);
+    for (const RecordedPacket& recorded : batch.packet()) {
+      ASSIGN_OR_RETURN(Packet packet, tool::DecodeRecordedPacket(recorded));
+      output.AddPacket(std::move(packet));
+    }
+    if (batch.has_timestamp_bound()) {
+      const Timestamp bound =
+          Timestamp::CreateNoErrorChecking(batch.timestamp_bound());
+      if (bound > output.NextTimestampBound()) {
+        output.SetNextTimestampBound(bound);
+      }
+    }
+    if (batch.done()) return tool::StatusStop();
+    return absl::OkStatus();
+  }
+
+  absl::Status Close(CalculatorContext* cc) override {
+    socket_.reset();
+    listener_.reset();
+    return absl::OkStatus();
+  }
+
+ private:
+  std::unique_ptr<MessageSocket> listener_;
+  std::unique_ptr<MessageSocket> socket_;
+};
+REGISTER_CALCULATOR(NetworkStreamSourceCalculator);
+
+}  // namespace mediapipe
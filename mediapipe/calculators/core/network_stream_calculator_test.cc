@@ -0,0 +1,164 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/util/message_socket.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Returns a port that is free for the test to listen on.
+int FreePort() {
+  auto listener = MessageSocket::Listen(0);
+  CHECK_OK(listener.status());
+  return (*listener)->port();
+}
+
+CalculatorGraphConfig SinkGraph(int port, const std::string& options) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(absl::StrReplaceAll(
+      R"pb(
+        input_stream: "in"
+        node {
+          calculator: "NetworkStreamSinkCalculator"
+          input_stream: "IN:in"
+          options {
+            [mediapipe.NetworkStreamSinkCalculatorOptions.ext] {
+              address: "localhost:$port"
+              $options
+            }
+          }
+        }
+      )pb",
+      {{"$port", absl::StrCat(port)}, {"$options", options}}));
+}
+
+CalculatorGraphConfig SourceGraph(int port) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(absl::StrReplaceAll(
+      R"pb(
+        output_stream: "out"
+        node {
+          calculator: "NetworkStreamSourceCalculator"
+          output_stream: "OUT:out"
+          options {
+            [mediapipe.NetworkStreamSourceCalculatorOptions.ext] {
+              port: $port
+            }
+          }
+        }
+      )pb",
+      {{"$port", absl::StrCat(port)}}));
+}
+
+Packet MakeFrame(int value, int64_t timestamp) {
+  auto frame = std::make_unique<ImageFrame>(ImageFormat::GRAY8, 64, 48);
+  frame->SetToZero();
+  frame->MutablePixelData()[0] = value;
+  return Adopt(frame.release()).At(Timestamp(timestamp));
+}
+
+// Collects the first pixels of the frames of a stream, and -1 for its
+// timestamp bounds.
+class FrameCollector {
+ public:
+  absl::Status Observe(CalculatorGraph* graph) {
+    return graph->ObserveOutputStream(
+        "out",
+        [this](const Packet& packet) {
+          absl::MutexLock lock(&mutex_);
+          timestamps_.push_back(packet.Timestamp().Value());
+          values_.push_back(packet.IsEmpty()
+                                ? -1
+                                : packet.Get<ImageFrame>().PixelData()[0]);
+          return absl::OkStatus();
+        },
+        /*observe_timestamp_bounds=*/true);
+  }
+
+  std::vector<int64_t> timestamps() {
+    absl::MutexLock lock(&mutex_);
+    return timestamps_;
+  }
+  std::vector<int> values() {
+    absl::MutexLock lock(&mutex_);
+    return values_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<int64_t> timestamps_;
+  std::vector<int> values_;
+};
+
+void SendFrames(const std::string& sink_options) {
+  const int port = FreePort();
+  CalculatorGraph source_graph(SourceGraph(port));
+  FrameCollector collector;
+  MP_ASSERT_OK(collector.Observe(&source_graph));
+  MP_ASSERT_OK(source_graph.StartRun({}));
+
+  CalculatorGraph sink_graph(SinkGraph(port, sink_options));
+  MP_ASSERT_OK(sink_graph.StartRun({}));
+  for (int i = 0; i < 5; ++i) {
+    MP_ASSERT_OK(sink_graph.AddPacketToInputStream("in", MakeFrame(i * 10, i)));
+  }
+  MP_ASSERT_OK(sink_graph.SetInputStreamTimestampBound("in", Timestamp(10)));
+  // Lets the sink send the bound before the stream closes.
+  MP_ASSERT_OK(sink_graph.WaitUntilIdle());
+  MP_ASSERT_OK(sink_graph.CloseAllInputStreams());
+  MP_ASSERT_OK(sink_graph.WaitUntilDone());
+  MP_ASSERT_OK(source_graph.WaitUntilDone());
+
+  EXPECT_THAT(collector.values(), ElementsAre(0, 10, 20, 30, 40, -1));
+  EXPECT_THAT(collector.timestamps(), ElementsAre(0, 1, 2, 3, 4, 9));
+}
+
+TEST(NetworkStreamCalculatorTest, SendsPacketsAndBounds) { SendFrames(""); }
+
+TEST(NetworkStreamCalculatorTest, SendsCompressedBatches) {
+  SendFrames("max_batch_packets: 3 max_batch_delay_ms: 60000 "
+             "compression: ZLIB");
+}
+
+TEST(NetworkStreamCalculatorTest, ClosesEmptyStream) {
+  const int port = FreePort();
+  CalculatorGraph source_graph(SourceGraph(port));
+  FrameCollector collector;
+  MP_ASSERT_OK(collector.Observe(&source_graph));
+  MP_ASSERT_OK(source_graph.StartRun({}));
+
+  CalculatorGraph sink_graph(SinkGraph(port, ""));
+  MP_ASSERT_OK(sink_graph.StartRun({}));
+  MP_ASSERT_OK(sink_graph.CloseAllInputStreams());
+  MP_ASSERT_OK(sink_graph.WaitUntilDone());
+  MP_ASSERT_OK(source_graph.WaitUntilDone());
+  EXPECT_TRUE(collector.values().empty());
+}
+
+}  // namespace
+}  // namespace mediapipe
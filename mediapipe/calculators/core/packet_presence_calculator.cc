@@ -66,6 +66,8 @@ class PacketPresenceCalculator : public CalculatorBase {
     // Process() function is invoked in response to input stream timestamp
     // bound updates.
     cc->SetProcessTimestampBounds(true);
+    cc->SetInlineSafe(true);
+    cc->SetWorkload(CalculatorContract::Workload::kLight);
     return absl::OkStatus();
   }
 
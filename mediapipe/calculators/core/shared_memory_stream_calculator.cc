@@ -0,0 +1,406 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/core/shared_memory_stream_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/packet_recording.h"
+#include "mediapipe/framework/tool/packet_recording.pb.h"
+#include "mediapipe/framework/tool/status_util.h"
+#include "mediapipe/util/shared_memory_ring.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kInTag[] = "IN";
+constexpr char kOutTag[] = "OUT";
+
+// The kinds of entries of a channel. A packet entry holds the uint32 size of
+// a RecordedPacket describing the packet, the RecordedPacket, and for images
+// and tensors, their data at the next multiple of kDataAlignment. The data of
+// the other packets is in the RecordedPacket.
+enum EntryKind : int32_t {
+  kPacketEntry = 1,
+  kTimestampBoundEntry = 2,
+};
+
+constexpr size_t kDataAlignment = 64;
+
+// How long a source waits for a packet before returning from Process, so
+// that the graph can be stopped.
+constexpr absl::Duration kReadTimeout = absl::Milliseconds(10);
+
+size_t DataOffset(size_t description_size) {
+  const size_t end = sizeof(uint32_t) + description_size;
+  return (end + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+}
+
+// Describes `frame` in `description`, and returns the size of its pixels
+// stored contiguously.
+size_t DescribeImageFrame(const ImageFrame& frame,
+                          RecordedPacket* description) {
+  description->set_format(frame.Format());
+  description->add_dims(frame.Width());
+  description->add_dims(frame.Height());
+  return frame.PixelDataSizeStoredContiguously();
+}
+
+void WriteImageFrame(const ImageFrame& frame, uint8_t* data) {
+  const int row_size =
+      frame.Width() * frame.NumberOfChannels() * frame.ByteDepth();
+  for (int y = 0; y < frame.Height(); ++y) {
+    std::memcpy(data + y * row_size, frame.PixelData() + y * frame.WidthStep(),
+                row_size);
+  }
+}
+
+}  // namespace
+
+// Publishes the IN stream to SharedMemoryStreamSourceCalculators in other
+// processes, or other graphs, through a ring of packets in shared memory.
+// The packets, and the timestamp bounds, are read by every source of the
+// channel, which lets several independent graphs process one camera feed
+// without encoding it or copying it through sockets.
+//
+// The pixels of ImageFrames and CPU Images, and the buffers of CPU Tensors,
+// are copied once into the channel, where the sources can use them without
+// copying. Proto messages, and the types registered with serialization
+// functions, are serialized into the channel. Other types are not supported.
+//
+// A packet waits for the BACKPRESSURE sources to read the packet written
+// num_slots packets before it, and for all the sources to release the
+// packets they keep from the slot it takes. A packet that waits longer than
+// publish_timeout_ms is dropped. Sources only read the packets published
+// after they connect, unless the sink waits for them with min_sources.
+//
+// Only supported on POSIX systems other than Android.
+//
+// Inputs:
+//   IN - The packets to publish.
+//
+// Example config:
+// node {
+//   calculator: "SharedMemoryStreamSinkCalculator"
+//   input_stream: "IN:input_video"
+//   options {
+//     [mediapipe.SharedMemoryStreamSinkCalculatorOptions.ext] {
+//       channel: "front_camera"
+//     }
+//   }
+// }
+class SharedMemoryStreamSinkCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Tag(kInTag).SetAny();
+    cc->SetProcessTimestampBounds(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    const auto& options =
+        cc->Options<SharedMemoryStreamSinkCalculatorOptions>();
+    RET_CHECK(!options.channel().empty()) << "A channel is required.";
+    RET_CHECK_GT(options.slot_size_bytes(), 0);
+    publish_timeout_ = options.publish_timeout_ms() > 0
+                           ? absl::Milliseconds(options.publish_timeout_ms())
+                           : absl::InfiniteDuration();
+    min_sources_ = options.min_sources();
+    ASSIGN_OR_RETURN(ring_,
+                     SharedMemoryRing::Create(options.channel(),
+                                              options.num_slots(),
+                                              options.slot_size_bytes()));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    // Sources only read what is published after they connect.
+    while (ring_->NumReaders() < min_sources_) {
+      absl::SleepFor(kReadTimeout);
+    }
+    min_sources_ = 0;
+
+    const Packet& packet = cc->Inputs().Tag(kInTag).Value();
+    if (packet.IsEmpty()) {
+      const Timestamp bound = cc->InputTimestamp().NextAllowedInStream();
+      return Publish(kTimestampBoundEntry, bound, /*description=*/"",
+                     /*data_size=*/0, /*write_data=*/nullptr);
+    }
+
+    RecordedPacket description;
+    size_t data_size = 0;
+    std::function<void(uint8_t*)> write_data;
+    if (packet.ValidateAsType<ImageFrame>().ok()) {
+      const ImageFrame& frame = packet.Get<ImageFrame>();
+      description.set_encoding(RecordedPacket::IMAGE_FRAME);
+      data_size = DescribeImageFrame(frame, &description);
+      write_data = [&frame](uint8_t* data) { WriteImageFrame(frame, data); };
+    } else if (packet.ValidateAsType<Image>().ok() &&
+               !packet.Get<Image>().UsesGpu()) {
+      const ImageFrame& frame =
+          *packet.Get<Image>().GetImageFrameSharedPtr();
+      description.set_encoding(RecordedPacket::IMAGE);
+      data_size = DescribeImageFrame(frame, &description);
+      write_data = [&frame](uint8_t* data) { WriteImageFrame(frame, data); };
+    } else if (packet.ValidateAsType<Tensor>().ok()) {
+      const Tensor& tensor = packet.Get<Tensor>();
+      description.set_encoding(RecordedPacket::TENSOR);
+      description.set_format(static_cast<int>(tensor.element_type()));
+      for (int dim : tensor.shape().dims) description.add_dims(dim);
+      description.set_quantization_scale(
+          tensor.quantization_parameters().scale);
+      description.set_quantization_zero_point(
+          tensor.quantization_parameters().zero_point);
+      data_size = tensor.bytes();
+      write_data = [&tensor](uint8_t* data) {
+        auto view = tensor.GetCpuReadView();
+        std::memcpy(data, view.buffer<uint8_t>(), tensor.bytes());
+      };
+    } else {
+      MP_RETURN_IF_ERROR(tool::EncodeRecordedPacket(packet, &description));
+    }
+    return Publish(kPacketEntry, packet.Timestamp(),
+                   description.SerializeAsString(), data_size, write_data);
+  }
+
+  absl::Status Close(CalculatorContext* cc) override {
+    if (ring_) ring_->CloseWriter();
+    ring_.reset();
+    return absl::OkStatus();
+  }
+
+ private:
+  absl::Status Publish(EntryKind kind, Timestamp timestamp,
+                       const std::string& description, size_t data_size,
+                       const std::function<void(uint8_t*)>& write_data) {
+    const size_t size = DataOffset(description.size()) + data_size;
+    if (size > ring_->slot_size()) {
+      return absl::ResourceExhaustedError(
+          absl::StrCat("A packet of ", size, " bytes doesn't fit in the ",
+                       ring_->slot_size(),
+                       " bytes of slot_size_bytes of the channel."));
+    }
+    absl::StatusOr<absl::Span<uint8_t>> slot =
+        ring_->BeginWrite(publish_timeout_);
+    if (absl::IsDeadlineExceeded(slot.status())) {
+      LOG_EVERY_N(WARNING, 100) << "Dropping a packet: " << slot.status();
+      return absl::OkStatus();
+    }
+    MP_RETURN_IF_ERROR(slot.status());
+    const uint32_t description_size = description.size();
+    std::memcpy(slot->data(), &description_size, sizeof(description_size));
+    std::memcpy(slot->data() + sizeof(description_size), description.data(),
+                description.size());
+    if (write_data) write_data(slot->data() + DataOffset(description.size()));
+    SharedMemoryRing::EntryInfo info;
+    info.kind = kind;
+    info.timestamp = timestamp.Value();
+    info.size = size;
+    ring_->EndWrite(info);
+    return absl::OkStatus();
+  }
+
+  std::shared_ptr<SharedMemoryRing> ring_;
+  absl::Duration publish_timeout_;
+  int min_sources_ = 0;
+};
+REGISTER_CALCULATOR(SharedMemoryStreamSinkCalculator);
+
+// Outputs the packets and timestamp bounds published by the
+// SharedMemoryStreamSinkCalculator of a channel, usually in another process.
+// Waits for the sink to create the channel, and closes OUT once the sink
+// closed the channel, or its process was killed, and all its packets were
+// read.
+//
+// With the BACKPRESSURE policy, every packet is output, and the sink waits
+// for the source to read it. With LATEST_ONLY, the source skips to the most
+// recent packet each time it reads, and the sink never waits for it.
+//
+// Unless copy_frames is set, ImageFrames and CPU Images point into the
+// channel, and keep their slot from being written until they are released.
+// Downstream calculators should thus not keep more than num_slots - 1 frames
+// at a time, which would stall the sink. Tensors are copied.
+//
+// Outputs:
+//   OUT - The packets of the channel.
+//
+// Example config:
+// node {
+//   calculator: "SharedMemoryStreamSourceCalculator"
+//   output_stream: "OUT:input_video"
+//   options {
+//     [mediapipe.SharedMemoryStreamSourceCalculatorOptions.ext] {
+//       channel: "front_camera"
+//       policy: LATEST_ONLY
+//     }
+//   }
+// }
+class SharedMemoryStreamSourceCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Outputs().Tag(kOutTag).SetAny();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<SharedMemoryStreamSourceCalculatorOptions>();
+    RET_CHECK(!options_.channel().empty()) << "A channel is required.";
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (!ring_) {
+      absl::StatusOr<std::shared_ptr<SharedMemoryRing>> ring =
+          SharedMemoryRing::Open(options_.channel());
+      if (absl::IsNotFound(ring.status()) ||
+          absl::IsUnavailable(ring.status())) {
+        // The sink hasn't created the channel yet.
+        absl::SleepFor(kReadTimeout);
+        return absl::OkStatus();
+      }
+      MP_RETURN_IF_ERROR(ring.status());
+      ring_ = *std::move(ring);
+      ASSIGN_OR_RETURN(
+          reader_,
+          ring_->AddReader(
+              options_.policy() ==
+                      SharedMemoryStreamSourceCalculatorOptions::LATEST_ONLY
+                  ? SharedMemoryRing::ReadPolicy::kLatestOnly
+                  : SharedMemoryRing::ReadPolicy::kBlocking));
+    }
+
+    SharedMemoryRing::Entry entry;
+    if (!ring_->Read(reader_, kReadTimeout, &entry)) {
+      if (ring_->IsDone(reader_)) return tool::StatusStop();
+      return absl::OkStatus();
+    }
+    absl::Status status = OutputEntry(entry, cc);
+    if (!entry_released_) ring_->Release(reader_, entry);
+    return status;
+  }
+
+  absl::Status Close(CalculatorContext* cc) override {
+    // Frames still held keep the ring, and release their slots when deleted.
+    if (ring_) ring_->RemoveReader(reader_);
+    ring_.reset();
+    return absl::OkStatus();
+  }
+
+ private:
+  absl::Status OutputEntry(const SharedMemoryRing::Entry& entry,
+                           CalculatorContext* cc) {
+    entry_released_ = false;
+    OutputStream& output = cc->Outputs().Tag(kOutTag);
+    const Timestamp timestamp =
+        Timestamp::CreateNoErrorChecking(entry.info.timestamp);
+    // Entries behind the output bound can only have been read after the
+    // sink restarted.
+    if (timestamp < output.NextTimestampBound()) return absl::OkStatus();
+    if (entry.info.kind == kTimestampBoundEntry) {
+      output.SetNextTimestampBound(timestamp);
+      return absl::OkStatus();
+    }
+    RET_CHECK_EQ(entry.info.kind, kPacketEntry);
+
+    uint32_t description_size;
+    RET_CHECK_GE(entry.info.size, sizeof(description_size));
+    std::memcpy(&description_size, entry.data, sizeof(description_size));
+    const size_t data_offset = DataOffset(description_size);
+    RET_CHECK_LE(data_offset, entry.info.size);
+    RecordedPacket description;
+    RET_CHECK(description.ParseFromArray(entry.data + sizeof(description_size),
+                                         description_size));
+    const uint8_t* data = entry.data + data_offset;
+    const size_t data_size = entry.info.size - data_offset;
+
+    Packet packet;
+    switch (description.encoding()) {
+      case RecordedPacket::IMAGE_FRAME: {
+        ASSIGN_OR_RETURN(std::unique_ptr<ImageFrame> frame,
+                         ReadImageFrame(description, entry, data, data_size));
+        packet = Adopt(frame.release());
+        break;
+      }
+      case RecordedPacket::IMAGE: {
+        ASSIGN_OR_RETURN(std::unique_ptr<ImageFrame> frame,
+                         ReadImageFrame(description, entry, data, data_size));
+        packet =
+            MakePacket<Image>(std::shared_ptr<ImageFrame>(std::move(frame)));
+        break;
+      }
+      case RecordedPacket::TENSOR: {
+        // Tensors own their CPU buffers, so they are copied.
+        description.set_data(data, data_size);
+        ASSIGN_OR_RETURN(packet, tool::DecodeRecordedPacket(description));
+        break;
+      }
+      default: {
+        ASSIGN_OR_RETURN(packet, tool::DecodeRecordedPacket(description));
+        break;
+      }
+    }
+    output.AddPacket(packet.At(timestamp));
+    return absl::OkStatus();
+  }
+
+  // Returns the frame of `entry`, which points into the entry, and releases
+  // it when deleted, unless copy_frames is set.
+  absl::StatusOr<std::unique_ptr<ImageFrame>> ReadImageFrame(
+      const RecordedPacket& description, const SharedMemoryRing::Entry& entry,
+      const uint8_t* data, size_t data_size) {
+    RET_CHECK(ImageFormat::Format_IsValid(description.format()));
+    RET_CHECK_EQ(description.dims_size(), 2);
+    const auto format = static_cast<ImageFormat::Format>(description.format());
+    const int width = description.dims(0);
+    const int height = description.dims(1);
+    const int row_size = width *
+                         ImageFrame::NumberOfChannelsForFormat(format) *
+                         ImageFrame::ByteDepthForFormat(format);
+    RET_CHECK_EQ(data_size, static_cast<size_t>(row_size) * height);
+    auto frame = std::make_unique<ImageFrame>();
+    if (options_.copy_frames()) {
+      frame->CopyPixelData(format, width, height, data,
+                           ImageFrame::kDefaultAlignmentBoundary);
+      return frame;
+    }
+    frame->AdoptPixelData(
+        format, width, height, row_size, const_cast<uint8_t*>(data),
+        [ring = ring_, reader = reader_, entry](uint8_t*) {
+          ring->Release(reader, entry);
+        });
+    entry_released_ = true;
+    return frame;
+  }
+
+  SharedMemoryStreamSourceCalculatorOptions options_;
+  std::shared_ptr<SharedMemoryRing> ring_;
+  int reader_ = -1;
+  // Whether the entry being output is released by the frame pointing into it.
+  bool entry_released_ = false;
+};
+REGISTER_CALCULATOR(SharedMemoryStreamSourceCalculator);
+
+}  // namespace mediapipe
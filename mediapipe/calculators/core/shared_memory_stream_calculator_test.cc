@@ -0,0 +1,247 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::string ChannelName(const std::string& test_name) {
+  return absl::StrCat("shared_memory_stream_test_", getpid(), "_", test_name);
+}
+
+// Collects the packets and timestamp bounds of a stream, as the values
+// returned by `read` for packets, and -1 for bounds.
+template <typename T>
+class StreamCollector {
+ public:
+  absl::Status Observe(CalculatorGraph* graph, const std::string& stream,
+                       std::function<int(const T&)> read) {
+    return graph->ObserveOutputStream(
+        stream,
+        [this, read](const Packet& packet) {
+          absl::MutexLock lock(&mutex_);
+          timestamps_.push_back(packet.Timestamp().Value());
+          values_.push_back(packet.IsEmpty() ? -1 : read(packet.Get<T>()));
+          return absl::OkStatus();
+        },
+        /*observe_timestamp_bounds=*/true);
+  }
+
+  std::vector<int64_t> timestamps() {
+    absl::MutexLock lock(&mutex_);
+    return timestamps_;
+  }
+  std::vector<int> values() {
+    absl::MutexLock lock(&mutex_);
+    return values_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<int64_t> timestamps_;
+  std::vector<int> values_;
+};
+
+CalculatorGraphConfig SinkGraph(const std::string& channel,
+                                const std::string& options) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(absl::StrReplaceAll(
+      R"pb(
+        input_stream: "in"
+        node {
+          calculator: "SharedMemoryStreamSinkCalculator"
+          input_stream: "IN:in"
+          options {
+            [mediapipe.SharedMemoryStreamSinkCalculatorOptions.ext] {
+              channel: "$channel"
+              min_sources: 1
+              $options
+            }
+          }
+        }
+      )pb",
+      {{"$channel", channel}, {"$options", options}}));
+}
+
+CalculatorGraphConfig SourceGraph(const std::string& channel,
+                                  const std::string& options) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(absl::StrReplaceAll(
+      R"pb(
+        output_stream: "out"
+        node {
+          calculator: "SharedMemoryStreamSourceCalculator"
+          output_stream: "OUT:out"
+          options {
+            [mediapipe.SharedMemoryStreamSourceCalculatorOptions.ext] {
+              channel: "$channel"
+              $options
+            }
+          }
+        }
+      )pb",
+      {{"$channel", channel}, {"$options", options}}));
+}
+
+Packet MakeFrame(int value, int64_t timestamp) {
+  auto frame = std::make_unique<ImageFrame>(ImageFormat::SRGB, 5, 3);
+  frame->SetToZero();
+  for (int y = 0; y < frame->Height(); ++y) {
+    frame->MutablePixelData()[y * frame->WidthStep()] = value;
+  }
+  return Adopt(frame.release()).At(Timestamp(timestamp));
+}
+
+// Returns the value of a frame made by MakeFrame(), or -1 if its other pixels
+// aren't zero.
+int ReadFrame(const ImageFrame& frame) {
+  for (int y = 0; y < frame.Height(); ++y) {
+    const uint8* row = frame.PixelData() + y * frame.WidthStep();
+    for (int x = 1; x < frame.Width() * 3; ++x) {
+      if (row[x] != 0 || row[0] != frame.PixelData()[0]) return -1;
+    }
+  }
+  return frame.PixelData()[0];
+}
+
+TEST(SharedMemoryStreamCalculatorTest, PublishesFramesAndBounds) {
+  const std::string channel = ChannelName("frames");
+  CalculatorGraph source_graph(SourceGraph(channel, ""));
+  StreamCollector<ImageFrame> collector;
+  MP_ASSERT_OK(collector.Observe(&source_graph, "out", ReadFrame));
+  MP_ASSERT_OK(source_graph.StartRun({}));
+
+  CalculatorGraph sink_graph(SinkGraph(channel, "num_slots: 2"));
+  MP_ASSERT_OK(sink_graph.StartRun({}));
+  for (int i = 0; i < 5; ++i) {
+    MP_ASSERT_OK(sink_graph.AddPacketToInputStream("in", MakeFrame(i * 10, i)));
+  }
+  MP_ASSERT_OK(sink_graph.SetInputStreamTimestampBound("in", Timestamp(10)));
+  // Lets the sink publish the bound before the stream closes.
+  MP_ASSERT_OK(sink_graph.WaitUntilIdle());
+  MP_ASSERT_OK(sink_graph.CloseAllInputStreams());
+  MP_ASSERT_OK(sink_graph.WaitUntilDone());
+  MP_ASSERT_OK(source_graph.WaitUntilDone());
+
+  EXPECT_THAT(collector.values(), ElementsAre(0, 10, 20, 30, 40, -1));
+  EXPECT_THAT(collector.timestamps(), ElementsAre(0, 1, 2, 3, 4, 9));
+}
+
+TEST(SharedMemoryStreamCalculatorTest, PublishesTensorsAndProtos) {
+  const std::string tensor_channel = ChannelName("tensors");
+  const std::string rect_channel = ChannelName("rects");
+  CalculatorGraph tensor_source_graph(SourceGraph(tensor_channel, ""));
+  StreamCollector<Tensor> tensor_collector;
+  MP_ASSERT_OK(tensor_collector.Observe(
+      &tensor_source_graph, "out", [](const Tensor& tensor) {
+        EXPECT_EQ(tensor.shape().dims, std::vector<int>({1, 2}));
+        auto view = tensor.GetCpuReadView();
+        return static_cast<int>(view.buffer<float>()[1]);
+      }));
+  CalculatorGraph rect_source_graph(SourceGraph(rect_channel, ""));
+  StreamCollector<NormalizedRect> rect_collector;
+  MP_ASSERT_OK(rect_collector.Observe(
+      &rect_source_graph, "out",
+      [](const NormalizedRect& rect) { return rect.rect_id(); }));
+  MP_ASSERT_OK(tensor_source_graph.StartRun({}));
+  MP_ASSERT_OK(rect_source_graph.StartRun({}));
+
+  CalculatorGraph tensor_sink_graph(SinkGraph(tensor_channel, ""));
+  CalculatorGraph rect_sink_graph(SinkGraph(rect_channel, ""));
+  MP_ASSERT_OK(tensor_sink_graph.StartRun({}));
+  MP_ASSERT_OK(rect_sink_graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape({1, 2}));
+    {
+      auto view = tensor.GetCpuWriteView();
+      view.buffer<float>()[0] = 0;
+      view.buffer<float>()[1] = i;
+    }
+    MP_ASSERT_OK(tensor_sink_graph.AddPacketToInputStream(
+        "in", MakePacket<Tensor>(std::move(tensor)).At(Timestamp(i))));
+    NormalizedRect rect;
+    rect.set_x_center(0.5f);
+    rect.set_y_center(0.5f);
+    rect.set_width(1.0f);
+    rect.set_height(1.0f);
+    rect.set_rect_id(i);
+    MP_ASSERT_OK(rect_sink_graph.AddPacketToInputStream(
+        "in", MakePacket<NormalizedRect>(rect).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(tensor_sink_graph.CloseAllInputStreams());
+  MP_ASSERT_OK(rect_sink_graph.CloseAllInputStreams());
+  MP_ASSERT_OK(tensor_sink_graph.WaitUntilDone());
+  MP_ASSERT_OK(rect_sink_graph.WaitUntilDone());
+  MP_ASSERT_OK(tensor_source_graph.WaitUntilDone());
+  MP_ASSERT_OK(rect_source_graph.WaitUntilDone());
+
+  EXPECT_THAT(tensor_collector.values(), ElementsAre(0, 1, 2));
+  EXPECT_THAT(rect_collector.values(), ElementsAre(0, 1, 2));
+  EXPECT_THAT(rect_collector.timestamps(), ElementsAre(0, 1, 2));
+}
+
+TEST(SharedMemoryStreamCalculatorTest, LatestOnlySourceSkipsPackets) {
+  const std::string channel = ChannelName("latest");
+  CalculatorGraph source_graph(
+      SourceGraph(channel, "policy: LATEST_ONLY copy_frames: true"));
+  std::vector<std::shared_ptr<ImageFrame>> frames;
+  MP_ASSERT_OK(source_graph.ObserveOutputStream(
+      "out", [&frames](const Packet& packet) {
+        // Copied frames can be kept without stalling the sink.
+        frames.push_back(std::make_shared<ImageFrame>());
+        frames.back()->CopyFrom(packet.Get<ImageFrame>(), 1);
+        return absl::OkStatus();
+      }));
+  MP_ASSERT_OK(source_graph.StartRun({}));
+
+  // The sink doesn't wait for LATEST_ONLY sources.
+  CalculatorGraph sink_graph(SinkGraph(channel, "num_slots: 2"));
+  MP_ASSERT_OK(sink_graph.StartRun({}));
+  for (int i = 0; i < 50; ++i) {
+    MP_ASSERT_OK(sink_graph.AddPacketToInputStream("in", MakeFrame(i, i)));
+  }
+  MP_ASSERT_OK(sink_graph.CloseAllInputStreams());
+  MP_ASSERT_OK(sink_graph.WaitUntilDone());
+  MP_ASSERT_OK(source_graph.WaitUntilDone());
+
+  ASSERT_FALSE(frames.empty());
+  EXPECT_LE(frames.size(), 50);
+  int last_value = -1;
+  for (const auto& frame : frames) {
+    const int value = ReadFrame(*frame);
+    EXPECT_GT(value, last_value);
+    last_value = value;
+  }
+  EXPECT_EQ(last_value, 49);
+}
+
+}  // namespace
+}  // namespace mediapipe
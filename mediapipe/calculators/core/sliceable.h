@@ -0,0 +1,38 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_CORE_SLICEABLE_H_
+#define MEDIAPIPE_CALCULATORS_CORE_SLICEABLE_H_
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mediapipe {
+
+// True for the types T with a static T::CreateSlice(std::shared_ptr<const T>)
+// returning a T that shares the content of the given element, like Tensor.
+// Such elements can be output without copying them or moving them out of
+// their packet, when the packet is shared with other consumers.
+template <typename T, typename = void>
+struct IsSliceable : std::false_type {};
+
+template <typename T>
+struct IsSliceable<T, std::void_t<decltype(T::CreateSlice(
+                          std::declval<std::shared_ptr<const T>>()))>>
+    : std::true_type {};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_CORE_SLICEABLE_H_
@@ -15,9 +15,11 @@
 #ifndef MEDIAPIPE_CALCULATORS_CORE_SPLIT_VECTOR_CALCULATOR_H_
 #define MEDIAPIPE_CALCULATORS_CORE_SPLIT_VECTOR_CALCULATOR_H_
 
+#include <memory>
 #include <type_traits>
 #include <vector>
 
+#include "mediapipe/calculators/core/sliceable.h"
 #include "mediapipe/calculators/core/split_vector_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/canonical_errors.h"
@@ -103,6 +105,7 @@ class SplitVectorCalculator : public CalculatorBase {
         }
       }
     }
+    cc->SetInlineSafe(true);
 
     return absl::OkStatus();
   }
@@ -179,7 +182,14 @@ class SplitVectorCalculator : public CalculatorBase {
   absl::Status ProcessMovableElements(CalculatorContext* cc) {
     absl::StatusOr<std::unique_ptr<std::vector<U>>> input_status =
         cc->Inputs().Index(0).Value().Consume<std::vector<U>>();
-    if (!input_status.ok()) return input_status.status();
+    if (!input_status.ok()) {
+      // Other consumers share the input, but sliceable elements can still be
+      // output without copies.
+      if constexpr (IsSliceable<U>::value) {
+        return ProcessSlicedElements<U>(cc);
+      }
+      return input_status.status();
+    }
     std::unique_ptr<std::vector<U>> input_vector =
         std::move(input_status).value();
     RET_CHECK_GE(input_vector->size(), max_range_end_);
@@ -222,6 +232,46 @@ class SplitVectorCalculator : public CalculatorBase {
     return absl::InternalError("Cannot move non-movable elements.");
   }
 
+  // Outputs slices sharing the elements of the input vector, which stays
+  // alive as long as the slices.
+  template <typename U>
+  absl::Status ProcessSlicedElements(CalculatorContext* cc) {
+    std::shared_ptr<const std::vector<U>> input_vector =
+        SharedPtrWithPacket<std::vector<U>>(cc->Inputs().Index(0).Value());
+    RET_CHECK_GE(input_vector->size(), max_range_end_);
+    auto slice = [&input_vector](int i) {
+      return U::CreateSlice(
+          std::shared_ptr<const U>(input_vector, &(*input_vector)[i]));
+    };
+
+    if (combine_outputs_) {
+      auto output = absl::make_unique<std::vector<U>>();
+      output->reserve(total_elements_);
+      for (const auto& range : ranges_) {
+        for (int j = range.first; j < range.second; ++j) {
+          output->push_back(slice(j));
+        }
+      }
+      cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
+    } else {
+      for (int i = 0; i < ranges_.size(); ++i) {
+        if (element_only_) {
+          cc->Outputs().Index(i).AddPacket(
+              MakePacket<U>(slice(ranges_[i].first)).At(cc->InputTimestamp()));
+          continue;
+        }
+        auto output = absl::make_unique<std::vector<U>>();
+        output->reserve(ranges_[i].second - ranges_[i].first);
+        for (int j = ranges_[i].first; j < ranges_[i].second; ++j) {
+          output->push_back(slice(j));
+        }
+        cc->Outputs().Index(i).Add(output.release(), cc->InputTimestamp());
+      }
+    }
+
+    return absl::OkStatus();
+  }
+
  private:
   static absl::Status checkRangesDontOverlap(
       const ::mediapipe::SplitVectorCalculatorOptions& options) {
@@ -16,8 +16,11 @@
 #define MEDIAPIPE_CALCULATORS_IMAGE_AFFINE_TRANSFORMATION_H_
 
 #include <array>
+#include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "mediapipe/framework/port/status_macros.h"
 
 namespace mediapipe {
 
@@ -47,6 +50,21 @@ class AffineTransformation {
                                         const std::array<float, 16>& matrix,
                                         const Size& output_size,
                                         BorderMode border_mode) = 0;
+
+    // Transforms input into one output per matrix in @matrices, as Run does.
+    // Runners override this to read the input once for all the outputs.
+    virtual absl::StatusOr<std::vector<OutputT>> RunBatch(
+        const InputT& input, const std::vector<std::array<float, 16>>& matrices,
+        const Size& output_size, BorderMode border_mode) {
+      std::vector<OutputT> outputs;
+      outputs.reserve(matrices.size());
+      for (const auto& matrix : matrices) {
+        ASSIGN_OR_RETURN(OutputT output,
+                         Run(input, matrix, output_size, border_mode));
+        outputs.push_back(std::move(output));
+      }
+      return outputs;
+    }
   };
 };
 
@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "Eigen/Core"
 #include "Eigen/Geometry"
@@ -199,8 +200,8 @@ class GlTextureWarpAffineRunner
           auto output_texture = gl_helper_->CreateDestinationTexture(
               size.width, size.height, input.format());
 
-          MP_RETURN_IF_ERROR(
-              RunInternal(input_texture, matrix, border_mode, &output_texture));
+          MP_RETURN_IF_ERROR(RunInternal(input_texture, {matrix}, border_mode,
+                                         {&output_texture}));
           gpu_buffer = output_texture.GetFrame<GpuBuffer>();
           return absl::OkStatus();
         }));
@@ -208,18 +209,44 @@ class GlTextureWarpAffineRunner
     return gpu_buffer;
   }
 
+  absl::StatusOr<std::vector<std::unique_ptr<GpuBuffer>>> RunBatch(
+      const GpuBuffer& input,
+      const std::vector<std::array<float, 16>>& matrices,
+      const AffineTransformation::Size& size,
+      AffineTransformation::BorderMode border_mode) override {
+    std::vector<std::unique_ptr<GpuBuffer>> gpu_buffers;
+    MP_RETURN_IF_ERROR(gl_helper_->RunInGlContext(
+        [this, &input, &matrices, &size, &border_mode,
+         &gpu_buffers]() -> absl::Status {
+          auto input_texture = gl_helper_->CreateSourceTexture(input);
+          std::vector<GlTexture> output_textures;
+          std::vector<GlTexture*> outputs;
+          output_textures.reserve(matrices.size());
+          for (int i = 0; i < matrices.size(); ++i) {
+            output_textures.push_back(gl_helper_->CreateDestinationTexture(
+                size.width, size.height, input.format()));
+            outputs.push_back(&output_textures.back());
+          }
+          MP_RETURN_IF_ERROR(
+              RunInternal(input_texture, matrices, border_mode, outputs));
+          for (auto& output_texture : output_textures) {
+            gpu_buffers.push_back(output_texture.GetFrame<GpuBuffer>());
+          }
+          return absl::OkStatus();
+        }));
+
+    return gpu_buffers;
+  }
+
+  // Draws @texture into each of @outputs with the matching matrix. The input
+  // texture and program are set up once for all the draws.
   absl::Status RunInternal(const GlTexture& texture,
-                           const std::array<float, 16>& matrix,
+                           const std::vector<std::array<float, 16>>& matrices,
                            AffineTransformation::BorderMode border_mode,
-                           GlTexture* output) {
+                           const std::vector<GlTexture*>& outputs) {
+    RET_CHECK_EQ(matrices.size(), outputs.size());
     glDisable(GL_DEPTH_TEST);
     glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
-    glViewport(0, 0, output->width(), output->height());
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, output->name());
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                           output->name(), 0);
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(texture.target(), texture.name());
@@ -256,25 +283,6 @@ class GlTextureWarpAffineRunner
     }
     glUseProgram(program->id);
 
-    Eigen::Matrix<float, 4, 4, Eigen::RowMajor> eigen_mat(matrix.data());
-    if (IsMatrixVerticalFlipNeeded(gpu_origin_)) {
-      // @matrix describes affine transformation in terms of TOP LEFT origin, so
-      // in some cases/on some platforms an extra flipping should be done before
-      // and after.
-      const Eigen::Matrix<float, 4, 4, Eigen::RowMajor> flip_y(
-          {{1.0f, 0.0f, 0.0f, 0.0f},
-           {0.0f, -1.0f, 0.0f, 1.0f},
-           {0.0f, 0.0f, 1.0f, 0.0f},
-           {0.0f, 0.0f, 0.0f, 1.0f}});
-      eigen_mat = flip_y * eigen_mat * flip_y;
-    }
-
-    // If GL context is ES2, then GL_FALSE must be used for 'transpose'
-    // GLboolean in glUniformMatrix4fv, or else INVALID_VALUE error is reported.
-    // Hence, transposing the matrix and always passing transposed.
-    eigen_mat.transposeInPlace();
-    glUniformMatrix4fv(program->matrix_id, 1, GL_FALSE, eigen_mat.data());
-
     // vao
     glBindVertexArray(vao_);
 
@@ -288,8 +296,36 @@ class GlTextureWarpAffineRunner
     glEnableVertexAttribArray(kAttribTexturePosition);
     glVertexAttribPointer(kAttribTexturePosition, 2, GL_FLOAT, 0, 0, nullptr);
 
-    // draw
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    for (int i = 0; i < outputs.size(); ++i) {
+      GlTexture* output = outputs[i];
+      glViewport(0, 0, output->width(), output->height());
+      glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                             GL_TEXTURE_2D, output->name(), 0);
+
+      Eigen::Matrix<float, 4, 4, Eigen::RowMajor> eigen_mat(
+          matrices[i].data());
+      if (IsMatrixVerticalFlipNeeded(gpu_origin_)) {
+        // The matrix describes affine transformation in terms of TOP LEFT
+        // origin, so in some cases/on some platforms an extra flipping should
+        // be done before and after.
+        const Eigen::Matrix<float, 4, 4, Eigen::RowMajor> flip_y(
+            {{1.0f, 0.0f, 0.0f, 0.0f},
+             {0.0f, -1.0f, 0.0f, 1.0f},
+             {0.0f, 0.0f, 1.0f, 0.0f},
+             {0.0f, 0.0f, 0.0f, 1.0f}});
+        eigen_mat = flip_y * eigen_mat * flip_y;
+      }
+
+      // If GL context is ES2, then GL_FALSE must be used for 'transpose'
+      // GLboolean in glUniformMatrix4fv, or else INVALID_VALUE error is
+      // reported. Hence, transposing the matrix and always passing
+      // transposed.
+      eigen_mat.transposeInPlace();
+      glUniformMatrix4fv(program->matrix_id, 1, GL_FALSE, eigen_mat.data());
+
+      // draw
+      glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
 
     // Resetting to MediaPipe texture param defaults.
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
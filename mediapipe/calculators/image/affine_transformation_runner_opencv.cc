@@ -15,6 +15,8 @@
 #include "mediapipe/calculators/image/affine_transformation_runner_opencv.h"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
@@ -42,10 +44,72 @@ cv::BorderTypes GetBorderModeForOpenCv(
 class OpenCvRunner
     : public AffineTransformation::Runner<ImageFrame, ImageFrame> {
  public:
+  explicit OpenCvRunner(ImageFrameMultiPool* pool) : pool_(pool) {}
+
   absl::StatusOr<ImageFrame> Run(
       const ImageFrame& input, const std::array<float, 16>& matrix,
       const AffineTransformation::Size& size,
       AffineTransformation::BorderMode border_mode) override {
+    ImageFrame out_image = CreateOutput(input, size);
+    cv::Mat out_mat = formats::MatView(&out_image);
+    cv::warpAffine(formats::MatView(&input), out_mat,
+                   GetOpenCvTransform(input, matrix, size),
+                   cv::Size(out_mat.cols, out_mat.rows),
+                   /*flags=*/cv::INTER_LINEAR | cv::WARP_INVERSE_MAP,
+                   GetBorderModeForOpenCv(border_mode));
+    return out_image;
+  }
+
+  absl::StatusOr<std::vector<ImageFrame>> RunBatch(
+      const ImageFrame& input,
+      const std::vector<std::array<float, 16>>& matrices,
+      const AffineTransformation::Size& size,
+      AffineTransformation::BorderMode border_mode) override {
+    // The outputs are allocated up front, then warped in parallel from the
+    // same view of the input.
+    const cv::Mat in_mat = formats::MatView(&input);
+    std::vector<ImageFrame> outputs;
+    std::vector<cv::Mat> transforms;
+    outputs.reserve(matrices.size());
+    transforms.reserve(matrices.size());
+    for (const auto& matrix : matrices) {
+      outputs.push_back(CreateOutput(input, size));
+      transforms.push_back(GetOpenCvTransform(input, matrix, size));
+    }
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(outputs.size())),
+        [&](const cv::Range& range) {
+          for (int i = range.start; i < range.end; ++i) {
+            cv::Mat out_mat = formats::MatView(&outputs[i]);
+            cv::warpAffine(in_mat, out_mat, transforms[i],
+                           cv::Size(out_mat.cols, out_mat.rows),
+                           /*flags=*/cv::INTER_LINEAR | cv::WARP_INVERSE_MAP,
+                           GetBorderModeForOpenCv(border_mode));
+          }
+        });
+    return outputs;
+  }
+
+ private:
+  ImageFrame CreateOutput(const ImageFrame& input,
+                          const AffineTransformation::Size& size) {
+    ImageFrame out_image;
+    if (pool_) {
+      // The moved frame keeps the pooled pixel data until it is destroyed.
+      out_image = std::move(
+          *pool_->GetUniqueBuffer(size.width, size.height, input.Format()));
+    } else {
+      out_image.Reset(input.Format(), size.width, size.height,
+                      ImageFrame::kDefaultAlignmentBoundary);
+    }
+    return out_image;
+  }
+
+  // Returns the 2x3 matrix for cv::warpAffine with WARP_INVERSE_MAP that maps
+  // output pixels to input pixels as @matrix does in relative coordinates.
+  static cv::Mat GetOpenCvTransform(const ImageFrame& input,
+                                    const std::array<float, 16>& matrix,
+                                    const AffineTransformation::Size& size) {
     // OpenCV warpAffine works in absolute coordinates, so the transfom (which
     // accepts and produces relative coordinates) should be adjusted to first
     // normalize coordinates and then scale them.
@@ -127,8 +191,6 @@ class OpenCvRunner
     cv::Matx44f transform_absolute =
         adjust_src_coordinate * transform * adjust_dst_coordinate;
 
-    cv::Mat in_mat = formats::MatView(&input);
-
     cv::Mat cv_affine_transform(2, 3, CV_32F);
     cv_affine_transform.at<float>(0, 0) = transform_absolute.val[0];
     cv_affine_transform.at<float>(0, 1) = transform_absolute.val[1];
@@ -136,25 +198,18 @@ class OpenCvRunner
     cv_affine_transform.at<float>(1, 0) = transform_absolute.val[4];
     cv_affine_transform.at<float>(1, 1) = transform_absolute.val[5];
     cv_affine_transform.at<float>(1, 2) = transform_absolute.val[7];
-
-    ImageFrame out_image(input.Format(), size.width, size.height);
-    cv::Mat out_mat = formats::MatView(&out_image);
-
-    cv::warpAffine(in_mat, out_mat, cv_affine_transform,
-                   cv::Size(out_mat.cols, out_mat.rows),
-                   /*flags=*/cv::INTER_LINEAR | cv::WARP_INVERSE_MAP,
-                   GetBorderModeForOpenCv(border_mode));
-
-    return out_image;
+    return cv_affine_transform;
   }
+
+  ImageFrameMultiPool* pool_;
 };
 
 }  // namespace
 
 absl::StatusOr<
     std::unique_ptr<AffineTransformation::Runner<ImageFrame, ImageFrame>>>
-CreateAffineTransformationOpenCvRunner() {
-  return absl::make_unique<OpenCvRunner>();
+CreateAffineTransformationOpenCvRunner(ImageFrameMultiPool* pool) {
+  return absl::make_unique<OpenCvRunner>(pool);
 }
 
 }  // namespace mediapipe
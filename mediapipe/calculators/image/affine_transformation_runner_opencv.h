@@ -20,12 +20,15 @@
 #include "absl/status/statusor.h"
 #include "mediapipe/calculators/image/affine_transformation.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
 
 namespace mediapipe {
 
+// Creates a runner whose output frames are taken from `pool` if it is not
+// null, and allocated anew otherwise. The pool must outlive the runner.
 absl::StatusOr<
     std::unique_ptr<AffineTransformation::Runner<ImageFrame, ImageFrame>>>
-CreateAffineTransformationOpenCvRunner();
+CreateAffineTransformationOpenCvRunner(ImageFrameMultiPool* pool = nullptr);
 
 }  // namespace mediapipe
 
@@ -17,6 +17,7 @@
 
 #include "absl/strings/str_replace.h"
 #include "mediapipe/calculators/image/bilateral_filter_calculator.pb.h"
+#include "mediapipe/calculators/image/guided_filter.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
@@ -29,6 +30,7 @@
 #include "mediapipe/framework/port/vector.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
+#include "mediapipe/calculators/image/guided_filter_gl.h"
 #include "mediapipe/gpu/gl_calculator_helper.h"
 #include "mediapipe/gpu/gl_simple_shaders.h"
 #include "mediapipe/gpu/shader_util.h"
@@ -56,7 +58,8 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //   IMAGE: ImageFrame containing input image - Grayscale or RGB only.
 //   IMAGE_GPU: GpuBuffer containing input image - Grayscale, RGB or RGBA.
 //
-//   GUIDE (optional): ImageFrame guide image used to filter IMAGE. (N/A).
+//   GUIDE (optional): ImageFrame guide image used to filter IMAGE.
+//                     (GUIDED filter_type only.)
 //   GUIDE_GPU (optional): GpuBuffer guide image used to filter IMAGE_GPU.
 //
 // Output:
@@ -68,6 +71,8 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //   sigma_space: Pixel radius: use (sigma_space*2+1)x(sigma_space*2+1) window.
 //                This should be set based on output image pixel space.
 //   sigma_color: Color variance: normalized [0-1] color difference allowed.
+//   filter_type: BILATERAL (default), or GUIDED for a guided filter whose
+//                cost does not depend on sigma_space.
 //
 // Notes:
 //   * When GUIDE is present, the output image is same size as GUIDE image;
@@ -75,7 +80,9 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //   * On GPU the kernel window is subsampled by approximately sqrt(sigma_space)
 //     i.e. the step size is ~sqrt(sigma_space),
 //     prioritizing performance > quality.
-//   * TODO: Add CPU path for joint filter.
+//   * With the GUIDED filter, the guide is reduced to its luminance and, on
+//     CPU, must be the same size as IMAGE.
+//   * TODO: Add CPU path for joint bilateral filter.
 //
 class BilateralFilterCalculator : public CalculatorBase {
  public:
@@ -99,15 +106,18 @@ class BilateralFilterCalculator : public CalculatorBase {
   mediapipe::BilateralFilterCalculatorOptions options_;
   float sigma_color_ = -1.f;
   float sigma_space_ = -1.f;
+  bool use_guided_filter_ = false;
+  float guided_filter_epsilon_ = -1.f;
 
   bool use_gpu_ = false;
   bool gpu_initialized_ = false;
 #if !MEDIAPIPE_DISABLE_GPU
   mediapipe::GlCalculatorHelper gpu_helper_;
   GLuint program_ = 0;
-  GLuint vao_;
-  GLuint vbo_[2];  // vertex storage
-#endif             // !MEDIAPIPE_DISABLE_GPU
+  GLuint vao_ = 0;
+  GLuint vbo_[2] = {0, 0};  // vertex storage
+  GuidedFilterGl guided_filter_gl_;
+#endif  // !MEDIAPIPE_DISABLE_GPU
 };
 REGISTER_CALCULATOR(BilateralFilterCalculator);
 
@@ -185,6 +195,12 @@ absl::Status BilateralFilterCalculator::Open(CalculatorContext* cc) {
   sigma_space_ = options_.sigma_space();
   CHECK_GE(sigma_color_, 0.0);
   CHECK_GE(sigma_space_, 0.0);
+  use_guided_filter_ = options_.filter_type() ==
+                       mediapipe::BilateralFilterCalculatorOptions::GUIDED;
+  if (use_guided_filter_) {
+    RET_CHECK_GT(sigma_color_, 0.0) << "GUIDED filter needs a sigma_color.";
+    guided_filter_epsilon_ = sigma_color_ * sigma_color_;
+  }
   if (!use_gpu_) sigma_color_ *= 255.0;
 
   if (use_gpu_) {
@@ -219,6 +235,7 @@ absl::Status BilateralFilterCalculator::Close(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
   gpu_helper_.RunInGlContext([this] {
     if (program_) glDeleteProgram(program_);
+    guided_filter_gl_.GlTeardown();
     if (vao_) glDeleteVertexArrays(1, &vao_);
     if (vbo_[0]) glDeleteBuffers(2, vbo_);
     program_ = 0;
@@ -240,7 +257,8 @@ absl::Status BilateralFilterCalculator::RenderCpu(CalculatorContext* cc) {
   auto input_mat = mediapipe::formats::MatView(&input_frame);
 
   // Only 1 or 3 channel images supported by OpenCV.
-  if (!(input_mat.channels() == 1 || input_mat.channels() == 3)) {
+  if (!use_guided_filter_ &&
+      !(input_mat.channels() == 1 || input_mat.channels() == 3)) {
     return absl::InternalError(
         "CPU filtering supports only 1 or 3 channel input images.");
   }
@@ -250,7 +268,17 @@ absl::Status BilateralFilterCalculator::RenderCpu(CalculatorContext* cc) {
   const bool has_guide_image = cc->Inputs().HasTag(kInputGuideTag) &&
                                !cc->Inputs().Tag(kInputGuideTag).IsEmpty();
 
-  if (has_guide_image) {
+  if (use_guided_filter_) {
+    auto output_mat = mediapipe::formats::MatView(output_frame.get());
+    cv::Mat guide_mat = input_mat;
+    if (has_guide_image) {
+      guide_mat = mediapipe::formats::MatView(
+          &cc->Inputs().Tag(kInputGuideTag).Get<ImageFrame>());
+    }
+    MP_RETURN_IF_ERROR(GuidedFilter(guide_mat, input_mat,
+                                    static_cast<int>(sigma_space_),
+                                    guided_filter_epsilon_, output_mat));
+  } else if (has_guide_image) {
     // cv::jointBilateralFilter() is in contrib module 'ximgproc'.
     return absl::UnimplementedError(
         "CPU joint filtering support is not implemented yet.");
@@ -280,7 +308,24 @@ absl::Status BilateralFilterCalculator::RenderGpu(CalculatorContext* cc) {
   const bool has_guide_image = cc->Inputs().HasTag(kInputGuideTagGpu);
 
   // Setup textures and Update image in GPU shader.
-  if (has_guide_image) {
+  if (use_guided_filter_) {
+    mediapipe::GlTexture guide_texture = input_texture;
+    if (has_guide_image) {
+      if (cc->Inputs().Tag(kInputGuideTagGpu).IsEmpty()) {
+        return absl::OkStatus();
+      }
+      guide_texture = gpu_helper_.CreateSourceTexture(
+          cc->Inputs().Tag(kInputGuideTagGpu).Get<mediapipe::GpuBuffer>());
+    }
+    output_texture = gpu_helper_.CreateDestinationTexture(
+        guide_texture.width(), guide_texture.height(),
+        mediapipe::GpuBufferFormat::kBGRA32);
+    MP_RETURN_IF_ERROR(guided_filter_gl_.GlRender(
+        &gpu_helper_, input_texture, guide_texture,
+        static_cast<int>(sigma_space_), guided_filter_epsilon_,
+        /*alpha_from_red=*/false, output_texture));
+    guide_texture.Release();
+  } else if (has_guide_image) {
     if (cc->Inputs().Tag(kInputGuideTagGpu).IsEmpty()) return absl::OkStatus();
     // joint bilateral filter
     glUseProgram(program_);
@@ -347,6 +392,10 @@ void BilateralFilterCalculator::GlRender(CalculatorContext* cc) {
 
 absl::Status BilateralFilterCalculator::GlSetup(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
+  if (use_guided_filter_) {
+    return guided_filter_gl_.GlSetup();
+  }
+
   const GLint attr_location[NUM_ATTRIBUTES] = {
       ATTRIB_VERTEX,
       ATTRIB_TEXTURE_POSITION,
@@ -15,6 +15,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
@@ -138,6 +139,7 @@ absl::Status ColorConvertCalculator::GetContract(CalculatorContract* cc) {
     cc->Outputs().Tag(kBgraOutTag).Set<ImageFrame>();
   }
 
+  UseImageFrameMultiPool(cc);
   return absl::OkStatus();
 }
 
@@ -147,8 +149,8 @@ absl::Status ColorConvertCalculator::ConvertAndOutput(
     CalculatorContext* cc) {
   const cv::Mat& input_mat =
       formats::MatView(&cc->Inputs().Tag(input_tag).Get<ImageFrame>());
-  std::unique_ptr<ImageFrame> output_frame(
-      new ImageFrame(output_format, input_mat.cols, input_mat.rows));
+  std::unique_ptr<ImageFrame> output_frame =
+      AllocateImageFrame(cc, output_format, input_mat.cols, input_mat.rows);
   cv::Mat output_mat = formats::MatView(output_frame.get());
   cv::cvtColor(input_mat, output_mat, open_cv_convert_code);
 
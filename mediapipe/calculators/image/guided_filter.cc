@@ -0,0 +1,93 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/guided_filter.h"
+
+#include <vector>
+
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+
+namespace {
+
+float NormalizationScale(const cv::Mat& mat) {
+  return mat.depth() == CV_8U ? 1.0f / 255.0f : 1.0f;
+}
+
+// Box mean over a (2 * radius + 1)^2 window. cv::boxFilter keeps running
+// sums, so this is O(1) per pixel and vectorized.
+cv::Mat BoxMean(const cv::Mat& src, int radius) {
+  cv::Mat dst;
+  cv::boxFilter(src, dst, CV_32F, cv::Size(2 * radius + 1, 2 * radius + 1),
+                cv::Point(-1, -1), /*normalize=*/true, cv::BORDER_REFLECT);
+  return dst;
+}
+
+}  // namespace
+
+absl::Status GuidedFilter(const cv::Mat& guide, const cv::Mat& input,
+                          int radius, float epsilon, cv::Mat& output) {
+  RET_CHECK(guide.size() == input.size());
+  RET_CHECK(guide.depth() == CV_8U || guide.depth() == CV_32F);
+  RET_CHECK(input.depth() == CV_8U || input.depth() == CV_32F);
+  RET_CHECK_GE(radius, 0);
+  RET_CHECK_GT(epsilon, 0.0f);
+
+  cv::Mat guide_f;
+  guide.convertTo(guide_f, CV_32F, NormalizationScale(guide));
+  cv::Mat luminance;
+  switch (guide_f.channels()) {
+    case 1:
+      luminance = guide_f;
+      break;
+    case 3:
+      cv::cvtColor(guide_f, luminance, cv::COLOR_RGB2GRAY);
+      break;
+    case 4:
+      cv::cvtColor(guide_f, luminance, cv::COLOR_RGBA2GRAY);
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          "Guide image must have 1, 3 or 4 channels.");
+  }
+
+  const cv::Mat mean_guide = BoxMean(luminance, radius);
+  const cv::Mat variance_guide =
+      BoxMean(luminance.mul(luminance), radius) - mean_guide.mul(mean_guide);
+  const cv::Mat denominator = variance_guide + epsilon;
+
+  const float input_scale = NormalizationScale(input);
+  cv::Mat input_f;
+  input.convertTo(input_f, CV_32F, input_scale);
+  std::vector<cv::Mat> channels;
+  cv::split(input_f, channels);
+  for (cv::Mat& channel : channels) {
+    // q = mean(a) * I + mean(b), with a and b the per-window linear
+    // coefficients mapping the guide to the input.
+    const cv::Mat mean_input = BoxMean(channel, radius);
+    const cv::Mat covariance = BoxMean(luminance.mul(channel), radius) -
+                               mean_guide.mul(mean_input);
+    const cv::Mat a = covariance / denominator;
+    const cv::Mat b = mean_input - a.mul(mean_guide);
+    channel = BoxMean(a, radius).mul(luminance) + BoxMean(b, radius);
+  }
+  cv::merge(channels, input_f);
+  input_f.convertTo(output, input.type(), 1.0f / input_scale);
+
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
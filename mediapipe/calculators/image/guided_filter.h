@@ -0,0 +1,40 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_IMAGE_GUIDED_FILTER_H_
+#define MEDIAPIPE_CALCULATORS_IMAGE_GUIDED_FILTER_H_
+
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+// Smooths `input` while preserving the edges of `guide`, using the guided
+// filter of He et al. ("Guided Image Filtering", TPAMI 2013). It only needs
+// box means, which are computed with running sums, so the cost per pixel does
+// not depend on `radius`.
+//
+// `guide` must be 1, 3 (RGB) or 4 (RGBA) channels and is reduced to its
+// luminance; `input` may have any number of channels, each filtered
+// independently. Both must have the same size and be 8-bit, in which case
+// values are normalized to [0, 1], or 32-bit float. `epsilon` is the
+// regularization in normalized units: edges whose variance is well below it
+// are smoothed out, so it plays the role of sigma_color^2 of a bilateral
+// filter. `output` gets the size and type of `input`, and may be `input`.
+absl::Status GuidedFilter(const cv::Mat& guide, const cv::Mat& input,
+                          int radius, float epsilon, cv::Mat& output);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_IMAGE_GUIDED_FILTER_H_
@@ -0,0 +1,220 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/guided_filter_gl.h"
+
+#include <algorithm>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/gpu/gl_simple_shaders.h"
+#include "mediapipe/gpu/gpu_buffer_format.h"
+#include "mediapipe/gpu/shader_util.h"
+
+namespace mediapipe {
+
+namespace {
+
+enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
+
+// Half width, in taps, of the window sampled on the subsampled grid. The
+// grid spacing is chosen so that the window spans the requested radius.
+constexpr int kGridRadius = 2;
+
+constexpr char kLuminance[] = R"(
+    float luminance(vec3 color) {
+      return dot(color, vec3(0.299, 0.587, 0.114));
+    }
+)";
+
+// Writes the window means of (p, I) or, if `second_moments` is 1, of
+// (I * p, I * I), where p is the input and I the guide luminance.
+constexpr char kMomentsShader[] = R"(
+    DEFAULT_PRECISION(highp, float)
+
+    in vec2 sample_coordinate;
+    uniform sampler2D input_frame;
+    uniform sampler2D guide_frame;
+    uniform vec2 step_size;
+    uniform float second_moments;
+
+    void main() {
+      vec4 sum = vec4(0.0);
+      for (int i = -$radius; i <= $radius; ++i) {
+        for (int j = -$radius; j <= $radius; ++j) {
+          vec2 uv = sample_coordinate + vec2(float(j), float(i)) * step_size;
+          vec3 p = texture2D(input_frame, uv).rgb;
+          float guide = luminance(texture2D(guide_frame, uv).rgb);
+          sum += mix(vec4(p, guide), vec4(guide * p, guide * guide),
+                     second_moments);
+        }
+      }
+      gl_FragColor = sum / float(($radius * 2 + 1) * ($radius * 2 + 1));
+    }
+)";
+
+// Solves the per-window linear model q = a * I + b from the upsampled means
+// and applies it to the full resolution guide.
+constexpr char kFilterShader[] = R"(
+    DEFAULT_PRECISION(highp, float)
+
+    in vec2 sample_coordinate;
+    uniform sampler2D guide_frame;
+    uniform sampler2D first_moments;
+    uniform sampler2D second_moments;
+    uniform float epsilon;
+    uniform float alpha_from_red;
+
+    void main() {
+      vec4 first = texture2D(first_moments, sample_coordinate);
+      vec4 second = texture2D(second_moments, sample_coordinate);
+      float variance = max(second.a - first.a * first.a, 0.0);
+      vec3 a = (second.rgb - first.a * first.rgb) / (variance + epsilon);
+      vec3 b = first.rgb - a * first.a;
+      float guide = luminance(texture2D(guide_frame, sample_coordinate).rgb);
+      vec3 q = a * guide + b;
+      gl_FragColor = vec4(q, mix(1.0, q.r, alpha_from_red));
+    }
+)";
+
+}  // namespace
+
+absl::Status GuidedFilterGl::GlSetup() {
+  const GLint attr_location[NUM_ATTRIBUTES] = {
+      ATTRIB_VERTEX,
+      ATTRIB_TEXTURE_POSITION,
+  };
+  const GLchar* attr_name[NUM_ATTRIBUTES] = {
+      "position",
+      "texture_coordinate",
+  };
+
+  const std::string moments_src = absl::StrCat(
+      kMediaPipeFragmentShaderPreamble, kLuminance,
+      absl::StrReplaceAll(kMomentsShader,
+                          {{"$radius", std::to_string(kGridRadius)}}));
+  GlhCreateProgram(kBasicVertexShader, moments_src.c_str(), NUM_ATTRIBUTES,
+                   &attr_name[0], attr_location, &moments_program_);
+  RET_CHECK(moments_program_) << "Problem initializing the moments program.";
+  glUseProgram(moments_program_);
+  glUniform1i(glGetUniformLocation(moments_program_, "input_frame"), 1);
+  glUniform1i(glGetUniformLocation(moments_program_, "guide_frame"), 2);
+  moments_step_unif_ = glGetUniformLocation(moments_program_, "step_size");
+  moments_second_unif_ =
+      glGetUniformLocation(moments_program_, "second_moments");
+
+  const std::string filter_src = absl::StrCat(
+      kMediaPipeFragmentShaderPreamble, kLuminance, kFilterShader);
+  GlhCreateProgram(kBasicVertexShader, filter_src.c_str(), NUM_ATTRIBUTES,
+                   &attr_name[0], attr_location, &filter_program_);
+  RET_CHECK(filter_program_) << "Problem initializing the filter program.";
+  glUseProgram(filter_program_);
+  glUniform1i(glGetUniformLocation(filter_program_, "guide_frame"), 2);
+  glUniform1i(glGetUniformLocation(filter_program_, "first_moments"), 3);
+  glUniform1i(glGetUniformLocation(filter_program_, "second_moments"), 4);
+  filter_epsilon_unif_ = glGetUniformLocation(filter_program_, "epsilon");
+  filter_alpha_from_red_unif_ =
+      glGetUniformLocation(filter_program_, "alpha_from_red");
+  glUseProgram(0);
+
+  glGenVertexArrays(1, &vao_);
+  glGenBuffers(2, vbo_);
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_[0]);
+  glBufferData(GL_ARRAY_BUFFER, 4 * 2 * sizeof(GLfloat), kBasicSquareVertices,
+               GL_STATIC_DRAW);
+  glEnableVertexAttribArray(ATTRIB_VERTEX);
+  glVertexAttribPointer(ATTRIB_VERTEX, 2, GL_FLOAT, 0, 0, nullptr);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_[1]);
+  glBufferData(GL_ARRAY_BUFFER, 4 * 2 * sizeof(GLfloat), kBasicTextureVertices,
+               GL_STATIC_DRAW);
+  glEnableVertexAttribArray(ATTRIB_TEXTURE_POSITION);
+  glVertexAttribPointer(ATTRIB_TEXTURE_POSITION, 2, GL_FLOAT, 0, 0, nullptr);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+
+  return absl::OkStatus();
+}
+
+absl::Status GuidedFilterGl::GlRender(GlCalculatorHelper* helper,
+                                      const GlTexture& input,
+                                      const GlTexture& guide, int radius,
+                                      float epsilon, bool alpha_from_red,
+                                      const GlTexture& output) {
+  RET_CHECK(moments_program_ && filter_program_) << "GlSetup() not called.";
+
+  // Grid spacing in output pixels, and the size of the subsampled grid.
+  const int spacing = std::max(1, (radius + kGridRadius - 1) / kGridRadius);
+  const int grid_width = (output.width() + spacing - 1) / spacing;
+  const int grid_height = (output.height() + spacing - 1) / spacing;
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, input.name());
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, guide.name());
+
+  GlTexture moments[2];
+  glUseProgram(moments_program_);
+  glUniform2f(moments_step_unif_,
+              static_cast<float>(spacing) / output.width(),
+              static_cast<float>(spacing) / output.height());
+  for (int i = 0; i < 2; ++i) {
+    moments[i] = helper->CreateDestinationTexture(
+        grid_width, grid_height, GpuBufferFormat::kRGBAHalf64);
+    helper->BindFramebuffer(moments[i]);
+    glUniform1f(moments_second_unif_, static_cast<float>(i));
+    DrawQuad();
+  }
+
+  helper->BindFramebuffer(output);
+  glUseProgram(filter_program_);
+  glUniform1f(filter_epsilon_unif_, epsilon);
+  glUniform1f(filter_alpha_from_red_unif_, alpha_from_red ? 1.0f : 0.0f);
+  for (int i = 0; i < 2; ++i) {
+    glActiveTexture(GL_TEXTURE3 + i);
+    glBindTexture(GL_TEXTURE_2D, moments[i].name());
+  }
+  DrawQuad();
+
+  for (GLenum unit : {GL_TEXTURE4, GL_TEXTURE3, GL_TEXTURE2, GL_TEXTURE1}) {
+    glActiveTexture(unit);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+  glUseProgram(0);
+  for (GlTexture& texture : moments) texture.Release();
+
+  return absl::OkStatus();
+}
+
+void GuidedFilterGl::DrawQuad() {
+  glBindVertexArray(vao_);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  glBindVertexArray(0);
+}
+
+void GuidedFilterGl::GlTeardown() {
+  if (moments_program_) glDeleteProgram(moments_program_);
+  if (filter_program_) glDeleteProgram(filter_program_);
+  if (vao_) glDeleteVertexArrays(1, &vao_);
+  if (vbo_[0]) glDeleteBuffers(2, vbo_);
+  moments_program_ = 0;
+  filter_program_ = 0;
+  vao_ = 0;
+  vbo_[0] = 0;
+  vbo_[1] = 0;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,63 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_IMAGE_GUIDED_FILTER_GL_H_
+#define MEDIAPIPE_CALCULATORS_IMAGE_GUIDED_FILTER_GL_H_
+
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/gpu/gl_base.h"
+#include "mediapipe/gpu/gl_calculator_helper.h"
+
+namespace mediapipe {
+
+// GPU counterpart of GuidedFilter() (see guided_filter.h).
+//
+// The window means are taken over a grid subsampled by about radius / 2 and
+// bilinearly upsampled ("Fast Guided Filter", He & Sun 2015), so every output
+// pixel costs a fixed number of texture fetches whatever the radius. The
+// intermediate means are stored as half floats, so `epsilon` should not be
+// much below 1e-3.
+//
+// All methods must be called within the GL context.
+class GuidedFilterGl {
+ public:
+  absl::Status GlSetup();
+
+  // Filters the RGB channels of `input` with the luminance of `guide` into
+  // `output`. The three textures are sampled bilinearly and may have
+  // different sizes; `radius` is in output pixels. If `alpha_from_red` is
+  // set, the filtered red channel is also written to alpha (the mask
+  // convention of the segmentation calculators), otherwise alpha is 1.
+  absl::Status GlRender(GlCalculatorHelper* helper, const GlTexture& input,
+                        const GlTexture& guide, int radius, float epsilon,
+                        bool alpha_from_red, const GlTexture& output);
+
+  void GlTeardown();
+
+ private:
+  void DrawQuad();
+
+  GLuint moments_program_ = 0;
+  GLint moments_step_unif_ = -1;
+  GLint moments_second_unif_ = -1;
+  GLuint filter_program_ = 0;
+  GLint filter_epsilon_unif_ = -1;
+  GLint filter_alpha_from_red_unif_ = -1;
+  GLuint vao_ = 0;
+  GLuint vbo_[2] = {0, 0};
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_IMAGE_GUIDED_FILTER_GL_H_
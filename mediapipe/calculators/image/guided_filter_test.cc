@@ -0,0 +1,70 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/guided_filter.h"
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(GuidedFilterTest, RemovesNoiseAndKeepsGuideEdges) {
+  // Step edge in the middle of the guide.
+  cv::Mat guide(32, 32, CV_32FC1, cv::Scalar(0.0f));
+  guide.colRange(16, 32).setTo(cv::Scalar(1.0f));
+  // Input follows the guide, with +-0.05 checkerboard noise.
+  cv::Mat input = guide.clone();
+  for (int y = 0; y < input.rows; ++y) {
+    for (int x = 0; x < input.cols; ++x) {
+      input.at<float>(y, x) += (x + y) % 2 ? 0.05f : -0.05f;
+    }
+  }
+
+  cv::Mat output;
+  MP_ASSERT_OK(GuidedFilter(guide, input, /*radius=*/4, /*epsilon=*/1e-3f,
+                            output));
+
+  ASSERT_EQ(output.type(), CV_32FC1);
+  ASSERT_EQ(output.size(), input.size());
+  EXPECT_LT(cv::norm(output, guide, cv::NORM_INF), 0.02);
+}
+
+TEST(GuidedFilterTest, KeepsEightBitTypeAndFiltersInPlace) {
+  cv::Mat guide(16, 16, CV_8UC3);
+  cv::randu(guide, cv::Scalar::all(0), cv::Scalar::all(255));
+  cv::Mat input(16, 16, CV_8UC3, cv::Scalar(128, 64, 32));
+  const cv::Mat expected = input.clone();
+
+  // A constant input is left unchanged whatever the guide.
+  MP_ASSERT_OK(GuidedFilter(guide, input, /*radius=*/3, /*epsilon=*/1e-2f,
+                            input));
+
+  ASSERT_EQ(input.type(), CV_8UC3);
+  EXPECT_LE(cv::norm(input, expected, cv::NORM_INF), 1.0);
+}
+
+TEST(GuidedFilterTest, RejectsMismatchedSizes) {
+  cv::Mat guide(16, 16, CV_8UC1, cv::Scalar(0));
+  cv::Mat input(8, 8, CV_8UC1, cv::Scalar(0));
+  cv::Mat output;
+  EXPECT_FALSE(GuidedFilter(guide, input, /*radius=*/2, /*epsilon=*/1e-2f,
+                            output)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
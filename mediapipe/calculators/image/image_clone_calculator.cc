@@ -37,7 +37,9 @@ using GpuBuffer = mediapipe::GpuBuffer;
 //
 // The clone shares ownership of the input pixel data on the existing storage.
 // If the target storage is different from the existing one, then the data is
-// further copied there.
+// further copied there. Pixel data are never copied on the same storage: a
+// consumer modifying the clone through Image::GetMutableImageFrameSharedPtr()
+// gets its own copy of them only then (copy-on-write).
 //
 // Example usage:
 // node {
@@ -66,6 +68,7 @@ class ImageCloneCalculator : public Node {
 #else
     MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
 #endif  // MEDIAPIPE_DISABLE_GPU
+    cc->SetPure(true);
     return absl::OkStatus();
   }
 
@@ -79,27 +82,10 @@ class ImageCloneCalculator : public Node {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    std::unique_ptr<Image> output;
-    const auto& input = *kIn(cc);
-    if (input.UsesGpu()) {
-#if !MEDIAPIPE_DISABLE_GPU
-      // Create an output Image that co-owns the underlying texture buffer as
-      // the input Image.
-      output = std::make_unique<Image>(input.GetGpuBuffer());
-#endif  // !MEDIAPIPE_DISABLE_GPU
-    } else {
-      // Make a copy of the input packet to co-own the input Image.
-      mediapipe::Packet* packet_copy_ptr =
-          new mediapipe::Packet(kIn(cc).packet());
-      // Create an output Image that (co-)owns a new ImageFrame that points to
-      // the same pixel data as the input Image and also owns the packet
-      // copy. As a result, the output Image indirectly co-owns the input
-      // Image. This ensures a correct life span of the shared pixel data.
-      output = std::make_unique<Image>(std::make_unique<mediapipe::ImageFrame>(
-          input.image_format(), input.width(), input.height(), input.step(),
-          const_cast<uint8*>(input.GetImageFrameSharedPtr()->PixelData()),
-          [packet_copy_ptr](uint8*) { delete packet_copy_ptr; }));
-    }
+    // The output Image co-owns the underlying buffer of the input Image, and
+    // is known to share it. Wrapping the input pixel data in a new ImageFrame
+    // instead would let a consumer of the output modify them in place.
+    auto output = std::make_unique<Image>(*kIn(cc));
 
     if (output_on_gpu_) {
 #if !MEDIAPIPE_DISABLE_GPU
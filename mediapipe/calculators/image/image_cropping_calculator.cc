@@ -19,6 +19,7 @@
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -64,6 +65,7 @@ absl::Status ImageCroppingCalculator::GetContract(CalculatorContract* cc) {
     RET_CHECK(cc->Outputs().HasTag(kImageTag));
     cc->Inputs().Tag(kImageTag).Set<ImageFrame>();
     cc->Outputs().Tag(kImageTag).Set<ImageFrame>();
+    UseImageFrameMultiPool(cc);
   }
 #if !MEDIAPIPE_DISABLE_GPU
   if (cc->Inputs().HasTag(kImageGpuTag)) {
@@ -254,16 +256,13 @@ absl::Status ImageCroppingCalculator::RenderCpu(CalculatorContext* cc) {
   cv::Mat dst_points = cv::Mat(4, 2, CV_32F, dst_corners);
   cv::Mat projection_matrix =
       cv::getPerspectiveTransform(src_points, dst_points);
-  cv::Mat cropped_image;
-  cv::warpPerspective(input_mat, cropped_image, projection_matrix,
+  std::unique_ptr<ImageFrame> output_frame = AllocateImageFrame(
+      cc, input_img.Format(), output_width, output_height);
+  cv::Mat output_mat = formats::MatView(output_frame.get());
+  cv::warpPerspective(input_mat, output_mat, projection_matrix,
                       cv::Size(output_width, output_height),
                       /* flags = */ 0,
                       /* borderMode = */ border_mode);
-
-  std::unique_ptr<ImageFrame> output_frame(new ImageFrame(
-      input_img.Format(), cropped_image.cols, cropped_image.rows));
-  cv::Mat output_mat = formats::MatView(output_frame.get());
-  cropped_image.copyTo(output_mat);
   cc->Outputs().Tag(kImageTag).Add(output_frame.release(),
                                    cc->InputTimestamp());
   return absl::OkStatus();
@@ -69,6 +69,7 @@ class ImagePropertiesCalculator : public Node {
                  1)
         << "One and only one of IMAGE, IMAGE_CPU and IMAGE_GPU input is "
            "expected.";
+    cc->SetPure(true);
 
     return absl::OkStatus();
   }
@@ -18,6 +18,7 @@
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/video_stream_header.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
@@ -289,6 +290,10 @@ absl::Status ImageTransformationCalculator::GetContract(
 #if !MEDIAPIPE_DISABLE_GPU
     MP_RETURN_IF_ERROR(GlCalculatorHelper::UpdateContract(cc));
 #endif  // !MEDIAPIPE_DISABLE_GPU
+  } else {
+    UseImageFrameMultiPool(cc);
+    // The GPU path only issues GL commands on the GL context's thread.
+    cc->SetWorkload(CalculatorContract::Workload::kHeavy);
   }
 
   return absl::OkStatus();
@@ -525,19 +530,16 @@ absl::Status ImageTransformationCalculator::RenderCpu(CalculatorContext* cc) {
     }
   }
 
-  cv::Mat flipped_mat;
+  std::unique_ptr<ImageFrame> output_frame =
+      AllocateImageFrame(cc, format, output_width, output_height);
+  cv::Mat output_mat = formats::MatView(output_frame.get());
   if (flip_horizontally_ || flip_vertically_) {
     const int flip_code =
         flip_horizontally_ && flip_vertically_ ? -1 : flip_horizontally_;
-    cv::flip(rotated_mat, flipped_mat, flip_code);
+    cv::flip(rotated_mat, output_mat, flip_code);
   } else {
-    flipped_mat = rotated_mat;
+    rotated_mat.copyTo(output_mat);
   }
-
-  std::unique_ptr<ImageFrame> output_frame(
-      new ImageFrame(format, output_width, output_height));
-  cv::Mat output_mat = formats::MatView(output_frame.get());
-  flipped_mat.copyTo(output_mat);
   cc->Outputs()
       .Tag(kImageFrameTag)
       .Add(output_frame.release(), cc->InputTimestamp());
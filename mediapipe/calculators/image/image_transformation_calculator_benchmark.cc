@@ -0,0 +1,83 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+
+#include "mediapipe/calculators/image/image_transformation_calculator.pb.h"
+#include "mediapipe/framework/benchmarks/calculator_benchmark.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/gpu/scale_mode.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumPackets = 16;
+
+// Returns a config resizing images to 256x256 with `scale_mode`.
+CalculatorGraphConfig::Node MakeNodeConfig(ScaleMode::Mode scale_mode) {
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "ImageTransformationCalculator"
+        input_stream: "IMAGE:image"
+        output_stream: "IMAGE:transformed_image"
+        options {
+          [mediapipe.ImageTransformationCalculatorOptions.ext] {
+            output_width: 256
+            output_height: 256
+          }
+        }
+      )pb");
+  node_config.mutable_options()
+      ->MutableExtension(ImageTransformationCalculatorOptions::ext)
+      ->set_scale_mode(scale_mode);
+  return node_config;
+}
+
+// Adds SRGB images of state.range(0) x state.range(1) pixels.
+absl::Status AddImages(benchmark::State& state, CalculatorRunner* runner) {
+  const int width = state.range(0);
+  const int height = state.range(1);
+  for (int t = 0; t < kNumPackets; ++t) {
+    auto image = std::make_unique<ImageFrame>(ImageFormat::SRGB, width, height);
+    for (int y = 0; y < height; ++y) {
+      uint8_t* row = image->MutablePixelData() + y * image->WidthStep();
+      for (int x = 0; x < width * 3; ++x) row[x] = (x + y + t) & 0xff;
+    }
+    runner->MutableInputs()->Tag("IMAGE").packets.push_back(
+        Adopt(image.release()).At(Timestamp(t)));
+  }
+  return absl::OkStatus();
+}
+
+MEDIAPIPE_CALCULATOR_BENCHMARK(BM_ImageTransformationStretch,
+                               MakeNodeConfig(ScaleMode::STRETCH), AddImages)
+    ->Args({640, 480})
+    ->Args({1280, 720});
+
+MEDIAPIPE_CALCULATOR_BENCHMARK(BM_ImageTransformationFit,
+                               MakeNodeConfig(ScaleMode::FIT), AddImages)
+    ->Args({640, 480})
+    ->Args({1280, 720});
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
@@ -0,0 +1,611 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/image/mask_compositing_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+#if !MEDIAPIPE_DISABLE_GPU
+#include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gl_simple_shaders.h"
+#include "mediapipe/gpu/shader_util.h"
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
+#if !MEDIAPIPE_DISABLE_OPENCV
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_opencv.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#endif  // !MEDIAPIPE_DISABLE_OPENCV
+
+namespace mediapipe {
+
+namespace {
+constexpr char kImageTag[] = "IMAGE";
+constexpr char kMaskTag[] = "MASK";
+constexpr char kPreviousMaskTag[] = "MASK_PREVIOUS";
+constexpr char kBackgroundTag[] = "BACKGROUND";
+constexpr char kSmoothedMaskTag[] = "MASK_SMOOTHED";
+
+enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
+
+using Options = MaskCompositingCalculatorOptions;
+
+#if !MEDIAPIPE_DISABLE_OPENCV
+// Same uncertainty-based mix as SegmentationSmoothingCalculator.
+inline float MixWithPrevious(float new_mask_value, float prev_mask_value,
+                             float ratio) {
+  const float c1 = 5.68842;
+  const float c2 = -0.748699;
+  const float c3 = -57.8051;
+  const float c4 = 291.309;
+  const float c5 = -624.717;
+  const float t = new_mask_value - 0.5f;
+  const float x = t * t;
+  const float uncertainty =
+      1.0f - std::min(1.0f, x * (c1 + x * (c2 + x * (c3 + x * (c4 + x * c5)))));
+  return new_mask_value +
+         (prev_mask_value - new_mask_value) * (uncertainty * ratio);
+}
+
+// Returns the mask as 1-channel float in [0, 1].
+absl::StatusOr<cv::Mat> FloatMask(const Image& image) {
+  auto view = formats::MatView(&image);
+  cv::Mat mask = *view;
+  if (mask.channels() > 1) {
+    cv::Mat first_channel;
+    cv::extractChannel(mask, first_channel, 0);
+    mask = first_channel;
+  }
+  if (mask.depth() == CV_32F) return mask.clone();
+  RET_CHECK_EQ(mask.depth(), CV_8U) << "Unsupported mask format.";
+  cv::Mat float_mask;
+  mask.convertTo(float_mask, CV_32F, 1.0 / 255.0);
+  return float_mask;
+}
+#endif  // !MEDIAPIPE_DISABLE_OPENCV
+
+}  // namespace
+
+// Composites a segmentation mask onto an image in a single pass, replacing
+// chains such as SegmentationSmoothingCalculator -> RecolorCalculator ->
+// SetAlphaCalculator that each read and write a full frame.
+//
+// The mask goes through the stages of MaskCompositingCalculatorOptions:
+// temporal mix with the previous mask, threshold/feather, inversion, then is
+// applied to the image (recolor or background blend) and optionally written
+// to alpha. On GPU all stages run in one fragment shader; on CPU in one
+// multithreaded pass over the image rows, after the mask is mixed and scaled
+// to the image size.
+//
+// Inputs:
+//   IMAGE - Image to composite onto. [ImageFormat::SRGB/SRGBA, or any
+//           RGB(A) GpuBuffer]
+//   MASK - Image containing the current mask, in the first channel.
+//          [ImageFormat::VEC32F1/GRAY8, or any GpuBuffer] Any size.
+//   MASK_PREVIOUS (optional) - The previous MASK_SMOOTHED output, for the
+//                              temporal mix. Same format as MASK.
+//   BACKGROUND (optional) - Image shown where the mask is not set, for the
+//                           BLEND_BACKGROUND operation. Any size.
+//   * All inputs must be on the same device as IMAGE.
+//
+// Outputs:
+//   IMAGE - The composited image. [ImageFormat::SRGB, or SRGBA if the input
+//           is SRGBA or write_alpha is set; GpuBufferFormat::kBGRA32]
+//   MASK_SMOOTHED (optional) - The mask after the temporal mix, at MASK
+//                              resolution, to be fed back as MASK_PREVIOUS.
+//                              On GPU this costs one mask-sized pass.
+//
+// Example:
+//  node {
+//    calculator: "MaskCompositingCalculator"
+//    input_stream: "IMAGE:image"
+//    input_stream: "MASK:mask"
+//    input_stream: "MASK_PREVIOUS:previous_mask"
+//    output_stream: "IMAGE:recolored_image"
+//    output_stream: "MASK_SMOOTHED:smoothed_mask"
+//    options: {
+//      [mediapipe.MaskCompositingCalculatorOptions.ext] {
+//        combine_with_previous_ratio: 0.9
+//        operation: RECOLOR
+//        color { r: 0 g: 0 b: 255 }
+//      }
+//    }
+//  }
+//
+class MaskCompositingCalculator : public CalculatorBase {
+ public:
+  MaskCompositingCalculator() = default;
+
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  absl::Status RenderCpu(CalculatorContext* cc);
+  absl::Status RenderGpu(CalculatorContext* cc);
+  absl::Status GlSetup(CalculatorContext* cc);
+  void GlRender();
+
+  bool HasPreviousMask(CalculatorContext* cc) const;
+  bool HasBackground(CalculatorContext* cc) const;
+
+  Options options_;
+  // Color of the options, in [0, 1].
+  float color_[3] = {0.0f, 0.0f, 0.0f};
+
+  bool gpu_initialized_ = false;
+#if !MEDIAPIPE_DISABLE_GPU
+  mediapipe::GlCalculatorHelper gpu_helper_;
+  GLuint composite_program_ = 0;
+  GLuint mask_program_ = 0;
+  GLuint vao_ = 0;
+  GLuint vbo_[2] = {0, 0};
+#endif  // !MEDIAPIPE_DISABLE_GPU
+};
+REGISTER_CALCULATOR(MaskCompositingCalculator);
+
+absl::Status MaskCompositingCalculator::GetContract(CalculatorContract* cc) {
+  cc->Inputs().Tag(kImageTag).Set<Image>();
+  cc->Inputs().Tag(kMaskTag).Set<Image>();
+  if (cc->Inputs().HasTag(kPreviousMaskTag)) {
+    cc->Inputs().Tag(kPreviousMaskTag).Set<Image>();
+  }
+  if (cc->Inputs().HasTag(kBackgroundTag)) {
+    cc->Inputs().Tag(kBackgroundTag).Set<Image>();
+  }
+  cc->Outputs().Tag(kImageTag).Set<Image>();
+  if (cc->Outputs().HasTag(kSmoothedMaskTag)) {
+    cc->Outputs().Tag(kSmoothedMaskTag).Set<Image>();
+  }
+
+#if !MEDIAPIPE_DISABLE_GPU
+  MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  UseImageFrameMultiPool(cc);
+
+  return absl::OkStatus();
+}
+
+absl::Status MaskCompositingCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+
+  options_ = cc->Options<Options>();
+  RET_CHECK_LE(options_.feather_low(), options_.feather_high());
+  if (options_.operation() != Options::NONE) {
+    RET_CHECK(options_.has_color() ||
+              (options_.operation() == Options::BLEND_BACKGROUND &&
+               cc->Inputs().HasTag(kBackgroundTag)))
+        << "Missing color option.";
+  }
+  color_[0] = options_.color().r() / 255.0f;
+  color_[1] = options_.color().g() / 255.0f;
+  color_[2] = options_.color().b() / 255.0f;
+
+#if !MEDIAPIPE_DISABLE_GPU
+  MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
+#endif  //  !MEDIAPIPE_DISABLE_GPU
+
+  return absl::OkStatus();
+}
+
+absl::Status MaskCompositingCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().Tag(kImageTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  if (cc->Inputs().Tag(kMaskTag).IsEmpty()) {
+    // Pass through the image if there is no mask.
+    cc->Outputs().Tag(kImageTag).AddPacket(cc->Inputs().Tag(kImageTag).Value());
+    return absl::OkStatus();
+  }
+
+  // Run on GPU if incoming data is on GPU.
+  const bool use_gpu = cc->Inputs().Tag(kImageTag).Get<Image>().UsesGpu();
+
+  if (use_gpu) {
+#if !MEDIAPIPE_DISABLE_GPU
+    MP_RETURN_IF_ERROR(gpu_helper_.RunInGlContext([this, cc]() -> absl::Status {
+      if (!gpu_initialized_) {
+        MP_RETURN_IF_ERROR(GlSetup(cc));
+        gpu_initialized_ = true;
+      }
+      MP_RETURN_IF_ERROR(RenderGpu(cc));
+      return absl::OkStatus();
+    }));
+#else
+    return absl::InternalError("GPU processing is disabled.");
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  } else {
+#if !MEDIAPIPE_DISABLE_OPENCV
+    MP_RETURN_IF_ERROR(RenderCpu(cc));
+#else
+    return absl::InternalError("OpenCV processing is disabled.");
+#endif  // !MEDIAPIPE_DISABLE_OPENCV
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status MaskCompositingCalculator::Close(CalculatorContext* cc) {
+#if !MEDIAPIPE_DISABLE_GPU
+  gpu_helper_.RunInGlContext([this] {
+    if (composite_program_) glDeleteProgram(composite_program_);
+    if (mask_program_) glDeleteProgram(mask_program_);
+    if (vao_) glDeleteVertexArrays(1, &vao_);
+    if (vbo_[0]) glDeleteBuffers(2, vbo_);
+    composite_program_ = 0;
+    mask_program_ = 0;
+    vao_ = 0;
+    vbo_[0] = 0;
+    vbo_[1] = 0;
+  });
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
+  return absl::OkStatus();
+}
+
+bool MaskCompositingCalculator::HasPreviousMask(CalculatorContext* cc) const {
+  return cc->Inputs().HasTag(kPreviousMaskTag) &&
+         !cc->Inputs().Tag(kPreviousMaskTag).IsEmpty();
+}
+
+bool MaskCompositingCalculator::HasBackground(CalculatorContext* cc) const {
+  return options_.operation() == Options::BLEND_BACKGROUND &&
+         cc->Inputs().HasTag(kBackgroundTag) &&
+         !cc->Inputs().Tag(kBackgroundTag).IsEmpty();
+}
+
+absl::Status MaskCompositingCalculator::RenderCpu(CalculatorContext* cc) {
+#if !MEDIAPIPE_DISABLE_OPENCV
+  const auto& image = cc->Inputs().Tag(kImageTag).Get<Image>();
+  auto image_view = formats::MatView(&image);
+  const cv::Mat& image_mat = *image_view;
+  RET_CHECK(image_mat.type() == CV_8UC3 || image_mat.type() == CV_8UC4)
+      << "Only SRGB or SRGBA input images are supported.";
+
+  // Temporal mix, at mask resolution.
+  ASSIGN_OR_RETURN(cv::Mat mask,
+                   FloatMask(cc->Inputs().Tag(kMaskTag).Get<Image>()));
+  if (HasPreviousMask(cc) && options_.combine_with_previous_ratio() > 0.0f) {
+    ASSIGN_OR_RETURN(
+        cv::Mat previous_mask,
+        FloatMask(cc->Inputs().Tag(kPreviousMaskTag).Get<Image>()));
+    RET_CHECK(previous_mask.size() == mask.size());
+    const float ratio = options_.combine_with_previous_ratio();
+    for (int i = 0; i < mask.rows; ++i) {
+      float* mask_ptr = mask.ptr<float>(i);
+      const float* prev_ptr = previous_mask.ptr<float>(i);
+      for (int j = 0; j < mask.cols; ++j) {
+        mask_ptr[j] = MixWithPrevious(mask_ptr[j], prev_ptr[j], ratio);
+      }
+    }
+  }
+  if (cc->Outputs().HasTag(kSmoothedMaskTag)) {
+    auto smoothed_frame = AllocateSharedImageFrame(cc, ImageFormat::VEC32F1,
+                                                   mask.cols, mask.rows);
+    cv::Mat smoothed_mat = formats::MatView(smoothed_frame.get());
+    mask.copyTo(smoothed_mat);
+    cc->Outputs()
+        .Tag(kSmoothedMaskTag)
+        .AddPacket(MakePacket<Image>(smoothed_frame).At(cc->InputTimestamp()));
+  }
+  if (mask.size() != image_mat.size()) {
+    cv::resize(mask, mask, image_mat.size(), 0, 0, cv::INTER_LINEAR);
+  }
+
+  cv::Mat background_mat;
+  std::shared_ptr<cv::Mat> background_view;
+  if (HasBackground(cc)) {
+    background_view =
+        formats::MatView(&cc->Inputs().Tag(kBackgroundTag).Get<Image>());
+    background_mat = *background_view;
+    RET_CHECK(background_mat.type() == CV_8UC3 ||
+              background_mat.type() == CV_8UC4)
+        << "Only SRGB or SRGBA background images are supported.";
+    if (background_mat.size() != image_mat.size()) {
+      cv::resize(background_mat, background_mat, image_mat.size(), 0, 0,
+                 cv::INTER_LINEAR);
+    }
+  }
+
+  const bool output_alpha =
+      options_.write_alpha() || image_mat.channels() == 4;
+  auto output_frame = AllocateSharedImageFrame(
+      cc, output_alpha ? ImageFormat::SRGBA : ImageFormat::SRGB,
+      image_mat.cols, image_mat.rows);
+  cv::Mat output_mat = formats::MatView(output_frame.get());
+
+  const Options::Operation operation = options_.operation();
+  const float feather_low = options_.feather_low();
+  const float feather_scale =
+      1.0f / std::max(options_.feather_high() - feather_low, 1e-6f);
+  const bool invert_mask = options_.invert_mask();
+  const bool adjust_with_luminance = options_.adjust_with_luminance();
+  const bool write_alpha = options_.write_alpha();
+  const int in_channels = image_mat.channels();
+  const int out_channels = output_mat.channels();
+  const int background_channels = background_mat.channels();
+  const float color[3] = {color_[0] * 255.0f, color_[1] * 255.0f,
+                          color_[2] * 255.0f};
+
+  // Rows are independent, so they are split over threads; the inner loop
+  // only does arithmetic on contiguous rows and vectorizes.
+  cv::parallel_for_(cv::Range(0, image_mat.rows), [&](const cv::Range& range) {
+    for (int i = range.start; i < range.end; ++i) {
+      const uchar* in = image_mat.ptr<uchar>(i);
+      const float* weight_ptr = mask.ptr<float>(i);
+      const uchar* background =
+          background_mat.empty() ? nullptr : background_mat.ptr<uchar>(i);
+      uchar* out = output_mat.ptr<uchar>(i);
+      for (int j = 0; j < image_mat.cols; ++j) {
+        float weight = std::clamp((weight_ptr[j] - feather_low) * feather_scale,
+                                  0.0f, 1.0f);
+        if (invert_mask) weight = 1.0f - weight;
+
+        float rgb[3] = {static_cast<float>(in[0]), static_cast<float>(in[1]),
+                        static_cast<float>(in[2])};
+        if (operation == Options::RECOLOR) {
+          const float luminance =
+              adjust_with_luminance
+                  ? (rgb[0] * 0.299f + rgb[1] * 0.587f + rgb[2] * 0.114f) /
+                        255.0f
+                  : 1.0f;
+          const float mix_value = weight * luminance;
+          for (int c = 0; c < 3; ++c) {
+            rgb[c] += (color[c] - rgb[c]) * mix_value;
+          }
+        } else if (operation == Options::BLEND_BACKGROUND) {
+          for (int c = 0; c < 3; ++c) {
+            const float back = background ? background[c] : color[c];
+            rgb[c] = back + (rgb[c] - back) * weight;
+          }
+        }
+        for (int c = 0; c < 3; ++c) {
+          out[c] = cv::saturate_cast<uchar>(rgb[c]);
+        }
+        if (out_channels == 4) {
+          out[3] = write_alpha ? cv::saturate_cast<uchar>(weight * 255.0f)
+                               : in[3];
+        }
+        in += in_channels;
+        out += out_channels;
+        if (background) background += background_channels;
+      }
+    }
+  });
+
+  cc->Outputs()
+      .Tag(kImageTag)
+      .AddPacket(MakePacket<Image>(output_frame).At(cc->InputTimestamp()));
+#endif  // !MEDIAPIPE_DISABLE_OPENCV
+
+  return absl::OkStatus();
+}
+
+absl::Status MaskCompositingCalculator::RenderGpu(CalculatorContext* cc) {
+#if !MEDIAPIPE_DISABLE_GPU
+  const auto& image = cc->Inputs().Tag(kImageTag).Get<Image>();
+  const auto& mask = cc->Inputs().Tag(kMaskTag).Get<Image>();
+  auto image_texture = gpu_helper_.CreateSourceTexture(image);
+  auto mask_texture = gpu_helper_.CreateSourceTexture(mask);
+  // Mixing the mask with itself is a no-op.
+  auto previous_texture =
+      HasPreviousMask(cc)
+          ? gpu_helper_.CreateSourceTexture(
+                cc->Inputs().Tag(kPreviousMaskTag).Get<Image>())
+          : mask_texture;
+  auto background_texture =
+      HasBackground(cc) ? gpu_helper_.CreateSourceTexture(
+                              cc->Inputs().Tag(kBackgroundTag).Get<Image>())
+                        : image_texture;
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, image_texture.name());
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_2D, mask_texture.name());
+  glActiveTexture(GL_TEXTURE3);
+  glBindTexture(GL_TEXTURE_2D, previous_texture.name());
+  glActiveTexture(GL_TEXTURE4);
+  glBindTexture(GL_TEXTURE_2D, background_texture.name());
+
+  auto output_texture = gpu_helper_.CreateDestinationTexture(
+      image_texture.width(), image_texture.height());
+  gpu_helper_.BindFramebuffer(output_texture);
+  glUseProgram(composite_program_);
+  glUniform1f(glGetUniformLocation(composite_program_, "use_background_frame"),
+              HasBackground(cc) ? 1.0f : 0.0f);
+  GlRender();
+
+  if (cc->Outputs().HasTag(kSmoothedMaskTag)) {
+    auto smoothed_texture = gpu_helper_.CreateDestinationTexture(
+        mask_texture.width(), mask_texture.height(), mask.format());
+    gpu_helper_.BindFramebuffer(smoothed_texture);
+    glUseProgram(mask_program_);
+    GlRender();
+    cc->Outputs()
+        .Tag(kSmoothedMaskTag)
+        .Add(smoothed_texture.GetFrame<Image>().release(),
+             cc->InputTimestamp());
+    smoothed_texture.Release();
+  }
+
+  for (GLenum unit : {GL_TEXTURE4, GL_TEXTURE3, GL_TEXTURE2, GL_TEXTURE1}) {
+    glActiveTexture(unit);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+  glUseProgram(0);
+  glFlush();
+
+  cc->Outputs()
+      .Tag(kImageTag)
+      .Add(output_texture.GetFrame<Image>().release(), cc->InputTimestamp());
+
+  image_texture.Release();
+  mask_texture.Release();
+  previous_texture.Release();
+  background_texture.Release();
+  output_texture.Release();
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
+  return absl::OkStatus();
+}
+
+void MaskCompositingCalculator::GlRender() {
+#if !MEDIAPIPE_DISABLE_GPU
+  glBindVertexArray(vao_);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  glBindVertexArray(0);
+#endif  // !MEDIAPIPE_DISABLE_GPU
+}
+
+absl::Status MaskCompositingCalculator::GlSetup(CalculatorContext* cc) {
+#if !MEDIAPIPE_DISABLE_GPU
+  const GLint attr_location[NUM_ATTRIBUTES] = {
+      ATTRIB_VERTEX,
+      ATTRIB_TEXTURE_POSITION,
+  };
+  const GLchar* attr_name[NUM_ATTRIBUTES] = {
+      "position",
+      "texture_coordinate",
+  };
+
+  // All stages of the options in one shader. With MASK_ONLY defined, only
+  // the temporally mixed mask is written, for the MASK_SMOOTHED output.
+  const std::string shader_body = R"(
+    DEFAULT_PRECISION(mediump, float)
+
+    in vec2 sample_coordinate;
+    uniform sampler2D frame;
+    uniform sampler2D mask;
+    uniform sampler2D previous_mask;
+    uniform sampler2D background;
+    uniform float combine_with_previous_ratio;
+    uniform float feather_low;
+    uniform float feather_scale;
+    uniform float invert_mask;
+    uniform vec3 color;
+    uniform float adjust_with_luminance;
+    uniform float use_background_frame;
+    uniform float write_alpha;
+
+    // Same uncertainty-based mix as SegmentationSmoothingCalculator.
+    float MixWithPrevious(float new_mask_value, float prev_mask_value) {
+      const float c1 = 5.68842;
+      const float c2 = -0.748699;
+      const float c3 = -57.8051;
+      const float c4 = 291.309;
+      const float c5 = -624.717;
+      float t = new_mask_value - 0.5;
+      float x = t * t;
+      float uncertainty =
+        1.0 - min(1.0, x * (c1 + x * (c2 + x * (c3 + x * (c4 + x * c5)))));
+      return new_mask_value + (prev_mask_value - new_mask_value) *
+                              (uncertainty * combine_with_previous_ratio);
+    }
+
+    void main() {
+      float weight = MixWithPrevious(
+          texture2D(mask, sample_coordinate).r,
+          texture2D(previous_mask, sample_coordinate).r);
+    #ifdef MASK_ONLY
+      gl_FragColor = vec4(weight, 0.0, 0.0, weight);
+    #else
+      weight = clamp((weight - feather_low) * feather_scale, 0.0, 1.0);
+      weight = mix(weight, 1.0 - weight, invert_mask);
+
+      vec4 pixel = texture2D(frame, sample_coordinate);
+    #if OPERATION == 1
+      float luminance = mix(1.0, dot(pixel.rgb, vec3(0.299, 0.587, 0.114)),
+                            adjust_with_luminance);
+      pixel.rgb = mix(pixel.rgb, color, weight * luminance);
+    #elif OPERATION == 2
+      vec3 back = mix(color, texture2D(background, sample_coordinate).rgb,
+                      use_background_frame);
+      pixel.rgb = mix(back, pixel.rgb, weight);
+    #endif  // OPERATION
+      pixel.a = mix(pixel.a, weight, write_alpha);
+      gl_FragColor = pixel;
+    #endif  // MASK_ONLY
+    }
+  )";
+
+  for (const bool mask_only : {false, true}) {
+    const std::string frag_src = absl::StrCat(
+        mediapipe::kMediaPipeFragmentShaderPreamble,
+        mask_only ? "#define MASK_ONLY\n" : "",
+        "#define OPERATION ", static_cast<int>(options_.operation()), "\n",
+        shader_body);
+    GLuint* program = mask_only ? &mask_program_ : &composite_program_;
+    mediapipe::GlhCreateProgram(
+        mediapipe::kBasicVertexShader, frag_src.c_str(), NUM_ATTRIBUTES,
+        (const GLchar**)&attr_name[0], attr_location, program);
+    RET_CHECK(*program) << "Problem initializing the program.";
+    glUseProgram(*program);
+    glUniform1i(glGetUniformLocation(*program, "frame"), 1);
+    glUniform1i(glGetUniformLocation(*program, "mask"), 2);
+    glUniform1i(glGetUniformLocation(*program, "previous_mask"), 3);
+    glUniform1i(glGetUniformLocation(*program, "background"), 4);
+    glUniform1f(glGetUniformLocation(*program, "combine_with_previous_ratio"),
+                options_.combine_with_previous_ratio());
+    glUniform1f(glGetUniformLocation(*program, "feather_low"),
+                options_.feather_low());
+    glUniform1f(
+        glGetUniformLocation(*program, "feather_scale"),
+        1.0f / std::max(options_.feather_high() - options_.feather_low(),
+                        1e-6f));
+    glUniform1f(glGetUniformLocation(*program, "invert_mask"),
+                options_.invert_mask() ? 1.0f : 0.0f);
+    glUniform3f(glGetUniformLocation(*program, "color"), color_[0], color_[1],
+                color_[2]);
+    glUniform1f(glGetUniformLocation(*program, "adjust_with_luminance"),
+                options_.adjust_with_luminance() ? 1.0f : 0.0f);
+    glUniform1f(glGetUniformLocation(*program, "write_alpha"),
+                options_.write_alpha() ? 1.0f : 0.0f);
+  }
+  glUseProgram(0);
+
+  glGenVertexArrays(1, &vao_);
+  glGenBuffers(2, vbo_);
+  glBindVertexArray(vao_);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_[0]);
+  glBufferData(GL_ARRAY_BUFFER, 4 * 2 * sizeof(GLfloat),
+               mediapipe::kBasicSquareVertices, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(ATTRIB_VERTEX);
+  glVertexAttribPointer(ATTRIB_VERTEX, 2, GL_FLOAT, 0, 0, nullptr);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_[1]);
+  glBufferData(GL_ARRAY_BUFFER, 4 * 2 * sizeof(GLfloat),
+               mediapipe::kBasicTextureVertices, GL_STATIC_DRAW);
+  glEnableVertexAttribArray(ATTRIB_TEXTURE_POSITION);
+  glVertexAttribPointer(ATTRIB_TEXTURE_POSITION, 2, GL_FLOAT, 0, 0, nullptr);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,147 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_opencv.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+Packet MakeImagePacket(const cv::Mat& mat, ImageFormat::Format format) {
+  Image image(std::make_shared<ImageFrame>(format, mat.cols, mat.rows));
+  mat.copyTo(*formats::MatView(&image));
+  return MakePacket<Image>(std::move(image)).At(Timestamp(0));
+}
+
+cv::Mat OutputMat(const CalculatorRunner& runner, const std::string& tag) {
+  const auto& packets = runner.Outputs().Tag(tag).packets;
+  EXPECT_EQ(packets.size(), 1);
+  const Image& image = packets[0].Get<Image>();
+  return formats::MatView(&image)->clone();
+}
+
+TEST(MaskCompositingCalculatorTest, RecolorsMaskedPixels) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "MaskCompositingCalculator"
+    input_stream: "IMAGE:image"
+    input_stream: "MASK:mask"
+    output_stream: "IMAGE:output"
+    options {
+      [mediapipe.MaskCompositingCalculatorOptions.ext] {
+        operation: RECOLOR
+        color { r: 0 g: 0 b: 255 }
+        adjust_with_luminance: false
+      }
+    }
+  )pb"));
+  const cv::Mat image(4, 4, CV_8UC3, cv::Scalar(200, 100, 50));
+  // Left half of the mask is set.
+  cv::Mat mask(4, 4, CV_32FC1, cv::Scalar(0.0f));
+  mask.colRange(0, 2).setTo(cv::Scalar(1.0f));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      MakeImagePacket(image, ImageFormat::SRGB));
+  runner.MutableInputs()->Tag("MASK").packets.push_back(
+      MakeImagePacket(mask, ImageFormat::VEC32F1));
+  MP_ASSERT_OK(runner.Run());
+
+  const cv::Mat output = OutputMat(runner, "IMAGE");
+  ASSERT_EQ(output.type(), CV_8UC3);
+  EXPECT_EQ(output.at<cv::Vec3b>(1, 0), cv::Vec3b(0, 0, 255));
+  EXPECT_EQ(output.at<cv::Vec3b>(1, 3), cv::Vec3b(200, 100, 50));
+}
+
+TEST(MaskCompositingCalculatorTest, WritesFeatheredMaskToAlpha) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "MaskCompositingCalculator"
+    input_stream: "IMAGE:image"
+    input_stream: "MASK:mask"
+    output_stream: "IMAGE:output"
+    options {
+      [mediapipe.MaskCompositingCalculatorOptions.ext] {
+        operation: NONE
+        feather_low: 0.4
+        feather_high: 0.6
+        write_alpha: true
+      }
+    }
+  )pb"));
+  const cv::Mat image(4, 4, CV_8UC3, cv::Scalar(10, 20, 30));
+  // The mask is smaller than the image and gets scaled up.
+  const cv::Mat mask(2, 2, CV_8UC1, cv::Scalar(153));  // 0.6
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      MakeImagePacket(image, ImageFormat::SRGB));
+  runner.MutableInputs()->Tag("MASK").packets.push_back(
+      MakeImagePacket(mask, ImageFormat::GRAY8));
+  MP_ASSERT_OK(runner.Run());
+
+  const cv::Mat output = OutputMat(runner, "IMAGE");
+  ASSERT_EQ(output.type(), CV_8UC4);
+  ASSERT_EQ(output.size(), image.size());
+  for (int i = 0; i < output.rows; ++i) {
+    for (int j = 0; j < output.cols; ++j) {
+      EXPECT_EQ(output.at<cv::Vec4b>(i, j), cv::Vec4b(10, 20, 30, 255));
+    }
+  }
+}
+
+TEST(MaskCompositingCalculatorTest, OutputsSmoothedMask) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "MaskCompositingCalculator"
+    input_stream: "IMAGE:image"
+    input_stream: "MASK:mask"
+    input_stream: "MASK_PREVIOUS:previous_mask"
+    input_stream: "BACKGROUND:background"
+    output_stream: "IMAGE:output"
+    output_stream: "MASK_SMOOTHED:smoothed_mask"
+    options {
+      [mediapipe.MaskCompositingCalculatorOptions.ext] {
+        combine_with_previous_ratio: 1.0
+        operation: BLEND_BACKGROUND
+      }
+    }
+  )pb"));
+  const cv::Mat image(2, 2, CV_8UC3, cv::Scalar(255, 255, 255));
+  const cv::Mat background(2, 2, CV_8UC3, cv::Scalar(0, 0, 0));
+  // A fully uncertain mask takes the previous value.
+  const cv::Mat mask(2, 2, CV_32FC1, cv::Scalar(0.5f));
+  const cv::Mat previous_mask(2, 2, CV_32FC1, cv::Scalar(1.0f));
+  runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+      MakeImagePacket(image, ImageFormat::SRGB));
+  runner.MutableInputs()->Tag("MASK").packets.push_back(
+      MakeImagePacket(mask, ImageFormat::VEC32F1));
+  runner.MutableInputs()->Tag("MASK_PREVIOUS").packets.push_back(
+      MakeImagePacket(previous_mask, ImageFormat::VEC32F1));
+  runner.MutableInputs()->Tag("BACKGROUND").packets.push_back(
+      MakeImagePacket(background, ImageFormat::SRGB));
+  MP_ASSERT_OK(runner.Run());
+
+  const cv::Mat smoothed_mask = OutputMat(runner, "MASK_SMOOTHED");
+  ASSERT_EQ(smoothed_mask.type(), CV_32FC1);
+  EXPECT_FLOAT_EQ(smoothed_mask.at<float>(0, 0), 1.0f);
+  const cv::Mat output = OutputMat(runner, "IMAGE");
+  EXPECT_EQ(output.at<cv::Vec3b>(0, 0), cv::Vec3b(255, 255, 255));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
 #include "mediapipe/calculators/image/opencv_encoded_image_to_image_frame_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
 #include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status.h"
@@ -22,9 +27,82 @@
 
 namespace mediapipe {
 
+namespace {
+
+// Reads the size and the number of components of a JPEG image from its frame
+// header. Returns false if `contents` isn't a JPEG image or has no frame header
+// before the image data.
+bool ReadJpegFrameHeader(absl::string_view contents, int* width, int* height,
+                         int* components) {
+  auto byte = [&contents](size_t i) {
+    return static_cast<uint8_t>(contents[i]);
+  };
+  if (contents.size() < 4 || byte(0) != 0xFF || byte(1) != 0xD8) return false;
+  size_t pos = 2;
+  while (pos + 4 <= contents.size()) {
+    if (byte(pos) != 0xFF) return false;
+    const uint8_t marker = byte(pos + 1);
+    if (marker == 0xFF) {
+      // Fill byte.
+      ++pos;
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+      // Markers without a segment.
+      pos += 2;
+      continue;
+    }
+    // End of image, or start of the image data.
+    if (marker == 0xD9 || marker == 0xDA) return false;
+    const size_t length = (byte(pos + 2) << 8) | byte(pos + 3);
+    // 0xC0 to 0xCF mark the start of a frame, except 0xC4, 0xC8 and 0xCC.
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+        marker != 0xCC) {
+      if (length < 8 || pos + 10 > contents.size()) return false;
+      *height = (byte(pos + 5) << 8) | byte(pos + 6);
+      *width = (byte(pos + 7) << 8) | byte(pos + 8);
+      *components = byte(pos + 9);
+      return true;
+    }
+    pos += 2 + length;
+  }
+  return false;
+}
+
+// Returns the cv::imdecode flags decoding the JPEG image `contents` at the
+// smallest of the 1/8, 1/4 and 1/2 scales covering min_width x min_height, or 0
+// if `contents` isn't a JPEG image or no reduced scale covers that size.
+int ReducedJpegDecodeFlags(absl::string_view contents, int min_width,
+                           int min_height) {
+  int width, height, components;
+  if (!ReadJpegFrameHeader(contents, &width, &height, &components)) return 0;
+  const int short_side = std::min(width, height);
+  const int long_side = std::max(width, height);
+  const int min_short_side = std::min(min_width, min_height);
+  const int min_long_side = std::max(min_width, min_height);
+  const bool grayscale = components == 1;
+  // The decoder rounds the reduced sizes up, so rounding down is conservative.
+  if (short_side / 8 >= min_short_side && long_side / 8 >= min_long_side) {
+    return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_8
+                     : cv::IMREAD_REDUCED_COLOR_8;
+  }
+  if (short_side / 4 >= min_short_side && long_side / 4 >= min_long_side) {
+    return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_4
+                     : cv::IMREAD_REDUCED_COLOR_4;
+  }
+  if (short_side / 2 >= min_short_side && long_side / 2 >= min_long_side) {
+    return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_2
+                     : cv::IMREAD_REDUCED_COLOR_2;
+  }
+  return 0;
+}
+
+}  // namespace
+
 // Takes in an encoded image string, decodes it by OpenCV, and converts to an
 // ImageFrame. Note that this calculator only supports grayscale and RGB images
-// for now.
+// for now. JPEG images can be decoded at a reduced scale, see the min_width and
+// min_height options.
 //
 // Example config:
 // node {
@@ -46,6 +124,7 @@ absl::Status OpenCvEncodedImageToImageFrameCalculator::GetContract(
     CalculatorContract* cc) {
   cc->Inputs().Index(0).Set<std::string>();
   cc->Outputs().Index(0).Set<ImageFrame>();
+  UseImageFrameMultiPool(cc);
   return absl::OkStatus();
 }
 
@@ -59,19 +138,32 @@ absl::Status OpenCvEncodedImageToImageFrameCalculator::Open(
 absl::Status OpenCvEncodedImageToImageFrameCalculator::Process(
     CalculatorContext* cc) {
   const std::string& contents = cc->Inputs().Index(0).Get<std::string>();
-  const std::vector<char> contents_vector(contents.begin(), contents.end());
-  cv::Mat decoded_mat;
+  // Decodes straight from the input string, without copying it.
+  const cv::Mat contents_mat(1, contents.size(), CV_8UC1,
+                             const_cast<char*>(contents.data()));
+  int flags;
   if (options_.apply_orientation_from_exif_data()) {
     // We want to respect the orientation from the EXIF data, which
     // IMREAD_UNCHANGED ignores, but otherwise we want to be as permissive as
     // possible with our reading flags. Therefore, we use IMREAD_ANYCOLOR and
     // IMREAD_ANYDEPTH.
-    decoded_mat = cv::imdecode(contents_vector,
-                               cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH);
+    flags = cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH;
   } else {
     // Return the loaded image as-is
-    decoded_mat = cv::imdecode(contents_vector, cv::IMREAD_UNCHANGED);
+    flags = cv::IMREAD_UNCHANGED;
+  }
+  if (options_.has_min_width() || options_.has_min_height()) {
+    // The reduced flags can't be combined with the flags above. They apply the
+    // EXIF orientation unless told otherwise.
+    if (int reduced_flags = ReducedJpegDecodeFlags(
+            contents, options_.min_width(), options_.min_height())) {
+      flags = reduced_flags;
+      if (!options_.apply_orientation_from_exif_data()) {
+        flags |= cv::IMREAD_IGNORE_ORIENTATION;
+      }
+    }
   }
+  cv::Mat decoded_mat = cv::imdecode(contents_mat, flags);
   ImageFormat::Format image_format = ImageFormat::UNKNOWN;
   cv::Mat output_mat;
   switch (decoded_mat.channels()) {
@@ -91,8 +183,8 @@ absl::Status OpenCvEncodedImageToImageFrameCalculator::Process(
       return mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
              << "Unsupported number of channels: " << decoded_mat.channels();
   }
-  std::unique_ptr<ImageFrame> output_frame = absl::make_unique<ImageFrame>(
-      image_format, decoded_mat.size().width, decoded_mat.size().height,
+  std::unique_ptr<ImageFrame> output_frame = AllocateImageFrame(
+      cc, image_format, decoded_mat.size().width, decoded_mat.size().height,
       ImageFrame::kGlDefaultAlignmentBoundary);
   output_mat.copyTo(formats::MatView(output_frame.get()));
   cc->Outputs().Index(0).Add(output_frame.release(), cc->InputTimestamp());
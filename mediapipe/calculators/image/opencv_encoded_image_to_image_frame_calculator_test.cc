@@ -102,5 +102,48 @@ TEST(OpenCvEncodedImageToImageFrameCalculatorTest, TestGrayscaleJpeg) {
   EXPECT_LE(max_val, 10);
 }
 
+TEST(OpenCvEncodedImageToImageFrameCalculatorTest, TestReducedJpeg) {
+  std::string contents;
+  MP_ASSERT_OK(file::GetContents(
+      file::JoinPath("./", "/mediapipe/calculators/image/testdata/dino.jpg"),
+      &contents));
+  Packet input_packet = MakePacket<std::string>(contents);
+
+  // The 2876x1699 image is decoded at 1/4 scale, the smallest covering
+  // 224x224.
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "OpenCvEncodedImageToImageFrameCalculator"
+        input_stream: "encoded_image"
+        output_stream: "image_frame"
+        options {
+          [mediapipe.OpenCvEncodedImageToImageFrameCalculatorOptions.ext] {
+            min_width: 224
+            min_height: 224
+          }
+        }
+      )pb");
+  CalculatorRunner runner(node_config);
+  runner.MutableInputs()->Index(0).packets.push_back(
+      input_packet.At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+  const std::vector<Packet>& packets = runner.Outputs().Index(0).packets;
+  ASSERT_EQ(1, packets.size());
+  const ImageFrame& output_frame = packets[0].Get<ImageFrame>();
+  EXPECT_EQ(output_frame.Width(), 719);
+  EXPECT_EQ(output_frame.Height(), 425);
+
+  cv::Mat input_mat = cv::imread(
+      file::JoinPath("./", "/mediapipe/calculators/image/testdata/dino.jpg"),
+      cv::IMREAD_REDUCED_COLOR_4);
+  cv::Mat output_mat;
+  cv::cvtColor(formats::MatView(&output_frame), output_mat, cv::COLOR_RGB2BGR);
+  cv::Mat diff;
+  cv::absdiff(input_mat, output_mat, diff);
+  double max_val;
+  cv::minMaxLoc(diff, nullptr, &max_val);
+  EXPECT_LE(max_val, 10);
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -22,7 +22,9 @@
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/image_frame_util.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gl_calculator_helper.h"
@@ -231,11 +233,15 @@ absl::Status RecolorCalculator::RenderCpu(CalculatorContext* cc) {
         .AddPacket(cc->Inputs().Tag(kImageFrameTag).Value());
     return absl::OkStatus();
   }
-  // Get inputs and setup output.
-  const auto& input_img = cc->Inputs().Tag(kImageFrameTag).Get<ImageFrame>();
+  // Get inputs and setup output. The image is recolored in place, without a
+  // copy unless other calculators also read the input frame.
+  ASSIGN_OR_RETURN(auto output_img,
+                   image_frame_util::ConsumeOrCopyImageFrame(
+                       &cc->Inputs().Tag(kImageFrameTag).Value(),
+                       ImageFrame::kDefaultAlignmentBoundary));
   const auto& mask_img = cc->Inputs().Tag(kMaskCpuTag).Get<ImageFrame>();
 
-  cv::Mat input_mat = formats::MatView(&input_img);
+  cv::Mat input_mat = formats::MatView(output_img.get());
   cv::Mat mask_mat = formats::MatView(&mask_img);
 
   RET_CHECK(input_mat.channels() == 3);  // RGB only.
@@ -252,9 +258,7 @@ absl::Status RecolorCalculator::RenderCpu(CalculatorContext* cc) {
   cv::resize(mask_mat, mask_full, input_mat.size());
   const cv::Vec3b recolor = {color_[0], color_[1], color_[2]};
 
-  auto output_img = absl::make_unique<ImageFrame>(
-      input_img.Format(), input_mat.cols, input_mat.rows);
-  cv::Mat output_mat = mediapipe::formats::MatView(output_img.get());
+  cv::Mat output_mat = input_mat;
 
   const int invert_mask = invert_mask_ ? 1 : 0;
   const int adjust_with_luminance = adjust_with_luminance_ ? 1 : 0;
@@ -29,6 +29,7 @@
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/video_stream_header.h"
 #include "mediapipe/framework/formats/yuv_image.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
 #include "mediapipe/framework/port/image_resizer.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
@@ -184,6 +185,7 @@ class ScaleImageCalculator : public CalculatorBase {
     if (cc->Inputs().HasTag("OVERRIDE_OPTIONS")) {
       cc->Inputs().Tag("OVERRIDE_OPTIONS").Set<ScaleImageCalculatorOptions>();
     }
+    UseImageFrameMultiPool(cc);
     return absl::OkStatus();
   }
 
@@ -635,8 +637,8 @@ absl::Status ScaleImageCalculator::Process(CalculatorContext* cc) {
   if (crop_width_ < input_width_ || crop_height_ < input_height_) {
     cc->GetCounter("Crops")->Increment();
     // TODO Do the crop as a range restrict inside OpenCV code below.
-    cropped_image.reset(new ImageFrame(image_frame->Format(), crop_width_,
-                                       crop_height_, alignment_boundary_));
+    cropped_image = AllocateImageFrame(cc, image_frame->Format(), crop_width_,
+                                       crop_height_, alignment_boundary_);
     if (image_frame->ByteDepth() == 1 || image_frame->ByteDepth() == 2) {
       CropImageFrame(*image_frame, col_start_, row_start_, crop_width_,
                      crop_height_, cropped_image.get());
@@ -689,19 +691,20 @@ absl::Status ScaleImageCalculator::Process(CalculatorContext* cc) {
   }
 
   // Rescale the image frame.
-  std::unique_ptr<ImageFrame> output_frame(new ImageFrame());
+  std::unique_ptr<ImageFrame> output_frame;
   if (image_frame->Width() >= output_width_ &&
       image_frame->Height() >= output_height_) {
     // Downscale.
     cc->GetCounter("Downscales")->Increment();
     cv::Mat input_mat = ::mediapipe::formats::MatView(image_frame);
-    output_frame->Reset(image_frame->Format(), output_width_, output_height_,
-                        alignment_boundary_);
+    output_frame = AllocateImageFrame(cc, image_frame->Format(), output_width_,
+                                      output_height_, alignment_boundary_);
     cv::Mat output_mat = ::mediapipe::formats::MatView(output_frame.get());
     downscaler_->Resize(input_mat, &output_mat);
   } else {
     // Upscale. If upscaling is disallowed, output_width_ and output_height_ are
     // the same as the input/crop width and height.
+    output_frame = absl::make_unique<ImageFrame>();
     image_frame_util::RescaleImageFrame(
         *image_frame, output_width_, output_height_, alignment_boundary_,
         interpolation_algorithm_, output_frame.get());
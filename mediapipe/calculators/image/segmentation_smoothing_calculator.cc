@@ -21,20 +21,24 @@
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/vector.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
+#include "mediapipe/calculators/image/guided_filter_gl.h"
 #include "mediapipe/gpu/gl_calculator_helper.h"
 #include "mediapipe/gpu/gl_simple_shaders.h"
 #include "mediapipe/gpu/shader_util.h"
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
 #if !MEDIAPIPE_DISABLE_OPENCV
+#include "mediapipe/calculators/image/guided_filter.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/image_opencv.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #endif  // !MEDIAPIPE_DISABLE_OPENCV
 
 namespace mediapipe {
@@ -43,6 +47,7 @@ namespace {
 constexpr char kCurrentMaskTag[] = "MASK";
 constexpr char kPreviousMaskTag[] = "MASK_PREVIOUS";
 constexpr char kOutputMaskTag[] = "MASK_SMOOTHED";
+constexpr char kGuideTag[] = "GUIDE";
 
 enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 }  // namespace
@@ -57,6 +62,8 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //   MASK_PREVIOUS - Image containing previous mask.
 //                   [Same format as MASK_CURRENT]
 //   * If input channels is >1, only the first channel (R) is used as the mask.
+//   GUIDE (optional) - Image the mask was computed from, e.g. the camera
+//                      frame. Any size; used by the guided filter refinement.
 //
 // Output:
 //   MASK_SMOOTHED - Blended mask.
@@ -66,6 +73,9 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 //
 // Options:
 //   combine_with_previous_ratio - Amount of previous to blend with current.
+//   guided_filter_radius - If >0, the blended mask is then guided-filtered
+//                          with GUIDE, snapping its boundary to image edges.
+//   guided_filter_epsilon - Regularization of the guided filter.
 //
 // Example:
 //  node {
@@ -98,12 +108,18 @@ class SegmentationSmoothingCalculator : public CalculatorBase {
   absl::Status GlSetup(CalculatorContext* cc);
   void GlRender(CalculatorContext* cc);
 
+  // Whether the guided filter runs on this input set.
+  bool RefineWithGuide(CalculatorContext* cc) const;
+
   float combine_with_previous_ratio_;
+  int guided_filter_radius_ = 0;
+  float guided_filter_epsilon_ = 0.0f;
 
   bool gpu_initialized_ = false;
 #if !MEDIAPIPE_DISABLE_GPU
   mediapipe::GlCalculatorHelper gpu_helper_;
   GLuint program_ = 0;
+  GuidedFilterGl guided_filter_gl_;
 #endif  // !MEDIAPIPE_DISABLE_GPU
 };
 REGISTER_CALCULATOR(SegmentationSmoothingCalculator);
@@ -115,10 +131,14 @@ absl::Status SegmentationSmoothingCalculator::GetContract(
   cc->Inputs().Tag(kCurrentMaskTag).Set<Image>();
   cc->Inputs().Tag(kPreviousMaskTag).Set<Image>();
   cc->Outputs().Tag(kOutputMaskTag).Set<Image>();
+  if (cc->Inputs().HasTag(kGuideTag)) {
+    cc->Inputs().Tag(kGuideTag).Set<Image>();
+  }
 
 #if !MEDIAPIPE_DISABLE_GPU
   MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
 #endif  // !MEDIAPIPE_DISABLE_GPU
+  UseImageFrameMultiPool(cc);
 
   return absl::OkStatus();
 }
@@ -129,6 +149,13 @@ absl::Status SegmentationSmoothingCalculator::Open(CalculatorContext* cc) {
   auto options =
       cc->Options<mediapipe::SegmentationSmoothingCalculatorOptions>();
   combine_with_previous_ratio_ = options.combine_with_previous_ratio();
+  guided_filter_radius_ = options.guided_filter_radius();
+  guided_filter_epsilon_ = options.guided_filter_epsilon();
+  if (guided_filter_radius_ > 0) {
+    RET_CHECK(cc->Inputs().HasTag(kGuideTag))
+        << "guided_filter_radius requires a GUIDE input.";
+    RET_CHECK_GT(guided_filter_epsilon_, 0.0f);
+  }
 
 #if !MEDIAPIPE_DISABLE_GPU
   MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
@@ -141,7 +168,7 @@ absl::Status SegmentationSmoothingCalculator::Process(CalculatorContext* cc) {
   if (cc->Inputs().Tag(kCurrentMaskTag).IsEmpty()) {
     return absl::OkStatus();
   }
-  if (cc->Inputs().Tag(kPreviousMaskTag).IsEmpty()) {
+  if (cc->Inputs().Tag(kPreviousMaskTag).IsEmpty() && !RefineWithGuide(cc)) {
     // Pass through current image if previous is not available.
     cc->Outputs()
         .Tag(kOutputMaskTag)
@@ -181,12 +208,18 @@ absl::Status SegmentationSmoothingCalculator::Close(CalculatorContext* cc) {
   gpu_helper_.RunInGlContext([this] {
     if (program_) glDeleteProgram(program_);
     program_ = 0;
+    guided_filter_gl_.GlTeardown();
   });
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
   return absl::OkStatus();
 }
 
+bool SegmentationSmoothingCalculator::RefineWithGuide(
+    CalculatorContext* cc) const {
+  return guided_filter_radius_ > 0 && !cc->Inputs().Tag(kGuideTag).IsEmpty();
+}
+
 absl::Status SegmentationSmoothingCalculator::RenderCpu(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_OPENCV
   // Setup source images.
@@ -195,7 +228,11 @@ absl::Status SegmentationSmoothingCalculator::RenderCpu(CalculatorContext* cc) {
   RET_CHECK_EQ(current_mat->type(), CV_32FC1)
       << "Only 1-channel float input image is supported.";
 
-  const auto& previous_frame = cc->Inputs().Tag(kPreviousMaskTag).Get<Image>();
+  // Without a previous mask, blending is a no-op but refinement still runs.
+  const auto& previous_frame =
+      cc->Inputs().Tag(kPreviousMaskTag).IsEmpty()
+          ? current_frame
+          : cc->Inputs().Tag(kPreviousMaskTag).Get<Image>();
   auto previous_mat = mediapipe::formats::MatView(&previous_frame);
   RET_CHECK_EQ(previous_mat->type(), current_mat->type())
       << "Warning: mixing input format types: " << previous_mat->type()
@@ -205,8 +242,8 @@ absl::Status SegmentationSmoothingCalculator::RenderCpu(CalculatorContext* cc) {
   RET_CHECK_EQ(current_mat->cols, previous_mat->cols);
 
   // Setup destination image.
-  auto output_frame = std::make_shared<ImageFrame>(
-      current_frame.image_format(), current_mat->cols, current_mat->rows);
+  auto output_frame = AllocateSharedImageFrame(
+      cc, current_frame.image_format(), current_mat->cols, current_mat->rows);
   cv::Mat output_mat = mediapipe::formats::MatView(output_frame.get());
   output_mat.setTo(cv::Scalar(0));
 
@@ -250,6 +287,21 @@ absl::Status SegmentationSmoothingCalculator::RenderCpu(CalculatorContext* cc) {
     }
   }
 
+  if (RefineWithGuide(cc)) {
+    const auto& guide_frame = cc->Inputs().Tag(kGuideTag).Get<Image>();
+    auto guide_view = mediapipe::formats::MatView(&guide_frame);
+    cv::Mat guide_mat = *guide_view;
+    if (guide_mat.size() != output_mat.size()) {
+      cv::Mat resized_guide;
+      cv::resize(guide_mat, resized_guide, output_mat.size(), 0, 0,
+                 cv::INTER_AREA);
+      guide_mat = resized_guide;
+    }
+    MP_RETURN_IF_ERROR(GuidedFilter(guide_mat, output_mat,
+                                    guided_filter_radius_,
+                                    guided_filter_epsilon_, output_mat));
+  }
+
   cc->Outputs()
       .Tag(kOutputMaskTag)
       .AddPacket(MakePacket<Image>(output_frame).At(cc->InputTimestamp()));
@@ -271,7 +323,10 @@ absl::Status SegmentationSmoothingCalculator::RenderGpu(CalculatorContext* cc) {
 
   auto current_texture = gpu_helper_.CreateSourceTexture(current_frame);
 
-  const auto& previous_frame = cc->Inputs().Tag(kPreviousMaskTag).Get<Image>();
+  const auto& previous_frame =
+      cc->Inputs().Tag(kPreviousMaskTag).IsEmpty()
+          ? current_frame
+          : cc->Inputs().Tag(kPreviousMaskTag).Get<Image>();
   if (previous_frame.format() != current_frame.format()) {
     LOG(ERROR) << "Warning: mixing input format types. ";
   }
@@ -281,10 +336,17 @@ absl::Status SegmentationSmoothingCalculator::RenderGpu(CalculatorContext* cc) {
   const int width = current_frame.width(), height = current_frame.height();
   auto output_texture = gpu_helper_.CreateDestinationTexture(
       width, height, current_frame.format());
+  const bool refine = RefineWithGuide(cc);
+  // With refinement, the blended mask is an intermediate.
+  auto blended_texture =
+      refine ? gpu_helper_.CreateDestinationTexture(
+                   width, height, current_frame.format(),
+                   GlCalculatorHelper::TextureUse::kIntermediate)
+             : output_texture;
 
   // Process shader.
   {
-    gpu_helper_.BindFramebuffer(output_texture);
+    gpu_helper_.BindFramebuffer(blended_texture);
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, current_texture.name());
     glActiveTexture(GL_TEXTURE2);
@@ -295,6 +357,15 @@ absl::Status SegmentationSmoothingCalculator::RenderGpu(CalculatorContext* cc) {
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, 0);
   }
+  if (refine) {
+    auto guide_texture = gpu_helper_.CreateSourceTexture(
+        cc->Inputs().Tag(kGuideTag).Get<Image>());
+    MP_RETURN_IF_ERROR(guided_filter_gl_.GlRender(
+        &gpu_helper_, blended_texture, guide_texture, guided_filter_radius_,
+        guided_filter_epsilon_, /*alpha_from_red=*/true, output_texture));
+    guide_texture.Release();
+  }
+  blended_texture.Release();
   glFlush();
 
   // Send out image as GPU packet.
@@ -430,6 +501,10 @@ absl::Status SegmentationSmoothingCalculator::GlSetup(CalculatorContext* cc) {
   glUniform1f(glGetUniformLocation(program_, "combine_with_previous_ratio"),
               combine_with_previous_ratio_);
 
+  if (guided_filter_radius_ > 0) {
+    MP_RETURN_IF_ERROR(guided_filter_gl_.GlSetup());
+  }
+
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
   return absl::OkStatus();
@@ -23,7 +23,9 @@
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/port/vector.h"
+#include "mediapipe/util/image_frame_util.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gl_calculator_helper.h"
@@ -270,16 +272,27 @@ absl::Status SetAlphaCalculator::RenderCpu(CalculatorContext* cc) {
     return absl::OkStatus();
   }
 
-  // Setup source image
-  const auto& input_frame = cc->Inputs().Tag(kInputFrameTag).Get<ImageFrame>();
-  const cv::Mat input_mat = mediapipe::formats::MatView(&input_frame);
+  // Setup source and destination images. An RGBA image gets its alpha set in
+  // place, without a copy unless other calculators also read the input frame.
+  std::unique_ptr<ImageFrame> output_frame;
+  cv::Mat input_mat;
+  if (cc->Inputs().Tag(kInputFrameTag).Get<ImageFrame>().Format() ==
+      ImageFormat::SRGBA) {
+    ASSIGN_OR_RETURN(output_frame,
+                     image_frame_util::ConsumeOrCopyImageFrame(
+                         &cc->Inputs().Tag(kInputFrameTag).Value(),
+                         ImageFrame::kDefaultAlignmentBoundary));
+    input_mat = mediapipe::formats::MatView(output_frame.get());
+  } else {
+    const auto& input_frame =
+        cc->Inputs().Tag(kInputFrameTag).Get<ImageFrame>();
+    input_mat = mediapipe::formats::MatView(&input_frame);
+    output_frame = absl::make_unique<ImageFrame>(
+        ImageFormat::SRGBA, input_mat.cols, input_mat.rows);
+  }
   if (!(input_mat.type() == CV_8UC3 || input_mat.type() == CV_8UC4)) {
     LOG(ERROR) << "Only 3 or 4 channel 8-bit input image supported";
   }
-
-  // Setup destination image
-  auto output_frame = absl::make_unique<ImageFrame>(
-      ImageFormat::SRGBA, input_mat.cols, input_mat.rows);
   cv::Mat output_mat = mediapipe::formats::MatView(output_frame.get());
 
   const bool has_alpha_mask = cc->Inputs().HasTag(kInputAlphaTag) &&
@@ -17,6 +17,8 @@
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "mediapipe/calculators/image/affine_transformation.h"
 #if !MEDIAPIPE_DISABLE_GPU
@@ -32,6 +34,8 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
 #include "mediapipe/framework/port/ret_check.h"
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gl_calculator_helper.h"
@@ -53,6 +57,16 @@ AffineTransformation::BorderMode GetBorderMode(
   }
 }
 
+// The GL runner outputs unique_ptrs, which the calculator sends by value.
+template <typename T>
+T Unwrap(T value) {
+  return value;
+}
+template <typename T>
+T Unwrap(std::unique_ptr<T> value) {
+  return std::move(*value);
+}
+
 template <typename ImageT>
 class WarpAffineRunnerHolder {};
 
@@ -61,15 +75,20 @@ template <>
 class WarpAffineRunnerHolder<ImageFrame> {
  public:
   using RunnerType = AffineTransformation::Runner<ImageFrame, ImageFrame>;
-  absl::Status Open(CalculatorContext* cc) { return absl::OkStatus(); }
+  absl::Status Open(CalculatorContext* cc) {
+    auto pool = cc->Service(kImageFrameMultiPoolService);
+    if (pool.IsAvailable()) pool_ = &pool.GetObject();
+    return absl::OkStatus();
+  }
   absl::StatusOr<RunnerType*> GetRunner() {
     if (!runner_) {
-      ASSIGN_OR_RETURN(runner_, CreateAffineTransformationOpenCvRunner());
+      ASSIGN_OR_RETURN(runner_, CreateAffineTransformationOpenCvRunner(pool_));
     }
     return runner_.get();
   }
 
  private:
+  ImageFrameMultiPool* pool_ = nullptr;
   std::unique_ptr<RunnerType> runner_;
 };
 #endif  // !MEDIAPIPE_DISABLE_OPENCV
@@ -141,21 +160,59 @@ class WarpAffineRunnerHolder<mediapipe::Image> {
       }
 #if !MEDIAPIPE_DISABLE_OPENCV
       ASSIGN_OR_RETURN(auto* runner, cpu_holder_.GetRunner());
-      const auto& frame_ptr = input.GetImageFrameSharedPtr();
-      // Wrap image into image frame.
-      const ImageFrame image_frame(frame_ptr->Format(), frame_ptr->Width(),
-                                   frame_ptr->Height(), frame_ptr->WidthStep(),
-                                   const_cast<uint8_t*>(frame_ptr->PixelData()),
-                                   [](uint8* data){});
-      ASSIGN_OR_RETURN(auto result,
-                       runner->Run(image_frame, matrix, size, border_mode));
+      ASSIGN_OR_RETURN(auto result, runner->Run(WrapImageFrame(input), matrix,
+                                                size, border_mode));
       return mediapipe::Image(std::make_shared<ImageFrame>(std::move(result)));
 #else
       return absl::UnavailableError("OpenCV support is disabled");
 #endif  // !MEDIAPIPE_DISABLE_OPENCV
     }
 
+    absl::StatusOr<std::vector<mediapipe::Image>> RunBatch(
+        const mediapipe::Image& input,
+        const std::vector<std::array<float, 16>>& matrices,
+        const AffineTransformation::Size& size,
+        AffineTransformation::BorderMode border_mode) override {
+      std::vector<mediapipe::Image> images;
+      images.reserve(matrices.size());
+      if (input.UsesGpu()) {
+#if !MEDIAPIPE_DISABLE_GPU
+        ASSIGN_OR_RETURN(auto* runner, gpu_holder_.GetRunner());
+        ASSIGN_OR_RETURN(auto results,
+                         runner->RunBatch(input.GetGpuBuffer(), matrices, size,
+                                          border_mode));
+        for (auto& result : results) images.emplace_back(*result);
+        return images;
+#else
+        return absl::UnavailableError("GPU support is disabled");
+#endif  // !MEDIAPIPE_DISABLE_GPU
+      }
+#if !MEDIAPIPE_DISABLE_OPENCV
+      ASSIGN_OR_RETURN(auto* runner, cpu_holder_.GetRunner());
+      ASSIGN_OR_RETURN(auto results,
+                       runner->RunBatch(WrapImageFrame(input), matrices, size,
+                                        border_mode));
+      for (auto& result : results) {
+        images.emplace_back(std::make_shared<ImageFrame>(std::move(result)));
+      }
+      return images;
+#else
+      return absl::UnavailableError("OpenCV support is disabled");
+#endif  // !MEDIAPIPE_DISABLE_OPENCV
+    }
+
    private:
+#if !MEDIAPIPE_DISABLE_OPENCV
+    // Wraps the pixels of a CPU image into an image frame.
+    static ImageFrame WrapImageFrame(const mediapipe::Image& input) {
+      const auto& frame_ptr = input.GetImageFrameSharedPtr();
+      return ImageFrame(frame_ptr->Format(), frame_ptr->Width(),
+                        frame_ptr->Height(), frame_ptr->WidthStep(),
+                        const_cast<uint8_t*>(frame_ptr->PixelData()),
+                        [](uint8* data) {});
+    }
+#endif  // !MEDIAPIPE_DISABLE_OPENCV
+
 #if !MEDIAPIPE_DISABLE_OPENCV
     WarpAffineRunnerHolder<ImageFrame> cpu_holder_;
 #endif  // !MEDIAPIPE_DISABLE_OPENCV
@@ -170,36 +227,66 @@ class WarpAffineRunnerHolder<mediapipe::Image> {
 template <typename InterfaceT>
 class WarpAffineCalculatorImpl : public mediapipe::api2::NodeImpl<InterfaceT> {
  public:
-#if !MEDIAPIPE_DISABLE_GPU
   static absl::Status UpdateContract(CalculatorContract* cc) {
+#if !MEDIAPIPE_DISABLE_GPU
     if constexpr (std::is_same_v<InterfaceT, WarpAffineCalculatorGpu> ||
                   std::is_same_v<InterfaceT, WarpAffineCalculator>) {
       MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
     }
+#endif  // !MEDIAPIPE_DISABLE_GPU
+#if !MEDIAPIPE_DISABLE_OPENCV
+    if constexpr (std::is_same_v<InterfaceT, WarpAffineCalculatorCpu> ||
+                  std::is_same_v<InterfaceT, WarpAffineCalculator>) {
+      UseImageFrameMultiPool(cc);
+    }
+#endif  // !MEDIAPIPE_DISABLE_OPENCV
+    RET_CHECK(InterfaceT::kMatrix(cc).IsConnected() ^
+              InterfaceT::kMatrices(cc).IsConnected())
+        << "One and only one of MATRIX and MATRICES is expected.";
+    RET_CHECK_EQ(InterfaceT::kMatrix(cc).IsConnected(),
+                 InterfaceT::kOutImage(cc).IsConnected())
+        << "IMAGE output requires MATRIX input.";
+    RET_CHECK_EQ(InterfaceT::kMatrices(cc).IsConnected(),
+                 InterfaceT::kOutImages(cc).IsConnected())
+        << "IMAGES output requires MATRICES input.";
     return absl::OkStatus();
   }
-#endif  // !MEDIAPIPE_DISABLE_GPU
 
   absl::Status Open(CalculatorContext* cc) override { return holder_.Open(cc); }
 
   absl::Status Process(CalculatorContext* cc) override {
+    const bool batched = InterfaceT::kMatrices(cc).IsConnected();
     if (InterfaceT::kInImage(cc).IsEmpty() ||
-        InterfaceT::kMatrix(cc).IsEmpty() ||
-        InterfaceT::kOutputSize(cc).IsEmpty()) {
+        InterfaceT::kOutputSize(cc).IsEmpty() ||
+        (batched ? InterfaceT::kMatrices(cc).IsEmpty() ||
+                       InterfaceT::kMatrices(cc)->empty()
+                 : InterfaceT::kMatrix(cc).IsEmpty())) {
       return absl::OkStatus();
     }
-    const std::array<float, 16>& transform = *InterfaceT::kMatrix(cc);
     auto [out_width, out_height] = *InterfaceT::kOutputSize(cc);
     AffineTransformation::Size output_size;
     output_size.width = out_width;
     output_size.height = out_height;
+    const AffineTransformation::BorderMode border_mode = GetBorderMode(
+        cc->Options<mediapipe::WarpAffineCalculatorOptions>().border_mode());
     ASSIGN_OR_RETURN(auto* runner, holder_.GetRunner());
-    ASSIGN_OR_RETURN(
-        auto result,
-        runner->Run(
-            *InterfaceT::kInImage(cc), transform, output_size,
-            GetBorderMode(cc->Options<mediapipe::WarpAffineCalculatorOptions>()
-                              .border_mode())));
+    if (batched) {
+      ASSIGN_OR_RETURN(auto results,
+                       runner->RunBatch(*InterfaceT::kInImage(cc),
+                                        *InterfaceT::kMatrices(cc),
+                                        output_size, border_mode));
+      std::vector<typename decltype(InterfaceT::kInImage)::PayloadT> images;
+      images.reserve(results.size());
+      for (auto& result : results) {
+        images.push_back(Unwrap(std::move(result)));
+      }
+      InterfaceT::kOutImages(cc).Send(std::move(images));
+      return absl::OkStatus();
+    }
+    const std::array<float, 16>& transform = *InterfaceT::kMatrix(cc);
+    ASSIGN_OR_RETURN(auto result,
+                     runner->Run(*InterfaceT::kInImage(cc), transform,
+                                 output_size, border_mode));
     InterfaceT::kOutImage(cc).Send(std::move(result));
 
     return absl::OkStatus();
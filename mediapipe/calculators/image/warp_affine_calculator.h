@@ -15,6 +15,10 @@
 #ifndef MEDIAPIPE_CALCULATORS_IMAGE_WARP_AFFINE_CALCULATOR_H_
 #define MEDIAPIPE_CALCULATORS_IMAGE_WARP_AFFINE_CALCULATOR_H_
 
+#include <array>
+#include <utility>
+#include <vector>
+
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/formats/image.h"
@@ -37,11 +41,22 @@ namespace mediapipe {
 //                            matrix[4] * x + matrix[5] * y + matrix[7])
 //     where x and y ranges are defined by @OUTPUT_SIZE.
 //
+//   MATRICES - std::vector<std::array<float, 16>>
+//     Used instead of MATRIX to warp the image with several matrices, e.g. to
+//     align all the faces in a frame. The input is uploaded or mapped once for
+//     all of them: on GPU the warps are consecutive draws with the same input
+//     texture, on CPU they run in parallel. Nothing is output for an empty
+//     vector.
+//
 //   OUTPUT_SIZE - std::pair<int, int>
 //     Size of the output image.
 //
 // Output:
 //   IMAGE - Image/ImageFrame/GpuBuffer
+//     The transformed image, with MATRIX.
+//
+//   IMAGES - std::vector<Image/ImageFrame/GpuBuffer>
+//     The transformed image for each of the MATRICES.
 //
 //   Note:
 //   - Output image type and format are the same as the input one.
@@ -63,18 +78,24 @@ template <typename ImageT>
 class WarpAffineCalculatorIntf : public mediapipe::api2::NodeIntf {
  public:
   static constexpr mediapipe::api2::Input<ImageT> kInImage{"IMAGE"};
-  static constexpr mediapipe::api2::Input<std::array<float, 16>> kMatrix{
-      "MATRIX"};
+  static constexpr mediapipe::api2::Input<std::array<float, 16>>::Optional
+      kMatrix{"MATRIX"};
+  static constexpr mediapipe::api2::Input<
+      std::vector<std::array<float, 16>>>::Optional kMatrices{"MATRICES"};
   static constexpr mediapipe::api2::Input<std::pair<int, int>> kOutputSize{
       "OUTPUT_SIZE"};
-  static constexpr mediapipe::api2::Output<ImageT> kOutImage{"IMAGE"};
+  static constexpr typename mediapipe::api2::Output<ImageT>::Optional
+      kOutImage{"IMAGE"};
+  static constexpr
+      typename mediapipe::api2::Output<std::vector<ImageT>>::Optional
+          kOutImages{"IMAGES"};
 };
 
 #if !MEDIAPIPE_DISABLE_OPENCV
 class WarpAffineCalculatorCpu : public WarpAffineCalculatorIntf<ImageFrame> {
  public:
   MEDIAPIPE_NODE_INTERFACE(WarpAffineCalculatorCpu, kInImage, kMatrix,
-                           kOutputSize, kOutImage);
+                           kMatrices, kOutputSize, kOutImage, kOutImages);
 };
 #endif  // !MEDIAPIPE_DISABLE_OPENCV
 #if !MEDIAPIPE_DISABLE_GPU
@@ -82,13 +103,13 @@ class WarpAffineCalculatorGpu
     : public WarpAffineCalculatorIntf<mediapipe::GpuBuffer> {
  public:
   MEDIAPIPE_NODE_INTERFACE(WarpAffineCalculatorGpu, kInImage, kMatrix,
-                           kOutputSize, kOutImage);
+                           kMatrices, kOutputSize, kOutImage, kOutImages);
 };
 #endif  // !MEDIAPIPE_DISABLE_GPU
 class WarpAffineCalculator : public WarpAffineCalculatorIntf<mediapipe::Image> {
  public:
-  MEDIAPIPE_NODE_INTERFACE(WarpAffineCalculator, kInImage, kMatrix, kOutputSize,
-                           kOutImage);
+  MEDIAPIPE_NODE_INTERFACE(WarpAffineCalculator, kInImage, kMatrix, kMatrices,
+                           kOutputSize, kOutImage, kOutImages);
 };
 
 }  // namespace mediapipe
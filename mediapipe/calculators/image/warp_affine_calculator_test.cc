@@ -611,5 +611,74 @@ TEST(WarpAffineCalculatorTest, NoOpBorderZero) {
           out_width, out_height, border_mode);
 }
 
+TEST(WarpAffineCalculatorTest, MultipleMatrices) {
+  auto input = GetRgb(
+      "/mediapipe/calculators/"
+      "tensor/testdata/image_to_tensor/input.jpg");
+  const int out_width = 256;
+  const int out_height = 256;
+  mediapipe::NormalizedRect roi;
+  roi.set_x_center(0.65f);
+  roi.set_y_center(0.4f);
+  roi.set_width(0.5f);
+  roi.set_height(0.5f);
+  roi.set_rotation(0);
+  mediapipe::NormalizedRect rotated_roi = roi;
+  rotated_roi.set_rotation(M_PI * 90.0f / 180.0f);
+  std::vector<std::array<float, 16>> matrices = {
+      GetMatrix(input, roi, /*keep_aspect_ratio=*/true, out_width, out_height),
+      GetMatrix(input, rotated_roi, /*keep_aspect_ratio=*/true, out_width,
+                out_height)};
+  std::vector<cv::Mat> expected_outputs = {
+      GetRgb("/mediapipe/calculators/"
+             "tensor/testdata/image_to_tensor/medium_sub_rect_keep_aspect.png"),
+      GetRgb("/mediapipe/calculators/"
+             "tensor/testdata/image_to_tensor/"
+             "medium_sub_rect_keep_aspect_with_rotation.png")};
+
+  auto graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input_image"
+        input_stream: "output_size"
+        input_stream: "matrices"
+        node {
+          calculator: "WarpAffineCalculatorCpu"
+          input_stream: "IMAGE:input_image"
+          input_stream: "MATRICES:matrices"
+          input_stream: "OUTPUT_SIZE:output_size"
+          output_stream: "IMAGES:output_images"
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("output_images", &graph_config, &output_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  ImageFrame input_image(ImageFormat::SRGB, input.cols, input.rows, input.step,
+                         input.data, [](uint8*) {});
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input_image",
+      MakePacket<ImageFrame>(std::move(input_image)).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "matrices", MakePacket<std::vector<std::array<float, 16>>>(matrices)
+                      .At(Timestamp(0))));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "output_size", MakePacket<std::pair<int, int>>(
+                         std::pair<int, int>(out_width, out_height))
+                         .At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_THAT(output_packets, testing::SizeIs(1));
+  const auto& out_frames = output_packets[0].Get<std::vector<ImageFrame>>();
+  ASSERT_EQ(out_frames.size(), 2);
+  for (int i = 0; i < 2; ++i) {
+    cv::Mat result = formats::MatView(&out_frames[i]);
+    double similarity = 1.0 - cv::norm(result, expected_outputs[i],
+                                       cv::NORM_RELATIVE | cv::NORM_L2);
+    EXPECT_GE(similarity, 0.99) << "output " << i;
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
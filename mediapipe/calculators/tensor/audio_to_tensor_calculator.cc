@@ -20,13 +20,15 @@
 #include <utility>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "audio/dsp/resampler_q.h"
-#include "audio/dsp/window_functions.h"
 #include "mediapipe/calculators/tensor/audio_to_tensor_calculator.pb.h"
+#include "mediapipe/calculators/tensor/stft_utils.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/framework/api2/port.h"
@@ -36,7 +38,6 @@
 #include "mediapipe/framework/formats/time_series_header.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/time_series_util.h"
-#include "pffft.h"
 
 namespace mediapipe {
 namespace api2 {
@@ -46,34 +47,6 @@ using Options = ::mediapipe::AudioToTensorCalculatorOptions;
 using DftTensorFormat = Options::DftTensorFormat;
 using FlushMode = Options::FlushMode;
 
-std::vector<float> HannWindow(int window_size, bool sqrt_hann) {
-  std::vector<float> hann_window(window_size);
-  audio_dsp::HannWindow().GetPeriodicSamples(window_size, &hann_window);
-  if (sqrt_hann) {
-    absl::c_transform(hann_window, hann_window.begin(),
-                      [](double x) { return std::sqrt(x); });
-  }
-  return hann_window;
-}
-
-// PFFFT only supports transforms for inputs of length N of the form
-// N = (2^a)*(3^b)*(5^c) where b >=0 and c >= 0 and a >= 5 for the real FFT.
-bool IsValidFftSize(int size) {
-  if (size <= 0) {
-    return false;
-  }
-  constexpr int kFactors[] = {2, 3, 5};
-  int factorization[] = {0, 0, 0};
-  int n = static_cast<int>(size);
-  for (int i = 0; i < 3; ++i) {
-    while (n % kFactors[i] == 0) {
-      n = n / kFactors[i];
-      ++factorization[i];
-    }
-  }
-  return factorization[0] >= 5 && n == 1;
-}
-
 }  // namespace
 
 // Converts audio buffers into tensors, possibly with resampling, buffering
@@ -201,32 +174,45 @@ class AudioToTensorCalculator : public Node {
   audio_dsp::QResamplerParams params_;
   // A QResampler instance to resample an audio stream.
   std::unique_ptr<audio_dsp::QResampler<float>> resampler_;
-  Matrix sample_buffer_;
+  // The buffered samples in the streaming mode.
+  time_series_util::TimeSeriesRingBuffer sample_buffer_;
+  // Holds frames that wrap around the end of sample_buffer_.
+  Matrix frame_scratch_;
   int processed_buffer_cols_ = 0;
 
-  // The internal state of the FFT library.
-  PFFFT_Setup* fft_state_ = nullptr;
   int fft_size_ = 0;
-  std::vector<float> fft_window_;
-  std::vector<float, Eigen::aligned_allocator<float>> fft_input_buffer_;
-  // pffft requires memory to work with to avoid using the stack.
-  std::vector<float, Eigen::aligned_allocator<float>> fft_workplace_;
-  std::vector<float, Eigen::aligned_allocator<float>> fft_output_;
+  // Set if the calculator outputs fft tensors.
+  std::unique_ptr<WindowedRealFft> fft_;
 
   absl::Status ProcessStreamingData(CalculatorContext* cc, const Matrix& input);
   absl::Status ProcessNonStreamingData(CalculatorContext* cc,
                                        const Matrix& input);
 
   absl::Status SetupStreamingResampler(double input_sample_rate_);
-  void AppendToSampleBuffer(Matrix buffer_to_append);
+  void AppendToSampleBuffer(const Matrix& buffer_to_append);
   void AppendZerosToSampleBuffer(int num_samples);
 
   absl::StatusOr<std::vector<Tensor>> ConvertToTensor(
-      const Matrix& block, std::vector<int> tensor_dims);
-  absl::Status OutputTensor(const Matrix& block, Timestamp timestamp,
-                            CalculatorContext* cc);
-  absl::Status ProcessBuffer(const Matrix& buffer, bool should_flush,
-                             CalculatorContext* cc);
+      const Eigen::Ref<const Matrix>& block, std::vector<int> tensor_dims);
+  // Converts the DFT in the layout of WindowedRealFft to a tensor of
+  // dft_tensor_format_.
+  absl::StatusOr<std::vector<Tensor>> ConvertDftToTensor(
+      absl::Span<const float> dft);
+  absl::Status OutputTensor(const Eigen::Ref<const Matrix>& block,
+                            Timestamp timestamp, CalculatorContext* cc);
+  // Frames the `buffer_size` samples returned by `get_frame`, which returns
+  // the samples in [first_sample, first_sample + num_samples).
+  absl::Status ProcessBuffer(
+      int buffer_size,
+      absl::FunctionRef<Eigen::Map<const Matrix>(int first_sample,
+                                                 int num_samples)>
+          get_frame,
+      bool should_flush, CalculatorContext* cc);
+  // Frames the streaming sample buffer.
+  absl::Status ProcessSampleBuffer(bool should_flush, CalculatorContext* cc);
+  // Frames a complete, contiguous buffer.
+  absl::Status ProcessContiguousBuffer(const Eigen::Map<const Matrix>& buffer,
+                                       CalculatorContext* cc);
 };
 
 absl::Status AudioToTensorCalculator::UpdateContract(CalculatorContract* cc) {
@@ -272,7 +258,7 @@ absl::Status AudioToTensorCalculator::Open(CalculatorContext* cc) {
   stream_mode_ = options.stream_mode();
   if (stream_mode_) {
     check_inconsistent_timestamps_ = options.check_inconsistent_timestamps();
-    sample_buffer_.resize(num_channels_, Eigen::NoChange);
+    sample_buffer_.Reset(num_channels_);
   }
   padding_samples_before_ = options.padding_samples_before();
   padding_samples_after_ = options.padding_samples_after();
@@ -301,12 +287,12 @@ absl::Status AudioToTensorCalculator::Open(CalculatorContext* cc) {
         << options.fft_size();
     RET_CHECK_EQ(1, num_channels_)
         << "Currently only support applying FFT on mono channel.";
+    RET_CHECK_LE(num_samples_, options.fft_size())
+        << "The audio frames are zero-padded to the FFT size, which must not "
+           "be smaller than num_samples.";
     fft_size_ = options.fft_size();
-    fft_state_ = pffft_new_setup(fft_size_, PFFFT_REAL);
-    fft_window_ = HannWindow(fft_size_, /* sqrt_hann = */ false);
-    fft_input_buffer_.resize(fft_size_);
-    fft_workplace_.resize(fft_size_);
-    fft_output_.resize(fft_size_);
+    fft_ = std::make_unique<WindowedRealFft>(
+        fft_size_, HannWindow(fft_size_, /* sqrt_hann = */ false));
   } else {
     RET_CHECK(!kDcAndNyquistOut(cc).IsConnected())
         << "The DC_AND_NYQUIST output stream can only be connected when the "
@@ -355,13 +341,10 @@ absl::Status AudioToTensorCalculator::Close(CalculatorContext* cc) {
   if (resampler_) {
     Matrix resampled_buffer(num_channels_, 0);
     resampler_->Flush(&resampled_buffer);
-    AppendToSampleBuffer(std::move(resampled_buffer));
+    AppendToSampleBuffer(resampled_buffer);
   }
   AppendZerosToSampleBuffer(padding_samples_after_);
-  MP_RETURN_IF_ERROR(ProcessBuffer(sample_buffer_, /*should_flush=*/true, cc));
-  if (fft_state_) {
-    pffft_destroy_setup(fft_state_);
-  }
+  MP_RETURN_IF_ERROR(ProcessSampleBuffer(/*should_flush=*/true, cc));
   return absl::OkStatus();
 }
 
@@ -390,23 +373,14 @@ absl::Status AudioToTensorCalculator::ProcessStreamingData(
   if (resampler_) {
     Matrix resampled_buffer(num_channels_, 0);
     resampler_->ProcessSamples(input_buffer, &resampled_buffer);
-    AppendToSampleBuffer(std::move(resampled_buffer));
+    AppendToSampleBuffer(resampled_buffer);
   } else {
-    // Tries to consume the input matrix first to avoid extra data copy.
-    auto status_or_matrix = kAudioIn(cc).packet().Consume<Matrix>();
-    if (status_or_matrix.ok()) {
-      Matrix local_matrix(num_channels_, 0);
-      local_matrix.swap(*status_or_matrix.value());
-      AppendToSampleBuffer(std::move(local_matrix));
-    } else {
-      AppendToSampleBuffer(input_buffer);
-    }
+    AppendToSampleBuffer(input_buffer);
   }
 
-  MP_RETURN_IF_ERROR(ProcessBuffer(sample_buffer_, /*should_flush=*/false, cc));
+  MP_RETURN_IF_ERROR(ProcessSampleBuffer(/*should_flush=*/false, cc));
   // Removes the processed samples from the global sample buffer.
-  sample_buffer_ = Matrix(sample_buffer_.rightCols(sample_buffer_.cols() -
-                                                   processed_buffer_cols_ - 1));
+  sample_buffer_.Pop(processed_buffer_cols_ + 1);
   return absl::OkStatus();
 }
 
@@ -423,9 +397,12 @@ absl::Status AudioToTensorCalculator::ProcessNonStreamingData(
         input_frame);
     Eigen::Map<const Matrix> matrix_mapping(resampled.data(), num_channels_,
                                             resampled.size() / num_channels_);
-    return ProcessBuffer(matrix_mapping, /*should_flush=*/true, cc);
+    return ProcessContiguousBuffer(matrix_mapping, cc);
   }
-  return ProcessBuffer(input_frame, /*should_flush=*/true, cc);
+  return ProcessContiguousBuffer(
+      Eigen::Map<const Matrix>(input_frame.data(), input_frame.rows(),
+                               input_frame.cols()),
+      cc);
 }
 
 absl::Status AudioToTensorCalculator::SetupStreamingResampler(
@@ -449,19 +426,16 @@ void AudioToTensorCalculator::AppendZerosToSampleBuffer(int num_samples) {
   if (num_samples == 0) {
     return;
   }
-  sample_buffer_.conservativeResize(Eigen::NoChange,
-                                    sample_buffer_.cols() + num_samples);
-  sample_buffer_.rightCols(num_samples).setZero();
+  sample_buffer_.PushZeros(num_samples);
 }
 
-void AudioToTensorCalculator::AppendToSampleBuffer(Matrix buffer_to_append) {
-  sample_buffer_.conservativeResize(
-      Eigen::NoChange, sample_buffer_.cols() + buffer_to_append.cols());
-  sample_buffer_.rightCols(buffer_to_append.cols()).swap(buffer_to_append);
+void AudioToTensorCalculator::AppendToSampleBuffer(
+    const Matrix& buffer_to_append) {
+  sample_buffer_.Push(buffer_to_append);
 }
 
 absl::StatusOr<std::vector<Tensor>> AudioToTensorCalculator::ConvertToTensor(
-    const Matrix& block, std::vector<int> tensor_dims) {
+    const Eigen::Ref<const Matrix>& block, std::vector<int> tensor_dims) {
   Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape(tensor_dims));
   auto buffer_view = tensor.GetCpuWriteView();
   int total_size = 1;
@@ -478,61 +452,56 @@ absl::StatusOr<std::vector<Tensor>> AudioToTensorCalculator::ConvertToTensor(
   return tensor_vector;
 }
 
-absl::Status AudioToTensorCalculator::OutputTensor(const Matrix& block,
-                                                   Timestamp timestamp,
-                                                   CalculatorContext* cc) {
-  std::vector<Tensor> output_tensor;
-  if (fft_state_) {
-    Eigen::VectorXf time_series_data =
-        Eigen::VectorXf::Map(block.data(), block.size());
-    //  Window on input audio prior to FFT.
-    std::transform(time_series_data.begin(), time_series_data.end(),
-                   fft_window_.begin(), fft_input_buffer_.begin(),
-                   std::multiplies<float>());
-    pffft_transform_ordered(fft_state_, fft_input_buffer_.data(),
-                            fft_output_.data(), fft_workplace_.data(),
-                            PFFFT_FORWARD);
-    if (kDcAndNyquistOut(cc).IsConnected()) {
-      kDcAndNyquistOut(cc).Send(std::make_pair(fft_output_[0], fft_output_[1]),
-                                timestamp);
+absl::StatusOr<std::vector<Tensor>>
+AudioToTensorCalculator::ConvertDftToTensor(absl::Span<const float> dft) {
+  // The real and imagery parts of the bins between DC and Nyquist.
+  const absl::Span<const float> bins = dft.subspan(2);
+  int num_values;
+  switch (dft_tensor_format_) {
+    case Options::WITH_NYQUIST:
+      num_values = fft_size_;
+      break;
+    case Options::WITH_DC_AND_NYQUIST:
+      num_values = fft_size_ + 2;
+      break;
+    case Options::WITHOUT_DC_AND_NYQUIST:
+      num_values = fft_size_ - 2;
+      break;
+    default:
+      return absl::InvalidArgumentError("Unsupported dft tensor format.");
+  }
+  // Writes the DFT into the tensor buffer directly.
+  Tensor tensor(Tensor::ElementType::kFloat32,
+                Tensor::Shape({2, num_values / 2}));
+  {
+    auto buffer_view = tensor.GetCpuWriteView();
+    float* buffer = buffer_view.buffer<float>();
+    if (dft_tensor_format_ == Options::WITH_DC_AND_NYQUIST) {
+      *buffer++ = dft[0];  // DC real part.
+      *buffer++ = 0.0f;    // DC imagery part.
     }
-    switch (dft_tensor_format_) {
-      case Options::WITH_NYQUIST: {
-        Matrix fft_output_matrix =
-            Eigen::Map<const Matrix>(fft_output_.data() + 2, 1, fft_size_ - 2);
-        fft_output_matrix.conservativeResize(Eigen::NoChange, fft_size_);
-        // The last two elements are Nyquist component.
-        fft_output_matrix(fft_size_ - 2) = fft_output_[1];  // Nyquist real part
-        fft_output_matrix(fft_size_ - 1) = 0.0f;  // Nyquist imagery part
-        ASSIGN_OR_RETURN(output_tensor, ConvertToTensor(fft_output_matrix,
-                                                        {2, fft_size_ / 2}));
-        break;
-      }
-      case Options::WITH_DC_AND_NYQUIST: {
-        Matrix fft_output_matrix =
-            Eigen::Map<const Matrix>(fft_output_.data(), 1, fft_size_);
-        fft_output_matrix.conservativeResize(Eigen::NoChange, fft_size_ + 2);
-        fft_output_matrix(1) = 0.0f;  // DC imagery part.
-        // The last two elements are  Nyquist component.
-        fft_output_matrix(fft_size_) = fft_output_[1];  // Nyquist real part
-        fft_output_matrix(fft_size_ + 1) = 0.0f;        // Nyquist imagery part
-        ASSIGN_OR_RETURN(
-            output_tensor,
-            ConvertToTensor(fft_output_matrix, {2, (fft_size_ + 2) / 2}));
-        break;
-      }
-      case Options::WITHOUT_DC_AND_NYQUIST: {
-        Matrix fft_output_matrix =
-            Eigen::Map<const Matrix>(fft_output_.data() + 2, 1, fft_size_ - 2);
-        ASSIGN_OR_RETURN(
-            output_tensor,
-            ConvertToTensor(fft_output_matrix, {2, (fft_size_ - 2) / 2}));
-        break;
-      }
-      default:
-        return absl::InvalidArgumentError("Unsupported dft tensor format.");
+    buffer = std::copy(bins.begin(), bins.end(), buffer);
+    if (dft_tensor_format_ != Options::WITHOUT_DC_AND_NYQUIST) {
+      *buffer++ = dft[1];  // Nyquist real part.
+      *buffer = 0.0f;      // Nyquist imagery part.
     }
+  }
+  std::vector<Tensor> tensor_vector;
+  tensor_vector.push_back(std::move(tensor));
+  return tensor_vector;
+}
 
+absl::Status AudioToTensorCalculator::OutputTensor(
+    const Eigen::Ref<const Matrix>& block, Timestamp timestamp,
+    CalculatorContext* cc) {
+  std::vector<Tensor> output_tensor;
+  if (fft_) {
+    // Windows the audio frame and zero-pads it to the fft size prior to FFT.
+    absl::Span<const float> dft = fft_->Forward(block.data(), block.size());
+    if (kDcAndNyquistOut(cc).IsConnected()) {
+      kDcAndNyquistOut(cc).Send(std::make_pair(dft[0], dft[1]), timestamp);
+    }
+    ASSIGN_OR_RETURN(output_tensor, ConvertDftToTensor(dft));
   } else {
     ASSIGN_OR_RETURN(output_tensor,
                      ConvertToTensor(block, {num_channels_, num_samples_}));
@@ -541,18 +510,44 @@ absl::Status AudioToTensorCalculator::OutputTensor(const Matrix& block,
   return absl::OkStatus();
 }
 
-absl::Status AudioToTensorCalculator::ProcessBuffer(const Matrix& buffer,
-                                                    bool should_flush,
-                                                    CalculatorContext* cc) {
+absl::Status AudioToTensorCalculator::ProcessSampleBuffer(
+    bool should_flush, CalculatorContext* cc) {
+  return ProcessBuffer(
+      sample_buffer_.size(),
+      [this](int first_sample, int num_samples) {
+        return sample_buffer_.GetFrame(first_sample, num_samples,
+                                       &frame_scratch_);
+      },
+      should_flush, cc);
+}
+
+absl::Status AudioToTensorCalculator::ProcessContiguousBuffer(
+    const Eigen::Map<const Matrix>& buffer, CalculatorContext* cc) {
+  return ProcessBuffer(
+      buffer.cols(),
+      [&buffer](int first_sample, int num_samples) {
+        return Eigen::Map<const Matrix>(
+            buffer.data() + static_cast<int64>(first_sample) * buffer.rows(),
+            buffer.rows(), num_samples);
+      },
+      /*should_flush=*/true, cc);
+}
+
+absl::Status AudioToTensorCalculator::ProcessBuffer(
+    int buffer_size,
+    absl::FunctionRef<Eigen::Map<const Matrix>(int first_sample,
+                                               int num_samples)>
+        get_frame,
+    bool should_flush, CalculatorContext* cc) {
   const bool should_flush_at_timestamp_max =
       stream_mode_ && should_flush &&
       flush_mode_ == Options::ENTIRE_TAIL_AT_TIMESTAMP_MAX;
   int next_frame_first_col = 0;
   std::vector<Timestamp> timestamps;
   if (!should_flush_at_timestamp_max) {
-    while (next_frame_first_col + num_samples_ <= buffer.cols()) {
+    while (next_frame_first_col + num_samples_ <= buffer_size) {
       MP_RETURN_IF_ERROR(OutputTensor(
-          buffer.block(0, next_frame_first_col, num_channels_, num_samples_),
+          get_frame(next_frame_first_col, num_samples_),
           next_output_timestamp_, cc));
       timestamps.push_back(next_output_timestamp_);
       next_output_timestamp_ += round(frame_step_ / target_sample_rate_ *
@@ -560,7 +555,7 @@ absl::Status AudioToTensorCalculator::ProcessBuffer(const Matrix& buffer,
       next_frame_first_col += frame_step_;
     }
   }
-  if (should_flush && next_frame_first_col < buffer.cols()) {
+  if (should_flush && next_frame_first_col < buffer_size) {
     // In the streaming mode, the flush happens in Close() and a packet at
     // Timestamp::Max() will be emitted. In the non-streaming mode, each
     // Process() invocation will process the entire buffer completely.
@@ -568,9 +563,8 @@ absl::Status AudioToTensorCalculator::ProcessBuffer(const Matrix& buffer,
                               ? Timestamp::Max()
                               : next_output_timestamp_;
     MP_RETURN_IF_ERROR(OutputTensor(
-        buffer.block(
-            0, next_frame_first_col, num_channels_,
-            std::min(num_samples_, (int)buffer.cols() - next_frame_first_col)),
+        get_frame(next_frame_first_col,
+                  std::min(num_samples_, buffer_size - next_frame_first_col)),
         timestamp, cc));
     timestamps.push_back(timestamp);
   }
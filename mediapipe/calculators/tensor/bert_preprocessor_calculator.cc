@@ -14,7 +14,6 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -26,6 +25,7 @@
 #include "absl/strings/ascii.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/types/span.h"
 #include "mediapipe/calculators/tensor/bert_preprocessor_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
@@ -129,14 +129,15 @@ class BertPreprocessorCalculator : public Node {
   int segment_ids_tensor_index_ = 1;
   int input_masks_tensor_index_ = 2;
 
-  // Applies `tokenizer_` to the `input_text` to generate a vector of tokens.
-  // This util prepends "[CLS]" and appends "[SEP]" to the input tokens and
-  // clips the vector of tokens to have length at most `bert_max_seq_len_`.
-  std::vector<std::string> TokenizeInputText(absl::string_view input_text);
-  // Processes the `input_tokens` to generate the three input tensors for the
-  // BERT model.
-  std::vector<Tensor> GenerateInputTensors(
-      const std::vector<std::string>& input_tokens);
+  // The ids of the "[CLS]" and "[SEP]" tokens.
+  int classifier_token_id_ = 0;
+  int separator_token_id_ = 0;
+
+  // Applies `tokenizer_` to the `input_text` and generates the three input
+  // tensors for the BERT model. The token ids are written directly into the
+  // input ids tensor, prefixed by "[CLS]" and suffixed by "[SEP]", and clipped
+  // to at most `bert_max_seq_len_` ids.
+  std::vector<Tensor> GenerateInputTensors(absl::string_view input_text);
 };
 
 absl::Status BertPreprocessorCalculator::UpdateContract(
@@ -178,70 +179,53 @@ absl::Status BertPreprocessorCalculator::Open(CalculatorContext* cc) {
   const auto& options =
       cc->Options<mediapipe::BertPreprocessorCalculatorOptions>();
   bert_max_seq_len_ = options.bert_max_seq_len();
+  tokenizer_->LookupId(kClassifierToken, &classifier_token_id_);
+  tokenizer_->LookupId(kSeparatorToken, &separator_token_id_);
   return absl::OkStatus();
 }
 
 absl::Status BertPreprocessorCalculator::Process(CalculatorContext* cc) {
-  kTensorsOut(cc).Send(
-      GenerateInputTensors(TokenizeInputText(kTextIn(cc).Get())));
+  kTensorsOut(cc).Send(GenerateInputTensors(kTextIn(cc).Get()));
   return absl::OkStatus();
 }
 
-std::vector<std::string> BertPreprocessorCalculator::TokenizeInputText(
+std::vector<Tensor> BertPreprocessorCalculator::GenerateInputTensors(
     absl::string_view input_text) {
   std::string processed_input = std::string(input_text);
   absl::AsciiStrToLower(&processed_input);
 
-  tasks::text::tokenizers::TokenizerResult tokenizer_result =
-      tokenizer_->Tokenize(processed_input);
-
-  // Offset by 2 to account for [CLS] and [SEP]
-  int input_tokens_size =
-      std::min(bert_max_seq_len_,
-               static_cast<int>(tokenizer_result.subwords.size()) + 2);
-  std::vector<std::string> input_tokens;
-  input_tokens.reserve(input_tokens_size);
-  input_tokens.push_back(std::string(kClassifierToken));
-  for (int i = 0; i < input_tokens_size - 2; ++i) {
-    input_tokens.push_back(std::move(tokenizer_result.subwords[i]));
-  }
-  input_tokens.push_back(std::string(kSeparatorToken));
-  return input_tokens;
-}
-
-std::vector<Tensor> BertPreprocessorCalculator::GenerateInputTensors(
-    const std::vector<std::string>& input_tokens) {
-  std::vector<int32_t> input_ids(bert_max_seq_len_, 0);
-  std::vector<int32_t> segment_ids(bert_max_seq_len_, 0);
-  std::vector<int32_t> input_masks(bert_max_seq_len_, 0);
-  // Convert tokens back into ids and set mask
-  for (int i = 0; i < input_tokens.size(); ++i) {
-    tokenizer_->LookupId(input_tokens[i], &input_ids[i]);
-    input_masks[i] = 1;
-  }
-  //                           |<--------bert_max_seq_len_--------->|
-  // input_ids                 [CLS] s1  s2...  sn [SEP]  0  0...  0
-  // segment_ids                 0    0   0...  0    0    0  0...  0
-  // input_masks                 1    1   1...  1    1    0  0...  0
-
   std::vector<Tensor> input_tensors;
   input_tensors.reserve(kNumInputTensorsForBert);
   for (int i = 0; i < kNumInputTensorsForBert; ++i) {
     input_tensors.push_back(
         {Tensor::ElementType::kInt32, Tensor::Shape({bert_max_seq_len_})});
   }
-  std::memcpy(input_tensors[input_ids_tensor_index_]
-                  .GetCpuWriteView()
-                  .buffer<int32_t>(),
-              input_ids.data(), input_ids.size() * sizeof(int32_t));
-  std::memcpy(input_tensors[segment_ids_tensor_index_]
-                  .GetCpuWriteView()
-                  .buffer<int32_t>(),
-              segment_ids.data(), segment_ids.size() * sizeof(int32_t));
-  std::memcpy(input_tensors[input_masks_tensor_index_]
-                  .GetCpuWriteView()
-                  .buffer<int32_t>(),
-              input_masks.data(), input_masks.size() * sizeof(int32_t));
+  //                           |<--------bert_max_seq_len_--------->|
+  // input_ids                 [CLS] s1  s2...  sn [SEP]  0  0...  0
+  // segment_ids                 0    0   0...  0    0    0  0...  0
+  // input_masks                 1    1   1...  1    1    0  0...  0
+  auto input_ids_view =
+      input_tensors[input_ids_tensor_index_].GetCpuWriteView();
+  int32_t* input_ids = input_ids_view.buffer<int32_t>();
+  std::fill(input_ids, input_ids + bert_max_seq_len_, 0);
+  // Offset by 2 to account for [CLS] and [SEP]
+  const int num_subwords = tokenizer_->TokenizeIds(
+      processed_input,
+      absl::MakeSpan(input_ids + 1, bert_max_seq_len_ - 2));
+  const int num_tokens = num_subwords + 2;
+  input_ids[0] = classifier_token_id_;
+  input_ids[num_tokens - 1] = separator_token_id_;
+
+  auto segment_ids_view =
+      input_tensors[segment_ids_tensor_index_].GetCpuWriteView();
+  int32_t* segment_ids = segment_ids_view.buffer<int32_t>();
+  std::fill(segment_ids, segment_ids + bert_max_seq_len_, 0);
+
+  auto input_masks_view =
+      input_tensors[input_masks_tensor_index_].GetCpuWriteView();
+  int32_t* input_masks = input_masks_view.buffer<int32_t>();
+  std::fill(input_masks, input_masks + num_tokens, 1);
+  std::fill(input_masks + num_tokens, input_masks + bert_max_seq_len_, 0);
   return input_tensors;
 }
 
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <utility>
 
@@ -92,6 +93,15 @@ class FeedbackTensorsCalculator : public Node {
   }
 
  private:
+  static Tensor CopyTensor(const Tensor& tensor) {
+    Tensor copy(tensor.element_type(), tensor.shape());
+    auto read_view = tensor.GetCpuReadView();
+    auto write_view = copy.GetCpuWriteView();
+    std::memcpy(write_view.buffer<char>(), read_view.buffer<char>(),
+                tensor.bytes());
+    return copy;
+  }
+
   absl::Status AddInputTensors(CalculatorContext* cc,
                                std::vector<Tensor>& outputs) {
     absl::StatusOr<std::unique_ptr<std::vector<Tensor>>> input_tensors =
@@ -100,7 +110,12 @@ class FeedbackTensorsCalculator : public Node {
             .Value()
             .Consume<std::vector<Tensor>>();
     if (!input_tensors.ok()) {
-      return absl::InternalError("The input tensors packet is not consumable");
+      // The input packet is shared with other calculators, e.g. when it also
+      // drives the loopback of the feedback tensors, so it is copied instead.
+      for (const Tensor& input : *kInputTensorsIn(cc)) {
+        outputs.push_back(CopyTensor(input));
+      }
+      return absl::OkStatus();
     }
     RET_CHECK(*input_tensors);
     std::vector<Tensor>& inputs = **input_tensors;
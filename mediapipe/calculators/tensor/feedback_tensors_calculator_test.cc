@@ -154,6 +154,56 @@ TEST(FeedbackTensorsCalculatorTest, AppendsFeedback) {
       /*expected_values=*/{-1.f, -2.f, -3.f, -4.f, -5.f, -6.f});
 }
 
+TEST(FeedbackTensorsCalculatorTest, CopiesSharedInputTensors) {
+  auto graph_config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "input"
+    input_stream: "feedback"
+    node {
+      calculator: "FeedbackTensorsCalculator"
+      input_stream: "INPUT_TENSORS:input"
+      input_stream: "FEEDBACK_TENSORS:feedback"
+      output_stream: "TENSORS:output"
+      options: {
+        [mediapipe.FeedbackTensorsCalculatorOptions.ext] {
+          feedback_tensor_shape: { dims: 2 }
+          location: APPENDED
+        }
+      }
+    }
+  )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("output", &graph_config, &output_packets);
+  // Also consuming the input in another node keeps it from being moved.
+  std::vector<Packet> input_packets;
+  tool::AddVectorSink("input", &graph_config, &input_packets);
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  auto input_tensors = std::make_unique<Tensors>();
+  input_tensors->push_back(MakeTensor<float>({3}, {1.f, 2.f, 3.f}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input", Adopt(input_tensors.release()).At(Timestamp(1))));
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams())
+      << "Couldn't close the graph inputs";
+  MP_ASSERT_OK(graph.WaitUntilDone()) << "Couldn't finalize the graph run";
+
+  ASSERT_EQ(output_packets.size(), 1);
+  const Tensors& combined_tensors = output_packets[0].Get<Tensors>();
+  ASSERT_EQ(combined_tensors.size(), 2);
+  ValidateTensor<float>(combined_tensors[0], /*expected_shape=*/{3},
+                        /*expected_values=*/{1.f, 2.f, 3.f});
+  ValidateTensor<float>(combined_tensors[1], /*expected_shape=*/{2},
+                        /*expected_values=*/{0.f, 0.f});
+  // The other consumer still sees the original tensors.
+  ASSERT_EQ(input_packets.size(), 1);
+  ValidateTensor<float>(input_packets[0].Get<Tensors>()[0],
+                        /*expected_shape=*/{3},
+                        /*expected_values=*/{1.f, 2.f, 3.f});
+}
+
 TEST(FeedbackTensorsCalculatorTest, PrependsFeedback) {
   auto graph_config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
     input_stream: "input"
@@ -13,23 +13,34 @@
 // limitations under the License.
 
 #include <array>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "libyuv/video_common.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_cpu_kernel.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/calculators/tensor/tensor_element_utils.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/yuv_image.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/tensor_pool_service.h"
 #include "mediapipe/gpu/gpu_origin.pb.h"
 
 #if !MEDIAPIPE_DISABLE_OPENCV
@@ -54,6 +65,106 @@
 namespace mediapipe {
 namespace api2 {
 
+namespace {
+
+// Returns a view of an 8-bit 4:2:0 YUV image, in any plane layout.
+absl::StatusOr<YuvImageView> GetYuvImageView(const YUVImage& image) {
+  RET_CHECK_EQ(image.bit_depth(), 8)
+      << "Only 8-bit YUV images are supported.";
+  YuvImageView view;
+  view.y_data = image.data(0);
+  view.y_stride = image.stride(0);
+  view.width = image.width();
+  view.height = image.height();
+  switch (image.fourcc()) {
+    case libyuv::FOURCC_NV12:
+    case libyuv::FOURCC_NV21: {
+      // Chroma samples are interleaved in the second plane.
+      const bool uv = image.fourcc() == libyuv::FOURCC_NV12;
+      view.u_data = image.data(1) + (uv ? 0 : 1);
+      view.v_data = image.data(1) + (uv ? 1 : 0);
+      view.uv_stride = image.stride(1);
+      view.uv_pixel_stride = 2;
+      break;
+    }
+    case libyuv::FOURCC_I420:
+    case libyuv::FOURCC_YV12: {
+      const bool uv = image.fourcc() == libyuv::FOURCC_I420;
+      view.u_data = image.data(uv ? 1 : 2);
+      view.v_data = image.data(uv ? 2 : 1);
+      RET_CHECK_EQ(image.stride(1), image.stride(2));
+      view.uv_stride = image.stride(1);
+      view.uv_pixel_stride = 1;
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unsupported YUV image fourcc: ", static_cast<int>(image.fourcc())));
+  }
+  // Other color matrices are converted as BT.601, which most cameras use.
+  const bool bt709 = image.matrix_coefficients() ==
+                     YUVImage::COLOR_MATRIX_COEFFICIENTS_BT709;
+  if (image.full_range()) {
+    view.color_space = bt709 ? YuvColorSpace::kBt709FullRange
+                             : YuvColorSpace::kBt601FullRange;
+  } else {
+    view.color_space = bt709 ? YuvColorSpace::kBt709LimitedRange
+                             : YuvColorSpace::kBt601LimitedRange;
+  }
+  return view;
+}
+
+// The outputs of a conversion with share_output.
+struct SharedOutput {
+  // The converted image, which identifies the conversion with the key.
+  mediapipe::Image image;
+  // The serialized options and rects.
+  std::string key;
+  Packet<std::vector<Tensor>> tensors;
+  std::vector<std::array<float, 4>> paddings;
+  std::vector<std::array<float, 16>> matrices;
+};
+
+// The latest outputs of conversions with share_output across the process.
+// The entries keep their images alive, so that an image can't be freed and
+// another one allocated at its address while it is compared with.
+class SharedOutputs {
+ public:
+  static SharedOutputs& Get() {
+    static NoDestructor<SharedOutputs> shared_outputs;
+    return *shared_outputs;
+  }
+
+  absl::optional<SharedOutput> Find(const mediapipe::Image& image,
+                                    const std::string& key) {
+    absl::MutexLock lock(&mutex_);
+    for (const SharedOutput& output : outputs_) {
+      if (output.image == image && output.key == key) return output;
+    }
+    return absl::nullopt;
+  }
+
+  void Add(SharedOutput output) {
+    absl::MutexLock lock(&mutex_);
+    // Another calculator may have converted the image meanwhile.
+    for (const SharedOutput& other : outputs_) {
+      if (other.image == output.image && other.key == output.key) return;
+    }
+    if (outputs_.size() == kMaxOutputs) outputs_.pop_front();
+    outputs_.push_back(std::move(output));
+  }
+
+ private:
+  // Enough for the conversions of a few tasks on a couple of frames in
+  // flight.
+  static constexpr int kMaxOutputs = 16;
+
+  absl::Mutex mutex_;
+  std::deque<SharedOutput> outputs_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
 // Converts image into Tensor, possibly with cropping, resizing and
 // normalization, according to specified inputs and options.
 //
@@ -62,22 +173,33 @@ namespace api2 {
 //           ImageFrame [ImageFormat::SRGB/SRGBA] (for backward compatibility
 //           with existing graphs that use IMAGE for ImageFrame input)
 //   IMAGE_GPU - GpuBuffer [GpuBufferFormat::kBGRA32]
+//   YUV_IMAGE - YUVImage [NV12, NV21, I420, YV12 with 8 bits]
 //     Image to extract from.
 //
 //   Note:
-//   - One and only one of IMAGE and IMAGE_GPU should be specified.
+//   - One and only one of IMAGE, IMAGE_GPU and YUV_IMAGE should be specified.
 //   - IMAGE input of type Image is processed on GPU if the data is already on
 //     GPU (i.e., Image::UsesGpu() returns true), or otherwise processed on CPU.
 //   - IMAGE input of type ImageFrame is always processed on CPU.
 //   - IMAGE_GPU input (of type GpuBuffer) is always processed on GPU.
+//   - YUV_IMAGE input is processed on CPU, converting to RGB while sampling
+//     the rect, without converting the whole image first. Images with
+//     BT.709 matrix coefficients are converted as such, any other as BT.601.
 //
 //   NORM_RECT - NormalizedRect @Optional
 //     Describes region of image to extract.
 //     @Optional: rect covering the whole image is used if not specified.
+//   NORM_RECTS - std::vector<NormalizedRect> @Optional
+//     Describes regions of image to extract into one batched tensor, e.g. for
+//     all the hands or faces detected in the image. Nothing is output for an
+//     empty vector. Can't be combined with NORM_RECT, MATRIX and
+//     LETTERBOX_PADDING.
 //
 // Outputs:
 //   TENSORS - std::vector<Tensor>
 //     Vector containing a single Tensor populated with an extrated RGB image.
+//     With NORM_RECTS, the tensor has a batch dimension of the number of
+//     rects, holding the image extracted for each rect.
 //   MATRIX - std::array<float, 16> @Optional
 //     An std::array<float, 16> representing a 4x4 row-major-order matrix that
 //     maps a point on the input image to a point on the output tensor, and
@@ -94,6 +216,9 @@ namespace api2 {
 //     20x20 and places it in the middle of the output image with an equal
 //     padding of 10 pixels at the top and the bottom. The resulting array is
 //     therefore [0.f, 0.25f, 0.f, 0.25f] (10/40 = 0.25f).
+//   MATRICES - std::vector<std::array<float, 16>> @Optional
+//   LETTERBOX_PADDINGS - std::vector<std::array<float, 4>> @Optional
+//     The MATRIX and LETTERBOX_PADDING of each of the NORM_RECTS.
 //
 // Example:
 // node {
@@ -120,23 +245,53 @@ class ImageToTensorCalculator : public Node {
   static constexpr Input<
       OneOf<mediapipe::Image, mediapipe::ImageFrame>>::Optional kIn{"IMAGE"};
   static constexpr Input<GpuBuffer>::Optional kInGpu{"IMAGE_GPU"};
+  static constexpr Input<YUVImage>::Optional kInYuv{"YUV_IMAGE"};
   static constexpr Input<mediapipe::NormalizedRect>::Optional kInNormRect{
       "NORM_RECT"};
+  static constexpr Input<std::vector<mediapipe::NormalizedRect>>::Optional
+      kInNormRects{"NORM_RECTS"};
   static constexpr Output<std::vector<Tensor>> kOutTensors{"TENSORS"};
   static constexpr Output<std::array<float, 4>>::Optional kOutLetterboxPadding{
       "LETTERBOX_PADDING"};
   static constexpr Output<std::array<float, 16>>::Optional kOutMatrix{"MATRIX"};
+  static constexpr Output<std::vector<std::array<float, 4>>>::Optional
+      kOutLetterboxPaddings{"LETTERBOX_PADDINGS"};
+  static constexpr Output<std::vector<std::array<float, 16>>>::Optional
+      kOutMatrices{"MATRICES"};
 
-  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInNormRect, kOutTensors,
-                          kOutLetterboxPadding, kOutMatrix);
+  MEDIAPIPE_NODE_CONTRACT(kIn, kInGpu, kInYuv, kInNormRect, kInNormRects, kOutTensors,
+                          kOutLetterboxPadding, kOutMatrix,
+                          kOutLetterboxPaddings, kOutMatrices);
 
   static absl::Status UpdateContract(CalculatorContract* cc) {
     const auto& options =
         cc->Options<mediapipe::ImageToTensorCalculatorOptions>();
 
     RET_CHECK_OK(ValidateOptionOutputDims(options));
-    RET_CHECK(kIn(cc).IsConnected() ^ kInGpu(cc).IsConnected())
-        << "One and only one of IMAGE and IMAGE_GPU input is expected.";
+    RET_CHECK_EQ(options.input_rotation_degrees() % 90, 0)
+        << "input_rotation_degrees must be a multiple of 90.";
+    RET_CHECK_EQ(kIn(cc).IsConnected() + kInGpu(cc).IsConnected() +
+                     kInYuv(cc).IsConnected(),
+                 1)
+        << "One and only one of IMAGE, IMAGE_GPU and YUV_IMAGE input is "
+           "expected.";
+    if (kInNormRects(cc).IsConnected()) {
+      RET_CHECK(!kInNormRect(cc).IsConnected() &&
+                !kOutLetterboxPadding(cc).IsConnected() &&
+                !kOutMatrix(cc).IsConnected())
+          << "NORM_RECTS can't be combined with NORM_RECT, LETTERBOX_PADDING "
+             "and MATRIX.";
+    } else {
+      RET_CHECK(!kOutLetterboxPaddings(cc).IsConnected() &&
+                !kOutMatrices(cc).IsConnected())
+          << "LETTERBOX_PADDINGS and MATRICES require NORM_RECTS.";
+    }
+    // Sets up the converters without waiting for the upstream nodes to be
+    // opened.
+    cc->SetInputStreamHeadersNeeded(false);
+    UseTensorPool(cc);
+    // Shared outputs are only reused for identical conversions.
+    cc->SetStateless(true);
 
 #if MEDIAPIPE_DISABLE_GPU
     if (kInGpu(cc).IsConnected()) {
@@ -162,19 +317,26 @@ class ImageToTensorCalculator : public Node {
 
   absl::Status Process(CalculatorContext* cc) {
     if ((kIn(cc).IsConnected() && kIn(cc).IsEmpty()) ||
-        (kInGpu(cc).IsConnected() && kInGpu(cc).IsEmpty())) {
+        (kInGpu(cc).IsConnected() && kInGpu(cc).IsEmpty()) ||
+        (kInYuv(cc).IsConnected() && kInYuv(cc).IsEmpty())) {
       // Timestamp bound update happens automatically.
       return absl::OkStatus();
     }
 
-    absl::optional<mediapipe::NormalizedRect> norm_rect;
-    if (kInNormRect(cc).IsConnected()) {
+    std::vector<absl::optional<mediapipe::NormalizedRect>> norm_rects;
+    if (kInNormRects(cc).IsConnected()) {
+      if (kInNormRects(cc).IsEmpty() || kInNormRects(cc)->empty()) {
+        // Timestamp bound update happens automatically.
+        return absl::OkStatus();
+      }
+      norm_rects.assign(kInNormRects(cc)->begin(), kInNormRects(cc)->end());
+    } else if (kInNormRect(cc).IsConnected()) {
       if (kInNormRect(cc).IsEmpty()) {
         // Timestamp bound update happens automatically. (See Open().)
         return absl::OkStatus();
       }
-      norm_rect = *kInNormRect(cc);
-      if (norm_rect->width() == 0 && norm_rect->height() == 0) {
+      const mediapipe::NormalizedRect& norm_rect = *kInNormRect(cc);
+      if (norm_rect.width() == 0 && norm_rect.height() == 0) {
         // WORKAROUND: some existing graphs may use sentinel rects {width=0,
         // height=0, ...} quite often and calculator has to handle them
         // gracefully by updating timestamp bound instead of returning failure.
@@ -184,6 +346,13 @@ class ImageToTensorCalculator : public Node {
             << "Updating timestamp bound in response to a sentinel rect";
         return absl::OkStatus();
       }
+      norm_rects.push_back(norm_rect);
+    } else {
+      norm_rects.push_back(absl::nullopt);
+    }
+
+    if (kInYuv(cc).IsConnected()) {
+      return ProcessYuvImage(cc, *kInYuv(cc), norm_rects);
     }
 
 #if MEDIAPIPE_DISABLE_GPU
@@ -194,42 +363,182 @@ class ImageToTensorCalculator : public Node {
                                               : GetInputImage(kIn(cc)));
 #endif  // MEDIAPIPE_DISABLE_GPU
 
-    RotatedRect roi = GetRoi(image->width(), image->height(), norm_rect);
-    ASSIGN_OR_RETURN(auto padding, PadRoi(options_.output_tensor_width(),
-                                          options_.output_tensor_height(),
-                                          options_.keep_aspect_ratio(), &roi));
-    if (kOutLetterboxPadding(cc).IsConnected()) {
-      kOutLetterboxPadding(cc).Send(padding);
-    }
-    if (kOutMatrix(cc).IsConnected()) {
-      std::array<float, 16> matrix;
-      GetRotatedSubRectToRectTransformMatrix(
-          roi, image->width(), image->height(),
-          /*flip_horizontaly=*/false, &matrix);
-      kOutMatrix(cc).Send(std::move(matrix));
+    // Only the conversions of Images on CPU are shared: an ImageFrame or a
+    // GpuBuffer is wrapped in a new Image for every packet, and GPU tensors
+    // are bound to the GL context of their graph.
+    std::string share_key;
+    if (options_.share_output() && kIn(cc).IsConnected() &&
+        kIn(cc).Has<mediapipe::Image>() && !image->UsesGpu()) {
+      share_key = GetShareKey(norm_rects);
+      if (auto output = SharedOutputs::Get().Find(*image, share_key)) {
+        SendOutputs(cc, output->tensors, std::move(output->paddings),
+                    std::move(output->matrices));
+        return absl::OkStatus();
+      }
     }
 
     // Lazy initialization of the GPU or CPU converter.
     MP_RETURN_IF_ERROR(InitConverterIfNecessary(cc, *image.get()));
 
+    // All the rects are extracted into one tensor, with a batch dimension of
+    // the number of rects.
+    const int batch_size = norm_rects.size();
     Tensor::ElementType output_tensor_type =
         GetOutputTensorType(image->UsesGpu(), params_);
-    Tensor tensor(output_tensor_type,
-                  {1, params_.output_height, params_.output_width,
-                   GetNumOutputChannels(*image)});
-    MP_RETURN_IF_ERROR((image->UsesGpu() ? gpu_converter_ : cpu_converter_)
-                           ->Convert(*image, roi, params_.range_min,
-                                     params_.range_max,
-                                     /*tensor_buffer_offset=*/0, tensor));
-
-    auto result = std::make_unique<std::vector<Tensor>>();
-    result->push_back(std::move(tensor));
-    kOutTensors(cc).Send(std::move(result));
+    Tensor tensor = AllocateTensor(
+        cc, output_tensor_type,
+        {batch_size, params_.output_height, params_.output_width,
+         GetNumOutputChannels(*image)});
+    const int tensor_buffer_size = tensor.bytes() / batch_size;
+    std::vector<std::array<float, 4>> paddings(batch_size);
+    std::vector<std::array<float, 16>> matrices(batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      ASSIGN_OR_RETURN(RotatedRect roi,
+                       GetInputRoi(image->width(), image->height(),
+                                   norm_rects[i], &paddings[i], &matrices[i]));
+      MP_RETURN_IF_ERROR(
+          (image->UsesGpu() ? gpu_converter_ : cpu_converter_)
+              ->Convert(*image, roi, params_.range_min, params_.range_max,
+                        /*tensor_buffer_offset=*/i * tensor_buffer_size,
+                        tensor));
+    }
 
+    auto tensors = MakeTensorsPacket(std::move(tensor));
+    if (!share_key.empty()) {
+      SharedOutputs::Get().Add(
+          {*image, std::move(share_key), tensors, paddings, matrices});
+    }
+    SendOutputs(cc, std::move(tensors), std::move(paddings),
+                std::move(matrices));
     return absl::OkStatus();
   }
 
  private:
+  // Extracts the rects of a YUV image into an RGB tensor, converting only the
+  // sampled pixels.
+  absl::Status ProcessYuvImage(
+      CalculatorContext* cc, const YUVImage& yuv_image,
+      const std::vector<absl::optional<mediapipe::NormalizedRect>>&
+          norm_rects) {
+    ASSIGN_OR_RETURN(const YuvImageView image, GetYuvImageView(yuv_image));
+    ASSIGN_OR_RETURN(auto transform,
+                     GetValueRangeTransformation(
+                         /*from_range_min=*/0.0f, /*from_range_max=*/255.0f,
+                         params_.range_min, params_.range_max));
+    const BorderMode border_mode = GetBorderMode(options_.border_mode());
+    const Tensor::ElementType tensor_type =
+        GetOutputTensorType(/*uses_gpu=*/false, params_);
+    const int batch_size = norm_rects.size();
+    const int width = params_.output_width;
+    const int height = params_.output_height;
+    const int num_elements = width * height * 3;
+    Tensor tensor =
+        AllocateTensor(cc, tensor_type, {batch_size, height, width, 3});
+    std::vector<std::array<float, 4>> paddings(batch_size);
+    std::vector<std::array<float, 16>> matrices(batch_size);
+    {
+      auto buffer_view = tensor.GetCpuWriteView();
+      for (int i = 0; i < batch_size; ++i) {
+        ASSIGN_OR_RETURN(RotatedRect roi,
+                         GetInputRoi(image.width, image.height, norm_rects[i],
+                                     &paddings[i], &matrices[i]));
+        const int offset = i * num_elements;
+        switch (tensor_type) {
+          case Tensor::ElementType::kInt8:
+            ExtractSubRectToTensor(image, roi, border_mode, transform.scale,
+                                   transform.offset, width, height,
+                                   buffer_view.buffer<int8>() + offset);
+            break;
+          case Tensor::ElementType::kUInt8:
+            ExtractSubRectToTensor(image, roi, border_mode, transform.scale,
+                                   transform.offset, width, height,
+                                   buffer_view.buffer<uint8>() + offset);
+            break;
+          case Tensor::ElementType::kFloat32:
+            ExtractSubRectToTensor(image, roi, border_mode, transform.scale,
+                                   transform.offset, width, height,
+                                   buffer_view.buffer<float>() + offset);
+            break;
+          case Tensor::ElementType::kFloat16:
+            half_scratch_.resize(num_elements);
+            ExtractSubRectToTensor(image, roi, border_mode, transform.scale,
+                                   transform.offset, width, height,
+                                   half_scratch_.data());
+            FloatsToHalves(half_scratch_.data(), num_elements,
+                           buffer_view.buffer<uint16_t>() + offset);
+            break;
+          default:
+            return absl::InvalidArgumentError(
+                absl::StrCat("Unsupported tensor type: ", tensor_type));
+        }
+      }
+    }
+
+    SendOutputs(cc, MakeTensorsPacket(std::move(tensor)), std::move(paddings),
+                std::move(matrices));
+    return absl::OkStatus();
+  }
+
+  // Returns the key of the conversion of an image with share_output: the
+  // options, then the presence and contents of each rect.
+  std::string GetShareKey(
+      const std::vector<absl::optional<mediapipe::NormalizedRect>>&
+          norm_rects) const {
+    std::string key = options_.SerializeAsString();
+    for (const auto& norm_rect : norm_rects) {
+      absl::StrAppend(&key, norm_rect ? "|" : "|-",
+                      norm_rect ? norm_rect->SerializeAsString() : "");
+    }
+    return key;
+  }
+
+  static Packet<std::vector<Tensor>> MakeTensorsPacket(Tensor tensor) {
+    auto tensors = std::make_unique<std::vector<Tensor>>();
+    tensors->push_back(std::move(tensor));
+    return PacketAdopting(std::move(tensors));
+  }
+
+  // Returns the region of `norm_rect` in the `width` x `height` input image,
+  // and sets its letterbox padding and matrix. The rect, padding and matrix
+  // refer to the image rotated by input_rotation_degrees.
+  absl::StatusOr<RotatedRect> GetInputRoi(
+      int width, int height,
+      const absl::optional<mediapipe::NormalizedRect>& norm_rect,
+      std::array<float, 4>* padding, std::array<float, 16>* matrix) {
+    const int rotation = options_.input_rotation_degrees();
+    const bool transposed = rotation % 180 != 0;
+    const int rotated_width = transposed ? height : width;
+    const int rotated_height = transposed ? width : height;
+    RotatedRect roi = GetRoi(rotated_width, rotated_height, norm_rect);
+    ASSIGN_OR_RETURN(*padding, PadRoi(options_.output_tensor_width(),
+                                      options_.output_tensor_height(),
+                                      options_.keep_aspect_ratio(), &roi));
+    GetRotatedSubRectToRectTransformMatrix(roi, rotated_width, rotated_height,
+                                           /*flip_horizontaly=*/false,
+                                           matrix);
+    if (rotation == 0) return roi;
+    return RotateRoiToInput(roi, rotation, width, height);
+  }
+
+  void SendOutputs(CalculatorContext* cc,
+                   const Packet<std::vector<Tensor>>& tensors,
+                   std::vector<std::array<float, 4>> paddings,
+                   std::vector<std::array<float, 16>> matrices) {
+    if (kOutLetterboxPadding(cc).IsConnected()) {
+      kOutLetterboxPadding(cc).Send(paddings[0]);
+    }
+    if (kOutMatrix(cc).IsConnected()) {
+      kOutMatrix(cc).Send(matrices[0]);
+    }
+    if (kOutLetterboxPaddings(cc).IsConnected()) {
+      kOutLetterboxPaddings(cc).Send(std::move(paddings));
+    }
+    if (kOutMatrices(cc).IsConnected()) {
+      kOutMatrices(cc).Send(std::move(matrices));
+    }
+    kOutTensors(cc).Send(tensors.At(cc->InputTimestamp()));
+  }
+
   absl::Status InitConverterIfNecessary(CalculatorContext* cc,
                                         const Image& image) {
     // Lazy initialization of the GPU or CPU converter.
@@ -284,6 +593,9 @@ class ImageToTensorCalculator : public Node {
   std::unique_ptr<ImageToTensorConverter> cpu_converter_;
   mediapipe::ImageToTensorCalculatorOptions options_;
   OutputTensorParams params_;
+  // Float image of kFloat16 tensors extracted from YUV images, reused across
+  // calls.
+  std::vector<float> half_scratch_;
 };
 
 MEDIAPIPE_REGISTER_NODE(ImageToTensorCalculator);
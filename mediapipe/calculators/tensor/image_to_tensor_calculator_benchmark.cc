@@ -0,0 +1,88 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+
+#include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
+#include "mediapipe/framework/benchmarks/calculator_benchmark.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumPackets = 16;
+
+// Returns a config converting the whole image into a 224x224 float tensor,
+// keeping the aspect ratio if `keep_aspect_ratio` is true.
+CalculatorGraphConfig::Node MakeNodeConfig(bool keep_aspect_ratio) {
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "ImageToTensorCalculator"
+        input_stream: "IMAGE:image"
+        output_stream: "TENSORS:tensors"
+        options {
+          [mediapipe.ImageToTensorCalculatorOptions.ext] {
+            output_tensor_width: 224
+            output_tensor_height: 224
+            output_tensor_float_range { min: -1 max: 1 }
+            border_mode: BORDER_ZERO
+          }
+        }
+      )pb");
+  node_config.mutable_options()
+      ->MutableExtension(ImageToTensorCalculatorOptions::ext)
+      ->set_keep_aspect_ratio(keep_aspect_ratio);
+  return node_config;
+}
+
+// Adds SRGB images of state.range(0) x state.range(1) pixels.
+absl::Status AddImages(benchmark::State& state, CalculatorRunner* runner) {
+  const int width = state.range(0);
+  const int height = state.range(1);
+  for (int t = 0; t < kNumPackets; ++t) {
+    auto image = std::make_unique<ImageFrame>(ImageFormat::SRGB, width, height);
+    for (int y = 0; y < height; ++y) {
+      uint8_t* row = image->MutablePixelData() + y * image->WidthStep();
+      for (int x = 0; x < width * 3; ++x) row[x] = (x + y + t) & 0xff;
+    }
+    runner->MutableInputs()->Tag("IMAGE").packets.push_back(
+        Adopt(image.release()).At(Timestamp(t)));
+  }
+  return absl::OkStatus();
+}
+
+MEDIAPIPE_CALCULATOR_BENCHMARK(BM_ImageToTensor,
+                               MakeNodeConfig(/*keep_aspect_ratio=*/false),
+                               AddImages)
+    ->Args({256, 256})
+    ->Args({640, 480})
+    ->Args({1280, 720});
+
+MEDIAPIPE_CALCULATOR_BENCHMARK(BM_ImageToTensorKeepAspectRatio,
+                               MakeNodeConfig(/*keep_aspect_ratio=*/true),
+                               AddImages)
+    ->Args({640, 480})
+    ->Args({1280, 720});
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
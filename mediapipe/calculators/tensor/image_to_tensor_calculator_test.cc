@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <array>
 #include <cmath>
 #include <vector>
 
@@ -486,5 +487,138 @@ TEST(ImageToTensorCalculatorTest, NoOpExceptRangeBorderZero) {
           BorderMode::kZero, roi);
 }
 
+TEST(ImageToTensorCalculatorTest, BatchesMultipleRects) {
+  auto graph_config = mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        input_stream: "input_image"
+        input_stream: "rois"
+        node {
+          calculator: "ImageToTensorCalculator"
+          input_stream: "IMAGE:input_image"
+          input_stream: "NORM_RECTS:rois"
+          output_stream: "TENSORS:tensor"
+          output_stream: "MATRICES:matrices"
+          options {
+            [mediapipe.ImageToTensorCalculatorOptions.ext] {
+              output_tensor_width: 256
+              output_tensor_height: 256
+              keep_aspect_ratio: true
+              output_tensor_float_range { min: 0.0 max: 1.0 }
+            }
+          }
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+  std::vector<Packet> matrix_packets;
+  tool::AddVectorSink("matrices", &graph_config, &matrix_packets);
+
+  std::vector<mediapipe::NormalizedRect> rois(2);
+  for (mediapipe::NormalizedRect& roi : rois) {
+    roi.set_x_center(0.65f);
+    roi.set_y_center(0.4f);
+    roi.set_width(0.5f);
+    roi.set_height(0.5f);
+  }
+  rois[1].set_rotation(M_PI * 90.0f / 180.0f);
+  const std::vector<cv::Mat> expected_results = {
+      GetRgb(GetFilePath("medium_sub_rect_keep_aspect.png")),
+      GetRgb(GetFilePath("medium_sub_rect_keep_aspect_with_rotation.png"))};
+
+  // The image packets don't own the pixels.
+  cv::Mat input = GetRgb(GetFilePath("input.jpg"));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("input_image", MakeImagePacket(input)));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "rois", MakePacket<std::vector<mediapipe::NormalizedRect>>(rois).At(
+                  Timestamp(0))));
+  // No tensor is output for an empty vector of rects.
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input_image", MakeImagePacket(input).At(Timestamp(1))));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "rois",
+      MakePacket<std::vector<mediapipe::NormalizedRect>>().At(Timestamp(1))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_THAT(output_packets, testing::SizeIs(1));
+  ASSERT_THAT(matrix_packets, testing::SizeIs(1));
+  EXPECT_THAT(matrix_packets[0].Get<std::vector<std::array<float, 16>>>(),
+              testing::SizeIs(2));
+
+  const std::vector<Tensor>& tensor_vec =
+      output_packets[0].Get<std::vector<Tensor>>();
+  ASSERT_THAT(tensor_vec, testing::SizeIs(1));
+  const Tensor& tensor = tensor_vec[0];
+  EXPECT_EQ(tensor.shape().dims, std::vector<int>({2, 256, 256, 3}));
+  auto view = tensor.GetCpuReadView();
+  for (int i = 0; i < 2; ++i) {
+    cv::Mat tensor_mat(256, 256, CV_32FC3,
+                       const_cast<float*>(view.buffer<float>()) +
+                           i * 256 * 256 * 3);
+    cv::Mat result_rgb;
+    tensor_mat.convertTo(result_rgb, CV_8UC3, 255.0f);
+    cv::Mat diff;
+    cv::absdiff(result_rgb, expected_results[i], diff);
+    double max_val;
+    cv::minMaxLoc(diff, nullptr, &max_val);
+    EXPECT_LE(max_val, 5);
+  }
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+
+// Runs an ImageToTensorCalculator with share_output, in a graph of its own, on
+// the image packet, and returns its output tensors packet.
+Packet RunSharingGraph(const Packet& image_packet, int output_size) {
+  auto graph_config = mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+      absl::Substitute(R"pb(
+                         input_stream: "input_image"
+                         node {
+                           calculator: "ImageToTensorCalculator"
+                           input_stream: "IMAGE:input_image"
+                           output_stream: "TENSORS:tensor"
+                           options {
+                             [mediapipe.ImageToTensorCalculatorOptions.ext] {
+                               output_tensor_width: $0
+                               output_tensor_height: $0
+                               output_tensor_float_range { min: 0.0 max: 1.0 }
+                               share_output: true
+                             }
+                           }
+                         }
+                       )pb",
+                       output_size));
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(graph_config));
+  MP_EXPECT_OK(graph.StartRun({}));
+  MP_EXPECT_OK(graph.AddPacketToInputStream("input_image", image_packet));
+  MP_EXPECT_OK(graph.CloseAllInputStreams());
+  MP_EXPECT_OK(graph.WaitUntilDone());
+  EXPECT_THAT(output_packets, testing::SizeIs(1));
+  return output_packets.empty() ? Packet() : output_packets[0];
+}
+
+TEST(ImageToTensorCalculatorTest, SharesOutputAcrossGraphs) {
+  cv::Mat input = GetRgb(GetFilePath("input.jpg"));
+  const Packet image_packet = MakeImagePacket(input);
+
+  const Packet first = RunSharingGraph(image_packet, 224);
+  const Packet second = RunSharingGraph(image_packet, 224);
+  const Packet other_size = RunSharingGraph(image_packet, 256);
+  const Packet other_image = RunSharingGraph(MakeImagePacket(input), 224);
+  ASSERT_FALSE(first.IsEmpty());
+
+  const auto* tensors = &first.Get<std::vector<Tensor>>();
+  EXPECT_EQ(&second.Get<std::vector<Tensor>>(), tensors);
+  EXPECT_NE(&other_size.Get<std::vector<Tensor>>(), tensors);
+  EXPECT_NE(&other_image.Get<std::vector<Tensor>>(), tensors);
+}
+
 }  // namespace
 }  // namespace mediapipe
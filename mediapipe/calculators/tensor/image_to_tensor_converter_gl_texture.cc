@@ -179,15 +179,20 @@ class GlProcessor : public ImageToTensorConverter {
       return InvalidArgumentError(absl::StrCat(
           "Unsupported format: ", static_cast<uint32_t>(input.format())));
     }
-    // TODO: support tensor_buffer_offset > 0 scenario.
-    RET_CHECK_EQ(tensor_buffer_offset, 0)
-        << "The non-zero tensor_buffer_offset input is not supported yet.";
     const auto& output_shape = output_tensor.shape();
     MP_RETURN_IF_ERROR(ValidateTensorShape(output_shape));
+    // The batch elements are stacked vertically in the texture, so an offset
+    // has to select a whole element.
+    const int output_size = output_tensor.bytes() / output_shape.dims[0];
+    RET_CHECK(tensor_buffer_offset >= 0 &&
+              tensor_buffer_offset % output_size == 0)
+        << "The tensor_buffer_offset needs to be a multiple of the size of a "
+           "batch element.";
+    const int batch_index = tensor_buffer_offset / output_size;
 
     MP_RETURN_IF_ERROR(gl_helper_.RunInGlContext(
         [this, &output_tensor, &input, &roi, &output_shape, range_min,
-         range_max]() -> absl::Status {
+         range_max, batch_index]() -> absl::Status {
           auto input_texture = gl_helper_.CreateSourceTexture(input);
 
           constexpr float kInputImageRangeMin = 0.0f;
@@ -196,11 +201,15 @@ class GlProcessor : public ImageToTensorConverter {
                            GetValueRangeTransformation(kInputImageRangeMin,
                                                        kInputImageRangeMax,
                                                        range_min, range_max));
+          int texture_width, texture_height;
+          RET_CHECK(Tensor::OpenGlTexture2dView::GetLayoutDimensions(
+                        output_shape, &texture_width, &texture_height) ==
+                    Tensor::OpenGlTexture2dView::Layout::kAligned)
+              << "The output tensor is too large for a texture.";
           auto tensor_view = output_tensor.GetOpenGlTexture2dWriteView();
-          MP_RETURN_IF_ERROR(ExtractSubRect(input_texture, roi,
-                                            /*flip_horizontaly=*/false,
-                                            transform.scale, transform.offset,
-                                            output_shape, &tensor_view));
+          MP_RETURN_IF_ERROR(ExtractSubRect(
+              input_texture, roi, /*flip_horizontaly=*/false, transform.scale,
+              transform.offset, output_shape, batch_index, &tensor_view));
           return absl::OkStatus();
         }));
 
@@ -211,6 +220,7 @@ class GlProcessor : public ImageToTensorConverter {
                               const RotatedRect& sub_rect,
                               bool flip_horizontaly, float alpha, float beta,
                               const Tensor::Shape& output_shape,
+                              int batch_index,
                               Tensor::OpenGlTexture2dView* output) {
     const int output_height = output_shape.dims[1];
     const int output_width = output_shape.dims[2];
@@ -218,7 +228,7 @@ class GlProcessor : public ImageToTensorConverter {
 
     glDisable(GL_DEPTH_TEST);
     glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
-    glViewport(0, 0, output_width, output_height);
+    glViewport(0, batch_index * output_height, output_width, output_height);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, output->name());
@@ -321,9 +331,8 @@ class GlProcessor : public ImageToTensorConverter {
   absl::Status ValidateTensorShape(const Tensor::Shape& output_shape) {
     RET_CHECK_EQ(output_shape.dims.size(), 4)
         << "Wrong output dims size: " << output_shape.dims.size();
-    RET_CHECK_EQ(output_shape.dims[0], 1)
-        << "Handling batch dimension not equal to 1 is not implemented in this "
-           "converter.";
+    RET_CHECK_GE(output_shape.dims[0], 1)
+        << "The batch dimension needs to be greater or equal to 1.";
     RET_CHECK_EQ(output_shape.dims[3], 3)
         << "Wrong output channel: " << output_shape.dims[3];
     return absl::OkStatus();
@@ -179,8 +179,9 @@ class SubRectExtractorMetal {
                        float alpha, float beta,
                        const tflite::gpu::HW& destination_size,
                        id<MTLCommandBuffer> command_buffer,
-                       id<MTLBuffer> destination) {
-    auto output_texture = MTLTextureWithBuffer(destination_size, destination);
+                       id<MTLBuffer> destination, int destination_offset) {
+    auto output_texture = MTLTextureWithBuffer(destination_size, destination,
+                                               destination_offset);
     return InternalExecute(input_texture, sub_rect, flip_horizontaly, alpha,
                            beta, destination_size, command_buffer,
                            output_texture);
@@ -188,7 +189,7 @@ class SubRectExtractorMetal {
 
  private:
   id<MTLTexture> MTLTextureWithBuffer(const tflite::gpu::HW& size,
-                                      id<MTLBuffer> buffer) {
+                                      id<MTLBuffer> buffer, int offset) {
     MTLTextureDescriptor* texture_desc = [MTLTextureDescriptor
         texture2DDescriptorWithPixelFormat:GetPixelFormat(output_format_)
                                      width:size.w
@@ -200,7 +201,7 @@ class SubRectExtractorMetal {
 
     id<MTLTexture> texture =
         [buffer newTextureWithDescriptor:texture_desc
-                                  offset:0
+                                  offset:offset
                              bytesPerRow:output_bytes_per_row];
     return texture;
   }
@@ -214,16 +215,12 @@ class SubRectExtractorMetal {
     RET_CHECK(command_buffer != nil);
     RET_CHECK(output_texture != nil);
 
-    // Obtain texture mapping coordinates transformation matrix and copy its
-    // data to the buffer.
+    // Obtain texture mapping coordinates transformation matrix. It is passed
+    // inline with the draw call rather than in a new MTLBuffer per frame.
     std::array<float, 16> transform_mat;
     GetRotatedSubRectToRectTransformMatrix(sub_rect, input_texture.width,
                                            input_texture.height,
                                            flip_horizontaly, &transform_mat);
-    id<MTLBuffer> transform_mat_buffer =
-        [device_ newBufferWithBytes:&transform_mat
-                             length:sizeof(transform_mat)
-                            options:MTLResourceOptionCPUCacheModeDefault];
 
     // Create parameters wrapper.
     float parameters[] = {alpha, beta};
@@ -242,7 +239,9 @@ class SubRectExtractorMetal {
     [command_encoder setRenderPipelineState:pipeline_state_];
     [command_encoder setVertexBuffer:positions_buffer_ offset:0 atIndex:0];
     [command_encoder setVertexBuffer:tex_coords_buffer_ offset:0 atIndex:1];
-    [command_encoder setVertexBuffer:transform_mat_buffer offset:0 atIndex:2];
+    [command_encoder setVertexBytes:transform_mat.data()
+                             length:sizeof(transform_mat)
+                            atIndex:2];
     [command_encoder setFragmentTexture:input_texture atIndex:0];
     [command_encoder setFragmentBytes:&parameters
                                length:sizeof(parameters)
@@ -358,10 +357,17 @@ class MetalProcessor : public ImageToTensorConverter {
           "Only 4-channel texture input formats are supported, passed format: ",
           static_cast<uint32_t>(input.format())));
     }
-    RET_CHECK_EQ(tensor_buffer_offset, 0)
-        << "The non-zero tensor_buffer_offset input is not supported yet.";
     const auto& output_shape = output_tensor.shape();
     MP_RETURN_IF_ERROR(ValidateTensorShape(output_shape));
+    // A batch element is rendered to a texture view of the buffer, which
+    // Metal requires to be aligned.
+    const NSUInteger alignment = [metal_helper_.mtlDevice
+        minimumLinearTextureAlignmentForPixelFormat:GetPixelFormat(
+                                                        OutputFormat::kF32C4)];
+    RET_CHECK(tensor_buffer_offset >= 0 &&
+              tensor_buffer_offset % alignment == 0)
+        << "The tensor_buffer_offset " << tensor_buffer_offset
+        << " needs to be a non-negative multiple of " << alignment << ".";
 
     @autoreleasepool {
       id<MTLTexture> texture =
@@ -381,7 +387,7 @@ class MetalProcessor : public ImageToTensorConverter {
           texture, roi,
           /*flip_horizontaly=*/false, transform.scale, transform.offset,
           tflite::gpu::HW(output_shape.dims[1], output_shape.dims[2]),
-          command_buffer, buffer_view.buffer()));
+          command_buffer, buffer_view.buffer(), tensor_buffer_offset));
       [command_buffer commit];
       return absl::OkStatus();
     }
@@ -391,9 +397,8 @@ class MetalProcessor : public ImageToTensorConverter {
   absl::Status ValidateTensorShape(const Tensor::Shape& output_shape) {
     RET_CHECK_EQ(output_shape.dims.size(), 4)
         << "Wrong output dims size: " << output_shape.dims.size();
-    RET_CHECK_EQ(output_shape.dims[0], 1)
-        << "Handling batch dimension not equal to 1 is not implemented in this "
-           "converter.";
+    RET_CHECK_GE(output_shape.dims[0], 1)
+        << "The batch dimension needs to be greater or equal to 1.";
     RET_CHECK_EQ(output_shape.dims[3], 4)
         << "Wrong output channel: " << output_shape.dims[3];
     return absl::OkStatus();
@@ -15,13 +15,17 @@
 #include "mediapipe/calculators/tensor/image_to_tensor_converter_opencv.h"
 
 #include <cmath>
+#include <cstdint>
 #include <memory>
 
 #include "mediapipe/calculators/tensor/image_to_tensor_converter.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_cpu_kernel.h"
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/calculators/tensor/tensor_element_utils.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_opencv.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/canonical_errors.h"
@@ -36,13 +40,13 @@ namespace {
 class OpenCvProcessor : public ImageToTensorConverter {
  public:
   OpenCvProcessor(BorderMode border_mode, Tensor::ElementType tensor_type)
-      : tensor_type_(tensor_type) {
+      : border_mode_(border_mode), tensor_type_(tensor_type) {
     switch (border_mode) {
       case BorderMode::kReplicate:
-        border_mode_ = cv::BORDER_REPLICATE;
+        cv_border_mode_ = cv::BORDER_REPLICATE;
         break;
       case BorderMode::kZero:
-        border_mode_ = cv::BORDER_CONSTANT;
+        cv_border_mode_ = cv::BORDER_CONSTANT;
         break;
     }
     switch (tensor_type_) {
@@ -50,6 +54,8 @@ class OpenCvProcessor : public ImageToTensorConverter {
         mat_type_ = CV_8SC3;
         mat_gray_type_ = CV_8SC1;
         break;
+      case Tensor::ElementType::kFloat16:
+        // Converted to float first, then narrowed into the tensor.
       case Tensor::ElementType::kFloat32:
         mat_type_ = CV_32FC3;
         mat_gray_type_ = CV_32FC1;
@@ -89,6 +95,8 @@ class OpenCvProcessor : public ImageToTensorConverter {
         output_height * output_width * output_channels;
     auto buffer_view = output_tensor.GetCpuWriteView();
     cv::Mat dst;
+    // Destination of kFloat16 tensors, which dst is a float copy of.
+    uint16_t* half_dst = nullptr;
     const int dst_data_type = output_channels == 1 ? mat_gray_type_ : mat_type_;
     switch (tensor_type_) {
       case Tensor::ElementType::kInt8:
@@ -110,6 +118,17 @@ class OpenCvProcessor : public ImageToTensorConverter {
             output_height, output_width, dst_data_type,
             buffer_view.buffer<float>() + tensor_buffer_offset / sizeof(float));
         break;
+      case Tensor::ElementType::kFloat16:
+        RET_CHECK_GE(
+            output_shape.num_elements(),
+            tensor_buffer_offset / sizeof(uint16_t) + num_elements_per_img)
+            << "The buffer offset + the input image size is larger than the "
+               "allocated tensor buffer.";
+        half_dst = buffer_view.buffer<uint16_t>() +
+                   tensor_buffer_offset / sizeof(uint16_t);
+        half_scratch_.create(output_height, output_width, dst_data_type);
+        dst = half_scratch_;
+        break;
       case Tensor::ElementType::kUInt8:
         RET_CHECK_GE(
             output_shape.num_elements(),
@@ -125,6 +144,42 @@ class OpenCvProcessor : public ImageToTensorConverter {
             absl::StrCat("Unsupported tensor type: ", tensor_type_));
     }
 
+    constexpr float kInputImageRangeMin = 0.0f;
+    constexpr float kInputImageRangeMax = 255.0f;
+    ASSIGN_OR_RETURN(
+        auto transform,
+        GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
+                                    range_min, range_max));
+
+    if (CanExtractSubRectToTensor(roi)) {
+      // Axis-aligned rects are extracted in a single pass, without the
+      // intermediate images of the general path below.
+      ImageFrameSharedPtr frame = input.GetImageFrameSharedPtr();
+      const Uint8ImageView image{frame->PixelData(), frame->Width(),
+                                 frame->Height(), frame->NumberOfChannels(),
+                                 frame->WidthStep()};
+      switch (tensor_type_) {
+        case Tensor::ElementType::kInt8:
+          ExtractSubRectToTensor(image, roi, border_mode_, transform.scale,
+                                 transform.offset, output_width, output_height,
+                                 output_channels, dst.ptr<int8>());
+          break;
+        case Tensor::ElementType::kFloat16:
+        case Tensor::ElementType::kFloat32:
+          ExtractSubRectToTensor(image, roi, border_mode_, transform.scale,
+                                 transform.offset, output_width, output_height,
+                                 output_channels, dst.ptr<float>());
+          break;
+        default:
+          ExtractSubRectToTensor(image, roi, border_mode_, transform.scale,
+                                 transform.offset, output_width, output_height,
+                                 output_channels, dst.ptr<uint8>());
+          break;
+      }
+      StoreHalves(dst, half_dst);
+      return absl::OkStatus();
+    }
+
     const cv::RotatedRect rotated_rect(cv::Point2f(roi.center_x, roi.center_y),
                                        cv::Size2f(roi.width, roi.height),
                                        roi.rotation * 180.f / M_PI);
@@ -148,7 +203,7 @@ class OpenCvProcessor : public ImageToTensorConverter {
     cv::warpPerspective(*src, transformed, projection_matrix,
                         cv::Size(dst_width, dst_height),
                         /*flags=*/cv::INTER_LINEAR,
-                        /*borderMode=*/border_mode_);
+                        /*borderMode=*/cv_border_mode_);
 
     if (transformed.channels() > output_channels) {
       cv::Mat proper_channels_mat;
@@ -156,18 +211,20 @@ class OpenCvProcessor : public ImageToTensorConverter {
       transformed = proper_channels_mat;
     }
 
-    constexpr float kInputImageRangeMin = 0.0f;
-    constexpr float kInputImageRangeMax = 255.0f;
-    ASSIGN_OR_RETURN(
-        auto transform,
-        GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
-                                    range_min, range_max));
     transformed.convertTo(dst, dst_data_type, transform.scale,
                           transform.offset);
+    StoreHalves(dst, half_dst);
     return absl::OkStatus();
   }
 
  private:
+  // Narrows the float image extracted for a kFloat16 tensor into @half_dst,
+  // if set.
+  void StoreHalves(const cv::Mat& dst, uint16_t* half_dst) {
+    if (half_dst == nullptr) return;
+    FloatsToHalves(dst.ptr<float>(), dst.total() * dst.channels(), half_dst);
+  }
+
   absl::Status ValidateTensorShape(const Tensor::Shape& output_shape) {
     RET_CHECK_EQ(output_shape.dims.size(), 4)
         << "Wrong output dims size: " << output_shape.dims.size();
@@ -178,10 +235,13 @@ class OpenCvProcessor : public ImageToTensorConverter {
     return absl::OkStatus();
   }
 
-  enum cv::BorderTypes border_mode_;
+  BorderMode border_mode_;
+  enum cv::BorderTypes cv_border_mode_;
   Tensor::ElementType tensor_type_;
   int mat_type_;
   int mat_gray_type_;
+  // Float image of kFloat16 tensors, reused across calls.
+  cv::Mat half_scratch_;
 };
 
 }  // namespace
@@ -190,6 +250,7 @@ absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateOpenCvConverter(
     CalculatorContext* cc, BorderMode border_mode,
     Tensor::ElementType tensor_type) {
   if (tensor_type != Tensor::ElementType::kInt8 &&
+      tensor_type != Tensor::ElementType::kFloat16 &&
       tensor_type != Tensor::ElementType::kFloat32 &&
       tensor_type != Tensor::ElementType::kUInt8) {
     return absl::InvalidArgumentError(absl::StrCat(
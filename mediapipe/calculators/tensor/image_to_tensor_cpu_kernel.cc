@@ -0,0 +1,354 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/image_to_tensor_cpu_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/util/simd/simd.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The two source pixels, and their weights, that an output pixel is
+// interpolated from along one axis. Taps outside of the image are clamped to
+// the border, and get zero weight for BorderMode::kZero.
+struct Tap {
+  int index0;
+  int index1;
+  float weight0;
+  float weight1;
+};
+
+// Computes the tap of an output pixel sampling the source at position, like
+// cv::warpPerspective does.
+Tap ComputeTap(float position, int src_size, BorderMode border_mode) {
+  auto clamp_tap = [&](int* index, float* weight) {
+    if (*index < 0 || *index >= src_size) {
+      *index = std::clamp(*index, 0, src_size - 1);
+      if (border_mode == BorderMode::kZero) *weight = 0.0f;
+    }
+  };
+  const float floor = std::floor(position);
+  const float fraction = position - floor;
+  Tap tap;
+  tap.index0 = static_cast<int>(floor);
+  tap.index1 = tap.index0 + 1;
+  tap.weight0 = 1.0f - fraction;
+  tap.weight1 = fraction;
+  clamp_tap(&tap.index0, &tap.weight0);
+  clamp_tap(&tap.index1, &tap.weight1);
+  return tap;
+}
+
+// Computes the taps of the output pixels 0..dst_size-1, which sample the
+// source at start + i * step.
+std::vector<Tap> ComputeTaps(float start, float step, int dst_size,
+                             int src_size, BorderMode border_mode) {
+  std::vector<Tap> taps(dst_size);
+  for (int i = 0; i < dst_size; ++i) {
+    taps[i] = ComputeTap(start + i * step, src_size, border_mode);
+  }
+  return taps;
+}
+
+// A YUV image with the coefficients of its conversion to RGB.
+class YuvSource {
+ public:
+  explicit YuvSource(const YuvImageView& image) : image_(image) {
+    const bool full_range =
+        image.color_space == YuvColorSpace::kBt601FullRange ||
+        image.color_space == YuvColorSpace::kBt709FullRange;
+    const bool bt709 = image.color_space == YuvColorSpace::kBt709LimitedRange ||
+                       image.color_space == YuvColorSpace::kBt709FullRange;
+    // Limited range values span [16, 235] for luma and [16, 240] for chroma.
+    y_offset_ = full_range ? 0.0f : 16.0f;
+    y_scale_ = full_range ? 1.0f : 255.0f / 219.0f;
+    const float uv_scale = full_range ? 1.0f : 255.0f / 224.0f;
+    if (bt709) {
+      r_v_ = 1.5748f * uv_scale;
+      g_u_ = -0.187324f * uv_scale;
+      g_v_ = -0.468124f * uv_scale;
+      b_u_ = 1.8556f * uv_scale;
+    } else {
+      r_v_ = 1.402f * uv_scale;
+      g_u_ = -0.344136f * uv_scale;
+      g_v_ = -0.714136f * uv_scale;
+      b_u_ = 1.772f * uv_scale;
+    }
+  }
+
+  int width() const { return image_.width; }
+  int height() const { return image_.height; }
+
+  // Writes the RGB values of pixel (x, y), clamped to [0, 255], to rgb.
+  void GetRgb(int x, int y, float* rgb) const {
+    const float luma =
+        (image_.y_data[y * image_.y_stride + x] - y_offset_) * y_scale_;
+    const int uv_index =
+        (y / 2) * image_.uv_stride + (x / 2) * image_.uv_pixel_stride;
+    const float u = image_.u_data[uv_index] - 128.0f;
+    const float v = image_.v_data[uv_index] - 128.0f;
+    rgb[0] = std::clamp(luma + r_v_ * v, 0.0f, 255.0f);
+    rgb[1] = std::clamp(luma + g_u_ * u + g_v_ * v, 0.0f, 255.0f);
+    rgb[2] = std::clamp(luma + b_u_ * u, 0.0f, 255.0f);
+  }
+
+ private:
+  const YuvImageView& image_;
+  float y_offset_;
+  float y_scale_;
+  float r_v_;
+  float g_u_;
+  float g_v_;
+  float b_u_;
+};
+
+// Interpolates a source row horizontally into dst_width * kChannels floats.
+template <int kChannels>
+void InterpolateRow(const uint8* src_row, int src_channels,
+                    const std::vector<Tap>& x_taps, float* out) {
+  for (const Tap& tap : x_taps) {
+    const uint8* p0 = src_row + tap.index0 * src_channels;
+    const uint8* p1 = src_row + tap.index1 * src_channels;
+    for (int c = 0; c < kChannels; ++c) {
+      out[c] = p0[c] * tap.weight0 + p1[c] * tap.weight1;
+    }
+    out += kChannels;
+  }
+}
+
+void InterpolateRow(const Uint8ImageView& image, int y,
+                    const std::vector<Tap>& x_taps, int dst_channels,
+                    float* out) {
+  const uint8* src_row = image.data + y * image.width_step;
+  switch (dst_channels) {
+    case 1:
+      InterpolateRow<1>(src_row, image.channels, x_taps, out);
+      break;
+    case 3:
+      InterpolateRow<3>(src_row, image.channels, x_taps, out);
+      break;
+    default:
+      InterpolateRow<4>(src_row, image.channels, x_taps, out);
+      break;
+  }
+}
+
+// Converts the sampled pixels of a YUV row to RGB and interpolates them.
+void InterpolateRow(const YuvSource& source, int y,
+                    const std::vector<Tap>& x_taps, int /*dst_channels*/,
+                    float* out) {
+  float rgb0[3];
+  float rgb1[3];
+  for (const Tap& tap : x_taps) {
+    source.GetRgb(tap.index0, y, rgb0);
+    source.GetRgb(tap.index1, y, rgb1);
+    for (int c = 0; c < 3; ++c) {
+      out[c] = rgb0[c] * tap.weight0 + rgb1[c] * tap.weight1;
+    }
+    out += 3;
+  }
+}
+
+// Keeps the last two horizontally interpolated source rows, as consecutive
+// output rows mostly sample the same source rows.
+template <typename Source>
+class RowCache {
+ public:
+  RowCache(const Source& source, const std::vector<Tap>& x_taps,
+           int dst_channels)
+      : source_(source), x_taps_(x_taps), dst_channels_(dst_channels) {
+    for (std::vector<float>& row : rows_) {
+      row.resize(x_taps.size() * dst_channels);
+    }
+  }
+
+  // Returns source row y interpolated, without evicting row keep_y.
+  const float* Get(int y, int keep_y) {
+    for (int slot = 0; slot < 2; ++slot) {
+      if (row_y_[slot] == y) return rows_[slot].data();
+    }
+    const int slot = row_y_[0] == keep_y ? 1 : 0;
+    float* out = rows_[slot].data();
+    InterpolateRow(source_, y, x_taps_, dst_channels_, out);
+    row_y_[slot] = y;
+    return out;
+  }
+
+ private:
+  const Source& source_;
+  const std::vector<Tap>& x_taps_;
+  const int dst_channels_;
+  std::vector<float> rows_[2];
+  int row_y_[2] = {-1, -1};
+};
+
+// Stores a blended row, rounded and saturated for integer types.
+template <typename T>
+void StoreRow(const float* row, int size, T* dst);
+
+template <>
+void StoreRow<uint8>(const float* row, int size, uint8* dst) {
+  for (int i = 0; i < size; ++i) {
+    dst[i] = static_cast<uint8>(std::clamp(row[i], 0.0f, 255.0f) + 0.5f);
+  }
+}
+
+template <>
+void StoreRow<int8>(const float* row, int size, int8* dst) {
+  for (int i = 0; i < size; ++i) {
+    // Shifted to be non-negative, so that truncation rounds.
+    dst[i] = static_cast<int8>(
+        static_cast<int>(std::clamp(row[i], -128.0f, 127.0f) + 128.5f) - 128);
+  }
+}
+
+template <typename T, typename Source>
+void ExtractRows(const Source& source, const std::vector<Tap>& x_taps,
+                 const std::vector<Tap>& y_taps, float scale, float offset,
+                 int dst_channels, T* dst) {
+  const int row_size = x_taps.size() * dst_channels;
+  RowCache<Source> cache(source, x_taps, dst_channels);
+  std::vector<float> blended(std::is_same_v<T, float> ? 0 : row_size);
+  for (const Tap& tap : y_taps) {
+    const float* row0 = cache.Get(tap.index0, tap.index1);
+    const float* row1 = cache.Get(tap.index1, tap.index0);
+    // Normalization is folded into the vertical weights. Float rows are
+    // blended directly into the tensor.
+    if constexpr (std::is_same_v<T, float>) {
+      simd::BlendRows(row0, row1, tap.weight0 * scale, tap.weight1 * scale, offset,
+                row_size, dst);
+    } else {
+      simd::BlendRows(row0, row1, tap.weight0 * scale, tap.weight1 * scale, offset,
+                row_size, blended.data());
+      StoreRow(blended.data(), row_size, dst);
+    }
+    dst += row_size;
+  }
+}
+
+// Extracts a rotated rect from a YUV image, interpolating every output pixel
+// from its four source pixels.
+template <typename T>
+void ExtractRotatedRect(const YuvSource& source, const RotatedRect& roi,
+                        BorderMode border_mode, float scale, float offset,
+                        int dst_width, int dst_height, T* dst) {
+  const float cos_rotation = std::cos(roi.rotation);
+  const float sin_rotation = std::sin(roi.rotation);
+  const float step_x = roi.width / dst_width;
+  const float step_y = roi.height / dst_height;
+  const int row_size = dst_width * 3;
+  std::vector<float> row(row_size);
+  float rgb[4][3];
+  for (int j = 0; j < dst_height; ++j) {
+    // Offsets from the rect center along the rect axes.
+    const float dy = j * step_y - roi.height / 2;
+    for (int i = 0; i < dst_width; ++i) {
+      const float dx = i * step_x - roi.width / 2;
+      const Tap x_tap = ComputeTap(
+          roi.center_x + dx * cos_rotation - dy * sin_rotation,
+          source.width(), border_mode);
+      const Tap y_tap = ComputeTap(
+          roi.center_y + dx * sin_rotation + dy * cos_rotation,
+          source.height(), border_mode);
+      source.GetRgb(x_tap.index0, y_tap.index0, rgb[0]);
+      source.GetRgb(x_tap.index1, y_tap.index0, rgb[1]);
+      source.GetRgb(x_tap.index0, y_tap.index1, rgb[2]);
+      source.GetRgb(x_tap.index1, y_tap.index1, rgb[3]);
+      for (int c = 0; c < 3; ++c) {
+        const float top = rgb[0][c] * x_tap.weight0 + rgb[1][c] * x_tap.weight1;
+        const float bottom =
+            rgb[2][c] * x_tap.weight0 + rgb[3][c] * x_tap.weight1;
+        row[i * 3 + c] =
+            (top * y_tap.weight0 + bottom * y_tap.weight1) * scale + offset;
+      }
+    }
+    if constexpr (std::is_same_v<T, float>) {
+      std::copy(row.begin(), row.end(), dst);
+    } else {
+      StoreRow(row.data(), row_size, dst);
+    }
+    dst += row_size;
+  }
+}
+
+}  // namespace
+
+bool CanExtractSubRectToTensor(const RotatedRect& roi) {
+  return roi.rotation == 0.0f && roi.width > 0.0f && roi.height > 0.0f;
+}
+
+template <typename T>
+void ExtractSubRectToTensor(const Uint8ImageView& image,
+                            const RotatedRect& roi, BorderMode border_mode,
+                            float scale, float offset, int dst_width,
+                            int dst_height, int dst_channels, T* dst) {
+  const std::vector<Tap> x_taps =
+      ComputeTaps(roi.center_x - roi.width / 2, roi.width / dst_width,
+                  dst_width, image.width, border_mode);
+  const std::vector<Tap> y_taps =
+      ComputeTaps(roi.center_y - roi.height / 2, roi.height / dst_height,
+                  dst_height, image.height, border_mode);
+  ExtractRows(image, x_taps, y_taps, scale, offset, dst_channels, dst);
+}
+
+template void ExtractSubRectToTensor<float>(const Uint8ImageView&,
+                                            const RotatedRect&, BorderMode,
+                                            float, float, int, int, int,
+                                            float*);
+template void ExtractSubRectToTensor<uint8>(const Uint8ImageView&,
+                                            const RotatedRect&, BorderMode,
+                                            float, float, int, int, int,
+                                            uint8*);
+template void ExtractSubRectToTensor<int8>(const Uint8ImageView&,
+                                           const RotatedRect&, BorderMode,
+                                           float, float, int, int, int, int8*);
+
+template <typename T>
+void ExtractSubRectToTensor(const YuvImageView& image, const RotatedRect& roi,
+                            BorderMode border_mode, float scale, float offset,
+                            int dst_width, int dst_height, T* dst) {
+  const YuvSource source(image);
+  if (roi.rotation != 0.0f) {
+    ExtractRotatedRect(source, roi, border_mode, scale, offset, dst_width,
+                       dst_height, dst);
+    return;
+  }
+  const std::vector<Tap> x_taps =
+      ComputeTaps(roi.center_x - roi.width / 2, roi.width / dst_width,
+                  dst_width, image.width, border_mode);
+  const std::vector<Tap> y_taps =
+      ComputeTaps(roi.center_y - roi.height / 2, roi.height / dst_height,
+                  dst_height, image.height, border_mode);
+  ExtractRows(source, x_taps, y_taps, scale, offset, /*dst_channels=*/3, dst);
+}
+
+template void ExtractSubRectToTensor<float>(const YuvImageView&,
+                                            const RotatedRect&, BorderMode,
+                                            float, float, int, int, float*);
+template void ExtractSubRectToTensor<uint8>(const YuvImageView&,
+                                            const RotatedRect&, BorderMode,
+                                            float, float, int, int, uint8*);
+template void ExtractSubRectToTensor<int8>(const YuvImageView&,
+                                           const RotatedRect&, BorderMode,
+                                           float, float, int, int, int8*);
+
+}  // namespace mediapipe
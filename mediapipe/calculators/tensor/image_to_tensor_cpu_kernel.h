@@ -0,0 +1,91 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CPU_KERNEL_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CPU_KERNEL_H_
+
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// An 8-bit interleaved image, e.g. an SRGB, SRGBA or GRAY8 ImageFrame.
+struct Uint8ImageView {
+  const uint8* data;
+  int width;
+  int height;
+  int channels;
+  int width_step;  // Bytes per row.
+};
+
+// The conversion of YUV to RGB, by the color matrix and range of the YUV
+// values.
+enum class YuvColorSpace {
+  kBt601LimitedRange,
+  kBt601FullRange,
+  kBt709LimitedRange,
+  kBt709FullRange,
+};
+
+// An 8-bit YUV 4:2:0 image, e.g. an NV12, NV21, I420 or YV12 YUVImage. The
+// chroma planes have half the width and height of the luma plane, rounded up.
+struct YuvImageView {
+  const uint8* y_data;
+  const uint8* u_data;
+  const uint8* v_data;
+  int y_stride;   // Bytes per luma row.
+  int uv_stride;  // Bytes per chroma row.
+  // Bytes between the chroma samples of consecutive pixels: 1 for planar
+  // chroma (I420, YV12) and 2 for interleaved chroma (NV12, NV21).
+  int uv_pixel_stride;
+  int width;
+  int height;
+  YuvColorSpace color_space;
+};
+
+// Returns whether ExtractSubRectToTensor can extract @roi, which is the case
+// if the rect is not rotated.
+bool CanExtractSubRectToTensor(const RotatedRect& roi);
+
+// Extracts @roi from @image into the CPU buffer of a tensor in a single pass:
+// samples bilinearly, drops the channels beyond @dst_channels (e.g. alpha of
+// RGBA), and writes scale * value + offset, rounded and saturated for integer
+// types. Produces the same result as cv::warpPerspective followed by
+// cv::cvtColor and cv::Mat::convertTo, but without the intermediate images.
+//
+// @dst receives dst_height rows of dst_width * dst_channels elements, and
+// dst_channels may not exceed image.channels. Specialized for float, uint8
+// and int8 outputs. The horizontal interpolation of each source row is
+// shared by the output rows sampling it, and the vertical interpolation and
+// normalization use AVX2 or NEON where available.
+template <typename T>
+void ExtractSubRectToTensor(const Uint8ImageView& image,
+                            const RotatedRect& roi, BorderMode border_mode,
+                            float scale, float offset, int dst_width,
+                            int dst_height, int dst_channels, T* dst);
+
+// Extracts @roi from a YUV @image into the CPU buffer of a tensor as RGB, like
+// the Uint8ImageView overload with dst_channels = 3 would from the image
+// converted to RGB. Color conversion is fused into the sampling: only the
+// source pixels the output samples are converted, with chroma upsampled by
+// nearest neighbor as libyuv does. Unlike the Uint8ImageView overload, @roi
+// may be rotated.
+template <typename T>
+void ExtractSubRectToTensor(const YuvImageView& image, const RotatedRect& roi,
+                            BorderMode border_mode, float scale, float offset,
+                            int dst_width, int dst_height, T* dst);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_IMAGE_TO_TENSOR_CPU_KERNEL_H_
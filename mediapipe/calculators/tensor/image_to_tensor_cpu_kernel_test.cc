@@ -0,0 +1,304 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/image_to_tensor_cpu_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+// An image with pseudo-random pixels and padded rows.
+struct TestImage {
+  TestImage(int width, int height, int channels)
+      : width(width), height(height), channels(channels) {
+    width_step = width * channels + 5;
+    pixels.resize(width_step * height);
+    for (int i = 0; i < pixels.size(); ++i) {
+      pixels[i] = static_cast<uint8>((i * 37 + i / 7) % 256);
+    }
+  }
+
+  Uint8ImageView view() const {
+    return {pixels.data(), width, height, channels, width_step};
+  }
+
+  // Samples channel c at (x, y) like cv::warpPerspective with INTER_LINEAR.
+  double Sample(double x, double y, int c, BorderMode border_mode) const {
+    const int x0 = std::floor(x);
+    const int y0 = std::floor(y);
+    double result = 0.0;
+    for (int dy = 0; dy < 2; ++dy) {
+      for (int dx = 0; dx < 2; ++dx) {
+        int px = x0 + dx;
+        int py = y0 + dy;
+        const double weight = (dx ? x - x0 : 1 - (x - x0)) *
+                              (dy ? y - y0 : 1 - (y - y0));
+        if (px < 0 || px >= width || py < 0 || py >= height) {
+          if (border_mode == BorderMode::kZero) continue;
+          px = std::clamp(px, 0, width - 1);
+          py = std::clamp(py, 0, height - 1);
+        }
+        result += weight * pixels[py * width_step + px * channels + c];
+      }
+    }
+    return result;
+  }
+
+  int width;
+  int height;
+  int channels;
+  int width_step;
+  std::vector<uint8> pixels;
+};
+
+// Returns the expected float output of ExtractSubRectToTensor.
+std::vector<float> Reference(const TestImage& image, const RotatedRect& roi,
+                             BorderMode border_mode, float scale, float offset,
+                             int dst_width, int dst_height, int dst_channels) {
+  std::vector<float> result;
+  const double left = roi.center_x - roi.width / 2.0;
+  const double top = roi.center_y - roi.height / 2.0;
+  for (int y = 0; y < dst_height; ++y) {
+    for (int x = 0; x < dst_width; ++x) {
+      for (int c = 0; c < dst_channels; ++c) {
+        const double value =
+            image.Sample(left + x * roi.width / dst_width,
+                         top + y * roi.height / dst_height, c, border_mode);
+        result.push_back(value * scale + offset);
+      }
+    }
+  }
+  return result;
+}
+
+TEST(ImageToTensorCpuKernelTest, OnlyHandlesAxisAlignedRects) {
+  EXPECT_TRUE(CanExtractSubRectToTensor({10, 10, 20, 20, 0}));
+  EXPECT_FALSE(CanExtractSubRectToTensor({10, 10, 20, 20, M_PI / 2}));
+  EXPECT_FALSE(CanExtractSubRectToTensor({10, 10, 0, 20, 0}));
+}
+
+TEST(ImageToTensorCpuKernelTest, CopiesWholeImage) {
+  TestImage image(4, 3, 3);
+  std::vector<uint8> tensor(4 * 3 * 3);
+  ExtractSubRectToTensor(image.view(), {2.0f, 1.5f, 4.0f, 3.0f, 0.0f},
+                         BorderMode::kReplicate, /*scale=*/1.0f,
+                         /*offset=*/0.0f, 4, 3, 3, tensor.data());
+  for (int y = 0; y < 3; ++y) {
+    std::vector<uint8> row(image.pixels.begin() + y * image.width_step,
+                           image.pixels.begin() + y * image.width_step + 12);
+    EXPECT_THAT(std::vector<uint8>(tensor.begin() + y * 12,
+                                   tensor.begin() + (y + 1) * 12),
+                ElementsAreArray(row));
+  }
+}
+
+TEST(ImageToTensorCpuKernelTest, DropsAlphaAndNormalizes) {
+  TestImage image(1, 1, 4);
+  image.pixels = {0, 51, 255, 7, 0, 0, 0, 0, 0};
+  std::vector<float> tensor(3);
+  ExtractSubRectToTensor(image.view(), {0.5f, 0.5f, 1.0f, 1.0f, 0.0f},
+                         BorderMode::kReplicate, /*scale=*/2.0f / 255.0f,
+                         /*offset=*/-1.0f, 1, 1, 3, tensor.data());
+  EXPECT_THAT(tensor, Pointwise(FloatNear(1e-6f), {-1.0f, -0.6f, 1.0f}));
+}
+
+TEST(ImageToTensorCpuKernelTest, SaturatesIntegers) {
+  TestImage image(1, 1, 1);
+  image.pixels = {200, 0, 0, 0, 0, 0};
+  std::vector<int8> int8_tensor(1);
+  ExtractSubRectToTensor(image.view(), {0.5f, 0.5f, 1.0f, 1.0f, 0.0f},
+                         BorderMode::kReplicate, /*scale=*/1.0f,
+                         /*offset=*/-128.0f, 1, 1, 1, int8_tensor.data());
+  EXPECT_EQ(int8_tensor[0], 72);
+  std::vector<uint8> uint8_tensor(1);
+  ExtractSubRectToTensor(image.view(), {0.5f, 0.5f, 1.0f, 1.0f, 0.0f},
+                         BorderMode::kReplicate, /*scale=*/2.0f,
+                         /*offset=*/0.0f, 1, 1, 1, uint8_tensor.data());
+  EXPECT_EQ(uint8_tensor[0], 255);
+  ExtractSubRectToTensor(image.view(), {0.5f, 0.5f, 1.0f, 1.0f, 0.0f},
+                         BorderMode::kReplicate, /*scale=*/-1.0f,
+                         /*offset=*/-128.0f, 1, 1, 1, int8_tensor.data());
+  EXPECT_EQ(int8_tensor[0], -128);
+}
+
+TEST(ImageToTensorCpuKernelTest, MatchesReferenceSampling) {
+  TestImage image(37, 29, 4);
+  // Downscaling, upscaling, and rects extending beyond the image.
+  const std::vector<RotatedRect> rois = {{18.5f, 14.5f, 37.0f, 29.0f, 0.0f},
+                                         {20.3f, 11.7f, 9.5f, 7.25f, 0.0f},
+                                         {5.0f, 25.0f, 30.0f, 24.0f, 0.0f}};
+  for (BorderMode border_mode : {BorderMode::kReplicate, BorderMode::kZero}) {
+    for (const RotatedRect& roi : rois) {
+      std::vector<float> tensor(19 * 13 * 3);
+      ExtractSubRectToTensor(image.view(), roi, border_mode,
+                             /*scale=*/1.0f / 255.0f, /*offset=*/0.0f, 19, 13,
+                             3, tensor.data());
+      const std::vector<float> expected = Reference(
+          image, roi, border_mode, 1.0f / 255.0f, 0.0f, 19, 13, 3);
+      for (int i = 0; i < tensor.size(); ++i) {
+        ASSERT_NEAR(tensor[i], expected[i], 1e-4f) << "at " << i;
+      }
+    }
+  }
+}
+
+// A YUV 4:2:0 image with pseudo-random samples, stored as NV12 (interleaved
+// chroma) or I420 (planar chroma).
+struct TestYuvImage {
+  TestYuvImage(int width, int height, bool interleaved)
+      : width(width), height(height), interleaved(interleaved) {
+    y_stride = width + 3;
+    const int uv_width = (width + 1) / 2;
+    const int uv_height = (height + 1) / 2;
+    uv_stride = (interleaved ? uv_width * 2 : uv_width) + 1;
+    y_plane.resize(y_stride * height);
+    for (int i = 0; i < y_plane.size(); ++i) {
+      y_plane[i] = static_cast<uint8>(16 + (i * 37 + i / 7) % 220);
+    }
+    uv_planes.resize(uv_stride * uv_height * (interleaved ? 1 : 2));
+    for (int i = 0; i < uv_planes.size(); ++i) {
+      uv_planes[i] = static_cast<uint8>(16 + (i * 53 + i / 5) % 225);
+    }
+  }
+
+  YuvImageView view(YuvColorSpace color_space) const {
+    const uint8* u_data = uv_planes.data();
+    const uint8* v_data =
+        interleaved ? u_data + 1
+                    : u_data + uv_stride * ((height + 1) / 2);
+    return {y_plane.data(), u_data, v_data,      y_stride,   uv_stride,
+            interleaved ? 2 : 1,    width,  height, color_space};
+  }
+
+  // Returns channel c of the RGB value of pixel (x, y) for BT.601 limited
+  // range.
+  double Rgb(int x, int y, int c) const {
+    const YuvImageView yuv = view(YuvColorSpace::kBt601LimitedRange);
+    const int uv_index = (y / 2) * uv_stride + (x / 2) * yuv.uv_pixel_stride;
+    const double luma = 1.164383 * (y_plane[y * y_stride + x] - 16.0);
+    const double u = yuv.u_data[uv_index] - 128.0;
+    const double v = yuv.v_data[uv_index] - 128.0;
+    const double rgb[3] = {luma + 1.596027 * v,
+                           luma - 0.391762 * u - 0.812968 * v,
+                           luma + 2.017232 * u};
+    return std::clamp(rgb[c], 0.0, 255.0);
+  }
+
+  // Samples channel c at (x, y) like cv::warpAffine with INTER_LINEAR.
+  double Sample(double x, double y, int c, BorderMode border_mode) const {
+    const int x0 = std::floor(x);
+    const int y0 = std::floor(y);
+    double result = 0.0;
+    for (int dy = 0; dy < 2; ++dy) {
+      for (int dx = 0; dx < 2; ++dx) {
+        int px = x0 + dx;
+        int py = y0 + dy;
+        const double weight = (dx ? x - x0 : 1 - (x - x0)) *
+                              (dy ? y - y0 : 1 - (y - y0));
+        if (px < 0 || px >= width || py < 0 || py >= height) {
+          if (border_mode == BorderMode::kZero) continue;
+          px = std::clamp(px, 0, width - 1);
+          py = std::clamp(py, 0, height - 1);
+        }
+        result += weight * Rgb(px, py, c);
+      }
+    }
+    return result;
+  }
+
+  int width;
+  int height;
+  bool interleaved;
+  int y_stride;
+  int uv_stride;
+  std::vector<uint8> y_plane;
+  std::vector<uint8> uv_planes;
+};
+
+TEST(ImageToTensorCpuKernelTest, ConvertsYuvColorSpaces) {
+  const uint8 y = 76;
+  const uint8 u = 85;
+  const uint8 v = 255;
+  const auto convert = [&](uint8 luma, YuvColorSpace color_space) {
+    const YuvImageView image = {&luma, &u, &v, 1, 1, 1, 1, 1, color_space};
+    std::vector<float> tensor(3);
+    ExtractSubRectToTensor(image, {0.5f, 0.5f, 1.0f, 1.0f, 0.0f},
+                           BorderMode::kReplicate, /*scale=*/1.0f,
+                           /*offset=*/0.0f, 1, 1, tensor.data());
+    return tensor;
+  };
+  // Saturated red, with clamped components.
+  EXPECT_THAT(convert(y, YuvColorSpace::kBt601FullRange),
+              Pointwise(FloatNear(0.5f), {254.05f, 0.0f, 0.0f}));
+  EXPECT_THAT(convert(y, YuvColorSpace::kBt709FullRange),
+              Pointwise(FloatNear(0.5f), {255.0f, 24.6f, 0.0f}));
+  EXPECT_THAT(convert(y, YuvColorSpace::kBt601LimitedRange),
+              Pointwise(FloatNear(0.5f), {255.0f, 0.0f, 0.0f}));
+  EXPECT_THAT(convert(y, YuvColorSpace::kBt709LimitedRange),
+              Pointwise(FloatNear(0.5f), {255.0f, 11.35f, 0.0f}));
+}
+
+TEST(ImageToTensorCpuKernelTest, MatchesReferenceYuvSampling) {
+  // Axis-aligned rects, including one extending beyond the image, and
+  // rotated rects.
+  const std::vector<RotatedRect> rois = {{16.5f, 14.5f, 33.0f, 29.0f, 0.0f},
+                                         {5.0f, 25.0f, 30.0f, 24.0f, 0.0f},
+                                         {17.3f, 11.7f, 19.5f, 9.25f, 0.5f},
+                                         {10.0f, 12.0f, 30.0f, 20.0f, -2.0f}};
+  for (bool interleaved : {true, false}) {
+    const TestYuvImage image(33, 29, interleaved);
+    for (BorderMode border_mode : {BorderMode::kReplicate, BorderMode::kZero}) {
+      for (const RotatedRect& roi : rois) {
+        std::vector<float> tensor(19 * 13 * 3);
+        ExtractSubRectToTensor(image.view(YuvColorSpace::kBt601LimitedRange),
+                               roi, border_mode, /*scale=*/1.0f / 255.0f,
+                               /*offset=*/0.0f, 19, 13, tensor.data());
+        const double cos_rotation = std::cos(roi.rotation);
+        const double sin_rotation = std::sin(roi.rotation);
+        for (int y = 0; y < 13; ++y) {
+          for (int x = 0; x < 19; ++x) {
+            const double dx = x * roi.width / 19.0 - roi.width / 2.0;
+            const double dy = y * roi.height / 13.0 - roi.height / 2.0;
+            for (int c = 0; c < 3; ++c) {
+              const double expected =
+                  image.Sample(roi.center_x + dx * cos_rotation -
+                                   dy * sin_rotation,
+                               roi.center_y + dx * sin_rotation +
+                                   dy * cos_rotation,
+                               c, border_mode) /
+                  255.0;
+              ASSERT_NEAR(tensor[(y * 19 + x) * 3 + c], expected, 1e-4)
+                  << "at " << x << ", " << y << ", " << c;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
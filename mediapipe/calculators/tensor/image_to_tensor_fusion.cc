@@ -0,0 +1,155 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Folds the rotations of ImageTransformationCalculators into the
+// ImageToTensorCalculators that consume them, so that the rotated image is
+// never rendered: ImageToTensorCalculator samples the unrotated image with a
+// rotated region instead.
+
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/image/image_transformation_calculator.pb.h"
+#include "mediapipe/calculators/image/rotation_mode.pb.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/tool/graph_optimization.h"
+#include "mediapipe/framework/tool/options_map.h"
+#include "mediapipe/framework/tool/validate_name.h"
+
+namespace mediapipe {
+
+namespace {
+
+struct TagAndName {
+  std::string tag;
+  std::string name;
+};
+
+absl::StatusOr<TagAndName> ParseStream(const std::string& stream) {
+  TagAndName result;
+  int index;
+  MP_RETURN_IF_ERROR(
+      tool::ParseTagIndexName(stream, &result.tag, &index, &result.name));
+  return result;
+}
+
+// Returns the counterclockwise rotation in degrees of an
+// ImageTransformationCalculator node, or -1 if the node does anything but
+// rotate its single image input.
+absl::StatusOr<int> RotationOnly(const CalculatorGraphConfig::Node& node) {
+  if (node.calculator() != "ImageTransformationCalculator" ||
+      node.input_stream_size() != 1 || node.output_stream_size() != 1 ||
+      node.input_side_packet_size() != 0 ||
+      node.output_side_packet_size() != 0) {
+    return -1;
+  }
+  ASSIGN_OR_RETURN(TagAndName input, ParseStream(node.input_stream(0)));
+  ASSIGN_OR_RETURN(TagAndName output, ParseStream(node.output_stream(0)));
+  if (input.tag != output.tag ||
+      (input.tag != "IMAGE" && input.tag != "IMAGE_GPU")) {
+    return -1;
+  }
+  auto options = tool::OptionsMap()
+                     .Initialize(node)
+                     .Get<ImageTransformationCalculatorOptions>();
+  const RotationMode::Mode rotation_mode = options.rotation_mode();
+  options.clear_rotation_mode();
+  // Only used by the FIT scale mode, which needs output dimensions.
+  options.clear_constant_padding();
+  if (options.ByteSizeLong() != 0) return -1;
+  switch (rotation_mode) {
+    case RotationMode::ROTATION_90:
+      return 90;
+    case RotationMode::ROTATION_180:
+      return 180;
+    case RotationMode::ROTATION_270:
+      return 270;
+    default:
+      return 0;
+  }
+}
+
+// Fuses ImageTransformationCalculators that only rotate their input into
+// their consumers, if those are all ImageToTensorCalculators reading the
+// image with the same tag.
+absl::StatusOr<int> FuseImageRotations(CalculatorGraphConfig* config) {
+  int num_removed = 0;
+  bool fused = true;
+  // Fusing a node can make an upstream rotation fusable, so repeat until
+  // nothing changes.
+  while (fused) {
+    fused = false;
+    for (int i = 0; i < config->node_size(); ++i) {
+      const CalculatorGraphConfig::Node& node = config->node(i);
+      ASSIGN_OR_RETURN(int rotation, RotationOnly(node));
+      if (rotation < 0) continue;
+      ASSIGN_OR_RETURN(TagAndName output, ParseStream(node.output_stream(0)));
+
+      bool graph_output = false;
+      for (const std::string& stream : config->output_stream()) {
+        ASSIGN_OR_RETURN(TagAndName graph_stream, ParseStream(stream));
+        graph_output |= graph_stream.name == output.name;
+      }
+      if (graph_output) continue;
+
+      // The consumers of the rotated image, and the index of its input
+      // stream in each.
+      std::vector<std::pair<int, int>> consumers;
+      bool fusable = true;
+      for (int j = 0; j < config->node_size() && fusable; ++j) {
+        const CalculatorGraphConfig::Node& consumer = config->node(j);
+        for (int k = 0; k < consumer.input_stream_size(); ++k) {
+          ASSIGN_OR_RETURN(TagAndName input,
+                           ParseStream(consumer.input_stream(k)));
+          if (input.name != output.name) continue;
+          if (consumer.calculator() != "ImageToTensorCalculator" ||
+              input.tag != output.tag) {
+            fusable = false;
+            break;
+          }
+          consumers.emplace_back(j, k);
+        }
+      }
+      if (!fusable || consumers.empty()) continue;
+
+      const std::string input_stream = node.input_stream(0);
+      for (const auto& [j, k] : consumers) {
+        CalculatorGraphConfig::Node* consumer = config->mutable_node(j);
+        *consumer->mutable_input_stream(k) = input_stream;
+        tool::MutableOptionsMap options_map;
+        options_map.Initialize(*consumer);
+        auto options = options_map.Get<ImageToTensorCalculatorOptions>();
+        options.set_input_rotation_degrees(
+            (options.input_rotation_degrees() + rotation) % 360);
+        options_map.Set(options);
+      }
+      config->mutable_node()->DeleteSubrange(i, 1);
+      ++num_removed;
+      fused = true;
+      break;
+    }
+  }
+  return num_removed;
+}
+
+}  // namespace
+
+REGISTER_MEDIAPIPE_NODE_FUSION(ImageToTensorRotationFusion,
+                               FuseImageRotations);
+
+}  // namespace mediapipe
@@ -0,0 +1,131 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/image_transformation_calculator.pb.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/graph_optimization.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(ImageToTensorFusionTest, FoldsRotationsIntoImageToTensor) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "tensors"
+        node {
+          calculator: "ImageTransformationCalculator"
+          input_stream: "IMAGE_GPU:image"
+          output_stream: "IMAGE_GPU:rotated"
+          options {
+            [mediapipe.ImageTransformationCalculatorOptions.ext] {
+              rotation_mode: ROTATION_90
+            }
+          }
+        }
+        node {
+          calculator: "ImageTransformationCalculator"
+          input_stream: "IMAGE_GPU:rotated"
+          output_stream: "IMAGE_GPU:rotated_again"
+          options {
+            [mediapipe.ImageTransformationCalculatorOptions.ext] {
+              rotation_mode: ROTATION_180
+            }
+          }
+        }
+        node {
+          calculator: "ImageToTensorCalculator"
+          input_stream: "IMAGE_GPU:rotated_again"
+          output_stream: "TENSORS:tensors"
+          options {
+            [mediapipe.ImageToTensorCalculatorOptions.ext] {
+              output_tensor_width: 256
+              output_tensor_height: 256
+            }
+          }
+        }
+      )pb");
+  CalculatorGraphConfig expected_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "tensors"
+        node {
+          calculator: "ImageToTensorCalculator"
+          input_stream: "IMAGE_GPU:image"
+          output_stream: "TENSORS:tensors"
+          options {
+            [mediapipe.ImageToTensorCalculatorOptions.ext] {
+              output_tensor_width: 256
+              output_tensor_height: 256
+              input_rotation_degrees: 270
+            }
+          }
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(int num_removed, tool::ApplyNodeFusions(&config));
+  EXPECT_EQ(num_removed, 2);
+  EXPECT_THAT(config, EqualsProto(expected_config));
+}
+
+TEST(ImageToTensorFusionTest, KeepsTransformationsWithOtherUses) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "flipped"
+        node {
+          calculator: "ImageTransformationCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "IMAGE:scaled"
+          options {
+            [mediapipe.ImageTransformationCalculatorOptions.ext] {
+              rotation_mode: ROTATION_90
+              output_width: 128
+              output_height: 128
+            }
+          }
+        }
+        node {
+          calculator: "ImageTransformationCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "IMAGE:flipped"
+          options {
+            [mediapipe.ImageTransformationCalculatorOptions.ext] {
+              rotation_mode: ROTATION_180
+            }
+          }
+        }
+        node {
+          calculator: "ImageToTensorCalculator"
+          input_stream: "IMAGE:scaled"
+          output_stream: "TENSORS:tensors"
+        }
+        node {
+          calculator: "ImageToTensorCalculator"
+          input_stream: "IMAGE:flipped"
+          output_stream: "TENSORS:flipped_tensors"
+        }
+      )pb");
+  const CalculatorGraphConfig original_config = config;
+  MP_ASSERT_OK_AND_ASSIGN(int num_removed, tool::ApplyNodeFusions(&config));
+  EXPECT_EQ(num_removed, 0);
+  EXPECT_THAT(config, EqualsProto(original_config));
+}
+
+}  // namespace
+}  // namespace mediapipe
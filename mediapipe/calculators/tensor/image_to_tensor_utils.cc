@@ -15,6 +15,7 @@
 #include "mediapipe/calculators/tensor/image_to_tensor_utils.h"
 
 #include <array>
+#include <cmath>
 
 #include "absl/status/status.h"
 #include "absl/types/optional.h"
@@ -78,6 +79,35 @@ absl::StatusOr<std::array<float, 4>> PadRoi(int input_tensor_width,
                               horizontal_padding, vertical_padding};
 }
 
+absl::StatusOr<RotatedRect> RotateRoiToInput(const RotatedRect& roi,
+                                             int rotation_degrees,
+                                             int input_width,
+                                             int input_height) {
+  RET_CHECK_EQ(rotation_degrees % 90, 0)
+      << "Rotation must be a multiple of 90 degrees.";
+  RotatedRect input_roi = roi;
+  // A counterclockwise rotation of the image turns the ROI axes clockwise in
+  // input coordinates, where y points down.
+  input_roi.rotation = roi.rotation + rotation_degrees * M_PI / 180.0f;
+  switch (((rotation_degrees % 360) + 360) % 360) {
+    case 0:
+      break;
+    case 90:
+      input_roi.center_x = input_width - roi.center_y;
+      input_roi.center_y = roi.center_x;
+      break;
+    case 180:
+      input_roi.center_x = input_width - roi.center_x;
+      input_roi.center_y = input_height - roi.center_y;
+      break;
+    case 270:
+      input_roi.center_x = roi.center_y;
+      input_roi.center_y = input_height - roi.center_x;
+      break;
+  }
+  return input_roi;
+}
+
 absl::StatusOr<ValueTransformation> GetValueRangeTransformation(
     float from_range_min, float from_range_max, float to_range_min,
     float to_range_max) {
@@ -233,7 +263,8 @@ Tensor::ElementType GetOutputTensorType(bool uses_gpu,
                                         const OutputTensorParams& params) {
   if (!uses_gpu) {
     if (params.is_float_output) {
-      return Tensor::ElementType::kFloat32;
+      return params.is_float16_output ? Tensor::ElementType::kFloat16
+                                      : Tensor::ElementType::kFloat32;
     }
     if (params.range_min < 0) {
       return Tensor::ElementType::kInt8;
@@ -55,6 +55,8 @@ struct OutputTensorParams {
   int output_width;
   int output_batch;
   bool is_float_output;
+  // Whether float output is in half precision (CPU only).
+  bool is_float16_output = false;
   float range_min;
   float range_max;
 };
@@ -70,6 +72,16 @@ absl::StatusOr<std::array<float, 4>> PadRoi(int input_tensor_width,
                                             bool keep_aspect_ratio,
                                             RotatedRect* roi);
 
+// Maps @roi, given in the coordinates of the input image rotated
+// counterclockwise by @rotation_degrees (a multiple of 90), to the
+// coordinates of the @input_width x @input_height input image. Extracting
+// the returned ROI from the input image gives the same pixels as extracting
+// @roi from the rotated image.
+absl::StatusOr<RotatedRect> RotateRoiToInput(const RotatedRect& roi,
+                                             int rotation_degrees,
+                                             int input_width,
+                                             int input_height);
+
 // Represents a transformation of value which involves scaling and offsetting.
 // To apply transformation:
 // ValueTransformation transform = ...
@@ -188,6 +200,8 @@ OutputTensorParams GetOutputTensorParams(const T& options) {
   params.output_width = options.output_tensor_width();
   params.output_height = options.output_tensor_height();
   params.is_float_output = options.has_output_tensor_float_range();
+  params.is_float16_output =
+      params.is_float_output && options.output_tensor_float16();
   params.output_batch = 1;
   return params;
 }
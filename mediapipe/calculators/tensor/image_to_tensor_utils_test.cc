@@ -106,6 +106,22 @@ TEST(PadRoi, VerticalPadding) {
   EXPECT_THAT(roi, EqRotatedRect(21, 21, 1, 2, 3));
 }
 
+TEST(RotateRoiToInput, MapsCentersAndRotation) {
+  // A 30x20 input image, rotated to a 20x30 image for 90 and 270 degrees.
+  const RotatedRect roi{
+      .center_x = 5, .center_y = 8, .width = 4, .height = 2, .rotation = 0};
+  MP_ASSERT_OK_AND_ASSIGN(RotatedRect input_roi,
+                          RotateRoiToInput(roi, 0, 30, 20));
+  EXPECT_THAT(input_roi, EqRotatedRect(4, 2, 5, 8, 0));
+  MP_ASSERT_OK_AND_ASSIGN(input_roi, RotateRoiToInput(roi, 90, 30, 20));
+  EXPECT_THAT(input_roi, EqRotatedRect(4, 2, 22, 5, M_PI / 2));
+  MP_ASSERT_OK_AND_ASSIGN(input_roi, RotateRoiToInput(roi, 180, 30, 20));
+  EXPECT_THAT(input_roi, EqRotatedRect(4, 2, 25, 12, M_PI));
+  MP_ASSERT_OK_AND_ASSIGN(input_roi, RotateRoiToInput(roi, 270, 30, 20));
+  EXPECT_THAT(input_roi, EqRotatedRect(4, 2, 8, 15, 3 * M_PI / 2));
+  EXPECT_FALSE(RotateRoiToInput(roi, 45, 30, 20).ok());
+}
+
 testing::Matcher<ValueTransformation> EqValueTransformation(float scale,
                                                             float offset) {
   return ::testing::AllOf(
@@ -238,6 +254,14 @@ TEST(GetOutputTensorType, GetOutputTensorType) {
   EXPECT_EQ(Tensor::ElementType::kFloat32,
             GetOutputTensorType(/*uses_gpu=*/false, params));
 
+  // Return float16 when is_float16_output is also set, but only on CPU.
+  params.is_float16_output = true;
+  EXPECT_EQ(Tensor::ElementType::kFloat16,
+            GetOutputTensorType(/*uses_gpu=*/false, params));
+  EXPECT_EQ(Tensor::ElementType::kFloat32,
+            GetOutputTensorType(/*uses_gpu=*/true, params));
+  params.is_float16_output = false;
+
   // Return int8 when range_min is negative.
   params.is_float_output = false;
   params.range_min = -255.0f;
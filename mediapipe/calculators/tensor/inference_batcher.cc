@@ -0,0 +1,236 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_batcher.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+const GraphService<InferenceBatcher> kInferenceBatcherService(
+    "mediapipe::InferenceBatcherService");
+
+namespace {
+
+// Returns `shape` with its leading dimension replaced by `batch_size`.
+Tensor::Shape WithBatchSize(const Tensor::Shape& shape, int batch_size) {
+  Tensor::Shape batched_shape = shape;
+  batched_shape.dims[0] = batch_size;
+  return batched_shape;
+}
+
+}  // namespace
+
+// Requests wait in the queue until a batch can be run. There is no thread of
+// its own: the first waiting caller to find a full batch, or a request past
+// its deadline, runs the next batch on behalf of all requests in it.
+class InferenceBatcher::BatchQueue {
+ public:
+  BatchQueue(std::unique_ptr<InferenceRunner> runner, int max_batch_size,
+             absl::Duration max_latency)
+      : runner_(std::move(runner)),
+        max_batch_size_(max_batch_size),
+        max_latency_(max_latency) {}
+
+  int max_batch_size() const { return max_batch_size_; }
+  absl::Duration max_latency() const { return max_latency_; }
+
+  absl::StatusOr<std::vector<Tensor>> Run(CalculatorContext* cc,
+                                          const std::vector<Tensor>& inputs);
+
+ private:
+  struct Request {
+    const std::vector<Tensor>* inputs;
+    absl::Time deadline;
+    bool done = false;
+    absl::StatusOr<std::vector<Tensor>> result;
+  };
+
+  // Returns true if the calling thread should run the next batch.
+  bool CanRunBatch() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !running_ && !pending_.empty() &&
+           (pending_.size() >= max_batch_size_ ||
+            absl::Now() >= pending_.front()->deadline);
+  }
+
+  // Runs "batch" and stores the result of each request in it.
+  void RunBatch(CalculatorContext* cc, const std::vector<Request*>& batch);
+  absl::Status RunBatchOrError(CalculatorContext* cc,
+                               const std::vector<Request*>& batch);
+
+  const std::unique_ptr<InferenceRunner> runner_;
+  const int max_batch_size_;
+  const absl::Duration max_latency_;
+
+  absl::Mutex mutex_;
+  std::deque<Request*> pending_ ABSL_GUARDED_BY(mutex_);
+  // Whether a batch is being run. Batches run one at a time, since the
+  // runner is not thread-safe.
+  bool running_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+absl::StatusOr<std::vector<Tensor>> InferenceBatcher::BatchQueue::Run(
+    CalculatorContext* cc, const std::vector<Tensor>& inputs) {
+  Request request;
+  request.inputs = &inputs;
+  request.deadline = absl::Now() + max_latency_;
+
+  absl::MutexLock lock(&mutex_);
+  pending_.push_back(&request);
+  while (!request.done) {
+    if (CanRunBatch()) {
+      const int batch_size = std::min<int>(pending_.size(), max_batch_size_);
+      std::vector<Request*> batch(pending_.begin(),
+                                  pending_.begin() + batch_size);
+      pending_.erase(pending_.begin(), pending_.begin() + batch_size);
+      running_ = true;
+      mutex_.Unlock();
+      RunBatch(cc, batch);
+      mutex_.Lock();
+      running_ = false;
+      for (Request* batched_request : batch) {
+        batched_request->done = true;
+      }
+      continue;
+    }
+    // While a batch is running, the runner wakes us up when it is done.
+    const absl::Time deadline =
+        running_ || pending_.empty() ? absl::InfiniteFuture()
+                                     : pending_.front()->deadline;
+    auto can_proceed = [this, &request]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+                           mutex_) { return request.done || CanRunBatch(); };
+    mutex_.AwaitWithDeadline(absl::Condition(&can_proceed), deadline);
+  }
+  return std::move(request.result);
+}
+
+void InferenceBatcher::BatchQueue::RunBatch(
+    CalculatorContext* cc, const std::vector<Request*>& batch) {
+  absl::Status status = RunBatchOrError(cc, batch);
+  if (!status.ok()) {
+    for (Request* request : batch) {
+      request->result = status;
+    }
+  }
+}
+
+absl::Status InferenceBatcher::BatchQueue::RunBatchOrError(
+    CalculatorContext* cc, const std::vector<Request*>& batch) {
+  // Gather the inputs of all requests. Slots not used by this batch are left
+  // zeroed.
+  const std::vector<Tensor>& first_inputs = *batch[0]->inputs;
+  std::vector<Tensor> batched_inputs;
+  batched_inputs.reserve(first_inputs.size());
+  for (const Tensor& input : first_inputs) {
+    RET_CHECK(!input.shape().dims.empty() && input.shape().dims[0] == 1)
+        << "Batched inference requires input tensors with a batch size of 1.";
+    batched_inputs.emplace_back(input.element_type(),
+                                WithBatchSize(input.shape(), max_batch_size_),
+                                input.quantization_parameters());
+    auto view = batched_inputs.back().GetCpuWriteView();
+    std::memset(view.buffer<uint8_t>(), 0, batched_inputs.back().bytes());
+  }
+  for (int b = 0; b < batch.size(); ++b) {
+    const std::vector<Tensor>& inputs = *batch[b]->inputs;
+    RET_CHECK_EQ(inputs.size(), batched_inputs.size());
+    for (int i = 0; i < inputs.size(); ++i) {
+      RET_CHECK(inputs[i].element_type() == first_inputs[i].element_type() &&
+                inputs[i].shape().dims == first_inputs[i].shape().dims)
+          << "Requests batched together must have matching input tensors.";
+      auto src = inputs[i].GetCpuReadView();
+      auto dst = batched_inputs[i].GetCpuWriteView();
+      std::memcpy(dst.buffer<uint8_t>() + b * inputs[i].bytes(),
+                  src.buffer<uint8_t>(), inputs[i].bytes());
+    }
+  }
+
+  ASSIGN_OR_RETURN(std::vector<Tensor> batched_outputs,
+                   runner_->Run(cc, batched_inputs));
+
+  // Scatter the outputs back to the requests.
+  for (const Tensor& output : batched_outputs) {
+    RET_CHECK(!output.shape().dims.empty() &&
+              output.shape().dims[0] == max_batch_size_)
+        << "Batched inference must produce outputs with a batch size of "
+        << max_batch_size_;
+  }
+  for (int b = 0; b < batch.size(); ++b) {
+    std::vector<Tensor> outputs;
+    outputs.reserve(batched_outputs.size());
+    for (const Tensor& batched_output : batched_outputs) {
+      outputs.emplace_back(batched_output.element_type(),
+                           WithBatchSize(batched_output.shape(), 1),
+                           batched_output.quantization_parameters());
+      const int slice_bytes = outputs.back().bytes();
+      auto src = batched_output.GetCpuReadView();
+      auto dst = outputs.back().GetCpuWriteView();
+      std::memcpy(dst.buffer<uint8_t>(),
+                  src.buffer<uint8_t>() + b * slice_bytes, slice_bytes);
+    }
+    batch[b]->result = std::move(outputs);
+  }
+  return absl::OkStatus();
+}
+
+class InferenceBatcher::BatchingRunner : public InferenceRunner {
+ public:
+  explicit BatchingRunner(std::shared_ptr<BatchQueue> queue)
+      : queue_(std::move(queue)) {}
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      CalculatorContext* cc, const std::vector<Tensor>& inputs) override {
+    return queue_->Run(cc, inputs);
+  }
+
+ private:
+  std::shared_ptr<BatchQueue> queue_;
+};
+
+absl::StatusOr<std::unique_ptr<InferenceRunner>>
+InferenceBatcher::CreateBatchingRunner(
+    const std::string& key, int max_batch_size, absl::Duration max_latency,
+    const CreateBatchedRunnerFn& create_batched_runner) {
+  RET_CHECK_GT(max_batch_size, 0);
+  absl::MutexLock lock(&mutex_);
+  std::shared_ptr<BatchQueue> queue = queues_[key].lock();
+  if (queue == nullptr) {
+    ASSIGN_OR_RETURN(auto runner, create_batched_runner(max_batch_size));
+    queue = std::make_shared<BatchQueue>(std::move(runner), max_batch_size,
+                                         max_latency);
+    queues_[key] = queue;
+  } else {
+    RET_CHECK(queue->max_batch_size() == max_batch_size &&
+              queue->max_latency() == max_latency)
+        << "Inference batching for \"" << key
+        << "\" is already configured with different parameters.";
+  }
+  return std::make_unique<BatchingRunner>(std::move(queue));
+}
+
+}  // namespace mediapipe
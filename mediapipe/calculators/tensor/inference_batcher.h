@@ -0,0 +1,75 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+
+// Collects inference requests for the same model from any number of graphs
+// into batches, so that they run as a single batched inference.
+//
+// To batch the inference of several graphs, set the same InferenceBatcher as
+// kInferenceBatcherService on all of them and configure their
+// InferenceCalculators with "batching".
+//
+//   auto batcher = std::make_shared<InferenceBatcher>();
+//   MP_RETURN_IF_ERROR(graph.SetServiceObject(kInferenceBatcherService,
+//                                             batcher));
+class InferenceBatcher {
+ public:
+  // Creates a runner that processes batches of `batch_size` inputs, i.e. whose
+  // input tensors have a leading dimension of `batch_size`.
+  using CreateBatchedRunnerFn =
+      std::function<absl::StatusOr<std::unique_ptr<InferenceRunner>>(
+          int batch_size)>;
+
+  // Returns a runner whose Run() calls are batched with those of all other
+  // runners created for `key`. Each Run() call takes input tensors with a
+  // leading dimension of 1, and waits until its batch is full or its request
+  // has waited for `max_latency`.
+  //
+  // `create_batched_runner` is only called for the first runner of `key`.
+  // Later calls must pass the same `max_batch_size` and `max_latency`.
+  absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateBatchingRunner(
+      const std::string& key, int max_batch_size, absl::Duration max_latency,
+      const CreateBatchedRunnerFn& create_batched_runner);
+
+ private:
+  class BatchQueue;
+  class BatchingRunner;
+
+  absl::Mutex mutex_;
+  // A queue lives as long as any runner created for it.
+  absl::flat_hash_map<std::string, std::weak_ptr<BatchQueue>> queues_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+extern const GraphService<InferenceBatcher> kInferenceBatcherService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_BATCHER_H_
@@ -0,0 +1,174 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_batcher.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+// Doubles a batch of int32 vectors of shape {batch_size, 2}.
+class DoublingRunner : public InferenceRunner {
+ public:
+  DoublingRunner(int batch_size, std::atomic<int>* num_runs)
+      : batch_size_(batch_size), num_runs_(num_runs) {}
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      CalculatorContext* cc, const std::vector<Tensor>& inputs) override {
+    ++*num_runs_;
+    EXPECT_EQ(inputs.size(), 1);
+    EXPECT_EQ(inputs[0].shape().dims, (std::vector<int>{batch_size_, 2}));
+    std::vector<Tensor> outputs;
+    outputs.emplace_back(Tensor::ElementType::kInt32, inputs[0].shape());
+    auto src = inputs[0].GetCpuReadView();
+    auto dst = outputs[0].GetCpuWriteView();
+    for (int i = 0; i < inputs[0].shape().num_elements(); ++i) {
+      dst.buffer<int32_t>()[i] = 2 * src.buffer<int32_t>()[i];
+    }
+    return outputs;
+  }
+
+ private:
+  const int batch_size_;
+  std::atomic<int>* num_runs_;
+};
+
+std::vector<Tensor> MakeInput(int value) {
+  std::vector<Tensor> inputs;
+  inputs.emplace_back(Tensor::ElementType::kInt32, Tensor::Shape{1, 2});
+  auto view = inputs[0].GetCpuWriteView();
+  view.buffer<int32_t>()[0] = value;
+  view.buffer<int32_t>()[1] = -value;
+  return inputs;
+}
+
+InferenceBatcher::CreateBatchedRunnerFn DoublingRunnerFactory(
+    std::atomic<int>* num_runs) {
+  return [num_runs](int batch_size)
+             -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+    return std::make_unique<DoublingRunner>(batch_size, num_runs);
+  };
+}
+
+TEST(InferenceBatcherTest, RunsPartialBatchAfterMaxLatency) {
+  InferenceBatcher batcher;
+  std::atomic<int> num_runs(0);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      batcher.CreateBatchingRunner("model", /*max_batch_size=*/4,
+                                   absl::Milliseconds(20),
+                                   DoublingRunnerFactory(&num_runs)));
+  const absl::Time start = absl::Now();
+  MP_ASSERT_OK_AND_ASSIGN(auto outputs, runner->Run(nullptr, MakeInput(3)));
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(20));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs[0].shape().dims, (std::vector<int>{1, 2}));
+  auto view = outputs[0].GetCpuReadView();
+  EXPECT_EQ(view.buffer<int32_t>()[0], 6);
+  EXPECT_EQ(view.buffer<int32_t>()[1], -6);
+  EXPECT_EQ(num_runs, 1);
+}
+
+TEST(InferenceBatcherTest, BatchesRequestsFromSeveralRunners) {
+  constexpr int kNumClients = 4;
+  constexpr int kNumRequestsPerClient = 10;
+  InferenceBatcher batcher;
+  std::atomic<int> num_runs(0);
+  std::vector<std::unique_ptr<InferenceRunner>> runners;
+  for (int i = 0; i < kNumClients; ++i) {
+    MP_ASSERT_OK_AND_ASSIGN(
+        auto runner,
+        batcher.CreateBatchingRunner("model", /*max_batch_size=*/kNumClients,
+                                     absl::Seconds(10),
+                                     DoublingRunnerFactory(&num_runs)));
+    runners.push_back(std::move(runner));
+  }
+  {
+    ThreadPool thread_pool("batcher_test", kNumClients);
+    thread_pool.StartWorkers();
+    for (int c = 0; c < kNumClients; ++c) {
+      thread_pool.Schedule([&, c] {
+        for (int r = 0; r < kNumRequestsPerClient; ++r) {
+          const int value = c * 100 + r;
+          auto outputs = runners[c]->Run(nullptr, MakeInput(value));
+          ASSERT_TRUE(outputs.ok()) << outputs.status();
+          auto view = (*outputs)[0].GetCpuReadView();
+          EXPECT_EQ(view.buffer<int32_t>()[0], 2 * value);
+          EXPECT_EQ(view.buffer<int32_t>()[1], -2 * value);
+        }
+      });
+    }
+  }
+  // The long max latency means that only full batches were run.
+  EXPECT_EQ(num_runs, kNumRequestsPerClient);
+}
+
+TEST(InferenceBatcherTest, KeepsKeysSeparate) {
+  InferenceBatcher batcher;
+  std::atomic<int> num_runs_a(0);
+  std::atomic<int> num_runs_b(0);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner_a,
+      batcher.CreateBatchingRunner("a", 1, absl::ZeroDuration(),
+                                   DoublingRunnerFactory(&num_runs_a)));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner_b,
+      batcher.CreateBatchingRunner("b", 1, absl::ZeroDuration(),
+                                   DoublingRunnerFactory(&num_runs_b)));
+  MP_ASSERT_OK(runner_a->Run(nullptr, MakeInput(1)).status());
+  MP_ASSERT_OK(runner_b->Run(nullptr, MakeInput(1)).status());
+  MP_ASSERT_OK(runner_b->Run(nullptr, MakeInput(1)).status());
+  EXPECT_EQ(num_runs_a, 1);
+  EXPECT_EQ(num_runs_b, 2);
+}
+
+TEST(InferenceBatcherTest, RejectsMismatchedParameters) {
+  InferenceBatcher batcher;
+  std::atomic<int> num_runs(0);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      batcher.CreateBatchingRunner("model", 2, absl::ZeroDuration(),
+                                   DoublingRunnerFactory(&num_runs)));
+  EXPECT_FALSE(batcher
+                   .CreateBatchingRunner("model", 3, absl::ZeroDuration(),
+                                         DoublingRunnerFactory(&num_runs))
+                   .ok());
+}
+
+TEST(InferenceBatcherTest, RejectsBatchedInputs) {
+  InferenceBatcher batcher;
+  std::atomic<int> num_runs(0);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      batcher.CreateBatchingRunner("model", 2, absl::ZeroDuration(),
+                                   DoublingRunnerFactory(&num_runs)));
+  std::vector<Tensor> inputs;
+  inputs.emplace_back(Tensor::ElementType::kInt32, Tensor::Shape{2, 2});
+  EXPECT_FALSE(runner->Run(nullptr, inputs).ok());
+  EXPECT_EQ(num_runs, 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/calculators/tensor/inference_calculator.pb.h"
 #include "mediapipe/framework/api2/packet.h"
@@ -40,9 +41,15 @@ class InferenceCalculatorSelectorImpl
             subgraph_node);
     std::vector<absl::string_view> impls;
 
+    // Only the CPU implementation can replace its model while running.
+    bool has_model_stream = false;
+    for (const auto& stream : subgraph_node.input_stream()) {
+      has_model_stream |= absl::StartsWith(stream, "MODEL:");
+    }
     const bool should_use_gpu =
-        !options.has_delegate() ||  // Use GPU delegate if not specified
-        (options.has_delegate() && options.delegate().has_gpu());
+        !has_model_stream &&
+        (!options.has_delegate() ||  // Use GPU delegate if not specified
+         (options.has_delegate() && options.delegate().has_gpu()));
     if (should_use_gpu) {
       const auto& api = options.delegate().gpu().api();
       using Gpu = ::mediapipe::InferenceCalculatorOptions::Delegate::Gpu;
@@ -58,6 +65,10 @@ class InferenceCalculatorSelectorImpl
         impls.emplace_back("GlAdvanced");
       }
     }
+    // Without the Hexagon implementation, the CPU one runs the model.
+    if (options.delegate().has_hexagon()) {
+      impls.emplace_back("Hexagon");
+    }
     impls.emplace_back("Cpu");
     impls.emplace_back("Xnnpack");
     for (const auto& suffix : impls) {
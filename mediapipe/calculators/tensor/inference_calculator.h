@@ -60,6 +60,13 @@ namespace api2 {
 //                     (std::unique_ptr<tflite::FlatBufferModel,
 //                       std::function<void(tflite::FlatBufferModel*)>>)
 //
+// Optional input:
+//  MODEL - Replaces the model while the graph is running (same type as the
+//          MODEL side packet). The interpreters of the new model are built in
+//          the background while the current model keeps serving, and take
+//          over at the first TENSORS packet after they are ready. Only
+//          supported by InferenceCalculatorCpu, and not with batching.
+//
 // Example use:
 // node {
 //   calculator: "InferenceCalculator"
@@ -87,6 +94,23 @@ namespace api2 {
 //   }
 // }
 //
+// The GPU implementations run on the "gpu" accelerator, the Hexagon one on
+// "hexagon", and the CPU one on "nnapi" or "coreml" when configured with those
+// delegates. A graph can give each accelerator its own executor with
+// ThreadPoolExecutorOptions "accelerator", so that e.g. detection on NNAPI and
+// landmarks on the GPU process different frames at the same time:
+//
+// executor {
+//   name: "gpu_inference"
+//   type: "ThreadPoolExecutor"
+//   options {
+//     [mediapipe.ThreadPoolExecutorOptions.ext] {
+//       num_threads: 1
+//       accelerator: "gpu"
+//     }
+//   }
+// }
+//
 // IMPORTANT Notes:
 //  Tensors are assumed to be ordered correctly (sequentially added to model).
 //  Input tensors are assumed to be of the correct size and already normalized.
@@ -102,13 +126,14 @@ class InferenceCalculator : public NodeIntf {
   static constexpr SideInput<tflite::OpResolver>::Optional kSideInOpResolver{
       "OP_RESOLVER"};
   static constexpr SideInput<TfLiteModelPtr>::Optional kSideInModel{"MODEL"};
+  static constexpr Input<TfLiteModelPtr>::Optional kInModel{"MODEL"};
   static constexpr Output<std::vector<Tensor>> kOutTensors{"TENSORS"};
   static constexpr SideInput<
       mediapipe::InferenceCalculatorOptions::Delegate>::Optional kDelegate{
       "DELEGATE"};
   MEDIAPIPE_NODE_CONTRACT(kInTensors, kSideInCustomOpResolver,
-                          kSideInOpResolver, kSideInModel, kOutTensors,
-                          kDelegate);
+                          kSideInOpResolver, kSideInModel, kInModel,
+                          kOutTensors, kDelegate);
 
  protected:
   using TfLiteDelegatePtr =
@@ -145,6 +170,10 @@ struct InferenceCalculatorXnnpack : public InferenceCalculator {
   static constexpr char kCalculatorName[] = "InferenceCalculatorXnnpack";
 };
 
+struct InferenceCalculatorHexagon : public InferenceCalculator {
+  static constexpr char kCalculatorName[] = "InferenceCalculatorHexagon";
+};
+
 }  // namespace api2
 }  // namespace mediapipe
 
@@ -12,27 +12,96 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/tensor/inference_batcher.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
 #include "mediapipe/calculators/tensor/inference_calculator_utils.h"
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 #include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+#include "mediapipe/framework/memory_trimmer.h"
+#include "mediapipe/framework/port.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/framework/tensor_pool_service.h"
+#include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/interpreter.h"
 #if defined(MEDIAPIPE_ANDROID)
+#include <sys/system_properties.h>
+
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #endif  // ANDROID
+#if defined(MEDIAPIPE_IOS)
+#include "tensorflow/lite/delegates/coreml/coreml_delegate.h"
+#endif  // MEDIAPIPE_IOS
 #include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
 
 namespace mediapipe {
 namespace api2 {
 
+namespace {
+
+using Delegate = ::mediapipe::InferenceCalculatorOptions::Delegate;
+
+// FNV-1a, which unlike absl::Hash is stable across processes.
+uint64_t Fingerprint(absl::string_view data) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : data) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+  }
+  return hash;
+}
+
+// Identifies the device and system the delegate benchmarks ran on.
+std::string DeviceFingerprint() {
+#if defined(MEDIAPIPE_ANDROID)
+  char fingerprint[PROP_VALUE_MAX] = {};
+  char platform[PROP_VALUE_MAX] = {};
+  __system_property_get("ro.build.fingerprint", fingerprint);
+  __system_property_get("ro.board.platform", platform);
+  return absl::StrCat(platform, "/", fingerprint);
+#else
+  return "host";
+#endif  // MEDIAPIPE_ANDROID
+}
+
+// The delegates auto_select chooses from, in order of preference on ties.
+std::vector<std::pair<std::string, Delegate>> AutoSelectCandidates() {
+  std::vector<std::pair<std::string, Delegate>> candidates(2);
+  candidates[0].first = "xnnpack";
+  candidates[0].second.mutable_xnnpack();
+  candidates[1].first = "tflite";
+  candidates[1].second.mutable_tflite();
+#if defined(MEDIAPIPE_ANDROID)
+  candidates.emplace_back();
+  candidates.back().first = "nnapi";
+  candidates.back().second.mutable_nnapi();
+#endif  // MEDIAPIPE_ANDROID
+#if defined(MEDIAPIPE_IOS)
+  candidates.emplace_back();
+  candidates.back().first = "coreml";
+  candidates.back().second.mutable_coreml();
+#endif  // MEDIAPIPE_IOS
+  return candidates;
+}
+
+}  // namespace
+
 class InferenceCalculatorCpuImpl
     : public NodeImpl<InferenceCalculatorCpu, InferenceCalculatorCpuImpl> {
  public:
@@ -45,31 +114,149 @@ class InferenceCalculatorCpuImpl
  private:
   absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunner(
       CalculatorContext* cc);
-  absl::StatusOr<TfLiteDelegatePtr> MaybeCreateDelegate(CalculatorContext* cc);
+  // Creates the interpreters of `model_packet` without batching. Doesn't use
+  // the calculator context, so that models received on the MODEL stream can
+  // be loaded in the background.
+  absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInterpreterPool(
+      Packet<TfLiteModelPtr> model_packet);
+  absl::StatusOr<TfLiteDelegatePtr> MaybeCreateDelegate();
+  // Builds the interpreters of a model received on the MODEL stream in the
+  // background, or right away if there is no model to serve meanwhile.
+  absl::Status UpdateModel(Packet<TfLiteModelPtr> model_packet);
+  // Replaces the auto_select delegate options with the delegate stored in
+  // the cache, if any, and creates the interpreters.
+  absl::Status OpenAutoSelect(CalculatorContext* cc);
+  // Benchmarks the candidate delegates with `input_tensors`, stores the
+  // fastest in the cache and creates its interpreters.
+  absl::Status AutoSelectDelegate(CalculatorContext* cc,
+                                  const std::vector<Tensor>& input_tensors);
 
+  mediapipe::InferenceCalculatorOptions options_;
+  // The delegate options, merged with the DELEGATE side packet.
+  mediapipe::InferenceCalculatorOptions::Delegate delegate_options_;
+  bool has_delegate_ = false;
+  Packet<tflite::OpResolver> op_resolver_packet_;
   std::unique_ptr<InferenceRunner> inference_runner_;
+  // The model and the cache file of the auto_select delegate.
+  Packet<TfLiteModelPtr> auto_select_model_;
+  std::string auto_select_cache_path_;
+  // Releases the memory of the interpreters under memory pressure, if set.
+  MemoryTrimmer* memory_trimmer_ = nullptr;
+
+  absl::Mutex mutex_;
+  // The interpreters of the latest loaded model, which replace
+  // inference_runner_ at the next inference.
+  std::unique_ptr<InferenceRunner> next_inference_runner_
+      ABSL_GUARDED_BY(mutex_);
+  absl::Status model_loading_status_ ABSL_GUARDED_BY(mutex_);
+  // Loads the models received on the MODEL stream. Declared last to be joined
+  // before the state it updates is destroyed.
+  std::unique_ptr<ThreadPool> model_loader_;
 };
 
 absl::Status InferenceCalculatorCpuImpl::UpdateContract(
     CalculatorContract* cc) {
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
-  RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
-      << "Either model as side packet or model path in options is required.";
+  if (kInModel(cc).IsConnected()) {
+    RET_CHECK(options.model_path().empty() || !kSideInModel(cc).IsConnected())
+        << "The initial model can't be both a side packet and a model path.";
+    RET_CHECK(!options.has_batching())
+        << "Batching doesn't support the MODEL input stream.";
+    // Models and tensors arrive independently.
+    cc->SetInputStreamHandler("ImmediateInputStreamHandler");
+  } else {
+    RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
+        << "Either model as side packet or model path in options is required.";
+    // With a fixed model, each inference only depends on its input tensors.
+    cc->SetStateless(true);
+  }
+  if (options.has_batching()) {
+    cc->UseService(kInferenceBatcherService).Optional();
+  }
+  // Loads the model without waiting for the upstream nodes to be opened.
+  cc->SetInputStreamHeadersNeeded(false);
+  UseTensorPool(cc);
+  cc->UseService(kMemoryTrimmerService).Optional();
+  cc->SetWorkload(CalculatorContract::Workload::kHeavy);
+  if (options.delegate().has_nnapi() ||
+      (!options.has_delegate() && options.use_nnapi())) {
+    cc->SetAccelerator("nnapi");
+  } else if (options.delegate().has_coreml()) {
+    cc->SetAccelerator("coreml");
+  }
 
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Open(CalculatorContext* cc) {
+  options_ = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  delegate_options_ = options_.delegate();
+  if (cc->Service(kMemoryTrimmerService).IsAvailable()) {
+    memory_trimmer_ = &cc->Service(kMemoryTrimmerService).GetObject();
+  }
+  if (!kDelegate(cc).IsEmpty()) {
+    const mediapipe::InferenceCalculatorOptions::Delegate&
+        input_side_packet_delegate = kDelegate(cc).Get();
+    RET_CHECK(
+        input_side_packet_delegate.has_tflite() ||
+        input_side_packet_delegate.has_xnnpack() ||
+        input_side_packet_delegate.has_nnapi() ||
+        input_side_packet_delegate.has_coreml() ||
+        input_side_packet_delegate.has_auto_select() ||
+        input_side_packet_delegate.delegate_case() ==
+            mediapipe::InferenceCalculatorOptions::Delegate::DELEGATE_NOT_SET)
+        << "inference_calculator_cpu only supports delegate input side packet "
+        << "for TFLite, XNNPack, Nnapi, CoreMl and AutoSelect";
+    delegate_options_.MergeFrom(input_side_packet_delegate);
+  }
+  has_delegate_ = options_.has_delegate() || !kDelegate(cc).IsEmpty();
+  ASSIGN_OR_RETURN(op_resolver_packet_, GetOpResolverAsPacket(cc));
+  if (has_delegate_ && delegate_options_.has_auto_select()) {
+    return OpenAutoSelect(cc);
+  }
+
+  if (kInModel(cc).IsConnected()) {
+    model_loader_ =
+        std::make_unique<ThreadPool>("mediapipe_inference_model_loader", 1);
+    model_loader_->StartWorkers();
+    // The initial model is optional, the first one may come from the stream.
+    if (options_.model_path().empty() && kSideInModel(cc).IsEmpty()) {
+      return absl::OkStatus();
+    }
+  }
   ASSIGN_OR_RETURN(inference_runner_, CreateInferenceRunner(cc));
+  if (options_.warm_up()) {
+    MP_RETURN_IF_ERROR(inference_runner_->WarmUp());
+  }
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
+  if (!kInModel(cc).IsEmpty()) {
+    MP_RETURN_IF_ERROR(UpdateModel(kInModel(cc)));
+  }
   if (kInTensors(cc).IsEmpty()) {
     return absl::OkStatus();
   }
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
+  if (!inference_runner_ && delegate_options_.has_auto_select()) {
+    MP_RETURN_IF_ERROR(AutoSelectDelegate(cc, input_tensors));
+  }
+
+  if (model_loader_) {
+    std::unique_ptr<InferenceRunner> next_inference_runner;
+    {
+      absl::MutexLock lock(&mutex_);
+      MP_RETURN_IF_ERROR(model_loading_status_);
+      next_inference_runner = std::move(next_inference_runner_);
+    }
+    // Switches models between two inferences.
+    if (next_inference_runner) {
+      inference_runner_ = std::move(next_inference_runner);
+    }
+    RET_CHECK(inference_runner_) << "No model has been received yet.";
+  }
 
   ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
                    inference_runner_->Run(cc, input_tensors));
@@ -78,42 +265,173 @@ absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
 }
 
 absl::Status InferenceCalculatorCpuImpl::Close(CalculatorContext* cc) {
+  // Waits for the model being loaded, if any.
+  model_loader_ = nullptr;
   inference_runner_ = nullptr;
+  absl::MutexLock lock(&mutex_);
+  next_inference_runner_ = nullptr;
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::UpdateModel(
+    Packet<TfLiteModelPtr> model_packet) {
+  if (!inference_runner_) {
+    ASSIGN_OR_RETURN(inference_runner_,
+                     CreateInterpreterPool(std::move(model_packet)));
+    return absl::OkStatus();
+  }
+  model_loader_->Schedule([this, model_packet = std::move(model_packet)] {
+    auto inference_runner = CreateInterpreterPool(model_packet);
+    absl::MutexLock lock(&mutex_);
+    if (inference_runner.ok()) {
+      next_inference_runner_ = std::move(inference_runner).value();
+    } else {
+      model_loading_status_ = inference_runner.status();
+    }
+  });
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::OpenAutoSelect(
+    CalculatorContext* cc) {
+  RET_CHECK(!kInModel(cc).IsConnected() && !options_.has_batching())
+      << "auto_select doesn't support the MODEL input stream or batching.";
+  ASSIGN_OR_RETURN(auto_select_model_, GetModelAsPacket(cc));
+  const Delegate::AutoSelect& auto_select = delegate_options_.auto_select();
+  if (!auto_select.cache_dir().empty()) {
+    const tflite::Allocation* allocation = (*auto_select_model_)->allocation();
+    RET_CHECK(allocation) << "The model has no allocation to fingerprint.";
+    const uint64_t model_fingerprint = Fingerprint(absl::string_view(
+        static_cast<const char*>(allocation->base()), allocation->bytes()));
+    auto_select_cache_path_ = file::JoinPath(
+        auto_select.cache_dir(),
+        absl::StrCat("inference_delegate_", model_fingerprint, "_",
+                     Fingerprint(DeviceFingerprint()), ".txt"));
+    std::string cached_name;
+    if (file::GetContents(auto_select_cache_path_, &cached_name).ok()) {
+      for (const auto& [name, delegate] : AutoSelectCandidates()) {
+        if (name != cached_name) continue;
+        delegate_options_ = delegate;
+        ASSIGN_OR_RETURN(inference_runner_,
+                         CreateInterpreterPool(auto_select_model_));
+        return absl::OkStatus();
+      }
+    }
+  }
+  // Benchmarked with the first input tensors.
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::AutoSelectDelegate(
+    CalculatorContext* cc, const std::vector<Tensor>& input_tensors) {
+  const int num_iterations =
+      std::max(delegate_options_.auto_select().num_iterations(), 1);
+  std::string best_name;
+  Delegate best_delegate;
+  absl::Duration best_duration = absl::InfiniteDuration();
+  for (const auto& [name, delegate] : AutoSelectCandidates()) {
+    delegate_options_ = delegate;
+    absl::StatusOr<std::unique_ptr<InferenceRunner>> runner = [&]()
+        -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+      ASSIGN_OR_RETURN(TfLiteDelegatePtr tflite_delegate,
+                       MaybeCreateDelegate());
+      return CreateInferenceInterpreterDelegateRunner(
+          auto_select_model_, op_resolver_packet_, std::move(tflite_delegate),
+          options_.cpu_num_thread(),
+          /*enable_zero_copy_tensor_binding=*/false);
+    }();
+    // The warm-up inference also rejects delegates failing at the first run.
+    absl::Status status = runner.status();
+    if (status.ok()) status = (*runner)->Run(cc, input_tensors).status();
+    if (!status.ok()) {
+      LOG(WARNING) << "Skipping the " << name << " delegate: " << status;
+      continue;
+    }
+    const absl::Time start = absl::Now();
+    for (int i = 0; i < num_iterations; ++i) {
+      MP_RETURN_IF_ERROR((*runner)->Run(cc, input_tensors).status());
+    }
+    const absl::Duration duration = absl::Now() - start;
+    VLOG(1) << "The " << name << " delegate took "
+            << duration / num_iterations << " per inference.";
+    if (duration < best_duration) {
+      best_name = name;
+      best_delegate = delegate;
+      best_duration = duration;
+    }
+  }
+  RET_CHECK(!best_name.empty()) << "No delegate can run the model.";
+  VLOG(1) << "Selected the " << best_name << " delegate.";
+  if (!auto_select_cache_path_.empty()) {
+    const absl::Status status =
+        file::SetContents(auto_select_cache_path_, best_name);
+    LOG_IF(WARNING, !status.ok())
+        << "Failed to store the selected delegate: " << status;
+  }
+  delegate_options_ = best_delegate;
+  ASSIGN_OR_RETURN(inference_runner_,
+                   CreateInterpreterPool(auto_select_model_));
   return absl::OkStatus();
 }
 
 absl::StatusOr<std::unique_ptr<InferenceRunner>>
 InferenceCalculatorCpuImpl::CreateInferenceRunner(CalculatorContext* cc) {
   ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
-  ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
-  const int interpreter_num_threads =
-      cc->Options<mediapipe::InferenceCalculatorOptions>().cpu_num_thread();
-  ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, MaybeCreateDelegate(cc));
-  return CreateInferenceInterpreterDelegateRunner(
-      std::move(model_packet), std::move(op_resolver_packet),
-      std::move(delegate), interpreter_num_threads);
+  const auto& options = options_;
+  const int interpreter_num_threads = options.cpu_num_thread();
+  if (options.has_batching() &&
+      cc->Service(kInferenceBatcherService).IsAvailable()) {
+    const auto& batching = options.batching();
+    const std::string& key =
+        batching.has_key() ? batching.key() : options.model_path();
+    RET_CHECK(!key.empty())
+        << "batching.key is required when the model is a side packet.";
+    return cc->Service(kInferenceBatcherService)
+        .GetObject()
+        .CreateBatchingRunner(
+            key, batching.max_batch_size(),
+            absl::Microseconds(batching.max_latency_us()),
+            [&](int batch_size)
+                -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+              ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate,
+                               MaybeCreateDelegate());
+              return CreateInferenceInterpreterDelegateRunner(
+                  model_packet, op_resolver_packet_, std::move(delegate),
+                  interpreter_num_threads,
+                  /*enable_zero_copy_tensor_binding=*/false, batch_size);
+            });
+  }
+  return CreateInterpreterPool(std::move(model_packet));
 }
 
-absl::StatusOr<TfLiteDelegatePtr>
-InferenceCalculatorCpuImpl::MaybeCreateDelegate(CalculatorContext* cc) {
-  const auto& calculator_opts =
-      cc->Options<mediapipe::InferenceCalculatorOptions>();
-  auto opts_delegate = calculator_opts.delegate();
-  if (!kDelegate(cc).IsEmpty()) {
-    const mediapipe::InferenceCalculatorOptions::Delegate&
-        input_side_packet_delegate = kDelegate(cc).Get();
-    RET_CHECK(
-        input_side_packet_delegate.has_tflite() ||
-        input_side_packet_delegate.has_xnnpack() ||
-        input_side_packet_delegate.has_nnapi() ||
-        input_side_packet_delegate.delegate_case() ==
-            mediapipe::InferenceCalculatorOptions::Delegate::DELEGATE_NOT_SET)
-        << "inference_calculator_cpu only supports delegate input side packet "
-        << "for TFLite, XNNPack and Nnapi";
-    opts_delegate.MergeFrom(input_side_packet_delegate);
+absl::StatusOr<std::unique_ptr<InferenceRunner>>
+InferenceCalculatorCpuImpl::CreateInterpreterPool(
+    Packet<TfLiteModelPtr> model_packet) {
+  std::vector<std::unique_ptr<InferenceRunner>> runners;
+  for (int i = 0; i < std::max(options_.num_interpreters(), 1); ++i) {
+    // Every interpreter needs a delegate instance of its own.
+    ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, MaybeCreateDelegate());
+    ASSIGN_OR_RETURN(auto runner,
+                     CreateInferenceInterpreterDelegateRunner(
+                         model_packet, op_resolver_packet_, std::move(delegate),
+                         options_.cpu_num_thread(),
+                         options_.enable_zero_copy_tensor_binding()));
+    runners.push_back(std::move(runner));
   }
-  const bool opts_has_delegate =
-      calculator_opts.has_delegate() || !kDelegate(cc).IsEmpty();
+  ASSIGN_OR_RETURN(auto inference_runner,
+                   CreateInferenceRunnerPool(std::move(runners)));
+  if (memory_trimmer_ != nullptr) {
+    return CreateMemoryTrimmingRunner(std::move(inference_runner),
+                                      *memory_trimmer_);
+  }
+  return inference_runner;
+}
+
+absl::StatusOr<TfLiteDelegatePtr>
+InferenceCalculatorCpuImpl::MaybeCreateDelegate() {
+  const auto& calculator_opts = options_;
+  const auto& opts_delegate = delegate_options_;
+  const bool opts_has_delegate = has_delegate_;
   if (opts_has_delegate && opts_delegate.has_tflite()) {
     // Default tflite inference requeqsted - no need to modify graph.
     return nullptr;
@@ -141,6 +459,25 @@ InferenceCalculatorCpuImpl::MaybeCreateDelegate(CalculatorContext* cc) {
   }
 #endif  // MEDIAPIPE_ANDROID
 
+#if defined(MEDIAPIPE_IOS)
+  if (opts_has_delegate && opts_delegate.has_coreml()) {
+    // Ops Core ML doesn't support, and whole models on devices the delegate
+    // doesn't target, fall back to the default CPU implementation.
+    const auto& coreml = opts_delegate.coreml();
+    TfLiteCoreMlDelegateOptions options = {};
+    options.enabled_devices = coreml.neural_engine_only()
+                                  ? TfLiteCoreMlDelegateDevicesWithNeuralEngine
+                                  : TfLiteCoreMlDelegateAllDevices;
+    options.max_delegated_partitions = coreml.max_delegated_partitions();
+    options.min_nodes_per_partition = coreml.min_nodes_per_partition();
+    TfLiteDelegate* delegate = TfLiteCoreMlDelegateCreate(&options);
+    if (delegate == nullptr) {
+      return nullptr;
+    }
+    return TfLiteDelegatePtr(delegate, &TfLiteCoreMlDelegateDelete);
+  }
+#endif  // MEDIAPIPE_IOS
+
 #if defined(__EMSCRIPTEN__)
   const bool use_xnnpack = true;
 #else
@@ -239,6 +239,13 @@ absl::Status InferenceCalculatorGlImpl::UpdateContract(CalculatorContract* cc) {
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  RET_CHECK(!kInModel(cc).IsConnected())
+      << "Only InferenceCalculatorCpu supports the MODEL input stream.";
+  // Loads the model without waiting for the upstream nodes to be opened.
+  cc->SetInputStreamHeadersNeeded(false);
+  // Each inference only depends on its input tensors and the model.
+  cc->SetStateless(true);
+  cc->SetAccelerator("gpu");
 
   return mediapipe::GlCalculatorHelper::UpdateContract(cc);
 }
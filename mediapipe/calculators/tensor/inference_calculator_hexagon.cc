@@ -0,0 +1,185 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/call_once.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/inference_calculator.h"
+#include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+#include "mediapipe/framework/memory_trimmer.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/tensor_pool_service.h"
+#include "tensorflow/lite/delegates/hexagon/hexagon_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+namespace api2 {
+
+namespace {
+
+// Loads the Hexagon NN libraries once per process. They are never unloaded,
+// as graphs may create and close Hexagon nodes at any time.
+void InitHexagon(const std::string& library_path) {
+  static absl::once_flag once;
+  absl::call_once(once, [&library_path]() {
+    if (library_path.empty()) {
+      TfLiteHexagonInit();
+    } else {
+      TfLiteHexagonInitWithPath(library_path.c_str());
+    }
+  });
+}
+
+}  // namespace
+
+class InferenceCalculatorHexagonImpl
+    : public NodeImpl<InferenceCalculatorHexagon,
+                      InferenceCalculatorHexagonImpl> {
+ public:
+  static absl::Status UpdateContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunner(
+      CalculatorContext* cc);
+  absl::StatusOr<mediapipe::InferenceCalculatorOptions::Delegate>
+  GetDelegateOptions(CalculatorContext* cc);
+  TfLiteDelegatePtr CreateDelegate(
+      const mediapipe::InferenceCalculatorOptions::Delegate::Hexagon& options);
+
+  std::unique_ptr<InferenceRunner> inference_runner_;
+};
+
+absl::Status InferenceCalculatorHexagonImpl::UpdateContract(
+    CalculatorContract* cc) {
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
+      << "Either model as side packet or model path in options is required.";
+  RET_CHECK(!kInModel(cc).IsConnected())
+      << "Only InferenceCalculatorCpu supports the MODEL input stream.";
+  // Loads the model without waiting for the upstream nodes to be opened.
+  cc->SetInputStreamHeadersNeeded(false);
+  // Each inference only depends on its input tensors and the model.
+  cc->SetStateless(true);
+  UseTensorPool(cc);
+  cc->UseService(kMemoryTrimmerService).Optional();
+  cc->SetAccelerator("hexagon");
+
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorHexagonImpl::Open(CalculatorContext* cc) {
+  ASSIGN_OR_RETURN(inference_runner_, CreateInferenceRunner(cc));
+  if (cc->Options<mediapipe::InferenceCalculatorOptions>().warm_up()) {
+    MP_RETURN_IF_ERROR(inference_runner_->WarmUp());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorHexagonImpl::Process(CalculatorContext* cc) {
+  if (kInTensors(cc).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  const auto& input_tensors = *kInTensors(cc);
+  RET_CHECK(!input_tensors.empty());
+
+  ASSIGN_OR_RETURN(std::vector<Tensor> output_tensors,
+                   inference_runner_->Run(cc, input_tensors));
+  kOutTensors(cc).Send(std::move(output_tensors));
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorHexagonImpl::Close(CalculatorContext* cc) {
+  inference_runner_ = nullptr;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<InferenceRunner>>
+InferenceCalculatorHexagonImpl::CreateInferenceRunner(CalculatorContext* cc) {
+  ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
+  ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  ASSIGN_OR_RETURN(const auto delegate_options, GetDelegateOptions(cc));
+  InitHexagon(delegate_options.hexagon().library_path());
+
+  std::vector<std::unique_ptr<InferenceRunner>> runners;
+  for (int i = 0; i < std::max(options.num_interpreters(), 1); ++i) {
+    // Every interpreter needs a delegate instance of its own. The tensors are
+    // always bound, so that inputs in shared memory aren't copied to the
+    // interpreter before the delegate copies them to the DSP.
+    ASSIGN_OR_RETURN(
+        auto runner,
+        CreateInferenceInterpreterDelegateRunner(
+            model_packet, op_resolver_packet,
+            CreateDelegate(delegate_options.hexagon()),
+            options.cpu_num_thread(),
+            /*enable_zero_copy_tensor_binding=*/true));
+    runners.push_back(std::move(runner));
+  }
+  ASSIGN_OR_RETURN(auto inference_runner,
+                   CreateInferenceRunnerPool(std::move(runners)));
+  if (cc->Service(kMemoryTrimmerService).IsAvailable()) {
+    return CreateMemoryTrimmingRunner(
+        std::move(inference_runner),
+        cc->Service(kMemoryTrimmerService).GetObject());
+  }
+  return inference_runner;
+}
+
+absl::StatusOr<mediapipe::InferenceCalculatorOptions::Delegate>
+InferenceCalculatorHexagonImpl::GetDelegateOptions(CalculatorContext* cc) {
+  auto opts_delegate =
+      cc->Options<mediapipe::InferenceCalculatorOptions>().delegate();
+  if (!kDelegate(cc).IsEmpty()) {
+    const mediapipe::InferenceCalculatorOptions::Delegate&
+        input_side_packet_delegate = kDelegate(cc).Get();
+    RET_CHECK(
+        input_side_packet_delegate.has_hexagon() ||
+        input_side_packet_delegate.delegate_case() ==
+            mediapipe::InferenceCalculatorOptions::Delegate::DELEGATE_NOT_SET)
+        << "inference_calculator_hexagon only supports delegate input side "
+        << "packet for Hexagon";
+    opts_delegate.MergeFrom(input_side_packet_delegate);
+  }
+  return opts_delegate;
+}
+
+TfLiteDelegatePtr InferenceCalculatorHexagonImpl::CreateDelegate(
+    const mediapipe::InferenceCalculatorOptions::Delegate::Hexagon& options) {
+  TfLiteHexagonDelegateOptions hexagon_opts =
+      TfLiteHexagonDelegateOptionsDefault();
+  hexagon_opts.powersave_level = options.powersave_level();
+  hexagon_opts.max_delegated_partitions = options.max_delegated_partitions();
+  hexagon_opts.min_nodes_per_partition = options.min_nodes_per_partition();
+  TfLiteDelegate* delegate = TfLiteHexagonDelegateCreate(&hexagon_opts);
+  if (delegate == nullptr) {
+    // The SoC has no supported DSP, or the libraries couldn't be loaded.
+    LOG(WARNING) << "Hexagon delegate is unavailable, running on CPU.";
+    return nullptr;
+  }
+  return TfLiteDelegatePtr(delegate, &TfLiteHexagonDelegateDelete);
+}
+
+}  // namespace api2
+}  // namespace mediapipe
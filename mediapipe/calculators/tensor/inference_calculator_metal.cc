@@ -24,6 +24,7 @@
 #include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
+#include "mediapipe/framework/tensor_pool_service.h"
 #import "mediapipe/gpu/MPPMetalHelper.h"
 #include "mediapipe/gpu/MPPMetalUtil.h"
 #include "mediapipe/gpu/gpu_buffer.h"
@@ -122,8 +123,16 @@ absl::Status InferenceCalculatorMetalImpl::UpdateContract(
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  RET_CHECK(!kInModel(cc).IsConnected())
+      << "Only InferenceCalculatorCpu supports the MODEL input stream.";
+  // Loads the model without waiting for the upstream nodes to be opened.
+  cc->SetInputStreamHeadersNeeded(false);
+  // Each inference only depends on its input tensors and the model.
+  cc->SetStateless(true);
+  cc->SetAccelerator("gpu");
 
   MP_RETURN_IF_ERROR([MPPMetalHelper updateContract:cc]);
+  UseTensorPool(cc);
   return absl::OkStatus();
 }
 
@@ -170,8 +179,8 @@ absl::Status InferenceCalculatorMetalImpl::Process(CalculatorContext* cc) {
 
   output_tensors->reserve(output_shapes_.size());
   for (int i = 0; i < output_shapes_.size(); ++i) {
-    output_tensors->emplace_back(Tensor::ElementType::kFloat32,
-                                 output_shapes_[i]);
+    output_tensors->push_back(
+        AllocateTensor(cc, Tensor::ElementType::kFloat32, output_shapes_[i]));
     // Reshape tensor.
     tflite::gpu::BHWC shape = BhwcFromTensorShape(output_shapes_[i]);
     auto read_view = gpu_buffers_out_[i]->GetMtlBufferReadView(command_buffer);
@@ -33,6 +33,7 @@
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"  // NOLINT
 #include "mediapipe/framework/tool/validate_type.h"
+#include "mediapipe/util/tflite/tflite_model_loader.h"
 #include "tensorflow/lite/error_reporter.h"
 #include "tensorflow/lite/kernels/register.h"
 #include "tensorflow/lite/model.h"
@@ -100,7 +101,23 @@ constexpr char kGraphWithModelAsInputSidePacket[] = R"(
     }
   )";
 
-std::vector<Tensor> CreateInputs() {
+constexpr char kGraphWithModelAsInputStream[] = R"(
+    input_stream: "model_in"
+    input_stream: "tensor_in"
+    node {
+      calculator: "InferenceCalculator"
+      input_stream: "MODEL:model_in"
+      input_stream: "TENSORS:tensor_in"
+      output_stream: "TENSORS:tensor_out"
+      options {
+        [mediapipe.InferenceCalculatorOptions.ext] {
+          delegate { tflite {} }
+        }
+      }
+    }
+  )";
+
+std::vector<Tensor> CreateInputs(float value = 1) {
   std::vector<Tensor> input_vec;
   // Prepare input tensor.
   input_vec.emplace_back(
@@ -111,7 +128,7 @@ std::vector<Tensor> CreateInputs() {
     auto num_elements = input_vec.back().shape().num_elements();
     auto tensor_buffer = view.buffer<float>();
     for (int i = 0; i < num_elements; i++) {
-      tensor_buffer[i] = 1;
+      tensor_buffer[i] = value;
     }
   }
 
@@ -176,10 +193,134 @@ TEST(InferenceCalculatorTest, SmokeTest) {
       {{"$delegate", "delegate { xnnpack { num_threads: 10 } }"}}));
 }
 
+TEST(InferenceCalculatorTest, ZeroCopyTensorBindingSmokeTest) {
+  DoSmokeTest(absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate",
+        "delegate { tflite {} } enable_zero_copy_tensor_binding: true"}}));
+  DoSmokeTest(absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate",
+        "delegate { xnnpack {} } enable_zero_copy_tensor_binding: true"}}));
+}
+
+// Outputs bound to the interpreter must not be written by later invocations.
+TEST(InferenceCalculatorTest, ZeroCopyTensorBindingKeepsEarlierOutputs) {
+  for (const char* delegate : {"delegate { tflite {} }",
+                               "delegate { xnnpack {} }"}) {
+    CalculatorGraphConfig graph_config =
+        ParseTextProtoOrDie<CalculatorGraphConfig>(absl::StrReplaceAll(
+            kGraphWithModelPathInOption,
+            {{"$delegate", absl::StrCat(delegate,
+                                        " enable_zero_copy_tensor_binding: "
+                                        "true")}}));
+    std::vector<Packet> output_packets;
+    tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+    CalculatorGraph graph(graph_config);
+    MP_ASSERT_OK(graph.StartRun({}));
+    for (int i = 0; i < 2; ++i) {
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          "tensor_in", MakePacket<std::vector<Tensor>>(CreateInputs(i + 1))
+                           .At(Timestamp(i))));
+      MP_ASSERT_OK(graph.WaitUntilIdle());
+    }
+
+    // Both outputs are still held when checked.
+    ASSERT_EQ(output_packets.size(), 2);
+    for (int i = 0; i < 2; ++i) {
+      const std::vector<Tensor>& result_vec =
+          output_packets[i].Get<std::vector<Tensor>>();
+      ASSERT_EQ(result_vec.size(), 1);
+      auto view = result_vec[0].GetCpuReadView();
+      auto result_buffer = view.buffer<float>();
+      for (int j = 0; j < result_vec[0].shape().num_elements(); ++j) {
+        ASSERT_EQ(result_buffer[j], 3 * (i + 1)) << delegate;
+      }
+    }
+    MP_ASSERT_OK(graph.CloseAllInputStreams());
+    MP_ASSERT_OK(graph.WaitUntilDone());
+  }
+}
+
+TEST(InferenceCalculatorTest, InterpreterPoolSmokeTest) {
+  DoSmokeTest(absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate", "delegate { tflite {} } num_interpreters: 2"}}));
+  DoSmokeTest(absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate", "delegate { xnnpack {} } num_interpreters: 2"}}));
+}
+
+TEST(InferenceCalculatorTest, SharedWeightsCacheSmokeTest) {
+  DoSmokeTest(absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate",
+        "delegate { xnnpack { share_weights_cache: true } } "
+        "num_interpreters: 2"}}));
+}
+
+TEST(InferenceCalculatorTest, AutoSelectSmokeTest) {
+  DoSmokeTest(absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate", "delegate { auto_select { num_iterations: 2 } }"}}));
+  // The second run uses the delegate stored by the first one.
+  const std::string with_cache = absl::StrReplaceAll(
+      kGraphWithModelPathInOption,
+      {{"$delegate", absl::StrCat("delegate { auto_select { cache_dir: '",
+                                  ::testing::TempDir(), "' } }")}});
+  DoSmokeTest(with_cache);
+  DoSmokeTest(with_cache);
+}
+
 TEST(InferenceCalculatorTest, ModelAsInputSidePacketSmokeTest) {
   DoSmokeTest(kGraphWithModelAsInputSidePacket);
 }
 
+Packet LoadAddModel() {
+  auto model = tflite::FlatBufferModel::BuildFromFile(
+      "mediapipe/calculators/tensor/testdata/add.bin");
+  CHECK(model);
+  return MakePacket<TfLiteModelPtr>(
+      model.release(), [](tflite::FlatBufferModel* model) { delete model; });
+}
+
+TEST(InferenceCalculatorTest, ModelAsInputStreamSwapsModels) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(kGraphWithModelAsInputStream);
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  // The first model is loaded before the tensors of the same timestamp.
+  MP_ASSERT_OK(graph.AddPacketToInputStream("model_in",
+                                            LoadAddModel().At(Timestamp(0))));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "tensor_in",
+      MakePacket<std::vector<Tensor>>(CreateInputs()).At(Timestamp(0))));
+  // The next one is loaded in the background while inference goes on.
+  MP_ASSERT_OK(graph.AddPacketToInputStream("model_in",
+                                            LoadAddModel().At(Timestamp(1))));
+  for (int i = 1; i < 4; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in",
+        MakePacket<std::vector<Tensor>>(CreateInputs()).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(output_packets.size(), 4);
+  for (const Packet& packet : output_packets) {
+    const std::vector<Tensor>& result_vec = packet.Get<std::vector<Tensor>>();
+    ASSERT_EQ(result_vec.size(), 1);
+    auto view = result_vec[0].GetCpuReadView();
+    auto result_buffer = view.buffer<float>();
+    for (int i = 0; i < result_vec[0].shape().num_elements(); i++) {
+      ASSERT_EQ(result_buffer[i], 3);
+    }
+  }
+}
+
 void BM_InitializeCalculator(benchmark::State& state) {
   mediapipe::InferenceCalculatorOptions::Delegate delegate;
   delegate.mutable_tflite();
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -20,16 +21,81 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/tensor/inference_batcher.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
 #include "mediapipe/calculators/tensor/inference_calculator_utils.h"
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 #include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "mediapipe/framework/memory_trimmer.h"
+#include "mediapipe/framework/tensor_pool_service.h"
 #include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
 #include "tensorflow/lite/interpreter.h"
 
 namespace mediapipe {
 namespace api2 {
 
+namespace {
+
+// An XNNPACK weights cache, which holds the packed weights of a model once
+// for all interpreters that run the model with it.
+class SharedWeightsCache {
+ public:
+  // Returns the cache of the model, which is shared with all other nodes
+  // running the same model until the last of them is closed.
+  static absl::StatusOr<std::shared_ptr<SharedWeightsCache>> Get(
+      const tflite::FlatBufferModel* model) {
+    static NoDestructor<absl::Mutex> mutex;
+    static NoDestructor<absl::flat_hash_map<
+        const tflite::FlatBufferModel*, std::weak_ptr<SharedWeightsCache>>>
+        caches;
+    absl::MutexLock lock(mutex.get());
+    absl::erase_if(*caches,
+                   [](const auto& entry) { return entry.second.expired(); });
+    std::weak_ptr<SharedWeightsCache>& entry = (*caches)[model];
+    std::shared_ptr<SharedWeightsCache> cache = entry.lock();
+    if (cache == nullptr) {
+      TfLiteXNNPackDelegateWeightsCache* weights_cache =
+          TfLiteXNNPackDelegateWeightsCacheCreate();
+      RET_CHECK(weights_cache) << "Failed to create XNNPACK weights cache.";
+      cache = std::shared_ptr<SharedWeightsCache>(
+          new SharedWeightsCache(weights_cache));
+      entry = cache;
+    }
+    return cache;
+  }
+
+  ~SharedWeightsCache() { TfLiteXNNPackDelegateWeightsCacheDelete(cache_); }
+
+  // Creates an inference runner whose delegate packs its weights into the
+  // cache. Interpreters are created one at a time, and the cache is finalized
+  // before they run, so that later interpreters can still add to it.
+  template <typename CreateFn>
+  absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateRunner(
+      CreateFn create) {
+    absl::MutexLock lock(&mutex_);
+    ASSIGN_OR_RETURN(std::unique_ptr<InferenceRunner> runner, create());
+    RET_CHECK(TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(cache_))
+        << "Failed to finalize XNNPACK weights cache.";
+    return runner;
+  }
+
+  TfLiteXNNPackDelegateWeightsCache* get() const { return cache_; }
+
+ private:
+  explicit SharedWeightsCache(TfLiteXNNPackDelegateWeightsCache* cache)
+      : cache_(cache) {}
+
+  absl::Mutex mutex_;
+  TfLiteXNNPackDelegateWeightsCache* const cache_;
+};
+
+}  // namespace
+
 class InferenceCalculatorXnnpackImpl
     : public NodeImpl<InferenceCalculatorXnnpack,
                       InferenceCalculatorXnnpackImpl> {
@@ -43,7 +109,11 @@ class InferenceCalculatorXnnpackImpl
  private:
   absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunner(
       CalculatorContext* cc);
-  absl::StatusOr<TfLiteDelegatePtr> CreateDelegate(CalculatorContext* cc);
+  absl::StatusOr<mediapipe::InferenceCalculatorOptions::Delegate>
+  GetDelegateOptions(CalculatorContext* cc);
+  absl::StatusOr<TfLiteDelegatePtr> CreateDelegate(
+      CalculatorContext* cc,
+      std::shared_ptr<SharedWeightsCache> weights_cache);
 
   std::unique_ptr<InferenceRunner> inference_runner_;
 };
@@ -53,12 +123,26 @@ absl::Status InferenceCalculatorXnnpackImpl::UpdateContract(
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  RET_CHECK(!kInModel(cc).IsConnected())
+      << "Only InferenceCalculatorCpu supports the MODEL input stream.";
+  if (options.has_batching()) {
+    cc->UseService(kInferenceBatcherService).Optional();
+  }
+  // Loads the model without waiting for the upstream nodes to be opened.
+  cc->SetInputStreamHeadersNeeded(false);
+  // Each inference only depends on its input tensors and the model.
+  cc->SetStateless(true);
+  UseTensorPool(cc);
+  cc->UseService(kMemoryTrimmerService).Optional();
 
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorXnnpackImpl::Open(CalculatorContext* cc) {
   ASSIGN_OR_RETURN(inference_runner_, CreateInferenceRunner(cc));
+  if (cc->Options<mediapipe::InferenceCalculatorOptions>().warm_up()) {
+    MP_RETURN_IF_ERROR(inference_runner_->WarmUp());
+  }
   return absl::OkStatus();
 }
 
@@ -84,19 +168,72 @@ absl::StatusOr<std::unique_ptr<InferenceRunner>>
 InferenceCalculatorXnnpackImpl::CreateInferenceRunner(CalculatorContext* cc) {
   ASSIGN_OR_RETURN(auto model_packet, GetModelAsPacket(cc));
   ASSIGN_OR_RETURN(auto op_resolver_packet, GetOpResolverAsPacket(cc));
-  const int interpreter_num_threads =
-      cc->Options<mediapipe::InferenceCalculatorOptions>().cpu_num_thread();
-  ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate, CreateDelegate(cc));
-  return CreateInferenceInterpreterDelegateRunner(
-      std::move(model_packet), std::move(op_resolver_packet),
-      std::move(delegate), interpreter_num_threads);
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  const int interpreter_num_threads = options.cpu_num_thread();
+  ASSIGN_OR_RETURN(const auto delegate_options, GetDelegateOptions(cc));
+  std::shared_ptr<SharedWeightsCache> weights_cache;
+  if (delegate_options.xnnpack().share_weights_cache()) {
+    ASSIGN_OR_RETURN(weights_cache,
+                     SharedWeightsCache::Get(model_packet.Get().get()));
+  }
+  // Creates a runner, with its weights in the shared cache if there is one.
+  auto create_runner = [&](bool enable_zero_copy_tensor_binding,
+                           int batch_size)
+      -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+    auto create = [&]() -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+      ASSIGN_OR_RETURN(TfLiteDelegatePtr delegate,
+                       CreateDelegate(cc, weights_cache));
+      return CreateInferenceInterpreterDelegateRunner(
+          model_packet, op_resolver_packet, std::move(delegate),
+          interpreter_num_threads, enable_zero_copy_tensor_binding,
+          batch_size);
+    };
+    if (weights_cache) {
+      return weights_cache->CreateRunner(create);
+    }
+    return create();
+  };
+  if (options.has_batching() &&
+      cc->Service(kInferenceBatcherService).IsAvailable()) {
+    const auto& batching = options.batching();
+    const std::string& key =
+        batching.has_key() ? batching.key() : options.model_path();
+    RET_CHECK(!key.empty())
+        << "batching.key is required when the model is a side packet.";
+    return cc->Service(kInferenceBatcherService)
+        .GetObject()
+        .CreateBatchingRunner(
+            key, batching.max_batch_size(),
+            absl::Microseconds(batching.max_latency_us()),
+            [&](int batch_size)
+                -> absl::StatusOr<std::unique_ptr<InferenceRunner>> {
+              return create_runner(/*enable_zero_copy_tensor_binding=*/false,
+                                   batch_size);
+            });
+  }
+  std::vector<std::unique_ptr<InferenceRunner>> runners;
+  for (int i = 0; i < std::max(options.num_interpreters(), 1); ++i) {
+    // Every interpreter needs a delegate instance of its own.
+    ASSIGN_OR_RETURN(
+        auto runner,
+        create_runner(options.enable_zero_copy_tensor_binding(),
+                      /*batch_size=*/1));
+    runners.push_back(std::move(runner));
+  }
+  ASSIGN_OR_RETURN(auto inference_runner,
+                   CreateInferenceRunnerPool(std::move(runners)));
+  if (cc->Service(kMemoryTrimmerService).IsAvailable()) {
+    return CreateMemoryTrimmingRunner(
+        std::move(inference_runner),
+        cc->Service(kMemoryTrimmerService).GetObject());
+  }
+  return inference_runner;
 }
 
-absl::StatusOr<TfLiteDelegatePtr>
-InferenceCalculatorXnnpackImpl::CreateDelegate(CalculatorContext* cc) {
-  const auto& calculator_opts =
-      cc->Options<mediapipe::InferenceCalculatorOptions>();
-  auto opts_delegate = calculator_opts.delegate();
+absl::StatusOr<mediapipe::InferenceCalculatorOptions::Delegate>
+InferenceCalculatorXnnpackImpl::GetDelegateOptions(CalculatorContext* cc) {
+  auto opts_delegate =
+      cc->Options<mediapipe::InferenceCalculatorOptions>().delegate();
   if (!kDelegate(cc).IsEmpty()) {
     const mediapipe::InferenceCalculatorOptions::Delegate&
         input_side_packet_delegate = kDelegate(cc).Get();
@@ -108,16 +245,30 @@ InferenceCalculatorXnnpackImpl::CreateDelegate(CalculatorContext* cc) {
         << "for TFLite, XNNPack";
     opts_delegate.MergeFrom(input_side_packet_delegate);
   }
+  return opts_delegate;
+}
+
+absl::StatusOr<TfLiteDelegatePtr>
+InferenceCalculatorXnnpackImpl::CreateDelegate(
+    CalculatorContext* cc, std::shared_ptr<SharedWeightsCache> weights_cache) {
+  ASSIGN_OR_RETURN(const auto opts_delegate, GetDelegateOptions(cc));
   const bool opts_has_delegate =
-      calculator_opts.has_delegate() || !kDelegate(cc).IsEmpty();
+      cc->Options<mediapipe::InferenceCalculatorOptions>().has_delegate() ||
+      !kDelegate(cc).IsEmpty();
 
   auto xnnpack_opts = TfLiteXNNPackDelegateOptionsDefault();
   xnnpack_opts.num_threads =
       GetXnnpackNumThreads(opts_has_delegate, opts_delegate);
   // TODO Remove once XNNPACK is enabled by default.
   xnnpack_opts.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_QU8;
+  if (weights_cache) {
+    xnnpack_opts.weights_cache = weights_cache->get();
+  }
+  // The delegate keeps the weights cache alive.
   return TfLiteDelegatePtr(TfLiteXNNPackDelegateCreate(&xnnpack_opts),
-                           &TfLiteXNNPackDelegateDelete);
+                           [weights_cache](TfLiteDelegate* delegate) {
+                             TfLiteXNNPackDelegateDelete(delegate);
+                           });
 }
 
 }  // namespace api2
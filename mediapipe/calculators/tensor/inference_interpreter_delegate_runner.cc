@@ -14,14 +14,24 @@
 
 #include "mediapipe/calculators/tensor/inference_interpreter_delegate_runner.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
+#include "mediapipe/framework/port/aligned_malloc_and_free.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/tensor_pool_service.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/interpreter_builder.h"
@@ -57,16 +67,84 @@ void CopyTensorBufferToInterpreter<char>(const Tensor& input_tensor,
       interpreter->tensor(interpreter->inputs()[input_tensor_index]));
 }
 
-template <typename T>
-void CopyTensorBufferFromInterpreter(tflite::Interpreter* interpreter,
-                                     int output_tensor_index,
-                                     Tensor* output_tensor) {
+// Returns a Tensor matching the type and shape of the interpreter tensor,
+// from the graph's tensor pool if the calculator uses one.
+absl::StatusOr<Tensor> CreateOutputTensor(CalculatorContext* cc,
+                                          const TfLiteTensor& tensor) {
+  Tensor::Shape shape{std::vector<int>{
+      tensor.dims->data, tensor.dims->data + tensor.dims->size}};
+  auto allocate = [cc, &shape](Tensor::ElementType element_type,
+                               const Tensor::QuantizationParameters& params =
+                                   Tensor::QuantizationParameters()) {
+    return cc ? AllocateTensor(cc, element_type, shape, params)
+              : Tensor(element_type, shape, params);
+  };
+  switch (tensor.type) {
+    case TfLiteType::kTfLiteFloat16:
+    case TfLiteType::kTfLiteFloat32:
+      return allocate(Tensor::ElementType::kFloat32);
+    case TfLiteType::kTfLiteUInt8:
+      return allocate(Tensor::ElementType::kUInt8,
+                      Tensor::QuantizationParameters{
+                          tensor.params.scale, tensor.params.zero_point});
+    case TfLiteType::kTfLiteInt8:
+      return allocate(Tensor::ElementType::kInt8,
+                      Tensor::QuantizationParameters{
+                          tensor.params.scale, tensor.params.zero_point});
+    case TfLiteType::kTfLiteInt32:
+      return allocate(Tensor::ElementType::kInt32);
+    case TfLiteType::kTfLiteBool:
+      return allocate(Tensor::ElementType::kBool,
+                      Tensor::QuantizationParameters{1.0f, 0});
+    case TfLiteType::kTfLiteString:
+      // No current use-case for copying TfLiteTensors with string type to
+      // MediaPipe Tensors.
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unsupported output tensor type:", TfLiteTypeGetName(tensor.type)));
+  }
+}
+
+absl::Status CopyTensorBufferFromInterpreter(const TfLiteTensor& tensor,
+                                             Tensor* output_tensor) {
+  RET_CHECK_EQ(tensor.bytes, output_tensor->bytes())
+      << "Unsupported output tensor type:" << TfLiteTypeGetName(tensor.type);
   auto output_tensor_view = output_tensor->GetCpuWriteView();
-  auto output_tensor_buffer = output_tensor_view.buffer<T>();
-  T* local_tensor_buffer =
-      interpreter->typed_output_tensor<T>(output_tensor_index);
-  std::memcpy(output_tensor_buffer, local_tensor_buffer,
+  std::memcpy(output_tensor_view.buffer<void>(), tensor.data.raw,
               output_tensor->bytes());
+  return absl::OkStatus();
+}
+
+// Returns true if the interpreter tensor can use the CPU buffer of a MediaPipe
+// Tensor as a custom allocation, which requires it to have a fixed size.
+bool CanBindTensorBuffer(const TfLiteTensor& tensor) {
+  if (tensor.allocation_type != kTfLiteArenaRw &&
+      tensor.allocation_type != kTfLiteArenaRwPersistent) {
+    return false;
+  }
+  switch (tensor.type) {
+    case TfLiteType::kTfLiteFloat32:
+    case TfLiteType::kTfLiteUInt8:
+    case TfLiteType::kTfLiteInt8:
+    case TfLiteType::kTfLiteInt32:
+    case TfLiteType::kTfLiteBool:
+      break;
+    default:
+      return false;
+  }
+  if (tensor.dims_signature != nullptr) {
+    for (int i = 0; i < tensor.dims_signature->size; ++i) {
+      if (tensor.dims_signature->data[i] < 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool IsCpuBufferAligned(const void* buffer) {
+  return reinterpret_cast<uintptr_t>(buffer) % Tensor::kCpuBufferAlignment ==
+         0;
 }
 
 }  // namespace
@@ -76,127 +154,380 @@ class InferenceInterpreterDelegateRunner : public InferenceRunner {
   InferenceInterpreterDelegateRunner(
       api2::Packet<TfLiteModelPtr> model,
       std::unique_ptr<tflite::Interpreter> interpreter,
-      TfLiteDelegatePtr delegate)
-      : model_(std::move(model)),
-        interpreter_(std::move(interpreter)),
-        delegate_(std::move(delegate)) {}
+      TfLiteDelegatePtr delegate, bool enable_zero_copy_tensor_binding);
 
   absl::StatusOr<std::vector<Tensor>> Run(
       CalculatorContext* cc, const std::vector<Tensor>& input_tensors) override;
 
+  absl::Status WarmUp() override;
+
+  void ReleaseMemory() override;
+
  private:
+  struct AlignedFree {
+    void operator()(void* buffer) const { aligned_free(buffer); }
+  };
+
+  absl::Status CopyInputTensor(const Tensor& input_tensor, int input_index);
+
+  // Resizes the interpreter inputs whose leading (batch) dimension differs
+  // from that of the input Tensors, e.g. one crop per detected object.
+  absl::Status ResizeInputsIfNeeded(const std::vector<Tensor>& input_tensors);
+
+  // Copies inputs into and outputs out of the interpreter's own buffers.
+  absl::StatusOr<std::vector<Tensor>> RunWithCopy(
+      CalculatorContext* cc, const std::vector<Tensor>& input_tensors);
+
+  // Binds input and output Tensors to the interpreter where possible.
+  absl::StatusOr<std::vector<Tensor>> RunWithTensorBinding(
+      CalculatorContext* cc, const std::vector<Tensor>& input_tensors);
+
+  // Binds the Tensors and runs inference. Adds the bound interpreter tensors
+  // to `bound_indexes`, also on failure, and sets the bound outputs.
+  absl::Status BindTensorsAndInvoke(
+      CalculatorContext* cc, const std::vector<Tensor>& input_tensors,
+      std::vector<int>* bound_indexes,
+      std::vector<absl::optional<Tensor>>* bound_outputs);
+
+  // Once bound, an interpreter tensor no longer has arena memory, so when it
+  // can't be bound on a later run it gets a buffer owned by the runner.
+  absl::Status BindStagingBuffer(int tensor_index);
+
+  // Points the tensors bound to MediaPipe Tensors back at staging buffers, so
+  // the interpreter keeps no reference to buffers sent downstream.
+  absl::Status UnbindTensorBuffers(const std::vector<int>& tensor_indexes);
+
+  absl::Status Invoke(CalculatorContext* cc);
+
+  // Allocates the interpreter's arena again after ReleaseMemory().
+  absl::Status ReallocateMemoryIfReleased()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Keeps ReleaseMemory() from running during inference.
+  absl::Mutex mutex_;
+  bool memory_released_ ABSL_GUARDED_BY(mutex_) = false;
+
   api2::Packet<TfLiteModelPtr> model_;
+  // Declared before the interpreter, which must not outlive them.
+  absl::flat_hash_map<int, std::unique_ptr<void, AlignedFree>>
+      staging_buffers_;
   std::unique_ptr<tflite::Interpreter> interpreter_;
   TfLiteDelegatePtr delegate_;
+  const bool enable_zero_copy_tensor_binding_;
+  // Whether each interpreter input / output can be bound to a Tensor.
+  std::vector<bool> bindable_inputs_;
+  std::vector<bool> bindable_outputs_;
 };
 
+InferenceInterpreterDelegateRunner::InferenceInterpreterDelegateRunner(
+    api2::Packet<TfLiteModelPtr> model,
+    std::unique_ptr<tflite::Interpreter> interpreter,
+    TfLiteDelegatePtr delegate, bool enable_zero_copy_tensor_binding)
+    : model_(std::move(model)),
+      interpreter_(std::move(interpreter)),
+      delegate_(std::move(delegate)),
+      enable_zero_copy_tensor_binding_(enable_zero_copy_tensor_binding) {
+  if (!enable_zero_copy_tensor_binding_) {
+    return;
+  }
+  const std::vector<int>& inputs = interpreter_->inputs();
+  const std::vector<int>& outputs = interpreter_->outputs();
+  // A tensor that appears more than once among the inputs and outputs would
+  // need to be bound to more than one Tensor.
+  absl::flat_hash_map<int, int> num_uses;
+  for (int index : inputs) ++num_uses[index];
+  for (int index : outputs) ++num_uses[index];
+  for (int index : inputs) {
+    bindable_inputs_.push_back(
+        num_uses[index] == 1 &&
+        CanBindTensorBuffer(*interpreter_->tensor(index)));
+  }
+  for (int index : outputs) {
+    bindable_outputs_.push_back(
+        num_uses[index] == 1 &&
+        CanBindTensorBuffer(*interpreter_->tensor(index)));
+  }
+}
+
 absl::StatusOr<std::vector<Tensor>> InferenceInterpreterDelegateRunner::Run(
     CalculatorContext* cc, const std::vector<Tensor>& input_tensors) {
-  // Read CPU input into tensors.
   RET_CHECK_EQ(interpreter_->inputs().size(), input_tensors.size());
+  absl::MutexLock lock(&mutex_);
+  MP_RETURN_IF_ERROR(ReallocateMemoryIfReleased());
+  MP_RETURN_IF_ERROR(ResizeInputsIfNeeded(input_tensors));
+  if (enable_zero_copy_tensor_binding_) {
+    return RunWithTensorBinding(cc, input_tensors);
+  }
+  return RunWithCopy(cc, input_tensors);
+}
+
+absl::Status InferenceInterpreterDelegateRunner::ResizeInputsIfNeeded(
+    const std::vector<Tensor>& input_tensors) {
+  bool resized = false;
+  const std::vector<int>& input_indexes = interpreter_->inputs();
   for (int i = 0; i < input_tensors.size(); ++i) {
-    const TfLiteType input_tensor_type =
-        interpreter_->tensor(interpreter_->inputs()[i])->type;
-    switch (input_tensor_type) {
-      case TfLiteType::kTfLiteFloat16:
-      case TfLiteType::kTfLiteFloat32: {
-        CopyTensorBufferToInterpreter<float>(input_tensors[i],
-                                             interpreter_.get(), i);
-        break;
-      }
-      case TfLiteType::kTfLiteUInt8: {
-        CopyTensorBufferToInterpreter<uint8_t>(input_tensors[i],
-                                               interpreter_.get(), i);
-        break;
-      }
-      case TfLiteType::kTfLiteInt8: {
-        CopyTensorBufferToInterpreter<int8_t>(input_tensors[i],
-                                              interpreter_.get(), i);
-        break;
-      }
-      case TfLiteType::kTfLiteInt32: {
-        CopyTensorBufferToInterpreter<int32_t>(input_tensors[i],
-                                               interpreter_.get(), i);
-        break;
-      }
-      case TfLiteType::kTfLiteString: {
-        CopyTensorBufferToInterpreter<char>(input_tensors[i],
-                                            interpreter_.get(), i);
-        break;
-      }
-      case TfLiteType::kTfLiteBool:
-        // No current use-case for copying MediaPipe Tensors with bool type to
-        // TfLiteTensors.
-      default:
-        return absl::InvalidArgumentError(
-            absl::StrCat("Unsupported input tensor type:", input_tensor_type));
+    const TfLiteIntArray* dims = interpreter_->tensor(input_indexes[i])->dims;
+    const std::vector<int>& input_dims = input_tensors[i].shape().dims;
+    if (dims->size == 0 || input_dims.size() != dims->size ||
+        input_dims[0] == dims->data[0]) {
+      continue;
     }
+    RET_CHECK(std::equal(input_dims.begin() + 1, input_dims.end(),
+                         dims->data + 1))
+        << "Only the batch dimension of an input tensor can be resized.";
+    RET_CHECK(!enable_zero_copy_tensor_binding_)
+        << "Resizing the batch dimension isn't supported with zero-copy "
+           "tensor binding.";
+    std::vector<int> resized_dims(dims->data, dims->data + dims->size);
+    resized_dims[0] = input_dims[0];
+    RET_CHECK_EQ(interpreter_->ResizeInputTensor(input_indexes[i],
+                                                 resized_dims),
+                 kTfLiteOk);
+    resized = true;
   }
+  if (resized) {
+    RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  }
+  return absl::OkStatus();
+}
 
-  // Run inference.
-  {
-    MEDIAPIPE_PROFILING(CPU_TASK_INVOKE, cc);
-    RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+absl::Status InferenceInterpreterDelegateRunner::CopyInputTensor(
+    const Tensor& input_tensor, int input_index) {
+  const TfLiteType input_tensor_type =
+      interpreter_->tensor(interpreter_->inputs()[input_index])->type;
+  switch (input_tensor_type) {
+    case TfLiteType::kTfLiteFloat16:
+    case TfLiteType::kTfLiteFloat32: {
+      CopyTensorBufferToInterpreter<float>(input_tensor, interpreter_.get(),
+                                           input_index);
+      break;
+    }
+    case TfLiteType::kTfLiteUInt8: {
+      CopyTensorBufferToInterpreter<uint8_t>(input_tensor, interpreter_.get(),
+                                             input_index);
+      break;
+    }
+    case TfLiteType::kTfLiteInt8: {
+      CopyTensorBufferToInterpreter<int8_t>(input_tensor, interpreter_.get(),
+                                            input_index);
+      break;
+    }
+    case TfLiteType::kTfLiteInt32: {
+      CopyTensorBufferToInterpreter<int32_t>(input_tensor, interpreter_.get(),
+                                             input_index);
+      break;
+    }
+    case TfLiteType::kTfLiteString: {
+      CopyTensorBufferToInterpreter<char>(input_tensor, interpreter_.get(),
+                                          input_index);
+      break;
+    }
+    case TfLiteType::kTfLiteBool:
+      // No current use-case for copying MediaPipe Tensors with bool type to
+      // TfLiteTensors.
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported input tensor type:", input_tensor_type));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InferenceInterpreterDelegateRunner::Invoke(
+    CalculatorContext* cc) {
+  MEDIAPIPE_PROFILING(CPU_TASK_INVOKE, cc);
+  RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<Tensor>>
+InferenceInterpreterDelegateRunner::RunWithCopy(
+    CalculatorContext* cc, const std::vector<Tensor>& input_tensors) {
+  // Read CPU input into tensors.
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    MP_RETURN_IF_ERROR(CopyInputTensor(input_tensors[i], i));
   }
+
+  // Run inference.
+  MP_RETURN_IF_ERROR(Invoke(cc));
+
   // Output result tensors (CPU).
   const auto& tensor_indexes = interpreter_->outputs();
   std::vector<Tensor> output_tensors;
   output_tensors.reserve(tensor_indexes.size());
   for (int i = 0; i < tensor_indexes.size(); ++i) {
-    TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
-    Tensor::Shape shape{std::vector<int>{
-        tensor->dims->data, tensor->dims->data + tensor->dims->size}};
-    switch (tensor->type) {
-      case TfLiteType::kTfLiteFloat16:
-      case TfLiteType::kTfLiteFloat32:
-        output_tensors.emplace_back(Tensor::ElementType::kFloat32, shape);
-        CopyTensorBufferFromInterpreter<float>(interpreter_.get(), i,
-                                               &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteUInt8:
-        output_tensors.emplace_back(
-            Tensor::ElementType::kUInt8, shape,
-            Tensor::QuantizationParameters{tensor->params.scale,
-                                           tensor->params.zero_point});
-        CopyTensorBufferFromInterpreter<uint8>(interpreter_.get(), i,
-                                               &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteInt8:
-        output_tensors.emplace_back(
-            Tensor::ElementType::kInt8, shape,
-            Tensor::QuantizationParameters{tensor->params.scale,
-                                           tensor->params.zero_point});
-        CopyTensorBufferFromInterpreter<int8>(interpreter_.get(), i,
-                                              &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteInt32:
-        output_tensors.emplace_back(Tensor::ElementType::kInt32, shape);
-        CopyTensorBufferFromInterpreter<int32_t>(interpreter_.get(), i,
-                                                 &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteBool:
-        output_tensors.emplace_back(Tensor::ElementType::kBool, shape,
-                                    Tensor::QuantizationParameters{1.0f, 0});
-        CopyTensorBufferFromInterpreter<bool>(interpreter_.get(), i,
-                                              &output_tensors.back());
-        break;
-      case TfLiteType::kTfLiteString:
-        // No current use-case for copying TfLiteTensors with string type to
-        // MediaPipe Tensors.
-      default:
-        return absl::InvalidArgumentError(
-            absl::StrCat("Unsupported output tensor type:",
-                         TfLiteTypeGetName(tensor->type)));
+    const TfLiteTensor& tensor = *interpreter_->tensor(tensor_indexes[i]);
+    ASSIGN_OR_RETURN(Tensor output_tensor, CreateOutputTensor(cc, tensor));
+    output_tensors.push_back(std::move(output_tensor));
+    MP_RETURN_IF_ERROR(
+        CopyTensorBufferFromInterpreter(tensor, &output_tensors.back()));
+  }
+  return output_tensors;
+}
+
+absl::StatusOr<std::vector<Tensor>>
+InferenceInterpreterDelegateRunner::RunWithTensorBinding(
+    CalculatorContext* cc, const std::vector<Tensor>& input_tensors) {
+  const std::vector<int>& output_indexes = interpreter_->outputs();
+  std::vector<int> bound_indexes;
+  std::vector<absl::optional<Tensor>> bound_outputs(output_indexes.size());
+  // Each run binds newly allocated output Tensors, and unbinds them before
+  // they are returned, even if inference fails.
+  const absl::Status status =
+      BindTensorsAndInvoke(cc, input_tensors, &bound_indexes, &bound_outputs);
+  MP_RETURN_IF_ERROR(UnbindTensorBuffers(bound_indexes));
+  MP_RETURN_IF_ERROR(status);
+
+  std::vector<Tensor> output_tensors;
+  output_tensors.reserve(output_indexes.size());
+  for (int i = 0; i < output_indexes.size(); ++i) {
+    if (bound_outputs[i].has_value()) {
+      output_tensors.push_back(std::move(*bound_outputs[i]));
+      continue;
     }
+    const TfLiteTensor& tensor = *interpreter_->tensor(output_indexes[i]);
+    ASSIGN_OR_RETURN(Tensor output_tensor, CreateOutputTensor(cc, tensor));
+    output_tensors.push_back(std::move(output_tensor));
+    MP_RETURN_IF_ERROR(
+        CopyTensorBufferFromInterpreter(tensor, &output_tensors.back()));
   }
   return output_tensors;
 }
 
+absl::Status InferenceInterpreterDelegateRunner::BindTensorsAndInvoke(
+    CalculatorContext* cc, const std::vector<Tensor>& input_tensors,
+    std::vector<int>* bound_indexes,
+    std::vector<absl::optional<Tensor>>* bound_outputs) {
+  // The views keep the bound buffers locked until Invoke() is done with them.
+  std::vector<Tensor::CpuReadView> input_views;
+  std::vector<Tensor::CpuWriteView> output_views;
+
+  const std::vector<int>& input_indexes = interpreter_->inputs();
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    const TfLiteTensor& tensor = *interpreter_->tensor(input_indexes[i]);
+    if (bindable_inputs_[i] && input_tensors[i].bytes() == tensor.bytes) {
+      auto view = input_tensors[i].GetCpuReadView();
+      const void* buffer = view.buffer<void>();
+      if (IsCpuBufferAligned(buffer)) {
+        // The interpreter only reads from input tensors.
+        bound_indexes->push_back(input_indexes[i]);
+        RET_CHECK_EQ(interpreter_->SetCustomAllocationForTensor(
+                         input_indexes[i],
+                         {const_cast<void*>(buffer), tensor.bytes}),
+                     kTfLiteOk);
+        input_views.push_back(std::move(view));
+        continue;
+      }
+    }
+    MP_RETURN_IF_ERROR(BindStagingBuffer(input_indexes[i]));
+    MP_RETURN_IF_ERROR(CopyInputTensor(input_tensors[i], i));
+  }
+
+  // Outputs that can be bound have fixed shapes, so their Tensors can be
+  // created before running inference.
+  const std::vector<int>& output_indexes = interpreter_->outputs();
+  for (int i = 0; i < output_indexes.size(); ++i) {
+    if (!bindable_outputs_[i]) {
+      continue;
+    }
+    const TfLiteTensor& tensor = *interpreter_->tensor(output_indexes[i]);
+    ASSIGN_OR_RETURN(Tensor output_tensor, CreateOutputTensor(cc, tensor));
+    if (output_tensor.bytes() == tensor.bytes) {
+      auto view = output_tensor.GetCpuWriteView();
+      void* buffer = view.buffer<void>();
+      if (IsCpuBufferAligned(buffer)) {
+        bound_indexes->push_back(output_indexes[i]);
+        RET_CHECK_EQ(interpreter_->SetCustomAllocationForTensor(
+                         output_indexes[i], {buffer, tensor.bytes}),
+                     kTfLiteOk);
+        output_views.push_back(std::move(view));
+        (*bound_outputs)[i] = std::move(output_tensor);
+        continue;
+      }
+    }
+    MP_RETURN_IF_ERROR(BindStagingBuffer(output_indexes[i]));
+  }
+  // TfLite requires AllocateTensors() after setting custom allocations. It is
+  // cheap while the tensor shapes are unchanged.
+  RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+
+  // Run inference.
+  return Invoke(cc);
+}
+
+absl::Status InferenceInterpreterDelegateRunner::BindStagingBuffer(
+    int tensor_index) {
+  const TfLiteTensor& tensor = *interpreter_->tensor(tensor_index);
+  if (tensor.allocation_type != kTfLiteCustom) {
+    return absl::OkStatus();
+  }
+  auto& buffer = staging_buffers_[tensor_index];
+  if (buffer == nullptr) {
+    buffer.reset(aligned_malloc(tensor.bytes + Tensor::kCpuBufferPadding,
+                                Tensor::kCpuBufferAlignment));
+    RET_CHECK(buffer != nullptr);
+  }
+  RET_CHECK_EQ(interpreter_->SetCustomAllocationForTensor(
+                   tensor_index, {buffer.get(), tensor.bytes}),
+               kTfLiteOk);
+  return absl::OkStatus();
+}
+
+absl::Status InferenceInterpreterDelegateRunner::UnbindTensorBuffers(
+    const std::vector<int>& tensor_indexes) {
+  if (tensor_indexes.empty()) {
+    return absl::OkStatus();
+  }
+  for (int index : tensor_indexes) {
+    MP_RETURN_IF_ERROR(BindStagingBuffer(index));
+  }
+  RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  return absl::OkStatus();
+}
+
+void InferenceInterpreterDelegateRunner::ReleaseMemory() {
+  absl::MutexLock lock(&mutex_);
+  if (memory_released_) return;
+  // Tensors bound to staging buffers between runs have custom allocations,
+  // which are kept.
+  if (interpreter_->ReleaseNonPersistentMemory() == kTfLiteOk) {
+    memory_released_ = true;
+  }
+}
+
+absl::Status InferenceInterpreterDelegateRunner::ReallocateMemoryIfReleased() {
+  if (!memory_released_) return absl::OkStatus();
+  // Also prepares the nodes again, as after resizing an input.
+  RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  memory_released_ = false;
+  return absl::OkStatus();
+}
+
+absl::Status InferenceInterpreterDelegateRunner::WarmUp() {
+  absl::MutexLock lock(&mutex_);
+  MP_RETURN_IF_ERROR(ReallocateMemoryIfReleased());
+  for (int index : interpreter_->inputs()) {
+    const TfLiteTensor* tensor = interpreter_->tensor(index);
+    // A string input has no contents to fill without knowing the model.
+    if (tensor->type == kTfLiteString) {
+      return absl::OkStatus();
+    }
+  }
+  for (int index : interpreter_->inputs()) {
+    TfLiteTensor* tensor = interpreter_->tensor(index);
+    if (tensor->bytes == 0) continue;
+    RET_CHECK(tensor->data.raw != nullptr);
+    std::memset(tensor->data.raw, 0, tensor->bytes);
+  }
+  RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::unique_ptr<InferenceRunner>>
 CreateInferenceInterpreterDelegateRunner(
     api2::Packet<TfLiteModelPtr> model,
     api2::Packet<tflite::OpResolver> op_resolver, TfLiteDelegatePtr delegate,
-    int interpreter_num_threads) {
+    int interpreter_num_threads, bool enable_zero_copy_tensor_binding,
+    int batch_size) {
   tflite::InterpreterBuilder interpreter_builder(*model.Get(),
                                                  op_resolver.Get());
   if (delegate) {
@@ -210,9 +541,21 @@ CreateInferenceInterpreterDelegateRunner(
   std::unique_ptr<tflite::Interpreter> interpreter;
   RET_CHECK_EQ(interpreter_builder(&interpreter), kTfLiteOk);
   RET_CHECK(interpreter);
+  if (batch_size > 1) {
+    for (int index : interpreter->inputs()) {
+      const TfLiteIntArray* dims = interpreter->tensor(index)->dims;
+      RET_CHECK(dims->size > 0 && dims->data[0] == 1)
+          << "Batching requires model inputs with a batch size of 1.";
+      std::vector<int> batched_dims(dims->data, dims->data + dims->size);
+      batched_dims[0] = batch_size;
+      RET_CHECK_EQ(interpreter->ResizeInputTensor(index, batched_dims),
+                   kTfLiteOk);
+    }
+  }
   RET_CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
   return std::make_unique<InferenceInterpreterDelegateRunner>(
-      std::move(model), std::move(interpreter), std::move(delegate));
+      std::move(model), std::move(interpreter), std::move(delegate),
+      enable_zero_copy_tensor_binding);
 }
 
 }  // namespace mediapipe
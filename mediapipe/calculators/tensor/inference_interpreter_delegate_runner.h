@@ -35,11 +35,21 @@ using TfLiteDelegatePtr =
 //
 // `delegate` can be nullptr, in that case newly initialized interpreter will
 // use what is available by default.
+//
+// If `enable_zero_copy_tensor_binding` is true, the interpreter reads inputs
+// from and writes outputs to the CPU buffers of the MediaPipe Tensors directly
+// wherever possible, instead of copying them.
+//
+// If `batch_size` is above 1, the leading dimension of every model input, which
+// must be 1, is resized to `batch_size`. Otherwise, when zero-copy tensor
+// binding is disabled, the leading dimension of a model input follows that of
+// the input Tensor, so a Tensor holding several crops runs as one batch.
 absl::StatusOr<std::unique_ptr<InferenceRunner>>
 CreateInferenceInterpreterDelegateRunner(
     api2::Packet<TfLiteModelPtr> model,
     api2::Packet<tflite::OpResolver> op_resolver, TfLiteDelegatePtr delegate,
-    int interpreter_num_threads);
+    int interpreter_num_threads, bool enable_zero_copy_tensor_binding = false,
+    int batch_size = 1);
 
 }  // namespace mediapipe
 
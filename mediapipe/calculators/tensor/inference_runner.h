@@ -1,6 +1,7 @@
 #ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_H_
 #define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_H_
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/formats/tensor.h"
@@ -13,6 +14,17 @@ class InferenceRunner {
   virtual ~InferenceRunner() = default;
   virtual absl::StatusOr<std::vector<Tensor>> Run(
       CalculatorContext* cc, const std::vector<Tensor>& inputs) = 0;
+
+  // Runs the model once on zero-filled inputs, so that the first-run costs,
+  // like the lazy preparation of delegate kernels, are paid before the first
+  // inference. Does nothing by default.
+  virtual absl::Status WarmUp() { return absl::OkStatus(); }
+
+  // Frees the working memory of the model, such as the arena of a TFLite
+  // interpreter, which the next Run allocates again. Used when the system is
+  // low on memory. May be called from any thread, concurrently with Run. Does
+  // nothing by default.
+  virtual void ReleaseMemory() {}
 };
 
 }  // namespace mediapipe
@@ -0,0 +1,141 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+namespace {
+
+class InferenceRunnerPool : public InferenceRunner {
+ public:
+  explicit InferenceRunnerPool(
+      std::vector<std::unique_ptr<InferenceRunner>> runners)
+      : runners_(std::move(runners)) {
+    for (auto& runner : runners_) {
+      idle_runners_.push_back(runner.get());
+    }
+  }
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      CalculatorContext* cc, const std::vector<Tensor>& inputs) override {
+    InferenceRunner* runner = AcquireRunner();
+    auto result = runner->Run(cc, inputs);
+    ReleaseRunner(runner);
+    return result;
+  }
+
+  absl::Status WarmUp() override {
+    for (auto& runner : runners_) {
+      MP_RETURN_IF_ERROR(runner->WarmUp());
+    }
+    return absl::OkStatus();
+  }
+
+  void ReleaseMemory() override {
+    // Runners that are busy still need their memory, and can't be used by
+    // two threads at once.
+    std::vector<InferenceRunner*> idle_runners;
+    {
+      absl::MutexLock lock(&mutex_);
+      idle_runners.swap(idle_runners_);
+    }
+    for (InferenceRunner* runner : idle_runners) {
+      runner->ReleaseMemory();
+    }
+    absl::MutexLock lock(&mutex_);
+    idle_runners_.insert(idle_runners_.end(), idle_runners.begin(),
+                         idle_runners.end());
+  }
+
+ private:
+  bool HasIdleRunner() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !idle_runners_.empty();
+  }
+
+  InferenceRunner* AcquireRunner() {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &InferenceRunnerPool::HasIdleRunner));
+    // The most recently used runner is the most likely to still be in cache.
+    InferenceRunner* runner = idle_runners_.back();
+    idle_runners_.pop_back();
+    return runner;
+  }
+
+  void ReleaseRunner(InferenceRunner* runner) {
+    absl::MutexLock lock(&mutex_);
+    idle_runners_.push_back(runner);
+  }
+
+  const std::vector<std::unique_ptr<InferenceRunner>> runners_;
+  absl::Mutex mutex_;
+  std::vector<InferenceRunner*> idle_runners_ ABSL_GUARDED_BY(mutex_);
+};
+
+class MemoryTrimmingRunner : public InferenceRunner {
+ public:
+  MemoryTrimmingRunner(std::unique_ptr<InferenceRunner> runner,
+                       MemoryTrimmer& trimmer)
+      : runner_(std::move(runner)),
+        registration_(trimmer.Register([this](MemoryTrimLevel level) {
+          if (level == MemoryTrimLevel::kComplete) {
+            runner_->ReleaseMemory();
+          }
+        })) {}
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      CalculatorContext* cc, const std::vector<Tensor>& inputs) override {
+    return runner_->Run(cc, inputs);
+  }
+
+  absl::Status WarmUp() override { return runner_->WarmUp(); }
+
+  void ReleaseMemory() override { runner_->ReleaseMemory(); }
+
+ private:
+  const std::unique_ptr<InferenceRunner> runner_;
+  // Declared last to be unregistered before the runner is destroyed.
+  MemoryTrimmer::Registration registration_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunnerPool(
+    std::vector<std::unique_ptr<InferenceRunner>> runners) {
+  RET_CHECK(!runners.empty());
+  for (const auto& runner : runners) {
+    RET_CHECK(runner != nullptr);
+  }
+  if (runners.size() == 1) {
+    return std::move(runners[0]);
+  }
+  return std::make_unique<InferenceRunnerPool>(std::move(runners));
+}
+
+std::unique_ptr<InferenceRunner> CreateMemoryTrimmingRunner(
+    std::unique_ptr<InferenceRunner> runner, MemoryTrimmer& trimmer) {
+  return std::make_unique<MemoryTrimmingRunner>(std::move(runner), trimmer);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,44 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_POOL_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_POOL_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/tensor/inference_runner.h"
+#include "mediapipe/framework/memory_trimmer.h"
+
+namespace mediapipe {
+
+// Creates an inference runner that can be called from several threads at once
+// and dispatches each call to one of `runners` that is not already running.
+// Calls wait while all of `runners` are busy.
+//
+// Each of `runners` is only ever used by one thread at a time, so they don't
+// need to be thread-safe.
+absl::StatusOr<std::unique_ptr<InferenceRunner>> CreateInferenceRunnerPool(
+    std::vector<std::unique_ptr<InferenceRunner>> runners);
+
+// Wraps `runner` so that it releases its memory with ReleaseMemory() on each
+// MemoryTrimLevel::kComplete trim of `trimmer`, until the wrapper is
+// destroyed. `trimmer` must outlive the wrapper.
+std::unique_ptr<InferenceRunner> CreateMemoryTrimmingRunner(
+    std::unique_ptr<InferenceRunner> runner, MemoryTrimmer& trimmer);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_INFERENCE_RUNNER_POOL_H_
@@ -0,0 +1,152 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/inference_runner_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/memory_trimmer.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+struct UsageStats {
+  std::atomic<int> num_running{0};
+  std::atomic<int> max_num_running{0};
+  std::atomic<int> num_memory_releases{0};
+};
+
+// Returns its input and records how many runners are running at once.
+class FakeRunner : public InferenceRunner {
+ public:
+  explicit FakeRunner(UsageStats* stats) : stats_(stats) {}
+
+  absl::StatusOr<std::vector<Tensor>> Run(
+      CalculatorContext* cc, const std::vector<Tensor>& inputs) override {
+    EXPECT_FALSE(running_.exchange(true)) << "Runner used concurrently.";
+    int num_running = ++stats_->num_running;
+    int max_num_running = stats_->max_num_running.load();
+    while (num_running > max_num_running &&
+           !stats_->max_num_running.compare_exchange_weak(max_num_running,
+                                                          num_running)) {
+    }
+    absl::SleepFor(absl::Milliseconds(5));
+
+    std::vector<Tensor> outputs;
+    outputs.emplace_back(Tensor::ElementType::kInt32, Tensor::Shape{1});
+    *outputs.back().GetCpuWriteView().buffer<int32_t>() =
+        *inputs[0].GetCpuReadView().buffer<int32_t>();
+    --stats_->num_running;
+    running_ = false;
+    return outputs;
+  }
+
+  void ReleaseMemory() override {
+    EXPECT_FALSE(running_) << "Memory released during inference.";
+    ++stats_->num_memory_releases;
+  }
+
+ private:
+  UsageStats* stats_;
+  std::atomic<bool> running_{false};
+};
+
+TEST(InferenceRunnerPoolTest, RequiresRunners) {
+  EXPECT_FALSE(CreateInferenceRunnerPool({}).ok());
+}
+
+TEST(InferenceRunnerPoolTest, RunsOnSeveralRunnersAtOnce) {
+  constexpr int kNumRunners = 3;
+  constexpr int kNumCalls = 30;
+  UsageStats stats;
+  std::vector<std::unique_ptr<InferenceRunner>> runners;
+  for (int i = 0; i < kNumRunners; ++i) {
+    runners.push_back(std::make_unique<FakeRunner>(&stats));
+  }
+  MP_ASSERT_OK_AND_ASSIGN(auto pool,
+                          CreateInferenceRunnerPool(std::move(runners)));
+
+  absl::Mutex mutex;
+  std::vector<int> results;
+  {
+    ThreadPool thread_pool("pool_test", 2 * kNumRunners);
+    thread_pool.StartWorkers();
+    for (int i = 0; i < kNumCalls; ++i) {
+      thread_pool.Schedule([&, i] {
+        std::vector<Tensor> inputs;
+        inputs.emplace_back(Tensor::ElementType::kInt32, Tensor::Shape{1});
+        *inputs.back().GetCpuWriteView().buffer<int32_t>() = i;
+        auto outputs = pool->Run(/*cc=*/nullptr, inputs);
+        ASSERT_TRUE(outputs.ok());
+        absl::MutexLock lock(&mutex);
+        results.push_back(
+            *(*outputs)[0].GetCpuReadView().buffer<int32_t>());
+      });
+    }
+  }
+
+  EXPECT_EQ(results.size(), kNumCalls);
+  EXPECT_GT(stats.max_num_running, 1);
+  EXPECT_LE(stats.max_num_running, kNumRunners);
+}
+
+TEST(InferenceRunnerPoolTest, ReleasesMemoryOfIdleRunners) {
+  constexpr int kNumRunners = 3;
+  UsageStats stats;
+  std::vector<std::unique_ptr<InferenceRunner>> runners;
+  for (int i = 0; i < kNumRunners; ++i) {
+    runners.push_back(std::make_unique<FakeRunner>(&stats));
+  }
+  MP_ASSERT_OK_AND_ASSIGN(auto pool,
+                          CreateInferenceRunnerPool(std::move(runners)));
+
+  pool->ReleaseMemory();
+  EXPECT_EQ(stats.num_memory_releases, kNumRunners);
+
+  // The runners are available again.
+  std::vector<Tensor> inputs;
+  inputs.emplace_back(Tensor::ElementType::kInt32, Tensor::Shape{1});
+  *inputs.back().GetCpuWriteView().buffer<int32_t>() = 7;
+  MP_ASSERT_OK_AND_ASSIGN(auto outputs, pool->Run(/*cc=*/nullptr, inputs));
+  EXPECT_EQ(*outputs[0].GetCpuReadView().buffer<int32_t>(), 7);
+}
+
+TEST(InferenceRunnerPoolTest, TrimsMemoryOfWrappedRunner) {
+  UsageStats stats;
+  MemoryTrimmer trimmer;
+  {
+    auto runner = CreateMemoryTrimmingRunner(
+        std::make_unique<FakeRunner>(&stats), trimmer);
+    trimmer.Trim(MemoryTrimLevel::kModerate);
+    EXPECT_EQ(stats.num_memory_releases, 0);
+    trimmer.Trim(MemoryTrimLevel::kComplete);
+    EXPECT_EQ(stats.num_memory_releases, 1);
+  }
+  // The destroyed runner is no longer trimmed.
+  trimmer.Trim(MemoryTrimLevel::kComplete);
+  EXPECT_EQ(stats.num_memory_releases, 1);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,8 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
-#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -21,6 +21,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mediapipe/calculators/tensor/regex_preprocessor_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
@@ -41,8 +42,11 @@ using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 // a RegexTokenizer.
 //
 // Inputs:
-//   TEXT - std::string
+//   TEXT - std::string @Optional
 //     The input text.
+//   TEXTS - std::vector<std::string> @Optional
+//     A batch of input texts, for text models with a dynamic batch size.
+//   Exactly one of TEXT and TEXTS must be connected.
 // Side Inputs:
 //   METADATA_EXTRACTOR - ModelMetadataExtractor
 //     The metadata extractor for the text model. Used to extract the metadata
@@ -56,7 +60,8 @@ using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 //     be the ids of the tokens of the input text. Any out-of-vocab tokens will
 //     have the id of the <UNKNOWN> token. The tensor will be padded with the
 //     <PAD> token id to have size equal to the max sequence length for the text
-//     model.
+//     model. For TEXTS, the tensor has shape [N, max_seq_len] and its rows are
+//     the tensors of the N texts.
 //
 // Example:
 // node {
@@ -72,21 +77,31 @@ using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 // }
 class RegexPreprocessorCalculator : public Node {
  public:
-  static constexpr Input<std::string> kTextIn{"TEXT"};
+  static constexpr Input<std::string>::Optional kTextIn{"TEXT"};
+  static constexpr Input<std::vector<std::string>>::Optional kTextsIn{
+      "TEXTS"};
   static constexpr SideInput<ModelMetadataExtractor> kMetadataExtractorSideIn{
       "METADATA_EXTRACTOR"};
   static constexpr Output<std::vector<Tensor>> kTensorsOut{"TENSORS"};
 
-  MEDIAPIPE_NODE_CONTRACT(kTextIn, kMetadataExtractorSideIn, kTensorsOut);
+  MEDIAPIPE_NODE_CONTRACT(kTextIn, kTextsIn, kMetadataExtractorSideIn,
+                          kTensorsOut);
 
   static absl::Status UpdateContract(CalculatorContract* cc);
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
 
  private:
+  // Writes the token ids of `text` to `input_ids` of size `max_seq_len_`.
+  void TokenizeInto(const std::string& text, absl::Span<int32_t> input_ids);
+
   std::unique_ptr<tasks::text::tokenizers::RegexTokenizer> tokenizer_;
   // The max sequence length accepted by the text model.
   int max_seq_len_ = 0;
+  // The ids of the special tokens, looked up once at Open().
+  bool has_start_token_ = false;
+  int start_token_id_ = 0;
+  int pad_token_id_ = 0;
 };
 
 absl::Status RegexPreprocessorCalculator::UpdateContract(
@@ -95,6 +110,8 @@ absl::Status RegexPreprocessorCalculator::UpdateContract(
       cc->Options<mediapipe::RegexPreprocessorCalculatorOptions>();
   RET_CHECK(options.has_max_seq_len()) << "max_seq_len is required";
   RET_CHECK_GT(options.max_seq_len(), 0) << "max_seq_len must be positive";
+  RET_CHECK(kTextIn(cc).IsConnected() ^ kTextsIn(cc).IsConnected())
+      << "Exactly one of TEXT and TEXTS must be connected";
   return absl::OkStatus();
 }
 
@@ -123,49 +140,50 @@ absl::Status RegexPreprocessorCalculator::Open(CalculatorContext* cc) {
   const auto& options =
       cc->Options<mediapipe::RegexPreprocessorCalculatorOptions>();
   max_seq_len_ = options.max_seq_len();
+  has_start_token_ = tokenizer_->GetStartToken(&start_token_id_);
+  tokenizer_->GetPadToken(&pad_token_id_);
   return absl::OkStatus();
 }
 
 absl::Status RegexPreprocessorCalculator::Process(CalculatorContext* cc) {
-  tasks::text::tokenizers::TokenizerResult tokenizer_result =
-      tokenizer_->Tokenize(kTextIn(cc).Get());
-
-  int unknown_token_id = 0;
-  tokenizer_->GetUnknownToken(&unknown_token_id);
-  int pad_token_id = 0;
-  tokenizer_->GetPadToken(&pad_token_id);
-
-  std::vector<int> input_tokens(max_seq_len_, pad_token_id);
-  int start_token_id = 0;
-  int input_token_index = 0;
-  if (tokenizer_->GetStartToken(&start_token_id)) {
-    input_tokens[0] = start_token_id;
-    input_token_index = 1;
-  }
-
-  for (int i = 0; (i < tokenizer_result.subwords.size()) &&
-                  (input_token_index < max_seq_len_);
-       ++i, ++input_token_index) {
-    const std::string& token = tokenizer_result.subwords[i];
-    int token_id = 0;
-    if (tokenizer_->LookupId(token, &token_id)) {
-      input_tokens[input_token_index] = token_id;
-    } else {
-      input_tokens[input_token_index] = unknown_token_id;
+  std::vector<Tensor> result;
+  if (kTextIn(cc).IsConnected()) {
+    if (kTextIn(cc).IsEmpty()) return absl::OkStatus();
+    result.push_back(
+        {Tensor::ElementType::kInt32, Tensor::Shape({max_seq_len_})});
+    auto write_view = result[0].GetCpuWriteView();
+    TokenizeInto(kTextIn(cc).Get(),
+                 absl::MakeSpan(write_view.buffer<int32_t>(), max_seq_len_));
+  } else {
+    if (kTextsIn(cc).IsEmpty()) return absl::OkStatus();
+    const std::vector<std::string>& texts = kTextsIn(cc).Get();
+    RET_CHECK(!texts.empty()) << "TEXTS must not be empty";
+    const int batch_size = texts.size();
+    result.push_back({Tensor::ElementType::kInt32,
+                      Tensor::Shape({batch_size, max_seq_len_})});
+    auto write_view = result[0].GetCpuWriteView();
+    int32_t* buffer = write_view.buffer<int32_t>();
+    for (int i = 0; i < batch_size; ++i) {
+      TokenizeInto(texts[i],
+                   absl::MakeSpan(buffer + i * max_seq_len_, max_seq_len_));
     }
   }
+  kTensorsOut(cc).Send(std::move(result));
+  return absl::OkStatus();
+}
 
+void RegexPreprocessorCalculator::TokenizeInto(const std::string& text,
+                                               absl::Span<int32_t> input_ids) {
   //                              |<-------sentence_length-------->|
   // input_tensor                 <START>, t1, t2... <PAD>, <PAD>...
   // <START> is optional, t1, t2... will be replaced by <UNKNOWN> if it's
   // not found in the tokenizer vocab.
-  std::vector<Tensor> result;
-  result.push_back(
-      {Tensor::ElementType::kInt32, Tensor::Shape({max_seq_len_})});
-  std::memcpy(result[0].GetCpuWriteView().buffer<int32_t>(),
-              input_tokens.data(), input_tokens.size() * sizeof(int32_t));
-  kTensorsOut(cc).Send(std::move(result));
-  return absl::OkStatus();
+  int num_ids = 0;
+  if (has_start_token_) {
+    input_ids[num_ids++] = start_token_id_;
+  }
+  num_ids += tokenizer_->TokenizeIds(text, input_ids.subspan(num_ids));
+  std::fill(input_ids.begin() + num_ids, input_ids.end(), pad_token_id_);
 }
 
 MEDIAPIPE_REGISTER_NODE(RegexPreprocessorCalculator);
@@ -43,8 +43,11 @@ constexpr char kTestModelPath[] =
     "mediapipe/tasks/testdata/text/"
     "test_model_text_classifier_with_regex_tokenizer.tflite";
 
+// Runs the calculator on `input` sent to its `input_tag` input stream, and
+// returns the values of the output tensor of shape `output_shape`.
 absl::StatusOr<std::vector<int>> RunRegexPreprocessorCalculator(
-    absl::string_view text) {
+    absl::string_view input_tag, Packet input,
+    const std::vector<int>& output_shape) {
   auto graph_config =
       ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
           R"pb(
@@ -52,7 +55,7 @@ absl::StatusOr<std::vector<int>> RunRegexPreprocessorCalculator(
             output_stream: "tensors"
             node {
               calculator: "RegexPreprocessorCalculator"
-              input_stream: "TEXT:text"
+              input_stream: "$1:text"
               input_side_packet: "METADATA_EXTRACTOR:metadata_extractor"
               output_stream: "TENSORS:tensors"
               options {
@@ -62,7 +65,7 @@ absl::StatusOr<std::vector<int>> RunRegexPreprocessorCalculator(
               }
             }
           )pb",
-          kMaxSeqLen));
+          kMaxSeqLen, input_tag));
   std::vector<Packet> output_packets;
   tool::AddVectorSink("tensors", &graph_config, &output_packets);
 
@@ -77,8 +80,8 @@ absl::StatusOr<std::vector<int>> RunRegexPreprocessorCalculator(
       {{"metadata_extractor",
         MakePacket<ModelMetadataExtractor>(std::move(*metadata_extractor))}}));
   MP_RETURN_IF_ERROR(graph.StartRun({}));
-  MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
-      "text", MakePacket<std::string>(text).At(Timestamp(0))));
+  MP_RETURN_IF_ERROR(
+      graph.AddPacketToInputStream("text", input.At(Timestamp(0))));
   MP_RETURN_IF_ERROR(graph.WaitUntilIdle());
 
   if (output_packets.size() != 1) {
@@ -94,13 +97,23 @@ absl::StatusOr<std::vector<int>> RunRegexPreprocessorCalculator(
   if (tensor_vec[0].element_type() != Tensor::ElementType::kInt32) {
     return absl::InvalidArgumentError("Expected tensor element type kInt32");
   }
+  if (tensor_vec[0].shape().dims != output_shape) {
+    return absl::InvalidArgumentError("Unexpected tensor shape");
+  }
   auto* buffer = tensor_vec[0].GetCpuReadView().buffer<int>();
-  std::vector<int> result(buffer, buffer + kMaxSeqLen);
+  std::vector<int> result(buffer,
+                          buffer + tensor_vec[0].shape().num_elements());
   MP_RETURN_IF_ERROR(graph.CloseAllPacketSources());
   MP_RETURN_IF_ERROR(graph.WaitUntilDone());
   return result;
 }
 
+absl::StatusOr<std::vector<int>> RunRegexPreprocessorCalculator(
+    absl::string_view text) {
+  return RunRegexPreprocessorCalculator(
+      "TEXT", MakePacket<std::string>(std::string(text)), {kMaxSeqLen});
+}
+
 TEST(RegexPreprocessorCalculatorTest, TextClassifierModel) {
   MP_ASSERT_OK_AND_ASSIGN(
       std::vector<int> processed_tensor_values,
@@ -126,5 +139,25 @@ TEST(RegexPreprocessorCalculatorTest, LongInput) {
   EXPECT_THAT(processed_tensor_values, ElementsAreArray(expected_result));
 }
 
+TEST(RegexPreprocessorCalculatorTest, BatchInput) {
+  const std::vector<std::string> texts = {
+      "This is the best movie I’ve seen in recent years. Strongly recommend "
+      "it!",
+      "What a waste of my time."};
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::vector<int> processed_tensor_values,
+      RunRegexPreprocessorCalculator(
+          "TEXTS", MakePacket<std::vector<std::string>>(texts),
+          {static_cast<int>(texts.size()), kMaxSeqLen}));
+
+  std::vector<int> expected_result;
+  for (const std::string& text : texts) {
+    MP_ASSERT_OK_AND_ASSIGN(std::vector<int> row,
+                            RunRegexPreprocessorCalculator(text));
+    expected_result.insert(expected_result.end(), row.begin(), row.end());
+  }
+  EXPECT_THAT(processed_tensor_values, ElementsAreArray(expected_result));
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -0,0 +1,146 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/stft_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "audio/dsp/window_functions.h"
+#include "mediapipe/framework/port/logging.h"
+#include "pffft.h"
+
+namespace mediapipe {
+
+bool IsValidFftSize(int size) {
+  if (size <= 0) {
+    return false;
+  }
+  constexpr int kFactors[] = {2, 3, 5};
+  int factorization[] = {0, 0, 0};
+  int n = static_cast<int>(size);
+  for (int i = 0; i < 3; ++i) {
+    while (n % kFactors[i] == 0) {
+      n = n / kFactors[i];
+      ++factorization[i];
+    }
+  }
+  return factorization[0] >= 5 && n == 1;
+}
+
+std::vector<float> HannWindow(int window_size, bool sqrt_hann) {
+  std::vector<float> hann_window(window_size);
+  audio_dsp::HannWindow().GetPeriodicSamples(window_size, &hann_window);
+  if (sqrt_hann) {
+    absl::c_transform(hann_window, hann_window.begin(),
+                      [](double x) { return std::sqrt(x); });
+  }
+  return hann_window;
+}
+
+std::vector<float> InvHannWindow(int window_size, int frame_step,
+                                 bool sqrt_hann) {
+  std::vector<float> window = HannWindow(window_size, sqrt_hann);
+  if (sqrt_hann) {
+    return window;
+  }
+  CHECK_GT(frame_step, 0);
+  std::vector<float> squared_window(window.size());
+  absl::c_transform(window, squared_window.begin(),
+                    [](double x) { return x * x; });
+  std::vector<float> inv_window(window.size());
+  for (int i = 0; i < window_size; ++i) {
+    // The frames overlapping sample i have it at the positions congruent to
+    // i modulo the frame step.
+    float sum = 0;
+    for (int j = i % frame_step; j < window_size; j += frame_step) {
+      sum += squared_window[j];
+    }
+    inv_window[i] = window[i] / static_cast<double>(sum);
+  }
+  return inv_window;
+}
+
+WindowedRealFft::WindowedRealFft(int fft_size, std::vector<float> window)
+    : fft_size_(fft_size),
+      inverse_fft_size_(1.0f / fft_size),
+      fft_state_(pffft_new_setup(fft_size, PFFFT_REAL)),
+      window_(std::move(window)),
+      input_(fft_size),
+      output_(fft_size),
+      workspace_(fft_size) {
+  CHECK(fft_state_) << "Invalid FFT size " << fft_size;
+  CHECK_EQ(window_.size(), fft_size);
+}
+
+WindowedRealFft::~WindowedRealFft() { pffft_destroy_setup(fft_state_); }
+
+absl::Span<const float> WindowedRealFft::Forward(const float* samples,
+                                                 int num_samples) {
+  CHECK_LE(num_samples, fft_size_);
+  std::transform(samples, samples + num_samples, window_.begin(),
+                 input_.begin(), std::multiplies<float>());
+  std::fill(input_.begin() + num_samples, input_.end(), 0.0f);
+  pffft_transform_ordered(fft_state_, input_.data(), output_.data(),
+                          workspace_.data(), PFFFT_FORWARD);
+  return absl::MakeConstSpan(output_.data(), fft_size_);
+}
+
+absl::Span<const float> WindowedRealFft::Inverse() {
+  pffft_transform_ordered(fft_state_, input_.data(), output_.data(),
+                          workspace_.data(), PFFFT_BACKWARD);
+  // Windows and scales in place, in one pass.
+  const float scale = inverse_fft_size_;
+  std::transform(output_.begin(), output_.end(), window_.begin(),
+                 output_.begin(),
+                 [scale](float a, float b) { return a * b * scale; });
+  return absl::MakeConstSpan(output_.data(), fft_size_);
+}
+
+OverlapAdder::OverlapAdder(int frame_size, int frame_step)
+    : frame_size_(frame_size),
+      frame_step_(frame_step),
+      buffer_(frame_size, 0.0f) {
+  CHECK_GT(frame_step, 0);
+  CHECK_LE(frame_step, frame_size);
+}
+
+void OverlapAdder::Add(const float* frame, float* output) {
+  // The frame starts at head_ and wraps around the end of the ring buffer,
+  // so it is added in two contiguous parts.
+  const int first_part_size = frame_size_ - head_;
+  float* buffer = buffer_.data();
+  for (int i = 0; i < first_part_size; ++i) {
+    buffer[head_ + i] += frame[i];
+  }
+  for (int i = first_part_size; i < frame_size_; ++i) {
+    buffer[i - first_part_size] += frame[i];
+  }
+  // Outputs and clears the first frame_step samples, which the next frames
+  // start after.
+  const int first_output_size = std::min(frame_step_, first_part_size);
+  std::memcpy(output, buffer + head_, first_output_size * sizeof(float));
+  std::fill_n(buffer + head_, first_output_size, 0.0f);
+  std::memcpy(output + first_output_size, buffer,
+              (frame_step_ - first_output_size) * sizeof(float));
+  std::fill_n(buffer, frame_step_ - first_output_size, 0.0f);
+  head_ = (head_ + frame_step_) % frame_size_;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,111 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_STFT_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_STFT_UTILS_H_
+
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/types/span.h"
+
+struct PFFFT_Setup;
+
+namespace mediapipe {
+
+// PFFFT only supports transforms for inputs of length N of the form
+// N = (2^a)*(3^b)*(5^c) where b >=0 and c >= 0 and a >= 5 for the real FFT.
+bool IsValidFftSize(int size);
+
+// Returns the periodic Hann window of @window_size samples, or its square root
+// if @sqrt_hann is true.
+std::vector<float> HannWindow(int window_size, bool sqrt_hann);
+
+// Returns the synthesis window inverting the Hann analysis window when the
+// frames are overlap-added every @frame_step samples: the Hann window (or its
+// square root) normalized by the sum of the squared windows overlapping each
+// sample. If @sqrt_hann is true, the window is returned as is, which assumes
+// that the frames overlap by half.
+std::vector<float> InvHannWindow(int window_size, int frame_step,
+                                 bool sqrt_hann);
+
+// A windowed real FFT of a fixed size. The FFT plan, the window and the
+// aligned buffers of the transforms are created once, so that transforming a
+// frame doesn't allocate.
+//
+// The DFT is in the PFFFT ordered layout: the real parts of the DC and Nyquist
+// components, followed by the interleaved real and imaginary parts of the
+// other frequency bins.
+class WindowedRealFft {
+ public:
+  // @fft_size must be valid according to IsValidFftSize. @window must have
+  // @fft_size samples.
+  WindowedRealFft(int fft_size, std::vector<float> window);
+  ~WindowedRealFft();
+
+  WindowedRealFft(const WindowedRealFft&) = delete;
+  WindowedRealFft& operator=(const WindowedRealFft&) = delete;
+
+  int fft_size() const { return fft_size_; }
+
+  // Returns the DFT of the first @num_samples samples of @samples, multiplied
+  // by the window and zero-padded to the FFT size. @num_samples must not
+  // exceed the FFT size. The result is valid until the next transform.
+  absl::Span<const float> Forward(const float* samples, int num_samples);
+
+  // The buffer to write the DFT to transform by Inverse() into.
+  absl::Span<float> inverse_input() {
+    return absl::MakeSpan(input_.data(), fft_size_);
+  }
+
+  // Returns the inverse DFT of inverse_input(), scaled by 1 / fft_size and
+  // multiplied by the window. The result is valid until the next transform.
+  absl::Span<const float> Inverse();
+
+ private:
+  using AlignedBuffer = std::vector<float, Eigen::aligned_allocator<float>>;
+
+  int fft_size_;
+  float inverse_fft_size_;
+  PFFFT_Setup* fft_state_;
+  std::vector<float> window_;
+  AlignedBuffer input_;
+  AlignedBuffer output_;
+  // pffft requires memory to work with to avoid using the stack.
+  AlignedBuffer workspace_;
+};
+
+// Overlap-adds frames of @frame_size samples whose starts are @frame_step
+// samples apart, in a ring buffer of one frame.
+class OverlapAdder {
+ public:
+  // @frame_step must be in (0, @frame_size].
+  OverlapAdder(int frame_size, int frame_step);
+
+  // Adds @frame, of frame_size samples, at frame_step samples after the
+  // previous frame, and writes to @output the frame_step samples that no next
+  // frame overlaps.
+  void Add(const float* frame, float* output);
+
+ private:
+  int frame_size_;
+  int frame_step_;
+  // The sums of the samples of the current frame, from @head_.
+  std::vector<float> buffer_;
+  int head_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_STFT_UTILS_H_
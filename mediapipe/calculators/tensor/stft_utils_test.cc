@@ -0,0 +1,124 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/stft_utils.h"
+
+#include <cmath>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/types/span.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(StftUtilsTest, IsValidFftSize) {
+  EXPECT_TRUE(IsValidFftSize(32));
+  EXPECT_TRUE(IsValidFftSize(320));
+  EXPECT_TRUE(IsValidFftSize(480));
+  EXPECT_FALSE(IsValidFftSize(0));
+  EXPECT_FALSE(IsValidFftSize(16));
+  EXPECT_FALSE(IsValidFftSize(103));
+  EXPECT_FALSE(IsValidFftSize(32 * 7));
+}
+
+TEST(StftUtilsTest, InvHannWindowInvertsHannWindowWhenOverlapAdded) {
+  constexpr int kWindowSize = 64;
+  const std::vector<float> window = HannWindow(kWindowSize, false);
+  for (int frame_step : {kWindowSize / 2, kWindowSize / 4}) {
+    const std::vector<float> inv_window =
+        InvHannWindow(kWindowSize, frame_step, false);
+    // Sums the products of the windows of the frames overlapping a sample.
+    for (int i = 0; i < frame_step; ++i) {
+      double sum = 0;
+      for (int j = i; j < kWindowSize; j += frame_step) {
+        sum += window[j] * inv_window[j];
+      }
+      EXPECT_NEAR(sum, 1.0, 1e-5) << "frame_step " << frame_step;
+    }
+  }
+}
+
+TEST(StftUtilsTest, ForwardZeroPadsSamples) {
+  WindowedRealFft fft(32, std::vector<float>(32, 2.0f));
+  const std::vector<float> samples = {1.0f, 1.0f, 1.0f, 1.0f};
+  absl::Span<const float> dft = fft.Forward(samples.data(), samples.size());
+  ASSERT_EQ(dft.size(), 32);
+  // The DC component sums the windowed samples, and the Nyquist component
+  // alternates their signs.
+  EXPECT_NEAR(dft[0], 8.0f, 1e-5);
+  EXPECT_NEAR(dft[1], 0.0f, 1e-5);
+}
+
+TEST(StftUtilsTest, InverseInvertsForward) {
+  constexpr int kFftSize = 32;
+  WindowedRealFft fft(kFftSize, std::vector<float>(kFftSize, 1.0f));
+  std::vector<float> samples(kFftSize);
+  for (int i = 0; i < kFftSize; ++i) {
+    samples[i] = std::sin(0.3f * i) + 0.1f * i;
+  }
+  absl::Span<const float> dft = fft.Forward(samples.data(), kFftSize);
+  absl::c_copy(dft, fft.inverse_input().begin());
+  absl::Span<const float> output = fft.Inverse();
+  for (int i = 0; i < kFftSize; ++i) {
+    EXPECT_NEAR(output[i], samples[i], 1e-4) << i;
+  }
+}
+
+TEST(StftUtilsTest, OverlapAdderSumsOverlappingFrames) {
+  OverlapAdder overlap_adder(/*frame_size=*/4, /*frame_step=*/3);
+  const std::vector<float> frame = {1.0f, 2.0f, 3.0f, 4.0f};
+  std::vector<float> output(3);
+  overlap_adder.Add(frame.data(), output.data());
+  EXPECT_THAT(output, ElementsAre(1.0f, 2.0f, 3.0f));
+  overlap_adder.Add(frame.data(), output.data());
+  EXPECT_THAT(output, ElementsAre(5.0f, 2.0f, 3.0f));
+  overlap_adder.Add(frame.data(), output.data());
+  EXPECT_THAT(output, ElementsAre(5.0f, 2.0f, 3.0f));
+}
+
+TEST(StftUtilsTest, ReconstructsSignal) {
+  constexpr int kFftSize = 64;
+  constexpr int kFrameStep = 16;
+  constexpr int kNumFrames = 12;
+  std::vector<float> signal(kFrameStep * kNumFrames + kFftSize);
+  for (int i = 0; i < signal.size(); ++i) {
+    signal[i] = std::sin(0.05f * i) + 0.5f * std::cos(0.7f * i);
+  }
+  WindowedRealFft analysis(kFftSize, HannWindow(kFftSize, false));
+  WindowedRealFft synthesis(kFftSize,
+                            InvHannWindow(kFftSize, kFrameStep, false));
+  OverlapAdder overlap_adder(kFftSize, kFrameStep);
+  std::vector<float> output(kFrameStep);
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    absl::Span<const float> dft =
+        analysis.Forward(signal.data() + frame * kFrameStep, kFftSize);
+    absl::c_copy(dft, synthesis.inverse_input().begin());
+    overlap_adder.Add(synthesis.Inverse().data(), output.data());
+    // The first fft_size samples miss the frames that would start before the
+    // signal.
+    if (frame * kFrameStep < kFftSize) continue;
+    for (int i = 0; i < kFrameStep; ++i) {
+      EXPECT_NEAR(output[i], signal[frame * kFrameStep + i], 1e-4)
+          << "frame " << frame << ", sample " << i;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
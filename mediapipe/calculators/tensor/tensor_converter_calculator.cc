@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -22,7 +23,10 @@
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/tensor_pool_service.h"
 #include "mediapipe/util/resource_util.h"
+#include "mediapipe/util/simd/simd.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gpu_buffer.h"
@@ -53,6 +57,54 @@ typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
 typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>
     ColMajorMatrixXf;
 
+// Frames with at least this many output values are converted with rows split
+// across threads.
+constexpr int kMinParallelSize = 1 << 18;
+// Number of output values converted per parallel task, about.
+constexpr int kParallelGrainSize = 1 << 16;
+
+// Converts a row of width pixels, keeping the first kOutChannels of the
+// kInChannels of each pixel. Fixed channel counts let the compiler unroll the
+// pixel loop, and rows keeping all channels are converted as a flat array.
+template <class T, int kInChannels, int kOutChannels>
+void ConvertRow(const T* src, int width, float scale, float bias, float* dst) {
+  if (kInChannels == kOutChannels) {
+    mediapipe::simd::ScaleAndBias(src, width * kInChannels, scale, bias, dst);
+    return;
+  }
+  for (int j = 0; j < width; ++j) {
+    for (int c = 0; c < kOutChannels; ++c) {
+      dst[c] = src[c] * scale + bias;
+    }
+    src += kInChannels;
+    dst += kOutChannels;
+  }
+}
+
+template <class T>
+using RowConverter = void (*)(const T* src, int width, float scale, float bias,
+                              float* dst);
+
+template <class T>
+RowConverter<T> GetRowConverter(int in_channels, int out_channels) {
+  switch (in_channels * 10 + out_channels) {
+    case 11:
+      return &ConvertRow<T, 1, 1>;
+    case 31:
+      return &ConvertRow<T, 3, 1>;
+    case 33:
+      return &ConvertRow<T, 3, 3>;
+    case 41:
+      return &ConvertRow<T, 4, 1>;
+    case 43:
+      return &ConvertRow<T, 4, 3>;
+    case 44:
+      return &ConvertRow<T, 4, 4>;
+    default:
+      return nullptr;
+  }
+}
+
 constexpr char kImageFrameTag[] = "IMAGE";
 constexpr char kGpuBufferTag[] = "IMAGE_GPU";
 constexpr char kTensorsTag[] = "TENSORS";
@@ -166,6 +218,7 @@ absl::Status TensorConverterCalculator::GetContract(CalculatorContract* cc) {
 
   RET_CHECK(cc->Outputs().HasTag(kTensorsTag));
   cc->Outputs().Tag(kTensorsTag).Set<std::vector<Tensor>>();
+  UseTensorPool(cc);
   return absl::OkStatus();
 }
 
@@ -243,9 +296,9 @@ absl::Status TensorConverterCalculator::ProcessCPU(CalculatorContext* cc) {
           format == mediapipe::ImageFormat::VEC32F1))
       RET_CHECK_FAIL() << "Unsupported CPU input format.";
 
-    output_tensors->emplace_back(
-        Tensor::ElementType::kFloat32,
-        Tensor::Shape{1, height, width, channels_preserved});
+    output_tensors->push_back(
+        AllocateTensor(cc, Tensor::ElementType::kFloat32,
+                       Tensor::Shape{1, height, width, channels_preserved}));
     auto cpu_view = output_tensors->back().GetCpuWriteView();
 
     // Copy image data into tensor.
@@ -267,8 +320,9 @@ absl::Status TensorConverterCalculator::ProcessCPU(CalculatorContext* cc) {
     const int height = matrix.rows();
     const int width = matrix.cols();
     const int channels = 1;
-    output_tensors->emplace_back(Tensor::ElementType::kFloat32,
-                                 Tensor::Shape{1, height, width, channels});
+    output_tensors->push_back(
+        AllocateTensor(cc, Tensor::ElementType::kFloat32,
+                       Tensor::Shape{1, height, width, channels}));
     MP_RETURN_IF_ERROR(CopyMatrixToTensor(
         matrix, output_tensors->back().GetCpuWriteView().buffer<float>()));
   } else {
@@ -293,8 +347,9 @@ absl::Status TensorConverterCalculator::ProcessGPU(CalculatorContext* cc) {
   int height = input.height();
   int channels = max_num_channels_;
   auto output_tensors = absl::make_unique<std::vector<Tensor>>();
-  output_tensors->emplace_back(Tensor::ElementType::kFloat32,
-                               Tensor::Shape{1, height, width, channels});
+  output_tensors->push_back(
+      AllocateTensor(cc, Tensor::ElementType::kFloat32,
+                     Tensor::Shape{1, height, width, channels}));
 #if MEDIAPIPE_METAL_ENABLED
   id<MTLCommandBuffer> command_buffer = [gpu_helper_ commandBuffer];
   command_buffer.label = @"TensorConverterCalculatorConvert";
@@ -612,42 +667,40 @@ absl::Status TensorConverterCalculator::NormalizeImage(
   const int width = image_frame.Width();
   const int channels = image_frame.NumberOfChannels();
   const int channels_preserved = std::min(channels, max_num_channels_);
-  const int channels_ignored = channels - channels_preserved;
 
+  // Without an output range, values are scaled from [0, 255] to [0, 1].
+  // Verified that there are no precision issues with 1.0f / 255.0f expression
+  float scale = 1.0f / 255.0f;
+  float bias = 0.0f;
   if (output_range_.has_value()) {
     // If the output float range is set and we are not using custom
     // normalization, normalize the pixel values from [0, 255] to the specified
     // output range.
     RET_CHECK_NE(output_range_->first, output_range_->second);
-    const float scale = (output_range_->second - output_range_->first) / 255.0f;
-    const float bias = output_range_->first;
+    scale = (output_range_->second - output_range_->first) / 255.0f;
+    bias = output_range_->first;
+  }
+
+  const RowConverter<T> convert_row =
+      GetRowConverter<T>(channels, channels_preserved);
+  RET_CHECK(convert_row) << "Unsupported number of channels: " << channels;
 
-    for (int i = 0; i < height; ++i) {
+  // The flip, channel selection and normalization are all done in one pass
+  // over each row.
+  const int row_size = width * channels_preserved;
+  auto convert_rows = [&](const BlockedRange& range) {
+    for (int i = range.begin(); i < range.end(); ++i) {
       const T* image_ptr = reinterpret_cast<const T*>(
           image_frame.PixelData() +
           (flip_vertically ? height - 1 - i : i) * image_frame.WidthStep());
-      for (int j = 0; j < width; ++j) {
-        for (int c = 0; c < channels_preserved; ++c) {
-          *tensor_ptr++ = *image_ptr++ * scale + bias;
-        }
-        image_ptr += channels_ignored;
-      }
+      convert_row(image_ptr, width, scale, bias, tensor_ptr + i * row_size);
     }
+  };
+  if (height * row_size >= kMinParallelSize) {
+    ParallelFor(0, height, std::max(1, kParallelGrainSize / row_size),
+                convert_rows);
   } else {
-    // [0,1], scale only (bias == 0)
-    // Verified that there are no precision issues with 1.0f / 255.0f expression
-    const float scale = 1.0f / 255.0f;
-    for (int i = 0; i < height; ++i) {
-      const T* image_ptr = reinterpret_cast<const T*>(
-          image_frame.PixelData() +
-          (flip_vertically ? height - 1 - i : i) * image_frame.WidthStep());
-      for (int j = 0; j < width; ++j) {
-        for (int c = 0; c < channels_preserved; ++c) {
-          *tensor_ptr++ = *image_ptr++ * scale;
-        }
-        image_ptr += channels_ignored;
-      }
-    }
+    convert_rows(BlockedRange(0, height, height));
   }
 
   return absl::OkStatus();
@@ -320,4 +320,61 @@ TEST_F(TensorConverterCalculatorTest, SetOutputRange) {
   }
 }
 
+
+TEST_F(TensorConverterCalculatorTest, FlipsAndDropsAlpha) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input_image"
+        node {
+          calculator: "TensorConverterCalculator"
+          input_stream: "IMAGE:input_image"
+          output_stream: "TENSORS:tensor"
+          options {
+            [mediapipe.TensorConverterCalculatorOptions.ext] {
+              zero_center: true
+              flip_vertically: true
+              max_num_channels: 3
+            }
+          }
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  constexpr int kWidth = 9;
+  constexpr int kHeight = 3;
+  auto input_image =
+      absl::make_unique<ImageFrame>(ImageFormat::SRGBA, kWidth, kHeight);
+  cv::Mat mat = mediapipe::formats::MatView(input_image.get());
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      mat.at<cv::Vec4b>(y, x) = cv::Vec4b(y * 100, x * 20, 255, 7);
+    }
+  }
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input_image", Adopt(input_image.release()).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_THAT(output_packets.size(), Eq(1));
+
+  const Tensor& tensor = output_packets[0].Get<std::vector<Tensor>>()[0];
+  EXPECT_EQ(tensor.shape().dims, std::vector<int>({1, kHeight, kWidth, 3}));
+  auto view = tensor.GetCpuReadView();
+  const float* data = view.buffer<float>();
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      const float* pixel = data + (y * kWidth + x) * 3;
+      // Rows are flipped, and values mapped from [0, 255] to [-1, 1].
+      EXPECT_FLOAT_EQ(pixel[0], (kHeight - 1 - y) * 100 * 2.0f / 255 - 1);
+      EXPECT_FLOAT_EQ(pixel[1], x * 20 * 2.0f / 255 - 1);
+      EXPECT_FLOAT_EQ(pixel[2], 1.0f);
+    }
+  }
+
+  MP_ASSERT_OK(graph.CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 }  // namespace mediapipe
@@ -0,0 +1,174 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/tensor_element_utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+namespace {
+
+uint32_t FloatBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+float BitsToFloat(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+template <typename T>
+void Dequantize(const T* src, int size,
+                const Tensor::QuantizationParameters& params, float* dst) {
+  for (int i = 0; i < size; ++i) {
+    dst[i] = params.scale * (static_cast<int>(src[i]) - params.zero_point);
+  }
+}
+
+}  // namespace
+
+float HalfToFloat(uint16_t half) {
+  const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1f;
+  uint32_t mantissa = half & 0x3ff;
+  if (exponent == 0x1f) {
+    // Infinity or NaN.
+    return BitsToFloat(sign | 0x7f800000 | (mantissa << 13));
+  }
+  if (exponent != 0) {
+    // Rebiases the exponent from 15 to 127.
+    return BitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+  }
+  if (mantissa == 0) {
+    return BitsToFloat(sign);
+  }
+  // Subnormal halves are normal floats.
+  uint32_t float_exponent = 113;
+  while ((mantissa & 0x400) == 0) {
+    mantissa <<= 1;
+    --float_exponent;
+  }
+  return BitsToFloat(sign | (float_exponent << 23) |
+                     ((mantissa & 0x3ff) << 13));
+}
+
+uint16_t FloatToHalf(float value) {
+  const uint32_t bits = FloatBits(value);
+  const uint16_t sign = (bits >> 16) & 0x8000;
+  const uint32_t abs_bits = bits & 0x7fffffff;
+  if (abs_bits >= 0x7f800000) {
+    // Infinity, or a quiet NaN.
+    return sign | 0x7c00 | (abs_bits > 0x7f800000 ? 0x200 : 0);
+  }
+  if (abs_bits >= 0x477ff000) {
+    // Rounds beyond the largest half, 65504.
+    return sign | 0x7c00;
+  }
+  if (abs_bits < 0x38800000) {
+    // Below the smallest normal half, 2^-14. Adding 0.5 rounds the value to a
+    // multiple of 2^-24, the half subnormal step, in the low mantissa bits.
+    const float rounded = BitsToFloat(abs_bits) + 0.5f;
+    return sign | static_cast<uint16_t>(FloatBits(rounded) - 0x3f000000);
+  }
+  // Rebiases the exponent and rounds the mantissa to 10 bits, to nearest even.
+  // A mantissa carry correctly increments the exponent.
+  const uint32_t odd = (abs_bits >> 13) & 1;
+  return sign | static_cast<uint16_t>((abs_bits + 0xc8000fff + odd) >> 13);
+}
+
+void FloatsToHalves(const float* src, int size, uint16_t* dst) {
+  for (int i = 0; i < size; ++i) {
+    dst[i] = FloatToHalf(src[i]);
+  }
+}
+
+bool IsConvertibleToFloat(Tensor::ElementType element_type) {
+  switch (element_type) {
+    case Tensor::ElementType::kFloat16:
+    case Tensor::ElementType::kFloat32:
+    case Tensor::ElementType::kUInt8:
+    case Tensor::ElementType::kInt8:
+    case Tensor::ElementType::kInt32:
+    case Tensor::ElementType::kBool:
+      return true;
+    default:
+      return false;
+  }
+}
+
+absl::Status ConvertTensorElementsToFloats(const Tensor& tensor,
+                                           const void* data, int size,
+                                           float* dst) {
+  const Tensor::QuantizationParameters& params =
+      tensor.quantization_parameters();
+  switch (tensor.element_type()) {
+    case Tensor::ElementType::kFloat16: {
+      const uint16_t* src = static_cast<const uint16_t*>(data);
+      for (int i = 0; i < size; ++i) {
+        dst[i] = HalfToFloat(src[i]);
+      }
+      return absl::OkStatus();
+    }
+    case Tensor::ElementType::kFloat32:
+      std::copy_n(static_cast<const float*>(data), size, dst);
+      return absl::OkStatus();
+    case Tensor::ElementType::kUInt8:
+      Dequantize(static_cast<const uint8_t*>(data), size, params, dst);
+      return absl::OkStatus();
+    case Tensor::ElementType::kInt8:
+      Dequantize(static_cast<const int8_t*>(data), size, params, dst);
+      return absl::OkStatus();
+    case Tensor::ElementType::kBool:
+      Dequantize(static_cast<const bool*>(data), size, params, dst);
+      return absl::OkStatus();
+    case Tensor::ElementType::kInt32: {
+      const int32_t* src = static_cast<const int32_t*>(data);
+      std::transform(src, src + size, dst,
+                     [](int32_t value) { return static_cast<float>(value); });
+      return absl::OkStatus();
+    }
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported tensor element type: ",
+                       static_cast<int>(tensor.element_type())));
+  }
+}
+
+absl::StatusOr<const float*> GetTensorFloatData(
+    const Tensor& tensor, const Tensor::CpuReadView& view,
+    std::vector<float>& storage) {
+  if (tensor.element_type() == Tensor::ElementType::kFloat32) {
+    return view.buffer<float>();
+  }
+  const int size = tensor.shape().num_elements();
+  storage.resize(size);
+  MP_RETURN_IF_ERROR(ConvertTensorElementsToFloats(
+      tensor, view.buffer<void>(), size, storage.data()));
+  return storage.data();
+}
+
+}  // namespace mediapipe
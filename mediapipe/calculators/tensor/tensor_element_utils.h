@@ -0,0 +1,62 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_TENSOR_ELEMENT_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_TENSOR_ELEMENT_UTILS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/formats/tensor.h"
+
+namespace mediapipe {
+
+// Converts an IEEE 754 half precision value, as stored in kFloat16 tensors,
+// to float.
+float HalfToFloat(uint16_t half);
+
+// Converts @value to half precision, rounding to the nearest even value.
+// Values beyond the half range become infinities.
+uint16_t FloatToHalf(float value);
+
+// Converts @size floats from @src to half precision into @dst.
+void FloatsToHalves(const float* src, int size, uint16_t* dst);
+
+// Returns whether the elements of tensors of @element_type can be read as
+// floats by ConvertTensorElementsToFloats and GetTensorFloatData.
+bool IsConvertibleToFloat(Tensor::ElementType element_type);
+
+// Converts the @size elements at @data, which are of @tensor's element type,
+// to floats into @dst. Half precision values are widened, kUInt8 and kInt8
+// values are dequantized with @tensor's quantization parameters, and kInt32
+// and kBool values are cast.
+absl::Status ConvertTensorElementsToFloats(const Tensor& tensor,
+                                           const void* data, int size,
+                                           float* dst);
+
+// Returns the elements of @tensor as floats, given a CPU read view of it.
+// For kFloat32 tensors this points into the view, without copying; for other
+// types the elements are converted into @storage, which must outlive the use
+// of the result. This lets post-processing calculators consume reduced
+// precision and quantized model outputs without an extra dequantization
+// calculator and tensor.
+absl::StatusOr<const float*> GetTensorFloatData(
+    const Tensor& tensor, const Tensor::CpuReadView& view,
+    std::vector<float>& storage);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_TENSOR_ELEMENT_UTILS_H_
@@ -0,0 +1,126 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/tensor_element_utils.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(TensorElementUtilsTest, ConvertsHalfToFloat) {
+  EXPECT_EQ(HalfToFloat(0x0000), 0.0f);
+  EXPECT_EQ(HalfToFloat(0x3c00), 1.0f);
+  EXPECT_EQ(HalfToFloat(0xc000), -2.0f);
+  EXPECT_EQ(HalfToFloat(0x7bff), 65504.0f);
+  EXPECT_EQ(HalfToFloat(0x0001), std::ldexp(1.0f, -24));
+  EXPECT_EQ(HalfToFloat(0x0200), std::ldexp(1.0f, -15));
+  EXPECT_EQ(HalfToFloat(0x7c00), std::numeric_limits<float>::infinity());
+  EXPECT_TRUE(std::isnan(HalfToFloat(0x7e00)));
+}
+
+TEST(TensorElementUtilsTest, ConvertsFloatToHalf) {
+  EXPECT_EQ(FloatToHalf(0.0f), 0x0000);
+  EXPECT_EQ(FloatToHalf(-0.0f), 0x8000);
+  EXPECT_EQ(FloatToHalf(1.0f), 0x3c00);
+  EXPECT_EQ(FloatToHalf(-2.0f), 0xc000);
+  EXPECT_EQ(FloatToHalf(65504.0f), 0x7bff);
+  EXPECT_EQ(FloatToHalf(65520.0f), 0x7c00);
+  EXPECT_EQ(FloatToHalf(std::ldexp(1.0f, -24)), 0x0001);
+  EXPECT_EQ(FloatToHalf(1e-9f), 0x0000);
+  EXPECT_EQ(FloatToHalf(std::numeric_limits<float>::infinity()), 0x7c00);
+  EXPECT_EQ(FloatToHalf(std::nanf("")) & 0x7e00, 0x7e00);
+  // Ties round to even.
+  EXPECT_EQ(FloatToHalf(1.0f + std::ldexp(1.0f, -11)), 0x3c00);
+  EXPECT_EQ(FloatToHalf(1.0f + 3 * std::ldexp(1.0f, -11)), 0x3c02);
+  EXPECT_EQ(FloatToHalf(1.5f * std::ldexp(1.0f, -24)), 0x0002);
+}
+
+TEST(TensorElementUtilsTest, RoundTripsAllHalves) {
+  for (uint32_t half = 0; half < 0x10000; ++half) {
+    const bool is_nan = (half & 0x7c00) == 0x7c00 && (half & 0x3ff) != 0;
+    if (is_nan) continue;
+    EXPECT_EQ(FloatToHalf(HalfToFloat(half)), half);
+  }
+}
+
+TEST(TensorElementUtilsTest, ReadsFloat32WithoutCopy) {
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape{2});
+  {
+    auto view = tensor.GetCpuWriteView();
+    view.buffer<float>()[0] = 1.5f;
+    view.buffer<float>()[1] = -3.0f;
+  }
+  auto view = tensor.GetCpuReadView();
+  std::vector<float> storage;
+  MP_ASSERT_OK_AND_ASSIGN(const float* data,
+                          GetTensorFloatData(tensor, view, storage));
+  EXPECT_EQ(data, view.buffer<float>());
+  EXPECT_TRUE(storage.empty());
+}
+
+TEST(TensorElementUtilsTest, ReadsFloat16) {
+  Tensor tensor(Tensor::ElementType::kFloat16, Tensor::Shape{3});
+  {
+    auto view = tensor.GetCpuWriteView();
+    FloatsToHalves(std::vector<float>{0.25f, -1.0f, 1024.0f}.data(), 3,
+                   view.buffer<uint16_t>());
+  }
+  auto view = tensor.GetCpuReadView();
+  std::vector<float> storage;
+  MP_ASSERT_OK_AND_ASSIGN(const float* data,
+                          GetTensorFloatData(tensor, view, storage));
+  EXPECT_THAT(std::vector<float>(data, data + 3),
+              ElementsAre(0.25f, -1.0f, 1024.0f));
+}
+
+TEST(TensorElementUtilsTest, DequantizesInt8) {
+  Tensor tensor(Tensor::ElementType::kInt8, Tensor::Shape{3},
+                Tensor::QuantizationParameters(0.5f, -2));
+  {
+    auto view = tensor.GetCpuWriteView();
+    int8_t* buffer = view.buffer<int8_t>();
+    buffer[0] = -2;
+    buffer[1] = 0;
+    buffer[2] = 127;
+  }
+  auto view = tensor.GetCpuReadView();
+  std::vector<float> storage;
+  MP_ASSERT_OK_AND_ASSIGN(const float* data,
+                          GetTensorFloatData(tensor, view, storage));
+  EXPECT_THAT(std::vector<float>(data, data + 3),
+              ElementsAre(0.0f, 1.0f, 64.5f));
+}
+
+TEST(TensorElementUtilsTest, FailsOnUnsupportedType) {
+  Tensor tensor(Tensor::ElementType::kChar, Tensor::Shape{1});
+  EXPECT_FALSE(IsConvertibleToFloat(tensor.element_type()));
+  { tensor.GetCpuWriteView().buffer<char>()[0] = 'a'; }
+  auto view = tensor.GetCpuReadView();
+  std::vector<float> storage;
+  EXPECT_FALSE(GetTensorFloatData(tensor, view, storage).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -17,6 +17,7 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/tensor/tensor_element_utils.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator_context.h"
@@ -26,31 +27,17 @@
 
 namespace mediapipe {
 namespace api2 {
-namespace {
-
-template <typename T>
-void Dequantize(const Tensor& input, Tensor* output) {
-  auto input_view = input.GetCpuReadView();
-  auto input_buffer = input_view.buffer<T>();
-  auto output_view = output->GetCpuWriteView();
-  auto output_buffer = output_view.buffer<float>();
-  for (int i = 0; i < input.shape().num_elements(); ++i) {
-    output_buffer[i] = input.quantization_parameters().scale *
-                       (static_cast<int>(input_buffer[i]) -
-                        input.quantization_parameters().zero_point);
-  }
-}
-
-}  // namespace
-
 // Performs dequantization using the quantization parameters from the input
 // UInt8 or Int8 tensors. Each element of the input tensors is converted using:
 //
 //   output = quantization_parameters.scale *
 //     (input - quantization_parameters.zero_point)
 //
+// Float16 input tensors are widened to float.
+//
 // Input:
-//  TENSORS - Vector of quantized Tensors of type kUint8 or kInt8.
+//  TENSORS - Vector of quantized Tensors of type kUint8 or kInt8, or of
+//    Tensors of type kFloat16.
 // Output:
 //  TENSORS - Vector of dequantized Tensors of type kFloat32.
 //
@@ -81,19 +68,20 @@ absl::Status TensorsDequantizationCalculator::Process(CalculatorContext* cc) {
     output_tensors->emplace_back(Tensor::ElementType::kFloat32,
                                  input_tensor.shape());
     switch (input_tensor.element_type()) {
+      case Tensor::ElementType::kFloat16:
       case Tensor::ElementType::kUInt8:
-        Dequantize<uint8>(input_tensor, &output_tensors->back());
-        break;
       case Tensor::ElementType::kInt8:
-        Dequantize<int8>(input_tensor, &output_tensors->back());
-        break;
       case Tensor::ElementType::kBool:
-        Dequantize<bool>(input_tensor, &output_tensors->back());
         break;
       default:
         return absl::InvalidArgumentError(absl::StrCat(
             "Unsupported input tensor type: ", input_tensor.element_type()));
     }
+    auto input_view = input_tensor.GetCpuReadView();
+    auto output_view = output_tensors->back().GetCpuWriteView();
+    MP_RETURN_IF_ERROR(ConvertTensorElementsToFloats(
+        input_tensor, input_view.buffer<void>(),
+        input_tensor.shape().num_elements(), output_view.buffer<float>()));
   }
   kOutTensors(cc).Send(std::move(output_tensors));
   return absl::OkStatus();
@@ -134,5 +134,15 @@ TEST_F(TensorsDequantizationCalculatorTest, SucceedsWithBoolTensors) {
   ValidateResult(GetOutput(), {1, 0, 1});
 }
 
+TEST_F(TensorsDequantizationCalculatorTest, SucceedsWithFloat16Tensors) {
+  // 0.5, -2 and 65504 in half precision.
+  std::vector<uint16_t> tensor = {0x3800, 0xc000, 0x7bff};
+  PushTensor(Tensor::ElementType::kFloat16, tensor);
+
+  MP_ASSERT_OK(runner_.Run());
+
+  ValidateResult(GetOutput(), {0.5, -2, 65504});
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -13,81 +13,31 @@
 // limitations under the License.
 
 #include <algorithm>
-#include <cmath>
-#include <cstring>
-#include <new>
+#include <memory>
 #include <utility>
 #include <vector>
 
-#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
-#include "audio/dsp/window_functions.h"
+#include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/stft_utils.h"
 #include "mediapipe/calculators/tensor/tensors_to_audio_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/ret_check.h"
-#include "pffft.h"
 
 namespace mediapipe {
 namespace api2 {
-namespace {
-
-std::vector<float> HannWindow(int window_size, bool sqrt_hann) {
-  std::vector<float> hann_window(window_size);
-  audio_dsp::HannWindow().GetPeriodicSamples(window_size, &hann_window);
-  if (sqrt_hann) {
-    absl::c_transform(hann_window, hann_window.begin(),
-                      [](double x) { return std::sqrt(x); });
-  }
-  return hann_window;
-}
-
-// Note that the InvHannWindow function may only work for 50% overlapping case.
-std::vector<float> InvHannWindow(int window_size, bool sqrt_hann) {
-  std::vector<float> window = HannWindow(window_size, sqrt_hann);
-  std::vector<float> inv_window(window.size());
-  if (sqrt_hann) {
-    absl::c_copy(window, inv_window.begin());
-  } else {
-    const int kHalfWindowSize = window.size() / 2;
-    absl::c_transform(window, inv_window.begin(),
-                      [](double x) { return x * x; });
-    for (int i = 0; i < kHalfWindowSize; ++i) {
-      double sum = inv_window[i] + inv_window[kHalfWindowSize + i];
-      inv_window[i] = window[i] / sum;
-      inv_window[kHalfWindowSize + i] = window[kHalfWindowSize + i] / sum;
-    }
-  }
-  return inv_window;
-}
-
-// PFFFT only supports transforms for inputs of length N of the form
-// N = (2^a)*(3^b)*(5^c) where b >=0 and c >= 0 and a >= 5 for the real FFT.
-bool IsValidFftSize(int size) {
-  if (size <= 0) {
-    return false;
-  }
-  constexpr int kFactors[] = {2, 3, 5};
-  int factorization[] = {0, 0, 0};
-  int n = static_cast<int>(size);
-  for (int i = 0; i < 3; ++i) {
-    while (n % kFactors[i] == 0) {
-      n = n / kFactors[i];
-      ++factorization[i];
-    }
-  }
-  return factorization[0] >= 5 && n == 1;
-}
-
-}  // namespace
 
 // Converts 2D MediaPipe float Tensors to audio buffers.
 // The calculator will perform ifft on the complex DFT and apply the window
 // function (Inverse Hann) afterwards. The input 2D MediaPipe Tensor must
 // have the DFT real parts in its first row and the DFT imagery parts in its
 // second row. A valid "fft_size" must be set in the CalculatorOptions.
+// If "num_overlapping_samples" is set, consecutive frames are overlap-added and
+// only the samples that no next frame overlaps are output, so that the output
+// stream is the reconstructed audio signal.
 //
 // Inputs:
 //   TENSORS - std::vector<Tensor>
@@ -122,19 +72,14 @@ class TensorsToAudioCalculator : public Node {
 
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
-  absl::Status Close(CalculatorContext* cc) override;
 
  private:
-  // The internal state of the FFT library.
-  PFFFT_Setup* fft_state_ = nullptr;
   int fft_size_ = 0;
-  float inverse_fft_size_ = 0;
-  std::vector<float, Eigen::aligned_allocator<float>> input_dft_;
-  std::vector<float> inv_fft_window_;
-  std::vector<float, Eigen::aligned_allocator<float>> fft_input_buffer_;
-  // pffft requires memory to work with to avoid using the stack.
-  std::vector<float, Eigen::aligned_allocator<float>> fft_workplace_;
-  std::vector<float, Eigen::aligned_allocator<float>> fft_output_;
+  // The number of samples between the starts of consecutive frames.
+  int frame_step_ = 0;
+  std::unique_ptr<WindowedRealFft> fft_;
+  // Set if the frames are overlap-added.
+  std::unique_ptr<OverlapAdder> overlap_adder_;
 };
 
 absl::Status TensorsToAudioCalculator::Open(CalculatorContext* cc) {
@@ -145,14 +90,20 @@ absl::Status TensorsToAudioCalculator::Open(CalculatorContext* cc) {
       << "FFT size must be of the form fft_size = (2^a)*(3^b)*(5^c) where b "
          ">=0 and c >= 0 and a >= 5, the requested fft size is "
       << options.fft_size();
+  RET_CHECK(options.num_overlapping_samples() >= 0 &&
+            options.num_overlapping_samples() < options.fft_size())
+      << "The number of overlapping samples must be in [0, fft_size).";
   fft_size_ = options.fft_size();
-  inverse_fft_size_ = 1.0f / fft_size_;
-  fft_state_ = pffft_new_setup(fft_size_, PFFFT_REAL);
-  input_dft_.resize(fft_size_);
-  inv_fft_window_ = InvHannWindow(fft_size_, /* sqrt_hann = */ false);
-  fft_input_buffer_.resize(fft_size_);
-  fft_workplace_.resize(fft_size_);
-  fft_output_.resize(fft_size_);
+  // Without overlap-add, the inverse window assumes a 50% overlap.
+  frame_step_ = options.num_overlapping_samples() > 0
+                    ? fft_size_ - options.num_overlapping_samples()
+                    : fft_size_ / 2;
+  fft_ = std::make_unique<WindowedRealFft>(
+      fft_size_,
+      InvHannWindow(fft_size_, frame_step_, /* sqrt_hann = */ false));
+  if (options.num_overlapping_samples() > 0) {
+    overlap_adder_ = std::make_unique<OverlapAdder>(fft_size_, frame_step_);
+  }
   return absl::OkStatus();
 }
 
@@ -164,30 +115,23 @@ absl::Status TensorsToAudioCalculator::Process(CalculatorContext* cc) {
   RET_CHECK_EQ(input_tensors.size(), 1);
   RET_CHECK(input_tensors[0].element_type() == Tensor::ElementType::kFloat32);
   auto view = input_tensors[0].GetCpuReadView();
+  absl::Span<float> input_dft = fft_->inverse_input();
   // DC's real part.
-  input_dft_[0] = kDcAndNyquistIn(cc)->first;
+  input_dft[0] = kDcAndNyquistIn(cc)->first;
   // Nyquist's real part is the penultimate element of the tensor buffer.
   // pffft ignores the Nyquist's imagery part. No need to fetch the last value
   // from the tensor buffer.
-  input_dft_[1] = *(view.buffer<float>() + (fft_size_ - 2));
-  std::memcpy(input_dft_.data() + 2, view.buffer<float>(),
-              (fft_size_ - 2) * sizeof(float));
-  pffft_transform_ordered(fft_state_, input_dft_.data(), fft_output_.data(),
-                          fft_workplace_.data(), PFFFT_BACKWARD);
-  // Applies the inverse window function.
-  std::transform(
-      fft_output_.begin(), fft_output_.end(), inv_fft_window_.begin(),
-      fft_output_.begin(),
-      [this](float a, float b) { return a * b * inverse_fft_size_; });
-  Matrix matrix = Eigen::Map<Matrix>(fft_output_.data(), 1, fft_output_.size());
-  kAudioOut(cc).Send(std::move(matrix));
-  return absl::OkStatus();
-}
-
-absl::Status TensorsToAudioCalculator::Close(CalculatorContext* cc) {
-  if (fft_state_) {
-    pffft_destroy_setup(fft_state_);
+  input_dft[1] = *(view.buffer<float>() + (fft_size_ - 2));
+  std::copy_n(view.buffer<float>(), fft_size_ - 2, input_dft.begin() + 2);
+  // Applies the inverse window function along with the inverse FFT.
+  absl::Span<const float> frame = fft_->Inverse();
+  Matrix matrix(1, overlap_adder_ ? frame_step_ : fft_size_);
+  if (overlap_adder_) {
+    overlap_adder_->Add(frame.data(), matrix.data());
+  } else {
+    std::copy(frame.begin(), frame.end(), matrix.data());
   }
+  kAudioOut(cc).Send(std::move(matrix));
   return absl::OkStatus();
 }
 
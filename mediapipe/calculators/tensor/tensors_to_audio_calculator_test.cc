@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <cmath>
 #include <new>
 #include <string>
 #include <vector>
@@ -40,7 +41,8 @@ class TensorsToAudioCalculatorFftTest : public ::testing::Test {
     return impulse;
   }
 
-  void ConfigGraph(int num_samples, double sample_rate, int fft_size) {
+  void ConfigGraph(int num_samples, double sample_rate, int fft_size,
+                   int num_overlapping_samples = 0) {
     graph_config_ = ParseTextProtoOrDie<CalculatorGraphConfig>(
         absl::Substitute(R"(
         input_stream: "audio_in"
@@ -56,7 +58,7 @@ class TensorsToAudioCalculatorFftTest : public ::testing::Test {
             [mediapipe.AudioToTensorCalculatorOptions.ext] {
               num_channels: 1
               num_samples: $0
-              num_overlapping_samples: 0
+              num_overlapping_samples: $3
               target_sample_rate: $1
               fft_size: $2
             }
@@ -70,13 +72,15 @@ class TensorsToAudioCalculatorFftTest : public ::testing::Test {
           options {
             [mediapipe.TensorsToAudioCalculatorOptions.ext] {
               fft_size: $2
+              num_overlapping_samples: $3
             }
           }
         }
         )",
                          /*$0=*/num_samples,
                          /*$1=*/sample_rate,
-                         /*$2=*/fft_size));
+                         /*$2=*/fft_size,
+                         /*$3=*/num_overlapping_samples));
     tool::AddVectorSink("audio_out", &graph_config_, &audio_out_packets_);
   }
 
@@ -145,5 +149,31 @@ TEST_F(TensorsToAudioCalculatorFftTest, TestImpulseSignalAtBeginning) {
   EXPECT_EQ(audio_out_packets_[0].Get<Matrix>(), Matrix::Zero(1, sample_size));
 }
 
+TEST_F(TensorsToAudioCalculatorFftTest, TestOverlapAddReconstructsSignal) {
+  constexpr int sample_size = 320;
+  constexpr int num_overlapping_samples = 240;
+  constexpr int frame_step = sample_size - num_overlapping_samples;
+  constexpr double sample_rate = 16000;
+  ConfigGraph(sample_size, sample_rate, 320, num_overlapping_samples);
+  Matrix signal(1, sample_size * 4);
+  for (int i = 0; i < signal.cols(); ++i) {
+    signal(0, i) = std::sin(0.01 * i) + 0.5 * std::cos(0.3 * i);
+  }
+  RunGraph(signal, sample_rate);
+  ASSERT_FALSE(audio_out_packets_.empty());
+  std::vector<float> output;
+  for (const Packet& packet : audio_out_packets_) {
+    const Matrix& matrix = packet.Get<Matrix>();
+    ASSERT_EQ(matrix.cols(), frame_step);
+    output.insert(output.end(), matrix.data(), matrix.data() + matrix.size());
+  }
+  // The samples of the first frame miss the overlapping frames that would
+  // start before the signal, and the last frames are zero-padded.
+  ASSERT_GE(output.size(), signal.cols() - sample_size);
+  for (int i = sample_size; i < signal.cols() - sample_size; ++i) {
+    EXPECT_NEAR(output[i], signal(0, i), 1e-4) << i;
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_format.h"
@@ -25,6 +26,7 @@
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/label_map.pb.h"
+#include "mediapipe/util/label_map_table.h"
 #include "mediapipe/util/resource_util.h"
 #if defined(MEDIAPIPE_MOBILE)
 #include "mediapipe/util/android/file/base/file.h"
@@ -37,12 +39,10 @@ namespace mediapipe {
 namespace api2 {
 namespace {
 
-void SetClassificationLabel(const LabelMapItem label_map_item,
-                            Classification* classification) {
-  classification->set_label(label_map_item.name());
-  if (label_map_item.has_display_name()) {
-    classification->set_display_name(label_map_item.display_name());
-  }
+// Orders (score, index) pairs by descending score, then ascending index.
+bool HasHigherScore(const std::pair<float, int>& a,
+                    const std::pair<float, int>& b) {
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
 }
 
 }  // namespace
@@ -53,10 +53,17 @@ void SetClassificationLabel(const LabelMapItem label_map_item,
 // Input:
 //  TENSORS - Vector of Tensors of type kFloat32 containing one
 //            tensor, the size of which must be (1, * num_classes).
+// Input side packet:
+//  LABEL_MAP (optional) - LabelMapTablePtr to use instead of a label map in the
+//                         options, e.g. the one output by another calculator.
 // Output:
 //  CLASSIFICATIONS - Result MediaPipe ClassificationList. The score and index
 //                    fields of each classification are set, while the label
-//                    field is only set if label_map_path is provided.
+//                    field is only set if a label map is provided, and
+//                    omit_labels is not set.
+// Output side packet:
+//  LABEL_MAP (optional) - The LabelMapTablePtr in use, from which the labels
+//                         can be looked up later when omit_labels is set.
 //
 // Usage example:
 // node {
@@ -75,8 +82,14 @@ class TensorsToClassificationCalculator : public Node {
   static constexpr Input<std::vector<Tensor>> kInTensors{"TENSORS"};
   static constexpr Output<ClassificationList> kOutClassificationList{
       "CLASSIFICATIONS"};
-  MEDIAPIPE_NODE_CONTRACT(kInTensors, kOutClassificationList);
+  static constexpr SideInput<LabelMapTablePtr>::Optional kSideInLabelMap{
+      "LABEL_MAP"};
+  static constexpr SideOutput<LabelMapTablePtr>::Optional kSideOutLabelMap{
+      "LABEL_MAP"};
+  MEDIAPIPE_NODE_CONTRACT(kInTensors, kOutClassificationList, kSideInLabelMap,
+                          kSideOutLabelMap);
 
+  static absl::Status UpdateContract(CalculatorContract* cc);
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
   absl::Status Close(CalculatorContext* cc) override;
@@ -84,8 +97,9 @@ class TensorsToClassificationCalculator : public Node {
  private:
   int top_k_ = 0;
   bool sort_by_descending_score_ = false;
-  proto_ns::Map<int64, LabelMapItem> local_label_map_;
-  bool label_map_loaded_ = false;
+  // The label map, shared with the calculators using the same one.
+  LabelMapTablePtr label_map_;
+  bool omit_labels_ = false;
   bool is_binary_classification_ = false;
   float min_score_threshold_ = std::numeric_limits<float>::lowest();
 
@@ -98,16 +112,28 @@ class TensorsToClassificationCalculator : public Node {
   // These are used to filter out the output classification results.
   ClassIndexSet class_index_set_;
   bool IsClassIndexAllowed(int class_index);
-  const proto_ns::Map<int64, LabelMapItem>& GetLabelMap(CalculatorContext* cc);
 };
 MEDIAPIPE_REGISTER_NODE(TensorsToClassificationCalculator);
 
+absl::Status TensorsToClassificationCalculator::UpdateContract(
+    CalculatorContract* cc) {
+  cc->SetStateless(true);
+  return absl::OkStatus();
+}
+
 absl::Status TensorsToClassificationCalculator::Open(CalculatorContext* cc) {
   const auto& options = cc->Options<TensorsToClassificationCalculatorOptions>();
 
   top_k_ = options.top_k();
   sort_by_descending_score_ = options.sort_by_descending_score();
-  if (options.has_label_map_path()) {
+  proto_ns::Map<int64, LabelMapItem> local_label_map;
+  if (kSideInLabelMap(cc).IsConnected()) {
+    RET_CHECK(!options.has_label_map_path() && options.label_items().empty() &&
+              !options.has_label_map())
+        << "The LABEL_MAP side packet replaces the label map of the options.";
+    label_map_ = *kSideInLabelMap(cc);
+    RET_CHECK(label_map_ != nullptr);
+  } else if (options.has_label_map_path()) {
     std::string string_path;
     ASSIGN_OR_RETURN(string_path,
                      PathToResourceAsFile(options.label_map_path()));
@@ -121,22 +147,26 @@ absl::Status TensorsToClassificationCalculator::Open(CalculatorContext* cc) {
     while (std::getline(stream, line)) {
       LabelMapItem item;
       item.set_name(line);
-      local_label_map_[i++] = item;
+      local_label_map[i++] = item;
     }
-    label_map_loaded_ = true;
+    label_map_ = InternLabelMapTable(local_label_map);
   } else if (!options.label_items().empty()) {
-    label_map_loaded_ = true;
+    label_map_ = InternLabelMapTable(options.label_items());
   } else if (options.has_label_map()) {
     for (int i = 0; i < options.label_map().entries_size(); ++i) {
       const auto& entry = options.label_map().entries(i);
-      RET_CHECK(!local_label_map_.contains(entry.id()))
+      RET_CHECK(!local_label_map.contains(entry.id()))
           << "Duplicate id found: " << entry.id();
       LabelMapItem item;
       item.set_name(entry.label());
-      local_label_map_[entry.id()] = item;
+      local_label_map[entry.id()] = item;
     }
-    label_map_loaded_ = true;
+    label_map_ = InternLabelMapTable(local_label_map);
+  }
+  if (label_map_) {
+    kSideOutLabelMap(cc).Set(api2::MakePacket<LabelMapTablePtr>(label_map_));
   }
+  omit_labels_ = options.omit_labels();
   if (options.has_min_score_threshold()) {
     min_score_threshold_ = options.min_score_threshold();
   }
@@ -174,64 +204,52 @@ absl::Status TensorsToClassificationCalculator::Process(CalculatorContext* cc) {
     // Number of classes for binary classification.
     num_classes = 2;
   }
-  if (label_map_loaded_) {
-    RET_CHECK_EQ(num_classes, GetLabelMap(cc).size());
+  if (label_map_) {
+    RET_CHECK_EQ(num_classes, label_map_->size());
   }
   auto view = input_tensors[0].GetCpuReadView();
   auto raw_scores = view.buffer<float>();
 
-  auto classification_list = absl::make_unique<ClassificationList>();
+  // The classes are selected and ordered as (score, index) pairs, so that
+  // Classifications are only created for the classes output, which matters
+  // with thousands of classes and a small top_k.
+  std::vector<std::pair<float, int>> selected;
   if (is_binary_classification_) {
-    Classification* class_first = classification_list->add_classification();
-    Classification* class_second = classification_list->add_classification();
-    class_first->set_index(0);
-    class_second->set_index(1);
-    class_first->set_score(raw_scores[0]);
-    class_second->set_score(1. - raw_scores[0]);
-
-    if (label_map_loaded_) {
-      SetClassificationLabel(GetLabelMap(cc).at(0), class_first);
-      SetClassificationLabel(GetLabelMap(cc).at(1), class_second);
-    }
+    selected.emplace_back(raw_scores[0], 0);
+    selected.emplace_back(1. - raw_scores[0], 1);
   } else {
     for (int i = 0; i < num_classes; ++i) {
-      if (!IsClassIndexAllowed(i)) {
-        continue;
-      }
       if (raw_scores[i] < min_score_threshold_) {
         continue;
       }
-      Classification* classification =
-          classification_list->add_classification();
-      classification->set_index(i);
-      classification->set_score(raw_scores[i]);
-      if (label_map_loaded_) {
-        SetClassificationLabel(GetLabelMap(cc).at(i), classification);
+      if (!IsClassIndexAllowed(i)) {
+        continue;
       }
+      selected.emplace_back(raw_scores[i], i);
     }
   }
 
-  auto raw_classification_list = classification_list->mutable_classification();
   if (top_k_ > 0) {
-    int desired_size =
-        std::min(classification_list->classification_size(), top_k_);
-    std::partial_sort(raw_classification_list->begin(),
-                      raw_classification_list->begin() + desired_size,
-                      raw_classification_list->end(),
-                      [](const Classification a, const Classification b) {
-                        return a.score() > b.score();
-                      });
-
-    if (desired_size >= top_k_) {
-      // Resizes the underlying list to have only top_k_ classifications.
-      raw_classification_list->DeleteSubrange(
-          top_k_, raw_classification_list->size() - top_k_);
+    if (static_cast<int>(selected.size()) > top_k_) {
+      // Only the top_k_ classes are sorted.
+      std::nth_element(selected.begin(), selected.begin() + top_k_,
+                       selected.end(), HasHigherScore);
+      selected.resize(top_k_);
     }
+    std::sort(selected.begin(), selected.end(), HasHigherScore);
   } else if (sort_by_descending_score_) {
-    std::sort(raw_classification_list->begin(), raw_classification_list->end(),
-              [](const Classification a, const Classification b) {
-                return a.score() > b.score();
-              });
+    std::sort(selected.begin(), selected.end(), HasHigherScore);
+  }
+
+  auto classification_list = absl::make_unique<ClassificationList>();
+  classification_list->mutable_classification()->Reserve(selected.size());
+  for (const auto& [score, index] : selected) {
+    Classification* classification = classification_list->add_classification();
+    classification->set_index(index);
+    classification->set_score(score);
+  }
+  if (label_map_ && !omit_labels_) {
+    SetClassificationLabels(*label_map_, classification_list.get());
   }
   kOutClassificationList(cc).Send(std::move(classification_list));
   return absl::OkStatus();
@@ -252,13 +270,5 @@ bool TensorsToClassificationCalculator::IsClassIndexAllowed(int class_index) {
   }
 }
 
-const proto_ns::Map<int64, LabelMapItem>&
-TensorsToClassificationCalculator::GetLabelMap(CalculatorContext* cc) {
-  return !local_label_map_.empty()
-             ? local_label_map_
-             : cc->Options<TensorsToClassificationCalculatorOptions>()
-                   .label_items();
-}
-
 }  // namespace api2
 }  // namespace mediapipe
@@ -18,6 +18,7 @@
 
 #include "absl/memory/memory.h"
 #include "mediapipe/calculators/tensor/tensors_to_classification_calculator.pb.h"
+#include "mediapipe/framework/calculator_graph.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
@@ -26,6 +27,10 @@
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/subgraph.h"
+#include "mediapipe/framework/tool/sink.h"
+#include "mediapipe/util/label_map.pb.h"
+#include "mediapipe/util/label_map_table.h"
 
 namespace mediapipe {
 
@@ -208,6 +213,38 @@ TEST_F(TensorsToClassificationCalculatorTest, CorrectOutputWithTopK) {
   }
 }
 
+TEST_F(TensorsToClassificationCalculatorTest,
+       CorrectOutputWithTopKAndThreshold) {
+  mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToClassificationCalculator"
+    input_stream: "TENSORS:tensors"
+    output_stream: "CLASSIFICATIONS:classifications"
+    options {
+      [mediapipe.TensorsToClassificationCalculatorOptions.ext] {
+        top_k: 3
+        min_score_threshold: 0.2
+      }
+    }
+  )pb"));
+
+  BuildGraph(&runner, {0.3, 0.9, 0.1, 0.9, 0.5, 0.25});
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets_ = runner.Outputs().Tag("CLASSIFICATIONS").packets;
+
+  EXPECT_EQ(1, output_packets_.size());
+
+  const auto& classification_list =
+      output_packets_[0].Get<ClassificationList>();
+
+  // Verify that the top3 classes are output by descending score, with ties
+  // ordered by index.
+  ASSERT_EQ(3, classification_list.classification_size());
+  EXPECT_EQ(1, classification_list.classification(0).index());
+  EXPECT_EQ(3, classification_list.classification(1).index());
+  EXPECT_EQ(4, classification_list.classification(2).index());
+}
+
 TEST_F(TensorsToClassificationCalculatorTest,
        CorrectOutputWithSortByDescendingScore) {
   mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
@@ -323,4 +360,162 @@ TEST_F(TensorsToClassificationCalculatorTest,
   ASSERT_TRUE(classification_list.classification(1).has_label());
 }
 
+TEST_F(TensorsToClassificationCalculatorTest,
+       OmitsLabelsAndOutputsLabelMap) {
+  mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToClassificationCalculator"
+    input_stream: "TENSORS:tensors"
+    output_stream: "CLASSIFICATIONS:classifications"
+    output_side_packet: "LABEL_MAP:label_map"
+    options {
+      [mediapipe.TensorsToClassificationCalculatorOptions.ext] {
+        omit_labels: true
+        label_items {
+          key: 0
+          value { name: "ClassA" }
+        }
+        label_items {
+          key: 1
+          value { name: "ClassB" display_name: "B" }
+        }
+      }
+    }
+  )pb"));
+
+  BuildGraph(&runner, {0.5, 1});
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets_ = runner.Outputs().Tag("CLASSIFICATIONS").packets;
+  ASSERT_EQ(1, output_packets_.size());
+  const auto& classification_list =
+      output_packets_[0].Get<ClassificationList>();
+  ASSERT_EQ(2, classification_list.classification_size());
+  for (int i = 0; i < classification_list.classification_size(); ++i) {
+    EXPECT_EQ(i, classification_list.classification(i).index());
+    EXPECT_FALSE(classification_list.classification(i).has_label());
+  }
+
+  // The labels are looked up in the side packet instead.
+  const LabelMapTablePtr& label_map =
+      runner.OutputSidePackets().Tag("LABEL_MAP").Get<LabelMapTablePtr>();
+  ASSERT_NE(label_map, nullptr);
+  ASSERT_NE(label_map->Find(1), nullptr);
+  EXPECT_EQ(label_map->Find(1)->name, "ClassB");
+  EXPECT_EQ(label_map->Find(1)->display_name, "B");
+}
+
+TEST_F(TensorsToClassificationCalculatorTest, CorrectOutputWithLabelMapPacket) {
+  mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToClassificationCalculator"
+    input_stream: "TENSORS:tensors"
+    output_stream: "CLASSIFICATIONS:classifications"
+    input_side_packet: "LABEL_MAP:label_map"
+    options {
+      [mediapipe.TensorsToClassificationCalculatorOptions.ext] {}
+    }
+  )pb"));
+  proto_ns::Map<int64, LabelMapItem> label_map;
+  label_map[0].set_name("ClassA");
+  label_map[1].set_name("ClassB");
+  runner.MutableSidePackets()->Tag("LABEL_MAP") =
+      MakePacket<LabelMapTablePtr>(InternLabelMapTable(label_map));
+
+  BuildGraph(&runner, {0.5, 1});
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets_ = runner.Outputs().Tag("CLASSIFICATIONS").packets;
+  ASSERT_EQ(1, output_packets_.size());
+  const auto& classification_list =
+      output_packets_[0].Get<ClassificationList>();
+  ASSERT_EQ(2, classification_list.classification_size());
+  EXPECT_EQ("ClassA", classification_list.classification(0).label());
+  EXPECT_EQ("ClassB", classification_list.classification(1).label());
+}
+
+
+// Converts score tensors to both floats and the top classification.
+class TensorsToScoresSubgraph : public Subgraph {
+ public:
+  absl::StatusOr<CalculatorGraphConfig> GetConfig(
+      SubgraphContext* sc) override {
+    return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+      input_stream: "TENSORS:tensors"
+      output_stream: "FLOATS:floats"
+      output_stream: "CLASSIFICATIONS:classifications"
+      node {
+        calculator: "TensorsToFloatsCalculator"
+        input_stream: "TENSORS:tensors"
+        output_stream: "FLOATS:floats"
+      }
+      node {
+        calculator: "TensorsToClassificationCalculator"
+        input_stream: "TENSORS:tensors"
+        output_stream: "CLASSIFICATIONS:classifications"
+        options {
+          [mediapipe.TensorsToClassificationCalculatorOptions.ext] {
+            top_k: 1
+          }
+        }
+      }
+    )pb");
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(TensorsToScoresSubgraph);
+
+TEST(TensorsToClassificationReplicationTest, ReplicatedSubgraphKeepsOrder) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "tensors"
+    num_threads: 4
+    node {
+      calculator: "TensorsToScoresSubgraph"
+      input_stream: "TENSORS:tensors"
+      output_stream: "FLOATS:floats"
+      output_stream: "CLASSIFICATIONS:classifications"
+      replicas: 3
+    }
+  )pb");
+  std::vector<Packet> floats_packets;
+  std::vector<Packet> classifications_packets;
+  tool::AddVectorSink("floats", &config, &floats_packets);
+  tool::AddVectorSink("classifications", &config, &classifications_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  // The highest of the 3 scores moves with the timestamp.
+  constexpr int kNumPackets = 20;
+  for (int i = 0; i < kNumPackets; ++i) {
+    auto tensors = absl::make_unique<std::vector<Tensor>>();
+    tensors->emplace_back(Tensor::ElementType::kFloat32,
+                          Tensor::Shape{1, 1, 3, 1});
+    auto view = tensors->back().GetCpuWriteView();
+    float* scores = view.buffer<float>();
+    for (int j = 0; j < 3; ++j) {
+      scores[j] = j == i % 3 ? i : 0;
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensors", Adopt(tensors.release()).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(floats_packets.size(), kNumPackets);
+  ASSERT_EQ(classifications_packets.size(), kNumPackets);
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(floats_packets[i].Timestamp(), Timestamp(i));
+    const auto& floats = floats_packets[i].Get<std::vector<float>>();
+    ASSERT_EQ(floats.size(), 3);
+    EXPECT_EQ(floats[i % 3], i);
+
+    EXPECT_EQ(classifications_packets[i].Timestamp(), Timestamp(i));
+    const auto& classification_list =
+        classifications_packets[i].Get<ClassificationList>();
+    ASSERT_EQ(classification_list.classification_size(), 1);
+    EXPECT_EQ(classification_list.classification(0).score(), i);
+    if (i > 0) {
+      EXPECT_EQ(classification_list.classification(0).index(), i % 3);
+    }
+  }
+}
+
 }  // namespace mediapipe
@@ -12,18 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <functional>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/tensor_element_utils.h"
 #include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor_array.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -66,31 +71,43 @@ namespace api2 {
 namespace {
 
 void ConvertRawValuesToAnchors(const float* raw_anchors, int num_boxes,
-                               std::vector<Anchor>* anchors) {
-  anchors->clear();
+                               AnchorArray* anchors) {
+  *anchors = AnchorArray();
+  anchors->reserve(num_boxes);
   for (int i = 0; i < num_boxes; ++i) {
-    Anchor new_anchor;
-    new_anchor.set_y_center(raw_anchors[i * kNumCoordsPerBox + 0]);
-    new_anchor.set_x_center(raw_anchors[i * kNumCoordsPerBox + 1]);
-    new_anchor.set_h(raw_anchors[i * kNumCoordsPerBox + 2]);
-    new_anchor.set_w(raw_anchors[i * kNumCoordsPerBox + 3]);
-    anchors->push_back(new_anchor);
+    anchors->Append(raw_anchors[i * kNumCoordsPerBox + 0],
+                    raw_anchors[i * kNumCoordsPerBox + 1],
+                    raw_anchors[i * kNumCoordsPerBox + 2],
+                    raw_anchors[i * kNumCoordsPerBox + 3]);
   }
 }
 
-void ConvertAnchorsToRawValues(const std::vector<Anchor>& anchors,
-                               int num_boxes, float* raw_anchors) {
+void ConvertAnchorsToRawValues(const AnchorArray& anchors, int num_boxes,
+                               float* raw_anchors) {
   CHECK_EQ(anchors.size(), num_boxes);
-  int box = 0;
-  for (const auto& anchor : anchors) {
-    raw_anchors[box * kNumCoordsPerBox + 0] = anchor.y_center();
-    raw_anchors[box * kNumCoordsPerBox + 1] = anchor.x_center();
-    raw_anchors[box * kNumCoordsPerBox + 2] = anchor.h();
-    raw_anchors[box * kNumCoordsPerBox + 3] = anchor.w();
-    ++box;
+  for (int box = 0; box < num_boxes; ++box) {
+    raw_anchors[box * kNumCoordsPerBox + 0] = anchors.y_center[box];
+    raw_anchors[box * kNumCoordsPerBox + 1] = anchors.x_center[box];
+    raw_anchors[box * kNumCoordsPerBox + 2] = anchors.h[box];
+    raw_anchors[box * kNumCoordsPerBox + 3] = anchors.w[box];
   }
 }
 
+// Returns the intersection over union of two decoded boxes. The boxes start
+// with {ymin, xmin, ymax, xmax}.
+float IntersectionOverUnion(const float* box0, const float* box1) {
+  const float ymin = std::max(box0[0], box1[0]);
+  const float xmin = std::max(box0[1], box1[1]);
+  const float ymax = std::min(box0[2], box1[2]);
+  const float xmax = std::min(box0[3], box1[3]);
+  if (ymin >= ymax || xmin >= xmax) return 0.0f;
+  const float intersection = (ymax - ymin) * (xmax - xmin);
+  const float area0 = (box0[2] - box0[0]) * (box0[3] - box0[1]);
+  const float area1 = (box1[2] - box1[0]) * (box1[3] - box1[1]);
+  const float union_area = area0 + area1 - intersection;
+  return union_area > 0.0f ? intersection / union_area : 0.0f;
+}
+
 absl::Status CheckCustomTensorMapping(
     const TensorsToDetectionsCalculatorOptions::TensorMapping& tensor_mapping) {
   RET_CHECK(tensor_mapping.has_detections_tensor_index() &&
@@ -138,18 +155,27 @@ absl::Status CheckCustomTensorMapping(
 //            (num_boxes * num_classes). It's optional to pass in a third tensor
 //            for anchors (e.g. for SSD models) depend on the outputs of the
 //            detection model. The size of anchor tensor must be (num_boxes *
-//            4).
+//            4). On CPU, kFloat16 and quantized kUInt8 and kInt8 tensors are
+//            also accepted, and converted as they are read.
 //
 // Input side packet:
 //  ANCHORS (optional) - The anchors used for decoding the bounding boxes, as a
 //      vector of `Anchor` protos. Not required if post-processing is built-in
 //      the model.
+//  ANCHOR_ARRAY (optional) - The same anchors as an AnchorArray, e.g. the
+//      ANCHOR_ARRAY output of SsdAnchorsCalculator. Preferred over ANCHORS,
+//      as boxes are decoded from it without converting any protos.
 //  IGNORE_CLASSES (optional) - The list of class ids that should be ignored, as
 //      a vector of integers. It overrides the corresponding field in the
 //      calculator options.
 //
 // Output:
-//  DETECTIONS - Result MediaPipe detections.
+//  DETECTIONS (optional) - Result MediaPipe detections.
+//  DETECTION_BATCH (optional) - The same detections as a DetectionBatch, built
+//      without any Detection protos.
+//
+// If the `nms` option is set, overlapping detections are also suppressed, see
+// TensorsToDetectionsCalculatorOptions.NmsOptions.
 //
 // Usage example:
 // node {
@@ -175,11 +201,17 @@ class TensorsToDetectionsCalculator : public Node {
   static constexpr Input<std::vector<Tensor>> kInTensors{"TENSORS"};
   static constexpr SideInput<std::vector<Anchor>>::Optional kInAnchors{
       "ANCHORS"};
+  static constexpr SideInput<AnchorArray>::Optional kInAnchorArray{
+      "ANCHOR_ARRAY"};
   static constexpr SideInput<std::vector<int>>::Optional kSideInIgnoreClasses{
       "IGNORE_CLASSES"};
-  static constexpr Output<std::vector<Detection>> kOutDetections{"DETECTIONS"};
-  MEDIAPIPE_NODE_CONTRACT(kInTensors, kInAnchors, kSideInIgnoreClasses,
-                          kOutDetections);
+  static constexpr Output<std::vector<Detection>>::Optional kOutDetections{
+      "DETECTIONS"};
+  static constexpr Output<DetectionBatch>::Optional kOutDetectionBatch{
+      "DETECTION_BATCH"};
+  MEDIAPIPE_NODE_CONTRACT(kInTensors, kInAnchors, kInAnchorArray,
+                          kSideInIgnoreClasses, kOutDetections,
+                          kOutDetectionBatch);
   static absl::Status UpdateContract(CalculatorContract* cc);
 
   absl::Status Open(CalculatorContext* cc) override;
@@ -188,22 +220,32 @@ class TensorsToDetectionsCalculator : public Node {
 
  private:
   absl::Status ProcessCPU(CalculatorContext* cc,
-                          std::vector<Detection>* output_detections);
+                          DetectionBatch* output_detections);
   absl::Status ProcessGPU(CalculatorContext* cc,
-                          std::vector<Detection>* output_detections);
+                          DetectionBatch* output_detections);
 
   absl::Status LoadOptions(CalculatorContext* cc);
   absl::Status GpuInit(CalculatorContext* cc);
-  absl::Status DecodeBoxes(const float* raw_boxes,
-                           const std::vector<Anchor>& anchors,
-                           std::vector<float>* boxes);
+  // Sets anchors_ from the ANCHOR_ARRAY or ANCHORS side packet.
+  absl::Status LoadSideAnchors(CalculatorContext* cc);
+  absl::Status DecodeBoxes(const float* raw_boxes, std::vector<float>* boxes);
+  // Decodes the num_coords_ values of a single box with anchors_[anchor].
+  void DecodeBox(const float* raw_box, int anchor, float* box);
   absl::Status ConvertToDetections(const float* detection_boxes,
                                    const float* detection_scores,
                                    const int* detection_classes,
-                                   std::vector<Detection>* output_detections);
-  Detection ConvertToDetection(float box_ymin, float box_xmin, float box_ymax,
-                               float box_xmax, float score, int class_id,
-                               bool flip_vertically);
+                                   DetectionBatch* output_detections);
+  // Like ConvertToDetections(), but selects the boxes to decode by score,
+  // obtains them from "decode_box" and applies non-maximum suppression.
+  // "decode_box" writes the decoded num_coords_ values of the given box.
+  absl::Status ConvertToDetectionsWithNms(
+      const float* detection_scores, const int* detection_classes,
+      const std::function<void(int box_index, float* box)>& decode_box,
+      DetectionBatch* output_detections);
+  // Appends the detection of the num_coords_ decoded values of a box,
+  // keypoints included.
+  void AppendDecodedBox(const float* box, float score, int class_id,
+                        DetectionBatch* detections);
   bool IsClassIndexAllowed(int class_index);
 
   int num_classes_ = 0;
@@ -225,7 +267,7 @@ class TensorsToDetectionsCalculator : public Node {
   TensorsToDetectionsCalculatorOptions::TensorMapping tensor_mapping_;
   std::vector<int> box_indices_ = {0, 1, 2, 3};
   bool has_custom_box_indices_ = false;
-  std::vector<Anchor> anchors_;
+  AnchorArray anchors_;
 
 #ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
   mediapipe::GlCalculatorHelper gpu_helper_;
@@ -248,6 +290,8 @@ MEDIAPIPE_REGISTER_NODE(TensorsToDetectionsCalculator);
 
 absl::Status TensorsToDetectionsCalculator::UpdateContract(
     CalculatorContract* cc) {
+  // The anchors and GPU programs are only initialized once.
+  cc->SetStateless(true);
   if (CanUseGpu()) {
 #ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
     MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
@@ -275,7 +319,8 @@ absl::Status TensorsToDetectionsCalculator::Open(CalculatorContext* cc) {
 }
 
 absl::Status TensorsToDetectionsCalculator::Process(CalculatorContext* cc) {
-  auto output_detections = absl::make_unique<std::vector<Detection>>();
+  DetectionBatch output_detections;
+  output_detections.num_keypoints = options_.num_keypoints();
   bool gpu_processing = false;
   if (CanUseGpu()) {
     // Use GPU processing only if at least one input tensor is already on GPU
@@ -289,7 +334,9 @@ absl::Status TensorsToDetectionsCalculator::Process(CalculatorContext* cc) {
   }
   const auto& input_tensors = *kInTensors(cc);
   for (const auto& tensor : input_tensors) {
-    RET_CHECK(tensor.element_type() == Tensor::ElementType::kFloat32);
+    RET_CHECK(gpu_processing
+                  ? tensor.element_type() == Tensor::ElementType::kFloat32
+                  : IsConvertibleToFloat(tensor.element_type()));
   }
   const int num_input_tensors = input_tensors.size();
   if (!scores_tensor_index_is_set_) {
@@ -312,17 +359,22 @@ absl::Status TensorsToDetectionsCalculator::Process(CalculatorContext* cc) {
       MP_RETURN_IF_ERROR(GpuInit(cc));
       gpu_inited_ = true;
     }
-    MP_RETURN_IF_ERROR(ProcessGPU(cc, output_detections.get()));
+    MP_RETURN_IF_ERROR(ProcessGPU(cc, &output_detections));
   } else {
-    MP_RETURN_IF_ERROR(ProcessCPU(cc, output_detections.get()));
+    MP_RETURN_IF_ERROR(ProcessCPU(cc, &output_detections));
   }
 
-  kOutDetections(cc).Send(std::move(output_detections));
+  if (kOutDetections(cc).IsConnected()) {
+    kOutDetections(cc).Send(UnpackDetections(output_detections));
+  }
+  if (kOutDetectionBatch(cc).IsConnected()) {
+    kOutDetectionBatch(cc).Send(std::move(output_detections));
+  }
   return absl::OkStatus();
 }
 
 absl::Status TensorsToDetectionsCalculator::ProcessCPU(
-    CalculatorContext* cc, std::vector<Detection>* output_detections) {
+    CalculatorContext* cc, DetectionBatch* output_detections) {
   const auto& input_tensors = *kInTensors(cc);
 
   if (input_tensors.size() == 2 ||
@@ -344,9 +396,15 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
     RET_CHECK_EQ(raw_score_tensor->shape().dims[1], num_boxes_);
     RET_CHECK_EQ(raw_score_tensor->shape().dims[2], num_classes_);
     auto raw_box_view = raw_box_tensor->GetCpuReadView();
-    auto raw_boxes = raw_box_view.buffer<float>();
+    std::vector<float> converted_boxes;
+    ASSIGN_OR_RETURN(
+        const float* raw_boxes,
+        GetTensorFloatData(*raw_box_tensor, raw_box_view, converted_boxes));
     auto raw_scores_view = raw_score_tensor->GetCpuReadView();
-    auto raw_scores = raw_scores_view.buffer<float>();
+    std::vector<float> converted_scores;
+    ASSIGN_OR_RETURN(const float* raw_scores,
+                     GetTensorFloatData(*raw_score_tensor, raw_scores_view,
+                                        converted_scores));
 
     // TODO: Support other options to load anchors.
     if (!anchors_init_) {
@@ -357,18 +415,16 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
         RET_CHECK_EQ(anchor_tensor->shape().dims[0], num_boxes_);
         RET_CHECK_EQ(anchor_tensor->shape().dims[1], kNumCoordsPerBox);
         auto anchor_view = anchor_tensor->GetCpuReadView();
-        auto raw_anchors = anchor_view.buffer<float>();
+        std::vector<float> converted_anchors;
+        ASSIGN_OR_RETURN(const float* raw_anchors,
+                         GetTensorFloatData(*anchor_tensor, anchor_view,
+                                            converted_anchors));
         ConvertRawValuesToAnchors(raw_anchors, num_boxes_, &anchors_);
-      } else if (!kInAnchors(cc).IsEmpty()) {
-        anchors_ = *kInAnchors(cc);
       } else {
-        return absl::UnavailableError("No anchor data available.");
+        MP_RETURN_IF_ERROR(LoadSideAnchors(cc));
       }
       anchors_init_ = true;
     }
-    std::vector<float> boxes(num_boxes_ * num_coords_);
-    MP_RETURN_IF_ERROR(DecodeBoxes(raw_boxes, anchors_, &boxes));
-
     std::vector<float> detection_scores(num_boxes_);
     std::vector<int> detection_classes(num_boxes_);
 
@@ -401,6 +457,18 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
       detection_classes[i] = class_id;
     }
 
+    if (options_.has_nms()) {
+      MP_RETURN_IF_ERROR(ConvertToDetectionsWithNms(
+          detection_scores.data(), detection_classes.data(),
+          [this, raw_boxes](int i, float* box) {
+            DecodeBox(raw_boxes + i * num_coords_, i, box);
+          },
+          output_detections));
+      return absl::OkStatus();
+    }
+
+    std::vector<float> boxes(num_boxes_ * num_coords_);
+    MP_RETURN_IF_ERROR(DecodeBoxes(raw_boxes, &boxes));
     MP_RETURN_IF_ERROR(
         ConvertToDetections(boxes.data(), detection_scores.data(),
                             detection_classes.data(), output_detections));
@@ -433,17 +501,31 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
     RET_CHECK_EQ(detection_scores_tensor->shape().dims[1], max_detections);
 
     auto num_boxes_view = num_boxes_tensor->GetCpuReadView();
-    auto num_boxes = num_boxes_view.buffer<float>();
+    std::vector<float> converted_num_boxes;
+    ASSIGN_OR_RETURN(const float* num_boxes,
+                     GetTensorFloatData(*num_boxes_tensor, num_boxes_view,
+                                        converted_num_boxes));
     num_boxes_ = num_boxes[0];
 
     auto detection_boxes_view = detection_boxes_tensor->GetCpuReadView();
-    auto detection_boxes = detection_boxes_view.buffer<float>();
+    std::vector<float> converted_boxes;
+    ASSIGN_OR_RETURN(const float* detection_boxes,
+                     GetTensorFloatData(*detection_boxes_tensor,
+                                        detection_boxes_view, converted_boxes));
 
     auto detection_scores_view = detection_scores_tensor->GetCpuReadView();
-    auto detection_scores = detection_scores_view.buffer<float>();
+    std::vector<float> converted_scores;
+    ASSIGN_OR_RETURN(
+        const float* detection_scores,
+        GetTensorFloatData(*detection_scores_tensor, detection_scores_view,
+                           converted_scores));
 
     auto detection_classes_view = detection_classes_tensor->GetCpuReadView();
-    auto detection_classes_ptr = detection_classes_view.buffer<float>();
+    std::vector<float> converted_classes;
+    ASSIGN_OR_RETURN(
+        const float* detection_classes_ptr,
+        GetTensorFloatData(*detection_classes_tensor, detection_classes_view,
+                           converted_classes));
     std::vector<int> detection_classes(num_boxes_);
     for (int i = 0; i < num_boxes_; ++i) {
       detection_classes[i] = static_cast<int>(detection_classes_ptr[i]);
@@ -456,7 +538,7 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
 }
 
 absl::Status TensorsToDetectionsCalculator::ProcessGPU(
-    CalculatorContext* cc, std::vector<Detection>* output_detections) {
+    CalculatorContext* cc, DetectionBatch* output_detections) {
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK_GE(input_tensors.size(), 2);
   RET_CHECK_GT(num_boxes_, 0) << "Please set num_boxes in calculator options";
@@ -475,13 +557,11 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
         glCopyBufferSubData(
             GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
             input_tensors[tensor_mapping_.anchors_tensor_index()].bytes());
-      } else if (!kInAnchors(cc).IsEmpty()) {
-        const auto& anchors = *kInAnchors(cc);
+      } else {
+        MP_RETURN_IF_ERROR(LoadSideAnchors(cc));
         auto anchors_view = raw_anchors_buffer_->GetCpuWriteView();
         auto raw_anchors = anchors_view.buffer<float>();
-        ConvertAnchorsToRawValues(anchors, num_boxes_, raw_anchors);
-      } else {
-        return absl::UnavailableError("No anchor data available.");
+        ConvertAnchorsToRawValues(anchors_, num_boxes_, raw_anchors);
       }
       anchors_init_ = true;
     }
@@ -528,6 +608,15 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
   }
   auto decoded_boxes_view = decoded_boxes_buffer_->GetCpuReadView();
   auto boxes = decoded_boxes_view.buffer<float>();
+  if (options_.has_nms()) {
+    MP_RETURN_IF_ERROR(ConvertToDetectionsWithNms(
+        detection_scores.data(), detection_classes.data(),
+        [this, boxes](int i, float* box) {
+          std::copy_n(boxes + i * num_coords_, num_coords_, box);
+        },
+        output_detections));
+    return absl::OkStatus();
+  }
   MP_RETURN_IF_ERROR(ConvertToDetections(boxes, detection_scores.data(),
                                          detection_classes.data(),
                                          output_detections));
@@ -551,13 +640,11 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
                                        .bytes()];
       [blit_command endEncoding];
       [command_buffer commit];
-    } else if (!kInAnchors(cc).IsEmpty()) {
-      const auto& anchors = *kInAnchors(cc);
+    } else {
+      MP_RETURN_IF_ERROR(LoadSideAnchors(cc));
       auto raw_anchors_view = raw_anchors_buffer_->GetCpuWriteView();
-      ConvertAnchorsToRawValues(anchors, num_boxes_,
+      ConvertAnchorsToRawValues(anchors_, num_boxes_,
                                 raw_anchors_view.buffer<float>());
-    } else {
-      return absl::UnavailableError("No anchor data available.");
     }
     anchors_init_ = true;
   }
@@ -613,6 +700,15 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
   }
   auto decoded_boxes_view = decoded_boxes_buffer_->GetCpuReadView();
   auto boxes = decoded_boxes_view.buffer<float>();
+  if (options_.has_nms()) {
+    MP_RETURN_IF_ERROR(ConvertToDetectionsWithNms(
+        detection_scores.data(), detection_classes.data(),
+        [this, boxes](int i, float* box) {
+          std::copy_n(boxes + i * num_coords_, num_coords_, box);
+        },
+        output_detections));
+    return absl::OkStatus();
+  }
   MP_RETURN_IF_ERROR(ConvertToDetections(boxes, detection_scores.data(),
                                          detection_classes.data(),
                                          output_detections));
@@ -719,73 +815,92 @@ absl::Status TensorsToDetectionsCalculator::LoadOptions(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+absl::Status TensorsToDetectionsCalculator::LoadSideAnchors(
+    CalculatorContext* cc) {
+  if (!kInAnchorArray(cc).IsEmpty()) {
+    anchors_ = *kInAnchorArray(cc);
+  } else if (!kInAnchors(cc).IsEmpty()) {
+    anchors_ = AnchorArray::FromAnchors(*kInAnchors(cc));
+  } else {
+    return absl::UnavailableError("No anchor data available.");
+  }
+  RET_CHECK_EQ(anchors_.size(), num_boxes_)
+      << "The number of anchors must match num_boxes.";
+  return absl::OkStatus();
+}
+
 absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
-    const float* raw_boxes, const std::vector<Anchor>& anchors,
-    std::vector<float>* boxes) {
+    const float* raw_boxes, std::vector<float>* boxes) {
   for (int i = 0; i < num_boxes_; ++i) {
-    const int box_offset = i * num_coords_ + options_.box_coord_offset();
-
-    float y_center = raw_boxes[box_offset];
-    float x_center = raw_boxes[box_offset + 1];
-    float h = raw_boxes[box_offset + 2];
-    float w = raw_boxes[box_offset + 3];
-    if (options_.reverse_output_order()) {
-      x_center = raw_boxes[box_offset];
-      y_center = raw_boxes[box_offset + 1];
-      w = raw_boxes[box_offset + 2];
-      h = raw_boxes[box_offset + 3];
-    }
+    DecodeBox(raw_boxes + i * num_coords_, i, boxes->data() + i * num_coords_);
+  }
 
-    x_center =
-        x_center / options_.x_scale() * anchors[i].w() + anchors[i].x_center();
-    y_center =
-        y_center / options_.y_scale() * anchors[i].h() + anchors[i].y_center();
+  return absl::OkStatus();
+}
 
-    if (options_.apply_exponential_on_box_size()) {
-      h = std::exp(h / options_.h_scale()) * anchors[i].h();
-      w = std::exp(w / options_.w_scale()) * anchors[i].w();
-    } else {
-      h = h / options_.h_scale() * anchors[i].h();
-      w = w / options_.w_scale() * anchors[i].w();
-    }
+void TensorsToDetectionsCalculator::DecodeBox(const float* raw_box, int anchor,
+                                              float* box) {
+  const float anchor_y_center = anchors_.y_center[anchor];
+  const float anchor_x_center = anchors_.x_center[anchor];
+  const float anchor_h = anchors_.h[anchor];
+  const float anchor_w = anchors_.w[anchor];
+  const int box_offset = options_.box_coord_offset();
+
+  float y_center = raw_box[box_offset];
+  float x_center = raw_box[box_offset + 1];
+  float h = raw_box[box_offset + 2];
+  float w = raw_box[box_offset + 3];
+  if (options_.reverse_output_order()) {
+    x_center = raw_box[box_offset];
+    y_center = raw_box[box_offset + 1];
+    w = raw_box[box_offset + 2];
+    h = raw_box[box_offset + 3];
+  }
 
-    const float ymin = y_center - h / 2.f;
-    const float xmin = x_center - w / 2.f;
-    const float ymax = y_center + h / 2.f;
-    const float xmax = x_center + w / 2.f;
-
-    (*boxes)[i * num_coords_ + 0] = ymin;
-    (*boxes)[i * num_coords_ + 1] = xmin;
-    (*boxes)[i * num_coords_ + 2] = ymax;
-    (*boxes)[i * num_coords_ + 3] = xmax;
-
-    if (options_.num_keypoints()) {
-      for (int k = 0; k < options_.num_keypoints(); ++k) {
-        const int offset = i * num_coords_ + options_.keypoint_coord_offset() +
-                           k * options_.num_values_per_keypoint();
-
-        float keypoint_y = raw_boxes[offset];
-        float keypoint_x = raw_boxes[offset + 1];
-        if (options_.reverse_output_order()) {
-          keypoint_x = raw_boxes[offset];
-          keypoint_y = raw_boxes[offset + 1];
-        }
+  x_center = x_center / options_.x_scale() * anchor_w + anchor_x_center;
+  y_center = y_center / options_.y_scale() * anchor_h + anchor_y_center;
+
+  if (options_.apply_exponential_on_box_size()) {
+    h = std::exp(h / options_.h_scale()) * anchor_h;
+    w = std::exp(w / options_.w_scale()) * anchor_w;
+  } else {
+    h = h / options_.h_scale() * anchor_h;
+    w = w / options_.w_scale() * anchor_w;
+  }
 
-        (*boxes)[offset] = keypoint_x / options_.x_scale() * anchors[i].w() +
-                           anchors[i].x_center();
-        (*boxes)[offset + 1] =
-            keypoint_y / options_.y_scale() * anchors[i].h() +
-            anchors[i].y_center();
+  const float ymin = y_center - h / 2.f;
+  const float xmin = x_center - w / 2.f;
+  const float ymax = y_center + h / 2.f;
+  const float xmax = x_center + w / 2.f;
+
+  box[0] = ymin;
+  box[1] = xmin;
+  box[2] = ymax;
+  box[3] = xmax;
+
+  if (options_.num_keypoints()) {
+    for (int k = 0; k < options_.num_keypoints(); ++k) {
+      const int offset = options_.keypoint_coord_offset() +
+                         k * options_.num_values_per_keypoint();
+
+      float keypoint_y = raw_box[offset];
+      float keypoint_x = raw_box[offset + 1];
+      if (options_.reverse_output_order()) {
+        keypoint_x = raw_box[offset];
+        keypoint_y = raw_box[offset + 1];
       }
+
+      box[offset] =
+          keypoint_x / options_.x_scale() * anchor_w + anchor_x_center;
+      box[offset + 1] =
+          keypoint_y / options_.y_scale() * anchor_h + anchor_y_center;
     }
   }
-
-  return absl::OkStatus();
 }
 
 absl::Status TensorsToDetectionsCalculator::ConvertToDetections(
     const float* detection_boxes, const float* detection_scores,
-    const int* detection_classes, std::vector<Detection>* output_detections) {
+    const int* detection_classes, DetectionBatch* output_detections) {
   for (int i = 0; i < num_boxes_; ++i) {
     if (max_results_ > 0 && output_detections->size() == max_results_) {
       break;
@@ -797,59 +912,147 @@ absl::Status TensorsToDetectionsCalculator::ConvertToDetections(
     if (!IsClassIndexAllowed(detection_classes[i])) {
       continue;
     }
-    const int box_offset = i * num_coords_;
-    Detection detection = ConvertToDetection(
-        /*box_ymin=*/detection_boxes[box_offset + box_indices_[0]],
-        /*box_xmin=*/detection_boxes[box_offset + box_indices_[1]],
-        /*box_ymax=*/detection_boxes[box_offset + box_indices_[2]],
-        /*box_xmax=*/detection_boxes[box_offset + box_indices_[3]],
-        detection_scores[i], detection_classes[i], options_.flip_vertically());
-    const auto& bbox = detection.location_data().relative_bounding_box();
-    if (bbox.width() < 0 || bbox.height() < 0 || std::isnan(bbox.width()) ||
-        std::isnan(bbox.height())) {
+    const float* box = detection_boxes + i * num_coords_;
+    const float height = box[box_indices_[2]] - box[box_indices_[0]];
+    const float width = box[box_indices_[3]] - box[box_indices_[1]];
+    if (width < 0 || height < 0 || std::isnan(width) || std::isnan(height)) {
       // Decoded detection boxes could have negative values for width/height due
       // to model prediction. Filter out those boxes since some downstream
       // calculators may assume non-negative values. (b/171391719)
       continue;
     }
-    // Add keypoints.
-    if (options_.num_keypoints() > 0) {
-      auto* location_data = detection.mutable_location_data();
-      for (int kp_id = 0; kp_id < options_.num_keypoints() *
-                                      options_.num_values_per_keypoint();
-           kp_id += options_.num_values_per_keypoint()) {
-        auto keypoint = location_data->add_relative_keypoints();
-        const int keypoint_index =
-            box_offset + options_.keypoint_coord_offset() + kp_id;
-        keypoint->set_x(detection_boxes[keypoint_index + 0]);
-        keypoint->set_y(options_.flip_vertically()
-                            ? 1.f - detection_boxes[keypoint_index + 1]
-                            : detection_boxes[keypoint_index + 1]);
-      }
-    }
-    output_detections->emplace_back(detection);
+    AppendDecodedBox(box, detection_scores[i], detection_classes[i],
+                     output_detections);
   }
   return absl::OkStatus();
 }
 
-Detection TensorsToDetectionsCalculator::ConvertToDetection(
-    float box_ymin, float box_xmin, float box_ymax, float box_xmax, float score,
-    int class_id, bool flip_vertically) {
-  Detection detection;
-  detection.add_score(score);
-  detection.add_label_id(class_id);
+absl::Status TensorsToDetectionsCalculator::ConvertToDetectionsWithNms(
+    const float* detection_scores, const int* detection_classes,
+    const std::function<void(int box_index, float* box)>& decode_box,
+    DetectionBatch* output_detections) {
+  const auto& nms_options = options_.nms();
 
-  LocationData* location_data = detection.mutable_location_data();
-  location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+  // Select the candidates on their scores alone. NaN scores are dropped since
+  // they cannot be ranked.
+  std::vector<int> candidates;
+  for (int i = 0; i < num_boxes_; ++i) {
+    if (std::isnan(detection_scores[i]) ||
+        (options_.has_min_score_thresh() &&
+         detection_scores[i] < options_.min_score_thresh())) {
+      continue;
+    }
+    if (!IsClassIndexAllowed(detection_classes[i])) {
+      continue;
+    }
+    candidates.push_back(i);
+  }
+  // Higher scores first. Ties are broken by box index.
+  const auto higher_score = [detection_scores](int i, int j) {
+    if (detection_scores[i] != detection_scores[j]) {
+      return detection_scores[i] > detection_scores[j];
+    }
+    return i < j;
+  };
+  if (nms_options.max_candidates() > 0 &&
+      candidates.size() > static_cast<size_t>(nms_options.max_candidates())) {
+    std::nth_element(candidates.begin(),
+                     candidates.begin() + nms_options.max_candidates(),
+                     candidates.end(), higher_score);
+    candidates.resize(nms_options.max_candidates());
+  }
+  std::sort(candidates.begin(), candidates.end(), higher_score);
+
+  // Decode the candidates, dropping the boxes that ConvertToDetections()
+  // would drop.
+  std::vector<float> boxes(candidates.size() * num_coords_);
+  int num_decoded = 0;
+  for (int i : candidates) {
+    float* box = &boxes[num_decoded * num_coords_];
+    decode_box(i, box);
+    const float height = box[box_indices_[2]] - box[box_indices_[0]];
+    const float width = box[box_indices_[3]] - box[box_indices_[1]];
+    if (!(width >= 0 && height >= 0)) {
+      continue;
+    }
+    candidates[num_decoded++] = i;
+  }
 
-  LocationData::RelativeBoundingBox* relative_bbox =
-      location_data->mutable_relative_bounding_box();
+  // Each remaining box, in order of decreasing score, suppresses the lower
+  // scoring boxes it overlaps. Suppressed boxes suppress nothing themselves.
+  const bool weighted =
+      nms_options.algorithm() ==
+      TensorsToDetectionsCalculatorOptions::NmsOptions::WEIGHTED;
+  const size_t max_results_or_all =
+      max_results_ > 0 ? max_results_ : num_decoded;
+  std::vector<bool> suppressed(num_decoded, false);
+  std::vector<float> weighted_box(num_coords_);
+  for (int i = 0;
+       i < num_decoded && output_detections->size() < max_results_or_all; ++i) {
+    if (suppressed[i]) {
+      continue;
+    }
+    const float* box = &boxes[i * num_coords_];
+    const float score = detection_scores[candidates[i]];
+    float total_score = score;
+    if (weighted) {
+      for (int c = 0; c < num_coords_; ++c) {
+        weighted_box[c] = box[c] * score;
+      }
+    }
+    for (int j = i + 1; j < num_decoded; ++j) {
+      if (suppressed[j]) {
+        continue;
+      }
+      const float* other_box = &boxes[j * num_coords_];
+      if (IntersectionOverUnion(box, other_box) <=
+          nms_options.min_suppression_threshold()) {
+        continue;
+      }
+      suppressed[j] = true;
+      if (weighted) {
+        const float other_score = detection_scores[candidates[j]];
+        total_score += other_score;
+        for (int c = 0; c < num_coords_; ++c) {
+          weighted_box[c] += other_box[c] * other_score;
+        }
+      }
+    }
+    if (weighted && total_score != score) {
+      for (int c = 0; c < num_coords_; ++c) {
+        weighted_box[c] /= total_score;
+      }
+      box = weighted_box.data();
+    }
+    AppendDecodedBox(box, score, detection_classes[candidates[i]],
+                     output_detections);
+  }
+  return absl::OkStatus();
+}
 
-  relative_bbox->set_xmin(box_xmin);
-  relative_bbox->set_ymin(flip_vertically ? 1.f - box_ymax : box_ymin);
-  relative_bbox->set_width(box_xmax - box_xmin);
-  relative_bbox->set_height(box_ymax - box_ymin);
-  return detection;
+void TensorsToDetectionsCalculator::AppendDecodedBox(
+    const float* box, float score, int class_id, DetectionBatch* detections) {
+  const float box_ymin = box[box_indices_[0]];
+  const float box_xmin = box[box_indices_[1]];
+  const float box_ymax = box[box_indices_[2]];
+  const float box_xmax = box[box_indices_[3]];
+  const bool flip_vertically = options_.flip_vertically();
+  detections->xmin.push_back(box_xmin);
+  detections->ymin.push_back(flip_vertically ? 1.f - box_ymax : box_ymin);
+  detections->width.push_back(box_xmax - box_xmin);
+  detections->height.push_back(box_ymax - box_ymin);
+  detections->score.push_back(score);
+  detections->label_id.push_back(class_id);
+  // Add keypoints.
+  for (int kp_id = 0;
+       kp_id < options_.num_keypoints() * options_.num_values_per_keypoint();
+       kp_id += options_.num_values_per_keypoint()) {
+    const int keypoint_index = options_.keypoint_coord_offset() + kp_id;
+    detections->keypoint_x.push_back(box[keypoint_index + 0]);
+    detections->keypoint_y.push_back(flip_vertically
+                                         ? 1.f - box[keypoint_index + 1]
+                                         : box[keypoint_index + 1]);
+  }
 }
 
 absl::Status TensorsToDetectionsCalculator::GpuInit(CalculatorContext* cc) {
@@ -0,0 +1,123 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
+#include "mediapipe/framework/benchmarks/calculator_benchmark.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumPackets = 16;
+constexpr int kNumCoords = 4;
+
+// Returns a config decoding `num_boxes` boxes of a single class model, with
+// non-maximum suppression if `nms` is true.
+CalculatorGraphConfig::Node MakeNodeConfig(int num_boxes, bool nms) {
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "TensorsToDetectionsCalculator"
+        input_stream: "TENSORS:tensors"
+        input_side_packet: "ANCHORS:anchors"
+        output_stream: "DETECTIONS:detections"
+        options {
+          [mediapipe.TensorsToDetectionsCalculatorOptions.ext] {
+            num_classes: 1
+            num_coords: 4
+            x_scale: 128
+            y_scale: 128
+            w_scale: 128
+            h_scale: 128
+            sigmoid_score: true
+            score_clipping_thresh: 100
+            min_score_thresh: 0.5
+          }
+        }
+      )pb");
+  auto* options = node_config.mutable_options()->MutableExtension(
+      TensorsToDetectionsCalculatorOptions::ext);
+  options->set_num_boxes(num_boxes);
+  if (nms) options->mutable_nms();
+  return node_config;
+}
+
+// Adds the anchors and packets of raw model outputs for state.range(0) boxes,
+// a quarter of which pass the score threshold.
+absl::Status AddTensors(benchmark::State& state, CalculatorRunner* runner) {
+  const int num_boxes = state.range(0);
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> offset(-8.0f, 8.0f);
+  std::uniform_real_distribution<float> size(8.0f, 24.0f);
+  std::uniform_real_distribution<float> logit(-6.0f, 2.0f);
+  for (int t = 0; t < kNumPackets; ++t) {
+    auto tensors = std::make_unique<std::vector<Tensor>>();
+    tensors->emplace_back(Tensor::ElementType::kFloat32,
+                          Tensor::Shape{1, num_boxes, kNumCoords});
+    tensors->emplace_back(Tensor::ElementType::kFloat32,
+                          Tensor::Shape{1, num_boxes, 1});
+    {
+      auto boxes_view = (*tensors)[0].GetCpuWriteView();
+      auto scores_view = (*tensors)[1].GetCpuWriteView();
+      float* boxes = boxes_view.buffer<float>();
+      float* scores = scores_view.buffer<float>();
+      for (int i = 0; i < num_boxes; ++i) {
+        boxes[i * kNumCoords + 0] = offset(rng);
+        boxes[i * kNumCoords + 1] = offset(rng);
+        boxes[i * kNumCoords + 2] = size(rng);
+        boxes[i * kNumCoords + 3] = size(rng);
+        scores[i] = logit(rng);
+      }
+    }
+    runner->MutableInputs()->Tag("TENSORS").packets.push_back(
+        Adopt(tensors.release()).At(Timestamp(t)));
+  }
+  std::uniform_real_distribution<float> center(0.0f, 1.0f);
+  std::vector<Anchor> anchors(num_boxes);
+  for (Anchor& anchor : anchors) {
+    anchor.set_x_center(center(rng));
+    anchor.set_y_center(center(rng));
+    anchor.set_w(1);
+    anchor.set_h(1);
+  }
+  runner->MutableSidePackets()->Tag("ANCHORS") =
+      MakePacket<std::vector<Anchor>>(std::move(anchors));
+  return absl::OkStatus();
+}
+
+MEDIAPIPE_CALCULATOR_BENCHMARK(BM_TensorsToDetections,
+                               MakeNodeConfig(state.range(0), /*nms=*/false),
+                               AddTensors)
+    ->Arg(896)
+    ->Arg(2304);
+
+MEDIAPIPE_CALCULATOR_BENCHMARK(BM_TensorsToDetectionsWithNms,
+                               MakeNodeConfig(state.range(0), /*nms=*/true),
+                               AddTensors)
+    ->Arg(896)
+    ->Arg(2304);
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
@@ -0,0 +1,205 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor_array.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using Node = ::mediapipe::CalculatorGraphConfig::Node;
+
+// A box given by its center and size, with the score of each class.
+struct RawBox {
+  float x_center;
+  float y_center;
+  float w;
+  float h;
+  std::vector<float> scores;
+};
+
+// Runs the calculator on "raw_boxes", decoded with identity anchors, and
+// returns the output detections. The anchors are given as an AnchorArray if
+// "use_anchor_array" is set, as Anchor protos otherwise.
+std::vector<Detection> RunCalculator(
+    const TensorsToDetectionsCalculatorOptions& options,
+    const std::vector<RawBox>& raw_boxes, bool use_anchor_array = false) {
+  Node node_config = ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToDetectionsCalculator"
+    input_stream: "TENSORS:tensors"
+    output_stream: "DETECTIONS:detections"
+  )pb");
+  node_config.add_input_side_packet(use_anchor_array
+                                        ? "ANCHOR_ARRAY:anchors"
+                                        : "ANCHORS:anchors");
+  *node_config.mutable_options()->MutableExtension(
+      TensorsToDetectionsCalculatorOptions::ext) = options;
+  CalculatorRunner runner(node_config);
+
+  const int num_boxes = raw_boxes.size();
+  const int num_classes = options.num_classes();
+  auto tensors = std::make_unique<std::vector<Tensor>>();
+  tensors->emplace_back(Tensor::ElementType::kFloat32,
+                        Tensor::Shape{1, num_boxes, 4});
+  tensors->emplace_back(Tensor::ElementType::kFloat32,
+                        Tensor::Shape{1, num_boxes, num_classes});
+  {
+    auto boxes_view = (*tensors)[0].GetCpuWriteView();
+    auto scores_view = (*tensors)[1].GetCpuWriteView();
+    float* boxes = boxes_view.buffer<float>();
+    float* scores = scores_view.buffer<float>();
+    for (int i = 0; i < num_boxes; ++i) {
+      boxes[i * 4 + 0] = raw_boxes[i].y_center;
+      boxes[i * 4 + 1] = raw_boxes[i].x_center;
+      boxes[i * 4 + 2] = raw_boxes[i].h;
+      boxes[i * 4 + 3] = raw_boxes[i].w;
+      for (int c = 0; c < num_classes; ++c) {
+        scores[i * num_classes + c] = raw_boxes[i].scores[c];
+      }
+    }
+  }
+  std::vector<Anchor> anchors(num_boxes);
+  for (Anchor& anchor : anchors) {
+    anchor.set_x_center(0);
+    anchor.set_y_center(0);
+    anchor.set_w(1);
+    anchor.set_h(1);
+  }
+  if (use_anchor_array) {
+    runner.MutableSidePackets()->Tag("ANCHOR_ARRAY") =
+        MakePacket<AnchorArray>(AnchorArray::FromAnchors(anchors));
+  } else {
+    runner.MutableSidePackets()->Tag("ANCHORS") =
+        MakePacket<std::vector<Anchor>>(anchors);
+  }
+  runner.MutableInputs()->Tag("TENSORS").packets.push_back(
+      Adopt(tensors.release()).At(Timestamp(0)));
+  MP_EXPECT_OK(runner.Run());
+  const auto& output_packets = runner.Outputs().Tag("DETECTIONS").packets;
+  EXPECT_EQ(output_packets.size(), 1);
+  if (output_packets.empty()) return {};
+  return output_packets[0].Get<std::vector<Detection>>();
+}
+
+TensorsToDetectionsCalculatorOptions MakeOptions(int num_classes) {
+  TensorsToDetectionsCalculatorOptions options;
+  options.set_num_classes(num_classes);
+  options.set_num_coords(4);
+  options.set_x_scale(1);
+  options.set_y_scale(1);
+  options.set_w_scale(1);
+  options.set_h_scale(1);
+  options.set_min_score_thresh(0.1);
+  return options;
+}
+
+TEST(TensorsToDetectionsCalculatorTest, DecodesAllBoxesWithoutNms) {
+  TensorsToDetectionsCalculatorOptions options = MakeOptions(2);
+  options.set_num_boxes(3);
+  std::vector<Detection> detections =
+      RunCalculator(options, {{0.2, 0.2, 0.2, 0.2, {0.8, 0.0}},
+                              {0.21, 0.21, 0.2, 0.2, {0.0, 0.9}},
+                              {0.7, 0.7, 0.2, 0.2, {0.05, 0.0}}});
+  ASSERT_EQ(detections.size(), 2);
+  EXPECT_FLOAT_EQ(detections[0].score(0), 0.8);
+  EXPECT_EQ(detections[1].label_id(0), 1);
+  const auto& bbox = detections[0].location_data().relative_bounding_box();
+  EXPECT_FLOAT_EQ(bbox.xmin(), 0.1);
+  EXPECT_FLOAT_EQ(bbox.ymin(), 0.1);
+  EXPECT_FLOAT_EQ(bbox.width(), 0.2);
+  EXPECT_FLOAT_EQ(bbox.height(), 0.2);
+}
+
+TEST(TensorsToDetectionsCalculatorTest, DecodesBoxesWithAnchorArray) {
+  TensorsToDetectionsCalculatorOptions options = MakeOptions(1);
+  options.set_num_boxes(2);
+  std::vector<Detection> detections =
+      RunCalculator(options,
+                    {{0.2, 0.3, 0.2, 0.4, {0.8}}, {0.7, 0.7, 0.2, 0.2, {0.9}}},
+                    /*use_anchor_array=*/true);
+  ASSERT_EQ(detections.size(), 2);
+  const auto& bbox = detections[0].location_data().relative_bounding_box();
+  EXPECT_FLOAT_EQ(bbox.xmin(), 0.1);
+  EXPECT_FLOAT_EQ(bbox.ymin(), 0.1);
+  EXPECT_FLOAT_EQ(bbox.width(), 0.2);
+  EXPECT_FLOAT_EQ(bbox.height(), 0.4);
+  EXPECT_FLOAT_EQ(detections[1].score(0), 0.9);
+}
+
+TEST(TensorsToDetectionsCalculatorTest, HardNmsSuppressesOverlappingBoxes) {
+  TensorsToDetectionsCalculatorOptions options = MakeOptions(1);
+  options.set_num_boxes(4);
+  options.mutable_nms()->set_min_suppression_threshold(0.5);
+  std::vector<Detection> detections =
+      RunCalculator(options, {{0.2, 0.2, 0.2, 0.2, {0.8}},
+                              {0.21, 0.21, 0.2, 0.2, {0.9}},
+                              {0.7, 0.7, 0.2, 0.2, {0.7}},
+                              {0.7, 0.7, 0.2, 0.2, {0.05}}});
+  ASSERT_EQ(detections.size(), 2);
+  EXPECT_FLOAT_EQ(detections[0].score(0), 0.9);
+  EXPECT_FLOAT_EQ(
+      detections[0].location_data().relative_bounding_box().xmin(), 0.11);
+  EXPECT_FLOAT_EQ(detections[1].score(0), 0.7);
+}
+
+TEST(TensorsToDetectionsCalculatorTest, WeightedNmsAveragesOverlappingBoxes) {
+  TensorsToDetectionsCalculatorOptions options = MakeOptions(1);
+  options.set_num_boxes(2);
+  options.mutable_nms()->set_algorithm(
+      TensorsToDetectionsCalculatorOptions::NmsOptions::WEIGHTED);
+  std::vector<Detection> detections =
+      RunCalculator(options, {{0.2, 0.2, 0.2, 0.2, {0.25}},
+                              {0.24, 0.24, 0.2, 0.2, {0.75}}});
+  ASSERT_EQ(detections.size(), 1);
+  EXPECT_FLOAT_EQ(detections[0].score(0), 0.75);
+  const auto& bbox = detections[0].location_data().relative_bounding_box();
+  EXPECT_FLOAT_EQ(bbox.xmin(), 0.13);
+  EXPECT_FLOAT_EQ(bbox.ymin(), 0.13);
+  EXPECT_FLOAT_EQ(bbox.width(), 0.2);
+}
+
+TEST(TensorsToDetectionsCalculatorTest, NmsLimitsCandidatesAndResults) {
+  TensorsToDetectionsCalculatorOptions options = MakeOptions(1);
+  options.set_num_boxes(4);
+  options.mutable_nms()->set_max_candidates(3);
+  // Disjoint boxes, so that none is suppressed.
+  std::vector<RawBox> raw_boxes = {{0.1, 0.1, 0.1, 0.1, {0.2}},
+                                   {0.3, 0.3, 0.1, 0.1, {0.6}},
+                                   {0.5, 0.5, 0.1, 0.1, {0.4}},
+                                   {0.7, 0.7, 0.1, 0.1, {0.8}}};
+  std::vector<Detection> detections = RunCalculator(options, raw_boxes);
+  ASSERT_EQ(detections.size(), 3);
+  EXPECT_FLOAT_EQ(detections[0].score(0), 0.8);
+  EXPECT_FLOAT_EQ(detections[1].score(0), 0.6);
+  EXPECT_FLOAT_EQ(detections[2].score(0), 0.4);
+
+  options.set_max_results(2);
+  detections = RunCalculator(options, raw_boxes);
+  ASSERT_EQ(detections.size(), 2);
+  EXPECT_FLOAT_EQ(detections[1].score(0), 0.6);
+}
+
+}  // namespace
+}  // namespace mediapipe
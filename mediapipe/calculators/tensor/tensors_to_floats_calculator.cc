@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "mediapipe/calculators/tensor/tensor_element_utils.h"
 #include "mediapipe/calculators/tensor/tensors_to_floats_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -30,7 +31,8 @@ inline float Sigmoid(float value) { return 1.0f / (1.0f + std::exp(-value)); }
 //
 // Input:
 //  TENSORS - Vector of Tensors of type kFloat32. Only the first
-//            tensor will be used.
+//            tensor will be used. Float16 tensors are widened, and
+//            quantized kUInt8 and kInt8 tensors are dequantized.
 // Output:
 //  FLOAT(optional) - Converted single float number.
 //  FLOATS(optional) - Converted float vector.
@@ -65,6 +67,7 @@ MEDIAPIPE_REGISTER_NODE(TensorsToFloatsCalculator);
 absl::Status TensorsToFloatsCalculator::UpdateContract(CalculatorContract* cc) {
   // Only exactly a single output allowed.
   RET_CHECK(kOutFloat(cc).IsConnected() ^ kOutFloats(cc).IsConnected());
+  cc->SetStateless(true);
   return absl::OkStatus();
 }
 
@@ -76,13 +79,14 @@ absl::Status TensorsToFloatsCalculator::Open(CalculatorContext* cc) {
 absl::Status TensorsToFloatsCalculator::Process(CalculatorContext* cc) {
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
-  RET_CHECK(input_tensors[0].element_type() == Tensor::ElementType::kFloat32);
+  RET_CHECK(IsConvertibleToFloat(input_tensors[0].element_type()));
   // TODO: Add option to specify which tensor to take from.
   auto view = input_tensors[0].GetCpuReadView();
-  auto raw_floats = view.buffer<float>();
   int num_values = input_tensors[0].shape().num_elements();
-  auto output_floats = absl::make_unique<std::vector<float>>(
-      raw_floats, raw_floats + num_values);
+  auto output_floats = absl::make_unique<std::vector<float>>(num_values);
+  MP_RETURN_IF_ERROR(ConvertTensorElementsToFloats(
+      input_tensors[0], view.buffer<void>(), num_values,
+      output_floats->data()));
 
   switch (options_.activation()) {
     case TensorsToFloatsCalculatorOptions::SIGMOID:
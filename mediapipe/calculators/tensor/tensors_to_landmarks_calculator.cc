@@ -12,18 +12,95 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "absl/strings/substitute.h"
+#include "mediapipe/calculators/tensor/tensor_element_utils.h"
 #include "mediapipe/calculators/tensor/tensors_to_landmarks_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/ret_check.h"
 
+#ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
+#include "mediapipe/gpu/gl_calculator_helper.h"
+#endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
+
 namespace mediapipe {
 namespace api2 {
 
 namespace {
 
+// Row-major 3x4 affine transform of (x, y, z).
+using AffineTransform = std::array<float, 12>;
+
+constexpr AffineTransform kIdentityTransform = {1.0f, 0.0f, 0.0f, 0.0f,  //
+                                                0.0f, 1.0f, 0.0f, 0.0f,  //
+                                                0.0f, 0.0f, 1.0f, 0.0f};
+
+// Returns the transform applying `second` after `first`.
+AffineTransform Compose(const AffineTransform& second,
+                        const AffineTransform& first) {
+  AffineTransform result;
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      float value = c == 3 ? second[r * 4 + 3] : 0.0f;
+      for (int k = 0; k < 3; ++k) {
+        value += second[r * 4 + k] * first[k * 4 + c];
+      }
+      result[r * 4 + c] = value;
+    }
+  }
+  return result;
+}
+
+void ApplyTransform(const AffineTransform& t, float& x, float& y, float& z) {
+  const float new_x = t[0] * x + t[1] * y + t[2] * z + t[3];
+  const float new_y = t[4] * x + t[5] * y + t[6] * z + t[7];
+  const float new_z = t[8] * x + t[9] * y + t[10] * z + t[11];
+  x = new_x;
+  y = new_y;
+  z = new_z;
+}
+
+// Same as LandmarkLetterboxRemovalCalculator.
+AffineTransform LetterboxRemovalTransform(
+    const std::array<float, 4>& padding) {
+  const float x_scale = 1.0f / (1.0f - padding[0] - padding[2]);
+  const float y_scale = 1.0f / (1.0f - padding[1] - padding[3]);
+  // Z coordinate is scaled as X.
+  return {x_scale, 0.0f, 0.0f,    -padding[0] * x_scale,  //
+          0.0f,    y_scale, 0.0f, -padding[1] * y_scale,  //
+          0.0f,    0.0f, x_scale, 0.0f};
+}
+
+// Same as LandmarkProjectionCalculator with a PROJECTION_MATRIX: X and Y are
+// projected and Z is scaled by the length of the projected unit X vector.
+AffineTransform ProjectionTransform(const std::array<float, 16>& matrix) {
+  const float z_scale =
+      std::sqrt(matrix[0] * matrix[0] + matrix[4] * matrix[4]);
+  return {matrix[0], matrix[1], matrix[2], matrix[3],  //
+          matrix[4], matrix[5], matrix[6], matrix[7],  //
+          0.0f,      0.0f,      z_scale,   0.0f};
+}
+
+bool CanUseGpu() {
+#ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
+  // TODO: Configure GPU usage policy in individual calculators.
+  constexpr bool kAllowGpuProcessing = true;
+  return kAllowGpuProcessing;
+#else
+  return false;
+#endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
+}
+
 inline float Sigmoid(float value) { return 1.0f / (1.0f + std::exp(-value)); }
 
 float ApplyActivation(
@@ -49,6 +126,8 @@ float ApplyActivation(
 // Input:
 //  TENSORS - Vector of Tensors of type kFloat32. Only the first tensor will be
 //  used. The size of the values must be (num_dimension x num_landmarks).
+//  Float16 tensors are widened, and quantized kUInt8 and kInt8 tensors are
+//  dequantized, as they are read.
 //
 //  FLIP_HORIZONTALLY (optional): Whether to flip landmarks horizontally or
 //  not. Overrides corresponding side packet and/or field in the calculator
@@ -57,6 +136,17 @@ float ApplyActivation(
 //  FLIP_VERTICALLY (optional): Whether to flip landmarks vertically or not.
 //  Overrides corresponding side packet and/or field in the calculator options.
 //
+//  LETTERBOX_PADDING (optional): An std::array<float, 4> with the padding
+//  added to the model input, removed from the normalized landmarks as
+//  LandmarkLetterboxRemovalCalculator does.
+//
+//  PROJECTION_MATRIX (optional): An std::array<float, 16> the normalized
+//  landmarks are projected with after the letterbox removal, as
+//  LandmarkProjectionCalculator does.
+//
+//  Nothing is output at a timestamp where a connected LETTERBOX_PADDING or
+//  PROJECTION_MATRIX stream is empty.
+//
 // Input side packet:
 //   FLIP_HORIZONTALLY (optional): Whether to flip landmarks horizontally or
 //   not. Overrides the corresponding field in the calculator options.
@@ -67,6 +157,14 @@ float ApplyActivation(
 // Output:
 //  LANDMARKS(optional) - Result MediaPipe landmarks.
 //  NORM_LANDMARKS(optional) - Result MediaPipe normalized landmarks.
+//  PACKED_NORM_LANDMARKS(optional) - The normalized landmarks as
+//    PackedNormalizedLandmarks, built straight from the tensor.
+//
+// GPU processing:
+//   When the input tensor is a kFloat32 tensor already on the GPU and only
+//   normalized outputs are connected, the landmarks are decoded, unpadded and
+//   projected by an OpenGL ES 3.1 compute shader, so only the final
+//   5 x num_landmarks values are read back instead of the whole tensor.
 //
 // Notes:
 //   To output normalized landmarks, user must provide the original input image
@@ -94,26 +192,78 @@ class TensorsToLandmarksCalculator : public Node {
       "FLIP_HORIZONTALLY"};
   static constexpr Input<bool>::SideFallback::Optional kFlipVertically{
       "FLIP_VERTICALLY"};
+  static constexpr Input<std::array<float, 4>>::Optional kLetterboxPadding{
+      "LETTERBOX_PADDING"};
+  static constexpr Input<std::array<float, 16>>::Optional kProjectionMatrix{
+      "PROJECTION_MATRIX"};
   static constexpr Output<LandmarkList>::Optional kOutLandmarkList{"LANDMARKS"};
   static constexpr Output<NormalizedLandmarkList>::Optional
       kOutNormalizedLandmarkList{"NORM_LANDMARKS"};
+  static constexpr Output<PackedNormalizedLandmarks>::Optional
+      kOutPackedNormalizedLandmarks{"PACKED_NORM_LANDMARKS"};
   MEDIAPIPE_NODE_CONTRACT(kInTensors, kFlipHorizontally, kFlipVertically,
-                          kOutLandmarkList, kOutNormalizedLandmarkList);
+                          kLetterboxPadding, kProjectionMatrix,
+                          kOutLandmarkList, kOutNormalizedLandmarkList,
+                          kOutPackedNormalizedLandmarks);
+
+  static absl::Status UpdateContract(CalculatorContract* cc);
 
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
 
  private:
   absl::Status LoadOptions(CalculatorContext* cc);
+  // Transform of the normalized landmarks given by the LETTERBOX_PADDING and
+  // PROJECTION_MATRIX inputs.
+  AffineTransform OutputTransform(CalculatorContext* cc);
+  // Transform from raw tensor values to the normalized landmarks.
+  AffineTransform NormalizationTransform(bool flip_horizontally,
+                                         bool flip_vertically);
+  absl::Status ProcessGpu(CalculatorContext* cc, const Tensor& tensor,
+                          int num_dimensions,
+                          const AffineTransform& transform);
+  absl::Status GpuInit(int num_dimensions);
+  PackedNormalizedLandmarks PackNormalizedLandmarks(const float* raw_landmarks,
+                                                    int num_dimensions,
+                                                    bool flip_horizontally,
+                                                    bool flip_vertically);
   int num_landmarks_ = 0;
   ::mediapipe::TensorsToLandmarksCalculatorOptions options_;
+
+#ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
+  mediapipe::GlCalculatorHelper gpu_helper_;
+  GLuint decode_program_ = 0;
+  // Decoded landmarks, as x, y, z, visibility and presence arrays.
+  std::unique_ptr<Tensor> decoded_landmarks_buffer_;
+#endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
+  // Number of dimensions the shader was built for, 0 until then.
+  int gpu_num_dimensions_ = 0;
 };
 MEDIAPIPE_REGISTER_NODE(TensorsToLandmarksCalculator);
 
+absl::Status TensorsToLandmarksCalculator::UpdateContract(
+    CalculatorContract* cc) {
+  cc->SetStateless(true);
+  if (CanUseGpu()) {
+#ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
+    MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
+#endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
+  }
+  return absl::OkStatus();
+}
+
 absl::Status TensorsToLandmarksCalculator::Open(CalculatorContext* cc) {
   MP_RETURN_IF_ERROR(LoadOptions(cc));
 
-  if (kOutNormalizedLandmarkList(cc).IsConnected()) {
+  if (CanUseGpu()) {
+#ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
+    MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
+#endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
+  }
+
+  if (kOutNormalizedLandmarkList(cc).IsConnected() ||
+      kOutPackedNormalizedLandmarks(cc).IsConnected()) {
     RET_CHECK(options_.has_input_image_height() &&
               options_.has_input_image_width())
         << "Must provide input width/height for getting normalized landmarks.";
@@ -138,14 +288,50 @@ absl::Status TensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
       kFlipHorizontally(cc).GetOr(options_.flip_horizontally());
   bool flip_vertically = kFlipVertically(cc).GetOr(options_.flip_vertically());
 
+  if ((kLetterboxPadding(cc).IsConnected() &&
+       kLetterboxPadding(cc).IsEmpty()) ||
+      (kProjectionMatrix(cc).IsConnected() &&
+       kProjectionMatrix(cc).IsEmpty())) {
+    return absl::OkStatus();
+  }
+  const AffineTransform output_transform = OutputTransform(cc);
+
   const auto& input_tensors = *kInTensors(cc);
-  RET_CHECK(input_tensors[0].element_type() == Tensor::ElementType::kFloat32);
   int num_values = input_tensors[0].shape().num_elements();
   const int num_dimensions = num_values / num_landmarks_;
   CHECK_GT(num_dimensions, 0);
 
+  if (CanUseGpu() && input_tensors[0].ready_on_gpu() &&
+      input_tensors[0].element_type() == Tensor::ElementType::kFloat32 &&
+      !kOutLandmarkList(cc).IsConnected()) {
+    return ProcessGpu(
+        cc, input_tensors[0], num_dimensions,
+        Compose(output_transform,
+                NormalizationTransform(flip_horizontally, flip_vertically)));
+  }
+
+  RET_CHECK(IsConvertibleToFloat(input_tensors[0].element_type()));
   auto view = input_tensors[0].GetCpuReadView();
-  auto raw_landmarks = view.buffer<float>();
+  std::vector<float> converted_landmarks;
+  ASSIGN_OR_RETURN(
+      const float* raw_landmarks,
+      GetTensorFloatData(input_tensors[0], view, converted_landmarks));
+
+  if (kOutPackedNormalizedLandmarks(cc).IsConnected()) {
+    PackedNormalizedLandmarks landmarks = PackNormalizedLandmarks(
+        raw_landmarks, num_dimensions, flip_horizontally, flip_vertically);
+    if (output_transform != kIdentityTransform) {
+      for (int i = 0; i < landmarks.size(); ++i) {
+        ApplyTransform(output_transform, landmarks.x[i], landmarks.y[i],
+                       landmarks.z[i]);
+      }
+    }
+    kOutPackedNormalizedLandmarks(cc).Send(std::move(landmarks));
+  }
+  if (!kOutLandmarkList(cc).IsConnected() &&
+      !kOutNormalizedLandmarkList(cc).IsConnected()) {
+    return absl::OkStatus();
+  }
 
   LandmarkList output_landmarks;
 
@@ -190,6 +376,15 @@ absl::Status TensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
       // Scale Z coordinate as X + allow additional uniform normalization.
       norm_landmark->set_z(landmark.z() / options_.input_image_width() /
                            options_.normalize_z());
+      if (output_transform != kIdentityTransform) {
+        float x = norm_landmark->x();
+        float y = norm_landmark->y();
+        float z = norm_landmark->z();
+        ApplyTransform(output_transform, x, y, z);
+        norm_landmark->set_x(x);
+        norm_landmark->set_y(y);
+        norm_landmark->set_z(z);
+      }
       if (landmark.has_visibility()) {  // Set only if supported in the model.
         norm_landmark->set_visibility(landmark.visibility());
       }
@@ -208,6 +403,225 @@ absl::Status TensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+PackedNormalizedLandmarks TensorsToLandmarksCalculator::PackNormalizedLandmarks(
+    const float* raw_landmarks, int num_dimensions, bool flip_horizontally,
+    bool flip_vertically) {
+  // Computes the same values as the NORM_LANDMARKS output, one attribute at a
+  // time.
+  const float width = options_.input_image_width();
+  const float height = options_.input_image_height();
+  PackedNormalizedLandmarks landmarks;
+  landmarks.Resize(num_landmarks_, /*with_visibility=*/num_dimensions > 3,
+                   /*with_presence=*/num_dimensions > 4);
+  for (int i = 0; i < num_landmarks_; ++i) {
+    const float x = raw_landmarks[i * num_dimensions];
+    landmarks.x[i] = (flip_horizontally ? width - x : x) / width;
+  }
+  if (num_dimensions > 1) {
+    for (int i = 0; i < num_landmarks_; ++i) {
+      const float y = raw_landmarks[i * num_dimensions + 1];
+      landmarks.y[i] = (flip_vertically ? height - y : y) / height;
+    }
+  }
+  if (num_dimensions > 2) {
+    for (int i = 0; i < num_landmarks_; ++i) {
+      // Scale Z coordinate as X + allow additional uniform normalization.
+      landmarks.z[i] = raw_landmarks[i * num_dimensions + 2] / width /
+                       options_.normalize_z();
+    }
+  }
+  for (int i = 0; i < landmarks.visibility.size(); ++i) {
+    landmarks.visibility[i] =
+        ApplyActivation(options_.visibility_activation(),
+                        raw_landmarks[i * num_dimensions + 3]);
+  }
+  for (int i = 0; i < landmarks.presence.size(); ++i) {
+    landmarks.presence[i] = ApplyActivation(
+        options_.presence_activation(), raw_landmarks[i * num_dimensions + 4]);
+  }
+  return landmarks;
+}
+
+AffineTransform TensorsToLandmarksCalculator::OutputTransform(
+    CalculatorContext* cc) {
+  AffineTransform transform = kIdentityTransform;
+  if (kLetterboxPadding(cc).IsConnected()) {
+    transform = LetterboxRemovalTransform(*kLetterboxPadding(cc));
+  }
+  if (kProjectionMatrix(cc).IsConnected()) {
+    transform = Compose(ProjectionTransform(*kProjectionMatrix(cc)), transform);
+  }
+  return transform;
+}
+
+AffineTransform TensorsToLandmarksCalculator::NormalizationTransform(
+    bool flip_horizontally, bool flip_vertically) {
+  const float x_scale = 1.0f / options_.input_image_width();
+  const float y_scale = 1.0f / options_.input_image_height();
+  // Scale Z coordinate as X + allow additional uniform normalization.
+  const float z_scale = x_scale / options_.normalize_z();
+  return {flip_horizontally ? -x_scale : x_scale, 0.0f, 0.0f,
+          flip_horizontally ? 1.0f : 0.0f,  //
+          0.0f, flip_vertically ? -y_scale : y_scale, 0.0f,
+          flip_vertically ? 1.0f : 0.0f,  //
+          0.0f, 0.0f, z_scale, 0.0f};
+}
+
+absl::Status TensorsToLandmarksCalculator::ProcessGpu(
+    CalculatorContext* cc, const Tensor& tensor, int num_dimensions,
+    const AffineTransform& transform) {
+#ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
+  if (gpu_num_dimensions_ != num_dimensions) {
+    MP_RETURN_IF_ERROR(GpuInit(num_dimensions));
+  }
+  MP_RETURN_IF_ERROR(gpu_helper_.RunInGlContext(
+      [this, &tensor, &transform]() -> absl::Status {
+        auto decoded_view =
+            decoded_landmarks_buffer_->GetOpenGlBufferWriteView();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, decoded_view.name());
+        auto input_view = tensor.GetOpenGlBufferReadView();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, input_view.name());
+        glUseProgram(decode_program_);
+        glUniform4fv(0, 3, transform.data());
+        glDispatchCompute(num_landmarks_, 1, 1);
+        return absl::OkStatus();
+      }));
+
+  // Only the decoded values are read back. Mapping the buffer waits for the
+  // dispatch above, not for the whole inference.
+  PackedNormalizedLandmarks landmarks;
+  landmarks.Resize(num_landmarks_, /*with_visibility=*/num_dimensions > 3,
+                   /*with_presence=*/num_dimensions > 4);
+  auto decoded_view = decoded_landmarks_buffer_->GetCpuReadView();
+  const float* decoded = decoded_view.buffer<float>();
+  std::copy_n(decoded, num_landmarks_, landmarks.x.data());
+  std::copy_n(decoded + num_landmarks_, num_landmarks_, landmarks.y.data());
+  std::copy_n(decoded + 2 * num_landmarks_, num_landmarks_,
+              landmarks.z.data());
+  std::copy_n(decoded + 3 * num_landmarks_, landmarks.visibility.size(),
+              landmarks.visibility.data());
+  std::copy_n(decoded + 4 * num_landmarks_, landmarks.presence.size(),
+              landmarks.presence.data());
+
+  if (kOutNormalizedLandmarkList(cc).IsConnected()) {
+    kOutNormalizedLandmarkList(cc).Send(UnpackLandmarks(landmarks));
+  }
+  if (kOutPackedNormalizedLandmarks(cc).IsConnected()) {
+    kOutPackedNormalizedLandmarks(cc).Send(std::move(landmarks));
+  }
+  return absl::OkStatus();
+#else
+  return absl::UnimplementedError("GL compute is not available.");
+#endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
+}
+
+absl::Status TensorsToLandmarksCalculator::GpuInit(int num_dimensions) {
+#ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
+  MP_RETURN_IF_ERROR(gpu_helper_.RunInGlContext([this, num_dimensions]()
+                                                    -> absl::Status {
+    // A shader to decode one landmark per invocation. The normalization,
+    // flips, letterbox removal and projection are all folded into the
+    // `transform` uniform.
+    const std::string decode_src = absl::Substitute(
+        R"( #version 310 es
+
+layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+
+// Rows of a 3x4 affine transform.
+layout(location = 0) uniform vec4 transform[3];
+
+layout(std430, binding = 0) writeonly buffer Output {
+  float data[];
+} landmarks;
+
+layout(std430, binding = 1) readonly buffer Input0 {
+  float data[];
+} raw_landmarks;
+
+uint num_landmarks = uint($0);
+uint num_dimensions = uint($1);
+int visibility_sigmoid = int($2);
+int presence_sigmoid = int($3);
+
+float activation(float x, int apply_sigmoid) {
+  if (apply_sigmoid == int(0)) return x;
+  return 1.0 / (1.0 + exp(-x));
+}
+
+void main() {
+  uint g_idx = gl_GlobalInvocationID.x;  // landmark index
+  uint offset = g_idx * num_dimensions;
+
+  vec4 raw = vec4(0.0, 0.0, 0.0, 1.0);
+  raw.x = raw_landmarks.data[offset];
+  if (num_dimensions > uint(1)) raw.y = raw_landmarks.data[offset + uint(1)];
+  if (num_dimensions > uint(2)) raw.z = raw_landmarks.data[offset + uint(2)];
+
+  landmarks.data[g_idx] = dot(transform[0], raw);
+  landmarks.data[num_landmarks + g_idx] = dot(transform[1], raw);
+  landmarks.data[uint(2) * num_landmarks + g_idx] = dot(transform[2], raw);
+  if (num_dimensions > uint(3)) {
+    landmarks.data[uint(3) * num_landmarks + g_idx] = activation(
+        raw_landmarks.data[offset + uint(3)], visibility_sigmoid);
+  }
+  if (num_dimensions > uint(4)) {
+    landmarks.data[uint(4) * num_landmarks + g_idx] = activation(
+        raw_landmarks.data[offset + uint(4)], presence_sigmoid);
+  }
+})",
+        num_landmarks_, num_dimensions,
+        options_.visibility_activation() ==
+                ::mediapipe::TensorsToLandmarksCalculatorOptions::SIGMOID
+            ? 1
+            : 0,
+        options_.presence_activation() ==
+                ::mediapipe::TensorsToLandmarksCalculatorOptions::SIGMOID
+            ? 1
+            : 0);
+
+    // Shader program
+    GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+    const GLchar* sources[] = {decode_src.c_str()};
+    glShaderSource(shader, 1, sources, NULL);
+    glCompileShader(shader);
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    RET_CHECK(compiled == GL_TRUE) << "Shader compilation error: " << [shader] {
+      GLint length;
+      glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+      std::string str;
+      str.reserve(length);
+      glGetShaderInfoLog(shader, length, nullptr, str.data());
+      return str;
+    }();
+    if (decode_program_) glDeleteProgram(decode_program_);
+    decode_program_ = glCreateProgram();
+    glAttachShader(decode_program_, shader);
+    glDeleteShader(shader);
+    glLinkProgram(decode_program_);
+
+    // Outputs
+    decoded_landmarks_buffer_ = std::make_unique<Tensor>(
+        Tensor::ElementType::kFloat32, Tensor::Shape{1, 5 * num_landmarks_});
+    return absl::OkStatus();
+  }));
+  gpu_num_dimensions_ = num_dimensions;
+#endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
+  return absl::OkStatus();
+}
+
+absl::Status TensorsToLandmarksCalculator::Close(CalculatorContext* cc) {
+#ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
+  if (gpu_num_dimensions_ > 0) {
+    gpu_helper_.RunInGlContext([this] {
+      decoded_landmarks_buffer_ = nullptr;
+      glDeleteProgram(decode_program_);
+    });
+  }
+#endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
+  return absl::OkStatus();
+}
+
 absl::Status TensorsToLandmarksCalculator::LoadOptions(CalculatorContext* cc) {
   // Get calculator options specified in the graph.
   options_ = cc->Options<::mediapipe::TensorsToLandmarksCalculatorOptions>();
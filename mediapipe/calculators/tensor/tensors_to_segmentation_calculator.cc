@@ -12,18 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <vector>
 
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/tensor_element_utils.h"
 #include "mediapipe/calculators/tensor/tensors_to_segmentation_calculator.pb.h"
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_utils.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/gpu/gpu_origin.pb.h"
 #include "mediapipe/util/resource_util.h"
 #include "tensorflow/lite/interpreter.h"
@@ -35,11 +40,6 @@
 #include "mediapipe/gpu/shader_util.h"
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
-#if !MEDIAPIPE_DISABLE_OPENCV
-#include "mediapipe/framework/formats/image_opencv.h"
-#include "mediapipe/framework/port/opencv_imgproc_inc.h"
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
-
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 #include "tensorflow/lite/delegates/gpu/gl/converters/util.h"
 #include "tensorflow/lite/delegates/gpu/gl/gl_program.h"
@@ -59,6 +59,8 @@
 
 namespace {
 constexpr int kWorkgroupSize = 8;  // Block size for GPU shader.
+// Number of CPU masks kept around for reuse.
+constexpr int kMaskPoolKeepCount = 2;
 enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 
 // Commonly used to compute the number of blocks to launch in a kernel.
@@ -118,7 +120,8 @@ using ::tflite::gpu::gl::GlShader;
 //   One of the following TENSORS tags:
 //   TENSORS: Vector of Tensors of type kFloat32. Only the first tensor will be
 //            used. The tensor dimensions are specified in this calculator's
-//            options.
+//            options. On CPU, kFloat16 and quantized kUInt8 and kInt8
+//            tensors are also accepted, and converted as they are read.
 //   OUTPUT_SIZE(optional): std::pair<int, int>,
 //                          If provided, the size to upscale mask to.
 //
@@ -163,12 +166,15 @@ class TensorsToSegmentationCalculator : public CalculatorBase {
     return options_.gpu_origin() != mediapipe::GpuOrigin_Mode_TOP_LEFT;
   }
 
-#if !MEDIAPIPE_DISABLE_OPENCV
-  template <class T>
-  absl::Status ApplyActivation(cv::Mat& tensor_mat, cv::Mat* small_mask_mat);
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
   ::mediapipe::TensorsToSegmentationCalculatorOptions options_;
 
+  // Output masks on CPU, reallocated when the output size changes.
+  std::shared_ptr<ImageFramePool> mask_pool_;
+  // Splits CPU processing between threads, if num_threads > 1.
+  std::unique_ptr<ThreadPool> thread_pool_;
+  // Float copy of non-float input tensors, reused across calls.
+  std::vector<float> converted_input_;
+
 #if !MEDIAPIPE_DISABLE_GPU
   mediapipe::GlCalculatorHelper gpu_helper_;
   GLuint upsample_program_;
@@ -199,6 +205,11 @@ absl::Status TensorsToSegmentationCalculator::GetContract(
 
   // Outputs.
   cc->Outputs().Tag(kMaskTag).Set<Image>();
+  // Compiles the GPU programs without waiting for the upstream nodes to be
+  // opened.
+  cc->SetInputStreamHeadersNeeded(false);
+  // The mask pool and GPU programs don't carry state between frames.
+  cc->SetStateless(true);
 
   if (CanUseGpu()) {
 #if !MEDIAPIPE_DISABLE_GPU
@@ -229,6 +240,12 @@ absl::Status TensorsToSegmentationCalculator::Open(CalculatorContext* cc) {
 
   MP_RETURN_IF_ERROR(LoadOptions(cc));
 
+  if (options_.num_threads() > 1) {
+    thread_pool_ = absl::make_unique<ThreadPool>("TensorsToSegmentation",
+                                                 options_.num_threads());
+    thread_pool_->StartWorkers();
+  }
+
   if (use_gpu) {
 #if !MEDIAPIPE_DISABLE_GPU
     MP_RETURN_IF_ERROR(InitGpu(cc));
@@ -262,7 +279,9 @@ absl::Status TensorsToSegmentationCalculator::Process(CalculatorContext* cc) {
   // Validate tensor channels and activation type.
   {
     RET_CHECK(!input_tensors.empty());
-    RET_CHECK(input_tensors[0].element_type() == Tensor::ElementType::kFloat32);
+    const Tensor::ElementType element_type = input_tensors[0].element_type();
+    RET_CHECK(use_gpu ? element_type == Tensor::ElementType::kFloat32
+                      : IsConvertibleToFloat(element_type));
     ASSIGN_OR_RETURN(auto hwc, GetHwcFromDims(input_tensors[0].shape().dims));
     int tensor_channels = std::get<2>(hwc);
     typedef mediapipe::TensorsToSegmentationCalculatorOptions Options;
@@ -289,11 +308,7 @@ absl::Status TensorsToSegmentationCalculator::Process(CalculatorContext* cc) {
     RET_CHECK_FAIL() << "GPU processing disabled.";
 #endif  // !MEDIAPIPE_DISABLE_GPU
   } else {
-#if !MEDIAPIPE_DISABLE_OPENCV
     MP_RETURN_IF_ERROR(ProcessCpu(cc));
-#else
-    RET_CHECK_FAIL() << "OpenCV processing disabled.";
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
   }
 
   return absl::OkStatus();
@@ -321,7 +336,6 @@ absl::Status TensorsToSegmentationCalculator::Close(CalculatorContext* cc) {
 
 absl::Status TensorsToSegmentationCalculator::ProcessCpu(
     CalculatorContext* cc) {
-#if !MEDIAPIPE_DISABLE_OPENCV
   // Get input streams, and dimensions.
   const auto& input_tensors =
       cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
@@ -335,96 +349,46 @@ absl::Status TensorsToSegmentationCalculator::ProcessCpu(
     output_height = size.second;
   }
 
-  // Create initial working mask.
-  cv::Mat small_mask_mat(cv::Size(tensor_width, tensor_height), CV_32FC1);
-
-  // Wrap input tensor.
-  auto raw_input_tensor = &input_tensors[0];
-  auto raw_input_view = raw_input_tensor->GetCpuReadView();
-  const float* raw_input_data = raw_input_view.buffer<float>();
-  cv::Mat tensor_mat(cv::Size(tensor_width, tensor_height),
-                     CV_MAKETYPE(CV_32F, tensor_channels),
-                     const_cast<float*>(raw_input_data));
-
-  // Process mask tensor and apply activation function.
-  if (tensor_channels == 2) {
-    MP_RETURN_IF_ERROR(ApplyActivation<cv::Vec2f>(tensor_mat, &small_mask_mat));
-  } else if (tensor_channels == 1) {
-    RET_CHECK(mediapipe::TensorsToSegmentationCalculatorOptions::SOFTMAX !=
-              options_.activation());  // Requires 2 channels.
-    if (mediapipe::TensorsToSegmentationCalculatorOptions::NONE ==
-        options_.activation())  // Pass-through optimization.
-      tensor_mat.copyTo(small_mask_mat);
-    else
-      MP_RETURN_IF_ERROR(ApplyActivation<float>(tensor_mat, &small_mask_mat));
-  } else {
-    RET_CHECK_FAIL() << "Unsupported number of tensor channels "
-                     << tensor_channels;
-  }
-
-  // Send out image as CPU packet.
-  std::shared_ptr<ImageFrame> mask_frame = std::make_shared<ImageFrame>(
-      ImageFormat::VEC32F1, output_width, output_height);
-  std::unique_ptr<Image> output_mask = absl::make_unique<Image>(mask_frame);
-  auto output_mat = formats::MatView(output_mask.get());
-  // Upsample small mask into output.
-  cv::resize(small_mask_mat, *output_mat,
-             cv::Size(output_width, output_height));
-  cc->Outputs().Tag(kMaskTag).Add(output_mask.release(), cc->InputTimestamp());
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
-
-  return absl::OkStatus();
-}
-
-#if !MEDIAPIPE_DISABLE_OPENCV
-template <class T>
-absl::Status TensorsToSegmentationCalculator::ApplyActivation(
-    cv::Mat& tensor_mat, cv::Mat* small_mask_mat) {
-  // Configure activation function.
-  const int output_layer_index = options_.output_layer_index();
+  // Select the tensor channel that makes up the mask.
   typedef mediapipe::TensorsToSegmentationCalculatorOptions Options;
-  const auto activation_fn = [&](const cv::Vec2f& mask_value) {
-    float new_mask_value = 0;
-    // TODO consider moving switch out of the loop,
-    // and also avoid float/Vec2f casting.
-    switch (options_.activation()) {
-      case Options::NONE: {
-        new_mask_value = mask_value[0];
-        break;
-      }
-      case Options::SIGMOID: {
-        const float pixel0 = mask_value[0];
-        new_mask_value = 1.0 / (std::exp(-pixel0) + 1.0);
-        break;
-      }
-      case Options::SOFTMAX: {
-        const float pixel0 = mask_value[0];
-        const float pixel1 = mask_value[1];
-        const float max_pixel = std::max(pixel0, pixel1);
-        const float min_pixel = std::min(pixel0, pixel1);
-        const float softmax_denom =
-            /*exp(max_pixel - max_pixel)=*/1.0f +
-            std::exp(min_pixel - max_pixel);
-        new_mask_value = std::exp(mask_value[output_layer_index] - max_pixel) /
-                         softmax_denom;
-        break;
-      }
-    }
-    return new_mask_value;
-  };
+  SegmentationActivation activation;
+  int channel = 0;
+  switch (options_.activation()) {
+    case Options::NONE:
+      activation = SegmentationActivation::kNone;
+      break;
+    case Options::SIGMOID:
+      activation = SegmentationActivation::kSigmoid;
+      break;
+    case Options::SOFTMAX:
+      activation = SegmentationActivation::kSoftmax;
+      channel = options_.output_layer_index();
+      break;
+  }
 
-  // Process mask tensor.
-  for (int i = 0; i < tensor_mat.rows; ++i) {
-    for (int j = 0; j < tensor_mat.cols; ++j) {
-      const T& input_pix = tensor_mat.at<T>(i, j);
-      const float mask_value = activation_fn(input_pix);
-      small_mask_mat->at<float>(i, j) = mask_value;
-    }
+  // Activate and upsample the tensor straight into the output mask.
+  if (!mask_pool_ || mask_pool_->width() != output_width ||
+      mask_pool_->height() != output_height) {
+    mask_pool_ = ImageFramePool::Create(output_width, output_height,
+                                        ImageFormat::VEC32F1,
+                                        kMaskPoolKeepCount);
   }
+  ImageFrameSharedPtr mask_frame = mask_pool_->GetBuffer();
+  auto raw_input_view = input_tensors[0].GetCpuReadView();
+  ASSIGN_OR_RETURN(const float* raw_input,
+                   GetTensorFloatData(input_tensors[0], raw_input_view,
+                                      converted_input_));
+  ImageFrame* masks[] = {mask_frame.get()};
+  MP_RETURN_IF_ERROR(ComputeSegmentationMasks(
+      raw_input, tensor_height, tensor_width,
+      tensor_channels, activation, {channel}, masks, thread_pool_.get()));
+
+  // Send out image as CPU packet.
+  cc->Outputs().Tag(kMaskTag).Add(new Image(std::move(mask_frame)),
+                                  cc->InputTimestamp());
 
   return absl::OkStatus();
 }
-#endif  // !MEDIAPIPE_DISABLE_OPENCV
 
 // Steps:
 // 1. receive tensor
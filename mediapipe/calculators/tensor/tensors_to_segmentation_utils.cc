@@ -0,0 +1,310 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Eigen/Core"
+#include "absl/synchronization/blocking_counter.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Number of mask rows computed together. A tile activates and horizontally
+// resizes each tensor row it samples once.
+constexpr int kTileRows = 16;
+
+// The two source samples an output coordinate interpolates, and the weight of
+// the second one.
+struct Tap {
+  int first;
+  int second;
+  float weight;
+};
+
+// Computes the taps of every output coordinate as cv::resize does for
+// INTER_LINEAR: pixel centers are aligned and coordinates outside the source
+// are clamped to its border.
+std::vector<Tap> ComputeTaps(int src_size, int dst_size) {
+  std::vector<Tap> taps(dst_size);
+  const double scale = static_cast<double>(src_size) / dst_size;
+  for (int i = 0; i < dst_size; ++i) {
+    float position = static_cast<float>((i + 0.5) * scale - 0.5);
+    int first = static_cast<int>(std::floor(position));
+    float weight = position - first;
+    if (first < 0) {
+      first = 0;
+      weight = 0.f;
+    }
+    if (first >= src_size - 1) {
+      first = src_size - 1;
+      weight = 0.f;
+    }
+    taps[i] = {first, std::min(first + 1, src_size - 1), weight};
+  }
+  return taps;
+}
+
+class MaskComputer {
+ public:
+  MaskComputer(const float* tensor, int tensor_height, int tensor_width,
+               int tensor_channels, SegmentationActivation activation,
+               absl::Span<const int> channels,
+               absl::Span<ImageFrame* const> masks)
+      : tensor_(tensor),
+        tensor_width_(tensor_width),
+        tensor_channels_(tensor_channels),
+        activation_(activation),
+        channels_(channels),
+        masks_(masks),
+        mask_width_(masks[0]->Width()),
+        x_taps_(ComputeTaps(tensor_width, mask_width_)),
+        y_taps_(ComputeTaps(tensor_height, masks[0]->Height())) {}
+
+  // Computes the mask rows in [row_begin, row_end).
+  void ComputeRows(int row_begin, int row_end) const {
+    // Scratch buffers, reused across tiles.
+    Eigen::ArrayXXf pixels(tensor_width_, tensor_channels_);
+    Eigen::ArrayXXf activated(tensor_width_, channels_.size());
+    std::vector<Eigen::ArrayXXf> resized(channels_.size());
+
+    for (int tile_begin = row_begin; tile_begin < row_end;
+         tile_begin += kTileRows) {
+      const int tile_end = std::min(tile_begin + kTileRows, row_end);
+      const int src_begin = y_taps_[tile_begin].first;
+      const int src_end = y_taps_[tile_end - 1].second + 1;
+
+      // Activate the sampled tensor rows and resize them horizontally. Each
+      // column of resized[i] is a row of mask i at its final width.
+      for (auto& rows : resized) {
+        rows.resize(mask_width_, src_end - src_begin);
+      }
+      for (int src_row = src_begin; src_row < src_end; ++src_row) {
+        ActivateRow(src_row, &pixels, &activated);
+        for (int i = 0; i < channels_.size(); ++i) {
+          const float* values = &activated(0, i);
+          float* row = &resized[i](0, src_row - src_begin);
+          for (int x = 0; x < mask_width_; ++x) {
+            const Tap& tap = x_taps_[x];
+            row[x] = values[tap.first] * (1.f - tap.weight) +
+                     values[tap.second] * tap.weight;
+          }
+        }
+      }
+
+      // Blend them vertically into the masks.
+      for (int y = tile_begin; y < tile_end; ++y) {
+        const Tap& tap = y_taps_[y];
+        for (int i = 0; i < channels_.size(); ++i) {
+          Eigen::Map<Eigen::ArrayXf> mask_row(
+              reinterpret_cast<float*>(masks_[i]->MutablePixelData() +
+                                       y * masks_[i]->WidthStep()),
+              mask_width_);
+          mask_row =
+              resized[i].col(tap.first - src_begin) * (1.f - tap.weight) +
+              resized[i].col(tap.second - src_begin) * tap.weight;
+        }
+      }
+    }
+  }
+
+ private:
+  // Writes the activated values of the requested channels of a tensor row to
+  // the columns of "activated". "pixels" is scratch space for the row in
+  // planar layout.
+  void ActivateRow(int src_row, Eigen::ArrayXXf* pixels,
+                   Eigen::ArrayXXf* activated) const {
+    const float* row = tensor_ + src_row * tensor_width_ * tensor_channels_;
+    *pixels = Eigen::Map<const Eigen::Array<float, Eigen::Dynamic,
+                                            Eigen::Dynamic, Eigen::RowMajor>>(
+        row, tensor_width_, tensor_channels_);
+    switch (activation_) {
+      case SegmentationActivation::kNone:
+        for (int i = 0; i < channels_.size(); ++i) {
+          activated->col(i) = pixels->col(channels_[i]);
+        }
+        break;
+      case SegmentationActivation::kSigmoid:
+        for (int i = 0; i < channels_.size(); ++i) {
+          activated->col(i) =
+              ((-pixels->col(channels_[i])).exp() + 1.f).inverse();
+        }
+        break;
+      case SegmentationActivation::kSoftmax: {
+        // Subtracting the maximum keeps exp() from overflowing.
+        Eigen::ArrayXf max_value = pixels->col(0);
+        for (int c = 1; c < tensor_channels_; ++c) {
+          max_value = max_value.max(pixels->col(c));
+        }
+        Eigen::ArrayXf denominator = Eigen::ArrayXf::Zero(tensor_width_);
+        for (int c = 0; c < tensor_channels_; ++c) {
+          pixels->col(c) = (pixels->col(c) - max_value).exp();
+          denominator += pixels->col(c);
+        }
+        for (int i = 0; i < channels_.size(); ++i) {
+          activated->col(i) = pixels->col(channels_[i]) / denominator;
+        }
+        break;
+      }
+    }
+  }
+
+  const float* tensor_;
+  const int tensor_width_;
+  const int tensor_channels_;
+  const SegmentationActivation activation_;
+  const absl::Span<const int> channels_;
+  const absl::Span<ImageFrame* const> masks_;
+  const int mask_width_;
+  const std::vector<Tap> x_taps_;
+  const std::vector<Tap> y_taps_;
+};
+
+// Computes the source coordinate every output coordinate samples, as cv::resize
+// does for INTER_NEAREST.
+std::vector<int> ComputeNearestIndices(int src_size, int dst_size) {
+  std::vector<int> indices(dst_size);
+  const double scale = static_cast<double>(src_size) / dst_size;
+  for (int i = 0; i < dst_size; ++i) {
+    indices[i] =
+        std::min(static_cast<int>(std::floor(i * scale)), src_size - 1);
+  }
+  return indices;
+}
+
+// Returns the index of the first highest score.
+inline uint8_t ArgMax(const float* scores, int num_scores) {
+  int max_index = 0;
+  float max_score = scores[0];
+  for (int i = 1; i < num_scores; ++i) {
+    if (scores[i] > max_score) {
+      max_score = scores[i];
+      max_index = i;
+    }
+  }
+  return max_index;
+}
+
+// Calls "compute_rows(row_begin, row_end)" on contiguous ranges of whole tiles
+// of the "num_rows" rows, split between the threads of "thread_pool" if it is
+// not null, and returns once all of them are done.
+template <typename ComputeRows>
+void ComputeRowsInChunks(int num_rows, ThreadPool* thread_pool,
+                         const ComputeRows& compute_rows) {
+  const int num_tiles = (num_rows + kTileRows - 1) / kTileRows;
+  const int num_chunks =
+      thread_pool ? std::min(thread_pool->num_threads(), num_tiles) : 1;
+  if (num_chunks <= 1) {
+    compute_rows(0, num_rows);
+    return;
+  }
+  absl::BlockingCounter counter(num_chunks);
+  for (int chunk = 0; chunk < num_chunks; ++chunk) {
+    const int row_begin = num_tiles * chunk / num_chunks * kTileRows;
+    const int row_end =
+        std::min(num_tiles * (chunk + 1) / num_chunks * kTileRows, num_rows);
+    thread_pool->Schedule([&compute_rows, &counter, row_begin, row_end] {
+      compute_rows(row_begin, row_end);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+}
+
+}  // namespace
+
+absl::Status ComputeSegmentationMasks(const float* tensor, int tensor_height,
+                                      int tensor_width, int tensor_channels,
+                                      SegmentationActivation activation,
+                                      absl::Span<const int> channels,
+                                      absl::Span<ImageFrame* const> masks,
+                                      ThreadPool* thread_pool) {
+  RET_CHECK(tensor_height > 0 && tensor_width > 0 && tensor_channels > 0);
+  RET_CHECK_EQ(channels.size(), masks.size());
+  if (masks.empty()) {
+    return absl::OkStatus();
+  }
+  for (int channel : channels) {
+    RET_CHECK(channel >= 0 && channel < tensor_channels)
+        << "Invalid channel " << channel << " for a tensor with "
+        << tensor_channels << " channels.";
+  }
+  const int mask_width = masks[0]->Width();
+  const int mask_height = masks[0]->Height();
+  for (const ImageFrame* mask : masks) {
+    RET_CHECK_EQ(mask->Format(), ImageFormat::VEC32F1);
+    RET_CHECK(mask->Width() == mask_width && mask->Height() == mask_height)
+        << "All masks must have the same dimensions.";
+  }
+  if (mask_width == 0 || mask_height == 0) {
+    return absl::OkStatus();
+  }
+
+  const MaskComputer computer(tensor, tensor_height, tensor_width,
+                              tensor_channels, activation, channels, masks);
+  ComputeRowsInChunks(mask_height, thread_pool,
+                      [&computer](int row_begin, int row_end) {
+                        computer.ComputeRows(row_begin, row_end);
+                      });
+  return absl::OkStatus();
+}
+
+absl::Status ComputeCategoryMask(const float* tensor, int tensor_height,
+                                 int tensor_width, int tensor_channels,
+                                 ImageFrame* mask, ThreadPool* thread_pool) {
+  RET_CHECK(tensor_height > 0 && tensor_width > 0 && tensor_channels > 0);
+  RET_CHECK_LE(tensor_channels, 256)
+      << "A category mask holds at most 256 categories.";
+  RET_CHECK_EQ(mask->Format(), ImageFormat::GRAY8);
+  const int mask_width = mask->Width();
+  const int mask_height = mask->Height();
+  if (mask_width == 0 || mask_height == 0) {
+    return absl::OkStatus();
+  }
+
+  const std::vector<int> x_indices =
+      ComputeNearestIndices(tensor_width, mask_width);
+  const std::vector<int> y_indices =
+      ComputeNearestIndices(tensor_height, mask_height);
+  ComputeRowsInChunks(mask_height, thread_pool, [&](int row_begin,
+                                                    int row_end) {
+    for (int y = row_begin; y < row_end; ++y) {
+      uint8_t* mask_row = mask->MutablePixelData() + y * mask->WidthStep();
+      // Rows sampling the same tensor row, as when upscaling, are copies.
+      if (y > row_begin && y_indices[y] == y_indices[y - 1]) {
+        std::memcpy(mask_row, mask_row - mask->WidthStep(), mask_width);
+        continue;
+      }
+      const float* tensor_row =
+          tensor + y_indices[y] * tensor_width * tensor_channels;
+      for (int x = 0; x < mask_width; ++x) {
+        mask_row[x] = x > 0 && x_indices[x] == x_indices[x - 1]
+                          ? mask_row[x - 1]
+                          : ArgMax(tensor_row + x_indices[x] * tensor_channels,
+                                   tensor_channels);
+      }
+    }
+  });
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
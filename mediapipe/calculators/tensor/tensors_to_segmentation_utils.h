@@ -0,0 +1,64 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_TENSORS_TO_SEGMENTATION_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_TENSORS_TO_SEGMENTATION_UTILS_H_
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// Activation applied across the channels of every pixel of a segmentation
+// tensor.
+enum class SegmentationActivation { kNone, kSigmoid, kSoftmax };
+
+// Computes confidence masks from a float segmentation tensor in HWC layout on
+// CPU. The activation is applied to every tensor pixel, then each requested
+// channel is resized bilinearly into its mask, using the same sampling as
+// cv::resize with INTER_LINEAR.
+//
+// "masks[i]" receives tensor channel "channels[i]". The masks must be VEC32F1
+// frames of the same dimensions, which may differ from the tensor's.
+//
+// Activation and resizing are fused: the masks are computed in tiles of rows,
+// and only the tensor rows a tile samples are activated, into a small scratch
+// buffer. If "thread_pool" is not null, the rows are split between its
+// threads, and the call returns once all of them are done.
+absl::Status ComputeSegmentationMasks(const float* tensor, int tensor_height,
+                                      int tensor_width, int tensor_channels,
+                                      SegmentationActivation activation,
+                                      absl::Span<const int> channels,
+                                      absl::Span<ImageFrame* const> masks,
+                                      ThreadPool* thread_pool = nullptr);
+
+// Computes a category mask from a float segmentation tensor in HWC layout on
+// CPU: every pixel of the GRAY8 "mask" receives the index of the highest
+// scoring tensor channel. The mask samples the tensor as cv::resize does with
+// INTER_NEAREST.
+//
+// No activation is needed, since softmax and sigmoid preserve the highest
+// score, and no per-channel buffer is allocated: the argmax is computed only
+// for the tensor pixels the mask samples, straight into the mask. If
+// "thread_pool" is not null, the rows are split between its threads.
+absl::Status ComputeCategoryMask(const float* tensor, int tensor_height,
+                                 int tensor_width, int tensor_channels,
+                                 ImageFrame* mask,
+                                 ThreadPool* thread_pool = nullptr);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_TENSORS_TO_SEGMENTATION_UTILS_H_
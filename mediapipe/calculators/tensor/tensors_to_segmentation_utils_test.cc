@@ -0,0 +1,220 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+float At(const ImageFrame& frame, int x, int y) {
+  return reinterpret_cast<const float*>(frame.PixelData() +
+                                        y * frame.WidthStep())[x];
+}
+
+// Straightforward per-pixel version of ComputeSegmentationMasks: activates the
+// whole tensor, then resizes as cv::resize does with INTER_LINEAR.
+std::vector<float> ReferenceMask(const std::vector<float>& tensor, int height,
+                                 int width, int channels,
+                                 SegmentationActivation activation,
+                                 int channel, int mask_width,
+                                 int mask_height) {
+  std::vector<float> activated(height * width);
+  for (int i = 0; i < height * width; ++i) {
+    const float* pixel = &tensor[i * channels];
+    switch (activation) {
+      case SegmentationActivation::kNone:
+        activated[i] = pixel[channel];
+        break;
+      case SegmentationActivation::kSigmoid:
+        activated[i] = 1.f / (1.f + std::exp(-pixel[channel]));
+        break;
+      case SegmentationActivation::kSoftmax: {
+        const float max_value = *std::max_element(pixel, pixel + channels);
+        float sum = 0.f;
+        for (int c = 0; c < channels; ++c) {
+          sum += std::exp(pixel[c] - max_value);
+        }
+        activated[i] = std::exp(pixel[channel] - max_value) / sum;
+        break;
+      }
+    }
+  }
+  const auto sample = [](float position, int size, int* first, int* second,
+                         float* weight) {
+    *first = std::floor(position);
+    *weight = position - *first;
+    if (*first < 0) {
+      *first = 0;
+      *weight = 0;
+    }
+    if (*first >= size - 1) {
+      *first = size - 1;
+      *weight = 0;
+    }
+    *second = std::min(*first + 1, size - 1);
+  };
+  std::vector<float> mask(mask_height * mask_width);
+  for (int y = 0; y < mask_height; ++y) {
+    int y0, y1, x0, x1;
+    float wy, wx;
+    sample((y + 0.5) * height / mask_height - 0.5, height, &y0, &y1, &wy);
+    for (int x = 0; x < mask_width; ++x) {
+      sample((x + 0.5) * width / mask_width - 0.5, width, &x0, &x1, &wx);
+      const float top = activated[y0 * width + x0] * (1 - wx) +
+                        activated[y0 * width + x1] * wx;
+      const float bottom = activated[y1 * width + x0] * (1 - wx) +
+                           activated[y1 * width + x1] * wx;
+      mask[y * mask_width + x] = top * (1 - wy) + bottom * wy;
+    }
+  }
+  return mask;
+}
+
+TEST(TensorsToSegmentationUtilsTest, MatchesReference) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> value(-8.f, 8.f);
+  ThreadPool thread_pool("segmentation_test", 3);
+  thread_pool.StartWorkers();
+
+  struct Size {
+    int width;
+    int height;
+  };
+  constexpr Size kTensorSize = {20, 13};
+  for (int channels : {1, 2, 3}) {
+    std::vector<float> tensor(kTensorSize.width * kTensorSize.height *
+                              channels);
+    for (float& v : tensor) v = value(rng);
+    for (auto activation :
+         {SegmentationActivation::kNone, SegmentationActivation::kSigmoid,
+          SegmentationActivation::kSoftmax}) {
+      for (Size mask_size : {Size{20, 13}, Size{67, 101}, Size{7, 5}}) {
+        for (ThreadPool* pool : {static_cast<ThreadPool*>(nullptr),
+                                 &thread_pool}) {
+          SCOPED_TRACE(absl::StrCat(channels, " ", static_cast<int>(activation),
+                                    " ", mask_size.width, "x",
+                                    mask_size.height, " ", pool != nullptr));
+          std::vector<int> mask_channels;
+          std::vector<std::unique_ptr<ImageFrame>> frames;
+          std::vector<ImageFrame*> masks;
+          for (int c = channels - 1; c >= 0; --c) {
+            mask_channels.push_back(c);
+            frames.push_back(std::make_unique<ImageFrame>(
+                ImageFormat::VEC32F1, mask_size.width, mask_size.height));
+            masks.push_back(frames.back().get());
+          }
+          MP_ASSERT_OK(ComputeSegmentationMasks(
+              tensor.data(), kTensorSize.height, kTensorSize.width, channels,
+              activation, mask_channels, masks, pool));
+          for (int i = 0; i < masks.size(); ++i) {
+            std::vector<float> expected = ReferenceMask(
+                tensor, kTensorSize.height, kTensorSize.width, channels,
+                activation, mask_channels[i], mask_size.width,
+                mask_size.height);
+            for (int y = 0; y < mask_size.height; ++y) {
+              for (int x = 0; x < mask_size.width; ++x) {
+                ASSERT_NEAR(At(*masks[i], x, y),
+                            expected[y * mask_size.width + x], 1e-5)
+                    << "at " << x << "," << y;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(TensorsToSegmentationUtilsTest, CategoryMaskMatchesReference) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> value(-8.f, 8.f);
+  ThreadPool thread_pool("segmentation_test", 3);
+  thread_pool.StartWorkers();
+
+  constexpr int kTensorWidth = 20;
+  constexpr int kTensorHeight = 13;
+  constexpr int kChannels = 5;
+  std::vector<float> tensor(kTensorWidth * kTensorHeight * kChannels);
+  for (float& v : tensor) v = value(rng);
+  for (auto [mask_width, mask_height] :
+       {std::pair(20, 13), std::pair(67, 101), std::pair(7, 5)}) {
+    for (ThreadPool* pool :
+         {static_cast<ThreadPool*>(nullptr), &thread_pool}) {
+      SCOPED_TRACE(absl::StrCat(mask_width, "x", mask_height, " ",
+                                pool != nullptr));
+      ImageFrame mask(ImageFormat::GRAY8, mask_width, mask_height);
+      MP_ASSERT_OK(ComputeCategoryMask(tensor.data(), kTensorHeight,
+                                       kTensorWidth, kChannels, &mask, pool));
+      // Nearest neighbor sampling as in cv::resize with INTER_NEAREST.
+      for (int y = 0; y < mask_height; ++y) {
+        const int src_y = std::min(y * kTensorHeight / mask_height,
+                                   kTensorHeight - 1);
+        for (int x = 0; x < mask_width; ++x) {
+          const int src_x =
+              std::min(x * kTensorWidth / mask_width, kTensorWidth - 1);
+          const float* pixel =
+              &tensor[(src_y * kTensorWidth + src_x) * kChannels];
+          const int expected =
+              std::max_element(pixel, pixel + kChannels) - pixel;
+          ASSERT_EQ(mask.PixelData()[y * mask.WidthStep() + x], expected)
+              << "at " << x << "," << y;
+        }
+      }
+    }
+  }
+}
+
+TEST(TensorsToSegmentationUtilsTest, RejectsInvalidArguments) {
+  std::vector<float> tensor(4 * 4 * 2);
+  ImageFrame mask(ImageFormat::VEC32F1, 8, 8);
+  ImageFrame smaller_mask(ImageFormat::VEC32F1, 4, 4);
+  ImageFrame gray_mask(ImageFormat::GRAY8, 8, 8);
+  std::vector<ImageFrame*> masks = {&mask};
+  EXPECT_FALSE(ComputeSegmentationMasks(tensor.data(), 4, 4, 2,
+                                        SegmentationActivation::kSoftmax, {2},
+                                        masks)
+                   .ok());
+  EXPECT_FALSE(ComputeSegmentationMasks(tensor.data(), 4, 4, 2,
+                                        SegmentationActivation::kSoftmax,
+                                        {0, 1}, masks)
+                   .ok());
+  masks = {&mask, &smaller_mask};
+  EXPECT_FALSE(ComputeSegmentationMasks(tensor.data(), 4, 4, 2,
+                                        SegmentationActivation::kSoftmax,
+                                        {0, 1}, masks)
+                   .ok());
+  masks = {&gray_mask};
+  EXPECT_FALSE(ComputeSegmentationMasks(tensor.data(), 4, 4, 2,
+                                        SegmentationActivation::kSoftmax, {0},
+                                        masks)
+                   .ok());
+  EXPECT_FALSE(ComputeCategoryMask(tensor.data(), 4, 4, 2, &mask).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,11 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_format.h"
 #include "mediapipe/calculators/image/opencv_image_encoder_calculator.pb.h"
 #include "mediapipe/calculators/tensorflow/pack_media_sequence_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -31,10 +36,14 @@
 #include "mediapipe/util/sequence/media_sequence_util.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace mediapipe {
 
 const char kSequenceExampleTag[] = "SEQUENCE_EXAMPLE";
+const char kChunkOutputPathTag[] = "CHUNK_OUTPUT_PATH";
 const char kImageTag[] = "IMAGE";
 const char kFloatContextFeaturePrefixTag[] = "FLOAT_CONTEXT_FEATURE_";
 const char kFloatFeaturePrefixTag[] = "FLOAT_FEATURE_";
@@ -88,6 +97,26 @@ namespace mpms = mediapipe::mediasequence;
 //     }
 //   }
 // }
+//
+// For long clips, holding every encoded image and feature until Close can take
+// more memory than available. If the CHUNK_OUTPUT_PATH input side packet is
+// set, the feature lists are instead flushed once they reach max_chunk_bytes
+// and written as SequenceExample chunks to the TFRecord shards
+// "${CHUNK_OUTPUT_PATH}-00000", "${CHUNK_OUTPUT_PATH}-00001", etc. Each chunk
+// holds the context, the feature lists since the previous chunk, and the
+// chunk/start/timestamp and chunk/end/timestamp of its feature lists, so that
+// UnpackMediaSequenceCalculator can seek without parsing the feature lists.
+// Metadata is reconciled per chunk. The output SequenceExample then only holds
+// the context.
+//
+// Example config:
+// node {
+//   calculator: "PackMediaSequenceCalculator"
+//   input_side_packet: "SEQUENCE_EXAMPLE:example_input_side_packet"
+//   input_side_packet: "CHUNK_OUTPUT_PATH:chunk_output_path"
+//   input_stream: "IMAGE:frames"
+//   output_stream: "SEQUENCE_EXAMPLE:example_output_stream"
+// }
 namespace {
 uint8 ConvertFloatToByte(const float float_value) {
   float clamped_value = std::clamp(0.0f, 1.0f, float_value);
@@ -100,6 +129,9 @@ class PackMediaSequenceCalculator : public CalculatorBase {
   static absl::Status GetContract(CalculatorContract* cc) {
     RET_CHECK(cc->InputSidePackets().HasTag(kSequenceExampleTag));
     cc->InputSidePackets().Tag(kSequenceExampleTag).Set<tf::SequenceExample>();
+    if (cc->InputSidePackets().HasTag(kChunkOutputPathTag)) {
+      cc->InputSidePackets().Tag(kChunkOutputPathTag).Set<std::string>();
+    }
 
     if (cc->Inputs().HasTag(kForwardFlowEncodedTag)) {
       cc->Inputs()
@@ -194,6 +226,18 @@ class PackMediaSequenceCalculator : public CalculatorBase {
       features_present_[tag] = false;
     }
 
+    if (cc->InputSidePackets().HasTag(kChunkOutputPathTag)) {
+      chunk_output_path_ =
+          cc->InputSidePackets().Tag(kChunkOutputPathTag).Get<std::string>();
+      RET_CHECK(!chunk_output_path_.empty());
+      RET_CHECK_GT(
+          cc->Options<PackMediaSequenceCalculatorOptions>().max_chunk_bytes(),
+          0);
+      RET_CHECK_GT(cc->Options<PackMediaSequenceCalculatorOptions>()
+                       .max_chunks_per_shard(),
+                   0);
+    }
+
     replace_keypoints_ = false;
     if (cc->Options<PackMediaSequenceCalculatorOptions>()
             .replace_data_instead_of_append()) {
@@ -284,27 +328,102 @@ class PackMediaSequenceCalculator : public CalculatorBase {
     }
   }
 
-  absl::Status VerifySize() {
+  absl::Status VerifySize(const tf::SequenceExample& sequence) {
     const int64 MAX_PROTO_BYTES = 1073741823;
-    std::string id = mpms::HasExampleId(*sequence_)
-                         ? mpms::GetExampleId(*sequence_)
+    std::string id = mpms::HasExampleId(sequence)
+                         ? mpms::GetExampleId(sequence)
                          : "example";
-    RET_CHECK_LT(sequence_->ByteSizeLong(), MAX_PROTO_BYTES)
+    RET_CHECK_LT(sequence.ByteSizeLong(), MAX_PROTO_BYTES)
         << "sequence '" << id
         << "' would be too many bytes to serialize after adding features.";
     return absl::OkStatus();
   }
 
-  absl::Status Close(CalculatorContext* cc) override {
-    auto& options = cc->Options<PackMediaSequenceCalculatorOptions>();
+  // Moves the feature lists collected so far into a chunk and appends it to
+  // the current TFRecord shard.
+  absl::Status FlushChunk(const PackMediaSequenceCalculatorOptions& options) {
+    if (sequence_->feature_lists().feature_list().empty()) {
+      return absl::OkStatus();
+    }
+    tf::SequenceExample chunk;
+    *chunk.mutable_context() = sequence_->context();
+    chunk.mutable_feature_lists()->Swap(sequence_->mutable_feature_lists());
+
+    int64 start_timestamp = std::numeric_limits<int64>::max();
+    int64 end_timestamp = std::numeric_limits<int64>::min();
+    for (const auto& map_kv : chunk.feature_lists().feature_list()) {
+      if (!absl::StrContains(map_kv.first, "/timestamp")) continue;
+      for (const auto& feature : map_kv.second.feature()) {
+        for (const int64 timestamp : feature.int64_list().value()) {
+          start_timestamp = std::min(start_timestamp, timestamp);
+          end_timestamp = std::max(end_timestamp, timestamp);
+        }
+      }
+    }
+    if (start_timestamp <= end_timestamp) {
+      mpms::SetChunkStartTimestamp(start_timestamp, &chunk);
+      mpms::SetChunkEndTimestamp(end_timestamp, &chunk);
+    }
     if (options.reconcile_metadata()) {
       RET_CHECK_OK(mpms::ReconcileMetadata(
           options.reconcile_bbox_annotations(),
-          options.reconcile_region_annotations(), sequence_.get()));
+          options.reconcile_region_annotations(), &chunk));
     }
-
     if (options.skip_large_sequences()) {
-      RET_CHECK_OK(VerifySize());
+      RET_CHECK_OK(VerifySize(chunk));
+    }
+
+    if (chunk_writer_ == nullptr ||
+        chunks_in_shard_ == options.max_chunks_per_shard()) {
+      MP_RETURN_IF_ERROR(CloseShard());
+      const std::string path =
+          absl::StrFormat("%s-%05d", chunk_output_path_, num_shards_);
+      auto tf_status =
+          tf::Env::Default()->NewWritableFile(path, &chunk_output_file_);
+      RET_CHECK(tf_status.ok())
+          << "Failed to open tfrecord file: " << tf_status.ToString();
+      chunk_writer_ =
+          absl::make_unique<tf::io::RecordWriter>(chunk_output_file_.get());
+      ++num_shards_;
+      chunks_in_shard_ = 0;
+    }
+    auto tf_status = chunk_writer_->WriteRecord(chunk.SerializeAsString());
+    RET_CHECK(tf_status.ok())
+        << "Failed to write tfrecord: " << tf_status.ToString();
+    ++chunks_in_shard_;
+    return absl::OkStatus();
+  }
+
+  absl::Status CloseShard() {
+    if (chunk_writer_ == nullptr) {
+      return absl::OkStatus();
+    }
+    auto tf_status = chunk_writer_->Close();
+    if (tf_status.ok()) {
+      tf_status = chunk_output_file_->Close();
+    }
+    RET_CHECK(tf_status.ok())
+        << "Failed to close tfrecord file: " << tf_status.ToString();
+    chunk_writer_.reset();
+    chunk_output_file_.reset();
+    return absl::OkStatus();
+  }
+
+  absl::Status Close(CalculatorContext* cc) override {
+    auto& options = cc->Options<PackMediaSequenceCalculatorOptions>();
+    if (!chunk_output_path_.empty()) {
+      MP_RETURN_IF_ERROR(FlushChunk(options));
+      MP_RETURN_IF_ERROR(CloseShard());
+    } else {
+      if (options.reconcile_metadata()) {
+        RET_CHECK_OK(mpms::ReconcileMetadata(
+            options.reconcile_bbox_annotations(),
+            options.reconcile_region_annotations(), sequence_.get()));
+      }
+
+      if (options.skip_large_sequences()) {
+        RET_CHECK_OK(VerifySize(*sequence_));
+      }
     }
     if (options.output_only_if_all_present()) {
       absl::Status status = VerifySequence();
@@ -548,12 +667,27 @@ class PackMediaSequenceCalculator : public CalculatorBase {
         }
       }
     }
+    // ByteSizeLong() is linear in the number of features, not in their size.
+    if (!chunk_output_path_.empty() &&
+        sequence_->feature_lists().ByteSizeLong() >=
+            cc->Options<PackMediaSequenceCalculatorOptions>()
+                .max_chunk_bytes()) {
+      MP_RETURN_IF_ERROR(
+          FlushChunk(cc->Options<PackMediaSequenceCalculatorOptions>()));
+    }
     return absl::OkStatus();
   }
 
   std::unique_ptr<tf::SequenceExample> sequence_;
   std::map<std::string, bool> features_present_;
   bool replace_keypoints_;
+
+  // Output of the feature lists in chunks, if CHUNK_OUTPUT_PATH is set.
+  std::string chunk_output_path_;
+  std::unique_ptr<tf::WritableFile> chunk_output_file_;
+  std::unique_ptr<tf::io::RecordWriter> chunk_writer_;
+  int num_shards_ = 0;
+  int chunks_in_shard_ = 0;
 };
 REGISTER_CALCULATOR(PackMediaSequenceCalculator);
 
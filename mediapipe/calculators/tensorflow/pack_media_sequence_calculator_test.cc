@@ -17,6 +17,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "mediapipe/calculators/image/opencv_image_encoder_calculator.pb.h"
 #include "mediapipe/calculators/tensorflow/pack_media_sequence_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -34,6 +35,9 @@
 #include "mediapipe/util/sequence/media_sequence.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace mediapipe {
 namespace {
@@ -61,8 +65,25 @@ constexpr char kIntFeatureOtherTag[] = "INT_FEATURE_OTHER";
 constexpr char kIntFeatureTestTag[] = "INT_FEATURE_TEST";
 constexpr char kImagePrefixTag[] = "IMAGE_PREFIX";
 constexpr char kSequenceExampleTag[] = "SEQUENCE_EXAMPLE";
+constexpr char kChunkOutputPathTag[] = "CHUNK_OUTPUT_PATH";
 constexpr char kImageTag[] = "IMAGE";
 
+// Reads all SequenceExamples of a TFRecord file.
+std::vector<tf::SequenceExample> ReadRecords(const std::string& path) {
+  std::vector<tf::SequenceExample> sequences;
+  std::unique_ptr<tf::RandomAccessFile> file;
+  EXPECT_TRUE(tf::Env::Default()->NewRandomAccessFile(path, &file).ok());
+  if (file == nullptr) return sequences;
+  tf::io::RecordReader reader(file.get());
+  tf::uint64 offset = 0;
+  tf::tstring record;
+  while (reader.ReadRecord(&offset, &record).ok()) {
+    sequences.emplace_back();
+    EXPECT_TRUE(sequences.back().ParseFromArray(record.data(), record.size()));
+  }
+  return sequences;
+}
+
 class PackMediaSequenceCalculatorTest : public ::testing::Test {
  protected:
   void SetUpCalculator(const std::vector<std::string>& input_streams,
@@ -220,6 +241,64 @@ TEST_F(PackMediaSequenceCalculatorTest, PacksTwoFloatLists) {
   }
 }
 
+TEST_F(PackMediaSequenceCalculatorTest, PacksFloatListsInChunks) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("PackMediaSequenceCalculator");
+  config.add_input_side_packet("SEQUENCE_EXAMPLE:input_sequence");
+  config.add_input_side_packet("CHUNK_OUTPUT_PATH:chunk_output_path");
+  config.add_input_stream("FLOAT_FEATURE_TEST:test");
+  config.add_output_stream("SEQUENCE_EXAMPLE:output_sequence");
+  auto options = config.mutable_options()->MutableExtension(
+      PackMediaSequenceCalculatorOptions::ext);
+  // Flushes a chunk after every timestep.
+  options->set_max_chunk_bytes(1);
+  options->set_max_chunks_per_shard(2);
+  runner_ = ::absl::make_unique<CalculatorRunner>(config);
+
+  auto input_sequence = ::absl::make_unique<tf::SequenceExample>();
+  std::string test_video_id = "test_video_id";
+  mpms::SetClipMediaId(test_video_id, input_sequence.get());
+  int num_timesteps = 3;
+  for (int i = 0; i < num_timesteps; ++i) {
+    auto vf_ptr = ::absl::make_unique<std::vector<float>>(2, 2 << i);
+    runner_->MutableInputs()
+        ->Tag(kFloatFeatureTestTag)
+        .packets.push_back(Adopt(vf_ptr.release()).At(Timestamp(i)));
+  }
+  const std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/packs_float_lists_in_chunks");
+  runner_->MutableSidePackets()->Tag(kSequenceExampleTag) =
+      Adopt(input_sequence.release());
+  runner_->MutableSidePackets()->Tag(kChunkOutputPathTag) =
+      MakePacket<std::string>(path);
+
+  MP_ASSERT_OK(runner_->Run());
+
+  const std::vector<Packet>& output_packets =
+      runner_->Outputs().Tag(kSequenceExampleTag).packets;
+  ASSERT_EQ(1, output_packets.size());
+  const tf::SequenceExample& output_sequence =
+      output_packets[0].Get<tf::SequenceExample>();
+  ASSERT_EQ(test_video_id, mpms::GetClipMediaId(output_sequence));
+  ASSERT_EQ(0, mpms::GetFeatureTimestampSize("TEST", output_sequence));
+
+  std::vector<tf::SequenceExample> chunks = ReadRecords(path + "-00000");
+  ASSERT_EQ(2, chunks.size());
+  for (const auto& chunk : ReadRecords(path + "-00001")) {
+    chunks.push_back(chunk);
+  }
+  ASSERT_EQ(num_timesteps, chunks.size());
+  for (int i = 0; i < num_timesteps; ++i) {
+    ASSERT_EQ(test_video_id, mpms::GetClipMediaId(chunks[i]));
+    ASSERT_EQ(i, mpms::GetChunkStartTimestamp(chunks[i]));
+    ASSERT_EQ(i, mpms::GetChunkEndTimestamp(chunks[i]));
+    ASSERT_EQ(1, mpms::GetFeatureTimestampSize("TEST", chunks[i]));
+    ASSERT_EQ(i, mpms::GetFeatureTimestampAt("TEST", chunks[i], 0));
+    ASSERT_THAT(mpms::GetFeatureFloatsAt("TEST", chunks[i], 0),
+                ::testing::ElementsAreArray(std::vector<float>(2, 2 << i)));
+  }
+}
+
 TEST_F(PackMediaSequenceCalculatorTest, PacksTwoIntLists) {
   SetUpCalculator({"INT_FEATURE_TEST:test", "INT_FEATURE_OTHER:test2"}, {},
                   false, true);
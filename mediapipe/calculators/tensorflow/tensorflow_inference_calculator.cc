@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
@@ -23,6 +24,8 @@
 #include "absl/memory/memory.h"
 #include "absl/strings/str_split.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/types/optional.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_inference_calculator.pb.h"
 #include "mediapipe/calculators/tensorflow/tensorflow_session.h"
 #include "mediapipe/framework/calculator_context.h"
@@ -34,6 +37,7 @@
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/framework/timestamp.h"
 #include "mediapipe/framework/tool/status_util.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -99,6 +103,21 @@ class InferenceState {
   std::vector<Timestamp> batch_timestamps_;
 };
 
+// A batch whose session run was started on a worker thread, in the pipelined
+// mode of TensorflowInferenceCalculator.
+struct InFlightBatch {
+  std::unique_ptr<InferenceState> inference_state;
+  std::vector<std::string> output_name_in_signature;
+  // Set by the worker thread before notifying `done`.
+  std::vector<tf::Tensor> outputs;
+  tf::Status status;
+  int64 run_start_time = 0;
+  int64 run_end_time = 0;
+  // The start of OutputBatch(), for the TotalTimeUsecs counter.
+  int64 start_time = 0;
+  absl::Notification done;
+};
+
 }  // namespace
 
 // This calculator performs inference on a trained TensorFlow model.
@@ -134,6 +153,11 @@ class InferenceState {
 // recurrent tensors. Initializing the recurrent state can be handled by the
 // GraphTensorsPacketGenerator.
 //
+// Setting max_in_flight_batches pipelines the session runs: each batch runs on
+// a worker thread through a callable made by Session::MakeCallable, while the
+// calculator thread assembles the next batch. Outputs of finished batches are
+// emitted in order by the following Process() calls and by Close().
+//
 // The calculator updates two Counters to report timing information:
 //   --<name>-TotalTimeUsecs = Total time spent running inference (in usecs),
 //   --<name>-TotalProcessedTimestamps = # of instances processed
@@ -343,7 +367,15 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
       inference_state_ = std::unique_ptr<InferenceState>();
     }
 
-    if (options_.batch_size() == 1 || options_.batched_input()) {
+    // In the pipelined mode, outputs are emitted after later inputs arrive, so
+    // their timestamps have no offset from the input timestamps.
+    if (options_.max_in_flight_batches() > 0) {
+      RET_CHECK(options_.recurrent_tag_pair().empty())
+          << "recurrent_tag_pair is not supported with max_in_flight_batches.";
+      session_run_pool_ = absl::make_unique<ThreadPool>(
+          "mediapipe_tf_inference", options_.max_in_flight_batches());
+      session_run_pool_->StartWorkers();
+    } else if (options_.batch_size() == 1 || options_.batched_input()) {
       cc->SetOffset(0);
     }
 
@@ -457,6 +489,10 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
       MP_RETURN_IF_ERROR(
           OutputBatch(cc, std::move(inference_state_to_process)));
     }
+    if (session_run_pool_) {
+      MP_RETURN_IF_ERROR(
+          OutputInFlightBatches(cc, options_.max_in_flight_batches()));
+    }
 
     return absl::OkStatus();
   }
@@ -475,6 +511,17 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
       MP_RETURN_IF_ERROR(
           OutputBatch(cc, std::move(inference_state_to_process)));
     }
+    if (session_run_pool_) {
+      absl::Status status = cc->GraphStatus().ok()
+                                ? OutputInFlightBatches(cc, 0)
+                                : DiscardInFlightBatches();
+      session_run_pool_.reset();
+      absl::MutexLock l(&callable_mutex_);
+      if (callable_status_.ok() && callable_feed_names_.has_value()) {
+        session_->ReleaseCallable(callable_).IgnoreError();
+      }
+      return status;
+    }
     return absl::OkStatus();
   }
 
@@ -536,6 +583,13 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
         output_name_in_signature.emplace_back(tag_pair.first);
       }
     }
+    if (session_run_pool_) {
+      return StartInFlightBatch(std::move(inference_state),
+                                std::move(input_tensors),
+                                std::move(output_tensor_names),
+                                std::move(output_name_in_signature),
+                                start_time);
+    }
     std::vector<tf::Tensor> outputs;
 
     SimpleSemaphore* session_run_throttle = nullptr;
@@ -567,6 +621,16 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
         ->IncrementBy(run_end_time - run_start_time);
     cc->GetCounter(kTotalNumSessionRunsCounterSuffix)->Increment();
 
+    return OutputTensors(cc, std::move(inference_state),
+                         output_name_in_signature, outputs, start_time);
+  }
+
+  // Outputs the tensors fetched for a batch, split into the timestamps of the
+  // batch, and keeps the recurrent state.
+  absl::Status OutputTensors(
+      CalculatorContext* cc, std::unique_ptr<InferenceState> inference_state,
+      const std::vector<std::string>& output_name_in_signature,
+      const std::vector<tf::Tensor>& outputs, int64 start_time) {
     // Feed back the recurrent state.
     for (const auto& tag_pair : recurrent_fetch_tags_to_feed_tags_) {
       int pos = std::find(output_name_in_signature.begin(),
@@ -583,7 +647,7 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
             ? options_.batch_size()
             : inference_state->batch_timestamps_.size(),
         1);
-    for (int i = 0; i < output_tensor_names.size(); ++i) {
+    for (int i = 0; i < output_name_in_signature.size(); ++i) {
       if (options_.batch_size() == 1) {
         if (cc->Outputs().HasTag(output_name_in_signature[i])) {
           tf::Tensor output_tensor(outputs[i]);
@@ -626,6 +690,121 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
     return absl::OkStatus();
   }
 
+  // Starts the session run of a batch on session_run_pool_.
+  absl::Status StartInFlightBatch(
+      std::unique_ptr<InferenceState> inference_state,
+      std::vector<std::pair<mediapipe::ProtoString, tf::Tensor>> input_tensors,
+      std::vector<mediapipe::ProtoString> output_tensor_names,
+      std::vector<std::string> output_name_in_signature, int64 start_time) {
+    auto batch = absl::make_unique<InFlightBatch>();
+    batch->inference_state = std::move(inference_state);
+    batch->output_name_in_signature = std::move(output_name_in_signature);
+    batch->start_time = start_time;
+    InFlightBatch* batch_ptr = batch.get();
+    {
+      absl::MutexLock l(&in_flight_mutex_);
+      in_flight_batches_.push_back(std::move(batch));
+    }
+    // The batch stays in in_flight_batches_ until `done` is notified.
+    session_run_pool_->Schedule([this, batch_ptr,
+                                 input_tensors = std::move(input_tensors),
+                                 output_tensor_names =
+                                     std::move(output_tensor_names)] {
+      SimpleSemaphore* session_run_throttle = nullptr;
+      if (options_.max_concurrent_session_runs() > 0) {
+        session_run_throttle =
+            get_session_run_throttle(options_.max_concurrent_session_runs());
+        session_run_throttle->Acquire(1);
+      }
+      batch_ptr->run_start_time = absl::ToUnixMicros(clock_->TimeNow());
+      batch_ptr->status =
+          RunCallable(input_tensors, output_tensor_names, &batch_ptr->outputs);
+      batch_ptr->run_end_time = absl::ToUnixMicros(clock_->TimeNow());
+      if (session_run_throttle != nullptr) {
+        session_run_throttle->Release(1);
+      }
+      batch_ptr->done.Notify();
+    });
+    return absl::OkStatus();
+  }
+
+  // Runs the session through a callable, made on the first run. The callable
+  // keeps the feed and fetch tensor names resolved across runs. Falls back to
+  // Session::Run if the session doesn't support callables or if the fed
+  // tensors differ from those of the first run.
+  tf::Status RunCallable(
+      const std::vector<std::pair<mediapipe::ProtoString, tf::Tensor>>&
+          input_tensors,
+      const std::vector<mediapipe::ProtoString>& output_tensor_names,
+      std::vector<tf::Tensor>* outputs) {
+    std::vector<std::string> feed_names;
+    std::vector<tf::Tensor> feed_tensors;
+    for (const auto& input : input_tensors) {
+      feed_names.emplace_back(input.first);
+      feed_tensors.push_back(input.second);
+    }
+    bool use_callable = false;
+    {
+      absl::MutexLock l(&callable_mutex_);
+      if (!callable_feed_names_.has_value()) {
+        tf::CallableOptions callable_options;
+        for (const std::string& name : feed_names) {
+          callable_options.add_feed(name);
+        }
+        for (const auto& name : output_tensor_names) {
+          callable_options.add_fetch(std::string(name));
+        }
+        callable_status_ = session_->MakeCallable(callable_options, &callable_);
+        callable_feed_names_ = feed_names;
+      }
+      use_callable =
+          callable_status_.ok() && *callable_feed_names_ == feed_names;
+    }
+    if (!use_callable) {
+      return session_->Run(input_tensors, output_tensor_names,
+                           {} /* target_node_names */, outputs);
+    }
+    return session_->RunCallable(callable_, feed_tensors, outputs,
+                                 /*run_metadata=*/nullptr);
+  }
+
+  // Outputs the finished in-flight batches in order, waiting for the oldest
+  // ones while more than max_in_flight batches are in flight.
+  absl::Status OutputInFlightBatches(CalculatorContext* cc, int max_in_flight) {
+    absl::MutexLock l(&in_flight_mutex_);
+    while (!in_flight_batches_.empty()) {
+      InFlightBatch* batch = in_flight_batches_.front().get();
+      if (static_cast<int>(in_flight_batches_.size()) > max_in_flight) {
+        batch->done.WaitForNotification();
+      } else if (!batch->done.HasBeenNotified()) {
+        break;
+      }
+      std::unique_ptr<InFlightBatch> finished =
+          std::move(in_flight_batches_.front());
+      in_flight_batches_.pop_front();
+      RET_CHECK(finished->status.ok())
+          << "Run failed: " << finished->status.ToString();
+      cc->GetCounter(kTotalSessionRunsTimeUsecsCounterSuffix)
+          ->IncrementBy(finished->run_end_time - finished->run_start_time);
+      cc->GetCounter(kTotalNumSessionRunsCounterSuffix)->Increment();
+      MP_RETURN_IF_ERROR(OutputTensors(
+          cc, std::move(finished->inference_state),
+          finished->output_name_in_signature, finished->outputs,
+          finished->start_time));
+    }
+    return absl::OkStatus();
+  }
+
+  // Waits for the in-flight batches and drops their outputs.
+  absl::Status DiscardInFlightBatches() {
+    absl::MutexLock l(&in_flight_mutex_);
+    for (const auto& batch : in_flight_batches_) {
+      batch->done.WaitForNotification();
+    }
+    in_flight_batches_.clear();
+    return absl::OkStatus();
+  }
+
  private:
   // The Session object is provided by a packet factory and is owned by the
   // MediaPipe framework. Individual calls are thread-safe, but session state
@@ -648,6 +827,24 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
   // Clock used to measure the computation time in OutputBatch().
   std::unique_ptr<mediapipe::Clock> clock_;
 
+  // The batches started in the pipelined mode and not yet output, oldest
+  // first.
+  absl::Mutex in_flight_mutex_;
+  std::deque<std::unique_ptr<InFlightBatch>> in_flight_batches_
+      ABSL_GUARDED_BY(in_flight_mutex_);
+
+  // The callable used by the pipelined mode, and the feeds it was made for.
+  absl::Mutex callable_mutex_;
+  absl::optional<std::vector<std::string>> callable_feed_names_
+      ABSL_GUARDED_BY(callable_mutex_);
+  tf::Status callable_status_ ABSL_GUARDED_BY(callable_mutex_);
+  tf::Session::CallableHandle callable_ ABSL_GUARDED_BY(callable_mutex_);
+
+  // Runs the sessions in the pipelined mode. Declared after the members used by
+  // the session runs, so that its workers are joined before they are
+  // destroyed.
+  std::unique_ptr<ThreadPool> session_run_pool_;
+
   // The static singleton semaphore to throttle concurrent session runs.
   static SimpleSemaphore* get_session_run_throttle(
       int32 max_concurrent_session_runs) {
@@ -558,6 +558,72 @@ TEST_F(TensorflowInferenceCalculatorTest, GetBatchComputed_MaxInFlight) {
                    ->Get());
 }
 
+TEST_F(TensorflowInferenceCalculatorTest, GetBatchComputed_InFlightBatches) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("TensorFlowInferenceCalculator");
+  config.add_input_stream("A:tensor_a");
+  config.add_input_stream("B:tensor_b");
+  config.add_output_stream("MULTIPLIED:tensor_o1");
+  config.add_input_side_packet("SESSION:session");
+  CalculatorOptions options;
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_batch_size(2);
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_add_batch_dim_to_tensors(true);
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_max_in_flight_batches(2);
+  *config.mutable_options() = options;
+
+  runner_ = absl::make_unique<CalculatorRunner>(config);
+  AddSessionInputSidePacket();
+  for (int i = 0; i < 5; ++i) {
+    AddVectorToInputsAsTensor({i + 2, i + 2, i + 2}, "A", i);
+    AddVectorToInputsAsTensor({3, 4, 5}, "B", i);
+  }
+  MP_ASSERT_OK(runner_->Run());
+
+  const std::vector<Packet>& output_packets_mult =
+      runner_->Outputs().Tag(kMultipliedTag).packets;
+  ASSERT_EQ(5, output_packets_mult.size());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(Timestamp(i), output_packets_mult[i].Timestamp());
+    const tf::Tensor& tensor_mult = output_packets_mult[i].Get<tf::Tensor>();
+    auto expected_tensor = tf::test::AsTensor<int32>(
+        {3 * (i + 2), 4 * (i + 2), 5 * (i + 2)});
+    tf::test::ExpectTensorEqual<int32>(tensor_mult, expected_tensor);
+  }
+
+  EXPECT_EQ(5, runner_
+                   ->GetCounter(
+                       "TensorFlowInferenceCalculator-TotalProcessedTimestamps")
+                   ->Get());
+  EXPECT_EQ(3, runner_
+                   ->GetCounter(
+                       "TensorFlowInferenceCalculator-TotalNumSessionRuns")
+                   ->Get());
+}
+
+TEST_F(TensorflowInferenceCalculatorTest, InFlightBatchesRejectRecurrentTags) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("TensorFlowInferenceCalculator");
+  config.add_input_stream("A:tensor_a");
+  config.add_input_stream("B:tensor_b");
+  config.add_output_stream("MULTIPLIED:tensor_o1");
+  config.add_input_side_packet("SESSION:session");
+  CalculatorOptions options;
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_batch_size(1);
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->add_recurrent_tag_pair("A:MULTIPLIED");
+  options.MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+      ->set_max_in_flight_batches(2);
+  *config.mutable_options() = options;
+
+  runner_ = absl::make_unique<CalculatorRunner>(config);
+  AddSessionInputSidePacket();
+  EXPECT_FALSE(runner_->Run().ok());
+}
+
 TEST_F(TensorflowInferenceCalculatorTest, TestRecurrentStates) {
   CalculatorGraphConfig::Node config;
   config.set_calculator("TensorFlowInferenceCalculator");
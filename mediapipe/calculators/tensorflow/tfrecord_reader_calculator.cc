@@ -12,16 +12,26 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensorflow/tfrecord_reader_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/framework/tool/status_util.h"
 #include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
@@ -47,16 +57,90 @@ const char kSequenceExampleTag[] = "SEQUENCE_EXAMPLE";
 //   input_side_packet: "RECORD_INDEX:record_index"
 //   output_side_packet: "SEQUENCE_EXAMPLE:sequence_example"
 // }
+//
+// If EXAMPLE or SEQUENCE_EXAMPLE is an output stream instead, the calculator
+// is a source outputting all the examples of the TFRecord shards, at
+// timestamps 0, 1, 2 and so on. TFRECORD_PATH is then a comma separated list
+// of shards or file patterns, read in order. num_reader_threads threads read
+// and parse the upcoming shards ahead of the output, holding up to
+// max_prefetched_records examples, so that reading from slow storage overlaps
+// with the rest of the graph. The examples are output in the same order as a
+// sequential read.
+//
+// Example config:
+// node {
+//   calculator: "TFRecordReaderCalculator"
+//   input_side_packet: "TFRECORD_PATH:tfrecord_shard_pattern"
+//   output_stream: "SEQUENCE_EXAMPLE:sequence_examples"
+//   options {
+//     [mediapipe.TFRecordReaderCalculatorOptions.ext]: {
+//       num_reader_threads: 8
+//     }
+//   }
+// }
 class TFRecordReaderCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc);
 
+  ~TFRecordReaderCalculator() override { StopReaders(); }
+
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  // The examples read ahead from a shard.
+  struct Shard {
+    std::string path;
+    std::deque<Packet> examples;
+    // Set when the shard has been read, or on a read error.
+    bool done = false;
+    absl::Status status;
+  };
+
+  // Reads the shards reader_index, reader_index + num_reader_threads, and so
+  // on. Runs on reader_threads_.
+  void ReadShards(int reader_index);
+
+  // Reads the examples of a shard until it is done or until stop_ is set.
+  absl::Status ReadShard(Shard* shard);
+
+  // Stops and joins the reader threads.
+  void StopReaders();
+
+  // Whether examples are output as a stream rather than a side packet.
+  bool streaming_ = false;
+  bool sequence_example_ = false;
+  int num_reader_threads_ = 1;
+  int max_shard_examples_ = 1;
+  int64 read_buffer_bytes_ = 0;
+
+  absl::Mutex mutex_;
+  std::vector<Shard> shards_ ABSL_GUARDED_BY(mutex_);
+  bool stop_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // Only used by Process().
+  int current_shard_ = 0;
+  int64 next_timestamp_ = 0;
+
+  std::unique_ptr<ThreadPool> reader_threads_;
 };
 
 absl::Status TFRecordReaderCalculator::GetContract(CalculatorContract* cc) {
   cc->InputSidePackets().Tag(kTFRecordPath).Set<std::string>();
+  if (cc->Outputs().HasTag(kExampleTag) ||
+      cc->Outputs().HasTag(kSequenceExampleTag)) {
+    RET_CHECK(!cc->InputSidePackets().HasTag(kRecordIndex))
+        << "RECORD_INDEX is not supported with output streams.";
+    RET_CHECK(cc->OutputSidePackets().GetTags().empty())
+        << "Examples are output either as a stream or as a side packet.";
+    if (cc->Outputs().HasTag(kExampleTag)) {
+      cc->Outputs().Tag(kExampleTag).Set<tensorflow::Example>();
+    } else {
+      cc->Outputs().Tag(kSequenceExampleTag).Set<tensorflow::SequenceExample>();
+    }
+    return absl::OkStatus();
+  }
   if (cc->InputSidePackets().HasTag(kRecordIndex)) {
     cc->InputSidePackets().Tag(kRecordIndex).Set<int>();
   }
@@ -76,6 +160,45 @@ absl::Status TFRecordReaderCalculator::GetContract(CalculatorContract* cc) {
 }
 
 absl::Status TFRecordReaderCalculator::Open(CalculatorContext* cc) {
+  if (cc->Outputs().NumEntries() > 0) {
+    const auto& options = cc->Options<TFRecordReaderCalculatorOptions>();
+    streaming_ = true;
+    sequence_example_ = cc->Outputs().HasTag(kSequenceExampleTag);
+    read_buffer_bytes_ = options.read_buffer_bytes();
+    const std::string& patterns =
+        cc->InputSidePackets().Tag(kTFRecordPath).Get<std::string>();
+    std::vector<std::string> paths;
+    for (absl::string_view pattern :
+         absl::StrSplit(patterns, ',', absl::SkipWhitespace())) {
+      std::vector<std::string> matches;
+      auto tf_status = tensorflow::Env::Default()->GetMatchingPaths(
+          std::string(pattern), &matches);
+      RET_CHECK(tf_status.ok())
+          << "Failed to match tfrecord files: " << tf_status.ToString();
+      RET_CHECK(!matches.empty()) << "No tfrecord file matches: " << pattern;
+      std::sort(matches.begin(), matches.end());
+      paths.insert(paths.end(), matches.begin(), matches.end());
+    }
+    num_reader_threads_ = std::max(
+        1, std::min<int>(options.num_reader_threads(), paths.size()));
+    max_shard_examples_ =
+        std::max(1, options.max_prefetched_records() / num_reader_threads_);
+    {
+      absl::MutexLock lock(&mutex_);
+      shards_.resize(paths.size());
+      for (int i = 0; i < paths.size(); ++i) {
+        shards_[i].path = paths[i];
+      }
+    }
+    reader_threads_ = std::make_unique<ThreadPool>("mediapipe_tfrecord_reader",
+                                                   num_reader_threads_);
+    reader_threads_->StartWorkers();
+    for (int i = 0; i < num_reader_threads_; ++i) {
+      reader_threads_->Schedule([this, i] { ReadShards(i); });
+    }
+    return absl::OkStatus();
+  }
+
   std::unique_ptr<tensorflow::RandomAccessFile> file;
   auto tf_status = tensorflow::Env::Default()->NewRandomAccessFile(
       cc->InputSidePackets().Tag(kTFRecordPath).Get<std::string>(), &file);
@@ -117,9 +240,117 @@ absl::Status TFRecordReaderCalculator::Open(CalculatorContext* cc) {
 }
 
 absl::Status TFRecordReaderCalculator::Process(CalculatorContext* cc) {
+  if (!streaming_) {
+    return absl::OkStatus();
+  }
+  Packet example;
+  {
+    absl::MutexLock lock(&mutex_);
+    while (example.IsEmpty()) {
+      if (current_shard_ == shards_.size()) {
+        return tool::StatusStop();
+      }
+      Shard* shard = &shards_[current_shard_];
+      mutex_.Await(absl::Condition(
+          +[](Shard* shard) { return shard->done || !shard->examples.empty(); },
+          shard));
+      if (!shard->examples.empty()) {
+        example = std::move(shard->examples.front());
+        shard->examples.pop_front();
+      } else {
+        MP_RETURN_IF_ERROR(shard->status);
+        ++current_shard_;
+      }
+    }
+  }
+  cc->Outputs()
+      .Tag(sequence_example_ ? kSequenceExampleTag : kExampleTag)
+      .AddPacket(example.At(Timestamp(next_timestamp_++)));
   return absl::OkStatus();
 }
 
+absl::Status TFRecordReaderCalculator::Close(CalculatorContext* cc) {
+  StopReaders();
+  return absl::OkStatus();
+}
+
+void TFRecordReaderCalculator::ReadShards(int reader_index) {
+  for (int i = reader_index;; i += num_reader_threads_) {
+    Shard* shard;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (stop_ || i >= shards_.size()) return;
+      shard = &shards_[i];
+    }
+    absl::Status status = ReadShard(shard);
+    absl::MutexLock lock(&mutex_);
+    shard->status = status;
+    shard->done = true;
+  }
+}
+
+absl::Status TFRecordReaderCalculator::ReadShard(Shard* shard) {
+  std::unique_ptr<tensorflow::RandomAccessFile> file;
+  auto tf_status =
+      tensorflow::Env::Default()->NewRandomAccessFile(shard->path, &file);
+  RET_CHECK(tf_status.ok())
+      << "Failed to open tfrecord file: " << tf_status.ToString();
+  tensorflow::io::RecordReaderOptions reader_options;
+  reader_options.buffer_size = read_buffer_bytes_;
+  tensorflow::io::RecordReader reader(file.get(), reader_options);
+  tensorflow::uint64 offset = 0;
+  tensorflow::tstring example_str;
+  while (true) {
+    tf_status = reader.ReadRecord(&offset, &example_str);
+    if (tensorflow::errors::IsOutOfRange(tf_status)) {
+      return absl::OkStatus();
+    }
+    RET_CHECK(tf_status.ok())
+        << "Failed to read tfrecord " << shard->path << ": "
+        << tf_status.ToString();
+    // Examples are parsed on the reader thread too.
+    Packet example;
+    if (sequence_example_) {
+      auto sequence = std::make_unique<tensorflow::SequenceExample>();
+      RET_CHECK(
+          sequence->ParseFromArray(example_str.data(), example_str.size()))
+          << "Failed to parse a sequence example in " << shard->path;
+      example = Adopt(sequence.release());
+    } else {
+      auto tf_example = std::make_unique<tensorflow::Example>();
+      RET_CHECK(tf_example->ParseFromArray(example_str.data(),
+                                           example_str.size()))
+          << "Failed to parse an example in " << shard->path;
+      example = Adopt(tf_example.release());
+    }
+    absl::MutexLock lock(&mutex_);
+    struct Args {
+      TFRecordReaderCalculator* self;
+      Shard* shard;
+    } args = {this, shard};
+    mutex_.Await(absl::Condition(
+        +[](Args* args) {
+          return args->self->stop_ ||
+                 args->shard->examples.size() <
+                     args->self->max_shard_examples_;
+        },
+        &args));
+    if (stop_) {
+      return absl::CancelledError("TFRecordReaderCalculator stopped.");
+    }
+    shard->examples.push_back(std::move(example));
+  }
+}
+
+void TFRecordReaderCalculator::StopReaders() {
+  if (!reader_threads_) return;
+  {
+    absl::MutexLock lock(&mutex_);
+    stop_ = true;
+  }
+  reader_threads_.reset();
+}
+
 REGISTER_CALCULATOR(TFRecordReaderCalculator);
 
 }  // namespace mediapipe
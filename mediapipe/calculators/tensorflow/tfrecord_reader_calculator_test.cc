@@ -0,0 +1,101 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/tensorflow/tfrecord_reader_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace mediapipe {
+namespace {
+
+namespace tf = ::tensorflow;
+
+constexpr char kTFRecordPathTag[] = "TFRECORD_PATH";
+constexpr char kExampleTag[] = "EXAMPLE";
+
+// Writes examples whose "index" feature counts from first_index.
+void WriteShard(const std::string& path, int first_index, int num_examples) {
+  std::unique_ptr<tf::WritableFile> file;
+  ASSERT_TRUE(tf::Env::Default()->NewWritableFile(path, &file).ok());
+  tf::io::RecordWriter writer(file.get());
+  for (int i = first_index; i < first_index + num_examples; ++i) {
+    tf::Example example;
+    (*example.mutable_features()->mutable_feature())["index"]
+        .mutable_int64_list()
+        ->add_value(i);
+    ASSERT_TRUE(writer.WriteRecord(example.SerializeAsString()).ok());
+  }
+  ASSERT_TRUE(writer.Close().ok());
+  ASSERT_TRUE(file->Close().ok());
+}
+
+CalculatorGraphConfig::Node StreamingConfig(int num_reader_threads,
+                                            int max_prefetched_records) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("TFRecordReaderCalculator");
+  config.add_input_side_packet("TFRECORD_PATH:path");
+  config.add_output_stream("EXAMPLE:examples");
+  auto* options = config.mutable_options()->MutableExtension(
+      TFRecordReaderCalculatorOptions::ext);
+  options->set_num_reader_threads(num_reader_threads);
+  options->set_max_prefetched_records(max_prefetched_records);
+  return config;
+}
+
+TEST(TFRecordReaderCalculatorTest, ReadsShardsInOrder) {
+  const std::string prefix =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/reads_shards_in_order");
+  // The shards are matched by a pattern and sorted by name.
+  WriteShard(absl::StrCat(prefix, "-00002"), 7, 1);
+  WriteShard(absl::StrCat(prefix, "-00000"), 0, 5);
+  WriteShard(absl::StrCat(prefix, "-00001"), 5, 2);
+
+  CalculatorRunner runner(StreamingConfig(/*num_reader_threads=*/2,
+                                          /*max_prefetched_records=*/2));
+  runner.MutableSidePackets()->Tag(kTFRecordPathTag) =
+      MakePacket<std::string>(absl::StrCat(prefix, "-*"));
+  MP_ASSERT_OK(runner.Run());
+
+  const std::vector<Packet>& packets =
+      runner.Outputs().Tag(kExampleTag).packets;
+  ASSERT_EQ(8, packets.size());
+  for (int i = 0; i < packets.size(); ++i) {
+    EXPECT_EQ(Timestamp(i), packets[i].Timestamp());
+    const tf::Example& example = packets[i].Get<tf::Example>();
+    EXPECT_EQ(i,
+              example.features().feature().at("index").int64_list().value(0));
+  }
+}
+
+TEST(TFRecordReaderCalculatorTest, FailsOnMissingShard) {
+  CalculatorRunner runner(StreamingConfig(/*num_reader_threads=*/1,
+                                          /*max_prefetched_records=*/4));
+  runner.MutableSidePackets()->Tag(kTFRecordPathTag) = MakePacket<std::string>(
+      absl::StrCat(getenv("TEST_TMPDIR"), "/missing_shard-*"));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,17 +12,33 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "mediapipe/calculators/core/packet_resampler_calculator.pb.h"
 #include "mediapipe/calculators/tensorflow/unpack_media_sequence_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/location.h"
+#include "mediapipe/framework/port/advanced_proto_lite_inc.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/proto_ns.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/util/audio_decoder.pb.h"
 #include "mediapipe/util/sequence/media_sequence.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace mediapipe {
 
@@ -35,6 +51,7 @@ const char kForwardFlowImageTag[] = "FORWARD_FLOW_ENCODED";
 
 // Side Packets:
 const char kSequenceExampleTag[] = "SEQUENCE_EXAMPLE";
+const char kChunkPathsTag[] = "CHUNK_PATHS";
 const char kDatasetRootDirTag[] = "DATASET_ROOT";
 const char kDataPath[] = "DATA_PATH";
 const char kPacketResamplerOptions[] = "RESAMPLER_OPTIONS";
@@ -44,6 +61,158 @@ const char kAudioDecoderOptions[] = "AUDIO_DECODER_OPTIONS";
 namespace tf = ::tensorflow;
 namespace mpms = mediapipe::mediasequence;
 
+namespace {
+
+using WireFormatLite = proto_ns::internal::WireFormatLite;
+
+// A TFRecord is a uint64 length and its masked crc32c, followed by the data
+// and its masked crc32c.
+constexpr int kRecordHeaderSize = sizeof(uint64) + sizeof(uint32);
+constexpr int kRecordFooterSize = sizeof(uint32);
+
+// Appends the records of a memory mapped TFRecord file to records, pointing
+// into the mapped file. Only the lengths are checksummed here, so that
+// records can be skipped without reading them.
+absl::Status SplitRecords(const tf::ReadOnlyMemoryRegion& file,
+                          std::vector<absl::string_view>* records) {
+  const char* data = static_cast<const char*>(file.data());
+  const uint64 size = file.length();
+  uint64 offset = 0;
+  while (offset < size) {
+    RET_CHECK_LE(kRecordHeaderSize, size - offset) << "Truncated tfrecord.";
+    const uint64 length = tf::core::DecodeFixed64(data + offset);
+    RET_CHECK_EQ(
+        tf::crc32c::Unmask(tf::core::DecodeFixed32(data + offset + 8)),
+        tf::crc32c::Value(data + offset, sizeof(uint64)))
+        << "Corrupted tfrecord length.";
+    offset += kRecordHeaderSize;
+    RET_CHECK(length <= size - offset &&
+              kRecordFooterSize <= size - offset - length)
+        << "Truncated tfrecord.";
+    records->emplace_back(data + offset, length);
+    offset += length + kRecordFooterSize;
+  }
+  return absl::OkStatus();
+}
+
+// Checks the data of a record returned by SplitRecords against its checksum.
+absl::Status VerifyRecord(absl::string_view record) {
+  const uint32 masked_crc =
+      tf::core::DecodeFixed32(record.data() + record.size());
+  RET_CHECK_EQ(tf::crc32c::Unmask(masked_crc),
+               tf::crc32c::Value(record.data(), record.size()))
+      << "Corrupted tfrecord.";
+  return absl::OkStatus();
+}
+
+// Parses only the context of a serialized SequenceExample, skipping over the
+// feature lists, which PackMediaSequenceCalculator serializes after it.
+absl::Status ParseContext(absl::string_view serialized,
+                          tf::SequenceExample* sequence) {
+  proto_ns::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  while (const uint32 tag = input.ReadTag()) {
+    if (WireFormatLite::GetTagFieldNumber(tag) ==
+            tf::SequenceExample::kContextFieldNumber &&
+        WireFormatLite::GetTagWireType(tag) ==
+            WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      RET_CHECK(
+          WireFormatLite::ReadMessage(&input, sequence->mutable_context()))
+          << "Failed to parse the SequenceExample context.";
+    } else {
+      RET_CHECK(WireFormatLite::SkipField(&input, tag))
+          << "Failed to parse the SequenceExample.";
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Parses the feature lists of a serialized FeatureLists whose keys start with
+// one of `prefixes`. The other feature lists are skipped without decoding them.
+absl::Status ParseFeatureLists(absl::string_view serialized,
+                               const std::vector<std::string>& prefixes,
+                               tf::FeatureLists* feature_lists) {
+  proto_ns::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  while (const uint32 tag = input.ReadTag()) {
+    if (WireFormatLite::GetTagFieldNumber(tag) !=
+            tf::FeatureLists::kFeatureListFieldNumber ||
+        WireFormatLite::GetTagWireType(tag) !=
+            WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      RET_CHECK(WireFormatLite::SkipField(&input, tag))
+          << "Failed to parse the SequenceExample feature lists.";
+      continue;
+    }
+    // A map entry, with the key as field 1 and the FeatureList as field 2.
+    uint32 entry_size = 0;
+    RET_CHECK(input.ReadVarint32(&entry_size));
+    const absl::string_view entry =
+        serialized.substr(input.CurrentPosition(), entry_size);
+    RET_CHECK(input.Skip(entry_size)) << "Truncated feature list.";
+    proto_ns::io::CodedInputStream entry_input(
+        reinterpret_cast<const uint8*>(entry.data()), entry.size());
+    std::string key;
+    absl::string_view value;
+    while (const uint32 entry_tag = entry_input.ReadTag()) {
+      const int field = WireFormatLite::GetTagFieldNumber(entry_tag);
+      if (field == 1) {
+        RET_CHECK(WireFormatLite::ReadString(&entry_input, &key));
+      } else if (field == 2) {
+        uint32 value_size = 0;
+        RET_CHECK(entry_input.ReadVarint32(&value_size));
+        value = entry.substr(entry_input.CurrentPosition(), value_size);
+        RET_CHECK(entry_input.Skip(value_size)) << "Truncated feature list.";
+      } else {
+        RET_CHECK(WireFormatLite::SkipField(&entry_input, entry_tag));
+      }
+    }
+    if (std::any_of(prefixes.begin(), prefixes.end(),
+                    [&key](const std::string& prefix) {
+                      return absl::StartsWith(key, prefix);
+                    })) {
+      RET_CHECK((*feature_lists->mutable_feature_list())[key].ParseFromArray(
+          value.data(), value.size()))
+          << "Failed to parse feature list " << key;
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Parses the context of a serialized SequenceExample and the feature lists
+// whose keys start with one of `prefixes`.
+absl::Status ParseRequestedFeatures(absl::string_view serialized,
+                                    const std::vector<std::string>& prefixes,
+                                    tf::SequenceExample* sequence) {
+  proto_ns::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  while (const uint32 tag = input.ReadTag()) {
+    const int field = WireFormatLite::GetTagFieldNumber(tag);
+    if (WireFormatLite::GetTagWireType(tag) !=
+        WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      RET_CHECK(WireFormatLite::SkipField(&input, tag))
+          << "Failed to parse the SequenceExample.";
+    } else if (field == tf::SequenceExample::kContextFieldNumber) {
+      RET_CHECK(
+          WireFormatLite::ReadMessage(&input, sequence->mutable_context()))
+          << "Failed to parse the SequenceExample context.";
+    } else if (field == tf::SequenceExample::kFeatureListsFieldNumber) {
+      uint32 size = 0;
+      RET_CHECK(input.ReadVarint32(&size));
+      const absl::string_view feature_lists =
+          serialized.substr(input.CurrentPosition(), size);
+      RET_CHECK(input.Skip(size)) << "Truncated feature lists.";
+      MP_RETURN_IF_ERROR(ParseFeatureLists(feature_lists, prefixes,
+                                           sequence->mutable_feature_lists()));
+    } else {
+      RET_CHECK(WireFormatLite::SkipField(&input, tag))
+          << "Failed to parse the SequenceExample.";
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
 // Source calculator to unpack side_packets and streams from tf.SequenceExamples
 //
 // Often, only side_packets or streams need to be output, but both can be output
@@ -116,12 +285,41 @@ namespace mpms = mediapipe::mediasequence;
 //   output_stream: "FLOAT_FEATURE_FDENSE:fdense_vf"
 //   output_stream: "BBOX:faces"
 // }
+//
+// Instead of the SEQUENCE_EXAMPLE, the CHUNK_PATHS input side packet can list
+// the TFRecord shards written by PackMediaSequenceCalculator with a
+// CHUNK_OUTPUT_PATH, in order. The shards are memory mapped and chunks are
+// parsed one at a time as the streams advance, so memory stays bounded by the
+// chunk size. Chunks ending before options.chunk_start_timestamp are skipped
+// using only their context. Side packets are unpacked from the context of the
+// first chunk. Only the feature lists of the connected output streams are
+// decoded from a chunk; the others are skipped over.
+//
+// Example config:
+// node {
+//   calculator: "UnpackMediaSequenceCalculator"
+//   input_side_packet: "CHUNK_PATHS:chunk_paths"
+//   output_stream: "IMAGE:frames"
+// }
 class UnpackMediaSequenceCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
     const auto& options = cc->Options<UnpackMediaSequenceCalculatorOptions>();
-    RET_CHECK(cc->InputSidePackets().HasTag(kSequenceExampleTag));
-    cc->InputSidePackets().Tag(kSequenceExampleTag).Set<tf::SequenceExample>();
+    RET_CHECK(cc->InputSidePackets().HasTag(kSequenceExampleTag) ^
+              cc->InputSidePackets().HasTag(kChunkPathsTag))
+        << "Exactly one of " << kSequenceExampleTag << " and "
+        << kChunkPathsTag << " must be provided.";
+    if (cc->InputSidePackets().HasTag(kSequenceExampleTag)) {
+      cc->InputSidePackets()
+          .Tag(kSequenceExampleTag)
+          .Set<tf::SequenceExample>();
+    } else {
+      RET_CHECK(!options.output_poststream_as_prestream())
+          << "output_poststream_as_prestream is not supported for chunks.";
+      cc->InputSidePackets()
+          .Tag(kChunkPathsTag)
+          .Set<std::vector<std::string>>();
+    }
     // Optional side inputs.
     if (cc->InputSidePackets().HasTag(kDatasetRootDirTag)) {
       cc->InputSidePackets().Tag(kDatasetRootDirTag).Set<std::string>();
@@ -187,77 +385,33 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
   }
 
   absl::Status Open(CalculatorContext* cc) override {
-    // Copy the packet to copy the otherwise inaccessible shared ptr.
-    example_packet_holder_ = cc->InputSidePackets().Tag(kSequenceExampleTag);
-    sequence_ = &example_packet_holder_.Get<tf::SequenceExample>();
     const auto& options = cc->Options<UnpackMediaSequenceCalculatorOptions>();
-
-    // Collect the timestamps for all streams keyed by the timestamp feature's
-    // key. While creating this data structure we also identify the last
-    // timestamp and the associated feature. This information is used in process
-    // to output batches of packets in order.
-    timestamps_.clear();
-    int64 last_timestamp_seen = Timestamp::PreStream().Value();
-    first_timestamp_seen_ = Timestamp::OneOverPostStream().Value();
-    for (const auto& map_kv : sequence_->feature_lists().feature_list()) {
-      if (absl::StrContains(map_kv.first, "/timestamp")) {
-        LOG(INFO) << "Found feature timestamps: " << map_kv.first
-                  << " with size: " << map_kv.second.feature_size();
-        int64 recent_timestamp = Timestamp::PreStream().Value();
-        for (int i = 0; i < map_kv.second.feature_size(); ++i) {
-          int64 next_timestamp =
-              mpms::GetInt64sAt(*sequence_, map_kv.first, i).Get(0);
-          RET_CHECK_GT(next_timestamp, recent_timestamp)
-              << "Timestamps must be sequential. If you're seeing this message "
-              << "you may have added images to the same SequenceExample twice. "
-              << "Key: " << map_kv.first;
-          if (options.output_poststream_as_prestream() &&
-              next_timestamp == Timestamp::PostStream().Value()) {
-            RET_CHECK_EQ(i, 0)
-                << "Detected PostStream() and timestamps being output for the "
-                << "same stream. This is currently invalid.";
-            next_timestamp = Timestamp::PreStream().Value();
-          }
-          timestamps_[map_kv.first].push_back(next_timestamp);
-          recent_timestamp = next_timestamp;
-          if (recent_timestamp < first_timestamp_seen_) {
-            first_timestamp_seen_ = recent_timestamp;
-          }
-        }
-        if (recent_timestamp > last_timestamp_seen &&
-            recent_timestamp < Timestamp::PostStream().Value()) {
-          last_timestamp_key_ = map_kv.first;
-          last_timestamp_seen = recent_timestamp;
-        }
-      }
-    }
-    if (!timestamps_.empty()) {
-      for (const auto& kv : timestamps_) {
-        if (!kv.second.empty() &&
-            kv.second[0] < Timestamp::PostStream().Value()) {
-          // These checks only make sense if any values are not PostStream, but
-          // only need to be made once.
-          RET_CHECK(!last_timestamp_key_.empty())
-              << "Something went wrong because the timestamp key is unset. "
-              << "Example: " << sequence_->DebugString();
-          RET_CHECK_GT(last_timestamp_seen, Timestamp::PreStream().Value())
-              << "Something went wrong because the last timestamp is unset. "
-              << "Example: " << sequence_->DebugString();
-          RET_CHECK_LT(first_timestamp_seen_,
-                       Timestamp::OneOverPostStream().Value())
-              << "Something went wrong because the first timestamp is unset. "
-              << "Example: " << sequence_->DebugString();
-          break;
-        }
+    if (cc->InputSidePackets().HasTag(kChunkPathsTag)) {
+      SetRequestedPrefixes(cc->Outputs());
+      MP_RETURN_IF_ERROR(IndexChunks(cc->InputSidePackets()
+                                         .Tag(kChunkPathsTag)
+                                         .Get<std::vector<std::string>>(),
+                                     options));
+      if (next_chunk_ < chunks_.size()) {
+        MP_RETURN_IF_ERROR(LoadNextChunk(options));
+      } else {
+        sequence_ = &first_context_;
+        MP_RETURN_IF_ERROR(IndexTimestamps(options));
       }
+    } else {
+      // Copy the packet to copy the otherwise inaccessible shared ptr.
+      example_packet_holder_ = cc->InputSidePackets().Tag(kSequenceExampleTag);
+      sequence_ = &example_packet_holder_.Get<tf::SequenceExample>();
+      MP_RETURN_IF_ERROR(IndexTimestamps(options));
     }
-    current_timestamp_index_ = 0;
-    process_poststream_ = false;
 
     // Determine the data path and output it.
-    const auto& sequence = cc->InputSidePackets()
-                               .Tag(kSequenceExampleTag)
-                               .Get<tensorflow::SequenceExample>();
+    const tf::SequenceExample& sequence =
+        cc->InputSidePackets().HasTag(kChunkPathsTag)
+            ? first_context_
+            : cc->InputSidePackets()
+                  .Tag(kSequenceExampleTag)
+                  .Get<tensorflow::SequenceExample>();
     if (cc->OutputSidePackets().HasTag(kDataPath)) {
       std::string root_directory = "";
       if (cc->InputSidePackets().HasTag(kDatasetRootDirTag)) {
@@ -348,6 +502,147 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
     return absl::OkStatus();
   }
 
+  // Maps the chunk shards and records the chunks to read, using only their
+  // contexts.
+  absl::Status IndexChunks(
+      const std::vector<std::string>& paths,
+      const UnpackMediaSequenceCalculatorOptions& options) {
+    for (const std::string& path : paths) {
+      std::unique_ptr<tf::ReadOnlyMemoryRegion> shard;
+      auto tf_status =
+          tf::Env::Default()->NewReadOnlyMemoryRegionFromFile(path, &shard);
+      RET_CHECK(tf_status.ok())
+          << "Failed to map tfrecord file: " << tf_status.ToString();
+      MP_RETURN_IF_ERROR(SplitRecords(*shard, &chunks_));
+      shards_.push_back(std::move(shard));
+    }
+    RET_CHECK(!chunks_.empty()) << "No chunks in " << kChunkPathsTag;
+    MP_RETURN_IF_ERROR(VerifyRecord(chunks_[0]));
+    MP_RETURN_IF_ERROR(ParseContext(chunks_[0], &first_context_));
+
+    next_chunk_ = 0;
+    if (options.has_chunk_start_timestamp()) {
+      tf::SequenceExample context;
+      while (next_chunk_ < chunks_.size()) {
+        context.Clear();
+        MP_RETURN_IF_ERROR(ParseContext(chunks_[next_chunk_], &context));
+        if (!mpms::HasChunkEndTimestamp(context) ||
+            mpms::GetChunkEndTimestamp(context) >=
+                options.chunk_start_timestamp()) {
+          break;
+        }
+        ++next_chunk_;
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Parses the next chunk and makes it the current sequence.
+  absl::Status LoadNextChunk(
+      const UnpackMediaSequenceCalculatorOptions& options) {
+    const absl::string_view record = chunks_[next_chunk_++];
+    MP_RETURN_IF_ERROR(VerifyRecord(record));
+    chunk_.Clear();
+    MP_RETURN_IF_ERROR(
+        ParseRequestedFeatures(record, requested_prefixes_, &chunk_))
+        << "Failed to parse chunk " << next_chunk_ - 1;
+    sequence_ = &chunk_;
+    return IndexTimestamps(options);
+  }
+
+  // Sets the prefixes of the feature list keys read by the output streams.
+  void SetRequestedPrefixes(const OutputStreamShardSet& outputs) {
+    const std::string image_prefix = absl::StrCat(kImageTag, "_");
+    const std::string bbox_prefix = absl::StrCat(kBBoxTag, "_");
+    for (const std::string& tag : outputs.GetTags()) {
+      if (tag == kImageTag) {
+        requested_prefixes_.push_back("image/");
+      } else if (absl::StartsWith(tag, image_prefix)) {
+        requested_prefixes_.push_back(
+            absl::StrCat(tag.substr(image_prefix.size()), "/image/"));
+      } else if (tag == kForwardFlowImageTag) {
+        requested_prefixes_.push_back(
+            absl::StrCat(mpms::kForwardFlowPrefix, "/image/"));
+      } else if (tag == kBBoxTag) {
+        requested_prefixes_.push_back("region/");
+      } else if (absl::StartsWith(tag, bbox_prefix)) {
+        requested_prefixes_.push_back(
+            absl::StrCat(tag.substr(bbox_prefix.size()), "/region/"));
+      } else if (absl::StartsWith(tag, kFloatFeaturePrefixTag)) {
+        requested_prefixes_.push_back(absl::StrCat(
+            tag.substr(strlen(kFloatFeaturePrefixTag)), "/feature/"));
+      }
+    }
+  }
+
+  // Collects the timestamps for all streams of the current sequence.
+  absl::Status IndexTimestamps(
+      const UnpackMediaSequenceCalculatorOptions& options) {
+    // Collect the timestamps for all streams keyed by the timestamp feature's
+    // key. While creating this data structure we also identify the last
+    // timestamp and the associated feature. This information is used in process
+    // to output batches of packets in order.
+    timestamps_.clear();
+    last_timestamp_key_.clear();
+    int64 last_timestamp_seen = Timestamp::PreStream().Value();
+    first_timestamp_seen_ = Timestamp::OneOverPostStream().Value();
+    for (const auto& map_kv : sequence_->feature_lists().feature_list()) {
+      if (absl::StrContains(map_kv.first, "/timestamp")) {
+        LOG(INFO) << "Found feature timestamps: " << map_kv.first
+                  << " with size: " << map_kv.second.feature_size();
+        int64 recent_timestamp = Timestamp::PreStream().Value();
+        for (int i = 0; i < map_kv.second.feature_size(); ++i) {
+          int64 next_timestamp =
+              mpms::GetInt64sAt(*sequence_, map_kv.first, i).Get(0);
+          RET_CHECK_GT(next_timestamp, recent_timestamp)
+              << "Timestamps must be sequential. If you're seeing this message "
+              << "you may have added images to the same SequenceExample twice. "
+              << "Key: " << map_kv.first;
+          if (options.output_poststream_as_prestream() &&
+              next_timestamp == Timestamp::PostStream().Value()) {
+            RET_CHECK_EQ(i, 0)
+                << "Detected PostStream() and timestamps being output for the "
+                << "same stream. This is currently invalid.";
+            next_timestamp = Timestamp::PreStream().Value();
+          }
+          timestamps_[map_kv.first].push_back(next_timestamp);
+          recent_timestamp = next_timestamp;
+          if (recent_timestamp < first_timestamp_seen_) {
+            first_timestamp_seen_ = recent_timestamp;
+          }
+        }
+        if (recent_timestamp > last_timestamp_seen &&
+            recent_timestamp < Timestamp::PostStream().Value()) {
+          last_timestamp_key_ = map_kv.first;
+          last_timestamp_seen = recent_timestamp;
+        }
+      }
+    }
+    if (!timestamps_.empty()) {
+      for (const auto& kv : timestamps_) {
+        if (!kv.second.empty() &&
+            kv.second[0] < Timestamp::PostStream().Value()) {
+          // These checks only make sense if any values are not PostStream, but
+          // only need to be made once.
+          RET_CHECK(!last_timestamp_key_.empty())
+              << "Something went wrong because the timestamp key is unset. "
+              << "Example: " << sequence_->DebugString();
+          RET_CHECK_GT(last_timestamp_seen, Timestamp::PreStream().Value())
+              << "Something went wrong because the last timestamp is unset. "
+              << "Example: " << sequence_->DebugString();
+          RET_CHECK_LT(first_timestamp_seen_,
+                       Timestamp::OneOverPostStream().Value())
+              << "Something went wrong because the first timestamp is unset. "
+              << "Example: " << sequence_->DebugString();
+          break;
+        }
+      }
+    }
+    current_timestamp_index_ = 0;
+    process_poststream_ = false;
+    return absl::OkStatus();
+  }
+
   absl::Status Process(CalculatorContext* cc) override {
     if (timestamps_.empty()) {
       // This occurs when we only have metadata to unpack.
@@ -461,6 +756,8 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
     ++current_timestamp_index_;
     if (current_timestamp_index_ < timestamps_[last_timestamp_key_].size()) {
       return absl::OkStatus();
+    } else if (!process_poststream_ && next_chunk_ < chunks_.size()) {
+      return LoadNextChunk(cc->Options<UnpackMediaSequenceCalculatorOptions>());
     } else {
       if (process_poststream_) {
         // Once we've processed the PostStream timestamp we can stop.
@@ -478,6 +775,16 @@ class UnpackMediaSequenceCalculator : public CalculatorBase {
   const tf::SequenceExample* sequence_;
   Packet example_packet_holder_;
 
+  // With CHUNK_PATHS, the mapped shards, their chunks, the index of the next
+  // chunk to read, the current chunk and the context of the first chunk.
+  std::vector<std::unique_ptr<tf::ReadOnlyMemoryRegion>> shards_;
+  std::vector<absl::string_view> chunks_;
+  int next_chunk_ = 0;
+  tf::SequenceExample chunk_;
+  tf::SequenceExample first_context_;
+  // The prefixes of the feature list keys parsed from the chunks.
+  std::vector<std::string> requested_prefixes_;
+
   // Store a map from the keys for each stream to the timestamps for each
   // key. This allows us to identify which packets to output for each stream
   // for timestamps within a given time window.
@@ -14,6 +14,7 @@
 
 #include "absl/memory/memory.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "mediapipe/calculators/core/packet_resampler_calculator.pb.h"
 #include "mediapipe/calculators/tensorflow/unpack_media_sequence_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -26,6 +27,9 @@
 #include "mediapipe/util/audio_decoder.pb.h"
 #include "mediapipe/util/sequence/media_sequence.h"
 #include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
 
 namespace mediapipe {
 namespace {
@@ -59,6 +63,7 @@ constexpr char kImageTag[] = "IMAGE";
 constexpr char kFloatContextFeatureOtherTag[] = "FLOAT_CONTEXT_FEATURE_OTHER";
 constexpr char kFloatContextFeatureTestTag[] = "FLOAT_CONTEXT_FEATURE_TEST";
 constexpr char kSequenceExampleTag[] = "SEQUENCE_EXAMPLE";
+constexpr char kChunkPathsTag[] = "CHUNK_PATHS";
 
 class UnpackMediaSequenceCalculatorTest : public ::testing::Test {
  protected:
@@ -360,6 +365,98 @@ TEST_F(UnpackMediaSequenceCalculatorTest, UnpacksTwoFloatLists) {
   }
 }
 
+TEST_F(UnpackMediaSequenceCalculatorTest, UnpacksChunks) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("UnpackMediaSequenceCalculator");
+  config.add_input_side_packet("CHUNK_PATHS:chunk_paths");
+  config.add_output_stream("IMAGE:images");
+  config.add_output_side_packet("DATA_PATH:data_path");
+  // Skips the first chunk.
+  config.mutable_options()
+      ->MutableExtension(UnpackMediaSequenceCalculatorOptions::ext)
+      ->set_chunk_start_timestamp(2);
+  runner_ = absl::make_unique<CalculatorRunner>(config);
+
+  // Writes chunks of two images each, as PackMediaSequenceCalculator does.
+  const std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/unpacks_chunks-00000");
+  std::unique_ptr<tf::WritableFile> file;
+  ASSERT_TRUE(tf::Env::Default()->NewWritableFile(path, &file).ok());
+  tf::io::RecordWriter writer(file.get());
+  int num_chunks = 3;
+  for (int c = 0; c < num_chunks; ++c) {
+    tf::SequenceExample chunk = *sequence_;
+    for (int i = 2 * c; i < 2 * c + 2; ++i) {
+      mpms::AddImageTimestamp(i, &chunk);
+      mpms::AddImageEncoded(absl::StrCat("image_", i), &chunk);
+    }
+    mpms::SetChunkStartTimestamp(2 * c, &chunk);
+    mpms::SetChunkEndTimestamp(2 * c + 1, &chunk);
+    ASSERT_TRUE(writer.WriteRecord(chunk.SerializeAsString()).ok());
+  }
+  ASSERT_TRUE(writer.Close().ok());
+  ASSERT_TRUE(file->Close().ok());
+
+  runner_->MutableSidePackets()->Tag(kChunkPathsTag) =
+      MakePacket<std::vector<std::string>>(std::vector<std::string>{path});
+
+  MP_ASSERT_OK(runner_->Run());
+
+  const std::vector<Packet>& output_packets =
+      runner_->Outputs().Tag(kImageTag).packets;
+  ASSERT_EQ(4, output_packets.size());
+  for (int i = 0; i < output_packets.size(); ++i) {
+    ASSERT_EQ(i + 2, output_packets[i].Timestamp().Value());
+    ASSERT_EQ(absl::StrCat("image_", i + 2),
+              output_packets[i].Get<std::string>());
+  }
+  ASSERT_EQ(data_path_,
+            runner_->OutputSidePackets().Tag(kDataPathTag).Get<std::string>());
+}
+
+TEST_F(UnpackMediaSequenceCalculatorTest, UnpacksOnlyRequestedChunkFeatures) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("UnpackMediaSequenceCalculator");
+  config.add_input_side_packet("CHUNK_PATHS:chunk_paths");
+  config.add_output_stream("FLOAT_FEATURE_OTHER:other");
+  runner_ = absl::make_unique<CalculatorRunner>(config);
+
+  const std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/unpacks_requested-00000");
+  std::unique_ptr<tf::WritableFile> file;
+  ASSERT_TRUE(tf::Env::Default()->NewWritableFile(path, &file).ok());
+  tf::io::RecordWriter writer(file.get());
+  int num_chunks = 2;
+  for (int c = 0; c < num_chunks; ++c) {
+    tf::SequenceExample chunk = *sequence_;
+    for (int i = 2 * c; i < 2 * c + 2; ++i) {
+      mpms::AddImageTimestamp(i, &chunk);
+      mpms::AddImageEncoded(absl::StrCat("image_", i), &chunk);
+      mpms::AddFeatureTimestamp("OTHER", i, &chunk);
+      mpms::AddFeatureFloats("OTHER", {static_cast<float>(i)}, &chunk);
+    }
+    mpms::SetChunkStartTimestamp(2 * c, &chunk);
+    mpms::SetChunkEndTimestamp(2 * c + 1, &chunk);
+    ASSERT_TRUE(writer.WriteRecord(chunk.SerializeAsString()).ok());
+  }
+  ASSERT_TRUE(writer.Close().ok());
+  ASSERT_TRUE(file->Close().ok());
+
+  runner_->MutableSidePackets()->Tag(kChunkPathsTag) =
+      MakePacket<std::vector<std::string>>(std::vector<std::string>{path});
+
+  MP_ASSERT_OK(runner_->Run());
+
+  const std::vector<Packet>& output_packets =
+      runner_->Outputs().Tag(kFloatFeatureOtherTag).packets;
+  ASSERT_EQ(4, output_packets.size());
+  for (int i = 0; i < output_packets.size(); ++i) {
+    ASSERT_EQ(i, output_packets[i].Timestamp().Value());
+    ASSERT_THAT(output_packets[i].Get<std::vector<float>>(),
+                ::testing::ElementsAre(static_cast<float>(i)));
+  }
+}
+
 TEST_F(UnpackMediaSequenceCalculatorTest, UnpacksNonOverlappingTimestamps) {
   SetUpCalculator({"IMAGE:images", "FLOAT_FEATURE_OTHER:other"}, {});
   auto input_sequence = absl::make_unique<tf::SequenceExample>();
@@ -19,12 +19,15 @@
 #include "mediapipe/calculators/tflite/ssd_anchors_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor_array.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
 
 namespace {
 
+constexpr char kAnchorArrayTag[] = "ANCHOR_ARRAY";
+
 struct MultiScaleAnchorInfo {
   int32 level;
   std::vector<float> aspect_ratios;
@@ -33,6 +36,13 @@ struct MultiScaleAnchorInfo {
   std::pair<float, float> anchor_stride;
 };
 
+struct AnchorBox {
+  float y_center;
+  float x_center;
+  float h;
+  float w;
+};
+
 struct FeatureMapDim {
   int height;
   int width;
@@ -91,25 +101,25 @@ std::pair<float, float> GetMultiScaleAnchorOffset(
 }
 
 void NormalizeAnchor(const int input_height, const int input_width,
-                     Anchor* anchor) {
-  anchor->set_h(anchor->h() / (float)input_height);
-  anchor->set_w(anchor->w() / (float)input_width);
-  anchor->set_y_center(anchor->y_center() / (float)input_height);
-  anchor->set_x_center(anchor->x_center() / (float)input_width);
+                     AnchorBox* anchor) {
+  anchor->h /= (float)input_height;
+  anchor->w /= (float)input_width;
+  anchor->y_center /= (float)input_height;
+  anchor->x_center /= (float)input_width;
 }
 
-Anchor CalculateAnchorBox(const int y_center, const int x_center,
+AnchorBox CalculateAnchorBox(const int y_center, const int x_center,
                           const float scale, const float aspect_ratio,
                           const std::pair<float, float> base_anchor_size,
                           // y-height first
                           const std::pair<float, float> anchor_stride,
                           const std::pair<float, float> anchor_offset) {
-  Anchor result;
+  AnchorBox result;
   float ratio_sqrt = std::sqrt(aspect_ratio);
-  result.set_h(scale * base_anchor_size.first / ratio_sqrt);
-  result.set_w(scale * ratio_sqrt * base_anchor_size.second);
-  result.set_y_center(y_center * anchor_stride.first + anchor_offset.first);
-  result.set_x_center(x_center * anchor_stride.second + anchor_offset.second);
+  result.h = scale * base_anchor_size.first / ratio_sqrt;
+  result.w = scale * ratio_sqrt * base_anchor_size.second;
+  result.y_center = y_center * anchor_stride.first + anchor_offset.first;
+  result.x_center = x_center * anchor_stride.second + anchor_offset.second;
   return result;
 }
 
@@ -118,7 +128,11 @@ Anchor CalculateAnchorBox(const int y_center, const int x_center,
 // Generate anchors for SSD object detection model.
 // Output:
 //   ANCHORS: A list of anchors. Model generates predictions based on the
-//   offsets of these anchors.
+//   offsets of these anchors. This untagged side packet is a vector of Anchor
+//   protos.
+//   ANCHOR_ARRAY (optional): The same anchors as an AnchorArray, which
+//   TensorsToDetectionsCalculator decodes boxes from directly. Graphs that
+//   only output it don't build the Anchor protos.
 //
 // Usage example:
 // node {
@@ -151,7 +165,16 @@ Anchor CalculateAnchorBox(const int y_center, const int x_center,
 class SsdAnchorsCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
-    cc->OutputSidePackets().Index(0).Set<std::vector<Anchor>>();
+    RET_CHECK(cc->OutputSidePackets().HasTag("") ||
+              cc->OutputSidePackets().HasTag(kAnchorArrayTag))
+        << "At least one output side packet is required.";
+    if (cc->OutputSidePackets().HasTag("")) {
+      cc->OutputSidePackets().Index(0).Set<std::vector<Anchor>>();
+    }
+    if (cc->OutputSidePackets().HasTag(kAnchorArrayTag)) {
+      cc->OutputSidePackets().Tag(kAnchorArrayTag).Set<AnchorArray>();
+    }
+    cc->SetPure(true);
     return absl::OkStatus();
   }
 
@@ -161,9 +184,17 @@ class SsdAnchorsCalculator : public CalculatorBase {
     const SsdAnchorsCalculatorOptions& options =
         cc->Options<SsdAnchorsCalculatorOptions>();
 
-    auto anchors = absl::make_unique<std::vector<Anchor>>();
+    auto anchors = absl::make_unique<AnchorArray>();
     MP_RETURN_IF_ERROR(GenerateAnchors(anchors.get(), options));
-    cc->OutputSidePackets().Index(0).Set(Adopt(anchors.release()));
+    if (cc->OutputSidePackets().HasTag("")) {
+      cc->OutputSidePackets().Index(0).Set(
+          MakePacket<std::vector<Anchor>>(anchors->ToAnchors()));
+    }
+    if (cc->OutputSidePackets().HasTag(kAnchorArrayTag)) {
+      cc->OutputSidePackets()
+          .Tag(kAnchorArrayTag)
+          .Set(Adopt(anchors.release()));
+    }
     return absl::OkStatus();
   }
 
@@ -173,10 +204,10 @@ class SsdAnchorsCalculator : public CalculatorBase {
 
  private:
   static absl::Status GenerateAnchors(
-      std::vector<Anchor>* anchors, const SsdAnchorsCalculatorOptions& options);
+      AnchorArray* anchors, const SsdAnchorsCalculatorOptions& options);
 
   static absl::Status GenerateMultiScaleAnchors(
-      std::vector<Anchor>* anchors, const SsdAnchorsCalculatorOptions& options);
+      AnchorArray* anchors, const SsdAnchorsCalculatorOptions& options);
 };
 REGISTER_CALCULATOR(SsdAnchorsCalculator);
 
@@ -185,7 +216,7 @@ REGISTER_CALCULATOR(SsdAnchorsCalculator);
 // "Focal Loss for Dense Object Detection" (https://arxiv.org/abs/1708.02002)
 // T.-Y. Lin, P. Goyal, R. Girshick, K. He, P. Dollar
 absl::Status SsdAnchorsCalculator::GenerateMultiScaleAnchors(
-    std::vector<Anchor>* anchors, const SsdAnchorsCalculatorOptions& options) {
+    AnchorArray* anchors, const SsdAnchorsCalculatorOptions& options) {
   std::vector<MultiScaleAnchorInfo> anchor_infos;
   for (int i = options.min_level(); i <= options.max_level(); ++i) {
     MultiScaleAnchorInfo current_anchor_info;
@@ -222,7 +253,7 @@ absl::Status SsdAnchorsCalculator::GenerateMultiScaleAnchors(
         for (unsigned int j = 0; j < anchor_infos[i].aspect_ratios.size();
              ++j) {
           for (unsigned int k = 0; k < anchor_infos[i].scales.size(); ++k) {
-            Anchor anchor = CalculateAnchorBox(
+            AnchorBox anchor = CalculateAnchorBox(
                 /*y_center=*/y, /*x_center=*/x, anchor_infos[i].scales[k],
                 anchor_infos[i].aspect_ratios[j],
                 anchor_infos[i].base_anchor_size,
@@ -235,7 +266,8 @@ absl::Status SsdAnchorsCalculator::GenerateMultiScaleAnchors(
               NormalizeAnchor(options.input_size_height(),
                               options.input_size_width(), &anchor);
             }
-            anchors->push_back(anchor);
+            anchors->Append(anchor.y_center, anchor.x_center, anchor.h,
+                            anchor.w);
           }
         }
       }
@@ -246,7 +278,7 @@ absl::Status SsdAnchorsCalculator::GenerateMultiScaleAnchors(
 }
 
 absl::Status SsdAnchorsCalculator::GenerateAnchors(
-    std::vector<Anchor>* anchors, const SsdAnchorsCalculatorOptions& options) {
+    AnchorArray* anchors, const SsdAnchorsCalculatorOptions& options) {
   // Verify the options.
   if (!options.feature_map_height_size() && !options.strides_size()) {
     return absl::InvalidArgumentError(
@@ -342,18 +374,12 @@ absl::Status SsdAnchorsCalculator::GenerateAnchors(
           const float y_center =
               (y + options.anchor_offset_y()) * 1.0f / feature_map_height;
 
-          Anchor new_anchor;
-          new_anchor.set_x_center(x_center);
-          new_anchor.set_y_center(y_center);
-
           if (options.fixed_anchor_size()) {
-            new_anchor.set_w(1.0f);
-            new_anchor.set_h(1.0f);
+            anchors->Append(y_center, x_center, 1.0f, 1.0f);
           } else {
-            new_anchor.set_w(anchor_width[anchor_id]);
-            new_anchor.set_h(anchor_height[anchor_id]);
+            anchors->Append(y_center, x_center, anchor_height[anchor_id],
+                            anchor_width[anchor_id]);
           }
-          anchors->push_back(new_anchor);
         }
       }
     }
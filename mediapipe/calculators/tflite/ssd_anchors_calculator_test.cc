@@ -17,6 +17,7 @@
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor_array.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -104,6 +105,44 @@ TEST(SsdAnchorCalculatorTest, FaceDetectionConfig) {
   CompareAnchors(anchors, anchors_golden);
 }
 
+TEST(SsdAnchorCalculatorTest, OutputsAnchorArray) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "SsdAnchorsCalculator"
+    output_side_packet: "ANCHOR_ARRAY:anchor_array"
+    options {
+      [mediapipe.SsdAnchorsCalculatorOptions.ext] {
+        num_layers: 5
+        min_scale: 0.1171875
+        max_scale: 0.75
+        input_size_height: 256
+        input_size_width: 256
+        anchor_offset_x: 0.5
+        anchor_offset_y: 0.5
+        strides: 8
+        strides: 16
+        strides: 32
+        strides: 32
+        strides: 32
+        aspect_ratios: 1.0
+        fixed_anchor_size: true
+      }
+    }
+  )pb"));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+
+  const auto& anchor_array =
+      runner.OutputSidePackets().Tag("ANCHOR_ARRAY").Get<AnchorArray>();
+  std::string anchors_string;
+  MP_EXPECT_OK(mediapipe::file::GetContents(
+      GetGoldenFilePath("anchor_golden_file_0.txt"), &anchors_string));
+
+  std::vector<Anchor> anchors_golden;
+  ParseAnchorsFromText(anchors_string, &anchors_golden);
+
+  CompareAnchors(anchor_array.ToAnchors(), anchors_golden);
+}
+
 TEST(SsdAnchorCalculatorTest, MobileSSDConfig) {
   CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
     calculator: "SsdAnchorsCalculator"
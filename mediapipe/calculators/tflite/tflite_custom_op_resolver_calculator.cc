@@ -68,6 +68,7 @@ class TfLiteCustomOpResolverCalculator : public CalculatorBase {
           .Index(0)
           .Set<tflite::ops::builtin::BuiltinOpResolver>();
     }
+    cc->SetPure(true);
     return absl::OkStatus();
   }
 
@@ -67,6 +67,7 @@ class TfLiteModelCalculator : public CalculatorBase {
     }
 
     cc->OutputSidePackets().Tag("MODEL").Set<TfLiteModelPtr>();
+    cc->SetPure(true);
     return absl::OkStatus();
   }
 
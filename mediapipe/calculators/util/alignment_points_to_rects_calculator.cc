@@ -5,10 +5,12 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/rect_batch.h"
 
 namespace mediapipe {
 
@@ -23,6 +25,8 @@ namespace {}  // namespace
 //       computing the rotation (it is caused by the fact that Y axis is
 //       directed downwards). So define target rotation vector accordingly.
 //
+// Like DetectionsToRectsCalculator, it also converts a DETECTION_BATCH input.
+//
 // Example config:
 //   node {
 //     calculator: "AlignmentPointsRectsCalculator"
@@ -60,6 +64,9 @@ class AlignmentPointsRectsCalculator : public DetectionsToRectsCalculator {
       const ::mediapipe::Detection& detection,
       const DetectionSpec& detection_spec,
       ::mediapipe::NormalizedRect* rect) override;
+  absl::Status DetectionBatchToNormalizedRects(
+      const DetectionBatch& detections, const DetectionSpec& detection_spec,
+      RectBatch* rects) override;
 };
 REGISTER_CALCULATOR(AlignmentPointsRectsCalculator);
 
@@ -70,32 +77,34 @@ absl::Status AlignmentPointsRectsCalculator::DetectionToNormalizedRect(
   const auto& image_size = detection_spec.image_size;
   RET_CHECK(image_size) << "Image size is required to calculate the rect";
 
-  const float x_center =
-      location_data.relative_keypoints(start_keypoint_index_).x() *
-      image_size->first;
-  const float y_center =
-      location_data.relative_keypoints(start_keypoint_index_).y() *
-      image_size->second;
-
-  const float x_scale =
-      location_data.relative_keypoints(end_keypoint_index_).x() *
-      image_size->first;
-  const float y_scale =
-      location_data.relative_keypoints(end_keypoint_index_).y() *
-      image_size->second;
-
-  // Bounding box size as double distance from center to scale point.
-  const float box_size =
-      std::sqrt((x_scale - x_center) * (x_scale - x_center) +
-                (y_scale - y_center) * (y_scale - y_center)) *
-      2.0;
+  const auto& center = location_data.relative_keypoints(start_keypoint_index_);
+  const auto& scale = location_data.relative_keypoints(end_keypoint_index_);
+  const float x[] = {center.x(), scale.x()};
+  const float y[] = {center.y(), scale.y()};
+  RectBatch rects;
+  rects.Resize(1);
+  SetRectsFromAlignmentPoints(x, y, /*num_points=*/2, /*center_index=*/0,
+                              /*scale_index=*/1, image_size->first,
+                              image_size->second, &rects);
 
   // Set resulting bounding box.
-  rect->set_x_center(x_center / image_size->first);
-  rect->set_y_center(y_center / image_size->second);
-  rect->set_width(box_size / image_size->first);
-  rect->set_height(box_size / image_size->second);
+  rect->set_x_center(rects.x_center[0]);
+  rect->set_y_center(rects.y_center[0]);
+  rect->set_width(rects.width[0]);
+  rect->set_height(rects.height[0]);
+
+  return absl::OkStatus();
+}
 
+absl::Status AlignmentPointsRectsCalculator::DetectionBatchToNormalizedRects(
+    const DetectionBatch& detections, const DetectionSpec& detection_spec,
+    RectBatch* rects) {
+  const auto& image_size = detection_spec.image_size;
+  RET_CHECK(image_size) << "Image size is required to calculate the rect";
+  SetRectsFromAlignmentPoints(
+      detections.keypoint_x.data(), detections.keypoint_y.data(),
+      detections.num_keypoints, start_keypoint_index_, end_keypoint_index_,
+      image_size->first, image_size->second, rects);
   return absl::OkStatus();
 }
 
@@ -26,9 +26,13 @@
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/framework/port/vector.h"
 #include "mediapipe/util/annotation_renderer.h"
 #include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/image_frame_util.h"
+#include "mediapipe/util/render_commands.h"
 #include "mediapipe/util/render_data.pb.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
@@ -43,6 +47,7 @@ namespace mediapipe {
 namespace {
 
 constexpr char kVectorTag[] = "VECTOR";
+constexpr char kRenderCommandsTag[] = "RENDER_COMMANDS";
 constexpr char kGpuBufferTag[] = "IMAGE_GPU";
 constexpr char kImageFrameTag[] = "IMAGE";
 
@@ -56,6 +61,14 @@ size_t RoundUp(size_t n, size_t m) { return ((n + m - 1) / m) * m; }  // NOLINT
 // this color is not supported and it should be set to something unlikely used.
 constexpr uchar kAnnotationBackgroundColor = 2;  // Grayscale value.
 
+// Row alignment of the output frames allocated on CPU.
+#if !MEDIAPIPE_DISABLE_GPU
+constexpr int kOutputAlignmentBoundary =
+    ImageFrame::kGlDefaultAlignmentBoundary;
+#else
+constexpr int kOutputAlignmentBoundary = ImageFrame::kDefaultAlignmentBoundary;
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
 // Future Image type.
 inline bool HasImageTag(mediapipe::CalculatorContext* cc) { return false; }
 }  // namespace
@@ -73,6 +86,10 @@ inline bool HasImageTag(mediapipe::CalculatorContext* cc) { return false; }
 //  3. std::vector<RenderData> on variable number of input streams. RenderData
 //     objects at a particular timestamp are drawn on the image in order of the
 //     input vector items. These input streams are tagged with "VECTOR".
+//  4. RenderCommands on variable number of input streams, tagged with
+//     "RENDER_COMMANDS". They are drawn without conversion to RenderData.
+//
+// All inputs are drawn in the order of their input streams.
 //
 // Output:
 //  1. IMAGE or IMAGE_GPU: A rendered ImageFrame (or GpuBuffer),
@@ -96,6 +113,7 @@ inline bool HasImageTag(mediapipe::CalculatorContext* cc) { return false; }
 //   input_stream: "render_data_3"
 //   input_stream: "VECTOR:0:render_data_vec_0"
 //   input_stream: "VECTOR:1:render_data_vec_1"
+//   input_stream: "RENDER_COMMANDS:render_commands"
 //   output_stream: "IMAGE:decorated_frames"
 //   options {
 //     [mediapipe.AnnotationOverlayCalculatorOptions.ext] {
@@ -134,15 +152,14 @@ class AnnotationOverlayCalculator : public CalculatorBase {
  private:
   absl::Status CreateRenderTargetCpu(CalculatorContext* cc,
                                      std::unique_ptr<cv::Mat>& image_mat,
-                                     ImageFormat::Format* target_format);
+                                     std::unique_ptr<ImageFrame>& output_frame);
   template <typename Type, const char* Tag>
   absl::Status CreateRenderTargetGpu(CalculatorContext* cc,
                                      std::unique_ptr<cv::Mat>& image_mat);
   template <typename Type, const char* Tag>
   absl::Status RenderToGpu(CalculatorContext* cc, uchar* overlay_image);
   absl::Status RenderToCpu(CalculatorContext* cc,
-                           const ImageFormat::Format& target_format,
-                           uchar* data_image);
+                           std::unique_ptr<ImageFrame> output_frame);
 
   absl::Status GlRender(CalculatorContext* cc);
   template <typename Type, const char* Tag>
@@ -154,6 +171,9 @@ class AnnotationOverlayCalculator : public CalculatorBase {
   // Underlying helper renderer library.
   std::unique_ptr<AnnotationRenderer> renderer_;
 
+  // Renders the annotations with multiple threads, if num_threads > 1.
+  std::unique_ptr<ThreadPool> thread_pool_;
+
   // Indicates if image frame is available as input.
   bool image_frame_available_ = false;
 
@@ -205,6 +225,8 @@ absl::Status AnnotationOverlayCalculator::GetContract(CalculatorContract* cc) {
     std::string tag = tag_and_index.first;
     if (tag == kVectorTag) {
       cc->Inputs().Get(id).Set<std::vector<RenderData>>();
+    } else if (tag == kRenderCommandsTag) {
+      cc->Inputs().Get(id).Set<RenderCommands>();
     } else if (tag.empty()) {
       // Empty tag defaults to accepting a single object of RenderData type.
       cc->Inputs().Get(id).Set<RenderData>();
@@ -252,6 +274,12 @@ absl::Status AnnotationOverlayCalculator::Open(CalculatorContext* cc) {
   renderer_ = absl::make_unique<AnnotationRenderer>();
   renderer_->SetFlipTextVertically(options_.flip_text_vertically());
   if (use_gpu_) renderer_->SetScaleFactor(options_.gpu_scale_factor());
+  if (options_.num_threads() > 1) {
+    thread_pool_ = absl::make_unique<ThreadPool>("AnnotationOverlay",
+                                                 options_.num_threads());
+    thread_pool_->StartWorkers();
+    renderer_->SetThreadPool(thread_pool_.get());
+  }
 
   // Set the output header based on the input header (if present).
   const char* tag = use_gpu_ ? kGpuBufferTag : kImageFrameTag;
@@ -283,7 +311,7 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
 
   // Initialize render target, drawn with OpenCV.
   std::unique_ptr<cv::Mat> image_mat;
-  ImageFormat::Format target_format;
+  std::unique_ptr<ImageFrame> output_frame;
   if (use_gpu_) {
 #if !MEDIAPIPE_DISABLE_GPU
     if (!gpu_initialized_) {
@@ -301,7 +329,7 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
 #endif  // !MEDIAPIPE_DISABLE_GPU
   } else {
     if (cc->Outputs().HasTag(kImageFrameTag)) {
-      MP_RETURN_IF_ERROR(CreateRenderTargetCpu(cc, image_mat, &target_format));
+      MP_RETURN_IF_ERROR(CreateRenderTargetCpu(cc, image_mat, output_frame));
     }
   }
 
@@ -313,7 +341,7 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
        ++id) {
     auto tag_and_index = cc->Inputs().TagAndIndexFromId(id);
     std::string tag = tag_and_index.first;
-    if (!tag.empty() && tag != kVectorTag) {
+    if (!tag.empty() && tag != kVectorTag && tag != kRenderCommandsTag) {
       continue;
     }
     if (cc->Inputs().Get(id).IsEmpty()) {
@@ -323,6 +351,9 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
       // Empty tag defaults to accepting a single object of RenderData type.
       const RenderData& render_data = cc->Inputs().Get(id).Get<RenderData>();
       renderer_->RenderDataOnImage(render_data);
+    } else if (tag == kRenderCommandsTag) {
+      renderer_->RenderCommandsOnImage(
+          cc->Inputs().Get(id).Get<RenderCommands>());
     } else {
       RET_CHECK_EQ(kVectorTag, tag);
       const std::vector<RenderData>& render_data_vec =
@@ -344,9 +375,8 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
         }));
 #endif  // !MEDIAPIPE_DISABLE_GPU
   } else {
-    // Copy the rendered image to output.
-    uchar* image_mat_ptr = image_mat->data;
-    MP_RETURN_IF_ERROR(RenderToCpu(cc, target_format, image_mat_ptr));
+    // The image was rendered onto the output frame.
+    MP_RETURN_IF_ERROR(RenderToCpu(cc, std::move(output_frame)));
   }
 
   return absl::OkStatus();
@@ -366,21 +396,7 @@ absl::Status AnnotationOverlayCalculator::Close(CalculatorContext* cc) {
 }
 
 absl::Status AnnotationOverlayCalculator::RenderToCpu(
-    CalculatorContext* cc, const ImageFormat::Format& target_format,
-    uchar* data_image) {
-  auto output_frame = absl::make_unique<ImageFrame>(
-      target_format, renderer_->GetImageWidth(), renderer_->GetImageHeight());
-
-#if !MEDIAPIPE_DISABLE_GPU
-  output_frame->CopyPixelData(target_format, renderer_->GetImageWidth(),
-                              renderer_->GetImageHeight(), data_image,
-                              ImageFrame::kGlDefaultAlignmentBoundary);
-#else
-  output_frame->CopyPixelData(target_format, renderer_->GetImageWidth(),
-                              renderer_->GetImageHeight(), data_image,
-                              ImageFrame::kDefaultAlignmentBoundary);
-#endif  // !MEDIAPIPE_DISABLE_GPU
-
+    CalculatorContext* cc, std::unique_ptr<ImageFrame> output_frame) {
   if (cc->Outputs().HasTag(kImageFrameTag)) {
     cc->Outputs()
         .Tag(kImageFrameTag)
@@ -441,49 +457,46 @@ absl::Status AnnotationOverlayCalculator::RenderToGpu(CalculatorContext* cc,
 
 absl::Status AnnotationOverlayCalculator::CreateRenderTargetCpu(
     CalculatorContext* cc, std::unique_ptr<cv::Mat>& image_mat,
-    ImageFormat::Format* target_format) {
+    std::unique_ptr<ImageFrame>& output_frame) {
   if (image_frame_available_) {
     const auto& input_frame =
         cc->Inputs().Tag(kImageFrameTag).Get<ImageFrame>();
 
-    int target_mat_type;
     switch (input_frame.Format()) {
       case ImageFormat::SRGBA:
-        *target_format = ImageFormat::SRGBA;
-        target_mat_type = CV_8UC4;
-        break;
       case ImageFormat::SRGB:
-        *target_format = ImageFormat::SRGB;
-        target_mat_type = CV_8UC3;
+        // Render onto the input frame itself, which is only copied if other
+        // calculators also read it.
+        ASSIGN_OR_RETURN(output_frame,
+                         image_frame_util::ConsumeOrCopyImageFrame(
+                             &cc->Inputs().Tag(kImageFrameTag).Value(),
+                             kOutputAlignmentBoundary));
         break;
-      case ImageFormat::GRAY8:
-        *target_format = ImageFormat::SRGB;
-        target_mat_type = CV_8UC3;
+      case ImageFormat::GRAY8: {
+        output_frame = absl::make_unique<ImageFrame>(
+            ImageFormat::SRGB, input_frame.Width(), input_frame.Height(),
+            kOutputAlignmentBoundary);
+        cv::Mat output_mat = formats::MatView(output_frame.get());
+        cv::cvtColor(formats::MatView(&input_frame), output_mat, CV_GRAY2RGB);
         break;
+      }
       default:
         return absl::UnknownError("Unexpected image frame format.");
         break;
     }
-
-    image_mat = absl::make_unique<cv::Mat>(
-        input_frame.Height(), input_frame.Width(), target_mat_type);
-
-    auto input_mat = formats::MatView(&input_frame);
-    if (input_frame.Format() == ImageFormat::GRAY8) {
-      cv::Mat rgb_mat;
-      cv::cvtColor(input_mat, rgb_mat, CV_GRAY2RGB);
-      rgb_mat.copyTo(*image_mat);
-    } else {
-      input_mat.copyTo(*image_mat);
-    }
   } else {
-    image_mat = absl::make_unique<cv::Mat>(
-        options_.canvas_height_px(), options_.canvas_width_px(), CV_8UC3,
-        cv::Scalar(options_.canvas_color().r(), options_.canvas_color().g(),
-                   options_.canvas_color().b()));
-    *target_format = ImageFormat::SRGB;
+    output_frame = absl::make_unique<ImageFrame>(
+        ImageFormat::SRGB, options_.canvas_width_px(),
+        options_.canvas_height_px(), kOutputAlignmentBoundary);
+    formats::MatView(output_frame.get())
+        .setTo(cv::Scalar(options_.canvas_color().r(),
+                          options_.canvas_color().g(),
+                          options_.canvas_color().b()));
   }
 
+  // The renderer draws onto the output frame through this view.
+  image_mat = absl::make_unique<cv::Mat>(formats::MatView(output_frame.get()));
+
   return absl::OkStatus();
 }
 
@@ -16,9 +16,9 @@
 #define MEDIAPIPE_CALCULATORS_UTIL_ASSOCIATION_CALCULATOR_H_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
-#include "absl/memory/memory.h"
 #include "mediapipe/calculators/util/association_calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -78,11 +78,7 @@ class AssociationCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    auto get_non_overlapping_elements = GetNonOverlappingElements(cc);
-    if (!get_non_overlapping_elements.ok()) {
-      return get_non_overlapping_elements.status();
-    }
-    std::list<T> result = get_non_overlapping_elements.value();
+    ASSIGN_OR_RETURN(auto result, GetNonOverlappingElements(cc));
 
     if (has_prev_input_stream_ &&
         !cc->Inputs().Get(prev_input_stream_id_).IsEmpty()) {
@@ -98,11 +94,8 @@ class AssociationCalculator : public CalculatorBase {
           PropagateIdsFromPreviousToCurrent(prev_input_vec, &result));
     }
 
-    auto output = absl::make_unique<std::vector<T>>();
-    for (auto it = result.begin(); it != result.end(); ++it) {
-      output->push_back(*it);
-    }
-    cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
+    cc->Outputs().Index(0).Add(
+        new std::vector<T>(std::move(result)), cc->InputTimestamp());
 
     return absl::OkStatus();
   }
@@ -122,14 +115,22 @@ class AssociationCalculator : public CalculatorBase {
   virtual void SetId(T* input, int id) {}
 
  private:
+  // The elements kept so far, in output order. Elements replaced by
+  // overlapping higher-priority elements are marked as removed, and the
+  // rectangles are indexed so that each new element is only compared with the
+  // elements it intersects.
+  struct KeptElements {
+    std::vector<T> elements;
+    std::vector<Rectangle_f> rects;
+    std::vector<bool> removed;
+    RectangleIndex index;
+  };
+
   // Get a list of non-overlapping elements from all input streams, with
   // increasing order of priority based on input stream index.
-  absl::StatusOr<std::list<T>> GetNonOverlappingElements(
+  absl::StatusOr<std::vector<T>> GetNonOverlappingElements(
       CalculatorContext* cc) {
-    std::list<T> result;
-
-    // Initialize result with the first non-empty input vector.
-    CollectionItemId non_empty_id = cc->Inputs().BeginId();
+    KeptElements kept;
     for (CollectionItemId id = cc->Inputs().BeginId();
          id < cc->Inputs().EndId(); ++id) {
       if (id == prev_input_stream_id_ || cc->Inputs().Get(id).IsEmpty()) {
@@ -137,65 +138,50 @@ class AssociationCalculator : public CalculatorBase {
       }
       const std::vector<T>& input_vec =
           cc->Inputs().Get(id).Get<std::vector<T>>();
-      if (!input_vec.empty()) {
-        non_empty_id = id;
-        result.push_back(input_vec[0]);
-        for (int j = 1; j < input_vec.size(); ++j) {
-          MP_RETURN_IF_ERROR(AddElementToList(input_vec[j], &result));
-        }
-        break;
+      for (const T& element : input_vec) {
+        MP_RETURN_IF_ERROR(AddElement(element, &kept));
       }
     }
 
-    // Compare remaining input vectors with the non-empty result vector,
-    // remove lower-priority overlapping elements from the result vector and
-    // had corresponding higher-priority elements as necessary.
-    for (CollectionItemId id = non_empty_id + 1; id < cc->Inputs().EndId();
-         ++id) {
-      if (id == prev_input_stream_id_ || cc->Inputs().Get(id).IsEmpty()) {
-        continue;
-      }
-      const std::vector<T>& input_vec =
-          cc->Inputs().Get(id).Get<std::vector<T>>();
-
-      for (int vi = 0; vi < input_vec.size(); ++vi) {
-        MP_RETURN_IF_ERROR(AddElementToList(input_vec[vi], &result));
+    std::vector<T> result;
+    for (int i = 0; i < kept.elements.size(); ++i) {
+      if (!kept.removed[i]) {
+        result.push_back(std::move(kept.elements[i]));
       }
     }
-
     return result;
   }
 
-  absl::Status AddElementToList(T element, std::list<T>* current) {
-    // Compare this element with elements of the input collection. If this
-    // element has high overlap with elements of the collection, remove
-    // those elements from the collection and add this element.
+  absl::Status AddElement(T element, KeptElements* kept) {
+    // Compare this element with the kept elements. If this element has high
+    // overlap with some of them, remove those elements and add this element.
     ASSIGN_OR_RETURN(auto cur_rect, GetRectangle(element));
 
     bool change_id = false;
     int new_elem_id = -1;
 
-    for (auto uit = current->begin(); uit != current->end();) {
-      ASSIGN_OR_RETURN(auto prev_rect, GetRectangle(*uit));
-      if (CalculateIou(cur_rect, prev_rect) >
+    for (int i : kept->index.Query(cur_rect)) {
+      if (kept->removed[i]) continue;
+      if (CalculateIou(cur_rect, kept->rects[i]) >
           options_.min_similarity_threshold()) {
-        std::pair<bool, int> prev_id = GetId(*uit);
+        std::pair<bool, int> prev_id = GetId(kept->elements[i]);
         // If prev_id.first is false when some element doesn't have an ID,
         // change_id and new_elem_id will not be updated.
         if (prev_id.first) {
           change_id = prev_id.first;
           new_elem_id = prev_id.second;
         }
-        uit = current->erase(uit);
-      } else {
-        ++uit;
+        kept->removed[i] = true;
       }
     }
 
     if (change_id) {
       SetId(&element, new_elem_id);
     }
-    current->push_back(element);
+    kept->index.Insert(kept->elements.size(), cur_rect);
+    kept->elements.push_back(std::move(element));
+    kept->rects.push_back(cur_rect);
+    kept->removed.push_back(false);
 
     return absl::OkStatus();
   }
@@ -204,25 +190,24 @@ class AssociationCalculator : public CalculatorBase {
   // of elements from the previous input stream, and propagate IDs from the
   // previous input stream as appropriate.
   absl::Status PropagateIdsFromPreviousToCurrent(
-      const std::vector<T>& prev_input_vec, std::list<T>* current) {
-    for (auto vit = current->begin(); vit != current->end(); ++vit) {
-      auto get_cur_rectangle = GetRectangle(*vit);
-      if (!get_cur_rectangle.ok()) {
-        return get_cur_rectangle.status();
-      }
-      const Rectangle_f& cur_rect = get_cur_rectangle.value();
+      const std::vector<T>& prev_input_vec, std::vector<T>* current) {
+    std::vector<Rectangle_f> prev_rects;
+    prev_rects.reserve(prev_input_vec.size());
+    RectangleIndex prev_index;
+    for (int ui = 0; ui < prev_input_vec.size(); ++ui) {
+      ASSIGN_OR_RETURN(auto prev_rect, GetRectangle(prev_input_vec[ui]));
+      prev_index.Insert(ui, prev_rect);
+      prev_rects.push_back(prev_rect);
+    }
+
+    for (T& element : *current) {
+      ASSIGN_OR_RETURN(auto cur_rect, GetRectangle(element));
 
       bool change_id = false;
       int id_for_vi = -1;
 
-      for (int ui = 0; ui < prev_input_vec.size(); ++ui) {
-        auto get_prev_rectangle = GetRectangle(prev_input_vec[ui]);
-        if (!get_prev_rectangle.ok()) {
-          return get_prev_rectangle.status();
-        }
-        const Rectangle_f& prev_rect = get_prev_rectangle.value();
-
-        if (CalculateIou(cur_rect, prev_rect) >
+      for (int ui : prev_index.Query(cur_rect)) {
+        if (CalculateIou(cur_rect, prev_rects[ui]) >
             options_.min_similarity_threshold()) {
           std::pair<bool, int> prev_id = GetId(prev_input_vec[ui]);
           // If prev_id.first is false when some element doesn't have an ID,
@@ -235,9 +220,7 @@ class AssociationCalculator : public CalculatorBase {
       }
 
       if (change_id) {
-        T element = *vit;
         SetId(&element, id_for_vi);
-        *vit = element;
       }
     }
     return absl::OkStatus();
@@ -0,0 +1,100 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace api2 {
+
+// Converts a DetectionBatch to std::vector<Detection>, where a detection
+// pipeline working on detection batches ends.
+//
+// Inputs:
+//   DETECTION_BATCH - DetectionBatch.
+// Outputs:
+//   DETECTIONS - std::vector<Detection>.
+//
+// Example:
+// node {
+//   calculator: "DetectionBatchToDetectionsCalculator"
+//   input_stream: "DETECTION_BATCH:detection_batch"
+//   output_stream: "DETECTIONS:detections"
+// }
+class DetectionBatchToDetectionsCalculator : public Node {
+ public:
+  static constexpr Input<DetectionBatch> kInDetections{"DETECTION_BATCH"};
+  static constexpr Output<std::vector<Detection>> kOutDetections{"DETECTIONS"};
+  MEDIAPIPE_NODE_CONTRACT(kInDetections, kOutDetections);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kInDetections(cc).IsEmpty()) return absl::OkStatus();
+    kOutDetections(cc).Send(UnpackDetections(*kInDetections(cc)));
+    return absl::OkStatus();
+  }
+};
+MEDIAPIPE_REGISTER_NODE(DetectionBatchToDetectionsCalculator);
+
+// Converts std::vector<Detection> to a DetectionBatch, where a detection
+// pipeline working on detection batches starts. The detections must have
+// relative bounding boxes and the same number of keypoints.
+//
+// Inputs:
+//   DETECTIONS - std::vector<Detection>.
+// Outputs:
+//   DETECTION_BATCH - DetectionBatch.
+//
+// Example:
+// node {
+//   calculator: "DetectionsToDetectionBatchCalculator"
+//   input_stream: "DETECTIONS:detections"
+//   output_stream: "DETECTION_BATCH:detection_batch"
+// }
+class DetectionsToDetectionBatchCalculator : public Node {
+ public:
+  static constexpr Input<std::vector<Detection>> kInDetections{"DETECTIONS"};
+  static constexpr Output<DetectionBatch> kOutDetections{"DETECTION_BATCH"};
+  MEDIAPIPE_NODE_CONTRACT(kInDetections, kOutDetections);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kInDetections(cc).IsEmpty()) return absl::OkStatus();
+    ASSIGN_OR_RETURN(DetectionBatch detections,
+                     PackDetections(*kInDetections(cc)));
+    kOutDetections(cc).Send(std::move(detections));
+    return absl::OkStatus();
+  }
+};
+MEDIAPIPE_REGISTER_NODE(DetectionsToDetectionBatchCalculator);
+
+}  // namespace api2
+}  // namespace mediapipe
@@ -20,6 +20,7 @@
 #include "mediapipe/framework/port/proto_ns.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/util/label_map.pb.h"
+#include "mediapipe/util/label_map_table.h"
 #include "mediapipe/util/resource_util.h"
 
 #if defined(MEDIAPIPE_MOBILE)
@@ -31,11 +32,23 @@
 
 namespace mediapipe {
 
+namespace {
+
+constexpr char kLabelMapTag[] = "LABEL_MAP";
+
+}  // namespace
+
 // Takes a label map (from label IDs to names), and replaces the label IDs
 // in Detection protos with label names. Note that the calculator makes a copy
 // of the input detections. Consider using it only when the size of input
 // detections is small.
 //
+// The label map may be given by a LabelMapTablePtr in the LABEL_MAP input side
+// packet instead of the options. The label map in use is output in the
+// optional LABEL_MAP output side packet. With omit_labels set, the detections
+// are passed on unchanged, and their labels can be looked up in that table
+// only where they are needed.
+//
 // Example usage:
 // node {
 //   calculator: "DetectionLabelIdToTextCalculator"
@@ -55,11 +68,10 @@ class DetectionLabelIdToTextCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) override;
 
  private:
-  // Local label map built from the calculator options' `label_map_path` or
-  // `label` field.
-  proto_ns::Map<int64, LabelMapItem> local_label_map_;
+  // The label map, shared with the calculators using the same one.
+  LabelMapTablePtr label_map_;
   bool keep_label_id_;
-  const proto_ns::Map<int64, LabelMapItem>& GetLabelMap(CalculatorContext* cc);
+  bool omit_labels_;
 };
 REGISTER_CALCULATOR(DetectionLabelIdToTextCalculator);
 
@@ -67,6 +79,12 @@ absl::Status DetectionLabelIdToTextCalculator::GetContract(
     CalculatorContract* cc) {
   cc->Inputs().Index(0).Set<std::vector<Detection>>();
   cc->Outputs().Index(0).Set<std::vector<Detection>>();
+  if (cc->InputSidePackets().HasTag(kLabelMapTag)) {
+    cc->InputSidePackets().Tag(kLabelMapTag).Set<LabelMapTablePtr>();
+  }
+  if (cc->OutputSidePackets().HasTag(kLabelMapTag)) {
+    cc->OutputSidePackets().Tag(kLabelMapTag).Set<LabelMapTablePtr>();
+  }
 
   return absl::OkStatus();
 }
@@ -76,7 +94,15 @@ absl::Status DetectionLabelIdToTextCalculator::Open(CalculatorContext* cc) {
 
   const auto& options = cc->Options<DetectionLabelIdToTextCalculatorOptions>();
 
-  if (options.has_label_map_path()) {
+  proto_ns::Map<int64, LabelMapItem> local_label_map;
+  if (cc->InputSidePackets().HasTag(kLabelMapTag)) {
+    RET_CHECK(!options.has_label_map_path() && options.label().empty() &&
+              options.label_items().empty())
+        << "The LABEL_MAP side packet replaces the label map of the options.";
+    label_map_ =
+        cc->InputSidePackets().Tag(kLabelMapTag).Get<LabelMapTablePtr>();
+    RET_CHECK(label_map_ != nullptr);
+  } else if (options.has_label_map_path()) {
     RET_CHECK(options.label_items().empty() && options.label().empty())
         << "Only can set one of the following fields in the CalculatorOptions: "
            "label_map_path, label, and label_items.";
@@ -92,8 +118,9 @@ absl::Status DetectionLabelIdToTextCalculator::Open(CalculatorContext* cc) {
     while (std::getline(stream, line)) {
       LabelMapItem item;
       item.set_name(line);
-      local_label_map_[i++] = item;
+      local_label_map[i++] = item;
     }
+    label_map_ = InternLabelMapTable(local_label_map);
   } else if (!options.label().empty()) {
     RET_CHECK(options.label_items().empty())
         << "Only can set one of the following fields in the CalculatorOptions: "
@@ -101,30 +128,35 @@ absl::Status DetectionLabelIdToTextCalculator::Open(CalculatorContext* cc) {
     for (int i = 0; i < options.label_size(); ++i) {
       LabelMapItem item;
       item.set_name(options.label(i));
-      local_label_map_[i] = item;
+      local_label_map[i] = item;
     }
+    label_map_ = InternLabelMapTable(local_label_map);
+  } else {
+    label_map_ = InternLabelMapTable(options.label_items());
+  }
+  if (cc->OutputSidePackets().HasTag(kLabelMapTag)) {
+    cc->OutputSidePackets().Tag(kLabelMapTag).Set(
+        MakePacket<LabelMapTablePtr>(label_map_));
   }
   keep_label_id_ = options.keep_label_id();
+  omit_labels_ = options.omit_labels();
   return absl::OkStatus();
 }
 
 absl::Status DetectionLabelIdToTextCalculator::Process(CalculatorContext* cc) {
+  if (omit_labels_) {
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+  const auto& input_detections =
+      cc->Inputs().Index(0).Get<std::vector<Detection>>();
   std::vector<Detection> output_detections;
-  for (const auto& input_detection :
-       cc->Inputs().Index(0).Get<std::vector<Detection>>()) {
+  output_detections.reserve(input_detections.size());
+  for (const auto& input_detection : input_detections) {
     output_detections.push_back(input_detection);
     Detection& output_detection = output_detections.back();
-    bool has_text_label = false;
-    for (const int32 label_id : output_detection.label_id()) {
-      if (GetLabelMap(cc).contains(label_id)) {
-        auto item = GetLabelMap(cc).at(label_id);
-        output_detection.add_label(item.name());
-        if (item.has_display_name()) {
-          output_detection.add_display_name(item.display_name());
-        }
-        has_text_label = true;
-      }
-    }
+    const bool has_text_label =
+        AddDetectionLabels(*label_map_, &output_detection);
     // Remove label_id field if text labels exist.
     if (has_text_label && !keep_label_id_) {
       output_detection.clear_label_id();
@@ -136,12 +168,4 @@ absl::Status DetectionLabelIdToTextCalculator::Process(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
-const proto_ns::Map<int64, LabelMapItem>&
-DetectionLabelIdToTextCalculator::GetLabelMap(CalculatorContext* cc) {
-  return !local_label_map_.empty()
-             ? local_label_map_
-             : cc->Options<DetectionLabelIdToTextCalculatorOptions>()
-                   .label_items();
-}
-
 }  // namespace mediapipe
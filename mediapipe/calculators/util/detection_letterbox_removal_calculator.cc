@@ -27,10 +27,12 @@
 // limitations under the License.
 
 #include <cmath>
+#include <utility>
 #include <vector>
 
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -50,16 +52,16 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 // corresponding input image before letterboxing.
 //
 // Input:
-//   DETECTIONS: An std::vector<Detection> representing detections on an
-//   letterboxed image.
+//   DETECTIONS: An std::vector<Detection> or a DetectionBatch representing
+//   detections on an letterboxed image.
 //
 //   LETTERBOX_PADDING: An std::array<float, 4> representing the letterbox
 //   padding from the 4 sides ([left, top, right, bottom]) of the letterboxed
 //   image, normalized to [0.f, 1.f] by the letterboxed image dimensions.
 //
 // Output:
-//   DETECTIONS: An std::vector<Detection> representing detections with their
-//   locations adjusted to the letterbox-removed (non-padded) image.
+//   DETECTIONS: Detections of the same type as the input with their locations
+//   adjusted to the letterbox-removed (non-padded) image.
 //
 // Usage example:
 // node {
@@ -75,10 +77,14 @@ class DetectionLetterboxRemovalCalculator : public CalculatorBase {
               cc->Inputs().HasTag(kLetterboxPaddingTag))
         << "Missing one or more input streams.";
 
-    cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
+    cc->Inputs()
+        .Tag(kDetectionsTag)
+        .SetOneOf<std::vector<Detection>, DetectionBatch>();
     cc->Inputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
 
-    cc->Outputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
+    cc->Outputs()
+        .Tag(kDetectionsTag)
+        .SetOneOf<std::vector<Detection>, DetectionBatch>();
 
     return absl::OkStatus();
   }
@@ -95,8 +101,6 @@ class DetectionLetterboxRemovalCalculator : public CalculatorBase {
       return absl::OkStatus();
     }
 
-    const auto& input_detections =
-        cc->Inputs().Tag(kDetectionsTag).Get<std::vector<Detection>>();
     const auto& letterbox_padding =
         cc->Inputs().Tag(kLetterboxPaddingTag).Get<std::array<float, 4>>();
 
@@ -105,6 +109,32 @@ class DetectionLetterboxRemovalCalculator : public CalculatorBase {
     const float left_and_right = letterbox_padding[0] + letterbox_padding[2];
     const float top_and_bottom = letterbox_padding[1] + letterbox_padding[3];
 
+    const Packet& input_packet = cc->Inputs().Tag(kDetectionsTag).Value();
+    if (input_packet.ValidateAsType<DetectionBatch>().ok()) {
+      DetectionBatch output_detections = input_packet.Get<DetectionBatch>();
+      for (int i = 0; i < output_detections.size(); ++i) {
+        output_detections.xmin[i] = (output_detections.xmin[i] - left) /
+                                    (1.0f - left_and_right);
+        output_detections.ymin[i] =
+            (output_detections.ymin[i] - top) / (1.0f - top_and_bottom);
+        // The size of the bounding box will change as well.
+        output_detections.width[i] /= 1.0f - left_and_right;
+        output_detections.height[i] /= 1.0f - top_and_bottom;
+      }
+      for (int i = 0; i < output_detections.keypoint_x.size(); ++i) {
+        output_detections.keypoint_x[i] =
+            (output_detections.keypoint_x[i] - left) / (1.0f - left_and_right);
+        output_detections.keypoint_y[i] =
+            (output_detections.keypoint_y[i] - top) / (1.0f - top_and_bottom);
+      }
+      cc->Outputs().Tag(kDetectionsTag).AddPacket(
+          MakePacket<DetectionBatch>(std::move(output_detections))
+              .At(cc->InputTimestamp()));
+      return absl::OkStatus();
+    }
+
+    const auto& input_detections = input_packet.Get<std::vector<Detection>>();
+
     auto output_detections = absl::make_unique<std::vector<Detection>>();
     for (const auto& detection : input_detections) {
       Detection new_detection;
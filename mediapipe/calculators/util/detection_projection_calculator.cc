@@ -20,6 +20,7 @@
 
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/point2.h"
@@ -32,15 +33,15 @@ namespace mediapipe {
 // projection matrix.
 //
 // Input:
-//   DETECTIONS - std::vector<Detection>
+//   DETECTIONS - std::vector<Detection> or DetectionBatch
 //     Detections to project using the provided projection matrix.
 //   PROJECTION_MATRIX - std::array<float, 16>
 //     A 4x4 row-major-order matrix that maps data from one coordinate system to
 //     another.
 //
 // Output:
-//   DETECTIONS - std::vector<Detection>
-//     Projected detections.
+//   DETECTIONS - std::vector<Detection> or DetectionBatch
+//     Projected detections, of the same type as the input.
 //
 // Example:
 //   node {
@@ -110,6 +111,46 @@ absl::Status ProjectDetection(
   return absl::OkStatus();
 }
 
+// Projects the keypoints and bounding boxes of a batch like
+// ProjectDetection(), one array at a time.
+void ProjectDetectionBatch(const std::array<float, 16>& project_mat,
+                           DetectionBatch* detections) {
+  const float m0 = project_mat[0], m1 = project_mat[1], m3 = project_mat[3];
+  const float m4 = project_mat[4], m5 = project_mat[5], m7 = project_mat[7];
+  float* kx = detections->keypoint_x.data();
+  float* ky = detections->keypoint_y.data();
+  for (int i = 0; i < detections->keypoint_x.size(); ++i) {
+    const float x = kx[i];
+    const float y = ky[i];
+    kx[i] = x * m0 + y * m1 + m3;
+    ky[i] = x * m4 + y * m5 + m7;
+  }
+
+  float* xmin = detections->xmin.data();
+  float* ymin = detections->ymin.data();
+  float* width = detections->width.data();
+  float* height = detections->height.data();
+  for (int i = 0; i < detections->size(); ++i) {
+    const float x0 = xmin[i];
+    const float y0 = ymin[i];
+    const float x1 = x0 + width[i];
+    const float y1 = y0 + height[i];
+    // The projected corners, in the order of ProjectDetection().
+    const float px0 = x0 * m0 + y0 * m1 + m3, py0 = x0 * m4 + y0 * m5 + m7;
+    const float px1 = x1 * m0 + y0 * m1 + m3, py1 = x1 * m4 + y0 * m5 + m7;
+    const float px2 = x1 * m0 + y1 * m1 + m3, py2 = x1 * m4 + y1 * m5 + m7;
+    const float px3 = x0 * m0 + y1 * m1 + m3, py3 = x0 * m4 + y1 * m5 + m7;
+    const float left = std::min(std::min(px0, px1), std::min(px2, px3));
+    const float top = std::min(std::min(py0, py1), std::min(py2, py3));
+    const float right = std::max(std::max(px0, px1), std::max(px2, px3));
+    const float bottom = std::max(std::max(py0, py1), std::max(py2, py3));
+    xmin[i] = left;
+    ymin[i] = top;
+    width[i] = right - left;
+    height[i] = bottom - top;
+  }
+}
+
 }  // namespace
 
 absl::Status DetectionProjectionCalculator::GetContract(
@@ -124,13 +165,13 @@ absl::Status DetectionProjectionCalculator::GetContract(
 
   for (CollectionItemId id = cc->Inputs().BeginId(kDetections);
        id != cc->Inputs().EndId(kDetections); ++id) {
-    cc->Inputs().Get(id).Set<std::vector<Detection>>();
+    cc->Inputs().Get(id).SetOneOf<std::vector<Detection>, DetectionBatch>();
   }
   cc->Inputs().Tag(kProjectionMatrix).Set<std::array<float, 16>>();
 
   for (CollectionItemId id = cc->Outputs().BeginId(kDetections);
        id != cc->Outputs().EndId(kDetections); ++id) {
-    cc->Outputs().Get(id).Set<std::vector<Detection>>();
+    cc->Outputs().Get(id).SetOneOf<std::vector<Detection>, DetectionBatch>();
   }
 
   return absl::OkStatus();
@@ -161,6 +202,15 @@ absl::Status DetectionProjectionCalculator::Process(CalculatorContext* cc) {
       continue;
     }
 
+    if (input_packet.ValidateAsType<DetectionBatch>().ok()) {
+      DetectionBatch output_detections = input_packet.Get<DetectionBatch>();
+      ProjectDetectionBatch(project_mat, &output_detections);
+      cc->Outputs().Get(output_id).AddPacket(
+          MakePacket<DetectionBatch>(std::move(output_detections))
+              .At(cc->InputTimestamp()));
+      continue;
+    }
+
     std::vector<Detection> output_detections;
     for (const auto& detection : input_packet.Get<std::vector<Detection>>()) {
       Detection output_detection = detection;
@@ -73,7 +73,9 @@ class DetectionsDeduplicateCalculator : public Node {
 
   absl::Status Process(mediapipe::CalculatorContext* cc) {
     const std::vector<Detection>& raw_detections = kIn(cc).Get();
-    absl::flat_hash_map<LocationData::BoundingBox, Detection*, BoundingBoxHash,
+    // Maps the boxes to the indices of their deduplicated detections, which
+    // stay valid as the vector grows.
+    absl::flat_hash_map<LocationData::BoundingBox, int, BoundingBoxHash,
                         BoundingBoxEq>
         bbox_to_detections;
     std::vector<Detection> deduplicated_detections;
@@ -87,8 +89,9 @@ class DetectionsDeduplicateCalculator : public Node {
               detection.location_data().bounding_box())) {
         // The bbox location already exists. Merge the detection labels into
         // the existing detection proto.
-        Detection& deduplicated_detection =
-            *bbox_to_detections[detection.location_data().bounding_box()];
+        const int index =
+            bbox_to_detections[detection.location_data().bounding_box()];
+        Detection& deduplicated_detection = deduplicated_detections[index];
         deduplicated_detection.mutable_score()->MergeFrom(detection.score());
         deduplicated_detection.mutable_label()->MergeFrom(detection.label());
         deduplicated_detection.mutable_label_id()->MergeFrom(
@@ -98,9 +101,9 @@ class DetectionsDeduplicateCalculator : public Node {
       } else {
         // The bbox location appears first time. Add the detection to output
         // detection vector.
-        deduplicated_detections.push_back(detection);
         bbox_to_detections[detection.location_data().bounding_box()] =
-            &deduplicated_detections.back();
+            deduplicated_detections.size();
+        deduplicated_detections.push_back(detection);
       }
     }
     kOut(cc).Send(std::move(deduplicated_detections));
@@ -14,16 +14,21 @@
 #include "mediapipe/calculators/util/detections_to_rects_calculator.h"
 
 #include <cmath>
-#include <limits>
+#include <utility>
+#include <vector>
 
 #include "mediapipe/calculators/util/detections_to_rects_calculator.pb.h"
+#include "mediapipe/calculators/util/rect_transformation_util.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/util/rect_batch.h"
 
 namespace mediapipe {
 
@@ -31,34 +36,29 @@ namespace {
 
 constexpr char kDetectionTag[] = "DETECTION";
 constexpr char kDetectionsTag[] = "DETECTIONS";
+constexpr char kDetectionBatchTag[] = "DETECTION_BATCH";
 constexpr char kImageSizeTag[] = "IMAGE_SIZE";
 constexpr char kRectTag[] = "RECT";
 constexpr char kNormRectTag[] = "NORM_RECT";
 constexpr char kRectsTag[] = "RECTS";
 constexpr char kNormRectsTag[] = "NORM_RECTS";
 
-constexpr float kMinFloat = std::numeric_limits<float>::lowest();
-constexpr float kMaxFloat = std::numeric_limits<float>::max();
-
 absl::Status NormRectFromKeyPoints(const LocationData& location_data,
                                    NormalizedRect* rect) {
   RET_CHECK_GT(location_data.relative_keypoints_size(), 1)
       << "2 or more key points required to calculate a rect.";
-  float xmin = kMaxFloat;
-  float ymin = kMaxFloat;
-  float xmax = kMinFloat;
-  float ymax = kMinFloat;
-  for (int i = 0; i < location_data.relative_keypoints_size(); ++i) {
-    const auto& kp = location_data.relative_keypoints(i);
-    xmin = std::min(xmin, kp.x());
-    ymin = std::min(ymin, kp.y());
-    xmax = std::max(xmax, kp.x());
-    ymax = std::max(ymax, kp.y());
-  }
-  rect->set_x_center((xmin + xmax) / 2);
-  rect->set_y_center((ymin + ymax) / 2);
-  rect->set_width(xmax - xmin);
-  rect->set_height(ymax - ymin);
+  std::vector<float> x, y;
+  for (const auto& keypoint : location_data.relative_keypoints()) {
+    x.push_back(keypoint.x());
+    y.push_back(keypoint.y());
+  }
+  RectBatch rects;
+  rects.Resize(1);
+  SetRectsFromPointBounds(x.data(), y.data(), x.size(), &rects);
+  rect->set_x_center(rects.x_center[0]);
+  rect->set_y_center(rects.y_center[0]);
+  rect->set_width(rects.width[0]);
+  rect->set_height(rects.height[0]);
   return absl::OkStatus();
 }
 
@@ -128,10 +128,12 @@ absl::Status DetectionsToRectsCalculator::DetectionToNormalizedRect(
 }
 
 absl::Status DetectionsToRectsCalculator::GetContract(CalculatorContract* cc) {
-  RET_CHECK(cc->Inputs().HasTag(kDetectionTag) ^
-            cc->Inputs().HasTag(kDetectionsTag))
-      << "Exactly one of DETECTION or DETECTIONS input stream should be "
-         "provided.";
+  RET_CHECK_EQ((cc->Inputs().HasTag(kDetectionTag) ? 1 : 0) +
+                   (cc->Inputs().HasTag(kDetectionsTag) ? 1 : 0) +
+                   (cc->Inputs().HasTag(kDetectionBatchTag) ? 1 : 0),
+               1)
+      << "Exactly one of DETECTION, DETECTIONS or DETECTION_BATCH input stream "
+         "should be provided.";
   RET_CHECK_EQ((cc->Outputs().HasTag(kNormRectTag) ? 1 : 0) +
                    (cc->Outputs().HasTag(kRectTag) ? 1 : 0) +
                    (cc->Outputs().HasTag(kNormRectsTag) ? 1 : 0) +
@@ -146,6 +148,12 @@ absl::Status DetectionsToRectsCalculator::GetContract(CalculatorContract* cc) {
   if (cc->Inputs().HasTag(kDetectionsTag)) {
     cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
   }
+  if (cc->Inputs().HasTag(kDetectionBatchTag)) {
+    RET_CHECK(cc->Outputs().HasTag(kNormRectTag) ||
+              cc->Outputs().HasTag(kNormRectsTag))
+        << "DETECTION_BATCH can only be converted to NORM_RECT or NORM_RECTS.";
+    cc->Inputs().Tag(kDetectionBatchTag).Set<DetectionBatch>();
+  }
   if (cc->Inputs().HasTag(kImageSizeTag)) {
     cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
   }
@@ -191,6 +199,14 @@ absl::Status DetectionsToRectsCalculator::Open(CalculatorContext* cc) {
   output_zero_rect_for_empty_detections_ =
       options_.output_zero_rect_for_empty_detections();
 
+  if (options_.has_transformation()) {
+    RET_CHECK(cc->Inputs().HasTag(kImageSizeTag) ||
+              !(cc->Outputs().HasTag(kNormRectTag) ||
+                cc->Outputs().HasTag(kNormRectsTag)))
+        << "Transforming normalized rects requires IMAGE_SIZE.";
+    ASSIGN_OR_RETURN(transform_, GetRectTransform(options_.transformation()));
+  }
+
   return absl::OkStatus();
 }
 
@@ -203,9 +219,21 @@ absl::Status DetectionsToRectsCalculator::Process(CalculatorContext* cc) {
       cc->Inputs().Tag(kDetectionsTag).IsEmpty()) {
     return absl::OkStatus();
   }
+  if (cc->Inputs().HasTag(kDetectionBatchTag) &&
+      cc->Inputs().Tag(kDetectionBatchTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
   if (rotate_ && !HasTagValue(cc, kImageSizeTag)) {
     return absl::OkStatus();
   }
+  const bool normalized =
+      cc->Outputs().HasTag(kNormRectTag) || cc->Outputs().HasTag(kNormRectsTag);
+  if (transform_ && normalized && !HasTagValue(cc, kImageSizeTag)) {
+    return absl::OkStatus();
+  }
+  if (cc->Inputs().HasTag(kDetectionBatchTag)) {
+    return ProcessDetectionBatch(cc);
+  }
 
   std::vector<Detection> detections;
   if (cc->Inputs().HasTag(kDetectionTag)) {
@@ -214,94 +242,170 @@ absl::Status DetectionsToRectsCalculator::Process(CalculatorContext* cc) {
   if (cc->Inputs().HasTag(kDetectionsTag)) {
     detections = cc->Inputs().Tag(kDetectionsTag).Get<std::vector<Detection>>();
     if (detections.empty()) {
-      if (output_zero_rect_for_empty_detections_) {
-        if (cc->Outputs().HasTag(kRectTag)) {
-          cc->Outputs().Tag(kRectTag).AddPacket(
-              MakePacket<Rect>().At(cc->InputTimestamp()));
-        }
-        if (cc->Outputs().HasTag(kNormRectTag)) {
-          cc->Outputs()
-              .Tag(kNormRectTag)
-              .AddPacket(MakePacket<NormalizedRect>().At(cc->InputTimestamp()));
-        }
-        if (cc->Outputs().HasTag(kNormRectsTag)) {
-          auto rect_vector = absl::make_unique<std::vector<NormalizedRect>>();
-          rect_vector->emplace_back(NormalizedRect());
-          cc->Outputs()
-              .Tag(kNormRectsTag)
-              .Add(rect_vector.release(), cc->InputTimestamp());
-        }
-      }
+      OutputZeroRects(cc);
       return absl::OkStatus();
     }
   }
 
   // Get dynamic calculator options (e.g. `image_size`).
   const DetectionSpec detection_spec = GetDetectionSpec(cc);
-
-  if (cc->Outputs().HasTag(kRectTag)) {
-    auto output_rect = absl::make_unique<Rect>();
-    MP_RETURN_IF_ERROR(
-        DetectionToRect(detections[0], detection_spec, output_rect.get()));
-    if (rotate_) {
-      float rotation;
-      MP_RETURN_IF_ERROR(
-          ComputeRotation(detections[0], detection_spec, &rotation));
-      output_rect->set_rotation(rotation);
-    }
-    cc->Outputs().Tag(kRectTag).Add(output_rect.release(),
-                                    cc->InputTimestamp());
-  }
-  if (cc->Outputs().HasTag(kNormRectTag)) {
-    auto output_rect = absl::make_unique<NormalizedRect>();
-    MP_RETURN_IF_ERROR(DetectionToNormalizedRect(detections[0], detection_spec,
-                                                 output_rect.get()));
-    if (rotate_) {
-      float rotation;
-      MP_RETURN_IF_ERROR(
-          ComputeRotation(detections[0], detection_spec, &rotation));
-      output_rect->set_rotation(rotation);
-    }
-    cc->Outputs()
-        .Tag(kNormRectTag)
-        .Add(output_rect.release(), cc->InputTimestamp());
-  }
-  if (cc->Outputs().HasTag(kRectsTag)) {
-    auto output_rects = absl::make_unique<std::vector<Rect>>(detections.size());
-    for (int i = 0; i < detections.size(); ++i) {
-      MP_RETURN_IF_ERROR(DetectionToRect(detections[i], detection_spec,
-                                         &(output_rects->at(i))));
+  // Only the first detection is converted to a single rect.
+  const int num_rects =
+      cc->Outputs().HasTag(kRectTag) || cc->Outputs().HasTag(kNormRectTag)
+          ? 1
+          : detections.size();
+
+  if (normalized) {
+    std::vector<NormalizedRect> output_rects(num_rects);
+    for (int i = 0; i < num_rects; ++i) {
+      MP_RETURN_IF_ERROR(DetectionToNormalizedRect(
+          detections[i], detection_spec, &output_rects[i]));
       if (rotate_) {
         float rotation;
         MP_RETURN_IF_ERROR(
             ComputeRotation(detections[i], detection_spec, &rotation));
-        output_rects->at(i).set_rotation(rotation);
+        output_rects[i].set_rotation(rotation);
       }
     }
-    cc->Outputs().Tag(kRectsTag).Add(output_rects.release(),
-                                     cc->InputTimestamp());
-  }
-  if (cc->Outputs().HasTag(kNormRectsTag)) {
-    auto output_rects =
-        absl::make_unique<std::vector<NormalizedRect>>(detections.size());
-    for (int i = 0; i < detections.size(); ++i) {
-      MP_RETURN_IF_ERROR(DetectionToNormalizedRect(
-          detections[i], detection_spec, &(output_rects->at(i))));
+    if (transform_) {
+      RectBatch rects = PackRects(output_rects);
+      TransformRects(*transform_, detection_spec.image_size->first,
+                     detection_spec.image_size->second, &rects);
+      UnpackRects(rects, &output_rects);
+    }
+    if (cc->Outputs().HasTag(kNormRectTag)) {
+      cc->Outputs().Tag(kNormRectTag).AddPacket(
+          MakePacket<NormalizedRect>(std::move(output_rects[0]))
+              .At(cc->InputTimestamp()));
+    } else {
+      cc->Outputs().Tag(kNormRectsTag).AddPacket(
+          MakePacket<std::vector<NormalizedRect>>(std::move(output_rects))
+              .At(cc->InputTimestamp()));
+    }
+  } else {
+    std::vector<Rect> output_rects(num_rects);
+    for (int i = 0; i < num_rects; ++i) {
+      MP_RETURN_IF_ERROR(
+          DetectionToRect(detections[i], detection_spec, &output_rects[i]));
       if (rotate_) {
         float rotation;
         MP_RETURN_IF_ERROR(
             ComputeRotation(detections[i], detection_spec, &rotation));
-        output_rects->at(i).set_rotation(rotation);
+        output_rects[i].set_rotation(rotation);
       }
     }
+    if (transform_) {
+      RectBatch rects = PackRects(output_rects);
+      TransformRects(*transform_, 1, 1, &rects);
+      UnpackRects(rects, &output_rects);
+    }
+    if (cc->Outputs().HasTag(kRectTag)) {
+      cc->Outputs().Tag(kRectTag).AddPacket(
+          MakePacket<Rect>(std::move(output_rects[0]))
+              .At(cc->InputTimestamp()));
+    } else {
+      cc->Outputs().Tag(kRectsTag).AddPacket(
+          MakePacket<std::vector<Rect>>(std::move(output_rects))
+              .At(cc->InputTimestamp()));
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status DetectionsToRectsCalculator::ProcessDetectionBatch(
+    CalculatorContext* cc) {
+  const auto& detections =
+      cc->Inputs().Tag(kDetectionBatchTag).Get<DetectionBatch>();
+  if (detections.empty()) {
+    OutputZeroRects(cc);
+    return absl::OkStatus();
+  }
+
+  const DetectionSpec detection_spec = GetDetectionSpec(cc);
+  if (rotate_) {
+    RET_CHECK(detection_spec.image_size)
+        << "Image size is required to calculate rotation";
+    RET_CHECK(start_keypoint_index_ >= 0 &&
+              start_keypoint_index_ < detections.num_keypoints &&
+              end_keypoint_index_ >= 0 &&
+              end_keypoint_index_ < detections.num_keypoints)
+        << "Rotation keypoints are out of range.";
+  }
+  RectBatch rects;
+  rects.Resize(cc->Outputs().HasTag(kNormRectTag) ? 1 : detections.size());
+  MP_RETURN_IF_ERROR(
+      DetectionBatchToNormalizedRects(detections, detection_spec, &rects));
+  if (rotate_) {
+    SetRotationsFromPoints(
+        detections.keypoint_x.data(), detections.keypoint_y.data(),
+        detections.num_keypoints, start_keypoint_index_, end_keypoint_index_,
+        detection_spec.image_size->first, detection_spec.image_size->second,
+        target_angle_, &rects);
+  }
+  if (transform_) {
+    TransformRects(*transform_, detection_spec.image_size->first,
+                   detection_spec.image_size->second, &rects);
+  }
+  std::vector<NormalizedRect> output_rects;
+  UnpackRects(rects, &output_rects);
+
+  if (cc->Outputs().HasTag(kNormRectTag)) {
     cc->Outputs()
-        .Tag(kNormRectsTag)
-        .Add(output_rects.release(), cc->InputTimestamp());
+        .Tag(kNormRectTag)
+        .AddPacket(MakePacket<NormalizedRect>(std::move(output_rects.front()))
+                       .At(cc->InputTimestamp()));
+  } else {
+    cc->Outputs().Tag(kNormRectsTag).AddPacket(
+        MakePacket<std::vector<NormalizedRect>>(std::move(output_rects))
+            .At(cc->InputTimestamp()));
   }
+  return absl::OkStatus();
+}
 
+absl::Status DetectionsToRectsCalculator::DetectionBatchToNormalizedRects(
+    const DetectionBatch& detections, const DetectionSpec& detection_spec,
+    RectBatch* rects) {
+  if (options_.conversion_mode() ==
+      DetectionsToRectsCalculatorOptions::USE_KEYPOINTS) {
+    RET_CHECK_GT(detections.num_keypoints, 1)
+        << "2 or more key points required to calculate a rect.";
+    SetRectsFromPointBounds(detections.keypoint_x.data(),
+                            detections.keypoint_y.data(),
+                            detections.num_keypoints, rects);
+    return absl::OkStatus();
+  }
+  for (int i = 0; i < rects->size(); ++i) {
+    rects->x_center[i] = detections.xmin[i] + detections.width[i] / 2;
+    rects->y_center[i] = detections.ymin[i] + detections.height[i] / 2;
+    rects->width[i] = detections.width[i];
+    rects->height[i] = detections.height[i];
+  }
   return absl::OkStatus();
 }
 
+void DetectionsToRectsCalculator::OutputZeroRects(CalculatorContext* cc) {
+  if (!output_zero_rect_for_empty_detections_) {
+    return;
+  }
+  if (cc->Outputs().HasTag(kRectTag)) {
+    cc->Outputs().Tag(kRectTag).AddPacket(
+        MakePacket<Rect>().At(cc->InputTimestamp()));
+  }
+  if (cc->Outputs().HasTag(kNormRectTag)) {
+    cc->Outputs()
+        .Tag(kNormRectTag)
+        .AddPacket(MakePacket<NormalizedRect>().At(cc->InputTimestamp()));
+  }
+  if (cc->Outputs().HasTag(kNormRectsTag)) {
+    auto rect_vector = absl::make_unique<std::vector<NormalizedRect>>();
+    rect_vector->emplace_back(NormalizedRect());
+    cc->Outputs()
+        .Tag(kNormRectsTag)
+        .Add(rect_vector.release(), cc->InputTimestamp());
+  }
+}
+
 absl::Status DetectionsToRectsCalculator::ComputeRotation(
     const Detection& detection, const DetectionSpec& detection_spec,
     float* rotation) {
@@ -318,7 +422,7 @@ absl::Status DetectionsToRectsCalculator::ComputeRotation(
   const float y1 = location_data.relative_keypoints(end_keypoint_index_).y() *
                    image_size->second;
 
-  *rotation = NormalizeRadians(target_angle_ - std::atan2(-(y1 - y0), x1 - x0));
+  *rotation = RotationFromPoints(x0, y0, x1, y1, target_angle_);
 
   return absl::OkStatus();
 }
@@ -21,10 +21,12 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/util/rect_batch.h"
 
 namespace mediapipe {
 
@@ -49,15 +51,27 @@ struct DetectionSpec {
 // single Detection and the output is a std::vector<Rect> or
 // std::vector<NormalizedRect>, the output is a vector of size 1.
 //
+// A DetectionBatch input is read in place instead, and can only be converted to
+// NormalizedRect or std::vector<NormalizedRect>. Its rects are computed all at
+// once, by DetectionBatchToNormalizedRects() rather than by the conversions of
+// single detections.
+//
+// The `transformation` option applies the transformation of a
+// RectTransformationCalculator to the output rects, which saves a node and a
+// copy of the rects. It is set by the node fusion that folds such calculators
+// into this one. The IMAGE_SIZE input is then required for normalized rects,
+// and no rects are output without it.
+//
 // Inputs:
 //
 // One of the following:
 // DETECTION: A Detection proto.
 // DETECTIONS: An std::vector<Detection>.
+// DETECTION_BATCH: A DetectionBatch.
 //
 // IMAGE_SIZE (optional): A std::pair<int, int> represention image width and
-//   height. This is required only when rotation needs to be computed (see
-//   calculator options).
+//   height. This is required only when rotation needs to be computed or
+//   normalized rects need to be transformed (see calculator options).
 //
 // Output:
 // One of the following:
@@ -98,18 +112,31 @@ class DetectionsToRectsCalculator : public CalculatorBase {
   virtual absl::Status ComputeRotation(const ::mediapipe::Detection& detection,
                                        const DetectionSpec& detection_spec,
                                        float* rotation);
+  // Sets each rect of `rects` to the unrotated rect of the detection of
+  // `detections` with the same index.
+  virtual absl::Status DetectionBatchToNormalizedRects(
+      const DetectionBatch& detections, const DetectionSpec& detection_spec,
+      RectBatch* rects);
   virtual DetectionSpec GetDetectionSpec(const CalculatorContext* cc);
 
   static inline float NormalizeRadians(float angle) {
-    return angle - 2 * M_PI * std::floor((angle - (-M_PI)) / (2 * M_PI));
+    return ::mediapipe::NormalizeRadians(angle);
   }
 
   ::mediapipe::DetectionsToRectsCalculatorOptions options_;
   int start_keypoint_index_;
   int end_keypoint_index_;
   float target_angle_ = 0.0f;  // In radians.
-  bool rotate_;
+  bool rotate_ = false;
   bool output_zero_rect_for_empty_detections_;
+  // The transformation of the output rects, if any.
+  absl::optional<RectTransform> transform_;
+
+ private:
+  // Equivalent to Process() for the DETECTION_BATCH input.
+  absl::Status ProcessDetectionBatch(CalculatorContext* cc);
+  // Outputs the zero rects of empty input detections, if enabled.
+  void OutputZeroRects(CalculatorContext* cc);
 };
 
 }  // namespace mediapipe
@@ -16,6 +16,7 @@
 #include <memory>
 #include <vector>
 
+#include "mediapipe/calculators/util/detections_to_rects_calculator.pb.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
@@ -390,6 +391,58 @@ TEST(DetectionsToRectsCalculatorTest, DetectionToNormalizedRects) {
   EXPECT_THAT(rects[0], NormRectEq(0.25f, 0.4f, 0.3f, 0.4f));
 }
 
+TEST(DetectionsToRectsCalculatorTest, TransformsNormalizedRects) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "DetectionsToRectsCalculator"
+    input_stream: "DETECTIONS:detections"
+    input_stream: "IMAGE_SIZE:image_size"
+    output_stream: "NORM_RECTS:rect"
+    options: {
+      [mediapipe.DetectionsToRectsCalculatorOptions.ext] {
+        transformation { scale_x: 2 shift_y: -0.5 square_long: true }
+      }
+    }
+  )pb"));
+
+  auto detections(absl::make_unique<std::vector<Detection>>());
+  detections->push_back(DetectionWithRelativeLocationData(0.1, 0.2, 0.3, 0.4));
+
+  runner.MutableInputs()
+      ->Tag(kDetectionsTag)
+      .packets.push_back(
+          Adopt(detections.release()).At(Timestamp::PostStream()));
+  runner.MutableInputs()
+      ->Tag(kImageSizeTag)
+      .packets.push_back(MakePacket<std::pair<int, int>>(200, 100).At(
+          Timestamp::PostStream()));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const std::vector<Packet>& output =
+      runner.Outputs().Tag(kNormRectsTag).packets;
+  ASSERT_EQ(1, output.size());
+  const auto& rects = output[0].Get<std::vector<NormalizedRect>>();
+  ASSERT_EQ(rects.size(), 1);
+  // The rect of 60 x 40 pixels is shifted up by 20 pixels, and squared to 60
+  // pixels.
+  EXPECT_THAT(rects[0], NormRectEq(0.25f, 0.2f, 0.6f, 0.6f));
+}
+
+TEST(DetectionsToRectsCalculatorTest, TransformationRequiresImageSize) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "DetectionsToRectsCalculator"
+    input_stream: "DETECTIONS:detections"
+    output_stream: "NORM_RECTS:rect"
+    options: {
+      [mediapipe.DetectionsToRectsCalculatorOptions.ext] {
+        transformation { scale_x: 2 }
+      }
+    }
+  )pb"));
+
+  ASSERT_THAT(runner.Run().message(),
+              testing::HasSubstr("requires IMAGE_SIZE"));
+}
+
 TEST(DetectionsToRectsCalculatorTest, WrongInputToRect) {
   CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
     calculator: "DetectionsToRectsCalculator"
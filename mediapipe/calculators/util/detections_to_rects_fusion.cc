@@ -0,0 +1,178 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Folds RectTransformationCalculators into the DetectionsToRectsCalculators
+// whose rects they transform, so that the rects are transformed as they are
+// computed, without a node and a copy of the rects in between.
+
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/util/detections_to_rects_calculator.pb.h"
+#include "mediapipe/calculators/util/rect_transformation_calculator.pb.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/tool/graph_optimization.h"
+#include "mediapipe/framework/tool/options_map.h"
+#include "mediapipe/framework/tool/validate_name.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kImageSizeTag[] = "IMAGE_SIZE";
+
+struct TagAndName {
+  std::string tag;
+  std::string name;
+};
+
+absl::StatusOr<TagAndName> ParseStream(const std::string& stream) {
+  TagAndName result;
+  int index;
+  MP_RETURN_IF_ERROR(
+      tool::ParseTagIndexName(stream, &result.tag, &index, &result.name));
+  return result;
+}
+
+bool IsRectTag(const std::string& tag) {
+  return tag == "RECT" || tag == "RECTS" || tag == "NORM_RECT" ||
+         tag == "NORM_RECTS";
+}
+
+// The streams of a RectTransformationCalculator node that can be fused.
+struct Transformation {
+  TagAndName rects;
+  // Unset for absolute rects.
+  std::string image_size;
+  std::string output;
+};
+
+// Returns whether `node` is a RectTransformationCalculator with only its rect
+// input, its image size input and its output, and sets `transformation` to
+// its streams if so.
+absl::StatusOr<bool> GetTransformation(const CalculatorGraphConfig::Node& node,
+                                       Transformation* transformation) {
+  if (node.calculator() != "RectTransformationCalculator" ||
+      node.output_stream_size() != 1 || node.input_side_packet_size() != 0 ||
+      node.output_side_packet_size() != 0) {
+    return false;
+  }
+  *transformation = {};
+  for (const std::string& stream : node.input_stream()) {
+    ASSIGN_OR_RETURN(TagAndName input, ParseStream(stream));
+    if (input.tag == kImageSizeTag) {
+      transformation->image_size = input.name;
+    } else if (IsRectTag(input.tag) && transformation->rects.tag.empty()) {
+      transformation->rects = input;
+    } else {
+      return false;
+    }
+  }
+  if (transformation->rects.tag.empty()) return false;
+  ASSIGN_OR_RETURN(TagAndName output, ParseStream(node.output_stream(0)));
+  transformation->output = output.name;
+  return true;
+}
+
+// Fuses RectTransformationCalculators into the DetectionsToRectsCalculators
+// or AlignmentPointsRectsCalculators that produce their input rects, if the
+// rects have no other use.
+absl::StatusOr<int> FuseRectTransformations(CalculatorGraphConfig* config) {
+  // Streams read by the graph outputs, which must be kept.
+  absl::flat_hash_set<std::string> graph_outputs;
+  for (const std::string& stream : config->output_stream()) {
+    ASSIGN_OR_RETURN(TagAndName graph_stream, ParseStream(stream));
+    graph_outputs.insert(graph_stream.name);
+  }
+
+  int num_removed = 0;
+  for (int i = 0; i < config->node_size();) {
+    Transformation transformation;
+    ASSIGN_OR_RETURN(bool transforms,
+                     GetTransformation(config->node(i), &transformation));
+    const std::string& rects = transformation.rects.name;
+    if (!transforms || graph_outputs.contains(rects)) {
+      ++i;
+      continue;
+    }
+
+    // The producer of the rects, and the index of its output stream.
+    int producer = -1;
+    int producer_output = -1;
+    bool fusable = true;
+    for (int j = 0; j < config->node_size() && fusable; ++j) {
+      const CalculatorGraphConfig::Node& node = config->node(j);
+      for (int k = 0; k < node.output_stream_size(); ++k) {
+        ASSIGN_OR_RETURN(TagAndName output, ParseStream(node.output_stream(k)));
+        if (output.name != rects) continue;
+        producer = j;
+        producer_output = k;
+        fusable = (node.calculator() == "DetectionsToRectsCalculator" ||
+                   node.calculator() == "AlignmentPointsRectsCalculator") &&
+                  output.tag == transformation.rects.tag;
+      }
+      if (j == i) continue;
+      for (const std::string& stream : node.input_stream()) {
+        ASSIGN_OR_RETURN(TagAndName input, ParseStream(stream));
+        fusable &= input.name != rects;
+      }
+    }
+    if (!fusable || producer < 0) {
+      ++i;
+      continue;
+    }
+
+    CalculatorGraphConfig::Node* node = config->mutable_node(producer);
+    tool::MutableOptionsMap options_map;
+    options_map.Initialize(*node);
+    auto options = options_map.Get<DetectionsToRectsCalculatorOptions>();
+    std::string producer_image_size;
+    for (const std::string& stream : node->input_stream()) {
+      ASSIGN_OR_RETURN(TagAndName input, ParseStream(stream));
+      if (input.tag == kImageSizeTag) producer_image_size = input.name;
+    }
+    if (options.has_transformation() ||
+        (!producer_image_size.empty() && !transformation.image_size.empty() &&
+         producer_image_size != transformation.image_size)) {
+      ++i;
+      continue;
+    }
+
+    *options.mutable_transformation() =
+        tool::OptionsMap()
+            .Initialize(config->node(i))
+            .Get<RectTransformationCalculatorOptions>();
+    options_map.Set(options);
+    *node->mutable_output_stream(producer_output) =
+        absl::StrCat(transformation.rects.tag, ":", transformation.output);
+    if (producer_image_size.empty() && !transformation.image_size.empty()) {
+      node->add_input_stream(
+          absl::StrCat(kImageSizeTag, ":", transformation.image_size));
+    }
+    config->mutable_node()->DeleteSubrange(i, 1);
+    ++num_removed;
+  }
+  return num_removed;
+}
+
+}  // namespace
+
+REGISTER_MEDIAPIPE_NODE_FUSION(DetectionsToRectsTransformationFusion,
+                               FuseRectTransformations);
+
+}  // namespace mediapipe
@@ -0,0 +1,126 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/util/detections_to_rects_calculator.pb.h"
+#include "mediapipe/calculators/util/rect_transformation_calculator.pb.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/graph_optimization.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(DetectionsToRectsFusionTest, FoldsTransformationsIntoDetectionsToRects) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "detections"
+        input_stream: "image_size"
+        output_stream: "roi"
+        node {
+          calculator: "DetectionsToRectsCalculator"
+          input_stream: "DETECTIONS:detections"
+          output_stream: "NORM_RECT:rect"
+          options {
+            [mediapipe.DetectionsToRectsCalculatorOptions.ext] {
+              output_zero_rect_for_empty_detections: true
+            }
+          }
+        }
+        node {
+          calculator: "RectTransformationCalculator"
+          input_stream: "NORM_RECT:rect"
+          input_stream: "IMAGE_SIZE:image_size"
+          output_stream: "roi"
+          options {
+            [mediapipe.RectTransformationCalculatorOptions.ext] {
+              scale_x: 1.5
+              scale_y: 1.5
+              square_long: true
+            }
+          }
+        }
+      )pb");
+  CalculatorGraphConfig expected_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "detections"
+        input_stream: "image_size"
+        output_stream: "roi"
+        node {
+          calculator: "DetectionsToRectsCalculator"
+          input_stream: "DETECTIONS:detections"
+          input_stream: "IMAGE_SIZE:image_size"
+          output_stream: "NORM_RECT:roi"
+          options {
+            [mediapipe.DetectionsToRectsCalculatorOptions.ext] {
+              output_zero_rect_for_empty_detections: true
+              transformation { scale_x: 1.5 scale_y: 1.5 square_long: true }
+            }
+          }
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(int num_removed, tool::ApplyNodeFusions(&config));
+  EXPECT_EQ(num_removed, 1);
+  EXPECT_THAT(config, EqualsProto(expected_config));
+}
+
+TEST(DetectionsToRectsFusionTest, KeepsTransformationsOfSharedRects) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "detections"
+        input_stream: "image_size"
+        input_stream: "other_image_size"
+        output_stream: "roi"
+        output_stream: "other_roi"
+        output_stream: "rects"
+        node {
+          calculator: "DetectionsToRectsCalculator"
+          input_stream: "DETECTIONS:detections"
+          input_stream: "IMAGE_SIZE:image_size"
+          output_stream: "NORM_RECT:rect"
+        }
+        node {
+          calculator: "RectTransformationCalculator"
+          input_stream: "NORM_RECT:rect"
+          input_stream: "IMAGE_SIZE:image_size"
+          output_stream: "roi"
+        }
+        node {
+          calculator: "RectTransformationCalculator"
+          input_stream: "NORM_RECT:rect"
+          input_stream: "IMAGE_SIZE:other_image_size"
+          output_stream: "other_roi"
+        }
+        node {
+          calculator: "DetectionsToRectsCalculator"
+          input_stream: "DETECTIONS:detections"
+          output_stream: "NORM_RECTS:rects"
+        }
+        node {
+          calculator: "RectTransformationCalculator"
+          input_stream: "NORM_RECTS:rects"
+          input_stream: "IMAGE_SIZE:image_size"
+          output_stream: "rois"
+        }
+      )pb");
+  const CalculatorGraphConfig original_config = config;
+  MP_ASSERT_OK_AND_ASSIGN(int num_removed, tool::ApplyNodeFusions(&config));
+  EXPECT_EQ(num_removed, 0);
+  EXPECT_THAT(config, EqualsProto(original_config));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -22,6 +22,7 @@
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/render_commands.h"
 #include "mediapipe/util/render_data.pb.h"
 namespace mediapipe {
 
@@ -31,6 +32,7 @@ constexpr char kDetectionTag[] = "DETECTION";
 constexpr char kDetectionsTag[] = "DETECTIONS";
 constexpr char kDetectionListTag[] = "DETECTION_LIST";
 constexpr char kRenderDataTag[] = "RENDER_DATA";
+constexpr char kRenderCommandsTag[] = "RENDER_COMMANDS";
 
 constexpr char kSceneLabelLabel[] = "LABEL";
 constexpr char kSceneFeatureLabel[] = "FEATURE";
@@ -60,6 +62,9 @@ constexpr float kNumScoreDecimalDigitsMultipler = 100;
 // corner of the bounding box. The text for "feature_tag" will be shown on
 // bottom left corner of the bounding box.
 //
+// The annotations are output as RenderData on RENDER_DATA, and/or as
+// RenderCommands on RENDER_COMMANDS, without the scene tags.
+//
 // Example config:
 // node {
 //   calculator: "DetectionsToRenderDataCalculator"
@@ -104,21 +109,56 @@ class DetectionsToRenderDataCalculator : public CalculatorBase {
                                 double width, double height,
                                 RenderAnnotation::Rectangle* rect);
 
+  static RenderCommands::Style CommandStyle(
+      const DetectionsToRenderDataCalculatorOptions& options, bool normalized);
+
+  // Adds an annotation to RenderData, or a command to RenderCommands.
+  static void AddText(const char* scene_tag,
+                      const DetectionsToRenderDataCalculatorOptions& options,
+                      const RenderAnnotation::Text& text,
+                      RenderData* render_data);
+  static void AddText(const char* scene_tag,
+                      const DetectionsToRenderDataCalculatorOptions& options,
+                      const RenderAnnotation::Text& text,
+                      RenderCommands* render_commands);
+  static void AddRectangle(
+      const DetectionsToRenderDataCalculatorOptions& options,
+      const RenderAnnotation::Rectangle& rect, RenderData* render_data);
+  static void AddRectangle(
+      const DetectionsToRenderDataCalculatorOptions& options,
+      const RenderAnnotation::Rectangle& rect,
+      RenderCommands* render_commands);
+  static void AddKeypoint(
+      const DetectionsToRenderDataCalculatorOptions& options, float x, float y,
+      RenderData* render_data);
+  static void AddKeypoint(
+      const DetectionsToRenderDataCalculatorOptions& options, float x, float y,
+      RenderCommands* render_commands);
+
+  template <class OutputType>
   static void AddLabels(const Detection& detection,
                         const DetectionsToRenderDataCalculatorOptions& options,
-                        float text_line_height, RenderData* render_data);
+                        float text_line_height, OutputType* output);
+  template <class OutputType>
   static void AddFeatureTag(
       const Detection& detection,
       const DetectionsToRenderDataCalculatorOptions& options,
-      float text_line_height, RenderData* render_data);
+      float text_line_height, OutputType* output);
+  template <class OutputType>
   static void AddLocationData(
       const Detection& detection,
       const DetectionsToRenderDataCalculatorOptions& options,
-      RenderData* render_data);
+      OutputType* output);
+  template <class OutputType>
   static void AddDetectionToRenderData(
       const Detection& detection,
       const DetectionsToRenderDataCalculatorOptions& options,
-      RenderData* render_data);
+      OutputType* output);
+  template <class OutputType>
+  static void AddInputDetections(
+      CalculatorContext* cc,
+      const DetectionsToRenderDataCalculatorOptions& options,
+      OutputType* output);
 };
 REGISTER_CALCULATOR(DetectionsToRenderDataCalculator);
 
@@ -138,7 +178,15 @@ absl::Status DetectionsToRenderDataCalculator::GetContract(
   if (cc->Inputs().HasTag(kDetectionsTag)) {
     cc->Inputs().Tag(kDetectionsTag).Set<std::vector<Detection>>();
   }
-  cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  RET_CHECK(cc->Outputs().HasTag(kRenderDataTag) ||
+            cc->Outputs().HasTag(kRenderCommandsTag))
+      << "At least one of RENDER_DATA and RENDER_COMMANDS must be output.";
+  if (cc->Outputs().HasTag(kRenderDataTag)) {
+    cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  }
+  if (cc->Outputs().HasTag(kRenderCommandsTag)) {
+    cc->Outputs().Tag(kRenderCommandsTag).Set<RenderCommands>();
+  }
   return absl::OkStatus();
 }
 
@@ -168,28 +216,49 @@ absl::Status DetectionsToRenderDataCalculator::Process(CalculatorContext* cc) {
 
   // TODO: Add score threshold to
   // DetectionsToRenderDataCalculatorOptions.
-  auto render_data = absl::make_unique<RenderData>();
-  render_data->set_scene_class(options.scene_class());
-  if (has_detection_from_list) {
+  if (cc->Outputs().HasTag(kRenderDataTag)) {
+    auto render_data = absl::make_unique<RenderData>();
+    render_data->set_scene_class(options.scene_class());
+    AddInputDetections(cc, options, render_data.get());
+    cc->Outputs()
+        .Tag(kRenderDataTag)
+        .Add(render_data.release(), cc->InputTimestamp());
+  }
+  if (cc->Outputs().HasTag(kRenderCommandsTag)) {
+    auto render_commands = absl::make_unique<RenderCommands>();
+    render_commands->set_scene_class(options.scene_class());
+    AddInputDetections(cc, options, render_commands.get());
+    cc->Outputs()
+        .Tag(kRenderCommandsTag)
+        .Add(render_commands.release(), cc->InputTimestamp());
+  }
+  return absl::OkStatus();
+}
+
+template <class OutputType>
+void DetectionsToRenderDataCalculator::AddInputDetections(
+    CalculatorContext* cc,
+    const DetectionsToRenderDataCalculatorOptions& options,
+    OutputType* output) {
+  if (cc->Inputs().HasTag(kDetectionListTag) &&
+      !cc->Inputs().Tag(kDetectionListTag).IsEmpty()) {
     for (const auto& detection :
          cc->Inputs().Tag(kDetectionListTag).Get<DetectionList>().detection()) {
-      AddDetectionToRenderData(detection, options, render_data.get());
+      AddDetectionToRenderData(detection, options, output);
     }
   }
-  if (has_detection_from_vector) {
+  if (cc->Inputs().HasTag(kDetectionsTag) &&
+      !cc->Inputs().Tag(kDetectionsTag).IsEmpty()) {
     for (const auto& detection :
          cc->Inputs().Tag(kDetectionsTag).Get<std::vector<Detection>>()) {
-      AddDetectionToRenderData(detection, options, render_data.get());
+      AddDetectionToRenderData(detection, options, output);
     }
   }
-  if (has_single_detection) {
+  if (cc->Inputs().HasTag(kDetectionTag) &&
+      !cc->Inputs().Tag(kDetectionTag).IsEmpty()) {
     AddDetectionToRenderData(cc->Inputs().Tag(kDetectionTag).Get<Detection>(),
-                             options, render_data.get());
+                             options, output);
   }
-  cc->Outputs()
-      .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
-  return absl::OkStatus();
 }
 
 void DetectionsToRenderDataCalculator::SetRenderAnnotationColorThickness(
@@ -229,10 +298,77 @@ void DetectionsToRenderDataCalculator::SetRectCoordinate(
   rect->set_bottom(normalized ? std::min(ymin + height, 1.0) : ymin + height);
 }
 
+RenderCommands::Style DetectionsToRenderDataCalculator::CommandStyle(
+    const DetectionsToRenderDataCalculatorOptions& options, bool normalized) {
+  RenderCommands::Style style;
+  style.color = ToRgb(options.color());
+  style.thickness = options.thickness();
+  style.normalized = normalized;
+  return style;
+}
+
+void DetectionsToRenderDataCalculator::AddText(
+    const char* scene_tag,
+    const DetectionsToRenderDataCalculatorOptions& options,
+    const RenderAnnotation::Text& text, RenderData* render_data) {
+  auto* text_annotation = render_data->add_render_annotations();
+  text_annotation->set_scene_tag(scene_tag);
+  SetRenderAnnotationColorThickness(options, text_annotation);
+  *text_annotation->mutable_text() = text;
+}
+
+void DetectionsToRenderDataCalculator::AddText(
+    const char* scene_tag,
+    const DetectionsToRenderDataCalculatorOptions& options,
+    const RenderAnnotation::Text& text, RenderCommands* render_commands) {
+  render_commands->SetStyle(CommandStyle(options, text.normalized()));
+  render_commands->AddText(ToRenderCommandsText(text), text.left(),
+                           text.baseline());
+}
+
+void DetectionsToRenderDataCalculator::AddRectangle(
+    const DetectionsToRenderDataCalculatorOptions& options,
+    const RenderAnnotation::Rectangle& rect, RenderData* render_data) {
+  auto* location_data_annotation = render_data->add_render_annotations();
+  location_data_annotation->set_scene_tag(kSceneLocationLabel);
+  SetRenderAnnotationColorThickness(options, location_data_annotation);
+  *location_data_annotation->mutable_rectangle() = rect;
+}
+
+void DetectionsToRenderDataCalculator::AddRectangle(
+    const DetectionsToRenderDataCalculatorOptions& options,
+    const RenderAnnotation::Rectangle& rect, RenderCommands* render_commands) {
+  // SetRectCoordinate leaves the rectangles outside of the image unset.
+  if (!rect.has_left()) return;
+  render_commands->SetStyle(CommandStyle(options, rect.normalized()));
+  render_commands->AddRectangle(rect.left(), rect.top(), rect.right(),
+                                rect.bottom());
+}
+
+void DetectionsToRenderDataCalculator::AddKeypoint(
+    const DetectionsToRenderDataCalculatorOptions& options, float x, float y,
+    RenderData* render_data) {
+  auto* keypoint_data_annotation = render_data->add_render_annotations();
+  keypoint_data_annotation->set_scene_tag(kKeypointLabel);
+  SetRenderAnnotationColorThickness(options, keypoint_data_annotation);
+  auto* keypoint_data = keypoint_data_annotation->mutable_point();
+  keypoint_data->set_normalized(true);
+  keypoint_data->set_x(x);
+  keypoint_data->set_y(y);
+}
+
+void DetectionsToRenderDataCalculator::AddKeypoint(
+    const DetectionsToRenderDataCalculatorOptions& options, float x, float y,
+    RenderCommands* render_commands) {
+  render_commands->SetStyle(CommandStyle(options, /*normalized=*/true));
+  render_commands->AddPoint(x, y);
+}
+
+template <class OutputType>
 void DetectionsToRenderDataCalculator::AddLabels(
     const Detection& detection,
     const DetectionsToRenderDataCalculatorOptions& options,
-    float text_line_height, RenderData* render_data) {
+    float text_line_height, OutputType* output) {
   CHECK(detection.label().empty() || detection.label_id().empty() ||
         detection.label_size() == detection.label_id_size())
       << "String or integer labels should be of same size. Or only one of them "
@@ -269,98 +405,85 @@ void DetectionsToRenderDataCalculator::AddLabels(
     labels.push_back(absl::StrJoin(label_and_scores, ""));
   }
   // Add the render annotations for "label(_id),score".
+  RenderAnnotation::Text text;
   for (int i = 0; i < labels.size(); ++i) {
-    auto label = labels.at(i);
-    auto* label_annotation = render_data->add_render_annotations();
-    label_annotation->set_scene_tag(kSceneLabelLabel);
-    SetRenderAnnotationColorThickness(options, label_annotation);
-    auto* text = label_annotation->mutable_text();
-    *text = options.text();
-    text->set_display_text(label);
+    text = options.text();
+    text.set_display_text(labels.at(i));
     if (detection.location_data().format() == LocationData::BOUNDING_BOX) {
       SetTextCoordinate(false, detection.location_data().bounding_box().xmin(),
                         detection.location_data().bounding_box().ymin() +
                             (i + 1) * text_line_height,
-                        text);
+                        &text);
     } else {
-      text->set_font_height(text_line_height * 0.9);
+      text.set_font_height(text_line_height * 0.9);
       SetTextCoordinate(
           true, detection.location_data().relative_bounding_box().xmin(),
           detection.location_data().relative_bounding_box().ymin() +
               (i + 1) * text_line_height,
-          text);
+          &text);
     }
+    AddText(kSceneLabelLabel, options, text, output);
   }
 }
 
+template <class OutputType>
 void DetectionsToRenderDataCalculator::AddFeatureTag(
     const Detection& detection,
     const DetectionsToRenderDataCalculatorOptions& options,
-    float text_line_height, RenderData* render_data) {
-  auto* feature_tag_annotation = render_data->add_render_annotations();
-  feature_tag_annotation->set_scene_tag(kSceneFeatureLabel);
-  SetRenderAnnotationColorThickness(options, feature_tag_annotation);
-  auto* feature_tag_text = feature_tag_annotation->mutable_text();
-  feature_tag_text->set_display_text(detection.feature_tag());
+    float text_line_height, OutputType* output) {
+  RenderAnnotation::Text feature_tag_text;
+  feature_tag_text.set_display_text(detection.feature_tag());
   if (detection.location_data().format() == LocationData::BOUNDING_BOX) {
     SetTextCoordinate(false, detection.location_data().bounding_box().xmin(),
                       detection.location_data().bounding_box().ymin() +
                           detection.location_data().bounding_box().height(),
-                      feature_tag_text);
+                      &feature_tag_text);
   } else {
-    feature_tag_text->set_font_height(text_line_height * 0.9);
+    feature_tag_text.set_font_height(text_line_height * 0.9);
     SetTextCoordinate(
         true, detection.location_data().relative_bounding_box().xmin(),
         detection.location_data().relative_bounding_box().ymin() +
             detection.location_data().relative_bounding_box().height(),
-        feature_tag_text);
+        &feature_tag_text);
   }
+  AddText(kSceneFeatureLabel, options, feature_tag_text, output);
 }
 
+template <class OutputType>
 void DetectionsToRenderDataCalculator::AddLocationData(
     const Detection& detection,
     const DetectionsToRenderDataCalculatorOptions& options,
-    RenderData* render_data) {
-  auto* location_data_annotation = render_data->add_render_annotations();
-  location_data_annotation->set_scene_tag(kSceneLocationLabel);
-  SetRenderAnnotationColorThickness(options, location_data_annotation);
-  auto* location_data_rect = location_data_annotation->mutable_rectangle();
+    OutputType* output) {
+  RenderAnnotation::Rectangle location_data_rect;
   if (detection.location_data().format() == LocationData::BOUNDING_BOX) {
     SetRectCoordinate(false, detection.location_data().bounding_box().xmin(),
                       detection.location_data().bounding_box().ymin(),
                       detection.location_data().bounding_box().width(),
                       detection.location_data().bounding_box().height(),
-                      location_data_rect);
+                      &location_data_rect);
+    AddRectangle(options, location_data_rect, output);
   } else {
     SetRectCoordinate(
         true, detection.location_data().relative_bounding_box().xmin(),
         detection.location_data().relative_bounding_box().ymin(),
         detection.location_data().relative_bounding_box().width(),
         detection.location_data().relative_bounding_box().height(),
-        location_data_rect);
+        &location_data_rect);
+    AddRectangle(options, location_data_rect, output);
     // Keypoints are only supported in normalized/relative coordinates.
-    if (detection.location_data().relative_keypoints_size()) {
-      for (int i = 0; i < detection.location_data().relative_keypoints_size();
-           ++i) {
-        auto* keypoint_data_annotation = render_data->add_render_annotations();
-        keypoint_data_annotation->set_scene_tag(kKeypointLabel);
-        SetRenderAnnotationColorThickness(options, keypoint_data_annotation);
-        auto* keypoint_data = keypoint_data_annotation->mutable_point();
-        keypoint_data->set_normalized(true);
-        // See location_data.proto for detail.
-        keypoint_data->set_x(
-            detection.location_data().relative_keypoints(i).x());
-        keypoint_data->set_y(
-            detection.location_data().relative_keypoints(i).y());
-      }
+    for (const auto& keypoint :
+         detection.location_data().relative_keypoints()) {
+      // See location_data.proto for detail.
+      AddKeypoint(options, keypoint.x(), keypoint.y(), output);
     }
   }
 }
 
+template <class OutputType>
 void DetectionsToRenderDataCalculator::AddDetectionToRenderData(
     const Detection& detection,
     const DetectionsToRenderDataCalculatorOptions& options,
-    RenderData* render_data) {
+    OutputType* output) {
   CHECK(detection.location_data().format() == LocationData::BOUNDING_BOX ||
         detection.location_data().format() ==
             LocationData::RELATIVE_BOUNDING_BOX)
@@ -379,8 +502,8 @@ void DetectionsToRenderDataCalculator::AddDetectionToRenderData(
                                        detection.label_id_size()) +
                               1 /* for feature_tag */));
   }
-  AddLabels(detection, options, text_line_height, render_data);
-  AddFeatureTag(detection, options, text_line_height, render_data);
-  AddLocationData(detection, options, render_data);
+  AddLabels(detection, options, text_line_height, output);
+  AddFeatureTag(detection, options, text_line_height, output);
+  AddLocationData(detection, options, output);
 }
 }  // namespace mediapipe
@@ -25,12 +25,14 @@
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"
 #include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/render_commands.h"
 #include "mediapipe/util/render_data.pb.h"
 
 namespace mediapipe {
 
 constexpr char kDetectionsTag[] = "DETECTIONS";
 constexpr char kRenderDataTag[] = "RENDER_DATA";
+constexpr char kRenderCommandsTag[] = "RENDER_COMMANDS";
 constexpr char kDetectionListTag[] = "DETECTION_LIST";
 
 // Error tolerance for pixels, distances, etc.
@@ -153,6 +155,65 @@ TEST(DetectionsToRenderDataCalculatorTest, OnlyDetecctionVector) {
   EXPECT_EQ(actual.render_annotations(2).rectangle().bottom(), 200 + 400);
 }
 
+TEST(DetectionsToRenderDataCalculatorTest, OutputsRenderCommands) {
+  CalculatorRunner runner{ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "DetectionsToRenderDataCalculator"
+    input_stream: "DETECTIONS:detections"
+    output_stream: "RENDER_DATA:render_data"
+    output_stream: "RENDER_COMMANDS:render_commands"
+    options {
+      [mediapipe.DetectionsToRenderDataCalculatorOptions.ext] {
+        color { r: 255 g: 0 b: 0 }
+        thickness: 2.0
+      }
+    }
+  )pb")};
+
+  LocationData location_data = CreateRelativeLocationData(0.1, 0.2, 0.3, 0.4);
+  auto* keypoint = location_data.add_relative_keypoints();
+  keypoint->set_x(0.25);
+  keypoint->set_y(0.5);
+  auto detections(absl::make_unique<std::vector<Detection>>());
+  detections->push_back(
+      CreateDetection({"label1"}, {}, {0.3}, location_data, "feature_tag"));
+
+  runner.MutableInputs()
+      ->Tag(kDetectionsTag)
+      .packets.push_back(
+          Adopt(detections.release()).At(Timestamp::PostStream()));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const std::vector<Packet>& output =
+      runner.Outputs().Tag(kRenderCommandsTag).packets;
+  ASSERT_EQ(1, output.size());
+  const auto& commands = output[0].Get<RenderCommands>();
+  ASSERT_EQ(commands.size(), 4);
+  EXPECT_EQ(commands.styles().size(), 1);
+  EXPECT_EQ(commands.styles()[0].color.r, 255);
+  EXPECT_EQ(commands.styles()[0].thickness, 2.0);
+  EXPECT_TRUE(commands.styles()[0].normalized);
+
+  // The commands draw the same as the render data, without the scene tags.
+  RenderData render_data =
+      runner.Outputs().Tag(kRenderDataTag).packets[0].Get<RenderData>();
+  for (auto& annotation : *render_data.mutable_render_annotations()) {
+    annotation.clear_scene_tag();
+  }
+  RenderData commands_render_data;
+  AppendToRenderData(commands, &commands_render_data);
+  ASSERT_EQ(commands_render_data.render_annotations_size(), 4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(commands_render_data.render_annotations(i).data_case(),
+              render_data.render_annotations(i).data_case());
+  }
+  EXPECT_EQ(commands_render_data.render_annotations(0).text().display_text(),
+            "label1,0.3,");
+  EXPECT_NEAR(commands_render_data.render_annotations(2).rectangle().right(),
+              0.4, kErrorTolerance);
+  EXPECT_NEAR(commands_render_data.render_annotations(3).point().x(), 0.25,
+              kErrorTolerance);
+}
+
 TEST(DetectionsToRenderDataCalculatorTest, BothDetecctionListAndVector) {
   CalculatorRunner runner{ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
     calculator: "DetectionsToRenderDataCalculator"
@@ -17,6 +17,7 @@
 
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
@@ -35,16 +36,16 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 // corresponding input image before letterboxing.
 //
 // Input:
-//   LANDMARKS: A NormalizedLandmarkList representing landmarks on an
-//   letterboxed image.
+//   LANDMARKS: A NormalizedLandmarkList or PackedNormalizedLandmarks
+//   representing landmarks on an letterboxed image.
 //
 //   LETTERBOX_PADDING: An std::array<float, 4> representing the letterbox
 //   padding from the 4 sides ([left, top, right, bottom]) of the letterboxed
 //   image, normalized to [0.f, 1.f] by the letterboxed image dimensions.
 //
 // Output:
-//   LANDMARKS: An NormalizedLandmarkList proto representing landmarks with
-//   their locations adjusted to the letterbox-removed (non-padded) image.
+//   LANDMARKS: Landmarks of the same type as the input with their locations
+//   adjusted to the letterbox-removed (non-padded) image.
 //
 // Usage example:
 // node {
@@ -75,13 +76,17 @@ class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
 
     for (CollectionItemId id = cc->Inputs().BeginId(kLandmarksTag);
          id != cc->Inputs().EndId(kLandmarksTag); ++id) {
-      cc->Inputs().Get(id).Set<NormalizedLandmarkList>();
+      cc->Inputs()
+          .Get(id)
+          .SetOneOf<NormalizedLandmarkList, PackedNormalizedLandmarks>();
     }
     cc->Inputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
 
     for (CollectionItemId id = cc->Outputs().BeginId(kLandmarksTag);
          id != cc->Outputs().EndId(kLandmarksTag); ++id) {
-      cc->Outputs().Get(id).Set<NormalizedLandmarkList>();
+      cc->Outputs()
+          .Get(id)
+          .SetOneOf<NormalizedLandmarkList, PackedNormalizedLandmarks>();
     }
 
     return absl::OkStatus();
@@ -114,6 +119,23 @@ class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
         continue;
       }
 
+      if (input_packet.ValidateAsType<PackedNormalizedLandmarks>().ok()) {
+        PackedNormalizedLandmarks output_landmarks =
+            input_packet.Get<PackedNormalizedLandmarks>();
+        float* xs = output_landmarks.x.data();
+        float* ys = output_landmarks.y.data();
+        float* zs = output_landmarks.z.data();
+        for (int i = 0; i < output_landmarks.size(); ++i) {
+          xs[i] = (xs[i] - left) / (1.0f - left_and_right);
+          ys[i] = (ys[i] - top) / (1.0f - top_and_bottom);
+          zs[i] = zs[i] / (1.0f - left_and_right);  // Scale Z coordinate as X.
+        }
+        cc->Outputs().Get(output_id).AddPacket(
+            MakePacket<PackedNormalizedLandmarks>(std::move(output_landmarks))
+                .At(cc->InputTimestamp()));
+        continue;
+      }
+
       const NormalizedLandmarkList& input_landmarks =
           input_packet.Get<NormalizedLandmarkList>();
       NormalizedLandmarkList output_landmarks;
@@ -19,6 +19,7 @@
 #include "mediapipe/calculators/util/landmark_projection_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -34,7 +35,7 @@ constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 
 // Projects normalized landmarks to its original coordinates.
 // Input:
-//   NORM_LANDMARKS - NormalizedLandmarkList
+//   NORM_LANDMARKS - NormalizedLandmarkList or PackedNormalizedLandmarks
 //     Represents landmarks in a normalized rectangle if NORM_RECT is specified
 //     or landmarks that should be projected using PROJECTION_MATRIX if
 //     specified. (Prefer using PROJECTION_MATRIX as it eliminates need of
@@ -52,8 +53,9 @@ constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 //     the normalized region of interest used during landmarks detection.
 //
 // Output:
-//   NORM_LANDMARKS - NormalizedLandmarkList
-//     Landmarks with their locations adjusted according to the inputs.
+//   NORM_LANDMARKS - NormalizedLandmarkList or PackedNormalizedLandmarks
+//     Landmarks with their locations adjusted according to the inputs, of the
+//     same type as the input landmarks.
 //
 // Usage example:
 // node {
@@ -99,7 +101,9 @@ class LandmarkProjectionCalculator : public CalculatorBase {
 
     for (CollectionItemId id = cc->Inputs().BeginId(kLandmarksTag);
          id != cc->Inputs().EndId(kLandmarksTag); ++id) {
-      cc->Inputs().Get(id).Set<NormalizedLandmarkList>();
+      cc->Inputs()
+          .Get(id)
+          .SetOneOf<NormalizedLandmarkList, PackedNormalizedLandmarks>();
     }
     RET_CHECK(cc->Inputs().HasTag(kRectTag) ^
               cc->Inputs().HasTag(kProjectionMatrix))
@@ -112,7 +116,9 @@ class LandmarkProjectionCalculator : public CalculatorBase {
 
     for (CollectionItemId id = cc->Outputs().BeginId(kLandmarksTag);
          id != cc->Outputs().EndId(kLandmarksTag); ++id) {
-      cc->Outputs().Get(id).Set<NormalizedLandmarkList>();
+      cc->Outputs()
+          .Get(id)
+          .SetOneOf<NormalizedLandmarkList, PackedNormalizedLandmarks>();
     }
 
     return absl::OkStatus();
@@ -157,6 +163,8 @@ class LandmarkProjectionCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) override {
     std::function<void(const NormalizedLandmark&, NormalizedLandmark*)>
         project_fn;
+    // Same projection, for all packed landmarks at once.
+    std::function<void(PackedNormalizedLandmarks*)> project_packed_fn;
     if (cc->Inputs().HasTag(kRectTag)) {
       if (cc->Inputs().Tag(kRectTag).IsEmpty()) {
         return absl::OkStatus();
@@ -185,6 +193,27 @@ class LandmarkProjectionCalculator : public CalculatorBase {
         new_landmark->set_y(new_y);
         new_landmark->set_z(new_z);
       };
+      project_packed_fn = [&input_rect,
+                           &options](PackedNormalizedLandmarks* landmarks) {
+        const float angle =
+            options.ignore_rotation() ? 0 : input_rect.rotation();
+        const float cos_angle = std::cos(angle);
+        const float sin_angle = std::sin(angle);
+        const float width = input_rect.width();
+        const float height = input_rect.height();
+        const float x_center = input_rect.x_center();
+        const float y_center = input_rect.y_center();
+        float* xs = landmarks->x.data();
+        float* ys = landmarks->y.data();
+        float* zs = landmarks->z.data();
+        for (int i = 0; i < landmarks->size(); ++i) {
+          const float x = xs[i] - 0.5f;
+          const float y = ys[i] - 0.5f;
+          xs[i] = (cos_angle * x - sin_angle * y) * width + x_center;
+          ys[i] = (sin_angle * x + cos_angle * y) * height + y_center;
+          zs[i] *= width;  // Scale Z coordinate as X.
+        }
+      };
     } else if (cc->Inputs().HasTag(kProjectionMatrix)) {
       if (cc->Inputs().Tag(kProjectionMatrix).IsEmpty()) {
         return absl::OkStatus();
@@ -198,6 +227,21 @@ class LandmarkProjectionCalculator : public CalculatorBase {
         ProjectXY(lm, project_mat, new_landmark);
         new_landmark->set_z(z_scale * lm.z());
       };
+      project_packed_fn = [&project_mat,
+                           z_scale](PackedNormalizedLandmarks* landmarks) {
+        const std::array<float, 16>& m = project_mat;
+        float* xs = landmarks->x.data();
+        float* ys = landmarks->y.data();
+        float* zs = landmarks->z.data();
+        for (int i = 0; i < landmarks->size(); ++i) {
+          const float x = xs[i];
+          const float y = ys[i];
+          const float z = zs[i];
+          xs[i] = x * m[0] + y * m[1] + z * m[2] + m[3];
+          ys[i] = x * m[4] + y * m[5] + z * m[6] + m[7];
+          zs[i] = z_scale * z;
+        }
+      };
     } else {
       return absl::InternalError("Either rect or matrix must be specified.");
     }
@@ -212,6 +256,16 @@ class LandmarkProjectionCalculator : public CalculatorBase {
         continue;
       }
 
+      if (input_packet.ValidateAsType<PackedNormalizedLandmarks>().ok()) {
+        PackedNormalizedLandmarks output_landmarks =
+            input_packet.Get<PackedNormalizedLandmarks>();
+        project_packed_fn(&output_landmarks);
+        cc->Outputs().Get(output_id).AddPacket(
+            MakePacket<PackedNormalizedLandmarks>(std::move(output_landmarks))
+                .At(cc->InputTimestamp()));
+        continue;
+      }
+
       const auto& input_landmarks = input_packet.Get<NormalizedLandmarkList>();
       NormalizedLandmarkList output_landmarks;
       for (int i = 0; i < input_landmarks.landmark_size(); ++i) {
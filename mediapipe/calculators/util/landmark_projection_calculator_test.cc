@@ -7,6 +7,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -98,6 +99,34 @@ TEST(LandmarkProjectionCalculatorTest, ProjectingWithCroppedRect) {
               EqualsProto(GetCroppedRectTestExpectedResult()));
 }
 
+TEST(LandmarkProjectionCalculatorTest, ProjectingPackedLandmarks) {
+  mediapipe::CalculatorRunner runner(
+      ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(R"pb(
+        calculator: "LandmarkProjectionCalculator"
+        input_stream: "NORM_LANDMARKS:landmarks"
+        input_stream: "NORM_RECT:rect"
+        output_stream: "NORM_LANDMARKS:projected_landmarks"
+      )pb"));
+  runner.MutableInputs()
+      ->Tag(kNormLandmarksTag)
+      .packets.push_back(MakePacket<PackedNormalizedLandmarks>(
+                             PackLandmarks(GetCroppedRectTestInput()))
+                             .At(Timestamp(1)));
+  runner.MutableInputs()
+      ->Tag(kNormRectTag)
+      .packets.push_back(
+          MakePacket<mediapipe::NormalizedRect>(GetCroppedRect())
+              .At(Timestamp(1)));
+
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets = runner.Outputs().Tag(kNormLandmarksTag).packets;
+  ASSERT_EQ(output_packets.size(), 1);
+  EXPECT_THAT(
+      UnpackLandmarks(output_packets[0].Get<PackedNormalizedLandmarks>()),
+      EqualsProto(GetCroppedRectTestExpectedResult()));
+}
+
 absl::StatusOr<mediapipe::NormalizedLandmarkList> RunCalculator(
     mediapipe::NormalizedLandmarkList input, std::array<float, 16> matrix) {
   mediapipe::CalculatorRunner runner(
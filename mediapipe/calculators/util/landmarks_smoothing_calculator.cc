@@ -13,16 +13,18 @@
 // limitations under the License.
 
 #include <memory>
+#include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/memory/memory.h"
 #include "mediapipe/calculators/util/landmarks_smoothing_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/timestamp.h"
-#include "mediapipe/util/filtering/one_euro_filter.h"
-#include "mediapipe/util/filtering/relative_velocity_filter.h"
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+#include "mediapipe/util/filtering/relative_velocity_filter_bank.h"
 
 namespace mediapipe {
 
@@ -35,8 +37,8 @@ constexpr char kObjectScaleRoiTag[] = "OBJECT_SCALE_ROI";
 constexpr char kNormalizedFilteredLandmarksTag[] = "NORM_FILTERED_LANDMARKS";
 constexpr char kFilteredLandmarksTag[] = "FILTERED_LANDMARKS";
 
-using mediapipe::OneEuroFilter;
-using mediapipe::RelativeVelocityFilter;
+using mediapipe::OneEuroFilterBank;
+using mediapipe::RelativeVelocityFilterBank;
 
 void NormalizedLandmarksToLandmarks(
     const NormalizedLandmarkList& norm_landmarks, const int image_width,
@@ -133,6 +135,42 @@ class NoFilter : public LandmarksFilter {
   }
 };
 
+// Gathers the coordinates of @landmarks into @values as the x coordinates of
+// all landmarks, followed by the y and then the z coordinates, so a filter
+// bank can filter all of them at once.
+void GatherCoordinates(const LandmarkList& landmarks,
+                       std::vector<float>* values) {
+  const int n_landmarks = landmarks.landmark_size();
+  values->resize(3 * n_landmarks);
+  float* x = values->data();
+  float* y = x + n_landmarks;
+  float* z = y + n_landmarks;
+  for (int i = 0; i < n_landmarks; ++i) {
+    const auto& landmark = landmarks.landmark(i);
+    x[i] = landmark.x();
+    y[i] = landmark.y();
+    z[i] = landmark.z();
+  }
+}
+
+// Copies @in_landmarks to @out_landmarks with the coordinates gathered by
+// GatherCoordinates replaced by @values.
+void ScatterCoordinates(const LandmarkList& in_landmarks,
+                        const std::vector<float>& values,
+                        LandmarkList* out_landmarks) {
+  const int n_landmarks = in_landmarks.landmark_size();
+  const float* x = values.data();
+  const float* y = x + n_landmarks;
+  const float* z = y + n_landmarks;
+  for (int i = 0; i < n_landmarks; ++i) {
+    auto* out_landmark = out_landmarks->add_landmark();
+    *out_landmark = in_landmarks.landmark(i);
+    out_landmark->set_x(x[i]);
+    out_landmark->set_y(y[i]);
+    out_landmark->set_z(z[i]);
+  }
+}
+
 // Please check RelativeVelocityFilter documentation for details.
 class VelocityFilter : public LandmarksFilter {
  public:
@@ -144,9 +182,7 @@ class VelocityFilter : public LandmarksFilter {
         disable_value_scaling_(disable_value_scaling) {}
 
   absl::Status Reset() override {
-    x_filters_.clear();
-    y_filters_.clear();
-    z_filters_.clear();
+    filters_.reset();
     return absl::OkStatus();
   }
 
@@ -171,19 +207,11 @@ class VelocityFilter : public LandmarksFilter {
     // Initialize filters once.
     MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.landmark_size()));
 
-    // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
-
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(
-          x_filters_[i].Apply(timestamp, value_scale, in_landmark.x()));
-      out_landmark->set_y(
-          y_filters_[i].Apply(timestamp, value_scale, in_landmark.y()));
-      out_landmark->set_z(
-          z_filters_[i].Apply(timestamp, value_scale, in_landmark.z()));
-    }
+    // Filter landmarks. Every axis of every landmark is filtered separately,
+    // but all of them in one pass over the bank.
+    GatherCoordinates(in_landmarks, &values_);
+    filters_->Apply(timestamp, value_scale, values_.data(), values_.data());
+    ScatterCoordinates(in_landmarks, values_, out_landmarks);
 
     return absl::OkStatus();
   }
@@ -192,19 +220,13 @@ class VelocityFilter : public LandmarksFilter {
   // Initializes filters for the first time or after Reset. If initialized then
   // check the size.
   absl::Status InitializeFiltersIfEmpty(const int n_landmarks) {
-    if (!x_filters_.empty()) {
-      RET_CHECK_EQ(x_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(y_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(z_filters_.size(), n_landmarks);
+    if (filters_ && filters_->size() > 0) {
+      RET_CHECK_EQ(filters_->size(), 3 * n_landmarks);
       return absl::OkStatus();
     }
 
-    x_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
-    y_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
-    z_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
+    filters_ = absl::make_unique<RelativeVelocityFilterBank>(
+        3 * n_landmarks, window_size_, velocity_scale_);
 
     return absl::OkStatus();
   }
@@ -214,9 +236,10 @@ class VelocityFilter : public LandmarksFilter {
   float min_allowed_object_scale_;
   bool disable_value_scaling_;
 
-  std::vector<RelativeVelocityFilter> x_filters_;
-  std::vector<RelativeVelocityFilter> y_filters_;
-  std::vector<RelativeVelocityFilter> z_filters_;
+  // Filters the x, y and z coordinates of all landmarks, see
+  // GatherCoordinates.
+  std::unique_ptr<RelativeVelocityFilterBank> filters_;
+  std::vector<float> values_;
 };
 
 // Please check OneEuroFilter documentation for details.
@@ -233,9 +256,7 @@ class OneEuroFilterImpl : public LandmarksFilter {
         disable_value_scaling_(disable_value_scaling) {}
 
   absl::Status Reset() override {
-    x_filters_.clear();
-    y_filters_.clear();
-    z_filters_.clear();
+    filters_.reset();
     return absl::OkStatus();
   }
 
@@ -260,19 +281,11 @@ class OneEuroFilterImpl : public LandmarksFilter {
       value_scale = 1.0f / object_scale;
     }
 
-    // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
-
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(
-          x_filters_[i].Apply(timestamp, value_scale, in_landmark.x()));
-      out_landmark->set_y(
-          y_filters_[i].Apply(timestamp, value_scale, in_landmark.y()));
-      out_landmark->set_z(
-          z_filters_[i].Apply(timestamp, value_scale, in_landmark.z()));
-    }
+    // Filter landmarks. Every axis of every landmark is filtered separately,
+    // but all of them in one pass over the bank.
+    GatherCoordinates(in_landmarks, &values_);
+    filters_->Apply(timestamp, value_scale, values_.data(), values_.data());
+    ScatterCoordinates(in_landmarks, values_, out_landmarks);
 
     return absl::OkStatus();
   }
@@ -281,21 +294,13 @@ class OneEuroFilterImpl : public LandmarksFilter {
   // Initializes filters for the first time or after Reset. If initialized then
   // check the size.
   absl::Status InitializeFiltersIfEmpty(const int n_landmarks) {
-    if (!x_filters_.empty()) {
-      RET_CHECK_EQ(x_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(y_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(z_filters_.size(), n_landmarks);
+    if (filters_ && filters_->size() > 0) {
+      RET_CHECK_EQ(filters_->size(), 3 * n_landmarks);
       return absl::OkStatus();
     }
 
-    for (int i = 0; i < n_landmarks; ++i) {
-      x_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      y_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      z_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-    }
+    filters_ = absl::make_unique<OneEuroFilterBank>(
+        3 * n_landmarks, frequency_, min_cutoff_, beta_, derivate_cutoff_);
 
     return absl::OkStatus();
   }
@@ -307,9 +312,10 @@ class OneEuroFilterImpl : public LandmarksFilter {
   double min_allowed_object_scale_;
   bool disable_value_scaling_;
 
-  std::vector<OneEuroFilter> x_filters_;
-  std::vector<OneEuroFilter> y_filters_;
-  std::vector<OneEuroFilter> z_filters_;
+  // Filters the x, y and z coordinates of all landmarks, see
+  // GatherCoordinates.
+  std::unique_ptr<OneEuroFilterBank> filters_;
+  std::vector<float> values_;
 };
 
 }  // namespace
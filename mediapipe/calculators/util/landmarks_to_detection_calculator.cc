@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <memory>
+#include <vector>
 
 #include "mediapipe/calculators/util/landmarks_to_detection_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -20,6 +21,7 @@
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/util/rect_batch.h"
 
 namespace mediapipe {
 
@@ -32,21 +34,20 @@ Detection ConvertLandmarksToDetection(const NormalizedLandmarkList& landmarks) {
   Detection detection;
   LocationData* location_data = detection.mutable_location_data();
 
-  float x_min = std::numeric_limits<float>::max();
-  float x_max = std::numeric_limits<float>::min();
-  float y_min = std::numeric_limits<float>::max();
-  float y_max = std::numeric_limits<float>::min();
+  std::vector<float> x(landmarks.landmark_size());
+  std::vector<float> y(landmarks.landmark_size());
   for (int i = 0; i < landmarks.landmark_size(); ++i) {
     const NormalizedLandmark& landmark = landmarks.landmark(i);
-    x_min = std::min(x_min, landmark.x());
-    x_max = std::max(x_max, landmark.x());
-    y_min = std::min(y_min, landmark.y());
-    y_max = std::max(y_max, landmark.y());
+    x[i] = landmark.x();
+    y[i] = landmark.y();
 
     auto keypoint = location_data->add_relative_keypoints();
     keypoint->set_x(landmark.x());
     keypoint->set_y(landmark.y());
   }
+  float x_min, y_min, x_max, y_max;
+  ComputePointBounds(x.data(), y.data(), x.size(), /*num_sets=*/1, &x_min,
+                     &y_min, &x_max, &y_max);
 
   location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
   LocationData::RelativeBoundingBox* relative_bbox =
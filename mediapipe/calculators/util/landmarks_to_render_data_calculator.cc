@@ -23,6 +23,7 @@
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/render_commands.h"
 #include "mediapipe/util/render_data.pb.h"
 namespace mediapipe {
 
@@ -32,6 +33,7 @@ constexpr char kLandmarksTag[] = "LANDMARKS";
 constexpr char kNormLandmarksTag[] = "NORM_LANDMARKS";
 constexpr char kRenderScaleTag[] = "RENDER_SCALE";
 constexpr char kRenderDataTag[] = "RENDER_DATA";
+constexpr char kRenderCommandsTag[] = "RENDER_COMMANDS";
 constexpr char kLandmarkLabel[] = "KEYPOINT";
 
 inline Color DefaultMinDepthLineColor() {
@@ -103,19 +105,16 @@ bool IsLandmarkVisibleAndPresent(const LandmarkType& landmark,
 }
 
 void SetColorSizeValueFromZ(float z, float z_min, float z_max,
-                            RenderAnnotation* render_annotation,
                             float min_depth_circle_thickness,
-                            float max_depth_circle_thickness) {
+                            float max_depth_circle_thickness, Color* color,
+                            float* thickness) {
   const int color_value = 255 - static_cast<int>(Remap(z, z_min, z_max, 255));
-  ::mediapipe::Color color;
-  color.set_r(color_value);
-  color.set_g(color_value);
-  color.set_b(color_value);
-  SetColor(render_annotation, color);
+  color->set_r(color_value);
+  color->set_g(color_value);
+  color->set_b(color_value);
   const float scale = max_depth_circle_thickness - min_depth_circle_thickness;
-  const int thickness = static_cast<int>(
+  *thickness = static_cast<int>(
       min_depth_circle_thickness + (1.f - Remap(z, z_min, z_max, 1)) * scale);
-  render_annotation->set_thickness(thickness);
 }
 
 template <class LandmarkType>
@@ -142,7 +141,22 @@ void AddConnectionToRenderData(const LandmarkType& start,
   connection_annotation->set_thickness(thickness);
 }
 
-template <class LandmarkListType, class LandmarkType>
+template <class LandmarkType>
+void AddConnectionToRenderData(const LandmarkType& start,
+                               const LandmarkType& end,
+                               const Color& color_start, const Color& color_end,
+                               float thickness, bool normalized,
+                               RenderCommands* render_commands) {
+  RenderCommands::Style style;
+  style.color = ToRgb(color_start);
+  style.color2 = ToRgb(color_end);
+  style.thickness = thickness;
+  style.normalized = normalized;
+  render_commands->SetStyle(style);
+  render_commands->AddGradientLine(start.x(), start.y(), end.x(), end.y());
+}
+
+template <class LandmarkListType, class LandmarkType, class OutputType>
 void AddConnectionsWithDepth(const LandmarkListType& landmarks,
                              const std::vector<int>& landmark_connections,
                              bool utilize_visibility,
@@ -151,7 +165,7 @@ void AddConnectionsWithDepth(const LandmarkListType& landmarks,
                              bool normalized, float min_z, float max_z,
                              const Color& min_depth_line_color,
                              const Color& max_depth_line_color,
-                             RenderData* render_data) {
+                             OutputType* output) {
   for (int i = 0; i < landmark_connections.size(); i += 2) {
     if (landmark_connections[i] >= landmarks.landmark_size() ||
         landmark_connections[i + 1] >= landmarks.landmark_size()) {
@@ -172,7 +186,7 @@ void AddConnectionsWithDepth(const LandmarkListType& landmarks,
     const Color color1 = MixColors(min_depth_line_color, max_depth_line_color,
                                    Remap(ld1.z(), min_z, max_z, 1.f));
     AddConnectionToRenderData<LandmarkType>(ld0, ld1, color0, color1, thickness,
-                                            normalized, render_data);
+                                            normalized, output);
   }
 }
 
@@ -192,13 +206,27 @@ void AddConnectionToRenderData(const LandmarkType& start,
   connection_annotation->set_thickness(thickness);
 }
 
-template <class LandmarkListType, class LandmarkType>
+template <class LandmarkType>
+void AddConnectionToRenderData(const LandmarkType& start,
+                               const LandmarkType& end,
+                               const Color& connection_color, float thickness,
+                               bool normalized,
+                               RenderCommands* render_commands) {
+  RenderCommands::Style style;
+  style.color = ToRgb(connection_color);
+  style.thickness = thickness;
+  style.normalized = normalized;
+  render_commands->SetStyle(style);
+  render_commands->AddLine(start.x(), start.y(), end.x(), end.y());
+}
+
+template <class LandmarkListType, class LandmarkType, class OutputType>
 void AddConnections(const LandmarkListType& landmarks,
                     const std::vector<int>& landmark_connections,
                     bool utilize_visibility, float visibility_threshold,
                     bool utilize_presence, float presence_threshold,
                     const Color& connection_color, float thickness,
-                    bool normalized, RenderData* render_data) {
+                    bool normalized, OutputType* output) {
   for (int i = 0; i < landmark_connections.size(); i += 2) {
     if (landmark_connections[i] >= landmarks.landmark_size() ||
         landmark_connections[i + 1] >= landmarks.landmark_size()) {
@@ -215,17 +243,111 @@ void AddConnections(const LandmarkListType& landmarks,
       continue;
     }
     AddConnectionToRenderData<LandmarkType>(ld0, ld1, connection_color,
-                                            thickness, normalized, render_data);
+                                            thickness, normalized, output);
   }
 }
 
-RenderAnnotation* AddPointRenderData(const Color& landmark_color,
-                                     float thickness, RenderData* render_data) {
+void AddPointRenderData(float x, float y, bool normalized,
+                        const Color& landmark_color, float thickness,
+                        RenderData* render_data) {
   auto* landmark_data_annotation = render_data->add_render_annotations();
   landmark_data_annotation->set_scene_tag(kLandmarkLabel);
   SetColor(landmark_data_annotation, landmark_color);
   landmark_data_annotation->set_thickness(thickness);
-  return landmark_data_annotation;
+  auto* landmark_data = landmark_data_annotation->mutable_point();
+  landmark_data->set_normalized(normalized);
+  landmark_data->set_x(x);
+  landmark_data->set_y(y);
+}
+
+void AddPointRenderData(float x, float y, bool normalized,
+                        const Color& landmark_color, float thickness,
+                        RenderCommands* render_commands) {
+  RenderCommands::Style style;
+  style.color = ToRgb(landmark_color);
+  style.thickness = thickness;
+  style.normalized = normalized;
+  render_commands->SetStyle(style);
+  render_commands->AddPoint(x, y);
+}
+
+// Adds the connections, then the points, of the landmarks to the output.
+template <class LandmarkListType, class LandmarkType, class OutputType>
+void AddLandmarks(const LandmarkListType& landmarks,
+                  const std::vector<int>& landmark_connections,
+                  const LandmarksToRenderDataCalculatorOptions& options,
+                  float thickness, bool normalized, OutputType* output) {
+  bool visualize_depth = options.visualize_landmark_depth();
+  float z_min = 0.f;
+  float z_max = 0.f;
+
+  const Color min_depth_line_color = options.has_min_depth_line_color()
+                                         ? options.min_depth_line_color()
+                                         : DefaultMinDepthLineColor();
+  const Color max_depth_line_color = options.has_max_depth_line_color()
+                                         ? options.max_depth_line_color()
+                                         : DefaultMaxDepthLineColor();
+
+  if (visualize_depth) {
+    GetMinMaxZ<LandmarkListType, LandmarkType>(landmarks, &z_min, &z_max);
+  }
+  // Only change rendering if there are actually z values other than 0.
+  visualize_depth &= ((z_max - z_min) > 1e-3);
+  if (visualize_depth) {
+    AddConnectionsWithDepth<LandmarkListType, LandmarkType>(
+        landmarks, landmark_connections, options.utilize_visibility(),
+        options.visibility_threshold(), options.utilize_presence(),
+        options.presence_threshold(), thickness, normalized, z_min, z_max,
+        min_depth_line_color, max_depth_line_color, output);
+  } else {
+    AddConnections<LandmarkListType, LandmarkType>(
+        landmarks, landmark_connections, options.utilize_visibility(),
+        options.visibility_threshold(), options.utilize_presence(),
+        options.presence_threshold(), options.connection_color(), thickness,
+        normalized, output);
+  }
+  Color depth_color;
+  for (int i = 0; i < landmarks.landmark_size(); ++i) {
+    const LandmarkType& landmark = landmarks.landmark(i);
+
+    if (!IsLandmarkVisibleAndPresent<LandmarkType>(
+            landmark, options.utilize_visibility(),
+            options.visibility_threshold(), options.utilize_presence(),
+            options.presence_threshold())) {
+      continue;
+    }
+
+    if (visualize_depth) {
+      float depth_thickness;
+      SetColorSizeValueFromZ(landmark.z(), z_min, z_max,
+                             options.min_depth_circle_thickness(),
+                             options.max_depth_circle_thickness(),
+                             &depth_color, &depth_thickness);
+      AddPointRenderData(landmark.x(), landmark.y(), normalized, depth_color,
+                         depth_thickness, output);
+    } else {
+      AddPointRenderData(landmark.x(), landmark.y(), normalized,
+                         options.landmark_color(), thickness, output);
+    }
+  }
+}
+
+template <class OutputType>
+void AddInputLandmarks(CalculatorContext* cc,
+                       const std::vector<int>& landmark_connections,
+                       const LandmarksToRenderDataCalculatorOptions& options,
+                       float thickness, OutputType* output) {
+  if (cc->Inputs().HasTag(kLandmarksTag)) {
+    AddLandmarks<LandmarkList, Landmark>(
+        cc->Inputs().Tag(kLandmarksTag).Get<LandmarkList>(),
+        landmark_connections, options, thickness, /*normalized=*/false,
+        output);
+  }
+  if (cc->Inputs().HasTag(kNormLandmarksTag)) {
+    AddLandmarks<NormalizedLandmarkList, NormalizedLandmark>(
+        cc->Inputs().Tag(kNormLandmarksTag).Get<NormalizedLandmarkList>(),
+        landmark_connections, options, thickness, /*normalized=*/true, output);
+  }
 }
 
 }  // namespace
@@ -249,7 +371,15 @@ absl::Status LandmarksToRenderDataCalculator::GetContract(
   if (cc->Inputs().HasTag(kRenderScaleTag)) {
     cc->Inputs().Tag(kRenderScaleTag).Set<float>();
   }
-  cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  RET_CHECK(cc->Outputs().HasTag(kRenderDataTag) ||
+            cc->Outputs().HasTag(kRenderCommandsTag))
+      << "At least one of RENDER_DATA and RENDER_COMMANDS must be output.";
+  if (cc->Outputs().HasTag(kRenderDataTag)) {
+    cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  }
+  if (cc->Outputs().HasTag(kRenderCommandsTag)) {
+    cc->Outputs().Tag(kRenderCommandsTag).Set<RenderCommands>();
+  }
   return absl::OkStatus();
 }
 
@@ -280,18 +410,6 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
     return absl::OkStatus();
   }
 
-  auto render_data = absl::make_unique<RenderData>();
-  bool visualize_depth = options_.visualize_landmark_depth();
-  float z_min = 0.f;
-  float z_max = 0.f;
-
-  const Color min_depth_line_color = options_.has_min_depth_line_color()
-                                         ? options_.min_depth_line_color()
-                                         : DefaultMinDepthLineColor();
-  const Color max_depth_line_color = options_.has_max_depth_line_color()
-                                         ? options_.max_depth_line_color()
-                                         : DefaultMaxDepthLineColor();
-
   // Apply scale to `thickness` of rendered landmarks and connections to make
   // them bigger when object (e.g. pose, hand or face) is closer/bigger and
   // snaller when object is further/smaller.
@@ -301,100 +419,22 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
     thickness *= render_scale;
   }
 
-  if (cc->Inputs().HasTag(kLandmarksTag)) {
-    const LandmarkList& landmarks =
-        cc->Inputs().Tag(kLandmarksTag).Get<LandmarkList>();
-    if (visualize_depth) {
-      GetMinMaxZ<LandmarkList, Landmark>(landmarks, &z_min, &z_max);
-    }
-    // Only change rendering if there are actually z values other than 0.
-    visualize_depth &= ((z_max - z_min) > 1e-3);
-    if (visualize_depth) {
-      AddConnectionsWithDepth<LandmarkList, Landmark>(
-          landmarks, landmark_connections_, options_.utilize_visibility(),
-          options_.visibility_threshold(), options_.utilize_presence(),
-          options_.presence_threshold(), thickness, /*normalized=*/false, z_min,
-          z_max, min_depth_line_color, max_depth_line_color, render_data.get());
-    } else {
-      AddConnections<LandmarkList, Landmark>(
-          landmarks, landmark_connections_, options_.utilize_visibility(),
-          options_.visibility_threshold(), options_.utilize_presence(),
-          options_.presence_threshold(), options_.connection_color(), thickness,
-          /*normalized=*/false, render_data.get());
-    }
-    for (int i = 0; i < landmarks.landmark_size(); ++i) {
-      const Landmark& landmark = landmarks.landmark(i);
-
-      if (!IsLandmarkVisibleAndPresent<Landmark>(
-              landmark, options_.utilize_visibility(),
-              options_.visibility_threshold(), options_.utilize_presence(),
-              options_.presence_threshold())) {
-        continue;
-      }
-
-      auto* landmark_data_render = AddPointRenderData(
-          options_.landmark_color(), thickness, render_data.get());
-      if (visualize_depth) {
-        SetColorSizeValueFromZ(landmark.z(), z_min, z_max, landmark_data_render,
-                               options_.min_depth_circle_thickness(),
-                               options_.max_depth_circle_thickness());
-      }
-      auto* landmark_data = landmark_data_render->mutable_point();
-      landmark_data->set_normalized(false);
-      landmark_data->set_x(landmark.x());
-      landmark_data->set_y(landmark.y());
-    }
+  if (cc->Outputs().HasTag(kRenderDataTag)) {
+    auto render_data = absl::make_unique<RenderData>();
+    AddInputLandmarks(cc, landmark_connections_, options_, thickness,
+                      render_data.get());
+    cc->Outputs()
+        .Tag(kRenderDataTag)
+        .Add(render_data.release(), cc->InputTimestamp());
   }
-
-  if (cc->Inputs().HasTag(kNormLandmarksTag)) {
-    const NormalizedLandmarkList& landmarks =
-        cc->Inputs().Tag(kNormLandmarksTag).Get<NormalizedLandmarkList>();
-    if (visualize_depth) {
-      GetMinMaxZ<NormalizedLandmarkList, NormalizedLandmark>(landmarks, &z_min,
-                                                             &z_max);
-    }
-    // Only change rendering if there are actually z values other than 0.
-    visualize_depth &= ((z_max - z_min) > 1e-3);
-    if (visualize_depth) {
-      AddConnectionsWithDepth<NormalizedLandmarkList, NormalizedLandmark>(
-          landmarks, landmark_connections_, options_.utilize_visibility(),
-          options_.visibility_threshold(), options_.utilize_presence(),
-          options_.presence_threshold(), thickness, /*normalized=*/true, z_min,
-          z_max, min_depth_line_color, max_depth_line_color, render_data.get());
-    } else {
-      AddConnections<NormalizedLandmarkList, NormalizedLandmark>(
-          landmarks, landmark_connections_, options_.utilize_visibility(),
-          options_.visibility_threshold(), options_.utilize_presence(),
-          options_.presence_threshold(), options_.connection_color(), thickness,
-          /*normalized=*/true, render_data.get());
-    }
-    for (int i = 0; i < landmarks.landmark_size(); ++i) {
-      const NormalizedLandmark& landmark = landmarks.landmark(i);
-
-      if (!IsLandmarkVisibleAndPresent<NormalizedLandmark>(
-              landmark, options_.utilize_visibility(),
-              options_.visibility_threshold(), options_.utilize_presence(),
-              options_.presence_threshold())) {
-        continue;
-      }
-
-      auto* landmark_data_render = AddPointRenderData(
-          options_.landmark_color(), thickness, render_data.get());
-      if (visualize_depth) {
-        SetColorSizeValueFromZ(landmark.z(), z_min, z_max, landmark_data_render,
-                               options_.min_depth_circle_thickness(),
-                               options_.max_depth_circle_thickness());
-      }
-      auto* landmark_data = landmark_data_render->mutable_point();
-      landmark_data->set_normalized(true);
-      landmark_data->set_x(landmark.x());
-      landmark_data->set_y(landmark.y());
-    }
+  if (cc->Outputs().HasTag(kRenderCommandsTag)) {
+    auto render_commands = absl::make_unique<RenderCommands>();
+    AddInputLandmarks(cc, landmark_connections_, options_, thickness,
+                      render_commands.get());
+    cc->Outputs()
+        .Tag(kRenderCommandsTag)
+        .Add(render_commands.release(), cc->InputTimestamp());
   }
-
-  cc->Outputs()
-      .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
   return absl::OkStatus();
 }
 
@@ -31,6 +31,10 @@ namespace mediapipe {
 // visualization. The input should be LandmarkList proto. It is also possible
 // to specify the connections between landmarks.
 //
+// The same annotations can be output as RenderCommands on the RENDER_COMMANDS
+// stream, instead of or besides RENDER_DATA, for AnnotationOverlayCalculator
+// to draw without a RenderAnnotation per landmark and connection.
+//
 // Example config:
 // node {
 //   calculator: "LandmarksToRenderDataCalculator"
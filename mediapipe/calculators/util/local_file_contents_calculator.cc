@@ -73,6 +73,7 @@ class LocalFileContentsCalculator : public CalculatorBase {
       cc->OutputSidePackets().Get(id).Set<std::string>();
     }
 
+    cc->SetPure(true);
     return absl::OkStatus();
   }
 
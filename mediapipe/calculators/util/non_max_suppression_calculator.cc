@@ -18,13 +18,17 @@
 #include <utility>
 #include <vector>
 
+#include "Eigen/Core"
 #include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/location.h"
+#include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/rectangle.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 
 namespace mediapipe {
@@ -35,6 +39,7 @@ typedef std::vector<std::pair<int, float>> IndexedScores;
 namespace {
 
 constexpr char kImageTag[] = "IMAGE";
+constexpr char kDetectionBatchTag[] = "DETECTION_BATCH";
 
 bool SortBySecond(const std::pair<int, float>& indexed_score_0,
                   const std::pair<int, float>& indexed_score_1) {
@@ -120,6 +125,119 @@ float OverlapSimilarity(
   return OverlapSimilarity(overlap_type, rect1, rect2);
 }
 
+// Number of boxes compared at a time on the fast path. A fixed-size Eigen
+// array of this many floats is vectorized with AVX2 or NEON where available.
+constexpr int kBoxBlockSize = 8;
+using BoxBlock = Eigen::Array<float, kBoxBlockSize, 1>;
+using BoxBlockMask = Eigen::Array<bool, kBoxBlockSize, 1>;
+
+// The relative bounding boxes retained by the fast path, in structure-of-arrays
+// layout. The arrays are padded with empty boxes to a multiple of
+// kBoxBlockSize. An empty box has a similarity of 0 with any box, so a padding
+// box can only suppress a candidate that a real box in its block suppresses as
+// well.
+class RetainedBoxes {
+ public:
+  explicit RetainedBoxes(int capacity) {
+    const int padded_capacity =
+        (capacity + kBoxBlockSize - 1) / kBoxBlockSize * kBoxBlockSize;
+    for (auto* values : {&xmin_, &ymin_, &xmax_, &ymax_, &area_}) {
+      values->reserve(padded_capacity);
+    }
+  }
+
+  void Add(const Rectangle_f& box) {
+    if (size_ % kBoxBlockSize == 0) {
+      for (auto* values : {&xmin_, &ymin_, &area_}) {
+        values->resize(size_ + kBoxBlockSize, 0.0f);
+      }
+      for (auto* values : {&xmax_, &ymax_}) {
+        values->resize(size_ + kBoxBlockSize, -1.0f);
+      }
+    }
+    xmin_[size_] = box.xmin();
+    ymin_[size_] = box.ymin();
+    xmax_[size_] = box.xmax();
+    ymax_[size_] = box.ymax();
+    area_[size_] = box.Area();
+    ++size_;
+  }
+
+  // Returns true iff OverlapSimilarity(overlap_type, retained, candidate)
+  // exceeds "threshold" for some retained box. This evaluates the same
+  // expressions as OverlapSimilarity(), one block of boxes at a time, and
+  // stops at the first block containing a suppressing box.
+  bool Suppresses(
+      const Rectangle_f& candidate,
+      const NonMaxSuppressionCalculatorOptions::OverlapType overlap_type,
+      float threshold) const {
+    if (size_ == 0) return false;
+    if (candidate.IsEmpty()) return 0.0f > threshold;
+    const BoxBlock cxmin = BoxBlock::Constant(candidate.xmin());
+    const BoxBlock cymin = BoxBlock::Constant(candidate.ymin());
+    const BoxBlock cxmax = BoxBlock::Constant(candidate.xmax());
+    const BoxBlock cymax = BoxBlock::Constant(candidate.ymax());
+    const float candidate_area = candidate.Area();
+    for (int i = 0; i < size_; i += kBoxBlockSize) {
+      const Eigen::Map<const BoxBlock> xmin(&xmin_[i]);
+      const Eigen::Map<const BoxBlock> ymin(&ymin_[i]);
+      const Eigen::Map<const BoxBlock> xmax(&xmax_[i]);
+      const Eigen::Map<const BoxBlock> ymax(&ymax_[i]);
+      const BoxBlockMask intersects = xmin <= xmax && ymin <= ymax &&
+                                      xmax >= cxmin && cxmax >= xmin &&
+                                      ymax >= cymin && cymax >= ymin;
+      const BoxBlock intersection_area =
+          (xmax.min(cxmax) - xmin.max(cxmin)) *
+          (ymax.min(cymax) - ymin.max(cymin));
+      BoxBlock normalization;
+      switch (overlap_type) {
+        case NonMaxSuppressionCalculatorOptions::JACCARD:
+          normalization = (xmax.max(cxmax) - xmin.min(cxmin)) *
+                          (ymax.max(cymax) - ymin.min(cymin));
+          break;
+        case NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD:
+          normalization = BoxBlock::Constant(candidate_area);
+          break;
+        case NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION:
+          normalization =
+              (Eigen::Map<const BoxBlock>(&area_[i]) + candidate_area) -
+              intersection_area;
+          break;
+        default:
+          LOG(FATAL) << "Unrecognized overlap type: " << overlap_type;
+      }
+      const BoxBlock similarity =
+          (intersects && normalization > 0.0f)
+              .select(intersection_area / normalization, 0.0f);
+      if ((similarity > threshold).any()) return true;
+    }
+    return false;
+  }
+
+ private:
+  int size_ = 0;
+  std::vector<float> xmin_;
+  std::vector<float> ymin_;
+  std::vector<float> xmax_;
+  std::vector<float> ymax_;
+  std::vector<float> area_;
+};
+
+// Returns the relative bounding box of detection "index" of "detections".
+Rectangle_f RelativeBox(const DetectionBatch& detections, int index) {
+  return Rectangle_f(detections.xmin[index], detections.ymin[index],
+                     detections.width[index], detections.height[index]);
+}
+
+// Returns the score that RetainMaxScoringLabelOnly() would retain.
+float MaxScore(const Detection& detection) {
+  CHECK(detection.label_id_size() == detection.score_size() ||
+        detection.label_size() == detection.score_size())
+      << "Number of scores must be equal to number of detections.";
+  CHECK_GT(detection.score_size(), 0);
+  return *std::max_element(detection.score().begin(), detection.score().end());
+}
+
 }  // namespace
 
 // A calculator performing non-maximum suppression on a set of detections.
@@ -134,6 +252,11 @@ float OverlapSimilarity(
 // Outputs: a single stream of type std::vector<Detection> containing a subset
 //   of the input detections after non-maximum suppression.
 //
+// The detections can instead be DetectionBatches on the DETECTION_BATCH:0 to
+// DETECTION_BATCH:<num_detection_streams - 1> input streams, and are then
+// output as a DetectionBatch on the DETECTION_BATCH output stream. The boxes
+// are compared in place, and only the retained detections are copied.
+//
 // Example config:
 // node {
 //   calculator: "NonMaxSuppressionCalculator"
@@ -160,6 +283,15 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
     if (cc->Inputs().HasTag(kImageTag)) {
       cc->Inputs().Tag(kImageTag).Set<ImageFrame>();
     }
+    if (cc->Inputs().HasTag(kDetectionBatchTag)) {
+      RET_CHECK(cc->Outputs().HasTag(kDetectionBatchTag))
+          << "DETECTION_BATCH inputs require a DETECTION_BATCH output.";
+      for (int k = 0; k < options.num_detection_streams(); ++k) {
+        cc->Inputs().Get(kDetectionBatchTag, k).Set<DetectionBatch>();
+      }
+      cc->Outputs().Tag(kDetectionBatchTag).Set<DetectionBatch>();
+      return absl::OkStatus();
+    }
     for (int k = 0; k < options.num_detection_streams(); ++k) {
       cc->Inputs().Index(k).Set<Detections>();
     }
@@ -181,6 +313,16 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
+    if (cc->Inputs().HasTag(kDetectionBatchTag)) {
+      return ProcessDetectionBatches(cc);
+    }
+    // The fast path doesn't normalize boxes by the size of the IMAGE frames.
+    if (!options_.use_reference_implementation() &&
+        options_.algorithm() == NonMaxSuppressionCalculatorOptions::DEFAULT &&
+        !cc->Inputs().HasTag(kImageTag) && FastNonMaxSuppression(cc)) {
+      return absl::OkStatus();
+    }
+
     // Add all input detections to the same vector.
     Detections input_detections;
     for (int i = 0; i < options_.num_detection_streams(); ++i) {
@@ -249,6 +391,165 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
   }
 
  private:
+  // Equivalent to Process() for the DETECTION_BATCH streams, which have a
+  // single label per detection and relative boxes only.
+  absl::Status ProcessDetectionBatches(CalculatorContext* cc) {
+    // The input batches are only concatenated if there are several of them.
+    const DetectionBatch* detections = nullptr;
+    DetectionBatch concatenated;
+    for (int i = 0; i < options_.num_detection_streams(); ++i) {
+      const auto& detections_packet =
+          cc->Inputs().Get(kDetectionBatchTag, i).Value();
+      if (detections_packet.IsEmpty()) {
+        continue;
+      }
+      const auto& batch = detections_packet.Get<DetectionBatch>();
+      if (detections == nullptr) {
+        detections = &batch;
+        continue;
+      }
+      if (detections != &concatenated) {
+        concatenated = *detections;
+        detections = &concatenated;
+      }
+      RET_CHECK_EQ(batch.num_keypoints, concatenated.num_keypoints)
+          << "Detection batches must have the same number of keypoints.";
+      for (int index = 0; index < batch.size(); ++index) {
+        concatenated.Append(batch, index);
+      }
+    }
+
+    if (detections == nullptr || detections->empty()) {
+      if (options_.return_empty_detections()) {
+        auto empty_detections = std::make_unique<DetectionBatch>();
+        if (detections != nullptr) {
+          empty_detections->num_keypoints = detections->num_keypoints;
+        }
+        cc->Outputs()
+            .Tag(kDetectionBatchTag)
+            .Add(empty_detections.release(), cc->InputTimestamp());
+      }
+      return absl::OkStatus();
+    }
+
+    IndexedScores indexed_scores;
+    indexed_scores.reserve(detections->size());
+    for (int index = 0; index < detections->size(); ++index) {
+      indexed_scores.push_back(
+          std::make_pair(index, detections->score[index]));
+    }
+    std::sort(indexed_scores.begin(), indexed_scores.end(), SortBySecond);
+
+    const int max_num_detections =
+        (options_.max_num_detections() > -1)
+            ? options_.max_num_detections()
+            : static_cast<int>(indexed_scores.size());
+    auto retained_detections = std::make_unique<DetectionBatch>();
+    retained_detections->num_keypoints = detections->num_keypoints;
+    if (options_.algorithm() == NonMaxSuppressionCalculatorOptions::WEIGHTED) {
+      WeightedNonMaxSuppression(indexed_scores, *detections,
+                                retained_detections.get());
+    } else {
+      RetainedBoxes retained_boxes(
+          std::min<int>(max_num_detections, indexed_scores.size()));
+      for (const auto& indexed_score : indexed_scores) {
+        if (options_.min_score_threshold() > 0 &&
+            indexed_score.second < options_.min_score_threshold()) {
+          break;
+        }
+        const Rectangle_f rect = RelativeBox(*detections, indexed_score.first);
+        if (!retained_boxes.Suppresses(rect, options_.overlap_type(),
+                                       options_.min_suppression_threshold())) {
+          retained_boxes.Add(rect);
+          retained_detections->Append(*detections, indexed_score.first);
+        }
+        if (retained_detections->size() >= max_num_detections) {
+          break;
+        }
+      }
+    }
+
+    cc->Outputs()
+        .Tag(kDetectionBatchTag)
+        .Add(retained_detections.release(), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+
+  // Equivalent to the DEFAULT algorithm in Process(), but compares boxes in
+  // blocks using SIMD and copies only the retained detections. The retained
+  // boxes must be relative and there must be no IMAGE input, so that no frame
+  // size is involved. Returns false without producing any output if some input
+  // box is not relative.
+  bool FastNonMaxSuppression(CalculatorContext* cc) {
+    std::vector<const Detection*> candidates;
+    bool has_input_detections = false;
+    for (int i = 0; i < options_.num_detection_streams(); ++i) {
+      const auto& detections_packet = cc->Inputs().Index(i).Value();
+      if (detections_packet.IsEmpty()) {
+        continue;
+      }
+      for (const auto& detection : detections_packet.Get<Detections>()) {
+        has_input_detections = true;
+        if (detection.label_id_size() == 0 && detection.label_size() == 0) {
+          continue;
+        }
+        if (detection.location_data().format() !=
+            LocationData::RELATIVE_BOUNDING_BOX) {
+          return false;
+        }
+        candidates.push_back(&detection);
+      }
+    }
+
+    if (!has_input_detections) {
+      if (options_.return_empty_detections()) {
+        cc->Outputs().Index(0).Add(new Detections(), cc->InputTimestamp());
+      }
+      return true;
+    }
+
+    // Sorted exactly like the scores in Process(), so that ties are broken
+    // the same way.
+    IndexedScores indexed_scores;
+    indexed_scores.reserve(candidates.size());
+    for (int index = 0; index < candidates.size(); ++index) {
+      indexed_scores.push_back(
+          std::make_pair(index, MaxScore(*candidates[index])));
+    }
+    std::sort(indexed_scores.begin(), indexed_scores.end(), SortBySecond);
+
+    const int max_num_detections =
+        (options_.max_num_detections() > -1)
+            ? options_.max_num_detections()
+            : static_cast<int>(indexed_scores.size());
+    auto* retained_detections = new Detections();
+    retained_detections->reserve(
+        std::min<int>(max_num_detections, indexed_scores.size()));
+    RetainedBoxes retained_boxes(retained_detections->capacity());
+    for (const auto& indexed_score : indexed_scores) {
+      if (options_.min_score_threshold() > 0 &&
+          indexed_score.second < options_.min_score_threshold()) {
+        break;
+      }
+      const Detection& detection = *candidates[indexed_score.first];
+      const auto& box = detection.location_data().relative_bounding_box();
+      const Rectangle_f rect(box.xmin(), box.ymin(), box.width(),
+                             box.height());
+      if (!retained_boxes.Suppresses(rect, options_.overlap_type(),
+                                     options_.min_suppression_threshold())) {
+        retained_boxes.Add(rect);
+        retained_detections->push_back(detection);
+        RetainMaxScoringLabelOnly(&retained_detections->back());
+      }
+      if (retained_detections->size() >= max_num_detections) {
+        break;
+      }
+    }
+
+    cc->Outputs().Index(0).Add(retained_detections, cc->InputTimestamp());
+    return true;
+  }
+
   void NonMaxSuppression(const IndexedScores& indexed_scores,
                          const Detections& detections, int max_num_detections,
                          CalculatorContext* cc, Detections* output_detections) {
@@ -378,6 +679,85 @@ class NonMaxSuppressionCalculator : public CalculatorBase {
     }
   }
 
+  // Equivalent to WeightedNonMaxSuppression() above for a DetectionBatch.
+  void WeightedNonMaxSuppression(const IndexedScores& indexed_scores,
+                                 const DetectionBatch& detections,
+                                 DetectionBatch* output_detections) {
+    IndexedScores remained_indexed_scores = indexed_scores;
+    IndexedScores remained;
+    IndexedScores candidates;
+    const int num_keypoints = detections.num_keypoints;
+    std::vector<float> keypoints(num_keypoints * 2);
+    while (!remained_indexed_scores.empty()) {
+      const int original_indexed_scores_size = remained_indexed_scores.size();
+      const int index = remained_indexed_scores[0].first;
+      if (options_.min_score_threshold() > 0 &&
+          detections.score[index] < options_.min_score_threshold()) {
+        break;
+      }
+      remained.clear();
+      candidates.clear();
+      const Rectangle_f location = RelativeBox(detections, index);
+      // This includes the first box.
+      for (const auto& indexed_score : remained_indexed_scores) {
+        const float similarity = OverlapSimilarity(
+            options_.overlap_type(),
+            RelativeBox(detections, indexed_score.first), location);
+        if (similarity > options_.min_suppression_threshold()) {
+          candidates.push_back(indexed_score);
+        } else {
+          remained.push_back(indexed_score);
+        }
+      }
+      output_detections->Append(detections, index);
+      if (!candidates.empty()) {
+        std::fill(keypoints.begin(), keypoints.end(), 0.0f);
+        float w_xmin = 0.0f;
+        float w_ymin = 0.0f;
+        float w_xmax = 0.0f;
+        float w_ymax = 0.0f;
+        float total_score = 0.0f;
+        for (const auto& candidate : candidates) {
+          const int i = candidate.first;
+          total_score += candidate.second;
+          w_xmin += detections.xmin[i] * candidate.second;
+          w_ymin += detections.ymin[i] * candidate.second;
+          w_xmax += (detections.xmin[i] + detections.width[i]) *
+                    candidate.second;
+          w_ymax += (detections.ymin[i] + detections.height[i]) *
+                    candidate.second;
+          for (int k = 0; k < num_keypoints; ++k) {
+            keypoints[k * 2] +=
+                detections.keypoint_x[i * num_keypoints + k] * candidate.second;
+            keypoints[k * 2 + 1] +=
+                detections.keypoint_y[i * num_keypoints + k] * candidate.second;
+          }
+        }
+        const int out = output_detections->size() - 1;
+        const float xmin = w_xmin / total_score;
+        const float ymin = w_ymin / total_score;
+        output_detections->xmin[out] = xmin;
+        output_detections->ymin[out] = ymin;
+        output_detections->width[out] = (w_xmax / total_score) - xmin;
+        output_detections->height[out] = (w_ymax / total_score) - ymin;
+        for (int k = 0; k < num_keypoints; ++k) {
+          output_detections->keypoint_x[out * num_keypoints + k] =
+              keypoints[k * 2] / total_score;
+          output_detections->keypoint_y[out * num_keypoints + k] =
+              keypoints[k * 2 + 1] / total_score;
+        }
+      }
+
+      // Breaks the loop if the size of indexed scores doesn't change after an
+      // iteration.
+      if (original_indexed_scores_size == remained.size()) {
+        break;
+      } else {
+        remained_indexed_scores = std::move(remained);
+      }
+    }
+  }
+
   NonMaxSuppressionCalculatorOptions options_;
 };
 REGISTER_CALCULATOR(NonMaxSuppressionCalculator);
@@ -0,0 +1,104 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <vector>
+
+#include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
+#include "mediapipe/framework/benchmarks/calculator_benchmark.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/location_data.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumPackets = 16;
+
+// Returns a config suppressing detections with the given algorithm.
+CalculatorGraphConfig::Node MakeNodeConfig(
+    NonMaxSuppressionCalculatorOptions::NmsAlgorithm algorithm) {
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "NonMaxSuppressionCalculator"
+        input_stream: "detections"
+        output_stream: "retained_detections"
+        options {
+          [mediapipe.NonMaxSuppressionCalculatorOptions.ext] {
+            min_suppression_threshold: 0.3
+            overlap_type: INTERSECTION_OVER_UNION
+          }
+        }
+      )pb");
+  node_config.mutable_options()
+      ->MutableExtension(NonMaxSuppressionCalculatorOptions::ext)
+      ->set_algorithm(algorithm);
+  return node_config;
+}
+
+// Adds packets of state.range(0) detections with random boxes and scores,
+// clustered like the raw output of a detection model.
+absl::Status AddDetections(benchmark::State& state, CalculatorRunner* runner) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> center(0.1f, 0.9f);
+  std::uniform_real_distribution<float> jitter(-0.02f, 0.02f);
+  std::uniform_real_distribution<float> score(0.0f, 1.0f);
+  for (int t = 0; t < kNumPackets; ++t) {
+    std::vector<Detection> detections(state.range(0));
+    float x = center(rng);
+    float y = center(rng);
+    for (int i = 0; i < detections.size(); ++i) {
+      if (i % 8 == 0) {
+        x = center(rng);
+        y = center(rng);
+      }
+      Detection& detection = detections[i];
+      detection.add_score(score(rng));
+      detection.add_label_id(0);
+      LocationData* location_data = detection.mutable_location_data();
+      location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+      auto* box = location_data->mutable_relative_bounding_box();
+      box->set_xmin(x + jitter(rng) - 0.05f);
+      box->set_ymin(y + jitter(rng) - 0.05f);
+      box->set_width(0.1f);
+      box->set_height(0.1f);
+    }
+    runner->MutableInputs()->Index(0).packets.push_back(
+        MakePacket<std::vector<Detection>>(std::move(detections))
+            .At(Timestamp(t)));
+  }
+  return absl::OkStatus();
+}
+
+MEDIAPIPE_CALCULATOR_BENCHMARK(
+    BM_NonMaxSuppressionDefault,
+    MakeNodeConfig(NonMaxSuppressionCalculatorOptions::DEFAULT), AddDetections)
+    ->Arg(100)
+    ->Arg(1000);
+
+MEDIAPIPE_CALCULATOR_BENCHMARK(
+    BM_NonMaxSuppressionWeighted,
+    MakeNodeConfig(NonMaxSuppressionCalculatorOptions::WEIGHTED),
+    AddDetections)
+    ->Arg(100)
+    ->Arg(1000);
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
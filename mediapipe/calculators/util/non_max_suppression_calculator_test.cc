@@ -0,0 +1,298 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/calculators/util/non_max_suppression_calculator.pb.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/detection_batch.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/location_data.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kImageTag[] = "IMAGE";
+constexpr char kDetectionBatchTag[] = "DETECTION_BATCH";
+
+using ::testing::ElementsAre;
+using ::testing::Pointwise;
+
+Detection MakeDetection(float xmin, float ymin, float width, float height,
+                        float score, int label_id = 0) {
+  Detection detection;
+  detection.add_score(score);
+  detection.add_label_id(label_id);
+  LocationData* location_data = detection.mutable_location_data();
+  location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+  auto* box = location_data->mutable_relative_bounding_box();
+  box->set_xmin(xmin);
+  box->set_ymin(ymin);
+  box->set_width(width);
+  box->set_height(height);
+  return detection;
+}
+
+// Runs the calculator on "detections". If "image_size" is positive, the
+// calculator also receives an IMAGE of that width and height.
+std::vector<Detection> RunNonMaxSuppression(
+    NonMaxSuppressionCalculatorOptions options,
+    const std::vector<Detection>& detections, int image_size = 0) {
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "NonMaxSuppressionCalculator"
+        input_stream: "detections"
+        output_stream: "retained_detections"
+      )pb");
+  if (image_size > 0) {
+    node_config.add_input_stream("IMAGE:image");
+  }
+  *node_config.mutable_options()->MutableExtension(
+      NonMaxSuppressionCalculatorOptions::ext) = options;
+  CalculatorRunner runner(node_config);
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<std::vector<Detection>>(detections).At(Timestamp(0)));
+  if (image_size > 0) {
+    runner.MutableInputs()->Tag(kImageTag).packets.push_back(
+        MakePacket<ImageFrame>(ImageFormat::SRGB, image_size, image_size)
+            .At(Timestamp(0)));
+  }
+  MP_EXPECT_OK(runner.Run());
+  const auto& output_packets = runner.Outputs().Index(0).packets;
+  EXPECT_EQ(output_packets.size(), 1);
+  if (output_packets.empty()) return {};
+  return output_packets[0].Get<std::vector<Detection>>();
+}
+
+MATCHER(DetectionEq, "") {
+  const Detection& actual = std::get<0>(arg);
+  const Detection& expected = std::get<1>(arg);
+  return actual.SerializeAsString() == expected.SerializeAsString();
+}
+
+// Runs the calculator on "detections" packed into one DetectionBatch per
+// stream, and returns the unpacked retained detections.
+std::vector<Detection> RunNonMaxSuppressionOnBatches(
+    NonMaxSuppressionCalculatorOptions options,
+    const std::vector<std::vector<Detection>>& detections) {
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "NonMaxSuppressionCalculator"
+        output_stream: "DETECTION_BATCH:retained_detections"
+      )pb");
+  for (int i = 0; i < detections.size(); ++i) {
+    node_config.add_input_stream(
+        absl::StrCat("DETECTION_BATCH:", i, ":batch_", i));
+  }
+  options.set_num_detection_streams(detections.size());
+  *node_config.mutable_options()->MutableExtension(
+      NonMaxSuppressionCalculatorOptions::ext) = options;
+  CalculatorRunner runner(node_config);
+  for (int i = 0; i < detections.size(); ++i) {
+    auto batch = PackDetections(detections[i]);
+    MP_EXPECT_OK(batch);
+    if (!batch.ok()) return {};
+    runner.MutableInputs()
+        ->Get(kDetectionBatchTag, i)
+        .packets.push_back(
+            MakePacket<DetectionBatch>(*std::move(batch)).At(Timestamp(0)));
+  }
+  MP_EXPECT_OK(runner.Run());
+  const auto& output_packets =
+      runner.Outputs().Tag(kDetectionBatchTag).packets;
+  EXPECT_EQ(output_packets.size(), 1);
+  if (output_packets.empty()) return {};
+  return UnpackDetections(output_packets[0].Get<DetectionBatch>());
+}
+
+TEST(NonMaxSuppressionCalculatorTest, SuppressesOverlappingDetections) {
+  NonMaxSuppressionCalculatorOptions options;
+  options.set_min_suppression_threshold(0.3);
+  options.set_overlap_type(
+      NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION);
+  std::vector<Detection> detections = {
+      MakeDetection(0.1, 0.1, 0.2, 0.2, 0.8),
+      MakeDetection(0.11, 0.11, 0.2, 0.2, 0.9),
+      MakeDetection(0.6, 0.6, 0.2, 0.2, 0.7),
+  };
+  for (bool use_reference_implementation : {false, true}) {
+    options.set_use_reference_implementation(use_reference_implementation);
+    std::vector<Detection> retained =
+        RunNonMaxSuppression(options, detections);
+    ASSERT_EQ(retained.size(), 2);
+    EXPECT_FLOAT_EQ(retained[0].score(0), 0.9);
+    EXPECT_FLOAT_EQ(retained[1].score(0), 0.7);
+  }
+}
+
+TEST(NonMaxSuppressionCalculatorTest, RetainsMaxScoringLabelOnly) {
+  NonMaxSuppressionCalculatorOptions options;
+  Detection detection = MakeDetection(0.1, 0.1, 0.2, 0.2, 0.2, 1);
+  detection.add_score(0.6);
+  detection.add_label_id(2);
+  std::vector<Detection> retained = RunNonMaxSuppression(options, {detection});
+  ASSERT_EQ(retained.size(), 1);
+  EXPECT_THAT(retained[0].score(), ElementsAre(0.6f));
+  EXPECT_THAT(retained[0].label_id(), ElementsAre(2));
+}
+
+TEST(NonMaxSuppressionCalculatorTest, FallsBackForAbsoluteBoxes) {
+  NonMaxSuppressionCalculatorOptions options;
+  options.set_min_suppression_threshold(0.3);
+  std::vector<Detection> detections = {
+      MakeDetection(0.1, 0.1, 0.2, 0.2, 0.8),
+      MakeDetection(0.11, 0.11, 0.2, 0.2, 0.9),
+  };
+  // Overlaps the other two detections once converted to relative coordinates.
+  Detection absolute;
+  absolute.add_score(0.5);
+  absolute.add_label_id(0);
+  LocationData* location_data = absolute.mutable_location_data();
+  location_data->set_format(LocationData::BOUNDING_BOX);
+  location_data->mutable_bounding_box()->set_xmin(10);
+  location_data->mutable_bounding_box()->set_ymin(10);
+  location_data->mutable_bounding_box()->set_width(20);
+  location_data->mutable_bounding_box()->set_height(20);
+  detections.push_back(absolute);
+  std::vector<Detection> retained =
+      RunNonMaxSuppression(options, detections, /*image_size=*/100);
+  ASSERT_EQ(retained.size(), 1);
+  EXPECT_FLOAT_EQ(retained[0].score(0), 0.9);
+}
+
+// Compares the fast path with the reference implementation on dense random
+// detections, for all overlap types and a range of options.
+TEST(NonMaxSuppressionCalculatorTest, FastPathMatchesReference) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> position(-0.1f, 1.0f);
+  std::uniform_real_distribution<float> size(-0.02f, 0.3f);
+  std::uniform_real_distribution<float> score(0.0f, 1.0f);
+  std::vector<Detection> detections;
+  for (int i = 0; i < 2000; ++i) {
+    Detection detection = MakeDetection(position(rng), position(rng),
+                                        size(rng), size(rng), score(rng), i);
+    if (i % 3 == 0) {
+      detection.add_score(score(rng));
+      detection.add_label_id(i + 1);
+    }
+    if (i % 100 == 0) {
+      // Ties in scores must be broken in the same way.
+      detection.set_score(0, 0.5f);
+    }
+    detections.push_back(detection);
+  }
+  for (auto overlap_type :
+       {NonMaxSuppressionCalculatorOptions::JACCARD,
+        NonMaxSuppressionCalculatorOptions::MODIFIED_JACCARD,
+        NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION}) {
+    for (float min_suppression_threshold : {-0.1f, 0.0f, 0.3f, 0.7f}) {
+      for (int max_num_detections : {-1, 5, 100}) {
+        for (float min_score_threshold : {-1.0f, 0.4f}) {
+          SCOPED_TRACE(absl::StrCat(overlap_type, " ",
+                                    min_suppression_threshold, " ",
+                                    max_num_detections, " ",
+                                    min_score_threshold));
+          NonMaxSuppressionCalculatorOptions options;
+          options.set_overlap_type(overlap_type);
+          options.set_min_suppression_threshold(min_suppression_threshold);
+          options.set_max_num_detections(max_num_detections);
+          options.set_min_score_threshold(min_score_threshold);
+          std::vector<Detection> fast =
+              RunNonMaxSuppression(options, detections);
+          options.set_use_reference_implementation(true);
+          std::vector<Detection> reference =
+              RunNonMaxSuppression(options, detections);
+          EXPECT_FALSE(reference.empty());
+          EXPECT_THAT(fast, Pointwise(DetectionEq(), reference));
+        }
+      }
+    }
+  }
+}
+
+// With an IMAGE input, boxes are compared as in the reference implementation,
+// i.e. after conversion with the frame size.
+TEST(NonMaxSuppressionCalculatorTest, ImageInputMatchesReference) {
+  NonMaxSuppressionCalculatorOptions options;
+  options.set_min_suppression_threshold(0.3);
+  std::vector<Detection> detections = {
+      MakeDetection(0.1, 0.1, 0.2, 0.2, 0.8),
+      MakeDetection(0.12, 0.12, 0.2, 0.2, 0.9),
+      MakeDetection(0.6, 0.6, 0.2, 0.2, 0.7),
+  };
+  std::vector<Detection> retained =
+      RunNonMaxSuppression(options, detections, /*image_size=*/100);
+  options.set_use_reference_implementation(true);
+  std::vector<Detection> reference =
+      RunNonMaxSuppression(options, detections, /*image_size=*/100);
+  ASSERT_EQ(reference.size(), 2);
+  EXPECT_THAT(retained, Pointwise(DetectionEq(), reference));
+}
+
+// Compares the DetectionBatch path with the std::vector<Detection> path, with
+// the detections split across two streams.
+TEST(NonMaxSuppressionCalculatorTest, DetectionBatchMatchesDetections) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> position(0.0f, 0.8f);
+  std::uniform_real_distribution<float> size(0.01f, 0.2f);
+  std::uniform_real_distribution<float> score(0.0f, 1.0f);
+  std::vector<Detection> detections;
+  for (int i = 0; i < 200; ++i) {
+    Detection detection = MakeDetection(position(rng), position(rng),
+                                        size(rng), size(rng), score(rng), i);
+    for (int k = 0; k < 2; ++k) {
+      auto* keypoint =
+          detection.mutable_location_data()->add_relative_keypoints();
+      keypoint->set_x(position(rng));
+      keypoint->set_y(position(rng));
+    }
+    detections.push_back(detection);
+  }
+  const std::vector<std::vector<Detection>> streams = {
+      {detections.begin(), detections.begin() + 120},
+      {detections.begin() + 120, detections.end()},
+  };
+  for (auto algorithm : {NonMaxSuppressionCalculatorOptions::DEFAULT,
+                         NonMaxSuppressionCalculatorOptions::WEIGHTED}) {
+    for (int max_num_detections : {-1, 10}) {
+      SCOPED_TRACE(absl::StrCat(algorithm, " ", max_num_detections));
+      NonMaxSuppressionCalculatorOptions options;
+      options.set_algorithm(algorithm);
+      options.set_overlap_type(
+          NonMaxSuppressionCalculatorOptions::INTERSECTION_OVER_UNION);
+      options.set_min_suppression_threshold(0.3);
+      options.set_max_num_detections(max_num_detections);
+      std::vector<Detection> expected =
+          RunNonMaxSuppression(options, detections);
+      EXPECT_FALSE(expected.empty());
+      EXPECT_THAT(RunNonMaxSuppressionOnBatches(options, streams),
+                  Pointwise(DetectionEq(), expected));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,96 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/packed_landmarks.h"
+
+namespace mediapipe {
+namespace api2 {
+
+// Converts PackedNormalizedLandmarks to a NormalizedLandmarkList, where a
+// landmark pipeline working on packed landmarks ends.
+//
+// Inputs:
+//   PACKED_NORM_LANDMARKS - PackedNormalizedLandmarks.
+// Outputs:
+//   NORM_LANDMARKS - NormalizedLandmarkList.
+//
+// Example:
+// node {
+//   calculator: "PackedLandmarksToLandmarksCalculator"
+//   input_stream: "PACKED_NORM_LANDMARKS:packed_landmarks"
+//   output_stream: "NORM_LANDMARKS:landmarks"
+// }
+class PackedLandmarksToLandmarksCalculator : public Node {
+ public:
+  static constexpr Input<PackedNormalizedLandmarks> kInLandmarks{
+      "PACKED_NORM_LANDMARKS"};
+  static constexpr Output<NormalizedLandmarkList> kOutLandmarks{
+      "NORM_LANDMARKS"};
+  MEDIAPIPE_NODE_CONTRACT(kInLandmarks, kOutLandmarks);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kInLandmarks(cc).IsEmpty()) return absl::OkStatus();
+    kOutLandmarks(cc).Send(UnpackLandmarks(*kInLandmarks(cc)));
+    return absl::OkStatus();
+  }
+};
+MEDIAPIPE_REGISTER_NODE(PackedLandmarksToLandmarksCalculator);
+
+// Converts a NormalizedLandmarkList to PackedNormalizedLandmarks, where a
+// landmark pipeline working on packed landmarks starts.
+//
+// Inputs:
+//   NORM_LANDMARKS - NormalizedLandmarkList.
+// Outputs:
+//   PACKED_NORM_LANDMARKS - PackedNormalizedLandmarks.
+//
+// Example:
+// node {
+//   calculator: "LandmarksToPackedLandmarksCalculator"
+//   input_stream: "NORM_LANDMARKS:landmarks"
+//   output_stream: "PACKED_NORM_LANDMARKS:packed_landmarks"
+// }
+class LandmarksToPackedLandmarksCalculator : public Node {
+ public:
+  static constexpr Input<NormalizedLandmarkList> kInLandmarks{
+      "NORM_LANDMARKS"};
+  static constexpr Output<PackedNormalizedLandmarks> kOutLandmarks{
+      "PACKED_NORM_LANDMARKS"};
+  MEDIAPIPE_NODE_CONTRACT(kInLandmarks, kOutLandmarks);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kInLandmarks(cc).IsEmpty()) return absl::OkStatus();
+    kOutLandmarks(cc).Send(PackLandmarks(*kInLandmarks(cc)));
+    return absl::OkStatus();
+  }
+};
+MEDIAPIPE_REGISTER_NODE(LandmarksToPackedLandmarksCalculator);
+
+}  // namespace api2
+}  // namespace mediapipe
@@ -11,10 +11,11 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
-#include <cmath>
+#include <vector>
 
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/util/rect_batch.h"
 
 namespace mediapipe {
 
@@ -75,28 +76,14 @@ absl::Status RectProjectionCalculator::Process(CalculatorContext* cc) {
   const auto& reference_rect =
       cc->Inputs().Tag(kNormReferenceRectTag).Get<NormalizedRect>();
 
-  // Project center.
-  const float x = rect.x_center() - 0.5f;
-  const float y = rect.y_center() - 0.5f;
-  const float angle = reference_rect.rotation();
-  float new_x = std::cos(angle) * x - std::sin(angle) * y;
-  float new_y = std::sin(angle) * x + std::cos(angle) * y;
-  new_x = new_x * reference_rect.width() + reference_rect.x_center();
-  new_y = new_y * reference_rect.height() + reference_rect.y_center();
-
-  // Project size.
-  const float new_width = rect.width() * reference_rect.width();
-  const float new_height = rect.height() * reference_rect.height();
-
-  // Project rotation.
-  const float new_rotation = rect.rotation() + reference_rect.rotation();
-
+  RectBatch rects = PackRects(std::vector<NormalizedRect>{rect});
+  ProjectRects(reference_rect, &rects);
   auto new_rect = absl::make_unique<NormalizedRect>();
-  new_rect->set_x_center(new_x);
-  new_rect->set_y_center(new_y);
-  new_rect->set_width(new_width);
-  new_rect->set_height(new_height);
-  new_rect->set_rotation(new_rotation);
+  new_rect->set_x_center(rects.x_center[0]);
+  new_rect->set_y_center(rects.y_center[0]);
+  new_rect->set_width(rects.width[0]);
+  new_rect->set_height(rects.height[0]);
+  new_rect->set_rotation(rects.rotation[0]);
 
   cc->Outputs().Tag(kNormRectTag).Add(new_rect.release(), cc->InputTimestamp());
 
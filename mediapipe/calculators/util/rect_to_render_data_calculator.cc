@@ -17,6 +17,7 @@
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/render_commands.h"
 #include "mediapipe/util/render_data.pb.h"
 
 namespace mediapipe {
@@ -28,6 +29,7 @@ constexpr char kRectTag[] = "RECT";
 constexpr char kNormRectsTag[] = "NORM_RECTS";
 constexpr char kRectsTag[] = "RECTS";
 constexpr char kRenderDataTag[] = "RENDER_DATA";
+constexpr char kRenderCommandsTag[] = "RENDER_COMMANDS";
 
 RenderAnnotation::Rectangle* NewRect(
     const RectToRenderDataCalculatorOptions& options, RenderData* render_data) {
@@ -54,15 +56,22 @@ RenderAnnotation::Rectangle* NewRect(
              : annotation->mutable_rectangle();
 }
 
-void SetRect(bool normalized, double xmin, double ymin, double width,
-             double height, double rotation,
-             RenderAnnotation::Rectangle* rect) {
+// Returns whether the rectangle is known to be outside of the image.
+bool IsRectOutside(bool normalized, double xmin, double ymin, double width,
+                   double height, double rotation) {
   if (rotation == 0.0) {
-    if (xmin + width < 0.0 || ymin + height < 0.0) return;
+    if (xmin + width < 0.0 || ymin + height < 0.0) return true;
     if (normalized) {
-      if (xmin > 1.0 || ymin > 1.0) return;
+      if (xmin > 1.0 || ymin > 1.0) return true;
     }
   }
+  return false;
+}
+
+void SetRect(bool normalized, double xmin, double ymin, double width,
+             double height, double rotation,
+             RenderAnnotation::Rectangle* rect) {
+  if (IsRectOutside(normalized, xmin, ymin, width, height, rotation)) return;
   rect->set_normalized(normalized);
   rect->set_left(xmin);
   rect->set_top(ymin);
@@ -71,6 +80,72 @@ void SetRect(bool normalized, double xmin, double ymin, double width,
   rect->set_rotation(rotation);
 }
 
+void AddRect(const RectToRenderDataCalculatorOptions& options, bool normalized,
+             double xmin, double ymin, double width, double height,
+             double rotation, RenderData* render_data) {
+  SetRect(normalized, xmin, ymin, width, height, rotation,
+          NewRect(options, render_data));
+}
+
+void AddRect(const RectToRenderDataCalculatorOptions& options, bool normalized,
+             double xmin, double ymin, double width, double height,
+             double rotation, RenderCommands* render_commands) {
+  if (IsRectOutside(normalized, xmin, ymin, width, height, rotation)) return;
+  RenderCommands::Style style;
+  style.color = ToRgb(options.color());
+  style.thickness = options.thickness();
+  style.normalized = normalized;
+  render_commands->SetStyle(style);
+  if (options.oval()) {
+    render_commands->AddOval(xmin, ymin, xmin + width, ymin + height, rotation,
+                             options.filled());
+  } else {
+    render_commands->AddRectangle(xmin, ymin, xmin + width, ymin + height,
+                                  rotation, options.filled());
+  }
+}
+
+template <class OutputType>
+void AddInputRects(CalculatorContext* cc,
+                   const RectToRenderDataCalculatorOptions& options,
+                   OutputType* output) {
+  if (cc->Inputs().HasTag(kNormRectTag) &&
+      !cc->Inputs().Tag(kNormRectTag).IsEmpty()) {
+    const auto& rect = cc->Inputs().Tag(kNormRectTag).Get<NormalizedRect>();
+    AddRect(options, /*normalized=*/true, rect.x_center() - rect.width() / 2.f,
+            rect.y_center() - rect.height() / 2.f, rect.width(), rect.height(),
+            rect.rotation(), output);
+  }
+  if (cc->Inputs().HasTag(kRectTag) && !cc->Inputs().Tag(kRectTag).IsEmpty()) {
+    const auto& rect = cc->Inputs().Tag(kRectTag).Get<Rect>();
+    AddRect(options, /*normalized=*/false,
+            rect.x_center() - rect.width() / 2.f,
+            rect.y_center() - rect.height() / 2.f, rect.width(), rect.height(),
+            rect.rotation(), output);
+  }
+  if (cc->Inputs().HasTag(kNormRectsTag) &&
+      !cc->Inputs().Tag(kNormRectsTag).IsEmpty()) {
+    const auto& rects =
+        cc->Inputs().Tag(kNormRectsTag).Get<std::vector<NormalizedRect>>();
+    for (auto& rect : rects) {
+      AddRect(options, /*normalized=*/true,
+              rect.x_center() - rect.width() / 2.f,
+              rect.y_center() - rect.height() / 2.f, rect.width(),
+              rect.height(), rect.rotation(), output);
+    }
+  }
+  if (cc->Inputs().HasTag(kRectsTag) &&
+      !cc->Inputs().Tag(kRectsTag).IsEmpty()) {
+    const auto& rects = cc->Inputs().Tag(kRectsTag).Get<std::vector<Rect>>();
+    for (auto& rect : rects) {
+      AddRect(options, /*normalized=*/false,
+              rect.x_center() - rect.width() / 2.f,
+              rect.y_center() - rect.height() / 2.f, rect.width(),
+              rect.height(), rect.rotation(), output);
+    }
+  }
+}
+
 }  // namespace
 
 // Generates render data needed to render a rectangle in
@@ -84,7 +159,10 @@ void SetRect(bool normalized, double xmin, double ymin, double width,
 //   RECTS: An std::vector<Rect>
 //
 // Output:
+//   At least one of the following:
 //   RENDER_DATA: A RenderData
+//   RENDER_COMMANDS: The same rectangles as RenderCommands. Not supported
+//     with top_left_thickness.
 //
 // Example config:
 // node {
@@ -120,7 +198,9 @@ absl::Status RectToRenderDataCalculator::GetContract(CalculatorContract* cc) {
                1)
       << "Exactly one of NORM_RECT, RECT, NORM_RECTS or RECTS input stream "
          "should be provided.";
-  RET_CHECK(cc->Outputs().HasTag(kRenderDataTag));
+  RET_CHECK(cc->Outputs().HasTag(kRenderDataTag) ||
+            cc->Outputs().HasTag(kRenderCommandsTag))
+      << "At least one of RENDER_DATA and RENDER_COMMANDS must be output.";
 
   if (cc->Inputs().HasTag(kNormRectTag)) {
     cc->Inputs().Tag(kNormRectTag).Set<NormalizedRect>();
@@ -134,7 +214,12 @@ absl::Status RectToRenderDataCalculator::GetContract(CalculatorContract* cc) {
   if (cc->Inputs().HasTag(kRectsTag)) {
     cc->Inputs().Tag(kRectsTag).Set<std::vector<Rect>>();
   }
-  cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  if (cc->Outputs().HasTag(kRenderDataTag)) {
+    cc->Outputs().Tag(kRenderDataTag).Set<RenderData>();
+  }
+  if (cc->Outputs().HasTag(kRenderCommandsTag)) {
+    cc->Outputs().Tag(kRenderCommandsTag).Set<RenderCommands>();
+  }
 
   return absl::OkStatus();
 }
@@ -147,55 +232,29 @@ absl::Status RectToRenderDataCalculator::Open(CalculatorContext* cc) {
     // Filled and oval don't support top_left_thickness.
     RET_CHECK(!options_.filled());
     RET_CHECK(!options_.oval());
+    RET_CHECK(!cc->Outputs().HasTag(kRenderCommandsTag))
+        << "RENDER_COMMANDS doesn't support top_left_thickness.";
   }
 
   return absl::OkStatus();
 }
 
 absl::Status RectToRenderDataCalculator::Process(CalculatorContext* cc) {
-  auto render_data = absl::make_unique<RenderData>();
-
-  if (cc->Inputs().HasTag(kNormRectTag) &&
-      !cc->Inputs().Tag(kNormRectTag).IsEmpty()) {
-    const auto& rect = cc->Inputs().Tag(kNormRectTag).Get<NormalizedRect>();
-    auto* rectangle = NewRect(options_, render_data.get());
-    SetRect(/*normalized=*/true, rect.x_center() - rect.width() / 2.f,
-            rect.y_center() - rect.height() / 2.f, rect.width(), rect.height(),
-            rect.rotation(), rectangle);
-  }
-  if (cc->Inputs().HasTag(kRectTag) && !cc->Inputs().Tag(kRectTag).IsEmpty()) {
-    const auto& rect = cc->Inputs().Tag(kRectTag).Get<Rect>();
-    auto* rectangle = NewRect(options_, render_data.get());
-    SetRect(/*normalized=*/false, rect.x_center() - rect.width() / 2.f,
-            rect.y_center() - rect.height() / 2.f, rect.width(), rect.height(),
-            rect.rotation(), rectangle);
-  }
-  if (cc->Inputs().HasTag(kNormRectsTag) &&
-      !cc->Inputs().Tag(kNormRectsTag).IsEmpty()) {
-    const auto& rects =
-        cc->Inputs().Tag(kNormRectsTag).Get<std::vector<NormalizedRect>>();
-    for (auto& rect : rects) {
-      auto* rectangle = NewRect(options_, render_data.get());
-      SetRect(/*normalized=*/true, rect.x_center() - rect.width() / 2.f,
-              rect.y_center() - rect.height() / 2.f, rect.width(),
-              rect.height(), rect.rotation(), rectangle);
-    }
+  if (cc->Outputs().HasTag(kRenderDataTag)) {
+    auto render_data = absl::make_unique<RenderData>();
+    AddInputRects(cc, options_, render_data.get());
+    cc->Outputs()
+        .Tag(kRenderDataTag)
+        .Add(render_data.release(), cc->InputTimestamp());
   }
-  if (cc->Inputs().HasTag(kRectsTag) &&
-      !cc->Inputs().Tag(kRectsTag).IsEmpty()) {
-    const auto& rects = cc->Inputs().Tag(kRectsTag).Get<std::vector<Rect>>();
-    for (auto& rect : rects) {
-      auto* rectangle = NewRect(options_, render_data.get());
-      SetRect(/*normalized=*/false, rect.x_center() - rect.width() / 2.f,
-              rect.y_center() - rect.height() / 2.f, rect.width(),
-              rect.height(), rect.rotation(), rectangle);
-    }
+  if (cc->Outputs().HasTag(kRenderCommandsTag)) {
+    auto render_commands = absl::make_unique<RenderCommands>();
+    AddInputRects(cc, options_, render_commands.get());
+    cc->Outputs()
+        .Tag(kRenderCommandsTag)
+        .Add(render_commands.release(), cc->InputTimestamp());
   }
 
-  cc->Outputs()
-      .Tag(kRenderDataTag)
-      .Add(render_data.release(), cc->InputTimestamp());
-
   return absl::OkStatus();
 }
 
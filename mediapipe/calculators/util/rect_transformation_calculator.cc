@@ -11,12 +11,16 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
-#include <cmath>
+#include <utility>
+#include <vector>
 
 #include "mediapipe/calculators/util/rect_transformation_calculator.pb.h"
+#include "mediapipe/calculators/util/rect_transformation_util.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/util/rect_batch.h"
 
 namespace mediapipe {
 
@@ -28,11 +32,6 @@ constexpr char kRectTag[] = "RECT";
 constexpr char kRectsTag[] = "RECTS";
 constexpr char kImageSizeTag[] = "IMAGE_SIZE";
 
-// Wraps around an angle in radians to within -M_PI and M_PI.
-inline float NormalizeRadians(float angle) {
-  return angle - 2 * M_PI * std::floor((angle - (-M_PI)) / (2 * M_PI));
-}
-
 }  // namespace
 
 // Performs geometric transformation to the input Rect or NormalizedRect,
@@ -40,6 +39,9 @@ inline float NormalizeRadians(float angle) {
 // is NORM_RECT, an addition input stream IMAGE_SIZE is required, which is a
 // std::pair<int, int> representing the image width and height.
 //
+// The transformation is also applied by DetectionsToRectsCalculator when this
+// calculator only transforms its output, and the graph is fused.
+//
 // Example config:
 // node {
 //   calculator: "RectTransformationCalculator"
@@ -63,12 +65,13 @@ class RectTransformationCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) override;
 
  private:
-  RectTransformationCalculatorOptions options_;
+  // Transforms `rects` in an image of the given size, which is 1 x 1 for
+  // absolute rects.
+  template <class R>
+  std::vector<R> TransformRects(std::vector<R> rects, int image_width,
+                                int image_height);
 
-  float ComputeNewRotation(float rotation);
-  void TransformRect(Rect* rect);
-  void TransformNormalizedRect(NormalizedRect* rect, int image_width,
-                               int image_height);
+  RectTransform transform_;
 };
 REGISTER_CALCULATOR(RectTransformationCalculator);
 
@@ -105,140 +108,61 @@ absl::Status RectTransformationCalculator::GetContract(CalculatorContract* cc) {
 absl::Status RectTransformationCalculator::Open(CalculatorContext* cc) {
   cc->SetOffset(TimestampDiff(0));
 
-  options_ = cc->Options<RectTransformationCalculatorOptions>();
-  RET_CHECK(!(options_.has_rotation() && options_.has_rotation_degrees()));
-  RET_CHECK(!(options_.has_square_long() && options_.has_square_short()));
+  ASSIGN_OR_RETURN(
+      transform_,
+      GetRectTransform(cc->Options<RectTransformationCalculatorOptions>()));
 
   return absl::OkStatus();
 }
 
 absl::Status RectTransformationCalculator::Process(CalculatorContext* cc) {
   if (cc->Inputs().HasTag(kRectTag) && !cc->Inputs().Tag(kRectTag).IsEmpty()) {
-    auto rect = cc->Inputs().Tag(kRectTag).Get<Rect>();
-    TransformRect(&rect);
+    const auto& rect = cc->Inputs().Tag(kRectTag).Get<Rect>();
     cc->Outputs().Index(0).AddPacket(
-        MakePacket<Rect>(rect).At(cc->InputTimestamp()));
+        MakePacket<Rect>(std::move(TransformRects<Rect>({rect}, 1, 1)[0]))
+            .At(cc->InputTimestamp()));
   }
   if (cc->Inputs().HasTag(kRectsTag) &&
       !cc->Inputs().Tag(kRectsTag).IsEmpty()) {
-    auto rects = cc->Inputs().Tag(kRectsTag).Get<std::vector<Rect>>();
-    auto output_rects = absl::make_unique<std::vector<Rect>>(rects.size());
-    for (int i = 0; i < rects.size(); ++i) {
-      output_rects->at(i) = rects[i];
-      auto it = output_rects->begin() + i;
-      TransformRect(&(*it));
-    }
-    cc->Outputs().Index(0).Add(output_rects.release(), cc->InputTimestamp());
+    const auto& rects = cc->Inputs().Tag(kRectsTag).Get<std::vector<Rect>>();
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<std::vector<Rect>>(TransformRects(rects, 1, 1))
+            .At(cc->InputTimestamp()));
   }
   if (HasTagValue(cc->Inputs(), kNormRectTag) &&
       HasTagValue(cc->Inputs(), kImageSizeTag)) {
-    auto rect = cc->Inputs().Tag(kNormRectTag).Get<NormalizedRect>();
+    const auto& rect = cc->Inputs().Tag(kNormRectTag).Get<NormalizedRect>();
     const auto& image_size =
         cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
-    TransformNormalizedRect(&rect, image_size.first, image_size.second);
     cc->Outputs().Index(0).AddPacket(
-        MakePacket<NormalizedRect>(rect).At(cc->InputTimestamp()));
+        MakePacket<NormalizedRect>(
+            std::move(TransformRects<NormalizedRect>(
+                {rect}, image_size.first, image_size.second)[0]))
+            .At(cc->InputTimestamp()));
   }
   if (HasTagValue(cc->Inputs(), kNormRectsTag) &&
       HasTagValue(cc->Inputs(), kImageSizeTag)) {
-    auto rects =
+    const auto& rects =
         cc->Inputs().Tag(kNormRectsTag).Get<std::vector<NormalizedRect>>();
     const auto& image_size =
         cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
-    auto output_rects =
-        absl::make_unique<std::vector<NormalizedRect>>(rects.size());
-    for (int i = 0; i < rects.size(); ++i) {
-      output_rects->at(i) = rects[i];
-      auto it = output_rects->begin() + i;
-      TransformNormalizedRect(&(*it), image_size.first, image_size.second);
-    }
-    cc->Outputs().Index(0).Add(output_rects.release(), cc->InputTimestamp());
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<std::vector<NormalizedRect>>(
+            TransformRects(rects, image_size.first, image_size.second))
+            .At(cc->InputTimestamp()));
   }
 
   return absl::OkStatus();
 }
 
-float RectTransformationCalculator::ComputeNewRotation(float rotation) {
-  if (options_.has_rotation()) {
-    rotation += options_.rotation();
-  } else if (options_.has_rotation_degrees()) {
-    rotation += M_PI * options_.rotation_degrees() / 180.f;
-  }
-  return NormalizeRadians(rotation);
-}
-
-void RectTransformationCalculator::TransformRect(Rect* rect) {
-  float width = rect->width();
-  float height = rect->height();
-  float rotation = rect->rotation();
-
-  if (options_.has_rotation() || options_.has_rotation_degrees()) {
-    rotation = ComputeNewRotation(rotation);
-  }
-  if (rotation == 0.f) {
-    rect->set_x_center(rect->x_center() + width * options_.shift_x());
-    rect->set_y_center(rect->y_center() + height * options_.shift_y());
-  } else {
-    const float x_shift = width * options_.shift_x() * std::cos(rotation) -
-                          height * options_.shift_y() * std::sin(rotation);
-    const float y_shift = width * options_.shift_x() * std::sin(rotation) +
-                          height * options_.shift_y() * std::cos(rotation);
-    rect->set_x_center(rect->x_center() + x_shift);
-    rect->set_y_center(rect->y_center() + y_shift);
-  }
-
-  if (options_.square_long()) {
-    const float long_side = std::max(width, height);
-    width = long_side;
-    height = long_side;
-  } else if (options_.square_short()) {
-    const float short_side = std::min(width, height);
-    width = short_side;
-    height = short_side;
-  }
-  rect->set_width(width * options_.scale_x());
-  rect->set_height(height * options_.scale_y());
-}
-
-void RectTransformationCalculator::TransformNormalizedRect(NormalizedRect* rect,
-                                                           int image_width,
-                                                           int image_height) {
-  float width = rect->width();
-  float height = rect->height();
-  float rotation = rect->rotation();
-
-  if (options_.has_rotation() || options_.has_rotation_degrees()) {
-    rotation = ComputeNewRotation(rotation);
-  }
-  if (rotation == 0.f) {
-    rect->set_x_center(rect->x_center() + width * options_.shift_x());
-    rect->set_y_center(rect->y_center() + height * options_.shift_y());
-  } else {
-    const float x_shift =
-        (image_width * width * options_.shift_x() * std::cos(rotation) -
-         image_height * height * options_.shift_y() * std::sin(rotation)) /
-        image_width;
-    const float y_shift =
-        (image_width * width * options_.shift_x() * std::sin(rotation) +
-         image_height * height * options_.shift_y() * std::cos(rotation)) /
-        image_height;
-    rect->set_x_center(rect->x_center() + x_shift);
-    rect->set_y_center(rect->y_center() + y_shift);
-  }
-
-  if (options_.square_long()) {
-    const float long_side =
-        std::max(width * image_width, height * image_height);
-    width = long_side / image_width;
-    height = long_side / image_height;
-  } else if (options_.square_short()) {
-    const float short_side =
-        std::min(width * image_width, height * image_height);
-    width = short_side / image_width;
-    height = short_side / image_height;
-  }
-  rect->set_width(width * options_.scale_x());
-  rect->set_height(height * options_.scale_y());
+template <class R>
+std::vector<R> RectTransformationCalculator::TransformRects(
+    std::vector<R> rects, int image_width, int image_height) {
+  RectBatch batch = PackRects(rects);
+  ::mediapipe::TransformRects(transform_, image_width, image_height, &batch);
+  // Keeps the other fields of the rects, like their ids.
+  UnpackRects(batch, &rects);
+  return rects;
 }
 
 }  // namespace mediapipe
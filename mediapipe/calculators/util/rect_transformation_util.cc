@@ -0,0 +1,50 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/util/rect_transformation_util.h"
+
+#include <cmath>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/util/rect_transformation_calculator.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/util/rect_batch.h"
+
+namespace mediapipe {
+
+absl::StatusOr<RectTransform> GetRectTransform(
+    const RectTransformationCalculatorOptions& options) {
+  RET_CHECK(!(options.has_rotation() && options.has_rotation_degrees()));
+  RET_CHECK(!(options.has_square_long() && options.has_square_short()));
+  RectTransform transform;
+  if (options.has_rotation()) {
+    transform.rotate = true;
+    transform.rotation = options.rotation();
+  } else if (options.has_rotation_degrees()) {
+    transform.rotate = true;
+    transform.rotation = M_PI * options.rotation_degrees() / 180.f;
+  }
+  transform.shift_x = options.shift_x();
+  transform.shift_y = options.shift_y();
+  if (options.square_long()) {
+    transform.square = RectTransform::Square::kLong;
+  } else if (options.square_short()) {
+    transform.square = RectTransform::Square::kShort;
+  }
+  transform.scale_x = options.scale_x();
+  transform.scale_y = options.scale_y();
+  return transform;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,31 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_UTIL_RECT_TRANSFORMATION_UTIL_H_
+#define MEDIAPIPE_CALCULATORS_UTIL_RECT_TRANSFORMATION_UTIL_H_
+
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/util/rect_transformation_calculator.pb.h"
+#include "mediapipe/util/rect_batch.h"
+
+namespace mediapipe {
+
+// Returns the transformation of rects described by `options`, or an error if
+// the options are inconsistent.
+absl::StatusOr<RectTransform> GetRectTransform(
+    const RectTransformationCalculatorOptions& options);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_UTIL_RECT_TRANSFORMATION_UTIL_H_
@@ -14,15 +14,18 @@
 
 #include "mediapipe/calculators/util/refine_landmarks_from_heatmap_calculator.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include "mediapipe/calculators/util/refine_landmarks_from_heatmap_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/util/simd/simd.h"
 
 namespace mediapipe {
 
 namespace {
 
-inline float Sigmoid(float value) { return 1.0f / (1.0f + std::exp(-value)); }
-
 absl::StatusOr<std::tuple<int, int, int>> GetHwcFromDims(
     const std::vector<int>& dims) {
   if (dims.size() == 3) {
@@ -118,23 +121,60 @@ absl::StatusOr<mediapipe::NormalizedLandmarkList> RefineLandmarksFromHeatMap(
   int hm_row_size = hm_width * hm_channels;
   int hm_pixel_size = hm_channels;
 
-  mediapipe::NormalizedLandmarkList out_lms = in_lms;
-  for (int lm_index = 0; lm_index < out_lms.landmark_size(); ++lm_index) {
-    int center_col = out_lms.landmark(lm_index).x() * hm_width;
-    int center_row = out_lms.landmark(lm_index).y() * hm_height;
-    // Point is outside of the image let's keep it intact.
+  // Kernel windows are gathered into contiguous rows, one per landmark, so
+  // that the sigmoid runs over all of them in a single SIMD pass. Cells
+  // outside of the heatmap get a sigmoid of exactly 0, which is equivalent to
+  // a zero border.
+  const int offset = (kernel_size - 1) / 2;
+  const int window_width = 2 * offset + 1;
+  const int window_area = window_width * window_width;
+  const int num_landmarks = in_lms.landmark_size();
+  std::vector<float> confidences(num_landmarks * window_area,
+                                 std::numeric_limits<float>::lowest());
+  std::vector<int> center_cols(num_landmarks);
+  std::vector<int> center_rows(num_landmarks);
+  for (int lm_index = 0; lm_index < num_landmarks; ++lm_index) {
+    int center_col = in_lms.landmark(lm_index).x() * hm_width;
+    int center_row = in_lms.landmark(lm_index).y() * hm_height;
+    center_cols[lm_index] = center_col;
+    center_rows[lm_index] = center_row;
+    // Point is outside of the image, the window stays empty.
     if (center_col < 0 || center_col >= hm_width || center_row < 0 ||
-        center_col >= hm_height) {
+        center_row >= hm_height) {
       continue;
     }
-
-    int offset = (kernel_size - 1) / 2;
-    // Calculate area to iterate over. Note that we decrease the kernel on
-    // the edges of the heatmap. Equivalent to zero border.
     int begin_col = std::max(0, center_col - offset);
     int end_col = std::min(hm_width, center_col + offset + 1);
     int begin_row = std::max(0, center_row - offset);
     int end_row = std::min(hm_height, center_row + offset + 1);
+    float* window = &confidences[lm_index * window_area];
+    for (int row = begin_row; row < end_row; ++row) {
+      float* window_row =
+          window + (row - center_row + offset) * window_width - center_col +
+          offset;
+      for (int col = begin_col; col < end_col; ++col) {
+        // We expect memory to be in HWC layout without padding.
+        window_row[col] =
+            heatmap_raw_data[hm_row_size * row + hm_pixel_size * col +
+                             lm_index];
+      }
+    }
+  }
+  // Right now we hardcode sigmoid activation as it will be wasteful to
+  // calculate sigmoid for each value of heatmap in the model itself.  If
+  // we ever have other activations it should be trivial to expand via
+  // options.
+  simd::Sigmoid(confidences.data(), confidences.size());
+
+  mediapipe::NormalizedLandmarkList out_lms = in_lms;
+  for (int lm_index = 0; lm_index < num_landmarks; ++lm_index) {
+    const int center_col = center_cols[lm_index];
+    const int center_row = center_rows[lm_index];
+    // Point is outside of the image let's keep it intact.
+    if (center_col < 0 || center_col >= hm_width || center_row < 0 ||
+        center_row >= hm_height) {
+      continue;
+    }
 
     float sum = 0;
     float weighted_col = 0;
@@ -143,15 +183,12 @@ absl::StatusOr<mediapipe::NormalizedLandmarkList> RefineLandmarksFromHeatMap(
 
     // Main loop. Go over kernel and calculate weighted sum of coordinates,
     // sum of weights and max weights.
-    for (int row = begin_row; row < end_row; ++row) {
-      for (int col = begin_col; col < end_col; ++col) {
-        // We expect memory to be in HWC layout without padding.
-        int idx = hm_row_size * row + hm_pixel_size * col + lm_index;
-        // Right now we hardcode sigmoid activation as it will be wasteful to
-        // calculate sigmoid for each value of heatmap in the model itself.  If
-        // we ever have other activations it should be trivial to expand via
-        // options.
-        float confidence = Sigmoid(heatmap_raw_data[idx]);
+    const float* window = &confidences[lm_index * window_area];
+    for (int i = 0; i < window_width; ++i) {
+      const int row = center_row - offset + i;
+      for (int j = 0; j < window_width; ++j) {
+        const int col = center_col - offset + j;
+        const float confidence = window[i * window_width + j];
         sum += confidence;
         max_confidence_value = std::max(max_confidence_value, confidence);
         weighted_col += col * confidence;
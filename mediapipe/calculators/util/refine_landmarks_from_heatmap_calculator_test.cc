@@ -14,6 +14,8 @@
 
 #include "mediapipe/calculators/util/refine_landmarks_from_heatmap_calculator.h"
 
+#include <cmath>
+
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/status_matchers.h"
@@ -59,6 +61,7 @@ std::vector<float> CHW_to_HWC(std::vector<float> inp, int height, int width,
 
 using testing::ElementsAre;
 using testing::FloatEq;
+using testing::FloatNear;
 using testing::Pair;
 
 TEST(RefineLandmarksFromHeatmapTest, Smoke) {
@@ -149,5 +152,30 @@ TEST(RefineLandmarksFromHeatmapTest, Border) {
                           Pair(FloatEq(2 / 3.), FloatEq(1 / 6. + 2 / 6.))));
 }
 
+TEST(RefineLandmarksFromHeatmapTest, MatchesExactSigmoid) {
+  // A 5x5 kernel covers more values than a SIMD register holds.
+  constexpr int kSize = 5;
+  std::vector<float> hm(kSize * kSize);
+  float sum = 0, weighted_col = 0, weighted_row = 0;
+  for (int row = 0; row < kSize; ++row) {
+    for (int col = 0; col < kSize; ++col) {
+      const float value = (row * kSize + col) * 0.7f - 8.0f;
+      hm[row * kSize + col] = value;
+      const float confidence = 1.0f / (1.0f + std::exp(-value));
+      sum += confidence;
+      weighted_col += col * confidence;
+      weighted_row += row * confidence;
+    }
+  }
+
+  auto ret_or_error =
+      RefineLandmarksFromHeatMap(vec_to_lms({{0.5, 0.5}}), hm.data(),
+                                 {kSize, kSize, 1}, kSize, 0.1, true, true);
+  MP_EXPECT_OK(ret_or_error);
+  EXPECT_THAT(lms_to_vec(*ret_or_error),
+              ElementsAre(Pair(FloatNear(weighted_col / kSize / sum, 1e-6),
+                               FloatNear(weighted_row / kSize / sum, 1e-6))));
+}
+
 }  // namespace
 }  // namespace mediapipe
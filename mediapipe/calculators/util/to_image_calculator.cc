@@ -81,6 +81,7 @@ absl::Status ToImageCalculator::UpdateContract(CalculatorContract* cc) {
   if (num_inputs != 1) {
     return absl::InternalError("Cannot have multiple inputs.");
   }
+  cc->SetPure(true);
 
   return absl::OkStatus();
 }
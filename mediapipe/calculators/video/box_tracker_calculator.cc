@@ -14,10 +14,14 @@
 
 #include <stdio.h>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
@@ -1175,40 +1179,77 @@ void BoxTrackerCalculator::StreamTrack(const TrackingData& data,
     actively_discarded_tracked_ids_.insert(discarded_id);
   }
 
+  const int from_frame = data_frame_num - (forward ? 1 : 0);
+  const int to_frame = forward ? from_frame + 1 : from_frame - 1;
+
+  // Tracking only uses the motion vectors around each box, so only the ones
+  // within the union of these regions are extracted.
+  std::vector<std::pair<int, MotionBoxPath*>> boxes;
+  std::vector<MotionBox*> motion_boxes;
+  Vector2_f region_top_left(std::numeric_limits<float>::max(),
+                            std::numeric_limits<float>::max());
+  Vector2_f region_bottom_right(std::numeric_limits<float>::lowest(),
+                                std::numeric_limits<float>::lowest());
+  for (auto& motion_box : *box_map) {
+    boxes.emplace_back(motion_box.first, &motion_box.second);
+    motion_boxes.push_back(&motion_box.second.box);
+    Vector2_f top_left, bottom_right;
+    if (motion_box.second.box.TrackStepRegion(
+            from_frame, data.frame_aspect(), &top_left, &bottom_right)) {
+      region_top_left = Vector2_f(std::min(region_top_left.x(), top_left.x()),
+                                  std::min(region_top_left.y(), top_left.y()));
+      region_bottom_right =
+          Vector2_f(std::max(region_bottom_right.x(), bottom_right.x()),
+                    std::max(region_bottom_right.y(), bottom_right.y()));
+    }
+  }
+
   // Track all existing boxes by one frame.
   MotionVectorFrame mvf;  // Holds motion from current to previous frame.
-  MotionVectorFrameFromTrackingData(data, &mvf);
-  mvf.actively_discarded_tracked_ids = &actively_discarded_tracked_ids_;
-
   if (forward) {
-    MotionVectorFrame mvf_inverted;
-    InvertMotionVectorFrame(mvf, &mvf_inverted);
-    std::swap(mvf, mvf_inverted);
+    // Vectors move by inversion, so the region applies to the inverted ones.
+    MotionVectorFrame mvf_backward;
+    MotionVectorFrameFromTrackingData(data, &mvf_backward);
+    InvertMotionVectorFrame(mvf_backward, region_top_left, region_bottom_right,
+                            &mvf);
+  } else {
+    MotionVectorFrameFromTrackingData(data, region_top_left,
+                                      region_bottom_right, &mvf);
   }
+  mvf.actively_discarded_tracked_ids = &actively_discarded_tracked_ids_;
 
   if (duration_ms > 0) {
     mvf.duration_ms = duration_ms;
   }
 
-  const int from_frame = data_frame_num - (forward ? 1 : 0);
-  const int to_frame = forward ? from_frame + 1 : from_frame - 1;
+  // All boxes are tracked in one parallel pass, results are stored in order.
+  const std::vector<int> failed_boxes =
+      TrackStepBatch(from_frame, mvf, forward, motion_boxes);
+  if (!boxes.empty()) {
+    // All boxes have seen the discarded ids of this frame.
+    actively_discarded_tracked_ids_.clear();
+  }
 
-  for (auto& motion_box : *box_map) {
-    if (!motion_box.second.box.TrackStep(from_frame,  // from frame.
-                                         mvf, forward)) {
-      failed_ids->push_back(motion_box.first);
-      LOG(INFO) << "lost track. pushed failed id: " << motion_box.first;
+  std::vector<bool> failed(boxes.size(), false);
+  for (const int k : failed_boxes) {
+    failed[k] = true;
+  }
+  for (int k = 0; k < boxes.size(); ++k) {
+    MotionBoxPath& motion_box = *boxes[k].second;
+    if (failed[k]) {
+      failed_ids->push_back(boxes[k].first);
+      LOG(INFO) << "lost track. pushed failed id: " << boxes[k].first;
     } else {
       // Store result.
-      PathSegment& path = motion_box.second.path;
+      PathSegment& path = motion_box.path;
       const MotionBoxState& result_state =
-          motion_box.second.box.StateAtFrame(to_frame);
+          motion_box.box.StateAtFrame(to_frame);
       AddStateToPath(result_state, dst_timestamp_ms, &path);
       // motion_box has got new tracking state/path. Now trimming it.
       const int cache_size =
           std::max(options_.streaming_track_data_cache_size(),
                    kMotionBoxPathMinQueueSize);
-      motion_box.second.Trim(cache_size, forward);
+      motion_box.Trim(cache_size, forward);
     }
   }
 }
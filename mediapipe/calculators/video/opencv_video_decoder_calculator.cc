@@ -14,6 +14,11 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mediapipe/calculators/video/opencv_video_decoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -21,6 +26,7 @@
 #include "mediapipe/framework/formats/video_stream_header.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/tool/status_util.h"
 
@@ -75,6 +81,25 @@ ImageFormat::Format GetImageFormat(int num_channels) {
 //   output_stream: "VIDEO_PRESTREAM:video_header"
 // }
 //
+// The calculator can also decode on a hardware accelerator if the OpenCV
+// backend supports it, drop frames to lower the frame rate, and output only a
+// time range of the video. See OpenCvVideoDecoderCalculatorOptions.
+//
+// Example config:
+// node {
+//   calculator: "OpenCvVideoDecoderCalculator"
+//   input_side_packet: "INPUT_FILE_PATH:input_file_path"
+//   output_stream: "VIDEO:video_frames"
+//   options {
+//     [mediapipe.OpenCvVideoDecoderCalculatorOptions.ext] {
+//       hardware_acceleration: true
+//       frame_rate: 5
+//       start_time: 10000000
+//       end_time: 20000000
+//     }
+//   }
+// }
+//
 // OpenCV's VideoCapture doesn't decode audio tracks. If the audio tracks need
 // to be saved, specify an output side packet with tag "SAVED_AUDIO_PATH".
 // The calculator will call FFmpeg binary to save audio tracks as an aac file.
@@ -105,9 +130,23 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   }
 
   absl::Status Open(CalculatorContext* cc) override {
+    const auto& options = cc->Options<OpenCvVideoDecoderCalculatorOptions>();
     const std::string& input_file_path =
         cc->InputSidePackets().Tag(kInputFilePathTag).Get<std::string>();
-    cap_ = absl::make_unique<cv::VideoCapture>(input_file_path);
+    if (options.hardware_acceleration()) {
+#ifdef MEDIAPIPE_OPENCV_VIDEO_HW_ACCELERATION
+      cap_ = absl::make_unique<cv::VideoCapture>(
+          input_file_path, cv::CAP_ANY,
+          std::vector<int>{cv::CAP_PROP_HW_ACCELERATION,
+                           cv::VIDEO_ACCELERATION_ANY});
+#else
+      LOG(WARNING) << "Hardware accelerated decoding requires OpenCV 4.5.2 or "
+                      "later, decoding in software.";
+#endif
+    }
+    if (!cap_) {
+      cap_ = absl::make_unique<cv::VideoCapture>(input_file_path);
+    }
     if (!cap_->isOpened()) {
       return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
              << "Fail to open video file at " << input_file_path;
@@ -139,11 +178,31 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
                 "the video file at "
              << input_file_path;
     }
+    RET_CHECK(options.end_time() <= 0 ||
+              options.end_time() > options.start_time())
+        << "end_time must be greater than start_time.";
+    all_frames_ = options.frame_rate() <= 0 && options.start_time() <= 0 &&
+                  options.end_time() <= 0;
+    // A frame is output if it is less than half a frame interval before the
+    // next output time.
+    frame_tolerance_us_ = 0.5e6 / fps;
+    output_period_us_ =
+        options.frame_rate() > 0 ? 1e6 / options.frame_rate() : 0;
+    start_time_us_ = options.start_time();
+    end_timestamp_ = options.end_time() > 0 ? Timestamp(options.end_time())
+                                            : Timestamp::Max();
+    if (start_time_us_ > 0) {
+      next_timestamp_ =
+          Timestamp(std::llround(start_time_us_ - frame_tolerance_us_));
+    }
+
     auto header = absl::make_unique<VideoHeader>();
     header->format = format_;
     header->width = width_;
     header->height = height_;
-    header->frame_rate = fps;
+    header->frame_rate = output_period_us_ > 0
+                             ? std::min(fps, options.frame_rate())
+                             : fps;
     header->duration = frame_count_ / fps;
 
     if (cc->Outputs().HasTag(kVideoPrestreamTag)) {
@@ -152,8 +211,11 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
           .Add(header.release(), Timestamp::PreStream());
       cc->Outputs().Tag(kVideoPrestreamTag).Close();
     }
-    // Rewind to the very first frame.
+    // Rewind to the very first frame, or seek to the start time.
     cap_->set(cv::CAP_PROP_POS_AVI_RATIO, 0);
+    if (start_time_us_ > 0) {
+      cap_->set(cv::CAP_PROP_POS_MSEC, start_time_us_ / 1000.0);
+    }
 
     if (cc->OutputSidePackets().HasTag(kSavedAudioPathTag)) {
 #ifdef HAVE_FFMPEG
@@ -187,10 +249,21 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    auto image_frame = absl::make_unique<ImageFrame>(format_, width_, height_,
-                                                     /*alignment_boundary=*/1);
     // Use microsecond as the unit of time.
     Timestamp timestamp(cap_->get(cv::CAP_PROP_POS_MSEC) * 1000);
+    // Frames before the next output time are only grabbed, which decodes them
+    // as needed for the following frames but skips their conversion.
+    while (timestamp < next_timestamp_) {
+      if (!GrabFrame()) {
+        return tool::StatusStop();
+      }
+      timestamp = Timestamp(cap_->get(cv::CAP_PROP_POS_MSEC) * 1000);
+    }
+    if (timestamp > end_timestamp_) {
+      return tool::StatusStop();
+    }
+    auto image_frame = absl::make_unique<ImageFrame>(format_, width_, height_,
+                                                     /*alignment_boundary=*/1);
     if (format_ == ImageFormat::GRAY8) {
       cv::Mat frame = formats::MatView(image_frame.get());
       ReadFrame(frame);
@@ -217,6 +290,16 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
       cc->Outputs().Tag(kVideoTag).Add(image_frame.release(), timestamp);
       prev_timestamp_ = timestamp;
       decoded_frames_++;
+      if (output_period_us_ > 0) {
+        // Output times are aligned to the start time so that rounding doesn't
+        // accumulate.
+        const double elapsed_us = timestamp.Value() - start_time_us_;
+        const double next_index =
+            std::round(elapsed_us / output_period_us_) + 1;
+        next_timestamp_ = Timestamp(std::llround(
+            start_time_us_ + next_index * output_period_us_ -
+            frame_tolerance_us_));
+      }
     }
 
     return absl::OkStatus();
@@ -226,7 +309,7 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
     if (cap_ && cap_->isOpened()) {
       cap_->release();
     }
-    if (decoded_frames_ != frame_count_) {
+    if (all_frames_ && decoded_frames_ != frame_count_) {
       LOG(WARNING) << "Not all the frames are decoded (total frames: "
                    << frame_count_ << " vs decoded frames: " << decoded_frames_
                    << ").";
@@ -242,6 +325,8 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
     }
   }
 
+  bool GrabFrame() { return cap_->grab() || cap_->grab(); }
+
  private:
   std::unique_ptr<cv::VideoCapture> cap_;
   int width_;
@@ -250,6 +335,14 @@ class OpenCvVideoDecoderCalculator : public CalculatorBase {
   int decoded_frames_ = 0;
   ImageFormat::Format format_;
   Timestamp prev_timestamp_ = Timestamp::Unset();
+  // Whether all the frames of the video are expected to be output.
+  bool all_frames_ = true;
+  double frame_tolerance_us_ = 0;
+  // The interval between output frames if frames are dropped, or 0.
+  double output_period_us_ = 0;
+  double start_time_us_ = 0;
+  Timestamp next_timestamp_ = Timestamp::Min();
+  Timestamp end_timestamp_ = Timestamp::Max();
 };
 
 REGISTER_CALCULATOR(OpenCvVideoDecoderCalculator);
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "mediapipe/calculators/video/opencv_video_decoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -168,5 +169,38 @@ TEST(OpenCvVideoDecoderCalculatorTest, TestMkvVp8Video) {
   }
 }
 
+TEST(OpenCvVideoDecoderCalculatorTest, DropsFramesInTimeRange) {
+  CalculatorGraphConfig::Node node_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+        calculator: "OpenCvVideoDecoderCalculator"
+        input_side_packet: "INPUT_FILE_PATH:input_file_path"
+        output_stream: "VIDEO:video"
+        output_stream: "VIDEO_PRESTREAM:video_prestream"
+        options {
+          [mediapipe.OpenCvVideoDecoderCalculatorOptions.ext] {
+            frame_rate: 10
+            start_time: 1000000
+            end_time: 3000000
+          }
+        })pb");
+  CalculatorRunner runner(node_config);
+  runner.MutableSidePackets()->Tag(kInputFilePathTag) =
+      MakePacket<std::string>(file::JoinPath(GetTestDataDir(kTestPackageRoot),
+                                             "format_MP4_AVC720P_AAC.video"));
+  MP_EXPECT_OK(runner.Run());
+
+  const VideoHeader& header =
+      runner.Outputs().Tag(kVideoPrestreamTag).packets[0].Get<VideoHeader>();
+  EXPECT_FLOAT_EQ(10.0f, header.frame_rate);
+  // Every third frame of the 30 fps video from 1 to 3 seconds.
+  const auto& packets = runner.Outputs().Tag(kVideoTag).packets;
+  EXPECT_GE(packets.size(), 20);
+  EXPECT_LE(packets.size(), 21);
+  for (int i = 0; i < packets.size(); ++i) {
+    EXPECT_NEAR(packets[i].Timestamp().Value(), 1000000 + i * 100000, 20000);
+    EXPECT_EQ(1280, packets[i].Get<ImageFrame>().Width());
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -14,11 +14,14 @@
 
 #include <stdlib.h>
 
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/calculators/video/opencv_video_encoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
@@ -32,6 +35,7 @@
 #include "mediapipe/framework/port/source_location.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/framework/tool/status_util.h"
 
 namespace mediapipe {
@@ -60,6 +64,11 @@ constexpr char kVideoTag[] = "VIDEO";
 //   }
 // }
 //
+// By default, frames are converted and encoded on a dedicated thread, so that
+// encoding doesn't hold up the scheduler thread. Process only blocks when
+// OpenCvVideoEncoderCalculatorOptions.max_queued_frames frames are waiting to
+// be encoded, and Close waits until all of them are written.
+//
 // OpenCV's VideoWriter doesn't encode audio. If an input side packet with tag
 // "AUDIO_FILE_PATH" is specified, the calculator will call FFmpeg binary to
 // attach the audio file to the video as the last step in Close().
@@ -81,6 +90,8 @@ constexpr char kVideoTag[] = "VIDEO";
 //
 class OpenCvVideoEncoderCalculator : public CalculatorBase {
  public:
+  ~OpenCvVideoEncoderCalculator() override { StopEncodingThread(); }
+
   static absl::Status GetContract(CalculatorContract* cc);
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
@@ -88,10 +99,24 @@ class OpenCvVideoEncoderCalculator : public CalculatorBase {
 
  private:
   absl::Status SetUpVideoWriter(float frame_rate, int width, int height);
+  // Converts the frame to BGR and writes it to the video.
+  void WriteFrame(const ImageFrame& image_frame);
+  // Writes the queued frames until the queue is empty and the calculator is
+  // closing. Runs on the encoding thread.
+  void EncodeUntilDone();
+  // Waits until the queued frames are written and joins the encoding thread.
+  void StopEncodingThread();
 
   std::string output_file_path_;
   int four_cc_;
+  bool hardware_acceleration_ = false;
   std::unique_ptr<cv::VideoWriter> writer_;
+
+  int max_queued_frames_ = 0;
+  std::unique_ptr<ThreadPool> encoding_thread_;
+  absl::Mutex mutex_;
+  std::deque<Packet> queued_frames_ ABSL_GUARDED_BY(mutex_);
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
 };
 
 absl::Status OpenCvVideoEncoderCalculator::GetContract(CalculatorContract* cc) {
@@ -128,13 +153,22 @@ absl::Status OpenCvVideoEncoderCalculator::Open(CalculatorContext* cc) {
             splited_file_path[splited_file_path.size() - 1] ==
                 options.video_format())
       << "The output file path is invalid.";
+  hardware_acceleration_ = options.hardware_acceleration();
   // If the video header will be available, the video metadata will be fetched
   // from the video header directly. The calculator will receive the video
   // header packet at timestamp prestream.
-  if (cc->Inputs().HasTag(kVideoPrestreamTag)) {
-    return absl::OkStatus();
+  if (!cc->Inputs().HasTag(kVideoPrestreamTag)) {
+    MP_RETURN_IF_ERROR(
+        SetUpVideoWriter(options.fps(), options.width(), options.height()));
+  }
+  max_queued_frames_ = options.max_queued_frames();
+  if (max_queued_frames_ > 0) {
+    encoding_thread_ =
+        std::make_unique<ThreadPool>("mediapipe_video_encoder", 1);
+    encoding_thread_->StartWorkers();
+    encoding_thread_->Schedule([this] { EncodeUntilDone(); });
   }
-  return SetUpVideoWriter(options.fps(), options.width(), options.height());
+  return absl::OkStatus();
 }
 
 absl::Status OpenCvVideoEncoderCalculator::Process(CalculatorContext* cc) {
@@ -145,40 +179,73 @@ absl::Status OpenCvVideoEncoderCalculator::Process(CalculatorContext* cc) {
                             video_header.height);
   }
 
-  const ImageFrame& image_frame =
-      cc->Inputs().Tag(kVideoTag).Value().Get<ImageFrame>();
-  ImageFormat::Format format = image_frame.Format();
+  const Packet& packet = cc->Inputs().Tag(kVideoTag).Value();
+  const ImageFrame& image_frame = packet.Get<ImageFrame>();
+  const ImageFormat::Format format = image_frame.Format();
+  if (format != ImageFormat::GRAY8 && format != ImageFormat::SRGB &&
+      format != ImageFormat::SRGBA) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Unsupported image format: " << format;
+  }
+  if (formats::MatView(&image_frame).empty()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Receive empty frame at timestamp " << packet.Timestamp()
+           << " in OpenCvVideoEncoderCalculator::Process()";
+  }
+  if (!encoding_thread_) {
+    WriteFrame(image_frame);
+    return absl::OkStatus();
+  }
+  // The queue holds the packet, which keeps the frame alive without a copy.
+  auto has_room = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return static_cast<int>(queued_frames_.size()) < max_queued_frames_;
+  };
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(&has_room));
+  queued_frames_.push_back(packet);
+  return absl::OkStatus();
+}
+
+void OpenCvVideoEncoderCalculator::WriteFrame(const ImageFrame& image_frame) {
   cv::Mat frame;
-  if (format == ImageFormat::GRAY8) {
+  if (image_frame.Format() == ImageFormat::GRAY8) {
     frame = formats::MatView(&image_frame);
-    if (frame.empty()) {
-      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Receive empty frame at timestamp "
-             << cc->Inputs().Tag(kVideoTag).Value().Timestamp()
-             << " in OpenCvVideoEncoderCalculator::Process()";
-    }
+  } else if (image_frame.Format() == ImageFormat::SRGB) {
+    cv::cvtColor(formats::MatView(&image_frame), frame, cv::COLOR_RGB2BGR);
   } else {
-    cv::Mat tmp_frame = formats::MatView(&image_frame);
-    if (tmp_frame.empty()) {
-      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Receive empty frame at timestamp "
-             << cc->Inputs().Tag(kVideoTag).Value().Timestamp()
-             << " in OpenCvVideoEncoderCalculator::Process()";
-    }
-    if (format == ImageFormat::SRGB) {
-      cv::cvtColor(tmp_frame, frame, cv::COLOR_RGB2BGR);
-    } else if (format == ImageFormat::SRGBA) {
-      cv::cvtColor(tmp_frame, frame, cv::COLOR_RGBA2BGR);
-    } else {
-      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Unsupported image format: " << format;
-    }
+    cv::cvtColor(formats::MatView(&image_frame), frame, cv::COLOR_RGBA2BGR);
   }
   writer_->write(frame);
-  return absl::OkStatus();
+}
+
+void OpenCvVideoEncoderCalculator::EncodeUntilDone() {
+  auto has_work = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !queued_frames_.empty() || done_;
+  };
+  absl::MutexLock lock(&mutex_);
+  while (true) {
+    mutex_.Await(absl::Condition(&has_work));
+    if (queued_frames_.empty()) return;
+    Packet packet = std::move(queued_frames_.front());
+    queued_frames_.pop_front();
+    mutex_.Unlock();
+    WriteFrame(packet.Get<ImageFrame>());
+    mutex_.Lock();
+  }
+}
+
+void OpenCvVideoEncoderCalculator::StopEncodingThread() {
+  if (!encoding_thread_) return;
+  {
+    absl::MutexLock lock(&mutex_);
+    done_ = true;
+  }
+  // Joins the encoding thread once the queue is drained.
+  encoding_thread_.reset();
 }
 
 absl::Status OpenCvVideoEncoderCalculator::Close(CalculatorContext* cc) {
+  StopEncodingThread();
   if (writer_ && writer_->isOpened()) {
     writer_->release();
   }
@@ -218,8 +285,21 @@ absl::Status OpenCvVideoEncoderCalculator::SetUpVideoWriter(float frame_rate,
   RET_CHECK(frame_rate > 0 && width > 0 && height > 0)
       << "Invalid video metadata: frame_rate=" << frame_rate
       << ", width=" << width << ", height=" << height;
-  writer_ = absl::make_unique<cv::VideoWriter>(
-      output_file_path_, four_cc_, frame_rate, cv::Size(width, height));
+  if (hardware_acceleration_) {
+#ifdef MEDIAPIPE_OPENCV_VIDEO_HW_ACCELERATION
+    writer_ = absl::make_unique<cv::VideoWriter>(
+        output_file_path_, four_cc_, frame_rate, cv::Size(width, height),
+        std::vector<int>{cv::VIDEOWRITER_PROP_HW_ACCELERATION,
+                         cv::VIDEO_ACCELERATION_ANY});
+#else
+    LOG(WARNING) << "Hardware accelerated encoding requires OpenCV 4.5.2 or "
+                    "later, encoding in software.";
+#endif
+  }
+  if (!writer_) {
+    writer_ = absl::make_unique<cv::VideoWriter>(
+        output_file_path_, four_cc_, frame_rate, cv::Size(width, height));
+  }
   if (!writer_->isOpened()) {
     return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
            << "Fail to open file at " << output_file_path_;
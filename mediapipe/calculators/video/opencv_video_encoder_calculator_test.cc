@@ -221,5 +221,49 @@ TEST(OpenCvVideoEncoderCalculatorTest, TestMkvVp8Video) {
                                         cap.get(cv::CAP_PROP_FPS))));
 }
 
+TEST(OpenCvVideoEncoderCalculatorTest, WritesAllQueuedFrames) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node {
+          calculator: "OpenCvVideoDecoderCalculator"
+          input_side_packet: "INPUT_FILE_PATH:input_file_path"
+          output_stream: "VIDEO:video"
+          output_stream: "VIDEO_PRESTREAM:video_prestream"
+        }
+        node {
+          calculator: "OpenCvVideoEncoderCalculator"
+          input_stream: "VIDEO:video"
+          input_stream: "VIDEO_PRESTREAM:video_prestream"
+          input_side_packet: "OUTPUT_FILE_PATH:output_file_path"
+          node_options {
+            [type.googleapis.com/
+             mediapipe.OpenCvVideoEncoderCalculatorOptions]: {
+              codec: "MJPG"
+              video_format: "avi"
+              max_queued_frames: 1
+            }
+          }
+        }
+      )pb");
+  std::map<std::string, Packet> input_side_packets;
+  input_side_packets["input_file_path"] =
+      MakePacket<std::string>(file::JoinPath(GetTestDataDir(kTestPackageRoot),
+                                             "format_FLV_H264_AAC.video"));
+  const std::string output_file_path = "/tmp/tmp_queued_video.avi";
+  DeletingFile deleting_file(output_file_path, true);
+  input_side_packets["output_file_path"] =
+      MakePacket<std::string>(output_file_path);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config, input_side_packets));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  // Close waits for the encoding thread, so all the decoded frames are in the
+  // file.
+  cv::VideoCapture cap(output_file_path);
+  ASSERT_TRUE(cap.isOpened());
+  EXPECT_EQ(180, static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT)));
+}
+
 }  // namespace
 }  // namespace mediapipe
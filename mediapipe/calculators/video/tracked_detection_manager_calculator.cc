@@ -264,8 +264,8 @@ absl::Status TrackedDetectionManagerCalculator::Process(CalculatorContext* cc) {
     auto output_detections = absl::make_unique<std::vector<Detection>>();
     auto output_boxes = absl::make_unique<std::vector<NormalizedRect>>();
 
-    for (const auto& detection_ptr : all_detections) {
-      const auto& detection = *detection_ptr.second;
+    for (const TrackedDetection* detection_ptr : all_detections) {
+      const auto& detection = *detection_ptr;
       // Only output detections that are synced.
       if (detection.last_updated_timestamp() <
           cc->InputTimestamp().Microseconds() / 1000) {
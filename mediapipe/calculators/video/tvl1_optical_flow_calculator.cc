@@ -14,12 +14,18 @@
 
 #include "absl/base/macros.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/video/tvl1_optical_flow_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/motion/optical_flow_field.h"
 #include "mediapipe/framework/port/opencv_video_inc.h"
 
+// cv::DISOpticalFlow is part of the video module since OpenCV 4.
+#if !defined(CV_VERSION_EPOCH) && CV_VERSION_MAJOR >= 4
+#define MEDIAPIPE_TVL1_HAS_DIS 1
+#endif
+
 namespace mediapipe {
 namespace {
 
@@ -46,7 +52,9 @@ cv::Mat ConvertToGrayscale(const cv::Mat& image) {
 }  // namespace
 
 // Calls OpenCV's DenseOpticalFlow to compute the optical flow between a pair of
-// image frames. The calculator can output forward flow fields (optical flow
+// image frames. The algorithm is TV-L1 by default; set
+// Tvl1OpticalFlowCalculatorOptions.algorithm to DIS for a much faster dense
+// inverse search flow, optionally warm-started from the previous flow. The calculator can output forward flow fields (optical flow
 // from the first frame to the second frame), backward flow fields (optical flow
 // from the second frame to the first frame), or both, depending on the tag of
 // the specified output streams. Note that the timestamp of the output optical
@@ -86,9 +94,17 @@ class Tvl1OpticalFlowCalculator : public CalculatorBase {
  private:
   absl::Status CalculateOpticalFlow(const ImageFrame& current_frame,
                                     const ImageFrame& next_frame,
-                                    OpticalFlowField* flow);
+                                    bool forward, OpticalFlowField* flow);
+  cv::Ptr<cv::DenseOpticalFlow> CreateFlowComputer() const;
+
+  Tvl1OpticalFlowCalculatorOptions options_;
   bool forward_requested_ = false;
   bool backward_requested_ = false;
+  // The latest flows in each direction, which initialize the next flows if
+  // warm_start is enabled. They share the data of the output flow fields,
+  // which are not modified after they are sent.
+  cv::Mat previous_forward_flow_ ABSL_GUARDED_BY(mutex_);
+  cv::Mat previous_backward_flow_ ABSL_GUARDED_BY(mutex_);
   // Stores the idle DenseOpticalFlow objects.
   // cv::DenseOpticalFlow is not thread-safe. Invoking multiple
   // DenseOpticalFlow::calc() in parallel may lead to memory corruption or
@@ -117,9 +133,15 @@ absl::Status Tvl1OpticalFlowCalculator::GetContract(CalculatorContract* cc) {
 }
 
 absl::Status Tvl1OpticalFlowCalculator::Open(CalculatorContext* cc) {
+  options_ = cc->Options<Tvl1OpticalFlowCalculatorOptions>();
+#if !MEDIAPIPE_TVL1_HAS_DIS
+  if (options_.algorithm() == Tvl1OpticalFlowCalculatorOptions::DIS) {
+    return absl::UnimplementedError("DIS optical flow requires OpenCV 4.");
+  }
+#endif  // !MEDIAPIPE_TVL1_HAS_DIS
   {
     absl::MutexLock lock(&mutex_);
-    tvl1_computers_.emplace_back(cv::createOptFlow_DualTVL1());
+    tvl1_computers_.emplace_back(CreateFlowComputer());
   }
   if (cc->Outputs().HasTag(kForwardFlowTag)) {
     forward_requested_ = true;
@@ -139,6 +161,7 @@ absl::Status Tvl1OpticalFlowCalculator::Process(CalculatorContext* cc) {
   if (forward_requested_) {
     auto forward_optical_flow_field = absl::make_unique<OpticalFlowField>();
     MP_RETURN_IF_ERROR(CalculateOpticalFlow(first_frame, second_frame,
+                                            /*forward=*/true,
                                             forward_optical_flow_field.get()));
     cc->Outputs()
         .Tag(kForwardFlowTag)
@@ -147,6 +170,7 @@ absl::Status Tvl1OpticalFlowCalculator::Process(CalculatorContext* cc) {
   if (backward_requested_) {
     auto backward_optical_flow_field = absl::make_unique<OpticalFlowField>();
     MP_RETURN_IF_ERROR(CalculateOpticalFlow(second_frame, first_frame,
+                                            /*forward=*/false,
                                             backward_optical_flow_field.get()));
     cc->Outputs()
         .Tag(kBackwardFlowTag)
@@ -155,9 +179,19 @@ absl::Status Tvl1OpticalFlowCalculator::Process(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+cv::Ptr<cv::DenseOpticalFlow> Tvl1OpticalFlowCalculator::CreateFlowComputer()
+    const {
+#if MEDIAPIPE_TVL1_HAS_DIS
+  if (options_.algorithm() == Tvl1OpticalFlowCalculatorOptions::DIS) {
+    return cv::DISOpticalFlow::create(options_.dis_preset());
+  }
+#endif  // MEDIAPIPE_TVL1_HAS_DIS
+  return cv::createOptFlow_DualTVL1();
+}
+
 absl::Status Tvl1OpticalFlowCalculator::CalculateOpticalFlow(
     const ImageFrame& current_frame, const ImageFrame& next_frame,
-    OpticalFlowField* flow) {
+    bool forward, OpticalFlowField* flow) {
   CHECK(flow);
   if (!ImageSizesMatch(current_frame, next_frame)) {
     return tool::StatusInvalid("Images are different sizes.");
@@ -176,17 +210,37 @@ absl::Status Tvl1OpticalFlowCalculator::CalculateOpticalFlow(
     }
   }
   if (tvl1_computer.empty()) {
-    tvl1_computer = cv::createOptFlow_DualTVL1();
+    tvl1_computer = CreateFlowComputer();
   }
 
   flow->Allocate(first.cols, first.rows);
   cv::Mat cv_flow(flow->mutable_flow_data());
+  if (options_.algorithm() == Tvl1OpticalFlowCalculatorOptions::DIS) {
+    // DIS refines the flow it is given, so it must not start from the
+    // uninitialized allocation.
+    bool warm_started = false;
+    if (options_.warm_start()) {
+      absl::MutexLock lock(&mutex_);
+      const cv::Mat& previous_flow =
+          forward ? previous_forward_flow_ : previous_backward_flow_;
+      if (previous_flow.size() == cv_flow.size()) {
+        previous_flow.copyTo(cv_flow);
+        warm_started = true;
+      }
+    }
+    if (!warm_started) {
+      cv_flow.setTo(cv::Scalar::all(0));
+    }
+  }
   tvl1_computer->calc(first, second, cv_flow);
   CHECK_EQ(flow->mutable_flow_data().data, cv_flow.data);
   // Inserts the idle DenseOpticalFlow object back to the cache for reuse.
   {
     absl::MutexLock lock(&mutex_);
     tvl1_computers_.push_back(tvl1_computer);
+    if (options_.warm_start()) {
+      (forward ? previous_forward_flow_ : previous_backward_flow_) = cv_flow;
+    }
   }
   return absl::OkStatus();
 }
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string>
+
+#include "mediapipe/calculators/video/tvl1_optical_flow_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
@@ -57,7 +60,8 @@ void AddInputPackets(int num_packets, CalculatorGraph* graph) {
   MP_ASSERT_OK(graph->CloseAllInputStreams());
 }
 
-void RunTest(int num_input_packets, int max_in_flight) {
+void RunTest(int num_input_packets, int max_in_flight,
+             const std::string& options = "") {
   CalculatorGraphConfig config = ParseTextProtoOrDie<CalculatorGraphConfig>(
       absl::Substitute(R"(
     input_stream: "first_frames"
@@ -69,10 +73,11 @@ void RunTest(int num_input_packets, int max_in_flight) {
       output_stream: "FORWARD_FLOW:forward_flow"
       output_stream: "BACKWARD_FLOW:backward_flow"
       max_in_flight: $0
+      $1
     }
     num_threads: $0
   )",
-                       max_in_flight));
+                       max_in_flight, options));
   CalculatorGraph graph;
   MP_ASSERT_OK(graph.Initialize(config));
   StatusOrPoller status_or_poller1 =
@@ -123,5 +128,18 @@ TEST(Tvl1OpticalFlowCalculatorTest, TestParallelExecution) {
   RunTest(/*num_input_packets=*/20, /*max_in_flight=*/10);
 }
 
+#if !defined(CV_VERSION_EPOCH) && CV_VERSION_MAJOR >= 4
+TEST(Tvl1OpticalFlowCalculatorTest, TestDisWithWarmStart) {
+  RunTest(/*num_input_packets=*/5, /*max_in_flight=*/1, R"pb(
+    options {
+      [mediapipe.Tvl1OpticalFlowCalculatorOptions.ext] {
+        algorithm: DIS
+        warm_start: true
+      }
+    }
+  )pb");
+}
+#endif
+
 }  // namespace
 }  // namespace mediapipe
@@ -15,7 +15,9 @@
 // This Calculator takes an ImageFrame and scales it appropriately.
 
 #include <algorithm>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "mediapipe/examples/desktop/autoflip/autoflip_messages.pb.h"
@@ -23,11 +25,18 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 
+#if !MEDIAPIPE_DISABLE_GPU
+#include "mediapipe/examples/desktop/autoflip/quality/gl_frame_statistics.h"
+#include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gpu_buffer.h"
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
 using mediapipe::Adopt;
 using mediapipe::CalculatorBase;
 using mediapipe::ImageFrame;
@@ -39,6 +48,7 @@ constexpr int kMinBorderDistance = 5;
 constexpr int kKMeansClusterCount = 4;
 constexpr int kMaxPixelsToProcess = 300000;
 constexpr char kVideoInputTag[] = "VIDEO";
+constexpr char kVideoGpuInputTag[] = "VIDEO_GPU";
 
 namespace mediapipe {
 namespace autoflip {
@@ -60,6 +70,12 @@ void SetRect(const cv::Rect& region,
 // This calculator takes a sequence of images (video) and detects solid color
 // borders as well as the dominant color of the non-border area.  This per-frame
 // information is passed to downstream calculators.
+//
+// Frames are either ImageFrames on the VIDEO stream or GpuBuffers on the
+// VIDEO_GPU stream. GPU frames are never read back whole: the border rows are
+// matched against the seed colors with OpenGL ES 3.1 compute shaders, and only
+// the seed rows and a downscaled non-border area are read back to find the
+// dominant colors.
 class BorderDetectionCalculator : public CalculatorBase {
  public:
   BorderDetectionCalculator() : frame_width_(-1), frame_height_(-1) {}
@@ -71,19 +87,40 @@ class BorderDetectionCalculator : public CalculatorBase {
   static absl::Status GetContract(mediapipe::CalculatorContract* cc);
   absl::Status Open(mediapipe::CalculatorContext* cc) override;
   absl::Status Process(mediapipe::CalculatorContext* cc) override;
+  absl::Status Close(mediapipe::CalculatorContext* cc) override;
 
  private:
-  // Given a color and image direction, check to see if a border of that color
-  // exists.
-  void DetectBorder(const cv::Mat& frame, const Color& color,
+  // Given an image direction, check to see if a border exists, where
+  // `row_color_fraction` provides the fraction of a frame row that has the
+  // color of the border.
+  void DetectBorder(const std::function<double(int row)>& row_color_fraction,
                     const Border::RelativePosition& direction,
                     StaticFeatures* features);
 
+  // Detects the borders and the solid background of an ImageFrame.
+  void DetectFeatures(const cv::Mat& frame, StaticFeatures* features);
+
+  // Detects the borders and the solid background of the current frame on the
+  // VIDEO_GPU stream.
+  absl::Status DetectGpuFeatures(mediapipe::CalculatorContext* cc,
+                                 StaticFeatures* features);
+
   // Provide the percent this color shows up in a given image.
   double ColorCount(const Color& mask_color, const cv::Mat& image) const;
 
   // Set member vars (image size) and confirm no changes frame-to-frame.
   absl::Status SetAndCheckInputs(const cv::Mat& frame);
+  absl::Status SetAndCheckSize(int width, int height);
+
+  // Sets the default non-static area of the frame.
+  void InitializeFeatures(StaticFeatures* features) const;
+
+  // Number of rows to search for a border from the top or the bottom.
+  int SearchDistance() const;
+
+  // Sets the solid background if the non-static area has a dominant color.
+  void SetSolidBackground(const cv::Mat& non_static_frame,
+                          StaticFeatures* features);
 
   // Find the dominant color for a input image.
   double FindDominantColor(const cv::Mat& image, Color* dominant_color);
@@ -94,6 +131,16 @@ class BorderDetectionCalculator : public CalculatorBase {
 
   // Options for processing.
   BorderDetectionCalculatorOptions options_;
+
+  // Whether frames come from the VIDEO_GPU stream.
+  bool use_gpu_ = false;
+#if !MEDIAPIPE_DISABLE_GPU
+  mediapipe::GlCalculatorHelper gpu_helper_;
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  // Created in the GL context on the first GPU frame.
+  std::unique_ptr<GlFrameStatistics> statistics_;
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+#endif  // !MEDIAPIPE_DISABLE_GPU
 };
 REGISTER_CALCULATOR(BorderDetectionCalculator);
 
@@ -101,62 +148,198 @@ absl::Status BorderDetectionCalculator::Open(mediapipe::CalculatorContext* cc) {
   options_ = cc->Options<BorderDetectionCalculatorOptions>();
   RET_CHECK_LT(options_.vertical_search_distance(), 0.5)
       << "Search distance must be less than half the full image.";
+  use_gpu_ = cc->Inputs().HasTag(kVideoGpuInputTag);
+  if (use_gpu_) {
+#if !MEDIAPIPE_DISABLE_GPU
+    MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
+#else
+    RET_CHECK_FAIL() << "GPU processing is disabled.";
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BorderDetectionCalculator::Close(
+    mediapipe::CalculatorContext* cc) {
+#if !MEDIAPIPE_DISABLE_GPU && \
+    MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  if (statistics_) {
+    gpu_helper_.RunInGlContext([this] { statistics_.reset(); });
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU && MEDIAPIPE_OPENGL_ES_VERSION >= 31
   return absl::OkStatus();
 }
 
 absl::Status BorderDetectionCalculator::SetAndCheckInputs(
     const cv::Mat& frame) {
+  MP_RETURN_IF_ERROR(SetAndCheckSize(frame.cols, frame.rows));
+  RET_CHECK_EQ(frame.channels(), 3) << "Input video type must be 3-channel";
+  return absl::OkStatus();
+}
+
+absl::Status BorderDetectionCalculator::SetAndCheckSize(int width,
+                                                        int height) {
   if (frame_width_ < 0) {
-    frame_width_ = frame.cols;
+    frame_width_ = width;
   }
   if (frame_height_ < 0) {
-    frame_height_ = frame.rows;
+    frame_height_ = height;
   }
-  RET_CHECK_EQ(frame.cols, frame_width_)
+  RET_CHECK_EQ(width, frame_width_)
       << "Input frame dimensions must remain constant throughout the video.";
-  RET_CHECK_EQ(frame.rows, frame_height_)
+  RET_CHECK_EQ(height, frame_height_)
       << "Input frame dimensions must remain constant throughout the video.";
-  RET_CHECK_EQ(frame.channels(), 3) << "Input video type must be 3-channel";
   return absl::OkStatus();
 }
 
+void BorderDetectionCalculator::InitializeFeatures(
+    StaticFeatures* features) const {
+  features->mutable_non_static_area()->set_x(0);
+  features->mutable_non_static_area()->set_width(frame_width_);
+  features->mutable_non_static_area()->set_y(options_.default_padding_px());
+  features->mutable_non_static_area()->set_height(
+      std::max(0, frame_height_ - options_.default_padding_px() * 2));
+}
+
+int BorderDetectionCalculator::SearchDistance() const {
+  return frame_height_ * options_.vertical_search_distance();
+}
+
 absl::Status BorderDetectionCalculator::Process(
     mediapipe::CalculatorContext* cc) {
-  if (!cc->Inputs().HasTag(kVideoInputTag) ||
-      cc->Inputs().Tag(kVideoInputTag).Value().IsEmpty()) {
+  const std::string tag = use_gpu_ ? kVideoGpuInputTag : kVideoInputTag;
+  if (cc->Inputs().Tag(tag).Value().IsEmpty()) {
     return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-           << "Input tag VIDEO not set or empty at timestamp: "
+           << "Input tag " << tag << " empty at timestamp: "
            << cc->InputTimestamp().Value();
   }
-  cv::Mat frame = mediapipe::formats::MatView(
-      &cc->Inputs().Tag(kVideoInputTag).Get<ImageFrame>());
-  MP_RETURN_IF_ERROR(SetAndCheckInputs(frame));
 
-  // Initialize output and set default values.
   std::unique_ptr<StaticFeatures> features =
       absl::make_unique<StaticFeatures>();
-  features->mutable_non_static_area()->set_x(0);
-  features->mutable_non_static_area()->set_width(frame_width_);
-  features->mutable_non_static_area()->set_y(options_.default_padding_px());
-  features->mutable_non_static_area()->set_height(
-      std::max(0, frame_height_ - options_.default_padding_px() * 2));
+  if (use_gpu_) {
+    MP_RETURN_IF_ERROR(DetectGpuFeatures(cc, features.get()));
+  } else {
+    cv::Mat frame = mediapipe::formats::MatView(
+        &cc->Inputs().Tag(kVideoInputTag).Get<ImageFrame>());
+    MP_RETURN_IF_ERROR(SetAndCheckInputs(frame));
+    DetectFeatures(frame, features.get());
+  }
+
+  // Output result.
+  cc->Outputs()
+      .Tag(kDetectedBorders)
+      .AddPacket(Adopt(features.release()).At(cc->InputTimestamp()));
+
+  return absl::OkStatus();
+}
+
+void BorderDetectionCalculator::DetectFeatures(const cv::Mat& frame,
+                                               StaticFeatures* features) {
+  // Initialize output and set default values.
+  InitializeFeatures(features);
 
   // Check for border at the top of the frame.
   Color seed_color_top;
   FindDominantColor(frame(cv::Rect(0, 0, frame_width_, 1)), &seed_color_top);
-  DetectBorder(frame, seed_color_top, Border::TOP, features.get());
+  DetectBorder(
+      [&](int row) {
+        return ColorCount(seed_color_top,
+                          frame(cv::Rect(0, row, frame_width_, 1)));
+      },
+      Border::TOP, features);
 
   // Check for border at the bottom of the frame.
   Color seed_color_bottom;
   FindDominantColor(frame(cv::Rect(0, frame_height_ - 1, frame_width_, 1)),
                     &seed_color_bottom);
-  DetectBorder(frame, seed_color_bottom, Border::BOTTOM, features.get());
+  DetectBorder(
+      [&](int row) {
+        return ColorCount(seed_color_bottom,
+                          frame(cv::Rect(0, row, frame_width_, 1)));
+      },
+      Border::BOTTOM, features);
 
   // Check the non-border area for a dominant color.
   cv::Mat non_static_frame = frame(
       cv::Rect(features->non_static_area().x(), features->non_static_area().y(),
                features->non_static_area().width(),
                features->non_static_area().height()));
+  SetSolidBackground(non_static_frame, features);
+}
+
+absl::Status BorderDetectionCalculator::DetectGpuFeatures(
+    mediapipe::CalculatorContext* cc, StaticFeatures* features) {
+#if !MEDIAPIPE_DISABLE_GPU && \
+    MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  return gpu_helper_.RunInGlContext([this, cc, features]() -> absl::Status {
+    if (!statistics_) {
+      ASSIGN_OR_RETURN(statistics_, GlFrameStatistics::Create());
+    }
+    const auto& input = cc->Inputs().Tag(kVideoGpuInputTag).Get<GpuBuffer>();
+    auto texture = gpu_helper_.CreateSourceTexture(input);
+    MP_RETURN_IF_ERROR(SetAndCheckSize(texture.width(), texture.height()));
+    InitializeFeatures(features);
+
+    const int search_distance = SearchDistance();
+    // Matches the channel order of ColorCount, which compares the red value
+    // against the last channel.
+    auto to_channels = [](const Color& color) {
+      return cv::Vec3i(color.b(), color.g(), color.r());
+    };
+    auto detect_border = [&](int seed_row, int first_row,
+                             const Border::RelativePosition& direction)
+        -> absl::Status {
+      cv::Mat seed_pixels;
+      MP_RETURN_IF_ERROR(statistics_->ReadRegion(
+          texture, cv::Rect(0, seed_row, frame_width_, 1),
+          cv::Size(frame_width_, 1), &seed_pixels));
+      Color seed_color;
+      FindDominantColor(seed_pixels, &seed_color);
+      std::vector<int> counts;
+      MP_RETURN_IF_ERROR(statistics_->CountMatchingPixels(
+          texture, first_row, search_distance, to_channels(seed_color),
+          options_.color_tolerance(), &counts));
+      DetectBorder(
+          [&](int row) {
+            return counts[row - first_row] / static_cast<double>(frame_width_);
+          },
+          direction, features);
+      return absl::OkStatus();
+    };
+    MP_RETURN_IF_ERROR(detect_border(/*seed_row=*/0, /*first_row=*/0,
+                                     Border::TOP));
+    MP_RETURN_IF_ERROR(detect_border(/*seed_row=*/frame_height_ - 1,
+                                     frame_height_ - search_distance,
+                                     Border::BOTTOM));
+
+    // Reads the non-border area back at the size FindDominantColor would
+    // resize it to.
+    const cv::Rect non_static_area(features->non_static_area().x(),
+                                   features->non_static_area().y(),
+                                   features->non_static_area().width(),
+                                   features->non_static_area().height());
+    cv::Size size = non_static_area.size();
+    if (non_static_area.area() > kMaxPixelsToProcess) {
+      const float resize =
+          kMaxPixelsToProcess / static_cast<float>(non_static_area.area());
+      size = cv::Size(cv::saturate_cast<int>(size.width * resize),
+                      cv::saturate_cast<int>(size.height * resize));
+    }
+    cv::Mat non_static_frame;
+    MP_RETURN_IF_ERROR(statistics_->ReadRegion(texture, non_static_area, size,
+                                               &non_static_frame));
+    texture.Release();
+    SetSolidBackground(non_static_frame, features);
+    return absl::OkStatus();
+  });
+#else
+  return absl::UnimplementedError(
+      "GPU border detection requires OpenGL ES 3.1 or newer.");
+#endif  // !MEDIAPIPE_DISABLE_GPU && MEDIAPIPE_OPENGL_ES_VERSION >= 31
+}
+
+void BorderDetectionCalculator::SetSolidBackground(
+    const cv::Mat& non_static_frame, StaticFeatures* features) {
   Color dominant_color_nonborder;
   double dominant_color_percent =
       FindDominantColor(non_static_frame, &dominant_color_nonborder);
@@ -166,13 +349,6 @@ absl::Status BorderDetectionCalculator::Process(
     bg_color->set_g(dominant_color_nonborder.g());
     bg_color->set_b(dominant_color_nonborder.b());
   }
-
-  // Output result.
-  cc->Outputs()
-      .Tag(kDetectedBorders)
-      .AddPacket(Adopt(features.release()).At(cc->InputTimestamp()));
-
-  return absl::OkStatus();
 }
 
 //  Find the dominant color within an image.
@@ -230,30 +406,18 @@ double BorderDetectionCalculator::ColorCount(const Color& mask_color,
 }
 
 void BorderDetectionCalculator::DetectBorder(
-    const cv::Mat& frame, const Color& color,
+    const std::function<double(int row)>& row_color_fraction,
     const Border::RelativePosition& direction, StaticFeatures* features) {
   // Search the entire image until we find an object, or hit the max search
   // distance.
-  int search_distance =
-      (direction == Border::TOP || direction == Border::BOTTOM) ? frame.rows
-                                                                : frame.cols;
-  search_distance *= options_.vertical_search_distance();
+  const int search_distance = SearchDistance();
 
   // Check if each next line has a dominant color that matches the given
   // border color.
   int last_border = -1;
   for (int i = 0; i < search_distance; i++) {
-    cv::Rect current_row;
-    switch (direction) {
-      case Border::TOP:
-        current_row = cv::Rect(0, i, frame.cols, 1);
-        break;
-      case Border::BOTTOM:
-        current_row = cv::Rect(0, frame.rows - i - 1, frame.cols, 1);
-        break;
-    }
-    if (ColorCount(color, frame(current_row)) <
-        options_.border_color_pixel_perc()) {
+    const int row = direction == Border::TOP ? i : frame_height_ - i - 1;
+    if (row_color_fraction(row) < options_.border_color_pixel_perc()) {
       break;
     }
     last_border = i;
@@ -269,7 +433,7 @@ void BorderDetectionCalculator::DetectBorder(
 
   switch (direction) {
     case Border::TOP:
-      SetRect(cv::Rect(0, 0, frame.cols, last_border), Border::TOP,
+      SetRect(cv::Rect(0, 0, frame_width_, last_border), Border::TOP,
               features->add_border());
       features->mutable_non_static_area()->set_y(
           last_border + features->non_static_area().y());
@@ -278,12 +442,12 @@ void BorderDetectionCalculator::DetectBorder(
                                        options_.default_padding_px())));
       break;
     case Border::BOTTOM:
-      SetRect(
-          cv::Rect(0, frame.rows - last_border - 1, frame.cols, last_border),
-          Border::BOTTOM, features->add_border());
+      SetRect(cv::Rect(0, frame_height_ - last_border - 1, frame_width_,
+                       last_border),
+              Border::BOTTOM, features->add_border());
 
       features->mutable_non_static_area()->set_height(std::max(
-          0, frame.rows - (features->non_static_area().y() + last_border +
+          0, frame_height_ - (features->non_static_area().y() + last_border +
                            options_.default_padding_px())));
 
       break;
@@ -292,7 +456,20 @@ void BorderDetectionCalculator::DetectBorder(
 
 absl::Status BorderDetectionCalculator::GetContract(
     mediapipe::CalculatorContract* cc) {
-  cc->Inputs().Tag(kVideoInputTag).Set<ImageFrame>();
+  RET_CHECK(cc->Inputs().HasTag(kVideoInputTag) ^
+            cc->Inputs().HasTag(kVideoGpuInputTag))
+      << "Exactly one of VIDEO and VIDEO_GPU must be present.";
+  if (cc->Inputs().HasTag(kVideoInputTag)) {
+    cc->Inputs().Tag(kVideoInputTag).Set<ImageFrame>();
+  }
+  if (cc->Inputs().HasTag(kVideoGpuInputTag)) {
+#if !MEDIAPIPE_DISABLE_GPU
+    cc->Inputs().Tag(kVideoGpuInputTag).Set<GpuBuffer>();
+    MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
+#else
+    RET_CHECK_FAIL() << "GPU processing is disabled.";
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  }
   cc->Outputs().Tag(kDetectedBorders).Set<StaticFeatures>();
   return absl::OkStatus();
 }
@@ -145,6 +145,14 @@ absl::Status SceneCroppingCalculator::Open(CalculatorContext* cc) {
       << "Maximum scene size is non-positive.";
   RET_CHECK_GE(options_.prior_frame_buffer_size(), 0)
       << "Prior frame buffer size is negative.";
+  if (options_.streaming_window_size() > 0) {
+    RET_CHECK(options_.camera_motion_options().has_kinematic_options())
+        << "Streaming mode requires the kinematic path solver.";
+    RET_CHECK(options_.streaming_lookahead_size() >= 0 &&
+              options_.streaming_lookahead_size() <
+                  options_.streaming_window_size())
+        << "Streaming lookahead size is not in [0, streaming_window_size).";
+  }
 
   RET_CHECK(options_.solid_background_frames_padding_fraction() >= 0.0 &&
             options_.solid_background_frames_padding_fraction() <= 1.0)
@@ -372,7 +380,8 @@ absl::Status SceneCroppingCalculator::Process(
 
   if (!scene_frame_timestamps_.empty() && (is_end_of_scene)) {
     continue_last_scene_ = false;
-    MP_RETURN_IF_ERROR(ProcessScene(is_end_of_scene, cc));
+    MP_RETURN_IF_ERROR(
+        ProcessScene(is_end_of_scene, scene_frame_timestamps_.size(), cc));
   }
 
   // Saves frame and timestamp and whether it is a key frame.
@@ -409,10 +418,20 @@ absl::Status SceneCroppingCalculator::Process(
     static_features_timestamps_.push_back(cc->InputTimestamp().Value());
   }
 
+  const int num_buffered_frames = scene_frame_timestamps_.size();
   const bool force_buffer_flush =
-      scene_frame_timestamps_.size() >= options_.max_scene_size();
+      num_buffered_frames >= options_.max_scene_size();
   if (!scene_frame_timestamps_.empty() && force_buffer_flush) {
-    MP_RETURN_IF_ERROR(ProcessScene(is_end_of_scene, cc));
+    MP_RETURN_IF_ERROR(
+        ProcessScene(is_end_of_scene, num_buffered_frames, cc));
+    continue_last_scene_ = true;
+  } else if (options_.streaming_window_size() > 0 &&
+             num_buffered_frames >= options_.streaming_window_size()) {
+    // Outputs the frames leaving the lookahead window. The kinematic path
+    // solver carries the camera path over to the following frames.
+    MP_RETURN_IF_ERROR(ProcessScene(
+        is_end_of_scene,
+        num_buffered_frames - options_.streaming_lookahead_size(), cc));
     continue_last_scene_ = true;
   }
 
@@ -421,7 +440,8 @@ absl::Status SceneCroppingCalculator::Process(
 
 absl::Status SceneCroppingCalculator::Close(mediapipe::CalculatorContext* cc) {
   if (!scene_frame_timestamps_.empty()) {
-    MP_RETURN_IF_ERROR(ProcessScene(/* is_end_of_scene = */ true, cc));
+    MP_RETURN_IF_ERROR(ProcessScene(/* is_end_of_scene = */ true,
+                                    scene_frame_timestamps_.size(), cc));
   }
   if (cc->Outputs().HasTag(kOutputSummary)) {
     cc->Outputs()
@@ -529,7 +549,43 @@ void SceneCroppingCalculator::FilterKeyFrameInfo() {
 }
 
 absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
+                                                   const int num_output_frames,
                                                    CalculatorContext* cc) {
+  const int num_frames = scene_frame_timestamps_.size();
+  RET_CHECK(num_output_frames > 0 && num_output_frames <= num_frames)
+      << "Number of output frames is not in [1, " << num_frames << "].";
+
+  // Keeps the buffered data of the frames that are not output, which the
+  // processing below modifies, to be buffered again afterwards.
+  const int64 first_kept_timestamp =
+      num_output_frames < num_frames
+          ? scene_frame_timestamps_[num_output_frames]
+          : Timestamp::Max().Value();
+  std::vector<cv::Mat> kept_frames;
+  if (!scene_frames_or_empty_.empty()) {
+    kept_frames.assign(scene_frames_or_empty_.begin() + num_output_frames,
+                       scene_frames_or_empty_.end());
+  }
+  const std::vector<int64> kept_timestamps(
+      scene_frame_timestamps_.begin() + num_output_frames,
+      scene_frame_timestamps_.end());
+  const std::vector<bool> kept_is_key_frames(
+      is_key_frames_.begin() + num_output_frames, is_key_frames_.end());
+  std::vector<KeyFrameInfo> kept_key_frame_infos;
+  for (const KeyFrameInfo& key_frame_info : key_frame_infos_) {
+    if (key_frame_info.timestamp_ms() >= first_kept_timestamp) {
+      kept_key_frame_infos.push_back(key_frame_info);
+    }
+  }
+  std::vector<StaticFeatures> kept_static_features;
+  std::vector<int64> kept_static_features_timestamps;
+  for (int i = 0; i < static_features_.size(); ++i) {
+    if (static_features_timestamps_[i] >= first_kept_timestamp) {
+      kept_static_features.push_back(static_features_[i]);
+      kept_static_features_timestamps.push_back(static_features_timestamps_[i]);
+    }
+  }
+
   // Removes detections under special circumstances.
   FilterKeyFrameInfo();
 
@@ -566,18 +622,33 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
           has_solid_background_, &scene_summary, &focus_point_frames,
           &scene_camera_motion));
 
-  // Crops scene frames.
+  // Crops the output frames.
   std::vector<cv::Mat> cropped_frames;
   std::vector<cv::Rect> crop_from_locations;
 
   auto* cropped_frames_ptr =
       should_perform_frame_cropping_ ? &cropped_frames : nullptr;
 
+  const std::vector<int64> output_timestamps(
+      scene_frame_timestamps_.begin(),
+      scene_frame_timestamps_.begin() + num_output_frames);
+  const std::vector<bool> output_is_key_frames(
+      is_key_frames_.begin(), is_key_frames_.begin() + num_output_frames);
+  const std::vector<FocusPointFrame> output_focus_point_frames(
+      focus_point_frames.begin(),
+      focus_point_frames.begin() + num_output_frames);
+  std::vector<cv::Mat> output_frames_or_empty;
+  if (!scene_frames_or_empty_.empty()) {
+    output_frames_or_empty.assign(
+        scene_frames_or_empty_.begin(),
+        scene_frames_or_empty_.begin() + num_output_frames);
+  }
   MP_RETURN_IF_ERROR(scene_cropper_->CropFrames(
-      scene_summary, scene_frame_timestamps_, is_key_frames_,
-      scene_frames_or_empty_, focus_point_frames, prior_focus_point_frames_,
-      top_static_border_size, bottom_static_border_size, continue_last_scene_,
-      &crop_from_locations, cropped_frames_ptr));
+      scene_summary, output_timestamps, output_is_key_frames,
+      output_frames_or_empty, output_focus_point_frames,
+      prior_focus_point_frames_, top_static_border_size,
+      bottom_static_border_size, continue_last_scene_, &crop_from_locations,
+      cropped_frames_ptr));
 
   // Formats and outputs cropped frames.
   bool apply_padding = false;
@@ -586,7 +657,7 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
   std::vector<cv::Scalar> padding_colors;
   MP_RETURN_IF_ERROR(FormatAndOutputCroppedFrames(
       scene_summary.crop_window_width(), scene_summary.crop_window_height(),
-      scene_frame_timestamps_.size(), &render_to_locations, &apply_padding,
+      num_output_frames, &render_to_locations, &apply_padding,
       &padding_colors, &vertical_fill_percent, cropped_frames_ptr, cc));
   // Caches prior FocusPointFrames if this was not the end of a scene.
   prior_focus_point_frames_.clear();
@@ -605,10 +676,11 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
   MP_RETURN_IF_ERROR(OutputVizFrames(key_frame_crop_results, focus_point_frames,
                                      crop_from_locations,
                                      scene_summary.crop_window_width(),
-                                     scene_summary.crop_window_height(), cc));
+                                     scene_summary.crop_window_height(),
+                                     num_output_frames, cc));
 
-  const double start_sec = Timestamp(scene_frame_timestamps_.front()).Seconds();
-  const double end_sec = Timestamp(scene_frame_timestamps_.back()).Seconds();
+  const double start_sec = Timestamp(output_timestamps.front()).Seconds();
+  const double end_sec = Timestamp(output_timestamps.back()).Seconds();
   VLOG(1) << absl::StrFormat("Processed a scene from %.2f sec to %.2f sec",
                              start_sec, end_sec);
 
@@ -623,7 +695,7 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
   }
 
   if (cc->Outputs().HasTag(kExternalRenderingPerFrame)) {
-    for (int i = 0; i < scene_frame_timestamps_.size(); i++) {
+    for (int i = 0; i < num_output_frames; i++) {
       auto external_render_message = absl::make_unique<ExternalRenderFrame>();
       ConstructExternalRenderMessage(
           crop_from_locations[i], render_to_locations[i], padding_colors[i],
@@ -636,7 +708,7 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
   }
 
   if (cc->Outputs().HasTag(kExternalRenderingFullVid)) {
-    for (int i = 0; i < scene_frame_timestamps_.size(); i++) {
+    for (int i = 0; i < num_output_frames; i++) {
       ExternalRenderFrame render_frame;
       ConstructExternalRenderMessage(crop_from_locations[i],
                                      render_to_locations[i], padding_colors[i],
@@ -645,12 +717,12 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
     }
   }
 
-  key_frame_infos_.clear();
-  scene_frames_or_empty_.clear();
-  scene_frame_timestamps_.clear();
-  is_key_frames_.clear();
-  static_features_.clear();
-  static_features_timestamps_.clear();
+  key_frame_infos_ = std::move(kept_key_frame_infos);
+  scene_frames_or_empty_ = std::move(kept_frames);
+  scene_frame_timestamps_ = kept_timestamps;
+  is_key_frames_ = kept_is_key_frames;
+  static_features_ = std::move(kept_static_features);
+  static_features_timestamps_ = std::move(kept_static_features_timestamps);
   return absl::OkStatus();
 }
 
@@ -680,6 +752,8 @@ absl::Status SceneCroppingCalculator::FormatAndOutputCroppedFrames(
   if (*apply_padding) {
     padder_ = absl::make_unique<PaddingEffectGenerator>(
         scaled_width, scaled_height, target_aspect_ratio_);
+    padder_->SetMaxBlurKernelSize(
+        options_.padding_parameters().max_blur_kernel_size());
     VLOG(1) << "Scene is padded: scaled width = " << scaled_width
             << " target width = " << target_width_
             << " scaled height = " << scaled_height
@@ -730,46 +804,62 @@ absl::Status SceneCroppingCalculator::FormatAndOutputCroppedFrames(
     return absl::OkStatus();
   }
 
-  // Resizes cropped frames, pads frames, and output frames.
-  for (int i = 0; i < num_frames; ++i) {
-    const int64 time_ms = scene_frame_timestamps_[i];
-    const Timestamp timestamp(time_ms);
-    auto scaled_frame = absl::make_unique<ImageFrame>(
-        frame_format_, scaled_width, scaled_height);
-    auto destination = formats::MatView(scaled_frame.get());
-    if (scaled_width == crop_width && scaled_height == crop_height) {
-      cropped_frames_ptr->at(i).copyTo(destination);
-    } else {
-      // cubic is better quality for upscaling and area is good for
-      // downscaling
-      const int interpolation_method =
-          scaling > 1 ? cv::INTER_CUBIC : cv::INTER_AREA;
-      cv::resize(cropped_frames_ptr->at(i), destination, destination.size(), 0,
-                 0, interpolation_method);
-    }
-    if (*apply_padding) {
-      cv::Scalar* background_color = nullptr;
-      if (has_solid_background_) {
-        background_color = &padding_colors->at(i);
-      }
-      auto padded_frame = absl::make_unique<ImageFrame>();
-      MP_RETURN_IF_ERROR(padder_->Process(
-          *scaled_frame, background_contrast_,
-          std::min({blur_cv_size_, scaled_width, scaled_height}),
-          overlay_opacity_, padded_frame.get(), background_color));
-      RET_CHECK_EQ(padded_frame->Width(), target_width_)
-          << "Padded frame width is off.";
-      RET_CHECK_EQ(padded_frame->Height(), target_height_)
-          << "Padded frame height is off.";
-      cc->Outputs()
-          .Tag(kOutputCroppedFrames)
-          .Add(padded_frame.release(), timestamp);
-    } else {
-      cc->Outputs()
-          .Tag(kOutputCroppedFrames)
-          .Add(scaled_frame.release(), timestamp);
+  // Resizes and pads cropped frames in parallel, and outputs them in order.
+  std::vector<std::unique_ptr<ImageFrame>> output_frames(num_frames);
+  std::vector<absl::Status> statuses(num_frames);
+  cv::parallel_for_(cv::Range(0, num_frames), [&](const cv::Range& range) {
+    for (int i = range.start; i < range.end; ++i) {
+      const cv::Scalar* background_color =
+          has_solid_background_ ? &padding_colors->at(i) : nullptr;
+      statuses[i] = ScaleAndPadFrame(cropped_frames_ptr->at(i), scaled_width,
+                                     scaled_height, *apply_padding,
+                                     background_color, &output_frames[i]);
     }
+  });
+  for (int i = 0; i < num_frames; ++i) {
+    MP_RETURN_IF_ERROR(statuses[i]);
+    cc->Outputs()
+        .Tag(kOutputCroppedFrames)
+        .Add(output_frames[i].release(), Timestamp(scene_frame_timestamps_[i]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SceneCroppingCalculator::ScaleAndPadFrame(
+    const cv::Mat& cropped_frame, const int scaled_width,
+    const int scaled_height, const bool apply_padding,
+    const cv::Scalar* background_color,
+    std::unique_ptr<ImageFrame>* output_frame) const {
+  auto scaled_frame = absl::make_unique<ImageFrame>(frame_format_, scaled_width,
+                                                    scaled_height);
+  auto destination = formats::MatView(scaled_frame.get());
+  if (scaled_width == cropped_frame.cols &&
+      scaled_height == cropped_frame.rows) {
+    cropped_frame.copyTo(destination);
+  } else {
+    // cubic is better quality for upscaling and area is good for
+    // downscaling
+    const int interpolation_method =
+        scaled_width * scaled_height > cropped_frame.cols * cropped_frame.rows
+            ? cv::INTER_CUBIC
+            : cv::INTER_AREA;
+    cv::resize(cropped_frame, destination, destination.size(), 0, 0,
+               interpolation_method);
+  }
+  if (!apply_padding) {
+    *output_frame = std::move(scaled_frame);
+    return absl::OkStatus();
   }
+  auto padded_frame = absl::make_unique<ImageFrame>();
+  MP_RETURN_IF_ERROR(padder_->Process(
+      *scaled_frame, background_contrast_,
+      std::min({blur_cv_size_, scaled_width, scaled_height}), overlay_opacity_,
+      padded_frame.get(), background_color));
+  RET_CHECK_EQ(padded_frame->Width(), target_width_)
+      << "Padded frame width is off.";
+  RET_CHECK_EQ(padded_frame->Height(), target_height_)
+      << "Padded frame height is off.";
+  *output_frame = std::move(padded_frame);
   return absl::OkStatus();
 }
 
@@ -778,13 +868,13 @@ absl::Status SceneCroppingCalculator::OutputVizFrames(
     const std::vector<FocusPointFrame>& focus_point_frames,
     const std::vector<cv::Rect>& crop_from_locations,
     const int crop_window_width, const int crop_window_height,
-    CalculatorContext* cc) const {
+    const int num_frames, CalculatorContext* cc) const {
   if (cc->Outputs().HasTag(kOutputKeyFrameCropViz)) {
     std::vector<std::unique_ptr<ImageFrame>> viz_frames;
     MP_RETURN_IF_ERROR(DrawDetectionsAndCropRegions(
         scene_frames_or_empty_, is_key_frames_, key_frame_infos_,
         key_frame_crop_results, frame_format_, &viz_frames));
-    for (int i = 0; i < scene_frames_or_empty_.size(); ++i) {
+    for (int i = 0; i < num_frames; ++i) {
       cc->Outputs()
           .Tag(kOutputKeyFrameCropViz)
           .Add(viz_frames[i].release(), Timestamp(scene_frame_timestamps_[i]));
@@ -796,7 +886,7 @@ absl::Status SceneCroppingCalculator::OutputVizFrames(
         scene_frames_or_empty_, focus_point_frames,
         options_.viz_overlay_opacity(), crop_window_width, crop_window_height,
         frame_format_, &viz_frames));
-    for (int i = 0; i < scene_frames_or_empty_.size(); ++i) {
+    for (int i = 0; i < num_frames; ++i) {
       cc->Outputs()
           .Tag(kOutputFocusPointFrameViz)
           .Add(viz_frames[i].release(), Timestamp(scene_frame_timestamps_[i]));
@@ -807,7 +897,7 @@ absl::Status SceneCroppingCalculator::OutputVizFrames(
     MP_RETURN_IF_ERROR(DrawDetectionAndFramingWindow(
         raw_scene_frames_or_empty_, crop_from_locations, frame_format_,
         options_.viz_overlay_opacity(), &viz_frames));
-    for (int i = 0; i < raw_scene_frames_or_empty_.size(); ++i) {
+    for (int i = 0; i < num_frames; ++i) {
       cc->Outputs()
           .Tag(kOutputFramingAndDetections)
           .Add(viz_frames[i].release(), Timestamp(scene_frame_timestamps_[i]));
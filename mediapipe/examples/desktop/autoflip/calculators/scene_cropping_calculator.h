@@ -134,7 +134,9 @@ class SceneCroppingCalculator : public CalculatorBase {
   // Buffers each scene frame and its timestamp. Packs and stores KeyFrameInfo
   // for key frames (a.k.a. frames with detection features). When a shot
   // boundary is encountered or when the buffer is full, calls ProcessScene()
-  // to process the scene at once, and clears buffers.
+  // to process the scene at once, and clears buffers. In streaming mode, the
+  // frames leaving the lookahead window are processed whenever the window is
+  // full.
   absl::Status Process(CalculatorContext* cc) override;
 
   // Calls ProcessScene() on remaining buffered frames. Optionally outputs a
@@ -164,7 +166,11 @@ class SceneCroppingCalculator : public CalculatorBase {
   //    to force flush).
   // 6. Optionally outputs visualization frames.
   // 7. Optionally updates cropping summary.
-  absl::Status ProcessScene(const bool is_end_of_scene, CalculatorContext* cc);
+  // Only the first |num_output_frames| buffered frames are cropped and output.
+  // The remaining ones only inform the analysis, and stay buffered.
+  absl::Status ProcessScene(const bool is_end_of_scene,
+                            const int num_output_frames,
+                            CalculatorContext* cc);
 
   // Formats and outputs the cropped frames passed in through
   // |cropped_frames_ptr|. Scales them to be at least as big as the target
@@ -181,13 +187,23 @@ class SceneCroppingCalculator : public CalculatorBase {
       std::vector<cv::Scalar>* padding_colors, float* vertical_fill_percent,
       const std::vector<cv::Mat>* cropped_frames_ptr, CalculatorContext* cc);
 
-  // Draws and outputs visualization frames if those streams are present.
+  // Scales |cropped_frame| to |scaled_width| x |scaled_height| and pads it to
+  // the target size if |apply_padding| is true, into |output_frame|. This is
+  // run on several frames in parallel.
+  absl::Status ScaleAndPadFrame(
+      const cv::Mat& cropped_frame, const int scaled_width,
+      const int scaled_height, const bool apply_padding,
+      const cv::Scalar* background_color,
+      std::unique_ptr<ImageFrame>* output_frame) const;
+
+  // Draws and outputs visualization frames of the first |num_frames| buffered
+  // frames if those streams are present.
   absl::Status OutputVizFrames(
       const std::vector<KeyFrameCropResult>& key_frame_crop_results,
       const std::vector<FocusPointFrame>& focus_point_frames,
       const std::vector<cv::Rect>& crop_from_locations,
       const int crop_window_width, const int crop_window_height,
-      CalculatorContext* cc) const;
+      const int num_frames, CalculatorContext* cc) const;
 
   // Filters detections based on USER_HINT under specific flag conditions.
   void FilterKeyFrameInfo();
@@ -397,6 +397,47 @@ TEST(SceneCroppingCalculatorTest, HandlesLongScene) {
   CheckCroppedFrames(*runner, 2 * kMaxSceneSize, kTargetWidth, kTargetHeight);
 }
 
+// Checks that the calculator crops scenes in streaming mode, outputting the
+// frames leaving the lookahead window in order.
+TEST(SceneCroppingCalculatorTest, CropsInStreamingMode) {
+  CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          kConfig, kTargetWidth, kTargetHeight, kTargetSizeType, kMaxSceneSize,
+          kPriorFrameBufferSize));
+  auto* options = config.mutable_options()->MutableExtension(
+      SceneCroppingCalculatorOptions::ext);
+  options->mutable_camera_motion_options()->mutable_kinematic_options();
+  options->set_streaming_window_size(6);
+  options->set_streaming_lookahead_size(2);
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  AddScene(0, 2 * kSceneSize, kInputFrameWidth, kInputFrameHeight,
+           kKeyFrameWidth, kKeyFrameHeight, /*DownSampleRate=*/1,
+           runner->MutableInputs());
+  MP_EXPECT_OK(runner->Run());
+  CheckCroppedFrames(*runner, 2 * kSceneSize, kTargetWidth, kTargetHeight);
+  const auto& packets = runner->Outputs().Tag(kCroppedFramesTag).packets;
+  for (int i = 0; i < packets.size(); ++i) {
+    EXPECT_EQ(packets[i].Timestamp().Value(), i * kTimestampDiff);
+  }
+}
+
+// Checks that the calculator requires the kinematic path solver in streaming
+// mode.
+TEST(SceneCroppingCalculatorTest, ChecksStreamingModeOptions) {
+  CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          kConfig, kTargetWidth, kTargetHeight, kTargetSizeType, kMaxSceneSize,
+          kPriorFrameBufferSize));
+  config.mutable_options()
+      ->MutableExtension(SceneCroppingCalculatorOptions::ext)
+      ->set_streaming_window_size(10);
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  const auto status = runner->Run();
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.ToString(),
+              HasSubstr("Streaming mode requires the kinematic path solver."));
+}
+
 // Checks that the calculator can optionally output debug streams.
 TEST(SceneCroppingCalculatorTest, OutputsDebugStreams) {
   const CalculatorGraphConfig::Node config =
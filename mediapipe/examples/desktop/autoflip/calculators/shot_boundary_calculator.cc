@@ -22,16 +22,24 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/timestamp.h"
 
+#if !MEDIAPIPE_DISABLE_GPU
+#include "mediapipe/examples/desktop/autoflip/quality/gl_frame_statistics.h"
+#include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gpu_buffer.h"
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
 using mediapipe::ImageFrame;
 using mediapipe::PacketTypeSet;
 
 // IO labels.
 constexpr char kVideoInputTag[] = "VIDEO";
+constexpr char kVideoGpuInputTag[] = "VIDEO_GPU";
 constexpr char kShotChangeTag[] = "IS_SHOT_CHANGE";
 // Histogram settings.
 const int kSaturationBins = 8;
@@ -48,6 +56,11 @@ namespace autoflip {
 // by computing a 3d color histogram and comparing this frame-to-frame. Settings
 // to control the shot change logic are presented in the options proto.
 //
+// Frames are either ImageFrames on the VIDEO stream or GpuBuffers on the
+// VIDEO_GPU stream. GPU frames are never read back: their histograms are
+// computed with OpenGL ES 3.1 compute shaders, and only the histograms are
+// read.
+//
 // Example:
 //  node {
 //    calculator: "ShotBoundaryCalculator"
@@ -63,10 +76,14 @@ class ShotBoundaryCalculator : public mediapipe::CalculatorBase {
   static absl::Status GetContract(mediapipe::CalculatorContract* cc);
   absl::Status Open(mediapipe::CalculatorContext* cc) override;
   absl::Status Process(mediapipe::CalculatorContext* cc) override;
+  absl::Status Close(mediapipe::CalculatorContext* cc) override;
 
  private:
   // Computes the histogram of an image.
   void ComputeHistogram(const cv::Mat& image, cv::Mat* image_histogram);
+  // Computes the histogram of the current frame on the VIDEO_GPU stream.
+  absl::Status ComputeGpuHistogram(mediapipe::CalculatorContext* cc,
+                                   cv::Mat* image_histogram);
   // Transmits signal to next calculator.
   void Transmit(mediapipe::CalculatorContext* cc, bool is_shot_change);
   // Calculator options.
@@ -79,6 +96,15 @@ class ShotBoundaryCalculator : public mediapipe::CalculatorBase {
   cv::Mat last_histogram_;
   // History of histogram motion.
   std::deque<double> motion_history_;
+  // Whether frames come from the VIDEO_GPU stream.
+  bool use_gpu_ = false;
+#if !MEDIAPIPE_DISABLE_GPU
+  mediapipe::GlCalculatorHelper gpu_helper_;
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  // Created in the GL context on the first GPU frame.
+  std::unique_ptr<GlFrameStatistics> statistics_;
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+#endif  // !MEDIAPIPE_DISABLE_GPU
 };
 REGISTER_CALCULATOR(ShotBoundaryCalculator);
 
@@ -102,9 +128,39 @@ absl::Status ShotBoundaryCalculator::Open(mediapipe::CalculatorContext* cc) {
   options_ = cc->Options<ShotBoundaryCalculatorOptions>();
   last_shot_timestamp_ = Timestamp(0);
   init_ = false;
+  use_gpu_ = cc->Inputs().HasTag(kVideoGpuInputTag);
+  if (use_gpu_) {
+#if !MEDIAPIPE_DISABLE_GPU
+    MP_RETURN_IF_ERROR(gpu_helper_.Open(cc));
+#else
+    RET_CHECK_FAIL() << "GPU processing is disabled.";
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  }
   return absl::OkStatus();
 }
 
+absl::Status ShotBoundaryCalculator::ComputeGpuHistogram(
+    mediapipe::CalculatorContext* cc, cv::Mat* image_histogram) {
+#if !MEDIAPIPE_DISABLE_GPU && \
+    MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  return gpu_helper_.RunInGlContext([this, cc,
+                                     image_histogram]() -> absl::Status {
+    if (!statistics_) {
+      ASSIGN_OR_RETURN(statistics_, GlFrameStatistics::Create());
+    }
+    const auto& input = cc->Inputs().Tag(kVideoGpuInputTag).Get<GpuBuffer>();
+    auto texture = gpu_helper_.CreateSourceTexture(input);
+    const absl::Status status = statistics_->ComputeHistogram(
+        texture, kSaturationBins, image_histogram);
+    texture.Release();
+    return status;
+  });
+#else
+  return absl::UnimplementedError(
+      "GPU histograms require OpenGL ES 3.1 or newer.");
+#endif  // !MEDIAPIPE_DISABLE_GPU && MEDIAPIPE_OPENGL_ES_VERSION >= 31
+}
+
 void ShotBoundaryCalculator::Transmit(mediapipe::CalculatorContext* cc,
                                       bool is_shot_change) {
   if ((cc->InputTimestamp() - last_shot_timestamp_).Seconds() <
@@ -127,14 +183,17 @@ void ShotBoundaryCalculator::Transmit(mediapipe::CalculatorContext* cc,
 }
 
 absl::Status ShotBoundaryCalculator::Process(mediapipe::CalculatorContext* cc) {
-  // Connect to input frame and make a mutable copy.
-  cv::Mat frame_org = mediapipe::formats::MatView(
-      &cc->Inputs().Tag(kVideoInputTag).Get<ImageFrame>());
-  cv::Mat frame = frame_org.clone();
-
   // Extract histogram from the current frame.
   cv::Mat current_histogram;
-  ComputeHistogram(frame, &current_histogram);
+  if (use_gpu_) {
+    MP_RETURN_IF_ERROR(ComputeGpuHistogram(cc, &current_histogram));
+  } else {
+    // Connect to input frame and make a mutable copy.
+    cv::Mat frame_org = mediapipe::formats::MatView(
+        &cc->Inputs().Tag(kVideoInputTag).Get<ImageFrame>());
+    cv::Mat frame = frame_org.clone();
+    ComputeHistogram(frame, &current_histogram);
+  }
 
   if (!init_) {
     last_histogram_ = current_histogram;
@@ -179,10 +238,33 @@ absl::Status ShotBoundaryCalculator::Process(mediapipe::CalculatorContext* cc) {
 
 absl::Status ShotBoundaryCalculator::GetContract(
     mediapipe::CalculatorContract* cc) {
-  cc->Inputs().Tag(kVideoInputTag).Set<ImageFrame>();
+  RET_CHECK(cc->Inputs().HasTag(kVideoInputTag) ^
+            cc->Inputs().HasTag(kVideoGpuInputTag))
+      << "Exactly one of VIDEO and VIDEO_GPU must be present.";
+  if (cc->Inputs().HasTag(kVideoInputTag)) {
+    cc->Inputs().Tag(kVideoInputTag).Set<ImageFrame>();
+  }
+  if (cc->Inputs().HasTag(kVideoGpuInputTag)) {
+#if !MEDIAPIPE_DISABLE_GPU
+    cc->Inputs().Tag(kVideoGpuInputTag).Set<GpuBuffer>();
+    MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
+#else
+    RET_CHECK_FAIL() << "GPU processing is disabled.";
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  }
   cc->Outputs().Tag(kShotChangeTag).Set<bool>();
   return absl::OkStatus();
 }
 
+absl::Status ShotBoundaryCalculator::Close(mediapipe::CalculatorContext* cc) {
+#if !MEDIAPIPE_DISABLE_GPU && \
+    MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  if (statistics_) {
+    gpu_helper_.RunInGlContext([this] { statistics_.reset(); });
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU && MEDIAPIPE_OPENGL_ES_VERSION >= 31
+  return absl::OkStatus();
+}
+
 }  // namespace autoflip
 }  // namespace mediapipe
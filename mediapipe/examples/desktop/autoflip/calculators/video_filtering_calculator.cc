@@ -13,27 +13,46 @@
 // limitations under the License.
 
 #include <string>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "mediapipe/examples/desktop/autoflip/calculators/video_filtering_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
-#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/status_builder.h"
 
+#if !MEDIAPIPE_DISABLE_GPU
+#include "mediapipe/gpu/gpu_buffer.h"
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
 namespace mediapipe {
 namespace autoflip {
 namespace {
 constexpr char kInputFrameTag[] = "INPUT_FRAMES";
 constexpr char kOutputFrameTag[] = "OUTPUT_FRAMES";
+
+// Returns the width and height of a frame packet, without reading GPU frames
+// back.
+std::pair<int, int> FrameSize(const Packet& packet) {
+#if !MEDIAPIPE_DISABLE_GPU
+  if (packet.ValidateAsType<GpuBuffer>().ok()) {
+    const GpuBuffer& frame = packet.Get<GpuBuffer>();
+    return {frame.width(), frame.height()};
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  const ImageFrame& frame = packet.Get<ImageFrame>();
+  return {frame.Width(), frame.Height()};
+}
 }  // namespace
 
 // This calculator filters out frames based on criteria specified in the
 // options. One use case is to filter based on the aspect ratio. Future work
 // can implement more filter types.
 //
-// Input: Video frames.
+// Input: Video frames, as ImageFrames or GpuBuffers. Only the frame size is
+//   used, so GPU frames are filtered without being read back.
 // Output: Video frames that pass all filters.
 //
 // Example config:
@@ -64,8 +83,13 @@ class VideoFilteringCalculator : public CalculatorBase {
 REGISTER_CALCULATOR(VideoFilteringCalculator);
 
 absl::Status VideoFilteringCalculator::GetContract(CalculatorContract* cc) {
+#if !MEDIAPIPE_DISABLE_GPU
+  cc->Inputs().Tag(kInputFrameTag).SetOneOf<ImageFrame, GpuBuffer>();
+#else
   cc->Inputs().Tag(kInputFrameTag).Set<ImageFrame>();
-  cc->Outputs().Tag(kOutputFrameTag).Set<ImageFrame>();
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  cc->Outputs().Tag(kOutputFrameTag).SetSameAs(
+      &cc->Inputs().Tag(kInputFrameTag));
   return absl::OkStatus();
 }
 
@@ -73,7 +97,7 @@ absl::Status VideoFilteringCalculator::Process(CalculatorContext* cc) {
   const auto& options = cc->Options<VideoFilteringCalculatorOptions>();
 
   const Packet& input_packet = cc->Inputs().Tag(kInputFrameTag).Value();
-  const ImageFrame& frame = input_packet.Get<ImageFrame>();
+  const auto [frame_width, frame_height] = FrameSize(input_packet);
 
   RET_CHECK(options.has_aspect_ratio_filter());
   const auto filter_type = options.aspect_ratio_filter().filter_type();
@@ -91,8 +115,7 @@ absl::Status VideoFilteringCalculator::Process(CalculatorContext* cc) {
   RET_CHECK_GT(target_height, 0);
 
   bool should_pass = false;
-  cv::Mat frame_mat = mediapipe::formats::MatView(&frame);
-  const double ratio = static_cast<double>(frame_mat.cols) / frame_mat.rows;
+  const double ratio = static_cast<double>(frame_width) / frame_height;
   const double target_ratio = static_cast<double>(target_width) / target_height;
   if (filter_type == VideoFilteringCalculatorOptions::AspectRatioFilter::
                          UPPER_ASPECT_RATIO_THRESHOLD &&
@@ -111,7 +134,7 @@ absl::Status VideoFilteringCalculator::Process(CalculatorContext* cc) {
     return mediapipe::UnknownErrorBuilder(MEDIAPIPE_LOC) << absl::Substitute(
                "Failing due to aspect ratio. Target aspect ratio: $0. Frame "
                "width: $1, height: $2.",
-               target_ratio, frame.Width(), frame.Height());
+               target_ratio, frame_width, frame_height);
   }
 
   return absl::OkStatus();
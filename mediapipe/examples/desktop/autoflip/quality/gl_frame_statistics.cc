@@ -0,0 +1,288 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/examples/desktop/autoflip/quality/gl_frame_statistics.h"
+
+#include "mediapipe/framework/port.h"
+
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/gpu/gl_base.h"
+#include "mediapipe/gpu/shader_util.h"
+
+namespace mediapipe {
+namespace autoflip {
+
+namespace {
+
+// Accumulates the histogram of each 16x16 block in shared memory first, to
+// limit the contention on the global bins.
+constexpr char kHistogramShader[] = R"(#version 310 es
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0) uniform highp sampler2D frame;
+layout(location = 1) uniform int num_bins;
+
+layout(std430, binding = 0) buffer Output {
+  uint data[];
+} histogram;
+
+shared uint block_histogram[256];
+
+void main() {
+  uint index = gl_LocalInvocationIndex;
+  block_histogram[index] = 0u;
+  memoryBarrierShared();
+  barrier();
+
+  ivec2 xy = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 size = textureSize(frame, 0);
+  if (xy.x < size.x && xy.y < size.y) {
+    ivec4 value = ivec4(texelFetch(frame, xy, 0) * 255.0 + 0.5);
+    int bin = (value.x * num_bins / 256) * num_bins + value.y * num_bins / 256;
+    atomicAdd(block_histogram[bin], 1u);
+  }
+  memoryBarrierShared();
+  barrier();
+
+  uint count = block_histogram[index];
+  if (count > 0u) {
+    atomicAdd(histogram.data[index], count);
+  }
+})";
+
+// Counts the matching pixels of a row segment in shared memory first.
+constexpr char kCountShader[] = R"(#version 310 es
+layout(local_size_x = 64, local_size_y = 1) in;
+
+layout(binding = 0) uniform highp sampler2D frame;
+layout(location = 1) uniform int first_row;
+layout(location = 2) uniform ivec3 color;
+layout(location = 3) uniform int tolerance;
+
+layout(std430, binding = 0) buffer Output {
+  uint data[];
+} counts;
+
+shared uint block_count;
+
+void main() {
+  if (gl_LocalInvocationIndex == 0u) {
+    block_count = 0u;
+  }
+  memoryBarrierShared();
+  barrier();
+
+  int x = int(gl_GlobalInvocationID.x);
+  int row = int(gl_GlobalInvocationID.y);
+  if (x < textureSize(frame, 0).x) {
+    ivec3 value = ivec3(
+        texelFetch(frame, ivec2(x, first_row + row), 0).xyz * 255.0 + 0.5);
+    if (all(lessThanEqual(abs(value - color), ivec3(tolerance)))) {
+      atomicAdd(block_count, 1u);
+    }
+  }
+  memoryBarrierShared();
+  barrier();
+
+  if (gl_LocalInvocationIndex == 0u && block_count > 0u) {
+    atomicAdd(counts.data[row], block_count);
+  }
+})";
+
+// Samples the region at the centers of the output pixels, like cv::resize
+// with INTER_LINEAR, and packs the first three channels of each pixel.
+constexpr char kReadShader[] = R"(#version 310 es
+layout(local_size_x = 16, local_size_y = 16) in;
+
+layout(binding = 0) uniform highp sampler2D frame;
+// Left, top, width and height of the region in pixels.
+layout(location = 1) uniform vec4 region;
+layout(location = 2) uniform ivec2 size;
+
+layout(std430, binding = 0) writeonly buffer Output {
+  uint data[];
+} pixels;
+
+void main() {
+  ivec2 xy = ivec2(gl_GlobalInvocationID.xy);
+  if (xy.x >= size.x || xy.y >= size.y) {
+    return;
+  }
+  vec2 position = region.xy + (vec2(xy) + 0.5) * region.zw / vec2(size);
+  uvec4 value = uvec4(
+      textureLod(frame, position / vec2(textureSize(frame, 0)), 0.0) * 255.0 +
+      0.5);
+  pixels.data[xy.y * size.x + xy.x] =
+      value.x | (value.y << 8) | (value.z << 16);
+})";
+
+absl::StatusOr<GLuint> CreateComputeProgram(const char* source) {
+  GLuint shader = 0;
+  RET_CHECK(GlhCompileShader(GL_COMPUTE_SHADER, source, &shader))
+      << "Failed to compile compute shader.";
+  const GLuint program = glCreateProgram();
+  glAttachShader(program, shader);
+  glDeleteShader(shader);
+  if (!GlhLinkProgram(program)) {
+    glDeleteProgram(program);
+    return absl::InternalError("Failed to link compute shader.");
+  }
+  return program;
+}
+
+absl::Status BindFrame(const GlTexture& frame) {
+  RET_CHECK_EQ(frame.target(), GL_TEXTURE_2D)
+      << "Only 2D textures are supported.";
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, frame.name());
+  return absl::OkStatus();
+}
+
+int DivideRoundUp(int n, int divisor) { return (n + divisor - 1) / divisor; }
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<GlFrameStatistics>> GlFrameStatistics::Create() {
+  std::unique_ptr<GlFrameStatistics> statistics(new GlFrameStatistics());
+  MP_RETURN_IF_ERROR(statistics->Initialize());
+  return statistics;
+}
+
+GlFrameStatistics::~GlFrameStatistics() {
+  glDeleteProgram(histogram_program_);
+  glDeleteProgram(count_program_);
+  glDeleteProgram(read_program_);
+  glDeleteBuffers(1, &buffer_);
+}
+
+absl::Status GlFrameStatistics::Initialize() {
+  ASSIGN_OR_RETURN(histogram_program_, CreateComputeProgram(kHistogramShader));
+  ASSIGN_OR_RETURN(count_program_, CreateComputeProgram(kCountShader));
+  ASSIGN_OR_RETURN(read_program_, CreateComputeProgram(kReadShader));
+  glGenBuffers(1, &buffer_);
+  return absl::OkStatus();
+}
+
+void GlFrameStatistics::PrepareBuffer(int size) {
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer_);
+  if (size > buffer_size_) {
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_READ);
+    buffer_size_ = size;
+  }
+  const std::vector<uint8_t> zeros(size, 0);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, zeros.data());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer_);
+}
+
+absl::Status GlFrameStatistics::ReadBuffer(int size, void* data) {
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer_);
+  const void* mapped =
+      glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, GL_MAP_READ_BIT);
+  RET_CHECK(mapped) << "Failed to map the storage buffer.";
+  std::memcpy(data, mapped, size);
+  glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  return absl::OkStatus();
+}
+
+absl::Status GlFrameStatistics::ComputeHistogram(const GlTexture& frame,
+                                                 int num_bins,
+                                                 cv::Mat* histogram) {
+  RET_CHECK(num_bins > 0 && num_bins <= 16)
+      << "Number of histogram bins is not in [1, 16].";
+  const int num_cells = num_bins * num_bins;
+  MP_RETURN_IF_ERROR(BindFrame(frame));
+  PrepareBuffer(num_cells * sizeof(uint32_t));
+  glUseProgram(histogram_program_);
+  glUniform1i(1, num_bins);
+  glDispatchCompute(DivideRoundUp(frame.width(), 16),
+                    DivideRoundUp(frame.height(), 16), 1);
+  std::vector<uint32_t> counts(num_cells);
+  MP_RETURN_IF_ERROR(ReadBuffer(num_cells * sizeof(uint32_t), counts.data()));
+  histogram->create(num_bins, num_bins, CV_32F);
+  for (int i = 0; i < num_cells; ++i) {
+    histogram->at<float>(i / num_bins, i % num_bins) = counts[i];
+  }
+  return absl::OkStatus();
+}
+
+absl::Status GlFrameStatistics::CountMatchingPixels(const GlTexture& frame,
+                                                    int first_row,
+                                                    int num_rows,
+                                                    const cv::Vec3i& color,
+                                                    int tolerance,
+                                                    std::vector<int>* counts) {
+  RET_CHECK(first_row >= 0 && first_row + num_rows <= frame.height())
+      << "Rows are out of the frame.";
+  counts->assign(num_rows, 0);
+  if (num_rows <= 0) {
+    return absl::OkStatus();
+  }
+  MP_RETURN_IF_ERROR(BindFrame(frame));
+  PrepareBuffer(num_rows * sizeof(uint32_t));
+  glUseProgram(count_program_);
+  glUniform1i(1, first_row);
+  glUniform3i(2, color[0], color[1], color[2]);
+  glUniform1i(3, tolerance);
+  glDispatchCompute(DivideRoundUp(frame.width(), 64), num_rows, 1);
+  std::vector<uint32_t> row_counts(num_rows);
+  MP_RETURN_IF_ERROR(
+      ReadBuffer(num_rows * sizeof(uint32_t), row_counts.data()));
+  counts->assign(row_counts.begin(), row_counts.end());
+  return absl::OkStatus();
+}
+
+absl::Status GlFrameStatistics::ReadRegion(const GlTexture& frame,
+                                           const cv::Rect& region,
+                                           const cv::Size& size,
+                                           cv::Mat* image) {
+  if (size.empty()) {
+    image->create(size, CV_8UC3);
+    return absl::OkStatus();
+  }
+  MP_RETURN_IF_ERROR(BindFrame(frame));
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  const int buffer_size = size.area() * sizeof(uint32_t);
+  PrepareBuffer(buffer_size);
+  glUseProgram(read_program_);
+  glUniform4f(1, region.x, region.y, region.width, region.height);
+  glUniform2i(2, size.width, size.height);
+  glDispatchCompute(DivideRoundUp(size.width, 16),
+                    DivideRoundUp(size.height, 16), 1);
+  // The packed pixels are laid out as 4-channel pixels in memory.
+  cv::Mat packed(size, CV_8UC4);
+  MP_RETURN_IF_ERROR(ReadBuffer(buffer_size, packed.data));
+  cv::cvtColor(packed, *image, cv::COLOR_RGBA2RGB);
+  return absl::OkStatus();
+}
+
+}  // namespace autoflip
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
@@ -0,0 +1,92 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_GL_FRAME_STATISTICS_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_GL_FRAME_STATISTICS_H_
+
+#include "mediapipe/framework/port.h"
+
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/gpu/gl_base.h"
+#include "mediapipe/gpu/gl_calculator_helper.h"
+
+namespace mediapipe {
+namespace autoflip {
+
+// Computes the statistics the AutoFlip signal calculators need from frames on
+// the GPU with OpenGL ES 3.1 compute shaders, so that only the statistics are
+// read back instead of the whole frames. Texture channels are in the memory
+// order of the ImageFrame the frame would be read back into, e.g. RGB for an
+// SRGB frame.
+//
+// The object must be created, used and destroyed in the same GL context.
+class GlFrameStatistics {
+ public:
+  static absl::StatusOr<std::unique_ptr<GlFrameStatistics>> Create();
+  ~GlFrameStatistics();
+
+  // Computes a 2D histogram of the first two channels of `frame`, with
+  // `num_bins` uniform bins over [0, 256) per channel, as cv::calcHist does
+  // for channels {0, 1} of the frame. `histogram` is a `num_bins` x
+  // `num_bins` CV_32F matrix indexed by the bins of the first and second
+  // channels. Supports up to 16 bins.
+  absl::Status ComputeHistogram(const GlTexture& frame, int num_bins,
+                                cv::Mat* histogram);
+
+  // Counts the pixels of each of the rows [first_row, first_row + num_rows)
+  // of `frame` whose first three channels all differ from `color` by at most
+  // `tolerance`.
+  absl::Status CountMatchingPixels(const GlTexture& frame, int first_row,
+                                   int num_rows, const cv::Vec3i& color,
+                                   int tolerance, std::vector<int>* counts);
+
+  // Reads `region` of `frame` back, bilinearly resized to `size`, into a
+  // CV_8UC3 `image`.
+  absl::Status ReadRegion(const GlTexture& frame, const cv::Rect& region,
+                          const cv::Size& size, cv::Mat* image);
+
+ private:
+  GlFrameStatistics() = default;
+
+  absl::Status Initialize();
+
+  // Clears the first `size` bytes of the storage buffer, growing it if
+  // needed, and binds it to binding point 0.
+  void PrepareBuffer(int size);
+
+  // Waits for the dispatched shaders and copies the first `size` bytes of
+  // the storage buffer to `data`.
+  absl::Status ReadBuffer(int size, void* data);
+
+  GLuint histogram_program_ = 0;
+  GLuint count_program_ = 0;
+  GLuint read_program_ = 0;
+  // Storage buffer of the shader outputs, shared by all the programs.
+  GLuint buffer_ = 0;
+  int buffer_size_ = 0;
+};
+
+}  // namespace autoflip
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_GL_FRAME_STATISTICS_H_
@@ -14,6 +14,8 @@
 
 #include "mediapipe/examples/desktop/autoflip/quality/padding_effect_generator.h"
 
+#include <algorithm>
+
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
@@ -94,11 +96,8 @@ absl::Status PaddingEffectGenerator::Process(
     // Blur.
     const int cv_size =
         blur_cv_size % 2 == 1 ? blur_cv_size : (blur_cv_size + 1);
-    const cv::Size kernel(cv_size, cv_size);
-    // TODO: the larger the kernel size, the slower the blurring
-    // operation is. Consider running multiple sequential blurs with smaller
-    // sizes to simulate the effect of using a large size. This might be able to
-    // speed up the process.
+    // Note: the larger the kernel size, the slower the blurring operation is,
+    // unless a max blur kernel size is set to blur at a reduced resolution.
     x = 0;
     width = effective_output_width;
     const cv::Rect canvas_rect(0, 0, canvas.cols, canvas.rows);
@@ -109,7 +108,7 @@ absl::Status PaddingEffectGenerator::Process(
         cv::Rect(x, y, width, height) & canvas_rect;
     if (top_blur_region.area() > 0) {
       cv::Mat top_blurred = canvas(top_blur_region);
-      cv::GaussianBlur(top_blurred, top_blurred, kernel, 0, 0);
+      BlurRegion(cv_size, &top_blurred);
     }
     // Blur the bottom region (below foreground).
     y = height + foreground_height - cv_size;
@@ -118,7 +117,7 @@ absl::Status PaddingEffectGenerator::Process(
         cv::Rect(x, y, width, height) & canvas_rect;
     if (bottom_blur_region.area() > 0) {
       cv::Mat bottom_blurred = canvas(bottom_blur_region);
-      cv::GaussianBlur(bottom_blurred, bottom_blurred, kernel, 0, 0);
+      BlurRegion(cv_size, &bottom_blurred);
     }
 
     const float kEqualThreshold = 0.0001f;
@@ -127,11 +126,10 @@ absl::Status PaddingEffectGenerator::Process(
       canvas *= background_contrast;
     }
 
-    // Alpha blend a translucent black layer.
+    // Alpha blend a translucent black layer, which amounts to scaling the
+    // background.
     if (std::abs(overlay_opacity - 0.0f) > kEqualThreshold) {
-      cv::Mat overlay = cv::Mat::zeros(canvas.size(), canvas.type());
-      cv::addWeighted(overlay, overlay_opacity, canvas, 1 - overlay_opacity, 0,
-                      canvas);
+      canvas.convertTo(canvas, -1, 1 - overlay_opacity);
     }
   }
 
@@ -173,6 +171,25 @@ absl::Status PaddingEffectGenerator::Process(
   return absl::OkStatus();
 }
 
+void PaddingEffectGenerator::BlurRegion(int cv_size, cv::Mat* region) const {
+  if (max_blur_kernel_size_ <= 0 || cv_size <= max_blur_kernel_size_) {
+    cv::GaussianBlur(*region, *region, cv::Size(cv_size, cv_size), 0, 0);
+    return;
+  }
+
+  // Blur at the resolution where the kernel is max_blur_kernel_size_ large,
+  // and upsample into the region, whose size and type are kept by resize.
+  const double scale = static_cast<double>(max_blur_kernel_size_) / cv_size;
+  const cv::Size small_size(std::max(1, cvRound(region->cols * scale)),
+                            std::max(1, cvRound(region->rows * scale)));
+  cv::Mat small;
+  cv::resize(*region, small, small_size, 0, 0, cv::INTER_AREA);
+  const int small_cv_size = std::max(1, cvRound(cv_size * scale)) | 1;
+  cv::GaussianBlur(small, small, cv::Size(small_cv_size, small_cv_size), 0,
+                   0);
+  cv::resize(small, *region, region->size(), 0, 0, cv::INTER_LINEAR);
+}
+
 cv::Rect PaddingEffectGenerator::ComputeOutputLocation() {
   const int effective_input_width =
       is_vertical_padding_ ? input_width_ : input_height_;
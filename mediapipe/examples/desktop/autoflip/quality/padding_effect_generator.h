@@ -58,13 +58,26 @@ class PaddingEffectGenerator {
   // location is to be placed.  For use with external rendering soutions.
   cv::Rect ComputeOutputLocation();
 
+  // If positive, background blurs with kernels larger than this size are
+  // computed on a downscaled background, at which the kernel is at most this
+  // large, and upsampled. This is much faster for the large kernels used for
+  // padding, at the cost of a slightly different background. Defaults to 0,
+  // i.e. blurring at full resolution.
+  void SetMaxBlurKernelSize(int max_blur_kernel_size) {
+    max_blur_kernel_size_ = max_blur_kernel_size;
+  }
+
  private:
+  // Blurs `region` in place with a kernel of size `cv_size`.
+  void BlurRegion(int cv_size, cv::Mat* region) const;
+
   double target_aspect_ratio_;
   int input_width_ = -1;
   int input_height_ = -1;
   int output_width_ = -1;
   int output_height_ = -1;
   bool is_vertical_padding_;
+  int max_blur_kernel_size_ = 0;
 };
 
 }  // namespace autoflip
@@ -186,6 +186,34 @@ TEST(PaddingEffectGeneratorTest, ScaleToMultipleOfTwo) {
   EXPECT_EQ(result_frame.Height(), expect_height);
 }
 
+TEST(PaddingEffectGeneratorTest, ReducedResolutionBlurIsSimilar) {
+  // A smooth gradient, whose blur hardly depends on the resolution.
+  ImageFrame test_frame(ImageFormat::SRGB, 320, 180);
+  cv::Mat test_mat = formats::MatView(&test_frame);
+  for (int y = 0; y < test_mat.rows; ++y) {
+    for (int x = 0; x < test_mat.cols; ++x) {
+      test_mat.at<cv::Vec3b>(y, x) = cv::Vec3b(x * 255 / 320, y, 128);
+    }
+  }
+
+  ImageFrame full_frame;
+  PaddingEffectGenerator full_generator(320, 180, 0.6);
+  MP_ASSERT_OK(full_generator.Process(test_frame, 0.8, 60, 0.5, &full_frame));
+
+  ImageFrame reduced_frame;
+  PaddingEffectGenerator reduced_generator(320, 180, 0.6);
+  reduced_generator.SetMaxBlurKernelSize(15);
+  MP_ASSERT_OK(
+      reduced_generator.Process(test_frame, 0.8, 60, 0.5, &reduced_frame));
+
+  cv::Mat full_mat = formats::MatView(&full_frame);
+  cv::Mat reduced_mat = formats::MatView(&reduced_frame);
+  ASSERT_EQ(full_mat.size(), reduced_mat.size());
+  const double mean_abs_diff = cv::norm(full_mat, reduced_mat, cv::NORM_L1) /
+                               (full_mat.total() * full_mat.channels());
+  EXPECT_LT(mean_abs_diff, 2.0);
+}
+
 TEST(PaddingEffectGeneratorTest, ComputeOutputLocation) {
   PaddingEffectGenerator generator(1920, 1080, 1.0);
 
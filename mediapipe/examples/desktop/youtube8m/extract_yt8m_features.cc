@@ -16,16 +16,24 @@
 // from files provided via the command line and output side packets are written
 // to disk.
 #include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/strings/str_split.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/graph_pool.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/map_util.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/util/sequence/media_sequence.h"
+#include "tensorflow/core/example/example.pb.h"
 
 ABSL_FLAG(std::string, calculator_graph_config_file, "",
           "Name of file containing text format CalculatorGraphConfig proto.");
@@ -38,6 +46,68 @@ ABSL_FLAG(std::string, output_side_packets, "",
           "Comma-separated list of key=value pairs specifying the output "
           "side packets and paths to write to disk for the "
           "CalculatorGraph.");
+ABSL_FLAG(int, num_shards, 1,
+          "Number of graphs extracting the features of consecutive parts of "
+          "the clip in parallel. The output sequence examples of the parts "
+          "are merged into one.");
+ABSL_FLAG(int64_t, shard_alignment_usec, 1000000,
+          "Shard boundaries are multiples of this period after the clip "
+          "start. Use a multiple of the frame sampling period so that the "
+          "shards sample the same frames as a single graph.");
+
+constexpr char kInputSequenceExample[] = "input_sequence_example";
+
+// Runs one graph per shard of the input sequence example, all sharing one
+// thread pool, and returns the named output side packets of the shards as
+// merged serialized sequence examples.
+absl::Status RunShardedGraphs(
+    const mediapipe::CalculatorGraphConfig& config,
+    const std::map<std::string, mediapipe::Packet>& input_side_packets,
+    const std::vector<std::string>& output_names,
+    std::map<std::string, std::string>* outputs) {
+  RET_CHECK(mediapipe::ContainsKey(input_side_packets, kInputSequenceExample))
+      << "Sharding requires the " << kInputSequenceExample << " side packet.";
+  tensorflow::SequenceExample input_sequence;
+  RET_CHECK(input_sequence.ParseFromString(
+      input_side_packets.at(kInputSequenceExample).Get<std::string>()));
+  ASSIGN_OR_RETURN(const auto shard_inputs,
+                   mediapipe::mediasequence::ShardSequenceByTime(
+                       input_sequence, absl::GetFlag(FLAGS_num_shards),
+                       absl::GetFlag(FLAGS_shard_alignment_usec)));
+
+  LOG(INFO) << "Run " << shard_inputs.size() << " shards.";
+  ASSIGN_OR_RETURN(auto pool, mediapipe::GraphPool::Create({}));
+  std::vector<std::unique_ptr<mediapipe::CalculatorGraph>> graphs;
+  for (const auto& shard_input : shard_inputs) {
+    std::map<std::string, mediapipe::Packet> shard_side_packets =
+        input_side_packets;
+    shard_side_packets[kInputSequenceExample] =
+        mediapipe::MakePacket<std::string>(shard_input.SerializeAsString());
+    ASSIGN_OR_RETURN(auto graph, pool->CreateGraph(config, shard_side_packets));
+    MP_RETURN_IF_ERROR(graph->StartRun({}));
+    graphs.push_back(std::move(graph));
+  }
+  for (auto& graph : graphs) {
+    MP_RETURN_IF_ERROR(graph->WaitUntilDone());
+  }
+
+  for (const std::string& name : output_names) {
+    std::vector<tensorflow::SequenceExample> shard_outputs(graphs.size());
+    for (int i = 0; i < graphs.size(); ++i) {
+      absl::StatusOr<mediapipe::Packet> output_packet =
+          graphs[i]->GetOutputSidePacket(name);
+      RET_CHECK(output_packet.ok())
+          << "Packet " << name << " was not available.";
+      RET_CHECK(shard_outputs[i].ParseFromString(
+          output_packet.value().Get<std::string>()));
+    }
+    tensorflow::SequenceExample merged;
+    MP_RETURN_IF_ERROR(
+        mediapipe::mediasequence::MergeSequenceShards(shard_outputs, &merged));
+    (*outputs)[name] = merged.SerializeAsString();
+  }
+  return absl::OkStatus();
+}
 
 absl::Status RunMPPGraph() {
   std::string calculator_graph_config_contents;
@@ -102,24 +172,38 @@ absl::Status RunMPPGraph() {
   input_side_packets["vggish_pca_projection_matrix"] =
       mediapipe::MakePacket<mediapipe::Matrix>(vggish_pca_projection_matrix);
 
-  LOG(INFO) << "Initialize the calculator graph.";
-  mediapipe::CalculatorGraph graph;
-  MP_RETURN_IF_ERROR(graph.Initialize(config, input_side_packets));
-  LOG(INFO) << "Start running the calculator graph.";
-  MP_RETURN_IF_ERROR(graph.Run());
-  LOG(INFO) << "Gathering output side packets.";
+  std::vector<std::string> output_names;
+  std::vector<std::string> output_paths;
   kv_pairs = absl::StrSplit(absl::GetFlag(FLAGS_output_side_packets), ',');
   for (const std::string& kv_pair : kv_pairs) {
     std::vector<std::string> name_and_value = absl::StrSplit(kv_pair, '=');
     RET_CHECK(name_and_value.size() == 2);
-    absl::StatusOr<mediapipe::Packet> output_packet =
-        graph.GetOutputSidePacket(name_and_value[0]);
-    RET_CHECK(output_packet.ok())
-        << "Packet " << name_and_value[0] << " was not available.";
-    const std::string& serialized_string =
-        output_packet.value().Get<std::string>();
+    output_names.push_back(name_and_value[0]);
+    output_paths.push_back(name_and_value[1]);
+  }
+
+  std::map<std::string, std::string> outputs;
+  if (absl::GetFlag(FLAGS_num_shards) > 1) {
     MP_RETURN_IF_ERROR(
-        mediapipe::file::SetContents(name_and_value[1], serialized_string));
+        RunShardedGraphs(config, input_side_packets, output_names, &outputs));
+  } else {
+    LOG(INFO) << "Initialize the calculator graph.";
+    mediapipe::CalculatorGraph graph;
+    MP_RETURN_IF_ERROR(graph.Initialize(config, input_side_packets));
+    LOG(INFO) << "Start running the calculator graph.";
+    MP_RETURN_IF_ERROR(graph.Run());
+    for (const std::string& name : output_names) {
+      absl::StatusOr<mediapipe::Packet> output_packet =
+          graph.GetOutputSidePacket(name);
+      RET_CHECK(output_packet.ok())
+          << "Packet " << name << " was not available.";
+      outputs[name] = output_packet.value().Get<std::string>();
+    }
+  }
+  LOG(INFO) << "Gathering output side packets.";
+  for (int i = 0; i < output_names.size(); ++i) {
+    MP_RETURN_IF_ERROR(mediapipe::file::SetContents(
+        output_paths[i], outputs[output_names[i]]));
   }
   return absl::OkStatus();
 }
@@ -83,6 +83,8 @@ class PacketGenerator;
 struct SourceBase;
 struct DestinationBase {
   SourceBase* source = nullptr;
+  // Set for inputs that close a loop in the graph.
+  bool back_edge = false;
 };
 struct SourceBase {
   std::vector<DestinationBase*> dests_;
@@ -145,6 +147,14 @@ class DestinationImpl {
     return DestinationImpl<IsSide, U>(&base_);
   }
 
+  // Marks the input stream as a back edge, e.g. to feed the previous output of
+  // a downstream node back to an upstream one.
+  DestinationImpl& AsBackEdge() {
+    static_assert(!IsSide, "Only input streams can be back edges.");
+    base_.back_edge = true;
+    return *this;
+  }
+
  private:
   DestinationBase& base_;
 
@@ -717,6 +727,11 @@ class Graph {
         [&](const TagIndexLocation& loc, const DestinationBase& endpoint) {
           CHECK(endpoint.source != nullptr);
           config->add_input_stream(TaggedName(loc, endpoint.source->name_));
+          if (endpoint.back_edge) {
+            auto* info = config->add_input_stream_info();
+            info->set_tag_index(absl::StrCat(loc.tag, ":", loc.index));
+            info->set_back_edge(true);
+          }
         });
     node.out_streams_.Visit(
         [&](const TagIndexLocation& loc, const SourceBase& endpoint) {
@@ -193,6 +193,37 @@ TEST(BuilderTest, FanOut) {
   EXPECT_THAT(graph.GetConfig(), EqualsProto(expected));
 }
 
+TEST(BuilderTest, BackEdge) {
+  builder::Graph graph;
+  auto& loopback = graph.AddNode("PreviousLoopbackCalculator");
+  auto& adder = graph.AddNode("FloatAdder");
+  graph.In("IN").SetName("in") >> loopback.In("MAIN");
+  graph.In("IN") >> adder.In("IN")[0];
+  loopback.Out("PREV_LOOP").SetName("prev") >> adder.In("IN")[1];
+  adder.Out("OUT").SetName("sum") >> graph.Out("OUT");
+  adder.Out("OUT") >> loopback.In("LOOP").AsBackEdge();
+
+  CalculatorGraphConfig expected =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "IN:in"
+        output_stream: "OUT:sum"
+        node {
+          calculator: "PreviousLoopbackCalculator"
+          input_stream: "LOOP:sum"
+          input_stream: "MAIN:in"
+          output_stream: "PREV_LOOP:prev"
+          input_stream_info { tag_index: "LOOP:0" back_edge: true }
+        }
+        node {
+          calculator: "FloatAdder"
+          input_stream: "IN:0:in"
+          input_stream: "IN:1:prev"
+          output_stream: "OUT:sum"
+        }
+      )pb");
+  EXPECT_THAT(graph.GetConfig(), EqualsProto(expected));
+}
+
 TEST(BuilderTest, TypedMultiple) {
   builder::Graph graph;
   auto& foo = graph.AddNode<Foo>();
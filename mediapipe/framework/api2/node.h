@@ -24,6 +24,24 @@ class Node : public CalculatorBase {
   virtual ~Node();
 };
 
+// A node whose Process() completes asynchronously, for calculators that wait
+// on I/O or an accelerator: ProcessAsync() starts the work on the inputs of
+// `cc` and returns, and `done` is called from any thread once the outputs are
+// added to `cc`. The executor thread is free meanwhile, and up to
+// max_in_flight calls can wait at once. See
+// CalculatorContext::DeferProcessCompletion().
+class AsyncNode : public Node {
+ public:
+  using Done = std::function<void(absl::Status)>;
+
+  virtual void ProcessAsync(CalculatorContext* cc, Done done) = 0;
+
+  absl::Status Process(CalculatorContext* cc) final {
+    ProcessAsync(cc, cc->DeferProcessCompletion());
+    return absl::OkStatus();
+  }
+};
+
 }  // namespace api2
 
 namespace internal {
@@ -80,15 +98,18 @@ struct ForceStaticInstantiation {
 #endif  // _MSC_VER
 };
 
-// Helper template for forcing the definition of a static registration token.
+// Helper template for forcing the definition of a static registration.
+// T is only accessed in member functions, since it can still be incomplete
+// when the registration is instantiated.
 template <typename T>
 struct NodeRegistrationStatic {
-  static NoDestructor<mediapipe::RegistrationToken> registration;
+  static NoDestructor<mediapipe::CalculatorBaseRegistry::StaticRegistration>
+      registration;
 
-  static mediapipe::RegistrationToken Make() {
-    return mediapipe::CalculatorBaseRegistry::Register(
-        T::kCalculatorName,
-        absl::make_unique<mediapipe::internal::CalculatorBaseFactoryFor<T>>);
+  static const char* Name() { return T::kCalculatorName; }
+  static std::unique_ptr<mediapipe::internal::CalculatorBaseFactory> Create() {
+    return absl::make_unique<
+        mediapipe::internal::CalculatorBaseFactoryFor<T>>();
   }
 
   using RequireStatics = ForceStaticInstantiation<&registration>;
@@ -96,25 +117,26 @@ struct NodeRegistrationStatic {
 
 // Static members of template classes can be defined in the header.
 template <typename T>
-NoDestructor<mediapipe::RegistrationToken>
-    NodeRegistrationStatic<T>::registration(NodeRegistrationStatic<T>::Make());
+NoDestructor<mediapipe::CalculatorBaseRegistry::StaticRegistration>
+    NodeRegistrationStatic<T>::registration(NodeRegistrationStatic<T>::Name(),
+                                            NodeRegistrationStatic<T>::Create);
 
 template <typename T>
 struct SubgraphRegistrationImpl {
-  static NoDestructor<mediapipe::RegistrationToken> registration;
+  static NoDestructor<mediapipe::SubgraphRegistry::StaticRegistration>
+      registration;
 
-  static mediapipe::RegistrationToken Make() {
-    return mediapipe::SubgraphRegistry::Register(T::kCalculatorName,
-                                                 absl::make_unique<T>);
-  }
+  static const char* Name() { return T::kCalculatorName; }
+  static std::unique_ptr<Subgraph> Create() { return absl::make_unique<T>(); }
 
   using RequireStatics = ForceStaticInstantiation<&registration>;
 };
 
 template <typename T>
-NoDestructor<mediapipe::RegistrationToken>
+NoDestructor<mediapipe::SubgraphRegistry::StaticRegistration>
     SubgraphRegistrationImpl<T>::registration(
-        SubgraphRegistrationImpl<T>::Make());
+        SubgraphRegistrationImpl<T>::Name(),
+        SubgraphRegistrationImpl<T>::Create);
 
 }  // namespace internal
 
@@ -223,23 +245,23 @@ class SubgraphImpl : public Subgraph, public Intf {
 
 // This macro is used to register a calculator that does not use automatic
 // registration. Deprecated.
-#define MEDIAPIPE_NODE_IMPLEMENTATION(Impl)                                  \
-  static mediapipe::NoDestructor<mediapipe::RegistrationToken>               \
-  REGISTRY_STATIC_VAR(calculator_registration,                               \
-                      __LINE__)(mediapipe::CalculatorBaseRegistry::Register( \
-      Impl::kCalculatorName,                                                 \
-      absl::make_unique<mediapipe::internal::CalculatorBaseFactoryFor<Impl>>))
+#define MEDIAPIPE_NODE_IMPLEMENTATION(Impl)                                    \
+  static mediapipe::NoDestructor<                                              \
+      mediapipe::CalculatorBaseRegistry::StaticRegistration>                   \
+  REGISTRY_STATIC_VAR(calculator_registration, __LINE__)(                      \
+      Impl::kCalculatorName,                                                   \
+      absl::make_unique<mediapipe::internal::CalculatorBaseFactoryFor<Impl>>)
 
 // This macro is used to register a non-split-contract calculator. Deprecated.
 #define MEDIAPIPE_REGISTER_NODE(name) REGISTER_CALCULATOR(name)
 
 // This macro is used to define a subgraph that does not use automatic
 // registration. Deprecated.
-#define MEDIAPIPE_SUBGRAPH_IMPLEMENTATION(Impl)                        \
-  static mediapipe::NoDestructor<mediapipe::RegistrationToken>         \
-  REGISTRY_STATIC_VAR(subgraph_registration,                           \
-                      __LINE__)(mediapipe::SubgraphRegistry::Register( \
-      Impl::kCalculatorName, absl::make_unique<Impl>))
+#define MEDIAPIPE_SUBGRAPH_IMPLEMENTATION(Impl)                                \
+  static mediapipe::NoDestructor<                                              \
+      mediapipe::SubgraphRegistry::StaticRegistration>                         \
+  REGISTRY_STATIC_VAR(subgraph_registration, __LINE__)(Impl::kCalculatorName,  \
+                                                       absl::make_unique<Impl>)
 
 }  // namespace api2
 }  // namespace mediapipe
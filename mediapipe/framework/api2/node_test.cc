@@ -1,7 +1,9 @@
 #include "mediapipe/framework/api2/node.h"
 
+#include <thread>  // NOLINT
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/framework/api2/port.h"
@@ -578,6 +580,91 @@ struct LogSinkNode : public Node {
 };
 MEDIAPIPE_REGISTER_NODE(LogSinkNode);
 
+// Doubles its input on another thread, or inline with the SYNC side packet.
+// Fails on negative inputs.
+struct AsyncDoubler : public AsyncNode {
+  static constexpr Input<int> kIn{"IN"};
+  static constexpr SideInput<bool>::Optional kSync{"SYNC"};
+  static constexpr Output<int> kOut{"OUT"};
+
+  MEDIAPIPE_NODE_CONTRACT(kIn, kSync, kOut);
+
+  ~AsyncDoubler() override {
+    for (auto& thread : threads_) thread.join();
+  }
+
+  void ProcessAsync(CalculatorContext* cc, Done done) override {
+    auto run = [cc, done = std::move(done)] {
+      const int value = *kIn(cc);
+      if (value < 0) {
+        done(absl::InvalidArgumentError("negative input"));
+        return;
+      }
+      kOut(cc).Send(value * 2);
+      done(absl::OkStatus());
+    };
+    if (kSync(cc).GetOr(false)) {
+      run();
+    } else {
+      threads_.emplace_back(std::move(run));
+    }
+  }
+
+  std::vector<std::thread> threads_;
+};
+MEDIAPIPE_REGISTER_NODE(AsyncDoubler);
+
+absl::Status RunAsyncDoubler(bool sync, const std::vector<int>& inputs,
+                             std::vector<mediapipe::Packet>* out_packets) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        input_side_packet: "sync"
+        node {
+          calculator: "AsyncDoubler"
+          input_stream: "IN:in"
+          input_side_packet: "SYNC:sync"
+          output_stream: "OUT:out"
+        }
+        node {
+          calculator: "IntForwarder"
+          input_stream: "IN:out"
+          output_stream: "OUT:out2"
+        }
+      )pb");
+  tool::AddVectorSink("out2", &config, out_packets);
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config, {}));
+  MP_RETURN_IF_ERROR(
+      graph.StartRun({{"sync", mediapipe::MakePacket<bool>(sync)}}));
+  for (int i = 0; i < inputs.size(); ++i) {
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        "in", mediapipe::MakePacket<int>(inputs[i]).At(Timestamp(i))));
+  }
+  // The graph isn't idle while a Process() call waits for its completion.
+  MP_RETURN_IF_ERROR(graph.WaitUntilIdle());
+  EXPECT_EQ(out_packets->size(), inputs.size());
+  MP_RETURN_IF_ERROR(graph.CloseAllPacketSources());
+  return graph.WaitUntilDone();
+}
+
+TEST(NodeTest, AsyncNode) {
+  for (bool sync : {false, true}) {
+    std::vector<mediapipe::Packet> out_packets;
+    MP_EXPECT_OK(RunAsyncDoubler(sync, {1, 2, 3}, &out_packets));
+    EXPECT_THAT(PacketValues<int>(out_packets), testing::ElementsAre(2, 4, 6));
+    for (int i = 0; i < out_packets.size(); ++i) {
+      EXPECT_EQ(out_packets[i].Timestamp(), Timestamp(i));
+    }
+  }
+}
+
+TEST(NodeTest, AsyncNodeError) {
+  std::vector<mediapipe::Packet> out_packets;
+  absl::Status status = RunAsyncDoubler(/*sync=*/false, {1, -1}, &out_packets);
+  EXPECT_THAT(status.message(), testing::HasSubstr("negative input"));
+}
+
 }  // namespace test
 }  // namespace api2
 }  // namespace mediapipe
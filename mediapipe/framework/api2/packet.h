@@ -23,6 +23,7 @@ namespace api2 {
 
 using Timestamp = mediapipe::Timestamp;
 using HolderBase = mediapipe::packet_internal::HolderBase;
+using HolderPtr = mediapipe::packet_internal::HolderPtr;
 
 template <typename T>
 class Packet;
@@ -58,7 +59,8 @@ class PacketBase {
   Packet<T> As() const;
 
   // Returns the reference to the object of type T if it contains
-  // one, crashes otherwise.
+  // one, crashes otherwise. For a packet made with MakeInlinePacket, the
+  // reference points into this packet object, not into a shared payload.
   template <typename T>
   const T& Get() const;
 
@@ -81,10 +83,10 @@ class PacketBase {
   }
 
  protected:
-  explicit PacketBase(std::shared_ptr<HolderBase> payload)
+  explicit PacketBase(HolderPtr payload)
       : payload_(std::move(payload)) {}
 
-  std::shared_ptr<HolderBase> payload_;
+  HolderPtr payload_;
   Timestamp timestamp_;
 
   template <typename T>
@@ -193,7 +195,7 @@ class Packet<internal::Generic> : public PacketBase {
   Packet<internal::Generic> At(Timestamp timestamp) &&;
 
  protected:
-  explicit Packet(std::shared_ptr<HolderBase> payload)
+  explicit Packet(HolderPtr payload)
       : PacketBase(std::move(payload)) {}
 
   friend PacketBase;
@@ -210,6 +212,9 @@ class Packet : public Packet<internal::Generic> {
   Packet<T> At(Timestamp timestamp) const&;
   Packet<T> At(Timestamp timestamp) &&;
 
+  // For a packet made with MakeInlinePacket, the returned reference is only
+  // valid while this packet object is alive and not assigned to, e.g.
+  // `const int& v = *kIn(cc);` dangles. Copy such payloads instead.
   const T& Get() const {
     CHECK(payload_);
     packet_internal::Holder<T>* typed_payload = payload_->As<T>();
@@ -232,12 +237,14 @@ class Packet : public Packet<internal::Generic> {
   }
 
  private:
-  explicit Packet(std::shared_ptr<HolderBase> payload)
+  explicit Packet(HolderPtr payload)
       : Packet<internal::Generic>(std::move(payload)) {}
 
   friend PacketBase;
   template <typename U, typename... Args>
   friend Packet<U> MakePacket(Args&&... args);
+  template <typename U, typename... Args>
+  friend Packet<U> MakeInlinePacket(Args&&... args);
   template <typename U>
   friend Packet<U> PacketAdopting(const U* ptr);
   template <typename U>
@@ -379,7 +386,7 @@ class Packet<OneOf<T...>> : public PacketBase {
   }
 
  protected:
-  explicit Packet(std::shared_ptr<HolderBase> payload)
+  explicit Packet(HolderPtr payload)
       : PacketBase(std::move(payload)) {}
 
   friend PacketBase;
@@ -450,10 +457,30 @@ inline Packet<internal::Generic> Packet<internal::Generic>::At(
 
 template <typename T, typename... Args>
 Packet<T> MakePacket(Args&&... args) {
+  if constexpr (packet_internal::kProtoArenaMovable<T, Args...>) {
+    if (auto holder = packet_internal::MakeProtoArenaHolder<T>(
+            std::forward<Args>(args)...)) {
+      return Packet<T>(std::move(holder));
+    }
+  }
+  if constexpr (packet_internal::kArenaAllocatable<T>) {
+    if (const std::shared_ptr<PacketArena>* arena = PacketArena::Current()) {
+      return Packet<T>(packet_internal::MakeArenaHolder<T>(
+          *arena, std::forward<Args>(args)...));
+    }
+  }
   return Packet<T>(std::make_shared<packet_internal::Holder<T>>(
       new T(std::forward<Args>(args)...)));
 }
 
+// See mediapipe::MakeInlinePacket.
+template <typename T, typename... Args>
+Packet<T> MakeInlinePacket(Args&&... args) {
+  static_assert(packet_internal::kInlineAllocatable<T>,
+                "MakeInlinePacket needs a small trivially copyable type.");
+  return Packet<T>(HolderPtr::MakeInline<T>(std::forward<Args>(args)...));
+}
+
 template <typename T>
 Packet<T> PacketAdopting(const T* ptr) {
   return Packet<T>(std::make_shared<packet_internal::Holder<T>>(ptr));
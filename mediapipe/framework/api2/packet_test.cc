@@ -233,6 +233,18 @@ TEST(PacketTest, Consume) {
   EXPECT_FALSE(p2.IsEmpty());
 }
 
+TEST(PacketTest, InlineConsume) {
+  Packet<int> p = MakeInlinePacket<int>(3);
+  auto p2 = p;
+  // Each copy holds its own payload.
+  EXPECT_NE(&*p, &*p2);
+  auto maybe_int = p.Consume();
+  ASSERT_TRUE(maybe_int.ok());
+  EXPECT_EQ(*maybe_int.value(), 3);
+  EXPECT_TRUE(p.IsEmpty());
+  EXPECT_EQ(*p2, 3);
+}
+
 TEST(PacketTest, OneOfConsume) {
   Packet<OneOf<std::string, int>> p = MakePacket<std::string>("hi");
   EXPECT_TRUE(p.Has<std::string>());
@@ -662,6 +662,24 @@ class InputShardOrSideAccess : public Packet<T> {
 
   PacketBase Header() const { return FromOldPacket(stream_->Header()); }
 
+  // Like InputShardAccess::Consume. Side packets are shared by all the
+  // invocations of a calculator and are never consumed.
+  template <class U = T,
+            class = std::enable_if_t<std::is_same<U, T>{},
+                                     decltype(&Packet<U>::Consume)>>
+  absl::StatusOr<std::unique_ptr<U>> Consume() {
+    if (!stream_) {
+      return absl::FailedPreconditionError(
+          "Side packets cannot be consumed.");
+    }
+    stream_->Value() = {};
+    auto result = Packet<T>::Consume();
+    if (!result.ok()) {
+      stream_->Value() = ToOldPacket(*this);
+    }
+    return result;
+  }
+
  private:
   InputShardOrSideAccess(const CalculatorContext&, InputStreamShard* stream,
                          const mediapipe::Packet* packet)
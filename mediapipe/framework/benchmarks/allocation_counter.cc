@@ -0,0 +1,54 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/framework/benchmarks/allocation_counter.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace mediapipe {
+namespace {
+
+std::atomic<int64_t> allocation_count{0};
+std::atomic<int64_t> allocated_bytes{0};
+
+}  // namespace
+
+int64_t GetAllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+int64_t GetAllocatedBytes() {
+  return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+}  // namespace mediapipe
+
+// The array and nothrow forms of operator new and delete forward to these by
+// default, so they are counted as well. Over-aligned allocations are not.
+void* operator new(std::size_t size) {
+  mediapipe::allocation_count.fetch_add(1, std::memory_order_relaxed);
+  mediapipe::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) std::abort();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
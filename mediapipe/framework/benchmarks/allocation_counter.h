@@ -0,0 +1,35 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef MEDIAPIPE_FRAMEWORK_BENCHMARKS_ALLOCATION_COUNTER_H_
+#define MEDIAPIPE_FRAMEWORK_BENCHMARKS_ALLOCATION_COUNTER_H_
+
+#include <cstdint>
+
+namespace mediapipe {
+
+// Returns the number of calls to the global operator new made by all threads
+// since the program started. Binaries that depend on this library replace the
+// global operator new to maintain the count, so it should only be linked into
+// benchmarks.
+int64_t GetAllocationCount();
+
+// Returns the number of bytes requested from the global operator new since the
+// program started.
+int64_t GetAllocatedBytes();
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_BENCHMARKS_ALLOCATION_COUNTER_H_
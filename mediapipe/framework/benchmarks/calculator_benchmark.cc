@@ -0,0 +1,132 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/benchmarks/calculator_benchmark.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+#include "mediapipe/framework/benchmarks/allocation_counter.h"
+#include "mediapipe/framework/collection_item_id.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif  // defined(__linux__)
+
+namespace mediapipe {
+namespace {
+
+// Counts hardware cache misses of the calling thread, and of the threads it
+// starts while the counter is open.
+class CacheMissCounter {
+ public:
+  // Returns nullptr if the platform does not provide the counter, which is
+  // also the case in most containers and virtual machines.
+  static std::unique_ptr<CacheMissCounter> Create() {
+#if defined(__linux__)
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;
+    const int fd = syscall(SYS_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                           /*group_fd=*/-1, /*flags=*/0);
+    if (fd < 0) return nullptr;
+    return std::unique_ptr<CacheMissCounter>(new CacheMissCounter(fd));
+#else
+    return nullptr;
+#endif  // defined(__linux__)
+  }
+
+  ~CacheMissCounter() {
+#if defined(__linux__)
+    close(fd_);
+#endif  // defined(__linux__)
+  }
+
+  int64_t Read() const {
+    int64_t count = 0;
+#if defined(__linux__)
+    if (read(fd_, &count, sizeof(count)) != sizeof(count)) return 0;
+#endif  // defined(__linux__)
+    return count;
+  }
+
+ private:
+  explicit CacheMissCounter(int fd) : fd_(fd) {}
+
+  const int fd_;
+};
+
+// Returns the number of packets in the longest input stream of `runner`.
+int64_t CountInputPackets(CalculatorRunner* runner) {
+  CalculatorRunner::StreamContentsSet* inputs = runner->MutableInputs();
+  int64_t num_packets = 0;
+  for (CollectionItemId id = inputs->BeginId(); id < inputs->EndId(); ++id) {
+    num_packets =
+        std::max<int64_t>(num_packets, inputs->Get(id).packets.size());
+  }
+  return num_packets;
+}
+
+bool SkipIfError(benchmark::State& state, const absl::Status& status) {
+  if (status.ok()) return false;
+  state.SkipWithError(status.ToString().c_str());
+  return true;
+}
+
+}  // namespace
+
+void RunCalculatorBenchmark(benchmark::State& state,
+                            const CalculatorGraphConfig::Node& node_config,
+                            const CalculatorBenchmarkSetup& setup) {
+  CalculatorRunner runner(node_config);
+  if (SkipIfError(state, setup(state, &runner))) return;
+  // Builds the graph, and warms up the calculator's caches and pools.
+  if (SkipIfError(state, runner.Run())) return;
+  const int64_t num_packets = std::max<int64_t>(CountInputPackets(&runner), 1);
+
+  std::unique_ptr<CacheMissCounter> cache_misses = CacheMissCounter::Create();
+  const int64_t initial_cache_misses = cache_misses ? cache_misses->Read() : 0;
+  const int64_t initial_allocations = GetAllocationCount();
+  const int64_t initial_bytes = GetAllocatedBytes();
+  for (auto _ : state) {
+    if (SkipIfError(state, runner.Run())) return;
+  }
+  const int64_t total_packets = num_packets * state.iterations();
+  state.SetItemsProcessed(total_packets);
+  state.counters["time_per_packet"] = benchmark::Counter(
+      total_packets, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+  state.counters["allocs_per_packet"] = benchmark::Counter(
+      static_cast<double>(GetAllocationCount() - initial_allocations) /
+      total_packets);
+  state.counters["bytes_per_packet"] = benchmark::Counter(
+      static_cast<double>(GetAllocatedBytes() - initial_bytes) /
+      total_packets);
+  if (cache_misses) {
+    state.counters["cache_misses_per_packet"] = benchmark::Counter(
+        static_cast<double>(cache_misses->Read() - initial_cache_misses) /
+        total_packets);
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,65 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_BENCHMARKS_CALCULATOR_BENCHMARK_H_
+#define MEDIAPIPE_FRAMEWORK_BENCHMARKS_CALCULATOR_BENCHMARK_H_
+
+#include <functional>
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+// Adds the input packets and input side packets of a benchmark to `runner`.
+// The same packets are processed in every iteration of the benchmark.
+using CalculatorBenchmarkSetup =
+    std::function<absl::Status(benchmark::State& state,
+                               CalculatorRunner* runner)>;
+
+// Runs the calculator of `node_config` with CalculatorRunner, processing the
+// packets added by `setup` once per benchmark iteration. The graph is built
+// and run once before timing starts. Besides time per iteration, reports
+// these counters, normalized by the length of the longest input stream:
+//   time_per_packet: wall time.
+//   allocs_per_packet: heap allocations, including Open() and Close().
+//   bytes_per_packet: heap bytes allocated.
+//   cache_misses_per_packet: hardware cache misses of the benchmark thread
+//     and the threads it starts. Only reported when the platform provides
+//     perf counters.
+void RunCalculatorBenchmark(benchmark::State& state,
+                            const CalculatorGraphConfig::Node& node_config,
+                            const CalculatorBenchmarkSetup& setup);
+
+// Defines and registers a benchmark of a single calculator. `node_config` and
+// `setup` are evaluated in the body of the benchmark function, so they may
+// refer to its benchmark::State argument, `state`, e.g. to read state.range().
+// Evaluates to the registered benchmark, so that arguments can be appended:
+//
+//   MEDIAPIPE_CALCULATOR_BENCHMARK(BM_MyCalculator,
+//                                  MakeNodeConfig(state.range(0)),
+//                                  AddInputPackets)
+//       ->Arg(16)
+//       ->Arg(256);
+#define MEDIAPIPE_CALCULATOR_BENCHMARK(name, node_config, setup)      \
+  void name(::benchmark::State& state) {                              \
+    ::mediapipe::RunCalculatorBenchmark(state, (node_config), (setup)); \
+  }                                                                   \
+  BENCHMARK(name)
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_BENCHMARKS_CALCULATOR_BENCHMARK_H_
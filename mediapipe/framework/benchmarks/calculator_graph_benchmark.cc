@@ -0,0 +1,377 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Microbenchmarks of CalculatorGraph scheduling overhead. The graphs consist
+// of trivial calculators, so the measured time is almost entirely spent in the
+// framework: packet creation, input stream handling, and scheduling.
+//
+// Besides time, each benchmark reports the number of heap allocations per
+// input packet.
+//
+// Build with -c opt for meaningful numbers.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/core/end_loop_calculator.h"
+#include "mediapipe/framework/benchmarks/allocation_counter.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+
+namespace mediapipe {
+namespace {
+
+typedef EndLoopCalculator<std::vector<int>> EndLoopIntCalculator;
+REGISTER_CALCULATOR(EndLoopIntCalculator);
+
+constexpr char kInputStream[] = "in";
+constexpr char kOutputStream[] = "out";
+
+// Counts the packets of an observed output stream.
+class PacketCounter {
+ public:
+  void Increment() {
+    absl::MutexLock lock(&mutex_);
+    ++count_;
+  }
+
+  int64_t count() {
+    absl::MutexLock lock(&mutex_);
+    return count_;
+  }
+
+  // Blocks until `count` packets have been observed.
+  void WaitFor(int64_t count) {
+    absl::MutexLock lock(&mutex_);
+    const auto reached = [this, count]() { return count_ >= count; };
+    mutex_.Await(absl::Condition(&reached));
+  }
+
+ private:
+  absl::Mutex mutex_;
+  int64_t count_ = 0;
+};
+
+// Counts the allocations made while it is in scope, and reports them per
+// packet.
+class AllocationReporter {
+ public:
+  explicit AllocationReporter(benchmark::State* state)
+      : state_(state),
+        initial_count_(GetAllocationCount()) {}
+
+  void Report(int64_t num_packets) {
+    const int64_t allocations = GetAllocationCount() - initial_count_;
+    state_->counters["allocs_per_packet"] =
+        num_packets > 0 ? static_cast<double>(allocations) / num_packets : 0.0;
+  }
+
+ private:
+  benchmark::State* state_;
+  const int64_t initial_count_;
+};
+
+// Adds a node running `calculator` from `input` to `output`.
+CalculatorGraphConfig::Node* AddNode(CalculatorGraphConfig* config,
+                                     const std::string& calculator,
+                                     const std::string& input,
+                                     const std::string& output) {
+  CalculatorGraphConfig::Node* node = config->add_node();
+  node->set_calculator(calculator);
+  node->add_input_stream(input);
+  node->add_output_stream(output);
+  return node;
+}
+
+// Returns a graph of `length` DoubleIntCalculators in series. The input
+// packets are zero, so repeated doubling cannot overflow.
+CalculatorGraphConfig ChainGraph(int length, int num_threads) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(num_threads);
+  config.add_input_stream(kInputStream);
+  std::string input = kInputStream;
+  for (int i = 0; i < length; ++i) {
+    const std::string output =
+        i == length - 1 ? kOutputStream : absl::StrCat("chain_", i);
+    AddNode(&config, "DoubleIntCalculator", input, output);
+    input = output;
+  }
+  config.add_output_stream(kOutputStream);
+  return config;
+}
+
+// Returns a graph that fans the input out to `width` DoubleIntCalculators,
+// and joins their outputs pairwise with MultiplyIntCalculators. `width` must
+// be a power of two.
+CalculatorGraphConfig FanOutFanInGraph(int width, int num_threads) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(num_threads);
+  config.add_input_stream(kInputStream);
+  std::vector<std::string> streams;
+  for (int i = 0; i < width; ++i) {
+    streams.push_back(absl::StrCat("branch_", i));
+    AddNode(&config, "DoubleIntCalculator", kInputStream, streams.back());
+  }
+  for (int level = 0; streams.size() > 1; ++level) {
+    std::vector<std::string> joined;
+    for (int i = 0; i < streams.size(); i += 2) {
+      const std::string output = streams.size() == 2
+                                     ? kOutputStream
+                                     : absl::StrCat("join_", level, "_", i);
+      CalculatorGraphConfig::Node* node =
+          AddNode(&config, "MultiplyIntCalculator", streams[i],
+                  absl::StrCat("OUT:", output));
+      node->add_input_stream(streams[i + 1]);
+      joined.push_back(output);
+    }
+    streams = joined;
+  }
+  config.add_output_stream(kOutputStream);
+  return config;
+}
+
+// Returns FanOutFanInGraph(width, 1) with each of the `width` branches running
+// on its own single-threaded executor, so that many scheduler queues go busy
+// and idle for every packet.
+CalculatorGraphConfig MultiExecutorGraph(int width) {
+  CalculatorGraphConfig config = FanOutFanInGraph(width, /*num_threads=*/1);
+  for (int i = 0; i < width; ++i) {
+    ExecutorConfig* executor = config.add_executor();
+    executor->set_name(absl::StrCat("executor_", i));
+    executor->set_type("ThreadPoolExecutor");
+    executor->mutable_options()
+        ->MutableExtension(ThreadPoolExecutorOptions::ext)
+        ->set_num_threads(1);
+    config.mutable_node(i)->set_executor(executor->name());
+  }
+  return config;
+}
+
+// Returns a graph that doubles every element of an input std::vector<int>
+// inside a BeginLoop/EndLoop pair.
+CalculatorGraphConfig LoopGraph(int num_threads) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(num_threads);
+  config.add_input_stream(kInputStream);
+  CalculatorGraphConfig::Node* begin =
+      AddNode(&config, "BeginLoopIntCalculator",
+              absl::StrCat("ITERABLE:", kInputStream), "ITEM:item");
+  begin->add_output_stream("BATCH_END:batch_end");
+  AddNode(&config, "DoubleIntCalculator", "item", "doubled_item");
+  CalculatorGraphConfig::Node* end =
+      AddNode(&config, "EndLoopIntCalculator", "ITEM:doubled_item",
+              absl::StrCat("ITERABLE:", kOutputStream));
+  end->add_input_stream("BATCH_END:batch_end");
+  config.add_output_stream(kOutputStream);
+  return config;
+}
+
+// Returns a graph in which a FlowLimiterCalculator admits one packet at a
+// time into a chain of `length` DoubleIntCalculators.
+CalculatorGraphConfig FlowLimiterGraph(int length, int num_threads) {
+  CalculatorGraphConfig config;
+  config.set_num_threads(num_threads);
+  config.add_input_stream(kInputStream);
+  CalculatorGraphConfig::Node* limiter =
+      AddNode(&config, "FlowLimiterCalculator", kInputStream, "limited");
+  limiter->add_input_stream(absl::StrCat("FINISHED:", kOutputStream));
+  InputStreamInfo* back_edge = limiter->add_input_stream_info();
+  back_edge->set_tag_index("FINISHED");
+  back_edge->set_back_edge(true);
+  std::string input = "limited";
+  for (int i = 0; i < length; ++i) {
+    const std::string output =
+        i == length - 1 ? kOutputStream : absl::StrCat("chain_", i);
+    AddNode(&config, "DoubleIntCalculator", input, output);
+    input = output;
+  }
+  config.add_output_stream(kOutputStream);
+  return config;
+}
+
+// Starts `graph`, counting the packets of its output stream with `counter`.
+absl::Status StartGraph(const CalculatorGraphConfig& config,
+                        CalculatorGraph* graph, PacketCounter* counter) {
+  MP_RETURN_IF_ERROR(graph->Initialize(config));
+  MP_RETURN_IF_ERROR(graph->ObserveOutputStream(
+      kOutputStream, [counter](const Packet&) {
+        counter->Increment();
+        return absl::OkStatus();
+      }));
+  return graph->StartRun({});
+}
+
+absl::Status FinishGraph(CalculatorGraph* graph) {
+  MP_RETURN_IF_ERROR(graph->CloseAllInputStreams());
+  return graph->WaitUntilDone();
+}
+
+// Skips the benchmark with `status` if it is an error.
+bool SkipIfError(benchmark::State& state, const absl::Status& status) {
+  if (status.ok()) return false;
+  state.SkipWithError(status.ToString().c_str());
+  return true;
+}
+
+// Sends one packet at a time through a chain of calculators and waits for
+// it to come out.
+void BM_ChainLatency(benchmark::State& state) {
+  const int length = state.range(0);
+  CalculatorGraph graph;
+  PacketCounter counter;
+  if (SkipIfError(state, StartGraph(ChainGraph(length, /*num_threads=*/1),
+                                    &graph, &counter))) {
+    return;
+  }
+  int64_t timestamp = 0;
+  AllocationReporter allocations(&state);
+  for (auto _ : state) {
+    if (SkipIfError(state, graph.AddPacketToInputStream(
+                               kInputStream,
+                               MakePacket<int>(0).At(Timestamp(timestamp))))) {
+      break;
+    }
+    ++timestamp;
+    counter.WaitFor(timestamp);
+  }
+  allocations.Report(timestamp);
+  state.SetItemsProcessed(timestamp);
+  SkipIfError(state, FinishGraph(&graph));
+}
+BENCHMARK(BM_ChainLatency)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+// Sends batches of packets through a graph without waiting between packets,
+// so that calculators run concurrently on the graph's threads.
+void RunThroughputBenchmark(benchmark::State& state,
+                            const CalculatorGraphConfig& config) {
+  constexpr int kBatchSize = 100;
+  CalculatorGraph graph;
+  PacketCounter counter;
+  if (SkipIfError(state, StartGraph(config, &graph, &counter))) return;
+  int64_t timestamp = 0;
+  AllocationReporter allocations(&state);
+  for (auto _ : state) {
+    for (int i = 0; i < kBatchSize; ++i) {
+      if (SkipIfError(state,
+                      graph.AddPacketToInputStream(
+                          kInputStream,
+                          MakePacket<int>(0).At(Timestamp(timestamp))))) {
+        return;
+      }
+      ++timestamp;
+    }
+    counter.WaitFor(timestamp);
+  }
+  allocations.Report(timestamp);
+  state.SetItemsProcessed(timestamp);
+  SkipIfError(state, FinishGraph(&graph));
+}
+
+// Arguments: chain length, number of threads.
+void BM_ChainThroughput(benchmark::State& state) {
+  RunThroughputBenchmark(state, ChainGraph(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_ChainThroughput)
+    ->ArgsProduct({{4, 16}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+// Arguments: fan-out width, number of threads.
+void BM_FanOutFanInThroughput(benchmark::State& state) {
+  RunThroughputBenchmark(state,
+                         FanOutFanInGraph(state.range(0), state.range(1)));
+}
+BENCHMARK(BM_FanOutFanInThroughput)
+    ->ArgsProduct({{2, 8, 32}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+// Arguments: number of branches, each on its own executor.
+void BM_MultiExecutorThroughput(benchmark::State& state) {
+  RunThroughputBenchmark(state, MultiExecutorGraph(state.range(0)));
+}
+BENCHMARK(BM_MultiExecutorThroughput)->Arg(2)->Arg(8)->Arg(32)->UseRealTime();
+
+// Arguments: number of vector elements, number of threads.
+void BM_BeginEndLoop(benchmark::State& state) {
+  const int num_elements = state.range(0);
+  CalculatorGraph graph;
+  PacketCounter counter;
+  if (SkipIfError(state,
+                  StartGraph(LoopGraph(state.range(1)), &graph, &counter))) {
+    return;
+  }
+  int64_t timestamp = 0;
+  AllocationReporter allocations(&state);
+  for (auto _ : state) {
+    if (SkipIfError(state, graph.AddPacketToInputStream(
+                               kInputStream,
+                               MakePacket<std::vector<int>>(num_elements, 0)
+                                   .At(Timestamp(timestamp))))) {
+      break;
+    }
+    ++timestamp;
+    counter.WaitFor(timestamp);
+  }
+  allocations.Report(timestamp * num_elements);
+  state.SetItemsProcessed(timestamp * num_elements);
+  SkipIfError(state, FinishGraph(&graph));
+}
+BENCHMARK(BM_BeginEndLoop)
+    ->ArgsProduct({{1, 16, 256}, {1, 4}})
+    ->UseRealTime();
+
+// Sends bursts of packets into a FlowLimiterCalculator loop, which drops the
+// packets that arrive while one is in flight. Reports the fraction of packets
+// that passed the limiter. Arguments: chain length, number of threads.
+void BM_FlowLimiterLoop(benchmark::State& state) {
+  constexpr int kBurstSize = 32;
+  CalculatorGraph graph;
+  PacketCounter counter;
+  if (SkipIfError(state,
+                  StartGraph(FlowLimiterGraph(state.range(0), state.range(1)),
+                             &graph, &counter))) {
+    return;
+  }
+  int64_t timestamp = 0;
+  AllocationReporter allocations(&state);
+  for (auto _ : state) {
+    for (int i = 0; i < kBurstSize; ++i) {
+      if (SkipIfError(state,
+                      graph.AddPacketToInputStream(
+                          kInputStream,
+                          MakePacket<int>(0).At(Timestamp(timestamp))))) {
+        return;
+      }
+      ++timestamp;
+    }
+    if (SkipIfError(state, graph.WaitUntilIdle())) return;
+  }
+  allocations.Report(timestamp);
+  state.SetItemsProcessed(timestamp);
+  state.counters["passed_fraction"] =
+      timestamp > 0 ? static_cast<double>(counter.count()) / timestamp : 0.0;
+  SkipIfError(state, FinishGraph(&graph));
+}
+BENCHMARK(BM_FlowLimiterLoop)
+    ->ArgsProduct({{1, 8}, {1, 4}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
@@ -70,6 +70,23 @@ void CalculatorContext::SetOffset(TimestampDiff offset) {
   }
 }
 
+std::function<void(absl::Status)> CalculatorContext::DeferProcessCompletion() {
+  CHECK(!process_deferred_) << "DeferProcessCompletion() was called twice by "
+                            << NodeName();
+  CHECK_GT(inputs_.NumEntries(), 0)
+      << "Source nodes cannot defer Process(): " << NodeName();
+  CHECK(NumberOfTimestamps() == 1 && input_batch_timestamps_.empty())
+      << "Batched Process() calls cannot be deferred: " << NodeName();
+  process_deferred_ = true;
+  deferred_arrivals_.store(2, std::memory_order_relaxed);
+  return [this](absl::Status status) {
+    deferred_status_ = std::move(status);
+    if (ArriveAtDeferredCompletion()) {
+      resume_deferred_process_();
+    }
+  };
+}
+
 const InputStreamSet& CalculatorContext::InputStreams() const {
   if (!input_streams_) {
     input_streams_ = absl::make_unique<InputStreamSet>(inputs_.TagMap());
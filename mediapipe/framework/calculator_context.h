@@ -15,11 +15,15 @@
 #ifndef MEDIAPIPE_FRAMEWORK_CALCULATOR_CONTEXT_H_
 #define MEDIAPIPE_FRAMEWORK_CALCULATOR_CONTEXT_H_
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/time/time.h"
 #include "mediapipe/framework/calculator_state.h"
 #include "mediapipe/framework/counter.h"
 #include "mediapipe/framework/graph_service.h"
@@ -28,11 +32,17 @@
 #include "mediapipe/framework/packet_set.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/any_proto.h"
+#include "mediapipe/framework/port/proto_ns.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/proto_arena_pool.h"
 #include "mediapipe/framework/timestamp.h"
 
 namespace mediapipe {
 
+namespace internal {
+class SchedulerQueue;
+}  // namespace internal
+
 // A CalculatorContext provides information about the graph it is running
 // inside of through a number of accessor functions: Inputs(), Outputs(),
 // InputSidePackets(), Options(), etc.
@@ -48,7 +58,8 @@ class CalculatorContext {
                     std::shared_ptr<tool::TagMap> output_tag_map)
       : calculator_state_(calculator_state),
         inputs_(std::move(input_tag_map)),
-        outputs_(std::move(output_tag_map)) {}
+        outputs_(std::move(output_tag_map)),
+        input_batch_(inputs_.TagMap()) {}
 
   CalculatorContext(const CalculatorContext&) = delete;
   CalculatorContext& operator=(const CalculatorContext&) = delete;
@@ -85,6 +96,27 @@ class CalculatorContext {
                                      : input_timestamps_.front();
   }
 
+  // Returns the time by which the current input timestamp should be
+  // processed, as set by the input stream handler, for instance
+  // DeadlineInputStreamHandler. Calculators can skip optional work when it is
+  // near. Returns absl::InfiniteFuture() if there is no deadline.
+  absl::Time Deadline() const { return deadline_; }
+
+  // Returns the input timestamps passed to the current Process() call, in
+  // order, starting with InputTimestamp(). Only input stream handlers that
+  // pass several timestamps to one Process() call, such as
+  // BatchingInputStreamHandler, fill the batch; otherwise it is empty.
+  const std::vector<Timestamp>& InputBatchTimestamps() const {
+    return input_batch_timestamps_;
+  }
+
+  // Returns the input packets for InputBatchTimestamps(), one vector per input
+  // stream, indexed like Inputs(). A packet is empty if its stream has none at
+  // the corresponding timestamp.
+  const internal::Collection<std::vector<Packet>>& InputBatch() const {
+    return input_batch_;
+  }
+
   // Returns a reference to the input side packet set.
   const PacketSet& InputSidePackets() const;
   // Returns a reference to the output side packet collection.
@@ -104,6 +136,28 @@ class CalculatorContext {
   // use OutputStream::SetOffset() directly.
   void SetOffset(TimestampDiff offset);
 
+  // Defers the end of the current Process() call, so that a calculator waiting
+  // on I/O or an accelerator doesn't hold an executor thread meanwhile.
+  // Process() must then return OK, and the returned callback must be called
+  // exactly once, from any thread, with the status Process() would otherwise
+  // have returned. Until then, the node keeps its current inputs and counts as
+  // in flight, and the outputs added to this context are only sent once the
+  // callback is called. Can only be called once per Process() call, by a
+  // non-source node without input batching.
+  std::function<void(absl::Status)> DeferProcessCompletion();
+
+  // Returns the protobuf arena shared by the calculators processing
+  // InputTimestamp() if CalculatorGraphConfig.enable_proto_arena is set, and
+  // nullptr otherwise; see ProtoArenaPool. Output protos created on it, e.g.
+  // with MakeArenaMessage<T>(cc->ProtoArena()), are freed together once no
+  // packet of the timestamp refers to them. Output them by value, e.g.
+  //   kOut(cc).Send(std::move(*message));
+  // which does not copy them, but never with Adopt() or OutputStream::Add().
+  // Can only be called from Process(), on the thread running it.
+  proto_ns::Arena* ProtoArena() const {
+    return ProtoArenaPool::CurrentArena();
+  }
+
   // Returns the status of the graph run.
   //
   // NOTE: This method should only be called during CalculatorBase::Close().
@@ -137,6 +191,41 @@ class CalculatorContext {
 
   void SetGraphStatus(const absl::Status& status) { graph_status_ = status; }
 
+  void SetDeadline(absl::Time deadline) { deadline_ = deadline; }
+
+  // Adds the packets of `input_set` at `input_timestamp` to the input batch.
+  void AddToInputBatch(Timestamp input_timestamp,
+                       const InputStreamShardSet& input_set) {
+    input_batch_timestamps_.push_back(input_timestamp);
+    for (CollectionItemId id = input_set.BeginId(); id < input_set.EndId();
+         ++id) {
+      input_batch_.Get(id).push_back(input_set.Get(id).Value());
+    }
+  }
+
+  void ClearInputBatch() {
+    input_batch_timestamps_.clear();
+    for (auto& packets : input_batch_) {
+      packets.clear();
+    }
+  }
+
+  bool IsProcessDeferred() const { return process_deferred_; }
+
+  // Called once by the callback of DeferProcessCompletion() and once by the
+  // scheduler after Process() returned. Returns true for the last of the two,
+  // which resumes the node.
+  bool ArriveAtDeferredCompletion() {
+    return deferred_arrivals_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  // Clears the deferral of the current Process() call, and returns the status
+  // passed to the callback of DeferProcessCompletion().
+  absl::Status TakeDeferredStatus() {
+    process_deferred_ = false;
+    return std::move(deferred_status_);
+  }
+
   // Interface for the friend class Calculator.
   const InputStreamSet& InputStreams() const;
   const OutputStreamSet& OutputStreams() const;
@@ -158,8 +247,27 @@ class CalculatorContext {
   // The status of the graph run. Only used when Close() is called.
   absl::Status graph_status_;
 
+  absl::Time deadline_ = absl::InfiniteFuture();
+
+  // The input sets passed to a single Process() call by a batching input
+  // stream handler.
+  std::vector<Timestamp> input_batch_timestamps_;
+  internal::Collection<std::vector<Packet>> input_batch_;
+
+  // Whether the current Process() call is deferred, and its completion. The
+  // scheduler sets resume_deferred_process_ before arriving.
+  bool process_deferred_ = false;
+  std::atomic<int> deferred_arrivals_{0};
+  absl::Status deferred_status_;
+  std::function<void()> resume_deferred_process_;
+
   // Accesses CalculatorContext for setting input timestamp.
   friend class CalculatorContextManager;
+  // Accesses CalculatorContext for setting the deadline and input batch.
+  friend class InputStreamHandler;
+  // Completes deferred Process() calls.
+  friend class CalculatorNode;
+  friend class internal::SchedulerQueue;
 };
 
 }  // namespace mediapipe
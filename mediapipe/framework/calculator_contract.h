@@ -133,6 +133,60 @@ class CalculatorContract {
   void SetTimestampOffset(TimestampDiff offset) { timestamp_offset_ = offset; }
   TimestampDiff GetTimestampOffset() const { return timestamp_offset_; }
 
+  // When false, the node is opened as soon as its input side packets are
+  // ready, without waiting for the headers of its input streams, which are
+  // set when the upstream nodes are opened. Nodes with slow Open calls, such
+  // as model loading, can then be opened concurrently on a multithreaded
+  // executor. Input stream headers can't be used in Open then. Defaults to
+  // true.
+  void SetInputStreamHeadersNeeded(bool needed) {
+    input_stream_headers_needed_ = needed;
+  }
+  bool GetInputStreamHeadersNeeded() const {
+    return input_stream_headers_needed_;
+  }
+
+  // When true, the outputs of the node only depend on its inputs, input side
+  // packets and options, and the node has no other effect. Graphs with
+  // optimize_graph set then merge identical pure nodes with identical inputs,
+  // and remove pure nodes whose outputs aren't consumed. Defaults to false.
+  void SetPure(bool pure) { pure_ = pure; }
+  bool IsPure() const { return pure_; }
+
+  // When true, each call to Process() only depends on the inputs of that
+  // call, the input side packets and options, so that several copies of the
+  // node can process different timestamps, as with the "replicas" node field.
+  // Pure nodes are stateless. Defaults to false.
+  void SetStateless(bool stateless) { stateless_ = stateless; }
+  bool IsStateless() const { return stateless_ || pure_; }
+
+  // When true, Process() is cheap and doesn't block, so that the node can run
+  // right after the node that made it ready, in the same executor task,
+  // instead of going through the scheduler queue. Chains of such nodes then
+  // run in a single task. Defaults to false.
+  void SetInlineSafe(bool inline_safe) { inline_safe_ = inline_safe; }
+  bool IsInlineSafe() const { return inline_safe_; }
+
+  // How much work Process() does. Nodes that don't set an executor run on the
+  // first executor of the graph whose ThreadPoolExecutorOptions
+  // require_processor_performance is HIGH if they are heavy, or LOW if they
+  // are light, so that e.g. inference runs on the big cores of big.LITTLE
+  // processors and control flow on the little ones. Defaults to kDefault.
+  enum class Workload { kDefault, kHeavy, kLight };
+  void SetWorkload(Workload workload) { workload_ = workload; }
+  Workload GetWorkload() const { return workload_; }
+
+  // The accelerator that Process() drives, e.g. "gpu" or "nnapi". Nodes that
+  // don't set an executor run on the first executor of the graph whose
+  // ThreadPoolExecutorOptions list this accelerator, so that each accelerator
+  // has a queue of its own and work for different accelerators, e.g. on
+  // different frames, overlaps. Takes precedence over the workload. Empty by
+  // default.
+  void SetAccelerator(absl::string_view accelerator) {
+    accelerator_ = std::string(accelerator);
+  }
+  const std::string& GetAccelerator() const { return accelerator_; }
+
   class GraphServiceRequest {
    public:
     // APIs that should be used by calculators.
@@ -188,6 +242,12 @@ class CalculatorContract {
   ServiceReqMap service_requests_;
   bool process_timestamps_ = false;
   TimestampDiff timestamp_offset_ = TimestampDiff::Unset();
+  bool input_stream_headers_needed_ = true;
+  bool pure_ = false;
+  bool stateless_ = false;
+  bool inline_safe_ = false;
+  Workload workload_ = Workload::kDefault;
+  std::string accelerator_;
 
   friend class CalculatorNode;
 };
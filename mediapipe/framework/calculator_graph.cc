@@ -25,6 +25,7 @@
 
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -33,13 +34,19 @@
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_base.h"
 #include "mediapipe/framework/counter_factory.h"
 #include "mediapipe/framework/delegating_executor.h"
 #include "mediapipe/framework/graph_service_manager.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
 #include "mediapipe/framework/input_stream_manager.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
+#include "mediapipe/framework/memory_trimmer.h"
+#include "mediapipe/framework/packet_arena.h"
+#include "mediapipe/framework/proto_arena_pool.h"
 #include "mediapipe/framework/packet_generator.h"
 #include "mediapipe/framework/packet_generator.pb.h"
 #include "mediapipe/framework/packet_set.h"
@@ -54,9 +61,11 @@
 #include "mediapipe/framework/port/status_builder.h"
 #include "mediapipe/framework/status_handler.h"
 #include "mediapipe/framework/status_handler.pb.h"
+#include "mediapipe/framework/tensor_pool_service.h"
 #include "mediapipe/framework/thread_pool_executor.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
 #include "mediapipe/framework/tool/fill_packet_set.h"
+#include "mediapipe/framework/tool/name_util.h"
 #include "mediapipe/framework/tool/status_util.h"
 #include "mediapipe/framework/tool/tag_map.h"
 #include "mediapipe/framework/tool/validate.h"
@@ -168,14 +177,42 @@ absl::Status CalculatorGraph::InitializePacketGeneratorGraph(
 absl::Status CalculatorGraph::InitializeStreams() {
   any_packet_type_.SetAny();
 
+  // Create the byte budget shared by the input streams, if any.
+  const int64 max_queue_bytes = validated_graph_->Config().max_queue_bytes();
+  if (max_queue_bytes > 0) {
+    queue_budget_ = absl::make_unique<SharedQueueBudget>(
+        max_queue_bytes,
+        std::bind(&CalculatorGraph::UpdateThrottledNodesForQueueBudget, this));
+    has_queue_byte_budgets_ = true;
+  }
+
   // Create and initialize the input streams.
   input_stream_managers_ = absl::make_unique<InputStreamManager[]>(
       validated_graph_->InputStreamInfos().size());
   for (int index = 0; index < validated_graph_->InputStreamInfos().size();
        ++index) {
     const EdgeInfo& edge_info = validated_graph_->InputStreamInfos()[index];
-    MP_RETURN_IF_ERROR(input_stream_managers_[index].Initialize(
+    InputStreamManager& manager = input_stream_managers_[index];
+    MP_RETURN_IF_ERROR(manager.Initialize(
         edge_info.name, edge_info.packet_type, edge_info.back_edge));
+    if (edge_info.lock_free_queue) {
+      manager.EnableLockFreeQueue();
+    }
+    if (edge_info.max_queue_bytes > 0) {
+      has_queue_byte_budgets_ = true;
+    }
+    // Packets queued on back edges are not held back by throttling the
+    // sources, so they do not count against the budget of the graph.
+    const bool use_queue_budget = queue_budget_ && !edge_info.back_edge;
+    if (validated_graph_->Config()
+            .profiler_config()
+            .enable_stream_memory_accounting() ||
+        edge_info.max_queue_bytes > 0 || use_queue_budget) {
+      manager.EnableMemoryAccounting();
+    }
+    if (use_queue_budget) {
+      manager.SetSharedQueueBudget(queue_budget_.get());
+    }
   }
 
   // Create and initialize the output streams.
@@ -274,6 +311,83 @@ absl::Status CalculatorGraph::InitializeCalculatorNodes() {
   return absl::OkStatus();
 }
 
+void CalculatorGraph::InitializeCriticalPathScheduling() {
+  std::vector<std::vector<const CalculatorNode*>> downstream_nodes(
+      nodes_.size());
+  for (const EdgeInfo& edge_info : validated_graph_->InputStreamInfos()) {
+    // Back edges would make the critical path estimates grow without bound.
+    if (edge_info.back_edge || edge_info.upstream < 0 ||
+        edge_info.parent_node.type != NodeTypeInfo::NodeType::CALCULATOR) {
+      continue;
+    }
+    const NodeTypeInfo::NodeRef& producer =
+        validated_graph_->OutputStreamInfos()[edge_info.upstream].parent_node;
+    if (producer.type != NodeTypeInfo::NodeType::CALCULATOR) continue;
+    std::vector<const CalculatorNode*>& consumers =
+        downstream_nodes[producer.index];
+    const CalculatorNode* consumer = nodes_[edge_info.parent_node.index].get();
+    if (std::find(consumers.begin(), consumers.end(), consumer) ==
+        consumers.end()) {
+      consumers.push_back(consumer);
+    }
+  }
+  for (int i = 0; i < downstream_nodes.size(); ++i) {
+    nodes_[i]->SetDownstreamNodes(std::move(downstream_nodes[i]));
+  }
+  scheduler_.EnableCriticalPathScheduling();
+}
+
+void CalculatorGraph::InitializeWorkloadExecutors() {
+  std::string heavy_executor;
+  std::string light_executor;
+  absl::flat_hash_map<std::string, std::string> accelerator_executors;
+  for (const ExecutorConfig& executor_config :
+       validated_graph_->Config().executor()) {
+    const MediaPipeOptions& options = executor_config.options();
+    if (executor_config.name().empty() ||
+        !options.HasExtension(ThreadPoolExecutorOptions::ext)) {
+      continue;
+    }
+    const auto& executor_options =
+        options.GetExtension(ThreadPoolExecutorOptions::ext);
+    for (const std::string& accelerator : executor_options.accelerator()) {
+      if (accelerator.empty()) continue;
+      accelerator_executors.emplace(accelerator, executor_config.name());
+    }
+    const auto performance = executor_options.require_processor_performance();
+    if (performance == ThreadPoolExecutorOptions::HIGH &&
+        heavy_executor.empty()) {
+      heavy_executor = executor_config.name();
+    } else if (performance == ThreadPoolExecutorOptions::LOW &&
+               light_executor.empty()) {
+      light_executor = executor_config.name();
+    }
+  }
+  if (heavy_executor.empty() && light_executor.empty() &&
+      accelerator_executors.empty()) {
+    return;
+  }
+  for (auto& node : nodes_) {
+    if (!node->Executor().empty()) continue;
+    auto accelerator_executor =
+        accelerator_executors.find(node->Contract().GetAccelerator());
+    if (accelerator_executor != accelerator_executors.end()) {
+      node->SetExecutor(accelerator_executor->second);
+      continue;
+    }
+    switch (node->Contract().GetWorkload()) {
+      case CalculatorContract::Workload::kHeavy:
+        if (!heavy_executor.empty()) node->SetExecutor(heavy_executor);
+        break;
+      case CalculatorContract::Workload::kLight:
+        if (!light_executor.empty()) node->SetExecutor(light_executor);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
 absl::Status CalculatorGraph::InitializePacketGeneratorNodes(
     const std::vector<int>& non_scheduled_generators) {
   // Do not add wrapper nodes again if we are running the graph multiple times.
@@ -416,10 +530,24 @@ absl::Status CalculatorGraph::Initialize(
       << "validated_graph is not initialized.";
   validated_graph_ = std::move(validated_graph);
 
+  if (validated_graph_->Config().enable_packet_arena()) {
+    auto packet_arena = std::make_shared<PacketArena>();
+    scheduler_.SetPacketArena(packet_arena);
+    profiler_->SetPacketArena(std::move(packet_arena));
+  }
+  if (validated_graph_->Config().enable_proto_arena()) {
+    scheduler_.SetProtoArenaPool(std::make_shared<ProtoArenaPool>());
+  }
   MP_RETURN_IF_ERROR(InitializeExecutors());
   MP_RETURN_IF_ERROR(InitializePacketGeneratorGraph(side_packets));
   MP_RETURN_IF_ERROR(InitializeStreams());
+  profiler_->SetInputStreamManagers(input_stream_managers_.get());
   MP_RETURN_IF_ERROR(InitializeCalculatorNodes());
+  if (validated_graph_->Config().scheduling_policy() ==
+      CalculatorGraphConfig::CRITICAL_PATH) {
+    InitializeCriticalPathScheduling();
+  }
+  InitializeWorkloadExecutors();
 #ifdef MEDIAPIPE_PROFILER_AVAILABLE
   MP_RETURN_IF_ERROR(InitializeProfiler());
 #endif
@@ -475,6 +603,11 @@ absl::Status CalculatorGraph::ObserveOutputStream(
   return absl::OkStatus();
 }
 
+void CalculatorGraph::ObserveInputStreams(
+    std::function<void(const std::string&, const Packet&)> packet_callback) {
+  input_stream_observer_ = std::move(packet_callback);
+}
+
 absl::StatusOr<OutputStreamPoller> CalculatorGraph::AddOutputStreamPoller(
     const std::string& stream_name, bool observe_timestamp_bounds) {
   RET_CHECK(initialized_).SetNoLogging()
@@ -614,6 +747,11 @@ static bool UsesGpu(const CalculatorNode& node) {
 absl::Status CalculatorGraph::PrepareGpu() {
   auto gpu_resources = service_manager_.GetServiceObject(kGpuService);
   if (!gpu_resources) return absl::OkStatus();
+  const int gl_context_pool_size =
+      validated_graph_->Config().gl_context_pool_size();
+  if (gl_context_pool_size > 0) {
+    gpu_resources->SetGlContextPoolSize(gl_context_pool_size);
+  }
   // Set up executors.
   for (auto& node : nodes_) {
     if (UsesGpu(*node)) {
@@ -736,6 +874,11 @@ absl::Status CalculatorGraph::PrepareForRun(
     full_input_streams_.clear();
     full_input_streams_.resize(validated_graph_->CalculatorInfos().size() +
                                graph_input_streams_.size());
+    throttle_stats_.resize(full_input_streams_.size());
+    queue_budget_was_full_ = false;
+  }
+  if (queue_budget_) {
+    queue_budget_->PrepareForRun();
   }
 
   for (auto& item : graph_input_streams_) {
@@ -793,6 +936,15 @@ absl::Status CalculatorGraph::PrepareForRun(
   for (auto& node : nodes_) {
     node->SetMaxInputStreamQueueSize(max_queue_size_);
   }
+  // Likewise for the byte budgets, which deadlock resolution may have raised.
+  for (int index = 0; index < validated_graph_->InputStreamInfos().size();
+       ++index) {
+    const int64 max_queue_bytes =
+        validated_graph_->InputStreamInfos()[index].max_queue_bytes;
+    if (max_queue_bytes > 0) {
+      input_stream_managers_[index].SetMaxQueueBytes(max_queue_bytes);
+    }
+  }
 
   // Allow graph input streams to override the global max queue size.
   for (const auto& name_max : graph_input_stream_max_queue_size_) {
@@ -867,6 +1019,58 @@ absl::Status CalculatorGraph::AddPacketToInputStream(
   return AddPacketToInputStreamInternal(stream_name, std::move(packet));
 }
 
+absl::StatusOr<CalculatorGraph::GraphInputStreamHandle>
+CalculatorGraph::GetInputStreamHandle(const std::string& stream_name) {
+  std::unique_ptr<GraphInputStream>* stream =
+      mediapipe::FindOrNull(graph_input_streams_, stream_name);
+  RET_CHECK(stream).SetNoLogging() << absl::Substitute(
+      "GetInputStreamHandle called on input stream \"$0\" which is not a "
+      "graph input stream.",
+      stream_name);
+  int node_id = mediapipe::FindOrDie(graph_input_stream_node_ids_, stream_name);
+  return GraphInputStreamHandle(stream->get(), node_id);
+}
+
+absl::Status CalculatorGraph::AddPacketToInputStream(
+    GraphInputStreamHandle stream, const Packet& packet) {
+  return AddPacketToInputStreamInternal(stream, packet);
+}
+
+absl::Status CalculatorGraph::AddPacketToInputStream(
+    GraphInputStreamHandle stream, Packet&& packet) {
+  return AddPacketToInputStreamInternal(stream, std::move(packet));
+}
+
+absl::Status CalculatorGraph::AddPacketsToInputStreams(
+    std::vector<std::pair<GraphInputStreamHandle, Packet>> packets) {
+  absl::InlinedVector<int, 4> node_ids;
+  node_ids.reserve(packets.size());
+  for (const auto& [stream, packet] : packets) {
+    RET_CHECK(stream.stream_)
+        << "AddPacketsToInputStreams called with an unset stream handle.";
+    node_ids.push_back(stream.node_id_);
+  }
+  MP_RETURN_IF_ERROR(WaitUntilInputStreamsAddable(node_ids));
+
+  for (auto& [stream, packet] : packets) {
+    AddPacketToGraphInputStream(stream.stream_, std::move(packet));
+  }
+  if (has_error_) {
+    absl::Status error_status;
+    GetCombinedErrors("Graph has errors: ", &error_status);
+    return error_status;
+  }
+  // The packets are propagated only once they are all added, so that a node
+  // reading several of the streams can be scheduled once for the batch.
+  for (auto& [stream, packet] : packets) {
+    stream.stream_->PropagateUpdatesToMirrors();
+  }
+
+  VLOG(2) << "Packets added directly to " << packets.size() << " streams.";
+  scheduler_.AddedPacketToGraphInputStream();
+  return absl::OkStatus();
+}
+
 absl::Status CalculatorGraph::SetInputStreamTimestampBound(
     const std::string& stream_name, Timestamp timestamp) {
   std::unique_ptr<GraphInputStream>* stream =
@@ -895,46 +1099,90 @@ absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
       stream_name);
   int node_id = mediapipe::FindOrDie(graph_input_stream_node_ids_, stream_name);
   CHECK_GE(node_id, validated_graph_->CalculatorInfos().size());
-  {
-    absl::MutexLock lock(&full_input_streams_mutex_);
-    if (full_input_streams_.empty()) {
-      return mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
-             << "CalculatorGraph::AddPacketToInputStream() is called before "
-                "StartRun()";
+  return AddPacketToInputStreamInternal(
+      GraphInputStreamHandle(stream->get(), node_id), std::forward<T>(packet));
+}
+
+template <typename T>
+absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
+    GraphInputStreamHandle stream, T&& packet) {
+  RET_CHECK(stream.stream_)
+      << "AddPacketToInputStream called with an unset stream handle.";
+  const int node_id = stream.node_id_;
+  MP_RETURN_IF_ERROR(WaitUntilInputStreamsAddable({&node_id, 1}));
+
+  AddPacketToGraphInputStream(stream.stream_, std::forward<T>(packet));
+  if (has_error_) {
+    absl::Status error_status;
+    GetCombinedErrors("Graph has errors: ", &error_status);
+    return error_status;
+  }
+  stream.stream_->PropagateUpdatesToMirrors();
+
+  VLOG(2) << "Packet added directly to: "
+          << stream.stream_->GetManager()->Name();
+  // Note: one reason why we need to call the scheduler here is that we have
+  // re-throttled the graph input streams, and we may need to unthrottle them
+  // again if the graph is still idle. Unthrottling basically only lets in one
+  // packet at a time. TODO: add test.
+  scheduler_.AddedPacketToGraphInputStream();
+  return absl::OkStatus();
+}
+
+absl::Status CalculatorGraph::WaitUntilInputStreamsAddable(
+    absl::Span<const int> node_ids) {
+  absl::MutexLock lock(&full_input_streams_mutex_);
+  if (full_input_streams_.empty()) {
+    return mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
+           << "CalculatorGraph::AddPacketToInputStream() is called before "
+              "StartRun()";
+  }
+  if (graph_input_stream_add_mode_ ==
+      GraphInputStreamAddMode::ADD_IF_NOT_FULL) {
+    if (has_error_) {
+      absl::Status error_status;
+      GetCombinedErrors("Graph has errors: ", &error_status);
+      return error_status;
     }
-    if (graph_input_stream_add_mode_ ==
-        GraphInputStreamAddMode::ADD_IF_NOT_FULL) {
-      if (has_error_) {
-        absl::Status error_status;
-        GetCombinedErrors("Graph has errors: ", &error_status);
-        return error_status;
-      }
-      // Return with StatusUnavailable if this stream is being throttled.
-      if (!full_input_streams_[node_id].empty()) {
-        return mediapipe::UnavailableErrorBuilder(MEDIAPIPE_LOC)
-               << "Graph is throttled.";
-      }
-    } else if (graph_input_stream_add_mode_ ==
-               GraphInputStreamAddMode::WAIT_TILL_NOT_FULL) {
-      // Wait until this stream is not being throttled.
-      // TODO: instead of checking has_error_, we could just check
-      // if the graph is done. That could also be indicated by returning an
-      // error from WaitUntilGraphInputStreamUnthrottled.
-      while (!has_error_ && !full_input_streams_[node_id].empty()) {
-        // TODO: allow waiting for a specific stream?
-        scheduler_.WaitUntilGraphInputStreamUnthrottled(
-            &full_input_streams_mutex_);
-      }
-      if (has_error_) {
-        absl::Status error_status;
-        GetCombinedErrors("Graph has errors: ", &error_status);
-        return error_status;
-      }
+    // Return with StatusUnavailable if any of the streams is being throttled.
+    if (IsAnyInputStreamThrottled(node_ids)) {
+      return mediapipe::UnavailableErrorBuilder(MEDIAPIPE_LOC)
+             << "Graph is throttled.";
+    }
+  } else if (graph_input_stream_add_mode_ ==
+             GraphInputStreamAddMode::WAIT_TILL_NOT_FULL) {
+    // Wait until none of the streams is being throttled.
+    // TODO: instead of checking has_error_, we could just check
+    // if the graph is done. That could also be indicated by returning an
+    // error from WaitUntilGraphInputStreamUnthrottled.
+    while (!has_error_ && IsAnyInputStreamThrottled(node_ids)) {
+      // TODO: allow waiting for a specific stream?
+      scheduler_.WaitUntilGraphInputStreamUnthrottled(
+          &full_input_streams_mutex_);
+    }
+    if (has_error_) {
+      absl::Status error_status;
+      GetCombinedErrors("Graph has errors: ", &error_status);
+      return error_status;
     }
   }
+  return absl::OkStatus();
+}
+
+bool CalculatorGraph::IsAnyInputStreamThrottled(
+    absl::Span<const int> node_ids) {
+  for (int node_id : node_ids) {
+    if (!full_input_streams_[node_id].empty()) return true;
+  }
+  return false;
+}
 
+template <typename T>
+void CalculatorGraph::AddPacketToGraphInputStream(GraphInputStream* stream,
+                                                  T&& packet) {
   // Adding profiling info for a new packet entering the graph.
-  const std::string* stream_id = &(*stream)->GetManager()->Name();
+  const std::string* stream_id = &stream->GetManager()->Name();
+  if (input_stream_observer_) input_stream_observer_(*stream_id, packet);
   profiler_->LogEvent(TraceEvent(TraceEvent::PROCESS)
                           .set_is_finish(true)
                           .set_input_ts(packet.Timestamp())
@@ -946,21 +1194,7 @@ absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
   // should not be called by multiple threads concurrently. Note that this could
   // potentially lead to the max queue size being exceeded by one packet at most
   // because we don't have the lock over the input stream.
-  (*stream)->AddPacket(std::forward<T>(packet));
-  if (has_error_) {
-    absl::Status error_status;
-    GetCombinedErrors("Graph has errors: ", &error_status);
-    return error_status;
-  }
-  (*stream)->PropagateUpdatesToMirrors();
-
-  VLOG(2) << "Packet added directly to: " << stream_name;
-  // Note: one reason why we need to call the scheduler here is that we have
-  // re-throttled the graph input streams, and we may need to unthrottle them
-  // again if the graph is still idle. Unthrottling basically only lets in one
-  // packet at a time. TODO: add test.
-  scheduler_.AddedPacketToGraphInputStream();
-  return absl::OkStatus();
+  stream->AddPacket(std::forward<T>(packet));
 }
 
 absl::Status CalculatorGraph::SetInputStreamMaxQueueSize(
@@ -1143,36 +1377,8 @@ void CalculatorGraph::UpdateThrottledNodes(InputStreamManager* stream,
                             TraceEvent(stream_is_full ? TraceEvent::THROTTLED
                                                       : TraceEvent::UNTHROTTLED)
                                 .set_stream_id(&stream->Name()));
-        bool was_throttled = !full_input_streams_[node_id].empty();
-        if (stream_is_full) {
-          DCHECK_EQ(full_input_streams_[node_id].count(stream), 0);
-          full_input_streams_[node_id].insert(stream);
-        } else {
-          DCHECK_EQ(full_input_streams_[node_id].count(stream), 1);
-          full_input_streams_[node_id].erase(stream);
-        }
-
-        bool is_throttled = !full_input_streams_[node_id].empty();
-        bool is_graph_input_stream =
-            node_id >= validated_graph_->CalculatorInfos().size();
-        if (is_graph_input_stream) {
-          // Making these calls while holding full_input_streams_mutex_
-          // ensures they are correctly serialized.
-          // Note: !is_throttled implies was_throttled, but not vice versa.
-          if (!is_throttled) {
-            scheduler_.UnthrottledGraphInputStream();
-          } else if (!was_throttled && is_throttled) {
-            scheduler_.ThrottledGraphInputStream();
-          }
-        } else {
-          if (!is_throttled) {
-            CalculatorNode& node = *nodes_[node_id];
-            // Add this node to the scheduler queue if possible.
-            if (node.Active() && !node.Closed()) {
-              nodes_to_schedule.emplace_back(&node);
-            }
-          }
-        }
+        UpdateNodeThrottling(node_id, stream, stream_is_full,
+                             &nodes_to_schedule);
       }
     }
     *stream_was_full = stream_is_full;
@@ -1183,9 +1389,88 @@ void CalculatorGraph::UpdateThrottledNodes(InputStreamManager* stream,
   }
 }
 
+void CalculatorGraph::UpdateThrottledNodesForQueueBudget() {
+  std::vector<CalculatorNode*> nodes_to_schedule;
+  {
+    absl::MutexLock lock(&full_input_streams_mutex_);
+    // The budget is re-checked here for the same reasons as a stream in
+    // UpdateThrottledNodes(). Callbacks may also arrive after the run.
+    bool budget_is_full = queue_budget_->IsFull();
+    if (full_input_streams_.empty() ||
+        queue_budget_was_full_ == budget_is_full) {
+      return;
+    }
+    VLOG(2) << "The queue byte budget of the graph is "
+            << (budget_is_full ? "throttling" : "no longer throttling")
+            << " the sources";
+    absl::flat_hash_set<int> sources;
+    for (const NodeTypeInfo& info : validated_graph_->CalculatorInfos()) {
+      sources.insert(info.AncestorSources().begin(),
+                     info.AncestorSources().end());
+    }
+    for (int node_id = validated_graph_->CalculatorInfos().size();
+         node_id < full_input_streams_.size(); ++node_id) {
+      sources.insert(node_id);
+    }
+    for (int node_id : sources) {
+      UpdateNodeThrottling(node_id, nullptr, budget_is_full,
+                           &nodes_to_schedule);
+    }
+    queue_budget_was_full_ = budget_is_full;
+  }
+
+  if (!nodes_to_schedule.empty()) {
+    scheduler_.ScheduleUnthrottledReadyNodes(nodes_to_schedule);
+  }
+}
+
+void CalculatorGraph::UpdateNodeThrottling(
+    int node_id, InputStreamManager* stream, bool is_full,
+    std::vector<CalculatorNode*>* nodes_to_schedule) {
+  bool was_throttled = !full_input_streams_[node_id].empty();
+  if (is_full) {
+    DCHECK_EQ(full_input_streams_[node_id].count(stream), 0);
+    full_input_streams_[node_id].insert(stream);
+  } else {
+    DCHECK_EQ(full_input_streams_[node_id].count(stream), 1);
+    full_input_streams_[node_id].erase(stream);
+  }
+
+  bool is_throttled = !full_input_streams_[node_id].empty();
+  ThrottleStats& stats = throttle_stats_[node_id];
+  if (!was_throttled && is_throttled) {
+    stats.throttled_since = absl::Now();
+    ++stats.throttle_count;
+  } else if (was_throttled && !is_throttled) {
+    stats.throttled_time += absl::Now() - stats.throttled_since;
+    stats.throttled_since = absl::InfiniteFuture();
+  }
+  bool is_graph_input_stream =
+      node_id >= validated_graph_->CalculatorInfos().size();
+  if (is_graph_input_stream) {
+    // Making these calls while holding full_input_streams_mutex_
+    // ensures they are correctly serialized.
+    // Note: !is_throttled implies was_throttled, but not vice versa.
+    if (!is_throttled) {
+      scheduler_.UnthrottledGraphInputStream();
+    } else if (!was_throttled && is_throttled) {
+      scheduler_.ThrottledGraphInputStream();
+    }
+  } else {
+    if (!is_throttled) {
+      CalculatorNode& node = *nodes_[node_id];
+      // Add this node to the scheduler queue if possible.
+      if (node.Active() && !node.Closed()) {
+        nodes_to_schedule->emplace_back(&node);
+      }
+    }
+  }
+}
+
 bool CalculatorGraph::IsNodeThrottled(int node_id) {
   absl::MutexLock lock(&full_input_streams_mutex_);
-  return max_queue_size_ != -1 && !full_input_streams_[node_id].empty();
+  return (max_queue_size_ != -1 || has_queue_byte_budgets_) &&
+         !full_input_streams_[node_id].empty();
 }
 
 // Returns true if an input stream serves as a graph-output-stream.
@@ -1209,10 +1494,15 @@ bool CalculatorGraph::UnthrottleSources() {
   // stream during each call to UnthrottleSources will eventually resolve
   // each deadlock.
   absl::flat_hash_set<InputStreamManager*> full_streams;
+  bool queue_budget_full = false;
   {
     absl::MutexLock lock(&full_input_streams_mutex_);
     for (absl::flat_hash_set<InputStreamManager*>& s : full_input_streams_) {
       for (auto& stream : s) {
+        if (stream == nullptr) {
+          queue_budget_full = true;
+          continue;
+        }
         // The queue size of a graph output stream shouldn't change. Throttling
         // should continue until the caller of the graph output stream consumes
         // enough packets.
@@ -1231,14 +1521,45 @@ bool CalculatorGraph::UnthrottleSources() {
           "\"resolve_deadlock\".")));
       continue;
     }
-    int new_size = stream->QueueSize() + 1;
-    stream->SetMaxQueueSize(new_size);
-    LOG_EVERY_N(WARNING, 100)
-        << "Resolved a deadlock by increasing max_queue_size of input stream: "
-        << stream->Name() << " to: " << new_size
-        << ". Consider increasing max_queue_size for better performance.";
+    const int max_queue_size = stream->MaxQueueSize();
+    if (max_queue_size != -1 && stream->QueueSize() >= max_queue_size) {
+      int new_size = stream->QueueSize() + 1;
+      stream->SetMaxQueueSize(new_size);
+      LOG_EVERY_N(WARNING, 100)
+          << "Resolved a deadlock by increasing max_queue_size of input "
+             "stream: "
+          << stream->Name() << " to: " << new_size
+          << ". Consider increasing max_queue_size for better performance.";
+    }
+    const int64 max_queue_bytes = stream->MaxQueueBytes();
+    if (max_queue_bytes != -1 && stream->QueuedBytes() >= max_queue_bytes) {
+      int64 new_bytes = stream->QueuedBytes() + 1;
+      stream->SetMaxQueueBytes(new_bytes);
+      LOG_EVERY_N(WARNING, 100)
+          << "Resolved a deadlock by increasing max_queue_bytes of input "
+             "stream: "
+          << stream->Name() << " to: " << new_bytes
+          << ". Consider increasing max_queue_bytes for better performance.";
+    }
   }
-  return !full_streams.empty();
+  if (queue_budget_full) {
+    if (Config().report_deadlock()) {
+      RecordError(absl::UnavailableError(
+          "Detected a deadlock due to the queue byte budget of the graph. All "
+          "calculators are idle while packet sources remain active and "
+          "throttled.  Consider adjusting \"max_queue_bytes\" or "
+          "\"resolve_deadlock\"."));
+    } else {
+      int64 new_bytes = queue_budget_->QueuedBytes() + 1;
+      queue_budget_->SetMaxBytes(new_bytes);
+      LOG_EVERY_N(WARNING, 100)
+          << "Resolved a deadlock by increasing max_queue_bytes of the graph "
+             "to: "
+          << new_bytes
+          << ". Consider increasing max_queue_bytes for better performance.";
+    }
+  }
+  return !full_streams.empty() || queue_budget_full;
 }
 
 CalculatorGraph::GraphInputStreamAddMode
@@ -1257,6 +1578,24 @@ void CalculatorGraph::Cancel() {
   scheduler_.Cancel();
 }
 
+void CalculatorGraph::TrimMemory(MemoryTrimLevel level) {
+  if (auto pool = service_manager_.GetServiceObject(
+          kImageFrameMultiPoolService)) {
+    pool->Clear();
+  }
+  if (auto pool = service_manager_.GetServiceObject(kTensorPoolService)) {
+    pool->FreeUnusedStorages();
+  }
+#if !MEDIAPIPE_DISABLE_GPU
+  if (auto gpu_resources = service_manager_.GetServiceObject(kGpuService)) {
+    gpu_resources->TrimMemory(level);
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  if (auto trimmer = service_manager_.GetServiceObject(kMemoryTrimmerService)) {
+    trimmer->Trim(level);
+  }
+}
+
 void CalculatorGraph::Pause() { scheduler_.Pause(); }
 
 void CalculatorGraph::Resume() { scheduler_.Resume(); }
@@ -1354,6 +1693,14 @@ void CalculatorGraph::CleanupAfterRun(absl::Status* status) {
   {
     absl::MutexLock lock(&full_input_streams_mutex_);
     full_input_streams_.clear();
+    // Nodes are no longer throttled once the run is over.
+    const absl::Time now = absl::Now();
+    for (ThrottleStats& stats : throttle_stats_) {
+      if (stats.throttled_since != absl::InfiniteFuture()) {
+        stats.throttled_time += now - stats.throttled_since;
+        stats.throttled_since = absl::InfiniteFuture();
+      }
+    }
   }
   // Note: output_side_packets_ and current_run_side_packets_ are not cleared
   // in order to enable GetOutputSidePacket after WaitUntilDone.
@@ -1392,4 +1739,76 @@ absl::Status CalculatorGraph::GetCalculatorProfiles(
   return profiler_->GetCalculatorProfiles(profiles);
 }
 
+absl::Status CalculatorGraph::GetGraphMetrics(GraphMetrics* metrics) {
+  RET_CHECK(initialized_) << "CalculatorGraph is not initialized.";
+  metrics->sample_time = absl::Now();
+  metrics->nodes.clear();
+  metrics->input_streams.clear();
+
+  std::vector<CalculatorProfile> profiles;
+  MP_RETURN_IF_ERROR(profiler_->GetCalculatorProfiles(&profiles));
+  absl::flat_hash_map<std::string, const CalculatorProfile*> profiles_by_name;
+  for (const CalculatorProfile& profile : profiles) {
+    profiles_by_name[profile.name()] = &profile;
+  }
+
+  const int num_calculators = validated_graph_->CalculatorInfos().size();
+  metrics->nodes.resize(num_calculators + graph_input_stream_node_ids_.size());
+  std::vector<std::string> node_names(num_calculators);
+  for (int i = 0; i < num_calculators; ++i) {
+    node_names[i] = tool::CanonicalNodeName(validated_graph_->Config(), i);
+    GraphMetrics::Node& node = metrics->nodes[i];
+    node.name = node_names[i];
+    auto profile = profiles_by_name.find(node.name);
+    if (profile != profiles_by_name.end()) {
+      node.process_runtime = profile->second->process_runtime();
+      node.process_input_latency = profile->second->process_input_latency();
+    }
+  }
+  for (const auto& [stream_name, node_id] : graph_input_stream_node_ids_) {
+    GraphMetrics::Node& node = metrics->nodes[node_id];
+    node.name = stream_name;
+    node.is_graph_input_stream = true;
+  }
+  {
+    absl::MutexLock lock(&full_input_streams_mutex_);
+    const absl::Time now = absl::Now();
+    for (int node_id = 0;
+         node_id < metrics->nodes.size() && node_id < throttle_stats_.size();
+         ++node_id) {
+      const ThrottleStats& stats = throttle_stats_[node_id];
+      GraphMetrics::Node& node = metrics->nodes[node_id];
+      node.is_throttled = stats.throttled_since != absl::InfiniteFuture();
+      node.throttle_count = stats.throttle_count;
+      node.throttled_time = stats.throttled_time;
+      if (node.is_throttled) {
+        node.throttled_time += now - stats.throttled_since;
+      }
+    }
+  }
+
+  const std::vector<EdgeInfo>& stream_infos =
+      validated_graph_->InputStreamInfos();
+  metrics->input_streams.reserve(stream_infos.size());
+  for (int i = 0; i < stream_infos.size(); ++i) {
+    const InputStreamManager& manager = input_stream_managers_[i];
+    GraphMetrics::InputStream& stream = metrics->input_streams.emplace_back();
+    stream.node_name = node_names[stream_infos[i].parent_node.index];
+    stream.stream_name = stream_infos[i].name;
+    stream.queue_size = manager.QueueSize();
+    stream.max_queue_size = manager.MaxQueueSize();
+    stream.packets_added = manager.NumPacketsAdded();
+    stream.has_memory_accounting = manager.MemoryAccountingEnabled();
+    stream.queued_bytes = manager.QueuedBytes();
+    stream.peak_queue_size = manager.PeakQueueSize();
+    stream.peak_queued_bytes = manager.PeakQueuedBytes();
+    stream.max_queue_bytes = manager.MaxQueueBytes();
+  }
+  if (queue_budget_) {
+    metrics->queued_bytes = queue_budget_->QueuedBytes();
+    metrics->max_queue_bytes = queue_budget_->MaxBytes();
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace mediapipe
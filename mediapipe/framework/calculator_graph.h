@@ -30,16 +30,21 @@
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_base.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/counter_factory.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/graph_metrics.h"
 #include "mediapipe/framework/graph_output_stream.h"
 #include "mediapipe/framework/graph_service.h"
 #include "mediapipe/framework/graph_service_manager.h"
+#include "mediapipe/framework/input_stream_manager.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
+#include "mediapipe/framework/memory_trimmer.h"
 #include "mediapipe/framework/output_side_packet_impl.h"
 #include "mediapipe/framework/output_stream.h"
 #include "mediapipe/framework/output_stream_manager.h"
@@ -158,6 +163,14 @@ class CalculatorGraph {
       std::function<absl::Status(const Packet&)> packet_callback,
       bool observe_timestamp_bounds = false);
 
+  // Observes the packets added to the graph input streams: packet_callback
+  // is invoked with the name of the stream and the packet, on the thread
+  // adding the packet, before the packet is added. Used to record the inputs
+  // of a run, see tool/packet_recording.h. Can only be called before Run()
+  // or StartRun().
+  void ObserveInputStreams(
+      std::function<void(const std::string&, const Packet&)> packet_callback);
+
   // Adds an OutputStreamPoller for a stream. This provides a synchronous,
   // polling API for accessing a stream's output. Should only be called before
   // Run() or StartRun(). For asynchronous output, use ObserveOutputStream. See
@@ -257,6 +270,34 @@ class CalculatorGraph {
   absl::Status AddPacketToInputStream(const std::string& stream_name,
                                       Packet&& packet);
 
+  // A graph input stream resolved by GetInputStreamHandle(), so that packets
+  // can be added to it without looking its name up on every call.
+  class GraphInputStreamHandle;
+
+  // Returns a handle to the graph input stream named `stream_name`. Can be
+  // called once the graph is initialized, and the handle stays valid for the
+  // lifetime of the graph, across runs.
+  absl::StatusOr<GraphInputStreamHandle> GetInputStreamHandle(
+      const std::string& stream_name);
+
+  // Same as the functions above, for a stream resolved by
+  // GetInputStreamHandle().
+  absl::Status AddPacketToInputStream(GraphInputStreamHandle stream,
+                                      const Packet& packet);
+  absl::Status AddPacketToInputStream(GraphInputStreamHandle stream,
+                                      Packet&& packet);
+
+  // Adds one packet to each of several graph input streams at once, such as
+  // the packets of a frame for streams read by the same node. Throttling is
+  // checked for all the streams together, as for a single stream under the
+  // graph input stream add mode: in ADD_IF_NOT_FULL mode, nothing is added and
+  // StatusUnavailable is returned if any of the streams is throttled. The
+  // packets are only propagated to the nodes once they are all added, and the
+  // scheduler is notified once for the batch. A stream may appear several
+  // times, with increasing timestamps.
+  absl::Status AddPacketsToInputStreams(
+      std::vector<std::pair<GraphInputStreamHandle, Packet>> packets);
+
   // Indicates that input will arrive no earlier than a certain timestamp.
   absl::Status SetInputStreamTimestampBound(const std::string& stream_name,
                                             Timestamp timestamp);
@@ -296,6 +337,12 @@ class CalculatorGraph {
   ABSL_DEPRECATED("Use profiler()->GetCalculatorProfiles() instead")
   absl::Status GetCalculatorProfiles(std::vector<CalculatorProfile>*) const;
 
+  // Samples the runtime metrics of the graph: the profiler histograms of the
+  // nodes, the queue sizes of their input streams, and node throttling. May
+  // be called from any thread after the graph has been initialized.
+  absl::Status GetGraphMetrics(GraphMetrics* metrics)
+      ABSL_LOCKS_EXCLUDED(full_input_streams_mutex_);
+
   // Set the type of counter used in this graph.
   void SetCounterFactory(CounterFactory* factory) {
     counter_factory_.reset(factory);
@@ -325,6 +372,13 @@ class CalculatorGraph {
   // Aborts the scheduler if the graph is not terminated; no-op otherwise.
   void Cancel();
 
+  // Gives memory back when the system is low on memory: frees the buffers
+  // kept by the graph's ImageFrame, Tensor and GPU buffer pools, and calls the
+  // callbacks calculators registered with kMemoryTrimmerService. Everything is
+  // allocated again when next needed. Can be called from any thread, but not
+  // concurrently with StartRun(), which sets up the services.
+  void TrimMemory(MemoryTrimLevel level);
+
   // Pauses the scheduler. Only used by calculator graph testing.
   ABSL_DEPRECATED(
       "CalculatorGraph will not allow external callers to explictly pause and "
@@ -454,6 +508,23 @@ class CalculatorGraph {
   template <typename T>
   absl::Status AddPacketToInputStreamInternal(const std::string& stream_name,
                                               T&& packet);
+  template <typename T>
+  absl::Status AddPacketToInputStreamInternal(GraphInputStreamHandle stream,
+                                              T&& packet);
+
+  // Waits until packets can be added to the graph input streams with the
+  // given virtual node ids, following graph_input_stream_add_mode_.
+  absl::Status WaitUntilInputStreamsAddable(absl::Span<const int> node_ids)
+      ABSL_LOCKS_EXCLUDED(full_input_streams_mutex_);
+
+  // Returns true if any of the graph input streams with the given virtual
+  // node ids is being throttled.
+  bool IsAnyInputStreamThrottled(absl::Span<const int> node_ids)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(full_input_streams_mutex_);
+
+  // Adds a packet to a graph input stream, without propagating it.
+  template <typename T>
+  void AddPacketToGraphInputStream(GraphInputStream* stream, T&& packet);
 
   // Sets the executor that will run the nodes assigned to the executor
   // named |name|.  If |name| is empty, this sets the default executor.
@@ -487,6 +558,13 @@ class CalculatorGraph {
   absl::Status InitializeStreams();
   absl::Status InitializeProfiler();
   absl::Status InitializeCalculatorNodes();
+  // Connects each calculator node to its downstream nodes for the critical
+  // path estimates, and enables critical path scheduling.
+  void InitializeCriticalPathScheduling();
+  // Assigns the nodes without an executor to the executors of their
+  // accelerators, or if they have none, the heavy and light nodes to the
+  // executors that require high and low processor performance, if any.
+  void InitializeWorkloadExecutors();
   absl::Status InitializePacketGeneratorNodes(
       const std::vector<int>& non_scheduled_generators);
 
@@ -541,6 +619,20 @@ class CalculatorGraph {
   // status before taking any action.
   void UpdateThrottledNodes(InputStreamManager* stream, bool* stream_was_full);
 
+  // Callback when queue_budget_ becomes full or non-full. While it is full,
+  // all the source nodes and graph input streams are throttled, as if
+  // throttled by a full input stream represented by nullptr. Like
+  // UpdateThrottledNodes(), it re-checks the budget before taking any action.
+  void UpdateThrottledNodesForQueueBudget();
+
+  // Records that the full input stream "stream", or queue_budget_ if
+  // nullptr, starts or stops throttling the node, and collects the nodes to
+  // schedule once they are no longer throttled.
+  void UpdateNodeThrottling(int node_id, InputStreamManager* stream,
+                            bool is_full,
+                            std::vector<CalculatorNode*>* nodes_to_schedule)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(full_input_streams_mutex_);
+
 #if !MEDIAPIPE_DISABLE_GPU
   // Owns the legacy GpuSharedData if we need to create one for backwards
   // compatibility.
@@ -578,10 +670,26 @@ class CalculatorGraph {
   std::vector<std::shared_ptr<internal::GraphOutputStream>>
       graph_output_streams_;
 
+  // Observes the packets added to the graph input streams, if set.
+  std::function<void(const std::string&, const Packet&)>
+      input_stream_observer_;
+
   // Maximum queue size for an input stream. This is used by the scheduler to
   // restrict memory usage.
   int max_queue_size_ = -1;
 
+  // True if an input stream has a byte budget, or the graph has one.
+  bool has_queue_byte_budgets_ = false;
+
+  // The byte budget shared by all the input streams, if
+  // CalculatorGraphConfig.max_queue_bytes is set.
+  std::unique_ptr<SharedQueueBudget> queue_budget_;
+
+  // Whether queue_budget_ was full at the last
+  // UpdateThrottledNodesForQueueBudget().
+  bool queue_budget_was_full_ ABSL_GUARDED_BY(full_input_streams_mutex_) =
+      false;
+
   // Mode for adding packets to a graph input stream. Set to block until all
   // affected input streams are not full by default.
   GraphInputStreamAddMode graph_input_stream_add_mode_
@@ -589,13 +697,27 @@ class CalculatorGraph {
 
   // For a source node or graph input stream (specified using id),
   // this stores the set of dependent input streams that have hit their
-  // maximum capacity. Graph input streams are also treated as nodes.
+  // maximum capacity, and nullptr while queue_budget_ is exhausted. Graph
+  // input streams are also treated as nodes.
   // A node is scheduled only if this set is empty.  Similarly, a packet
   // is added to a graph input stream only if this set is empty.
   // Note that this vector contains an unused entry for each non-source node.
   std::vector<absl::flat_hash_set<InputStreamManager*>> full_input_streams_
       ABSL_GUARDED_BY(full_input_streams_mutex_);
 
+  // The throttling counters of a source node or graph input stream.
+  struct ThrottleStats {
+    // The time the node became throttled, or InfiniteFuture if it is not.
+    absl::Time throttled_since = absl::InfiniteFuture();
+    absl::Duration throttled_time;
+    int64 throttle_count = 0;
+  };
+
+  // The throttling counters, indexed like full_input_streams_. Unlike
+  // full_input_streams_, they are kept across runs.
+  std::vector<ThrottleStats> throttle_stats_
+      ABSL_GUARDED_BY(full_input_streams_mutex_);
+
   // Maps stream names to graph input stream objects.
   absl::flat_hash_map<std::string, std::unique_ptr<GraphInputStream>>
       graph_input_streams_;
@@ -657,6 +779,20 @@ class CalculatorGraph {
   internal::Scheduler scheduler_;
 };
 
+class CalculatorGraph::GraphInputStreamHandle {
+ public:
+  GraphInputStreamHandle() = default;
+
+ private:
+  friend class CalculatorGraph;
+
+  GraphInputStreamHandle(GraphInputStream* stream, int node_id)
+      : stream_(stream), node_id_(node_id) {}
+
+  GraphInputStream* stream_ = nullptr;
+  int node_id_ = -1;
+};
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_CALCULATOR_GRAPH_H_
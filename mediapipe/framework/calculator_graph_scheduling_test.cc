@@ -0,0 +1,426 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for the order in which the scheduler runs ready nodes.
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kLogTag[] = "LOG";
+constexpr char kSleepMsTag[] = "SLEEP_MS";
+constexpr char kFailAtTag[] = "FAIL_AT";
+constexpr char kStartedTag[] = "STARTED";
+constexpr char kReleaseTag[] = "RELEASE";
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+// Passes its input through, after appending its node name to the vector in
+// the "LOG" side packet and sleeping for the optional "SLEEP_MS" side packet.
+class RecordingCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    cc->InputSidePackets().Tag(kLogTag).Set<std::vector<std::string>*>();
+    if (cc->InputSidePackets().HasTag(kSleepMsTag)) {
+      cc->InputSidePackets().Tag(kSleepMsTag).Set<int>();
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->InputSidePackets().Tag(kLogTag).Get<std::vector<std::string>*>()
+        ->push_back(cc->NodeName());
+    if (cc->InputSidePackets().HasTag(kSleepMsTag)) {
+      absl::SleepFor(absl::Milliseconds(
+          cc->InputSidePackets().Tag(kSleepMsTag).Get<int>()));
+    }
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(RecordingCalculator);
+
+// A RecordingCalculator that can run right after the node that made it ready,
+// in the same task, and that fails on the timestamp of the optional "FAIL_AT"
+// side packet.
+class InlineRecordingCalculator : public RecordingCalculator {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    MP_RETURN_IF_ERROR(RecordingCalculator::GetContract(cc));
+    if (cc->InputSidePackets().HasTag(kFailAtTag)) {
+      cc->InputSidePackets().Tag(kFailAtTag).Set<int>();
+    }
+    cc->SetInlineSafe(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (cc->InputSidePackets().HasTag(kFailAtTag) &&
+        cc->InputTimestamp() ==
+            Timestamp(cc->InputSidePackets().Tag(kFailAtTag).Get<int>())) {
+      return absl::InternalError(
+          absl::StrCat(cc->NodeName(), " failed at ",
+                       cc->InputTimestamp().Value()));
+    }
+    return RecordingCalculator::Process(cc);
+  }
+};
+REGISTER_CALCULATOR(InlineRecordingCalculator);
+
+// Passes its input through, after notifying the "STARTED" side packet and
+// waiting for the "RELEASE" side packet to be notified.
+class BlockingCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    cc->InputSidePackets().Tag(kStartedTag).Set<absl::Notification*>();
+    cc->InputSidePackets().Tag(kReleaseTag).Set<absl::Notification*>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->InputSidePackets().Tag(kStartedTag).Get<absl::Notification*>()
+        ->Notify();
+    cc->InputSidePackets().Tag(kReleaseTag).Get<absl::Notification*>()
+        ->WaitForNotification();
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(BlockingCalculator);
+
+// Sends "num_packets" packets into "in", one at a time, and returns the order
+// in which the nodes processed each of them. All nodes run on the application
+// thread, so that every node that becomes ready for a packet is queued before
+// any of them runs.
+std::vector<std::vector<std::string>> RunGraph(CalculatorGraphConfig config,
+                                               int num_packets) {
+  config.add_executor()->set_type("ApplicationThreadExecutor");
+  std::vector<std::string> log;
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  MP_EXPECT_OK(graph.StartRun(
+      {{"log", MakePacket<std::vector<std::string>*>(&log)},
+       {"sleep_ms", MakePacket<int>(5)}}));
+  std::vector<std::vector<std::string>> orders;
+  for (int i = 0; i < num_packets; ++i) {
+    MP_EXPECT_OK(
+        graph.AddPacketToInputStream("in", MakePacket<int>(i).At(Timestamp(i))));
+    MP_EXPECT_OK(graph.WaitUntilIdle());
+    orders.push_back(std::move(log));
+    log.clear();
+  }
+  MP_EXPECT_OK(graph.CloseAllInputStreams());
+  MP_EXPECT_OK(graph.WaitUntilDone());
+  return orders;
+}
+
+TEST(CalculatorGraphSchedulingTest, HigherPriorityNodesRunFirst) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    node {
+      name: "first"
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "first_out"
+      input_side_packet: "LOG:log"
+    }
+    node {
+      name: "second"
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "second_out"
+      input_side_packet: "LOG:log"
+    }
+  )pb");
+  // Without priorities, nodes that come later in the config run first.
+  EXPECT_THAT(RunGraph(config, 1), ElementsAre(ElementsAre("second", "first")));
+
+  config.mutable_node(0)->set_priority(1);
+  EXPECT_THAT(RunGraph(config, 1), ElementsAre(ElementsAre("first", "second")));
+}
+
+TEST(CalculatorGraphSchedulingTest, LongerCriticalPathsRunFirst) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    node {
+      name: "slow"
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "slow_out"
+      input_side_packet: "LOG:log"
+      input_side_packet: "SLEEP_MS:sleep_ms"
+    }
+    node {
+      name: "slow_tail"
+      calculator: "RecordingCalculator"
+      input_stream: "slow_out"
+      output_stream: "slow_tail_out"
+      input_side_packet: "LOG:log"
+      input_side_packet: "SLEEP_MS:sleep_ms"
+    }
+    node {
+      name: "fast"
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "fast_out"
+      input_side_packet: "LOG:log"
+    }
+  )pb");
+  EXPECT_THAT(RunGraph(config, 2),
+              ElementsAre(ElementsAre("fast", "slow", "slow_tail"),
+                          ElementsAre("fast", "slow", "slow_tail")));
+
+  // Once the runtimes of the first packet have been measured, the slow branch
+  // is known to be on the critical path.
+  config.set_scheduling_policy(CalculatorGraphConfig::CRITICAL_PATH);
+  EXPECT_THAT(RunGraph(config, 2),
+              ElementsAre(ElementsAre("fast", "slow", "slow_tail"),
+                          ElementsAre("slow", "slow_tail", "fast")));
+}
+
+TEST(CalculatorGraphSchedulingTest, PriorityOverridesCriticalPath) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    scheduling_policy: CRITICAL_PATH
+    node {
+      name: "slow"
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "slow_out"
+      input_side_packet: "LOG:log"
+      input_side_packet: "SLEEP_MS:sleep_ms"
+    }
+    node {
+      name: "fast"
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "fast_out"
+      input_side_packet: "LOG:log"
+      priority: 1
+    }
+  )pb");
+  EXPECT_THAT(RunGraph(config, 2), ElementsAre(ElementsAre("fast", "slow"),
+                                               ElementsAre("fast", "slow")));
+}
+
+
+TEST(CalculatorGraphSchedulingTest, FusedNodesKeepPriorityOrder) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    node {
+      name: "head"
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "head_out"
+      input_side_packet: "LOG:log"
+      priority: 2
+    }
+    node {
+      name: "tail"
+      calculator: "InlineRecordingCalculator"
+      input_stream: "head_out"
+      output_stream: "tail_out"
+      input_side_packet: "LOG:log"
+    }
+    node {
+      name: "other"
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "other_out"
+      input_side_packet: "LOG:log"
+      priority: 1
+    }
+  )pb");
+  // "tail" becomes ready after "head" while "other" is queued, and runs after
+  // it, as it would without fusion.
+  EXPECT_THAT(RunGraph(config, 2),
+              ElementsAre(ElementsAre("head", "other", "tail"),
+                          ElementsAre("head", "other", "tail")));
+
+  // Without a queued node to run first, "tail" runs right after "head".
+  config.mutable_node(2)->set_priority(-1);
+  EXPECT_THAT(RunGraph(config, 1),
+              ElementsAre(ElementsAre("head", "tail", "other")));
+}
+
+TEST(CalculatorGraphSchedulingTest, PausedGraphDoesNotRunFusedNodes) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    num_threads: 2
+    node {
+      name: "head"
+      calculator: "BlockingCalculator"
+      input_stream: "in"
+      output_stream: "head_out"
+      input_side_packet: "STARTED:started"
+      input_side_packet: "RELEASE:release"
+    }
+    node {
+      name: "tail"
+      calculator: "InlineRecordingCalculator"
+      input_stream: "head_out"
+      output_stream: "out"
+      input_side_packet: "LOG:log"
+    }
+  )pb");
+  std::vector<std::string> log;
+  absl::Notification started;
+  absl::Notification release;
+  std::atomic<int> num_outputs(0);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.ObserveOutputStream("out", [&](const Packet&) {
+    ++num_outputs;
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun(
+      {{"log", MakePacket<std::vector<std::string>*>(&log)},
+       {"started", MakePacket<absl::Notification*>(&started)},
+       {"release", MakePacket<absl::Notification*>(&release)}}));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(0).At(Timestamp(0))));
+
+  // "tail" becomes ready while the graph is paused, in the task of "head".
+  started.WaitForNotification();
+  graph.Pause();
+  release.Notify();
+  absl::SleepFor(absl::Milliseconds(50));
+  EXPECT_EQ(num_outputs, 0);
+
+  graph.Resume();
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  EXPECT_EQ(num_outputs, 1);
+  EXPECT_THAT(log, ElementsAre("tail"));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST(CalculatorGraphSchedulingTest, WaitUntilIdleWaitsForFusedChains) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    num_threads: 4
+    node {
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "a"
+      input_side_packet: "LOG:log"
+    }
+    node {
+      calculator: "InlineRecordingCalculator"
+      input_stream: "a"
+      output_stream: "b"
+      input_side_packet: "LOG:log"
+    }
+    node {
+      calculator: "InlineRecordingCalculator"
+      input_stream: "b"
+      output_stream: "c"
+      input_side_packet: "LOG:log"
+    }
+    node {
+      calculator: "InlineRecordingCalculator"
+      input_stream: "c"
+      output_stream: "out"
+      input_side_packet: "LOG:log"
+    }
+  )pb");
+  std::vector<std::string> log;
+  std::atomic<int> num_outputs(0);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.ObserveOutputStream("out", [&](const Packet&) {
+    ++num_outputs;
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun(
+      {{"log", MakePacket<std::vector<std::string>*>(&log)}}));
+  for (int i = 0; i < 100; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+    ASSERT_EQ(num_outputs, i + 1);
+    ASSERT_EQ(log.size(), 4 * (i + 1));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST(CalculatorGraphSchedulingTest, FusedNodeErrorsStopTheGraph) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    node {
+      name: "head"
+      calculator: "RecordingCalculator"
+      input_stream: "in"
+      output_stream: "head_out"
+      input_side_packet: "LOG:log"
+    }
+    node {
+      name: "failing"
+      calculator: "InlineRecordingCalculator"
+      input_stream: "head_out"
+      output_stream: "failing_out"
+      input_side_packet: "LOG:log"
+      input_side_packet: "FAIL_AT:fail_at"
+    }
+    node {
+      name: "tail"
+      calculator: "InlineRecordingCalculator"
+      input_stream: "failing_out"
+      output_stream: "out"
+      input_side_packet: "LOG:log"
+    }
+  )pb");
+  config.add_executor()->set_type("ApplicationThreadExecutor");
+  std::vector<std::string> log;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun(
+      {{"log", MakePacket<std::vector<std::string>*>(&log)},
+       {"fail_at", MakePacket<int>(1)}}));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(0).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  EXPECT_THAT(log, ElementsAre("head", "failing", "tail"));
+  log.clear();
+
+  // Adding the packet may already report the error.
+  graph.AddPacketToInputStream("in", MakePacket<int>(1).At(Timestamp(1)))
+      .IgnoreError();
+  graph.CloseAllInputStreams().IgnoreError();
+  absl::Status status = graph.WaitUntilDone();
+  EXPECT_THAT(status.message(), HasSubstr("failing failed at 1"));
+  EXPECT_THAT(log, ElementsAre("head"));
+}
+
+}  // namespace
+}  // namespace mediapipe
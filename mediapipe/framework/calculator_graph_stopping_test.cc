@@ -21,6 +21,7 @@
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/packet_size.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/core_proto_inc.h"
 #include "mediapipe/framework/port/gmock.h"
@@ -384,4 +385,90 @@ TEST(CalculatorGraphStoppingTest, DeadlockResolution) {
   ASSERT_EQ(21, out_packets.size());
 }
 
+int64 StringSize(const std::string& value) { return value.size(); }
+MEDIAPIPE_REGISTER_PACKET_SIZE_ESTIMATOR(std::string, StringSize);
+
+// The graph for the tests of the queue byte budget of the graph. The packets
+// on "in_1" are queued until a packet arrives on "in_2".
+constexpr char kQueueBytesGraph[] = R"(
+    input_stream: 'in_1'
+    input_stream: 'in_2'
+    max_queue_size: -1
+    max_queue_bytes: 10
+    node {
+      calculator: 'ProcessCallbackCalculator'
+      input_stream: 'in_1'
+      input_stream: 'in_2'
+      output_stream: 'out_1'
+      output_stream: 'out_2'
+      input_side_packet: 'callback_1'
+    }
+    package: 'testing_ns'
+  )";
+
+// Verify that deadlock due to the queue byte budget can be reported.
+TEST(CalculatorGraphStoppingTest, QueueBytesDeadlockReporting) {
+  CalculatorGraphConfig config;
+  ASSERT_TRUE(proto_ns::TextFormat::ParseFromString(kQueueBytesGraph, &config));
+  config.set_report_deadlock(true);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+  ProcessFunction callback_1 = DoProcess;
+  MP_ASSERT_OK(graph.StartRun({
+      {"callback_1", AdoptAsUniquePtr(new auto(callback_1))},
+  }));
+
+  // The third packet exhausts the budget of 10 bytes, with no packets on
+  // "in_2".
+  for (int i = 1; i <= 3; ++i) {
+    MP_EXPECT_OK(graph.AddPacketToInputStream(
+        "in_1", MakePacket<std::string>("abcd").At(Timestamp(i))));
+  }
+  absl::Status status = graph.WaitUntilIdle();
+  EXPECT_EQ(status.code(), absl::StatusCode::kUnavailable);
+  EXPECT_THAT(status.message(),
+              testing::HasSubstr("queue byte budget of the graph"));
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  EXPECT_FALSE(graph.WaitUntilDone().ok());
+}
+
+// Verify that the queue byte budget grows due to deadlock resolution.
+TEST(CalculatorGraphStoppingTest, QueueBytesDeadlockResolution) {
+  CalculatorGraphConfig config;
+  ASSERT_TRUE(proto_ns::TextFormat::ParseFromString(kQueueBytesGraph, &config));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::WAIT_TILL_NOT_FULL);
+  std::vector<Packet> out_packets;
+  MP_ASSERT_OK(
+      graph.ObserveOutputStream("out_1", [&out_packets](const Packet& packet) {
+        out_packets.push_back(packet);
+        return absl::OkStatus();
+      }));
+  ProcessFunction callback_1 = DoProcess;
+  MP_ASSERT_OK(graph.StartRun({
+      {"callback_1", AdoptAsUniquePtr(new auto(callback_1))},
+  }));
+
+  // Each packet from the third one exhausts the budget, which grows to one
+  // byte more than the queued bytes.
+  for (int i = 1; i <= 5; ++i) {
+    MP_EXPECT_OK(graph.AddPacketToInputStream(
+        "in_1", MakePacket<std::string>("abcd").At(Timestamp(i))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+  }
+  mediapipe::GraphMetrics metrics;
+  MP_ASSERT_OK(graph.GetGraphMetrics(&metrics));
+  EXPECT_EQ(20, metrics.queued_bytes);
+  EXPECT_EQ(21, metrics.max_queue_bytes);
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(5, out_packets.size());
+}
+
 }  // namespace testing_ns
@@ -21,10 +21,13 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/fixed_array.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/escaping.h"
@@ -32,6 +35,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -948,6 +952,48 @@ class SemaphoreCalculator : public CalculatorBase {
 };
 REGISTER_CALCULATOR(SemaphoreCalculator);
 
+// This calculator waits in Open until two instances are opening at the same
+// time, which fails if they are opened one after the other.
+class ConcurrentOpenCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    cc->SetTimestampOffset(TimestampDiff(0));
+    cc->SetInputStreamHeadersNeeded(false);
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    absl::MutexLock lock(&mutex_);
+    ++num_opening_;
+    auto all_opening = []() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+      return num_opening_ >= 2;
+    };
+    RET_CHECK(mutex_.AwaitWithTimeout(absl::Condition(&all_opening),
+                                      absl::Seconds(10)))
+        << "Nodes weren't opened concurrently.";
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+
+  static void Reset() {
+    absl::MutexLock lock(&mutex_);
+    num_opening_ = 0;
+  }
+
+ private:
+  static absl::Mutex mutex_;
+  static int num_opening_ ABSL_GUARDED_BY(mutex_);
+};
+absl::Mutex ConcurrentOpenCalculator::mutex_;
+int ConcurrentOpenCalculator::num_opening_ = 0;
+REGISTER_CALCULATOR(ConcurrentOpenCalculator);
+
 // A calculator that has no input streams and output streams, runs only once,
 // and takes 20 milliseconds to run.
 class OneShot20MsCalculator : public CalculatorBase {
@@ -1512,6 +1558,18 @@ TEST(CalculatorGraph, RunsCorrectlyWithCurrentThreadExecutor) {
   RunComprehensiveTest(&graph, proto, /*define_node_5=*/true);
 }
 
+TEST(CalculatorGraph, RunsCorrectlyWithWorkStealingExecutor) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig proto = GetConfig();
+  ExecutorConfig* executor = proto.add_executor();
+  ThreadPoolExecutorOptions* extension =
+      executor->mutable_options()->MutableExtension(
+          ThreadPoolExecutorOptions::ext);
+  extension->set_num_threads(4);
+  extension->set_enable_work_stealing(true);
+  RunComprehensiveTest(&graph, proto, /*define_node_5=*/true);
+}
+
 TEST(CalculatorGraph, RunsCorrectlyWithNonDefaultExecutors) {
   CalculatorGraph graph;
   // Add executors "second" and "third".
@@ -2141,6 +2199,183 @@ TEST(CalculatorGraph, InputPacketLifetime) {
   MP_EXPECT_OK(graph.WaitUntilDone());
 }
 
+// Returns a config with `num_branches` chains of two pass-through nodes, from
+// "in_<i>" to "out_<i>", each on an executor of its own, so that the
+// scheduler queues go busy and idle concurrently.
+CalculatorGraphConfig ConcurrentBranchesConfig(int num_branches) {
+  CalculatorGraphConfig config;
+  for (int i = 0; i < num_branches; ++i) {
+    const std::string executor = absl::StrCat("branch_", i);
+    ExecutorConfig* executor_config = config.add_executor();
+    executor_config->set_name(executor);
+    executor_config->set_type("ThreadPoolExecutor");
+    executor_config->mutable_options()
+        ->MutableExtension(ThreadPoolExecutorOptions::ext)
+        ->set_num_threads(1);
+    config.add_input_stream(absl::StrCat("in_", i));
+    for (const auto& [input, output] :
+         {std::make_pair(absl::StrCat("in_", i), absl::StrCat("mid_", i)),
+          std::make_pair(absl::StrCat("mid_", i), absl::StrCat("out_", i))}) {
+      CalculatorGraphConfig::Node* node = config.add_node();
+      node->set_calculator("PassThroughCalculator");
+      node->set_executor(executor);
+      node->add_input_stream(input);
+      node->add_output_stream(output);
+    }
+  }
+  return config;
+}
+
+// Stresses the idle detection of the scheduler: WaitUntilIdle must not return
+// before all the branches have processed all the packets.
+TEST(CalculatorGraph, WaitUntilIdleWithConcurrentQueues) {
+  constexpr int kNumBranches = 4;
+  constexpr int kNumPackets = 500;
+  CalculatorGraphConfig config = ConcurrentBranchesConfig(kNumBranches);
+  std::vector<std::vector<Packet>> outputs(kNumBranches);
+  for (int i = 0; i < kNumBranches; ++i) {
+    tool::AddVectorSink(absl::StrCat("out_", i), &config, &outputs[i]);
+  }
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int t = 0; t < kNumPackets; ++t) {
+    for (int i = 0; i < kNumBranches; ++i) {
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          absl::StrCat("in_", i), MakePacket<int>(t).At(Timestamp(t))));
+    }
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+    for (const auto& packets : outputs) {
+      ASSERT_EQ(packets.size(), t + 1);
+    }
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// Stresses the wake-ups of WaitForObservedOutput, which are signaled without
+// state_mutex_ unless the application thread is waiting.
+TEST(CalculatorGraph, WaitForObservedOutputWithConcurrentQueues) {
+  constexpr int kNumBranches = 4;
+  constexpr int kNumPackets = 500;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(ConcurrentBranchesConfig(kNumBranches)));
+  std::atomic<int> num_observed(0);
+  for (int i = 0; i < kNumBranches; ++i) {
+    MP_ASSERT_OK(graph.ObserveOutputStream(
+        absl::StrCat("out_", i), [&num_observed](const Packet& packet) {
+          ++num_observed;
+          return absl::OkStatus();
+        }));
+  }
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int t = 0; t < kNumPackets; ++t) {
+    for (int i = 0; i < kNumBranches; ++i) {
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          absl::StrCat("in_", i), MakePacket<int>(t).At(Timestamp(t))));
+    }
+    while (num_observed < (t + 1) * kNumBranches) {
+      MP_ASSERT_OK(graph.WaitForObservedOutput());
+    }
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(num_observed, kNumPackets * kNumBranches);
+}
+
+// Stresses the unthrottling of graph input streams, which relies on the
+// scheduler noticing that it is idle while several threads add packets.
+TEST(CalculatorGraph, UnthrottlesConcurrentProducers) {
+  constexpr int kNumBranches = 4;
+  constexpr int kNumPackets = 500;
+  CalculatorGraphConfig config = ConcurrentBranchesConfig(kNumBranches);
+  config.set_max_queue_size(1);
+  std::vector<std::vector<Packet>> outputs(kNumBranches);
+  for (int i = 0; i < kNumBranches; ++i) {
+    tool::AddVectorSink(absl::StrCat("out_", i), &config, &outputs[i]);
+  }
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::WAIT_TILL_NOT_FULL);
+  MP_ASSERT_OK(graph.StartRun({}));
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kNumBranches; ++i) {
+    producers.emplace_back([&graph, i]() {
+      const std::string stream = absl::StrCat("in_", i);
+      for (int t = 0; t < kNumPackets; ++t) {
+        MP_EXPECT_OK(graph.AddPacketToInputStream(
+            stream, MakePacket<int>(t).At(Timestamp(t))));
+      }
+      MP_EXPECT_OK(graph.CloseInputStream(stream));
+    });
+  }
+  for (auto& producer : producers) producer.join();
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  for (const auto& packets : outputs) {
+    EXPECT_EQ(packets.size(), kNumPackets);
+  }
+}
+
+// Test adding packets through input stream handles, one at a time and in
+// batches.
+TEST(CalculatorGraph, AddPacketsToInputStreams) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'a'
+        input_stream: 'b'
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'a'
+          input_stream: 'b'
+          output_stream: 'out_a'
+          output_stream: 'out_b'
+        }
+      )pb");
+  std::vector<Packet> out_a;
+  std::vector<Packet> out_b;
+  tool::AddVectorSink("out_a", &config, &out_a);
+  tool::AddVectorSink("out_b", &config, &out_b);
+  MP_ASSERT_OK(graph.Initialize(config));
+
+  EXPECT_FALSE(graph.GetInputStreamHandle("out_a").ok());
+  MP_ASSERT_OK_AND_ASSIGN(auto a, graph.GetInputStreamHandle("a"));
+  MP_ASSERT_OK_AND_ASSIGN(auto b, graph.GetInputStreamHandle("b"));
+  EXPECT_EQ(graph
+                .AddPacketsToInputStreams(
+                    {{a, MakePacket<int>(0).At(Timestamp(0))}})
+                .code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream(a, MakePacket<int>(1).At(Timestamp(1))));
+  MP_EXPECT_OK(
+      graph.AddPacketToInputStream(b, MakePacket<int>(2).At(Timestamp(1))));
+  for (int i = 2; i < 5; ++i) {
+    MP_EXPECT_OK(graph.AddPacketsToInputStreams(
+        {{a, MakePacket<int>(i).At(Timestamp(i))},
+         {b, MakePacket<int>(i * 2).At(Timestamp(i))}}));
+  }
+  MP_EXPECT_OK(graph.AddPacketsToInputStreams(
+      {{a, MakePacket<int>(5).At(Timestamp(5))},
+       {a, MakePacket<int>(6).At(Timestamp(6))}}));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(out_a.size(), 6);
+  ASSERT_EQ(out_b.size(), 4);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(out_a[i].Get<int>(), i + 1);
+    EXPECT_EQ(out_a[i].Timestamp(), Timestamp(i + 1));
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(out_b[i].Get<int>(), (i + 1) * 2);
+    EXPECT_EQ(out_b[i].Timestamp(), Timestamp(i + 1));
+  }
+}
+
 // Demonstrate an if-then-else graph.
 TEST(CalculatorGraph, IfThenElse) {
   // This graph has an if-then-else structure. The left branch, selected by the
@@ -3546,6 +3781,47 @@ TEST(CalculatorGraph, ObserveOutputStream) {
   }
 }
 
+// Verifies that packets flow through input streams using the lock-free queue.
+TEST(CalculatorGraph, LockFreeInputStreamQueue) {
+  const int max_count = 1000;
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        num_threads: 4
+        node {
+          calculator: 'CountingSourceCalculator'
+          output_stream: 'count'
+          input_side_packet: 'MAX_COUNT:max_count'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'count'
+          output_stream: 'mid'
+          input_stream_info: { tag_index: ':0' lock_free_queue: true }
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'mid'
+          output_stream: 'out'
+          input_stream_info: { tag_index: ':0' lock_free_queue: true }
+        }
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(
+      graph.Initialize(config, {{"max_count", MakePacket<int>(max_count)}}));
+  std::vector<Packet> out_packets;
+  MP_ASSERT_OK(
+      graph.ObserveOutputStream("out", [&out_packets](const Packet& packet) {
+        out_packets.push_back(packet);
+        return absl::OkStatus();
+      }));
+  MP_ASSERT_OK(graph.Run());
+  ASSERT_EQ(max_count, out_packets.size());
+  for (int i = 0; i < out_packets.size(); ++i) {
+    EXPECT_EQ(i, out_packets[i].Get<int>());
+    EXPECT_EQ(Timestamp(i), out_packets[i].Timestamp());
+  }
+}
+
 class PassThroughSubgraph : public Subgraph {
  public:
   absl::StatusOr<CalculatorGraphConfig> GetConfig(
@@ -4195,6 +4471,304 @@ TEST(CalculatorGraph, NumThreadsAndDefaultExecutorConfig) {
                              testing::HasSubstr("default executor")));
 }
 
+// The name of the NamedExecutor running the current task, if any.
+thread_local const std::string* current_executor_name = nullptr;
+
+// A single-threaded executor that makes its name available to the calculators
+// it runs through current_executor_name.
+class NamedExecutor : public Executor {
+ public:
+  explicit NamedExecutor(std::string name)
+      : name_(std::move(name)), thread_pool_(1) {}
+
+  void Schedule(std::function<void()> task) override {
+    thread_pool_.Schedule([this, task = std::move(task)]() {
+      current_executor_name = &name_;
+      task();
+      current_executor_name = nullptr;
+    });
+  }
+
+ private:
+  const std::string name_;
+  ThreadPoolExecutor thread_pool_;
+};
+
+// Outputs the name of the NamedExecutor it runs on for every input packet.
+class ExecutorNameCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).Set<std::string>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<std::string>(current_executor_name ? *current_executor_name
+                                                      : "")
+            .At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(ExecutorNameCalculator);
+
+class HeavyExecutorNameCalculator : public ExecutorNameCalculator {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->SetWorkload(CalculatorContract::Workload::kHeavy);
+    return ExecutorNameCalculator::GetContract(cc);
+  }
+};
+REGISTER_CALCULATOR(HeavyExecutorNameCalculator);
+
+class LightExecutorNameCalculator : public ExecutorNameCalculator {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->SetWorkload(CalculatorContract::Workload::kLight);
+    return ExecutorNameCalculator::GetContract(cc);
+  }
+};
+REGISTER_CALCULATOR(LightExecutorNameCalculator);
+
+class GpuExecutorNameCalculator : public ExecutorNameCalculator {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->SetAccelerator("gpu");
+    return ExecutorNameCalculator::GetContract(cc);
+  }
+};
+REGISTER_CALCULATOR(GpuExecutorNameCalculator);
+
+class HeavyNnapiExecutorNameCalculator : public ExecutorNameCalculator {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->SetWorkload(CalculatorContract::Workload::kHeavy);
+    cc->SetAccelerator("nnapi");
+    return ExecutorNameCalculator::GetContract(cc);
+  }
+};
+REGISTER_CALCULATOR(HeavyNnapiExecutorNameCalculator);
+
+// Runs `config` on the NamedExecutors `executor_names` for one packet and
+// returns the executor name output by each node, keyed by output stream.
+absl::StatusOr<std::map<std::string, std::string>> RunExecutorNameGraph(
+    CalculatorGraphConfig config,
+    const std::vector<std::string>& executor_names) {
+  CalculatorGraph graph;
+  for (const std::string& name : executor_names) {
+    MP_RETURN_IF_ERROR(
+        graph.SetExecutor(name, std::make_shared<NamedExecutor>(name)));
+  }
+  std::vector<std::string> output_names;
+  for (const auto& node : config.node()) {
+    output_names.push_back(node.output_stream(0));
+  }
+  std::map<std::string, std::vector<Packet>> outputs;
+  for (const std::string& name : output_names) {
+    tool::AddVectorSink(name, &config, &outputs[name]);
+  }
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+  MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+      "in", MakePacket<int>(1).At(Timestamp(0))));
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  std::map<std::string, std::string> executors;
+  for (const std::string& name : output_names) {
+    RET_CHECK_EQ(outputs[name].size(), 1) << name;
+    executors[name] = outputs[name][0].Get<std::string>();
+  }
+  return executors;
+}
+
+// Heavy and light nodes run on the executors requiring high and low processor
+// performance, unless they are assigned to an executor in the config.
+TEST(CalculatorGraph, AssignsWorkloadsToExecutors) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        executor {
+          name: 'big'
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] {
+              require_processor_performance: HIGH
+            }
+          }
+        }
+        executor {
+          name: 'little'
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] {
+              require_processor_performance: LOW
+            }
+          }
+        }
+        executor { name: 'custom' }
+        node {
+          calculator: 'HeavyExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'heavy'
+        }
+        node {
+          calculator: 'LightExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'light'
+        }
+        node {
+          calculator: 'ExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'default'
+        }
+        node {
+          calculator: 'HeavyExecutorNameCalculator'
+          executor: 'custom'
+          input_stream: 'in'
+          output_stream: 'heavy_custom'
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto executors,
+      RunExecutorNameGraph(config, {"big", "little", "custom"}));
+  EXPECT_THAT(executors, testing::ElementsAre(
+                             testing::Pair("default", ""),
+                             testing::Pair("heavy", "big"),
+                             testing::Pair("heavy_custom", "custom"),
+                             testing::Pair("light", "little")));
+}
+
+// Without an executor for their workload, nodes stay on the default executor.
+TEST(CalculatorGraph, KeepsWorkloadsWithoutExecutorOnDefaultExecutor) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        executor {
+          name: 'big'
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] {
+              require_processor_performance: HIGH
+            }
+          }
+        }
+        node {
+          calculator: 'HeavyExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'heavy'
+        }
+        node {
+          calculator: 'LightExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'light'
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(auto executors,
+                          RunExecutorNameGraph(config, {"big"}));
+  EXPECT_THAT(executors,
+              testing::ElementsAre(testing::Pair("heavy", "big"),
+                                   testing::Pair("light", "")));
+}
+
+// Nodes on each accelerator run on the executor of that accelerator, which
+// takes precedence over their workload, unless they are assigned to an
+// executor in the config.
+TEST(CalculatorGraph, AssignsAcceleratorsToExecutors) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        executor {
+          name: 'gpu_inference'
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] { accelerator: 'gpu' }
+          }
+        }
+        executor {
+          name: 'nnapi_inference'
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] {
+              accelerator: 'nnapi'
+            }
+          }
+        }
+        executor {
+          name: 'big'
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] {
+              require_processor_performance: HIGH
+            }
+          }
+        }
+        node {
+          calculator: 'GpuExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'gpu'
+        }
+        node {
+          calculator: 'HeavyNnapiExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'nnapi'
+        }
+        node {
+          calculator: 'HeavyExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'heavy'
+        }
+        node {
+          calculator: 'GpuExecutorNameCalculator'
+          executor: 'big'
+          input_stream: 'in'
+          output_stream: 'gpu_on_big'
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto executors,
+      RunExecutorNameGraph(config,
+                           {"gpu_inference", "nnapi_inference", "big"}));
+  EXPECT_THAT(executors, testing::ElementsAre(
+                             testing::Pair("gpu", "gpu_inference"),
+                             testing::Pair("gpu_on_big", "big"),
+                             testing::Pair("heavy", "big"),
+                             testing::Pair("nnapi", "nnapi_inference")));
+}
+
+// An executor can serve several accelerators, and nodes on an accelerator
+// without an executor stay on the default executor.
+TEST(CalculatorGraph, SharesExecutorBetweenAccelerators) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        executor {
+          name: 'inference'
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] {
+              accelerator: 'gpu'
+              accelerator: 'nnapi'
+            }
+          }
+        }
+        node {
+          calculator: 'GpuExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'gpu'
+        }
+        node {
+          calculator: 'HeavyNnapiExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'nnapi'
+        }
+        node {
+          calculator: 'HeavyExecutorNameCalculator'
+          input_stream: 'in'
+          output_stream: 'heavy'
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(auto executors,
+                          RunExecutorNameGraph(config, {"inference"}));
+  EXPECT_THAT(executors,
+              testing::ElementsAre(testing::Pair("gpu", "inference"),
+                                   testing::Pair("heavy", ""),
+                                   testing::Pair("nnapi", "inference")));
+}
+
 // The graph-level num_threads field and the ExecutorConfig for a non-default
 // executor may coexist.
 TEST(CalculatorGraph, NumThreadsAndNonDefaultExecutorConfig) {
@@ -4417,6 +4991,26 @@ class FirstPacketFilterCalculator : public CalculatorBase {
   bool seen_first_packet_ = false;
 };
 REGISTER_CALCULATOR(FirstPacketFilterCalculator);
+
+// Passes through the even integers and only advances the timestamp bound for
+// the odd ones.
+class EvenIntFilterCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    cc->SetTimestampOffset(0);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (cc->Inputs().Index(0).Get<int>() % 2 == 0) {
+      cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    }
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(EvenIntFilterCalculator);
 constexpr int kDefaultMaxCount = 1000;
 
 TEST(CalculatorGraph, TestPollPacket) {
@@ -4520,6 +5114,117 @@ TEST(CalculatorGraph, TestPollPacketsFromMultipleStreams) {
   EXPECT_EQ(kDefaultMaxCount, num_packets2);
 }
 
+TEST(CalculatorGraph, TestPollPacketBatches) {
+  CalculatorGraphConfig config;
+  CalculatorGraphConfig::Node* node = config.add_node();
+  node->set_calculator("CountingSourceCalculator");
+  node->add_output_stream("output");
+  node->add_input_side_packet("MAX_COUNT:max_count");
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  auto status_or_poller = graph.AddOutputStreamPoller("output");
+  ASSERT_TRUE(status_or_poller.ok());
+  OutputStreamPoller poller = std::move(status_or_poller.value());
+  MP_ASSERT_OK(
+      graph.StartRun({{"max_count", MakePacket<int>(kDefaultMaxCount)}}));
+  std::vector<Packet> packets;
+  int num_packets = 0;
+  while (poller.NextBatch(&packets, /*max_packets=*/16)) {
+    EXPECT_LE(packets.size(), 16);
+    for (const Packet& packet : packets) {
+      EXPECT_EQ(num_packets, packet.Get<int>());
+      ++num_packets;
+    }
+  }
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_FALSE(poller.NextBatch(&packets, /*max_packets=*/16));
+  EXPECT_TRUE(packets.empty());
+  EXPECT_EQ(kDefaultMaxCount, num_packets);
+}
+
+TEST(CalculatorGraph, TestPollPacketBatchTimeout) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "input"
+          output_stream: "output"
+        }
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  auto status_or_poller = graph.AddOutputStreamPoller("output");
+  ASSERT_TRUE(status_or_poller.ok());
+  OutputStreamPoller poller = std::move(status_or_poller.value());
+  MP_ASSERT_OK(graph.StartRun({}));
+  std::vector<Packet> packets;
+  EXPECT_TRUE(poller.NextBatch(&packets, /*max_packets=*/4,
+                               absl::Milliseconds(10)));
+  EXPECT_TRUE(packets.empty());
+
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input", MakePacket<int>(1).At(Timestamp(1))));
+  EXPECT_TRUE(poller.NextBatch(&packets, /*max_packets=*/4,
+                               absl::InfiniteDuration()));
+  ASSERT_EQ(1, packets.size());
+  EXPECT_EQ(1, packets[0].Get<int>());
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_FALSE(poller.NextBatch(&packets, /*max_packets=*/4));
+}
+
+TEST(CalculatorGraph, TestPollSyncedPacketsFromMultipleStreams) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "input"
+          output_stream: "all"
+        }
+        node {
+          calculator: "EvenIntFilterCalculator"
+          input_stream: "input"
+          output_stream: "even"
+        }
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  std::vector<OutputStreamPoller> pollers;
+  for (const std::string& stream : {"all", "even"}) {
+    auto status_or_poller =
+        graph.AddOutputStreamPoller(stream, /*observe_timestamp_bounds=*/true);
+    ASSERT_TRUE(status_or_poller.ok());
+    pollers.push_back(std::move(status_or_poller.value()));
+  }
+  SyncedOutputStreamPoller poller(std::move(pollers));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 10; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllPacketSources());
+
+  std::vector<Packet> packets;
+  Timestamp timestamp;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(poller.Next(&packets, &timestamp));
+    EXPECT_EQ(Timestamp(i), timestamp);
+    ASSERT_EQ(2, packets.size());
+    EXPECT_EQ(i, packets[0].Get<int>());
+    if (i % 2 == 0) {
+      EXPECT_EQ(i, packets[1].Get<int>());
+    } else {
+      EXPECT_TRUE(packets[1].IsEmpty());
+    }
+  }
+  EXPECT_FALSE(poller.Next(&packets, &timestamp));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 class TimestampBoundTestCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
@@ -4589,6 +5294,38 @@ TEST(CalculatorGraph, TestPollPacketsWithTimestampNotification) {
   EXPECT_EQ(101, values[2]);
 }
 
+// Nodes that don't need their input stream headers are opened without waiting
+// for their upstream nodes.
+TEST(CalculatorGraph, OpensNodesConcurrently) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        num_threads: 2
+        node {
+          calculator: "ConcurrentOpenCalculator"
+          input_stream: "input"
+          output_stream: "middle"
+        }
+        node {
+          calculator: "ConcurrentOpenCalculator"
+          input_stream: "middle"
+          output_stream: "output"
+        }
+      )pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("output", &config, &output_packets);
+  ConcurrentOpenCalculator::Reset();
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input", MakePacket<int>(1).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(output_packets.size(), 1);
+  EXPECT_EQ(output_packets[0].Get<int>(), 1);
+}
+
 // Ensure that when a custom input stream handler is used to handle packets from
 // input streams, an error message is outputted with the appropriate link to
 // resolve the issue when the calculator doesn't handle inputs in monotonically
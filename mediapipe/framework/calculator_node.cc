@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/calculator_node.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -109,6 +110,67 @@ std::unique_ptr<PacketTypeSet> RemoveOmittedPacketTypes(
   return result;
 }
 
+// Returns "TAG:index" for a "TAG:index:name" side packet.
+std::string TagIndex(const std::string& tag_index_name) {
+  std::string tag;
+  int index;
+  std::string name;
+  if (!tool::ParseTagIndexName(tag_index_name, &tag, &index, &name).ok()) {
+    return tag_index_name;
+  }
+  return absl::StrCat(tag, ":", index);
+}
+
+// Returns a key that is equal for the nodes whose output side packets are
+// equal given equal input side packets, or an empty string if the node's
+// output side packets can't be shared across graphs.
+std::string SharedResourcesKey(const CalculatorGraphConfig::Node& node_config,
+                               const CalculatorContract& contract) {
+  if (!contract.IsPure() || contract.Inputs().NumEntries() > 0 ||
+      contract.Outputs().NumEntries() > 0 ||
+      contract.OutputSidePackets().NumEntries() == 0) {
+    return "";
+  }
+  CalculatorGraphConfig::Node key_node;
+  key_node.set_calculator(node_config.calculator());
+  *key_node.mutable_options() = node_config.options();
+  *key_node.mutable_node_options() = node_config.node_options();
+  // Side packet names differ between graphs, only their tags matter.
+  for (const auto& side_packet : node_config.input_side_packet()) {
+    key_node.add_input_side_packet(TagIndex(side_packet));
+  }
+  for (const auto& side_packet : node_config.output_side_packet()) {
+    key_node.add_output_side_packet(TagIndex(side_packet));
+  }
+  return key_node.SerializeAsString();
+}
+
+// Appends the value of a string, proto or scalar side packet to a key and
+// returns true, or appends the packet identity and returns false.
+bool AppendSidePacketKey(const Packet& packet, std::string* key) {
+  if (packet.IsEmpty()) {
+    absl::StrAppend(key, ";");
+    return true;
+  }
+  const packet_internal::HolderBase* holder =
+      packet_internal::GetHolder(packet);
+  std::string value;
+  bool by_value = true;
+  if (packet.ValidateAsType<std::string>().ok()) {
+    value = packet.Get<std::string>();
+  } else if (packet.ValidateAsProtoMessageLite().ok()) {
+    value = packet.GetProtoMessageLite().SerializeAsString();
+  } else if (!holder->AppendScalarBytes(&value)) {
+    // Unlike the address of an inline payload, the data id is the same for
+    // all copies of the packet.
+    value = absl::StrCat(absl::Hex(holder->DataId()));
+    by_value = false;
+  }
+  absl::StrAppend(key, ";", packet.GetTypeId().hash_code(), ":", value.size(),
+                  ":", value);
+  return by_value;
+}
+
 }  // namespace
 
 CalculatorNode::CalculatorNode() {}
@@ -118,6 +180,21 @@ Timestamp CalculatorNode::SourceProcessOrder(
   return calculator_->SourceProcessOrder(cc);
 }
 
+void CalculatorNode::RecordProcessRuntime(int64 runtime_usec) {
+  // An exponential moving average with weight 1/8 for the new sample. Racing
+  // updates from parallel invocations may drop a sample, which is harmless.
+  int64 estimate = runtime_estimate_usec_.load(std::memory_order_relaxed);
+  estimate = estimate == 0 ? runtime_usec
+                           : estimate + (runtime_usec - estimate) / 8;
+  runtime_estimate_usec_.store(estimate, std::memory_order_relaxed);
+  int64 downstream_usec = 0;
+  for (const CalculatorNode* node : downstream_nodes_) {
+    downstream_usec = std::max(downstream_usec, node->critical_path_usec());
+  }
+  critical_path_usec_.store(estimate + downstream_usec,
+                            std::memory_order_relaxed);
+}
+
 absl::Status CalculatorNode::Initialize(
     const ValidatedGraphConfig* validated_graph, NodeTypeInfo::NodeRef node_ref,
     InputStreamManager* input_stream_managers,
@@ -151,8 +228,10 @@ absl::Status CalculatorNode::Initialize(
     executor_ = node_config->executor();
   }
   source_layer_ = node_config->source_layer();
+  priority_ = node_config->priority();
 
   const CalculatorContract& contract = node_type_info_->Contract();
+  inline_safe_ = contract.IsInlineSafe();
 
   // TODO Propagate types between calculators when SetAny is used.
 
@@ -169,6 +248,12 @@ absl::Status CalculatorNode::Initialize(
   calculator_state_ = absl::make_unique<CalculatorState>(
       name_, node_ref.index, node_config->calculator(), *node_config,
       profiling_context_);
+  // Options unpacked by GetContract() are not unpacked again for Open().
+  calculator_state_->ShareOptions(node_type_info_->Contract().options_);
+  if (node_ref.type == NodeTypeInfo::NodeType::CALCULATOR) {
+    shared_resources_key_ =
+        SharedResourcesKey(*node_config, node_type_info_->Contract());
+  }
 
   // Inform the scheduler that this node has buffering behavior and that the
   // maximum input queue size should be adjusted accordingly.
@@ -403,6 +488,15 @@ absl::Status CalculatorNode::PrepareForRun(
   calculator_state_->SetOutputSidePackets(output_side_packets_.get());
   calculator_state_->SetCounterFactory(counter_factory);
 
+  shared_resources_ = nullptr;
+  if (!shared_resources_key_.empty()) {
+    auto it = service_packets.find(kSharedGraphResourcesService.key);
+    if (it != service_packets.end()) {
+      shared_resources_ =
+          it->second.Get<std::shared_ptr<SharedGraphResources>>();
+    }
+  }
+
   for (const auto& svc_req : contract.ServiceRequests()) {
     const auto& req = svc_req.second;
     auto it = service_packets.find(req.Service().key);
@@ -435,7 +529,8 @@ absl::Status CalculatorNode::PrepareForRun(
     input_stream_headers_ready_called_ = false;
     input_side_packets_ready_called_ = false;
     input_stream_headers_ready_ =
-        (input_stream_handler_->UnsetHeaderCount() == 0);
+        (input_stream_handler_->UnsetHeaderCount() == 0) ||
+        !contract.GetInputStreamHeadersNeeded();
     input_side_packets_ready_ =
         (input_side_packet_handler_.MissingInputSidePacketCount() == 0);
   }
@@ -474,6 +569,50 @@ bool CalculatorNode::OutputsAreConstant(CalculatorContext* cc) {
   return true;
 }
 
+absl::Status CalculatorNode::OpenCalculator(CalculatorContext* cc) {
+  MEDIAPIPE_PROFILING(OPEN, cc);
+  LegacyCalculatorSupport::Scoped<CalculatorContext> s(cc);
+  return calculator_->Open(cc);
+}
+
+absl::Status CalculatorNode::OpenWithSharedResources(CalculatorContext* cc) {
+  std::string key = shared_resources_key_;
+  // Input side packets that are only identified by their data id are kept
+  // alive in the cache, so that the id is not reused by another packet.
+  std::vector<Packet> keep_alive;
+  const PacketSet& inputs = cc->InputSidePackets();
+  for (CollectionItemId id = inputs.BeginId(); id < inputs.EndId(); ++id) {
+    if (!AppendSidePacketKey(inputs.Get(id), &key)) {
+      keep_alive.push_back(inputs.Get(id));
+    }
+  }
+  auto& outputs = cc->OutputSidePackets();
+  bool opened = false;
+  ASSIGN_OR_RETURN(
+      std::vector<Packet> packets,
+      shared_resources_->GetOrCreate(
+          key, [&]() -> absl::StatusOr<std::vector<Packet>> {
+            MP_RETURN_IF_ERROR(OpenCalculator(cc));
+            opened = true;
+            std::vector<Packet> packets;
+            for (CollectionItemId id = outputs.BeginId(); id < outputs.EndId();
+                 ++id) {
+              packets.push_back(GetPacket(outputs.Get(id)));
+            }
+            packets.insert(packets.end(), keep_alive.begin(),
+                           keep_alive.end());
+            return packets;
+          }));
+  if (opened) return absl::OkStatus();
+  for (CollectionItemId id = outputs.BeginId(); id < outputs.EndId(); ++id) {
+    const Packet& packet = packets[id.value()];
+    if (!packet.IsEmpty()) {
+      outputs.Get(id).Set(packet);
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status CalculatorNode::OpenNode() {
   VLOG(2) << "CalculatorNode::OpenNode() for " << DebugName();
 
@@ -492,10 +631,10 @@ absl::Status CalculatorNode::OpenNode() {
   absl::Status result;
   if (OutputsAreConstant(default_context)) {
     result = ResendSidePackets(default_context);
+  } else if (shared_resources_) {
+    result = OpenWithSharedResources(default_context);
   } else {
-    MEDIAPIPE_PROFILING(OPEN, default_context);
-    LegacyCalculatorSupport::Scoped<CalculatorContext> s(default_context);
-    result = calculator_->Open(default_context);
+    result = OpenCalculator(default_context);
   }
 
   calculator_context_manager_.PopInputTimestampFromContext(default_context);
@@ -694,9 +833,11 @@ void CalculatorNode::InputStreamHeadersReady() {
   bool ready_for_open = false;
   {
     absl::MutexLock lock(&status_mutex_);
-    CHECK_EQ(status_, kStatePrepared) << DebugName();
     CHECK(!input_stream_headers_ready_called_);
     input_stream_headers_ready_called_ = true;
+    // The node may already be opened if it doesn't need the headers.
+    if (input_stream_headers_ready_) return;
+    CHECK_EQ(status_, kStatePrepared) << DebugName();
     input_stream_headers_ready_ = true;
     ready_for_open = input_side_packets_ready_;
   }
@@ -814,7 +955,12 @@ absl::Status CalculatorNode::ProcessNode(
     {
       MEDIAPIPE_PROFILING(PROCESS, calculator_context);
       LegacyCalculatorSupport::Scoped<CalculatorContext> s(calculator_context);
+      const char* node_name = calculator_state_->NodeName().c_str();
+      MEDIAPIPE_TRACEPOINT_BEGIN(node_started, node_name, Id(),
+                                 input_timestamp.Value());
       result = calculator_->Process(calculator_context);
+      MEDIAPIPE_TRACEPOINT_END(node_finished, node_name, Id(),
+                               input_timestamp.Value());
     }
 
     bool node_stopped = false;
@@ -864,30 +1010,26 @@ absl::Status CalculatorNode::ProcessNode(
           MEDIAPIPE_PROFILING(PROCESS, calculator_context);
           LegacyCalculatorSupport::Scoped<CalculatorContext> s(
               calculator_context);
+          const char* node_name = calculator_state_->NodeName().c_str();
+          MEDIAPIPE_TRACEPOINT_BEGIN(node_started, node_name, Id(),
+                                     input_timestamp.Value());
           result = calculator_->Process(calculator_context);
+          MEDIAPIPE_TRACEPOINT_END(node_finished, node_name, Id(),
+                                   input_timestamp.Value());
         }
 
         VLOG(2) << "Called Calculator::Process() for node: " << DebugName()
                 << " timestamp: " << input_timestamp;
 
-        // Removes one packet from each shard and progresses to the next input
-        // timestamp.
-        input_stream_handler_->ClearCurrentInputs(calculator_context);
-
-        // Nodes are allowed to return StatusStop() to cause the termination
-        // of the graph. This is different from an error in that it will
-        // ensure that all sources will be closed and that packets in input
-        // streams will be processed before the graph is terminated.
-        if (!result.ok() && result != tool::StatusStop()) {
-          return mediapipe::StatusBuilder(result, MEDIAPIPE_LOC).SetPrepend()
-                 << absl::Substitute(
-                        "Calculator::Process() for node \"$0\" failed: ",
-                        DebugName());
-        }
-        output_stream_handler_->PostProcess(input_timestamp);
-        if (result == tool::StatusStop()) {
-          return result;
+        if (calculator_context->IsProcessDeferred()) {
+          if (result.ok()) {
+            return absl::OkStatus();
+          }
+          // The deferral is dropped, and so is the later completion.
+          calculator_context->TakeDeferredStatus();
         }
+        MP_RETURN_IF_ERROR(
+            EndProcess(calculator_context, input_timestamp, result));
       } else if (input_timestamp == Timestamp::Done()) {
         // Some or all the input streams are closed and there are not enough
         // open input streams for Process(). So this node needs to be closed
@@ -907,6 +1049,35 @@ absl::Status CalculatorNode::ProcessNode(
   }
 }
 
+absl::Status CalculatorNode::CompleteDeferredProcess(
+    CalculatorContext* calculator_context, const absl::Status& result) {
+  VLOG(2) << "Completing Calculator::Process() for node: " << DebugName()
+          << " timestamp: " << calculator_context->InputTimestamp();
+  return EndProcess(calculator_context, calculator_context->InputTimestamp(),
+                    result);
+}
+
+absl::Status CalculatorNode::EndProcess(CalculatorContext* cc,
+                                        Timestamp input_timestamp,
+                                        const absl::Status& result) {
+  // Removes one packet from each shard and progresses to the next input
+  // timestamp.
+  input_stream_handler_->ClearCurrentInputs(cc);
+
+  // Nodes are allowed to return StatusStop() to cause the termination
+  // of the graph. This is different from an error in that it will
+  // ensure that all sources will be closed and that packets in input
+  // streams will be processed before the graph is terminated.
+  if (!result.ok() && result != tool::StatusStop()) {
+    return mediapipe::StatusBuilder(result, MEDIAPIPE_LOC).SetPrepend()
+           << absl::Substitute(
+                  "Calculator::Process() for node \"$0\" failed: ",
+                  DebugName());
+  }
+  output_stream_handler_->PostProcess(input_timestamp);
+  return result;
+}
+
 void CalculatorNode::SetQueueSizeCallbacks(
     InputStreamManager::QueueSizeCallback becomes_full_callback,
     InputStreamManager::QueueSizeCallback becomes_not_full_callback) {
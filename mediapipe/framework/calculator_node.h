@@ -20,12 +20,14 @@
 
 #include <stddef.h>
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/synchronization/mutex.h"
@@ -45,6 +47,7 @@
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/shared_graph_resources.h"
 #include "mediapipe/framework/stream_handler.pb.h"
 #include "mediapipe/framework/timestamp.h"
 #include "mediapipe/framework/tool/validate_name.h"
@@ -95,9 +98,17 @@ class CalculatorNode {
   // Changes the executor a node is assigned to.
   void SetExecutor(const std::string& executor);
 
-  // Calls Process() on the Calculator corresponding to this node.
+  // Calls Process() on the Calculator corresponding to this node. If Process()
+  // deferred its completion, returns OK without clearing the inputs or sending
+  // the outputs, which CompleteDeferredProcess() does later.
   absl::Status ProcessNode(CalculatorContext* calculator_context);
 
+  // Completes a Process() call deferred with
+  // CalculatorContext::DeferProcessCompletion(), whose callback was called
+  // with `result`.
+  absl::Status CompleteDeferredProcess(CalculatorContext* calculator_context,
+                                       const absl::Status& result);
+
   // Initializes the node.  The buffer_size_hint argument is
   // set to the value specified in the graph proto for this field.
   // input_stream_managers/output_stream_managers is expected to point to
@@ -162,6 +173,32 @@ class CalculatorNode {
 
   int source_layer() const { return source_layer_; }
 
+  // The scheduling priority from CalculatorGraphConfig::Node::priority.
+  int priority() const { return priority_; }
+
+  // Whether the calculator declared that it can run in the task of the node
+  // that made it ready. See CalculatorContract::SetInlineSafe.
+  bool IsInlineSafe() const { return inline_safe_; }
+
+  // Sets the calculator nodes that consume the output streams of this node,
+  // for the critical path estimate. Must be called before the graph starts.
+  void SetDownstreamNodes(std::vector<const CalculatorNode*> nodes) {
+    downstream_nodes_ = std::move(nodes);
+  }
+
+  // Records the duration of a Process() call, in microseconds, and updates
+  // the critical path estimate. This method is thread-safe.
+  void RecordProcessRuntime(int64 runtime_usec);
+
+  // Returns the estimated time, in microseconds, from the start of a
+  // Process() call on this node until the packets it emits have been
+  // processed by the leaves of the graph: this node's average Process()
+  // runtime plus the longest critical path among the downstream nodes.
+  // This method is thread-safe.
+  int64 critical_path_usec() const {
+    return critical_path_usec_.load(std::memory_order_relaxed);
+  }
+
   // Checks if the node can be scheduled; if so, increases current_in_flight_
   // and returns true; otherwise, returns false.
   // If true is returned, the scheduler must commit to executing the node, and
@@ -286,17 +323,44 @@ class CalculatorNode {
   // Returns true if all outputs will be identical to the previous graph run.
   bool OutputsAreConstant(CalculatorContext* cc);
 
+  // Clears the inputs of a Process() call which returned `result`, and sends
+  // its outputs unless it failed.
+  absl::Status EndProcess(CalculatorContext* cc, Timestamp input_timestamp,
+                          const absl::Status& result);
+
+  // Calls Calculator::Open().
+  absl::Status OpenCalculator(CalculatorContext* cc);
+  // Takes the output side packets from shared_resources_, or calls
+  // Calculator::Open() and caches them there.
+  absl::Status OpenWithSharedResources(CalculatorContext* cc);
+
   // The calculator.
   std::unique_ptr<CalculatorBase> calculator_;
   // Keeps data which a Calculator subclass needs access to.
   std::unique_ptr<CalculatorState> calculator_state_;
 
+  // Identifies the node config among those whose output side packets can be
+  // shared across graphs, or is empty if the node's can't be.
+  std::string shared_resources_key_;
+  // Caches the output side packets of the node, if the graph has a
+  // SharedGraphResources and the node's can be shared.
+  std::shared_ptr<SharedGraphResources> shared_resources_;
+
   std::string name_;  // Optional user-defined name
   // Name of the executor which the node will execute on. If empty, the node
   // will execute on the default executor.
   std::string executor_;
   // The layer a source calculator operates on.
   int source_layer_ = 0;
+  // The scheduling priority of the node.
+  int priority_ = 0;
+  bool inline_safe_ = false;
+  // The nodes reading the output streams of this node.
+  std::vector<const CalculatorNode*> downstream_nodes_;
+  // The moving average of the Process() runtime, in microseconds.
+  std::atomic<int64> runtime_estimate_usec_{0};
+  // See critical_path_usec().
+  std::atomic<int64> critical_path_usec_{0};
   // The status of the current Calculator that this CalculatorNode
   // is wrapping.  kStateActive is currently used only for source nodes.
   enum NodeStatus {
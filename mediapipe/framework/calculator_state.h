@@ -66,6 +66,12 @@ class CalculatorState {
   const T& Options() const {
     return options_.Get<T>();
   }
+  // Reuses the options messages already unpacked from the same node config,
+  // e.g. by the CalculatorContract during graph validation.
+  void ShareOptions(const tool::OptionsMap& options) {
+    options_ = options;
+    options_.Initialize(node_config_);
+  }
   const std::string& NodeName() const { return node_name_; }
   const int& NodeId() const { return node_id_; }
 
@@ -16,6 +16,7 @@
 #define MEDIAPIPE_DEPS_REGISTRATION_H_
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <string>
 #include <tuple>
@@ -23,7 +24,9 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
+#include "absl/base/const_init.h"
 #include "absl/base/macros.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
@@ -33,6 +36,7 @@
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/deps/registration_token.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
@@ -320,6 +324,32 @@ class GlobalFactoryRegistry {
   using Functions = FunctionRegistry<R, Args...>;
 
  public:
+  // A registration made by a static initializer. Constructing it only links
+  // it into a list of pending registrations, without locking or allocating,
+  // so that the registrations linked into a binary add no work before main.
+  // The pending registrations are added to the registry on its next use.
+  // Static registrations are never unregistered.
+  class StaticRegistration {
+   public:
+    template <typename F>
+    StaticRegistration(const char* name, F&& func)
+        : name_(name), func_(std::forward<F>(func)) {
+      next_ = registrations_.load(std::memory_order_relaxed);
+      while (!registrations_.compare_exchange_weak(
+          next_, this, std::memory_order_release, std::memory_order_relaxed)) {
+      }
+    }
+    StaticRegistration(const StaticRegistration&) = delete;
+    StaticRegistration& operator=(const StaticRegistration&) = delete;
+
+   private:
+    friend class GlobalFactoryRegistry;
+
+    const char* name_;
+    typename Functions::Function func_;
+    StaticRegistration* next_ = nullptr;
+  };
+
   static RegistrationToken Register(absl::string_view name,
                                     typename Functions::Function func) {
     return functions()->Register(name, std::move(func));
@@ -366,11 +396,39 @@ class GlobalFactoryRegistry {
   // Returns the factory function registry singleton.
   static Functions* functions() {
     static auto* functions = new Functions();
+    RegisterPending(functions);
     return functions;
   }
 
  private:
   GlobalFactoryRegistry() = delete;
+
+  // Adds the static registrations not yet in `functions`, in the order they
+  // were made. A duplicate name is fatal here, as it is in Register.
+  static void RegisterPending(Functions* functions) {
+    if (registrations_.load(std::memory_order_acquire) ==
+        registered_.load(std::memory_order_acquire)) {
+      return;
+    }
+    absl::MutexLock lock(&pending_mutex_);
+    StaticRegistration* last = registrations_.load(std::memory_order_acquire);
+    std::vector<StaticRegistration*> pending;
+    for (StaticRegistration* r = last;
+         r != registered_.load(std::memory_order_relaxed); r = r->next_) {
+      pending.push_back(r);
+    }
+    for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+      functions->Register((*it)->name_, std::move((*it)->func_));
+    }
+    registered_.store(last, std::memory_order_release);
+  }
+
+  // The static registrations, most recent first, and the most recent one
+  // added to the registry. Both are constant-initialized, so that they can be
+  // used by any static initializer.
+  static inline std::atomic<StaticRegistration*> registrations_{nullptr};
+  static inline std::atomic<StaticRegistration*> registered_{nullptr};
+  static inline absl::Mutex pending_mutex_{absl::kConstInit};
 };
 
 // Two levels of macros are required to convert __LINE__ into a string
@@ -379,15 +437,15 @@ class GlobalFactoryRegistry {
 #define REGISTRY_STATIC_VAR(var_name, line) \
   REGISTRY_STATIC_VAR_INNER(var_name, line)
 
+// Registrations made with these macros are only recorded at static
+// initialization, and added to the registry on its first use.
 #define MEDIAPIPE_REGISTER_FACTORY_FUNCTION(RegistryType, name, ...) \
-  static auto* REGISTRY_STATIC_VAR(registration_##name, __LINE__) =  \
-      new mediapipe::RegistrationToken(                              \
-          RegistryType::Register(#name, __VA_ARGS__))
+  static mediapipe::NoDestructor<RegistryType::StaticRegistration>   \
+  REGISTRY_STATIC_VAR(registration_##name, __LINE__)(#name, __VA_ARGS__)
 
 #define REGISTER_FACTORY_FUNCTION_QUALIFIED(RegistryType, var_name, name, ...) \
-  static auto* REGISTRY_STATIC_VAR(var_name, __LINE__) =                       \
-      new mediapipe::RegistrationToken(                                        \
-          RegistryType::Register(#name, __VA_ARGS__))
+  static mediapipe::NoDestructor<RegistryType::StaticRegistration>             \
+  REGISTRY_STATIC_VAR(var_name, __LINE__)(#name, __VA_ARGS__)
 
 }  // namespace mediapipe
 
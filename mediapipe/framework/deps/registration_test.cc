@@ -0,0 +1,119 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/registration.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Every test uses a registry of its own, told apart by the argument type, so
+// that the tests see the registry before and after its first lookup.
+template <int kId>
+struct Tag {};
+
+template <int kId>
+using TestRegistry = GlobalFactoryRegistry<int, Tag<kId>>;
+
+using OrderRegistry = TestRegistry<0>;
+using LateRegistry = TestRegistry<1>;
+using DuplicateRegistry = TestRegistry<2>;
+using ConcurrentRegistry = TestRegistry<3>;
+
+// The unqualified "Foo" must be registered first: registering
+// "::mediapipe::Foo" also makes it available as "Foo", unless that name is
+// taken, and registering "Foo" after it would then be a duplicate.
+REGISTER_FACTORY_FUNCTION_QUALIFIED(OrderRegistry, order_registration, Foo,
+                                    [](Tag<0>) { return 1; });
+REGISTER_FACTORY_FUNCTION_QUALIFIED(OrderRegistry, order_registration,
+                                    ::mediapipe::Foo,
+                                    [](Tag<0>) { return 2; });
+
+REGISTER_FACTORY_FUNCTION_QUALIFIED(LateRegistry, late_registration, Early,
+                                    [](Tag<1>) { return 1; });
+
+REGISTER_FACTORY_FUNCTION_QUALIFIED(DuplicateRegistry, duplicate_registration,
+                                    Duplicate, [](Tag<2>) { return 1; });
+REGISTER_FACTORY_FUNCTION_QUALIFIED(DuplicateRegistry, duplicate_registration,
+                                    Duplicate, [](Tag<2>) { return 2; });
+
+REGISTER_FACTORY_FUNCTION_QUALIFIED(ConcurrentRegistry,
+                                    concurrent_registration, Concurrent,
+                                    [](Tag<3>) { return 1; });
+
+TEST(RegistrationTest, AddsStaticRegistrationsInOrder) {
+  MP_ASSERT_OK_AND_ASSIGN(int foo,
+                          OrderRegistry::CreateByName("Foo", Tag<0>()));
+  EXPECT_EQ(foo, 1);
+  MP_ASSERT_OK_AND_ASSIGN(
+      int qualified_foo,
+      OrderRegistry::CreateByName("mediapipe::Foo", Tag<0>()));
+  EXPECT_EQ(qualified_foo, 2);
+}
+
+TEST(RegistrationTest, AddsStaticRegistrationsAfterFirstLookup) {
+  EXPECT_TRUE(LateRegistry::IsRegistered("Early"));
+  EXPECT_FALSE(LateRegistry::IsRegistered("Late"));
+
+  // Like the registrations of a library loaded after the first lookup.
+  static NoDestructor<LateRegistry::StaticRegistration> late_registration(
+      "Late", [](Tag<1>) { return 2; });
+  EXPECT_TRUE(LateRegistry::IsRegistered("Early"));
+  ASSERT_TRUE(LateRegistry::IsRegistered("Late"));
+  MP_ASSERT_OK_AND_ASSIGN(int late,
+                          LateRegistry::CreateByName("Late", Tag<1>()));
+  EXPECT_EQ(late, 2);
+  EXPECT_THAT(LateRegistry::GetRegisteredNames(),
+              testing::UnorderedElementsAre("Early", "Late"));
+}
+
+TEST(RegistrationTest, StaticRegistrationOfTakenNameAfterLookupIsFatal) {
+  EXPECT_TRUE(LateRegistry::IsRegistered("Early"));
+  EXPECT_DEATH(
+      {
+        static NoDestructor<LateRegistry::StaticRegistration> registration(
+            "Early", [](Tag<1>) { return 3; });
+        LateRegistry::IsRegistered("Early");
+      },
+      "Early already registered");
+}
+
+TEST(RegistrationTest, DuplicateStaticRegistrationIsFatalOnFirstLookup) {
+  EXPECT_DEATH(DuplicateRegistry::IsRegistered("Duplicate"),
+               "Duplicate already registered");
+}
+
+TEST(RegistrationTest, AddsStaticRegistrationsOnceForConcurrentLookups) {
+  std::vector<std::thread> threads;
+  std::vector<int> results(8, 0);
+  for (int i = 0; i < results.size(); ++i) {
+    threads.emplace_back([&results, i]() {
+      auto result = ConcurrentRegistry::CreateByName("Concurrent", Tag<3>());
+      results[i] = result.ok() ? *result : -1;
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_THAT(results, testing::Each(1));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,179 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_RING_BUFFER_QUEUE_H_
+#define MEDIAPIPE_DEPS_RING_BUFFER_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace mediapipe {
+
+// A lock-free FIFO queue with one producer and one consumer, kept in a bounded
+// ring buffer. Push() never blocks and never waits for the consumer. When the
+// ring buffer is full, Push() moves on to a new one of twice the capacity,
+// which replaces the old one once the consumer has emptied it. So the queue
+// is unbounded, but allocates only while it grows past its largest size.
+//
+// There may be different producer threads, and different consumer threads,
+// over time as long as their calls are ordered by some other synchronization,
+// such as a mutex among the producers. Push() must only be called by the
+// producer, and all other methods other than the constructor and destructor
+// only by the consumer. T must be default constructible and move assignable.
+//
+// Items become visible to the consumer in order as soon as each Push()
+// returns.
+template <typename T>
+class RingBufferQueue {
+ public:
+  // "capacity" is the initial capacity of the ring buffer, and must be a
+  // power of two.
+  explicit RingBufferQueue(size_t capacity = 32)
+      : consumer_ring_(new Ring(capacity)), producer_ring_(consumer_ring_) {}
+  RingBufferQueue(const RingBufferQueue&) = delete;
+  RingBufferQueue& operator=(const RingBufferQueue&) = delete;
+
+  ~RingBufferQueue() {
+    while (consumer_ring_ != nullptr) {
+      Ring* next = consumer_ring_->next.load(std::memory_order_acquire);
+      delete consumer_ring_;
+      consumer_ring_ = next;
+    }
+  }
+
+  // Producer only.
+  void Push(T value) {
+    Ring* ring = producer_ring_;
+    const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail - ring->head.load(std::memory_order_acquire) < ring->capacity) {
+      ring->slots[tail & ring->mask] = std::move(value);
+      ring->tail.store(tail + 1, std::memory_order_release);
+      return;
+    }
+    // The consumer empties this ring buffer before it moves on to the next.
+    Ring* next = new Ring(ring->capacity * 2);
+    next->slots[0] = std::move(value);
+    next->tail.store(1, std::memory_order_relaxed);
+    producer_ring_ = next;
+    ring->next.store(next, std::memory_order_release);
+  }
+
+  // Returns the oldest item, or nullptr if the queue appears empty. The item
+  // stays valid until it is popped.
+  T* Front() const {
+    Ring* ring = ConsumerRing();
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    if (head == ring->tail.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &ring->slots[head & ring->mask];
+  }
+
+  // Removes the oldest item and moves it into "value". Returns false if the
+  // queue appears empty.
+  bool Pop(T* value) {
+    T* front = Front();
+    if (front == nullptr) {
+      return false;
+    }
+    *value = std::move(*front);
+    PopFront();
+    return true;
+  }
+
+  // Removes the oldest item. Returns false if the queue appears empty.
+  bool PopFront() {
+    T* front = Front();
+    if (front == nullptr) {
+      return false;
+    }
+    // Releases whatever the item holds before the producer reuses the slot.
+    *front = T();
+    Ring* ring = consumer_ring_;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+    return true;
+  }
+
+  // Calls "fn" on each visible item from oldest to newest.
+  template <typename Fn>
+  void ForEach(Fn fn) const {
+    for (Ring* ring = ConsumerRing(); ring != nullptr;) {
+      // Once the next ring buffer is linked, the tail of this one is final.
+      Ring* next = ring->next.load(std::memory_order_acquire);
+      const uint64_t tail = ring->tail.load(std::memory_order_acquire);
+      for (uint64_t i = ring->head.load(std::memory_order_relaxed); i != tail;
+           ++i) {
+        fn(ring->slots[i & ring->mask]);
+      }
+      ring = next;
+    }
+  }
+
+  // Removes all visible items.
+  void Clear() {
+    while (PopFront()) {
+    }
+  }
+
+ private:
+  struct Ring {
+    explicit Ring(size_t capacity)
+        : capacity(capacity), mask(capacity - 1), slots(new T[capacity]) {}
+
+    const uint64_t capacity;
+    const uint64_t mask;
+    const std::unique_ptr<T[]> slots;
+    // The next ring buffer, set by the producer once this one is full.
+    std::atomic<Ring*> next{nullptr};
+    // Written by the consumer.
+    alignas(64) std::atomic<uint64_t> head{0};
+    // Written by the producer.
+    alignas(64) std::atomic<uint64_t> tail{0};
+  };
+
+  // Returns the ring buffer holding the oldest item, after deleting the ones
+  // the consumer has emptied and the producer has left.
+  Ring* ConsumerRing() const {
+    Ring* ring = consumer_ring_;
+    while (true) {
+      const uint64_t head = ring->head.load(std::memory_order_relaxed);
+      if (head != ring->tail.load(std::memory_order_acquire)) {
+        return ring;
+      }
+      Ring* next = ring->next.load(std::memory_order_acquire);
+      // Items may have been added before the producer moved on.
+      if (next == nullptr ||
+          head != ring->tail.load(std::memory_order_acquire)) {
+        return ring;
+      }
+      delete ring;
+      ring = next;
+      consumer_ring_ = ring;
+    }
+  }
+
+  // Consumer only. Mutable since moving past emptied ring buffers doesn't
+  // change the items in the queue.
+  mutable Ring* consumer_ring_;
+  // Producer only.
+  Ring* producer_ring_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_RING_BUFFER_QUEUE_H_
@@ -0,0 +1,123 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/ring_buffer_queue.h"
+
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(RingBufferQueueTest, IsFifo) {
+  RingBufferQueue<int> queue;
+  EXPECT_EQ(queue.Front(), nullptr);
+  queue.Push(1);
+  queue.Push(2);
+  queue.Push(3);
+  ASSERT_NE(queue.Front(), nullptr);
+  EXPECT_EQ(*queue.Front(), 1);
+  std::vector<int> items;
+  queue.ForEach([&items](int item) { items.push_back(item); });
+  EXPECT_EQ(items, std::vector<int>({1, 2, 3}));
+  int item = 0;
+  EXPECT_TRUE(queue.Pop(&item));
+  EXPECT_EQ(item, 1);
+  EXPECT_TRUE(queue.PopFront());
+  EXPECT_TRUE(queue.Pop(&item));
+  EXPECT_EQ(item, 3);
+  EXPECT_FALSE(queue.Pop(&item));
+}
+
+TEST(RingBufferQueueTest, WrapsAroundAndGrows) {
+  RingBufferQueue<int> queue(/*capacity=*/4);
+  int next_pushed = 0;
+  int next_popped = 0;
+  // Stays within the ring buffer while it wraps around.
+  for (int i = 0; i < 10; ++i) {
+    queue.Push(next_pushed++);
+    queue.Push(next_pushed++);
+    int item = -1;
+    ASSERT_TRUE(queue.Pop(&item));
+    EXPECT_EQ(item, next_popped++);
+  }
+  // Grows past the capacity twice.
+  while (next_pushed < next_popped + 20) {
+    queue.Push(next_pushed++);
+  }
+  std::vector<int> items;
+  queue.ForEach([&items](int item) { items.push_back(item); });
+  ASSERT_EQ(items.size(), 20);
+  for (int i = 0; i < items.size(); ++i) {
+    EXPECT_EQ(items[i], next_popped + i);
+  }
+  int item = -1;
+  while (queue.Pop(&item)) {
+    EXPECT_EQ(item, next_popped++);
+  }
+  EXPECT_EQ(next_popped, next_pushed);
+}
+
+TEST(RingBufferQueueTest, ReleasesPoppedAndRemainingItems) {
+  auto item = std::make_shared<int>(0);
+  {
+    RingBufferQueue<std::shared_ptr<int>> queue(/*capacity=*/2);
+    queue.Push(item);
+    queue.Push(item);
+    queue.Push(item);
+    EXPECT_EQ(item.use_count(), 4);
+    EXPECT_TRUE(queue.PopFront());
+    EXPECT_EQ(item.use_count(), 3);
+  }
+  EXPECT_EQ(item.use_count(), 1);
+}
+
+// Producers take turns under a mutex, as in InputStreamManager.
+TEST(RingBufferQueueTest, KeepsOrderWithConcurrentConsumer) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumItemsPerProducer = 20000;
+  RingBufferQueue<std::pair<int, int>> queue(/*capacity=*/8);
+  absl::Mutex producer_mutex;
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; ++p) {
+    producers.emplace_back([&queue, &producer_mutex, p] {
+      for (int i = 0; i < kNumItemsPerProducer; ++i) {
+        absl::MutexLock lock(&producer_mutex);
+        queue.Push({p, i});
+      }
+    });
+  }
+  std::vector<int> next(kNumProducers, 0);
+  int num_received = 0;
+  while (num_received < kNumProducers * kNumItemsPerProducer) {
+    std::pair<int, int> item;
+    if (queue.Pop(&item)) {
+      ASSERT_EQ(item.second, next[item.first]);
+      ++next[item.first];
+      ++num_received;
+    }
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(queue.Front(), nullptr);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,182 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_WORK_STEALING_DEQUE_H_
+#define MEDIAPIPE_DEPS_WORK_STEALING_DEQUE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace mediapipe {
+
+// A lock-free double-ended queue of pointers with a single owner and any
+// number of thieves (Chase-Lev). The owner thread pushes and pops items at the
+// bottom end in LIFO order, while other threads steal items from the top end
+// in FIFO order.
+//
+// The deque does not take ownership of the items. It grows as needed; retired
+// ring buffers are kept alive until the deque is destroyed because a thief may
+// still be reading from them.
+//
+// Sample usage:
+//
+//   WorkStealingDeque<Task> deque;
+//   // Owner thread:
+//   deque.Push(task);
+//   Task* mine = deque.Pop();
+//   // Any other thread:
+//   Task* stolen = deque.Steal();
+//
+template <typename T>
+class WorkStealingDeque {
+ public:
+  // "initial_capacity" is rounded up to a power of two.
+  explicit WorkStealingDeque(int64_t initial_capacity = 64);
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // Must only be called by the owner thread.
+  void Push(T* item);
+
+  // Must only be called by the owner thread. Returns the most recently pushed
+  // item, or nullptr if the deque is empty.
+  T* Pop();
+
+  // May be called by any thread. Returns the least recently pushed item, or
+  // nullptr if the deque is empty or the steal lost a race with another
+  // thread.
+  T* Steal();
+
+  // Returns true if the deque appeared empty at some point during the call.
+  bool IsEmpty() const {
+    int64_t top = top_.load(std::memory_order_acquire);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    return bottom <= top;
+  }
+
+ private:
+  class RingBuffer {
+   public:
+    explicit RingBuffer(int64_t capacity)
+        : mask_(capacity - 1), slots_(new std::atomic<T*>[capacity]) {}
+
+    int64_t capacity() const { return mask_ + 1; }
+
+    T* Get(int64_t index) const {
+      return slots_[index & mask_].load(std::memory_order_relaxed);
+    }
+
+    void Put(int64_t index, T* item) {
+      slots_[index & mask_].store(item, std::memory_order_relaxed);
+    }
+
+    // Returns a buffer of twice the capacity holding the items in
+    // [top, bottom).
+    std::unique_ptr<RingBuffer> Grow(int64_t top, int64_t bottom) const {
+      auto grown = std::make_unique<RingBuffer>(capacity() * 2);
+      for (int64_t i = top; i < bottom; ++i) {
+        grown->Put(i, Get(i));
+      }
+      return grown;
+    }
+
+   private:
+    const int64_t mask_;
+    std::unique_ptr<std::atomic<T*>[]> slots_;
+  };
+
+  // Keep the indices on separate cache lines, since the owner writes bottom_
+  // and thieves write top_.
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  alignas(64) std::atomic<RingBuffer*> buffer_;
+
+  // All buffers ever allocated, including the current one. Only touched by the
+  // owner thread.
+  std::vector<std::unique_ptr<RingBuffer>> buffers_;
+};
+
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(int64_t initial_capacity) {
+  int64_t capacity = 1;
+  while (capacity < initial_capacity) {
+    capacity <<= 1;
+  }
+  buffers_.push_back(std::make_unique<RingBuffer>(capacity));
+  buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T>
+void WorkStealingDeque<T>::Push(T* item) {
+  int64_t bottom = bottom_.load(std::memory_order_relaxed);
+  int64_t top = top_.load(std::memory_order_acquire);
+  RingBuffer* buffer = buffer_.load(std::memory_order_relaxed);
+  if (bottom - top > buffer->capacity() - 1) {
+    buffers_.push_back(buffer->Grow(top, bottom));
+    buffer = buffers_.back().get();
+    buffer_.store(buffer, std::memory_order_release);
+  }
+  buffer->Put(bottom, item);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(bottom + 1, std::memory_order_relaxed);
+}
+
+template <typename T>
+T* WorkStealingDeque<T>::Pop() {
+  int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+  RingBuffer* buffer = buffer_.load(std::memory_order_relaxed);
+  bottom_.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = top_.load(std::memory_order_relaxed);
+  if (top > bottom) {
+    // Empty.
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  T* item = buffer->Get(bottom);
+  if (top == bottom) {
+    // Last item: race against thieves for it.
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      item = nullptr;
+    }
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return item;
+}
+
+template <typename T>
+T* WorkStealingDeque<T>::Steal() {
+  int64_t top = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t bottom = bottom_.load(std::memory_order_acquire);
+  if (top >= bottom) {
+    return nullptr;
+  }
+  RingBuffer* buffer = buffer_.load(std::memory_order_acquire);
+  T* item = buffer->Get(top);
+  if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return item;
+}
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_WORK_STEALING_DEQUE_H_
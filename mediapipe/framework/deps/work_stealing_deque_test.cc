@@ -0,0 +1,97 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/work_stealing_deque.h"
+
+#include <atomic>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(WorkStealingDequeTest, PopIsLifoAndStealIsFifo) {
+  std::vector<int> items = {0, 1, 2, 3};
+  WorkStealingDeque<int> deque;
+  EXPECT_TRUE(deque.IsEmpty());
+  EXPECT_EQ(deque.Pop(), nullptr);
+  EXPECT_EQ(deque.Steal(), nullptr);
+  for (int& item : items) {
+    deque.Push(&item);
+  }
+  EXPECT_FALSE(deque.IsEmpty());
+  EXPECT_EQ(deque.Pop(), &items[3]);
+  EXPECT_EQ(deque.Steal(), &items[0]);
+  EXPECT_EQ(deque.Pop(), &items[2]);
+  EXPECT_EQ(deque.Steal(), &items[1]);
+  EXPECT_EQ(deque.Pop(), nullptr);
+  EXPECT_TRUE(deque.IsEmpty());
+}
+
+TEST(WorkStealingDequeTest, GrowsBeyondInitialCapacity) {
+  std::vector<int> items(100);
+  WorkStealingDeque<int> deque(/*initial_capacity=*/4);
+  for (int& item : items) {
+    deque.Push(&item);
+  }
+  EXPECT_EQ(deque.Steal(), &items[0]);
+  for (int i = items.size() - 1; i >= 1; --i) {
+    EXPECT_EQ(deque.Pop(), &items[i]);
+  }
+  EXPECT_EQ(deque.Pop(), nullptr);
+}
+
+TEST(WorkStealingDequeTest, EachItemIsTakenExactlyOnce) {
+  constexpr int kNumItems = 100000;
+  constexpr int kNumThieves = 4;
+  std::vector<int> items(kNumItems, 0);
+  std::vector<std::atomic<int>> taken(kNumItems);
+  WorkStealingDeque<int> deque(/*initial_capacity=*/16);
+  std::atomic<bool> done(false);
+
+  auto take = [&](int* item) { taken[item - items.data()].fetch_add(1); };
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < kNumThieves; ++i) {
+    thieves.emplace_back([&] {
+      while (!done.load() || !deque.IsEmpty()) {
+        if (int* item = deque.Steal()) {
+          take(item);
+        }
+      }
+    });
+  }
+  for (int i = 0; i < kNumItems; ++i) {
+    deque.Push(&items[i]);
+    if (i % 3 == 0) {
+      if (int* item = deque.Pop()) {
+        take(item);
+      }
+    }
+  }
+  while (int* item = deque.Pop()) {
+    take(item);
+  }
+  done.store(true);
+  for (auto& thief : thieves) {
+    thief.join();
+  }
+  for (int i = 0; i < kNumItems; ++i) {
+    EXPECT_EQ(taken[i].load(), 1) << "item " << i;
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
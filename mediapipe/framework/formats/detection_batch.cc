@@ -0,0 +1,118 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/detection_batch.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/location_data.pb.h"
+
+namespace mediapipe {
+
+void DetectionBatch::Resize(int size, int num_keypoints) {
+  this->num_keypoints = num_keypoints;
+  for (auto* values : {&xmin, &ymin, &width, &height, &score}) {
+    values->resize(size);
+  }
+  label_id.resize(size);
+  keypoint_x.resize(size * num_keypoints);
+  keypoint_y.resize(size * num_keypoints);
+}
+
+void DetectionBatch::Append(const DetectionBatch& other, int index) {
+  xmin.push_back(other.xmin[index]);
+  ymin.push_back(other.ymin[index]);
+  width.push_back(other.width[index]);
+  height.push_back(other.height[index]);
+  score.push_back(other.score[index]);
+  label_id.push_back(other.label_id[index]);
+  const int offset = index * num_keypoints;
+  keypoint_x.insert(keypoint_x.end(), other.keypoint_x.begin() + offset,
+                    other.keypoint_x.begin() + offset + num_keypoints);
+  keypoint_y.insert(keypoint_y.end(), other.keypoint_y.begin() + offset,
+                    other.keypoint_y.begin() + offset + num_keypoints);
+}
+
+absl::StatusOr<DetectionBatch> PackDetections(
+    const std::vector<Detection>& detections) {
+  const int size = detections.size();
+  const int num_keypoints =
+      size > 0 ? detections[0].location_data().relative_keypoints_size() : 0;
+  DetectionBatch packed;
+  packed.Resize(size, num_keypoints);
+  for (int i = 0; i < size; ++i) {
+    const Detection& detection = detections[i];
+    const LocationData& location_data = detection.location_data();
+    if (location_data.format() != LocationData::RELATIVE_BOUNDING_BOX) {
+      return absl::InvalidArgumentError(
+          "Only detections with relative bounding boxes can be packed.");
+    }
+    if (location_data.relative_keypoints_size() != num_keypoints) {
+      return absl::InvalidArgumentError(
+          "Packed detections must have the same number of keypoints.");
+    }
+    if (detection.score_size() == 0) {
+      return absl::InvalidArgumentError("Packed detections must have a score.");
+    }
+    const auto& box = location_data.relative_bounding_box();
+    packed.xmin[i] = box.xmin();
+    packed.ymin[i] = box.ymin();
+    packed.width[i] = box.width();
+    packed.height[i] = box.height();
+    const int top_index =
+        std::max_element(detection.score().begin(), detection.score().end()) -
+        detection.score().begin();
+    packed.score[i] = detection.score(top_index);
+    packed.label_id[i] = top_index < detection.label_id_size()
+                             ? detection.label_id(top_index)
+                             : -1;
+    for (int k = 0; k < num_keypoints; ++k) {
+      packed.keypoint_x[i * num_keypoints + k] =
+          location_data.relative_keypoints(k).x();
+      packed.keypoint_y[i * num_keypoints + k] =
+          location_data.relative_keypoints(k).y();
+    }
+  }
+  return packed;
+}
+
+std::vector<Detection> UnpackDetections(const DetectionBatch& detections) {
+  std::vector<Detection> unpacked(detections.size());
+  for (int i = 0; i < detections.size(); ++i) {
+    Detection& detection = unpacked[i];
+    detection.add_score(detections.score[i]);
+    if (detections.label_id[i] >= 0) {
+      detection.add_label_id(detections.label_id[i]);
+    }
+    LocationData* location_data = detection.mutable_location_data();
+    location_data->set_format(LocationData::RELATIVE_BOUNDING_BOX);
+    auto* box = location_data->mutable_relative_bounding_box();
+    box->set_xmin(detections.xmin[i]);
+    box->set_ymin(detections.ymin[i]);
+    box->set_width(detections.width[i]);
+    box->set_height(detections.height[i]);
+    for (int k = 0; k < detections.num_keypoints; ++k) {
+      auto* keypoint = location_data->add_relative_keypoints();
+      keypoint->set_x(detections.keypoint_x[i * detections.num_keypoints + k]);
+      keypoint->set_y(detections.keypoint_y[i * detections.num_keypoints + k]);
+    }
+  }
+  return unpacked;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,78 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_DETECTION_BATCH_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_DETECTION_BATCH_H_
+
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+
+namespace mediapipe {
+
+// Detections with relative bounding boxes in structure-of-arrays layout, with
+// one contiguous array per attribute.
+//
+// A std::vector<Detection> allocates a LocationData and a keypoint message per
+// detection, and every calculator that adjusts the detections copies all of
+// them. Calculators on hot paths can instead update a batch with simple loops
+// over the arrays, which compilers vectorize, and pass it on without
+// per-detection allocations. Convert to and from std::vector<Detection> at the
+// edges of the graph with UnpackDetections and PackDetections.
+//
+// Each detection has a single score and label id, as after non-maximum
+// suppression. String labels and the other Detection fields are not kept.
+struct DetectionBatch {
+  // Relative bounding boxes of the detections. All of them have size()
+  // elements.
+  std::vector<float> xmin;
+  std::vector<float> ymin;
+  std::vector<float> width;
+  std::vector<float> height;
+  // Score and label id of the detections, of size() elements. Label ids are
+  // -1 for detections without one.
+  std::vector<float> score;
+  std::vector<int> label_id;
+  // Relative keypoints, `num_keypoints` per detection, of size() *
+  // num_keypoints elements. The keypoints of detection i are at
+  // [i * num_keypoints, (i + 1) * num_keypoints).
+  int num_keypoints = 0;
+  std::vector<float> keypoint_x;
+  std::vector<float> keypoint_y;
+
+  int size() const { return xmin.size(); }
+  bool empty() const { return xmin.empty(); }
+
+  // Resizes the arrays to @size detections with @num_keypoints keypoints
+  // each.
+  void Resize(int size, int num_keypoints);
+
+  // Appends detection @index of @other, which must have the same number of
+  // keypoints.
+  void Append(const DetectionBatch& other, int index);
+};
+
+// Packs @detections, which must have relative bounding boxes and the same
+// number of relative keypoints. The maximum score of each detection is packed
+// with its label id.
+absl::StatusOr<DetectionBatch> PackDetections(
+    const std::vector<Detection>& detections);
+
+// Unpacks @detections into detections with relative bounding boxes.
+std::vector<Detection> UnpackDetections(const DetectionBatch& detections);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_DETECTION_BATCH_H_
@@ -0,0 +1,128 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/detection_batch.h"
+
+#include <vector>
+
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(DetectionBatchTest, PacksAndUnpacksDetections) {
+  const std::vector<Detection> detections = {
+      ParseTextProtoOrDie<Detection>(R"pb(
+        label_id: 3
+        score: 0.9
+        location_data {
+          format: RELATIVE_BOUNDING_BOX
+          relative_bounding_box { xmin: 0.1 ymin: 0.2 width: 0.3 height: 0.4 }
+          relative_keypoints { x: 0.15 y: 0.25 }
+          relative_keypoints { x: 0.35 y: 0.45 }
+        }
+      )pb"),
+      ParseTextProtoOrDie<Detection>(R"pb(
+        label_id: 1
+        score: 0.5
+        location_data {
+          format: RELATIVE_BOUNDING_BOX
+          relative_bounding_box { xmin: 0.5 ymin: 0.6 width: 0.2 height: 0.1 }
+          relative_keypoints { x: 0.55 y: 0.65 }
+          relative_keypoints { x: 0.6 y: 0.7 }
+        }
+      )pb")};
+
+  MP_ASSERT_OK_AND_ASSIGN(const DetectionBatch packed,
+                          PackDetections(detections));
+
+  EXPECT_EQ(packed.size(), 2);
+  EXPECT_EQ(packed.num_keypoints, 2);
+  EXPECT_THAT(packed.xmin, ElementsAre(0.1f, 0.5f));
+  EXPECT_THAT(packed.ymin, ElementsAre(0.2f, 0.6f));
+  EXPECT_THAT(packed.width, ElementsAre(0.3f, 0.2f));
+  EXPECT_THAT(packed.height, ElementsAre(0.4f, 0.1f));
+  EXPECT_THAT(packed.score, ElementsAre(0.9f, 0.5f));
+  EXPECT_THAT(packed.label_id, ElementsAre(3, 1));
+  EXPECT_THAT(packed.keypoint_x, ElementsAre(0.15f, 0.35f, 0.55f, 0.6f));
+  EXPECT_THAT(packed.keypoint_y, ElementsAre(0.25f, 0.45f, 0.65f, 0.7f));
+
+  const std::vector<Detection> unpacked = UnpackDetections(packed);
+  ASSERT_EQ(unpacked.size(), detections.size());
+  for (int i = 0; i < detections.size(); ++i) {
+    EXPECT_EQ(unpacked[i].SerializeAsString(),
+              detections[i].SerializeAsString());
+  }
+}
+
+TEST(DetectionBatchTest, PacksMaxScoringLabel) {
+  const std::vector<Detection> detections = {
+      ParseTextProtoOrDie<Detection>(R"pb(
+        label_id: 3
+        label_id: 7
+        score: 0.2
+        score: 0.8
+        location_data {
+          format: RELATIVE_BOUNDING_BOX
+          relative_bounding_box { xmin: 0.1 ymin: 0.2 width: 0.3 height: 0.4 }
+        }
+      )pb")};
+
+  MP_ASSERT_OK_AND_ASSIGN(const DetectionBatch packed,
+                          PackDetections(detections));
+
+  EXPECT_THAT(packed.score, ElementsAre(0.8f));
+  EXPECT_THAT(packed.label_id, ElementsAre(7));
+}
+
+TEST(DetectionBatchTest, AppendsDetections) {
+  DetectionBatch batch;
+  batch.Resize(2, /*num_keypoints=*/1);
+  batch.xmin = {0.1f, 0.2f};
+  batch.score = {0.5f, 0.6f};
+  batch.label_id = {4, 5};
+  batch.keypoint_x = {0.3f, 0.4f};
+
+  DetectionBatch appended;
+  appended.num_keypoints = 1;
+  appended.Append(batch, 1);
+
+  EXPECT_EQ(appended.size(), 1);
+  EXPECT_THAT(appended.xmin, ElementsAre(0.2f));
+  EXPECT_THAT(appended.score, ElementsAre(0.6f));
+  EXPECT_THAT(appended.label_id, ElementsAre(5));
+  EXPECT_THAT(appended.keypoint_x, ElementsAre(0.4f));
+}
+
+TEST(DetectionBatchTest, RejectsAbsoluteBoundingBoxes) {
+  const std::vector<Detection> detections = {
+      ParseTextProtoOrDie<Detection>(R"pb(
+        score: 0.9
+        location_data {
+          format: BOUNDING_BOX
+          bounding_box { xmin: 1 ymin: 2 width: 3 height: 4 }
+        }
+      )pb")};
+
+  EXPECT_FALSE(PackDetections(detections).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -14,6 +14,8 @@
 
 #include "mediapipe/framework/formats/image.h"
 
+#include <memory>
+
 #include "mediapipe/framework/type_map.h"
 
 #if !MEDIAPIPE_DISABLE_GPU
@@ -29,6 +31,24 @@ bool Image::ConvertToCpu() const {
   return true;
 }
 
+ImageFrameSharedPtr Image::GetMutableImageFrameSharedPtr() {
+  if (!gpu_buffer_.IsShared()) {
+    ImageFrameSharedPtr frame = gpu_buffer_.GetWriteView<ImageFrame>();
+    use_gpu_ = false;
+    // Only the storage and `frame` refer to the frame.
+    if (frame.use_count() == 2) return frame;
+  }
+  // A read view leaves the storages of the shared contents untouched.
+  std::shared_ptr<const ImageFrame> shared_frame =
+      gpu_buffer_.GetReadView<ImageFrame>();
+  auto frame = std::make_shared<ImageFrame>();
+  frame->CopyFrom(*shared_frame, ImageFrame::kDefaultAlignmentBoundary);
+  *this = Image(frame);
+  return frame;
+}
+
+void Image::PrefetchCpu() const { gpu_buffer_.PrefetchReadView<ImageFrame>(); }
+
 // TODO Refactor common code from ImageFrameToGpuBufferCalculator
 bool Image::ConvertToGpu() const {
 #if MEDIAPIPE_DISABLE_GPU
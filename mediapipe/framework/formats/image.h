@@ -82,6 +82,13 @@ class Image {
     return gpu_buffer_.GetWriteView<ImageFrame>();
   }
 
+  // Returns the ImageFrame of this Image for modification, without affecting
+  // other Images (copy-on-write): if copies of this Image or other holders of
+  // the ImageFrame share the pixel data, this Image is first detached onto a
+  // copy of them. Pixel data wrapped by an ImageFrame with a custom deleter
+  // can't be detected as shared, and are modified in place.
+  ImageFrameSharedPtr GetMutableImageFrameSharedPtr();
+
   // Creates an Image representing the same image content as the input GPU
   // buffer in platform-specific representations.
 #if !MEDIAPIPE_DISABLE_GPU
@@ -147,6 +154,10 @@ class Image {
 
   // Helper utility for GPU->CPU data transfer.
   bool ConvertToCpu() const;
+  // Starts a GPU->CPU data transfer without waiting for it to finish, so that
+  // a later ConvertToCpu only blocks if the transfer is still in progress.
+  // Call this before sending a GPU image to a consumer that reads it on CPU.
+  void PrefetchCpu() const;
   // Helper utility for CPU->GPU data transfer.
   // *Requires a valid OpenGL context to be active before calling!*
   bool ConvertToGpu() const;
@@ -25,6 +25,7 @@
 
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/packet_size.h"
 #include "mediapipe/framework/port/aligned_malloc_and_free.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/proto_ns.h"
@@ -44,8 +45,14 @@ int CountOnes(uint32 n) {
 #endif
 }
 
+int64 EstimateImageFrameSize(const ImageFrame& frame) {
+  return frame.PixelDataSize();
+}
+
 }  // namespace
 
+MEDIAPIPE_REGISTER_PACKET_SIZE_ESTIMATOR(ImageFrame, EstimateImageFrameSize);
+
 const ImageFrame::Deleter ImageFrame::PixelDataDeleter::kArrayDelete =
     std::default_delete<uint8[]>();
 const ImageFrame::Deleter ImageFrame::PixelDataDeleter::kFree = free;
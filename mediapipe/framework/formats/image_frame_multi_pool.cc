@@ -0,0 +1,38 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+
+#include <memory>
+#include <utility>
+
+namespace mediapipe {
+
+std::unique_ptr<ImageFrame> ImageFrameMultiPool::GetUniqueBuffer(
+    int width, int height, ImageFormat::Format format,
+    int alignment_boundary) {
+  ImageFrameSharedPtr pooled =
+      GetBuffer(width, height, format, alignment_boundary);
+  uint8* pixel_data = pooled->MutablePixelData();
+  const int width_step = pooled->WidthStep();
+  // The deleter holds the pooled frame, and with it the pixel data.
+  auto frame = std::make_unique<ImageFrame>();
+  frame->AdoptPixelData(format, width, height, width_step, pixel_data,
+                        [pooled = std::move(pooled)](uint8*) mutable {
+                          pooled.reset();
+                        });
+  return frame;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,58 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This class lets calculators allocate ImageFrames of various sizes and
+// formats, caching and reusing them as needed. It is the CPU counterpart of
+// GpuBufferMultiPool.
+//
+// Calculators normally get it from kImageFrameMultiPoolService, through the
+// helpers in image_frame_pool_service.h.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MULTI_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MULTI_POOL_H_
+
+#include <memory>
+
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
+#include "mediapipe/gpu/multi_pool.h"
+
+namespace mediapipe {
+
+class ImageFrameMultiPool : public MultiPool<ImageFramePool,
+                                             internal::ImageFrameSpec,
+                                             ImageFrameSharedPtr> {
+ public:
+  using MultiPool::MultiPool;
+
+  // Obtains a frame shared with the pool. Suits Image outputs, which hold
+  // their ImageFrame by shared_ptr.
+  ImageFrameSharedPtr GetBuffer(
+      int width, int height, ImageFormat::Format format,
+      int alignment_boundary = ImageFrame::kDefaultAlignmentBoundary) {
+    return Get(
+        internal::ImageFrameSpec(width, height, format, alignment_boundary));
+  }
+
+  // Obtains a uniquely owned frame, for calculators that output ImageFrame
+  // packets. Its pixel data goes back to the pool when it is released.
+  std::unique_ptr<ImageFrame> GetUniqueBuffer(
+      int width, int height, ImageFormat::Format format,
+      int alignment_boundary = ImageFrame::kDefaultAlignmentBoundary);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_MULTI_POOL_H_
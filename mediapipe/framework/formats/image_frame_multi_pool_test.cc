@@ -0,0 +1,80 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 300;
+constexpr int kHeight = 200;
+constexpr ImageFormat::Format kFormat = ImageFormat::SRGB;
+
+TEST(ImageFrameMultiPoolTest, ReusesBuffersOfTheSameSpec) {
+  ImageFrameMultiPool pool;
+  // The pool for a spec is only created on its second request.
+  pool.GetBuffer(kWidth, kHeight, kFormat);
+  const uint8_t* pixel_data;
+  {
+    ImageFrameSharedPtr frame = pool.GetBuffer(kWidth, kHeight, kFormat);
+    pixel_data = frame->PixelData();
+  }
+  ImageFrameSharedPtr frame = pool.GetBuffer(kWidth, kHeight, kFormat);
+  EXPECT_EQ(frame->PixelData(), pixel_data);
+  EXPECT_EQ(frame->Width(), kWidth);
+  EXPECT_EQ(frame->Height(), kHeight);
+  EXPECT_EQ(frame->Format(), kFormat);
+  EXPECT_TRUE(frame->IsAligned(ImageFrame::kDefaultAlignmentBoundary));
+
+  ImageFrameSharedPtr other_format =
+      pool.GetBuffer(kWidth, kHeight, ImageFormat::SRGBA);
+  EXPECT_EQ(other_format->Format(), ImageFormat::SRGBA);
+  EXPECT_NE(other_format->PixelData(), pixel_data);
+
+  ImageFrameSharedPtr gl_aligned =
+      pool.GetBuffer(kWidth, kHeight, kFormat,
+                     ImageFrame::kGlDefaultAlignmentBoundary);
+  EXPECT_EQ(gl_aligned->WidthStep(), kWidth * 3);
+  EXPECT_NE(gl_aligned->PixelData(), pixel_data);
+}
+
+TEST(ImageFrameMultiPoolTest, UniqueBuffersReturnPixelDataToPool) {
+  ImageFrameMultiPool pool;
+  pool.GetBuffer(kWidth, kHeight, kFormat);
+  const uint8_t* pixel_data;
+  {
+    std::unique_ptr<ImageFrame> frame =
+        pool.GetUniqueBuffer(kWidth, kHeight, kFormat);
+    EXPECT_EQ(frame->Width(), kWidth);
+    EXPECT_EQ(frame->Height(), kHeight);
+    EXPECT_EQ(frame->Format(), kFormat);
+    pixel_data = frame->PixelData();
+    // Moving the frame, as Packet::Consume does, keeps the pooled pixels.
+    ImageFrame moved(std::move(*frame));
+    EXPECT_EQ(moved.PixelData(), pixel_data);
+  }
+  std::unique_ptr<ImageFrame> frame =
+      pool.GetUniqueBuffer(kWidth, kHeight, kFormat);
+  EXPECT_EQ(frame->PixelData(), pixel_data);
+}
+
+}  // namespace
+}  // namespace mediapipe
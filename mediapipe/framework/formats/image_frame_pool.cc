@@ -19,11 +19,13 @@
 namespace mediapipe {
 
 ImageFramePool::ImageFramePool(int width, int height,
-                               ImageFormat::Format format, int keep_count)
+                               ImageFormat::Format format, int keep_count,
+                               int alignment_boundary)
     : width_(width),
       height_(height),
       format_(format),
-      keep_count_(keep_count) {}
+      keep_count_(keep_count),
+      alignment_boundary_(alignment_boundary) {}
 
 ImageFrameSharedPtr ImageFramePool::GetBuffer() {
   std::unique_ptr<ImageFrame> buffer;
@@ -31,9 +33,10 @@ ImageFrameSharedPtr ImageFramePool::GetBuffer() {
   {
     absl::MutexLock lock(&mutex_);
     if (available_.empty()) {
-      // Fix alignment at 4 for best compatability with OpenGL.
-      buffer = std::make_unique<ImageFrame>(
-          format_, width_, height_, ImageFrame::kGlDefaultAlignmentBoundary);
+      // Unless requested otherwise, alignment is fixed at 4 for best
+      // compatibility with OpenGL.
+      buffer = std::make_unique<ImageFrame>(format_, width_, height_,
+                                            alignment_boundary_);
       if (!buffer) return nullptr;
     } else {
       buffer = std::move(available_.back());
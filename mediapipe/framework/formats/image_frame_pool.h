@@ -18,16 +18,48 @@
 #ifndef MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_POOL_H_
 #define MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_POOL_H_
 
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/gpu/multi_pool.h"
 
 namespace mediapipe {
 
 using ImageFrameSharedPtr = std::shared_ptr<ImageFrame>;
 
+namespace internal {
+
+struct ImageFrameSpec {
+  ImageFrameSpec(int w, int h, ImageFormat::Format f,
+                 int a = ImageFrame::kDefaultAlignmentBoundary)
+      : width(w), height(h), format(f), alignment_boundary(a) {}
+
+  template <typename H>
+  friend H AbslHashValue(H h, const ImageFrameSpec& spec) {
+    return H::combine(std::move(h), spec.width, spec.height,
+                      static_cast<int>(spec.format), spec.alignment_boundary);
+  }
+
+  int width;
+  int height;
+  ImageFormat::Format format;
+  int alignment_boundary;
+};
+
+inline bool operator==(const ImageFrameSpec& lhs, const ImageFrameSpec& rhs) {
+  return lhs.width == rhs.width && lhs.height == rhs.height &&
+         lhs.format == rhs.format &&
+         lhs.alignment_boundary == rhs.alignment_boundary;
+}
+inline bool operator!=(const ImageFrameSpec& lhs, const ImageFrameSpec& rhs) {
+  return !operator==(lhs, rhs);
+}
+
+}  // namespace internal
+
 class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
  public:
   // Creates a pool. This pool will manage buffers of the specified dimensions,
@@ -41,6 +73,21 @@ class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
         new ImageFramePool(width, height, format, keep_count));
   }
 
+  // Creates a pool for a MultiPool. Unlike the pools above, its buffers have
+  // the alignment given in the spec.
+  static std::shared_ptr<ImageFramePool> Create(
+      const internal::ImageFrameSpec& spec, const MultiPoolOptions& options) {
+    return std::shared_ptr<ImageFramePool>(
+        new ImageFramePool(spec.width, spec.height, spec.format,
+                           options.keep_count, spec.alignment_boundary));
+  }
+
+  static ImageFrameSharedPtr CreateBufferWithoutPool(
+      const internal::ImageFrameSpec& spec) {
+    return std::make_shared<ImageFrame>(spec.format, spec.width, spec.height,
+                                        spec.alignment_boundary);
+  }
+
   // Obtains a buffers. May either be reused or created anew.
   ImageFrameSharedPtr GetBuffer();
 
@@ -53,7 +100,9 @@ class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
 
  private:
   ImageFramePool(int width, int height, ImageFormat::Format format,
-                 int keep_count);
+                 int keep_count,
+                 int alignment_boundary =
+                     ImageFrame::kGlDefaultAlignmentBoundary);
 
   // Return a buffer to the pool.
   void Return(ImageFrame* buf);
@@ -67,6 +116,7 @@ class ImageFramePool : public std::enable_shared_from_this<ImageFramePool> {
   const int height_;
   const ImageFormat::Format format_;
   const int keep_count_;
+  const int alignment_boundary_;
 
   absl::Mutex mutex_;
   int in_use_count_ ABSL_GUARDED_BY(mutex_) = 0;
@@ -0,0 +1,95 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/image.h"
+
+#include <memory>
+
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+std::shared_ptr<ImageFrame> MakeFrame() {
+  auto frame = std::make_shared<ImageFrame>(ImageFormat::GRAY8, 4, 3);
+  frame->SetToZero();
+  return frame;
+}
+
+const uint8* PixelData(const Image& image) {
+  return image.GetImageFrameSharedPtr()->PixelData();
+}
+
+TEST(ImageTest, GetMutableImageFrameOfSoleOwnerIsInPlace) {
+  Image image(MakeFrame());
+  const uint8* pixels = PixelData(image);
+
+  ImageFrameSharedPtr frame = image.GetMutableImageFrameSharedPtr();
+  EXPECT_EQ(frame->PixelData(), pixels);
+  frame->MutablePixelData()[0] = 7;
+  EXPECT_EQ(PixelData(image), pixels);
+  EXPECT_EQ(PixelData(image)[0], 7);
+}
+
+TEST(ImageTest, GetMutableImageFrameOfCopiedImageCopies) {
+  Image image(MakeFrame());
+  const Image copy = image;
+  const uint8* pixels = PixelData(copy);
+
+  ImageFrameSharedPtr frame = image.GetMutableImageFrameSharedPtr();
+  EXPECT_NE(frame->PixelData(), pixels);
+  EXPECT_EQ(frame->Width(), 4);
+  EXPECT_EQ(frame->Height(), 3);
+  EXPECT_EQ(frame->Format(), ImageFormat::GRAY8);
+  frame->MutablePixelData()[0] = 7;
+  EXPECT_EQ(PixelData(image), frame->PixelData());
+  EXPECT_EQ(PixelData(copy), pixels);
+  EXPECT_EQ(PixelData(copy)[0], 0);
+}
+
+TEST(ImageTest, GetMutableImageFrameOfSharedFrameCopies) {
+  std::shared_ptr<ImageFrame> shared_frame = MakeFrame();
+  Image image(shared_frame);
+
+  ImageFrameSharedPtr frame = image.GetMutableImageFrameSharedPtr();
+  EXPECT_NE(frame.get(), shared_frame.get());
+  frame->MutablePixelData()[0] = 7;
+  EXPECT_EQ(shared_frame->PixelData()[0], 0);
+}
+
+TEST(ImageTest, GetMutableImageFrameLeavesUpstreamPacketUnchanged) {
+  const Packet upstream = MakePacket<Image>(MakeFrame());
+  const uint8* pixels = PixelData(upstream.Get<Image>());
+  Image image = upstream.Get<Image>();
+
+  ImageFrameSharedPtr frame = image.GetMutableImageFrameSharedPtr();
+  EXPECT_NE(frame->PixelData(), pixels);
+  frame->MutablePixelData()[0] = 7;
+  EXPECT_EQ(PixelData(upstream.Get<Image>()), pixels);
+  EXPECT_EQ(PixelData(upstream.Get<Image>())[0], 0);
+}
+
+TEST(ImageTest, GetMutableImageFrameAfterCopyIsReleasedIsInPlace) {
+  Image image(MakeFrame());
+  const uint8* pixels = PixelData(image);
+  { const Image copy = image; }
+
+  EXPECT_EQ(image.GetMutableImageFrameSharedPtr()->PixelData(), pixels);
+}
+
+}  // namespace
+}  // namespace mediapipe
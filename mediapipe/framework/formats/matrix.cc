@@ -15,12 +15,22 @@
 
 #include <algorithm>
 
+#include "mediapipe/framework/packet_size.h"
 #include "mediapipe/framework/port/core_proto_inc.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/proto_ns.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
+namespace {
+
+int64 EstimateMatrixSize(const Matrix& matrix) {
+  return static_cast<int64>(matrix.size()) * sizeof(float);
+}
+
+}  // namespace
+
+MEDIAPIPE_REGISTER_PACKET_SIZE_ESTIMATOR(Matrix, EstimateMatrixSize);
 
 void MatrixDataProtoFromMatrix(const Matrix& matrix, MatrixData* matrix_data) {
   const int rows = matrix.rows();
@@ -0,0 +1,75 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_OBJECT_DETECTION_ANCHOR_ARRAY_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_OBJECT_DETECTION_ANCHOR_ARRAY_H_
+
+#include <vector>
+
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+
+namespace mediapipe {
+
+// The anchors of a detection model as one float array per coordinate, in
+// the same units as the Anchor proto. Box decoders read anchor i as
+// {y_center[i], x_center[i], h[i], w[i]}, so a batch of boxes is decoded from
+// contiguous arrays instead of one message per anchor.
+struct AnchorArray {
+  std::vector<float> y_center;
+  std::vector<float> x_center;
+  std::vector<float> h;
+  std::vector<float> w;
+
+  int size() const { return y_center.size(); }
+
+  void reserve(int size) {
+    y_center.reserve(size);
+    x_center.reserve(size);
+    h.reserve(size);
+    w.reserve(size);
+  }
+
+  void Append(float anchor_y_center, float anchor_x_center, float anchor_h,
+              float anchor_w) {
+    y_center.push_back(anchor_y_center);
+    x_center.push_back(anchor_x_center);
+    h.push_back(anchor_h);
+    w.push_back(anchor_w);
+  }
+
+  static AnchorArray FromAnchors(const std::vector<Anchor>& anchors) {
+    AnchorArray result;
+    result.reserve(anchors.size());
+    for (const Anchor& anchor : anchors) {
+      result.Append(anchor.y_center(), anchor.x_center(), anchor.h(),
+                    anchor.w());
+    }
+    return result;
+  }
+
+  std::vector<Anchor> ToAnchors() const {
+    std::vector<Anchor> anchors(size());
+    for (int i = 0; i < size(); ++i) {
+      anchors[i].set_y_center(y_center[i]);
+      anchors[i].set_x_center(x_center[i]);
+      anchors[i].set_h(h[i]);
+      anchors[i].set_w(w[i]);
+    }
+    return anchors;
+  }
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_OBJECT_DETECTION_ANCHOR_ARRAY_H_
@@ -0,0 +1,68 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/packed_landmarks.h"
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+
+namespace mediapipe {
+
+void PackedNormalizedLandmarks::Resize(int size, bool with_visibility,
+                                       bool with_presence) {
+  x.resize(size);
+  y.resize(size);
+  z.resize(size);
+  visibility.resize(with_visibility ? size : 0);
+  presence.resize(with_presence ? size : 0);
+}
+
+PackedNormalizedLandmarks PackLandmarks(
+    const NormalizedLandmarkList& landmarks) {
+  const int size = landmarks.landmark_size();
+  const bool with_visibility =
+      size > 0 && landmarks.landmark(0).has_visibility();
+  const bool with_presence = size > 0 && landmarks.landmark(0).has_presence();
+  PackedNormalizedLandmarks packed;
+  packed.Resize(size, with_visibility, with_presence);
+  for (int i = 0; i < size; ++i) {
+    const NormalizedLandmark& landmark = landmarks.landmark(i);
+    packed.x[i] = landmark.x();
+    packed.y[i] = landmark.y();
+    packed.z[i] = landmark.z();
+    if (with_visibility) packed.visibility[i] = landmark.visibility();
+    if (with_presence) packed.presence[i] = landmark.presence();
+  }
+  return packed;
+}
+
+NormalizedLandmarkList UnpackLandmarks(
+    const PackedNormalizedLandmarks& landmarks) {
+  NormalizedLandmarkList unpacked;
+  unpacked.mutable_landmark()->Reserve(landmarks.size());
+  for (int i = 0; i < landmarks.size(); ++i) {
+    NormalizedLandmark* landmark = unpacked.add_landmark();
+    landmark->set_x(landmarks.x[i]);
+    landmark->set_y(landmarks.y[i]);
+    landmark->set_z(landmarks.z[i]);
+    if (landmarks.has_visibility()) {
+      landmark->set_visibility(landmarks.visibility[i]);
+    }
+    if (landmarks.has_presence()) {
+      landmark->set_presence(landmarks.presence[i]);
+    }
+  }
+  return unpacked;
+}
+
+}  // namespace mediapipe
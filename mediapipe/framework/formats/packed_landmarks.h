@@ -0,0 +1,64 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_PACKED_LANDMARKS_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_PACKED_LANDMARKS_H_
+
+#include <vector>
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+
+namespace mediapipe {
+
+// Normalized landmarks in structure-of-arrays layout, with one contiguous
+// float array per attribute.
+//
+// A NormalizedLandmarkList allocates a sub-message per landmark, and every
+// calculator that adjusts the landmarks copies all of them. Calculators on hot
+// paths can instead update packed landmarks with simple loops over the arrays,
+// which compilers vectorize, and pass them on without per-landmark
+// allocations. Convert to and from NormalizedLandmarkList at the edges of the
+// graph with UnpackLandmarks and PackLandmarks.
+struct PackedNormalizedLandmarks {
+  // Coordinates of the landmarks. All of them have size() elements.
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  // Visibility and presence of the landmarks, empty if unset, and of size()
+  // elements otherwise.
+  std::vector<float> visibility;
+  std::vector<float> presence;
+
+  int size() const { return x.size(); }
+
+  bool has_visibility() const { return !visibility.empty(); }
+  bool has_presence() const { return !presence.empty(); }
+
+  // Resizes the arrays to @size landmarks. Visibility and presence are resized
+  // if requested, and cleared otherwise.
+  void Resize(int size, bool with_visibility, bool with_presence);
+};
+
+// Packs @landmarks. Visibility and presence are packed if set on the first
+// landmark; unset values of other landmarks are packed as 0.
+PackedNormalizedLandmarks PackLandmarks(
+    const NormalizedLandmarkList& landmarks);
+
+// Unpacks @landmarks, setting visibility and presence if they are packed.
+NormalizedLandmarkList UnpackLandmarks(
+    const PackedNormalizedLandmarks& landmarks);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_PACKED_LANDMARKS_H_
@@ -0,0 +1,58 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/packed_landmarks.h"
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(PackedLandmarksTest, PacksAndUnpacksLandmarks) {
+  const auto landmarks = ParseTextProtoOrDie<NormalizedLandmarkList>(R"pb(
+    landmark { x: 0.1 y: 0.2 z: 0.3 visibility: 0.9 }
+    landmark { x: 0.4 y: 0.5 z: 0.6 visibility: 0.8 }
+  )pb");
+
+  const PackedNormalizedLandmarks packed = PackLandmarks(landmarks);
+
+  EXPECT_EQ(packed.size(), 2);
+  EXPECT_THAT(packed.x, ElementsAre(0.1f, 0.4f));
+  EXPECT_THAT(packed.y, ElementsAre(0.2f, 0.5f));
+  EXPECT_THAT(packed.z, ElementsAre(0.3f, 0.6f));
+  EXPECT_THAT(packed.visibility, ElementsAre(0.9f, 0.8f));
+  EXPECT_THAT(packed.presence, IsEmpty());
+
+  const NormalizedLandmarkList unpacked = UnpackLandmarks(packed);
+  EXPECT_EQ(unpacked.SerializeAsString(), landmarks.SerializeAsString());
+}
+
+TEST(PackedLandmarksTest, PacksEmptyList) {
+  const PackedNormalizedLandmarks packed =
+      PackLandmarks(NormalizedLandmarkList());
+
+  EXPECT_EQ(packed.size(), 0);
+  EXPECT_FALSE(packed.has_visibility());
+  EXPECT_FALSE(packed.has_presence());
+  EXPECT_EQ(UnpackLandmarks(packed).landmark_size(), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
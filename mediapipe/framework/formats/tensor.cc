@@ -17,8 +17,13 @@
 #include <cstdint>
 #include <utility>
 
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
+#include "mediapipe/framework/packet_size.h"
 #include "mediapipe/framework/port.h"
+#include "mediapipe/framework/port/aligned_malloc_and_free.h"
 #include "mediapipe/framework/port/logging.h"
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
 #include "mediapipe/gpu/gl_base.h"
@@ -55,6 +60,15 @@ int BhwcDepthFromShape(const Tensor::Shape& shape) {
   return shape.dims.size() < 2 ? 1 : shape.dims[shape.dims.size() - 1];
 }
 
+namespace {
+// A slice owns no storage.
+int64 EstimateTensorSize(const Tensor& tensor) {
+  return tensor.is_slice() ? 0 : tensor.bytes();
+}
+}  // namespace
+
+MEDIAPIPE_REGISTER_PACKET_SIZE_ESTIMATOR(Tensor, EstimateTensorSize);
+
 // TODO: Match channels count and padding for Texture2D:
 // 1) support 1/2/4 channesl texture for 1/2/3-4 depth.
 // 2) Allocate cpu_buffer_ with padded amount of memory
@@ -85,6 +99,7 @@ void DeallocateVirtualMemory(void* pointer, size_t size) {
 
 Tensor::MtlBufferView Tensor::GetMtlBufferReadView(
     id<MTLCommandBuffer> command_buffer) const {
+  if (parent_) return WholeParent().GetMtlBufferReadView(command_buffer);
   LOG_IF(FATAL, valid_ == kValidNone)
       << "Tensor must be written prior to read from.";
   LOG_IF(FATAL, !(valid_ & (kValidCpu | kValidMetalBuffer)))
@@ -98,14 +113,25 @@ Tensor::MtlBufferView Tensor::GetMtlBufferReadView(
 
 Tensor::MtlBufferView Tensor::GetMtlBufferWriteView(
     id<MTLCommandBuffer> command_buffer) const {
+  if (parent_) return WholeParent().GetMtlBufferWriteView(command_buffer);
+  auto lock(absl::make_unique<absl::MutexLock>(&view_mutex_));
   // Don't overwrite command buffer at which the metal buffer has been written
   // so we can wait until completed.
   command_buffer_ = command_buffer;
-  return GetMtlBufferWriteView([command_buffer device]);
+  valid_ = kValidMetalBuffer;
+  if (pool_ && !metal_buffer_ && !cpu_buffer_) {
+    // Reusing a pooled buffer is safe here, as this write is encoded after
+    // all earlier GPU work on the buffer, and Metal orders them.
+    metal_buffer_ = pool_->TakeMtlBuffer([command_buffer device], bytes());
+    if (metal_buffer_) cpu_buffer_ = metal_buffer_.contents;
+  }
+  AllocateMtlBuffer([command_buffer device]);
+  return {metal_buffer_, std::move(lock)};
 }
 
 Tensor::MtlBufferView Tensor::GetMtlBufferWriteView(
     id<MTLDevice> device) const {
+  if (parent_) return WholeParent().GetMtlBufferWriteView(device);
   auto lock(absl::make_unique<absl::MutexLock>(&view_mutex_));
   valid_ = kValidMetalBuffer;
   AllocateMtlBuffer(device);
@@ -148,6 +174,7 @@ bool Tensor::NeedsHalfFloatRenderTarget() const {
 }
 
 Tensor::OpenGlTexture2dView Tensor::GetOpenGlTexture2dReadView() const {
+  if (parent_) return WholeParent().GetOpenGlTexture2dReadView();
   LOG_IF(FATAL, valid_ == kValidNone)
       << "Tensor must be written prior to read from.";
   LOG_IF(FATAL, !(valid_ & (kValidCpu | kValidOpenGlTexture2d)))
@@ -202,6 +229,7 @@ Tensor::OpenGlTexture2dView Tensor::GetOpenGlTexture2dReadView() const {
 }
 
 Tensor::OpenGlTexture2dView Tensor::GetOpenGlTexture2dWriteView() const {
+  if (parent_) return WholeParent().GetOpenGlTexture2dWriteView();
   auto lock = absl::make_unique<absl::MutexLock>(&view_mutex_);
   AllocateOpenGlTexture2d();
 #ifdef __EMSCRIPTEN__
@@ -315,6 +343,7 @@ void Tensor::AllocateOpenGlTexture2d() const {
 
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 Tensor::OpenGlBufferView Tensor::GetOpenGlBufferReadView() const {
+  if (parent_) return WholeParent().GetOpenGlBufferReadView();
   LOG_IF(FATAL, valid_ == kValidNone)
       << "Tensor must be written prior to read from.";
   LOG_IF(FATAL, !(valid_ & (kValidCpu |
@@ -349,6 +378,7 @@ Tensor::OpenGlBufferView Tensor::GetOpenGlBufferReadView() const {
 }
 
 Tensor::OpenGlBufferView Tensor::GetOpenGlBufferWriteView() const {
+  if (parent_) return WholeParent().GetOpenGlBufferWriteView();
   auto lock(absl::make_unique<absl::MutexLock>(&view_mutex_));
   AllocateOpenGlBuffer();
   valid_ = kValidOpenGlBuffer;
@@ -359,6 +389,10 @@ void Tensor::AllocateOpenGlBuffer() const {
   if (opengl_buffer_ == GL_INVALID_INDEX) {
     gl_context_ = mediapipe::GlContext::GetCurrent();
     LOG_IF(FATAL, !gl_context_) << "GlContext is not bound to the thread.";
+    if (pool_ && !use_ahwb_) {
+      opengl_buffer_ = pool_->TakeOpenGlBuffer(gl_context_.get(), bytes());
+      if (opengl_buffer_ != GL_INVALID_INDEX) return;
+    }
     glGenBuffers(1, &opengl_buffer_);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, opengl_buffer_);
     if (!use_ahwb_ || !AllocateAhwbMapToSsbo()) {
@@ -383,6 +417,9 @@ void Tensor::Move(Tensor* src) {
   shape_ = src->shape();
   element_type_ = src->element_type();
   src->element_type_ = ElementType::kNone;  // Mark as invalidated.
+  pool_ = std::move(src->pool_);
+  parent_ = std::move(src->parent_);
+  parent_offset_ = std::exchange(src->parent_offset_, 0);
   cpu_buffer_ = src->cpu_buffer_;
   src->cpu_buffer_ = nullptr;
 #if MEDIAPIPE_METAL_ENABLED
@@ -419,6 +456,37 @@ Tensor::Tensor(ElementType element_type, const Shape& shape,
       shape_(shape),
       quantization_parameters_(quantization_parameters) {}
 
+absl::StatusOr<Tensor> Tensor::CreateSlice(
+    std::shared_ptr<const Tensor> parent, int begin, int end) {
+  if (parent->shape_.dims.empty() || begin < 0 || begin >= end ||
+      end > parent->shape_.dims[0]) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid slice [", begin, ", ", end,
+                     ") of the first dimension of a tensor of ",
+                     parent->shape_.dims.empty() ? 0 : parent->shape_.dims[0],
+                     " elements."));
+  }
+  Tensor slice = CreateSlice(std::move(parent));
+  const int stride = slice.bytes() / slice.shape_.dims[0];
+  slice.shape_.dims[0] = end - begin;
+  slice.parent_offset_ += begin * stride;
+  return slice;
+}
+
+Tensor Tensor::CreateSlice(std::shared_ptr<const Tensor> parent) {
+  Tensor slice(parent->element_type_, parent->shape_,
+               parent->quantization_parameters_);
+  slice.parent_offset_ = parent->parent_offset_;
+  slice.parent_ = parent->parent_ ? parent->parent_ : std::move(parent);
+  return slice;
+}
+
+const Tensor& Tensor::WholeParent() const {
+  LOG_IF(FATAL, parent_offset_ != 0 || bytes() != parent_->bytes())
+      << "A slice of part of a tensor only supports CPU views.";
+  return *parent_;
+}
+
 #if MEDIAPIPE_METAL_ENABLED
 void Tensor::Invalidate() {
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
@@ -432,6 +500,10 @@ void Tensor::Invalidate() {
     if (cpu_buffer_ && !metal_buffer_) {
       DeallocateVirtualMemory(cpu_buffer_, AlignToPageSize(bytes()));
     }
+    // Only pooled buffers are allocated from heaps.
+    if (pool_ && metal_buffer_.heap) {
+      pool_->ReturnMtlBuffer(device_, bytes(), metal_buffer_);
+    }
     metal_buffer_ = nil;
     command_buffer_ = nil;
     device_ = nil;
@@ -476,6 +548,11 @@ void Tensor::Invalidate() {
     std::swap(cleanup_gl_fb, frame_buffer_);
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
     std::swap(cleanup_gl_buf, opengl_buffer_);
+    // SSBOs backed by an AHardwareBuffer are not pooled.
+    if (pool_ && !use_ahwb_ && cleanup_gl_buf != GL_INVALID_INDEX &&
+        pool_->ReturnOpenGlBuffer(gl_context_, bytes(), cleanup_gl_buf)) {
+      cleanup_gl_buf = GL_INVALID_INDEX;
+    }
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
   }
@@ -501,13 +578,22 @@ void Tensor::Invalidate() {
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
 
   if (cpu_buffer_) {
-    free(cpu_buffer_);
+    if (pool_) {
+      pool_->ReturnCpuBuffer(bytes(), cpu_buffer_);
+    } else {
+      aligned_free(cpu_buffer_);
+    }
   }
   cpu_buffer_ = nullptr;
 }
 #endif  // MEDIAPIPE_METAL_ENABLED
 
 Tensor::CpuReadView Tensor::GetCpuReadView() const {
+  if (parent_) {
+    CpuReadView view = parent_->GetCpuReadView();
+    return {static_cast<const uint8_t*>(view.buffer_) + parent_offset_,
+            std::move(view.lock_), std::exchange(view.release_callback_, {})};
+  }
   auto lock = absl::make_unique<absl::MutexLock>(&view_mutex_);
   LOG_IF(FATAL, valid_ == kValidNone)
       << "Tensor must be written prior to read from.";
@@ -590,6 +676,17 @@ Tensor::CpuReadView Tensor::GetCpuReadView() const {
 }
 
 Tensor::CpuWriteView Tensor::GetCpuWriteView() const {
+  if (parent_) {
+    // The rest of the parent is kept, so its content is brought to the CPU
+    // before the CPU buffer becomes the only valid one.
+    if (parent_->valid_ != kValidNone &&
+        (parent_offset_ != 0 || bytes() != parent_->bytes())) {
+      parent_->GetCpuReadView();
+    }
+    CpuWriteView view = parent_->GetCpuWriteView();
+    return {static_cast<uint8_t*>(view.buffer_) + parent_offset_,
+            std::move(view.lock_), std::exchange(view.release_callback_, {})};
+  }
   auto lock = absl::make_unique<absl::MutexLock>(&view_mutex_);
   AllocateCpuBuffer();
   valid_ = kValidCpu;
@@ -615,7 +712,12 @@ void Tensor::AllocateCpuBuffer() const {
 #if MEDIAPIPE_METAL_ENABLED
     cpu_buffer_ = AllocateVirtualMemory(bytes());
 #else
-    cpu_buffer_ = malloc(bytes());
+    if (pool_) {
+      cpu_buffer_ = pool_->TakeCpuBuffer(bytes());
+      if (cpu_buffer_) return;
+    }
+    cpu_buffer_ =
+        aligned_malloc(bytes() + kCpuBufferPadding, kCpuBufferAlignment);
 #endif  // MEDIAPIPE_METAL_ENABLED
   }
 }
@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <functional>
 #include <initializer_list>
+#include <memory>
 #include <numeric>
 #include <tuple>
 #include <type_traits>
@@ -25,6 +26,7 @@
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port.h"
 
@@ -74,6 +76,8 @@ namespace mediapipe {
 // float* pointer = view.buffer<float>();
 // ...reading the cpu memory...
 
+class TensorPool;
+
 class Tensor {
   class View {
    public:
@@ -131,6 +135,22 @@ class Tensor {
   Tensor& operator=(Tensor&&);
   ~Tensor() { Invalidate(); }
 
+  // Returns a tensor holding elements [begin, end) of the first dimension of
+  // `parent`, without copying them: the slice shares the storage of `parent`
+  // and keeps it alive. Writing to the slice writes to `parent`.
+  //
+  // Views of the slice hold the corresponding view of `parent`, so a thread
+  // must not hold views of two slices of the same tensor at once. A slice of
+  // part of `parent` only supports CPU views, since the GPU views are whole
+  // buffers and textures. Its CPU buffer is aligned to the element size only.
+  static absl::StatusOr<Tensor> CreateSlice(
+      std::shared_ptr<const Tensor> parent, int begin, int end);
+  // Returns a slice of all of `parent`, which supports all views.
+  static Tensor CreateSlice(std::shared_ptr<const Tensor> parent);
+  // Returns true if the tensor is a slice sharing the storage of another
+  // tensor.
+  bool is_slice() const { return parent_ != nullptr; }
+
   template <typename T>
   class CpuView : public View {
    public:
@@ -244,6 +264,14 @@ class Tensor {
   // size_alignment must be power of 2, i.e. 2, 4, 8, 16, 64, etc.
   // If size_alignment is 0, then the buffer will not be padded.
   AHardwareBufferView GetAHardwareBufferWriteView(int size_alignment = 0) const;
+
+  // Creates a tensor whose data is `handle`, an AHARDWAREBUFFER_FORMAT_BLOB
+  // buffer of at least bytes() bytes, without copying it. The data must be
+  // written before the tensor is created. The tensor acquires a reference to
+  // the buffer, and calls `release_callback`, if any, once it is done with it.
+  static absl::StatusOr<Tensor> CreateFromAHardwareBuffer(
+      ElementType element_type, const Shape& shape, AHardwareBuffer* handle,
+      std::function<void()> release_callback = nullptr);
 #endif  // MEDIAPIPE_TENSOR_USE_AHWB
 
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
@@ -335,19 +363,27 @@ class Tensor {
   }
   int bytes() const { return shape_.num_elements() * element_size(); }
 
+  // Except on Metal and with AHardwareBuffer storage, the CPU buffer is
+  // aligned to kCpuBufferAlignment bytes and followed by kCpuBufferPadding
+  // readable bytes, so that it can be bound directly to a TfLite tensor.
+  static constexpr int kCpuBufferAlignment = 64;
+  static constexpr int kCpuBufferPadding = 16;
+
   bool ready_on_cpu() const {
-    return valid_ & (kValidAHardwareBuffer | kValidCpu);
+    return storage().valid_ & (kValidAHardwareBuffer | kValidCpu);
   }
   bool ready_on_gpu() const {
-    return valid_ & (kValidMetalBuffer | kValidOpenGlBuffer |
-                     kValidAHardwareBuffer | kValidOpenGlTexture2d);
+    return storage().valid_ & (kValidMetalBuffer | kValidOpenGlBuffer |
+                               kValidAHardwareBuffer | kValidOpenGlTexture2d);
+  }
+  bool ready_as_metal_buffer() const {
+    return storage().valid_ & kValidMetalBuffer;
   }
-  bool ready_as_metal_buffer() const { return valid_ & kValidMetalBuffer; }
   bool ready_as_opengl_buffer() const {
-    return valid_ & (kValidAHardwareBuffer | kValidOpenGlBuffer);
+    return storage().valid_ & (kValidAHardwareBuffer | kValidOpenGlBuffer);
   }
   bool ready_as_opengl_texture_2d() const {
-    return valid_ & kValidOpenGlTexture2d;
+    return storage().valid_ & kValidOpenGlTexture2d;
   }
   // Sets the type of underlying resource that is going to be allocated.
   enum class StorageType {
@@ -358,6 +394,8 @@ class Tensor {
   static StorageType GetPreferredStorageType();
 
  private:
+  friend class TensorPool;
+
   void Move(Tensor*);
   void Invalidate();
 
@@ -380,6 +418,18 @@ class Tensor {
   // The mutex is locked by Get*View and is kept by all Views.
   mutable absl::Mutex view_mutex_;
 
+  // The pool that the storages are taken from and returned to, if any.
+  std::shared_ptr<TensorPool> pool_;
+
+  // For a slice, the tensor owning the storage, which is never a slice, and
+  // the offset of the slice in its storage. A slice allocates no storage.
+  std::shared_ptr<const Tensor> parent_;
+  int parent_offset_ = 0;
+  // Returns the tensor owning the storage.
+  const Tensor& storage() const { return parent_ ? *parent_ : *this; }
+  // Returns parent_, which must be covered by the slice entirely.
+  const Tensor& WholeParent() const;
+
   mutable void* cpu_buffer_ = nullptr;
   void AllocateCpuBuffer() const;
 #if MEDIAPIPE_METAL_ENABLED
@@ -7,8 +7,12 @@
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port.h"
+#include "mediapipe/framework/port/aligned_malloc_and_free.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/gpu/gl_base.h"
 #endif  // MEDIAPIPE_TENSOR_USE_AHWB
@@ -207,6 +211,7 @@ class DelayedReleaser {
 }  // namespace
 
 Tensor::AHardwareBufferView Tensor::GetAHardwareBufferReadView() const {
+  if (parent_) return WholeParent().GetAHardwareBufferReadView();
   auto lock(absl::make_unique<absl::MutexLock>(&view_mutex_));
   CHECK(valid_ != kValidNone) << "Tensor must be written prior to read from.";
   CHECK(!(valid_ & kValidOpenGlTexture2d))
@@ -255,6 +260,7 @@ void Tensor::CreateEglSyncAndFd() const {
 
 Tensor::AHardwareBufferView Tensor::GetAHardwareBufferWriteView(
     int size_alignment) const {
+  if (parent_) return WholeParent().GetAHardwareBufferWriteView(size_alignment);
   auto lock(absl::make_unique<absl::MutexLock>(&view_mutex_));
   CHECK(AllocateAHardwareBuffer(size_alignment))
       << "AHardwareBuffer is not supported on the target system.";
@@ -267,6 +273,30 @@ Tensor::AHardwareBufferView Tensor::GetAHardwareBufferWriteView(
           std::move(lock)};
 }
 
+absl::StatusOr<Tensor> Tensor::CreateFromAHardwareBuffer(
+    ElementType element_type, const Shape& shape, AHardwareBuffer* handle,
+    std::function<void()> release_callback) {
+  Tensor tensor(element_type, shape);
+  if (__builtin_available(android 26, *)) {
+    AHardwareBuffer_Desc desc = {};
+    AHardwareBuffer_describe(handle, &desc);
+    if (desc.format != AHARDWAREBUFFER_FORMAT_BLOB ||
+        desc.width < tensor.bytes()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Expected a BLOB AHardwareBuffer of at least ", tensor.bytes(),
+          " bytes, got format ", desc.format, " and width ", desc.width));
+    }
+    AHardwareBuffer_acquire(handle);
+    tensor.ahwb_ = handle;
+    tensor.valid_ = kValidAHardwareBuffer;
+    // Written before being wrapped.
+    tensor.ahwb_written_ = [](bool) { return true; };
+    tensor.release_callback_ = std::move(release_callback);
+    return tensor;
+  }
+  return absl::UnavailableError("AHardwareBuffer requires Android API 26.");
+}
+
 bool Tensor::AllocateAHardwareBuffer(int size_alignment) const {
   if (__builtin_available(android 26, *)) {
     if (ahwb_ == nullptr) {
@@ -329,7 +359,7 @@ void Tensor::MoveCpuOrSsboToAhwb() const {
   } else if (valid_ & kValidCpu) {
     std::memcpy(dest, cpu_buffer_, bytes());
     // Free CPU memory because next time AHWB is mapped instead.
-    free(cpu_buffer_);
+    aligned_free(cpu_buffer_);
     cpu_buffer_ = nullptr;
   } else {
     LOG(FATAL) << "Can't convert tensor with mask " << valid_ << " into AHWB.";
@@ -0,0 +1,218 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_pool.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/port/aligned_malloc_and_free.h"
+
+namespace mediapipe {
+
+#if MEDIAPIPE_METAL_ENABLED
+namespace {
+
+// Heaps are at least this large, so that small tensors share a heap.
+constexpr NSUInteger kMinMetalHeapSize = 16 << 20;
+
+constexpr MTLResourceOptions kMetalBufferOptions =
+    MTLResourceStorageModeShared | MTLResourceCPUCacheModeDefaultCache;
+
+}  // namespace
+#endif  // MEDIAPIPE_METAL_ENABLED
+
+TensorPool::~TensorPool() {
+  for (auto& [bytes, buffers] : free_cpu_buffers_) {
+    for (void* buffer : buffers) {
+      aligned_free(buffer);
+    }
+  }
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  for (auto& [key, free_buffers] : free_opengl_buffers_) {
+    free_buffers.context->RunWithoutWaiting(
+        [buffers = std::move(free_buffers.buffers)]() {
+          glDeleteBuffers(buffers.size(), buffers.data());
+        });
+  }
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+}
+
+Tensor TensorPool::GetTensor(Tensor::ElementType element_type,
+                             const Tensor::Shape& shape) {
+  Tensor tensor(element_type, shape);
+  tensor.pool_ = shared_from_this();
+  return tensor;
+}
+
+Tensor TensorPool::GetTensor(
+    Tensor::ElementType element_type, const Tensor::Shape& shape,
+    const Tensor::QuantizationParameters& quantization_parameters) {
+  Tensor tensor(element_type, shape, quantization_parameters);
+  tensor.pool_ = shared_from_this();
+  return tensor;
+}
+
+int TensorPool::NumFreeStorages() {
+  absl::MutexLock lock(&mutex_);
+  int result = 0;
+  for (const auto& [bytes, buffers] : free_cpu_buffers_) {
+    result += buffers.size();
+  }
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  for (const auto& [key, free_buffers] : free_opengl_buffers_) {
+    result += free_buffers.buffers.size();
+  }
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+#if MEDIAPIPE_METAL_ENABLED
+  for (const auto& [key, buffers] : free_metal_buffers_) {
+    result += buffers.size();
+  }
+#endif  // MEDIAPIPE_METAL_ENABLED
+  return result;
+}
+
+void TensorPool::FreeUnusedStorages() {
+  absl::flat_hash_map<size_t, std::vector<void*>> free_cpu_buffers;
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  absl::flat_hash_map<std::pair<const GlContext*, size_t>, FreeOpenGlBuffers>
+      free_opengl_buffers;
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  {
+    absl::MutexLock lock(&mutex_);
+    free_cpu_buffers.swap(free_cpu_buffers_);
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+    free_opengl_buffers.swap(free_opengl_buffers_);
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+#if MEDIAPIPE_METAL_ENABLED
+    // Heaps are kept alive by the buffers still in use.
+    free_metal_buffers_.clear();
+    metal_heaps_.clear();
+#endif  // MEDIAPIPE_METAL_ENABLED
+  }
+  for (auto& [bytes, buffers] : free_cpu_buffers) {
+    for (void* buffer : buffers) {
+      aligned_free(buffer);
+    }
+  }
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  for (auto& [key, free_buffers] : free_opengl_buffers) {
+    free_buffers.context->RunWithoutWaiting(
+        [buffers = std::move(free_buffers.buffers)]() {
+          glDeleteBuffers(buffers.size(), buffers.data());
+        });
+  }
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+}
+
+void* TensorPool::TakeCpuBuffer(size_t bytes) {
+  absl::MutexLock lock(&mutex_);
+  auto it = free_cpu_buffers_.find(bytes);
+  if (it == free_cpu_buffers_.end() || it->second.empty()) {
+    return nullptr;
+  }
+  void* buffer = it->second.back();
+  it->second.pop_back();
+  return buffer;
+}
+
+void TensorPool::ReturnCpuBuffer(size_t bytes, void* buffer) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto& buffers = free_cpu_buffers_[bytes];
+    if (static_cast<int>(buffers.size()) < max_free_per_size_) {
+      buffers.push_back(buffer);
+      return;
+    }
+  }
+  aligned_free(buffer);
+}
+
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+GLuint TensorPool::TakeOpenGlBuffer(const GlContext* context, size_t bytes) {
+  absl::MutexLock lock(&mutex_);
+  auto it = free_opengl_buffers_.find({context, bytes});
+  if (it == free_opengl_buffers_.end() || it->second.buffers.empty()) {
+    return GL_INVALID_INDEX;
+  }
+  GLuint buffer = it->second.buffers.back();
+  it->second.buffers.pop_back();
+  return buffer;
+}
+
+bool TensorPool::ReturnOpenGlBuffer(const std::shared_ptr<GlContext>& context,
+                                    size_t bytes, GLuint buffer) {
+  absl::MutexLock lock(&mutex_);
+  auto& free_buffers = free_opengl_buffers_[{context.get(), bytes}];
+  if (static_cast<int>(free_buffers.buffers.size()) >= max_free_per_size_) {
+    return false;
+  }
+  // Keeps the context alive to delete the buffers with it.
+  free_buffers.context = context;
+  free_buffers.buffers.push_back(buffer);
+  return true;
+}
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+
+#if MEDIAPIPE_METAL_ENABLED
+id<MTLBuffer> TensorPool::TakeMtlBuffer(id<MTLDevice> device, size_t bytes) {
+  if (@available(iOS 13.0, macOS 10.15, *)) {
+    const void* device_key = (__bridge const void*)device;
+    absl::MutexLock lock(&mutex_);
+    auto it = free_metal_buffers_.find({device_key, bytes});
+    if (it != free_metal_buffers_.end() && !it->second.empty()) {
+      id<MTLBuffer> buffer = it->second.back();
+      it->second.pop_back();
+      return buffer;
+    }
+    const MTLSizeAndAlign size_and_align =
+        [device heapBufferSizeAndAlignWithLength:bytes
+                                         options:kMetalBufferOptions];
+    std::vector<id<MTLHeap>>& heaps = metal_heaps_[device_key];
+    for (id<MTLHeap> heap : heaps) {
+      if ([heap maxAvailableSizeWithAlignment:size_and_align.align] >=
+          size_and_align.size) {
+        id<MTLBuffer> buffer = [heap newBufferWithLength:bytes
+                                                 options:kMetalBufferOptions];
+        if (buffer) return buffer;
+      }
+    }
+    MTLHeapDescriptor* descriptor = [[MTLHeapDescriptor alloc] init];
+    descriptor.storageMode = MTLStorageModeShared;
+    descriptor.cpuCacheMode = MTLCPUCacheModeDefaultCache;
+    descriptor.hazardTrackingMode = MTLHazardTrackingModeTracked;
+    descriptor.size =
+        std::max(kMinMetalHeapSize, size_and_align.size * max_free_per_size_);
+    id<MTLHeap> heap = [device newHeapWithDescriptor:descriptor];
+    // Shared heaps are not available on all Macs.
+    if (!heap) return nil;
+    heaps.push_back(heap);
+    return [heap newBufferWithLength:bytes options:kMetalBufferOptions];
+  }
+  return nil;
+}
+
+void TensorPool::ReturnMtlBuffer(id<MTLDevice> device, size_t bytes,
+                                 id<MTLBuffer> buffer) {
+  absl::MutexLock lock(&mutex_);
+  auto& buffers = free_metal_buffers_[{(__bridge const void*)device, bytes}];
+  // Otherwise the buffer is released, which frees its memory in the heap.
+  if (static_cast<int>(buffers.size()) < max_free_per_size_) {
+    buffers.push_back(buffer);
+  }
+}
+#endif  // MEDIAPIPE_METAL_ENABLED
+
+}  // namespace mediapipe
@@ -0,0 +1,123 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/tensor.h"
+
+namespace mediapipe {
+
+// Recycles the storage of Tensors. A Tensor obtained from the pool takes its
+// CPU buffer and OpenGL storage buffer from the pool when it first needs them,
+// and returns them to the pool when it is destroyed, instead of allocating and
+// freeing them for every frame. Storages depend only on the size of the
+// tensor, so tensors of any element type and shape with the same size share
+// them. OpenGL buffers are further kept apart by GlContext. AHardwareBuffers
+// and OpenGL textures are not pooled.
+//
+// On Metal, tensors that are first written by a command buffer take their
+// MTLBuffer from the pool. Pooled buffers are suballocated from shared-storage
+// MTLHeaps with hazard tracking, so a recycled buffer is only overwritten by
+// later command buffers once earlier GPU work on it is done.
+//
+// The pool must be owned by a std::shared_ptr, which its tensors share.
+class TensorPool : public std::enable_shared_from_this<TensorPool> {
+ public:
+  // The default number of free storages kept for each size. Storages returned
+  // beyond that are freed.
+  static constexpr int kDefaultMaxFreePerSize = 4;
+
+  explicit TensorPool(int max_free_per_size = kDefaultMaxFreePerSize)
+      : max_free_per_size_(max_free_per_size) {}
+  ~TensorPool();
+
+  TensorPool(const TensorPool&) = delete;
+  TensorPool& operator=(const TensorPool&) = delete;
+
+  // Returns a tensor whose storages come from and go back to this pool.
+  Tensor GetTensor(Tensor::ElementType element_type,
+                   const Tensor::Shape& shape);
+  Tensor GetTensor(
+      Tensor::ElementType element_type, const Tensor::Shape& shape,
+      const Tensor::QuantizationParameters& quantization_parameters);
+
+  // Returns the number of free storages held by the pool.
+  int NumFreeStorages();
+
+  // Frees the free storages held by the pool, e.g. when the system is low on
+  // memory. Storages in use go back to the pool as usual.
+  void FreeUnusedStorages();
+
+ private:
+  friend class Tensor;
+
+  // Returns a free CPU buffer for a tensor of `bytes`, or nullptr.
+  void* TakeCpuBuffer(size_t bytes);
+  // Keeps the CPU buffer of a tensor of `bytes`, or frees it.
+  void ReturnCpuBuffer(size_t bytes, void* buffer);
+
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  // Returns a free OpenGL buffer of `bytes` in `context`, or
+  // GL_INVALID_INDEX.
+  GLuint TakeOpenGlBuffer(const GlContext* context, size_t bytes);
+  // Keeps the OpenGL buffer and returns true, or returns false if the caller
+  // should delete it.
+  bool ReturnOpenGlBuffer(const std::shared_ptr<GlContext>& context,
+                          size_t bytes, GLuint buffer);
+
+  struct FreeOpenGlBuffers {
+    std::shared_ptr<GlContext> context;
+    std::vector<GLuint> buffers;
+  };
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+
+#if MEDIAPIPE_METAL_ENABLED
+  // Returns a free Metal buffer of `bytes` on `device`, allocating it from the
+  // pool's heaps if needed. Returns nil if heaps are not supported.
+  id<MTLBuffer> TakeMtlBuffer(id<MTLDevice> device, size_t bytes);
+  // Keeps the Metal buffer of a tensor of `bytes`, or releases it to its heap.
+  void ReturnMtlBuffer(id<MTLDevice> device, size_t bytes,
+                       id<MTLBuffer> buffer);
+#endif  // MEDIAPIPE_METAL_ENABLED
+
+  const int max_free_per_size_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<size_t, std::vector<void*>> free_cpu_buffers_
+      ABSL_GUARDED_BY(mutex_);
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+  absl::flat_hash_map<std::pair<const GlContext*, size_t>, FreeOpenGlBuffers>
+      free_opengl_buffers_ ABSL_GUARDED_BY(mutex_);
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
+#if MEDIAPIPE_METAL_ENABLED
+  // Keyed by MTLDevice.
+  absl::flat_hash_map<const void*, std::vector<id<MTLHeap>>> metal_heaps_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::pair<const void*, size_t>,
+                      std::vector<id<MTLBuffer>>>
+      free_metal_buffers_ ABSL_GUARDED_BY(mutex_);
+#endif  // MEDIAPIPE_METAL_ENABLED
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
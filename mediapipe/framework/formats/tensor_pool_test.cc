@@ -0,0 +1,89 @@
+#include "mediapipe/framework/formats/tensor_pool.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+
+TEST(TensorPool, RecyclesCpuBuffers) {
+  auto pool = std::make_shared<TensorPool>();
+  void* buffer;
+  {
+    Tensor tensor =
+        pool->GetTensor(Tensor::ElementType::kFloat32, Tensor::Shape{2, 3});
+    buffer = tensor.GetCpuWriteView().buffer<float>();
+    EXPECT_EQ(pool->NumFreeStorages(), 0);
+  }
+  EXPECT_EQ(pool->NumFreeStorages(), 1);
+
+  // A tensor of the same size reuses the buffer, whatever its type and shape.
+  Tensor tensor = pool->GetTensor(Tensor::ElementType::kInt32,
+                                  Tensor::Shape{1, 6});
+  EXPECT_EQ(tensor.GetCpuWriteView().buffer<int32_t>(), buffer);
+  EXPECT_EQ(pool->NumFreeStorages(), 0);
+
+  // A tensor of another size doesn't.
+  Tensor other =
+      pool->GetTensor(Tensor::ElementType::kFloat32, Tensor::Shape{7});
+  EXPECT_NE(other.GetCpuWriteView().buffer<float>(), buffer);
+}
+
+TEST(TensorPool, MovedTensorReturnsBufferOnce) {
+  auto pool = std::make_shared<TensorPool>();
+  {
+    Tensor tensor =
+        pool->GetTensor(Tensor::ElementType::kUInt8, Tensor::Shape{16});
+    tensor.GetCpuWriteView();
+    Tensor moved(std::move(tensor));
+  }
+  EXPECT_EQ(pool->NumFreeStorages(), 1);
+}
+
+TEST(TensorPool, KeepsLimitedFreeBuffers) {
+  auto pool = std::make_shared<TensorPool>(/*max_free_per_size=*/2);
+  {
+    std::vector<Tensor> tensors;
+    for (int i = 0; i < 3; ++i) {
+      tensors.push_back(
+          pool->GetTensor(Tensor::ElementType::kUInt8, Tensor::Shape{16}));
+      tensors.back().GetCpuWriteView();
+    }
+  }
+  EXPECT_EQ(pool->NumFreeStorages(), 2);
+}
+
+TEST(TensorPool, FreesUnusedStorages) {
+  auto pool = std::make_shared<TensorPool>();
+  Tensor in_use =
+      pool->GetTensor(Tensor::ElementType::kUInt8, Tensor::Shape{16});
+  in_use.GetCpuWriteView();
+  {
+    Tensor tensor =
+        pool->GetTensor(Tensor::ElementType::kUInt8, Tensor::Shape{16});
+    tensor.GetCpuWriteView();
+  }
+  EXPECT_EQ(pool->NumFreeStorages(), 1);
+
+  pool->FreeUnusedStorages();
+  EXPECT_EQ(pool->NumFreeStorages(), 0);
+
+  // Storages in use still go back to the pool.
+  in_use = Tensor(Tensor::ElementType::kUInt8, Tensor::Shape{1});
+  EXPECT_EQ(pool->NumFreeStorages(), 1);
+}
+
+TEST(TensorPool, TensorKeepsPoolAlive) {
+  auto pool = std::make_shared<TensorPool>();
+  Tensor tensor =
+      pool->GetTensor(Tensor::ElementType::kUInt8, Tensor::Shape{16});
+  tensor.GetCpuWriteView();
+  // The tensor keeps the pool alive and still returns its buffer to it.
+  pool.reset();
+}
+
+}  // namespace mediapipe
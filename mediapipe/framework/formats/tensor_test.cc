@@ -1,6 +1,7 @@
 #include "mediapipe/framework/formats/tensor.h"
 
 #include <cstring>
+#include <memory>
 #include <string>
 
 #include "mediapipe/framework/port/gmock.h"
@@ -41,6 +42,16 @@ TEST(Cpu, TestMemoryAllocation) {
   EXPECT_NE(f1, nullptr);
 }
 
+TEST(Cpu, TestMemoryAlignment) {
+  for (int size : {1, 3, 17, 1000, 100000}) {
+    Tensor t(Tensor::ElementType::kUInt8, Tensor::Shape{size});
+    auto view = t.GetCpuWriteView();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(view.buffer<uint8_t>()) %
+                  Tensor::kCpuBufferAlignment,
+              0);
+  }
+}
+
 TEST(Cpu, TestTensorMove) {
   Tensor t1(Tensor::ElementType::kFloat32, Tensor::Shape{4, 3, 2, 3});
   void* p1 = t1.GetCpuWriteView().buffer<float>();
@@ -63,6 +74,57 @@ TEST(Cpu, TestViewMove) {
   EXPECT_EQ(v1.buffer<float>(), nullptr);  // NOLINT
 }
 
+TEST(Cpu, TestSliceSharesStorage) {
+  auto parent = std::make_shared<Tensor>(Tensor::ElementType::kFloat32,
+                                         Tensor::Shape{4, 2});
+  {
+    auto view = parent->GetCpuWriteView();
+    for (int i = 0; i < 8; ++i) view.buffer<float>()[i] = i;
+  }
+  auto slice = Tensor::CreateSlice(parent, 1, 3);
+  ASSERT_TRUE(slice.ok());
+  EXPECT_TRUE(slice->is_slice());
+  EXPECT_THAT(slice->shape().dims, testing::ElementsAre(2, 2));
+  EXPECT_EQ(slice->bytes(), 4 * sizeof(float));
+  // Views of a slice hold the view of the parent, so they are taken in turn.
+  const float* parent_data = parent->GetCpuReadView().buffer<float>();
+  EXPECT_EQ(slice->GetCpuReadView().buffer<float>(), parent_data + 2);
+  {
+    auto view = slice->GetCpuWriteView();
+    view.buffer<float>()[3] = 100;
+  }
+  auto view = parent->GetCpuReadView();
+  EXPECT_EQ(view.buffer<float>()[5], 100);
+  EXPECT_EQ(view.buffer<float>()[6], 6);
+}
+
+TEST(Cpu, TestSliceOfSlice) {
+  auto parent = std::make_shared<Tensor>(Tensor::ElementType::kUInt8,
+                                         Tensor::Shape{6, 3});
+  const uint8_t* parent_data = parent->GetCpuWriteView().buffer<uint8_t>();
+  auto slice = Tensor::CreateSlice(parent, 2, 6);
+  ASSERT_TRUE(slice.ok());
+  auto shared_slice = std::make_shared<Tensor>(std::move(slice).value());
+  auto slice_of_slice = Tensor::CreateSlice(shared_slice, 1, 2);
+  ASSERT_TRUE(slice_of_slice.ok());
+  // The slice of a slice refers to the original parent directly.
+  shared_slice.reset();
+  EXPECT_EQ(slice_of_slice->GetCpuReadView().buffer<uint8_t>(),
+            parent_data + 9);
+
+  Tensor whole_slice = Tensor::CreateSlice(parent);
+  EXPECT_EQ(whole_slice.bytes(), parent->bytes());
+  EXPECT_EQ(whole_slice.GetCpuReadView().buffer<uint8_t>(), parent_data);
+}
+
+TEST(Cpu, TestInvalidSlice) {
+  auto parent = std::make_shared<Tensor>(Tensor::ElementType::kFloat32,
+                                         Tensor::Shape{4, 2});
+  EXPECT_FALSE(Tensor::CreateSlice(parent, -1, 2).ok());
+  EXPECT_FALSE(Tensor::CreateSlice(parent, 2, 2).ok());
+  EXPECT_FALSE(Tensor::CreateSlice(parent, 3, 5).ok());
+}
+
 }  // namespace mediapipe
 
 int main(int argc, char** argv) {
@@ -0,0 +1,95 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_GRAPH_METRICS_H_
+#define MEDIAPIPE_FRAMEWORK_GRAPH_METRICS_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// A sample of the runtime metrics of a CalculatorGraph, returned by
+// CalculatorGraph::GetGraphMetrics. Counters accumulate over the runs of the
+// graph, except for the profiler histograms, which are reset whenever the
+// GraphProfiler writes or captures a profile.
+struct GraphMetrics {
+  // The metrics of a calculator node, or of a graph input stream, which is
+  // throttled like a source node.
+  struct Node {
+    // The canonical node name, or the name of the graph input stream.
+    std::string name;
+    bool is_graph_input_stream = false;
+    // The Process() runtime and input latency histograms of the node. Only
+    // populated if ProfilerConfig.enable_profiler is set, and the latency
+    // only if ProfilerConfig.enable_stream_latency is set as well.
+    TimeHistogram process_runtime;
+    TimeHistogram process_input_latency;
+    // Whether a full input stream currently throttles the node, how many
+    // times it has become throttled, and for how long in total. Only source
+    // nodes and graph input streams are throttled.
+    bool is_throttled = false;
+    int64 throttle_count = 0;
+    absl::Duration throttled_time;
+  };
+
+  // The metrics of the input stream of a calculator node.
+  struct InputStream {
+    std::string node_name;
+    std::string stream_name;
+    // The number of packets queued, and the queue size limit, or -1 if the
+    // queue is unbounded.
+    int queue_size = 0;
+    int max_queue_size = -1;
+    // The number of packets added to the stream during the current run.
+    int64 packets_added = 0;
+    // The estimated bytes held by the queued packets, and the peaks of the
+    // queue size and bytes during the current run. Only populated if
+    // ProfilerConfig.enable_stream_memory_accounting is set.
+    bool has_memory_accounting = false;
+    int64 queued_bytes = 0;
+    int peak_queue_size = 0;
+    int64 peak_queued_bytes = 0;
+    // The byte budget of the stream, or -1 if it has none, see
+    // InputStreamInfo.max_queue_bytes.
+    int64 max_queue_bytes = -1;
+  };
+
+  absl::Time sample_time;
+  std::vector<Node> nodes;
+  std::vector<InputStream> input_streams;
+
+  // The estimated bytes queued in all the input streams, and their budget,
+  // if CalculatorGraphConfig.max_queue_bytes is set. Otherwise -1.
+  int64 queued_bytes = -1;
+  int64 max_queue_bytes = -1;
+};
+
+// Receives GraphMetrics samples, e.g. to publish them to a monitoring system.
+// See GraphMetricsSampler for periodic sampling.
+class GraphMetricsExporter {
+ public:
+  virtual ~GraphMetricsExporter() = default;
+
+  // Publishes a sample. Calls are not concurrent.
+  virtual void Export(const GraphMetrics& metrics) = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_GRAPH_METRICS_H_
@@ -0,0 +1,67 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/graph_metrics_sampler.h"
+
+#include <memory>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/graph_metrics.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+GraphMetricsSampler::GraphMetricsSampler(CalculatorGraph* graph,
+                                         GraphMetricsExporter* exporter,
+                                         absl::Duration interval)
+    : graph_(graph), exporter_(exporter), interval_(interval) {
+  thread_ = std::make_unique<ThreadPool>("mediapipe_metrics", 1);
+  thread_->StartWorkers();
+  thread_->Schedule([this] { SampleUntilStopped(); });
+}
+
+GraphMetricsSampler::~GraphMetricsSampler() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+  }
+  // Joins the sampling thread.
+  thread_.reset();
+}
+
+absl::Status GraphMetricsSampler::SampleOnce() {
+  GraphMetrics metrics;
+  absl::MutexLock lock(&sample_mutex_);
+  MP_RETURN_IF_ERROR(graph_->GetGraphMetrics(&metrics));
+  exporter_->Export(metrics);
+  return absl::OkStatus();
+}
+
+void GraphMetricsSampler::SampleUntilStopped() {
+  absl::MutexLock lock(&mutex_);
+  while (!mutex_.AwaitWithTimeout(absl::Condition(&stopped_), interval_)) {
+    mutex_.Unlock();
+    absl::Status status = SampleOnce();
+    if (!status.ok()) {
+      LOG_EVERY_N(WARNING, 100) << "Failed to sample graph metrics: " << status;
+    }
+    mutex_.Lock();
+  }
+}
+
+}  // namespace mediapipe
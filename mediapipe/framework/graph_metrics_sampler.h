@@ -0,0 +1,68 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_GRAPH_METRICS_SAMPLER_H_
+#define MEDIAPIPE_FRAMEWORK_GRAPH_METRICS_SAMPLER_H_
+
+#include <memory>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/graph_metrics.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// Periodically samples the GraphMetrics of a CalculatorGraph on a background
+// thread and passes them to a GraphMetricsExporter. Sampling locks only the
+// stream queues and the throttling state briefly, so it can run alongside the
+// graph. The graph and the exporter must outlive the sampler.
+//
+// Example:
+//   PrometheusExporter exporter;
+//   GraphMetricsSampler sampler(&graph, &exporter, absl::Seconds(1));
+//   ...  // Serve exporter.Scrape() on the application's /metrics endpoint.
+class GraphMetricsSampler {
+ public:
+  GraphMetricsSampler(CalculatorGraph* graph, GraphMetricsExporter* exporter,
+                      absl::Duration interval);
+
+  // Stops sampling, waiting for a sample in progress.
+  ~GraphMetricsSampler();
+
+  // Takes and exports a sample right away, e.g. after the graph is done.
+  absl::Status SampleOnce() ABSL_LOCKS_EXCLUDED(sample_mutex_);
+
+ private:
+  void SampleUntilStopped() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  CalculatorGraph* const graph_;
+  GraphMetricsExporter* const exporter_;
+  const absl::Duration interval_;
+
+  // Serializes the calls to the exporter.
+  absl::Mutex sample_mutex_;
+
+  absl::Mutex mutex_;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // Runs SampleUntilStopped. Declared last, so that it is destroyed first.
+  std::unique_ptr<ThreadPool> thread_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_GRAPH_METRICS_SAMPLER_H_
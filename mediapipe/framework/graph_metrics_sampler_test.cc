@@ -0,0 +1,163 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/graph_metrics_sampler.h"
+
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/graph_metrics.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+absl::Notification* process_started;
+absl::Notification* unblock_process;
+
+// Blocks in Process() until unblock_process is notified.
+class BlockingCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    if (!process_started->HasBeenNotified()) process_started->Notify();
+    unblock_process->WaitForNotification();
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(BlockingCalculator);
+
+// Keeps the exported samples.
+class RecordingExporter : public GraphMetricsExporter {
+ public:
+  void Export(const GraphMetrics& metrics) override {
+    absl::MutexLock lock(&mutex_);
+    samples_.push_back(metrics);
+  }
+
+  std::vector<GraphMetrics> samples() {
+    absl::MutexLock lock(&mutex_);
+    return samples_;
+  }
+
+  void AwaitSamples(int count) {
+    auto has_samples = [this, count]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+      return samples_.size() >= count;
+    };
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(&has_samples));
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<GraphMetrics> samples_ ABSL_GUARDED_BY(mutex_);
+};
+
+class GraphMetricsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    process_started = new absl::Notification;
+    unblock_process = new absl::Notification;
+    MP_ASSERT_OK(graph_.Initialize(ParseTextProtoOrDie<CalculatorGraphConfig>(
+        R"pb(
+          input_stream: "in"
+          max_queue_size: 1
+          node {
+            calculator: "BlockingCalculator"
+            input_stream: "in"
+          }
+        )pb")));
+    graph_.SetGraphInputStreamAddMode(
+        CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+  }
+
+  void TearDown() override {
+    delete process_started;
+    delete unblock_process;
+  }
+
+  CalculatorGraph graph_;
+};
+
+TEST_F(GraphMetricsTest, ReportsQueuesAndThrottling) {
+  MP_ASSERT_OK(graph_.StartRun({}));
+  MP_ASSERT_OK(graph_.AddPacketToInputStream(
+      "in", MakePacket<int>(1).At(Timestamp(1))));
+  process_started->WaitForNotification();
+  // Fills the queue of the blocked calculator, which throttles "in".
+  MP_ASSERT_OK(graph_.AddPacketToInputStream(
+      "in", MakePacket<int>(2).At(Timestamp(2))));
+
+  GraphMetrics metrics;
+  MP_ASSERT_OK(graph_.GetGraphMetrics(&metrics));
+  ASSERT_EQ(metrics.nodes.size(), 2);
+  EXPECT_EQ(metrics.nodes[0].name, "BlockingCalculator");
+  EXPECT_FALSE(metrics.nodes[0].is_graph_input_stream);
+  EXPECT_FALSE(metrics.nodes[0].is_throttled);
+  EXPECT_EQ(metrics.nodes[1].name, "in");
+  EXPECT_TRUE(metrics.nodes[1].is_graph_input_stream);
+  EXPECT_TRUE(metrics.nodes[1].is_throttled);
+  EXPECT_EQ(metrics.nodes[1].throttle_count, 1);
+  ASSERT_EQ(metrics.input_streams.size(), 1);
+  EXPECT_EQ(metrics.input_streams[0].node_name, "BlockingCalculator");
+  EXPECT_EQ(metrics.input_streams[0].stream_name, "in");
+  EXPECT_EQ(metrics.input_streams[0].queue_size, 1);
+  EXPECT_EQ(metrics.input_streams[0].max_queue_size, 1);
+  EXPECT_EQ(metrics.input_streams[0].packets_added, 2);
+
+  unblock_process->Notify();
+  MP_ASSERT_OK(graph_.CloseAllInputStreams());
+  MP_ASSERT_OK(graph_.WaitUntilDone());
+
+  GraphMetrics done;
+  MP_ASSERT_OK(graph_.GetGraphMetrics(&done));
+  EXPECT_FALSE(done.nodes[1].is_throttled);
+  EXPECT_EQ(done.nodes[1].throttle_count, 1);
+  EXPECT_GT(done.nodes[1].throttled_time, absl::ZeroDuration());
+  EXPECT_EQ(done.input_streams[0].queue_size, 0);
+}
+
+TEST_F(GraphMetricsTest, SamplerExportsPeriodically) {
+  RecordingExporter exporter;
+  {
+    GraphMetricsSampler sampler(&graph_, &exporter, absl::Milliseconds(1));
+    exporter.AwaitSamples(2);
+    MP_ASSERT_OK(sampler.SampleOnce());
+  }
+  std::vector<GraphMetrics> samples = exporter.samples();
+  ASSERT_GE(samples.size(), 3);
+  EXPECT_EQ(samples.back().nodes.size(), 2);
+  EXPECT_LE(samples.front().sample_time, samples.back().sample_time);
+}
+
+TEST(GraphMetricsSamplerTest, FailsForUninitializedGraph) {
+  CalculatorGraph graph;
+  RecordingExporter exporter;
+  GraphMetricsSampler sampler(&graph, &exporter, absl::Hours(1));
+  EXPECT_FALSE(sampler.SampleOnce().ok());
+  EXPECT_TRUE(exporter.samples().empty());
+}
+
+}  // namespace
+}  // namespace mediapipe
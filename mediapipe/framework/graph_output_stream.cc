@@ -221,5 +221,49 @@ bool OutputStreamPollerImpl::Next(Packet* packet) {
   return true;
 }
 
+bool OutputStreamPollerImpl::NextBatch(std::vector<Packet>* packets,
+                                       int max_packets,
+                                       absl::Duration timeout) {
+  CHECK(packets);
+  CHECK_GT(max_packets, 0);
+  packets->clear();
+  const absl::Time deadline = absl::Now() + timeout;
+  bool empty_queue = true;
+  Timestamp min_timestamp = Timestamp::Unset();
+  mutex_.Lock();
+  while (packets->size() < max_packets) {
+    min_timestamp = input_stream_->MinTimestampOrBound(&empty_queue);
+    if (!empty_queue) {
+      output_timestamp_ = min_timestamp;
+      mutex_.Unlock();
+      int num_packets_dropped = 0;
+      bool stream_is_done = false;
+      packets->push_back(input_stream_->PopPacketAtTimestamp(
+          min_timestamp, &num_packets_dropped, &stream_is_done));
+      CHECK_EQ(num_packets_dropped, 0)
+          << absl::Substitute("Dropped $0 packet(s) on input stream \"$1\".",
+                              num_packets_dropped, input_stream_->Name());
+      mutex_.Lock();
+      continue;
+    }
+    if (input_stream_handler_->ProcessTimestampBounds() &&
+        output_timestamp_ < min_timestamp.PreviousAllowedInStream()) {
+      output_timestamp_ = min_timestamp.PreviousAllowedInStream();
+      packets->push_back(Packet().At(output_timestamp_));
+      continue;
+    }
+    // Only waits if nothing has been taken yet.
+    if (!packets->empty() || graph_has_error_ ||
+        min_timestamp == Timestamp::Done() ||
+        handler_condvar_.WaitWithDeadline(&mutex_, deadline)) {
+      break;
+    }
+  }
+  const bool stream_is_done =
+      graph_has_error_ || min_timestamp == Timestamp::Done();
+  mutex_.Unlock();
+  return !packets->empty() || !stream_is_done;
+}
+
 }  // namespace internal
 }  // namespace mediapipe
@@ -24,6 +24,7 @@
 #include "absl/base/thread_annotations.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/input_stream_handler.h"
 #include "mediapipe/framework/input_stream_manager.h"
 #include "mediapipe/framework/output_stream_manager.h"
@@ -167,6 +168,13 @@ class OutputStreamPollerImpl : public GraphOutputStream {
   // done).  Returns true if successful.
   ABSL_MUST_USE_RESULT bool Next(Packet* packet);
 
+  // Gets up to `max_packets` packets that are available, waiting until there
+  // is at least one, the stream is done, or `timeout` expires. All the packets
+  // are taken with a single wakeup. Returns false if the stream is done and no
+  // packets are returned, and true with no packets on timeout.
+  ABSL_MUST_USE_RESULT bool NextBatch(std::vector<Packet>* packets,
+                                      int max_packets, absl::Duration timeout);
+
  private:
   absl::Mutex mutex_;
   absl::CondVar handler_condvar_ ABSL_GUARDED_BY(mutex_);
@@ -0,0 +1,126 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/graph_pool.h"
+
+#include <deque>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/thread_pool_executor.h"
+#include "mediapipe/util/cpu_util.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Queues the tasks of one graph in a shared executor. At most `max_tasks`
+// tasks are queued on or running in the shared executor; when one of them
+// completes, the next task of the graph is queued at the back of the shared
+// executor, behind the tasks of the other graphs.
+class GraphExecutor : public Executor,
+                      public std::enable_shared_from_this<GraphExecutor> {
+ public:
+  GraphExecutor(std::shared_ptr<Executor> executor, int max_tasks)
+      : executor_(std::move(executor)), max_tasks_(max_tasks) {}
+
+  void Schedule(std::function<void()> task) override {
+    {
+      absl::MutexLock lock(&mutex_);
+      tasks_.push_back(std::move(task));
+      if (num_scheduled_ >= max_tasks_) return;
+      ++num_scheduled_;
+    }
+    ScheduleNext();
+  }
+
+ private:
+  void ScheduleNext() {
+    executor_->Schedule([self = shared_from_this()] { self->RunNext(); });
+  }
+
+  void RunNext() {
+    std::function<void()> task;
+    {
+      absl::MutexLock lock(&mutex_);
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+    {
+      absl::MutexLock lock(&mutex_);
+      // The other scheduled runs take the first tasks, the rest are waiting
+      // for this run to complete.
+      if (static_cast<int>(tasks_.size()) < num_scheduled_) {
+        --num_scheduled_;
+        return;
+      }
+    }
+    ScheduleNext();
+  }
+
+  std::shared_ptr<Executor> executor_;
+  const int max_tasks_;
+  absl::Mutex mutex_;
+  std::deque<std::function<void()>> tasks_ ABSL_GUARDED_BY(mutex_);
+  // The number of RunNext() calls queued on or running in executor_.
+  int num_scheduled_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<GraphPool>> GraphPool::Create(
+    const Options& options) {
+  RET_CHECK_GE(options.num_threads, 0);
+  RET_CHECK_GE(options.max_tasks_per_graph, 0);
+  const int num_threads =
+      options.num_threads > 0 ? options.num_threads : NumCPUCores();
+  return std::make_unique<GraphPool>(
+      std::make_shared<ThreadPoolExecutor>(num_threads),
+      options.max_tasks_per_graph);
+}
+
+GraphPool::GraphPool(std::shared_ptr<Executor> executor,
+                     int max_tasks_per_graph)
+    : executor_(std::move(executor)),
+      max_tasks_per_graph_(max_tasks_per_graph > 0
+                               ? max_tasks_per_graph
+                               : std::numeric_limits<int>::max()),
+      shared_resources_(std::make_shared<SharedGraphResources>()) {}
+
+std::shared_ptr<Executor> GraphPool::CreateGraphExecutor() {
+  return std::make_shared<GraphExecutor>(executor_, max_tasks_per_graph_);
+}
+
+absl::StatusOr<std::unique_ptr<CalculatorGraph>> GraphPool::CreateGraph(
+    const CalculatorGraphConfig& config,
+    const std::map<std::string, Packet>& side_packets) {
+  auto graph = std::make_unique<CalculatorGraph>();
+  MP_RETURN_IF_ERROR(graph->SetExecutor("", CreateGraphExecutor()));
+#if !MEDIAPIPE_DISABLE_GPU
+  if (gpu_resources_) {
+    MP_RETURN_IF_ERROR(graph->SetGpuResources(gpu_resources_));
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  MP_RETURN_IF_ERROR(graph->Initialize(config, side_packets));
+  MP_RETURN_IF_ERROR(graph->SetServiceObject(kSharedGraphResourcesService,
+                                             shared_resources_));
+  return graph;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,99 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_GRAPH_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_GRAPH_POOL_H_
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/shared_graph_resources.h"
+
+namespace mediapipe {
+
+// Runs many graph instances, e.g. one per camera stream, on one set of
+// threads instead of a default thread pool per graph.
+//
+// The graphs created by a GraphPool share its executor as their default
+// executor, its SharedGraphResources, and its GpuResources if any. Each graph
+// has at most max_tasks_per_graph tasks queued on or running in the shared
+// executor; its other tasks wait in the graph's own queue and are queued
+// behind the other graphs' tasks as its tasks complete, so a busy graph can't
+// starve the others.
+//
+//   GraphPool::Options options;
+//   options.num_threads = 8;
+//   ASSIGN_OR_RETURN(auto pool, GraphPool::Create(options));
+//   for (int i = 0; i < num_streams; ++i) {
+//     ASSIGN_OR_RETURN(graphs[i], pool->CreateGraph(config));
+//     MP_RETURN_IF_ERROR(graphs[i]->StartRun({}));
+//   }
+//
+// Executors named in the config are still created per graph.
+class GraphPool {
+ public:
+  struct Options {
+    // The number of threads of the shared executor. 0 uses the number of
+    // CPU cores.
+    int num_threads = 0;
+    // The maximum number of tasks of a graph in the shared executor at any
+    // time. 0 means no limit.
+    int max_tasks_per_graph = 2;
+  };
+
+  // Creates a pool running on a new thread pool.
+  static absl::StatusOr<std::unique_ptr<GraphPool>> Create(
+      const Options& options);
+
+  // Creates a pool running on an existing executor.
+  GraphPool(std::shared_ptr<Executor> executor, int max_tasks_per_graph);
+
+  // Returns a new graph initialized with the config and set up to use the
+  // shared executor and resources. The graph may outlive the pool.
+  absl::StatusOr<std::unique_ptr<CalculatorGraph>> CreateGraph(
+      const CalculatorGraphConfig& config,
+      const std::map<std::string, Packet>& side_packets = {});
+
+  // Returns a new executor that queues tasks in the shared executor with the
+  // pool's per-graph limit, for graphs set up by the caller.
+  std::shared_ptr<Executor> CreateGraphExecutor();
+
+#if !MEDIAPIPE_DISABLE_GPU
+  // Sets the GpuResources given to the graphs created afterwards.
+  void SetGpuResources(std::shared_ptr<GpuResources> resources) {
+    gpu_resources_ = std::move(resources);
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
+  const std::shared_ptr<SharedGraphResources>& shared_resources() const {
+    return shared_resources_;
+  }
+
+ private:
+  std::shared_ptr<Executor> executor_;
+  int max_tasks_per_graph_;
+  std::shared_ptr<SharedGraphResources> shared_resources_;
+#if !MEDIAPIPE_DISABLE_GPU
+  std::shared_ptr<GpuResources> gpu_resources_;
+#endif  // !MEDIAPIPE_DISABLE_GPU
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_GRAPH_POOL_H_
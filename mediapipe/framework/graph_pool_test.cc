@@ -0,0 +1,138 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/graph_pool.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Queues tasks until the test runs them.
+class ManualExecutor : public Executor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    tasks_.push_back(std::move(task));
+  }
+
+  bool RunNext() {
+    if (tasks_.empty()) return false;
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    task();
+    return true;
+  }
+
+  int size() const { return tasks_.size(); }
+
+ private:
+  std::deque<std::function<void()>> tasks_;
+};
+
+TEST(GraphPoolTest, LimitsQueuedTasksPerGraph) {
+  auto executor = std::make_shared<ManualExecutor>();
+  GraphPool pool(executor, /*max_tasks_per_graph=*/2);
+  auto graph_executor = pool.CreateGraphExecutor();
+  int num_runs = 0;
+  for (int i = 0; i < 5; ++i) {
+    graph_executor->Schedule([&num_runs] { ++num_runs; });
+  }
+  EXPECT_EQ(executor->size(), 2);
+  while (executor->RunNext()) {
+    EXPECT_LE(executor->size(), 2);
+  }
+  EXPECT_EQ(num_runs, 5);
+}
+
+TEST(GraphPoolTest, AlternatesBetweenGraphs) {
+  auto executor = std::make_shared<ManualExecutor>();
+  GraphPool pool(executor, /*max_tasks_per_graph=*/1);
+  auto executor_a = pool.CreateGraphExecutor();
+  auto executor_b = pool.CreateGraphExecutor();
+  std::vector<std::string> runs;
+  for (int i = 0; i < 3; ++i) {
+    executor_a->Schedule([&runs] { runs.push_back("a"); });
+  }
+  for (int i = 0; i < 2; ++i) {
+    executor_b->Schedule([&runs] { runs.push_back("b"); });
+  }
+  while (executor->RunNext()) {
+  }
+  EXPECT_THAT(runs, ElementsAre("a", "b", "a", "b", "a"));
+}
+
+TEST(GraphPoolTest, RunsGraphsOnSharedExecutor) {
+  GraphPool::Options options;
+  options.num_threads = 2;
+  MP_ASSERT_OK_AND_ASSIGN(auto pool, GraphPool::Create(options));
+  const auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    output_stream: "out"
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "in"
+      output_stream: "mid"
+    }
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "mid"
+      output_stream: "out"
+    }
+  )pb");
+  constexpr int kNumGraphs = 8;
+  constexpr int kNumPackets = 10;
+  std::vector<std::unique_ptr<CalculatorGraph>> graphs;
+  std::vector<std::vector<Packet>> outputs(kNumGraphs);
+  for (int i = 0; i < kNumGraphs; ++i) {
+    MP_ASSERT_OK_AND_ASSIGN(auto graph, pool->CreateGraph(config));
+    MP_ASSERT_OK(
+        graph->ObserveOutputStream("out", [&outputs, i](const Packet& packet) {
+          outputs[i].push_back(packet);
+          return absl::OkStatus();
+        }));
+    MP_ASSERT_OK(graph->StartRun({}));
+    graphs.push_back(std::move(graph));
+  }
+  for (int t = 0; t < kNumPackets; ++t) {
+    for (auto& graph : graphs) {
+      MP_ASSERT_OK(graph->AddPacketToInputStream(
+          "in", MakePacket<int>(t).At(Timestamp(t))));
+    }
+  }
+  for (auto& graph : graphs) {
+    MP_ASSERT_OK(graph->CloseAllInputStreams());
+    MP_ASSERT_OK(graph->WaitUntilDone());
+  }
+  for (const auto& packets : outputs) {
+    ASSERT_EQ(packets.size(), kNumPackets);
+    for (int t = 0; t < kNumPackets; ++t) {
+      EXPECT_EQ(packets[t].Get<int>(), t);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
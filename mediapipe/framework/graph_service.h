@@ -108,6 +108,9 @@ class ServiceBinding {
  public:
   bool IsAvailable() { return service_ != nullptr; }
   T& GetObject() { return *service_; }
+  // Returns the object shared with the graph, e.g. to provide the same
+  // service to a graph run by the calculator.
+  std::shared_ptr<T> GetSharedObject() { return service_; }
 
   ServiceBinding() {}
   explicit ServiceBinding(std::shared_ptr<T> service) : service_(service) {}
@@ -0,0 +1,54 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/image_frame_pool_service.h"
+
+#include <memory>
+
+namespace mediapipe {
+
+const GraphService<ImageFrameMultiPool> kImageFrameMultiPoolService(
+    "kImageFrameMultiPoolService",
+    GraphServiceBase::kAllowDefaultInitialization);
+
+void UseImageFrameMultiPool(CalculatorContract* cc) {
+  cc->UseService(kImageFrameMultiPoolService).Optional();
+}
+
+std::unique_ptr<ImageFrame> AllocateImageFrame(CalculatorContext* cc,
+                                               ImageFormat::Format format,
+                                               int width, int height,
+                                               int alignment_boundary) {
+  auto pool = cc->Service(kImageFrameMultiPoolService);
+  if (!pool.IsAvailable()) {
+    return std::make_unique<ImageFrame>(format, width, height,
+                                        alignment_boundary);
+  }
+  return pool.GetObject().GetUniqueBuffer(width, height, format,
+                                          alignment_boundary);
+}
+
+ImageFrameSharedPtr AllocateSharedImageFrame(CalculatorContext* cc,
+                                             ImageFormat::Format format,
+                                             int width, int height,
+                                             int alignment_boundary) {
+  auto pool = cc->Service(kImageFrameMultiPoolService);
+  if (!pool.IsAvailable()) {
+    return std::make_shared<ImageFrame>(format, width, height,
+                                        alignment_boundary);
+  }
+  return pool.GetObject().GetBuffer(width, height, format, alignment_boundary);
+}
+
+}  // namespace mediapipe
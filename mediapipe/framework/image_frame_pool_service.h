@@ -0,0 +1,52 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_IMAGE_FRAME_POOL_SERVICE_H_
+#define MEDIAPIPE_FRAMEWORK_IMAGE_FRAME_POOL_SERVICE_H_
+
+#include <memory>
+
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/calculator_contract.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_multi_pool.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+
+// A pool of ImageFrames shared by the calculators of a graph. It is created
+// with the graph unless the application provides one with SetServiceObject.
+extern const GraphService<ImageFrameMultiPool> kImageFrameMultiPoolService;
+
+// Requests kImageFrameMultiPoolService. Call from GetContract in calculators
+// that allocate their output frames with the functions below.
+void UseImageFrameMultiPool(CalculatorContract* cc);
+
+// Returns a frame for a calculator to fill. It comes from the graph's pool if
+// the calculator requested it, and is allocated anew otherwise. As with the
+// ImageFrame constructor, the pixels are not initialized.
+std::unique_ptr<ImageFrame> AllocateImageFrame(
+    CalculatorContext* cc, ImageFormat::Format format, int width, int height,
+    int alignment_boundary = ImageFrame::kDefaultAlignmentBoundary);
+
+// Like AllocateImageFrame(), but returns a frame that can be wrapped in an
+// Image.
+ImageFrameSharedPtr AllocateSharedImageFrame(
+    CalculatorContext* cc, ImageFormat::Format format, int width, int height,
+    int alignment_boundary = ImageFrame::kDefaultAlignmentBoundary);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_IMAGE_FRAME_POOL_SERVICE_H_
@@ -14,6 +14,8 @@
 
 #include "mediapipe/framework/input_stream_handler.h"
 
+#include <algorithm>
+
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "mediapipe/framework/collection_item_id.h"
@@ -23,6 +25,10 @@
 namespace mediapipe {
 using SyncSet = InputStreamHandler::SyncSet;
 
+// Sync sets with at least this many streams track readiness incrementally.
+// Scanning is cheaper for narrower ones.
+constexpr int kMinIncrementalSyncSetSize = 8;
+
 absl::Status InputStreamHandler::InitializeInputStreamManagers(
     InputStreamManager* flat_input_stream_managers) {
   for (CollectionItemId id = input_stream_managers_.BeginId();
@@ -184,10 +190,18 @@ bool InputStreamHandler::ScheduleInvocations(int max_allowance,
       CalculatorContext* calculator_context =
           calculator_context_manager_->PrepareCalculatorContext(
               min_stream_timestamp);
+      if (!calculator_context_manager_->ContextHasInputTimestamp(
+              *calculator_context)) {
+        // A batch is due by the deadline of its first timestamp.
+        calculator_context->SetDeadline(Deadline(min_stream_timestamp));
+      }
       calculator_context_manager_->PushInputTimestampToContext(
           calculator_context, min_stream_timestamp);
       if (!late_preparation_) {
         FillInputSet(min_stream_timestamp, &calculator_context->Inputs());
+        if (max_process_batch_size_ > 1) {
+          FillInputBatch(min_stream_timestamp, calculator_context);
+        }
       }
       if (calculator_context_manager_->NumberOfContextTimestamps(
               *calculator_context) == batch_size_) {
@@ -224,6 +238,23 @@ bool InputStreamHandler::ScheduleInvocations(int max_allowance,
   return invocations_scheduled > 0;
 }
 
+void InputStreamHandler::FillInputBatch(Timestamp input_timestamp,
+                                        CalculatorContext* calculator_context) {
+  calculator_context->AddToInputBatch(input_timestamp,
+                                      calculator_context->Inputs());
+  const auto& batch_timestamps = calculator_context->InputBatchTimestamps();
+  InputStreamShardSet input_set(InputTagMap());
+  Timestamp timestamp;
+  while (static_cast<int>(batch_timestamps.size()) < max_process_batch_size_ &&
+         GetNodeReadiness(&timestamp) == NodeReadiness::kReadyForProcess) {
+    FillInputSet(timestamp, &input_set);
+    calculator_context->AddToInputBatch(timestamp, input_set);
+    for (auto& input : input_set) {
+      input.ClearCurrentPacket();
+    }
+  }
+}
+
 void InputStreamHandler::FinalizeInputSet(Timestamp timestamp,
                                           InputStreamShardSet* input_set) {
   if (late_preparation_) {
@@ -267,8 +298,9 @@ void InputStreamHandler::AddPackets(CollectionItemId id,
   if (!result.ok()) {
     error_callback_(result);
   }
+  InputStreamChanged(id);
   if (notify) {
-    notification_();
+    Notify();
   }
 }
 
@@ -282,8 +314,9 @@ void InputStreamHandler::MovePackets(CollectionItemId id,
   if (!result.ok()) {
     error_callback_(result);
   }
+  InputStreamChanged(id);
   if (notify) {
-    notification_();
+    Notify();
   }
 }
 
@@ -295,8 +328,36 @@ void InputStreamHandler::SetNextTimestampBound(CollectionItemId id,
   if (!result.ok()) {
     error_callback_(result);
   }
+  InputStreamChanged(id);
   if (notify) {
+    Notify();
+  }
+}
+
+thread_local InputStreamHandler::BatchedNotifications*
+    InputStreamHandler::BatchedNotifications::current_ = nullptr;
+
+InputStreamHandler::BatchedNotifications::BatchedNotifications()
+    : saved_(current_) {
+  current_ = this;
+}
+
+InputStreamHandler::BatchedNotifications::~BatchedNotifications() {
+  current_ = saved_;
+  for (InputStreamHandler* handler : handlers_) {
+    handler->notification_();
+  }
+}
+
+void InputStreamHandler::Notify() {
+  BatchedNotifications* batch = BatchedNotifications::current_;
+  if (batch == nullptr) {
     notification_();
+    return;
+  }
+  if (std::find(batch->handlers_.begin(), batch->handlers_.end(), this) ==
+      batch->handlers_.end()) {
+    batch->handlers_.push_back(this);
   }
 }
 
@@ -308,11 +369,14 @@ void InputStreamHandler::ClearCurrentInputs(
     // Invokes InputStreamShard's private method to clear packet.
     input.ClearCurrentPacket();
   }
+  calculator_context->ClearInputBatch();
 }
 
 void InputStreamHandler::Close() {
-  for (auto& stream : input_stream_managers_) {
-    stream->Close();
+  for (CollectionItemId id = input_stream_managers_.BeginId();
+       id < input_stream_managers_.EndId(); ++id) {
+    input_stream_managers_.Get(id)->Close();
+    InputStreamChanged(id);
   }
 }
 
@@ -327,6 +391,18 @@ void InputStreamHandler::SetBatchSize(int batch_size) {
   batch_size_ = batch_size;
 }
 
+void InputStreamHandler::SetMaxProcessBatchSize(int max_process_batch_size) {
+  CHECK(!calculator_run_in_parallel_ || max_process_batch_size == 1)
+      << "Batching cannot be combined with parallel execution.";
+  CHECK(!late_preparation_ || max_process_batch_size == 1)
+      << "Batching cannot be combined with late preparation.";
+  CHECK(batch_size_ == 1 || max_process_batch_size == 1)
+      << "Batching into Process() cannot be combined with batch_size.";
+  CHECK_GE(max_process_batch_size, 1)
+      << "Batch size has to be greater than or equal to 1.";
+  max_process_batch_size_ = max_process_batch_size;
+}
+
 void InputStreamHandler::SetLatePreparation(bool late_preparation) {
   CHECK(batch_size_ == 1 || !late_preparation_)
       << "Batching cannot be combined with late preparation.";
@@ -336,23 +412,114 @@ void InputStreamHandler::SetLatePreparation(bool late_preparation) {
 SyncSet::SyncSet(InputStreamHandler* input_stream_handler,
                  std::vector<CollectionItemId> stream_ids)
     : input_stream_handler_(input_stream_handler),
-      stream_ids_(std::move(stream_ids)) {}
+      stream_ids_(std::move(stream_ids)),
+      incremental_(stream_ids_.size() >= kMinIncrementalSyncSetSize),
+      mutex_(std::make_unique<absl::Mutex>()) {
+  if (!incremental_) {
+    return;
+  }
+  for (int i = 0; i < stream_ids_.size(); ++i) {
+    const int id = stream_ids_[i].value();
+    if (id >= stream_indexes_.size()) {
+      stream_indexes_.resize(id + 1, -1);
+    }
+    stream_indexes_[id] = i;
+  }
+  stream_states_.resize(stream_ids_.size());
+  MarkAllStreamsChanged();
+}
 
-void SyncSet::PrepareForRun() { last_processed_ts_ = Timestamp::Unset(); }
+void SyncSet::PrepareForRun() {
+  last_processed_ts_ = Timestamp::Unset();
+  MarkAllStreamsChanged();
+}
 
-NodeReadiness SyncSet::GetReadiness(Timestamp* min_stream_timestamp) {
-  Timestamp min_bound = Timestamp::Done();
-  Timestamp min_packet = Timestamp::Done();
-  for (CollectionItemId id : stream_ids_) {
-    const auto& stream = input_stream_handler_->input_stream_managers_.Get(id);
-    bool empty;
-    Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
-    if (empty) {
-      min_bound = std::min(min_bound, stream_timestamp);
-    } else {
-      min_packet = std::min(min_packet, stream_timestamp);
+void SyncSet::MarkStreamChanged(CollectionItemId id) {
+  if (!incremental_ || id.value() >= stream_indexes_.size()) {
+    return;
+  }
+  const int index = stream_indexes_[id.value()];
+  if (index < 0) {
+    return;
+  }
+  absl::MutexLock lock(mutex_.get());
+  if (!stream_states_[index].changed) {
+    stream_states_[index].changed = true;
+    changed_streams_.push_back(index);
+  }
+}
+
+void SyncSet::MarkAllStreamsChanged() {
+  if (!incremental_) {
+    return;
+  }
+  absl::MutexLock lock(mutex_.get());
+  for (int i = 0; i < stream_states_.size(); ++i) {
+    if (!stream_states_[i].changed) {
+      stream_states_[i].changed = true;
+      changed_streams_.push_back(i);
+    }
+  }
+}
+
+void SyncSet::UpdateStreamState(int index) {
+  const auto& stream =
+      input_stream_handler_->input_stream_managers_.Get(stream_ids_[index]);
+  bool empty;
+  Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
+  StreamState& state = stream_states_[index];
+  if (state.tracked && state.empty == empty &&
+      state.timestamp == stream_timestamp) {
+    return;
+  }
+  if (state.tracked) {
+    (state.empty ? bounds_ : packets_).erase({state.timestamp, index});
+  }
+  (empty ? bounds_ : packets_).insert({stream_timestamp, index});
+  state.timestamp = stream_timestamp;
+  state.empty = empty;
+  state.tracked = true;
+}
+
+void SyncSet::GetMinTimestamps(Timestamp* min_bound, Timestamp* min_packet) {
+  *min_bound = Timestamp::Done();
+  *min_packet = Timestamp::Done();
+  if (!incremental_) {
+    for (CollectionItemId id : stream_ids_) {
+      const auto& stream =
+          input_stream_handler_->input_stream_managers_.Get(id);
+      bool empty;
+      Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
+      if (empty) {
+        *min_bound = std::min(*min_bound, stream_timestamp);
+      } else {
+        *min_packet = std::min(*min_packet, stream_timestamp);
+      }
     }
+    return;
   }
+  // A stream changed concurrently is marked again, and the notification that
+  // follows triggers another readiness check.
+  std::vector<int> changed_streams;
+  changed_streams.swap(changed_streams_);
+  for (int index : changed_streams) {
+    stream_states_[index].changed = false;
+    UpdateStreamState(index);
+  }
+  if (!bounds_.empty()) {
+    *min_bound = bounds_.begin()->first;
+  }
+  if (!packets_.empty()) {
+    *min_packet = packets_.begin()->first;
+  }
+}
+
+NodeReadiness SyncSet::GetReadiness(Timestamp* min_stream_timestamp) {
+  // Only the incremental state is shared with the stream notifications.
+  absl::MutexLockMaybe lock(incremental_ ? mutex_.get() : nullptr);
+  Timestamp min_bound;
+  Timestamp min_packet;
+  GetMinTimestamps(&min_bound, &min_packet);
   *min_stream_timestamp = std::min(min_packet, min_bound);
   if (*min_stream_timestamp >= Timestamp::OneOverPostStream()) {
     // Either OneOverPostStream or Done indicates no more packets.
@@ -406,7 +573,9 @@ void SyncSet::FillInputSet(Timestamp input_timestamp,
                            InputStreamShardSet* input_set) {
   CHECK(input_timestamp.IsAllowedInStream());
   CHECK(input_set);
-  for (CollectionItemId id : stream_ids_) {
+  absl::MutexLockMaybe lock(incremental_ ? mutex_.get() : nullptr);
+  for (int i = 0; i < stream_ids_.size(); ++i) {
+    const CollectionItemId id = stream_ids_[i];
     const auto& stream = input_stream_handler_->input_stream_managers_.Get(id);
     int num_packets_dropped = 0;
     bool stream_is_done = false;
@@ -417,6 +586,9 @@ void SyncSet::FillInputSet(Timestamp input_timestamp,
                             num_packets_dropped, stream->Name());
     input_stream_handler_->AddPacketToShard(
         &input_set->Get(id), std::move(current_packet), stream_is_done);
+    if (incremental_) {
+      UpdateStreamState(i);
+    }
   }
 }
 
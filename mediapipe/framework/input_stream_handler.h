@@ -23,6 +23,9 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/btree_set.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 // TODO: Move protos in another CL after the C++ code migration.
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_context_manager.h"
@@ -141,6 +144,28 @@ class InputStreamHandler {
   // Sets next timestamp bound in a particular stream.
   void SetNextTimestampBound(CollectionItemId id, Timestamp bound);
 
+  // While an instance is in scope, the nodes notified by AddPackets,
+  // MovePackets and SetNextTimestampBound on the current thread are notified
+  // once each when it goes out of scope instead. Used by the upstream node to
+  // batch the updates of all its output streams, so that a downstream node
+  // receiving several packets and bounds checks its readiness once.
+  class BatchedNotifications {
+   public:
+    BatchedNotifications();
+    ~BatchedNotifications();
+    BatchedNotifications(const BatchedNotifications&) = delete;
+    BatchedNotifications& operator=(const BatchedNotifications&) = delete;
+
+   private:
+    friend class InputStreamHandler;
+
+    // The handlers to notify, without duplicates.
+    std::vector<InputStreamHandler*> handlers_;
+    // The batch in scope when this one was created.
+    BatchedNotifications* const saved_;
+    static thread_local BatchedNotifications* current_;  // NOLINT
+  };
+
   // Clears the current packet of every stream shard and removes the current
   // timestamp from the calculator context.
   void ClearCurrentInputs(CalculatorContext* calculator_context);
@@ -197,6 +222,12 @@ class InputStreamHandler {
   //
   // If ProcessTimestampBounds() is set, then a fully determined input timestamp
   // with only empty input packets will qualify as ReadyForProcess.
+  //
+  // Wide sync sets keep the timestamps of their streams ordered, and only
+  // update the streams reported by MarkStreamChanged, so that readiness costs
+  // O(log n) per stream change rather than O(n) per notification. The input
+  // stream handler must then report every change to the streams that is not
+  // made through the SyncSet itself.
   class SyncSet {
    public:
     // Creates a SyncSet for a certain set of streams, |stream_ids|.
@@ -206,6 +237,13 @@ class InputStreamHandler {
     // Reinitializes this SyncSet before each CalculatorGraph run.
     void PrepareForRun();
 
+    // Records that the packets or the timestamp bound of a stream changed.
+    // Streams outside of this SyncSet are ignored. Thread-safe.
+    void MarkStreamChanged(CollectionItemId id);
+
+    // Records that any of the streams may have changed.
+    void MarkAllStreamsChanged();
+
     // Answers whether this stream is ready for Process or Close.
     NodeReadiness GetReadiness(Timestamp* min_stream_timestamp);
 
@@ -223,9 +261,39 @@ class InputStreamHandler {
     void FillInputBounds(InputStreamShardSet* input_set);
 
    private:
+    // The cached state of a stream, in incremental mode.
+    struct StreamState {
+      Timestamp timestamp;
+      bool empty = true;
+      // Whether the stream is in bounds_ or packets_.
+      bool tracked = false;
+      // Whether the stream is in changed_streams_.
+      bool changed = false;
+    };
+
+    // Computes the minimum timestamp bound over the empty streams, and the
+    // minimum packet timestamp over the other ones.
+    void GetMinTimestamps(Timestamp* min_bound, Timestamp* min_packet);
+
+    // Refreshes the cached state of the stream at |index| in stream_ids_.
+    void UpdateStreamState(int index);
+
     InputStreamHandler* input_stream_handler_;
     std::vector<CollectionItemId> stream_ids_;
     Timestamp last_processed_ts_ = Timestamp::Unset();
+
+    // Incremental readiness state, used by wide sync sets only.
+    bool incremental_ = false;
+    // The index in stream_ids_ of each CollectionItemId, or -1.
+    std::vector<int> stream_indexes_;
+    // Guards the members below. Held by pointer to keep SyncSet movable.
+    std::unique_ptr<absl::Mutex> mutex_;
+    std::vector<StreamState> stream_states_;
+    // Indexes of the streams that changed since their state was cached.
+    std::vector<int> changed_streams_;
+    // (timestamp, index) of the empty and non-empty streams.
+    absl::btree_set<std::pair<Timestamp, int>> bounds_;
+    absl::btree_set<std::pair<Timestamp, int>> packets_;
   };
 
  protected:
@@ -237,6 +305,13 @@ class InputStreamHandler {
   // Batching cannot be combined with late_preparation_ behavior.
   void SetBatchSize(int batch_size);
 
+  // Subclasses can set the maximum number of input sets passed to a single
+  // Process() call through CalculatorContext::InputBatch(). Each call receives
+  // the input sets that are ready when it is scheduled, up to this number.
+  // Cannot be combined with batch_size, late preparation or parallel
+  // execution.
+  void SetMaxProcessBatchSize(int max_process_batch_size);
+
   // Subclasses can enable late preparation; however it cannot be used along
   // with batching.
   void SetLatePreparation(bool late_preparation);
@@ -269,6 +344,19 @@ class InputStreamHandler {
   virtual void FillInputSet(Timestamp input_timestamp,
                             InputStreamShardSet* input_set) = 0;
 
+  // Invoked after the packets or the timestamp bound of an input stream were
+  // changed by AddPackets, MovePackets, SetNextTimestampBound or Close, before
+  // the node is notified. May be invoked concurrently with any other method.
+  // Input stream handlers that cache the state of their streams override it.
+  virtual void InputStreamChanged(CollectionItemId id) {}
+
+  // Returns the time by which the given input timestamp should be processed,
+  // reported by CalculatorContext::Deadline(). There is no deadline by
+  // default.
+  virtual absl::Time Deadline(Timestamp input_timestamp) const {
+    return absl::InfiniteFuture();
+  }
+
   // Collection of InputStreamManager objects.
   InputStreamManagerSet input_stream_managers_;
   // A pointer to the calculator context manager of the calculator node.
@@ -288,6 +376,15 @@ class InputStreamHandler {
   std::function<void(absl::Status)> error_callback_;
 
  private:
+  // Invokes notification_, or defers it to the current BatchedNotifications.
+  void Notify();
+
+  // Adds the input set of `input_timestamp`, already in the inputs of
+  // `calculator_context`, and the following ready input sets to its input
+  // batch, up to max_process_batch_size_ in total.
+  void FillInputBatch(Timestamp input_timestamp,
+                      CalculatorContext* calculator_context);
+
   // Indicates when to fill the input set. If true, every input set will be
   // prepared in FinalizeInputSet(). Otherwise, the input sets will be filled
   // in ScheduleInvocations() in the scheduling phase.
@@ -300,6 +397,9 @@ class InputStreamHandler {
   // CalculatorNode is scheduled.
   int batch_size_ = 1;
 
+  // The maximum number of input sets passed to a single Process() call.
+  int max_process_batch_size_ = 1;
+
   // When true, any increase in timestamp bound invokes Calculator::Process.
   bool process_timestamps_ = false;
 
@@ -14,18 +14,118 @@
 
 #include "mediapipe/framework/input_stream_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT(build/c++11)
 #include <type_traits>
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/ring_buffer_queue.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_size.h"
+#include "mediapipe/framework/platform_specific_tracepoints.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/source_location.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/tool/status_util.h"
 
 namespace mediapipe {
+namespace {
+
+// Raises "peak" to "value" if it is lower.
+template <typename T>
+void UpdatePeak(std::atomic<T>& peak, T value) {
+  T current = peak.load(std::memory_order_relaxed);
+  while (current < value &&
+         !peak.compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+SharedQueueBudget::SharedQueueBudget(int64 max_bytes,
+                                     FullnessCallback fullness_callback)
+    : initial_max_bytes_(max_bytes),
+      fullness_callback_(std::move(fullness_callback)),
+      max_bytes_(max_bytes) {}
+
+void SharedQueueBudget::PrepareForRun() {
+  queued_bytes_ = 0;
+  max_bytes_ = initial_max_bytes_;
+}
+
+bool SharedQueueBudget::IsFull() const {
+  const int64 max_bytes = MaxBytes();
+  return max_bytes != -1 && QueuedBytes() >= max_bytes;
+}
+
+void SharedQueueBudget::SetMaxBytes(int64 max_bytes) {
+  max_bytes_ = max_bytes;
+  fullness_callback_();
+}
+
+bool SharedQueueBudget::Add(int64 delta) {
+  const int64 old_bytes = queued_bytes_.fetch_add(delta);
+  const int64 max_bytes = MaxBytes();
+  return max_bytes != -1 &&
+         (old_bytes >= max_bytes) != (old_bytes + delta >= max_bytes);
+}
+
+// The state of a stream using the lock-free queue.
+//
+// Producers hold producer_mutex while they validate and enqueue packets, so
+// they take turns as the producer of the queue, but the consumer never takes
+// it. An input stream has a single output stream as its producer, so the
+// mutex is rarely contended. The only cross-thread ordering the consumer
+// relies on is:
+// * A packet is visible in the queue before the producer's bound moves past
+//   it, so reading the bound before the queue never skips a packet.
+// * A producer publishes pending_timestamp before it checks select_bound, and
+//   PopPacketAtTimestamp() publishes select_bound before it checks
+//   pending_timestamp. So a packet racing with the pop is either rejected
+//   with a timestamp error before it is queued, or seen by the pop, which
+//   then waits until the packet is queued. This matches the locked queue.
+struct InputStreamManager::LockFreeState {
+  // Stands for no pending packet. It is the value of Timestamp::Done(), which
+  // no packet can have.
+  static constexpr int64 kNoPendingTimestamp = kint64max;
+
+  // Also excludes producers during PrepareForRun(), Close() and
+  // SetMaxQueueSize().
+  absl::Mutex producer_mutex;
+  RingBufferQueue<Packet> queue;
+  std::atomic<int> queue_size{0};
+  std::atomic<int64> num_packets_added{0};
+  std::atomic<bool> closed{false};
+  std::atomic<int> max_queue_size{-1};
+  // The bound set by the producer.
+  std::atomic<int64> next_timestamp_bound{Timestamp::PreStream().Value()};
+  // The bound implied by the consumer's last PopPacketAtTimestamp().
+  std::atomic<int64> select_bound{Timestamp::PreStream().Value()};
+  // The timestamp of the packet a producer is adding, if any.
+  std::atomic<int64> pending_timestamp{kNoPendingTimestamp};
+  // Only accessed by the consumer.
+  Timestamp last_select_timestamp = Timestamp::Unstarted();
+
+  // The equivalent of next_timestamp_bound_ in the locked implementation.
+  Timestamp NextTimestampBound() const {
+    return Timestamp::CreateNoErrorChecking(
+        std::max(next_timestamp_bound.load(), select_bound.load()));
+  }
+
+  bool IsFull(int size) const {
+    int max_size = max_queue_size.load(std::memory_order_relaxed);
+    return max_size != -1 && size >= max_size;
+  }
+};
+
+InputStreamManager::InputStreamManager() = default;
+InputStreamManager::~InputStreamManager() = default;
 
 absl::Status InputStreamManager::Initialize(const std::string& name,
                                             const PacketType* packet_type,
@@ -46,7 +146,29 @@ void InputStreamManager::SetQueueSizeCallbacks(
   becomes_not_full_callback_ = becomes_not_full_callback;
 }
 
+void InputStreamManager::EnableLockFreeQueue() {
+  lock_free_ = absl::make_unique<LockFreeState>();
+  PrepareForRun();
+}
+
 void InputStreamManager::PrepareForRun() {
+  queued_bytes_ = 0;
+  peak_queued_bytes_ = 0;
+  peak_queue_size_ = 0;
+  if (lock_free_) {
+    absl::MutexLock producer_lock(&lock_free_->producer_mutex);
+    lock_free_->queue.Clear();
+    lock_free_->queue_size = 0;
+    lock_free_->num_packets_added = 0;
+    lock_free_->closed = false;
+    lock_free_->next_timestamp_bound = Timestamp::PreStream().Value();
+    lock_free_->select_bound = Timestamp::PreStream().Value();
+    lock_free_->pending_timestamp = LockFreeState::kNoPendingTimestamp;
+    lock_free_->last_select_timestamp = Timestamp::Unstarted();
+    last_reported_stream_full_ = false;
+    header_ = Packet();
+    return;
+  }
   absl::MutexLock stream_lock(&stream_mutex_);
   queue_.clear();
   last_reported_stream_full_ = false;
@@ -58,11 +180,18 @@ void InputStreamManager::PrepareForRun() {
 }
 
 bool InputStreamManager::IsEmpty() const {
+  if (lock_free_) {
+    return lock_free_->queue_size.load() == 0;
+  }
   absl::MutexLock stream_lock(&stream_mutex_);
   return queue_.empty();
 }
 
 Packet InputStreamManager::QueueHead() const {
+  if (lock_free_) {
+    const Packet* head = lock_free_->queue.Front();
+    return head ? *head : Packet();
+  }
   absl::MutexLock stream_lock(&stream_mutex_);
   if (queue_.empty()) {
     return Packet();
@@ -82,20 +211,79 @@ absl::Status InputStreamManager::SetHeader(const Packet& header) {
 
 absl::Status InputStreamManager::AddPackets(const std::list<Packet>& container,
                                             bool* notify) {
+  if (lock_free_) {
+    return AddOrMovePacketsLockFree<const std::list<Packet>&>(container,
+                                                              notify);
+  }
   return AddOrMovePacketsInternal<const std::list<Packet>&>(container, notify);
 }
 
 absl::Status InputStreamManager::MovePackets(std::list<Packet>* container,
                                              bool* notify) {
+  if (lock_free_) {
+    return AddOrMovePacketsLockFree<std::list<Packet>&>(*container, notify);
+  }
   return AddOrMovePacketsInternal<std::list<Packet>&>(*container, notify);
 }
 
+absl::Status InputStreamManager::ValidatePacket(
+    const Packet& packet, Timestamp next_timestamp_bound,
+    int64 num_packets_added) const {
+  absl::Status result = packet_type_->Validate(packet);
+  if (!result.ok()) {
+    return tool::AddStatusPrefix(
+        absl::StrCat(
+            "Packet type mismatch on a calculator receiving from stream \"",
+            name_, "\": "),
+        result);
+  }
+
+  const Timestamp timestamp = packet.Timestamp();
+  if (!timestamp.IsAllowedInStream()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "In stream \"" << name_
+           << "\", timestamp not specified or set to illegal value: "
+           << timestamp.DebugString();
+  }
+  if (enable_timestamps_) {
+    // Check that PostStream(), if used, is the only timestamp used.  This
+    // is also true for PreStream() but doesn't need to be checked because
+    // Timestamp::PreStream().NextAllowedInStream() is
+    // Timestamp::OneOverPostStream().
+    if (timestamp == Timestamp::PostStream() && num_packets_added > 0) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "In stream \"" << name_
+             << "\", a packet at Timestamp::PostStream() must be the only "
+                "Packet in an InputStream.";
+    }
+    if (timestamp < next_timestamp_bound) {
+      return TimestampMismatchError(timestamp, next_timestamp_bound);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InputStreamManager::TimestampMismatchError(
+    Timestamp timestamp, Timestamp next_timestamp_bound) const {
+  return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+         << "Packet timestamp mismatch on a calculator receiving from "
+            "stream \""
+         << name_ << "\". Current minimum expected timestamp is "
+         << next_timestamp_bound.DebugString() << " but received "
+         << timestamp.DebugString()
+         << ". Are you using a custom InputStreamHandler? Note that "
+            "some InputStreamHandlers allow timestamps that are not "
+            "strictly monotonically increasing. See for example the "
+            "ImmediateInputStreamHandler class comment.";
+}
+
 template <typename Container>
 absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
                                                           bool* notify) {
   *notify = false;
   bool queue_became_non_empty = false;
   bool queue_became_full = false;
+  bool shared_budget_changed = false;
   {
     // Scope to prevent locking the stream when notification is called.
     absl::MutexLock stream_lock(&stream_mutex_);
@@ -103,51 +291,13 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
       return absl::OkStatus();
     }
     // Check if the queue was full before packets came in.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    bool was_queue_full = IsFullLocked();
     // Check if the queue becomes non-empty.
     queue_became_non_empty = queue_.empty() && !container.empty();
     for (auto& packet : container) {
-      absl::Status result = packet_type_->Validate(packet);
-      if (!result.ok()) {
-        return tool::AddStatusPrefix(
-            absl::StrCat(
-                "Packet type mismatch on a calculator receiving from stream \"",
-                name_, "\": "),
-            result);
-      }
-
+      MP_RETURN_IF_ERROR(
+          ValidatePacket(packet, next_timestamp_bound_, num_packets_added_));
       const Timestamp timestamp = packet.Timestamp();
-      if (!timestamp.IsAllowedInStream()) {
-        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-               << "In stream \"" << name_
-               << "\", timestamp not specified or set to illegal value: "
-               << timestamp.DebugString();
-      }
-      if (enable_timestamps_) {
-        // Check that PostStream(), if used, is the only timestamp used.  This
-        // is also true for PreStream() but doesn't need to be checked because
-        // Timestamp::PreStream().NextAllowedInStream() is
-        // Timestamp::OneOverPostStream().
-        if (timestamp == Timestamp::PostStream() && num_packets_added_ > 0) {
-          return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-                 << "In stream \"" << name_
-                 << "\", a packet at Timestamp::PostStream() must be the only "
-                    "Packet in an InputStream.";
-        }
-        if (timestamp < next_timestamp_bound_) {
-          return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-                 << "Packet timestamp mismatch on a calculator receiving from "
-                    "stream \""
-                 << name_ << "\". Current minimum expected timestamp is "
-                 << next_timestamp_bound_.DebugString() << " but received "
-                 << timestamp.DebugString()
-                 << ". Are you using a custom InputStreamHandler? Note that "
-                    "some InputStreamHandlers allow timestamps that are not "
-                    "strictly monotonically increasing. See for example the "
-                    "ImmediateInputStreamHandler class comment.";
-        }
-      }
       next_timestamp_bound_ = timestamp.NextAllowedInStream();
 
       // If the caller is MovePackets(), packet's underlying holder should be
@@ -161,9 +311,12 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
       } else {
         queue_.emplace_back(std::move(packet));
       }
+      AccountAddedPacket(queue_.back(), static_cast<int>(queue_.size()),
+                         &shared_budget_changed);
+      MEDIAPIPE_TRACEPOINT(packet_added, name_.c_str(), timestamp.Value(),
+                           queue_.size());
     }
-    queue_became_full = (!was_queue_full && max_queue_size_ != -1 &&
-                         queue_.size() >= max_queue_size_);
+    queue_became_full = !was_queue_full && IsFullLocked();
     if (queue_.size() > 1) {
       VLOG(3) << "Queue size greater than 1: stream name: " << name_
               << " queue_size: " << queue_.size();
@@ -172,6 +325,7 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
             << " becomes non-empty status:" << queue_became_non_empty
             << " Size: " << queue_.size();
   }
+  NotifySharedQueueBudget(shared_budget_changed);
   if (queue_became_full) {
     VLOG(3) << "Queue became full: " << Name();
     becomes_full_callback_(this, &last_reported_stream_full_);
@@ -182,6 +336,9 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
 
 absl::Status InputStreamManager::SetNextTimestampBound(const Timestamp bound,
                                                        bool* notify) {
+  if (lock_free_) {
+    return SetNextTimestampBoundLockFree(bound, notify);
+  }
   *notify = false;
   {
     // Scope to prevent locking the stream when notification is called.
@@ -219,6 +376,16 @@ absl::Status InputStreamManager::SetNextTimestampBound(const Timestamp bound,
 void InputStreamManager::DisableTimestamps() { enable_timestamps_ = false; }
 
 void InputStreamManager::Close() {
+  if (lock_free_) {
+    absl::MutexLock producer_lock(&lock_free_->producer_mutex);
+    if (lock_free_->closed) {
+      return;
+    }
+    lock_free_->next_timestamp_bound = Timestamp::Done().Value();
+    lock_free_->select_bound = Timestamp::Done().Value();
+    lock_free_->closed = true;
+    return;
+  }
   absl::MutexLock stream_lock(&stream_mutex_);
   if (closed_) {
     return;
@@ -229,6 +396,9 @@ void InputStreamManager::Close() {
 }
 
 Timestamp InputStreamManager::MinTimestampOrBound(bool* is_empty) const {
+  if (lock_free_) {
+    return MinTimestampOrBoundLockFree(is_empty);
+  }
   absl::MutexLock stream_lock(&stream_mutex_);
   if (is_empty) {
     *is_empty = queue_.empty();
@@ -244,10 +414,15 @@ Timestamp InputStreamManager::MinTimestampOrBoundHelper() const
 Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
                                                 int* num_packets_dropped,
                                                 bool* stream_is_done) {
+  if (lock_free_) {
+    return PopPacketAtTimestampLockFree(timestamp, num_packets_dropped,
+                                        stream_is_done);
+  }
   CHECK(enable_timestamps_);
   *num_packets_dropped = -1;
   *stream_is_done = false;
   bool queue_became_non_full = false;
+  bool shared_budget_changed = false;
   Packet packet;
   {
     absl::MutexLock stream_lock(&stream_mutex_);
@@ -269,13 +444,15 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
     Timestamp current_timestamp = Timestamp::Unset();
 
     // Checks if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    bool was_queue_full = IsFullLocked();
 
     while (!queue_.empty() && queue_.front().Timestamp() <= timestamp) {
+      AccountRemovedPacket(queue_.front(), &shared_budget_changed);
       packet = std::move(queue_.front());
       queue_.pop_front();
       current_timestamp = packet.Timestamp();
+      MEDIAPIPE_TRACEPOINT(packet_popped, name_.c_str(),
+                           current_timestamp.Value(), queue_.size());
       ++(*num_packets_dropped);
     }
     // Clear value_ if it doesn't have exactly the right timestamp.
@@ -288,9 +465,10 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
 
     VLOG(3) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_became_non_full = was_queue_full && !IsFullLocked();
     *stream_is_done = IsDone();
   }
+  NotifySharedQueueBudget(shared_budget_changed);
   if (queue_became_non_full) {
     VLOG(3) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
@@ -299,9 +477,13 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
 }
 
 Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
+  if (lock_free_) {
+    return PopQueueHeadLockFree(stream_is_done);
+  }
   CHECK(!enable_timestamps_);
   *stream_is_done = false;
   bool queue_became_non_full = false;
+  bool shared_budget_changed = false;
   Packet packet;
   {
     absl::MutexLock stream_lock(&stream_mutex_);
@@ -309,21 +491,24 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
     VLOG(3) << "Input stream " << name_ << " selecting at queue head";
 
     // Check if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    bool was_queue_full = IsFullLocked();
 
     if (!queue_.empty()) {
+      AccountRemovedPacket(queue_.front(), &shared_budget_changed);
       packet = std::move(queue_.front());
       queue_.pop_front();
+      MEDIAPIPE_TRACEPOINT(packet_popped, name_.c_str(),
+                           packet.Timestamp().Value(), queue_.size());
     } else {
       packet = Packet();
     }
 
     VLOG(3) << "Input stream removed a packet:" << name_
             << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_became_non_full = was_queue_full && !IsFullLocked();
     *stream_is_done = IsDone();
   }
+  NotifySharedQueueBudget(shared_budget_changed);
   if (queue_became_non_full) {
     VLOG(3) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
@@ -332,16 +517,25 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
 }
 
 int InputStreamManager::NumPacketsAdded() const {
+  if (lock_free_) {
+    return lock_free_->num_packets_added.load(std::memory_order_relaxed);
+  }
   absl::MutexLock lock(&stream_mutex_);
   return num_packets_added_;
 }
 
 int InputStreamManager::QueueSize() const {
+  if (lock_free_) {
+    return lock_free_->queue_size.load();
+  }
   absl::MutexLock lock(&stream_mutex_);
   return static_cast<int>(queue_.size());
 }
 
 int InputStreamManager::MaxQueueSize() const {
+  if (lock_free_) {
+    return lock_free_->max_queue_size.load(std::memory_order_relaxed);
+  }
   absl::MutexLock lock(&stream_mutex_);
   return max_queue_size_;
 }
@@ -349,11 +543,43 @@ int InputStreamManager::MaxQueueSize() const {
 void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
   bool was_full;
   bool is_full;
-  {
+  if (lock_free_) {
+    absl::MutexLock producer_lock(&lock_free_->producer_mutex);
+    const int size = lock_free_->queue_size.load();
+    was_full = lock_free_->IsFull(size);
+    lock_free_->max_queue_size = max_queue_size;
+    is_full = lock_free_->IsFull(size);
+  } else {
     absl::MutexLock lock(&stream_mutex_);
-    was_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    was_full = IsFullLocked();
     max_queue_size_ = max_queue_size;
-    is_full = (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    is_full = IsFullLocked();
+  }
+
+  // QueueSizeCallback is called with no mutexes held.
+  if (!was_full && is_full) {
+    VLOG(3) << "Queue became full: " << Name();
+    becomes_full_callback_(this, &last_reported_stream_full_);
+  } else if (was_full && !is_full) {
+    VLOG(3) << "Queue became non-full: " << Name();
+    becomes_not_full_callback_(this, &last_reported_stream_full_);
+  }
+}
+
+void InputStreamManager::SetMaxQueueBytes(int64 max_queue_bytes) {
+  DCHECK(memory_accounting_ || max_queue_bytes == -1);
+  bool was_full;
+  bool is_full;
+  if (lock_free_) {
+    absl::MutexLock producer_lock(&lock_free_->producer_mutex);
+    was_full = BytesFull(QueuedBytes());
+    max_queue_bytes_ = max_queue_bytes;
+    is_full = BytesFull(QueuedBytes());
+  } else {
+    absl::MutexLock lock(&stream_mutex_);
+    was_full = IsFullLocked();
+    max_queue_bytes_ = max_queue_bytes;
+    is_full = IsFullLocked();
   }
 
   // QueueSizeCallback is called with no mutexes held.
@@ -367,11 +593,18 @@ void InputStreamManager::SetMaxQueueSize(int max_queue_size) {
 }
 
 bool InputStreamManager::IsFull() const {
+  if (lock_free_) {
+    return lock_free_->IsFull(lock_free_->queue_size.load()) ||
+           BytesFull(QueuedBytes());
+  }
   absl::MutexLock lock(&stream_mutex_);
-  return max_queue_size_ != -1 && queue_.size() >= max_queue_size_;
+  return IsFullLocked();
 }
 
 Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
+  if (lock_free_) {
+    return GetMinTimestampAmongNLatestLockFree(n);
+  }
   absl::MutexLock lock(&stream_mutex_);
   if (queue_.empty()) {
     return Timestamp::Unset();
@@ -380,29 +613,314 @@ Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
 }
 
 void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
+  if (lock_free_) {
+    ErasePacketsEarlierThanLockFree(timestamp);
+    return;
+  }
   bool queue_became_non_full = false;
+  bool shared_budget_changed = false;
   {
     absl::MutexLock lock(&stream_mutex_);
     // Checks if queue is full.
-    bool was_queue_full =
-        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+    bool was_queue_full = IsFullLocked();
 
     while (!queue_.empty() && queue_.front().Timestamp() < timestamp) {
+      AccountRemovedPacket(queue_.front(), &shared_budget_changed);
       queue_.pop_front();
     }
 
     VLOG(3) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
-    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    queue_became_non_full = was_queue_full && !IsFullLocked();
   }
+  NotifySharedQueueBudget(shared_budget_changed);
   if (queue_became_non_full) {
     VLOG(3) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
   }
 }
 
+bool InputStreamManager::AccountAddedPacket(const Packet& packet,
+                                            int queue_size,
+                                            bool* shared_budget_changed) {
+  if (!memory_accounting_) {
+    return false;
+  }
+  const int64 size = EstimatePacketSize(packet);
+  const int64 old_bytes = queued_bytes_.fetch_add(size);
+  UpdatePeak(peak_queued_bytes_, old_bytes + size);
+  UpdatePeak(peak_queue_size_, queue_size);
+  if (shared_budget_ && shared_budget_->Add(size)) {
+    *shared_budget_changed = true;
+  }
+  return !BytesFull(old_bytes) && BytesFull(old_bytes + size);
+}
+
+bool InputStreamManager::AccountRemovedPacket(const Packet& packet,
+                                              bool* shared_budget_changed) {
+  if (!memory_accounting_) {
+    return false;
+  }
+  const int64 size = EstimatePacketSize(packet);
+  const int64 old_bytes = queued_bytes_.fetch_sub(size);
+  if (shared_budget_ && shared_budget_->Add(-size)) {
+    *shared_budget_changed = true;
+  }
+  return BytesFull(old_bytes) && !BytesFull(old_bytes - size);
+}
+
+bool InputStreamManager::BytesFull(int64 queued_bytes) const {
+  const int64 max_bytes = MaxQueueBytes();
+  return max_bytes != -1 && queued_bytes >= max_bytes;
+}
+
+bool InputStreamManager::IsFullLocked() const {
+  return (max_queue_size_ != -1 && queue_.size() >= max_queue_size_) ||
+         BytesFull(QueuedBytes());
+}
+
+void InputStreamManager::NotifySharedQueueBudget(bool shared_budget_changed) {
+  if (shared_budget_changed) {
+    shared_budget_->fullness_callback_();
+  }
+}
+
 bool InputStreamManager::IsDone() const {
   return queue_.empty() && next_timestamp_bound_ == Timestamp::Done();
 }
 
+bool InputStreamManager::BecameNonFullLockFree(int old_size) const {
+  return lock_free_->IsFull(old_size) && !lock_free_->IsFull(old_size - 1);
+}
+
+template <typename Container>
+absl::Status InputStreamManager::AddOrMovePacketsLockFree(Container container,
+                                                          bool* notify) {
+  LockFreeState& state = *lock_free_;
+  *notify = false;
+  bool queue_became_non_empty = false;
+  bool queue_became_full = false;
+  bool shared_budget_changed = false;
+  {
+    absl::MutexLock producer_lock(&state.producer_mutex);
+    if (state.closed) {
+      return absl::OkStatus();
+    }
+    for (auto& packet : container) {
+      MP_RETURN_IF_ERROR(ValidatePacket(packet, state.NextTimestampBound(),
+                                        state.num_packets_added));
+      const Timestamp timestamp = packet.Timestamp();
+      if (enable_timestamps_) {
+        // Checks select_bound again, now that the consumer will wait for the
+        // packet if it selects past it from here on.
+        state.pending_timestamp = timestamp.Value();
+        const int64 select_bound = state.select_bound;
+        if (timestamp.Value() < select_bound) {
+          state.pending_timestamp = LockFreeState::kNoPendingTimestamp;
+          return TimestampMismatchError(
+              timestamp, Timestamp::CreateNoErrorChecking(select_bound));
+        }
+      }
+      ++state.num_packets_added;
+      VLOG(3) << "Input stream:" << name_
+              << " has added packet at time: " << packet.Timestamp();
+      // Account before the consumer can see the packet, so that its removal
+      // never comes first.
+      queue_became_full |= AccountAddedPacket(
+          packet, state.queue_size.load() + 1, &shared_budget_changed);
+      if (std::is_const<
+              typename std::remove_reference<Container>::type>::value) {
+        state.queue.Push(packet);
+      } else {
+        state.queue.Push(std::move(packet));
+      }
+      const int old_size = state.queue_size.fetch_add(1);
+      MEDIAPIPE_TRACEPOINT(packet_added, name_.c_str(), timestamp.Value(),
+                           old_size + 1);
+      queue_became_non_empty |= (old_size == 0);
+      queue_became_full |=
+          (!state.IsFull(old_size) && state.IsFull(old_size + 1));
+      // Only now that the packet is visible may the bound move past it.
+      state.next_timestamp_bound = timestamp.NextAllowedInStream().Value();
+      state.pending_timestamp = LockFreeState::kNoPendingTimestamp;
+    }
+  }
+  NotifySharedQueueBudget(shared_budget_changed);
+  if (queue_became_full) {
+    VLOG(3) << "Queue became full: " << Name();
+    becomes_full_callback_(this, &last_reported_stream_full_);
+  }
+  *notify = queue_became_non_empty;
+  return absl::OkStatus();
+}
+
+absl::Status InputStreamManager::SetNextTimestampBoundLockFree(
+    const Timestamp bound, bool* notify) {
+  LockFreeState& state = *lock_free_;
+  *notify = false;
+  absl::MutexLock producer_lock(&state.producer_mutex);
+  if (state.closed) {
+    return absl::OkStatus();
+  }
+  const Timestamp current_bound = state.NextTimestampBound();
+  if (enable_timestamps_ && bound < current_bound) {
+    return mediapipe::UnknownErrorBuilder(MEDIAPIPE_LOC)
+           << "SetNextTimestampBound must be called with a timestamp greater "
+              "than or equal to the current bound. In stream \""
+           << name_ << "\". Current minimum expected timestamp is "
+           << current_bound.DebugString() << " but received "
+           << bound.DebugString();
+  }
+  if (bound > current_bound) {
+    state.next_timestamp_bound = bound.Value();
+    VLOG(3) << "Next timestamp bound for input " << name_ << " is " << bound;
+    // A change to the bound is only detectable by the consumer if the queue
+    // is empty.
+    *notify = (state.queue_size.load() == 0);
+  }
+  return absl::OkStatus();
+}
+
+Timestamp InputStreamManager::MinTimestampOrBoundLockFree(
+    bool* is_empty) const {
+  const LockFreeState& state = *lock_free_;
+  // Read the bound before the queue, see LockFreeState.
+  const Timestamp bound = state.NextTimestampBound();
+  const Packet* head = state.queue.Front();
+  if (is_empty) {
+    *is_empty = (head == nullptr);
+  }
+  if (head == nullptr) {
+    return bound;
+  }
+  return head->Timestamp();
+}
+
+Packet InputStreamManager::PopPacketAtTimestampLockFree(
+    Timestamp timestamp, int* num_packets_dropped, bool* stream_is_done) {
+  CHECK(enable_timestamps_);
+  LockFreeState& state = *lock_free_;
+  *num_packets_dropped = -1;
+  *stream_is_done = false;
+  bool queue_became_non_full = false;
+  bool shared_budget_changed = false;
+  Packet packet;
+
+  CHECK_LE(state.last_select_timestamp, timestamp);
+  state.last_select_timestamp = timestamp;
+  // Make sure AddPacket and SetNextTimestampBound are not called with
+  // timestamps we have already passed.
+  if (state.select_bound < timestamp.NextAllowedInStream().Value()) {
+    state.select_bound = timestamp.NextAllowedInStream().Value();
+  }
+  // Must come after publishing select_bound, see LockFreeState. A packet
+  // being added at or before the timestamp is queued within a few
+  // instructions.
+  while (state.pending_timestamp <= timestamp.Value()) {
+    std::this_thread::yield();
+  }
+  Timestamp current_timestamp = Timestamp::Unset();
+  if (state.queue_size.load() > 0) {
+    for (const Packet* head = state.queue.Front();
+         head != nullptr && head->Timestamp() <= timestamp;
+         head = state.queue.Front()) {
+      state.queue.Pop(&packet);
+      queue_became_non_full |=
+          AccountRemovedPacket(packet, &shared_budget_changed);
+      const int old_size = state.queue_size.fetch_sub(1);
+      queue_became_non_full |= BecameNonFullLockFree(old_size);
+      current_timestamp = packet.Timestamp();
+      MEDIAPIPE_TRACEPOINT(packet_popped, name_.c_str(),
+                           current_timestamp.Value(), old_size - 1);
+      ++(*num_packets_dropped);
+    }
+  }
+  // Clear the packet if it doesn't have exactly the right timestamp.
+  if (current_timestamp != timestamp) {
+    // The timestamp bound reported when no packet is sent.
+    Timestamp bound = MinTimestampOrBoundLockFree(nullptr);
+    packet = Packet().At(bound.PreviousAllowedInStream());
+    ++(*num_packets_dropped);
+  }
+  VLOG(3) << "Input stream removed packets:" << name_
+          << " Size:" << state.queue_size.load();
+  *stream_is_done = state.queue_size.load() == 0 &&
+                    state.NextTimestampBound() == Timestamp::Done();
+  NotifySharedQueueBudget(shared_budget_changed);
+  if (queue_became_non_full) {
+    VLOG(3) << "Queue became non-full: " << Name();
+    becomes_not_full_callback_(this, &last_reported_stream_full_);
+  }
+  return packet;
+}
+
+Packet InputStreamManager::PopQueueHeadLockFree(bool* stream_is_done) {
+  CHECK(!enable_timestamps_);
+  LockFreeState& state = *lock_free_;
+  bool queue_became_non_full = false;
+  bool shared_budget_changed = false;
+  Packet packet;
+  if (state.queue.Pop(&packet)) {
+    queue_became_non_full =
+        AccountRemovedPacket(packet, &shared_budget_changed);
+    const int old_size = state.queue_size.fetch_sub(1);
+    queue_became_non_full |= BecameNonFullLockFree(old_size);
+    MEDIAPIPE_TRACEPOINT(packet_popped, name_.c_str(),
+                         packet.Timestamp().Value(), old_size - 1);
+  }
+  VLOG(3) << "Input stream removed a packet:" << name_
+          << " Size:" << state.queue_size.load();
+  *stream_is_done = state.queue_size.load() == 0 &&
+                    state.NextTimestampBound() == Timestamp::Done();
+  NotifySharedQueueBudget(shared_budget_changed);
+  if (queue_became_non_full) {
+    VLOG(3) << "Queue became non-full: " << Name();
+    becomes_not_full_callback_(this, &last_reported_stream_full_);
+  }
+  return packet;
+}
+
+Timestamp InputStreamManager::GetMinTimestampAmongNLatestLockFree(
+    int n) const {
+  const LockFreeState& state = *lock_free_;
+  int size = 0;
+  state.queue.ForEach([&size](const Packet&) { ++size; });
+  if (size == 0) {
+    return Timestamp::Unset();
+  }
+  // Packets added since the count are newer, so the packet at this index is
+  // still among the n latest of the counted ones.
+  const int skip = size - std::min(n, size);
+  int index = 0;
+  Timestamp result = Timestamp::Unset();
+  state.queue.ForEach([&](const Packet& packet) {
+    if (index++ == skip) {
+      result = packet.Timestamp();
+    }
+  });
+  return result;
+}
+
+void InputStreamManager::ErasePacketsEarlierThanLockFree(Timestamp timestamp) {
+  LockFreeState& state = *lock_free_;
+  bool queue_became_non_full = false;
+  bool shared_budget_changed = false;
+  for (const Packet* head = state.queue.Front();
+       head != nullptr && head->Timestamp() < timestamp;
+       head = state.queue.Front()) {
+    queue_became_non_full |=
+        AccountRemovedPacket(*head, &shared_budget_changed);
+    state.queue.PopFront();
+    queue_became_non_full |=
+        BecameNonFullLockFree(state.queue_size.fetch_sub(1));
+  }
+  VLOG(3) << "Input stream removed packets:" << name_
+          << " Size:" << state.queue_size.load();
+  NotifySharedQueueBudget(shared_budget_changed);
+  if (queue_became_non_full) {
+    VLOG(3) << "Queue became non-full: " << Name();
+    becomes_not_full_callback_(this, &last_reported_stream_full_);
+  }
+}
+
 }  // namespace mediapipe
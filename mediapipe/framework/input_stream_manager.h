@@ -15,9 +15,11 @@
 #ifndef MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 #define MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <list>
+#include <memory>
 #include <string>
 
 #include "absl/base/thread_annotations.h"
@@ -31,6 +33,50 @@
 
 namespace mediapipe {
 
+// A byte budget shared by several input streams, e.g. by all the input streams
+// of a graph. It holds the total of the estimated bytes queued by the streams
+// that use it, see InputStreamManager::SetSharedQueueBudget().
+class SharedQueueBudget {
+ public:
+  // Invoked with no stream lock held when the budget may have become full or
+  // non-full. Calls can race, so the callback must check IsFull() itself.
+  typedef std::function<void()> FullnessCallback;
+
+  // A budget of "max_bytes", or an unlimited one if "max_bytes" is -1.
+  SharedQueueBudget(int64 max_bytes, FullnessCallback fullness_callback);
+
+  SharedQueueBudget(const SharedQueueBudget&) = delete;
+  SharedQueueBudget& operator=(const SharedQueueBudget&) = delete;
+
+  // Resets the queued bytes, and the limit to the one given at construction,
+  // for another run of the graph.
+  void PrepareForRun();
+
+  int64 QueuedBytes() const {
+    return queued_bytes_.load(std::memory_order_relaxed);
+  }
+  int64 MaxBytes() const { return max_bytes_.load(std::memory_order_relaxed); }
+
+  // Returns true if the queued bytes reach the limit.
+  bool IsFull() const;
+
+  // Changes the limit, e.g. to resolve a deadlock.
+  void SetMaxBytes(int64 max_bytes);
+
+ private:
+  friend class InputStreamManager;
+
+  // Adds "delta" bytes, which may be negative. Returns true if this made the
+  // budget full or non-full, in which case the caller must invoke
+  // fullness_callback_ once it has released its locks.
+  bool Add(int64 delta);
+
+  const int64 initial_max_bytes_;
+  const FullnessCallback fullness_callback_;
+  std::atomic<int64> max_bytes_;
+  std::atomic<int64> queued_bytes_{0};
+};
+
 // An OutputStreamManager will add packets to InputStreamManager through
 // InputStreamHandler as they are output.  A CalculatorNode prepares the input
 // packets for a particular invocation by calling InputStreamManager's
@@ -54,7 +100,8 @@ class InputStreamManager {
   InputStreamManager(const InputStreamManager&) = delete;
   InputStreamManager& operator=(const InputStreamManager&) = delete;
 
-  InputStreamManager() = default;
+  InputStreamManager();
+  ~InputStreamManager();
 
   // Initializes the InputStreamManager.
   absl::Status Initialize(const std::string& name,
@@ -66,6 +113,64 @@ class InputStreamManager {
   // Returns true if the input stream is a back edge.
   bool BackEdge() const { return back_edge_; }
 
+  // Switches the stream to a lock-free ring buffer queue, in which the
+  // consumer never takes a lock. Producers are still serialized among
+  // themselves. The consumer only waits for a producer when it selects past a
+  // packet that the producer is adding, until the packet is queued. Must be
+  // called after Initialize() and before the graph starts running.
+  //
+  // In this mode the consumer-side methods (everything that reads or removes
+  // queued packets, including MinTimestampOrBound()) must only be called from
+  // the node's scheduling context, which runs on at most one thread at a time.
+  // QueueSize(), NumPacketsAdded(), IsEmpty() and IsFull() may be called from
+  // any thread.
+  void EnableLockFreeQueue();
+
+  // Returns true if EnableLockFreeQueue() has been called.
+  bool LockFreeQueueEnabled() const { return lock_free_ != nullptr; }
+
+  // Starts tracking the estimated bytes held by the queued packets, see
+  // EstimatePacketSize(), and the peak queue occupancy. Must be called before
+  // the graph starts running.
+  void EnableMemoryAccounting() { memory_accounting_ = true; }
+
+  // Returns true if EnableMemoryAccounting() has been called.
+  bool MemoryAccountingEnabled() const { return memory_accounting_; }
+
+  // The estimated bytes held by the queued packets, and the peaks of the
+  // bytes and of the number of queued packets during the current run. Zero
+  // unless EnableMemoryAccounting() has been called. May be called from any
+  // thread.
+  int64 QueuedBytes() const {
+    return queued_bytes_.load(std::memory_order_relaxed);
+  }
+  int64 PeakQueuedBytes() const {
+    return peak_queued_bytes_.load(std::memory_order_relaxed);
+  }
+  int PeakQueueSize() const {
+    return peak_queue_size_.load(std::memory_order_relaxed);
+  }
+
+  // Makes the queue full, in addition to the max queue size, while the queued
+  // packets hold at least "max_queue_bytes" bytes. A value of -1 means that
+  // there is no byte budget. Requires EnableMemoryAccounting().
+  //
+  // With the lock-free queue, the queue size callbacks may be invoked when
+  // only one of the two limits is crossed, without IsFull() changing.
+  void SetMaxQueueBytes(int64 max_queue_bytes);
+
+  // Returns the byte budget of the stream, or -1 if there is none.
+  int64 MaxQueueBytes() const {
+    return max_queue_bytes_.load(std::memory_order_relaxed);
+  }
+
+  // Makes the stream count its queued bytes against "budget" too, which
+  // must outlive the run. Requires EnableMemoryAccounting(). Must be called
+  // before the graph starts running.
+  void SetSharedQueueBudget(SharedQueueBudget* budget) {
+    shared_budget_ = budget;
+  }
+
   // Sets the header Packet.
   absl::Status SetHeader(const Packet& header);
 
@@ -148,7 +253,8 @@ class InputStreamManager {
   // Returns the number of packets in the queue.
   int QueueSize() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
-  // Returns true iff the queue is full.
+  // Returns true iff the queue is full, by its max queue size or by its byte
+  // budget.
   bool IsFull() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
   // Returns the max queue size. -1 indicates that there is no maximum.
@@ -172,9 +278,10 @@ class InputStreamManager {
   void ErasePacketsEarlierThan(Timestamp timestamp)
       ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
-  // If a maximum queue size is specified (!= -1), these callbacks that are
-  // invoked when the input queue becomes full (>= max_queue_size_) or when it
-  // becomes non-full (< max_queue_size_).
+  // If a maximum queue size or a byte budget is specified (!= -1), these
+  // callbacks that are invoked when the input queue becomes full
+  // (>= max_queue_size_ packets, or >= max_queue_bytes_ bytes) or when it
+  // becomes non-full.
   void SetQueueSizeCallbacks(QueueSizeCallback becomes_full_callback,
                              QueueSizeCallback becomes_not_full_callback);
 
@@ -189,12 +296,57 @@ class InputStreamManager {
   absl::Status AddOrMovePacketsInternal(Container container, bool* notify)
       ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
+  // Returns an error if "packet" cannot be added to the stream, given the
+  // current next timestamp bound and the number of packets added so far.
+  absl::Status ValidatePacket(const Packet& packet,
+                              Timestamp next_timestamp_bound,
+                              int64 num_packets_added) const;
+  absl::Status TimestampMismatchError(Timestamp timestamp,
+                                      Timestamp next_timestamp_bound) const;
+
+  // Update the memory accounting for a packet added to a queue of
+  // "queue_size" packets, or removed from the queue. Return true if this
+  // made the queued bytes reach the byte budget of the stream, or drop
+  // below it, respectively. Set "shared_budget_changed" if this made the
+  // shared budget full or non-full.
+  bool AccountAddedPacket(const Packet& packet, int queue_size,
+                          bool* shared_budget_changed);
+  bool AccountRemovedPacket(const Packet& packet, bool* shared_budget_changed);
+
+  // Returns true if "queued_bytes" reach the byte budget of the stream.
+  bool BytesFull(int64 queued_bytes) const;
+
+  // Returns true if the queue holds max_queue_size_ packets, or reaches its
+  // byte budget.
+  bool IsFullLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
+
+  // Invokes the callback of the shared budget if "shared_budget_changed".
+  // Must be called with no lock held.
+  void NotifySharedQueueBudget(bool shared_budget_changed);
+
   // Returns true if the next timestamp bound reaches Timestamp::Done().
   bool IsDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(stream_mutex_);
 
   // Returns the smallest timestamp at which this stream might see an input.
   Timestamp MinTimestampOrBoundHelper() const;
 
+  // Lock-free counterparts of the public methods, used after
+  // EnableLockFreeQueue().
+  struct LockFreeState;
+  template <typename Container>
+  absl::Status AddOrMovePacketsLockFree(Container container, bool* notify);
+  absl::Status SetNextTimestampBoundLockFree(Timestamp bound, bool* notify);
+  Timestamp MinTimestampOrBoundLockFree(bool* is_empty) const;
+  Packet PopPacketAtTimestampLockFree(Timestamp timestamp,
+                                      int* num_packets_dropped,
+                                      bool* stream_is_done);
+  Packet PopQueueHeadLockFree(bool* stream_is_done);
+  Timestamp GetMinTimestampAmongNLatestLockFree(int n) const;
+  void ErasePacketsEarlierThanLockFree(Timestamp timestamp);
+  // Returns true if a pop that took the queue from "old_size" packets to
+  // one less made it non-full.
+  bool BecameNonFullLockFree(int old_size) const;
+
   mutable absl::Mutex stream_mutex_;
   std::deque<Packet> queue_ ABSL_GUARDED_BY(stream_mutex_);
   // The number of packets added to queue_.  Used to verify a packet at
@@ -227,6 +379,19 @@ class InputStreamManager {
   // fullness reported in the last completed QueueSizeCallback.
   // This variable is only accessed during the QueueSizeCallback.
   bool last_reported_stream_full_ = false;
+
+  // The memory accounting, see EnableMemoryAccounting().
+  bool memory_accounting_ = false;
+  std::atomic<int64> queued_bytes_{0};
+  std::atomic<int64> peak_queued_bytes_{0};
+  std::atomic<int> peak_queue_size_{0};
+  // The byte budgets, see SetMaxQueueBytes() and SetSharedQueueBudget().
+  std::atomic<int64> max_queue_bytes_{-1};
+  SharedQueueBudget* shared_budget_ = nullptr;
+
+  // State of the lock-free queue, if enabled. When set, it replaces queue_
+  // and the other fields guarded by stream_mutex_.
+  std::unique_ptr<LockFreeState> lock_free_;
 };
 
 }  // namespace mediapipe
@@ -14,19 +14,23 @@
 
 #include "mediapipe/framework/input_stream_manager.h"
 
+#include <atomic>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 
 #include "absl/memory/memory.h"
 #include "mediapipe/framework/input_stream_shard.h"
 #include "mediapipe/framework/lifetime_tracker.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_size.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/status_matchers.h"
 
 namespace mediapipe {
 namespace {
-class InputStreamManagerTest : public ::testing::Test {
+// The parameter selects the lock-free queue.
+class InputStreamManagerTest : public ::testing::TestWithParam<bool> {
  protected:
   InputStreamManagerTest() {}
 
@@ -44,6 +48,9 @@ class InputStreamManagerTest : public ::testing::Test {
     input_stream_manager_ = absl::make_unique<InputStreamManager>();
     MP_ASSERT_OK(input_stream_manager_->Initialize("a_test", &packet_type_,
                                                    /*back_edge=*/false));
+    if (GetParam()) {
+      input_stream_manager_->EnableLockFreeQueue();
+    }
 
     queue_full_callback_ =
         std::bind(&InputStreamManagerTest::ReportQueueBecomesFull, this,
@@ -89,9 +96,9 @@ class InputStreamManagerTest : public ::testing::Test {
   int queue_becomes_not_full_count_;
 };
 
-TEST_F(InputStreamManagerTest, Init) {}
+TEST_P(InputStreamManagerTest, Init) {}
 
-TEST_F(InputStreamManagerTest, AddPackets) {
+TEST_P(InputStreamManagerTest, AddPackets) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -108,7 +115,7 @@ TEST_F(InputStreamManagerTest, AddPackets) {
   }
 }
 
-TEST_F(InputStreamManagerTest, MovePackets) {
+TEST_P(InputStreamManagerTest, MovePackets) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -128,7 +135,7 @@ TEST_F(InputStreamManagerTest, MovePackets) {
 // InputStreamManager should reject the four timestamps that are not allowed in
 // a stream: Timestamp::Unset(), Timestamp::Unstarted(),
 // Timestamp::OneOverPostStream(), and Timestamp::Done().
-TEST_F(InputStreamManagerTest, AddPacketUnset) {
+TEST_P(InputStreamManagerTest, AddPacketUnset) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp::Unset()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -139,7 +146,7 @@ TEST_F(InputStreamManagerTest, AddPacketUnset) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketUnstarted) {
+TEST_P(InputStreamManagerTest, AddPacketUnstarted) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::Unstarted()));
@@ -151,7 +158,7 @@ TEST_F(InputStreamManagerTest, AddPacketUnstarted) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketOneOverPostStream) {
+TEST_P(InputStreamManagerTest, AddPacketOneOverPostStream) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::OneOverPostStream()));
@@ -164,7 +171,7 @@ TEST_F(InputStreamManagerTest, AddPacketOneOverPostStream) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketDone) {
+TEST_P(InputStreamManagerTest, AddPacketDone) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp::Done()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -175,7 +182,7 @@ TEST_F(InputStreamManagerTest, AddPacketDone) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketsOnlyPreStream) {
+TEST_P(InputStreamManagerTest, AddPacketsOnlyPreStream) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PreStream()));
@@ -189,7 +196,7 @@ TEST_F(InputStreamManagerTest, AddPacketsOnlyPreStream) {
 
 // An attempt to add a packet after Timestamp::PreStream() should be rejected
 // because the next timestamp bound is Timestamp::OneOverPostStream().
-TEST_F(InputStreamManagerTest, AddPacketsAfterPreStream) {
+TEST_P(InputStreamManagerTest, AddPacketsAfterPreStream) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PreStream()));
@@ -203,7 +210,7 @@ TEST_F(InputStreamManagerTest, AddPacketsAfterPreStream) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketsOnlyPostStream) {
+TEST_P(InputStreamManagerTest, AddPacketsOnlyPostStream) {
   std::list<Packet> packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PostStream()));
@@ -217,7 +224,7 @@ TEST_F(InputStreamManagerTest, AddPacketsOnlyPostStream) {
 
 // A packet at Timestamp::PostStream() must be the only Packet in an input
 // stream.
-TEST_F(InputStreamManagerTest, AddPacketsBeforePostStream) {
+TEST_P(InputStreamManagerTest, AddPacketsBeforePostStream) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(
@@ -230,7 +237,7 @@ TEST_F(InputStreamManagerTest, AddPacketsBeforePostStream) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, AddPacketsReverseTimestamps) {
+TEST_P(InputStreamManagerTest, AddPacketsReverseTimestamps) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(20)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(10)));
@@ -245,7 +252,7 @@ TEST_F(InputStreamManagerTest, AddPacketsReverseTimestamps) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, PopPacketAtTimestamp) {
+TEST_P(InputStreamManagerTest, PopPacketAtTimestamp) {
   std::string expected_value_at_10("packet 1");
   std::string expected_value_at_20("packet 2");
   std::string expected_value_at_30("packet 3");
@@ -329,7 +336,7 @@ TEST_F(InputStreamManagerTest, PopPacketAtTimestamp) {
   EXPECT_TRUE(stream_is_done_);
 }
 
-TEST_F(InputStreamManagerTest, PopQueueHead) {
+TEST_P(InputStreamManagerTest, PopQueueHead) {
   input_stream_manager_->DisableTimestamps();
   std::string expected_value_at_10("packet 1");
   std::string expected_value_at_20("packet 2");
@@ -393,7 +400,7 @@ TEST_F(InputStreamManagerTest, PopQueueHead) {
   EXPECT_TRUE(stream_is_done_);
 }
 
-TEST_F(InputStreamManagerTest, BadPacketType) {
+TEST_P(InputStreamManagerTest, BadPacketType) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<int>(10).At(Timestamp(10)));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -404,7 +411,7 @@ TEST_F(InputStreamManagerTest, BadPacketType) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, Close) {
+TEST_P(InputStreamManagerTest, Close) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -427,7 +434,7 @@ TEST_F(InputStreamManagerTest, Close) {
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
 }
 
-TEST_F(InputStreamManagerTest, ReuseInputStreamManager) {
+TEST_P(InputStreamManagerTest, ReuseInputStreamManager) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -480,7 +487,7 @@ TEST_F(InputStreamManagerTest, ReuseInputStreamManager) {
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
 }
 
-TEST_F(InputStreamManagerTest, MultipleNotifications) {
+TEST_P(InputStreamManagerTest, MultipleNotifications) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -516,7 +523,7 @@ TEST_F(InputStreamManagerTest, MultipleNotifications) {
   EXPECT_TRUE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, SetHeader) {
+TEST_P(InputStreamManagerTest, SetHeader) {
   Packet header = MakePacket<std::string>("blah");
   MP_ASSERT_OK(input_stream_manager_->SetHeader(header));
 
@@ -525,7 +532,7 @@ TEST_F(InputStreamManagerTest, SetHeader) {
   EXPECT_EQ(header.Timestamp(), input_stream_manager_->Header().Timestamp());
 }
 
-TEST_F(InputStreamManagerTest, BackwardsInTime) {
+TEST_P(InputStreamManagerTest, BackwardsInTime) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -592,7 +599,7 @@ TEST_F(InputStreamManagerTest, BackwardsInTime) {
   EXPECT_FALSE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, SelectBackwardsInTime) {
+TEST_P(InputStreamManagerTest, SelectBackwardsInTime) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -636,7 +643,7 @@ TEST_F(InputStreamManagerTest, SelectBackwardsInTime) {
                "");
 }
 
-TEST_F(InputStreamManagerTest, TimestampBound) {
+TEST_P(InputStreamManagerTest, TimestampBound) {
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
@@ -746,7 +753,7 @@ TEST_F(InputStreamManagerTest, TimestampBound) {
             input_stream_manager_->MinTimestampOrBound(&is_empty));
 }
 
-TEST_F(InputStreamManagerTest, QueueSizeTest) {
+TEST_P(InputStreamManagerTest, QueueSizeTest) {
   std::list<Packet> packets;
   int max_queue_size = 2;
   input_stream_manager_->SetMaxQueueSize(max_queue_size);
@@ -783,7 +790,7 @@ TEST_F(InputStreamManagerTest, QueueSizeTest) {
   expected_queue_becomes_not_full_count_ = 1;
 }
 
-TEST_F(InputStreamManagerTest, InputReleaseTest) {
+TEST_P(InputStreamManagerTest, InputReleaseTest) {
   packet_type_.Set<LifetimeTracker::Object>();
   input_stream_manager_ = absl::make_unique<InputStreamManager>();
   MP_ASSERT_OK(input_stream_manager_->Initialize("a_test", &packet_type_,
@@ -833,7 +840,7 @@ TEST_F(InputStreamManagerTest, InputReleaseTest) {
 
 // An attempt to add a packet after Timestamp::PreStream() should be allowed
 // if packet timestamps don't need to be increasing.
-TEST_F(InputStreamManagerTest, AddPacketsAfterPreStreamUntimed) {
+TEST_P(InputStreamManagerTest, AddPacketsAfterPreStreamUntimed) {
   input_stream_manager_->DisableTimestamps();
   std::list<Packet> packets;
   packets.push_back(
@@ -849,7 +856,7 @@ TEST_F(InputStreamManagerTest, AddPacketsAfterPreStreamUntimed) {
 
 // A packet at Timestamp::PostStream() doesn't need to be the only Packet in
 // an input stream if packet timestamps don't need to be increasing.
-TEST_F(InputStreamManagerTest, AddPacketsBeforePostStreamUntimed) {
+TEST_P(InputStreamManagerTest, AddPacketsBeforePostStreamUntimed) {
   input_stream_manager_->DisableTimestamps();
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
@@ -863,7 +870,7 @@ TEST_F(InputStreamManagerTest, AddPacketsBeforePostStreamUntimed) {
   EXPECT_TRUE(notify_);
 }
 
-TEST_F(InputStreamManagerTest, BackwardsInTimeUntimed) {
+TEST_P(InputStreamManagerTest, BackwardsInTimeUntimed) {
   input_stream_manager_->DisableTimestamps();
   std::list<Packet> packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
@@ -924,5 +931,179 @@ TEST_F(InputStreamManagerTest, BackwardsInTimeUntimed) {
   EXPECT_TRUE(notify_);
 }
 
+// Adds packets from several threads while the test thread pops them, and
+// checks that every packet is received exactly once and in order.
+TEST_P(InputStreamManagerTest, ConcurrentProducerAndConsumer) {
+  constexpr int kNumPackets = 10000;
+  std::thread producer([this] {
+    for (int i = 0; i < kNumPackets; ++i) {
+      std::list<Packet> packets;
+      packets.push_back(MakePacket<std::string>("x").At(Timestamp(i)));
+      bool notify = false;
+      MP_EXPECT_OK(input_stream_manager_->AddPackets(packets, &notify));
+    }
+    bool notify = false;
+    MP_EXPECT_OK(
+        input_stream_manager_->SetNextTimestampBound(Timestamp::Done(), &notify));
+  });
+  int next_expected = 0;
+  while (next_expected < kNumPackets) {
+    bool empty = false;
+    Timestamp timestamp = input_stream_manager_->MinTimestampOrBound(&empty);
+    if (empty) {
+      continue;
+    }
+    ASSERT_EQ(timestamp, Timestamp(next_expected));
+    popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+        timestamp, &num_packets_dropped_, &stream_is_done_);
+    ASSERT_EQ(popped_packet_.Timestamp(), Timestamp(next_expected));
+    EXPECT_EQ(num_packets_dropped_, 0);
+    ++next_expected;
+  }
+  producer.join();
+  EXPECT_TRUE(input_stream_manager_->IsEmpty());
+  EXPECT_EQ(input_stream_manager_->MinTimestampOrBound(nullptr),
+            Timestamp::Done());
+  EXPECT_EQ(input_stream_manager_->NumPacketsAdded(), kNumPackets);
+}
+
+int64 StringSize(const std::string& value) { return value.size(); }
+MEDIAPIPE_REGISTER_PACKET_SIZE_ESTIMATOR(std::string, StringSize);
+
+TEST_P(InputStreamManagerTest, MemoryAccounting) {
+  input_stream_manager_->EnableMemoryAccounting();
+  std::list<Packet> packets;
+  packets.push_back(MakePacket<std::string>("ab").At(Timestamp(10)));
+  packets.push_back(MakePacket<std::string>("cdef").At(Timestamp(20)));
+  packets.push_back(MakePacket<std::string>("g").At(Timestamp(30)));
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  EXPECT_EQ(7, input_stream_manager_->QueuedBytes());
+
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(20), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_EQ("cdef", popped_packet_.Get<std::string>());
+  EXPECT_EQ(1, input_stream_manager_->QueuedBytes());
+  input_stream_manager_->ErasePacketsEarlierThan(Timestamp(40));
+  EXPECT_EQ(0, input_stream_manager_->QueuedBytes());
+  EXPECT_EQ(7, input_stream_manager_->PeakQueuedBytes());
+  EXPECT_EQ(3, input_stream_manager_->PeakQueueSize());
+
+  input_stream_manager_->PrepareForRun();
+  EXPECT_EQ(0, input_stream_manager_->PeakQueuedBytes());
+  EXPECT_EQ(0, input_stream_manager_->PeakQueueSize());
+}
+
+TEST_P(InputStreamManagerTest, QueueByteBudget) {
+  input_stream_manager_->EnableMemoryAccounting();
+  input_stream_manager_->SetMaxQueueBytes(5);
+  EXPECT_EQ(5, input_stream_manager_->MaxQueueBytes());
+  std::list<Packet> packets;
+  packets.push_back(MakePacket<std::string>("abc").At(Timestamp(10)));
+  packets.push_back(MakePacket<std::string>("de").At(Timestamp(20)));
+  packets.push_back(MakePacket<std::string>("f").At(Timestamp(30)));
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  expected_queue_becomes_full_count_ = 1;
+  EXPECT_TRUE(input_stream_manager_->IsFull());
+
+  // 3 bytes remain queued.
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(10), &num_packets_dropped_, &stream_is_done_);
+  expected_queue_becomes_not_full_count_ = 1;
+  EXPECT_FALSE(input_stream_manager_->IsFull());
+
+  // Lowering the budget makes the queue full again.
+  input_stream_manager_->SetMaxQueueBytes(3);
+  expected_queue_becomes_full_count_ = 2;
+  EXPECT_TRUE(input_stream_manager_->IsFull());
+  input_stream_manager_->SetMaxQueueBytes(-1);
+  expected_queue_becomes_not_full_count_ = 2;
+  EXPECT_FALSE(input_stream_manager_->IsFull());
+}
+
+TEST_P(InputStreamManagerTest, SharedQueueBudget) {
+  int budget_changes = 0;
+  SharedQueueBudget budget(/*max_bytes=*/4, [&budget_changes] {
+    ++budget_changes;
+  });
+  InputStreamManager other_stream;
+  MP_ASSERT_OK(other_stream.Initialize("other", &packet_type_,
+                                       /*back_edge=*/false));
+  for (InputStreamManager* stream :
+       {input_stream_manager_.get(), &other_stream}) {
+    stream->EnableMemoryAccounting();
+    stream->SetSharedQueueBudget(&budget);
+  }
+
+  std::list<Packet> packets = {
+      MakePacket<std::string>("abc").At(Timestamp(10))};
+  MP_ASSERT_OK(input_stream_manager_->AddPackets(packets, &notify_));
+  EXPECT_FALSE(budget.IsFull());
+  packets = {MakePacket<std::string>("de").At(Timestamp(10))};
+  MP_ASSERT_OK(other_stream.AddPackets(packets, &notify_));
+  EXPECT_EQ(5, budget.QueuedBytes());
+  EXPECT_TRUE(budget.IsFull());
+  EXPECT_EQ(1, budget_changes);
+  // The budget does not make the streams themselves full.
+  EXPECT_FALSE(input_stream_manager_->IsFull());
+
+  popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+      Timestamp(10), &num_packets_dropped_, &stream_is_done_);
+  EXPECT_EQ(2, budget.QueuedBytes());
+  EXPECT_FALSE(budget.IsFull());
+  EXPECT_EQ(2, budget_changes);
+
+  budget.SetMaxBytes(2);
+  EXPECT_TRUE(budget.IsFull());
+  budget.PrepareForRun();
+  EXPECT_EQ(0, budget.QueuedBytes());
+  EXPECT_EQ(4, budget.MaxBytes());
+}
+
+// Adds packets while the test thread selects the timestamp of the packet
+// being added. Each packet must be either rejected, and never queued, or
+// popped or dropped by a later selection.
+TEST_P(InputStreamManagerTest, PacketsRacingSelectionAreRejectedOrPopped) {
+  constexpr int kNumPackets = 20000;
+  std::atomic<int> next_timestamp(0);
+  int num_accepted = 0;
+  std::thread producer([this, &next_timestamp, &num_accepted] {
+    for (int i = 0; i < kNumPackets; ++i) {
+      next_timestamp = i;
+      std::list<Packet> packets;
+      packets.push_back(MakePacket<std::string>("x").At(Timestamp(i)));
+      bool notify = false;
+      if (input_stream_manager_->AddPackets(packets, &notify).ok()) {
+        ++num_accepted;
+      }
+    }
+    next_timestamp = kNumPackets;
+  });
+  int num_removed = 0;
+  Timestamp last_selected = Timestamp::Unstarted();
+  while (last_selected < Timestamp(kNumPackets)) {
+    const Timestamp timestamp(next_timestamp.load());
+    if (timestamp == last_selected) {
+      continue;
+    }
+    last_selected = timestamp;
+    popped_packet_ = input_stream_manager_->PopPacketAtTimestamp(
+        last_selected, &num_packets_dropped_, &stream_is_done_);
+    const bool popped = !popped_packet_.IsEmpty();
+    if (popped) {
+      EXPECT_EQ(popped_packet_.Timestamp(), last_selected);
+    }
+    num_removed += num_packets_dropped_ + (popped ? 1 : 0);
+  }
+  producer.join();
+
+  // Every packet accepted was removed by a selection.
+  EXPECT_TRUE(input_stream_manager_->IsEmpty());
+  EXPECT_EQ(num_removed, num_accepted);
+  EXPECT_EQ(input_stream_manager_->NumPacketsAdded(), num_accepted);
+}
+
+INSTANTIATE_TEST_SUITE_P(LockFreeQueue, InputStreamManagerTest,
+                         ::testing::Bool());
+
 }  // namespace
 }  // namespace mediapipe
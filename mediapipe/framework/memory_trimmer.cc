@@ -0,0 +1,71 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/memory_trimmer.h"
+
+#include <memory>
+#include <utility>
+
+namespace mediapipe {
+
+const GraphService<MemoryTrimmer> kMemoryTrimmerService(
+    "kMemoryTrimmerService", GraphServiceBase::kAllowDefaultInitialization);
+
+struct MemoryTrimmer::Registration::State {
+  absl::Mutex mutex;
+  int next_id ABSL_GUARDED_BY(mutex) = 1;
+  absl::flat_hash_map<int, Callback> callbacks ABSL_GUARDED_BY(mutex);
+};
+
+MemoryTrimmer::Registration::~Registration() { Unregister(); }
+
+MemoryTrimmer::Registration& MemoryTrimmer::Registration::operator=(
+    Registration&& other) {
+  if (this != &other) {
+    Unregister();
+    state_ = std::move(other.state_);
+    id_ = other.id_;
+    other.state_.reset();
+  }
+  return *this;
+}
+
+void MemoryTrimmer::Registration::Unregister() {
+  if (auto state = state_.lock()) {
+    absl::MutexLock lock(&state->mutex);
+    state->callbacks.erase(id_);
+  }
+  state_.reset();
+}
+
+MemoryTrimmer::MemoryTrimmer()
+    : state_(std::make_shared<Registration::State>()) {}
+
+MemoryTrimmer::Registration MemoryTrimmer::Register(Callback callback) {
+  absl::MutexLock lock(&state_->mutex);
+  const int id = state_->next_id++;
+  state_->callbacks[id] = std::move(callback);
+  return Registration(state_, id);
+}
+
+void MemoryTrimmer::Trim(MemoryTrimLevel level) {
+  // Holding the lock keeps the callbacks from being unregistered, and their
+  // calculators from being closed, while they run.
+  absl::MutexLock lock(&state_->mutex);
+  for (auto& [id, callback] : state_->callbacks) {
+    callback(level);
+  }
+}
+
+}  // namespace mediapipe
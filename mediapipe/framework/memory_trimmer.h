@@ -0,0 +1,87 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_MEMORY_TRIMMER_H_
+#define MEDIAPIPE_FRAMEWORK_MEMORY_TRIMMER_H_
+
+#include <functional>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+
+// How much memory to give back when the system is low on memory.
+enum class MemoryTrimLevel {
+  // Releases the memory kept only for reuse, such as the free buffers of
+  // pools. Suits Android's TRIM_MEMORY_RUNNING_LOW.
+  kModerate,
+  // Also releases the working memory that is allocated again on the next use,
+  // such as the arenas of TFLite interpreters. Suits an app in the background
+  // and iOS memory warnings.
+  kComplete,
+};
+
+// Lets calculators give back memory under memory pressure.
+// CalculatorGraph::TrimMemory trims the pools of the graph and then calls the
+// callbacks registered here. Everything released is allocated again lazily.
+class MemoryTrimmer {
+ public:
+  using Callback = std::function<void(MemoryTrimLevel)>;
+
+  // Unregisters its callback when destroyed, waiting for a running call to
+  // return.
+  class Registration {
+   public:
+    Registration() = default;
+    ~Registration();
+    Registration(Registration&& other) { *this = std::move(other); }
+    Registration& operator=(Registration&& other);
+
+   private:
+    friend class MemoryTrimmer;
+    struct State;
+
+    Registration(std::weak_ptr<State> state, int id)
+        : state_(std::move(state)), id_(id) {}
+
+    void Unregister();
+
+    std::weak_ptr<State> state_;
+    int id_ = 0;
+  };
+
+  MemoryTrimmer();
+
+  // Registers `callback` to run on each Trim until the returned Registration
+  // is destroyed. The callback runs on the thread calling Trim, concurrently
+  // with the calculator, and must not register or unregister callbacks.
+  Registration Register(Callback callback);
+
+  // Calls the registered callbacks.
+  void Trim(MemoryTrimLevel level);
+
+ private:
+  std::shared_ptr<Registration::State> state_;
+};
+
+// Provides the MemoryTrimmer of a graph. It is created with the graph when a
+// calculator requests it.
+extern const GraphService<MemoryTrimmer> kMemoryTrimmerService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_MEMORY_TRIMMER_H_
@@ -0,0 +1,135 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/memory_trimmer.h"
+
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/image_frame_pool_service.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(MemoryTrimmerTest, CallsRegisteredCallbacks) {
+  MemoryTrimmer trimmer;
+  std::vector<MemoryTrimLevel> levels;
+  MemoryTrimmer::Registration registration = trimmer.Register(
+      [&levels](MemoryTrimLevel level) { levels.push_back(level); });
+  trimmer.Trim(MemoryTrimLevel::kModerate);
+  trimmer.Trim(MemoryTrimLevel::kComplete);
+  EXPECT_THAT(levels, ElementsAre(MemoryTrimLevel::kModerate,
+                                  MemoryTrimLevel::kComplete));
+}
+
+TEST(MemoryTrimmerTest, UnregistersWhenRegistrationIsDestroyed) {
+  MemoryTrimmer trimmer;
+  int num_calls = 0;
+  {
+    MemoryTrimmer::Registration registration =
+        trimmer.Register([&num_calls](MemoryTrimLevel) { ++num_calls; });
+    // A moved registration keeps the callback registered.
+    MemoryTrimmer::Registration moved = std::move(registration);
+    trimmer.Trim(MemoryTrimLevel::kModerate);
+  }
+  trimmer.Trim(MemoryTrimLevel::kModerate);
+  EXPECT_EQ(num_calls, 1);
+}
+
+TEST(MemoryTrimmerTest, RegistrationCanOutliveTrimmer) {
+  MemoryTrimmer::Registration registration;
+  {
+    MemoryTrimmer trimmer;
+    registration = trimmer.Register([](MemoryTrimLevel) {});
+  }
+}
+
+std::vector<MemoryTrimLevel>* trimmed_levels = nullptr;
+
+// Passes its input through, allocating a frame from the graph's pool for
+// each packet, and records the trims of the graph.
+class TrimRecordingCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    UseImageFrameMultiPool(cc);
+    cc->UseService(kMemoryTrimmerService).Optional();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    RET_CHECK(cc->Service(kMemoryTrimmerService).IsAvailable());
+    registration_ = cc->Service(kMemoryTrimmerService)
+                        .GetObject()
+                        .Register([](MemoryTrimLevel level) {
+                          trimmed_levels->push_back(level);
+                        });
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    AllocateImageFrame(cc, ImageFormat::SRGB, 16, 16);
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+
+ private:
+  MemoryTrimmer::Registration registration_;
+};
+REGISTER_CALCULATOR(TrimRecordingCalculator);
+
+TEST(MemoryTrimmerTest, GraphTrimsCalculators) {
+  std::vector<MemoryTrimLevel> levels;
+  trimmed_levels = &levels;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    output_stream: "out"
+    node {
+      calculator: "TrimRecordingCalculator"
+      input_stream: "in"
+      output_stream: "out"
+    }
+  )pb")));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+
+  graph.TrimMemory(MemoryTrimLevel::kComplete);
+  EXPECT_THAT(levels, ElementsAre(MemoryTrimLevel::kComplete));
+
+  // Calculators are no longer trimmed once the graph is done.
+  levels.clear();
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  graph.TrimMemory(MemoryTrimLevel::kComplete);
+  EXPECT_THAT(levels, IsEmpty());
+  trimmed_levels = nullptr;
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -16,6 +16,7 @@
 
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/collection_item_id.h"
+#include "mediapipe/framework/input_stream_handler.h"
 #include "mediapipe/framework/output_stream_shard.h"
 
 namespace mediapipe {
@@ -126,6 +127,7 @@ void OutputStreamHandler::TryPropagateTimestampBound(Timestamp input_bound) {
   if (!input_bound.IsRangeValue()) {
     return;
   }
+  InputStreamHandler::BatchedNotifications batched_notifications;
   OutputStreamShard empty_output;
   for (OutputStreamManager* manager : output_stream_managers_) {
     if (manager->OffsetEnabled() && !manager->IsClosed() &&
@@ -137,6 +139,7 @@ void OutputStreamHandler::TryPropagateTimestampBound(Timestamp input_bound) {
 }
 
 void OutputStreamHandler::Close(OutputStreamShardSet* output_shards) {
+  InputStreamHandler::BatchedNotifications batched_notifications;
   for (CollectionItemId id = output_stream_managers_.BeginId();
        id < output_stream_managers_.EndId(); ++id) {
     if (output_shards) {
@@ -150,6 +153,9 @@ void OutputStreamHandler::Close(OutputStreamShardSet* output_shards) {
 void OutputStreamHandler::PropagateOutputPackets(
     Timestamp input_timestamp, OutputStreamShardSet* output_shards) {
   CHECK(output_shards);
+  // Notifies each downstream node once, after all the output streams are
+  // updated.
+  InputStreamHandler::BatchedNotifications batched_notifications;
   for (CollectionItemId id = output_stream_managers_.BeginId();
        id < output_stream_managers_.EndId(); ++id) {
     OutputStreamManager* manager = output_stream_managers_.Get(id);
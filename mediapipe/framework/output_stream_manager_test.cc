@@ -40,7 +40,7 @@ class OutputStreamManagerTest : public ::testing::Test {
     headers_ready_callback_ =
         std::bind(&OutputStreamManagerTest::HeadersReadyNoOp, this);
     notification_callback_ =
-        std::bind(&OutputStreamManagerTest::NotifyNoOp, this);
+        std::bind(&OutputStreamManagerTest::CountNotification, this);
     schedule_callback_ = std::bind(&OutputStreamManagerTest::ScheduleNoOp, this,
                                    std::placeholders::_1);
     error_callback_ = std::bind(&OutputStreamManagerTest::RecordError, this,
@@ -81,7 +81,7 @@ class OutputStreamManagerTest : public ::testing::Test {
 
   void HeadersReadyNoOp() {}
 
-  void NotifyNoOp() {}
+  void CountNotification() { ++num_notifications_; }
 
   void ScheduleNoOp(CalculatorContext* cc) {}
 
@@ -115,6 +115,8 @@ class OutputStreamManagerTest : public ::testing::Test {
 
   // Vector of errors encountered while using the stream.
   std::vector<absl::Status> errors_;
+  // Number of times the downstream node was notified.
+  int num_notifications_ = 0;
 };
 
 TEST_F(OutputStreamManagerTest, Init) {}
@@ -688,5 +690,27 @@ TEST_F(OutputStreamManagerTest, AddPacketAndMovePacket) {
   EXPECT_TRUE(errors_.empty());
 }
 
+TEST_F(OutputStreamManagerTest, BatchesNotifications) {
+  output_stream_shard_.SetNextTimestampBound(Timestamp(10));
+  EXPECT_EQ(Timestamp(10), ComputeBoundAndPropagateUpdates(Timestamp(0)));
+  EXPECT_EQ(num_notifications_, 1);
+
+  {
+    InputStreamHandler::BatchedNotifications batched_notifications;
+    output_stream_manager_->ResetShard(&output_stream_shard_);
+    output_stream_shard_.SetNextTimestampBound(Timestamp(20));
+    EXPECT_EQ(Timestamp(20), ComputeBoundAndPropagateUpdates(Timestamp(10)));
+    output_stream_manager_->ResetShard(&output_stream_shard_);
+    output_stream_shard_.AddPacket(
+        MakePacket<std::string>("packet 1").At(Timestamp(20)));
+    EXPECT_EQ(Timestamp(21), ComputeBoundAndPropagateUpdates(Timestamp(20)));
+    // The node is notified once, when the batch goes out of scope.
+    EXPECT_EQ(num_notifications_, 1);
+  }
+  EXPECT_EQ(num_notifications_, 2);
+  EXPECT_EQ(input_stream_manager_.QueueSize(), 1);
+  EXPECT_TRUE(errors_.empty());
+}
+
 }  // namespace
 }  // namespace mediapipe
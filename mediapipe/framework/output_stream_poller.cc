@@ -0,0 +1,59 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/output_stream_poller.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace mediapipe {
+
+SyncedOutputStreamPoller::SyncedOutputStreamPoller(
+    std::vector<OutputStreamPoller> pollers)
+    : pollers_(std::move(pollers)), next_packets_(pollers_.size()) {}
+
+bool SyncedOutputStreamPoller::Next(std::vector<Packet>* packets,
+                                    Timestamp* timestamp) {
+  while (true) {
+    Timestamp min_timestamp = Timestamp::Done();
+    for (int i = 0; i < pollers_.size(); ++i) {
+      Packet& next_packet = next_packets_[i];
+      if (next_packet.Timestamp() == Timestamp::Unset() &&
+          !pollers_[i].Next(&next_packet)) {
+        next_packet = Packet().At(Timestamp::Done());
+      }
+      min_timestamp = std::min(min_timestamp, next_packet.Timestamp());
+    }
+    if (min_timestamp == Timestamp::Done()) {
+      return false;
+    }
+    packets->assign(pollers_.size(), Packet());
+    bool has_packet = false;
+    for (int i = 0; i < pollers_.size(); ++i) {
+      if (next_packets_[i].Timestamp() == min_timestamp) {
+        has_packet |= !next_packets_[i].IsEmpty();
+        (*packets)[i] = std::exchange(next_packets_[i], Packet());
+      }
+    }
+    // Skips the timestamps at which all the streams only have timestamp
+    // bound updates.
+    if (has_packet) {
+      *timestamp = min_timestamp;
+      return true;
+    }
+  }
+}
+
+}  // namespace mediapipe
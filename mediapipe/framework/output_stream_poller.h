@@ -16,8 +16,13 @@
 #define MEDIAPIPE_FRAMEWORK_OUTPUT_STREAM_POLLER_H_
 
 #include <memory>
+#include <vector>
 
+#include "absl/base/attributes.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/graph_output_stream.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/timestamp.h"
 
 namespace mediapipe {
 
@@ -48,6 +53,22 @@ class OutputStreamPoller {
     return poller->Next(packet);
   }
 
+  // Gets up to `max_packets` available packets, waiting until there is at
+  // least one, the stream is done, or `timeout` expires. Draining a high-rate
+  // stream this way takes one wakeup per batch rather than per packet. Returns
+  // false if the stream is done and no packets are returned, and true with no
+  // packets on timeout.
+  ABSL_MUST_USE_RESULT bool NextBatch(
+      std::vector<Packet>* packets, int max_packets,
+      absl::Duration timeout = absl::InfiniteDuration()) {
+    auto poller = internal_poller_impl_.lock();
+    if (!poller) {
+      packets->clear();
+      return false;
+    }
+    return poller->NextBatch(packets, max_packets, timeout);
+  }
+
   void SetMaxQueueSize(int queue_size) {
     auto poller = internal_poller_impl_.lock();
     CHECK(poller) << "OutputStreamPollerImpl is already destroyed.";
@@ -73,6 +94,28 @@ class OutputStreamPoller {
   friend class CalculatorGraph;
 };
 
+// Polls several output streams and returns their packets one timestamp at a
+// time, so that the application doesn't need to synchronize the streams. The
+// pollers should observe timestamp bounds. Otherwise, a timestamp at which a
+// stream has no packet is only returned after that stream's next packet.
+class SyncedOutputStreamPoller {
+ public:
+  explicit SyncedOutputStreamPoller(std::vector<OutputStreamPoller> pollers);
+
+  // Gets the packets of all the streams at the next timestamp with at least
+  // one packet, in the order of the pollers. Streams without a packet at that
+  // timestamp get an empty packet. Returns false once all the streams are
+  // done.
+  ABSL_MUST_USE_RESULT bool Next(std::vector<Packet>* packets,
+                                 Timestamp* timestamp);
+
+ private:
+  std::vector<OutputStreamPoller> pollers_;
+  // The next packet of each stream, which is Unset if it needs to be polled
+  // and Done if the stream is done.
+  std::vector<Packet> next_packets_;
+};
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_OUTPUT_STREAM_POLLER_H_
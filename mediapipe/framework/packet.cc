@@ -14,6 +14,9 @@
 
 #include "mediapipe/framework/packet.h"
 
+#include <atomic>
+#include <cstdint>
+
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
@@ -28,6 +31,20 @@ namespace packet_internal {
 
 HolderBase::~HolderBase() {}
 
+int64_t NewInlineDataId() {
+  // Each thread takes ids in blocks, so making packets on several threads
+  // doesn't contend on the shared counter.
+  constexpr int64_t kBlockSize = 1024;
+  static std::atomic<int64_t> next_block(0);
+  thread_local int64_t next_id = 0;
+  thread_local int64_t end_id = 0;
+  if (next_id == end_id) {
+    next_id = next_block.fetch_add(kBlockSize, std::memory_order_relaxed);
+    end_id = next_id + kBlockSize;
+  }
+  return -1 - next_id++;
+}
+
 Packet Create(HolderBase* holder) {
   Packet result;
   result.holder_.reset(holder);
@@ -41,7 +58,7 @@ Packet Create(HolderBase* holder, Timestamp timestamp) {
   return result;
 }
 
-Packet Create(std::shared_ptr<HolderBase> holder, Timestamp timestamp) {
+Packet Create(HolderPtr holder, Timestamp timestamp) {
   Packet result;
   result.holder_ = std::move(holder);
   result.timestamp_ = timestamp;
@@ -18,9 +18,13 @@
 #define MEDIAPIPE_FRAMEWORK_PACKET_H_
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <new>
 #include <string>
 #include <type_traits>
+#include <utility>
 
 #include "absl/base/macros.h"
 #include "absl/memory/memory.h"
@@ -28,6 +32,7 @@
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/packet_arena.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
@@ -36,6 +41,7 @@
 #include "mediapipe/framework/port/status_builder.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/proto_arena_pool.h"
 #include "mediapipe/framework/timestamp.h"
 #include "mediapipe/framework/tool/type_util.h"
 #include "mediapipe/framework/type_map.h"
@@ -46,15 +52,124 @@ class Packet;
 
 namespace packet_internal {
 class HolderBase;
+template <typename T>
+class InlineHolder;
+
+// A pointer to the holder of a Packet. Usually this is a shared_ptr, but the
+// holder of a payload made with MakeInlinePacket (see kInlineAllocatable) is
+// stored in the HolderPtr itself. Copying such a HolderPtr copies the holder
+// and its payload, which needs neither a heap allocation nor an atomic
+// reference count.
+class HolderPtr {
+ public:
+  // Fits the holder of a payload of up to pointer size, along with its id.
+  static constexpr size_t kInlineSize =
+      2 * sizeof(void*) + 2 * sizeof(int64_t);
+
+  HolderPtr() : shared_() {}
+  HolderPtr(std::nullptr_t) : shared_() {}  // NOLINT
+  template <typename H>
+  HolderPtr(std::shared_ptr<H> holder)  // NOLINT
+      : shared_(std::move(holder)) {}
+  HolderPtr(const HolderPtr& other);
+  HolderPtr(HolderPtr&& other);
+  HolderPtr& operator=(const HolderPtr& other);
+  HolderPtr& operator=(HolderPtr&& other);
+  ~HolderPtr() { Destroy(); }
+
+  // Returns a HolderPtr storing an InlineHolder<T> constructed from "args".
+  template <typename T, typename... Args>
+  static HolderPtr MakeInline(Args&&... args);
+
+  HolderBase* get() const {
+    return is_inline_ ? inline_holder() : shared_.get();
+  }
+  HolderBase* operator->() const { return get(); }
+  HolderBase& operator*() const { return *get(); }
+  explicit operator bool() const { return get() != nullptr; }
+
+  // Returns true if no other HolderPtr shares the holder.
+  bool unique() const { return is_inline_ || shared_.use_count() == 1; }
+
+  void reset();
+  void reset(HolderBase* holder);
+
+  // Holders are equal if they are the same object, or copies of the same
+  // inline holder.
+  friend bool operator==(const HolderPtr& a, const HolderPtr& b);
+  friend bool operator!=(const HolderPtr& a, const HolderPtr& b) {
+    return !(a == b);
+  }
+  friend bool operator==(const HolderPtr& a, std::nullptr_t) { return !a; }
+  friend bool operator!=(const HolderPtr& a, std::nullptr_t) {
+    return static_cast<bool>(a);
+  }
+
+ private:
+  // The holder is constructed at the start of storage_, and its HolderBase
+  // subobject is at offset zero since holders use single inheritance only.
+  HolderBase* inline_holder() const {
+    return reinterpret_cast<HolderBase*>(const_cast<unsigned char*>(storage_));
+  }
+  void CopyFrom(const HolderPtr& other);
+  void MoveFrom(HolderPtr&& other);
+  void Destroy();
+
+  union {
+    std::shared_ptr<HolderBase> shared_;
+    alignas(std::shared_ptr<HolderBase>) alignas(int64_t) unsigned char
+        storage_[kInlineSize];
+  };
+  bool is_inline_ = false;
+};
 
 Packet Create(HolderBase* holder);
 Packet Create(HolderBase* holder, Timestamp timestamp);
-Packet Create(std::shared_ptr<HolderBase> holder, Timestamp timestamp);
+Packet Create(HolderPtr holder, Timestamp timestamp);
 const HolderBase* GetHolder(const Packet& packet);
-const std::shared_ptr<HolderBase>& GetHolderShared(const Packet& packet);
-std::shared_ptr<HolderBase> GetHolderShared(Packet&& packet);
+const HolderPtr& GetHolderShared(const Packet& packet);
+HolderPtr GetHolderShared(Packet&& packet);
 absl::StatusOr<Packet> PacketFromDynamicProto(const std::string& type_name,
                                               const std::string& serialized);
+
+// Types that MakePacket may place in a PacketArena. The data must be movable
+// so that Packet::Consume() can still hand it out as a unique_ptr.
+template <typename T>
+constexpr bool kArenaAllocatable =
+    !std::is_array<T>::value && !std::is_const<T>::value &&
+    std::is_move_constructible<T>::value;
+
+// Types that MakeInlinePacket can store inline in the Packet. Copies of such a
+// packet hold copies of the payload, so T must be trivially copyable.
+template <typename T>
+constexpr bool kInlineAllocatable =
+    !std::is_array<T>::value && !std::is_const<T>::value &&
+    std::is_trivially_copyable<T>::value && sizeof(T) <= sizeof(void*) &&
+    alignof(T) <= alignof(void*);
+
+// Returns a holder for a T constructed from "args", allocated together with
+// its control block in "arena".
+template <typename T, typename... Args>
+std::shared_ptr<HolderBase> MakeArenaHolder(
+    const std::shared_ptr<PacketArena>& arena, Args&&... args);
+
+// True if MakePacket<T>(args...) may keep a proto message on the protobuf
+// arena of the current calculator invocation: T is a message, made from
+// another T.
+template <typename T, typename... Args>
+constexpr bool kProtoArenaMovable = false;
+template <typename T, typename Arg>
+constexpr bool kProtoArenaMovable<T, Arg> =
+    std::is_base_of<proto_ns::MessageLite, T>::value &&
+    std::is_same<typename std::decay<Arg>::type, T>::value;
+
+// If "message" lives on the protobuf arena of the current calculator
+// invocation (see ProtoArenaPool), returns a holder for a T on the same arena,
+// assigned from "message", and sharing the ownership of the arena. Since both
+// messages are on the same arena, moving swaps them. Returns nullptr, leaving
+// "message" untouched, otherwise.
+template <typename T, typename Arg>
+std::shared_ptr<HolderBase> MakeProtoArenaHolder(Arg&& message);
 }  // namespace packet_internal
 
 // A generic container class which can hold data of any type.  The type of
@@ -64,6 +179,8 @@ absl::StatusOr<Packet> PacketFromDynamicProto(const std::string& type_name,
 // that copying Packets creates a fast, shallow copy.  Packets are
 // copyable, movable, and assignable.  Packets can be stored in STL
 // containers.  A Packet may optionally contain a timestamp.
+// MakeInlinePacket instead keeps a small payload in the Packet itself, which
+// is why sizeof(Packet) is 48 bytes on 64-bit platforms.
 //
 // The preferred method of creating a Packet is with MakePacket<T>().
 // The Packet typically owns the object that it contains, but
@@ -103,6 +220,10 @@ class Packet {
   // Returns the reference to the object of typename T if it contains
   // one, crashes otherwise. It is safe to concurrently call Get()
   // on the same packet from multiple threads.
+  // For a packet made with MakeInlinePacket, the reference points into this
+  // Packet object, so it is only valid while this object is alive and not
+  // assigned to, e.g. `const int& v = MakeInlinePacket<int>(1).Get<int>();`
+  // dangles. For other packets it is valid while any copy of the packet is.
   template <typename T>
   const T& Get() const;
 
@@ -209,20 +330,19 @@ class Packet {
   friend Packet packet_internal::Create(packet_internal::HolderBase* holder);
   friend Packet packet_internal::Create(packet_internal::HolderBase* holder,
                                         class Timestamp timestamp);
-  friend Packet packet_internal::Create(
-      std::shared_ptr<packet_internal::HolderBase> holder,
-      class Timestamp timestamp);
+  friend Packet packet_internal::Create(packet_internal::HolderPtr holder,
+                                        class Timestamp timestamp);
   friend const packet_internal::HolderBase* packet_internal::GetHolder(
       const Packet& packet);
-  friend const std::shared_ptr<packet_internal::HolderBase>&
-  packet_internal::GetHolderShared(const Packet& packet);
-  friend std::shared_ptr<packet_internal::HolderBase>
-  packet_internal::GetHolderShared(Packet&& packet);
+  friend const packet_internal::HolderPtr& packet_internal::GetHolderShared(
+      const Packet& packet);
+  friend packet_internal::HolderPtr packet_internal::GetHolderShared(
+      Packet&& packet);
 
   friend class PacketType;
   absl::Status ValidateAsType(TypeId type_id) const;
 
-  std::shared_ptr<packet_internal::HolderBase> holder_;
+  packet_internal::HolderPtr holder_;
   class Timestamp timestamp_;
 };
 
@@ -308,6 +428,19 @@ template <typename T,
           typename std::enable_if<!std::is_array<T>::value>::type* = nullptr,
           typename... Args>
 Packet MakePacket(Args&&... args) {  // NOLINT(build/c++11)
+  if constexpr (packet_internal::kProtoArenaMovable<T, Args...>) {
+    if (auto holder = packet_internal::MakeProtoArenaHolder<T>(
+            std::forward<Args>(args)...)) {
+      return packet_internal::Create(std::move(holder), Timestamp::Unset());
+    }
+  }
+  if constexpr (packet_internal::kArenaAllocatable<T>) {
+    if (const std::shared_ptr<PacketArena>* arena = PacketArena::Current()) {
+      return packet_internal::Create(packet_internal::MakeArenaHolder<T>(
+                                         *arena, std::forward<Args>(args)...),
+                                     Timestamp::Unset());
+    }
+  }
   return Adopt(new T(std::forward<Args>(args)...));
 }
 
@@ -324,6 +457,23 @@ Packet MakePacket(Args&&... args) {  // NOLINT(build/c++11)
       new T{std::forward<typename std::remove_extent<T>::type>(args)...}));
 }
 
+// Like MakePacket, but stores a small trivially copyable payload, such as an
+// int, a float or a Timestamp, inside the Packet. This saves the heap
+// allocation of the holder and the atomic reference counting on each copy.
+// Since each copy of the packet holds its own copy of the payload:
+// - Get() returns a reference into the Packet object itself, which dangles
+//   once that object is destroyed or assigned to.
+// - Consume() on a copy succeeds and leaves the other copies intact.
+// Copies of the packet still compare equal.
+template <typename T, typename... Args>
+Packet MakeInlinePacket(Args&&... args) {
+  static_assert(packet_internal::kInlineAllocatable<T>,
+                "MakeInlinePacket needs a small trivially copyable type.");
+  return packet_internal::Create(
+      packet_internal::HolderPtr::MakeInline<T>(std::forward<Args>(args)...),
+      Timestamp::Unset());
+}
+
 // Returns a mutable pointer to the data in a unique_ptr in a packet. This
 // is useful in combination with AdoptAsUniquePtr.  The caller must
 // exercise caution when mutating the retrieved data, since the data
@@ -340,12 +490,10 @@ T* GetFromUniquePtr(const Packet& packet) {
 // if you want to try and modify the payload directly.
 template <typename T>
 std::shared_ptr<const T> SharedPtrWithPacket(Packet packet) {
-  // This needs to be a separate statement because the evaluation order of
-  // function arguments is unspecified, and if the lambda is created first it
-  // moves the packet.
-  const T* ptr = &packet.Get<T>();
-  return std::shared_ptr<const T>(
-      ptr, [packet = std::move(packet)](const T* ptr) mutable { packet = {}; });
+  // The payload may be stored inside the Packet object, so it must be
+  // addressed only after the packet has reached its final location.
+  auto shared_packet = std::make_shared<const Packet>(std::move(packet));
+  return std::shared_ptr<const T>(shared_packet, &shared_packet->Get<T>());
 }
 
 //// Implementation details.
@@ -393,6 +541,27 @@ class HolderBase {
   GetVectorOfProtoMessageLite() const = 0;
 
   virtual bool HasForeignOwner() const { return false; }
+
+  // Returns true if the data is stored inside the holder rather than in a
+  // separate heap allocation.
+  virtual bool HoldsDataInline() const { return false; }
+
+  // For holders stored in a HolderPtr: copy-constructs this holder into
+  // "storage".
+  virtual void CopyInlineTo(void* storage) const {
+    LOG(FATAL) << "Holder can't be stored inline.";
+  }
+
+  // Returns an id that is the same for all copies of a packet, and unique
+  // among the packets alive. Inline holders, which are copied along with the
+  // packet, get a negative id when they are created. Other holders are
+  // identified by their address.
+  virtual int64_t DataId() const { return reinterpret_cast<intptr_t>(this); }
+
+  // For a payload of arithmetic, enum or Timestamp type, appends its bytes to
+  // "bytes" and returns true. Equal bytes then mean equal values. Returns
+  // false for other payloads.
+  virtual bool AppendScalarBytes(std::string* bytes) const { return false; }
 };
 
 // Two helper functions to get the proto base pointers.
@@ -506,6 +675,15 @@ class Holder : public HolderBase {
     return *ptr_;
   }
   TypeId GetTypeId() const final { return kTypeId<T>; }
+  bool AppendScalarBytes(std::string* bytes) const final {
+    if constexpr (std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+                  std::is_same<T, Timestamp>::value) {
+      bytes->append(reinterpret_cast<const char*>(ptr_), sizeof(T));
+      return true;
+    } else {
+      return false;
+    }
+  }
   // Releases the underlying data pointer and transfers the ownership to a
   // unique pointer.
   // This method is dangerous and is only used by Packet::Consume() if the
@@ -518,6 +696,9 @@ class Holder : public HolderBase {
       return InternalError(
           "Foreign holder can't release data ptr without ownership.");
     }
+    if (HoldsDataInline()) {
+      return MoveInlineData();
+    }
     // Casts away constness to make the data mutable after the release.
     std::unique_ptr<T> data_ptr(const_cast<T*>(ptr_));
     ptr_ = nullptr;
@@ -563,6 +744,16 @@ class Holder : public HolderBase {
   }
 
  private:
+  // Moves data stored inside the holder into a new heap object.
+  absl::StatusOr<std::unique_ptr<T>> MoveInlineData() {
+    if constexpr (std::is_move_constructible<T>::value) {
+      return absl::make_unique<T>(std::move(*const_cast<T*>(ptr_)));
+    } else {
+      return absl::InternalError(
+          "Holder can't release inline data that is not movable.");
+    }
+  }
+
   // Call delete[] if T is an array, delete otherwise.
   template <typename U = T>
   inline void delete_helper(
@@ -593,6 +784,173 @@ class ForeignHolder : public Holder<T> {
   bool HasForeignOwner() const final { return true; }
 };
 
+// Like Holder, but stores the data inline. Created by MakeArenaHolder so that
+// the data, the holder and the shared_ptr control block occupy a single
+// PacketArena block.
+template <typename T>
+class ArenaHolder : public Holder<T> {
+ public:
+  template <typename... Args>
+  explicit ArenaHolder(Args&&... args)
+      : Holder<T>(&data_), data_(std::forward<Args>(args)...) {}
+  ~ArenaHolder() override {
+    // Null out ptr_ so it doesn't get deleted by ~Holder; data_ is destroyed
+    // with this object.
+    this->ptr_ = nullptr;
+  }
+  bool HoldsDataInline() const final { return true; }
+
+ private:
+  T data_;
+};
+
+template <typename T, typename... Args>
+std::shared_ptr<HolderBase> MakeArenaHolder(
+    const std::shared_ptr<PacketArena>& arena, Args&&... args) {
+  return std::allocate_shared<ArenaHolder<T>>(
+      PacketArenaAllocator<ArenaHolder<T>>(arena),
+      std::forward<Args>(args)...);
+}
+
+// Holds a message allocated on a protobuf arena, and keeps the arena alive.
+// Created by MakeProtoArenaHolder.
+template <typename T>
+class ProtoArenaHolder : public Holder<T> {
+ public:
+  ProtoArenaHolder(const T* ptr, std::shared_ptr<proto_ns::Arena> arena)
+      : Holder<T>(ptr), arena_(std::move(arena)) {}
+  ~ProtoArenaHolder() override {
+    // Null out ptr_ so it doesn't get deleted by ~Holder; the arena owns it.
+    this->ptr_ = nullptr;
+  }
+  // Lets Consume() move the data to the heap, since the arena cannot release
+  // it.
+  bool HoldsDataInline() const final { return true; }
+
+ private:
+  std::shared_ptr<proto_ns::Arena> arena_;
+};
+
+template <typename T, typename Arg>
+std::shared_ptr<HolderBase> MakeProtoArenaHolder(Arg&& message) {
+  proto_ns::Arena* const arena = message.GetArena();
+  if (arena == nullptr) return nullptr;
+  const std::shared_ptr<proto_ns::Arena>* current =
+      ProtoArenaPool::FindCurrentArena(arena);
+  if (current == nullptr) return nullptr;
+  T* data = proto_ns::Arena::CreateMessage<T>(arena);
+  *data = std::forward<Arg>(message);
+  return std::make_shared<ProtoArenaHolder<T>>(data, *current);
+}
+
+// Returns a new id for an InlineHolder. Ids are negative, so they differ
+// from the ids of other holders.
+int64_t NewInlineDataId();
+
+// Like ArenaHolder, but constructed inside a HolderPtr. T must be trivially
+// copyable (see kInlineAllocatable).
+template <typename T>
+class InlineHolder : public Holder<T> {
+ public:
+  template <typename... Args>
+  explicit InlineHolder(Args&&... args)
+      : Holder<T>(&data_),
+        data_(std::forward<Args>(args)...),
+        id_(NewInlineDataId()) {}
+  InlineHolder(const InlineHolder& other) : Holder<T>(&data_), id_(other.id_) {
+    std::memcpy(&data_, &other.data_, sizeof(T));
+  }
+  ~InlineHolder() override { this->ptr_ = nullptr; }
+  bool HoldsDataInline() const final { return true; }
+  void CopyInlineTo(void* storage) const final {
+    new (storage) InlineHolder(*this);
+  }
+  int64_t DataId() const final { return id_; }
+
+ private:
+  union {
+    T data_;
+  };
+  const int64_t id_;
+};
+
+inline HolderPtr::HolderPtr(const HolderPtr& other) { CopyFrom(other); }
+
+inline HolderPtr::HolderPtr(HolderPtr&& other) { MoveFrom(std::move(other)); }
+
+inline HolderPtr& HolderPtr::operator=(const HolderPtr& other) {
+  if (this != &other) {
+    Destroy();
+    CopyFrom(other);
+  }
+  return *this;
+}
+
+inline HolderPtr& HolderPtr::operator=(HolderPtr&& other) {
+  if (this != &other) {
+    Destroy();
+    MoveFrom(std::move(other));
+  }
+  return *this;
+}
+
+template <typename T, typename... Args>
+HolderPtr HolderPtr::MakeInline(Args&&... args) {
+  static_assert(sizeof(InlineHolder<T>) <= kInlineSize &&
+                    alignof(InlineHolder<T>) <= alignof(HolderPtr),
+                "Holder doesn't fit in HolderPtr.");
+  HolderPtr result;
+  result.shared_.~shared_ptr();
+  new (result.storage_) InlineHolder<T>(std::forward<Args>(args)...);
+  result.is_inline_ = true;
+  return result;
+}
+
+inline void HolderPtr::reset() {
+  Destroy();
+  new (&shared_) std::shared_ptr<HolderBase>();
+}
+
+inline void HolderPtr::reset(HolderBase* holder) {
+  reset();
+  shared_.reset(holder);
+}
+
+inline void HolderPtr::CopyFrom(const HolderPtr& other) {
+  is_inline_ = other.is_inline_;
+  if (is_inline_) {
+    other.inline_holder()->CopyInlineTo(storage_);
+  } else {
+    new (&shared_) std::shared_ptr<HolderBase>(other.shared_);
+  }
+}
+
+inline void HolderPtr::MoveFrom(HolderPtr&& other) {
+  is_inline_ = other.is_inline_;
+  if (is_inline_) {
+    other.inline_holder()->CopyInlineTo(storage_);
+    other.reset();
+  } else {
+    new (&shared_) std::shared_ptr<HolderBase>(std::move(other.shared_));
+  }
+}
+
+inline void HolderPtr::Destroy() {
+  if (is_inline_) {
+    inline_holder()->~HolderBase();
+    is_inline_ = false;
+  } else {
+    shared_.~shared_ptr();
+  }
+}
+
+inline bool operator==(const HolderPtr& a, const HolderPtr& b) {
+  if (a.is_inline_ && b.is_inline_) {
+    return a->DataId() == b->DataId();
+  }
+  return a.get() == b.get();
+}
+
 template <typename T>
 Holder<T>* HolderBase::As() {
   if (PayloadIsOfType<T>()) {
@@ -772,8 +1130,10 @@ Packet PointToForeign(const T* ptr) {
 }
 
 // Equal Packets refer to the same memory contents, like equal pointers.
+// Copies of a packet holding its payload inline are equal as well.
 inline bool operator==(const Packet& p1, const Packet& p2) {
-  return packet_internal::GetHolder(p1) == packet_internal::GetHolder(p2);
+  return packet_internal::GetHolderShared(p1) ==
+         packet_internal::GetHolderShared(p2);
 }
 inline bool operator!=(const Packet& p1, const Packet& p2) {
   return !(p1 == p2);
@@ -781,12 +1141,11 @@ inline bool operator!=(const Packet& p1, const Packet& p2) {
 
 namespace packet_internal {
 
-inline const std::shared_ptr<HolderBase>& GetHolderShared(
-    const Packet& packet) {
+inline const HolderPtr& GetHolderShared(const Packet& packet) {
   return packet.holder_;
 }
 
-inline std::shared_ptr<HolderBase> GetHolderShared(Packet&& packet) {
+inline HolderPtr GetHolderShared(Packet&& packet) {
   return std::move(packet.holder_);
 }
 
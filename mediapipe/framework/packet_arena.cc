@@ -0,0 +1,172 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_arena.h"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Block sizes, in increasing order. A Holder and control block for a small
+// payload such as a bool or a NormalizedRect fits in the smallest one.
+constexpr size_t kBlockSizes[] = {64, 128, 256, 512};
+constexpr int kNumSizeClasses = sizeof(kBlockSizes) / sizeof(kBlockSizes[0]);
+
+// Every size class reserves memory in slabs of this size.
+constexpr size_t kSlabSize = 64 * 1024;
+
+// Blocks are aligned to this, which is what operator new guarantees.
+constexpr size_t kMaxAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+}  // namespace
+
+class PacketArena::SizeClass {
+ public:
+  void Init(size_t block_size) { block_size_ = block_size; }
+
+  // Returns a free block, or nullptr if a new one must be carved out.
+  void* PopFree() {
+    absl::MutexLock lock(&mutex_);
+    FreeBlock* block = free_list_;
+    if (block != nullptr) {
+      free_list_ = block->next;
+    }
+    return block;
+  }
+
+  // Carves a new block out of the current slab. Sets "new_slab" if a slab had
+  // to be reserved for it.
+  void* Carve(bool* new_slab) {
+    absl::MutexLock lock(&mutex_);
+    *new_slab = false;
+    if (next_ == end_) {
+      slabs_.emplace_back(new char[kSlabSize]);
+      next_ = slabs_.back().get();
+      end_ = next_ + (kSlabSize / block_size_) * block_size_;
+      *new_slab = true;
+    }
+    void* block = next_;
+    next_ += block_size_;
+    return block;
+  }
+
+  void Push(void* ptr) {
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    absl::MutexLock lock(&mutex_);
+    block->next = free_list_;
+    free_list_ = block;
+  }
+
+  size_t block_size() const { return block_size_; }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  size_t block_size_ = 0;
+  absl::Mutex mutex_;
+  FreeBlock* free_list_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  // The unused part of the most recent slab.
+  char* next_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  char* end_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  std::vector<std::unique_ptr<char[]>> slabs_ ABSL_GUARDED_BY(mutex_);
+};
+
+thread_local const std::shared_ptr<PacketArena>* PacketArena::current_ =
+    nullptr;
+
+PacketArena::PacketArena()
+    : size_classes_(new SizeClass[kNumSizeClasses]) {
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    size_classes_[i].Init(kBlockSizes[i]);
+  }
+}
+
+PacketArena::~PacketArena() {
+  DCHECK_EQ(live_blocks_.load(), 0)
+      << "PacketArena destroyed while blocks are still in use.";
+}
+
+PacketArena::SizeClass* PacketArena::FindSizeClass(size_t bytes,
+                                                   size_t alignment) const {
+  if (alignment > kMaxAlignment) {
+    return nullptr;
+  }
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    if (bytes <= kBlockSizes[i]) {
+      return &size_classes_[i];
+    }
+  }
+  return nullptr;
+}
+
+void* PacketArena::Allocate(size_t bytes, size_t alignment) {
+  SizeClass* size_class = FindSizeClass(bytes, alignment);
+  if (size_class == nullptr) {
+    oversized_allocations_.fetch_add(1, std::memory_order_relaxed);
+    if (alignment > kMaxAlignment) {
+      return ::operator new(bytes, std::align_val_t(alignment));
+    }
+    return ::operator new(bytes);
+  }
+  allocations_.fetch_add(1, std::memory_order_relaxed);
+  live_blocks_.fetch_add(1, std::memory_order_relaxed);
+  if (void* block = size_class->PopFree()) {
+    reused_allocations_.fetch_add(1, std::memory_order_relaxed);
+    return block;
+  }
+  bool new_slab;
+  void* block = size_class->Carve(&new_slab);
+  if (new_slab) {
+    reserved_bytes_.fetch_add(kSlabSize, std::memory_order_relaxed);
+  }
+  return block;
+}
+
+void PacketArena::Deallocate(void* ptr, size_t bytes, size_t alignment) {
+  SizeClass* size_class = FindSizeClass(bytes, alignment);
+  if (size_class == nullptr) {
+    if (alignment > kMaxAlignment) {
+      ::operator delete(ptr, std::align_val_t(alignment));
+    } else {
+      ::operator delete(ptr);
+    }
+    return;
+  }
+  live_blocks_.fetch_sub(1, std::memory_order_relaxed);
+  size_class->Push(ptr);
+}
+
+PacketArena::Stats PacketArena::GetStats() const {
+  Stats stats;
+  stats.allocations = allocations_.load(std::memory_order_relaxed);
+  stats.reused_allocations =
+      reused_allocations_.load(std::memory_order_relaxed);
+  stats.oversized_allocations =
+      oversized_allocations_.load(std::memory_order_relaxed);
+  stats.live_blocks = live_blocks_.load(std::memory_order_relaxed);
+  stats.reserved_bytes = reserved_bytes_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace mediapipe
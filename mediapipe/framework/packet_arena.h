@@ -0,0 +1,147 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PACKET_ARENA_H_
+#define MEDIAPIPE_FRAMEWORK_PACKET_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace mediapipe {
+
+// A thread-safe slab allocator for the small, short-lived blocks that hold
+// packet payloads. Blocks are carved out of large slabs in a few size classes
+// and recycled through per-class free lists, so that steady-state packet
+// creation does not reach the global heap. Requests that do not fit any size
+// class are forwarded to operator new.
+//
+// Memory is returned to the system only when the arena is destroyed. Anything
+// allocated from the arena must hold a reference to it (PacketArenaAllocator
+// does), since packets can outlive the graph that created them.
+//
+// A CalculatorGraph creates an arena when
+// CalculatorGraphConfig.enable_packet_arena is set, and activates it on the
+// threads running its calculators. MakePacket() then allocates the packet
+// holder, its payload and the shared_ptr control block as one arena block.
+class PacketArena {
+ public:
+  // Allocation counters, for profiling.
+  struct Stats {
+    // Number of allocations served by the arena.
+    int64_t allocations = 0;
+    // Number of those that reused a freed block.
+    int64_t reused_allocations = 0;
+    // Number of allocations too large for the arena, served by operator new.
+    int64_t oversized_allocations = 0;
+    // Number of arena blocks currently in use.
+    int64_t live_blocks = 0;
+    // Total size of the slabs reserved by the arena.
+    int64_t reserved_bytes = 0;
+  };
+
+  PacketArena();
+  ~PacketArena();
+  PacketArena(const PacketArena&) = delete;
+  PacketArena& operator=(const PacketArena&) = delete;
+
+  // Returns a block of at least "bytes" bytes aligned to "alignment".
+  void* Allocate(size_t bytes, size_t alignment);
+
+  // Returns a block obtained from Allocate() with the same arguments. May be
+  // called from any thread.
+  void Deallocate(void* ptr, size_t bytes, size_t alignment);
+
+  Stats GetStats() const;
+
+  // Returns the arena active on the current thread, or nullptr if there is
+  // none.
+  static const std::shared_ptr<PacketArena>* Current() { return current_; }
+
+  // Makes "arena" the current thread's arena for the lifetime of this object.
+  // "arena" may be null, which deactivates any enclosing arena.
+  class ScopedActivation {
+   public:
+    explicit ScopedActivation(const std::shared_ptr<PacketArena>& arena)
+        : previous_(current_) {
+      current_ = arena ? &arena : nullptr;
+    }
+    ~ScopedActivation() { current_ = previous_; }
+    ScopedActivation(const ScopedActivation&) = delete;
+    ScopedActivation& operator=(const ScopedActivation&) = delete;
+
+   private:
+    const std::shared_ptr<PacketArena>* const previous_;
+  };
+
+ private:
+  class SizeClass;
+
+  // Returns the size class for a request, or nullptr if the request must go
+  // to operator new.
+  SizeClass* FindSizeClass(size_t bytes, size_t alignment) const;
+
+  std::unique_ptr<SizeClass[]> size_classes_;
+
+  std::atomic<int64_t> allocations_{0};
+  std::atomic<int64_t> reused_allocations_{0};
+  std::atomic<int64_t> oversized_allocations_{0};
+  std::atomic<int64_t> live_blocks_{0};
+  std::atomic<int64_t> reserved_bytes_{0};
+
+  static thread_local const std::shared_ptr<PacketArena>* current_;  // NOLINT
+};
+
+// A std allocator drawing from a PacketArena, for use with
+// std::allocate_shared. It keeps the arena alive as long as any copy of it,
+// including the one stored in a shared_ptr control block, exists.
+template <typename T>
+class PacketArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit PacketArenaAllocator(std::shared_ptr<PacketArena> arena)
+      : arena_(std::move(arena)) {}
+  template <typename U>
+  PacketArenaAllocator(const PacketArenaAllocator<U>& other)  // NOLINT
+      : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* ptr, size_t n) {
+    arena_->Deallocate(ptr, n * sizeof(T), alignof(T));
+  }
+
+  const std::shared_ptr<PacketArena>& arena() const { return arena_; }
+
+  template <typename U>
+  bool operator==(const PacketArenaAllocator<U>& other) const {
+    return arena_ == other.arena();
+  }
+  template <typename U>
+  bool operator!=(const PacketArenaAllocator<U>& other) const {
+    return arena_ != other.arena();
+  }
+
+ private:
+  std::shared_ptr<PacketArena> arena_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PACKET_ARENA_H_
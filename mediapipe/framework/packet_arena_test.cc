@@ -0,0 +1,193 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_arena.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(PacketArenaTest, ReusesFreedBlocks) {
+  PacketArena arena;
+  void* first = arena.Allocate(40, 8);
+  arena.Deallocate(first, 40, 8);
+  void* second = arena.Allocate(48, 8);
+  EXPECT_EQ(first, second);
+  arena.Deallocate(second, 48, 8);
+
+  PacketArena::Stats stats = arena.GetStats();
+  EXPECT_EQ(stats.allocations, 2);
+  EXPECT_EQ(stats.reused_allocations, 1);
+  EXPECT_EQ(stats.oversized_allocations, 0);
+  EXPECT_EQ(stats.live_blocks, 0);
+  EXPECT_GT(stats.reserved_bytes, 0);
+}
+
+TEST(PacketArenaTest, ForwardsOversizedAllocations) {
+  PacketArena arena;
+  void* big = arena.Allocate(4096, 8);
+  void* overaligned = arena.Allocate(32, 64);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(overaligned) % 64, 0);
+  arena.Deallocate(big, 4096, 8);
+  arena.Deallocate(overaligned, 32, 64);
+
+  PacketArena::Stats stats = arena.GetStats();
+  EXPECT_EQ(stats.allocations, 0);
+  EXPECT_EQ(stats.oversized_allocations, 2);
+  EXPECT_EQ(stats.reserved_bytes, 0);
+}
+
+TEST(PacketArenaTest, DeallocatesFromOtherThreads) {
+  PacketArena arena;
+  std::vector<void*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    blocks.push_back(arena.Allocate(100, 8));
+  }
+  std::thread thread([&] {
+    for (void* block : blocks) {
+      arena.Deallocate(block, 100, 8);
+    }
+  });
+  thread.join();
+  EXPECT_EQ(arena.GetStats().live_blocks, 0);
+}
+
+TEST(PacketArenaTest, MakePacketUsesCurrentArena) {
+  auto arena = std::make_shared<PacketArena>();
+  Packet packet;
+  {
+    PacketArena::ScopedActivation activation(arena);
+    packet = MakePacket<std::string>("hello").At(Timestamp(10));
+  }
+  Packet heap_packet = MakePacket<std::string>("world");
+  EXPECT_EQ(packet.Get<std::string>(), "hello");
+  EXPECT_EQ(heap_packet.Get<std::string>(), "world");
+  EXPECT_EQ(arena->GetStats().allocations, 1);
+  EXPECT_EQ(arena->GetStats().live_blocks, 1);
+  packet = Packet();
+  EXPECT_EQ(arena->GetStats().live_blocks, 0);
+}
+
+TEST(PacketArenaTest, Api2MakePacketUsesCurrentArena) {
+  auto arena = std::make_shared<PacketArena>();
+  PacketArena::ScopedActivation activation(arena);
+  api2::Packet<int> packet = api2::MakePacket<int>(42);
+  EXPECT_EQ(packet.Get(), 42);
+  EXPECT_EQ(arena->GetStats().live_blocks, 1);
+}
+
+TEST(PacketArenaTest, ConsumeMovesDataOutOfArena) {
+  auto arena = std::make_shared<PacketArena>();
+  Packet packet;
+  {
+    PacketArena::ScopedActivation activation(arena);
+    packet = MakePacket<std::vector<int>>(3, 7);
+  }
+  auto result = packet.Consume<std::vector<int>>();
+  MP_ASSERT_OK(result);
+  EXPECT_EQ(*result.value(), std::vector<int>(3, 7));
+  EXPECT_TRUE(packet.IsEmpty());
+  EXPECT_EQ(arena->GetStats().live_blocks, 0);
+}
+
+TEST(PacketArenaTest, PacketsKeepArenaAlive) {
+  Packet packet;
+  {
+    auto arena = std::make_shared<PacketArena>();
+    PacketArena::ScopedActivation activation(arena);
+    packet = MakePacket<int>(5);
+  }
+  EXPECT_EQ(packet.Get<int>(), 5);
+}
+
+TEST(PacketArenaTest, NullActivationDisablesArena) {
+  auto arena = std::make_shared<PacketArena>();
+  PacketArena::ScopedActivation activation(arena);
+  {
+    PacketArena::ScopedActivation deactivation(nullptr);
+    EXPECT_EQ(PacketArena::Current(), nullptr);
+    Packet packet = MakePacket<int>(1);
+  }
+  EXPECT_EQ(PacketArena::Current(), &arena);
+  EXPECT_EQ(arena->GetStats().allocations, 0);
+}
+
+// Emits 100 integer packets created with MakePacket.
+class ArenaTestSourceCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Outputs().Index(0).Set<int>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (count_ == 100) {
+      return tool::StatusStop();
+    }
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<int>(count_).At(Timestamp(count_)));
+    ++count_;
+    return absl::OkStatus();
+  }
+
+ private:
+  int count_ = 0;
+};
+REGISTER_CALCULATOR(ArenaTestSourceCalculator);
+
+TEST(PacketArenaTest, GraphReportsArenaStats) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    enable_packet_arena: true
+    node { calculator: "ArenaTestSourceCalculator" output_stream: "out" }
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "out"
+      output_stream: "out_1"
+    }
+  )pb");
+  std::vector<Packet> packets;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.ObserveOutputStream("out_1", [&](const Packet& packet) {
+    packets.push_back(packet);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.Run());
+
+  ASSERT_EQ(packets.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(packets[i].Get<int>(), i);
+  }
+  GraphProfile profile;
+  MP_ASSERT_OK(graph.profiler()->CaptureProfile(&profile));
+  EXPECT_GE(profile.packet_arena_stats().allocations(), 100);
+  EXPECT_GE(profile.packet_arena_stats().live_blocks(), 100);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,75 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_size.h"
+
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace mediapipe {
+namespace {
+
+struct EstimatorRegistry {
+  absl::Mutex mutex;
+  absl::flat_hash_map<TypeId, PacketSizeEstimator> estimators
+      ABSL_GUARDED_BY(mutex);
+};
+
+EstimatorRegistry& GetEstimatorRegistry() {
+  static EstimatorRegistry* registry = new EstimatorRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+bool RegisterPacketSizeEstimator(TypeId type_id,
+                                 PacketSizeEstimator estimator) {
+  EstimatorRegistry& registry = GetEstimatorRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  registry.estimators[type_id] = std::move(estimator);
+  return true;
+}
+
+int64 EstimatePacketSize(const Packet& packet) {
+  if (packet.IsEmpty()) {
+    return 0;
+  }
+  EstimatorRegistry& registry = GetEstimatorRegistry();
+  const TypeId type_id = packet.GetTypeId();
+  {
+    absl::ReaderMutexLock lock(&registry.mutex);
+    auto it = registry.estimators.find(type_id);
+    if (it != registry.estimators.end()) {
+      return it->second(packet);
+    }
+  }
+  // Remember the fallback for the type, so that later packets need no check.
+  PacketSizeEstimator estimator;
+  if (packet.ValidateAsProtoMessageLite().ok()) {
+    estimator = [](const Packet& packet) -> int64 {
+      return packet.GetProtoMessageLite().ByteSizeLong();
+    };
+  } else {
+    estimator = [](const Packet&) -> int64 { return 0; };
+  }
+  {
+    absl::MutexLock lock(&registry.mutex);
+    registry.estimators.emplace(type_id, estimator);
+  }
+  return estimator(packet);
+}
+
+}  // namespace mediapipe
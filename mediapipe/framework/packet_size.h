@@ -0,0 +1,62 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PACKET_SIZE_H_
+#define MEDIAPIPE_FRAMEWORK_PACKET_SIZE_H_
+
+#include <functional>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/tool/type_util.h"
+
+namespace mediapipe {
+
+// Returns an estimate of the number of bytes held by the payload of `packet`,
+// used for the memory accounting of input streams. Uses the estimator
+// registered for the payload type if there is one, ByteSizeLong() for protos,
+// and 0 for empty packets and other types.
+int64 EstimatePacketSize(const Packet& packet);
+
+// Estimates the size of a packet known to hold the registered type.
+using PacketSizeEstimator = std::function<int64(const Packet&)>;
+
+// Registers the estimator for packets holding `type_id`, replacing any
+// previous one. Returns true, so that it can initialize a static variable.
+bool RegisterPacketSizeEstimator(TypeId type_id, PacketSizeEstimator estimator);
+
+template <typename T>
+bool RegisterPacketSizeEstimator(int64 (*estimate)(const T&)) {
+  return RegisterPacketSizeEstimator(
+      kTypeId<T>,
+      [estimate](const Packet& packet) { return estimate(packet.Get<T>()); });
+}
+
+// Registers `estimate`, a function taking a const T&, as the size estimator
+// for packets holding T. Use it in the .cc file of the type, e.g.:
+//   MEDIAPIPE_REGISTER_PACKET_SIZE_ESTIMATOR(
+//       ImageFrame, [](const ImageFrame& frame) -> int64 { ... });
+#define MEDIAPIPE_REGISTER_PACKET_SIZE_ESTIMATOR(T, estimate)   \
+  static const bool MEDIAPIPE_PACKET_SIZE_VAR(__LINE__) =       \
+      ::mediapipe::RegisterPacketSizeEstimator<T>(              \
+          static_cast<int64 (*)(const T&)>(estimate))
+
+// Two levels of macros are required to expand __LINE__.
+#define MEDIAPIPE_PACKET_SIZE_VAR_INNER(line) \
+  packet_size_estimator_registration_##line##__
+#define MEDIAPIPE_PACKET_SIZE_VAR(line) MEDIAPIPE_PACKET_SIZE_VAR_INNER(line)
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PACKET_SIZE_H_
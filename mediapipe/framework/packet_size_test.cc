@@ -0,0 +1,57 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_size.h"
+
+#include <vector>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_test.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace {
+
+struct Buffer {
+  std::vector<char> data;
+};
+
+MEDIAPIPE_REGISTER_PACKET_SIZE_ESTIMATOR(
+    Buffer, [](const Buffer& buffer) -> int64 { return buffer.data.size(); });
+
+TEST(PacketSizeTest, UsesRegisteredEstimator) {
+  EXPECT_EQ(100, EstimatePacketSize(MakePacket<Buffer>(Buffer{
+                     std::vector<char>(100)})));
+}
+
+TEST(PacketSizeTest, UsesProtoByteSize) {
+  SimpleProto proto;
+  proto.add_value("abcdef");
+  EXPECT_EQ(proto.ByteSizeLong(),
+            EstimatePacketSize(MakePacket<SimpleProto>(proto)));
+  // The fallback is remembered per type, but computed per packet.
+  proto.add_value("ghi");
+  EXPECT_EQ(proto.ByteSizeLong(),
+            EstimatePacketSize(MakePacket<SimpleProto>(proto)));
+}
+
+TEST(PacketSizeTest, OtherTypesAreZero) {
+  EXPECT_EQ(0, EstimatePacketSize(Packet()));
+  EXPECT_EQ(0, EstimatePacketSize(MakePacket<int>(5)));
+  EXPECT_EQ(0, EstimatePacketSize(MakePacket<int>(6)));
+}
+
+}  // namespace
+}  // namespace mediapipe
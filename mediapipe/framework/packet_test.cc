@@ -14,12 +14,14 @@
 
 #include "mediapipe/framework/packet.h"
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/packet_test.pb.h"
 #include "mediapipe/framework/port/core_proto_inc.h"
@@ -368,6 +370,72 @@ TEST(PacketTest, TestPacketConsumeOrCopy) {
   EXPECT_TRUE(packet3.IsEmpty());
 }
 
+TEST(PacketTest, MakeInlinePacketStoresPayloadInline) {
+  Packet packet = MakeInlinePacket<int>(33).At(Timestamp(10));
+  Packet copy = packet;
+  // Each copy holds its own payload.
+  EXPECT_NE(&packet.Get<int>(), &copy.Get<int>());
+  EXPECT_EQ(33, copy.Get<int>());
+  EXPECT_EQ(Timestamp(10), copy.Timestamp());
+  // Copies are equal, like copies of packets sharing their payload, but
+  // separately made packets are not, even if their payloads are.
+  EXPECT_TRUE(packet == copy);
+  EXPECT_TRUE(packet == copy.At(Timestamp(20)));
+  EXPECT_FALSE(packet == MakeInlinePacket<int>(33));
+  EXPECT_FALSE(packet == MakeInlinePacket<int>(34));
+  EXPECT_FALSE(packet == MakeInlinePacket<float>(33));
+  EXPECT_EQ(Timestamp(5), MakeInlinePacket<Timestamp>(5).Get<Timestamp>());
+  EXPECT_TRUE(MakeInlinePacket<bool>(true).Get<bool>());
+
+  Packet moved = std::move(copy);
+  EXPECT_TRUE(copy.IsEmpty());  // NOLINT used after std::move().
+  EXPECT_EQ(33, moved.Get<int>());
+
+  // Consuming a copy leaves the other copies intact.
+  absl::StatusOr<std::unique_ptr<int>> result = moved.Consume<int>();
+  MP_ASSERT_OK(result);
+  EXPECT_EQ(33, *result.value());
+  EXPECT_TRUE(moved.IsEmpty());
+  EXPECT_EQ(33, packet.Get<int>());
+}
+
+TEST(PacketTest, InlinePayloadDataIds) {
+  Packet packet = MakeInlinePacket<int>(33);
+  const int64_t id = packet_internal::GetHolder(packet)->DataId();
+  // Copies and moves keep the id, though the payload address changes.
+  Packet copy = packet;
+  EXPECT_EQ(id, packet_internal::GetHolder(copy)->DataId());
+  Packet moved = std::move(copy);
+  EXPECT_EQ(id, packet_internal::GetHolder(moved)->DataId());
+  Packet assigned;
+  assigned = moved;
+  EXPECT_EQ(id, packet_internal::GetHolder(assigned)->DataId());
+  EXPECT_TRUE(assigned == packet);
+
+  // Packets made in the same place, one after another, get distinct ids.
+  absl::flat_hash_set<int64_t> ids;
+  for (int i = 0; i < 100; ++i) {
+    Packet temporary = MakeInlinePacket<int>(33);
+    EXPECT_LT(packet_internal::GetHolder(temporary)->DataId(), 0);
+    EXPECT_TRUE(ids.insert(packet_internal::GetHolder(temporary)->DataId())
+                    .second);
+  }
+  EXPECT_EQ(ids.count(id), 0);
+
+  // A holder on the heap is identified by its address.
+  Packet string_packet = MakePacket<std::string>("33");
+  Packet string_copy = string_packet;
+  EXPECT_GT(packet_internal::GetHolder(string_packet)->DataId(), 0);
+  EXPECT_EQ(packet_internal::GetHolder(string_packet)->DataId(),
+            packet_internal::GetHolder(string_copy)->DataId());
+}
+
+TEST(PacketTest, SharedPtrWithInlinePacket) {
+  std::shared_ptr<const int> ptr =
+      SharedPtrWithPacket<int>(MakeInlinePacket<int>(7));
+  EXPECT_EQ(7, *ptr);
+}
+
 TEST(PacketTest, TestConsumeForeignHolder) {
   std::unique_ptr<int> data(new int(33));
   Packet packet = PointToForeign(data.get());
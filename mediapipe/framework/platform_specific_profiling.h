@@ -20,6 +20,7 @@
 #else
 #include "mediapipe/framework/profiler/graph_profiler_stub.h"
 #endif
+#include "mediapipe/framework/platform_specific_tracepoints.h"
 
 // Enabling this flag, will require specific platform implementation for the
 // methods mediapipe::PlatformSpecificTraceEventBegin() and
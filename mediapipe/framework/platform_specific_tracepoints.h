@@ -0,0 +1,151 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PLATFORM_SPECIFIC_TRACEPOINTS_H_
+#define MEDIAPIPE_FRAMEWORK_PLATFORM_SPECIFIC_TRACEPOINTS_H_
+
+// Statically defined tracepoints, which system tracers can enable in a
+// running process, unlike the GraphTracer, which must be configured in the
+// graph config:
+//   - on Linux, USDT probes of provider "mediapipe", for perf and bpftrace,
+//     e.g. "bpftrace -e 'usdt:/path/to/binary:mediapipe:node_started
+//     { printf("%s %d\n", str(arg0), arg2); }' -p <pid>",
+//   - on Apple platforms, os_signpost events of subsystem
+//     "com.google.mediapipe", category "Graph", for Instruments,
+//   - on Android, ATrace sections and counters, for Perfetto and systrace,
+//     with the "app" category.
+// Linux requires <sys/sdt.h>, from the systemtap SDT development package.
+//
+// A tracer that isn't attached costs a nop instruction per USDT probe, and a
+// check of whether tracing is enabled otherwise. The arguments of a
+// tracepoint are evaluated regardless, so they should be cheap, like the name
+// of a node or stream that is already stored.
+//
+// Every tracepoint has a name (const char*), an id and a value (int64):
+//   node_scheduled(node name, node id, input timestamp)
+//       A node is added to the scheduler queue.
+//   node_started, node_finished(node name, node id, input timestamp)
+//       A node calls and returns from Calculator::Process(), on one thread.
+//   node_throttled, node_unthrottled(node name, node id, input timestamp)
+//       A source node isn't scheduled because an input stream of the graph
+//       is full, or is scheduled again.
+//   graph_input_throttled, graph_input_unthrottled(
+//           "graph_input_streams", 0, number of throttled streams)
+//       AddPacketToInputStream() waits, or stops waiting, for full streams.
+//   packet_added, packet_popped(stream name, packet timestamp, queue size)
+//       An input stream of a node queues or dequeues a packet.
+//   gpu_task_submitted("gl_context", node id, input timestamp)
+//       A task is submitted to the thread of a GL context.
+//
+// All tracepoints can be compiled out with MEDIAPIPE_DISABLE_TRACEPOINTS.
+
+#if !defined(MEDIAPIPE_DISABLE_TRACEPOINTS) && defined(__has_include)
+#if defined(__linux__) && !defined(__ANDROID__) && __has_include(<sys/sdt.h>)
+#define MEDIAPIPE_USDT_TRACEPOINTS 1
+#elif defined(__APPLE__) && __has_include(<os/signpost.h>)
+#define MEDIAPIPE_SIGNPOST_TRACEPOINTS 1
+#elif defined(__ANDROID__) && __ANDROID_API__ >= 23
+#define MEDIAPIPE_ATRACE_TRACEPOINTS 1
+#endif
+#endif  // !MEDIAPIPE_DISABLE_TRACEPOINTS && __has_include
+
+#if defined(MEDIAPIPE_USDT_TRACEPOINTS)
+#include <sys/sdt.h>
+
+#include <cstdint>
+
+#define MEDIAPIPE_TRACEPOINT(event, name, id, value)                   \
+  DTRACE_PROBE3(mediapipe, event, static_cast<const char*>(name),      \
+                static_cast<int64_t>(id), static_cast<int64_t>(value))
+#define MEDIAPIPE_TRACEPOINT_BEGIN(event, name, id, value) \
+  MEDIAPIPE_TRACEPOINT(event, name, id, value)
+#define MEDIAPIPE_TRACEPOINT_END(event, name, id, value) \
+  MEDIAPIPE_TRACEPOINT(event, name, id, value)
+
+#elif defined(MEDIAPIPE_SIGNPOST_TRACEPOINTS)
+#include <os/signpost.h>
+
+namespace mediapipe {
+namespace tracepoints {
+
+// Returns the log of the signposts, or null before iOS 12 and macOS 10.14.
+inline os_log_t SignpostLog() {
+  if (__builtin_available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+    static os_log_t log = os_log_create("com.google.mediapipe", "Graph");
+    return log;
+  }
+  return nullptr;
+}
+
+}  // namespace tracepoints
+}  // namespace mediapipe
+
+#define MEDIAPIPE_SIGNPOST_INTERNAL(emit, event, name, id, value)           \
+  do {                                                                      \
+    if (__builtin_available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, \
+                            *)) {                                           \
+      os_log_t mediapipe_signpost_log =                                     \
+          mediapipe::tracepoints::SignpostLog();                            \
+      if (os_signpost_enabled(mediapipe_signpost_log)) {                    \
+        emit(mediapipe_signpost_log,                                        \
+             os_signpost_id_make_with_pointer(mediapipe_signpost_log,      \
+                                              (name)),                      \
+             #event, "%{public}s %lld %lld",                                \
+             static_cast<const char*>(name), static_cast<long long>(id),   \
+             static_cast<long long>(value));                                \
+      }                                                                     \
+    }                                                                       \
+  } while (0)
+
+#define MEDIAPIPE_TRACEPOINT(event, name, id, value) \
+  MEDIAPIPE_SIGNPOST_INTERNAL(os_signpost_event_emit, event, name, id, value)
+#define MEDIAPIPE_TRACEPOINT_BEGIN(event, name, id, value)                  \
+  MEDIAPIPE_SIGNPOST_INTERNAL(os_signpost_interval_begin, node, name, id, \
+                              value)
+#define MEDIAPIPE_TRACEPOINT_END(event, name, id, value)                  \
+  MEDIAPIPE_SIGNPOST_INTERNAL(os_signpost_interval_end, node, name, id, \
+                              value)
+
+#elif defined(MEDIAPIPE_ATRACE_TRACEPOINTS)
+#include <android/trace.h>
+
+#include <cstdint>
+#include <cstdio>
+
+// Instant tracepoints set a counter named after the event and the name to the
+// value, which needs Android Q. Intervals are sections named after the name.
+#if __ANDROID_API__ >= 29
+#define MEDIAPIPE_TRACEPOINT(event, name, id, value)                         \
+  do {                                                                       \
+    if (ATrace_isEnabled()) {                                                \
+      char mediapipe_counter_name[128];                                      \
+      snprintf(mediapipe_counter_name, sizeof(mediapipe_counter_name),      \
+               "%s %s", #event, static_cast<const char*>(name));             \
+      ATrace_setCounter(mediapipe_counter_name, static_cast<int64_t>(value)); \
+    }                                                                        \
+  } while (0)
+#else
+#define MEDIAPIPE_TRACEPOINT(event, name, id, value)
+#endif  // __ANDROID_API__ >= 29
+#define MEDIAPIPE_TRACEPOINT_BEGIN(event, name, id, value) \
+  ATrace_beginSection(static_cast<const char*>(name))
+#define MEDIAPIPE_TRACEPOINT_END(event, name, id, value) ATrace_endSection()
+
+#else
+#define MEDIAPIPE_TRACEPOINT(event, name, id, value)
+#define MEDIAPIPE_TRACEPOINT_BEGIN(event, name, id, value)
+#define MEDIAPIPE_TRACEPOINT_END(event, name, id, value)
+#endif
+
+#endif  // MEDIAPIPE_FRAMEWORK_PLATFORM_SPECIFIC_TRACEPOINTS_H_
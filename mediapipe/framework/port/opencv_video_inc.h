@@ -84,6 +84,15 @@ inline int fourcc(char c1, char c2, char c3, char c4) {
 #include <opencv2/video.hpp>
 #include <opencv2/videoio.hpp>
 
+// The hardware acceleration properties of cv::VideoCapture and
+// cv::VideoWriter are available since OpenCV 4.5.2.
+#if CV_VERSION_MAJOR > 4 ||                           \
+    (CV_VERSION_MAJOR == 4 && (CV_VERSION_MINOR > 5 ||   \
+                               (CV_VERSION_MINOR == 5 && \
+                                CV_VERSION_REVISION >= 2)))
+#define MEDIAPIPE_OPENCV_VIDEO_HW_ACCELERATION 1
+#endif
+
 #if CV_VERSION_MAJOR == 4 && !defined(MEDIAPIPE_MOBILE)
 #include <opencv2/optflow.hpp>
 
@@ -0,0 +1,326 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/compact_trace.h"
+
+#include <array>
+
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+namespace {
+
+using CalculatorTrace = GraphTrace::CalculatorTrace;
+using StreamTrace = GraphTrace::StreamTrace;
+
+// The columns of the CalculatorTraces of a GraphTrace. The mask columns hold
+// a bit for each of the following fields that is set, and each field column
+// holds the values of the traces where the field is set.
+enum Column {
+  kTraceMask,
+  kNodeId,
+  kInputTimestamp,
+  kEventType,
+  kStartTime,
+  kFinishTime,
+  kThreadId,
+  kNumInputTraces,
+  kNumOutputTraces,
+  // The input traces followed by the output traces of each CalculatorTrace.
+  kStreamMask,
+  kStreamStartTime,
+  kStreamFinishTime,
+  kPacketTimestamp,
+  kStreamId,
+  kPacketId,
+  kEventData,
+  kNumColumns,
+};
+
+constexpr uint64 TraceBit(Column column) { return 1ull << (column - kNodeId); }
+constexpr uint64 StreamBit(Column column) {
+  return 1ull << (column - kStreamStartTime);
+}
+
+// Returns a - b and a + b, wrapping around instead of overflowing.
+int64 Subtract(int64 a, int64 b) {
+  return static_cast<int64>(static_cast<uint64>(a) - static_cast<uint64>(b));
+}
+int64 Add(int64 a, int64 b) {
+  return static_cast<int64>(static_cast<uint64>(a) + static_cast<uint64>(b));
+}
+
+void AppendVarint(uint64 value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+bool ReadVarint(absl::string_view* data, uint64* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (data->empty()) return false;
+    const uint8 byte = static_cast<uint8>(data->front());
+    data->remove_prefix(1);
+    *value |= static_cast<uint64>(byte & 0x7f) << shift;
+    if (byte < 0x80) return true;
+  }
+  return false;
+}
+
+bool ReadBytes(absl::string_view* data, absl::string_view* bytes) {
+  uint64 size;
+  if (!ReadVarint(data, &size) || size > data->size()) return false;
+  *bytes = data->substr(0, size);
+  data->remove_prefix(size);
+  return true;
+}
+
+void AppendBytes(absl::string_view bytes, std::string* out) {
+  AppendVarint(bytes.size(), out);
+  out->append(bytes.data(), bytes.size());
+}
+
+// Writes values as zigzag varints of their differences to the previous value.
+// The differences wrap around, so any int64 values round-trip.
+class ColumnWriter {
+ public:
+  void Append(int64 value) {
+    const int64 delta = Subtract(value, previous_);
+    AppendVarint((static_cast<uint64>(delta) << 1) ^
+                     static_cast<uint64>(delta >> 63),
+                 &data_);
+    previous_ = value;
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  int64 previous_ = 0;
+  std::string data_;
+};
+
+class ColumnReader {
+ public:
+  explicit ColumnReader(absl::string_view data = {}) : data_(data) {}
+
+  bool Read(int64* value) {
+    uint64 zigzag;
+    if (!ReadVarint(&data_, &zigzag)) return false;
+    const uint64 delta = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+    previous_ = Add(previous_, static_cast<int64>(delta));
+    *value = previous_;
+    return true;
+  }
+
+ private:
+  absl::string_view data_;
+  int64 previous_ = 0;
+};
+
+void EncodeStreamTrace(const StreamTrace& trace, int64 base_time,
+                       std::array<ColumnWriter, kNumColumns>* columns) {
+  auto& c = *columns;
+  uint64 mask = 0;
+  if (trace.has_start_time()) mask |= StreamBit(kStreamStartTime);
+  if (trace.has_finish_time()) mask |= StreamBit(kStreamFinishTime);
+  if (trace.has_packet_timestamp()) mask |= StreamBit(kPacketTimestamp);
+  if (trace.has_stream_id()) mask |= StreamBit(kStreamId);
+  if (trace.has_packet_id()) mask |= StreamBit(kPacketId);
+  if (trace.has_event_data()) mask |= StreamBit(kEventData);
+  c[kStreamMask].Append(mask);
+  if (trace.has_start_time()) {
+    c[kStreamStartTime].Append(Subtract(trace.start_time(), base_time));
+  }
+  if (trace.has_finish_time()) {
+    c[kStreamFinishTime].Append(Subtract(trace.finish_time(), base_time));
+  }
+  if (trace.has_packet_timestamp()) {
+    c[kPacketTimestamp].Append(trace.packet_timestamp());
+  }
+  if (trace.has_stream_id()) c[kStreamId].Append(trace.stream_id());
+  if (trace.has_packet_id()) c[kPacketId].Append(trace.packet_id());
+  if (trace.has_event_data()) c[kEventData].Append(trace.event_data());
+}
+
+void EncodeCalculatorTrace(const CalculatorTrace& trace,
+                           std::array<ColumnWriter, kNumColumns>* columns) {
+  auto& c = *columns;
+  uint64 mask = 0;
+  if (trace.has_node_id()) mask |= TraceBit(kNodeId);
+  if (trace.has_input_timestamp()) mask |= TraceBit(kInputTimestamp);
+  if (trace.has_event_type()) mask |= TraceBit(kEventType);
+  if (trace.has_start_time()) mask |= TraceBit(kStartTime);
+  if (trace.has_finish_time()) mask |= TraceBit(kFinishTime);
+  if (trace.has_thread_id()) mask |= TraceBit(kThreadId);
+  c[kTraceMask].Append(mask);
+  // Durations vary less than end times.
+  const int64 base_time = trace.start_time();
+  if (trace.has_node_id()) c[kNodeId].Append(trace.node_id());
+  if (trace.has_input_timestamp()) {
+    c[kInputTimestamp].Append(trace.input_timestamp());
+  }
+  if (trace.has_event_type()) c[kEventType].Append(trace.event_type());
+  if (trace.has_start_time()) c[kStartTime].Append(trace.start_time());
+  if (trace.has_finish_time()) {
+    c[kFinishTime].Append(Subtract(trace.finish_time(), base_time));
+  }
+  if (trace.has_thread_id()) c[kThreadId].Append(trace.thread_id());
+  c[kNumInputTraces].Append(trace.input_trace_size());
+  c[kNumOutputTraces].Append(trace.output_trace_size());
+  for (const StreamTrace& stream_trace : trace.input_trace()) {
+    EncodeStreamTrace(stream_trace, base_time, columns);
+  }
+  for (const StreamTrace& stream_trace : trace.output_trace()) {
+    EncodeStreamTrace(stream_trace, base_time, columns);
+  }
+}
+
+absl::Status DecodeStreamTrace(int64 base_time,
+                               std::array<ColumnReader, kNumColumns>* columns,
+                               StreamTrace* trace) {
+  auto& c = *columns;
+  int64 mask, value;
+  RET_CHECK(c[kStreamMask].Read(&mask));
+  if (mask & StreamBit(kStreamStartTime)) {
+    RET_CHECK(c[kStreamStartTime].Read(&value));
+    trace->set_start_time(Add(value, base_time));
+  }
+  if (mask & StreamBit(kStreamFinishTime)) {
+    RET_CHECK(c[kStreamFinishTime].Read(&value));
+    trace->set_finish_time(Add(value, base_time));
+  }
+  if (mask & StreamBit(kPacketTimestamp)) {
+    RET_CHECK(c[kPacketTimestamp].Read(&value));
+    trace->set_packet_timestamp(value);
+  }
+  if (mask & StreamBit(kStreamId)) {
+    RET_CHECK(c[kStreamId].Read(&value));
+    trace->set_stream_id(value);
+  }
+  if (mask & StreamBit(kPacketId)) {
+    RET_CHECK(c[kPacketId].Read(&value));
+    trace->set_packet_id(value);
+  }
+  if (mask & StreamBit(kEventData)) {
+    RET_CHECK(c[kEventData].Read(&value));
+    trace->set_event_data(value);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DecodeCalculatorTrace(
+    std::array<ColumnReader, kNumColumns>* columns, CalculatorTrace* trace) {
+  auto& c = *columns;
+  int64 mask, value;
+  RET_CHECK(c[kTraceMask].Read(&mask));
+  if (mask & TraceBit(kNodeId)) {
+    RET_CHECK(c[kNodeId].Read(&value));
+    trace->set_node_id(value);
+  }
+  if (mask & TraceBit(kInputTimestamp)) {
+    RET_CHECK(c[kInputTimestamp].Read(&value));
+    trace->set_input_timestamp(value);
+  }
+  if (mask & TraceBit(kEventType)) {
+    RET_CHECK(c[kEventType].Read(&value));
+    RET_CHECK(GraphTrace::EventType_IsValid(value));
+    trace->set_event_type(static_cast<GraphTrace::EventType>(value));
+  }
+  if (mask & TraceBit(kStartTime)) {
+    RET_CHECK(c[kStartTime].Read(&value));
+    trace->set_start_time(value);
+  }
+  if (mask & TraceBit(kFinishTime)) {
+    RET_CHECK(c[kFinishTime].Read(&value));
+    trace->set_finish_time(Add(value, trace->start_time()));
+  }
+  if (mask & TraceBit(kThreadId)) {
+    RET_CHECK(c[kThreadId].Read(&value));
+    trace->set_thread_id(value);
+  }
+  int64 num_inputs, num_outputs;
+  RET_CHECK(c[kNumInputTraces].Read(&num_inputs));
+  RET_CHECK(c[kNumOutputTraces].Read(&num_outputs));
+  RET_CHECK_GE(num_inputs, 0);
+  RET_CHECK_GE(num_outputs, 0);
+  for (int64 i = 0; i < num_inputs; ++i) {
+    MP_RETURN_IF_ERROR(DecodeStreamTrace(trace->start_time(), columns,
+                                         trace->add_input_trace()));
+  }
+  for (int64 i = 0; i < num_outputs; ++i) {
+    MP_RETURN_IF_ERROR(DecodeStreamTrace(trace->start_time(), columns,
+                                         trace->add_output_trace()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+std::string EncodeCompactProfile(const GraphProfile& profile) {
+  GraphProfile rest = profile;
+  for (GraphTrace& trace : *rest.mutable_graph_trace()) {
+    trace.clear_calculator_trace();
+  }
+  std::string record;
+  AppendBytes(rest.SerializeAsString(), &record);
+  for (const GraphTrace& trace : profile.graph_trace()) {
+    std::array<ColumnWriter, kNumColumns> columns;
+    for (const CalculatorTrace& calculator_trace : trace.calculator_trace()) {
+      EncodeCalculatorTrace(calculator_trace, &columns);
+    }
+    AppendVarint(trace.calculator_trace_size(), &record);
+    for (const ColumnWriter& column : columns) {
+      AppendBytes(column.data(), &record);
+    }
+  }
+  std::string result;
+  AppendBytes(record, &result);
+  return result;
+}
+
+absl::Status DecodeCompactTrace(absl::string_view data,
+                                std::vector<GraphProfile>* profiles) {
+  RET_CHECK(IsCompactTrace(data)) << "Not a compact trace log.";
+  data.remove_prefix(kCompactTraceMagic.size());
+  while (!data.empty()) {
+    absl::string_view record, rest;
+    RET_CHECK(ReadBytes(&data, &record)) << "Truncated compact trace record.";
+    RET_CHECK(ReadBytes(&record, &rest));
+    GraphProfile profile;
+    RET_CHECK(profile.ParseFromArray(rest.data(), rest.size()));
+    for (GraphTrace& trace : *profile.mutable_graph_trace()) {
+      uint64 num_traces;
+      RET_CHECK(ReadVarint(&record, &num_traces));
+      std::array<ColumnReader, kNumColumns> columns;
+      for (ColumnReader& column : columns) {
+        absl::string_view column_data;
+        RET_CHECK(ReadBytes(&record, &column_data));
+        column = ColumnReader(column_data);
+      }
+      for (uint64 i = 0; i < num_traces; ++i) {
+        MP_RETURN_IF_ERROR(
+            DecodeCalculatorTrace(&columns, trace.add_calculator_trace()));
+      }
+    }
+    profiles->push_back(std::move(profile));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
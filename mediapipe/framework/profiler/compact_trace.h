@@ -0,0 +1,53 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_COMPACT_TRACE_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_COMPACT_TRACE_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+
+namespace mediapipe {
+
+// The compact trace log format stores GraphProfiles in about half the space of
+// their binary protos. A file starts with kCompactTraceMagic and holds one
+// record per GraphProfile. In a record, the CalculatorTraces of each
+// GraphTrace are stored column by column: all node ids, then all input
+// timestamps, and so on, each value as a zigzag varint of its difference to
+// the previous value in the column. The rest of the GraphProfile is stored as
+// a binary proto.
+
+// The first bytes of a compact trace log file.
+inline constexpr absl::string_view kCompactTraceMagic = "MPCT\x01";
+
+// Returns the record encoding `profile`.
+std::string EncodeCompactProfile(const GraphProfile& profile);
+
+// Decodes a compact trace log file and appends its GraphProfiles to
+// `profiles`.
+absl::Status DecodeCompactTrace(absl::string_view data,
+                                std::vector<GraphProfile>* profiles);
+
+// Returns true if `data` starts with kCompactTraceMagic.
+inline bool IsCompactTrace(absl::string_view data) {
+  return data.substr(0, kCompactTraceMagic.size()) == kCompactTraceMagic;
+}
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_COMPACT_TRACE_H_
@@ -0,0 +1,141 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/compact_trace.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::Pointwise;
+
+GraphProfile ExampleProfile() {
+  return ParseTextProtoOrDie<GraphProfile>(R"pb(
+    graph_trace {
+      base_time: 1544086800000000
+      base_timestamp: 1544084200000000
+      calculator_name: "source"
+      calculator_name: "sink"
+      stream_name: "input"
+      stream_name: "output"
+      calculator_trace {
+        node_id: 0
+        input_timestamp: 0
+        event_type: PROCESS
+        start_time: 100
+        finish_time: 150
+        thread_id: 3
+        output_trace { packet_timestamp: 0 stream_id: 1 event_data: 7 }
+      }
+      calculator_trace {
+        node_id: 1
+        input_timestamp: 0
+        event_type: PROCESS
+        start_time: 160
+        finish_time: 155
+        input_trace {
+          start_time: 150
+          finish_time: 160
+          packet_timestamp: 0
+          stream_id: 1
+          event_data: -7
+        }
+      }
+      calculator_trace {
+        node_id: 0
+        event_type: NOT_READY
+        start_time: 90
+        thread_id: 2
+      }
+      calculator_trace {
+        node_id: 0
+        input_timestamp: -9223372036854775807
+        event_type: CLOSE
+        start_time: 9223372036854775807
+      }
+    }
+    calculator_profiles { name: "source" open_runtime: 5 }
+  )pb");
+}
+
+TEST(CompactTraceTest, RoundTripsProfiles) {
+  GraphProfile empty;
+  empty.add_graph_trace();
+  std::vector<GraphProfile> expected = {ExampleProfile(), empty,
+                                        ExampleProfile()};
+  std::string data(kCompactTraceMagic);
+  for (const GraphProfile& profile : expected) {
+    data += EncodeCompactProfile(profile);
+  }
+  ASSERT_TRUE(IsCompactTrace(data));
+  std::vector<GraphProfile> profiles;
+  MP_ASSERT_OK(DecodeCompactTrace(data, &profiles));
+  EXPECT_THAT(profiles, Pointwise(EqualsProto(), expected));
+}
+
+TEST(CompactTraceTest, IsSmallerThanBinaryProto) {
+  // A trace of a two node graph running at 30 fps.
+  GraphProfile profile;
+  GraphTrace* trace = profile.add_graph_trace();
+  for (int i = 0; i < 1000; ++i) {
+    const int64 timestamp = i * 33333;
+    const int64 time = 1000000 + i * 33333;
+    GraphTrace::CalculatorTrace* source = trace->add_calculator_trace();
+    source->set_node_id(0);
+    source->set_input_timestamp(timestamp);
+    source->set_event_type(GraphTrace::PROCESS);
+    source->set_start_time(time);
+    source->set_finish_time(time + 5000 + i % 7);
+    source->set_thread_id(1);
+    GraphTrace::StreamTrace* output = source->add_output_trace();
+    output->set_packet_timestamp(timestamp);
+    output->set_stream_id(1);
+    GraphTrace::CalculatorTrace* sink = trace->add_calculator_trace();
+    sink->set_node_id(1);
+    sink->set_input_timestamp(timestamp);
+    sink->set_event_type(GraphTrace::PROCESS);
+    sink->set_start_time(time + 5100);
+    sink->set_finish_time(time + 8000 + i % 5);
+    sink->set_thread_id(2);
+    GraphTrace::StreamTrace* input = sink->add_input_trace();
+    input->set_start_time(time + 5000 + i % 7);
+    input->set_finish_time(time + 5100);
+    input->set_packet_timestamp(timestamp);
+    input->set_stream_id(1);
+  }
+  EXPECT_LT(EncodeCompactProfile(profile).size() * 2,
+            profile.SerializeAsString().size());
+}
+
+TEST(CompactTraceTest, RejectsTruncatedTrace) {
+  std::string data =
+      absl::StrCat(kCompactTraceMagic, EncodeCompactProfile(ExampleProfile()));
+  std::vector<GraphProfile> profiles;
+  EXPECT_FALSE(DecodeCompactTrace(data.substr(0, data.size() - 1), &profiles)
+                   .ok());
+  EXPECT_FALSE(DecodeCompactTrace("not a trace", &profiles).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
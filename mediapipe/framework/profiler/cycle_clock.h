@@ -0,0 +1,99 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_CYCLE_CLOCK_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_CYCLE_CLOCK_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace mediapipe {
+
+// Returns a monotonic tick count that is much cheaper to read than the wall
+// clock: the time stamp counter on x86, the virtual counter on ARM64, and
+// steady_clock nanoseconds elsewhere. Ticks are converted to absl::Time by
+// CycleClockConverter.
+inline uint64 CycleClockNow() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64 ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+// Converts CycleClockNow() ticks to absl::Time, by interpolating between a
+// (ticks, time) sample taken on construction and one taken by the latest call
+// to Recalibrate(). This class is thread-safe.
+class CycleClockConverter {
+ public:
+  CycleClockConverter()
+      : base_ticks_(CycleClockNow()),
+        base_time_(absl::Now()),
+        ticks_per_second_(DefaultTicksPerSecond()) {}
+
+  // Updates the tick rate from the ticks and time elapsed since construction.
+  // The rate is kept until enough time has elapsed to measure it accurately.
+  void Recalibrate() {
+    const uint64 ticks = CycleClockNow();
+    const absl::Duration elapsed = absl::Now() - base_time_;
+    if (elapsed < absl::Milliseconds(10)) return;
+    absl::MutexLock lock(&mutex_);
+    ticks_per_second_ = (ticks - base_ticks_) / absl::ToDoubleSeconds(elapsed);
+  }
+
+  // Returns the time at which CycleClockNow() returned `ticks`.
+  absl::Time ToTime(uint64 ticks) const {
+    absl::MutexLock lock(&mutex_);
+    const double ticks_since_base =
+        static_cast<double>(static_cast<int64>(ticks - base_ticks_));
+    return base_time_ + absl::Seconds(ticks_since_base / ticks_per_second_);
+  }
+
+ private:
+  // Returns the tick rate used until the first recalibration.
+  static double DefaultTicksPerSecond() {
+#if defined(__aarch64__)
+    uint64 frequency;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    return frequency;
+#else
+    // Exact for steady_clock, and the right order of magnitude for the x86
+    // time stamp counter.
+    return 1e9;
+#endif
+  }
+
+  const uint64 base_ticks_;
+  const absl::Time base_time_;
+  mutable absl::Mutex mutex_;
+  double ticks_per_second_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_CYCLE_CLOCK_H_
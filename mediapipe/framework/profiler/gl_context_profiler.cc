@@ -12,12 +12,246 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
 #include <memory>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
-#include "absl/types/optional.h"
+#include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/profiler/graph_profiler.h"
+#include "mediapipe/gpu/gl_base.h"
 
-namespace mediapipe {}  // namespace mediapipe
+namespace mediapipe {
+
+namespace {
+
+// Spans beyond this many pending spans are not measured, so that a GPU
+// falling far behind doesn't accumulate timer queries.
+constexpr size_t kMaxPendingSpans = 256;
+
+}  // namespace
+
+#if HAS_EGL || (HAS_NSGL && CGL_VERSION_1_3)
+
+// Issues and reads GL_TIMESTAMP queries, through GL_ARB_timer_query on desktop
+// OpenGL and through GL_EXT_disjoint_timer_query on OpenGL ES.
+class GlContextProfiler::GlTimer {
+ public:
+  // Returns a GlTimer, or nullptr if the current GlContext doesn't support
+  // timer queries.
+  static std::unique_ptr<GlTimer> Create() {
+    auto timer = absl::WrapUnique(new GlTimer());
+    if (!timer->Initialize()) return nullptr;
+    return timer;
+  }
+
+  ~GlTimer() {
+    if (!free_queries_.empty()) {
+      glDeleteQueries(free_queries_.size(), free_queries_.data());
+    }
+  }
+
+  // Records the GPU time once the GPU reaches all preceding commands.
+  GLuint QueryTimestamp() {
+    if (free_queries_.empty()) {
+      free_queries_.resize(16);
+      glGenQueries(free_queries_.size(), free_queries_.data());
+    }
+    GLuint query = free_queries_.back();
+    free_queries_.pop_back();
+    query_counter_(query, kTimestamp);
+    return query;
+  }
+
+  // Returns true if the result of the query can be read without waiting.
+  bool IsAvailable(GLuint query) {
+    GLuint available = 0;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != 0;
+  }
+
+  // Returns the GPU time recorded by the query, waiting for it if needed, and
+  // releases the query.
+  absl::Time ReadTimestamp(GLuint query) {
+    GLuint64 nanos = 0;
+    get_query_object_ui64v_(query, GL_QUERY_RESULT, &nanos);
+    ReleaseQuery(query);
+    return absl::FromUnixNanos(nanos);
+  }
+
+  // Releases the query without reading its result.
+  void ReleaseQuery(GLuint query) { free_queries_.push_back(query); }
+
+  // Returns the current GPU time.
+  absl::Time GetTimestamp() {
+    GLint64 nanos = 0;
+    glGetInteger64v(kTimestamp, &nanos);
+    return absl::FromUnixNanos(nanos);
+  }
+
+  // Returns true if GPU timing was disrupted since the previous call, such as
+  // by a change of the GPU frequency. Timings read since are unreliable.
+  bool IsDisjoint() {
+#if HAS_EGL
+    GLint disjoint = 0;
+    glGetIntegerv(kGpuDisjoint, &disjoint);
+    return disjoint != 0;
+#else
+    return false;
+#endif  // HAS_EGL
+  }
+
+ private:
+#if HAS_EGL
+  static constexpr GLenum kTimestamp = 0x8E28;    // GL_TIMESTAMP_EXT
+  static constexpr GLenum kGpuDisjoint = 0x8FBB;  // GL_GPU_DISJOINT_EXT
+  using QueryCounterFn = void (*)(GLuint, GLenum);
+  using GetQueryObjectui64vFn = void (*)(GLuint, GLenum, GLuint64*);
+#else
+  static constexpr GLenum kTimestamp = GL_TIMESTAMP;
+  using QueryCounterFn = decltype(&glQueryCounter);
+  using GetQueryObjectui64vFn = decltype(&glGetQueryObjectui64v);
+#endif  // HAS_EGL
+
+  GlTimer() = default;
+
+  bool Initialize() {
+#if HAS_EGL
+    const char* extensions =
+        reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+    if (extensions == nullptr ||
+        std::strstr(extensions, "GL_EXT_disjoint_timer_query") == nullptr) {
+      return false;
+    }
+    query_counter_ = reinterpret_cast<QueryCounterFn>(
+        eglGetProcAddress("glQueryCounterEXT"));
+    get_query_object_ui64v_ = reinterpret_cast<GetQueryObjectui64vFn>(
+        eglGetProcAddress("glGetQueryObjectui64vEXT"));
+    // Clear the disjoint flag set before profiling.
+    IsDisjoint();
+#else
+    query_counter_ = &glQueryCounter;
+    get_query_object_ui64v_ = &glGetQueryObjectui64v;
+#endif  // HAS_EGL
+    return query_counter_ != nullptr && get_query_object_ui64v_ != nullptr;
+  }
+
+  QueryCounterFn query_counter_ = nullptr;
+  GetQueryObjectui64vFn get_query_object_ui64v_ = nullptr;
+  std::vector<GLuint> free_queries_;
+};
+#else
+// Timer queries are not available on this platform.
+class GlContextProfiler::GlTimer {
+ public:
+  static std::unique_ptr<GlTimer> Create() { return nullptr; }
+  GLuint QueryTimestamp() { return 0; }
+  bool IsAvailable(GLuint query) { return true; }
+  absl::Time ReadTimestamp(GLuint query) { return absl::UnixEpoch(); }
+  void ReleaseQuery(GLuint query) {}
+  absl::Time GetTimestamp() { return absl::UnixEpoch(); }
+  bool IsDisjoint() { return false; }
+};
+#endif  // HAS_EGL || (HAS_NSGL && CGL_VERSION_1_3)
+
+GlContextProfiler::GlContextProfiler(
+    std::shared_ptr<ProfilingContext> profiling_context)
+    : profiling_context_(std::move(profiling_context)) {}
+
+GlContextProfiler::~GlContextProfiler() {
+  if (!open_spans_.empty() || !pending_spans_.empty()) {
+    LOG(WARNING) << "GlContextProfiler destroyed without LogAllTimestamps().";
+  }
+}
+
+void GlContextProfiler::Initialize() {
+  initialized_ = true;
+  timer_ = GlTimer::Create();
+  if (timer_) {
+    CalibrateTimer();
+  } else {
+    VLOG(1) << "GPU timer queries are not supported, GPU time is not profiled.";
+  }
+}
+
+void GlContextProfiler::CalibrateTimer() {
+  // The CPU time halfway through reading the GPU time.
+  absl::Time cpu_start = profiling_context_->GetClock()->TimeNow();
+  absl::Time gpu_time = timer_->GetTimestamp();
+  absl::Time cpu_end = profiling_context_->GetClock()->TimeNow();
+  absl::Time cpu_time = cpu_start + (cpu_end - cpu_start) / 2;
+  gpu_time_offset_ = cpu_time - gpu_time;
+  profiling_context_->LogEvent(
+      TraceEvent(GraphTrace::GPU_CALIBRATION)
+          .set_event_time(cpu_time)
+          .set_packet_ts(Timestamp(absl::ToUnixMicros(gpu_time))));
+}
+
+void GlContextProfiler::MarkTimestamp(int node_id, Timestamp input_timestamp,
+                                      bool is_finish) {
+  if (!initialized_) Initialize();
+  if (!timer_) return;
+  if (!is_finish) {
+    if (pending_spans_.size() + open_spans_.size() >= kMaxPendingSpans) {
+      RetireReadySpans(/*wait=*/false);
+    }
+    GpuSpan span{node_id, input_timestamp, 0};
+    // A span beyond the limit is still opened, so that starts and finishes
+    // stay balanced, but issues no queries.
+    if (pending_spans_.size() + open_spans_.size() < kMaxPendingSpans) {
+      span.start_query = timer_->QueryTimestamp();
+    }
+    open_spans_.push_back(span);
+    return;
+  }
+  if (open_spans_.empty()) {
+    LOG_FIRST_N(WARNING, 1) << "GlContextProfiler finish without start.";
+    return;
+  }
+  GpuSpan span = open_spans_.back();
+  open_spans_.pop_back();
+  if (span.start_query != 0) {
+    span.finish_query = timer_->QueryTimestamp();
+    pending_spans_.push_back(span);
+  }
+  RetireReadySpans(/*wait=*/false);
+}
+
+void GlContextProfiler::RetireReadySpans(bool wait) {
+  if (timer_->IsDisjoint()) {
+    // The pending timings are unreliable, and the GPU clock may have jumped.
+    for (const GpuSpan& span : pending_spans_) {
+      timer_->ReleaseQuery(span.start_query);
+      timer_->ReleaseQuery(span.finish_query);
+    }
+    pending_spans_.clear();
+    CalibrateTimer();
+    return;
+  }
+  // Queries complete in order, so only the oldest span needs to be checked.
+  while (!pending_spans_.empty() &&
+         (wait || timer_->IsAvailable(pending_spans_.front().finish_query))) {
+    const GpuSpan& span = pending_spans_.front();
+    absl::Time start_time =
+        timer_->ReadTimestamp(span.start_query) + gpu_time_offset_;
+    absl::Time end_time =
+        timer_->ReadTimestamp(span.finish_query) + gpu_time_offset_;
+    profiling_context_->LogGpuSpan(span.node_id, span.input_timestamp,
+                                   start_time, end_time);
+    pending_spans_.pop_front();
+  }
+}
+
+void GlContextProfiler::LogAllTimestamps() {
+  if (!timer_) return;
+  RetireReadySpans(/*wait=*/true);
+  for (const GpuSpan& span : open_spans_) {
+    if (span.start_query != 0) timer_->ReleaseQuery(span.start_query);
+  }
+  open_spans_.clear();
+  timer_.reset();
+}
+
+}  // namespace mediapipe
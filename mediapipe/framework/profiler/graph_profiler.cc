@@ -16,10 +16,14 @@
 
 #include <fstream>
 #include <list>
+#include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "mediapipe/framework/input_stream_manager.h"
 #include "mediapipe/framework/port/advanced_proto_lite_inc.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/file_helpers.h"
@@ -28,6 +32,8 @@
 #include "mediapipe/framework/port/re2.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/profiler/compact_trace.h"
+#include "mediapipe/framework/profiler/perfetto_trace_writer.h"
 #include "mediapipe/framework/profiler/profiler_resource_util.h"
 #include "mediapipe/framework/tool/name_util.h"
 #include "mediapipe/framework/tool/tag_map.h"
@@ -176,18 +182,24 @@ void GraphProfiler::Initialize(
     profile.set_name(node_name);
     InitializeTimeHistogram(interval_size_usec, num_intervals,
                             profile.mutable_process_runtime());
+    const CalculatorGraphConfig::Node& node_config =
+        validated_graph_config.Config().node(node_id);
     if (profiler_config_.enable_stream_latency()) {
       InitializeTimeHistogram(interval_size_usec, num_intervals,
                               profile.mutable_process_input_latency());
       InitializeTimeHistogram(interval_size_usec, num_intervals,
                               profile.mutable_process_output_latency());
 
-      const CalculatorGraphConfig::Node& node_config =
-          validated_graph_config.Config().node(node_id);
       InitializeOutputStreams(node_config);
       InitializeInputStreams(node_config, interval_size_usec, num_intervals,
                              &profile);
+    } else if (profiler_config_.enable_stream_memory_accounting()) {
+      // The StreamProfiles only report the memory accounting.
+      InitializeInputStreams(node_config, interval_size_usec, num_intervals,
+                             &profile);
     }
+    node_ids_[node_name] = node_id;
+    node_names_.push_back(node_name);
 
     auto iter = calculator_profiles_.insert({node_name, profile});
     CHECK(iter.second) << absl::Substitute(
@@ -230,6 +242,9 @@ void GraphProfiler::Reset() {
     ResetTimeHistogram(calculator_profile->mutable_process_runtime());
     ResetTimeHistogram(calculator_profile->mutable_process_input_latency());
     ResetTimeHistogram(calculator_profile->mutable_process_output_latency());
+    if (calculator_profile->has_gpu_runtime()) {
+      ResetTimeHistogram(calculator_profile->mutable_gpu_runtime());
+    }
     for (auto& input_stream_profile :
          *(calculator_profile->mutable_input_stream_profiles())) {
       ResetTimeHistogram(input_stream_profile.mutable_latency());
@@ -279,6 +294,9 @@ absl::Status GraphProfiler::Stop() {
   if (IsTraceLogEnabled(profiler_config_)) {
     MP_RETURN_IF_ERROR(WriteProfile());
   }
+  if (trace_log_writer_) {
+    MP_RETURN_IF_ERROR(trace_log_writer_->Flush());
+  }
   return absl::OkStatus();
 }
 
@@ -301,6 +319,39 @@ void GraphProfiler::LogEvent(const TraceEvent& event) {
   }
 }
 
+void GraphProfiler::LogGpuSpan(int node_id, Timestamp input_timestamp,
+                               absl::Time start_time, absl::Time end_time) {
+  if (packet_tracer_) {
+    TraceEvent event(GraphTrace::GPU_TASK);
+    event.set_node_id(node_id).set_input_ts(input_timestamp);
+    packet_tracer_->LogEvent(
+        TraceEvent(event).set_event_time(start_time).set_is_finish(false));
+    packet_tracer_->LogEvent(
+        TraceEvent(event).set_event_time(end_time).set_is_finish(true));
+  }
+
+  // The gpu_runtime histogram is created by the first GPU span of a node, so
+  // a writer lock is needed.
+  absl::WriterMutexLock lock(&profiler_mutex_);
+  if (!is_profiling_ || node_id < 0 || node_id >= static_cast<int>(node_names_.size())) {
+    return;
+  }
+  auto profile_iter = calculator_profiles_.find(node_names_[node_id]);
+  if (profile_iter == calculator_profiles_.end()) {
+    return;
+  }
+  CalculatorProfile* calculator_profile = &profile_iter->second;
+  if (!calculator_profile->has_gpu_runtime()) {
+    const TimeHistogram& process_runtime =
+        calculator_profile->process_runtime();
+    InitializeTimeHistogram(process_runtime.interval_size_usec(),
+                            process_runtime.num_intervals(),
+                            calculator_profile->mutable_gpu_runtime());
+  }
+  AddTimeSample(absl::ToUnixMicros(start_time), absl::ToUnixMicros(end_time),
+                calculator_profile->mutable_gpu_runtime());
+}
+
 void GraphProfiler::AddPacketInfo(const TraceEvent& packet_info) {
   absl::ReaderMutexLock lock(&profiler_mutex_);
   if (!is_profiling_) {
@@ -336,10 +387,37 @@ absl::Status GraphProfiler::GetCalculatorProfiles(
       << "GetCalculatorProfiles can only be called after Initialize()";
   for (auto& entry : calculator_profiles_) {
     profiles->push_back(entry.second);
+    if (input_stream_managers_ &&
+        profiler_config_.enable_stream_memory_accounting()) {
+      AddStreamMemoryStats(&profiles->back());
+    }
   }
   return absl::OkStatus();
 }
 
+void GraphProfiler::AddStreamMemoryStats(
+    CalculatorProfile* calculator_profile) const {
+  auto node_id = node_ids_.find(calculator_profile->name());
+  if (node_id == node_ids_.end()) {
+    return;
+  }
+  // The StreamProfiles are in the order of the node's input streams.
+  const int base_index = validated_graph_->CalculatorInfos()[node_id->second]
+                             .InputStreamBaseIndex();
+  for (int i = 0; i < calculator_profile->input_stream_profiles_size(); ++i) {
+    const InputStreamManager& manager = input_stream_managers_[base_index + i];
+    StreamProfile* stream_profile =
+        calculator_profile->mutable_input_stream_profiles(i);
+    stream_profile->set_queue_size(manager.QueueSize());
+    stream_profile->set_peak_queue_size(manager.PeakQueueSize());
+    stream_profile->set_queued_bytes(manager.QueuedBytes());
+    stream_profile->set_peak_queued_bytes(manager.PeakQueuedBytes());
+    if (manager.MaxQueueBytes() != -1) {
+      stream_profile->set_max_queue_bytes(manager.MaxQueueBytes());
+    }
+  }
+}
+
 void GraphProfiler::InitializeTimeHistogram(int64 interval_size_usec,
                                             int64 num_intervals,
                                             TimeHistogram* histogram) {
@@ -565,7 +643,8 @@ void GraphProfiler::AddProcessSample(
 }
 
 std::unique_ptr<GlProfilingHelper> GraphProfiler::CreateGlProfilingHelper() {
-  if (!IsTracerEnabled(profiler_config_)) {
+  if (!IsProfilerEnabled(profiler_config_) &&
+      !IsTracerEnabled(profiler_config_)) {
     return nullptr;
   }
   return absl::make_unique<mediapipe::GlProfilingHelper>(shared_from_this());
@@ -641,6 +720,9 @@ void CleanCalculatorProfiles(GraphProfile* profile) {
     CleanTimeHistogram(p.mutable_process_runtime());
     CleanTimeHistogram(p.mutable_process_input_latency());
     CleanTimeHistogram(p.mutable_process_output_latency());
+    if (p.has_gpu_runtime()) {
+      CleanTimeHistogram(p.mutable_gpu_runtime());
+    }
     for (StreamProfile& s : *p.mutable_input_stream_profiles()) {
       CleanTimeHistogram(s.mutable_latency());
     }
@@ -691,6 +773,15 @@ absl::Status GraphProfiler::CaptureProfile(
   }
   this->Reset();
   CleanCalculatorProfiles(result);
+  if (packet_arena_) {
+    const PacketArena::Stats stats = packet_arena_->GetStats();
+    PacketArenaStats* arena_stats = result->mutable_packet_arena_stats();
+    arena_stats->set_allocations(stats.allocations);
+    arena_stats->set_reused_allocations(stats.reused_allocations);
+    arena_stats->set_oversized_allocations(stats.oversized_allocations);
+    arena_stats->set_live_blocks(stats.live_blocks);
+    arena_stats->set_reserved_bytes(stats.reserved_bytes);
+  }
   if (populate_config == PopulateGraphConfig::kFull) {
     *result->mutable_config() = validated_graph_->Config();
     AssignNodeNames(result);
@@ -704,6 +795,12 @@ absl::Status GraphProfiler::WriteProfile() {
     return absl::OkStatus();
   }
   ASSIGN_OR_RETURN(std::string trace_log_path, GetTraceLogPath());
+  if (profiler_config_.trace_log_format() == ProfilerConfig::PERFETTO) {
+    return WritePerfettoTrace(trace_log_path);
+  }
+  if (profiler_config_.trace_log_format() == ProfilerConfig::COMPACT) {
+    return WriteCompactTrace(trace_log_path);
+  }
   int log_interval_count = GetLogIntervalCount(profiler_config_);
   int log_file_count = GetLogFileCount(profiler_config_);
   GraphProfile profile;
@@ -738,4 +835,73 @@ absl::Status GraphProfiler::WriteProfile() {
   return absl::OkStatus();
 }
 
+absl::Status GraphProfiler::WritePerfettoTrace(
+    const std::string& trace_log_path) {
+  if (!tracer()) {
+    return absl::OkStatus();
+  }
+  std::vector<std::string> node_names;
+  for (int node_id = 0; node_id < validated_graph_->CalculatorInfos().size();
+       ++node_id) {
+    node_names.push_back(
+        tool::CanonicalNodeName(validated_graph_->Config(), node_id));
+  }
+  PerfettoTraceWriter writer(std::move(node_names));
+  // If there are no trace events, skip log writing.
+  if (tracer()->WritePerfettoTrace(&writer) == 0) {
+    return absl::OkStatus();
+  }
+
+  // Perfetto traces are sequences of packets, so each interval is appended
+  // to the current file.
+  ++previous_log_index_;
+  int log_interval_count = GetLogIntervalCount(profiler_config_);
+  int log_file_count = GetLogFileCount(profiler_config_);
+  bool is_new_file = (previous_log_index_ % log_interval_count == 0);
+  int log_index = previous_log_index_ / log_interval_count % log_file_count;
+  std::string log_path = absl::StrCat(trace_log_path, log_index, ".pftrace");
+  std::ofstream ofs;
+  if (is_new_file) {
+    ofs.open(log_path, std::ofstream::out | std::ofstream::binary |
+                           std::ofstream::trunc);
+  } else {
+    ofs.open(log_path, std::ofstream::out | std::ofstream::binary |
+                           std::ofstream::app);
+  }
+  ofs << writer.data();
+  RET_CHECK(ofs.good()) << "Could not write Perfetto trace to: " << log_path;
+  return absl::OkStatus();
+}
+
+absl::Status GraphProfiler::WriteCompactTrace(
+    const std::string& trace_log_path) {
+  GraphProfile profile;
+  MP_RETURN_IF_ERROR(CaptureProfile(&profile, PopulateGraphConfig::kNo));
+  // If there are no trace events, skip log writing.
+  if (is_tracing_ && !profile.graph_trace().empty() &&
+      profile.graph_trace().rbegin()->calculator_trace().empty()) {
+    return absl::OkStatus();
+  }
+
+  // Every file starts with the CalculatorGraphConfig, so that each file can
+  // be read on its own.
+  if (!trace_log_writer_) {
+    GraphProfile header;
+    *header.mutable_config() = validated_graph_->Config();
+    AssignNodeNames(&header);
+    trace_log_writer_ = std::make_unique<TraceLogWriter>(
+        trace_log_path, ".mptrace", GetLogFileCount(profiler_config_),
+        profiler_config_.trace_log_file_size(),
+        absl::StrCat(kCompactTraceMagic, EncodeCompactProfile(header)));
+  }
+  ++previous_log_index_;
+  bool is_new_file =
+      profiler_config_.trace_log_file_size() == 0 &&
+      previous_log_index_ % GetLogIntervalCount(profiler_config_) == 0;
+  // The file is written on the writer's thread; errors are returned by
+  // Stop().
+  trace_log_writer_->Append(EncodeCompactProfile(profile), is_new_file);
+  return absl::OkStatus();
+}
+
 }  // namespace mediapipe
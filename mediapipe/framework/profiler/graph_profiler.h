@@ -17,11 +17,14 @@
 
 #include <atomic>
 #include <cstddef>
+#include <deque>
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
@@ -29,14 +32,18 @@
 #include "mediapipe/framework/deps/clock.h"
 #include "mediapipe/framework/deps/monotonic_clock.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/packet_arena.h"
+#include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/profiler/graph_tracer.h"
 #include "mediapipe/framework/profiler/sharded_map.h"
+#include "mediapipe/framework/profiler/trace_log_writer.h"
 #include "mediapipe/framework/validated_graph_config.h"
 
 namespace mediapipe {
 
 class GlProfilingHelper;
+class InputStreamManager;
 
 struct PacketId {
   // Stream name, excluding TAG if available.
@@ -125,6 +132,20 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   const std::shared_ptr<mediapipe::Clock> GetClock() const
       ABSL_LOCKS_EXCLUDED(profiler_mutex_);
 
+  // Sets the graph's packet arena, whose counters are reported by
+  // CaptureProfile.
+  void SetPacketArena(std::shared_ptr<const PacketArena> packet_arena) {
+    packet_arena_ = std::move(packet_arena);
+  }
+
+  // Sets the graph's input stream managers, indexed like
+  // ValidatedGraphConfig::InputStreamInfos(). If
+  // ProfilerConfig.enable_stream_memory_accounting is set, their queue sizes
+  // and queued bytes are reported in the StreamProfiles.
+  void SetInputStreamManagers(const InputStreamManager* input_stream_managers) {
+    input_stream_managers_ = input_stream_managers;
+  }
+
   // Pauses profiling. No-op if already paused.
   void Pause();
   // Resumes profiling. No-op if already profiling.
@@ -140,6 +161,13 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Record a tracing event.
   void LogEvent(const TraceEvent& event);
 
+  // Records GPU work of a node for the packet at input_timestamp, measured by
+  // the GPU between start_time and end_time. The span is traced as GPU_TASK
+  // events and added to the gpu_runtime of the CalculatorProfile. Called by
+  // the GlContextProfiler and for Metal command buffers.
+  void LogGpuSpan(int node_id, Timestamp input_timestamp, absl::Time start_time,
+                  absl::Time end_time) ABSL_LOCKS_EXCLUDED(profiler_mutex_);
+
   // Collects the runtime profile for Open(), Process(), and Close() of each
   // calculator in the graph. May be called at any time after the graph has been
   // initialized.
@@ -164,7 +192,8 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Returns the trace event buffer.
   GraphTracer* tracer() { return packet_tracer_.get(); }
 
-  // Creates and returns a GlProfilingHelper interface for a single GLContext.
+  // Creates and returns a GlProfilingHelper interface for a single GLContext,
+  // or nullptr if neither the profiler nor the tracer is enabled.
   std::unique_ptr<GlProfilingHelper> CreateGlProfilingHelper();
 
   // Convenience temporary object to record scoped entry and exit.
@@ -265,6 +294,8 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   void InitializeInputStreams(const CalculatorGraphConfig::Node& node_config,
                               int64 interval_size_usec, int64 num_intervals,
                               CalculatorProfile* calculator_profile);
+  // Sets the queue sizes and queued bytes of the StreamProfiles.
+  void AddStreamMemoryStats(CalculatorProfile* calculator_profile) const;
   // Returns the input stream back edges for a calculator.
   std::set<int> GetBackEdgeIds(const CalculatorGraphConfig::Node& node_config,
                                const tool::TagMap& input_tag_map);
@@ -307,6 +338,15 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // trace_log_path.
   absl::StatusOr<std::string> GetTraceLogPath();
 
+  // Writes the trace events since the previous call to a Perfetto trace file
+  // under `trace_log_path`. Used with PERFETTO trace_log_format.
+  absl::Status WritePerfettoTrace(const std::string& trace_log_path);
+
+  // Queues the GraphProfile since the previous call to be written to a
+  // compact trace log file under `trace_log_path`. Used with COMPACT
+  // trace_log_format.
+  absl::Status WriteCompactTrace(const std::string& trace_log_path);
+
   // Helper method to get the clock time in microsecond.
   int64 TimeNowUsec() { return ToUnixMicros(clock_->TimeNow()); }
 
@@ -350,9 +390,23 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // The index number of the previous output log.
   int previous_log_index_;
 
+  // Writes the COMPACT trace log files, created by the first
+  // WriteCompactTrace().
+  std::unique_ptr<TraceLogWriter> trace_log_writer_;
+
   // The configuration for the graph being profiled.
   const ValidatedGraphConfig* validated_graph_;
 
+  // The packet arena of the graph being profiled, if any.
+  std::shared_ptr<const PacketArena> packet_arena_;
+
+  // The input stream managers of the graph being profiled, if any.
+  const InputStreamManager* input_stream_managers_ = nullptr;
+
+  // The node id of each calculator name, and the name of each node id.
+  absl::flat_hash_map<std::string, int> node_ids_;
+  std::vector<std::string> node_names_;
+
   // A private resource for creating GraphProfiles.
   class GraphProfileBuilder;
   std::unique_ptr<GraphProfileBuilder> profile_builder_;
@@ -369,77 +423,67 @@ class ProfilingContext : public GraphProfiler {
   using GraphProfiler::GraphProfiler;
 };
 
-// For now, OSS always uses GlContextProfilerStub.
-// TODO: Switch to GlContextProfiler when GlContext is moved to OSS.
-#define MEDIAPIPE_DISABLE_GPU_PROFILER 1
-
-// GlContextProfiler keeps track of all timestamp queries within a specific
-// GlContext object. When created, the GlContextProfiler must be initialized
-// before marking timestamps. Finally, when GlContext is no longer interested
-// in marking timestamps or is about to be destroyed, Finish() must be called
-// to complete all pending time queries and detach the timer from the GlContext.
-// Note that the GlContextProfiler must be created and initialized within a
-// valid GlContext object.
-#if !MEDIAPIPE_DISABLE_GPU_PROFILER
+// GlContextProfiler measures the GPU time of the work run in a GlContext with
+// timestamp queries, and reports it through ProfilingContext::LogGpuSpan().
+// MarkTimestamp() only issues the queries; their results are collected by
+// later calls once the GPU has reached them, so profiling never waits for the
+// GPU. Before the GlContext is destroyed, LogAllTimestamps() must be called to
+// collect the remaining results and release the queries. All methods must be
+// called with the GlContext current.
+//
+// Timing is supported with GL_ARB_timer_query on desktop OpenGL and with
+// GL_EXT_disjoint_timer_query on OpenGL ES. Otherwise the profiler does
+// nothing.
+#if !MEDIAPIPE_DISABLE_GPU
 class GlContextProfiler {
  public:
   explicit GlContextProfiler(
-      std::shared_ptr<ProfilingContext> profiling_context)
-      : profiling_context_(profiling_context) {}
+      std::shared_ptr<ProfilingContext> profiling_context);
+  ~GlContextProfiler();
 
   // Not copyable or movable.
   GlContextProfiler(const GlContextProfiler&) = delete;
   GlContextProfiler& operator=(const GlContextProfiler&) = delete;
 
-  // Add a GlTimingInfo object to the collection of pending timestamp queries
-  // associated with a specific graph node_id, packet input_timestamp and mark
-  // if it is a start or stop event. When a stop event is marked, this function
-  // blocks on the corresponding start event to complete.
+  // Marks the start or the finish of GPU work by node_id for the packet at
+  // input_timestamp. Starts and finishes may nest, and must be balanced.
   void MarkTimestamp(int node_id, Timestamp input_timestamp, bool is_finish);
 
-  // Complete all pending timing queries and detach the timer from the
-  // GlContext.
+  // Waits for all pending timing queries, reports them, and releases the
+  // queries.
   void LogAllTimestamps();
 
  private:
-  // Store GlTimeQuery and the corresponding TraceEvent object that should be
-  // populated when the query completes together.
-  struct GlTimingInfo {
-    GlTimeQuery time_query;
-    TraceEvent trace_event;
+  // The GL timer queries, defined in gl_context_profiler.cc.
+  class GlTimer;
+
+  // A span of GPU work, between two timestamp queries.
+  struct GpuSpan {
+    int node_id;
+    Timestamp input_timestamp;
+    uint32 start_query;
+    uint32 finish_query = 0;
   };
 
-  // Setup the timer for marking GPU timestamps. If successful in setup, return
-  // true otherwise return false to indicate that timing measurment is not
-  // supported.
-  bool Initialize();
-
-  absl::Time TimeNow();
-
-  // Calibrate the GPU timer w.r.t. the CPU clock. If calibration is fails,
-  // timing_measurement_supported_ is set to false.
-  void CalibrateTimer(bool recalibrate);
-
-  // Log a TraceEvent object to represent if the GPU calibration period has
-  // started or just ended.
-  void LogCalibrationEvent(bool started, absl::Time time);
+  // Creates the timer, if the GlContext supports timer queries.
+  void Initialize();
 
-  // Log TraceEvent objects for completed time queries. If the parameter wait is
-  // set to true, wait for all time queries to complete before returning.
-  void RetireReadyGlTimings(bool wait = false);
+  // Measures the offset from GPU time to the profiler clock.
+  void CalibrateTimer();
 
-  // Get the TraceEvent object containing the timestamp recorded by the GPU if
-  // the provided query was fulfilled. If it is still pending and wait is false,
-  // return absl::nullopt.
-  absl::optional<TraceEvent> GetTimeFromQuery(
-      std::unique_ptr<GlTimingInfo>& query, bool wait);
+  // Reports the finished spans whose queries are available. If wait is true,
+  // waits for all of them.
+  void RetireReadySpans(bool wait);
 
   std::shared_ptr<ProfilingContext> profiling_context_;
-  GlSimpleTimer gl_timer_;
-  bool checked_timing_supported_ = false;
-  bool timing_measurement_supported_ = false;
-  std::deque<std::unique_ptr<GlTimingInfo>> pending_gl_times_;
-  std::unique_ptr<GlTimingInfo> gl_start_query_;
+  std::unique_ptr<GlTimer> timer_;
+  bool initialized_ = false;
+  // The profiler clock time minus the GPU time.
+  absl::Duration gpu_time_offset_;
+  // The spans started but not finished, innermost last.
+  std::vector<GpuSpan> open_spans_;
+  // The finished spans whose queries are pending, oldest first.
+  std::deque<GpuSpan> pending_spans_;
 };
 
 // The API class used to access the preferred GlContext profiler, such as
@@ -449,7 +493,7 @@ class GlContextProfiler {
 class GlProfilingHelper : public GlContextProfiler {
   using GlContextProfiler::GlContextProfiler;
 };
-#else   // MEDIAPIPE_DISABLE_GPU_PROFILER
+#else   // MEDIAPIPE_DISABLE_GPU
 class GlContextProfilerStub {
  public:
   explicit GlContextProfilerStub(
@@ -464,8 +508,7 @@ class GlContextProfilerStub {
 class GlProfilingHelper : public GlContextProfilerStub {
   using GlContextProfilerStub::GlContextProfilerStub;
 };
-#endif  // !MEDIAPIPE_DISABLE_GPU_PROFILER
-#undef MEDIAPIPE_DISABLE_GPU_PROFILER
+#endif  // !MEDIAPIPE_DISABLE_GPU
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_PROFILER_H_
@@ -15,6 +15,7 @@
 #ifndef MEDIAPIPE_FRAMEWORK_PROFILER_MEDIAPIPE_PROFILER_STUB_H_
 #define MEDIAPIPE_FRAMEWORK_PROFILER_MEDIAPIPE_PROFILER_STUB_H_
 
+#include "absl/time/time.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/timestamp.h"
 
@@ -35,6 +36,8 @@ class Packet;
 class Clock;
 class GraphTracer;
 class GlProfilingHelper;
+class InputStreamManager;
+class PacketArena;
 
 class TraceEvent {
  public:
@@ -84,6 +87,8 @@ class GraphProfilerStub {
   inline void Initialize(const ValidatedGraphConfig& validated_graph_config) {}
   inline void SetClock(const std::shared_ptr<mediapipe::Clock>& clock) {}
   inline void LogEvent(const TraceEvent& event) {}
+  inline void LogGpuSpan(int node_id, Timestamp input_timestamp,
+                         absl::Time start_time, absl::Time end_time) {}
   inline absl::Status GetCalculatorProfiles(
       std::vector<CalculatorProfile>*) const {
     return absl::OkStatus();
@@ -105,6 +110,9 @@ class GraphProfilerStub {
     return nullptr;
   }
   const std::shared_ptr<mediapipe::Clock> GetClock() const { return nullptr; }
+  inline void SetPacketArena(std::shared_ptr<const PacketArena> packet_arena) {}
+  inline void SetInputStreamManagers(
+      const InputStreamManager* input_stream_managers) {}
 };
 
 // The API class used to access the preferred profiler, such as
@@ -1132,6 +1132,37 @@ TEST_F(GraphProfilerTestPeer, AddProcessSampleWithStreamLatency) {
   ASSERT_NE(GetPacketInfo(GetPacketsInfoMap(), {"stream_1", 100}), nullptr);
 }
 
+// Tests that LogGpuSpan() adds |gpu_runtime| to the profile of the node.
+TEST_F(GraphProfilerTestPeer, LogGpuSpan) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+      output_stream: "output_stream"
+    })");
+
+  profiler_.LogGpuSpan(/*node_id=*/0, Timestamp(100),
+                       absl::FromUnixMicros(1000), absl::FromUnixMicros(1250));
+  profiler_.LogGpuSpan(/*node_id=*/0, Timestamp(200),
+                       absl::FromUnixMicros(2000), absl::FromUnixMicros(2100));
+  // Spans of unknown nodes are ignored.
+  profiler_.LogGpuSpan(/*node_id=*/7, Timestamp(200),
+                       absl::FromUnixMicros(2000), absl::FromUnixMicros(2100));
+
+  std::vector<CalculatorProfile> profiles = Profiles();
+  ASSERT_EQ(profiles.size(), 1);
+  EXPECT_THAT(profiles[0].gpu_runtime(), EqualsProto(R"pb(
+                total: 350
+                interval_size_usec: 1000000
+                num_intervals: 1
+                count: 2
+              )pb"));
+}
+
 // This test shows that CalculatorGraph::GetCalculatorProfiles and
 // GraphProfiler::AddProcessSample() can be called in parallel.
 // Without the GraphProfiler::profiler_mutex_ this test should
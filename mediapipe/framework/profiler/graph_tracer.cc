@@ -14,12 +14,16 @@
 
 #include "mediapipe/framework/profiler/graph_tracer.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/input_stream_shard.h"
 #include "mediapipe/framework/output_stream_shard.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/profiler/trace_builder.h"
 #include "mediapipe/framework/timestamp.h"
 
@@ -37,6 +41,48 @@ inline int GetCurrentThreadId() {
   return thread_id;
 }
 
+// Returns a record of a packet event.
+inline TraceRecord PacketRecord(TraceRecord::Kind kind, EventType event_type,
+                                const CalculatorContext* context,
+                                Timestamp input_ts,
+                                const std::string* stream_id,
+                                const Packet& packet) {
+  TraceRecord record;
+  record.time = CycleClockNow();
+  record.kind = kind;
+  record.event_type = event_type;
+  record.node_id = context->NodeId();
+  record.input_ts = input_ts.Value();
+  record.stream_id = stream_id;
+  record.packet_ts = packet.Timestamp().Value();
+  record.event_data =
+      packet_internal::GetPacketDataId(packet_internal::GetHolder(packet));
+  return record;
+}
+
+// Returns a record of the start or the end of a calculator method.
+inline TraceRecord SliceRecord(TraceRecord::Kind kind, EventType event_type,
+                               const CalculatorContext* context,
+                               Timestamp input_ts) {
+  TraceRecord record;
+  record.time = CycleClockNow();
+  record.kind = kind;
+  record.event_type = event_type;
+  record.node_id = context->NodeId();
+  record.input_ts = input_ts.Value();
+  record.is_finish = kind == TraceRecord::kSliceEnd;
+  return record;
+}
+
+// Returns a well mixed hash of a timestamp value, so that timestamps at
+// regular intervals are sampled evenly.
+inline uint64 MixTimestamp(int64 value) {
+  uint64 x = static_cast<uint64>(value);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
 }  // namespace
 
 absl::Duration GraphTracer::GetTraceLogInterval() {
@@ -52,29 +98,109 @@ int64 GraphTracer::GetTraceLogCapacity() {
 }
 
 GraphTracer::GraphTracer(const ProfilerConfig& profiler_config)
-    : profiler_config_(profiler_config), trace_buffer_(GetTraceLogCapacity()) {
+    : profiler_config_(profiler_config),
+      trace_buffer_(GetTraceLogCapacity()),
+      sample_interval_(std::max(profiler_config.trace_sample_interval(), 1)) {
+  for (auto& timestamp : propagated_timestamps_) {
+    timestamp.store(Timestamp::Unset().Value(), std::memory_order_relaxed);
+  }
   for (int disabled : profiler_config_.trace_event_types_disabled()) {
     EventType event_type = static_cast<EventType>(disabled);
     (*trace_event_registry())[event_type].set_enabled(false);
   }
+  if (profiler_config_.trace_log_format() == ProfilerConfig::PERFETTO) {
+    trace_rings_ = std::make_unique<TraceRingSet>(GetTraceLogCapacity());
+  }
 }
 
 TraceEventRegistry* GraphTracer::trace_event_registry() {
   return trace_builder_.trace_event_registry();
 }
 
+bool GraphTracer::IsSampled(Timestamp timestamp) const {
+  if (sample_interval_ == 1 || !timestamp.IsRangeValue()) {
+    return true;
+  }
+  if (MixTimestamp(timestamp.Value()) % sample_interval_ == 0) {
+    return true;
+  }
+  for (const auto& propagated : propagated_timestamps_) {
+    if (propagated.load(std::memory_order_relaxed) == timestamp.Value()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void GraphTracer::AddSampledTimestamp(Timestamp timestamp) {
+  if (IsSampled(timestamp)) {
+    return;
+  }
+  int index = next_propagated_index_.fetch_add(1, std::memory_order_relaxed) %
+              kNumPropagatedTimestamps;
+  propagated_timestamps_[index].store(timestamp.Value(),
+                                      std::memory_order_relaxed);
+}
+
 void GraphTracer::LogEvent(TraceEvent event) {
   if (!(*trace_event_registry())[event.event_type].enabled()) {
     return;
   }
+  if (!IsSampled(event.input_ts != Timestamp::Unset() ? event.input_ts
+                                                      : event.packet_ts)) {
+    return;
+  }
+  if (trace_rings_) {
+    TraceRecord record;
+    // GPU events carry the time measured by the GPU.
+    if (event.event_type == GraphTrace::GPU_TASK ||
+        event.event_type == GraphTrace::GPU_CALIBRATION) {
+      record.time = absl::ToUnixNanos(event.event_time);
+      record.time_is_ticks = false;
+    } else {
+      record.time = CycleClockNow();
+    }
+    record.event_type = event.event_type;
+    record.is_finish = event.is_finish;
+    record.input_ts = event.input_ts.Value();
+    record.packet_ts = event.packet_ts.Value();
+    record.node_id = event.node_id;
+    record.stream_id = event.stream_id;
+    record.event_data = event.event_data;
+    WriteRecord(record);
+    return;
+  }
   event.set_thread_id(GetCurrentThreadId());
   trace_buffer_.push_back(event);
 }
 
+void GraphTracer::WriteRecord(const TraceRecord& record) {
+  trace_rings_->GetThreadRing()->Write(record);
+}
+
 void GraphTracer::LogInputEvents(GraphTrace::EventType event_type,
                                  const CalculatorContext* context,
                                  absl::Time event_time) {
   Timestamp input_ts = context->InputTimestamp();
+  if (!IsSampled(input_ts)) {
+    return;
+  }
+  if (trace_rings_) {
+    if (!(*trace_event_registry())[event_type].enabled()) {
+      return;
+    }
+    WriteRecord(SliceRecord(TraceRecord::kSliceBegin, event_type, context,
+                            input_ts));
+    for (const InputStreamShard& in_stream : context->Inputs()) {
+      const Packet& packet = in_stream.Value();
+      if (!packet.IsEmpty()) {
+        WriteRecord(PacketRecord(TraceRecord::kInputPacket, event_type,
+                                 context, input_ts, &in_stream.Name(),
+                                 packet));
+      }
+    }
+    return;
+  }
   for (const InputStreamShard& in_stream : context->Inputs()) {
     const Packet& packet = in_stream.Value();
     if (!packet.IsEmpty()) {
@@ -98,6 +224,34 @@ void GraphTracer::LogOutputEvents(GraphTrace::EventType event_type,
   Timestamp input_ts = (context->Inputs().NumEntries() > 0)
                            ? context->InputTimestamp()
                            : GetOutputTimestamp(context);
+  if (!IsSampled(input_ts)) {
+    return;
+  }
+  if (sample_interval_ > 1) {
+    // Trace the packets derived from the sampled packets downstream.
+    for (const OutputStreamShard& out_stream : context->Outputs()) {
+      for (const Packet& packet : *out_stream.OutputQueue()) {
+        if (packet.Timestamp() != input_ts) {
+          AddSampledTimestamp(packet.Timestamp());
+        }
+      }
+    }
+  }
+  if (trace_rings_) {
+    if (!(*trace_event_registry())[event_type].enabled()) {
+      return;
+    }
+    for (const OutputStreamShard& out_stream : context->Outputs()) {
+      for (const Packet& packet : *out_stream.OutputQueue()) {
+        WriteRecord(PacketRecord(TraceRecord::kOutputPacket, event_type,
+                                 context, input_ts, &out_stream.Name(),
+                                 packet));
+      }
+    }
+    WriteRecord(
+        SliceRecord(TraceRecord::kSliceEnd, event_type, context, input_ts));
+    return;
+  }
   for (const OutputStreamShard& out_stream : context->Outputs()) {
     const std::string* stream_id = &out_stream.Name();
     for (const Packet& packet : *out_stream.OutputQueue()) {
@@ -139,6 +293,37 @@ void GraphTracer::GetLog(absl::Time begin_time, absl::Time end_time,
 
 const TraceBuffer& GraphTracer::GetTraceBuffer() { return trace_buffer_; }
 
+int64 GraphTracer::WritePerfettoTrace(PerfettoTraceWriter* writer) {
+  if (!trace_rings_) {
+    return 0;
+  }
+  // Each TraceRing supports only one reader at a time.
+  absl::MutexLock lock(trace_builder_mutex());
+  cycle_clock_.Recalibrate();
+  int64 num_records = 0;
+  std::vector<TraceRecord> records;
+  for (TraceRing* ring : trace_rings_->GetRings()) {
+    writer->AddThreadTrack(ring->thread_index());
+    records.clear();
+    ring->Read(&records);
+    for (const TraceRecord& record : records) {
+      absl::Time time = record.time_is_ticks
+                            ? cycle_clock_.ToTime(record.time)
+                            : absl::FromUnixNanos(record.time);
+      writer->AddRecord(ring->thread_index(), record, time);
+    }
+    num_records += records.size();
+  }
+  int64 dropped_count = trace_rings_->dropped_count();
+  if (dropped_count > reported_dropped_count_) {
+    LOG(WARNING) << dropped_count - reported_dropped_count_
+                 << " trace events were dropped, consider increasing "
+                    "trace_log_capacity.";
+    reported_dropped_count_ = dropped_count;
+  }
+  return num_records;
+}
+
 Timestamp GraphTracer::GetOutputTimestamp(const CalculatorContext* context) {
   for (const OutputStreamShard& out_stream : context->Outputs()) {
     for (const Packet& packet : *out_stream.OutputQueue()) {
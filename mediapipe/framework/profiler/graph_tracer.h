@@ -15,13 +15,19 @@
 #ifndef MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_TRACER_H_
 #define MEDIAPIPE_FRAMEWORK_PROFILER_GRAPH_TRACER_H_
 
+#include <array>
+#include <atomic>
+#include <memory>
 #include <string>
 
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/profiler/cycle_clock.h"
+#include "mediapipe/framework/profiler/perfetto_trace_writer.h"
 #include "mediapipe/framework/profiler/trace_buffer.h"
 #include "mediapipe/framework/profiler/trace_builder.h"
+#include "mediapipe/framework/profiler/trace_ring.h"
 
 namespace mediapipe {
 
@@ -44,6 +50,12 @@ namespace mediapipe {
 //
 //   end_time = current_time - max_packet_latency
 //
+// With ProfilerConfig::PERFETTO trace_log_format, events are instead recorded
+// in per-thread TraceRings, timed with CycleClockNow(), and retrieved with
+// WritePerfettoTrace. GetTrace and GetLog then return no events.
+//
+// With ProfilerConfig::trace_sample_interval, only the events of sampled
+// packet timestamps are recorded; see IsSampled.
 class GraphTracer {
  public:
   // Returns the interval between trace log output.
@@ -81,7 +93,21 @@ class GraphTracer {
   // Returns the logged TraceEvents.
   const TraceBuffer& GetTraceBuffer();
 
+  // Encodes the events recorded since the previous call with `writer`, and
+  // returns their number. Only supported with PERFETTO trace_log_format.
+  int64 WritePerfettoTrace(PerfettoTraceWriter* writer);
+
+  // Returns true if events for packet timestamp `timestamp` are traced, as
+  // selected by ProfilerConfig::trace_sample_interval.
+  bool IsSampled(Timestamp timestamp) const;
+
  private:
+  // Traces `timestamp` as an output of a sampled timestamp.
+  void AddSampledTimestamp(Timestamp timestamp);
+
+  // Records `record` in the TraceRing of the calling thread.
+  void WriteRecord(const TraceRecord& record);
+
   // Returns the timestamp of the first output packet.
   Timestamp GetOutputTimestamp(const CalculatorContext* context);
 
@@ -93,6 +119,26 @@ class GraphTracer {
 
   // The builder for the GraphTrace protobuf.
   TraceBuilder trace_builder_;
+
+  // The per-thread event rings, used with PERFETTO trace_log_format.
+  std::unique_ptr<TraceRingSet> trace_rings_;
+
+  // Converts the CycleClockNow() times of records in trace_rings_.
+  CycleClockConverter cycle_clock_;
+
+  // The number of dropped records reported so far.
+  int64 reported_dropped_count_ = 0;
+
+  // The sampling interval, or 1 if every timestamp is traced.
+  int sample_interval_;
+
+  // Recent timestamps traced because they were output for a sampled
+  // timestamp. These are checked without locking on every event, so only a
+  // few recent ones are kept, overwritten in turn.
+  static constexpr int kNumPropagatedTimestamps = 32;
+  std::array<std::atomic<int64>, kNumPropagatedTimestamps>
+      propagated_timestamps_;
+  std::atomic<int> next_propagated_index_{0};
 };
 
 }  // namespace mediapipe
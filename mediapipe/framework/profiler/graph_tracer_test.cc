@@ -18,6 +18,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -328,6 +329,58 @@ TEST_F(GraphTracerTest, GraphTrace) {
   EXPECT_EQ(4, trace.calculator_trace().size());
 }
 
+TEST_F(GraphTracerTest, SampledTrace) {
+  ProfilerConfig profiler_config;
+  profiler_config.set_trace_enabled(true);
+  profiler_config.set_trace_sample_interval(10);
+  tracer_ = absl::make_unique<GraphTracer>(profiler_config);
+  SetUpCalculatorContext("PCalculator_1", /*node_id=*/0, {"input_stream"},
+                         {"output_stream"});
+  SetUpCalculatorContext("PCalculator_2", /*node_id=*/1, {"output_stream"},
+                         {"final_stream"});
+
+  // PCalculator_1 outputs each packet one microsecond later, and
+  // PCalculator_2 passes it through.
+  constexpr int kNumPackets = 1000;
+  int num_sampled = 0;
+  absl::Time curr_time = start_time_;
+  for (int i = 0; i < kNumPackets; ++i) {
+    Timestamp input_ts = start_timestamp_ + i * 1000;
+    Timestamp output_ts = input_ts + 1;
+    bool is_sampled = tracer_->IsSampled(input_ts);
+    num_sampled += is_sampled;
+    ClearCalculatorContext("PCalculator_1");
+    LogInputPackets("PCalculator_1", GraphTrace::PROCESS, curr_time,
+                    {MakePacket<int>(i).At(input_ts)});
+    LogOutputPackets("PCalculator_1", GraphTrace::PROCESS, curr_time,
+                     {{MakePacket<int>(i).At(output_ts)}});
+    // The output timestamp of a sampled packet is sampled too.
+    if (is_sampled) {
+      EXPECT_TRUE(tracer_->IsSampled(output_ts));
+    }
+    ClearCalculatorContext("PCalculator_2");
+    LogInputPackets("PCalculator_2", GraphTrace::PROCESS, curr_time,
+                    {MakePacket<int>(i).At(output_ts)});
+    LogOutputPackets("PCalculator_2", GraphTrace::PROCESS, curr_time,
+                     {{MakePacket<int>(i).At(output_ts)}});
+    curr_time += absl::Microseconds(1000);
+  }
+  EXPECT_GT(num_sampled, kNumPackets / 20);
+  EXPECT_LT(num_sampled, kNumPackets / 5);
+
+  // Both calculators are traced for each sampled packet.
+  GraphTrace trace = GetTrace();
+  std::map<int64, std::set<int>> nodes_by_timestamp;
+  for (const auto& calculator_trace : trace.calculator_trace()) {
+    nodes_by_timestamp[calculator_trace.input_timestamp() % 1000].insert(
+        calculator_trace.node_id());
+  }
+  EXPECT_THAT(nodes_by_timestamp,
+              ElementsAre(std::make_pair(0, std::set<int>{0}),
+                          std::make_pair(1, std::set<int>{1})));
+  EXPECT_GE(trace.calculator_trace_size(), 2 * num_sampled);
+}
+
 // Tests showing GraphTracer logging packet latencies.
 class GraphTracerE2ETest : public ::testing::Test {
  protected:
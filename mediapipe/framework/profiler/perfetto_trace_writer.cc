@@ -0,0 +1,200 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/perfetto_trace_writer.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+
+namespace mediapipe {
+namespace {
+
+// Field numbers of the Perfetto protos, from perfetto/protos/perfetto/trace.
+// Trace.
+constexpr int kTracePacket = 1;
+// TracePacket.
+constexpr int kPacketTimestamp = 8;
+constexpr int kPacketSequenceId = 10;
+constexpr int kPacketTrackEvent = 11;
+constexpr int kPacketSequenceFlags = 13;
+constexpr int kPacketTrackDescriptor = 60;
+// TrackDescriptor.
+constexpr int kTrackUuid = 1;
+constexpr int kTrackName = 2;
+// TrackEvent.
+constexpr int kEventDebugAnnotations = 4;
+constexpr int kEventType = 9;
+constexpr int kEventTrackUuid = 11;
+constexpr int kEventCategories = 22;
+constexpr int kEventName = 23;
+constexpr int kEventFlowIds = 47;
+// DebugAnnotation.
+constexpr int kAnnotationIntValue = 4;
+constexpr int kAnnotationStringValue = 6;
+constexpr int kAnnotationName = 10;
+
+// TrackEvent.Type values.
+constexpr int kSliceBegin = 1;
+constexpr int kSliceEnd = 2;
+constexpr int kInstant = 3;
+
+// TracePacket.SequenceFlags.SEQ_INCREMENTAL_STATE_CLEARED.
+constexpr int kIncrementalStateCleared = 1;
+
+// All packets are written on one trusted sequence.
+constexpr int kSequenceId = 1;
+
+enum WireType { kVarint = 0, kFixed64 = 1, kLengthDelimited = 2 };
+
+void AppendVarint(uint64 value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void AppendTag(int field, WireType wire_type, std::string* out) {
+  AppendVarint((static_cast<uint64>(field) << 3) | wire_type, out);
+}
+
+void AppendVarintField(int field, uint64 value, std::string* out) {
+  AppendTag(field, kVarint, out);
+  AppendVarint(value, out);
+}
+
+void AppendFixed64Field(int field, uint64 value, std::string* out) {
+  AppendTag(field, kFixed64, out);
+  for (int i = 0; i < 8; ++i) {
+    out->push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+void AppendBytesField(int field, absl::string_view value, std::string* out) {
+  AppendTag(field, kLengthDelimited, out);
+  AppendVarint(value.size(), out);
+  out->append(value.data(), value.size());
+}
+
+void AppendIntAnnotation(absl::string_view name, int64 value,
+                         std::string* event) {
+  std::string annotation;
+  AppendBytesField(kAnnotationName, name, &annotation);
+  AppendVarintField(kAnnotationIntValue, value, &annotation);
+  AppendBytesField(kEventDebugAnnotations, annotation, event);
+}
+
+void AppendStringAnnotation(absl::string_view name, absl::string_view value,
+                            std::string* event) {
+  std::string annotation;
+  AppendBytesField(kAnnotationName, name, &annotation);
+  AppendBytesField(kAnnotationStringValue, value, &annotation);
+  AppendBytesField(kEventDebugAnnotations, annotation, event);
+}
+
+uint64 ThreadTrackUuid(int thread_index) { return thread_index + 1; }
+
+// Returns the flow id shared by the producer and the consumers of a packet.
+uint64 PacketFlowId(const TraceRecord& record) {
+  uint64 id = static_cast<uint64>(record.event_data) * 0x9E3779B97F4A7C15ull;
+  id ^= static_cast<uint64>(record.packet_ts) + 0x632BE59BD9B4E019ull +
+        (id << 6) + (id >> 2);
+  return id;
+}
+
+}  // namespace
+
+PerfettoTraceWriter::PerfettoTraceWriter(std::vector<std::string> node_names)
+    : node_names_(std::move(node_names)) {}
+
+void PerfettoTraceWriter::AddThreadTrack(int thread_index) {
+  std::string track;
+  AppendVarintField(kTrackUuid, ThreadTrackUuid(thread_index), &track);
+  AppendBytesField(kTrackName, absl::StrCat("mediapipe thread ", thread_index),
+                   &track);
+  std::string packet;
+  AppendBytesField(kPacketTrackDescriptor, track, &packet);
+  AppendBytesField(kTracePacket, packet, &data_);
+}
+
+void PerfettoTraceWriter::AddRecord(int thread_index,
+                                    const TraceRecord& record,
+                                    absl::Time time) {
+  std::string event;
+  AppendVarintField(kEventTrackUuid, ThreadTrackUuid(thread_index), &event);
+  switch (record.kind) {
+    case TraceRecord::kSliceBegin:
+      AppendVarintField(kEventType, kSliceBegin, &event);
+      AppendBytesField(kEventName, NodeName(record.node_id), &event);
+      AppendBytesField(kEventCategories,
+                       GraphTrace::EventType_Name(record.event_type), &event);
+      AppendIntAnnotation("input_ts", record.input_ts, &event);
+      break;
+    case TraceRecord::kSliceEnd:
+      AppendVarintField(kEventType, kSliceEnd, &event);
+      break;
+    case TraceRecord::kInputPacket:
+    case TraceRecord::kOutputPacket:
+      AppendVarintField(kEventType, kInstant, &event);
+      AppendBytesField(kEventName,
+                       record.stream_id ? absl::string_view(*record.stream_id)
+                                        : absl::string_view("packet"),
+                       &event);
+      AppendBytesField(
+          kEventCategories,
+          record.kind == TraceRecord::kInputPacket ? "input" : "output",
+          &event);
+      AppendFixed64Field(kEventFlowIds, PacketFlowId(record), &event);
+      AppendIntAnnotation("packet_ts", record.packet_ts, &event);
+      break;
+    case TraceRecord::kInstant:
+      AppendVarintField(kEventType, kInstant, &event);
+      AppendBytesField(kEventName,
+                       GraphTrace::EventType_Name(record.event_type), &event);
+      AppendStringAnnotation("node", NodeName(record.node_id), &event);
+      if (record.stream_id) {
+        AppendStringAnnotation("stream", *record.stream_id, &event);
+      }
+      AppendIntAnnotation("input_ts", record.input_ts, &event);
+      AppendIntAnnotation("packet_ts", record.packet_ts, &event);
+      AppendIntAnnotation("event_data", record.event_data, &event);
+      AppendIntAnnotation("is_finish", record.is_finish, &event);
+      break;
+  }
+  AddTrackEvent(time, event);
+}
+
+void PerfettoTraceWriter::AddTrackEvent(absl::Time time,
+                                        const std::string& track_event) {
+  std::string packet;
+  AppendVarintField(kPacketTimestamp, absl::ToUnixNanos(time), &packet);
+  AppendVarintField(kPacketSequenceId, kSequenceId, &packet);
+  if (is_first_packet_) {
+    AppendVarintField(kPacketSequenceFlags, kIncrementalStateCleared, &packet);
+    is_first_packet_ = false;
+  }
+  AppendBytesField(kPacketTrackEvent, track_event, &packet);
+  AppendBytesField(kTracePacket, packet, &data_);
+}
+
+const std::string& PerfettoTraceWriter::NodeName(int node_id) const {
+  static const std::string* const kGraphName = new std::string("graph");
+  if (node_id < 0 || node_id >= node_names_.size()) return *kGraphName;
+  return node_names_[node_id];
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,65 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_PERFETTO_TRACE_WRITER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_PERFETTO_TRACE_WRITER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/profiler/trace_ring.h"
+
+namespace mediapipe {
+
+// Encodes TraceRecords as packets of a Perfetto trace, in the protobuf wire
+// format of perfetto.protos.Trace. The encoded packets of successive writers
+// can be concatenated into one trace file, which can be opened with
+// ui.perfetto.dev.
+//
+// Each thread gets a track. Calculator invocations become slices on the track
+// of the thread that ran them, and their input and output packets become
+// instant events within the slices, connected from producer to consumers by
+// flow events. All other events become instant events.
+class PerfettoTraceWriter {
+ public:
+  // `node_names` provides the slice names for node ids.
+  explicit PerfettoTraceWriter(std::vector<std::string> node_names);
+
+  // Appends the descriptor of the track of the thread with `thread_index`.
+  // Records can only be added to described tracks.
+  void AddThreadTrack(int thread_index);
+
+  // Appends a record logged by the thread with `thread_index` at `time`.
+  void AddRecord(int thread_index, const TraceRecord& record, absl::Time time);
+
+  // Returns the encoded trace packets.
+  const std::string& data() const { return data_; }
+
+ private:
+  // Appends a TracePacket holding `track_event` at `time`.
+  void AddTrackEvent(absl::Time time, const std::string& track_event);
+
+  // Returns the name of a node, or "graph" if the node_id is not a node.
+  const std::string& NodeName(int node_id) const;
+
+  const std::vector<std::string> node_names_;
+  std::string data_;
+  bool is_first_packet_ = true;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_PERFETTO_TRACE_WRITER_H_
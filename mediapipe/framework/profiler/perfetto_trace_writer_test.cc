@@ -0,0 +1,181 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/perfetto_trace_writer.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/profiler/trace_ring.h"
+
+namespace mediapipe {
+namespace {
+
+// A decoded protobuf field.
+struct Field {
+  int number = 0;
+  uint64 value = 0;
+  std::string bytes;
+};
+
+uint64 ReadVarint(const std::string& data, size_t* pos) {
+  uint64 value = 0;
+  for (int shift = 0; *pos < data.size(); shift += 7) {
+    const uint8 byte = data[(*pos)++];
+    value |= static_cast<uint64>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) break;
+  }
+  return value;
+}
+
+// Decodes the fields of a protobuf message.
+std::vector<Field> ParseFields(const std::string& data) {
+  std::vector<Field> fields;
+  size_t pos = 0;
+  while (pos < data.size()) {
+    const uint64 tag = ReadVarint(data, &pos);
+    Field field;
+    field.number = tag >> 3;
+    switch (tag & 7) {
+      case 0:
+        field.value = ReadVarint(data, &pos);
+        break;
+      case 1:
+        for (int i = 0; i < 8; ++i) {
+          field.value |= static_cast<uint64>(static_cast<uint8>(data[pos++]))
+                         << (8 * i);
+        }
+        break;
+      case 2: {
+        const size_t size = ReadVarint(data, &pos);
+        field.bytes = data.substr(pos, size);
+        pos += size;
+        break;
+      }
+      default:
+        ADD_FAILURE() << "Unexpected wire type: " << (tag & 7);
+        return fields;
+    }
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+// Returns the first field with `number`, or an empty field.
+Field FindField(const std::vector<Field>& fields, int number) {
+  for (const Field& field : fields) {
+    if (field.number == number) return field;
+  }
+  return Field();
+}
+
+// Returns the fields of the TracePackets in `trace`.
+std::vector<std::vector<Field>> ParsePackets(const std::string& trace) {
+  std::vector<std::vector<Field>> packets;
+  for (const Field& field : ParseFields(trace)) {
+    EXPECT_EQ(field.number, 1);
+    packets.push_back(ParseFields(field.bytes));
+  }
+  return packets;
+}
+
+TEST(PerfettoTraceWriterTest, WritesThreadTracks) {
+  PerfettoTraceWriter writer({"node"});
+  writer.AddThreadTrack(2);
+  std::vector<std::vector<Field>> packets = ParsePackets(writer.data());
+  ASSERT_EQ(packets.size(), 1);
+  std::vector<Field> track = ParseFields(FindField(packets[0], 60).bytes);
+  EXPECT_EQ(FindField(track, 1).value, 3);
+  EXPECT_EQ(FindField(track, 2).bytes, "mediapipe thread 2");
+}
+
+TEST(PerfettoTraceWriterTest, WritesSlicesAndPacketFlows) {
+  const std::string stream = "stream";
+  const absl::Time time = absl::FromUnixNanos(1000);
+  PerfettoTraceWriter writer({"producer", "consumer"});
+
+  TraceRecord begin;
+  begin.kind = TraceRecord::kSliceBegin;
+  begin.event_type = GraphTrace::PROCESS;
+  begin.node_id = 0;
+  writer.AddRecord(0, begin, time);
+  TraceRecord output;
+  output.kind = TraceRecord::kOutputPacket;
+  output.stream_id = &stream;
+  output.packet_ts = 10;
+  output.event_data = 1234;
+  writer.AddRecord(0, output, time + absl::Nanoseconds(5));
+  TraceRecord end;
+  end.kind = TraceRecord::kSliceEnd;
+  writer.AddRecord(0, end, time + absl::Nanoseconds(6));
+  TraceRecord input = output;
+  input.kind = TraceRecord::kInputPacket;
+  input.node_id = 1;
+  writer.AddRecord(1, input, time + absl::Nanoseconds(8));
+
+  std::vector<std::vector<Field>> packets = ParsePackets(writer.data());
+  ASSERT_EQ(packets.size(), 4);
+  EXPECT_EQ(FindField(packets[0], 8).value, 1000);
+  // Only the first packet clears the incremental state.
+  EXPECT_EQ(FindField(packets[0], 13).value, 1);
+  EXPECT_EQ(FindField(packets[1], 13).number, 0);
+  for (const std::vector<Field>& packet : packets) {
+    EXPECT_EQ(FindField(packet, 10).value, 1);
+  }
+
+  std::vector<Field> begin_event = ParseFields(FindField(packets[0], 11).bytes);
+  EXPECT_EQ(FindField(begin_event, 9).value, 1);
+  EXPECT_EQ(FindField(begin_event, 11).value, 1);
+  EXPECT_EQ(FindField(begin_event, 23).bytes, "producer");
+  EXPECT_EQ(FindField(begin_event, 22).bytes, "PROCESS");
+
+  std::vector<Field> output_event =
+      ParseFields(FindField(packets[1], 11).bytes);
+  EXPECT_EQ(FindField(output_event, 9).value, 3);
+  EXPECT_EQ(FindField(output_event, 23).bytes, "stream");
+  EXPECT_EQ(FindField(output_event, 22).bytes, "output");
+
+  std::vector<Field> end_event = ParseFields(FindField(packets[2], 11).bytes);
+  EXPECT_EQ(FindField(end_event, 9).value, 2);
+
+  std::vector<Field> input_event = ParseFields(FindField(packets[3], 11).bytes);
+  EXPECT_EQ(FindField(input_event, 11).value, 2);
+  EXPECT_EQ(FindField(input_event, 22).bytes, "input");
+  // The producer and consumer events of a packet share a flow id.
+  EXPECT_NE(FindField(output_event, 47).number, 0);
+  EXPECT_EQ(FindField(input_event, 47).value,
+            FindField(output_event, 47).value);
+}
+
+TEST(PerfettoTraceWriterTest, WritesOtherEventsAsInstants) {
+  PerfettoTraceWriter writer({"node"});
+  TraceRecord record;
+  record.event_type = GraphTrace::READY_FOR_PROCESS;
+  record.node_id = 0;
+  writer.AddRecord(0, record, absl::FromUnixNanos(1));
+  std::vector<std::vector<Field>> packets = ParsePackets(writer.data());
+  ASSERT_EQ(packets.size(), 1);
+  std::vector<Field> event = ParseFields(FindField(packets[0], 11).bytes);
+  EXPECT_EQ(FindField(event, 9).value, 3);
+  EXPECT_EQ(FindField(event, 23).bytes, "READY_FOR_PROCESS");
+  std::vector<Field> annotation = ParseFields(FindField(event, 4).bytes);
+  EXPECT_EQ(FindField(annotation, 10).bytes, "node");
+  EXPECT_EQ(FindField(annotation, 6).bytes, "node");
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,265 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/prometheus_exporter.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/graph_metrics.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+namespace {
+
+using Labels = std::vector<std::pair<absl::string_view, std::string>>;
+
+constexpr char kPrometheusContentType[] =
+    "text/plain; version=0.0.4; charset=utf-8";
+constexpr char kOpenMetricsContentType[] =
+    "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+std::string FormatDouble(double value) {
+  return absl::StrFormat("%.9g", value);
+}
+
+std::string FormatSeconds(int64 usec) { return FormatDouble(usec * 1e-6); }
+
+// Escapes a label value or HELP text.
+std::string Escape(absl::string_view text) {
+  std::string result;
+  result.reserve(text.size());
+  for (char c : text) {
+    switch (c) {
+      case '\\':
+        result += "\\\\";
+        break;
+      case '"':
+        result += "\\\"";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      default:
+        result += c;
+    }
+  }
+  return result;
+}
+
+// Writes metric families one at a time, each with its samples.
+class TextWriter {
+ public:
+  explicit TextWriter(const PrometheusTextOptions& options)
+      : options_(options) {}
+
+  // Starts a family. Counter samples are named `name` + "_total". The
+  // Prometheus format names the family after its samples, OpenMetrics after
+  // the counter.
+  void StartFamily(absl::string_view name, absl::string_view type,
+                   absl::string_view help) {
+    const bool add_total = type == "counter" && !options_.open_metrics;
+    const std::string family_name =
+        add_total ? absl::StrCat(name, "_total") : std::string(name);
+    absl::StrAppend(&text_, "# HELP ", family_name, " ", Escape(help), "\n",
+                    "# TYPE ", family_name, " ", type, "\n");
+  }
+
+  void AddSample(absl::string_view name, const Labels& labels,
+                 absl::string_view value) {
+    absl::StrAppend(&text_, name);
+    bool first = true;
+    auto append_label = [&](absl::string_view key, absl::string_view value) {
+      absl::StrAppend(&text_, first ? "{" : ",", key, "=\"", Escape(value),
+                      "\"");
+      first = false;
+    };
+    if (!options_.graph_name.empty()) {
+      append_label("graph", options_.graph_name);
+    }
+    for (const auto& [key, value] : labels) {
+      append_label(key, value);
+    }
+    absl::StrAppend(&text_, first ? "" : "}", " ", value, "\n");
+  }
+
+  // Adds the samples of a histogram, in seconds. The last interval of a
+  // TimeHistogram extends to +inf.
+  void AddHistogram(absl::string_view name, Labels labels,
+                    const TimeHistogram& histogram) {
+    const std::string bucket_name = absl::StrCat(name, "_bucket");
+    int64 cumulative_count = 0;
+    labels.emplace_back("le", "");
+    for (int i = 0; i + 1 < histogram.count_size(); ++i) {
+      cumulative_count += histogram.count(i);
+      labels.back().second =
+          FormatSeconds((i + 1) * histogram.interval_size_usec());
+      AddSample(bucket_name, labels, absl::StrCat(cumulative_count));
+    }
+    cumulative_count += histogram.count(histogram.count_size() - 1);
+    labels.back().second = "+Inf";
+    AddSample(bucket_name, labels, absl::StrCat(cumulative_count));
+    labels.pop_back();
+    AddSample(absl::StrCat(name, "_sum"), labels,
+              FormatSeconds(histogram.total()));
+    AddSample(absl::StrCat(name, "_count"), labels,
+              absl::StrCat(cumulative_count));
+  }
+
+  std::string Finish() {
+    if (options_.open_metrics) {
+      absl::StrAppend(&text_, "# EOF\n");
+    }
+    return std::move(text_);
+  }
+
+ private:
+  const PrometheusTextOptions& options_;
+  std::string text_;
+};
+
+Labels NodeLabels(const GraphMetrics::Node& node) {
+  Labels labels = {{"node", node.name}};
+  if (node.is_graph_input_stream) {
+    labels.emplace_back("graph_input_stream", "true");
+  }
+  return labels;
+}
+
+Labels StreamLabels(const GraphMetrics::InputStream& stream) {
+  return {{"node", stream.node_name}, {"stream", stream.stream_name}};
+}
+
+}  // namespace
+
+std::string FormatPrometheusText(const GraphMetrics& metrics,
+                                 const PrometheusTextOptions& options) {
+  TextWriter writer(options);
+
+  writer.StartFamily("mediapipe_node_process_runtime_seconds", "histogram",
+                     "Runtime of Calculator::Process calls.");
+  for (const GraphMetrics::Node& node : metrics.nodes) {
+    if (node.process_runtime.count_size() == 0) continue;
+    writer.AddHistogram("mediapipe_node_process_runtime_seconds",
+                        NodeLabels(node), node.process_runtime);
+  }
+  writer.StartFamily("mediapipe_node_process_input_latency_seconds",
+                     "histogram",
+                     "Time from the creation of an input packet to its "
+                     "Calculator::Process call.");
+  for (const GraphMetrics::Node& node : metrics.nodes) {
+    if (node.process_input_latency.count_size() == 0) continue;
+    writer.AddHistogram("mediapipe_node_process_input_latency_seconds",
+                        NodeLabels(node), node.process_input_latency);
+  }
+  writer.StartFamily("mediapipe_node_throttled", "gauge",
+                     "Whether a full input stream throttles the node.");
+  for (const GraphMetrics::Node& node : metrics.nodes) {
+    writer.AddSample("mediapipe_node_throttled", NodeLabels(node),
+                     node.is_throttled ? "1" : "0");
+  }
+  writer.StartFamily("mediapipe_node_throttles", "counter",
+                     "Number of times the node became throttled.");
+  for (const GraphMetrics::Node& node : metrics.nodes) {
+    writer.AddSample("mediapipe_node_throttles_total", NodeLabels(node),
+                     absl::StrCat(node.throttle_count));
+  }
+  writer.StartFamily("mediapipe_node_throttled_seconds", "counter",
+                     "Time the node has been throttled.");
+  for (const GraphMetrics::Node& node : metrics.nodes) {
+    writer.AddSample("mediapipe_node_throttled_seconds_total",
+                     NodeLabels(node),
+                     FormatDouble(absl::ToDoubleSeconds(node.throttled_time)));
+  }
+
+  writer.StartFamily("mediapipe_input_stream_queue_size", "gauge",
+                     "Number of packets queued in the input stream.");
+  for (const GraphMetrics::InputStream& stream : metrics.input_streams) {
+    writer.AddSample("mediapipe_input_stream_queue_size",
+                     StreamLabels(stream), absl::StrCat(stream.queue_size));
+  }
+  writer.StartFamily("mediapipe_input_stream_max_queue_size", "gauge",
+                     "Queue size at which the input stream is full.");
+  for (const GraphMetrics::InputStream& stream : metrics.input_streams) {
+    if (stream.max_queue_size < 0) continue;
+    writer.AddSample("mediapipe_input_stream_max_queue_size",
+                     StreamLabels(stream),
+                     absl::StrCat(stream.max_queue_size));
+  }
+  writer.StartFamily("mediapipe_input_stream_packets", "counter",
+                     "Number of packets added to the input stream in the "
+                     "current run.");
+  for (const GraphMetrics::InputStream& stream : metrics.input_streams) {
+    writer.AddSample("mediapipe_input_stream_packets_total",
+                     StreamLabels(stream),
+                     absl::StrCat(stream.packets_added));
+  }
+  writer.StartFamily("mediapipe_input_stream_peak_queue_size", "gauge",
+                     "Largest number of packets queued in the input stream in "
+                     "the current run.");
+  for (const GraphMetrics::InputStream& stream : metrics.input_streams) {
+    if (!stream.has_memory_accounting) continue;
+    writer.AddSample("mediapipe_input_stream_peak_queue_size",
+                     StreamLabels(stream),
+                     absl::StrCat(stream.peak_queue_size));
+  }
+  writer.StartFamily("mediapipe_input_stream_queued_bytes", "gauge",
+                     "Estimated bytes held by the packets queued in the input "
+                     "stream.");
+  for (const GraphMetrics::InputStream& stream : metrics.input_streams) {
+    if (!stream.has_memory_accounting) continue;
+    writer.AddSample("mediapipe_input_stream_queued_bytes",
+                     StreamLabels(stream), absl::StrCat(stream.queued_bytes));
+  }
+  writer.StartFamily("mediapipe_input_stream_peak_queued_bytes", "gauge",
+                     "Largest estimated bytes held by the packets queued in "
+                     "the input stream in the current run.");
+  for (const GraphMetrics::InputStream& stream : metrics.input_streams) {
+    if (!stream.has_memory_accounting) continue;
+    writer.AddSample("mediapipe_input_stream_peak_queued_bytes",
+                     StreamLabels(stream),
+                     absl::StrCat(stream.peak_queued_bytes));
+  }
+  return writer.Finish();
+}
+
+PrometheusExporter::PrometheusExporter(PrometheusTextOptions options)
+    : options_(std::move(options)),
+      text_(FormatPrometheusText(GraphMetrics(), options_)) {}
+
+void PrometheusExporter::Export(const GraphMetrics& metrics) {
+  std::string text = FormatPrometheusText(metrics, options_);
+  absl::MutexLock lock(&mutex_);
+  text_ = std::move(text);
+}
+
+std::string PrometheusExporter::Scrape() const {
+  absl::MutexLock lock(&mutex_);
+  return text_;
+}
+
+absl::string_view PrometheusExporter::ContentType() const {
+  return options_.open_metrics ? kOpenMetricsContentType
+                               : kPrometheusContentType;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,75 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_PROMETHEUS_EXPORTER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_PROMETHEUS_EXPORTER_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/graph_metrics.h"
+
+namespace mediapipe {
+
+struct PrometheusTextOptions {
+  // Emits the OpenMetrics 1.0 text format instead of the Prometheus 0.0.4
+  // text format.
+  bool open_metrics = false;
+  // If not empty, every sample gets a graph="<graph_name>" label, to tell
+  // apart the graphs of a process.
+  std::string graph_name;
+};
+
+// Formats GraphMetrics in the Prometheus or OpenMetrics text exposition
+// format. The families are:
+//   mediapipe_node_process_runtime_seconds        histogram {node}
+//   mediapipe_node_process_input_latency_seconds  histogram {node}
+//   mediapipe_node_throttled                      gauge     {node}
+//   mediapipe_node_throttles                      counter   {node}
+//   mediapipe_node_throttled_seconds              counter   {node}
+//   mediapipe_input_stream_queue_size             gauge     {node, stream}
+//   mediapipe_input_stream_max_queue_size         gauge     {node, stream}
+//   mediapipe_input_stream_packets                counter   {node, stream}
+// Graph input streams are reported as nodes with a graph_input_stream="true"
+// label. The histograms are omitted for nodes that are not profiled, and the
+// max queue size for unbounded streams.
+std::string FormatPrometheusText(const GraphMetrics& metrics,
+                                 const PrometheusTextOptions& options = {});
+
+// Keeps the text of the latest GraphMetrics sample for a Prometheus scrape
+// endpoint. MediaPipe does not serve HTTP itself: the application's handler
+// responds with Scrape() and ContentType().
+class PrometheusExporter : public GraphMetricsExporter {
+ public:
+  explicit PrometheusExporter(PrometheusTextOptions options = {});
+
+  void Export(const GraphMetrics& metrics) override;
+
+  // Returns the text of the latest sample, or an empty exposition if nothing
+  // has been exported yet. May be called from any thread.
+  std::string Scrape() const;
+
+  // The HTTP Content-Type of the scraped text.
+  absl::string_view ContentType() const;
+
+ private:
+  const PrometheusTextOptions options_;
+  mutable absl::Mutex mutex_;
+  std::string text_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_PROMETHEUS_EXPORTER_H_
@@ -0,0 +1,140 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/prometheus_exporter.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/graph_metrics.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+GraphMetrics MakeMetrics() {
+  GraphMetrics metrics;
+  GraphMetrics::Node& node = metrics.nodes.emplace_back();
+  node.name = "Detector";
+  // 3 calls under 10ms, 1 under 20ms, 2 beyond.
+  node.process_runtime.set_total(95000);
+  node.process_runtime.set_interval_size_usec(10000);
+  node.process_runtime.set_num_intervals(3);
+  node.process_runtime.add_count(3);
+  node.process_runtime.add_count(1);
+  node.process_runtime.add_count(2);
+  GraphMetrics::Node& input = metrics.nodes.emplace_back();
+  input.name = "in\"put";
+  input.is_graph_input_stream = true;
+  input.is_throttled = true;
+  input.throttle_count = 4;
+  input.throttled_time = absl::Milliseconds(1500);
+  GraphMetrics::InputStream& stream = metrics.input_streams.emplace_back();
+  stream.node_name = "Detector";
+  stream.stream_name = "in\"put";
+  stream.queue_size = 2;
+  stream.max_queue_size = 5;
+  stream.packets_added = 17;
+  stream.has_memory_accounting = true;
+  stream.queued_bytes = 4096;
+  stream.peak_queue_size = 4;
+  stream.peak_queued_bytes = 8192;
+  GraphMetrics::InputStream& unbounded = metrics.input_streams.emplace_back();
+  unbounded.node_name = "Detector";
+  unbounded.stream_name = "side";
+  return metrics;
+}
+
+TEST(PrometheusExporterTest, FormatsHistograms) {
+  std::string text = FormatPrometheusText(MakeMetrics());
+  EXPECT_THAT(text, HasSubstr(
+                        "# TYPE mediapipe_node_process_runtime_seconds "
+                        "histogram\n"
+                        "mediapipe_node_process_runtime_seconds_bucket{"
+                        "node=\"Detector\",le=\"0.01\"} 3\n"
+                        "mediapipe_node_process_runtime_seconds_bucket{"
+                        "node=\"Detector\",le=\"0.02\"} 4\n"
+                        "mediapipe_node_process_runtime_seconds_bucket{"
+                        "node=\"Detector\",le=\"+Inf\"} 6\n"
+                        "mediapipe_node_process_runtime_seconds_sum{"
+                        "node=\"Detector\"} 0.095\n"
+                        "mediapipe_node_process_runtime_seconds_count{"
+                        "node=\"Detector\"} 6\n"));
+  // Unprofiled nodes have no histograms.
+  EXPECT_THAT(text, Not(HasSubstr("process_runtime_seconds_count{node=\"in")));
+  EXPECT_THAT(text, Not(HasSubstr("process_input_latency_seconds_count")));
+}
+
+TEST(PrometheusExporterTest, FormatsThrottlingAndQueues) {
+  std::string text = FormatPrometheusText(MakeMetrics());
+  const char kInputLabels[] =
+      "{node=\"in\\\"put\",graph_input_stream=\"true\"}";
+  EXPECT_THAT(text, HasSubstr(absl::StrCat("mediapipe_node_throttled",
+                                           kInputLabels, " 1\n")));
+  EXPECT_THAT(text, HasSubstr("# TYPE mediapipe_node_throttles_total counter\n"
+                              "mediapipe_node_throttles_total{"
+                              "node=\"Detector\"} 0\n"));
+  EXPECT_THAT(text, HasSubstr(absl::StrCat("mediapipe_node_throttles_total",
+                                           kInputLabels, " 4\n")));
+  EXPECT_THAT(text,
+              HasSubstr(absl::StrCat("mediapipe_node_throttled_seconds_total",
+                                     kInputLabels, " 1.5\n")));
+  EXPECT_THAT(text, HasSubstr("mediapipe_input_stream_queue_size{"
+                              "node=\"Detector\",stream=\"in\\\"put\"} 2\n"));
+  EXPECT_THAT(text, HasSubstr("mediapipe_input_stream_max_queue_size{"
+                              "node=\"Detector\",stream=\"in\\\"put\"} 5\n"));
+  EXPECT_THAT(text, Not(HasSubstr("mediapipe_input_stream_max_queue_size{"
+                                  "node=\"Detector\",stream=\"side\"}")));
+  EXPECT_THAT(text, HasSubstr("mediapipe_input_stream_packets_total{"
+                              "node=\"Detector\",stream=\"in\\\"put\"} 17\n"));
+  EXPECT_THAT(text, HasSubstr("mediapipe_input_stream_peak_queue_size{"
+                              "node=\"Detector\",stream=\"in\\\"put\"} 4\n"));
+  EXPECT_THAT(text,
+              HasSubstr("mediapipe_input_stream_queued_bytes{"
+                        "node=\"Detector\",stream=\"in\\\"put\"} 4096\n"));
+  EXPECT_THAT(text,
+              HasSubstr("mediapipe_input_stream_peak_queued_bytes{"
+                        "node=\"Detector\",stream=\"in\\\"put\"} 8192\n"));
+  EXPECT_THAT(text, Not(HasSubstr("mediapipe_input_stream_queued_bytes{"
+                                  "node=\"Detector\",stream=\"side\"}")));
+  EXPECT_THAT(text, Not(HasSubstr("# EOF")));
+}
+
+TEST(PrometheusExporterTest, FormatsOpenMetrics) {
+  std::string text = FormatPrometheusText(
+      MakeMetrics(), {.open_metrics = true, .graph_name = "face"});
+  EXPECT_THAT(text, HasSubstr("# TYPE mediapipe_node_throttles counter\n"
+                              "mediapipe_node_throttles_total{graph=\"face\","
+                              "node=\"Detector\"} 0\n"));
+  EXPECT_THAT(text, EndsWith("# EOF\n"));
+}
+
+TEST(PrometheusExporterTest, ScrapesLatestSample) {
+  PrometheusExporter exporter;
+  EXPECT_THAT(exporter.Scrape(),
+              HasSubstr("# TYPE mediapipe_node_throttled gauge\n"));
+  EXPECT_THAT(exporter.Scrape(), Not(HasSubstr("Detector")));
+  exporter.Export(MakeMetrics());
+  EXPECT_THAT(exporter.Scrape(), HasSubstr("node=\"Detector\""));
+  EXPECT_THAT(exporter.ContentType(), HasSubstr("version=0.0.4"));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,269 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/reporter/latency_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace mediapipe {
+namespace reporter {
+namespace {
+
+// Returns the nearest-rank percentile of sorted values.
+int64_t PercentileOf(const std::vector<int64_t>& sorted_values,
+                     double percentile) {
+  const int size = sorted_values.size();
+  int index = std::ceil(percentile / 100 * size) - 1;
+  index = std::max(0, std::min(size - 1, index));
+  return sorted_values[index];
+}
+
+// Prints rows of cells, padding every column but the last to its widest
+// cell.
+void PrintColumns(const std::vector<std::vector<std::string>>& rows,
+                  std::ostream& output) {
+  std::vector<size_t> widths;
+  for (const auto& row : rows) {
+    widths.resize(std::max(widths.size(), row.size()));
+    for (int i = 0; i < row.size(); ++i) {
+      widths[i] = std::max(widths[i], row[i].size());
+    }
+  }
+  for (const auto& row : rows) {
+    for (int i = 0; i < row.size(); ++i) {
+      std::string cell = row[i];
+      if (i + 1 < row.size()) cell.append(widths[i] + 1 - cell.size(), ' ');
+      output << cell;
+    }
+    output << std::endl;
+  }
+}
+
+}  // namespace
+
+void LatencyAnalyzer::Accumulate(const GraphProfile& profile) {
+  for (const auto& graph_trace : profile.graph_trace()) {
+    const int64_t base_time = graph_trace.base_time();
+    const int64_t base_timestamp = graph_trace.base_timestamp();
+    for (int i = 0; i < graph_trace.calculator_name_size(); ++i) {
+      node_names_[i] = graph_trace.calculator_name(i);
+    }
+    // Streams are identified by name, since ids are local to a GraphTrace.
+    auto stream_name = [&graph_trace](int32_t stream_id) {
+      return stream_id >= 0 && stream_id < graph_trace.stream_name_size()
+                 ? graph_trace.stream_name(stream_id)
+                 : absl::StrCat(stream_id);
+    };
+
+    for (const auto& trace : graph_trace.calculator_trace()) {
+      const int64_t input_timestamp = trace.input_timestamp() + base_timestamp;
+      switch (trace.event_type()) {
+        case GraphTrace::PROCESS: {
+          // The start and finish of a call can be in separate traces.
+          const SpanKey key(trace.node_id(), input_timestamp,
+                            trace.thread_id());
+          ProcessSpan& span = spans_[key];
+          span.node_id = trace.node_id();
+          span.input_timestamp = input_timestamp;
+          if (trace.has_start_time()) {
+            span.start_time = trace.start_time() + base_time;
+          }
+          if (trace.has_finish_time()) {
+            span.finish_time = trace.finish_time() + base_time;
+          }
+          for (const auto& stream_trace : trace.input_trace()) {
+            span.inputs.emplace_back(
+                stream_trace.packet_timestamp() + base_timestamp,
+                stream_name(stream_trace.stream_id()));
+          }
+          for (const auto& stream_trace : trace.output_trace()) {
+            producers_[{stream_trace.packet_timestamp() + base_timestamp,
+                        stream_name(stream_trace.stream_id())}] = key;
+          }
+          break;
+        }
+        case GraphTrace::READY_FOR_PROCESS:
+          ready_times_[trace.node_id()].insert(
+              (trace.has_start_time() ? trace.start_time()
+                                      : trace.finish_time()) +
+              base_time);
+          break;
+        case GraphTrace::GPU_TASK:
+          if (trace.has_start_time() && trace.has_finish_time()) {
+            gpu_times_[{trace.node_id(), input_timestamp}] +=
+                trace.finish_time() - trace.start_time();
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+FrameLatency LatencyAnalyzer::CriticalPath(const ProcessSpan& last) const {
+  FrameLatency frame;
+  frame.input_timestamp = last.input_timestamp;
+  int64_t frame_start = *last.start_time;
+  std::set<const ProcessSpan*> visited;
+  for (const ProcessSpan* span = &last; span != nullptr;) {
+    visited.insert(span);
+    const int64_t start = *span->start_time;
+    const int64_t finish = *span->finish_time;
+
+    // The input that arrived last held back the call.
+    const ProcessSpan* producer = nullptr;
+    for (const auto& input : span->inputs) {
+      const auto it = producers_.find(input);
+      if (it == producers_.end()) continue;
+      const ProcessSpan& candidate = spans_.at(it->second);
+      if (!candidate.finish_time || *candidate.finish_time > start) continue;
+      if (!producer || *candidate.finish_time > *producer->finish_time) {
+        producer = &candidate;
+      }
+    }
+    const int64_t arrival = producer ? *producer->finish_time : start;
+
+    // A node that became ready after the arrival waited for its other
+    // inputs or for its queues until then, and for a thread afterwards.
+    // Without such an event, the node is assumed to have started as soon as
+    // it was ready.
+    int64_t ready = start;
+    const auto ready_it = ready_times_.find(span->node_id);
+    if (ready_it != ready_times_.end()) {
+      const auto it = ready_it->second.upper_bound(start);
+      if (it != ready_it->second.begin() && *std::prev(it) >= arrival) {
+        ready = *std::prev(it);
+      }
+    }
+
+    CriticalPathStep step;
+    const auto name_it = node_names_.find(span->node_id);
+    step.name = name_it != node_names_.end()
+                    ? name_it->second
+                    : absl::StrCat("node_", span->node_id);
+    const auto gpu_it = gpu_times_.find({span->node_id, span->input_timestamp});
+    const int64_t gpu_time =
+        gpu_it != gpu_times_.end() ? gpu_it->second : int64_t{0};
+    step.gpu_time = std::min(finish - start, gpu_time);
+    step.compute_time = finish - start - step.gpu_time;
+    step.queue_time = ready - arrival;
+    step.executor_time = start - ready;
+    frame.critical_path.push_back(step);
+    frame_start = arrival;
+
+    // The path ends at a graph input stream, at a source calculator, or at a
+    // call that started before the trace.
+    if (!producer || producer->node_id < 0 || !producer->start_time ||
+        visited.count(producer)) {
+      break;
+    }
+    span = producer;
+  }
+  frame.latency = *last.finish_time - frame_start;
+  return frame;
+}
+
+std::vector<FrameLatency> LatencyAnalyzer::Frames() const {
+  // The call to Process() that finished last for each input timestamp.
+  std::map<int64_t, const ProcessSpan*> last_spans;
+  for (const auto& entry : spans_) {
+    const ProcessSpan& span = entry.second;
+    if (span.node_id < 0 || !span.start_time || !span.finish_time) continue;
+    const ProcessSpan*& last = last_spans[span.input_timestamp];
+    if (!last || *span.finish_time > *last->finish_time) {
+      last = &span;
+    }
+  }
+  std::vector<FrameLatency> frames;
+  for (const auto& entry : last_spans) {
+    frames.push_back(CriticalPath(*entry.second));
+  }
+  return frames;
+}
+
+LatencyReport LatencyAnalyzer::Report(double percentile,
+                                      int max_contributors) const {
+  LatencyReport report;
+  report.percentile = percentile;
+  const std::vector<FrameLatency> frames = Frames();
+  report.num_frames = frames.size();
+  if (frames.empty()) {
+    return report;
+  }
+  std::vector<int64_t> latencies;
+  for (const auto& frame : frames) {
+    latencies.push_back(frame.latency);
+  }
+  std::sort(latencies.begin(), latencies.end());
+  report.median_latency = PercentileOf(latencies, 50);
+  report.percentile_latency = PercentileOf(latencies, percentile);
+
+  // Maps the calculator name and cause to the time of the slow frames.
+  std::map<std::pair<std::string, std::string>, int64_t> times;
+  int64_t total_latency = 0;
+  for (const auto& frame : frames) {
+    if (frame.latency < report.percentile_latency) continue;
+    ++report.num_slow_frames;
+    total_latency += frame.latency;
+    for (const auto& step : frame.critical_path) {
+      times[{step.name, "compute"}] += step.compute_time;
+      times[{step.name, "gpu"}] += step.gpu_time;
+      times[{step.name, "queue"}] += step.queue_time;
+      times[{step.name, "executor"}] += step.executor_time;
+    }
+  }
+  for (const auto& entry : times) {
+    if (entry.second == 0) continue;
+    LatencyContributor contributor;
+    contributor.name = entry.first.first;
+    contributor.cause = entry.first.second;
+    contributor.mean_time =
+        static_cast<double>(entry.second) / report.num_slow_frames;
+    contributor.percent =
+        total_latency == 0 ? 0 : 100.0 * entry.second / total_latency;
+    report.contributors.push_back(contributor);
+  }
+  std::stable_sort(
+      report.contributors.begin(), report.contributors.end(),
+      [](const LatencyContributor& a, const LatencyContributor& b) {
+        return a.mean_time > b.mean_time;
+      });
+  if (report.contributors.size() > max_contributors) {
+    report.contributors.resize(max_contributors);
+  }
+  return report;
+}
+
+void LatencyReport::Print(std::ostream& output) const {
+  output << "frames: " << num_frames << ", median latency: " << median_latency
+         << " us, p" << percentile << " latency: " << percentile_latency
+         << " us, slow frames: " << num_slow_frames << std::endl;
+  std::vector<std::vector<std::string>> rows = {
+      {"calculator", "cause", "time_mean", "time_percent"}};
+  for (const auto& contributor : contributors) {
+    rows.push_back({contributor.name, contributor.cause,
+                    absl::StrFormat("%1.2f", contributor.mean_time),
+                    absl::StrFormat("%1.2f", contributor.percent)});
+  }
+  PrintColumns(rows, output);
+}
+
+}  // namespace reporter
+}  // namespace mediapipe
@@ -0,0 +1,150 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_REPORTER_LATENCY_ANALYZER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_REPORTER_LATENCY_ANALYZER_H_
+
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+
+namespace mediapipe {
+namespace reporter {
+
+// The time a frame spent at one calculator on its critical path, in
+// microseconds, from the arrival of the input that arrived last to the end
+// of Process().
+struct CriticalPathStep {
+  // Name of the calculator.
+  std::string name;
+
+  // The time spent in Process(), other than waiting for GPU tasks.
+  int64_t compute_time = 0;
+
+  // The time spent in GPU tasks of Process().
+  int64_t gpu_time = 0;
+
+  // The time from the arrival of the input to the calculator being ready,
+  // waiting for other inputs, for queued packets or for throttling.
+  int64_t queue_time = 0;
+
+  // The time from the calculator being ready to Process() starting, waiting
+  // for an executor thread.
+  int64_t executor_time = 0;
+};
+
+// The critical path of one frame: the chain of Process() calls leading to
+// the last output for an input timestamp, each one entered through the
+// input that arrived last.
+struct FrameLatency {
+  // The input timestamp of the frame.
+  int64_t input_timestamp = 0;
+
+  // The time from the frame entering the graph, through a graph input stream
+  // or a source calculator, to the end of its last Process() call.
+  int64_t latency = 0;
+
+  // The steps of the critical path, starting from the last one. Their times
+  // add up to the latency.
+  std::vector<CriticalPathStep> critical_path;
+};
+
+// The time that a calculator contributed to slow frames, for one cause.
+struct LatencyContributor {
+  std::string name;
+
+  // One of "compute", "gpu", "queue" or "executor".
+  std::string cause;
+
+  // The mean time per slow frame, in microseconds.
+  double mean_time = 0;
+
+  // The percentage of the latency of slow frames.
+  double percent = 0;
+};
+
+// Summarizes the critical paths of the frames at or above a latency
+// percentile.
+struct LatencyReport {
+  int num_frames = 0;
+  int num_slow_frames = 0;
+  int64_t median_latency = 0;
+  int64_t percentile_latency = 0;
+  double percentile = 0;
+
+  // The largest contributors, in decreasing order of time.
+  std::vector<LatencyContributor> contributors;
+
+  // Prints the report to a given stream (e.g., std::cout).
+  void Print(std::ostream& output) const;
+};
+
+// Reconstructs the critical path of each frame from the PROCESS events of
+// one or more GraphProfile protobufs, and attributes the latency of the
+// slowest frames to computing, GPU tasks, queueing and waiting for the
+// executor. This tells whether more threads, smaller queues or faster
+// calculators would help.
+class LatencyAnalyzer {
+ public:
+  // Adds the contents of a given profile.
+  void Accumulate(const GraphProfile& profile);
+
+  // Returns the critical path of each input timestamp, in timestamp order.
+  std::vector<FrameLatency> Frames() const;
+
+  // Summarizes the frames with a latency at or above `percentile`, listing
+  // up to `max_contributors` of their largest contributors.
+  LatencyReport Report(double percentile, int max_contributors) const;
+
+ private:
+  // A call to Process(), with absolute times and timestamps.
+  struct ProcessSpan {
+    int32_t node_id = 0;
+    int64_t input_timestamp = 0;
+    // Unset for calls that started before the trace or ended after it.
+    absl::optional<int64_t> start_time;
+    absl::optional<int64_t> finish_time;
+    // The packet timestamp and stream name of each input packet.
+    std::vector<std::pair<int64_t, std::string>> inputs;
+  };
+  // Node id, input timestamp and thread id.
+  using SpanKey = std::tuple<int32_t, int64_t, int32_t>;
+  // Node id and input timestamp.
+  using TaskKey = std::pair<int32_t, int64_t>;
+
+  FrameLatency CriticalPath(const ProcessSpan& last) const;
+
+  std::map<SpanKey, ProcessSpan> spans_;
+  // The span that output each packet, by packet timestamp and stream name.
+  std::map<std::pair<int64_t, std::string>, SpanKey> producers_;
+  // The times at which each node became ready for Process(). These events
+  // don't carry input timestamps, so a call to Process() is matched with the
+  // last one before it.
+  std::map<int32_t, std::set<int64_t>> ready_times_;
+  // The total duration of the GPU tasks of each task.
+  std::map<TaskKey, int64_t> gpu_times_;
+  std::map<int32_t, std::string> node_names_;
+};
+
+}  // namespace reporter
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_REPORTER_LATENCY_ANALYZER_H_
@@ -18,6 +18,8 @@
 
 #include <algorithm>
 #include <fstream>
+#include <string>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/flags/flag.h"
@@ -26,16 +28,25 @@
 #include "mediapipe/framework/port/advanced_proto_inc.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/profiler/compact_trace.h"
+#include "mediapipe/framework/profiler/reporter/latency_analyzer.h"
 #include "mediapipe/framework/profiler/reporter/reporter.h"
 
 ABSL_FLAG(std::vector<std::string>, logfiles, {},
-          "comma-separated list of .binarypb files to process.");
+          "comma-separated list of .binarypb or .mptrace files to process.");
 ABSL_FLAG(std::vector<std::string>, cols, {"*"},
           "comma-separated list of columns to show. Suffix wildcards, '*', '?' "
           "allowed.");
 ABSL_FLAG(bool, compact, false,
           "if true, then don't print unnecessary whitespace.");
+ABSL_FLAG(double, latency_percentile, 0,
+          "if set, print which calculators and causes make up the critical "
+          "path of the frames at or above this latency percentile, instead of "
+          "calculator statistics.");
+ABSL_FLAG(int, latency_contributors, 10,
+          "the number of largest latency contributors to print.");
 
+using mediapipe::reporter::LatencyAnalyzer;
 using mediapipe::reporter::Reporter;
 
 // The command line utility to mine trace files of useful statistics to
@@ -45,6 +56,7 @@ int main(int argc, char** argv) {
   absl::ParseCommandLine(argc, argv);
 
   Reporter reporter;
+  LatencyAnalyzer latency_analyzer;
   reporter.set_compact(absl::GetFlag(FLAGS_compact));
   const auto result = reporter.set_columns(absl::GetFlag(FLAGS_cols));
   if (result.message().length()) {
@@ -53,6 +65,21 @@ int main(int argc, char** argv) {
 
   const auto& flags_logfiles = absl::GetFlag(FLAGS_logfiles);
   for (const auto& file_name : flags_logfiles) {
+    std::string contents;
+    if (mediapipe::file::GetContents(file_name, &contents).ok() &&
+        mediapipe::IsCompactTrace(contents)) {
+      std::vector<mediapipe::GraphProfile> profiles;
+      const absl::Status status =
+          mediapipe::DecodeCompactTrace(contents, &profiles);
+      if (!status.ok()) {
+        std::cerr << "Failed to decode compact trace: " << status << "\n";
+      }
+      for (const auto& profile : profiles) {
+        reporter.Accumulate(profile);
+        latency_analyzer.Accumulate(profile);
+      }
+      continue;
+    }
     std::ifstream ifs(file_name.c_str(), std::ifstream::in);
     mediapipe::proto_ns::io::IstreamInputStream isis(&ifs);
     mediapipe::proto_ns::io::CodedInputStream coded_input_stream(&isis);
@@ -61,8 +88,16 @@ int main(int argc, char** argv) {
       std::cerr << "Failed to parse proto.\n";
     } else {
       reporter.Accumulate(proto);
+      latency_analyzer.Accumulate(proto);
     }
   }
+  const double latency_percentile = absl::GetFlag(FLAGS_latency_percentile);
+  if (latency_percentile > 0) {
+    latency_analyzer
+        .Report(latency_percentile, absl::GetFlag(FLAGS_latency_contributors))
+        .Print(std::cout);
+    return 1;
+  }
   reporter.Report()->Print(std::cout);
   return 1;
 }
@@ -28,13 +28,16 @@
 #include "mediapipe/framework/port/advanced_proto_inc.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/proto_ns.h"
 #include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/profiler/reporter/latency_analyzer.h"
 #include "mediapipe/framework/profiler/reporter/statistic.h"
 #include "mediapipe/framework/tool/test_util.h"
 
 namespace mediapipe {
 
+using mediapipe::reporter::LatencyAnalyzer;
 using mediapipe::reporter::Reporter;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
@@ -228,4 +231,158 @@ TEST(Reporter, LatencyCalculatedCorrectly) {
       testing::DoubleEq(1500));
 }
 
+// Frame 0 enters at 1000 and reaches CCalculator through ACalculator and the
+// slower BCalculator, which waits on the GPU. Frame 1 takes 150.
+GraphProfile CriticalPathProfile() {
+  return ParseTextProtoOrDie<GraphProfile>(R"pb(
+    graph_trace {
+      calculator_name: [ "ACalculator", "BCalculator", "CCalculator" ]
+      stream_name: [ "", "input", "a_c", "b_c" ]
+      calculator_trace {
+        node_id: -1
+        input_timestamp: 0
+        event_type: PROCESS
+        finish_time: 1000
+        output_trace { packet_timestamp: 0 stream_id: 1 }
+      }
+      calculator_trace {
+        node_id: 0
+        input_timestamp: 0
+        event_type: PROCESS
+        start_time: 1100
+        finish_time: 1300
+        input_trace { packet_timestamp: 0 stream_id: 1 }
+        output_trace { packet_timestamp: 0 stream_id: 2 }
+      }
+      calculator_trace {
+        node_id: 1
+        input_timestamp: 0
+        event_type: PROCESS
+        start_time: 1050
+        finish_time: 1800
+        input_trace { packet_timestamp: 0 stream_id: 1 }
+        output_trace { packet_timestamp: 0 stream_id: 3 }
+      }
+      calculator_trace {
+        node_id: 1
+        input_timestamp: 0
+        event_type: GPU_TASK
+        start_time: 1200
+        finish_time: 1600
+      }
+      calculator_trace {
+        node_id: 2
+        event_type: READY_FOR_PROCESS
+        start_time: 1850
+      }
+      calculator_trace {
+        node_id: 2
+        input_timestamp: 0
+        event_type: PROCESS
+        start_time: 1900
+        finish_time: 2000
+        input_trace { packet_timestamp: 0 stream_id: 2 }
+        input_trace { packet_timestamp: 0 stream_id: 3 }
+      }
+      calculator_trace {
+        node_id: -1
+        input_timestamp: 1
+        event_type: PROCESS
+        finish_time: 3000
+        output_trace { packet_timestamp: 1 stream_id: 1 }
+      }
+      calculator_trace {
+        node_id: 0
+        input_timestamp: 1
+        event_type: PROCESS
+        start_time: 3000
+        finish_time: 3100
+        input_trace { packet_timestamp: 1 stream_id: 1 }
+        output_trace { packet_timestamp: 1 stream_id: 2 }
+      }
+      calculator_trace {
+        node_id: 1
+        input_timestamp: 1
+        event_type: PROCESS
+        start_time: 3000
+        finish_time: 3050
+        input_trace { packet_timestamp: 1 stream_id: 1 }
+        output_trace { packet_timestamp: 1 stream_id: 3 }
+      }
+      calculator_trace {
+        node_id: 2
+        input_timestamp: 1
+        event_type: PROCESS
+        start_time: 3100
+        input_trace { packet_timestamp: 1 stream_id: 2 }
+        input_trace { packet_timestamp: 1 stream_id: 3 }
+      }
+    }
+    graph_trace {
+      base_time: 3000
+      calculator_name: [ "ACalculator", "BCalculator", "CCalculator" ]
+      stream_name: [ "", "input", "a_c", "b_c" ]
+      calculator_trace {
+        node_id: 2
+        input_timestamp: 1
+        event_type: PROCESS
+        finish_time: 150
+      }
+    }
+  )pb");
+}
+
+TEST(LatencyAnalyzer, FollowsLastArrivingInputs) {
+  LatencyAnalyzer analyzer;
+  analyzer.Accumulate(CriticalPathProfile());
+  const auto frames = analyzer.Frames();
+  ASSERT_EQ(frames.size(), 2);
+
+  EXPECT_EQ(frames[0].input_timestamp, 0);
+  EXPECT_EQ(frames[0].latency, 1000);
+  ASSERT_EQ(frames[0].critical_path.size(), 2);
+  const auto& c_step = frames[0].critical_path[0];
+  EXPECT_EQ(c_step.name, "CCalculator");
+  EXPECT_EQ(c_step.compute_time, 100);
+  EXPECT_EQ(c_step.gpu_time, 0);
+  EXPECT_EQ(c_step.queue_time, 50);
+  EXPECT_EQ(c_step.executor_time, 50);
+  const auto& b_step = frames[0].critical_path[1];
+  EXPECT_EQ(b_step.name, "BCalculator");
+  EXPECT_EQ(b_step.compute_time, 350);
+  EXPECT_EQ(b_step.gpu_time, 400);
+  EXPECT_EQ(b_step.queue_time, 50);
+  EXPECT_EQ(b_step.executor_time, 0);
+
+  // The start and finish of the last call are in separate traces.
+  EXPECT_EQ(frames[1].input_timestamp, 1);
+  EXPECT_EQ(frames[1].latency, 150);
+  ASSERT_EQ(frames[1].critical_path.size(), 2);
+  EXPECT_EQ(frames[1].critical_path[1].name, "ACalculator");
+}
+
+TEST(LatencyAnalyzer, ReportsContributorsOfSlowFrames) {
+  LatencyAnalyzer analyzer;
+  analyzer.Accumulate(CriticalPathProfile());
+  const auto report = analyzer.Report(99, 3);
+  EXPECT_EQ(report.num_frames, 2);
+  EXPECT_EQ(report.num_slow_frames, 1);
+  EXPECT_EQ(report.median_latency, 150);
+  EXPECT_EQ(report.percentile_latency, 1000);
+  ASSERT_EQ(report.contributors.size(), 3);
+  EXPECT_EQ(report.contributors[0].name, "BCalculator");
+  EXPECT_EQ(report.contributors[0].cause, "gpu");
+  EXPECT_THAT(report.contributors[0].mean_time, testing::DoubleEq(400));
+  EXPECT_THAT(report.contributors[0].percent, testing::DoubleEq(40));
+  EXPECT_EQ(report.contributors[1].name, "BCalculator");
+  EXPECT_EQ(report.contributors[1].cause, "compute");
+  EXPECT_EQ(report.contributors[2].name, "CCalculator");
+  EXPECT_EQ(report.contributors[2].cause, "compute");
+
+  std::stringstream output;
+  report.Print(output);
+  EXPECT_THAT(output.str(), HasSubstr("p99 latency: 1000 us"));
+  EXPECT_THAT(output.str(), HasSubstr("BCalculator gpu     400.00"));
+}
+
 }  // namespace mediapipe
@@ -24,13 +24,13 @@
 namespace mediapipe {
 
 namespace packet_internal {
-// Returns a hash of the packet data address from a packet data holder.
+// Returns an id of the packet data from a packet data holder, which is the
+// same for all copies of the packet.
 inline const int64 GetPacketDataId(const HolderBase* holder) {
   if (holder == nullptr) {
     return 0;
   }
-  const void* address = &(static_cast<const Holder<int>*>(holder)->data());
-  return reinterpret_cast<int64>(address);
+  return holder->DataId();
 }
 }  // namespace packet_internal
 
@@ -0,0 +1,106 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/trace_log_writer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+namespace mediapipe {
+
+TraceLogWriter::TraceLogWriter(std::string path_prefix, std::string extension,
+                               int file_count, int64 max_file_size,
+                               std::string file_header)
+    : path_prefix_(std::move(path_prefix)),
+      extension_(std::move(extension)),
+      file_count_(std::max(file_count, 1)),
+      max_file_size_(max_file_size),
+      file_header_(std::move(file_header)),
+      thread_("mediapipe_trace_log", 1) {
+  thread_.StartWorkers();
+}
+
+TraceLogWriter::~TraceLogWriter() { Flush().IgnoreError(); }
+
+std::string TraceLogWriter::FilePath(int index) const {
+  return absl::StrCat(path_prefix_, index, extension_);
+}
+
+void TraceLogWriter::Append(std::string data, bool new_file) {
+  absl::MutexLock lock(&mutex_);
+  queued_.push_back({std::move(data), new_file});
+  if (!is_writing_) {
+    is_writing_ = true;
+    thread_.Schedule([this] { WriteQueued(); });
+  }
+}
+
+absl::Status TraceLogWriter::Flush() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(
+      +[](bool* is_writing) { return !*is_writing; }, &is_writing_));
+  absl::Status status = std::move(status_);
+  status_ = absl::OkStatus();
+  return status;
+}
+
+void TraceLogWriter::WriteQueued() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      writing_.clear();
+      if (queued_.empty()) {
+        is_writing_ = false;
+        return;
+      }
+      // Swap the buffers, so that new data is queued while writing.
+      std::swap(queued_, writing_);
+    }
+    absl::Status status;
+    for (const Chunk& chunk : writing_) {
+      status.Update(Write(chunk));
+    }
+    if (file_.is_open()) file_.flush();
+    if (!status.ok()) {
+      absl::MutexLock lock(&mutex_);
+      status_.Update(status);
+    }
+  }
+}
+
+absl::Status TraceLogWriter::Write(const Chunk& chunk) {
+  const bool is_full =
+      max_file_size_ > 0 && file_size_ > 0 &&
+      file_size_ + static_cast<int64>(chunk.data.size()) > max_file_size_;
+  if (file_index_ < 0 || chunk.new_file || is_full) {
+    file_.close();
+    file_index_ = (file_index_ + 1) % file_count_;
+    file_.open(FilePath(file_index_), std::ofstream::out |
+                                          std::ofstream::binary |
+                                          std::ofstream::trunc);
+    file_ << file_header_;
+    file_size_ = file_header_.size();
+  }
+  file_ << chunk.data;
+  file_size_ += chunk.data.size();
+  if (!file_.good()) {
+    return absl::UnavailableError(
+        absl::StrCat("Could not write trace log to: ", FilePath(file_index_)));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,93 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_LOG_WRITER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_LOG_WRITER_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// Writes trace log files on a background thread, so that the thread logging
+// the traces doesn't wait for file I/O. Append() only queues the data; the
+// writer thread takes all the queued data at once while new data is queued in
+// a second buffer.
+//
+// The files are StrCat(path_prefix, index, extension) for index 0 through
+// file_count - 1, reused in turn. Each file starts with `file_header`.
+class TraceLogWriter {
+ public:
+  // A file is full when it holds max_file_size bytes, or never if 0.
+  TraceLogWriter(std::string path_prefix, std::string extension,
+                 int file_count, int64 max_file_size, std::string file_header);
+
+  // Writes the queued data.
+  ~TraceLogWriter();
+
+  // Queues `data` to be written to the current file, or to the start of the
+  // next file if `new_file` is true or the current file would be full.
+  void Append(std::string data, bool new_file = false);
+
+  // Waits until the queued data is written, and returns the first error since
+  // the previous call.
+  absl::Status Flush();
+
+  // Returns the path of the file with `index`.
+  std::string FilePath(int index) const;
+
+ private:
+  struct Chunk {
+    std::string data;
+    bool new_file;
+  };
+
+  // Writes queued chunks until the queue is empty. Runs on thread_.
+  void WriteQueued();
+
+  // Writes a chunk to the file. Runs on thread_.
+  absl::Status Write(const Chunk& chunk);
+
+  const std::string path_prefix_;
+  const std::string extension_;
+  const int file_count_;
+  const int64 max_file_size_;
+  const std::string file_header_;
+
+  absl::Mutex mutex_;
+  std::vector<Chunk> queued_ ABSL_GUARDED_BY(mutex_);
+  // True while WriteQueued() is scheduled or running.
+  bool is_writing_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+
+  // Only used by WriteQueued().
+  std::vector<Chunk> writing_;
+  std::ofstream file_;
+  int file_index_ = -1;
+  int64 file_size_ = 0;
+
+  // Declared last, so that the thread stops before the members it uses are
+  // destroyed.
+  ThreadPool thread_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_LOG_WRITER_H_
@@ -0,0 +1,73 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/trace_log_writer.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::string contents;
+  MP_EXPECT_OK(file::GetContents(path, &contents));
+  return contents;
+}
+
+TEST(TraceLogWriterTest, StartsNewFilesOnRequest) {
+  TraceLogWriter writer(absl::StrCat(getenv("TEST_TMPDIR"), "/requested_"),
+                        ".log", /*file_count=*/2, /*max_file_size=*/0, "H");
+  writer.Append("a");
+  writer.Append("b");
+  writer.Append("c", /*new_file=*/true);
+  MP_ASSERT_OK(writer.Flush());
+  EXPECT_EQ(ReadFile(writer.FilePath(0)), "Hab");
+  EXPECT_EQ(ReadFile(writer.FilePath(1)), "Hc");
+
+  // The files are reused in turn.
+  writer.Append("d", /*new_file=*/true);
+  MP_ASSERT_OK(writer.Flush());
+  EXPECT_EQ(ReadFile(writer.FilePath(0)), "Hd");
+}
+
+TEST(TraceLogWriterTest, StartsNewFilesBySize) {
+  TraceLogWriter writer(absl::StrCat(getenv("TEST_TMPDIR"), "/sized_"), ".log",
+                        /*file_count=*/4, /*max_file_size=*/6, "H");
+  for (const char* data : {"aa", "bb", "cc", "dddddddd", "e"}) {
+    writer.Append(data);
+  }
+  MP_ASSERT_OK(writer.Flush());
+  EXPECT_EQ(ReadFile(writer.FilePath(0)), "Haabb");
+  EXPECT_EQ(ReadFile(writer.FilePath(1)), "Hcc");
+  // Data larger than a file still gets written.
+  EXPECT_EQ(ReadFile(writer.FilePath(2)), "Hdddddddd");
+  EXPECT_EQ(ReadFile(writer.FilePath(3)), "He");
+}
+
+TEST(TraceLogWriterTest, ReportsWriteErrors) {
+  TraceLogWriter writer("/nonexistent/dir/trace_", ".log", 1, 0, "");
+  writer.Append("a");
+  EXPECT_FALSE(writer.Flush().ok());
+  // The error is reported once.
+  MP_EXPECT_OK(writer.Flush());
+}
+
+}  // namespace
+}  // namespace mediapipe
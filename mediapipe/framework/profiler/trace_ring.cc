@@ -0,0 +1,79 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/trace_ring.h"
+
+namespace mediapipe {
+namespace {
+
+// Returns the smallest power of two that is at least `n`.
+uint64 RoundUpToPowerOfTwo(uint64 n) {
+  uint64 result = 1;
+  while (result < n) result <<= 1;
+  return result;
+}
+
+std::atomic<uint64> next_ring_set_id{1};
+
+}  // namespace
+
+TraceRing::TraceRing(int thread_index, size_t capacity)
+    : thread_index_(thread_index),
+      mask_(RoundUpToPowerOfTwo(capacity) - 1),
+      buffer_(mask_ + 1) {}
+
+void TraceRing::Read(std::vector<TraceRecord>* records) {
+  const uint64 tail = tail_.load(std::memory_order_relaxed);
+  const uint64 head = head_.load(std::memory_order_acquire);
+  for (uint64 i = tail; i < head; ++i) {
+    records->push_back(buffer_[i & mask_]);
+  }
+  tail_.store(head, std::memory_order_release);
+}
+
+TraceRingSet::TraceRingSet(size_t capacity)
+    : id_(next_ring_set_id.fetch_add(1, std::memory_order_relaxed)),
+      capacity_(capacity) {}
+
+TraceRingSet::ThreadCache& TraceRingSet::thread_cache() {
+  static thread_local ThreadCache cache;
+  return cache;
+}
+
+TraceRing* TraceRingSet::GetThreadRingSlow() {
+  absl::MutexLock lock(&mutex_);
+  TraceRing*& ring = thread_rings_[std::this_thread::get_id()];
+  if (ring == nullptr) {
+    rings_.push_back(std::make_unique<TraceRing>(rings_.size(), capacity_));
+    ring = rings_.back().get();
+  }
+  thread_cache() = {id_, ring};
+  return ring;
+}
+
+std::vector<TraceRing*> TraceRingSet::GetRings() {
+  absl::MutexLock lock(&mutex_);
+  std::vector<TraceRing*> result;
+  result.reserve(rings_.size());
+  for (const auto& ring : rings_) result.push_back(ring.get());
+  return result;
+}
+
+int64 TraceRingSet::dropped_count() {
+  int64 result = 0;
+  for (TraceRing* ring : GetRings()) result += ring->dropped_count();
+  return result;
+}
+
+}  // namespace mediapipe
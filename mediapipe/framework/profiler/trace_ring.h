@@ -0,0 +1,151 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_RING_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// A compact trace event. Unlike TraceEvent, it holds raw timestamp values and
+// the time in CycleClockNow() ticks, so that it can be recorded cheaply.
+struct TraceRecord {
+  enum Kind : uint8 {
+    // An event logged by GraphTracer::LogEvent.
+    kInstant = 0,
+    // The start of a calculator method invocation.
+    kSliceBegin = 1,
+    // The end of a calculator method invocation.
+    kSliceEnd = 2,
+    // A packet consumed by the invocation in progress.
+    kInputPacket = 3,
+    // A packet produced by the invocation in progress.
+    kOutputPacket = 4,
+  };
+
+  // CycleClockNow() ticks if time_is_ticks, otherwise Unix nanoseconds.
+  uint64 time = 0;
+  int64 input_ts = 0;
+  int64 packet_ts = 0;
+  int64 event_data = 0;
+  const std::string* stream_id = nullptr;
+  int32 node_id = -1;
+  GraphTrace::EventType event_type = GraphTrace::UNKNOWN;
+  Kind kind = kInstant;
+  bool is_finish = false;
+  bool time_is_ticks = true;
+};
+
+// A fixed-size ring of TraceRecords with one writer thread and one reader
+// thread. Writing is wait-free and does not allocate. Records written while
+// the ring is full are dropped and counted.
+class TraceRing {
+ public:
+  // Creates a ring holding at least `capacity` records for the thread with
+  // index `thread_index`.
+  TraceRing(int thread_index, size_t capacity);
+
+  // Appends a record. Returns false if the ring is full.
+  inline bool Write(const TraceRecord& record) {
+    const uint64 head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ > mask_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ > mask_) {
+        dropped_count_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    buffer_[head & mask_] = record;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Appends the records written since the previous call to `records`.
+  void Read(std::vector<TraceRecord>* records);
+
+  // Returns the number of records dropped because the ring was full.
+  int64 dropped_count() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the index of the writer thread within its TraceRingSet.
+  int thread_index() const { return thread_index_; }
+
+ private:
+  const int thread_index_;
+  const uint64 mask_;
+  std::vector<TraceRecord> buffer_;
+  // The next index to write, advanced by the writer.
+  alignas(64) std::atomic<uint64> head_{0};
+  // The latest value of tail_ seen by the writer.
+  uint64 cached_tail_ = 0;
+  std::atomic<int64> dropped_count_{0};
+  // The next index to read, advanced by the reader.
+  alignas(64) std::atomic<uint64> tail_{0};
+};
+
+// The TraceRings of the threads logging events to one GraphTracer. Each
+// thread writes to its own ring, so writers never contend.
+class TraceRingSet {
+ public:
+  // Creates rings holding at least `capacity` records each.
+  explicit TraceRingSet(size_t capacity);
+
+  // Returns the ring of the calling thread, creating it on first use.
+  inline TraceRing* GetThreadRing() {
+    ThreadCache& cache = thread_cache();
+    if (cache.set_id == id_) return cache.ring;
+    return GetThreadRingSlow();
+  }
+
+  // Returns all rings created so far.
+  std::vector<TraceRing*> GetRings() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of records dropped by all rings.
+  int64 dropped_count() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  // The ring most recently used by a thread, and the id of its TraceRingSet.
+  struct ThreadCache {
+    uint64 set_id = 0;
+    TraceRing* ring = nullptr;
+  };
+  static ThreadCache& thread_cache();
+
+  TraceRing* GetThreadRingSlow() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Identifies this set in thread caches, unlike its address, which may be
+  // reused.
+  const uint64 id_;
+  const size_t capacity_;
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<TraceRing>> rings_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::thread::id, TraceRing*> thread_rings_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_TRACE_RING_H_
@@ -0,0 +1,107 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/trace_ring.h"
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+TraceRecord MakeRecord(int node_id, int64 event_data) {
+  TraceRecord record;
+  record.node_id = node_id;
+  record.event_data = event_data;
+  return record;
+}
+
+TEST(TraceRingTest, ReadsRecordsInWriteOrder) {
+  TraceRing ring(/*thread_index=*/0, /*capacity=*/8);
+  std::vector<TraceRecord> records;
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_TRUE(ring.Write(MakeRecord(0, i)));
+    if (i % 3 == 2) ring.Read(&records);
+  }
+  ring.Read(&records);
+  ASSERT_EQ(records.size(), 20);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(records[i].event_data, i);
+  }
+  EXPECT_EQ(ring.dropped_count(), 0);
+}
+
+TEST(TraceRingTest, DropsRecordsWhenFull) {
+  TraceRing ring(/*thread_index=*/0, /*capacity=*/3);
+  // The capacity is rounded up to 4.
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(ring.Write(MakeRecord(0, i)), i < 4);
+  }
+  EXPECT_EQ(ring.dropped_count(), 2);
+  std::vector<TraceRecord> records;
+  ring.Read(&records);
+  ASSERT_EQ(records.size(), 4);
+  EXPECT_EQ(records[3].event_data, 3);
+  EXPECT_TRUE(ring.Write(MakeRecord(0, 6)));
+  records.clear();
+  ring.Read(&records);
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0].event_data, 6);
+}
+
+TEST(TraceRingSetTest, ReadsWhileThreadsWrite) {
+  constexpr int kNumWriters = 4;
+  constexpr int kNumRecords = 10000;
+  TraceRingSet rings(/*capacity=*/kNumWriters * kNumRecords);
+  std::vector<TraceRecord> records;
+  {
+    ThreadPool pool(kNumWriters);
+    pool.StartWorkers();
+    for (int w = 0; w < kNumWriters; ++w) {
+      pool.Schedule([&rings, w] {
+        for (int i = 0; i < kNumRecords; ++i) {
+          rings.GetThreadRing()->Write(MakeRecord(w, i));
+        }
+      });
+    }
+    for (int i = 0; i < 100; ++i) {
+      for (TraceRing* ring : rings.GetRings()) ring->Read(&records);
+    }
+  }
+  for (TraceRing* ring : rings.GetRings()) ring->Read(&records);
+  EXPECT_EQ(rings.dropped_count(), 0);
+  ASSERT_EQ(records.size(), kNumWriters * kNumRecords);
+  // The records of each writer are read in order.
+  absl::flat_hash_map<int, int64> next_event_data;
+  for (const TraceRecord& record : records) {
+    EXPECT_EQ(record.event_data, next_event_data[record.node_id]++);
+  }
+}
+
+TEST(TraceRingSetTest, SeparatesSetsOnTheSameThread) {
+  TraceRingSet rings_1(/*capacity=*/4);
+  TraceRingSet rings_2(/*capacity=*/4);
+  TraceRing* ring_1 = rings_1.GetThreadRing();
+  TraceRing* ring_2 = rings_2.GetThreadRing();
+  EXPECT_NE(ring_1, ring_2);
+  EXPECT_EQ(rings_1.GetThreadRing(), ring_1);
+  EXPECT_EQ(rings_2.GetThreadRing(), ring_2);
+  EXPECT_EQ(rings_1.GetRings().size(), 1);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,89 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/proto_arena_pool.h"
+
+#include <algorithm>
+
+namespace mediapipe {
+
+namespace {
+
+// The entries of destroyed arenas are pruned whenever the map grows to this
+// many times its size after the last pruning, so that pruning takes amortized
+// constant time.
+constexpr size_t kPruneGrowthFactor = 2;
+constexpr size_t kMinPruneSize = 16;
+
+}  // namespace
+
+thread_local ProtoArenaPool::ScopedActivation* ProtoArenaPool::current_ =
+    nullptr;
+
+std::shared_ptr<proto_ns::Arena> ProtoArenaPool::GetArena(
+    Timestamp timestamp) {
+  absl::MutexLock lock(&mutex_);
+  std::weak_ptr<proto_ns::Arena>& entry = arenas_[timestamp];
+  std::shared_ptr<proto_ns::Arena> arena = entry.lock();
+  if (!arena) {
+    arena = std::make_shared<proto_ns::Arena>();
+    entry = arena;
+  }
+  if (arenas_.size() >=
+      kPruneGrowthFactor * std::max(pruned_size_, kMinPruneSize)) {
+    PruneLocked();
+  }
+  return arena;
+}
+
+int ProtoArenaPool::NumLiveArenas() {
+  absl::MutexLock lock(&mutex_);
+  PruneLocked();
+  return arenas_.size();
+}
+
+void ProtoArenaPool::PruneLocked() {
+  for (auto it = arenas_.begin(); it != arenas_.end();) {
+    if (it->second.expired()) {
+      it = arenas_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  pruned_size_ = arenas_.size();
+}
+
+proto_ns::Arena* ProtoArenaPool::CurrentArena() {
+  ScopedActivation* activation = current_;
+  if (!activation || !activation->pool_ ||
+      !activation->timestamp_.IsRangeValue()) {
+    return nullptr;
+  }
+  if (!activation->arena_) {
+    activation->arena_ = activation->pool_->GetArena(activation->timestamp_);
+  }
+  return activation->arena_.get();
+}
+
+const std::shared_ptr<proto_ns::Arena>* ProtoArenaPool::FindCurrentArena(
+    const proto_ns::Arena* arena) {
+  ScopedActivation* activation = current_;
+  if (!activation || !activation->arena_ ||
+      activation->arena_.get() != arena) {
+    return nullptr;
+  }
+  return &activation->arena_;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,129 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROTO_ARENA_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_PROTO_ARENA_POOL_H_
+
+#include <stddef.h>
+
+#include <map>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "google/protobuf/arena.h"
+#include "mediapipe/framework/port/proto_ns.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+
+// Hands out one protobuf arena per timestamp, so that the protos output by
+// the calculators processing a timestamp, such as detections, landmarks and
+// RenderData, are allocated together and freed at once instead of field by
+// field.
+//
+// The pool only refers weakly to its arenas. An arena is owned by the packets
+// of the messages allocated on it, and is destroyed with the last of them;
+// a later request for the same timestamp gets a new arena. Note that a packet
+// kept for long, e.g. by a PacketClonerCalculator, keeps all the messages of
+// its timestamp alive.
+//
+// A CalculatorGraph creates a pool when
+// CalculatorGraphConfig.enable_proto_arena is set, and activates it on the
+// threads running its calculators, for the input timestamp of each Process()
+// call. Calculators get the arena from
+// CalculatorContext::ProtoArena(), and MakePacket() wraps the messages created
+// on it, e.g. with MakeArenaMessage() below, without copying them.
+class ProtoArenaPool {
+ public:
+  ProtoArenaPool() = default;
+  ProtoArenaPool(const ProtoArenaPool&) = delete;
+  ProtoArenaPool& operator=(const ProtoArenaPool&) = delete;
+
+  // Returns the arena for "timestamp", creating it if there is none alive.
+  std::shared_ptr<proto_ns::Arena> GetArena(Timestamp timestamp)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of arenas still alive.
+  int NumLiveArenas() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the arena for the timestamp active on the current thread, creating
+  // it on first use, or nullptr if no pool is active. Only timestamps that are
+  // range values get an arena: sources, and Open() and Close() calls, would
+  // otherwise keep one arena alive for the whole run.
+  static proto_ns::Arena* CurrentArena();
+
+  // Returns the arena obtained by CurrentArena() if it is "arena", so that a
+  // packet can share its ownership, and nullptr otherwise.
+  static const std::shared_ptr<proto_ns::Arena>* FindCurrentArena(
+      const proto_ns::Arena* arena);
+
+  // Makes the arena of "pool" for "timestamp" current on this thread for the
+  // lifetime of this object. The arena is only requested from the pool on
+  // first use. "pool" may be null, which deactivates any enclosing pool.
+  class ScopedActivation {
+   public:
+    ScopedActivation(ProtoArenaPool* pool, Timestamp timestamp)
+        : pool_(pool), timestamp_(timestamp), previous_(current_) {
+      current_ = this;
+    }
+    ~ScopedActivation() { current_ = previous_; }
+    ScopedActivation(const ScopedActivation&) = delete;
+    ScopedActivation& operator=(const ScopedActivation&) = delete;
+
+   private:
+    friend class ProtoArenaPool;
+
+    ProtoArenaPool* const pool_;
+    const Timestamp timestamp_;
+    std::shared_ptr<proto_ns::Arena> arena_;
+    ScopedActivation* const previous_;
+  };
+
+ private:
+  // Removes the entries of the arenas that were destroyed.
+  void PruneLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  absl::Mutex mutex_;
+  std::map<Timestamp, std::weak_ptr<proto_ns::Arena>> arenas_
+      ABSL_GUARDED_BY(mutex_);
+  // Number of entries left by the last pruning.
+  size_t pruned_size_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  static thread_local ScopedActivation* current_;  // NOLINT
+};
+
+// Deletes a message unless an arena owns it.
+struct ArenaMessageDeleter {
+  void operator()(proto_ns::MessageLite* message) const {
+    if (message->GetArena() == nullptr) delete message;
+  }
+};
+
+template <typename T>
+using ArenaMessagePtr = std::unique_ptr<T, ArenaMessageDeleter>;
+
+// Returns a new T on "arena", or on the heap if "arena" is null, so that
+// calculators need not care whether CalculatorContext::ProtoArena() is set:
+//   auto detection = MakeArenaMessage<Detection>(cc->ProtoArena());
+//   ...
+//   kOut(cc).Send(std::move(*detection));
+template <typename T>
+ArenaMessagePtr<T> MakeArenaMessage(proto_ns::Arena* arena) {
+  return ArenaMessagePtr<T>(proto_ns::Arena::CreateMessage<T>(arena));
+}
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROTO_ARENA_POOL_H_
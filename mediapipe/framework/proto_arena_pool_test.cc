@@ -0,0 +1,229 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/proto_arena_pool.h"
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(ProtoArenaPoolTest, SharesArenaPerTimestamp) {
+  ProtoArenaPool pool;
+  std::shared_ptr<proto_ns::Arena> arena = pool.GetArena(Timestamp(1));
+  EXPECT_EQ(pool.GetArena(Timestamp(1)), arena);
+  EXPECT_NE(pool.GetArena(Timestamp(2)), arena);
+  EXPECT_EQ(pool.NumLiveArenas(), 1);
+
+  arena.reset();
+  EXPECT_EQ(pool.NumLiveArenas(), 0);
+  EXPECT_NE(pool.GetArena(Timestamp(1)), nullptr);
+}
+
+TEST(ProtoArenaPoolTest, CurrentArenaOnlyForRangeTimestamps) {
+  ProtoArenaPool pool;
+  EXPECT_EQ(ProtoArenaPool::CurrentArena(), nullptr);
+  {
+    ProtoArenaPool::ScopedActivation activation(&pool, Timestamp::Unset());
+    EXPECT_EQ(ProtoArenaPool::CurrentArena(), nullptr);
+  }
+  {
+    ProtoArenaPool::ScopedActivation activation(&pool, Timestamp(5));
+    proto_ns::Arena* arena = ProtoArenaPool::CurrentArena();
+    ASSERT_NE(arena, nullptr);
+    EXPECT_EQ(ProtoArenaPool::CurrentArena(), arena);
+    {
+      ProtoArenaPool::ScopedActivation deactivation(nullptr, Timestamp(5));
+      EXPECT_EQ(ProtoArenaPool::CurrentArena(), nullptr);
+    }
+    EXPECT_EQ(ProtoArenaPool::CurrentArena(), arena);
+  }
+  // The arena died with the activation, since no packet refers to it.
+  EXPECT_EQ(pool.NumLiveArenas(), 0);
+}
+
+TEST(ProtoArenaPoolTest, MakePacketKeepsArenaMessages) {
+  ProtoArenaPool pool;
+  Packet packet;
+  {
+    ProtoArenaPool::ScopedActivation activation(&pool, Timestamp(5));
+    proto_ns::Arena* arena = ProtoArenaPool::CurrentArena();
+    Detection* detection = proto_ns::Arena::CreateMessage<Detection>(arena);
+    detection->add_label("face");
+    packet = MakePacket<Detection>(std::move(*detection)).At(Timestamp(5));
+    EXPECT_EQ(packet.Get<Detection>().GetArena(), arena);
+  }
+  // The packet keeps the arena alive.
+  EXPECT_EQ(pool.NumLiveArenas(), 1);
+  EXPECT_EQ(packet.Get<Detection>().label(0), "face");
+  packet = Packet();
+  EXPECT_EQ(pool.NumLiveArenas(), 0);
+}
+
+TEST(ProtoArenaPoolTest, MakePacketIgnoresOtherMessages) {
+  ProtoArenaPool pool;
+  ProtoArenaPool::ScopedActivation activation(&pool, Timestamp(5));
+  Detection heap_detection;
+  heap_detection.add_label("face");
+  Packet packet = MakePacket<Detection>(std::move(heap_detection));
+  EXPECT_EQ(packet.Get<Detection>().GetArena(), nullptr);
+
+  proto_ns::Arena other_arena;
+  Detection* other_detection =
+      proto_ns::Arena::CreateMessage<Detection>(&other_arena);
+  packet = MakePacket<Detection>(*other_detection);
+  EXPECT_EQ(packet.Get<Detection>().GetArena(), nullptr);
+  EXPECT_EQ(pool.NumLiveArenas(), 0);
+}
+
+TEST(ProtoArenaPoolTest, MakeArenaMessageFallsBackToHeap) {
+  ArenaMessagePtr<Detection> heap_detection =
+      MakeArenaMessage<Detection>(nullptr);
+  EXPECT_EQ(heap_detection->GetArena(), nullptr);
+
+  proto_ns::Arena arena;
+  ArenaMessagePtr<Detection> arena_detection =
+      MakeArenaMessage<Detection>(&arena);
+  EXPECT_EQ(arena_detection->GetArena(), &arena);
+}
+
+TEST(ProtoArenaPoolTest, Api2MakePacketKeepsArenaMessages) {
+  ProtoArenaPool pool;
+  ProtoArenaPool::ScopedActivation activation(&pool, Timestamp(5));
+  proto_ns::Arena* arena = ProtoArenaPool::CurrentArena();
+  Detection* detection = proto_ns::Arena::CreateMessage<Detection>(arena);
+  api2::Packet<Detection> packet =
+      api2::MakePacket<Detection>(std::move(*detection));
+  EXPECT_EQ(packet.Get().GetArena(), arena);
+}
+
+TEST(ProtoArenaPoolTest, ConsumeMovesMessageToHeap) {
+  ProtoArenaPool pool;
+  Packet packet;
+  {
+    ProtoArenaPool::ScopedActivation activation(&pool, Timestamp(5));
+    Detection* detection = proto_ns::Arena::CreateMessage<Detection>(
+        ProtoArenaPool::CurrentArena());
+    detection->add_label("face");
+    packet = MakePacket<Detection>(std::move(*detection));
+  }
+  auto result = packet.Consume<Detection>();
+  MP_ASSERT_OK(result);
+  EXPECT_EQ(result.value()->GetArena(), nullptr);
+  EXPECT_EQ(result.value()->label(0), "face");
+  EXPECT_EQ(pool.NumLiveArenas(), 0);
+}
+
+// Outputs a Detection created on the arena of the input timestamp.
+class ArenaDetectionCalculator : public api2::Node {
+ public:
+  static constexpr api2::Input<int> kIn{"IN"};
+  static constexpr api2::Output<Detection> kOut{"OUT"};
+  MEDIAPIPE_NODE_CONTRACT(kIn, kOut);
+
+  absl::Status Process(CalculatorContext* cc) override {
+    auto detection = MakeArenaMessage<Detection>(cc->ProtoArena());
+    detection->add_score(*kIn(cc));
+    kOut(cc).Send(std::move(*detection));
+    return absl::OkStatus();
+  }
+};
+MEDIAPIPE_REGISTER_NODE(ArenaDetectionCalculator);
+
+TEST(ProtoArenaPoolTest, GraphSharesArenaPerTimestamp) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    enable_proto_arena: true
+    input_stream: "in"
+    node {
+      calculator: "ArenaDetectionCalculator"
+      input_stream: "IN:in"
+      output_stream: "OUT:a"
+    }
+    node {
+      calculator: "ArenaDetectionCalculator"
+      input_stream: "IN:in"
+      output_stream: "OUT:b"
+    }
+  )pb");
+  std::vector<Packet> a_packets;
+  std::vector<Packet> b_packets;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.ObserveOutputStream("a", [&](const Packet& packet) {
+    a_packets.push_back(packet);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.ObserveOutputStream("b", [&](const Packet& packet) {
+    b_packets.push_back(packet);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 2; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(a_packets.size(), 2);
+  ASSERT_EQ(b_packets.size(), 2);
+  for (int i = 0; i < 2; ++i) {
+    const Detection& a = a_packets[i].Get<Detection>();
+    const Detection& b = b_packets[i].Get<Detection>();
+    EXPECT_EQ(a.score(0), i);
+    EXPECT_NE(a.GetArena(), nullptr);
+    EXPECT_EQ(a.GetArena(), b.GetArena());
+  }
+  EXPECT_NE(a_packets[0].Get<Detection>().GetArena(),
+            a_packets[1].Get<Detection>().GetArena());
+}
+
+TEST(ProtoArenaPoolTest, NoArenaByDefault) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    node {
+      calculator: "ArenaDetectionCalculator"
+      input_stream: "IN:in"
+      output_stream: "OUT:a"
+    }
+  )pb");
+  std::vector<Packet> packets;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.ObserveOutputStream("a", [&](const Packet& packet) {
+    packets.push_back(packet);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("in", MakePacket<int>(1).At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(packets.size(), 1);
+  EXPECT_EQ(packets[0].Get<Detection>().GetArena(), nullptr);
+}
+
+}  // namespace
+}  // namespace mediapipe
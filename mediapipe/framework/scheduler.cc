@@ -23,6 +23,7 @@
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_graph.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/platform_specific_tracepoints.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
@@ -82,6 +83,27 @@ void Scheduler::SetExecutor(Executor* executor) {
   default_queue_.SetExecutor(executor);
 }
 
+void Scheduler::SetPacketArena(std::shared_ptr<PacketArena> packet_arena) {
+  CHECK_EQ(state_, STATE_NOT_STARTED)
+      << "SetPacketArena must not be called after the scheduler has started";
+  shared_.packet_arena = std::move(packet_arena);
+}
+
+void Scheduler::SetProtoArenaPool(
+    std::shared_ptr<ProtoArenaPool> proto_arena_pool) {
+  CHECK_EQ(state_, STATE_NOT_STARTED)
+      << "SetProtoArenaPool must not be called after the scheduler has "
+         "started";
+  shared_.proto_arena_pool = std::move(proto_arena_pool);
+}
+
+void Scheduler::EnableCriticalPathScheduling() {
+  CHECK_EQ(state_, STATE_NOT_STARTED)
+      << "EnableCriticalPathScheduling must not be called after the scheduler "
+         "has started";
+  shared_.critical_path_scheduling = true;
+}
+
 // TODO: Consider renaming this method CreateNonDefaultQueue.
 absl::Status Scheduler::SetNonDefaultExecutor(const std::string& name,
                                               Executor* executor) {
@@ -212,13 +234,16 @@ void Scheduler::AddApplicationThreadTask(std::function<void()> task) {
 }
 
 void Scheduler::ThrottledGraphInputStream() {
-  absl::MutexLock lock(&state_mutex_);
-  ++throttled_graph_input_stream_count_;
+  // No need to lock: nobody waits for this, and HandleIdle reads the count.
+  const int count = ++throttled_graph_input_stream_count_;
+  MEDIAPIPE_TRACEPOINT(graph_input_throttled, "graph_input_streams", 0, count);
 }
 
 void Scheduler::UnthrottledGraphInputStream() {
   absl::MutexLock lock(&state_mutex_);
-  --throttled_graph_input_stream_count_;
+  const int count = --throttled_graph_input_stream_count_;
+  MEDIAPIPE_TRACEPOINT(graph_input_unthrottled, "graph_input_streams", 0,
+                       count);
   ++unthrottle_seq_num_;
   state_cond_var_.SignalAll();
 }
@@ -245,9 +270,12 @@ void Scheduler::WaitUntilGraphInputStreamUnthrottled(
 }
 
 void Scheduler::EmittedObservedOutput() {
-  absl::MutexLock lock(&state_mutex_);
   observed_output_signal_ = true;
+  // Only lock to wake up a waiting application thread. Since the signal is set
+  // before checking for a waiter, a waiter that is not seen here will see the
+  // signal in WaitForObservedOutput.
   if (waiting_for_observed_output_) {
+    absl::MutexLock lock(&state_mutex_);
     state_cond_var_.SignalAll();
   }
 }
@@ -256,11 +284,15 @@ absl::Status Scheduler::WaitForObservedOutput() {
   bool observed = false;
   ApplicationThreadAwait(
       [this, &observed]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(state_mutex_) {
-        observed = observed_output_signal_;
-        observed_output_signal_ = false;
-        waiting_for_observed_output_ = !observed && state_ != STATE_TERMINATED;
-        // Wait until the member waiting_for_observed_output_ becomes false.
-        return !waiting_for_observed_output_;
+        // Announce the wait before checking the signal. See
+        // EmittedObservedOutput.
+        waiting_for_observed_output_ = true;
+        observed = observed_output_signal_.exchange(false);
+        if (observed || state_ == STATE_TERMINATED) {
+          waiting_for_observed_output_ = false;
+          return true;
+        }
+        return false;
       });
   return observed ? absl::OkStatus() : absl::OutOfRangeError("Graph is done.");
 }
@@ -308,6 +340,11 @@ void Scheduler::AddedPacketToGraphInputStream() {
   if (state_ == STATE_TERMINATED) {
     return;
   }
+  // While some queue is busy, the queue that makes the scheduler idle will
+  // call HandleIdle, and see this packet then.
+  if (!IsIdle()) {
+    return;
+  }
   absl::MutexLock lock(&state_mutex_);
   // It seems that the only thing it really needs to do is to check if more
   // unthrottling needs to be done.
@@ -332,6 +369,11 @@ void Scheduler::ScheduleNodeIfNotThrottled(
   DCHECK(calculator_context);
   if (!graph_->IsNodeThrottled(node->Id())) {
     node->GetSchedulerQueue()->AddNode(node, calculator_context);
+  } else {
+    MEDIAPIPE_TRACEPOINT(node_throttled,
+                         node->GetCalculatorState().NodeName().c_str(),
+                         node->Id(),
+                         calculator_context->InputTimestamp().Value());
   }
 }
 
@@ -348,6 +390,9 @@ void Scheduler::ScheduleUnthrottledReadyNodes(
     // can't be executed in parallel.
     CHECK(node->IsSource());
     CalculatorContext* default_context = node->GetDefaultCalculatorContext();
+    MEDIAPIPE_TRACEPOINT(node_unthrottled,
+                         node->GetCalculatorState().NodeName().c_str(),
+                         node->Id(), default_context->InputTimestamp().Value());
     node->GetSchedulerQueue()->AddNode(node, default_context);
   }
 }
@@ -449,10 +494,25 @@ void Scheduler::AssignNodeToSchedulerQueue(CalculatorNode* node) {
 }
 
 void Scheduler::QueueIdleStateChanged(bool idle) {
+  if (!idle) {
+    // A queue becoming busy cannot make the scheduler idle.
+    const int count = non_idle_queue_count_.fetch_add(1) + 1;
+    VLOG(2) << "active queues: " << count;
+    return;
+  }
+  // While other queues remain busy, this queue becoming idle cannot make the
+  // scheduler idle either, and one of them will call HandleIdle later.
+  int count = non_idle_queue_count_.load();
+  while (count > 1) {
+    if (non_idle_queue_count_.compare_exchange_weak(count, count - 1)) {
+      VLOG(2) << "active queues: " << count - 1;
+      return;
+    }
+  }
   absl::MutexLock lock(&state_mutex_);
-  non_idle_queue_count_ += (idle ? -1 : 1);
-  VLOG(2) << "active queues: " << non_idle_queue_count_;
-  if (non_idle_queue_count_ == 0) {
+  count = non_idle_queue_count_.fetch_sub(1) - 1;
+  VLOG(2) << "active queues: " << count;
+  if (count == 0) {
     state_cond_var_.SignalAll();
     // Here we need to check if we should activate sources, unthrottle, or
     // quit.
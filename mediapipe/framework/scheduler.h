@@ -59,6 +59,18 @@ class Scheduler {
   absl::Status SetNonDefaultExecutor(const std::string& name,
                                      Executor* executor);
 
+  // Sets the arena in which packets created by the nodes are allocated. Must
+  // be called before the scheduler is started.
+  void SetPacketArena(std::shared_ptr<PacketArena> packet_arena);
+
+  // Sets the pool of the protobuf arenas made available to the nodes for their
+  // input timestamps. Must be called before the scheduler is started.
+  void SetProtoArenaPool(std::shared_ptr<ProtoArenaPool> proto_arena_pool);
+
+  // Enables CalculatorGraphConfig::CRITICAL_PATH scheduling. Must be called
+  // before the scheduler is started.
+  void EnableCriticalPathScheduling();
+
   // Resets the data members at the beginning of each graph run.
   void Reset();
 
@@ -214,7 +226,9 @@ class Scheduler {
 
   // Returns true if nothing can be scheduled and no tasks are running or
   // scheduled to run on the Executor.
-  bool IsIdle() ABSL_EXCLUSIVE_LOCKS_REQUIRED(state_mutex_);
+  // Does not need state_mutex_, but the answer is only stable under it when it
+  // is true: a queue can become busy at any time.
+  bool IsIdle();
 
   // Clean up active_sources_ by removing closed sources. If all the active
   // sources are closed, this will leave active_sources_ empty. If not, some
@@ -291,7 +305,10 @@ class Scheduler {
   // This is ok, because it happens within a single critical section, which is
   // guarded by state_mutex_. If we wanted to split this critical section, we
   // would have to separate a and b into two variables.
-  int non_idle_queue_count_ ABSL_GUARDED_BY(state_mutex_) = 0;
+  // Only the transition to zero needs that critical section. The count is
+  // atomic so that queues can become busy, or idle while other queues remain
+  // busy, without contending on state_mutex_.
+  std::atomic<int> non_idle_queue_count_ = ATOMIC_VAR_INIT(0);
 
   // Tasks to be executed on the application thread.
   std::deque<std::function<void()>> app_thread_tasks_
@@ -316,16 +333,22 @@ class Scheduler {
   bool graph_input_streams_closed_ ABSL_GUARDED_BY(state_mutex_) = false;
 
   // Number of throttled graph input streams.
-  int throttled_graph_input_stream_count_ ABSL_GUARDED_BY(state_mutex_) = 0;
+  // Atomic so that throttling a graph input stream does not take state_mutex_;
+  // it is only read by HandleIdle.
+  std::atomic<int> throttled_graph_input_stream_count_ = ATOMIC_VAR_INIT(0);
 
   // Used to stop WaitUntilGraphInputStreamUnthrottled.
   int unthrottle_seq_num_ ABSL_GUARDED_BY(state_mutex_) = 0;
 
   // Used to stop WaitForObservedOutput.
-  bool observed_output_signal_ ABSL_GUARDED_BY(state_mutex_) = false;
+  // These two flags are atomic so that EmittedObservedOutput only takes
+  // state_mutex_ when an application thread is actually waiting. Each side
+  // sets its own flag before reading the other's, so that either the emitter
+  // sees the waiter, or the waiter sees the signal.
+  std::atomic<bool> observed_output_signal_ = ATOMIC_VAR_INIT(false);
 
   // True if an application thread is waiting in WaitForObservedOutput.
-  bool waiting_for_observed_output_ ABSL_GUARDED_BY(state_mutex_) = false;
+  std::atomic<bool> waiting_for_observed_output_ = ATOMIC_VAR_INIT(false);
 };
 
 }  // namespace internal
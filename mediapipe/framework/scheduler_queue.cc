@@ -17,10 +17,12 @@
 #include <memory>
 #include <queue>
 #include <utility>
+#include <vector>
 
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/platform_specific_tracepoints.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/status.h"
@@ -34,12 +36,21 @@
 namespace mediapipe {
 namespace internal {
 
-SchedulerQueue::Item::Item(CalculatorNode* node, CalculatorContext* cc)
-    : node_(node), cc_(cc) {
+thread_local SchedulerQueue* SchedulerQueue::current_queue_ = nullptr;
+thread_local std::vector<SchedulerQueue::Item>*
+    SchedulerQueue::current_fused_items_ = nullptr;
+
+SchedulerQueue::Item::Item(CalculatorNode* node, CalculatorContext* cc,
+                           bool completes_deferred_process)
+    : node_(node),
+      cc_(cc),
+      completes_deferred_process_(completes_deferred_process) {
   CHECK(node);
   CHECK(cc);
   is_source_ = node->IsSource();
   id_ = node->Id();
+  priority_ = node->priority();
+  critical_path_usec_ = node->critical_path_usec();
   if (is_source_) {
     layer_ = node->source_layer();
     source_process_order_ = node->SourceProcessOrder(cc).Value();
@@ -51,6 +62,7 @@ SchedulerQueue::Item::Item(CalculatorNode* node)
   CHECK(node);
   is_source_ = node->IsSource();
   id_ = node->Id();
+  priority_ = node->priority();
   if (is_source_) {
     layer_ = node->source_layer();
     source_process_order_ = Timestamp::Unstarted().Value();
@@ -70,6 +82,8 @@ bool SchedulerQueue::Item::operator<(const SchedulerQueue::Item& that) const {
   if (is_source_) {
     // Sources run after non-sources.
     if (!that.is_source_) return true;
+    // Lower priority sources run after higher priority sources.
+    if (priority_ != that.priority_) return priority_ < that.priority_;
     // Higher layer sources run after lower layer sources.
     if (layer_ != that.layer_) return layer_ > that.layer_;
     // Higher SourceProcessOrder values run after lower values.
@@ -81,6 +95,13 @@ bool SchedulerQueue::Item::operator<(const SchedulerQueue::Item& that) const {
   } else {
     // Non-sources run before sources.
     if (that.is_source_) return false;
+    // Lower priority non-sources run after higher priority non-sources.
+    if (priority_ != that.priority_) return priority_ < that.priority_;
+    // Nodes on shorter critical paths run after nodes on longer ones. This is
+    // always zero unless critical path scheduling is enabled.
+    if (critical_path_usec_ != that.critical_path_usec_) {
+      return critical_path_usec_ < that.critical_path_usec_;
+    }
     // For non-sources, higher ids run before lower ids.
     return id_ < that.id_;
   }
@@ -90,6 +111,7 @@ void SchedulerQueue::Reset() {
   absl::MutexLock lock(&mutex_);
   num_pending_tasks_ = 0;
   num_tasks_to_add_ = 0;
+  num_deferred_processes_ = 0;
   running_count_ = 0;
 }
 
@@ -97,8 +119,10 @@ void SchedulerQueue::SetExecutor(Executor* executor) { executor_ = executor; }
 
 bool SchedulerQueue::IsIdle() {
   VLOG(3) << "Scheduler queue empty: " << queue_.empty()
-          << ", # of pending tasks: " << num_pending_tasks_;
-  return queue_.empty() && num_pending_tasks_ == 0;
+          << ", # of pending tasks: " << num_pending_tasks_
+          << ", # of deferred processes: " << num_deferred_processes_;
+  return queue_.empty() && num_pending_tasks_ == 0 &&
+         num_deferred_processes_ == 0;
 }
 
 void SchedulerQueue::SetRunning(bool running) {
@@ -120,6 +144,15 @@ void SchedulerQueue::AddNode(CalculatorNode* node, CalculatorContext* cc) {
     CHECK(node->IsSource()) << node->DebugName();
     return;
   }
+  MEDIAPIPE_TRACEPOINT(node_scheduled,
+                       node->GetCalculatorState().NodeName().c_str(),
+                       node->Id(), cc->InputTimestamp().Value());
+  if (current_queue_ == this && node->IsInlineSafe() && !node->IsSource()) {
+    // Runs in the current task once the running node is done, unless the
+    // queue is paused or has a node to run first by then.
+    current_fused_items_->emplace_back(node, cc);
+    return;
+  }
   AddItemToQueue(Item(node, cc));
 }
 
@@ -189,6 +222,7 @@ void SchedulerQueue::RunNextTask() {
   CalculatorNode* node;
   CalculatorContext* calculator_context;
   bool is_open_node;
+  bool completes_deferred_process;
   {
     absl::MutexLock lock(&mutex_);
 
@@ -198,6 +232,7 @@ void SchedulerQueue::RunNextTask() {
     node = queue_.top().Node();
     calculator_context = queue_.top().Context();
     is_open_node = queue_.top().IsOpenNode();
+    completes_deferred_process = queue_.top().CompletesDeferredProcess();
     queue_.pop();
 
     CHECK(!node->Closed())
@@ -210,11 +245,25 @@ void SchedulerQueue::RunNextTask() {
   // an executor creating standard pthread will not, by default), so we
   // do it here to ensure all executors are covered.
   AUTORELEASEPOOL {
+    PacketArena::ScopedActivation packet_arena(shared_->packet_arena);
     if (is_open_node) {
       DCHECK(!calculator_context);
       OpenCalculatorNode(node);
     } else {
-      RunCalculatorNode(node, calculator_context);
+      // Executors may run tasks inline, so this task may be nested in another.
+      SchedulerQueue* const outer_queue = current_queue_;
+      std::vector<Item>* const outer_fused_items = current_fused_items_;
+      std::vector<Item> fused_items;
+      current_queue_ = this;
+      current_fused_items_ = &fused_items;
+      if (completes_deferred_process) {
+        CompleteDeferredProcess(node, calculator_context);
+      } else {
+        RunCalculatorNode(node, calculator_context);
+      }
+      RunFusedNodes(&fused_items);
+      current_queue_ = outer_queue;
+      current_fused_items_ = outer_fused_items;
     }
   }
 
@@ -231,6 +280,27 @@ void SchedulerQueue::RunNextTask() {
   }
 }
 
+bool SchedulerQueue::CanRunFused(const Item& item) {
+  absl::MutexLock lock(&mutex_);
+  // A paused queue starts no node, and queued nodes that run before this one
+  // keep their turn.
+  return running_count_ > 0 && (queue_.empty() || !(item < queue_.top()));
+}
+
+void SchedulerQueue::RunFusedNodes(std::vector<Item>* fused_items) {
+  // The nodes run in the order they became ready, and the nodes they make
+  // ready are appended. This task stays pending meanwhile, so the queue isn't
+  // idle. The nodes that can't run now are queued as usual.
+  for (int i = 0; i < fused_items->size(); ++i) {
+    Item item = (*fused_items)[i];
+    if (CanRunFused(item)) {
+      RunCalculatorNode(item.Node(), item.Context());
+    } else {
+      AddItemToQueue(std::move(item));
+    }
+  }
+}
+
 void SchedulerQueue::RunCalculatorNode(CalculatorNode* node,
                                        CalculatorContext* cc) {
   VLOG(3) << "Running " << node->DebugName();
@@ -254,31 +324,75 @@ void SchedulerQueue::RunCalculatorNode(CalculatorNode* node,
       shared_->error_callback(result);
     }
   } else {
+    ProtoArenaPool::ScopedActivation proto_arena(
+        shared_->proto_arena_pool.get(), cc->InputTimestamp());
     // Note that we don't need a lock because only one thread can execute this
     // due to the lock on running_nodes.
     int64 start_time = shared_->timer.StartNode();
     const absl::Status result = node->ProcessNode(cc);
-    shared_->timer.EndNode(start_time);
+    int64 node_time = shared_->timer.EndNode(start_time);
+    if (shared_->critical_path_scheduling) {
+      node->RecordProcessRuntime(node_time);
+    }
 
-    if (!result.ok()) {
-      if (result == tool::StatusStop()) {
-        // Check if StatusStop was returned by a non-source node. This means
-        // that all sources will be closed and no further sources should be
-        // scheduled. The graph will be terminated as soon as its scheduler
-        // queue becomes empty.
-        CHECK(!node->IsSource());  // ProcessNode takes care of StatusStop()
-                                   // from sources.
-        shared_->stopping = true;
-      } else {
-        // If we have an error in this calculator.
-        VLOG(3) << node->DebugName() << " had an error!";
-        shared_->error_callback(result);
-      }
+    if (result.ok() && cc->IsProcessDeferred()) {
+      // The node stays scheduled until Process() completes.
+      DeferProcess(node, cc);
+      return;
+    }
+    HandleProcessResult(node, result);
+  }
+
+  VLOG(4) << "Done running " << node->DebugName();
+  node->EndScheduling();
+}
+
+void SchedulerQueue::HandleProcessResult(CalculatorNode* node,
+                                         const absl::Status& result) {
+  if (!result.ok()) {
+    if (result == tool::StatusStop()) {
+      // Check if StatusStop was returned by a non-source node. This means
+      // that all sources will be closed and no further sources should be
+      // scheduled. The graph will be terminated as soon as its scheduler
+      // queue becomes empty.
+      CHECK(!node->IsSource());  // ProcessNode takes care of StatusStop()
+                                 // from sources.
+      shared_->stopping = true;
+    } else {
+      // If we have an error in this calculator.
+      VLOG(3) << node->DebugName() << " had an error!";
+      shared_->error_callback(result);
     }
   }
+}
+
+void SchedulerQueue::DeferProcess(CalculatorNode* node, CalculatorContext* cc) {
+  VLOG(3) << node->DebugName() << " deferred the completion of Process()";
+  {
+    absl::MutexLock lock(&mutex_);
+    ++num_deferred_processes_;
+  }
+  cc->resume_deferred_process_ = [this, node, cc] {
+    AddItemToQueue(Item(node, cc, /*completes_deferred_process=*/true));
+  };
+  if (cc->ArriveAtDeferredCompletion()) {
+    // The callback was already called during Process().
+    CompleteDeferredProcess(node, cc);
+  }
+}
+
+void SchedulerQueue::CompleteDeferredProcess(CalculatorNode* node,
+                                             CalculatorContext* cc) {
+  int64 start_time = shared_->timer.StartNode();
+  const absl::Status result =
+      node->CompleteDeferredProcess(cc, cc->TakeDeferredStatus());
+  shared_->timer.EndNode(start_time);
+  HandleProcessResult(node, result);
 
   VLOG(4) << "Done running " << node->DebugName();
   node->EndScheduling();
+  absl::MutexLock lock(&mutex_);
+  --num_deferred_processes_;
 }
 
 void SchedulerQueue::OpenCalculatorNode(CalculatorNode* node) {
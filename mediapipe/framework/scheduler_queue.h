@@ -20,6 +20,7 @@
 #include <memory>
 #include <queue>
 #include <utility>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/synchronization/mutex.h"
@@ -45,7 +46,10 @@ class SchedulerQueue : public TaskQueue {
   // Item in the queue. Wraps a node pointer and helps with priority sorting.
   class Item {
    public:
-    Item(CalculatorNode* node, CalculatorContext* cc);
+    // If completes_deferred_process is true, the task completes a Process()
+    // call deferred by the node in `cc` instead of running ProcessNode().
+    Item(CalculatorNode* node, CalculatorContext* cc,
+         bool completes_deferred_process = false);
     // A null CalculatorContext indicates the task should run OpenNode().
     Item(CalculatorNode* node);
 
@@ -55,25 +59,37 @@ class SchedulerQueue : public TaskQueue {
 
     bool IsOpenNode() const { return is_open_node_; }
 
+    bool CompletesDeferredProcess() const {
+      return completes_deferred_process_;
+    }
+
     // This comparison is meant to be used with a std::priority_queue. Since
     // the priority queue returns higher priority items first, this function
     // means "this is lower priority than that", i.e. "this runs after that".
     // - Non-sources have priority over sources.
-    // - Sources are sorted by layer (lower layer numbers run first), then by
-    //   Calculator::SourceProcessOrder (smaller values run first), then by
-    //   node id: smaller ids run first, since they come earlier in the config.
-    // - Non-sources are sorted by node id: larger ids run first, because they
-    //   are closer to the leaves.
+    // - Within each group, nodes with a higher Node::priority run first.
+    // - Sources are then sorted by layer (lower layer numbers run first),
+    //   then by Calculator::SourceProcessOrder (smaller values run first),
+    //   then by node id: smaller ids run first, since they come earlier in
+    //   the config.
+    // - Non-sources are then sorted by their critical path estimate, if
+    //   critical path scheduling is enabled: longer paths run first. Then
+    //   they are sorted by node id: larger ids run first, because they are
+    //   closer to the leaves.
     bool operator<(const Item& that) const;
 
    private:
     int64 source_process_order_ = 0;
+    // The critical path of the node when the item was created.
+    int64 critical_path_usec_ = 0;
     CalculatorNode* node_;
     CalculatorContext* cc_;
     int id_ = 0;
     int layer_ = 0;
+    int priority_ = 0;
     bool is_source_ = false;
     bool is_open_node_ = false;  // True if the task should run OpenNode().
+    bool completes_deferred_process_ = false;
   };
 
   explicit SchedulerQueue(SchedulerShared* shared) : shared_(shared) {}
@@ -133,11 +149,33 @@ class SchedulerQueue : public TaskQueue {
   void CleanupAfterRun() ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
+  // Runs `fused_items`, the inline-safe nodes added while a node of this queue
+  // runs on the current thread, including those added meanwhile.
+  void RunFusedNodes(std::vector<Item>* fused_items)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns true if `item`, an inline-safe node, can run in the current task:
+  // the queue is running and no queued node would run before it.
+  bool CanRunFused(const Item& item) ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Used internally by RunNextTask. Invokes ProcessNode or CloseNode, followed
   // by EndScheduling.
   void RunCalculatorNode(CalculatorNode* node, CalculatorContext* cc)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Reports the result of ProcessNode or CompleteDeferredProcess.
+  void HandleProcessResult(CalculatorNode* node, const absl::Status& result);
+
+  // Used internally by RunCalculatorNode when the node deferred the completion
+  // of Process(). Completes it right away if its callback was already called,
+  // or else lets the callback add a task to complete it.
+  void DeferProcess(CalculatorNode* node, CalculatorContext* cc)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Invokes CompleteDeferredProcess, followed by EndScheduling.
+  void CompleteDeferredProcess(CalculatorNode* node, CalculatorContext* cc)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   // Used internally by RunNextTask. Invokes OpenNode, followed by
   // CheckIfBecameReady.
   void OpenCalculatorNode(CalculatorNode* node) ABSL_LOCKS_EXCLUDED(mutex_);
@@ -162,12 +200,21 @@ class SchedulerQueue : public TaskQueue {
   // Number of tasks that need to be added to the Executor.
   int num_tasks_to_add_ ABSL_GUARDED_BY(mutex_);
 
+  // Number of Process() calls deferred by nodes and not yet complete. The
+  // queue isn't idle while they wait.
+  int num_deferred_processes_ ABSL_GUARDED_BY(mutex_) = 0;
+
   // Queue of nodes that need to be run.
   std::priority_queue<Item> queue_ ABSL_GUARDED_BY(mutex_);
 
   SchedulerShared* const shared_;
 
   absl::Mutex mutex_;
+
+  // The queue running a task on the current thread, and the inline-safe nodes
+  // added to it by that task, which run in the same task.
+  static thread_local SchedulerQueue* current_queue_;         // NOLINT
+  static thread_local std::vector<Item>* current_fused_items_;  // NOLINT
 };
 
 }  // namespace internal
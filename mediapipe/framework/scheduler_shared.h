@@ -25,6 +25,8 @@
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/deps/clock.h"
 #include "mediapipe/framework/deps/monotonic_clock.h"
+#include "mediapipe/framework/packet_arena.h"
+#include "mediapipe/framework/proto_arena_pool.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
 
@@ -70,11 +72,12 @@ class SchedulerTimer {
 
   // Called immediately before invoking ProcessNode or CloseNode.
   int64 StartNode() { return absl::ToUnixMicros(clock_->TimeNow()); }
-  // Called immediately after invoking ProcessNode or CloseNode.
-  void EndNode(int64 node_start_time) {
-    total_node_time_.fetch_add(
-        absl::ToUnixMicros(clock_->TimeNow()) - node_start_time,
-        std::memory_order_relaxed);
+  // Called immediately after invoking ProcessNode or CloseNode. Returns the
+  // time spent in the node, in microseconds.
+  int64 EndNode(int64 node_start_time) {
+    int64 node_time = absl::ToUnixMicros(clock_->TimeNow()) - node_start_time;
+    total_node_time_.fetch_add(node_time, std::memory_order_relaxed);
+    return node_time;
   }
 
   SchedulerTimes GetSchedulerTimes() {
@@ -108,6 +111,14 @@ struct SchedulerShared {
   std::function<void(const absl::Status& error)> error_callback;
   // Collects timing information for measuring overhead.
   internal::SchedulerTimer timer;
+  // The arena activated while running nodes, if any.
+  std::shared_ptr<PacketArena> packet_arena;
+  // The pool whose arena for the input timestamp is activated while running
+  // nodes, if any.
+  std::shared_ptr<ProtoArenaPool> proto_arena_pool;
+  // If true, the Process() runtimes of the nodes are recorded to rank ready
+  // nodes by their critical path.
+  bool critical_path_scheduling = false;
 };
 
 }  // namespace internal
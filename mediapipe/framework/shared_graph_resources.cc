@@ -0,0 +1,56 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/shared_graph_resources.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+const GraphService<SharedGraphResources> kSharedGraphResourcesService(
+    "kSharedGraphResourcesService");
+
+absl::StatusOr<std::vector<Packet>> SharedGraphResources::GetOrCreate(
+    const std::string& key,
+    absl::FunctionRef<absl::StatusOr<std::vector<Packet>>()> create) {
+  std::shared_ptr<Entry> entry;
+  {
+    absl::MutexLock lock(&mutex_);
+    std::shared_ptr<Entry>& slot = entries_[key];
+    if (!slot) {
+      slot = std::make_shared<Entry>();
+    }
+    entry = slot;
+  }
+  absl::MutexLock lock(&entry->mutex);
+  if (!entry->created) {
+    ASSIGN_OR_RETURN(entry->packets, create());
+    entry->created = true;
+  }
+  return entry->packets;
+}
+
+int SharedGraphResources::size() const {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size();
+}
+
+void SharedGraphResources::Clear() {
+  absl::MutexLock lock(&mutex_);
+  entries_.clear();
+}
+
+}  // namespace mediapipe
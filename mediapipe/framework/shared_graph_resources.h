@@ -0,0 +1,82 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_SHARED_GRAPH_RESOURCES_H_
+#define MEDIAPIPE_FRAMEWORK_SHARED_GRAPH_RESOURCES_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/packet.h"
+
+namespace mediapipe {
+
+// Memoizes the output side packets of pure calculators that only have side
+// packets, such as model, label map and anchor loaders, so that the graphs of a
+// process share them instead of each loading their own copy.
+//
+// Applications running many identical graphs give all of them the same
+// object:
+//
+//   auto resources = std::make_shared<SharedGraphResources>();
+//   for (CalculatorGraph& graph : graphs) {
+//     MP_RETURN_IF_ERROR(graph.Initialize(config));
+//     MP_RETURN_IF_ERROR(
+//         graph.SetServiceObject(kSharedGraphResourcesService, resources));
+//   }
+//
+// A node is shared if its calculator sets CalculatorContract::SetPure() and it
+// has no input or output streams. Nodes match when they have the same
+// calculator, options and side packet tags, and equal input side packets:
+// strings and protos are compared by value, other types by identity. The
+// cached packets live as long as the SharedGraphResources.
+class SharedGraphResources {
+ public:
+  // Returns the packets cached for `key`, calling `create` if there are none
+  // yet. Concurrent calls for the same key wait for a single `create` call.
+  // Errors are returned but not cached.
+  absl::StatusOr<std::vector<Packet>> GetOrCreate(
+      const std::string& key,
+      absl::FunctionRef<absl::StatusOr<std::vector<Packet>>()> create);
+
+  // Returns the number of cached entries.
+  int size() const;
+
+  // Drops the cached packets. Running graphs keep the packets they use.
+  void Clear();
+
+ private:
+  struct Entry {
+    absl::Mutex mutex;
+    bool created ABSL_GUARDED_BY(mutex) = false;
+    std::vector<Packet> packets ABSL_GUARDED_BY(mutex);
+  };
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// Provides the SharedGraphResources of a graph. There is none by default.
+extern const GraphService<SharedGraphResources> kSharedGraphResourcesService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_SHARED_GRAPH_RESOURCES_H_
@@ -0,0 +1,208 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/shared_graph_resources.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+int num_opens = 0;
+
+// Outputs a new string made of the PREFIX side packet and the number of
+// opens, so that shared outputs can be told apart from recomputed ones.
+class CountingLoaderCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->InputSidePackets().Tag("PREFIX").Set<std::string>();
+    cc->OutputSidePackets().Tag("DATA").Set<std::string>();
+    cc->SetPure(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    ++num_opens;
+    cc->OutputSidePackets().Tag("DATA").Set(MakePacket<std::string>(
+        cc->InputSidePackets().Tag("PREFIX").Get<std::string>() +
+        std::to_string(num_opens)));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(CountingLoaderCalculator);
+
+// Outputs ten times the SCALE side packet plus the number of opens.
+class CountingScaleCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->InputSidePackets().Tag("SCALE").Set<int>();
+    cc->OutputSidePackets().Tag("DATA").Set<int>();
+    cc->SetPure(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    ++num_opens;
+    cc->OutputSidePackets().Tag("DATA").Set(MakePacket<int>(
+        cc->InputSidePackets().Tag("SCALE").Get<int>() * 10 + num_opens));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(CountingScaleCalculator);
+
+CalculatorGraphConfig LoaderGraphConfig(const std::string& output_name) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(absl::Substitute(
+      R"pb(
+        input_side_packet: "input"
+        node {
+          calculator: "CountingLoaderCalculator"
+          input_side_packet: "PREFIX:input"
+          output_side_packet: "DATA:$0"
+        }
+      )pb",
+      output_name));
+}
+
+CalculatorGraphConfig ScaleGraphConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_side_packet: "input"
+    node {
+      calculator: "CountingScaleCalculator"
+      input_side_packet: "SCALE:input"
+      output_side_packet: "DATA:data"
+    }
+  )pb");
+}
+
+absl::StatusOr<Packet> RunGraph(
+    const CalculatorGraphConfig& config, const std::string& output_name,
+    const Packet& input, std::shared_ptr<SharedGraphResources> resources) {
+  CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  if (resources) {
+    MP_RETURN_IF_ERROR(
+        graph.SetServiceObject(kSharedGraphResourcesService, resources));
+  }
+  MP_RETURN_IF_ERROR(graph.Run({{"input", input}}));
+  return graph.GetOutputSidePacket(output_name);
+}
+
+absl::StatusOr<Packet> RunGraph(
+    const CalculatorGraphConfig& config, const std::string& output_name,
+    const std::string& prefix,
+    std::shared_ptr<SharedGraphResources> resources) {
+  return RunGraph(config, output_name, MakePacket<std::string>(prefix),
+                  std::move(resources));
+}
+
+TEST(SharedGraphResourcesTest, SharesOutputSidePacketsAcrossGraphs) {
+  num_opens = 0;
+  auto resources = std::make_shared<SharedGraphResources>();
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet first, RunGraph(LoaderGraphConfig("data"), "data", "a", resources));
+  // Only the names of the side packets differ.
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet second,
+      RunGraph(LoaderGraphConfig("other_data"), "other_data", "a", resources));
+  EXPECT_EQ(num_opens, 1);
+  EXPECT_EQ(first.Get<std::string>(), "a1");
+  EXPECT_EQ(&first.Get<std::string>(), &second.Get<std::string>());
+  EXPECT_EQ(resources->size(), 1);
+}
+
+TEST(SharedGraphResourcesTest, KeysOnInputSidePacketValues) {
+  num_opens = 0;
+  auto resources = std::make_shared<SharedGraphResources>();
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet first, RunGraph(LoaderGraphConfig("data"), "data", "a", resources));
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet second,
+      RunGraph(LoaderGraphConfig("data"), "data", "b", resources));
+  EXPECT_EQ(num_opens, 2);
+  EXPECT_EQ(first.Get<std::string>(), "a1");
+  EXPECT_EQ(second.Get<std::string>(), "b2");
+  EXPECT_EQ(resources->size(), 2);
+}
+
+TEST(SharedGraphResourcesTest, KeysOnScalarInputSidePacketValues) {
+  num_opens = 0;
+  auto resources = std::make_shared<SharedGraphResources>();
+  // Each graph gets a separately made packet, so only equal values match.
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet first,
+      RunGraph(ScaleGraphConfig(), "data", MakePacket<int>(2), resources));
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet second,
+      RunGraph(ScaleGraphConfig(), "data", MakePacket<int>(2), resources));
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet third,
+      RunGraph(ScaleGraphConfig(), "data", MakePacket<int>(3), resources));
+  // Inline payloads live in the packet, so their address tells nothing.
+  MP_ASSERT_OK_AND_ASSIGN(
+      Packet fourth, RunGraph(ScaleGraphConfig(), "data",
+                              MakeInlinePacket<int>(3), resources));
+  EXPECT_EQ(num_opens, 2);
+  EXPECT_EQ(first.Get<int>(), 21);
+  EXPECT_EQ(&first.Get<int>(), &second.Get<int>());
+  EXPECT_EQ(third.Get<int>(), 32);
+  EXPECT_EQ(&third.Get<int>(), &fourth.Get<int>());
+  EXPECT_EQ(resources->size(), 2);
+}
+
+TEST(SharedGraphResourcesTest, DoesNotShareWithoutService) {
+  num_opens = 0;
+  MP_ASSERT_OK(RunGraph(LoaderGraphConfig("data"), "data", "a", nullptr));
+  MP_ASSERT_OK(RunGraph(LoaderGraphConfig("data"), "data", "a", nullptr));
+  EXPECT_EQ(num_opens, 2);
+}
+
+TEST(SharedGraphResourcesTest, DoesNotCacheErrors) {
+  SharedGraphResources resources;
+  int num_calls = 0;
+  auto create = [&]() -> absl::StatusOr<std::vector<Packet>> {
+    if (++num_calls == 1) return absl::InternalError("failed");
+    return std::vector<Packet>{MakePacket<int>(num_calls)};
+  };
+  EXPECT_FALSE(resources.GetOrCreate("key", create).ok());
+  MP_ASSERT_OK_AND_ASSIGN(auto packets, resources.GetOrCreate("key", create));
+  MP_ASSERT_OK_AND_ASSIGN(auto cached, resources.GetOrCreate("key", create));
+  EXPECT_EQ(num_calls, 2);
+  ASSERT_EQ(cached.size(), 1);
+  EXPECT_EQ(cached[0].Get<int>(), 2);
+
+  resources.Clear();
+  EXPECT_EQ(resources.size(), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,65 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <utility>
+
+#include "mediapipe/framework/stream_handler/batching_input_stream_handler.pb.h"
+#include "mediapipe/framework/stream_handler/default_input_stream_handler.h"
+
+namespace mediapipe {
+
+// Input stream handler that passes several consecutive input timestamps to a
+// single Process() call, for calculators whose per-invocation overhead
+// outweighs their per-packet work on high-rate streams. Each input timestamp
+// is synchronized as in the DefaultInputStreamHandler. When the node is
+// scheduled, it receives all input timestamps that are ready, up to
+// max_batch_size, so batches only grow while the node falls behind and the
+// handler never delays an input set to fill a batch.
+//
+// Process() sees the first input set in Inputs() and at InputTimestamp(), and
+// all of them in CalculatorContext::InputBatch() and InputBatchTimestamps().
+// It may output packets at any of the batch timestamps, in order. For example:
+//
+// node {
+//   calculator: "BatchedScoringCalculator"
+//   input_stream: "TENSORS:tensors"
+//   output_stream: "FLOATS:floats"
+//   input_stream_handler {
+//     input_stream_handler: "BatchingInputStreamHandler"
+//     options {
+//       [mediapipe.BatchingInputStreamHandlerOptions.ext] {
+//         max_batch_size: 16
+//       }
+//     }
+//   }
+// }
+class BatchingInputStreamHandler : public DefaultInputStreamHandler {
+ public:
+  BatchingInputStreamHandler() = delete;
+  BatchingInputStreamHandler(std::shared_ptr<tool::TagMap> tag_map,
+                             CalculatorContextManager* cc_manager,
+                             const MediaPipeOptions& options,
+                             bool calculator_run_in_parallel)
+      : DefaultInputStreamHandler(std::move(tag_map), cc_manager, options,
+                                  calculator_run_in_parallel) {
+    SetMaxProcessBatchSize(
+        options.GetExtension(BatchingInputStreamHandlerOptions::ext)
+            .max_batch_size());
+  }
+};
+
+REGISTER_INPUT_STREAM_HANDLER(BatchingInputStreamHandler);
+
+}  // namespace mediapipe
@@ -0,0 +1,107 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Sums the "VALUE" packets of each batch, and outputs the sum at the last
+// timestamp of the batch.
+class BatchSumCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Tag("VALUE").Set<int>();
+    cc->Inputs().Tag("GATE").SetAny();
+    cc->Outputs().Index(0).Set<int>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    const auto& timestamps = cc->InputBatchTimestamps();
+    RET_CHECK(!timestamps.empty());
+    RET_CHECK_EQ(timestamps.front(), cc->InputTimestamp());
+    const auto& values = cc->InputBatch().Tag("VALUE");
+    RET_CHECK_EQ(values.size(), timestamps.size());
+    int sum = 0;
+    for (int i = 0; i < values.size(); ++i) {
+      RET_CHECK_EQ(values[i].Timestamp(), timestamps[i]);
+      sum += values[i].Get<int>();
+    }
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<int>(sum).At(timestamps.back()));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(BatchSumCalculator);
+
+// The 10 input sets become ready together when the "gate" stream closes, and
+// are passed to Process() in batches of at most 4.
+TEST(BatchingInputStreamHandlerTest, ProcessesReadyInputSetsInBatches) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "value"
+        input_stream: "gate"
+        node {
+          calculator: "BatchSumCalculator"
+          input_stream: "VALUE:value"
+          input_stream: "GATE:gate"
+          output_stream: "sum"
+          input_stream_handler {
+            input_stream_handler: "BatchingInputStreamHandler"
+            options {
+              [mediapipe.BatchingInputStreamHandlerOptions.ext] {
+                max_batch_size: 4
+              }
+            }
+          }
+        })pb");
+  std::vector<Packet> sum_packets;
+  tool::AddVectorSink("sum", &config, &sum_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  for (int i = 0; i < 10; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "value", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  EXPECT_TRUE(sum_packets.empty());
+  MP_ASSERT_OK(graph.CloseInputStream("gate"));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  std::vector<int> sums;
+  std::vector<Timestamp> timestamps;
+  for (const Packet& packet : sum_packets) {
+    sums.push_back(packet.Get<int>());
+    timestamps.push_back(packet.Timestamp());
+  }
+  EXPECT_THAT(sums, ElementsAre(0 + 1 + 2 + 3, 4 + 5 + 6 + 7, 8 + 9));
+  EXPECT_THAT(timestamps,
+              ElementsAre(Timestamp(3), Timestamp(7), Timestamp(9)));
+}
+
+}  // namespace
+}  // namespace mediapipe
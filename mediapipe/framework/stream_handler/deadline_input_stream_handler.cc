@@ -0,0 +1,107 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <memory>
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/stream_handler/deadline_input_stream_handler.pb.h"
+#include "mediapipe/framework/stream_handler/default_input_stream_handler.h"
+
+namespace mediapipe {
+
+// Input stream handler that drops the input sets whose deadline has passed.
+// The deadline of a timestamp is the time it represents plus a latency budget,
+// so the timestamps must be measured in microseconds with a known clock, as
+// for live camera frames. Dropped timestamps still advance the timestamp
+// bound, so downstream nodes aren't held up. Otherwise it behaves like the
+// DefaultInputStreamHandler, and reports the deadline through
+// CalculatorContext::Deadline().
+//
+// Under load, work is then shed at each node where it gets late, rather than
+// only at the graph input by a FlowLimiterCalculator. For example:
+//
+// node {
+//   calculator: "InferenceCalculator"
+//   input_stream: "TENSORS:input_tensors"
+//   output_stream: "TENSORS:output_tensors"
+//   input_stream_handler {
+//     input_stream_handler: "DeadlineInputStreamHandler"
+//     options {
+//       [mediapipe.DeadlineInputStreamHandlerOptions.ext] {
+//         clock: MONOTONIC
+//         latency_budget_us: 100000
+//       }
+//     }
+//   }
+// }
+class DeadlineInputStreamHandler : public DefaultInputStreamHandler {
+ public:
+  DeadlineInputStreamHandler() = delete;
+  DeadlineInputStreamHandler(std::shared_ptr<tool::TagMap> tag_map,
+                             CalculatorContextManager* cc_manager,
+                             const MediaPipeOptions& options,
+                             bool calculator_run_in_parallel)
+      : DefaultInputStreamHandler(std::move(tag_map), cc_manager, options,
+                                  calculator_run_in_parallel) {
+    const auto& ext =
+        options.GetExtension(DeadlineInputStreamHandlerOptions::ext);
+    clock_ = ext.clock();
+    latency_budget_ = absl::Microseconds(ext.latency_budget_us());
+  }
+
+ protected:
+  NodeReadiness GetNodeReadiness(Timestamp* min_stream_timestamp) override {
+    while (true) {
+      const NodeReadiness readiness =
+          DefaultInputStreamHandler::GetNodeReadiness(min_stream_timestamp);
+      if (readiness != NodeReadiness::kReadyForProcess ||
+          Deadline(*min_stream_timestamp) >= absl::Now()) {
+        return readiness;
+      }
+      // Drops the late input set. Once no input set is ready, the node
+      // propagates the timestamp bound past it.
+      const Timestamp next_timestamp =
+          min_stream_timestamp->NextAllowedInStream();
+      for (auto& stream : input_stream_managers_) {
+        stream->ErasePacketsEarlierThan(next_timestamp);
+      }
+      sync_set_.MarkAllStreamsChanged();
+    }
+  }
+
+  absl::Time Deadline(Timestamp input_timestamp) const override {
+    if (!input_timestamp.IsRangeValue()) {
+      return absl::InfiniteFuture();
+    }
+    const absl::Duration deadline =
+        absl::Microseconds(input_timestamp.Microseconds()) + latency_budget_;
+    if (clock_ == DeadlineInputStreamHandlerOptions::MONOTONIC) {
+      const absl::Duration monotonic_now =
+          absl::FromChrono(std::chrono::steady_clock::now().time_since_epoch());
+      return absl::Now() + (deadline - monotonic_now);
+    }
+    return absl::UnixEpoch() + deadline;
+  }
+
+ private:
+  DeadlineInputStreamHandlerOptions::Clock clock_;
+  absl::Duration latency_budget_;
+};
+
+REGISTER_INPUT_STREAM_HANDLER(DeadlineInputStreamHandler);
+
+}  // namespace mediapipe
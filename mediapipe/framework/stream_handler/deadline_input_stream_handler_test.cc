@@ -0,0 +1,68 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(DeadlineInputStreamHandlerTest, DropsLateInputs) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "input"
+          output_stream: "output"
+          input_stream_handler {
+            input_stream_handler: "DeadlineInputStreamHandler"
+            options {
+              [mediapipe.DeadlineInputStreamHandlerOptions.ext] {
+                clock: REALTIME
+                latency_budget_us: 1000000
+              }
+            }
+          }
+        })pb");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("output", &config, &output_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  const int64_t now_us = absl::ToUnixMicros(absl::Now());
+  const Timestamp late_timestamp(now_us - 10000000);
+  const Timestamp timely_timestamp(now_us);
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input", MakePacket<int>(1).At(late_timestamp)));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "input", MakePacket<int>(2).At(timely_timestamp)));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(output_packets.size(), 1);
+  EXPECT_EQ(output_packets[0].Timestamp(), timely_timestamp);
+  EXPECT_EQ(output_packets[0].Get<int>(), 2);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -66,4 +66,8 @@ void DefaultInputStreamHandler::FillInputSet(Timestamp input_timestamp,
   sync_set_.FillInputSet(input_timestamp, input_set);
 }
 
+void DefaultInputStreamHandler::InputStreamChanged(CollectionItemId id) {
+  sync_set_.MarkStreamChanged(id);
+}
+
 }  // namespace mediapipe
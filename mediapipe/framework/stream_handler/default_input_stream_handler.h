@@ -52,6 +52,9 @@ class DefaultInputStreamHandler : public InputStreamHandler {
   void FillInputSet(Timestamp input_timestamp,
                     InputStreamShardSet* input_set) override;
 
+  // Reports stream changes to the SyncSet.
+  void InputStreamChanged(CollectionItemId id) override;
+
   // The packet-set builder.
   SyncSet sync_set_;
 };
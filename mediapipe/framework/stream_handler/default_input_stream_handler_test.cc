@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -279,5 +280,67 @@ TEST(DefaultInputStreamHandlerTest, DoesntPropagateTimestampWhenBatching) {
   EXPECT_EQ(4, sink.size());
 }
 
+// This test checks the synchronization of a node with many input streams,
+// whose readiness is tracked incrementally.
+TEST(DefaultInputStreamHandlerTest, SynchronizesWideNodes) {
+  constexpr int kNumStreams = 10;
+  CalculatorGraphConfig config;
+  CalculatorGraphConfig::Node* node = config.add_node();
+  node->set_calculator("PassThroughCalculator");
+  for (int i = 0; i < kNumStreams; ++i) {
+    config.add_input_stream(absl::StrCat("input", i));
+    node->add_input_stream(absl::StrCat("input", i));
+    node->add_output_stream(absl::StrCat("output", i));
+  }
+  std::vector<std::vector<Packet>> sinks(kNumStreams);
+  for (int i = 0; i < kNumStreams; ++i) {
+    tool::AddVectorSink(absl::StrCat("output", i), &config, &sinks[i]);
+  }
+  auto sink_timestamps = [&sinks](int i) {
+    std::vector<int64> timestamps;
+    for (const Packet& packet : sinks[i]) {
+      timestamps.push_back(packet.Timestamp().Value());
+    }
+    return timestamps;
+  };
+
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  for (int i = 0; i < kNumStreams - 1; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        absl::StrCat("input", i), Adopt(new int(i)).At(Timestamp(1))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  // The last stream is not settled at timestamp 1 yet.
+  for (int i = 0; i < kNumStreams; ++i) {
+    EXPECT_TRUE(sinks[i].empty());
+  }
+
+  MP_ASSERT_OK(graph.SetInputStreamTimestampBound(
+      absl::StrCat("input", kNumStreams - 1), Timestamp(2)));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  for (int i = 0; i < kNumStreams - 1; ++i) {
+    EXPECT_EQ(sink_timestamps(i), std::vector<int64>({1}));
+  }
+  EXPECT_TRUE(sinks[kNumStreams - 1].empty());
+
+  // Packets arriving in a different order on each stream.
+  for (int i = kNumStreams - 1; i >= 0; --i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        absl::StrCat("input", i), Adopt(new int(i)).At(Timestamp(3))));
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+    EXPECT_EQ(sinks[0].size(), i == 0 ? 2 : 1);
+  }
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  for (int i = 0; i < kNumStreams - 1; ++i) {
+    EXPECT_EQ(sink_timestamps(i), std::vector<int64>({1, 3}));
+  }
+  EXPECT_EQ(sink_timestamps(kNumStreams - 1), std::vector<int64>({3}));
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -85,6 +85,7 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
     for (auto& stream : input_stream_managers_) {
       stream->ErasePacketsEarlierThan(min_timestamp_all_streams);
     }
+    sync_set_.MarkAllStreamsChanged();
   }
 
   // Returns the latest timestamp allowed before a bound.
@@ -149,6 +150,7 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
     for (auto& stream : input_stream_managers_) {
       stream->ErasePacketsEarlierThan(kept_timestamp_);
     }
+    sync_set_.MarkAllStreamsChanged();
   }
 
   void EraseSurplusPackets(bool keep_one)
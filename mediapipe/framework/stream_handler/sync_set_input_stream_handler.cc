@@ -69,6 +69,9 @@ class SyncSetInputStreamHandler : public InputStreamHandler {
   // Returns the number of sync-sets maintained by this input-handler.
   int SyncSetCount() override;
 
+  // Reports stream changes to the sync-sets.
+  void InputStreamChanged(CollectionItemId id) override;
+
  private:
   absl::Mutex mutex_;
   // The ids of each set of inputs.
@@ -196,6 +199,13 @@ void SyncSetInputStreamHandler::FillInputSet(Timestamp input_timestamp,
   ready_timestamp_ = Timestamp::Done();
 }
 
+void SyncSetInputStreamHandler::InputStreamChanged(CollectionItemId id) {
+  absl::MutexLock lock(&mutex_);
+  for (auto& sync_set : sync_sets_) {
+    sync_set.MarkStreamChanged(id);
+  }
+}
+
 int SyncSetInputStreamHandler::SyncSetCount() {
   absl::MutexLock lock(&mutex_);
   return sync_sets_.size();
@@ -0,0 +1,47 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tensor_pool_service.h"
+
+namespace mediapipe {
+
+const GraphService<TensorPool> kTensorPoolService(
+    "kTensorPoolService", GraphServiceBase::kAllowDefaultInitialization);
+
+void UseTensorPool(CalculatorContract* cc) {
+  cc->UseService(kTensorPoolService).Optional();
+}
+
+Tensor AllocateTensor(CalculatorContext* cc, Tensor::ElementType element_type,
+                      const Tensor::Shape& shape) {
+  auto pool = cc->Service(kTensorPoolService);
+  if (!pool.IsAvailable()) {
+    return Tensor(element_type, shape);
+  }
+  return pool.GetObject().GetTensor(element_type, shape);
+}
+
+Tensor AllocateTensor(
+    CalculatorContext* cc, Tensor::ElementType element_type,
+    const Tensor::Shape& shape,
+    const Tensor::QuantizationParameters& quantization_parameters) {
+  auto pool = cc->Service(kTensorPoolService);
+  if (!pool.IsAvailable()) {
+    return Tensor(element_type, shape, quantization_parameters);
+  }
+  return pool.GetObject().GetTensor(element_type, shape,
+                                    quantization_parameters);
+}
+
+}  // namespace mediapipe
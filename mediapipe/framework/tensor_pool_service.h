@@ -0,0 +1,47 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TENSOR_POOL_SERVICE_H_
+#define MEDIAPIPE_FRAMEWORK_TENSOR_POOL_SERVICE_H_
+
+#include "mediapipe/framework/calculator_context.h"
+#include "mediapipe/framework/calculator_contract.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+
+// A pool of Tensor storages shared by the calculators of a graph. It is
+// created with the graph unless the application provides one with
+// SetServiceObject.
+extern const GraphService<TensorPool> kTensorPoolService;
+
+// Requests kTensorPoolService. Call from GetContract in calculators that
+// allocate their output tensors with the function below.
+void UseTensorPool(CalculatorContract* cc);
+
+// Returns a tensor for a calculator to fill. Its storages come from the
+// graph's pool if the calculator requested it, and are allocated anew
+// otherwise.
+Tensor AllocateTensor(CalculatorContext* cc, Tensor::ElementType element_type,
+                      const Tensor::Shape& shape);
+Tensor AllocateTensor(
+    CalculatorContext* cc, Tensor::ElementType element_type,
+    const Tensor::Shape& shape,
+    const Tensor::QuantizationParameters& quantization_parameters);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TENSOR_POOL_SERVICE_H_
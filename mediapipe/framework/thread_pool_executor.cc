@@ -14,12 +14,17 @@
 
 #include "mediapipe/framework/thread_pool_executor.h"
 
+#include <iterator>
+#include <set>
 #include <utility>
 
+#include "absl/algorithm/container.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
+#include "mediapipe/framework/work_stealing_executor.h"
 #include "mediapipe/util/cpu_util.h"
 
 namespace mediapipe {
@@ -70,7 +75,38 @@ absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
     default:
       break;
   }
+  if (options.cpu_set_size() > 0) {
+    thread_options.set_cpu_set(
+        std::set<int>(options.cpu_set().begin(), options.cpu_set().end()));
+  }
+  if (options.has_numa_node()) {
+    ASSIGN_OR_RETURN(std::set<int> numa_node_cpus,
+                     GetNumaNodeCpuIds(options.numa_node()));
+    std::set<int> cpus;
+    if (options.cpu_set_size() > 0) {
+      absl::c_set_intersection(thread_options.cpu_set(), numa_node_cpus,
+                               std::inserter(cpus, cpus.begin()));
+    } else {
+      cpus = std::move(numa_node_cpus);
+    }
+    if (cpus.empty()) {
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "No CPU of the cpu_set field in ThreadPoolExecutorOptions is "
+                "on NUMA node "
+             << options.numa_node();
+    }
+    thread_options.set_cpu_set(cpus);
+  }
+#else
+  if (options.cpu_set_size() > 0 || options.has_numa_node()) {
+    return absl::UnimplementedError(
+        "The cpu_set and numa_node fields in ThreadPoolExecutorOptions are "
+        "only supported on Linux.");
+  }
 #endif
+  if (options.enable_work_stealing()) {
+    return new WorkStealingExecutor(thread_options, options.num_threads());
+  }
   return new ThreadPoolExecutor(thread_options, options.num_threads());
 }
 
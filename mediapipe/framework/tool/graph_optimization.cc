@@ -0,0 +1,215 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_optimization.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/proto_ns.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/tool/subgraph_expansion.h"
+
+namespace mediapipe {
+
+namespace tool {
+
+namespace {
+
+using RenameMap = absl::flat_hash_map<std::string, std::string>;
+
+// Returns the name in a "TAG:index:name" stream or side packet.
+absl::string_view StreamName(absl::string_view stream) {
+  const auto colon_pos = stream.find_last_of(':');
+  return colon_pos == absl::string_view::npos ? stream
+                                              : stream.substr(colon_pos + 1);
+}
+
+// Returns a key that is equal for nodes that only differ by their name and the
+// names of their outputs.
+absl::StatusOr<std::string> NodeKey(const CalculatorGraphConfig::Node& node) {
+  CalculatorGraphConfig::Node key_node = node;
+  key_node.clear_name();
+  const auto clear = [](absl::string_view) { return std::string(); };
+  MP_RETURN_IF_ERROR(
+      TransformStreamNames(key_node.mutable_output_stream(), clear));
+  MP_RETURN_IF_ERROR(
+      TransformStreamNames(key_node.mutable_output_side_packet(), clear));
+  return key_node.SerializeAsString();
+}
+
+// Maps the output names of `duplicate` to those of `original`, which only
+// differ by their names.
+void AddRenames(const proto_ns::RepeatedPtrField<ProtoString>& duplicate,
+                const proto_ns::RepeatedPtrField<ProtoString>& original,
+                RenameMap* renames) {
+  for (int i = 0; i < duplicate.size(); ++i) {
+    (*renames)[std::string(StreamName(duplicate[i]))] =
+        std::string(StreamName(original[i]));
+  }
+}
+
+absl::Status ApplyRenames(const RenameMap& renames,
+                          proto_ns::RepeatedPtrField<ProtoString>* streams) {
+  if (renames.empty()) return absl::OkStatus();
+  return TransformStreamNames(streams, [&renames](absl::string_view name) {
+    // A surviving node may itself be merged into a later one that produces
+    // a graph output, so the renames are followed to the end.
+    std::string renamed(name);
+    for (auto it = renames.find(renamed); it != renames.end();
+         it = renames.find(renamed)) {
+      renamed = it->second;
+    }
+    return renamed;
+  });
+}
+
+void AddNames(const proto_ns::RepeatedPtrField<ProtoString>& streams,
+              absl::flat_hash_set<std::string>* names) {
+  for (const auto& stream : streams) {
+    names->insert(std::string(StreamName(stream)));
+  }
+}
+
+bool AnyNameIn(const proto_ns::RepeatedPtrField<ProtoString>& streams,
+               const absl::flat_hash_set<std::string>& names) {
+  for (const auto& stream : streams) {
+    if (names.contains(StreamName(stream))) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+absl::StatusOr<int> OptimizePureNodes(std::vector<bool> pure_nodes,
+                                      CalculatorGraphConfig* config) {
+  RET_CHECK_EQ(pure_nodes.size(), config->node_size());
+  absl::flat_hash_set<std::string> graph_output_streams;
+  absl::flat_hash_set<std::string> graph_output_side_packets;
+  AddNames(config->output_stream(), &graph_output_streams);
+  AddNames(config->output_side_packet(), &graph_output_side_packets);
+  const auto produces_graph_output =
+      [&](const CalculatorGraphConfig::Node& node) {
+        return AnyNameIn(node.output_stream(), graph_output_streams) ||
+               AnyNameIn(node.output_side_packet(),
+                         graph_output_side_packets);
+      };
+  int num_removed = 0;
+  while (true) {
+    const int num_nodes = config->node_size();
+    std::vector<bool> removed(num_nodes, false);
+
+    // Merges the duplicates of earlier pure nodes. The graph outputs are
+    // never renamed: a duplicate producing one survives in place of the
+    // earlier node, and two nodes producing graph outputs are both kept.
+    RenameMap stream_renames;
+    RenameMap side_packet_renames;
+    absl::flat_hash_map<std::string, int> first_nodes;
+    for (int i = 0; i < num_nodes; ++i) {
+      if (!pure_nodes[i]) continue;
+      ASSIGN_OR_RETURN(std::string key, NodeKey(config->node(i)));
+      const auto [it, inserted] = first_nodes.emplace(std::move(key), i);
+      if (inserted) continue;
+      int kept = it->second;
+      int merged = i;
+      if (produces_graph_output(config->node(merged))) {
+        if (produces_graph_output(config->node(kept))) continue;
+        std::swap(kept, merged);
+        it->second = kept;
+      }
+      const auto& node = config->node(merged);
+      const auto& original = config->node(kept);
+      AddRenames(node.output_stream(), original.output_stream(),
+                 &stream_renames);
+      AddRenames(node.output_side_packet(), original.output_side_packet(),
+                 &side_packet_renames);
+      removed[merged] = true;
+    }
+    for (auto& node : *config->mutable_node()) {
+      MP_RETURN_IF_ERROR(
+          ApplyRenames(stream_renames, node.mutable_input_stream()));
+      MP_RETURN_IF_ERROR(
+          ApplyRenames(side_packet_renames, node.mutable_input_side_packet()));
+    }
+    for (auto& generator : *config->mutable_packet_generator()) {
+      MP_RETURN_IF_ERROR(ApplyRenames(side_packet_renames,
+                                      generator.mutable_input_side_packet()));
+    }
+    for (auto& status_handler : *config->mutable_status_handler()) {
+      MP_RETURN_IF_ERROR(ApplyRenames(
+          side_packet_renames, status_handler.mutable_input_side_packet()));
+    }
+
+    // Removes the pure nodes whose outputs aren't consumed.
+    absl::flat_hash_set<std::string> consumed_streams;
+    absl::flat_hash_set<std::string> consumed_side_packets;
+    for (int i = 0; i < num_nodes; ++i) {
+      if (removed[i]) continue;
+      AddNames(config->node(i).input_stream(), &consumed_streams);
+      AddNames(config->node(i).input_side_packet(), &consumed_side_packets);
+    }
+    for (const auto& generator : config->packet_generator()) {
+      AddNames(generator.input_side_packet(), &consumed_side_packets);
+    }
+    for (const auto& status_handler : config->status_handler()) {
+      AddNames(status_handler.input_side_packet(), &consumed_side_packets);
+    }
+    AddNames(config->output_stream(), &consumed_streams);
+    AddNames(config->output_side_packet(), &consumed_side_packets);
+    for (int i = 0; i < num_nodes; ++i) {
+      if (!pure_nodes[i] || removed[i]) continue;
+      const auto& node = config->node(i);
+      removed[i] =
+          !AnyNameIn(node.output_stream(), consumed_streams) &&
+          !AnyNameIn(node.output_side_packet(), consumed_side_packets);
+    }
+
+    const int num_removed_now =
+        std::count(removed.begin(), removed.end(), true);
+    if (num_removed_now == 0) break;
+    num_removed += num_removed_now;
+    proto_ns::RepeatedPtrField<CalculatorGraphConfig::Node> nodes;
+    std::vector<bool> remaining_pure_nodes;
+    for (int i = 0; i < num_nodes; ++i) {
+      if (removed[i]) continue;
+      *nodes.Add() = std::move(*config->mutable_node(i));
+      remaining_pure_nodes.push_back(pure_nodes[i]);
+    }
+    config->mutable_node()->Swap(&nodes);
+    pure_nodes = std::move(remaining_pure_nodes);
+  }
+  return num_removed;
+}
+
+absl::StatusOr<int> ApplyNodeFusions(CalculatorGraphConfig* config) {
+  const auto names = NodeFusionRegistry::GetRegisteredNames();
+  int num_removed = 0;
+  for (const std::string& name : std::set<std::string>(names.begin(),
+                                                       names.end())) {
+    ASSIGN_OR_RETURN(int num_fused,
+                     NodeFusionRegistry::CreateByName(name, config),
+                     _ << "in node fusion " << name);
+    num_removed += num_fused;
+  }
+  return num_removed;
+}
+
+}  // namespace tool
+}  // namespace mediapipe
@@ -0,0 +1,67 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_OPTIMIZATION_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_OPTIMIZATION_H_
+
+#include <vector>
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+namespace tool {
+
+// Removes redundant pure nodes from an expanded graph config, where
+// `pure_nodes[i]` tells whether node i is pure, i.e. whether its outputs only
+// depend on its inputs and options and it has no other effect:
+// - A pure node that is identical to an earlier pure node, including its input
+//   streams and input side packets, is merged into it: the consumers of its
+//   outputs are connected to the corresponding outputs of the earlier node.
+//   The graph outputs keep their names: when only the later node produces
+//   one, the earlier node is merged into it instead, and when both do, both
+//   are kept.
+// - A pure node none of whose outputs is consumed by a node, a packet
+//   generator, a status handler or the graph outputs is removed.
+// Both are repeated until no node is removed, and the number of removed nodes
+// is returned.
+absl::StatusOr<int> OptimizePureNodes(std::vector<bool> pure_nodes,
+                                      CalculatorGraphConfig* config);
+
+// A node fusion rewrites an expanded graph config, replacing nodes with
+// downstream nodes that can do their work as part of their own, e.g. folding
+// an image transformation into the sampling pass of a later calculator so
+// that the intermediate image is never produced. It must leave the outputs
+// that remain in the graph unchanged, and returns the number of nodes it
+// removed.
+using NodeFusionRegistry =
+    GlobalFactoryRegistry<absl::StatusOr<int>, CalculatorGraphConfig*>;
+
+// Registers a node fusion, usually next to the calculator that absorbs the
+// fused nodes, so that it is only linked in when the calculator is.
+#define REGISTER_MEDIAPIPE_NODE_FUSION(name, fusion)                     \
+  REGISTER_FACTORY_FUNCTION_QUALIFIED(mediapipe::tool::NodeFusionRegistry, \
+                                      node_fusion_registration, name, fusion)
+
+// Applies all registered node fusions, in the order of their names, and
+// returns the number of removed nodes.
+absl::StatusOr<int> ApplyNodeFusions(CalculatorGraphConfig* config);
+
+}  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_OPTIMIZATION_H_
@@ -0,0 +1,269 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_optimization.h"
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace tool {
+namespace {
+
+TEST(GraphOptimizationTest, MergesIdenticalPureNodes) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        node {
+          name: "size_a"
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_a"
+        }
+        node {
+          name: "size_b"
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_b"
+        }
+        node {
+          calculator: "ScaleCalculator"
+          input_stream: "SIZE:size_a"
+          output_stream: "scaled_a"
+        }
+        node {
+          calculator: "ScaleCalculator"
+          input_stream: "SIZE:size_b"
+          output_stream: "scaled_b"
+        }
+        node {
+          calculator: "SinkCalculator"
+          input_stream: "scaled_a"
+          input_stream: "scaled_b"
+        }
+      )pb");
+  CalculatorGraphConfig expected_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        node {
+          name: "size_a"
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_a"
+        }
+        node {
+          calculator: "ScaleCalculator"
+          input_stream: "SIZE:size_a"
+          output_stream: "scaled_a"
+        }
+        node {
+          calculator: "SinkCalculator"
+          input_stream: "scaled_a"
+          input_stream: "scaled_a"
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(
+      int num_removed,
+      OptimizePureNodes({true, true, true, true, false}, &config));
+  EXPECT_EQ(num_removed, 2);
+  EXPECT_THAT(config, EqualsProto(expected_config));
+}
+
+TEST(GraphOptimizationTest, KeepsNodesWithDifferentOptionsOrInputs) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "a"
+        input_stream: "b"
+        node {
+          calculator: "PureCalculator"
+          input_stream: "a"
+          output_stream: "out_1"
+        }
+        node {
+          calculator: "PureCalculator"
+          input_stream: "b"
+          output_stream: "out_2"
+        }
+        node {
+          calculator: "PureCalculator"
+          input_stream: "a"
+          output_stream: "out_3"
+          max_in_flight: 2
+        }
+        node {
+          calculator: "SinkCalculator"
+          input_stream: "out_1"
+          input_stream: "out_2"
+          input_stream: "out_3"
+        }
+      )pb");
+  const CalculatorGraphConfig expected_config = config;
+  MP_ASSERT_OK_AND_ASSIGN(
+      int num_removed, OptimizePureNodes({true, true, true, false}, &config));
+  EXPECT_EQ(num_removed, 0);
+  EXPECT_THAT(config, EqualsProto(expected_config));
+}
+
+TEST(GraphOptimizationTest, RemovesUnconsumedPureBranches) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "OUT:result"
+        node {
+          calculator: "PureCalculator"
+          input_stream: "image"
+          output_stream: "render_data"
+        }
+        node {
+          calculator: "PureCalculator"
+          input_stream: "render_data"
+          output_stream: "rendered"
+        }
+        node {
+          calculator: "OtherPureCalculator"
+          input_stream: "image"
+          output_stream: "result"
+        }
+        node {
+          calculator: "ImpureCalculator"
+          input_stream: "image"
+          output_stream: "unused"
+        }
+      )pb");
+  CalculatorGraphConfig expected_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "OUT:result"
+        node {
+          calculator: "OtherPureCalculator"
+          input_stream: "image"
+          output_stream: "result"
+        }
+        node {
+          calculator: "ImpureCalculator"
+          input_stream: "image"
+          output_stream: "unused"
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(
+      int num_removed, OptimizePureNodes({true, true, true, false}, &config));
+  EXPECT_EQ(num_removed, 2);
+  EXPECT_THAT(config, EqualsProto(expected_config));
+}
+
+TEST(GraphOptimizationTest, KeepsGraphOutputNames) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "SIZE:size_b"
+        output_side_packet: "side_b"
+        node {
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_a"
+          output_side_packet: "side_a"
+        }
+        node {
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_b"
+          output_side_packet: "side_b"
+        }
+        node {
+          calculator: "SinkCalculator"
+          input_stream: "size_a"
+          input_side_packet: "side_a"
+        }
+      )pb");
+  CalculatorGraphConfig expected_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "SIZE:size_b"
+        output_side_packet: "side_b"
+        node {
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_b"
+          output_side_packet: "side_b"
+        }
+        node {
+          calculator: "SinkCalculator"
+          input_stream: "size_b"
+          input_side_packet: "side_b"
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(int num_removed,
+                          OptimizePureNodes({true, true, false}, &config));
+  EXPECT_EQ(num_removed, 1);
+  EXPECT_THAT(config, EqualsProto(expected_config));
+}
+
+TEST(GraphOptimizationTest, KeepsDuplicatesProducingGraphOutputs) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "size_a"
+        output_stream: "size_b"
+        node {
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_a"
+        }
+        node {
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_b"
+        }
+        node {
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_c"
+        }
+        node {
+          calculator: "SinkCalculator"
+          input_stream: "size_c"
+        }
+      )pb");
+  CalculatorGraphConfig expected_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "size_a"
+        output_stream: "size_b"
+        node {
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_a"
+        }
+        node {
+          calculator: "SizeCalculator"
+          input_stream: "IMAGE:image"
+          output_stream: "SIZE:size_b"
+        }
+        node {
+          calculator: "SinkCalculator"
+          input_stream: "size_a"
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(
+      int num_removed, OptimizePureNodes({true, true, true, false}, &config));
+  EXPECT_EQ(num_removed, 1);
+  EXPECT_THAT(config, EqualsProto(expected_config));
+}
+
+}  // namespace
+}  // namespace tool
+}  // namespace mediapipe
@@ -0,0 +1,205 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_partitioner.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/tool/name_util.h"
+#include "mediapipe/framework/tool/tag_map.h"
+
+namespace mediapipe {
+
+namespace tool {
+
+namespace {
+
+using Node = CalculatorGraphConfig::Node;
+
+class GraphPartitioner {
+ public:
+  GraphPartitioner(const CalculatorGraphConfig& config,
+                   const GraphPartitionOptions& options)
+      : config_(config), options_(options) {}
+
+  absl::StatusOr<std::map<std::string, CalculatorGraphConfig>> Partition() {
+    CalculatorGraphConfig base = config_;
+    base.clear_node();
+    base.clear_input_stream();
+    base.clear_output_stream();
+    base.clear_output_side_packet();
+    base.clear_packet_generator();
+    base.clear_status_handler();
+    for (const Node& node : config_.node()) {
+      partitions_.emplace(Placement(node), base);
+    }
+    CalculatorGraphConfig& main = partitions_[options_.default_placement];
+    main = config_;
+    main.clear_node();
+
+    // The partition producing each stream and side packet.
+    for (const std::string& stream : config_.input_stream()) {
+      stream_placements_[ParseNameFromStream(stream)] =
+          options_.default_placement;
+    }
+    for (const Node& node : config_.node()) {
+      for (const std::string& stream : node.output_stream()) {
+        stream_placements_[ParseNameFromStream(stream)] = Placement(node);
+      }
+      for (const std::string& side_packet : node.output_side_packet()) {
+        side_packet_placements_[ParseNameFromStream(side_packet)] =
+            Placement(node);
+      }
+    }
+    for (const auto& generator : config_.packet_generator()) {
+      for (const std::string& side_packet : generator.output_side_packet()) {
+        side_packet_placements_[ParseNameFromStream(side_packet)] =
+            options_.default_placement;
+      }
+    }
+
+    for (const Node& node : config_.node()) {
+      const std::string& placement = Placement(node);
+      MP_RETURN_IF_ERROR(CheckSidePackets(node.input_side_packet(), placement));
+      ASSIGN_OR_RETURN(std::set<std::string> back_edges, BackEdges(node));
+      for (const std::string& stream : node.input_stream()) {
+        const std::string name = ParseNameFromStream(stream);
+        const auto producer = stream_placements_.find(name);
+        if (back_edges.count(name) && producer != stream_placements_.end() &&
+            producer->second != placement) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "The back edge \"", name, "\" can't cross partitions."));
+        }
+        MP_RETURN_IF_ERROR(ReceiveStream(name, placement));
+      }
+      *partitions_[placement].add_node() = node;
+    }
+    for (const auto& generator : config_.packet_generator()) {
+      MP_RETURN_IF_ERROR(CheckSidePackets(generator.input_side_packet(),
+                                          options_.default_placement));
+    }
+    for (const auto& handler : config_.status_handler()) {
+      MP_RETURN_IF_ERROR(CheckSidePackets(handler.input_side_packet(),
+                                          options_.default_placement));
+    }
+    for (const std::string& stream : config_.output_stream()) {
+      MP_RETURN_IF_ERROR(ReceiveStream(ParseNameFromStream(stream),
+                                       options_.default_placement));
+    }
+    return std::move(partitions_);
+  }
+
+ private:
+  const std::string& Placement(const Node& node) const {
+    return node.placement().empty() ? options_.default_placement
+                                    : node.placement();
+  }
+
+  // Returns the names of the input streams of `node` that are back edges.
+  absl::StatusOr<std::set<std::string>> BackEdges(const Node& node) {
+    std::set<std::string> result;
+    if (node.input_stream_info().empty()) return result;
+    ASSIGN_OR_RETURN(std::shared_ptr<TagMap> tag_map,
+                     TagMap::Create(node.input_stream()));
+    for (const auto& info : node.input_stream_info()) {
+      if (!info.back_edge()) continue;
+      std::string tag;
+      int index;
+      MP_RETURN_IF_ERROR(ParseTagIndex(info.tag_index(), &tag, &index));
+      const CollectionItemId id = tag_map->GetId(tag, index);
+      RET_CHECK(id.IsValid()) << "Unknown input stream " << info.tag_index();
+      result.insert(tag_map->Names()[id.value()]);
+    }
+    return result;
+  }
+
+  template <typename SidePackets>
+  absl::Status CheckSidePackets(const SidePackets& side_packets,
+                                const std::string& placement) {
+    for (const std::string& side_packet : side_packets) {
+      const std::string name = ParseNameFromStream(side_packet);
+      const auto producer = side_packet_placements_.find(name);
+      if (producer != side_packet_placements_.end() &&
+          producer->second != placement) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "The side packet \"", name, "\" is output in partition \"",
+            producer->second, "\" and used in partition \"", placement,
+            "\", which isn't supported."));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Connects the stream `name` to partition `placement`, unless it is
+  // produced there or was already connected.
+  absl::Status ReceiveStream(const std::string& name,
+                             const std::string& placement) {
+    const auto producer = stream_placements_.find(name);
+    if (producer == stream_placements_.end() ||
+        producer->second == placement) {
+      return absl::OkStatus();
+    }
+    if (!received_streams_.emplace(name, placement).second) {
+      return absl::OkStatus();
+    }
+    const auto host = options_.hosts.find(placement);
+    if (host == options_.hosts.end()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "No host for partition \"", placement, "\", which receives \"",
+          name, "\"."));
+    }
+    const int port = options_.base_port + received_streams_.size() - 1;
+
+    Node* sink = partitions_[producer->second].add_node();
+    sink->set_calculator("NetworkStreamSinkCalculator");
+    sink->add_input_stream(absl::StrCat("IN:", name));
+    auto* sink_options = sink->mutable_options()->MutableExtension(
+        NetworkStreamSinkCalculatorOptions::ext);
+    *sink_options = options_.sink_options;
+    sink_options->set_address(absl::StrCat(host->second, ":", port));
+
+    Node* source = partitions_[placement].add_node();
+    source->set_calculator("NetworkStreamSourceCalculator");
+    source->add_output_stream(absl::StrCat("OUT:", name));
+    source->mutable_options()
+        ->MutableExtension(NetworkStreamSourceCalculatorOptions::ext)
+        ->set_port(port);
+    return absl::OkStatus();
+  }
+
+  const CalculatorGraphConfig& config_;
+  const GraphPartitionOptions& options_;
+  std::map<std::string, CalculatorGraphConfig> partitions_;
+  absl::flat_hash_map<std::string, std::string> stream_placements_;
+  absl::flat_hash_map<std::string, std::string> side_packet_placements_;
+  // The streams received by each partition, as (stream, placement).
+  absl::flat_hash_set<std::pair<std::string, std::string>> received_streams_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::map<std::string, CalculatorGraphConfig>> PartitionGraph(
+    const CalculatorGraphConfig& config, const GraphPartitionOptions& options) {
+  return GraphPartitioner(config, options).Partition();
+}
+
+}  // namespace tool
+}  // namespace mediapipe
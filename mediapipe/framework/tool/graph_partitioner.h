@@ -0,0 +1,68 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_PARTITIONER_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_PARTITIONER_H_
+
+#include <map>
+#include <string>
+
+#include "mediapipe/calculators/core/network_stream_calculator.pb.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+namespace tool {
+
+struct GraphPartitionOptions {
+  // The partition of the nodes without a placement, and of the graph input
+  // and output streams, output side packets, packet generators and status
+  // handlers.
+  std::string default_placement;
+
+  // The host name or address of each partition receiving streams from other
+  // partitions.
+  std::map<std::string, std::string> hosts;
+
+  // The port receiving the first stream crossing partitions. The other
+  // streams crossing partitions are received on the consecutive ports.
+  int base_port = 7600;
+
+  // The options of the NetworkStreamSinkCalculators sending the streams
+  // crossing partitions, other than their address.
+  NetworkStreamSinkCalculatorOptions sink_options;
+};
+
+// Splits `config` into a graph for each placement of its nodes, keyed by
+// placement, such as a graph for a GPU host running a detection model, and
+// one for a CPU host tracking the detections. Each stream consumed in
+// another partition than the one producing it is sent by a
+// NetworkStreamSinkCalculator in the producing partition to a
+// NetworkStreamSourceCalculator in the consuming one, once for each
+// consuming partition. The result only depends on `config` and `options`,
+// so that each host can partition the graph and run its own partition.
+//
+// The graph input side packets are declared in every partition, and must be
+// provided to each one using them. Side packets output by nodes and packet
+// generators, and back edges, can't cross partitions. Subgraph nodes are
+// placed as a whole.
+absl::StatusOr<std::map<std::string, CalculatorGraphConfig>> PartitionGraph(
+    const CalculatorGraphConfig& config, const GraphPartitionOptions& options);
+
+}  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_PARTITIONER_H_
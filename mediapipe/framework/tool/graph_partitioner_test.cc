@@ -0,0 +1,311 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_partitioner.h"
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/util/message_socket.h"
+
+namespace mediapipe {
+namespace tool {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+GraphPartitionOptions PartitionOptions() {
+  GraphPartitionOptions options;
+  options.default_placement = "app";
+  options.hosts = {{"app", "app-host"},
+                   {"gpu", "gpu-host"},
+                   {"cpu", "cpu-host"}};
+  options.base_port = 9000;
+  options.sink_options.set_compression(
+      NetworkStreamSinkCalculatorOptions::ZLIB);
+  return options;
+}
+
+TEST(GraphPartitionerTest, SplitsGraphAtPlacements) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "tracks"
+        input_side_packet: "model"
+        max_queue_size: 2
+        node {
+          calculator: "DetectionCalculator"
+          input_stream: "IMAGE:image"
+          input_side_packet: "MODEL:model"
+          output_stream: "DETECTIONS:detections"
+          placement: "gpu"
+        }
+        node {
+          calculator: "TrackingCalculator"
+          input_stream: "IMAGE:image"
+          input_stream: "DETECTIONS:detections"
+          output_stream: "TRACKS:tracks"
+          placement: "cpu"
+        }
+        node {
+          calculator: "AnalyticsCalculator"
+          input_stream: "DETECTIONS:detections"
+          input_stream: "TRACKS:tracks"
+        }
+      )pb");
+  MP_ASSERT_OK_AND_ASSIGN(auto partitions,
+                          PartitionGraph(config, PartitionOptions()));
+  ASSERT_EQ(partitions.size(), 3);
+
+  CalculatorGraphConfig expected_app =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "image"
+        output_stream: "tracks"
+        input_side_packet: "model"
+        max_queue_size: 2
+        node {
+          calculator: "NetworkStreamSinkCalculator"
+          input_stream: "IN:image"
+          options {
+            [mediapipe.NetworkStreamSinkCalculatorOptions.ext] {
+              address: "gpu-host:9000"
+              compression: ZLIB
+            }
+          }
+        }
+        node {
+          calculator: "NetworkStreamSinkCalculator"
+          input_stream: "IN:image"
+          options {
+            [mediapipe.NetworkStreamSinkCalculatorOptions.ext] {
+              address: "cpu-host:9001"
+              compression: ZLIB
+            }
+          }
+        }
+        node {
+          calculator: "NetworkStreamSourceCalculator"
+          output_stream: "OUT:detections"
+          options {
+            [mediapipe.NetworkStreamSourceCalculatorOptions.ext] { port: 9003 }
+          }
+        }
+        node {
+          calculator: "NetworkStreamSourceCalculator"
+          output_stream: "OUT:tracks"
+          options {
+            [mediapipe.NetworkStreamSourceCalculatorOptions.ext] { port: 9004 }
+          }
+        }
+        node {
+          calculator: "AnalyticsCalculator"
+          input_stream: "DETECTIONS:detections"
+          input_stream: "TRACKS:tracks"
+        }
+      )pb");
+  EXPECT_THAT(partitions["app"], EqualsProto(expected_app));
+
+  CalculatorGraphConfig expected_gpu =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_side_packet: "model"
+        max_queue_size: 2
+        node {
+          calculator: "NetworkStreamSourceCalculator"
+          output_stream: "OUT:image"
+          options {
+            [mediapipe.NetworkStreamSourceCalculatorOptions.ext] { port: 9000 }
+          }
+        }
+        node {
+          calculator: "DetectionCalculator"
+          input_stream: "IMAGE:image"
+          input_side_packet: "MODEL:model"
+          output_stream: "DETECTIONS:detections"
+          placement: "gpu"
+        }
+        node {
+          calculator: "NetworkStreamSinkCalculator"
+          input_stream: "IN:detections"
+          options {
+            [mediapipe.NetworkStreamSinkCalculatorOptions.ext] {
+              address: "cpu-host:9002"
+              compression: ZLIB
+            }
+          }
+        }
+        node {
+          calculator: "NetworkStreamSinkCalculator"
+          input_stream: "IN:detections"
+          options {
+            [mediapipe.NetworkStreamSinkCalculatorOptions.ext] {
+              address: "app-host:9003"
+              compression: ZLIB
+            }
+          }
+        }
+      )pb");
+  EXPECT_THAT(partitions["gpu"], EqualsProto(expected_gpu));
+
+  CalculatorGraphConfig expected_cpu =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_side_packet: "model"
+        max_queue_size: 2
+        node {
+          calculator: "NetworkStreamSourceCalculator"
+          output_stream: "OUT:image"
+          options {
+            [mediapipe.NetworkStreamSourceCalculatorOptions.ext] { port: 9001 }
+          }
+        }
+        node {
+          calculator: "NetworkStreamSourceCalculator"
+          output_stream: "OUT:detections"
+          options {
+            [mediapipe.NetworkStreamSourceCalculatorOptions.ext] { port: 9002 }
+          }
+        }
+        node {
+          calculator: "TrackingCalculator"
+          input_stream: "IMAGE:image"
+          input_stream: "DETECTIONS:detections"
+          output_stream: "TRACKS:tracks"
+          placement: "cpu"
+        }
+        node {
+          calculator: "NetworkStreamSinkCalculator"
+          input_stream: "IN:tracks"
+          options {
+            [mediapipe.NetworkStreamSinkCalculatorOptions.ext] {
+              address: "app-host:9004"
+              compression: ZLIB
+            }
+          }
+        }
+      )pb");
+  EXPECT_THAT(partitions["cpu"], EqualsProto(expected_cpu));
+}
+
+TEST(GraphPartitionerTest, RejectsSidePacketsAndBackEdgesAcrossPartitions) {
+  CalculatorGraphConfig side_packet_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node {
+          calculator: "ModelLoaderCalculator"
+          output_side_packet: "MODEL:model"
+        }
+        node {
+          calculator: "InferenceCalculator"
+          input_side_packet: "MODEL:model"
+          placement: "gpu"
+        }
+      )pb");
+  EXPECT_THAT(PartitionGraph(side_packet_config, PartitionOptions()).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("\"model\"")));
+
+  CalculatorGraphConfig back_edge_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        node {
+          calculator: "LoopCalculator"
+          input_stream: "in"
+          input_stream: "FEEDBACK:feedback"
+          input_stream_info { tag_index: "FEEDBACK" back_edge: true }
+          output_stream: "out"
+        }
+        node {
+          calculator: "FeedbackCalculator"
+          input_stream: "out"
+          output_stream: "feedback"
+          placement: "gpu"
+        }
+      )pb");
+  EXPECT_THAT(PartitionGraph(back_edge_config, PartitionOptions()).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("\"feedback\"")));
+}
+
+TEST(GraphPartitionerTest, RunsPartitions) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        output_stream: "out"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "in"
+          output_stream: "remote"
+          placement: "remote"
+        }
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "remote"
+          output_stream: "out"
+        }
+      )pb");
+  GraphPartitionOptions options;
+  options.default_placement = "app";
+  options.hosts = {{"app", "localhost"}, {"remote", "localhost"}};
+  // Two consecutive free ports.
+  for (options.base_port = 20000; options.base_port < 30000;
+       options.base_port += 2) {
+    if (MessageSocket::Listen(options.base_port).ok() &&
+        MessageSocket::Listen(options.base_port + 1).ok()) {
+      break;
+    }
+  }
+  MP_ASSERT_OK_AND_ASSIGN(auto partitions, PartitionGraph(config, options));
+
+  CalculatorGraph remote_graph(partitions["remote"]);
+  MP_ASSERT_OK(remote_graph.StartRun({}));
+  CalculatorGraph app_graph(partitions["app"]);
+  std::vector<Packet> packets;
+  MP_ASSERT_OK(app_graph.ObserveOutputStream("out", [&](const Packet& p) {
+    packets.push_back(p);
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(app_graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    NormalizedRect rect;
+    rect.set_x_center(0.5f);
+    rect.set_y_center(0.5f);
+    rect.set_width(1.0f);
+    rect.set_height(1.0f);
+    rect.set_rect_id(i);
+    MP_ASSERT_OK(app_graph.AddPacketToInputStream(
+        "in", MakePacket<NormalizedRect>(rect).At(Timestamp(i * 10))));
+  }
+  MP_ASSERT_OK(app_graph.CloseAllInputStreams());
+  MP_ASSERT_OK(app_graph.WaitUntilDone());
+  MP_ASSERT_OK(remote_graph.WaitUntilDone());
+
+  std::vector<int> ids;
+  std::vector<int64_t> timestamps;
+  for (const Packet& packet : packets) {
+    ids.push_back(packet.Get<NormalizedRect>().rect_id());
+    timestamps.push_back(packet.Timestamp().Value());
+  }
+  EXPECT_THAT(ids, ElementsAre(0, 1, 2));
+  EXPECT_THAT(timestamps, ElementsAre(0, 10, 20));
+}
+
+}  // namespace
+}  // namespace tool
+}  // namespace mediapipe
@@ -13,6 +13,13 @@ Example:
     ]
   )
 
+With expand_graph = True, the output is the canonical config of the graph, with
+its subgraphs expanded, which initializes faster. The deps must then include
+all the calculators and subgraphs of the graph.
+
+mediapipe_static_graph() generates a C++ class running a graph with a fixed
+topology, from its config expanded at build time.
+
 """
 
 load("//mediapipe/framework:encode_binary_proto.bzl", "encode_binary_proto", "generate_proto_descriptor_set")
@@ -22,7 +29,7 @@ load("//mediapipe/framework/tool:build_defs.bzl", "clean_dep")
 load("//mediapipe/framework/deps:descriptor_set.bzl", "direct_descriptor_set", "transitive_descriptor_set")
 load("@org_tensorflow//tensorflow/lite/core/shims:cc_library_with_tflite.bzl", "cc_library_with_tflite")
 
-def mediapipe_binary_graph(name, graph = None, output_name = None, deps = [], testonly = False, **kwargs):
+def mediapipe_binary_graph(name, graph = None, output_name = None, deps = [], expand_graph = False, testonly = False, **kwargs):
     """Converts a graph from text format to binary format."""
 
     if not graph:
@@ -44,7 +51,7 @@ def mediapipe_binary_graph(name, graph = None, output_name = None, deps = [], te
         deps = [
             clean_dep("//mediapipe/framework/tool:text_to_binary_graph"),
             name + "_gather_cc_protos",
-        ],
+        ] + (deps if expand_graph else []),
         tags = ["manual"],
         testonly = testonly,
     )
@@ -57,7 +64,8 @@ def mediapipe_binary_graph(name, graph = None, output_name = None, deps = [], te
         cmd = (
             "$(location " + name + "_text_to_binary_graph" + ") " +
             ("--proto_source=$(location %s) " % graph) +
-            ("--proto_output=\"$@\" ")
+            ("--proto_output=\"$@\" ") +
+            ("--expand_graph " if expand_graph else "")
         ),
         tools = [name + "_text_to_binary_graph"],
         testonly = testonly,
@@ -175,6 +183,82 @@ def mediapipe_simple_subgraph(
             **kwargs
         )
 
+def mediapipe_static_graph(
+        name,
+        class_name,
+        graph,
+        namespace = "mediapipe",
+        deps = [],
+        visibility = None,
+        testonly = None,
+        **kwargs):
+    """Defines a C++ class running a graph whose topology is fixed at build time.
+
+    The graph is expanded and validated at build time, and embedded in the
+    class, which initializes it without parsing or expanding it. The class has
+    an enumerator and named methods for each graph input and output stream,
+    and adds packets through input stream handles resolved once, rather than
+    looking the streams up by name. The header is "<package>/<name>.h".
+
+    Args:
+      name: name of the cc_library target to define.
+      class_name: name of the generated class.
+      graph: the BUILD label of a text-format MediaPipe graph.
+      namespace: namespace of the generated class, such as "foo::bar".
+      deps: the calculators and subgraphs used by the graph.
+      visibility: The list of packages the library should be visible to.
+      testonly: pass 1 if the graph is to be used only for tests.
+      **kwargs: Remaining keyword args, forwarded to cc_library.
+    """
+    mediapipe_binary_graph(
+        name = name + "_graph",
+        graph = graph,
+        output_name = name + ".binarypb",
+        deps = deps,
+        expand_graph = True,
+        testonly = testonly,
+    )
+    data_as_c_string(
+        name = name + "_inc",
+        srcs = [name + ".binarypb"],
+        outs = [name + ".inc"],
+        testonly = testonly,
+    )
+    generator = clean_dep("//mediapipe/framework/tool:static_graph_generator")
+    native.genrule(
+        name = name + "_cc",
+        srcs = [name + ".binarypb"],
+        outs = [name + ".h", name + ".cc"],
+        cmd = (
+            "$(location " + generator + ") " +
+            ("--graph=$(location %s.binarypb) " % name) +
+            ("--class_name=%s " % class_name) +
+            ("--namespace=%s " % namespace) +
+            ("--header_path=%s/%s.h " % (native.package_name(), name)) +
+            ("--inc_path=%s/%s.inc " % (native.package_name(), name)) +
+            ("--header_output=$(location %s.h) " % name) +
+            ("--source_output=$(location %s.cc)" % name)
+        ),
+        tools = [generator],
+        testonly = testonly,
+    )
+    native.cc_library(
+        name = name,
+        srcs = [
+            name + ".cc",
+            name + ".inc",
+        ],
+        hdrs = [name + ".h"],
+        deps = [
+            clean_dep("//mediapipe/framework:calculator_framework"),
+            "@com_google_absl//absl/status",
+            "@com_google_absl//absl/status:statusor",
+        ] + deps,
+        visibility = visibility,
+        testonly = testonly,
+        **kwargs
+    )
+
 def mediapipe_reexport_library(
         name,
         actual,
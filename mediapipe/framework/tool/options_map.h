@@ -80,19 +80,27 @@ void SetNodeOptions(CalculatorGraphConfig::Node& node_config, const T& value) {
 #endif
 }
 
-// A map from object type to object.
+// A map from object type to object. Copies share the objects already
+// created.
 class TypeMap {
  public:
   template <class T>
   bool Has() const {
     return content_.count(kTypeId<T>) > 0;
   }
+  // Returns the object of type T, or nullptr if there is none yet.
+  template <class T>
+  T* Find() const {
+    auto it = content_.find(kTypeId<T>);
+    return it == content_.end() ? nullptr : static_cast<T*>(it->second.get());
+  }
   template <class T>
   T* Get() const {
-    if (!Has<T>()) {
-      content_[kTypeId<T>] = std::make_shared<T>();
+    std::shared_ptr<void>& content = content_[kTypeId<T>];
+    if (!content) {
+      content = std::make_shared<T>();
     }
-    return static_cast<T*>(content_[kTypeId<T>].get());
+    return static_cast<T*>(content.get());
   }
 
  private:
@@ -100,7 +108,8 @@ class TypeMap {
 };
 
 // Extracts the options message of a specified type from a
-// CalculatorGraphConfig::Node.
+// CalculatorGraphConfig::Node. Each type is unpacked once, on first access, and
+// copies of the OptionsMap reuse the messages unpacked so far.
 class OptionsMap {
  public:
   OptionsMap& Initialize(const CalculatorGraphConfig::Node& node_config) {
@@ -112,8 +121,8 @@ class OptionsMap {
   // either "options" or "node_options" using either GetExtension or UnpackTo.
   template <class T>
   const T& Get() const {
-    if (options_.Has<T>()) {
-      return *options_.Get<T>();
+    if (const T* cached = options_.Find<T>()) {
+      return *cached;
     }
     T* result = options_.Get<T>();
     if (node_config_->has_options()) {
@@ -146,8 +155,8 @@ class MutableOptionsMap : public OptionsMap {
 
   template <class T>
   T* GetMutable() const {
-    if (options_.Has<T>()) {
-      return options_.Get<T>();
+    if (T* cached = options_.Find<T>()) {
+      return cached;
     }
     if (node_config_->has_options()) {
       return GetExtension<T>(*node_config_->mutable_options());
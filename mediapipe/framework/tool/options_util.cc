@@ -1,10 +1,15 @@
 
 #include "mediapipe/framework/tool/options_util.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <variant>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -31,6 +36,8 @@ using options_field_util::GetNodeOptions;
 using options_field_util::MergeFieldValues;
 using options_field_util::MergeMessages;
 
+namespace {
+
 // Returns the type for the root options message if specified.
 std::string ExtensionType(const std::string& option_fields_tag) {
   OptionsSyntaxUtil syntax_util;
@@ -55,6 +62,37 @@ std::string MessageType(FieldData message) {
       std::string(message.message_value().type_url()));
 }
 
+// Parses each option tag of a graph once, and each field path once per
+// message type. The returned references stay valid as entries are added.
+class OptionPathCache {
+ public:
+  const std::string& GetExtensionType(const std::string& tag) {
+    auto it = extension_types_.find(tag);
+    if (it == extension_types_.end()) {
+      it = extension_types_.emplace(tag, ExtensionType(tag)).first;
+    }
+    return it->second;
+  }
+
+  const FieldPath& GetFieldPath(const std::string& tag,
+                                const std::string& message_type) {
+    auto key = std::make_pair(tag, message_type);
+    auto it = field_paths_.find(key);
+    if (it == field_paths_.end()) {
+      it = field_paths_.emplace(std::move(key), GetPath(tag, message_type))
+               .first;
+    }
+    return it->second;
+  }
+
+ private:
+  absl::node_hash_map<std::string, std::string> extension_types_;
+  absl::node_hash_map<std::pair<std::string, std::string>, FieldPath>
+      field_paths_;
+};
+
+}  // namespace
+
 // Assigns the value from a StatusOr if avialable.
 #define ASSIGN_IF_OK(lhs, rexpr) \
   {                              \
@@ -65,45 +103,76 @@ std::string MessageType(FieldData message) {
   }
 
 // Copy literal options from graph_options to node_options.
-absl::Status CopyLiteralOptions(CalculatorGraphConfig::Node parent_node,
+absl::Status CopyLiteralOptions(const CalculatorGraphConfig::Node& parent_node,
                                 CalculatorGraphConfig* config) {
   absl::Status status;
   FieldData graph_data = options_field_util::AsFieldData(*config);
   FieldData parent_data = options_field_util::AsFieldData(parent_node);
 
   OptionsSyntaxUtil syntax_util;
+  OptionPathCache path_cache;
+  // The graph options merged with the parent node options, by extension type.
+  absl::flat_hash_map<std::string, FieldData> graph_options_by_type;
   for (auto& node : *config->mutable_node()) {
+    if (node.option_value().empty()) continue;
+    FieldData node_data = options_field_util::AsFieldData(node);
+    // The node options are unpacked once per extension type, updated by all
+    // the option values, and packed once.
+    absl::flat_hash_map<std::string, FieldData> node_options_by_type;
+    std::vector<std::string> updated_types;
     for (const std::string& option_def : node.option_value()) {
-      FieldData node_data = options_field_util::AsFieldData(node);
-
       std::vector<absl::string_view> tag_and_name =
           syntax_util.StrSplitTags(option_def);
       std::string graph_tag = syntax_util.OptionFieldsTag(tag_and_name[1]);
-      std::string graph_extension_type = ExtensionType(graph_tag);
+      const std::string& graph_extension_type =
+          path_cache.GetExtensionType(graph_tag);
       std::string node_tag = syntax_util.OptionFieldsTag(tag_and_name[0]);
-      std::string node_extension_type = ExtensionType(node_tag);
-      FieldData graph_options;
-      ASSIGN_IF_OK(graph_options,
-                   GetGraphOptions(graph_data, graph_extension_type));
-      FieldData parent_options;
-      ASSIGN_IF_OK(parent_options,
-                   GetNodeOptions(parent_data, graph_extension_type));
-      ASSIGN_OR_RETURN(graph_options,
-                       MergeMessages(graph_options, parent_options));
-      FieldData node_options;
-      ASSIGN_OR_RETURN(node_options,
-                       GetNodeOptions(node_data, node_extension_type));
+      const std::string& node_extension_type =
+          path_cache.GetExtensionType(node_tag);
+      auto graph_it = graph_options_by_type.find(graph_extension_type);
+      if (graph_it == graph_options_by_type.end()) {
+        FieldData graph_options;
+        ASSIGN_IF_OK(graph_options,
+                     GetGraphOptions(graph_data, graph_extension_type));
+        FieldData parent_options;
+        ASSIGN_IF_OK(parent_options,
+                     GetNodeOptions(parent_data, graph_extension_type));
+        ASSIGN_OR_RETURN(graph_options,
+                         MergeMessages(graph_options, parent_options));
+        graph_it = graph_options_by_type
+                       .emplace(graph_extension_type, std::move(graph_options))
+                       .first;
+      }
+      const FieldData& graph_options = graph_it->second;
+      auto node_it = node_options_by_type.find(node_extension_type);
+      if (node_it == node_options_by_type.end()) {
+        FieldData node_options;
+        ASSIGN_OR_RETURN(node_options,
+                         GetNodeOptions(node_data, node_extension_type));
+        node_it = node_options_by_type
+                      .emplace(node_extension_type, std::move(node_options))
+                      .first;
+      }
+      FieldData& node_options = node_it->second;
       if (!node_options.has_message_value() ||
           !graph_options.has_message_value()) {
         continue;
       }
-      FieldPath graph_path = GetPath(graph_tag, MessageType(graph_options));
-      FieldPath node_path = GetPath(node_tag, MessageType(node_options));
+      const FieldPath& graph_path =
+          path_cache.GetFieldPath(graph_tag, MessageType(graph_options));
+      const FieldPath& node_path =
+          path_cache.GetFieldPath(node_tag, MessageType(node_options));
       std::vector<FieldData> packet_data;
       ASSIGN_OR_RETURN(packet_data, GetFieldValues(graph_options, graph_path));
       MP_RETURN_IF_ERROR(
           MergeFieldValues(node_options, node_path, packet_data));
-      options_field_util::SetOptionsMessage(node_options, &node);
+      if (std::find(updated_types.begin(), updated_types.end(),
+                    node_extension_type) == updated_types.end()) {
+        updated_types.push_back(node_extension_type);
+      }
+    }
+    for (const std::string& type : updated_types) {
+      options_field_util::SetOptionsMessage(node_options_by_type[type], &node);
     }
     node.clear_option_value();
   }
@@ -154,6 +154,43 @@ TEST_F(OptionsUtilTest, CopyLiteralOptions) {
   MakePacket<NightLightCalculatorOptions>();
 }
 
+// Shows several option values of a node being copied from graph options.
+TEST_F(OptionsUtilTest, CopyLiteralOptionsForSeveralFields) {
+  CalculatorGraphConfig subgraph_config;
+
+  auto node = subgraph_config.add_node();
+  *node->mutable_calculator() = "NightLightCalculator";
+  *node->add_option_value() = "num_lights:options/chain_length";
+  *node->add_option_value() = "format_string:options/node_type";
+  NightLightCalculatorOptions node_options;
+  node_options.set_jitter(0.5);
+  node->add_node_options()->PackFrom(node_options);
+
+  NodeChainSubgraphOptions options;
+  options.set_chain_length(8);
+  options.set_node_type("night");
+  subgraph_config.add_graph_options()->PackFrom(options);
+  subgraph_config.set_type("NightSubgraph");
+
+  CalculatorGraphConfig graph_config;
+  node = graph_config.add_node();
+  *node->mutable_calculator() = "NightSubgraph";
+
+  CalculatorGraph graph;
+  graph_config.set_num_threads(4);
+  MP_ASSERT_OK(graph.Initialize({subgraph_config, graph_config}, {}, {}));
+
+  CalculatorGraphConfig::Node expected_node;
+  expected_node.set_name("nightsubgraph__NightLightCalculator");
+  expected_node.set_calculator("NightLightCalculator");
+  NightLightCalculatorOptions expected_node_options;
+  expected_node_options.set_jitter(0.5);
+  expected_node_options.add_num_lights(8);
+  expected_node_options.set_format_string("night");
+  expected_node.add_node_options()->PackFrom(expected_node_options);
+  EXPECT_THAT(graph.Config().node(0), EqualsProto(expected_node));
+}
+
 // Retrieves the description of a protobuf message and a nested protobuf message
 // from the OptionsRegistry.
 TEST_F(OptionsUtilTest, GetProtobufDescriptorRegistered) {
@@ -0,0 +1,363 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/packet_recording.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/deps/monotonic_clock.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/type_map.h"
+
+namespace mediapipe {
+namespace tool {
+namespace {
+
+std::shared_ptr<Clock> ClockOrDefault(std::shared_ptr<Clock> clock) {
+  if (clock) return clock;
+  return std::shared_ptr<Clock>(
+      MonotonicClock::CreateSynchronizedMonotonicClock());
+}
+
+// Stores the pixels of `frame` contiguously.
+void EncodeImageFrame(const ImageFrame& frame, RecordedPacket* recorded) {
+  recorded->set_format(frame.Format());
+  recorded->add_dims(frame.Width());
+  recorded->add_dims(frame.Height());
+  const int row_size =
+      frame.Width() * frame.NumberOfChannels() * frame.ByteDepth();
+  std::string* data = recorded->mutable_data();
+  data->resize(frame.PixelDataSizeStoredContiguously());
+  for (int y = 0; y < frame.Height(); ++y) {
+    std::memcpy(&(*data)[y * row_size],
+                frame.PixelData() + y * frame.WidthStep(), row_size);
+  }
+}
+
+absl::StatusOr<std::unique_ptr<ImageFrame>> DecodeImageFrame(
+    const RecordedPacket& recorded) {
+  RET_CHECK(ImageFormat::Format_IsValid(recorded.format()));
+  RET_CHECK_EQ(recorded.dims_size(), 2);
+  const auto format = static_cast<ImageFormat::Format>(recorded.format());
+  const int width = recorded.dims(0);
+  const int height = recorded.dims(1);
+  RET_CHECK_EQ(recorded.data().size(),
+               static_cast<size_t>(width) * height *
+                   ImageFrame::NumberOfChannelsForFormat(format) *
+                   ImageFrame::ByteDepthForFormat(format));
+  auto frame = std::make_unique<ImageFrame>();
+  frame->CopyPixelData(format, width, height,
+                       reinterpret_cast<const uint8*>(recorded.data().data()),
+                       ImageFrame::kDefaultAlignmentBoundary);
+  return frame;
+}
+
+void EncodeTensor(const Tensor& tensor, RecordedPacket* recorded) {
+  recorded->set_format(static_cast<int>(tensor.element_type()));
+  for (int dim : tensor.shape().dims) recorded->add_dims(dim);
+  recorded->set_quantization_scale(tensor.quantization_parameters().scale);
+  recorded->set_quantization_zero_point(
+      tensor.quantization_parameters().zero_point);
+  auto view = tensor.GetCpuReadView();
+  recorded->set_data(view.buffer<char>(), tensor.bytes());
+}
+
+absl::StatusOr<Packet> DecodeTensor(const RecordedPacket& recorded) {
+  RET_CHECK(recorded.format() >= 0 &&
+            recorded.format() <= static_cast<int>(Tensor::ElementType::kBool));
+  Tensor tensor(static_cast<Tensor::ElementType>(recorded.format()),
+                Tensor::Shape(std::vector<int>(recorded.dims().begin(),
+                                               recorded.dims().end())),
+                Tensor::QuantizationParameters(
+                    recorded.quantization_scale(),
+                    recorded.quantization_zero_point()));
+  RET_CHECK_EQ(recorded.data().size(), tensor.bytes());
+  {
+    auto view = tensor.GetCpuWriteView();
+    std::memcpy(view.buffer<char>(), recorded.data().data(), tensor.bytes());
+  }
+  return MakePacket<Tensor>(std::move(tensor));
+}
+
+// Returns the p-th percentile of the sorted `values`, by nearest rank.
+absl::Duration Percentile(const std::vector<absl::Duration>& values,
+                          double p) {
+  const int rank = static_cast<int>(std::ceil(p / 100 * values.size()));
+  return values[std::max(rank - 1, 0)];
+}
+
+}  // namespace
+
+absl::Status EncodeRecordedPacket(const Packet& packet,
+                                  RecordedPacket* recorded) {
+  recorded->set_timestamp(packet.Timestamp().Value());
+  if (packet.ValidateAsType<ImageFrame>().ok()) {
+    recorded->set_encoding(RecordedPacket::IMAGE_FRAME);
+    EncodeImageFrame(packet.Get<ImageFrame>(), recorded);
+  } else if (packet.ValidateAsType<Image>().ok()) {
+    const Image& image = packet.Get<Image>();
+    RET_CHECK(!image.UsesGpu()) << "GPU images can't be recorded.";
+    recorded->set_encoding(RecordedPacket::IMAGE);
+    EncodeImageFrame(*image.GetImageFrameSharedPtr(), recorded);
+  } else if (packet.ValidateAsType<Tensor>().ok()) {
+    recorded->set_encoding(RecordedPacket::TENSOR);
+    EncodeTensor(packet.Get<Tensor>(), recorded);
+  } else if (packet.ValidateAsProtoMessageLite().ok()) {
+    const proto_ns::MessageLite& message = packet.GetProtoMessageLite();
+    recorded->set_encoding(RecordedPacket::PROTO);
+    recorded->set_type_name(message.GetTypeName());
+    RET_CHECK(message.SerializeToString(recorded->mutable_data()));
+  } else {
+    const MediaPipeTypeData* type_data =
+        PacketTypeIdToMediaPipeTypeData::GetValue(
+            packet.GetTypeId().hash_code());
+    if (type_data == nullptr || !type_data->serialize_fn ||
+        !type_data->deserialize_fn) {
+      return absl::UnimplementedError(absl::StrCat(
+          "Packets of type ", packet.DebugTypeName(), " can't be recorded."));
+    }
+    recorded->set_encoding(RecordedPacket::REGISTERED_TYPE);
+    recorded->set_type_name(type_data->type_string);
+    MP_RETURN_IF_ERROR(type_data->serialize_fn(
+        *packet_internal::GetHolder(packet), recorded->mutable_data()));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Packet> DecodeRecordedPacket(const RecordedPacket& recorded) {
+  Packet packet;
+  switch (recorded.encoding()) {
+    case RecordedPacket::IMAGE_FRAME: {
+      ASSIGN_OR_RETURN(std::unique_ptr<ImageFrame> frame,
+                       DecodeImageFrame(recorded));
+      packet = Adopt(frame.release());
+      break;
+    }
+    case RecordedPacket::IMAGE: {
+      ASSIGN_OR_RETURN(std::unique_ptr<ImageFrame> frame,
+                       DecodeImageFrame(recorded));
+      packet =
+          MakePacket<Image>(std::shared_ptr<ImageFrame>(std::move(frame)));
+      break;
+    }
+    case RecordedPacket::TENSOR: {
+      ASSIGN_OR_RETURN(packet, DecodeTensor(recorded));
+      break;
+    }
+    case RecordedPacket::PROTO: {
+      ASSIGN_OR_RETURN(packet, packet_internal::PacketFromDynamicProto(
+                                   recorded.type_name(), recorded.data()));
+      break;
+    }
+    case RecordedPacket::REGISTERED_TYPE: {
+      const MediaPipeTypeData* type_data =
+          PacketTypeStringToMediaPipeTypeData::GetValue(recorded.type_name());
+      RET_CHECK(type_data != nullptr && type_data->deserialize_fn)
+          << "No deserialization function for " << recorded.type_name();
+      std::unique_ptr<packet_internal::HolderBase> holder;
+      MP_RETURN_IF_ERROR(type_data->deserialize_fn(recorded.data(), &holder));
+      packet = packet_internal::Create(holder.release());
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown packet encoding ", recorded.encoding()));
+  }
+  return packet.At(Timestamp::CreateNoErrorChecking(recorded.timestamp()));
+}
+
+PacketRecorder::PacketRecorder(std::shared_ptr<Clock> clock)
+    : clock_(ClockOrDefault(std::move(clock))) {}
+
+void PacketRecorder::RecordInputStreams(CalculatorGraph* graph) {
+  graph->ObserveInputStreams(
+      [this](const std::string& stream_name, const Packet& packet) {
+        absl::Status status = Record(stream_name, packet);
+        if (!status.ok()) {
+          absl::MutexLock lock(&mutex_);
+          status_.Update(status);
+        }
+      });
+}
+
+absl::Status PacketRecorder::Record(const std::string& stream_name,
+                                    const Packet& packet) {
+  // Encoding is done outside of the lock, so that streams added from
+  // several threads don't wait for each other's copies.
+  const absl::Time arrival_time = clock_->TimeNow();
+  RecordedPacket recorded;
+  MP_RETURN_IF_ERROR(EncodeRecordedPacket(packet, &recorded));
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] =
+      stream_indices_.emplace(stream_name, recording_.stream_name_size());
+  if (inserted) recording_.add_stream_name(stream_name);
+  if (start_time_ == absl::InfinitePast()) start_time_ = arrival_time;
+  recorded.set_stream_index(it->second);
+  recorded.set_arrival_usec(
+      absl::ToInt64Microseconds(arrival_time - start_time_));
+  *recording_.add_packet() = std::move(recorded);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<PacketRecording> PacketRecorder::GetRecording() const {
+  absl::MutexLock lock(&mutex_);
+  MP_RETURN_IF_ERROR(status_);
+  return recording_;
+}
+
+absl::Status WritePacketRecording(const PacketRecording& recording,
+                                  const std::string& path) {
+  return file::SetContents(path, recording.SerializeAsString());
+}
+
+absl::StatusOr<PacketRecording> ReadPacketRecording(const std::string& path) {
+  std::string contents;
+  MP_RETURN_IF_ERROR(file::GetContents(path, &contents));
+  PacketRecording recording;
+  RET_CHECK(recording.ParseFromString(contents))
+      << "Invalid packet recording: " << path;
+  return recording;
+}
+
+namespace {
+
+// The timings collected during a replay. Shared with the output stream
+// callbacks, which stay attached to the graph after the replay.
+struct ReplayTimings {
+  struct Output {
+    int64_t num_packets = 0;
+    absl::Time last_time = absl::InfinitePast();
+    std::vector<absl::Duration> latencies;
+  };
+
+  absl::Mutex mutex;
+  // The time the first input packet of each timestamp was added.
+  absl::flat_hash_map<int64_t, absl::Time> input_times ABSL_GUARDED_BY(mutex);
+  std::vector<Output> outputs ABSL_GUARDED_BY(mutex);
+};
+
+// Adds the packets of `recording` to the graph input streams.
+absl::Status AddRecordedPackets(const PacketRecording& recording,
+                                const ReplayOptions& options, Clock* clock,
+                                ReplayTimings* timings,
+                                CalculatorGraph* graph) {
+  std::vector<CalculatorGraph::GraphInputStreamHandle> streams;
+  for (const std::string& stream_name : recording.stream_name()) {
+    ASSIGN_OR_RETURN(CalculatorGraph::GraphInputStreamHandle stream,
+                     graph->GetInputStreamHandle(stream_name));
+    streams.push_back(stream);
+  }
+  const absl::Time start_time = clock->TimeNow();
+  for (const RecordedPacket& recorded : recording.packet()) {
+    RET_CHECK(recorded.stream_index() >= 0 &&
+              recorded.stream_index() < streams.size());
+    ASSIGN_OR_RETURN(Packet packet, DecodeRecordedPacket(recorded));
+    if (options.recorded_pace) {
+      clock->SleepUntil(start_time +
+                        absl::Microseconds(recorded.arrival_usec()));
+    }
+    {
+      absl::MutexLock lock(&timings->mutex);
+      timings->input_times.emplace(packet.Timestamp().Value(),
+                                   clock->TimeNow());
+    }
+    MP_RETURN_IF_ERROR(graph->AddPacketToInputStream(
+        streams[recorded.stream_index()], std::move(packet)));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<std::map<std::string, ReplayStreamStats>> ReplayPacketRecording(
+    const PacketRecording& recording, const ReplayOptions& options,
+    CalculatorGraph* graph) {
+  std::shared_ptr<Clock> clock = ClockOrDefault(options.clock);
+  auto timings = std::make_shared<ReplayTimings>();
+  {
+    absl::MutexLock lock(&timings->mutex);
+    timings->outputs.resize(options.output_streams.size());
+  }
+  for (int i = 0; i < options.output_streams.size(); ++i) {
+    MP_RETURN_IF_ERROR(graph->ObserveOutputStream(
+        options.output_streams[i], [clock, timings, i](const Packet& packet) {
+          const absl::Time now = clock->TimeNow();
+          absl::MutexLock lock(&timings->mutex);
+          ReplayTimings::Output& output = timings->outputs[i];
+          ++output.num_packets;
+          output.last_time = now;
+          auto it = timings->input_times.find(packet.Timestamp().Value());
+          if (it != timings->input_times.end()) {
+            output.latencies.push_back(now - it->second);
+          }
+          return absl::OkStatus();
+        }));
+  }
+
+  MP_RETURN_IF_ERROR(graph->StartRun(options.input_side_packets));
+  const absl::Time start_time = clock->TimeNow();
+  absl::Status status =
+      AddRecordedPackets(recording, options, clock.get(), timings.get(), graph);
+  if (status.ok()) {
+    status = graph->CloseAllInputStreams();
+  } else {
+    graph->CloseAllPacketSources().IgnoreError();
+  }
+  status.Update(graph->WaitUntilDone());
+  MP_RETURN_IF_ERROR(status);
+
+  std::map<std::string, ReplayStreamStats> result;
+  absl::MutexLock lock(&timings->mutex);
+  for (int i = 0; i < options.output_streams.size(); ++i) {
+    ReplayTimings::Output& output = timings->outputs[i];
+    ReplayStreamStats& stats = result[options.output_streams[i]];
+    stats.num_packets = output.num_packets;
+    if (output.last_time > start_time) {
+      stats.packets_per_second =
+          output.num_packets /
+          absl::ToDoubleSeconds(output.last_time - start_time);
+    }
+    std::vector<absl::Duration>& latencies = output.latencies;
+    stats.num_latencies = latencies.size();
+    if (latencies.empty()) continue;
+    std::sort(latencies.begin(), latencies.end());
+    absl::Duration total;
+    for (absl::Duration latency : latencies) total += latency;
+    stats.latency_mean = total / latencies.size();
+    stats.latency_p50 = Percentile(latencies, 50);
+    stats.latency_p90 = Percentile(latencies, 90);
+    stats.latency_p99 = Percentile(latencies, 99);
+    stats.latency_max = latencies.back();
+  }
+  return result;
+}
+
+}  // namespace tool
+}  // namespace mediapipe
@@ -0,0 +1,144 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Recording and replay of the packets added to the graph input streams, to
+// benchmark a graph end to end on realistic inputs.
+//
+// A PacketRecorder records the packets of a run of a graph, such as from a
+// camera, with the times they arrived at the graph:
+//
+//   tool::PacketRecorder recorder;
+//   recorder.RecordInputStreams(&graph);
+//   ... run the graph ...
+//   ASSIGN_OR_RETURN(PacketRecording recording, recorder.GetRecording());
+//   MP_RETURN_IF_ERROR(tool::WritePacketRecording(recording, path));
+//
+// ReplayPacketRecording() then feeds the recording to a graph, at the
+// recorded pace or as fast as the graph takes the packets, and measures the
+// latency and throughput of its output streams. Running the replayed graph
+// on a SimulationClockExecutor, with its clock in ReplayOptions, makes the
+// timings deterministic.
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_PACKET_RECORDING_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_PACKET_RECORDING_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/deps/clock.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/tool/packet_recording.pb.h"
+
+namespace mediapipe {
+namespace tool {
+
+// Stores `packet` into `recorded`, except for its stream and arrival time.
+// Supports ImageFrame, CPU Image, Tensor, proto messages, and the types
+// registered with serialization functions.
+absl::Status EncodeRecordedPacket(const Packet& packet,
+                                  RecordedPacket* recorded);
+
+// Returns the packet stored by EncodeRecordedPacket(), with its timestamp.
+absl::StatusOr<Packet> DecodeRecordedPacket(const RecordedPacket& recorded);
+
+// Records packets with their arrival times. Thread-safe.
+class PacketRecorder {
+ public:
+  // Measures arrival times with `clock`, or a monotonic real-time clock if
+  // null.
+  explicit PacketRecorder(std::shared_ptr<Clock> clock = nullptr);
+
+  // Records the packets added to the graph input streams of `graph` from the
+  // next run on. Must be called before the graph is started, and the
+  // recorder must outlive the run.
+  void RecordInputStreams(CalculatorGraph* graph);
+
+  // Records `packet`, added to the stream named `stream_name`.
+  absl::Status Record(const std::string& stream_name, const Packet& packet);
+
+  // Returns the packets recorded so far, or the first error recording a
+  // packet added to a graph.
+  absl::StatusOr<PacketRecording> GetRecording() const;
+
+ private:
+  std::shared_ptr<Clock> clock_;
+  mutable absl::Mutex mutex_;
+  PacketRecording recording_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, int> stream_indices_ ABSL_GUARDED_BY(mutex_);
+  absl::Time start_time_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Writes `recording` to the file at `path`.
+absl::Status WritePacketRecording(const PacketRecording& recording,
+                                  const std::string& path);
+
+// Reads the recording written to the file at `path`.
+absl::StatusOr<PacketRecording> ReadPacketRecording(const std::string& path);
+
+struct ReplayOptions {
+  // If true, each packet is added at its recorded arrival time after the
+  // start of the replay, otherwise as soon as the graph takes it.
+  bool recorded_pace = false;
+
+  // The clock used to pace the packets and to measure latencies, such as the
+  // clock of a SimulationClockExecutor running the graph. A monotonic
+  // real-time clock if null.
+  std::shared_ptr<Clock> clock;
+
+  // The output streams to measure.
+  std::vector<std::string> output_streams;
+
+  // The input side packets of the run.
+  std::map<std::string, Packet> input_side_packets;
+};
+
+// The timings of an output stream during a replay.
+struct ReplayStreamStats {
+  int64_t num_packets = 0;
+
+  // The output packets per second, from the first input packet to the last
+  // output packet.
+  double packets_per_second = 0;
+
+  // The latencies of the output packets, from the addition of the first
+  // input packet with the same timestamp. Output packets with no such input
+  // packet are not measured.
+  int64_t num_latencies = 0;
+  absl::Duration latency_mean;
+  absl::Duration latency_p50;
+  absl::Duration latency_p90;
+  absl::Duration latency_p99;
+  absl::Duration latency_max;
+};
+
+// Runs `graph`, initialized and not started, on the packets of `recording`
+// until done, and returns the timings of options.output_streams by name.
+absl::StatusOr<std::map<std::string, ReplayStreamStats>> ReplayPacketRecording(
+    const PacketRecording& recording, const ReplayOptions& options,
+    CalculatorGraph* graph);
+
+}  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_PACKET_RECORDING_H_
@@ -0,0 +1,185 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/packet_recording.h"
+
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/packet_test.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/simulation_clock_executor.h"
+
+namespace mediapipe {
+namespace tool {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Returns `packet` as decoded from its recording.
+Packet RoundTrip(const Packet& packet) {
+  RecordedPacket recorded;
+  MP_EXPECT_OK(EncodeRecordedPacket(packet, &recorded));
+  absl::StatusOr<Packet> decoded = DecodeRecordedPacket(recorded);
+  MP_EXPECT_OK(decoded);
+  return decoded.value();
+}
+
+// An RGB frame with padded rows, with the pixel values 0, 1, 2, ...
+std::unique_ptr<ImageFrame> MakeImageFrame() {
+  auto frame = std::make_unique<ImageFrame>(ImageFormat::SRGB, 3, 2);
+  for (int y = 0; y < frame->Height(); ++y) {
+    for (int x = 0; x < frame->Width() * 3; ++x) {
+      frame->MutablePixelData()[y * frame->WidthStep() + x] =
+          y * frame->Width() * 3 + x;
+    }
+  }
+  return frame;
+}
+
+void ExpectPixelsEqual(const ImageFrame& a, const ImageFrame& b) {
+  ASSERT_EQ(a.Format(), b.Format());
+  ASSERT_EQ(a.Width(), b.Width());
+  ASSERT_EQ(a.Height(), b.Height());
+  for (int y = 0; y < a.Height(); ++y) {
+    for (int x = 0; x < a.Width() * a.NumberOfChannels(); ++x) {
+      EXPECT_EQ(a.PixelData()[y * a.WidthStep() + x],
+                b.PixelData()[y * b.WidthStep() + x]);
+    }
+  }
+}
+
+TEST(PacketRecordingTest, EncodesImageFrame) {
+  Packet packet = Adopt(MakeImageFrame().release()).At(Timestamp(7));
+  Packet decoded = RoundTrip(packet);
+  EXPECT_EQ(decoded.Timestamp(), Timestamp(7));
+  ExpectPixelsEqual(decoded.Get<ImageFrame>(), packet.Get<ImageFrame>());
+}
+
+TEST(PacketRecordingTest, EncodesImage) {
+  Packet packet =
+      MakePacket<Image>(std::shared_ptr<ImageFrame>(MakeImageFrame()))
+          .At(Timestamp(7));
+  Packet decoded = RoundTrip(packet);
+  ExpectPixelsEqual(*decoded.Get<Image>().GetImageFrameSharedPtr(),
+                    *packet.Get<Image>().GetImageFrameSharedPtr());
+}
+
+TEST(PacketRecordingTest, EncodesTensor) {
+  Tensor tensor(Tensor::ElementType::kUInt8, Tensor::Shape{2, 3},
+                Tensor::QuantizationParameters(0.5f, 3));
+  {
+    auto view = tensor.GetCpuWriteView();
+    for (int i = 0; i < 6; ++i) view.buffer<uint8_t>()[i] = i * 10;
+  }
+  Packet decoded =
+      RoundTrip(MakePacket<Tensor>(std::move(tensor)).At(Timestamp(7)));
+  const Tensor& result = decoded.Get<Tensor>();
+  EXPECT_EQ(result.element_type(), Tensor::ElementType::kUInt8);
+  EXPECT_THAT(result.shape().dims, ElementsAre(2, 3));
+  EXPECT_EQ(result.quantization_parameters().scale, 0.5f);
+  EXPECT_EQ(result.quantization_parameters().zero_point, 3);
+  auto view = result.GetCpuReadView();
+  EXPECT_EQ(view.buffer<uint8_t>()[5], 50);
+}
+
+TEST(PacketRecordingTest, EncodesProto) {
+  SimpleProto proto;
+  proto.add_value("foo");
+  Packet decoded = RoundTrip(MakePacket<SimpleProto>(proto).At(Timestamp(7)));
+  EXPECT_THAT(decoded.Get<SimpleProto>().value(), ElementsAre("foo"));
+}
+
+TEST(PacketRecordingTest, RejectsTypesWithoutSerialization) {
+  RecordedPacket recorded;
+  EXPECT_EQ(EncodeRecordedPacket(MakePacket<int>(1), &recorded).code(),
+            absl::StatusCode::kUnimplemented);
+}
+
+CalculatorGraphConfig PassThroughGraph() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "frame"
+    input_stream: "tensor"
+    output_stream: "frame_out"
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "frame"
+      input_stream: "tensor"
+      output_stream: "frame_out"
+      output_stream: "tensor_out"
+    }
+  )pb");
+}
+
+TEST(PacketRecordingTest, RecordsAndReplaysGraphInputs) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(PassThroughGraph()));
+  PacketRecorder recorder;
+  recorder.RecordInputStreams(&graph);
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 3; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "frame", Adopt(MakeImageFrame().release()).At(Timestamp(i))));
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor", MakePacket<Tensor>(Tensor::ElementType::kFloat32,
+                                     Tensor::Shape{4})
+                      .At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  MP_ASSERT_OK_AND_ASSIGN(PacketRecording recording,
+                          recorder.GetRecording());
+  EXPECT_THAT(recording.stream_name(), ElementsAre("frame", "tensor"));
+  ASSERT_EQ(recording.packet_size(), 6);
+  EXPECT_EQ(recording.packet(0).arrival_usec(), 0);
+  EXPECT_EQ(recording.packet(5).stream_index(), 1);
+  EXPECT_EQ(recording.packet(5).timestamp(), 2);
+
+  const std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/packet_recording");
+  MP_ASSERT_OK(WritePacketRecording(recording, path));
+  MP_ASSERT_OK_AND_ASSIGN(recording, ReadPacketRecording(path));
+
+  CalculatorGraph replay_graph;
+  auto executor = std::make_shared<SimulationClockExecutor>(2);
+  MP_ASSERT_OK(replay_graph.SetExecutor("", executor));
+  MP_ASSERT_OK(replay_graph.Initialize(PassThroughGraph()));
+  ReplayOptions options;
+  options.recorded_pace = true;
+  options.clock = executor->GetClock();
+  options.output_streams = {"frame_out", "tensor_out"};
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto stats, ReplayPacketRecording(recording, options, &replay_graph));
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats["frame_out"].num_packets, 3);
+  EXPECT_EQ(stats["frame_out"].num_latencies, 3);
+  EXPECT_EQ(stats["tensor_out"].num_packets, 3);
+  EXPECT_GE(stats["tensor_out"].latency_max, stats["tensor_out"].latency_p50);
+}
+
+}  // namespace
+}  // namespace tool
+}  // namespace mediapipe
@@ -0,0 +1,122 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <set>
+#include <string>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/container_util.h"
+
+namespace mediapipe {
+
+// A calculator to deal the input packets of successive timestamps to several
+// output channels in turn, each consisting of streams corresponding to the
+// input streams. Each channel is distinguished by a tag-prefix such as
+// "C1__". For example:
+//
+//         node {
+//           calculator: "ReplicaDemuxCalculator"
+//           input_stream: "IMAGE:image"
+//           input_stream: "ROI:roi"
+//           output_stream: "C0__IMAGE:image_0"
+//           output_stream: "C0__ROI:roi_0"
+//           output_stream: "C1__IMAGE:image_1"
+//           output_stream: "C1__ROI:roi_1"
+//           output_stream: "SELECT:select"
+//         }
+//
+// The index of the channel of each timestamp is sent to output stream
+// "SELECT", with which a SwitchMuxCalculator merges the outputs of the nodes
+// on the channels back in timestamp order. The timestamp bounds of all the
+// channels advance with each timestamp.
+//
+// ExpandSubgraphs() uses ReplicaDemuxCalculator for the nodes that set
+// "replicas".
+class ReplicaDemuxCalculator : public CalculatorBase {
+  static constexpr char kSelectTag[] = "SELECT";
+
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Outputs().Tag(kSelectTag).Set<int>();
+    const int channel_count = tool::ChannelCount(cc->Outputs().TagMap());
+    RET_CHECK_GT(channel_count, 0);
+    for (CollectionItemId id = cc->Inputs().BeginId();
+         id < cc->Inputs().EndId(); ++id) {
+      cc->Inputs().Get(id).SetAny();
+      const auto tag_index = cc->Inputs().TagAndIndexFromId(id);
+      for (int channel = 0; channel < channel_count; ++channel) {
+        auto output_id = cc->Outputs().GetId(
+            tool::ChannelTag(tag_index.first, channel), tag_index.second);
+        if (output_id.IsValid()) {
+          cc->Outputs().Get(output_id).SetSameAs(&cc->Inputs().Get(id));
+        }
+      }
+    }
+    cc->SetTimestampOffset(0);
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    channel_count_ = tool::ChannelCount(cc->Outputs().TagMap());
+    // Relay headers to all channels.
+    for (CollectionItemId id = cc->Inputs().BeginId();
+         id < cc->Inputs().EndId(); ++id) {
+      const Packet& header = cc->Inputs().Get(id).Header();
+      if (header.IsEmpty()) continue;
+      for (int channel = 0; channel < channel_count_; ++channel) {
+        auto output_id = ChannelOutputId(cc, id, channel);
+        if (output_id.IsValid()) {
+          cc->Outputs().Get(output_id).SetHeader(header);
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    for (CollectionItemId id = cc->Inputs().BeginId();
+         id < cc->Inputs().EndId(); ++id) {
+      const InputStreamShard& input = cc->Inputs().Get(id);
+      if (input.IsEmpty()) continue;
+      auto output_id = ChannelOutputId(cc, id, channel_);
+      if (output_id.IsValid()) {
+        cc->Outputs().Get(output_id).AddPacket(input.Value());
+      }
+    }
+    cc->Outputs().Tag(kSelectTag).AddPacket(
+        MakePacket<int>(channel_).At(cc->InputTimestamp()));
+    channel_ = (channel_ + 1) % channel_count_;
+    return absl::OkStatus();
+  }
+
+ private:
+  // Returns the output stream of a channel corresponding to an input stream.
+  static CollectionItemId ChannelOutputId(CalculatorContext* cc,
+                                          CollectionItemId input_id,
+                                          int channel) {
+    const auto tag_index = cc->Inputs().TagAndIndexFromId(input_id);
+    return cc->Outputs().GetId(tool::ChannelTag(tag_index.first, channel),
+                               tag_index.second);
+  }
+
+  int channel_count_ = 0;
+  // The channel of the next timestamp.
+  int channel_ = 0;
+};
+REGISTER_CALCULATOR(ReplicaDemuxCalculator);
+
+}  // namespace mediapipe
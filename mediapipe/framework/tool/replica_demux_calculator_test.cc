@@ -0,0 +1,246 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <numeric>
+#include <set>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/subgraph.h"
+#include "mediapipe/framework/tool/sink.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::HasSubstr;
+using ::testing::SizeIs;
+
+// The calculator instances that ran Process().
+absl::Mutex instances_mutex;
+std::set<const void*>* instances = new std::set<const void*>();
+
+// Outputs the sum of its inputs after a delay varying with the input, so
+// that copies of it finish out of order.
+class StatelessDelayCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    for (CollectionItemId id = cc->Inputs().BeginId();
+         id < cc->Inputs().EndId(); ++id) {
+      cc->Inputs().Get(id).Set<int>();
+    }
+    cc->Outputs().Index(0).Set<int>();
+    cc->SetTimestampOffset(0);
+    cc->SetStateless(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    {
+      absl::MutexLock lock(&instances_mutex);
+      instances->insert(this);
+    }
+    int sum = 0;
+    for (CollectionItemId id = cc->Inputs().BeginId();
+         id < cc->Inputs().EndId(); ++id) {
+      if (!cc->Inputs().Get(id).IsEmpty()) {
+        sum += cc->Inputs().Get(id).Get<int>();
+      }
+    }
+    absl::SleepFor(absl::Milliseconds(sum % 4 == 0 ? 10 : 1));
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<int>(sum).At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(StatelessDelayCalculator);
+
+// Outputs the number of packets received so far.
+class CountingCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).Set<int>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<int>(++count_).At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+
+ private:
+  int count_ = 0;
+};
+REGISTER_CALCULATOR(CountingCalculator);
+
+// Chains two StatelessDelayCalculators.
+class StatelessChainSubgraph : public Subgraph {
+ public:
+  absl::StatusOr<CalculatorGraphConfig> GetConfig(
+      const SubgraphOptions& options) override {
+    return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+      input_stream: "IN:in"
+      output_stream: "OUT:out"
+      node {
+        calculator: "StatelessDelayCalculator"
+        input_stream: "in"
+        output_stream: "middle"
+      }
+      node {
+        calculator: "StatelessDelayCalculator"
+        input_stream: "middle"
+        output_stream: "out"
+      }
+    )pb");
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(StatelessChainSubgraph);
+
+// Runs a graph with input streams "a" and "b", where "b" skips the odd
+// timestamps, and returns the packets of output stream "out".
+absl::StatusOr<std::vector<Packet>> RunGraph(CalculatorGraphConfig config,
+                                             int num_packets) {
+  std::vector<Packet> output;
+  tool::AddVectorSink("out", &config, &output);
+  CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+  for (int i = 0; i < num_packets; ++i) {
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        "a", MakePacket<int>(i).At(Timestamp(i))));
+    if (i % 2 == 0) {
+      MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+          "b", MakePacket<int>(100).At(Timestamp(i))));
+    }
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  return output;
+}
+
+std::vector<int> Values(const std::vector<Packet>& packets) {
+  std::vector<int> result;
+  for (const Packet& packet : packets) result.push_back(packet.Get<int>());
+  return result;
+}
+
+std::vector<int64> Timestamps(const std::vector<Packet>& packets) {
+  std::vector<int64> result;
+  for (const Packet& packet : packets) {
+    result.push_back(packet.Timestamp().Value());
+  }
+  return result;
+}
+
+TEST(ReplicaDemuxCalculatorTest, ReplicatedNodeKeepsTimestampOrder) {
+  {
+    absl::MutexLock lock(&instances_mutex);
+    instances->clear();
+  }
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::vector<Packet> output,
+      RunGraph(ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+                 input_stream: "a"
+                 input_stream: "b"
+                 num_threads: 4
+                 node {
+                   calculator: "StatelessDelayCalculator"
+                   input_stream: "a"
+                   output_stream: "out"
+                   replicas: 3
+                 }
+               )pb"),
+               30));
+
+  std::vector<int> expected(30);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_THAT(Values(output), ElementsAreArray(expected));
+  EXPECT_THAT(Timestamps(output),
+              ElementsAreArray(std::vector<int64>(expected.begin(),
+                                                  expected.end())));
+  absl::MutexLock lock(&instances_mutex);
+  EXPECT_THAT(*instances, SizeIs(3));
+}
+
+TEST(ReplicaDemuxCalculatorTest, ReplicatedNodeGetsAllInputs) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::vector<Packet> output,
+      RunGraph(ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+                 input_stream: "a"
+                 input_stream: "b"
+                 num_threads: 4
+                 node {
+                   calculator: "StatelessDelayCalculator"
+                   input_stream: "a"
+                   input_stream: "b"
+                   output_stream: "out"
+                   replicas: 2
+                 }
+               )pb"),
+               10));
+
+  EXPECT_THAT(Values(output),
+              ElementsAreArray({100, 1, 102, 3, 104, 5, 106, 7, 108, 9}));
+}
+
+TEST(ReplicaDemuxCalculatorTest, ReplicatedSubgraphKeepsTimestampOrder) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::vector<Packet> output,
+      RunGraph(ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+                 input_stream: "a"
+                 input_stream: "b"
+                 num_threads: 4
+                 node {
+                   calculator: "StatelessChainSubgraph"
+                   input_stream: "IN:a"
+                   output_stream: "OUT:out"
+                   replicas: 4
+                 }
+               )pb"),
+               20));
+
+  std::vector<int> expected(20);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_THAT(Values(output), ElementsAreArray(expected));
+}
+
+TEST(ReplicaDemuxCalculatorTest, RejectsCalculatorNotStateless) {
+  CalculatorGraph graph;
+  absl::Status status =
+      graph.Initialize(ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "a"
+        node {
+          calculator: "CountingCalculator"
+          input_stream: "a"
+          output_stream: "out"
+          replicas: 2
+        }
+      )pb"));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("isn't stateless"));
+}
+
+}  // namespace
+}  // namespace mediapipe
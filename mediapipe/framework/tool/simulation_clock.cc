@@ -14,6 +14,10 @@
 
 #include "mediapipe/framework/tool/simulation_clock.h"
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "mediapipe/framework/port/logging.h"
@@ -27,12 +31,17 @@ SimulationClock::~SimulationClock() {
 
 absl::Time SimulationClock::TimeNow() {
   absl::MutexLock l(&time_mutex_);
+  if (mode_ == Mode::kComputeTime) {
+    Waiter* waiter = CurrentWaiter();
+    if (waiter) return ThreadTime(waiter);
+  }
   return time_;
 }
 
 void SimulationClock::Sleep(absl::Duration d) {
   absl::MutexLock l(&time_mutex_);
-  SleepInternal(time_ + d);
+  Waiter* waiter = mode_ == Mode::kComputeTime ? CurrentWaiter() : nullptr;
+  SleepInternal((waiter ? ThreadTime(waiter) : time_) + d);
 }
 
 void SimulationClock::SleepUntil(absl::Time wakeup_time) {
@@ -41,6 +50,30 @@ void SimulationClock::SleepUntil(absl::Time wakeup_time) {
 }
 
 void SimulationClock::SleepInternal(absl::Time wakeup_time) {
+  if (mode_ == Mode::kComputeTime) {
+    // A thread running in simulated time sleeps with its own Waiter. Other
+    // threads only hold back simulated time until they are woken.
+    Waiter* waiter = CurrentWaiter();
+    Waiter local_waiter;
+    if (waiter) {
+      running_.erase(waiter);
+      waiter->sleeping = true;
+      waiter->run_start = absl::InfinitePast();
+    } else {
+      waiter = &local_waiter;
+    }
+    waiter->wake_time = wakeup_time;
+    waiters_.insert({wakeup_time, waiter});
+    TryAdvanceTime();
+    WaitUntilWoken(waiter);
+    if (waiter == &local_waiter) {
+      running_.erase(waiter);
+      TryAdvanceTime();
+    } else {
+      waiter->run_start = absl::Now();
+    }
+    return;
+  }
   Waiter waiter;
   waiters_.insert({wakeup_time, &waiter});
   num_running_--;
@@ -54,15 +87,85 @@ void SimulationClock::SleepInternal(absl::Time wakeup_time) {
 void SimulationClock::ThreadStart() {
   absl::MutexLock l(&time_mutex_);
   num_running_++;
+  if (mode_ == Mode::kComputeTime && !CurrentWaiter()) {
+    Waiter* waiter = new Waiter;
+    waiter->sleeping = false;
+    waiter->wake_time = time_;
+    waiter->run_start = absl::Now();
+    running_.insert(waiter);
+    thread_waiters_[std::this_thread::get_id()] = waiter;
+  }
 }
 
 void SimulationClock::ThreadFinish() {
   absl::MutexLock l(&time_mutex_);
   num_running_--;
+  if (mode_ == Mode::kComputeTime) {
+    Waiter* waiter = CurrentWaiter();
+    if (waiter) {
+      thread_waiters_.erase(std::this_thread::get_id());
+      running_.erase(waiter);
+      delete waiter;
+    }
+  }
   TryAdvanceTime();
 }
 
+std::function<void()> SimulationClock::WrapTask(std::function<void()> task) {
+  if (mode_ == Mode::kSerial) {
+    // The task counts as running until it sleeps at the current time, so
+    // that time doesn't advance before it is queued.
+    ThreadStart();
+    return [this, task = std::move(task)] {
+      Sleep(absl::ZeroDuration());
+      task();
+      ThreadFinish();
+    };
+  }
+  // The task is queued at the time of the calling thread right away, and
+  // runs once woken, with the Waiter as the Waiter of its thread.
+  auto waiter = std::make_shared<Waiter>();
+  {
+    absl::MutexLock l(&time_mutex_);
+    Waiter* caller = CurrentWaiter();
+    waiter->wake_time = caller ? ThreadTime(caller) : time_;
+    waiters_.insert({waiter->wake_time, waiter.get()});
+    TryAdvanceTime();
+  }
+  return [this, waiter, task = std::move(task)] {
+    {
+      absl::MutexLock l(&time_mutex_);
+      thread_waiters_[std::this_thread::get_id()] = waiter.get();
+      WaitUntilWoken(waiter.get());
+      waiter->run_start = absl::Now();
+    }
+    task();
+    absl::MutexLock l(&time_mutex_);
+    thread_waiters_.erase(std::this_thread::get_id());
+    running_.erase(waiter.get());
+    TryAdvanceTime();
+  };
+}
+
 void SimulationClock::TryAdvanceTime() {
+  if (mode_ == Mode::kComputeTime) {
+    // Wakes the threads no running thread can precede anymore, as running
+    // threads only act at their own time or later.
+    while (!waiters_.empty()) {
+      absl::Time wake_time = waiters_.begin()->first;
+      for (const Waiter* running : running_) {
+        if (ThreadTime(running) < wake_time) return;
+      }
+      VLOG(2) << "Wake thread at: " << absl::ToUnixMicros(wake_time);
+      time_ = std::max(time_, wake_time);
+      Waiter* waiter = waiters_.begin()->second;
+      waiters_.erase(waiters_.begin());
+      running_.insert(waiter);
+      waiter->sleeping = false;
+      waiter->cond.Signal();
+    }
+    return;
+  }
   if (num_running_ == 0 && !waiters_.empty()) {
     VLOG(2) << "Advance time from: " << absl::ToUnixMicros(time_)
             << " to: " << absl::ToUnixMicros(waiters_.begin()->first);
@@ -74,4 +177,44 @@ void SimulationClock::TryAdvanceTime() {
   }
 }
 
+absl::Time SimulationClock::ThreadTime(const Waiter* waiter) const {
+  if (waiter->run_start == absl::InfinitePast()) return waiter->wake_time;
+  return waiter->wake_time +
+         (absl::Now() - waiter->run_start) * compute_time_scale_;
+}
+
+SimulationClock::Waiter* SimulationClock::CurrentWaiter() {
+  auto it = thread_waiters_.find(std::this_thread::get_id());
+  return it == thread_waiters_.end() ? nullptr : it->second;
+}
+
+void SimulationClock::WaitUntilWoken(Waiter* waiter) {
+  while (waiter->sleeping) {
+    // The earliest sleeping thread also wakes once the running threads have
+    // computed past its wake up time.
+    absl::Duration timeout = waiters_.begin()->second == waiter
+                                 ? TimeUntilNextWakeup()
+                                 : absl::InfiniteDuration();
+    waiter->cond.WaitWithTimeout(&time_mutex_, timeout);
+    TryAdvanceTime();
+  }
+}
+
+absl::Duration SimulationClock::TimeUntilNextWakeup() {
+  if (waiters_.empty() || running_.empty()) return absl::InfiniteDuration();
+  const absl::Time wake_time = waiters_.begin()->first;
+  const absl::Time now = absl::Now();
+  absl::Duration result = absl::ZeroDuration();
+  for (const Waiter* running : running_) {
+    // A thread not running yet only advances once it runs.
+    if (running->run_start == absl::InfinitePast()) {
+      return absl::InfiniteDuration();
+    }
+    absl::Time reached = running->run_start +
+                         (wake_time - running->wake_time) / compute_time_scale_;
+    result = std::max(result, reached - now);
+  }
+  return result;
+}
+
 }  // namespace mediapipe
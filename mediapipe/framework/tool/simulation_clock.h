@@ -15,8 +15,10 @@
 #ifndef MEDIAPIPE_FRAMEWORK_TOOL_SIMULATION_CLOCK_H_
 #define MEDIAPIPE_FRAMEWORK_TOOL_SIMULATION_CLOCK_H_
 
+#include <functional>
 #include <map>
 #include <set>
+#include <thread>  // NOLINT(build/c++11)
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
@@ -36,12 +38,33 @@ namespace mediapipe {
 // to continue until all earlier threads have finished or entered Sleep.
 // The result is a single well-defined order of events.  Any desired
 // order of events can be defined by adjusting the precise sleep times.
+//
+// In Mode::kComputeTime, simulated time also accounts for the computation of
+// the threads, see below.
 class SimulationClock : public mediapipe::Clock {
  public:
+  enum class Mode {
+    // Computation takes no simulated time. Woken threads run one at a time,
+    // in a single well-defined order.
+    kSerial,
+    // Each running thread sees simulated time advance with its own compute
+    // time, scaled by compute_time_scale, while time spent with all threads
+    // asleep is skipped. Time-dependent calculators, such as flow limiters
+    // and packet thinners, then make the decisions they would make in real
+    // time on a machine of that speed, while recorded input replays as fast
+    // as the computation allows. Threads run in parallel: a thread is woken
+    // as soon as no running thread can still act at an earlier simulated
+    // time. As compute times are measured, the order of events is only as
+    // deterministic as the compute times.
+    kComputeTime,
+  };
+
   SimulationClock() {}
+  explicit SimulationClock(Mode mode, double compute_time_scale = 1.0)
+      : mode_(mode), compute_time_scale_(compute_time_scale) {}
   ~SimulationClock() override;
 
-  // Returns the simulated time.
+  // Returns the simulated time, as seen by the calling thread.
   absl::Time TimeNow() override;
 
   // Sleeps until the specified duration has elapsed according to this clock.
@@ -56,6 +79,11 @@ class SimulationClock : public mediapipe::Clock {
   // Informs this clock that a woken thread has finished running.
   void ThreadFinish();
 
+  // Returns a function running `task` in simulated time, starting at the
+  // simulated time of the calling thread. Used by executors to schedule
+  // tasks, see SimulationClockExecutor.
+  std::function<void()> WrapTask(std::function<void()> task);
+
  protected:
   // Queue up wake up waiter.
   void SleepInternal(absl::Time wakeup_time)
@@ -67,13 +95,37 @@ class SimulationClock : public mediapipe::Clock {
   struct Waiter {
     bool sleeping = true;
     absl::CondVar cond;
+    // In kComputeTime mode, the simulated time the thread wakes at, and the
+    // real time it has been running since, or InfinitePast() until then.
+    absl::Time wake_time;
+    absl::Time run_start = absl::InfinitePast();
   };
 
+  // kComputeTime mode: returns the simulated time reached by a woken thread.
+  absl::Time ThreadTime(const Waiter* waiter) const;
+  // kComputeTime mode: returns the Waiter of the calling thread, or nullptr
+  // if the calling thread isn't running in simulated time.
+  Waiter* CurrentWaiter() ABSL_EXCLUSIVE_LOCKS_REQUIRED(time_mutex_);
+  // kComputeTime mode: blocks until `waiter` is woken.
+  void WaitUntilWoken(Waiter* waiter)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(time_mutex_);
+  // kComputeTime mode: returns the real time to wait until the running
+  // threads reach the earliest wake up time, or InfiniteDuration().
+  absl::Duration TimeUntilNextWakeup()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(time_mutex_);
+
  protected:
+  const Mode mode_ = Mode::kSerial;
+  const double compute_time_scale_ = 1.0;
   absl::Mutex time_mutex_;
   absl::Time time_ ABSL_GUARDED_BY(time_mutex_);
   std::multimap<absl::Time, Waiter*> waiters_ ABSL_GUARDED_BY(time_mutex_);
   int num_running_ ABSL_GUARDED_BY(time_mutex_) = 0;
+  // kComputeTime mode: the woken threads, and the Waiter of each thread
+  // running in simulated time.
+  std::set<Waiter*> running_ ABSL_GUARDED_BY(time_mutex_);
+  std::map<std::thread::id, Waiter*> thread_waiters_
+      ABSL_GUARDED_BY(time_mutex_);
 };
 
 }  // namespace mediapipe
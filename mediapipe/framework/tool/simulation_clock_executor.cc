@@ -14,6 +14,8 @@
 
 #include "mediapipe/framework/tool/simulation_clock_executor.h"
 
+#include <utility>
+
 #include "mediapipe/framework/tool/simulation_clock.h"
 
 namespace mediapipe {
@@ -21,13 +23,14 @@ namespace mediapipe {
 SimulationClockExecutor::SimulationClockExecutor(int num_threads)
     : clock_(new SimulationClock()), executor_(num_threads) {}
 
+SimulationClockExecutor::SimulationClockExecutor(int num_threads,
+                                                 SimulationClock::Mode mode,
+                                                 double compute_time_scale)
+    : clock_(new SimulationClock(mode, compute_time_scale)),
+      executor_(num_threads) {}
+
 void SimulationClockExecutor::Schedule(std::function<void()> task) {
-  clock_->ThreadStart();
-  executor_.Schedule([this, task] {
-    clock_->Sleep(absl::ZeroDuration());
-    task();
-    clock_->ThreadFinish();
-  });
+  executor_.Schedule(clock_->WrapTask(std::move(task)));
 }
 
 std::shared_ptr<SimulationClock> SimulationClockExecutor::GetClock() {
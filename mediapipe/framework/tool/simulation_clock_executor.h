@@ -26,6 +26,11 @@ namespace mediapipe {
 class SimulationClockExecutor : public Executor {
  public:
   explicit SimulationClockExecutor(int num_threads);
+  // Uses a SimulationClock in the given mode, see SimulationClock::Mode.
+  // With Mode::kComputeTime, recorded input can be re-processed faster than
+  // real time, with the timing decisions of real time.
+  SimulationClockExecutor(int num_threads, SimulationClock::Mode mode,
+                          double compute_time_scale = 1.0);
   void Schedule(std::function<void()> task) override;
 
   // Returns a pointer to the instance of SimulationClock used by
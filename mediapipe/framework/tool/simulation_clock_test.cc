@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/tool/simulation_clock.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
@@ -21,6 +22,9 @@
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/input_stream.h"
@@ -242,6 +246,54 @@ TEST_F(SimulationClockTest, InFlight) {
               ElementsAre(10000, 20000, 40000, 60000, 70000, 100000));
 }
 
+// In kComputeTime mode, tasks woken at the same time run in parallel.
+TEST_F(SimulationClockTest, ComputeTimeRunsTasksInParallel) {
+  auto executor = std::make_shared<SimulationClockExecutor>(
+      2, SimulationClock::Mode::kComputeTime);
+  // Each task waits for the other one to start.
+  std::atomic<int> started(0);
+  absl::BlockingCounter finished(2);
+  for (int i = 0; i < 2; ++i) {
+    executor->Schedule([&] {
+      ++started;
+      while (started < 2) {
+      }
+      finished.DecrementCount();
+    });
+  }
+  finished.Wait();
+}
+
+// In kComputeTime mode, simulated time advances with the compute time of a
+// task, and skips the time with all tasks asleep.
+TEST_F(SimulationClockTest, ComputeTimeChargesComputeTime) {
+  auto executor = std::make_shared<SimulationClockExecutor>(
+      2, SimulationClock::Mode::kComputeTime);
+  clock_ = executor->GetClock().get();
+  absl::Time start, computed, woken, other_woken;
+  absl::BlockingCounter finished(2);
+  executor->Schedule([&] {
+    start = clock_->TimeNow();
+    absl::SleepFor(absl::Milliseconds(20));
+    computed = clock_->TimeNow();
+    clock_->Sleep(absl::Seconds(10));
+    woken = clock_->TimeNow();
+    finished.DecrementCount();
+  });
+  executor->Schedule([&] {
+    clock_->SleepUntil(absl::UnixEpoch() + absl::Seconds(5));
+    other_woken = clock_->TimeNow();
+    finished.DecrementCount();
+  });
+  const absl::Time real_start = absl::Now();
+  finished.Wait();
+  EXPECT_LT(absl::Now() - real_start, absl::Seconds(5));
+  EXPECT_GE(computed - start, absl::Milliseconds(20));
+  EXPECT_GE(woken - computed, absl::Seconds(10));
+  EXPECT_GE(other_woken, absl::UnixEpoch() + absl::Seconds(5));
+  EXPECT_LT(other_woken, woken);
+}
+
 // Shows successful destruction of CalculatorGraph, SimulationClockExecutor,
 // and SimulationClock.  With tsan, this test reveals a race condition unless
 // the SimulationClock destructor calls ThreadFinish to waits for all threads.
@@ -0,0 +1,310 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generates the C++ class of a graph for the mediapipe_static_graph macro in
+// //mediapipe/framework/tool/mediapipe_graph.bzl, from the binary config of
+// the graph with its subgraphs expanded.
+//
+// The class holds the graph, initialized from the config embedded at build
+// time, and the handles of its input streams, resolved once, so that packets
+// are added by index rather than by stream name. Each graph input and output
+// stream gets an enumerator and named methods.
+
+#include <stdlib.h>
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/canonical_errors.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/tag_map.h"
+
+ABSL_FLAG(std::string, graph, "",
+          "The binary CalculatorGraphConfig of the graph, with its subgraphs "
+          "expanded.");
+ABSL_FLAG(std::string, class_name, "", "The name of the generated class.");
+ABSL_FLAG(std::string, namespace, "mediapipe",
+          "The namespace of the generated class, such as \"foo::bar\".");
+ABSL_FLAG(std::string, header_path, "",
+          "The path of the generated header, as included by the source.");
+ABSL_FLAG(std::string, inc_path, "",
+          "The path of the config encoded by data_as_c_string.");
+ABSL_FLAG(std::string, header_output, "", "The generated header file.");
+ABSL_FLAG(std::string, source_output, "", "The generated source file.");
+
+namespace mediapipe {
+namespace {
+
+// A graph input or output stream.
+struct Stream {
+  std::string name;
+  // The CamelCase name used in enumerators and methods.
+  std::string camel_name;
+};
+
+// Returns "foo_bar2" as "FooBar2".
+std::string ToCamelCase(absl::string_view name) {
+  std::string result;
+  for (absl::string_view part :
+       absl::StrSplit(name, absl::ByAnyChar("_-."), absl::SkipEmpty())) {
+    std::string word(part);
+    word[0] = absl::ascii_toupper(word[0]);
+    absl::StrAppend(&result, word);
+  }
+  return result;
+}
+
+absl::StatusOr<std::vector<Stream>> GetStreams(
+    const proto_ns::RepeatedPtrField<ProtoString>& tag_index_names) {
+  ASSIGN_OR_RETURN(auto tag_map, tool::TagMap::Create(tag_index_names));
+  std::vector<Stream> streams;
+  for (const std::string& name : tag_map->Names()) {
+    std::string camel_name = ToCamelCase(name);
+    RET_CHECK(!camel_name.empty() && std::isalpha(camel_name[0]))
+        << "Stream \"" << name << "\" has no valid C++ identifier.";
+    for (const Stream& stream : streams) {
+      RET_CHECK_NE(stream.camel_name, camel_name)
+          << "Streams \"" << stream.name << "\" and \"" << name
+          << "\" have the same C++ identifier.";
+    }
+    streams.push_back({name, std::move(camel_name)});
+  }
+  return streams;
+}
+
+// Returns the enumerators of `streams`.
+std::string Enumerators(const std::vector<Stream>& streams) {
+  std::vector<std::string> enumerators;
+  for (int i = 0; i < streams.size(); ++i) {
+    enumerators.push_back(absl::StrCat("k", streams[i].camel_name, " = ", i));
+  }
+  return absl::StrJoin(enumerators, ", ");
+}
+
+// Returns `streams` as the initializer of an array of their names.
+std::string NameArray(const std::vector<Stream>& streams) {
+  std::vector<std::string> names;
+  for (const Stream& stream : streams) {
+    names.push_back(absl::StrCat("\"", absl::CEscape(stream.name), "\""));
+  }
+  return absl::StrCat("{", absl::StrJoin(names, ", "), "}");
+}
+
+std::string GenerateHeader(const std::string& class_name,
+                           const std::vector<std::string>& namespaces,
+                           const std::string& header_path,
+                           const std::vector<Stream>& inputs,
+                           const std::vector<Stream>& outputs) {
+  std::string guard = absl::AsciiStrToUpper(header_path);
+  for (char& c : guard) {
+    if (!absl::ascii_isalnum(c)) c = '_';
+  }
+  absl::StrAppend(&guard, "_");
+
+  std::ostringstream out;
+  out << "// Generated by mediapipe_static_graph(). Do not edit.\n\n"
+      << "#ifndef " << guard << "\n#define " << guard << "\n\n"
+      << "#include <array>\n#include <functional>\n#include <memory>\n"
+      << "#include <utility>\n#include <vector>\n\n"
+      << "#include \"absl/status/status.h\"\n"
+      << "#include \"absl/status/statusor.h\"\n"
+      << "#include \"mediapipe/framework/calculator_graph.h\"\n"
+      << "#include \"mediapipe/framework/packet.h\"\n\n";
+  for (const std::string& ns : namespaces) {
+    out << "namespace " << ns << " {\n";
+  }
+  out << "\nclass " << class_name << " {\n public:\n"
+      << "  using CalculatorGraph = ::mediapipe::CalculatorGraph;\n"
+      << "  using Packet = ::mediapipe::Packet;\n\n"
+      << "  static constexpr int kNumInputs = " << inputs.size() << ";\n"
+      << "  static constexpr int kNumOutputs = " << outputs.size() << ";\n"
+      << "  enum class Input { " << Enumerators(inputs) << " };\n"
+      << "  enum class Output { " << Enumerators(outputs) << " };\n\n"
+      << "  // Returns the graph, initialized from its config expanded at "
+         "build time.\n"
+      << "  static absl::StatusOr<std::unique_ptr<" << class_name
+      << ">> Create();\n\n"
+      << "  static const char* InputName(Input input) {\n"
+      << "    return kInputNames[static_cast<int>(input)];\n  }\n"
+      << "  static const char* OutputName(Output output) {\n"
+      << "    return kOutputNames[static_cast<int>(output)];\n  }\n\n"
+      << "  // Adds a packet to a graph input stream, without looking it up by "
+         "name.\n"
+      << "  absl::Status AddPacket(Input input, Packet packet) {\n"
+      << "    return graph_.AddPacketToInputStream(\n"
+      << "        inputs_[static_cast<int>(input)], std::move(packet));\n"
+      << "  }\n\n"
+      << "  // Adds packets to several graph input streams at once. See\n"
+      << "  // CalculatorGraph::AddPacketsToInputStreams().\n"
+      << "  absl::Status AddPackets(\n"
+      << "      std::vector<std::pair<Input, Packet>> packets);\n\n"
+      << "  absl::Status ObserveOutput(\n"
+      << "      Output output,\n"
+      << "      std::function<absl::Status(const Packet&)> packet_callback) {\n"
+      << "    return graph_.ObserveOutputStream(OutputName(output),\n"
+      << "                                      std::move(packet_callback));\n"
+      << "  }\n";
+  for (const Stream& input : inputs) {
+    out << "\n  absl::Status Add" << input.camel_name
+        << "(Packet packet) {\n"
+        << "    return AddPacket(Input::k" << input.camel_name
+        << ", std::move(packet));\n  }\n";
+  }
+  for (const Stream& output : outputs) {
+    out << "\n  absl::Status Observe" << output.camel_name << "(\n"
+        << "      std::function<absl::Status(const Packet&)> packet_callback) "
+           "{\n"
+        << "    return ObserveOutput(Output::k" << output.camel_name
+        << ", std::move(packet_callback));\n  }\n";
+  }
+  out << "\n  // Runs the graph, see CalculatorGraph.\n"
+      << "  CalculatorGraph& graph() { return graph_; }\n\n"
+      << " private:\n"
+      << "  static constexpr const char* kInputNames[kNumInputs + 1] = "
+      << NameArray(inputs) << ";\n"
+      << "  static constexpr const char* kOutputNames[kNumOutputs + 1] = "
+      << NameArray(outputs) << ";\n\n"
+      << "  " << class_name << "() = default;\n\n"
+      << "  CalculatorGraph graph_;\n"
+      << "  std::array<CalculatorGraph::GraphInputStreamHandle,\n"
+      << "             kNumInputs>\n"
+      << "      inputs_;\n"
+      << "};\n\n";
+  for (auto it = namespaces.rbegin(); it != namespaces.rend(); ++it) {
+    out << "}  // namespace " << *it << "\n";
+  }
+  out << "\n#endif  // " << guard << "\n";
+  return out.str();
+}
+
+std::string GenerateSource(const std::string& class_name,
+                           const std::vector<std::string>& namespaces,
+                           const std::string& header_path,
+                           const std::string& inc_path) {
+  std::ostringstream out;
+  out << "// Generated by mediapipe_static_graph(). Do not edit.\n\n"
+      << "#include \"" << header_path << "\"\n\n"
+      << "#include \"mediapipe/framework/calculator.pb.h\"\n\n";
+  for (const std::string& ns : namespaces) {
+    out << "namespace " << ns << " {\n";
+  }
+  out << "namespace {\n\n"
+      << "// clang-format off\n"
+      << "const char kBinaryGraph[] =\n"
+      << "#include \"" << inc_path << "\"\n"
+      << "    ;  // NOLINT(whitespace/semicolon)\n"
+      << "// clang-format on\n\n"
+      << "}  // namespace\n\n"
+      << "absl::StatusOr<std::unique_ptr<" << class_name << ">> " << class_name
+      << "::Create() {\n"
+      << "  ::mediapipe::CalculatorGraphConfig config;\n"
+      << "  // The trailing NUL added to the string literal is excluded.\n"
+      << "  if (!config.ParseFromArray(kBinaryGraph,\n"
+      << "                              sizeof(kBinaryGraph) - 1)) {\n"
+      << "    return absl::InternalError(\"Could not parse " << class_name
+      << ".\");\n  }\n"
+      << "  std::unique_ptr<" << class_name << "> result(new " << class_name
+      << "());\n"
+      << "  absl::Status status = result->graph_.Initialize(std::move(config));"
+         "\n"
+      << "  if (!status.ok()) return status;\n"
+      << "  for (int i = 0; i < kNumInputs; ++i) {\n"
+      << "    auto handle =\n"
+      << "        result->graph_.GetInputStreamHandle(kInputNames[i]);\n"
+      << "    if (!handle.ok()) return handle.status();\n"
+      << "    result->inputs_[i] = *handle;\n  }\n"
+      << "  return result;\n}\n\n"
+      << "absl::Status " << class_name << "::AddPackets(\n"
+      << "    std::vector<std::pair<Input, Packet>> packets) {\n"
+      << "  std::vector<std::pair<\n"
+      << "      CalculatorGraph::GraphInputStreamHandle,\n"
+      << "      Packet>>\n"
+      << "      handle_packets;\n"
+      << "  handle_packets.reserve(packets.size());\n"
+      << "  for (auto& [input, packet] : packets) {\n"
+      << "    handle_packets.emplace_back(inputs_[static_cast<int>(input)],\n"
+      << "                                std::move(packet));\n  }\n"
+      << "  return graph_.AddPacketsToInputStreams(std::move(handle_packets));"
+         "\n}\n\n";
+  for (auto it = namespaces.rbegin(); it != namespaces.rend(); ++it) {
+    out << "}  // namespace " << *it << "\n";
+  }
+  return out.str();
+}
+
+absl::Status WriteFile(const std::string& path, const std::string& contents) {
+  std::ofstream ofs(path, std::ios_base::out | std::ios_base::trunc);
+  ofs << contents;
+  RET_CHECK(ofs.good()) << "could not write: " << path;
+  return absl::OkStatus();
+}
+
+absl::Status Generate() {
+  for (const auto* flag : {&FLAGS_graph, &FLAGS_class_name, &FLAGS_header_path,
+                           &FLAGS_inc_path, &FLAGS_header_output,
+                           &FLAGS_source_output}) {
+    RET_CHECK(!absl::GetFlag(*flag).empty())
+        << "--graph, --class_name, --header_path, --inc_path, "
+           "--header_output and --source_output must be specified";
+  }
+  CalculatorGraphConfig config;
+  std::ifstream ifs(absl::GetFlag(FLAGS_graph), std::ios_base::binary);
+  RET_CHECK(config.ParseFromIstream(&ifs))
+      << "could not parse binary proto: " << absl::GetFlag(FLAGS_graph);
+
+  ASSIGN_OR_RETURN(std::vector<Stream> inputs,
+                   GetStreams(config.input_stream()));
+  ASSIGN_OR_RETURN(std::vector<Stream> outputs,
+                   GetStreams(config.output_stream()));
+  const std::string class_name = absl::GetFlag(FLAGS_class_name);
+  const std::vector<std::string> namespaces = absl::StrSplit(
+      absl::GetFlag(FLAGS_namespace), "::", absl::SkipEmpty());
+  MP_RETURN_IF_ERROR(WriteFile(
+      absl::GetFlag(FLAGS_header_output),
+      GenerateHeader(class_name, namespaces, absl::GetFlag(FLAGS_header_path),
+                     inputs, outputs)));
+  return WriteFile(
+      absl::GetFlag(FLAGS_source_output),
+      GenerateSource(class_name, namespaces, absl::GetFlag(FLAGS_header_path),
+                     absl::GetFlag(FLAGS_inc_path)));
+}
+
+}  // namespace
+}  // namespace mediapipe
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status status = mediapipe::Generate();
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
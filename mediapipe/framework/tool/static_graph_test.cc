@@ -0,0 +1,73 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/nested_test_static_graph.h"
+
+namespace mediapipe {
+namespace tool {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(StaticGraphTest, NamesStreams) {
+  EXPECT_EQ(NestedTestStaticGraph::kNumInputs, 1);
+  EXPECT_EQ(NestedTestStaticGraph::kNumOutputs, 3);
+  EXPECT_STREQ(
+      NestedTestStaticGraph::InputName(NestedTestStaticGraph::Input::kInts),
+      "ints");
+  EXPECT_STREQ(NestedTestStaticGraph::OutputName(
+                   NestedTestStaticGraph::Output::kOctupled),
+               "octupled");
+}
+
+TEST(StaticGraphTest, RunsExpandedGraph) {
+  MP_ASSERT_OK_AND_ASSIGN(auto graph, NestedTestStaticGraph::Create());
+  // The subgraphs were expanded at build time.
+  for (const auto& node : graph->graph().Config().node()) {
+    EXPECT_EQ(node.calculator(), "DoubleIntCalculator");
+  }
+  std::vector<int> doubled;
+  std::vector<int> octupled;
+  MP_ASSERT_OK(graph->ObserveDoubled([&doubled](const Packet& packet) {
+    doubled.push_back(packet.Get<int>());
+    return absl::OkStatus();
+  }));
+  MP_ASSERT_OK(graph->ObserveOutput(
+      NestedTestStaticGraph::Output::kOctupled,
+      [&octupled](const Packet& packet) {
+        octupled.push_back(packet.Get<int>());
+        return absl::OkStatus();
+      }));
+
+  MP_ASSERT_OK(graph->graph().StartRun({}));
+  MP_ASSERT_OK(graph->AddInts(MakePacket<int>(1).At(Timestamp(0))));
+  MP_ASSERT_OK(graph->AddPacket(NestedTestStaticGraph::Input::kInts,
+                                MakePacket<int>(2).At(Timestamp(1))));
+  MP_ASSERT_OK(graph->AddPackets({{NestedTestStaticGraph::Input::kInts,
+                                   MakePacket<int>(3).At(Timestamp(2))}}));
+  MP_ASSERT_OK(graph->graph().CloseAllInputStreams());
+  MP_ASSERT_OK(graph->graph().WaitUntilDone());
+  EXPECT_THAT(doubled, ElementsAre(2, 4, 6));
+  EXPECT_THAT(octupled, ElementsAre(8, 16, 24));
+}
+
+}  // namespace
+}  // namespace tool
+}  // namespace mediapipe
@@ -126,6 +126,16 @@ absl::Status TransformNames(
   return absl::OkStatus();
 }
 
+// Returns the prefix of the names of streams derived from a node name.
+static std::string StreamNamePrefix(std::string node_name) {
+  std::transform(node_name.begin(), node_name.end(), node_name.begin(),
+                 ::tolower);
+  std::replace(node_name.begin(), node_name.end(), '.', '_');
+  std::replace(node_name.begin(), node_name.end(), ' ', '_');
+  std::replace(node_name.begin(), node_name.end(), ':', '_');
+  return absl::StrCat(node_name, "__");
+}
+
 // Adds a prefix to the name of each stream, side packet and node in the
 // config. Each call to this method should use a different prefix. For example:
 //   1, { foo, bar }  --PrefixNames-> { qsg__foo, qsg__bar }
@@ -134,11 +144,7 @@ absl::Status TransformNames(
 // each other.
 static absl::Status PrefixNames(std::string prefix,
                                 CalculatorGraphConfig* config) {
-  std::transform(prefix.begin(), prefix.end(), prefix.begin(), ::tolower);
-  std::replace(prefix.begin(), prefix.end(), '.', '_');
-  std::replace(prefix.begin(), prefix.end(), ' ', '_');
-  std::replace(prefix.begin(), prefix.end(), ':', '_');
-  absl::StrAppend(&prefix, "__");
+  prefix = StreamNamePrefix(prefix);
   auto add_prefix = [&prefix](absl::string_view s) {
     return absl::StrCat(prefix, s);
   };
@@ -181,14 +187,13 @@ absl::Status FindCorrespondingStreams(
 
 // The following fields can be used in a Node message for a subgraph:
 //   name, calculator, input_stream, output_stream, input_side_packet,
-//   output_side_packet, options.
+//   output_side_packet, options, max_in_flight, executor, replicas.
 // All other fields are only applicable to calculators.
 absl::Status ValidateSubgraphFields(
     const CalculatorGraphConfig::Node& subgraph_node) {
   if (subgraph_node.source_layer() || subgraph_node.buffer_size_hint() ||
       subgraph_node.has_output_stream_handler() ||
-      subgraph_node.input_stream_info_size() != 0 ||
-      !subgraph_node.executor().empty()) {
+      subgraph_node.input_stream_info_size() != 0) {
     return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
            << "Subgraph \"" << subgraph_node.name()
            << "\" has a field that is only applicable to calculators.";
@@ -272,6 +277,157 @@ absl::Status ConnectSubgraphStreams(
   return absl::OkStatus();
 }
 
+void ApplySubgraphMaxInFlight(const CalculatorGraphConfig::Node& subgraph_node,
+                              CalculatorGraphConfig* subgraph_config) {
+  if (subgraph_node.max_in_flight() <= 1) return;
+  for (auto& node : *subgraph_config->mutable_node()) {
+    if (node.max_in_flight() == 0) {
+      node.set_max_in_flight(subgraph_node.max_in_flight());
+    }
+  }
+}
+
+void ApplySubgraphExecutor(const CalculatorGraphConfig::Node& subgraph_node,
+                           CalculatorGraphConfig* subgraph_config) {
+  if (subgraph_node.executor().empty()) return;
+  for (auto& node : *subgraph_config->mutable_node()) {
+    if (node.executor().empty()) {
+      node.set_executor(subgraph_node.executor());
+    }
+  }
+}
+
+void ApplySubgraphReplicas(const CalculatorGraphConfig::Node& subgraph_node,
+                           CalculatorGraphConfig* subgraph_config) {
+  if (subgraph_node.replicas() != 1) return;
+  for (auto& node : *subgraph_config->mutable_node()) {
+    if (node.replicas() == 0) {
+      node.set_replicas(1);
+    }
+  }
+}
+
+// Returns a stream as "TAG:index:name", or as "name" if it is untagged.
+static std::string TagIndexName(const std::string& tag, int index,
+                                const std::string& name) {
+  return tag.empty() ? name : absl::StrCat(tag, ":", index, ":", name);
+}
+
+// Returns the tag of one of the channels of SwitchMuxCalculator, as
+// tool::ChannelTag().
+static std::string ReplicaChannelTag(const std::string& tag, int channel) {
+  return absl::StrCat("C", channel, "__", tag);
+}
+
+// Adds the streams of one copy of a replicated node, renamed for the copy,
+// to `replica_streams`, and the corresponding channel streams of the demux or
+// mux node to `channel_streams`.
+static absl::Status ConnectReplica(
+    const proto_ns::RepeatedPtrField<ProtoString>& streams, int channel,
+    const std::string& prefix,
+    proto_ns::RepeatedPtrField<ProtoString>* replica_streams,
+    proto_ns::RepeatedPtrField<ProtoString>* channel_streams) {
+  std::set<std::string> names;
+  int untagged_index = 0;
+  for (const std::string& stream : streams) {
+    std::string tag, name;
+    int index;
+    MP_RETURN_IF_ERROR(ParseTagIndexName(stream, &tag, &index, &name));
+    if (index == -1) index = untagged_index++;
+    const std::string replica_name =
+        absl::StrCat(prefix, "replica", channel, "__", name);
+    *replica_streams->Add() = TagIndexName(tag, index, replica_name);
+    // A stream the node consumes twice is still produced once.
+    if (!names.insert(name).second) continue;
+    *channel_streams->Add() = absl::StrCat(ReplicaChannelTag(tag, channel),
+                                           ":", index, ":", replica_name);
+  }
+  return absl::OkStatus();
+}
+
+// Adds to `nodes` the nodes running `node` as node.replicas() copies.
+static absl::Status ReplicateNode(
+    const CalculatorGraphConfig::Node& node, const std::string& node_name,
+    proto_ns::RepeatedPtrField<CalculatorGraphConfig::Node>* nodes) {
+  if (node.input_stream().empty() || !node.output_side_packet().empty()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Node \"" << node_name
+           << "\" can only be replicated with input streams and without "
+              "output side packets.";
+  }
+  const std::string prefix = StreamNamePrefix(node_name);
+  const std::string select_stream = absl::StrCat(prefix, "replica_select");
+
+  CalculatorGraphConfig::Node* demux = nodes->Add();
+  demux->set_name(absl::StrCat(node_name, "__replica_demux"));
+  demux->set_calculator("ReplicaDemuxCalculator");
+  *demux->mutable_input_stream() = node.input_stream();
+  *demux->mutable_input_stream_info() = node.input_stream_info();
+  demux->add_output_stream(absl::StrCat("SELECT:", select_stream));
+
+  CalculatorGraphConfig::Node* mux = nodes->Add();
+  mux->set_name(absl::StrCat(node_name, "__replica_mux"));
+  mux->set_calculator("SwitchMuxCalculator");
+  mux->add_input_stream(absl::StrCat("SELECT:", select_stream));
+  *mux->mutable_output_stream() = node.output_stream();
+
+  for (int channel = 0; channel < node.replicas(); ++channel) {
+    CalculatorGraphConfig::Node* replica = nodes->Add();
+    *replica = node;
+    replica->set_name(absl::StrCat(node_name, "__replica", channel));
+    replica->set_replicas(1);
+    replica->clear_input_stream();
+    replica->clear_output_stream();
+    replica->clear_input_stream_info();
+    MP_RETURN_IF_ERROR(ConnectReplica(
+        node.input_stream(), channel, prefix, replica->mutable_input_stream(),
+        demux->mutable_output_stream()));
+    MP_RETURN_IF_ERROR(ConnectReplica(
+        node.output_stream(), channel, prefix,
+        replica->mutable_output_stream(), mux->mutable_input_stream()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReplicateNodes(CalculatorGraphConfig* config) {
+  const auto& nodes = config->node();
+  if (std::none_of(nodes.begin(), nodes.end(),
+                   [](const CalculatorGraphConfig::Node& node) {
+                     return node.replicas() > 1;
+                   })) {
+    return absl::OkStatus();
+  }
+  std::vector<std::string> node_names(config->node_size());
+  for (int node_id = 0; node_id < config->node_size(); ++node_id) {
+    node_names[node_id] = CanonicalNodeName(*config, node_id);
+  }
+  proto_ns::RepeatedPtrField<CalculatorGraphConfig::Node> result;
+  for (int node_id = 0; node_id < config->node_size(); ++node_id) {
+    CalculatorGraphConfig::Node* node = config->mutable_node(node_id);
+    if (node->replicas() <= 1) {
+      result.Add()->Swap(node);
+      continue;
+    }
+    MP_RETURN_IF_ERROR(ReplicateNode(*node, node_names[node_id], &result));
+  }
+  config->mutable_node()->Swap(&result);
+  return absl::OkStatus();
+}
+
+void AddSubgraphExecutors(const CalculatorGraphConfig& subgraph_config,
+                          CalculatorGraphConfig* config) {
+  for (const ExecutorConfig& executor : subgraph_config.executor()) {
+    // The default executor is the graph's own.
+    if (executor.name().empty()) continue;
+    const bool declared = std::any_of(
+        config->executor().begin(), config->executor().end(),
+        [&executor](const ExecutorConfig& graph_executor) {
+          return graph_executor.name() == executor.name();
+        });
+    if (!declared) *config->add_executor() = executor;
+  }
+}
+
 absl::Status ExpandSubgraphs(CalculatorGraphConfig* config,
                              const GraphRegistry* graph_registry,
                              const Subgraph::SubgraphOptions* graph_options,
@@ -284,6 +440,7 @@ absl::Status ExpandSubgraphs(CalculatorGraphConfig* config,
       graph_options ? *graph_options : CalculatorGraphConfig::Node(), config));
   auto* nodes = config->mutable_node();
   while (1) {
+    MP_RETURN_IF_ERROR(ReplicateNodes(config));
     auto subgraph_nodes_start = std::stable_partition(
         nodes->begin(), nodes->end(),
         [config, graph_registry](CalculatorGraphConfig::Node& node) {
@@ -304,6 +461,9 @@ absl::Status ExpandSubgraphs(CalculatorGraphConfig* config,
       MP_RETURN_IF_ERROR(mediapipe::tool::DefineGraphOptions(node, &subgraph));
       MP_RETURN_IF_ERROR(PrefixNames(node_name, &subgraph));
       MP_RETURN_IF_ERROR(ConnectSubgraphStreams(node, &subgraph));
+      ApplySubgraphMaxInFlight(node, &subgraph);
+      ApplySubgraphExecutor(node, &subgraph);
+      ApplySubgraphReplicas(node, &subgraph);
       subgraphs.push_back(subgraph);
     }
     nodes->erase(subgraph_nodes_start, nodes->end());
@@ -318,6 +478,7 @@ absl::Status ExpandSubgraphs(CalculatorGraphConfig* config,
                 subgraph.status_handler().end(),
                 proto_ns::RepeatedPtrFieldBackInserter(
                     config->mutable_status_handler()));
+      AddSubgraphExecutors(subgraph, config);
     }
   }
   return absl::OkStatus();
@@ -66,9 +66,44 @@ absl::Status ConnectSubgraphStreams(
     const CalculatorGraphConfig::Node& subgraph_node,
     CalculatorGraphConfig* subgraph_config);
 
+// Applies the max_in_flight of the wrapping node, if greater than 1, to the
+// nodes of a subgraph config that don't set their own. This lets a stateless
+// subgraph, such as the body of a loop, process several timestamps at once.
+void ApplySubgraphMaxInFlight(const CalculatorGraphConfig::Node& subgraph_node,
+                              CalculatorGraphConfig* subgraph_config);
+
+// Applies the executor of the wrapping node, if any, to the nodes of a
+// subgraph config that don't set their own, so that a whole branch of a graph
+// can run on its own executor, concurrently with the other branches.
+void ApplySubgraphExecutor(const CalculatorGraphConfig::Node& subgraph_node,
+                           CalculatorGraphConfig* subgraph_config);
+
+// Applies the replicas of the wrapping node, if 1, to the nodes of a subgraph
+// config that don't set their own, so that they are checked to be stateless.
+// A wrapping node with more replicas is first replaced by its copies, which
+// have replicas set to 1.
+void ApplySubgraphReplicas(const CalculatorGraphConfig::Node& subgraph_node,
+                           CalculatorGraphConfig* subgraph_config);
+
+// Replaces each node in the given config with replicas greater than 1 by
+// that many copies of it, which process successive timestamps in turn:
+//   - a ReplicaDemuxCalculator sends the input packets of each timestamp to
+//     the next copy, and the index of that copy to a SELECT stream,
+//   - each copy has replicas set to 1 and its own renamed streams,
+//   - a SwitchMuxCalculator merges the outputs of the copies, in timestamp
+//     order, into the output streams of the node.
+absl::Status ReplicateNodes(CalculatorGraphConfig* config);
+
+// Adds the named executors declared by a subgraph config to the graph config,
+// unless the graph declares an executor of the same name, which takes
+// precedence.
+void AddSubgraphExecutors(const CalculatorGraphConfig& subgraph_config,
+                          CalculatorGraphConfig* config);
+
 // Replaces subgraph nodes in the given config with the contents of the
 // corresponding subgraphs. Nested subgraphs are retrieved from the
-// graph registry and expanded recursively.
+// graph registry and expanded recursively. Replicated nodes are replaced as
+// by ReplicateNodes() first, at each level of nesting.
 absl::Status ExpandSubgraphs(
     CalculatorGraphConfig* config,
     const GraphRegistry* graph_registry = nullptr,
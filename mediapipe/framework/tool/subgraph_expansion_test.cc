@@ -31,6 +31,7 @@
 #include "mediapipe/framework/port/status_matchers.h"
 #include "mediapipe/framework/status_handler.h"
 #include "mediapipe/framework/subgraph.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
 #include "mediapipe/framework/tool/node_chain_subgraph.pb.h"
 
 namespace mediapipe {
@@ -192,6 +193,39 @@ class EnclosingSubgraph : public Subgraph {
 };
 REGISTER_MEDIAPIPE_GRAPH(EnclosingSubgraph);
 
+// A subgraph that declares an executor, used by one of its two nodes.
+class ExecutorDeclaringSubgraph : public Subgraph {
+ public:
+  absl::StatusOr<CalculatorGraphConfig> GetConfig(
+      const SubgraphOptions& options) override {
+    CalculatorGraphConfig config =
+        mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+          input_stream: "IN:in"
+          output_stream: "OUT:out"
+          executor {
+            name: "branch_pool"
+            type: "ThreadPoolExecutor"
+            options {
+              [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 1 }
+            }
+          }
+          node {
+            calculator: "PassThroughCalculator"
+            input_stream: "in"
+            output_stream: "mid"
+            executor: "branch_pool"
+          }
+          node {
+            calculator: "PassThroughCalculator"
+            input_stream: "mid"
+            output_stream: "out"
+          }
+        )pb");
+    return config;
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(ExecutorDeclaringSubgraph);
+
 TEST(SubgraphExpansionTest, TransformStreamNames) {
   CalculatorGraphConfig config =
       mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
@@ -527,6 +561,172 @@ TEST(SubgraphExpansionTest, ExecutorFieldOfNodeInSubgraphPreserved) {
   EXPECT_THAT(supergraph, mediapipe::EqualsProto(expected_graph));
 }
 
+// The max_in_flight of a subgraph node applies to the nodes of nested
+// subgraphs as well.
+TEST(SubgraphExpansionTest, MaxInFlightOfSubgraphNodeApplied) {
+  CalculatorGraphConfig supergraph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "EnclosingSubgraph"
+          input_stream: "IN:input"
+          output_stream: "OUT:output"
+          max_in_flight: 4
+        }
+      )pb");
+  CalculatorGraphConfig expected_graph = mediapipe::ParseTextProtoOrDie<
+      CalculatorGraphConfig>(R"pb(
+    input_stream: "input"
+    node {
+      calculator: "PassThroughCalculator"
+      name: "enclosingsubgraph__nodewithexecutorsubgraph__PassThroughCalculator"
+      input_stream: "input"
+      output_stream: "output"
+      executor: "custom_thread_pool"
+      max_in_flight: 4
+    }
+  )pb");
+  MP_EXPECT_OK(tool::ExpandSubgraphs(&supergraph));
+  EXPECT_THAT(supergraph, mediapipe::EqualsProto(expected_graph));
+}
+
+// A replicated subgraph node is replaced by a demux node, a mux node, and its
+// copies, whose nodes are checked to be stateless.
+TEST(SubgraphExpansionTest, ReplicasOfSubgraphNodeApplied) {
+  CalculatorGraphConfig supergraph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "NodeWithExecutorSubgraph"
+          input_stream: "INPUT:input"
+          output_stream: "OUTPUT:output"
+          replicas: 2
+        }
+      )pb");
+  CalculatorGraphConfig expected_graph = mediapipe::ParseTextProtoOrDie<
+      CalculatorGraphConfig>(R"pb(
+    input_stream: "input"
+    node {
+      name: "NodeWithExecutorSubgraph__replica_demux"
+      calculator: "ReplicaDemuxCalculator"
+      input_stream: "INPUT:input"
+      output_stream: "SELECT:nodewithexecutorsubgraph__replica_select"
+      output_stream: "C0__INPUT:0:nodewithexecutorsubgraph__replica0__input"
+      output_stream: "C1__INPUT:0:nodewithexecutorsubgraph__replica1__input"
+    }
+    node {
+      name: "NodeWithExecutorSubgraph__replica_mux"
+      calculator: "SwitchMuxCalculator"
+      input_stream: "SELECT:nodewithexecutorsubgraph__replica_select"
+      input_stream: "C0__OUTPUT:0:nodewithexecutorsubgraph__replica0__output"
+      input_stream: "C1__OUTPUT:0:nodewithexecutorsubgraph__replica1__output"
+      output_stream: "OUTPUT:output"
+    }
+    node {
+      name: "nodewithexecutorsubgraph__replica0__PassThroughCalculator"
+      calculator: "PassThroughCalculator"
+      input_stream: "nodewithexecutorsubgraph__replica0__input"
+      output_stream: "nodewithexecutorsubgraph__replica0__output"
+      executor: "custom_thread_pool"
+      replicas: 1
+    }
+    node {
+      name: "nodewithexecutorsubgraph__replica1__PassThroughCalculator"
+      calculator: "PassThroughCalculator"
+      input_stream: "nodewithexecutorsubgraph__replica1__input"
+      output_stream: "nodewithexecutorsubgraph__replica1__output"
+      executor: "custom_thread_pool"
+      replicas: 1
+    }
+  )pb");
+  MP_EXPECT_OK(tool::ExpandSubgraphs(&supergraph));
+  EXPECT_THAT(supergraph, mediapipe::EqualsProto(expected_graph));
+}
+
+// The executor of a subgraph node applies to the nodes without their own, and
+// the executors declared by the subgraph are added to the graph.
+TEST(SubgraphExpansionTest, ExecutorOfSubgraphNodeApplied) {
+  CalculatorGraphConfig supergraph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        executor {
+          name: "outer_pool"
+          type: "ThreadPoolExecutor"
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 2 }
+          }
+        }
+        node {
+          calculator: "ExecutorDeclaringSubgraph"
+          input_stream: "IN:input"
+          output_stream: "OUT:output"
+          executor: "outer_pool"
+        }
+      )pb");
+  CalculatorGraphConfig expected_graph = mediapipe::ParseTextProtoOrDie<
+      CalculatorGraphConfig>(R"pb(
+    input_stream: "input"
+    executor {
+      name: "outer_pool"
+      type: "ThreadPoolExecutor"
+      options {
+        [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 2 }
+      }
+    }
+    executor {
+      name: "branch_pool"
+      type: "ThreadPoolExecutor"
+      options {
+        [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 1 }
+      }
+    }
+    node {
+      calculator: "PassThroughCalculator"
+      name: "executordeclaringsubgraph__PassThroughCalculator_1"
+      input_stream: "input"
+      output_stream: "executordeclaringsubgraph__mid"
+      executor: "branch_pool"
+    }
+    node {
+      calculator: "PassThroughCalculator"
+      name: "executordeclaringsubgraph__PassThroughCalculator_2"
+      input_stream: "executordeclaringsubgraph__mid"
+      output_stream: "output"
+      executor: "outer_pool"
+    }
+  )pb");
+  MP_EXPECT_OK(tool::ExpandSubgraphs(&supergraph));
+  EXPECT_THAT(supergraph, mediapipe::EqualsProto(expected_graph));
+}
+
+// An executor declared by the graph takes precedence over the one of the same
+// name declared by a subgraph.
+TEST(SubgraphExpansionTest, GraphExecutorOverridesSubgraphExecutor) {
+  CalculatorGraphConfig supergraph =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        executor {
+          name: "branch_pool"
+          type: "ThreadPoolExecutor"
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 4 }
+          }
+        }
+        node {
+          calculator: "ExecutorDeclaringSubgraph"
+          input_stream: "IN:input"
+          output_stream: "OUT:output"
+        }
+      )pb");
+  MP_EXPECT_OK(tool::ExpandSubgraphs(&supergraph));
+  ASSERT_EQ(supergraph.executor_size(), 1);
+  EXPECT_EQ(supergraph.executor(0)
+                .options()
+                .GetExtension(ThreadPoolExecutorOptions::ext)
+                .num_threads(),
+            4);
+}
+
 const mediapipe::GraphService<std::string> kStringTestService{
     "mediapipe::StringTestService"};
 class GraphServicesClientTestSubgraph : public Subgraph {
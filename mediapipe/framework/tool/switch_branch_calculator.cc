@@ -0,0 +1,316 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/collection_item_id.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/framework/tool/switch_container.pb.h"
+#include "mediapipe/framework/tool/tag_map.h"
+#include "mediapipe/framework/validated_graph_config.h"
+#include "mediapipe/gpu/gpu_service.h"
+
+namespace mediapipe {
+
+// A calculator running a contained node of a SwitchContainer in a graph of
+// its own, which is started only when the first packet arrives, so that the
+// node isn't opened, and doesn't load its models, until its channel is
+// selected. For example:
+//
+//         node {
+//           calculator: "SwitchBranchCalculator"
+//           input_stream: "FUNC_INPUT:c1__foo"
+//           output_stream: "FUNC_OUTPUT:c1__bar"
+//           node_options {
+//             [type.googleapis.com/mediapipe.SwitchBranchCalculatorOptions] {
+//               node {
+//                 calculator: "AdvancedSubgraph"
+//                 input_stream: "FUNC_INPUT:c1__foo"
+//                 output_stream: "FUNC_OUTPUT:c1__bar"
+//               }
+//             }
+//           }
+//         }
+//
+// The contained graph runs on the thread calling Process, which waits for it
+// to become idle before sending its outputs. Timestamp bounds are passed
+// through the contained graph in both directions.
+//
+// SwitchBranchCalculator is used by SwitchContainer with lazy_open.
+//
+class SwitchBranchCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  // Returns the contained graph, started and opened.
+  absl::StatusOr<std::unique_ptr<CalculatorGraph>> StartGraph();
+  // Waits for a preopen to finish, and takes its graph.
+  absl::Status WaitForPreopen();
+  // Starts the contained graph unless it is running.
+  absl::Status EnsureGraphRunning();
+  // Closes the contained graph and releases its resources.
+  absl::Status CloseGraph();
+  // Sends the packets and timestamp bounds output by the contained graph.
+  // Unless final, those at or after Timestamp::PostStream() are dropped.
+  void SendOutputs(CalculatorContext* cc, bool final);
+
+  CalculatorGraphConfig config_;
+  // The output streams and their names in the contained graph.
+  std::vector<std::pair<CollectionItemId, std::string>> output_streams_;
+  std::map<std::string, Packet> side_packets_;
+  std::shared_ptr<GpuResources> gpu_resources_;
+  absl::Duration idle_timeout_ = absl::ZeroDuration();
+  absl::Time last_packet_time_;
+
+  std::unique_ptr<CalculatorGraph> graph_;
+  // Runs StartGraph in the background for preopen.
+  std::unique_ptr<ThreadPool> preopen_thread_;
+  absl::StatusOr<std::unique_ptr<CalculatorGraph>> preopened_graph_;
+
+  absl::Mutex output_mutex_;
+  std::vector<std::pair<CollectionItemId, Packet>> outputs_
+      ABSL_GUARDED_BY(output_mutex_);
+};
+REGISTER_CALCULATOR(SwitchBranchCalculator);
+
+namespace {
+
+// Returns the config of a graph running the contained node on the calling
+// thread, connected to streams and side packets named as those of the
+// SwitchBranchCalculator, which are renamed by subgraph expansion.
+template <class CC>
+CalculatorGraphConfig BranchGraphConfig(CC* cc) {
+  const auto& options = cc->template Options<SwitchBranchCalculatorOptions>();
+  CalculatorGraphConfig config;
+  for (const std::string& name : cc->Inputs().TagMap()->Names()) {
+    config.add_input_stream(name);
+  }
+  for (const std::string& name : cc->Outputs().TagMap()->Names()) {
+    config.add_output_stream(name);
+  }
+  for (const std::string& name : cc->InputSidePackets().TagMap()->Names()) {
+    config.add_input_side_packet(name);
+  }
+  config.add_executor()->set_type("ApplicationThreadExecutor");
+  CalculatorGraphConfig::Node* contained = config.add_node();
+  *contained = options.node();
+  contained->clear_executor();
+  *contained->mutable_input_stream() =
+      cc->Inputs().TagMap()->CanonicalEntries();
+  *contained->mutable_output_stream() =
+      cc->Outputs().TagMap()->CanonicalEntries();
+  *contained->mutable_input_side_packet() =
+      cc->InputSidePackets().TagMap()->CanonicalEntries();
+  return config;
+}
+
+}  // namespace
+
+absl::Status SwitchBranchCalculator::GetContract(CalculatorContract* cc) {
+  const auto& options = cc->Options<SwitchBranchCalculatorOptions>();
+  RET_CHECK(options.has_node());
+  for (CollectionItemId id = cc->Inputs().BeginId();
+       id < cc->Inputs().EndId(); ++id) {
+    cc->Inputs().Get(id).SetAny();
+  }
+  for (CollectionItemId id = cc->Outputs().BeginId();
+       id < cc->Outputs().EndId(); ++id) {
+    cc->Outputs().Get(id).SetAny();
+  }
+  for (CollectionItemId id = cc->InputSidePackets().BeginId();
+       id < cc->InputSidePackets().EndId(); ++id) {
+    cc->InputSidePackets().Get(id).SetAny().Optional();
+  }
+  RET_CHECK_EQ(cc->OutputSidePackets().NumEntries(), 0)
+      << "Lazily opened nodes can't produce output side packets.";
+
+  // Requests the GPU service if the contained node does, so that the graph
+  // sets up the GPU as it would for the node itself.
+  ValidatedGraphConfig validated_graph;
+  MP_RETURN_IF_ERROR(validated_graph.Initialize(BranchGraphConfig(cc)));
+  for (const auto& node : validated_graph.CalculatorInfos()) {
+    const auto& requests = node.Contract().ServiceRequests();
+    auto it = requests.find(kGpuService.key);
+    if (it != requests.end()) {
+      auto& request = cc->UseService(kGpuService);
+      if (it->second.IsOptional()) request.Optional();
+    }
+  }
+
+  cc->SetProcessTimestampBounds(true);
+  return absl::OkStatus();
+}
+
+absl::Status SwitchBranchCalculator::Open(CalculatorContext* cc) {
+  const auto& options = cc->Options<SwitchBranchCalculatorOptions>();
+  config_ = BranchGraphConfig(cc);
+  idle_timeout_ = absl::Milliseconds(options.idle_timeout_ms());
+  const auto& output_names = cc->Outputs().TagMap()->Names();
+  for (CollectionItemId id = cc->Outputs().BeginId();
+       id < cc->Outputs().EndId(); ++id) {
+    output_streams_.emplace_back(id, output_names[id.value()]);
+  }
+  const auto& side_packet_names = cc->InputSidePackets().TagMap()->Names();
+  for (CollectionItemId id = cc->InputSidePackets().BeginId();
+       id < cc->InputSidePackets().EndId(); ++id) {
+    if (!cc->InputSidePackets().Get(id).IsEmpty()) {
+      side_packets_[side_packet_names[id.value()]] =
+          cc->InputSidePackets().Get(id);
+    }
+  }
+  if (cc->Service(kGpuService).IsAvailable()) {
+    gpu_resources_ = cc->Service(kGpuService).GetSharedObject();
+  }
+
+  if (options.preopen()) {
+    preopen_thread_ = std::make_unique<ThreadPool>("switch_branch_preopen",
+                                                   /*num_threads=*/1);
+    preopen_thread_->StartWorkers();
+    preopen_thread_->Schedule([this] { preopened_graph_ = StartGraph(); });
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<CalculatorGraph>>
+SwitchBranchCalculator::StartGraph() {
+  auto graph = std::make_unique<CalculatorGraph>();
+  MP_RETURN_IF_ERROR(graph->Initialize(config_));
+  for (const auto& [id, name] : output_streams_) {
+    MP_RETURN_IF_ERROR(graph->ObserveOutputStream(
+        name,
+        [this, id = id](const Packet& packet) {
+          absl::MutexLock lock(&output_mutex_);
+          outputs_.emplace_back(id, packet);
+          return absl::OkStatus();
+        },
+        /*observe_timestamp_bounds=*/true));
+  }
+#if !MEDIAPIPE_DISABLE_GPU
+  if (gpu_resources_) {
+    MP_RETURN_IF_ERROR(graph->SetGpuResources(gpu_resources_));
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU
+  MP_RETURN_IF_ERROR(graph->StartRun(side_packets_));
+  // Runs the Open of the contained calculators on this thread.
+  MP_RETURN_IF_ERROR(graph->WaitUntilIdle());
+  return graph;
+}
+
+absl::Status SwitchBranchCalculator::WaitForPreopen() {
+  if (!preopen_thread_) return absl::OkStatus();
+  // Destroying the thread pool waits for its task.
+  preopen_thread_.reset();
+  ASSIGN_OR_RETURN(graph_, std::move(preopened_graph_));
+  return absl::OkStatus();
+}
+
+absl::Status SwitchBranchCalculator::EnsureGraphRunning() {
+  MP_RETURN_IF_ERROR(WaitForPreopen());
+  if (!graph_) {
+    ASSIGN_OR_RETURN(graph_, StartGraph());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SwitchBranchCalculator::CloseGraph() {
+  MP_RETURN_IF_ERROR(WaitForPreopen());
+  if (!graph_) return absl::OkStatus();
+  MP_RETURN_IF_ERROR(graph_->CloseAllInputStreams());
+  absl::Status status = graph_->WaitUntilDone();
+  graph_.reset();
+  return status;
+}
+
+absl::Status SwitchBranchCalculator::Process(CalculatorContext* cc) {
+  bool has_packets = false;
+  for (CollectionItemId id = cc->Inputs().BeginId();
+       id < cc->Inputs().EndId(); ++id) {
+    has_packets = has_packets || !cc->Inputs().Get(id).IsEmpty();
+  }
+  if (has_packets) {
+    last_packet_time_ = absl::Now();
+    MP_RETURN_IF_ERROR(EnsureGraphRunning());
+  } else if (graph_ && idle_timeout_ > absl::ZeroDuration() &&
+             absl::Now() - last_packet_time_ > idle_timeout_) {
+    MP_RETURN_IF_ERROR(CloseGraph());
+    SendOutputs(cc, /*final=*/false);
+  }
+
+  const Timestamp bound = cc->InputTimestamp().NextAllowedInStream();
+  if (!graph_) {
+    // Nothing is running, so the outputs settle with the inputs.
+    for (CollectionItemId id = cc->Outputs().BeginId();
+         id < cc->Outputs().EndId(); ++id) {
+      cc->Outputs().Get(id).SetNextTimestampBound(bound);
+    }
+    return absl::OkStatus();
+  }
+
+  const auto& input_names = cc->Inputs().TagMap()->Names();
+  for (CollectionItemId id = cc->Inputs().BeginId();
+       id < cc->Inputs().EndId(); ++id) {
+    const Packet& packet = cc->Inputs().Get(id).Value();
+    if (!packet.IsEmpty()) {
+      MP_RETURN_IF_ERROR(
+          graph_->AddPacketToInputStream(input_names[id.value()], packet));
+    } else {
+      MP_RETURN_IF_ERROR(
+          graph_->SetInputStreamTimestampBound(input_names[id.value()], bound));
+    }
+  }
+  MP_RETURN_IF_ERROR(graph_->WaitUntilIdle());
+  SendOutputs(cc, /*final=*/false);
+  return absl::OkStatus();
+}
+
+absl::Status SwitchBranchCalculator::Close(CalculatorContext* cc) {
+  MP_RETURN_IF_ERROR(CloseGraph());
+  SendOutputs(cc, /*final=*/true);
+  return absl::OkStatus();
+}
+
+void SwitchBranchCalculator::SendOutputs(CalculatorContext* cc, bool final) {
+  std::vector<std::pair<CollectionItemId, Packet>> outputs;
+  {
+    absl::MutexLock lock(&output_mutex_);
+    outputs.swap(outputs_);
+  }
+  for (auto& [id, packet] : outputs) {
+    if (!final && packet.Timestamp() >= Timestamp::PostStream()) continue;
+    OutputStreamShard& output = cc->Outputs().Get(id);
+    if (packet.IsEmpty()) {
+      output.SetNextTimestampBound(packet.Timestamp().NextAllowedInStream());
+    } else {
+      output.AddPacket(std::move(packet));
+    }
+  }
+}
+
+}  // namespace mediapipe
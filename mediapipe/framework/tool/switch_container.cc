@@ -20,6 +20,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -67,6 +68,11 @@ using mediapipe::SwitchContainerOptions;
 // which can be used to accept infrequent "enable" packets asynchronously.
 // However, it can be overridden to work with DefaultInputStreamHandler,
 // which can be used to accept frequent "enable" packets synchronously.
+//
+// With option "lazy_open", each contained node is opened only when its channel
+// is first selected, so that unselected channels don't load their models.
+// Options "preopen_channel" and "idle_timeout_ms" open channels ahead of their
+// selection, and close channels that are no longer selected.
 class SwitchContainer : public Subgraph {
  public:
   SwitchContainer() = default;
@@ -228,6 +234,11 @@ absl::Status ValidateContract(
         "Only one of SwitchContainer inputs 'ENABLE' and 'SELECT' can be "
         "specified");
   }
+  if (options.lazy_open() && subgraph_node.output_side_packet_size() > 0) {
+    return absl::InvalidArgumentError(
+        "SwitchContainer option 'lazy_open' doesn't support output side "
+        "packets");
+  }
   return absl::OkStatus();
 }
 
@@ -248,6 +259,25 @@ bool ContainsTag(const proto_ns::RepeatedPtrField<std::string>& tags,
   return false;
 }
 
+// Replaces a contained node with a SwitchBranchCalculator running it, so that
+// it is opened only once its channel is selected.
+void WrapLazyNode(const SwitchContainerOptions& options, int channel,
+                  CalculatorGraphConfig::Node* node) {
+  SwitchBranchCalculatorOptions branch_options;
+  *branch_options.mutable_node() = *node;
+  branch_options.set_preopen(
+      absl::c_linear_search(options.preopen_channel(), channel));
+  branch_options.set_idle_timeout_ms(options.idle_timeout_ms());
+  CalculatorGraphConfig::Node branch;
+  branch.set_calculator("SwitchBranchCalculator");
+  *branch.mutable_input_stream() = node->input_stream();
+  *branch.mutable_output_stream() = node->output_stream();
+  *branch.mutable_input_side_packet() = node->input_side_packet();
+  *branch.mutable_output_side_packet() = node->output_side_packet();
+  branch.add_node_options()->PackFrom(branch_options);
+  *node = std::move(branch);
+}
+
 absl::StatusOr<CalculatorGraphConfig> SwitchContainer::GetConfig(
     const Subgraph::SubgraphOptions& options) {
   CalculatorGraphConfig config;
@@ -410,6 +440,11 @@ absl::StatusOr<CalculatorGraphConfig> SwitchContainer::GetConfig(
     }
   }
 
+  if (switch_options.lazy_open()) {
+    for (int channel = 0; channel < subnodes.size(); ++channel) {
+      WrapLazyNode(switch_options, channel, subnodes[channel]);
+    }
+  }
   return config;
 }
 
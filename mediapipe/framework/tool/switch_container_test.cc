@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -19,6 +20,8 @@
 
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/gmock.h"
@@ -489,5 +492,140 @@ TEST(SwitchContainerTest, ValidateSideInputs) {
                                   "'ENABLE' and 'SELECT' can be specified")));
 }
 
+// Shows the SwitchContainer runs with contained nodes opened lazily.
+TEST(SwitchContainerTest, RunsWithLazyOpen) {
+  CalculatorGraphConfig supergraph =
+      SubnodeContainerExample("async_selection: true lazy_open: true");
+  MP_EXPECT_OK(tool::ExpandSubgraphs(&supergraph));
+  RunTestContainer(supergraph);
+}
+
+TEST(SwitchContainerTest, RunsWithLazyOpenAndInputStreamHandler) {
+  CalculatorGraphConfig supergraph =
+      SubnodeContainerExample("lazy_open: true synchronize_io: true");
+  MP_EXPECT_OK(tool::ExpandSubgraphs(&supergraph));
+  RunTestContainer(supergraph, true);
+}
+
+// A Calculator passing through its input packets, which counts the times it
+// is opened and closed.
+class OpenCountingCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) final {
+    cc->SetOffset(TimestampDiff(0));
+    ++num_opens;
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+
+  absl::Status Close(CalculatorContext* cc) final {
+    ++num_closes;
+    return absl::OkStatus();
+  }
+
+  static inline std::atomic<int> num_opens = 0;
+  static inline std::atomic<int> num_closes = 0;
+};
+REGISTER_CALCULATOR(OpenCountingCalculator);
+
+// Returns a graph switching between a TripleIntCalculator and an
+// OpenCountingCalculator, which are opened lazily.
+CalculatorGraphConfig LazyContainerExample(const std::string& options) {
+  std::string config = R"pb(
+    input_stream: "foo"
+    input_stream: "select"
+    output_stream: "bar"
+    node {
+      calculator: "SwitchContainer"
+      input_stream: "SELECT:select"
+      input_stream: "foo"
+      output_stream: "bar"
+      options {
+        [mediapipe.SwitchContainerOptions.ext] {
+          contained_node: { calculator: "TripleIntCalculator" }
+          contained_node: { calculator: "OpenCountingCalculator" }
+          lazy_open: true
+          $options
+        }
+      }
+    }
+  )pb";
+  return mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+      absl::StrReplaceAll(config, {{"$options", options}}));
+}
+
+// Sends a packet to the channel selected at a timestamp.
+void SendToChannel(CalculatorGraph& graph, int channel, int64 t) {
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "select", MakePacket<int>(channel).At(Timestamp(t))));
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      "foo", MakePacket<int>(1).At(Timestamp(t))));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+}
+
+TEST(SwitchContainerTest, LazyOpenOpensChannelWhenSelected) {
+  OpenCountingCalculator::num_opens = 0;
+  CalculatorGraph graph;
+  std::vector<Packet> out_bar;
+  CalculatorGraphConfig config = LazyContainerExample("");
+  tool::AddVectorSink("bar", &config, &out_bar);
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  SendToChannel(graph, 0, 10);
+  SendToChannel(graph, 0, 20);
+  EXPECT_EQ(OpenCountingCalculator::num_opens, 0);
+  SendToChannel(graph, 1, 30);
+  SendToChannel(graph, 1, 40);
+  EXPECT_EQ(OpenCountingCalculator::num_opens, 1);
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(out_bar.size(), 4);
+  EXPECT_EQ(out_bar[0].Get<int>(), 3);
+  EXPECT_EQ(out_bar[3].Get<int>(), 1);
+  EXPECT_EQ(out_bar[3].Timestamp(), Timestamp(40));
+}
+
+TEST(SwitchContainerTest, LazyOpenPreopensChannel) {
+  OpenCountingCalculator::num_opens = 0;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(LazyContainerExample("preopen_channel: 1")));
+  MP_ASSERT_OK(graph.StartRun({}));
+  SendToChannel(graph, 0, 10);
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(OpenCountingCalculator::num_opens, 1);
+}
+
+TEST(SwitchContainerTest, LazyOpenClosesIdleChannel) {
+  OpenCountingCalculator::num_opens = 0;
+  OpenCountingCalculator::num_closes = 0;
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(LazyContainerExample("idle_timeout_ms: 1")));
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  SendToChannel(graph, 1, 10);
+  absl::SleepFor(absl::Milliseconds(10));
+  SendToChannel(graph, 0, 20);
+  EXPECT_EQ(OpenCountingCalculator::num_closes, 1);
+  SendToChannel(graph, 1, 30);
+  EXPECT_EQ(OpenCountingCalculator::num_opens, 2);
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(OpenCountingCalculator::num_closes, 2);
+}
+
 }  // namespace
 }  // namespace mediapipe
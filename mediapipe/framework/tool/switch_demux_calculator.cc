@@ -64,10 +64,15 @@ class SwitchDemuxCalculator : public CalculatorBase {
  private:
   absl::Status RecordPackets(CalculatorContext* cc);
   int ChannelIndex(Timestamp timestamp);
+  void SetInactiveChannelBounds(CalculatorContext* cc, const std::string& tag,
+                                int index, int active_channel,
+                                Timestamp timestamp);
   absl::Status SendActivePackets(CalculatorContext* cc);
 
  private:
   int channel_index_;
+  // Whether to advance the timestamp bounds of the inactive channels.
+  bool bound_inactive_channels_ = false;
   std::set<std::string> channel_tags_;
   using PacketQueue = std::map<CollectionItemId, std::queue<Packet>>;
   PacketQueue input_queue_;
@@ -153,6 +158,11 @@ absl::Status SwitchDemuxCalculator::Open(CalculatorContext* cc) {
   channel_index_ = tool::GetChannelIndex(*cc, channel_index_);
   channel_tags_ = ChannelTags(cc->Outputs().TagMap());
   channel_history_[Timestamp::Unstarted()] = channel_index_;
+  // Lazily opened channels close when idle, which they learn from the
+  // timestamp bounds.
+  const auto& options = cc->Options<mediapipe::SwitchContainerOptions>();
+  bound_inactive_channels_ =
+      options.lazy_open() && options.idle_timeout_ms() > 0;
 
   // Relay side packets to all channels.
   // Note: This is necessary because Calculator::Open only proceeds when every
@@ -227,6 +237,23 @@ int SwitchDemuxCalculator::ChannelIndex(Timestamp timestamp) {
   return it->second;
 }
 
+// Advances the outputs of the channels not receiving a packet past it.
+void SwitchDemuxCalculator::SetInactiveChannelBounds(CalculatorContext* cc,
+                                                     const std::string& tag,
+                                                     int index,
+                                                     int active_channel,
+                                                     Timestamp timestamp) {
+  int channel_count = tool::ChannelCount(cc->Outputs().TagMap());
+  for (int channel = 0; channel < channel_count; ++channel) {
+    if (channel == active_channel) continue;
+    auto output_id = cc->Outputs().GetId(tool::ChannelTag(tag, channel), index);
+    if (output_id.IsValid()) {
+      cc->Outputs().Get(output_id).SetNextTimestampBound(
+          timestamp.NextAllowedInStream());
+    }
+  }
+}
+
 // Dispatches all queued input packets with known channels.
 absl::Status SwitchDemuxCalculator::SendActivePackets(CalculatorContext* cc) {
   // Dispatch any queued input packets with a defined channel_index.
@@ -242,6 +269,10 @@ absl::Status SwitchDemuxCalculator::SendActivePackets(CalculatorContext* cc) {
         if (output_id.IsValid()) {
           cc->Outputs().Get(output_id).AddPacket(queue.front());
         }
+        if (bound_inactive_channels_) {
+          SetInactiveChannelBounds(cc, tag, index, channel_index,
+                                   queue.front().Timestamp());
+        }
         queue.pop();
       }
     }
@@ -81,7 +81,7 @@ class SwitchMuxCalculator : public CalculatorBase {
   void SendActivePackets(CalculatorContext* cc);
 
  private:
-  int channel_index_;
+  int channel_index_ = 0;
   std::set<std::string> channel_tags_;
   mediapipe::SwitchContainerOptions options_;
   // This is used to keep around packets that we've received but not
@@ -26,12 +26,18 @@
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/validated_graph_config.h"
 
 ABSL_FLAG(std::string, proto_source, "",
           "The template source file containing CalculatorGraphConfig "
           "protobuf text with inline template params.");
 ABSL_FLAG(std::string, proto_output, "",
           "An output template file in binary CalculatorGraphTemplate form.");
+ABSL_FLAG(bool, expand_graph, false,
+          "If true, outputs the canonical config of the graph, with its "
+          "subgraphs expanded and its nodes sorted, after validating it. "
+          "Initializing a graph from it skips the expansion. The calculators "
+          "and subgraphs of the graph must be linked in.");
 
 #define EXIT_IF_ERROR(status) \
   if (!status.ok()) {         \
@@ -110,6 +116,11 @@ int main(int argc, char** argv) {
   mediapipe::CalculatorGraphConfig config;
   EXIT_IF_ERROR(
       mediapipe::ReadFile(absl::GetFlag(FLAGS_proto_source), true, &config));
+  if (absl::GetFlag(FLAGS_expand_graph)) {
+    mediapipe::ValidatedGraphConfig validated_config;
+    EXIT_IF_ERROR(validated_config.Initialize(config));
+    config = validated_config.Config();
+  }
   EXIT_IF_ERROR(
       mediapipe::WriteFile(absl::GetFlag(FLAGS_proto_output), false, config));
   return EXIT_SUCCESS;
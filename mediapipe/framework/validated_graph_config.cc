@@ -15,12 +15,17 @@
 #include "mediapipe/framework/validated_graph_config.h"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_base.h"
 #include "mediapipe/framework/graph_service_manager.h"
@@ -41,6 +46,7 @@
 #include "mediapipe/framework/status_handler.h"
 #include "mediapipe/framework/stream_handler.pb.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
+#include "mediapipe/framework/tool/graph_optimization.h"
 #include "mediapipe/framework/tool/name_util.h"
 #include "mediapipe/framework/tool/status_util.h"
 #include "mediapipe/framework/tool/subgraph_expansion.h"
@@ -112,6 +118,24 @@ std::string DebugName(const CalculatorGraphConfig& config,
              << NodeTypeInfo::NodeTypeToString(node_type);
 }
 
+// The canonical configs of the initialized graphs, by ConfigCacheKey.
+struct ConfigCache {
+  absl::Mutex mutex;
+  bool enabled ABSL_GUARDED_BY(mutex) = false;
+  absl::flat_hash_map<std::string, CalculatorGraphConfig> configs
+      ABSL_GUARDED_BY(mutex);
+};
+
+ConfigCache& GetConfigCache() {
+  static ConfigCache* cache = new ConfigCache;
+  return *cache;
+}
+
+// Appends a length-prefixed `value` to the cache key.
+void AppendToCacheKey(absl::string_view value, std::string* key) {
+  absl::StrAppend(key, value.size(), ":", value);
+}
+
 // Adds the ExecutorConfigs for predefined executors, if they are not in
 // graph_config.
 //
@@ -245,6 +269,10 @@ absl::Status NodeTypeInfo::Initialize(
                      " failed to validate: "),
         statuses);
   }
+  if (node.replicas() > 0 && !contract_.IsStateless()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << node_class << " can't be replicated because it isn't stateless.";
+  }
   return absl::OkStatus();
 }
 
@@ -330,12 +358,35 @@ absl::Status ValidatedGraphConfig::Initialize(
           << input_config.DebugString();
 #endif
 
-  config_ = std::move(input_config);
-  MP_RETURN_IF_ERROR(
-      PerformBasicTransforms(graph_registry, graph_options, service_manager));
+  const std::string cache_key = ConfigCacheKey(input_config, graph_registry,
+                                               graph_options, service_manager);
+  bool cached = false;
+  if (!cache_key.empty()) {
+    ConfigCache& cache = GetConfigCache();
+    absl::MutexLock lock(&cache.mutex);
+    auto it = cache.configs.find(cache_key);
+    if (it != cache.configs.end()) {
+      config_ = it->second;
+      cached = true;
+    }
+  }
+  if (!cached) {
+    config_ = std::move(input_config);
+    MP_RETURN_IF_ERROR(
+        PerformBasicTransforms(graph_registry, graph_options, service_manager));
+  }
+  if (config_.optimize_graph()) {
+    ASSIGN_OR_RETURN(int num_fused, tool::ApplyNodeFusions(&config_));
+    if (num_fused > 0) {
+      VLOG(1) << "Fused " << num_fused << " nodes.";
+    }
+  }
   // Initialize the basic node information.
   MP_RETURN_IF_ERROR(InitializeGeneratorInfo());
   MP_RETURN_IF_ERROR(InitializeCalculatorInfo());
+  if (config_.optimize_graph()) {
+    MP_RETURN_IF_ERROR(OptimizePureNodes());
+  }
   MP_RETURN_IF_ERROR(InitializeStatusHandlerInfo());
 
   sorted_nodes_.reserve(generators_.size() + calculators_.size());
@@ -400,6 +451,12 @@ absl::Status ValidatedGraphConfig::Initialize(
 
   MP_RETURN_IF_ERROR(ValidateExecutors());
 
+  if (!cached && !cache_key.empty()) {
+    ConfigCache& cache = GetConfigCache();
+    absl::MutexLock lock(&cache.mutex);
+    if (cache.enabled) cache.configs.emplace(cache_key, config_);
+  }
+
 #if !defined(MEDIAPIPE_MOBILE)
   VLOG(1) << "ValidatedGraphConfig produced canonical config:\n"
           << config_.DebugString();
@@ -444,6 +501,44 @@ absl::Status ValidatedGraphConfig::Initialize(
                     service_manager);
 }
 
+// static
+void ValidatedGraphConfig::SetConfigCacheEnabled(bool enabled) {
+  ConfigCache& cache = GetConfigCache();
+  absl::MutexLock lock(&cache.mutex);
+  cache.enabled = enabled;
+  if (!enabled) cache.configs.clear();
+}
+
+// static
+std::string ValidatedGraphConfig::ConfigCacheKey(
+    const CalculatorGraphConfig& input_config,
+    const GraphRegistry* graph_registry,
+    const Subgraph::SubgraphOptions* graph_options,
+    const GraphServiceManager* service_manager) {
+  if (graph_registry != nullptr &&
+      graph_registry != &GraphRegistry::global_graph_registry) {
+    return "";
+  }
+  {
+    ConfigCache& cache = GetConfigCache();
+    absl::MutexLock lock(&cache.mutex);
+    if (!cache.enabled) return "";
+  }
+  // Serialization isn't guaranteed to be deterministic, which can only cause
+  // cache misses.
+  std::string key;
+  AppendToCacheKey(input_config.SerializeAsString(), &key);
+  AppendToCacheKey(graph_options ? graph_options->SerializeAsString() : "",
+                   &key);
+  if (service_manager) {
+    // Subgraphs can expand differently depending on the available services.
+    for (const auto& [name, packet] : service_manager->ServicePackets()) {
+      AppendToCacheKey(name, &key);
+    }
+  }
+  return key;
+}
+
 absl::Status ValidatedGraphConfig::PerformBasicTransforms(
     const GraphRegistry* graph_registry,
     const Subgraph::SubgraphOptions* graph_options,
@@ -485,6 +580,22 @@ absl::Status ValidatedGraphConfig::InitializeCalculatorInfo() {
                               statuses);
 }
 
+absl::Status ValidatedGraphConfig::OptimizePureNodes() {
+  std::vector<bool> pure_nodes;
+  pure_nodes.reserve(calculators_.size());
+  for (const NodeTypeInfo& node_type_info : calculators_) {
+    pure_nodes.push_back(node_type_info.Contract().IsPure());
+  }
+  ASSIGN_OR_RETURN(int num_removed,
+                   tool::OptimizePureNodes(std::move(pure_nodes), &config_));
+  if (num_removed > 0) {
+    VLOG(1) << "Removed " << num_removed << " redundant pure nodes.";
+    calculators_.clear();
+    MP_RETURN_IF_ERROR(InitializeCalculatorInfo());
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ValidatedGraphConfig::InitializeGeneratorInfo() {
   std::vector<absl::Status> statuses;
   generators_.reserve(config_.packet_generator_size());
@@ -664,18 +775,26 @@ absl::Status ValidatedGraphConfig::AddInputStreamsForNode(
   const int node_index = node_type_info->Node().index;
   const PacketTypeSet& input_stream_types = node_type_info->InputStreamTypes();
   std::vector<bool> is_back_edge;  // Indexed by CollectionItemId.
+  std::vector<bool> is_lock_free;  // Indexed by CollectionItemId.
+  std::vector<int64> max_queue_bytes;  // Indexed by CollectionItemId.
   if (!config_.node(node_index).input_stream_info().empty()) {
     is_back_edge.resize(input_stream_types.NumEntries(), false);
+    is_lock_free.resize(input_stream_types.NumEntries(), false);
+    max_queue_bytes.resize(input_stream_types.NumEntries(), 0);
     for (const auto& input_stream_info :
          config_.node(node_index).input_stream_info()) {
-      if (input_stream_info.back_edge()) {
+      if (input_stream_info.back_edge() ||
+          input_stream_info.lock_free_queue() ||
+          input_stream_info.max_queue_bytes() != 0) {
         std::string tag;
         int index;
         MP_RETURN_IF_ERROR(
             tool::ParseTagIndex(input_stream_info.tag_index(), &tag, &index));
         CollectionItemId id = input_stream_types.GetId(tag, index);
         RET_CHECK(id.IsValid());
-        is_back_edge[id.value()] = true;
+        is_back_edge[id.value()] = input_stream_info.back_edge();
+        is_lock_free[id.value()] = input_stream_info.lock_free_queue();
+        max_queue_bytes[id.value()] = input_stream_info.max_queue_bytes();
       }
     }
   }
@@ -686,6 +805,10 @@ absl::Status ValidatedGraphConfig::AddInputStreamsForNode(
     input_streams_.emplace_back();
     auto& edge_info = input_streams_.back();
     edge_info.back_edge = !is_back_edge.empty() && is_back_edge[id.value()];
+    edge_info.lock_free_queue =
+        !is_lock_free.empty() && is_lock_free[id.value()];
+    edge_info.max_queue_bytes =
+        max_queue_bytes.empty() ? 0 : max_queue_bytes[id.value()];
 
     auto iter = stream_to_producer_.find(name);
     if (iter != stream_to_producer_.end()) {
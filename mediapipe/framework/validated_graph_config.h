@@ -24,6 +24,7 @@
 #include "mediapipe/framework/graph_service_manager.h"
 #include "mediapipe/framework/packet_generator.pb.h"
 #include "mediapipe/framework/packet_type.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/map_util.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_builder.h"
@@ -186,6 +187,8 @@ struct EdgeInfo {
   std::string name;
   PacketType* packet_type = nullptr;
   bool back_edge = false;  // Only applicable to input streams.
+  bool lock_free_queue = false;  // Only applicable to input streams.
+  int64 max_queue_bytes = 0;     // Only applicable to input streams.
 };
 
 // This class is used to validate and canonicalize a CalculatorGraphConfig.
@@ -304,12 +307,29 @@ class ValidatedGraphConfig {
   // Returns true if |name| is a reserved executor name.
   static bool IsReservedExecutorName(const std::string& name);
 
+  // Enables or disables the process-wide cache of canonical configs. When it
+  // is enabled, initializing again from the same config, graph options and
+  // set of services reuses the canonical config, skipping subgraph expansion
+  // and node sorting. Type checking still runs, since contracts can't be
+  // cached. Only configs using the global graph registry are cached, and
+  // subgraphs must expand the same way for the same inputs. Disabled by
+  // default. Disabling it clears it.
+  static void SetConfigCacheEnabled(bool enabled);
+
   // Returns true if a side packet is provided as an input to the graph.
   bool IsExternalSidePacket(const std::string& name) const {
     return required_side_packets_.count(name) > 0;
   }
 
  private:
+  // Returns the key of the input config in the config cache, or an empty
+  // string if it can't be cached.
+  static std::string ConfigCacheKey(
+      const CalculatorGraphConfig& input_config,
+      const GraphRegistry* graph_registry,
+      const Subgraph::SubgraphOptions* graph_options,
+      const GraphServiceManager* service_manager);
+
   // Perform transforms such as converting legacy features, expanding
   // subgraphs, and popluting input stream handler.
   absl::Status PerformBasicTransforms(
@@ -321,6 +341,9 @@ class ValidatedGraphConfig {
   absl::Status InitializeGeneratorInfo();
   // Initialize the Calculator information.
   absl::Status InitializeCalculatorInfo();
+  // Merges and removes redundant pure nodes, and reinitializes the Calculator
+  // information if any node was removed.
+  absl::Status OptimizePureNodes();
   // Initialize the StatusHandler information.
   absl::Status InitializeStatusHandlerInfo();
 
@@ -163,4 +163,37 @@ TEST(ValidatedGraphConfigTest, InitializeSubgraphWithServiceCalculatorB) {
   }
 }
 
+int counting_subgraph_expansions = 0;
+
+class CountingSubgraph : public Subgraph {
+  absl::StatusOr<CalculatorGraphConfig> GetConfig(
+      SubgraphContext* sc) override {
+    ++counting_subgraph_expansions;
+    return ExpectedConfig("CalculatorA");
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(CountingSubgraph);
+
+TEST(ValidatedGraphConfigTest, ConfigCacheSkipsSubgraphExpansion) {
+  CalculatorGraphConfig graph;
+  graph.add_node()->set_calculator("CountingSubgraph");
+  counting_subgraph_expansions = 0;
+
+  ValidatedGraphConfig::SetConfigCacheEnabled(true);
+  for (int i = 0; i < 3; ++i) {
+    ValidatedGraphConfig config;
+    MP_EXPECT_OK(config.Initialize(graph));
+    ASSERT_TRUE(config.Initialized());
+    EXPECT_THAT(config.Config(), EqualsProto(ExpectedConfigExpandedFromGraph(
+                                     "CountingSubgraph", "CalculatorA")));
+  }
+  EXPECT_EQ(counting_subgraph_expansions, 1);
+
+  // Disabling the cache clears it.
+  ValidatedGraphConfig::SetConfigCacheEnabled(false);
+  ValidatedGraphConfig config;
+  MP_EXPECT_OK(config.Initialize(graph));
+  EXPECT_EQ(counting_subgraph_expansions, 2);
+}
+
 }  // namespace mediapipe
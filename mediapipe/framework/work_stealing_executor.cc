@@ -0,0 +1,214 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/work_stealing_executor.h"
+
+#include <utility>
+
+#include "mediapipe/framework/deps/work_stealing_deque.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+// A worker checks the injection queue before its own tasks once every this
+// many tasks, so that tasks scheduled from outside the executor are not
+// starved by a worker that keeps scheduling tasks for itself.
+constexpr uint32_t kInjectionQueueCheckInterval = 61;
+
+}  // namespace
+
+struct WorkStealingExecutor::Worker {
+  Worker(WorkStealingExecutor* executor, int index)
+      : executor(executor), random_state(2 * index + 1) {}
+
+  // Returns a pseudo-random number, used to pick the first steal victim.
+  uint32_t NextRandom() {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+  }
+
+  WorkStealingExecutor* const executor;
+
+  // The task most recently scheduled from this worker. Other workers take it
+  // only when they have found nothing else to do.
+  std::atomic<Task*> lifo_slot{nullptr};
+
+  // Tasks displaced from the LIFO slot.
+  WorkStealingDeque<Task> deque;
+
+  // Only accessed by the thread running this worker.
+  uint32_t random_state;
+  uint32_t num_tasks_run = 0;
+};
+
+thread_local WorkStealingExecutor::Worker*
+    WorkStealingExecutor::current_worker_ = nullptr;
+
+WorkStealingExecutor::WorkStealingExecutor(int num_threads)
+    : WorkStealingExecutor(ThreadOptions(), num_threads) {}
+
+WorkStealingExecutor::WorkStealingExecutor(const ThreadOptions& thread_options,
+                                           int num_threads) {
+  if (num_threads == 0) {
+    num_threads = 1;
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>(this, i));
+  }
+  thread_pool_ = std::make_unique<ThreadPool>(
+      thread_options,
+      thread_options.name_prefix().empty() ? "mediapipe"
+                                           : thread_options.name_prefix(),
+      num_threads);
+  thread_pool_->StartWorkers();
+  // Each call to RunWorker() occupies one thread of the pool until the
+  // executor is destroyed.
+  for (auto& worker : workers_) {
+    Worker* w = worker.get();
+    thread_pool_->Schedule([this, w] { RunWorker(w); });
+  }
+  VLOG(2) << "Started work-stealing executor with " << num_threads
+          << " threads.";
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  VLOG(2) << "Terminating work-stealing executor.";
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+    condition_.SignalAll();
+  }
+  // Joins the worker threads, which run all remaining tasks first.
+  thread_pool_.reset();
+  CHECK_EQ(num_pending_tasks_.load(), 0);
+}
+
+void WorkStealingExecutor::Schedule(std::function<void()> task) {
+  Task* new_task = new Task(std::move(task));
+  Worker* worker = current_worker_;
+  if (worker != nullptr && worker->executor == this) {
+    Task* displaced =
+        worker->lifo_slot.exchange(new_task, std::memory_order_acq_rel);
+    if (displaced != nullptr) {
+      worker->deque.Push(displaced);
+    }
+  } else {
+    absl::MutexLock lock(&mutex_);
+    injected_tasks_.push_back(new_task);
+    num_injected_tasks_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // The task must be visible to other workers before it is counted, so that
+  // a worker woken up for it can find it.
+  num_pending_tasks_.fetch_add(1);
+  NotifyTaskAdded();
+}
+
+void WorkStealingExecutor::NotifyTaskAdded() {
+  // A worker increments num_sleeping_workers_ before it checks
+  // num_pending_tasks_ and goes to sleep, so either it sees the new task or we
+  // see it sleeping here.
+  if (num_sleeping_workers_.load() > 0) {
+    absl::MutexLock lock(&mutex_);
+    condition_.Signal();
+  }
+}
+
+void WorkStealingExecutor::RunWorker(Worker* worker) {
+  current_worker_ = worker;
+  while (true) {
+    std::unique_ptr<Task> task(FindTask(worker));
+    if (task != nullptr) {
+      num_pending_tasks_.fetch_sub(1);
+      (*task)();
+      continue;
+    }
+    absl::MutexLock lock(&mutex_);
+    num_sleeping_workers_.fetch_add(1);
+    while (num_pending_tasks_.load() == 0 && !stopped_) {
+      condition_.Wait(&mutex_);
+    }
+    num_sleeping_workers_.fetch_sub(1);
+    if (stopped_ && num_pending_tasks_.load() == 0) {
+      break;
+    }
+  }
+  current_worker_ = nullptr;
+}
+
+WorkStealingExecutor::Task* WorkStealingExecutor::FindTask(Worker* worker) {
+  if (++worker->num_tasks_run % kInjectionQueueCheckInterval == 0) {
+    if (Task* task = PopInjectedTask()) {
+      return task;
+    }
+  }
+  if (Task* task = worker->lifo_slot.exchange(nullptr,
+                                              std::memory_order_acquire)) {
+    return task;
+  }
+  if (Task* task = worker->deque.Pop()) {
+    return task;
+  }
+  if (Task* task = PopInjectedTask()) {
+    return task;
+  }
+  return StealTask(worker);
+}
+
+WorkStealingExecutor::Task* WorkStealingExecutor::PopInjectedTask() {
+  if (num_injected_tasks_.load(std::memory_order_relaxed) == 0) {
+    return nullptr;
+  }
+  absl::MutexLock lock(&mutex_);
+  if (injected_tasks_.empty()) {
+    return nullptr;
+  }
+  Task* task = injected_tasks_.front();
+  injected_tasks_.pop_front();
+  num_injected_tasks_.fetch_sub(1, std::memory_order_relaxed);
+  return task;
+}
+
+WorkStealingExecutor::Task* WorkStealingExecutor::StealTask(Worker* thief) {
+  const int num_workers = workers_.size();
+  const int start = thief->NextRandom() % num_workers;
+  for (int i = 0; i < num_workers; ++i) {
+    Worker* victim = workers_[(start + i) % num_workers].get();
+    if (victim == thief) {
+      continue;
+    }
+    if (Task* task = victim->deque.Steal()) {
+      return task;
+    }
+  }
+  // Take a task parked in the LIFO slot of a busy worker only as a last
+  // resort, since it would run on a cold cache here.
+  for (int i = 0; i < num_workers; ++i) {
+    Worker* victim = workers_[(start + i) % num_workers].get();
+    if (victim == thief ||
+        victim->lifo_slot.load(std::memory_order_relaxed) == nullptr) {
+      continue;
+    }
+    if (Task* task =
+            victim->lifo_slot.exchange(nullptr, std::memory_order_acquire)) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace mediapipe
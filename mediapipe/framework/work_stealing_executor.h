@@ -0,0 +1,90 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_WORK_STEALING_EXECUTOR_H_
+#define MEDIAPIPE_FRAMEWORK_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/thread_options.h"
+#include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// A multithreaded executor in which every worker thread owns a lock-free
+// deque of tasks, instead of all workers sharing one mutex-guarded queue.
+//
+// A task scheduled from one of the executor's own worker threads is placed in
+// that worker's LIFO slot and runs next on the same thread, which keeps the
+// data produced by the previous task hot in cache. A task displaced from the
+// LIFO slot is pushed onto the worker's deque, where idle workers can steal
+// it. Tasks scheduled from other threads go through a shared injection queue.
+//
+// Select this executor through ThreadPoolExecutorOptions.enable_work_stealing.
+class WorkStealingExecutor : public Executor {
+ public:
+  explicit WorkStealingExecutor(int num_threads);
+  WorkStealingExecutor(const ThreadOptions& thread_options, int num_threads);
+  ~WorkStealingExecutor() override;
+  void Schedule(std::function<void()> task) override;
+
+  // For testing.
+  int num_threads() const { return workers_.size(); }
+
+ private:
+  using Task = std::function<void()>;
+  struct Worker;
+
+  // Runs tasks on behalf of "worker" until the executor is stopped and no
+  // tasks remain.
+  void RunWorker(Worker* worker);
+
+  // Returns a runnable task, or nullptr if none could be found.
+  Task* FindTask(Worker* worker);
+  Task* PopInjectedTask();
+  Task* StealTask(Worker* thief);
+
+  // Wakes up one sleeping worker, if any.
+  void NotifyTaskAdded();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Number of tasks waiting in LIFO slots, deques and the injection queue.
+  std::atomic<int64_t> num_pending_tasks_{0};
+  std::atomic<int> num_sleeping_workers_{0};
+  std::atomic<int64_t> num_injected_tasks_{0};
+
+  absl::Mutex mutex_;
+  absl::CondVar condition_;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+  std::deque<Task*> injected_tasks_ ABSL_GUARDED_BY(mutex_);
+
+  // Provides the worker threads, each of which runs RunWorker() for one
+  // Worker. Declared last so that it is joined before the workers go away.
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // The worker running on the current thread, if any.
+  static thread_local Worker* current_worker_;  // NOLINT
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_WORK_STEALING_EXECUTOR_H_
@@ -0,0 +1,88 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/work_stealing_executor.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/thread_pool_executor.h"
+#include "mediapipe/framework/thread_pool_executor.pb.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(WorkStealingExecutorTest, RunsTasksScheduledFromOutside) {
+  std::atomic<int> count(0);
+  {
+    WorkStealingExecutor executor(4);
+    ASSERT_EQ(executor.num_threads(), 4);
+    for (int i = 0; i < 1000; ++i) {
+      executor.Schedule([&count] { ++count; });
+    }
+  }
+  EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(WorkStealingExecutorTest, RunsTasksScheduledFromWorkers) {
+  // Every task schedules two child tasks until the tree is kDepth deep.
+  constexpr int kDepth = 12;
+  constexpr int kNumTasks = (1 << kDepth) - 1;
+  absl::BlockingCounter counter(kNumTasks);
+  WorkStealingExecutor executor(4);
+  std::function<void(int)> spawn = [&](int depth) {
+    if (depth < kDepth - 1) {
+      executor.Schedule([&spawn, depth] { spawn(depth + 1); });
+      executor.Schedule([&spawn, depth] { spawn(depth + 1); });
+    }
+    counter.DecrementCount();
+  };
+  executor.Schedule([&spawn] { spawn(0); });
+  counter.Wait();
+}
+
+TEST(WorkStealingExecutorTest, SingleThread) {
+  std::atomic<int> count(0);
+  {
+    WorkStealingExecutor executor(0);
+    ASSERT_EQ(executor.num_threads(), 1);
+    executor.Schedule([&] {
+      for (int i = 0; i < 100; ++i) {
+        executor.Schedule([&count] { ++count; });
+      }
+    });
+  }
+  EXPECT_EQ(count.load(), 100);
+}
+
+TEST(WorkStealingExecutorTest, SelectedThroughThreadPoolExecutorOptions) {
+  MediaPipeOptions extendable_options;
+  ThreadPoolExecutorOptions* options =
+      extendable_options.MutableExtension(ThreadPoolExecutorOptions::ext);
+  options->set_num_threads(2);
+  options->set_enable_work_stealing(true);
+  MP_ASSERT_OK_AND_ASSIGN(Executor * executor,
+                          ThreadPoolExecutor::Create(extendable_options));
+  std::unique_ptr<Executor> owned_executor(executor);
+  auto* work_stealing_executor = dynamic_cast<WorkStealingExecutor*>(executor);
+  ASSERT_NE(work_stealing_executor, nullptr);
+  EXPECT_EQ(work_stealing_executor->num_threads(), 2);
+}
+
+}  // namespace
+}  // namespace mediapipe
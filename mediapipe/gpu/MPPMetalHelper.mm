@@ -14,11 +14,14 @@
 
 #import "mediapipe/gpu/MPPMetalHelper.h"
 
+#import <QuartzCore/QuartzCore.h>
+
 #import "mediapipe/gpu/gpu_buffer.h"
 #import "mediapipe/gpu/graph_support.h"
 #import "mediapipe/gpu/metal_shared_resources.h"
 #import "GTMDefines.h"
 
+#include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 @interface MPPMetalHelper () {
@@ -124,7 +127,31 @@ class MetalHelperLegacySupport {
 }
 
 - (id<MTLCommandBuffer>)commandBuffer {
-  return [_gpuResources->metal_shared().resources().mtlCommandQueue commandBuffer];
+  id<MTLCommandBuffer> commandBuffer =
+      [_gpuResources->metal_shared().resources().mtlCommandQueue commandBuffer];
+#ifdef MEDIAPIPE_PROFILER_AVAILABLE
+  // Report the GPU time of the command buffer to the profiler of the graph.
+  auto cc = mediapipe::MetalHelperLegacySupport::GetCalculatorContext();
+  mediapipe::ProfilingContext* profiler = cc ? cc->GetProfilingContext() : nullptr;
+  if (profiler) {
+    if (@available(iOS 10.3, macOS 10.15, *)) {
+      std::weak_ptr<mediapipe::ProfilingContext> weak_profiler = profiler->weak_from_this();
+      int node_id = cc->NodeId();
+      mediapipe::Timestamp input_timestamp = cc->InputTimestamp();
+      [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+        auto profiler = weak_profiler.lock();
+        if (!profiler || buffer.status != MTLCommandBufferStatusCompleted) return;
+        // GPUStartTime and GPUEndTime are in seconds of CACurrentMediaTime().
+        absl::Time now = profiler->GetClock()->TimeNow();
+        CFTimeInterval media_now = CACurrentMediaTime();
+        profiler->LogGpuSpan(node_id, input_timestamp,
+                             now - absl::Seconds(media_now - buffer.GPUStartTime),
+                             now - absl::Seconds(media_now - buffer.GPUEndTime));
+      }];
+    }
+  }
+#endif  // MEDIAPIPE_PROFILER_AVAILABLE
+  return commandBuffer;
 }
 
 - (CVMetalTextureRef)copyCVMetalTextureWithGpuBuffer:(const mediapipe::GpuBuffer&)gpuBuffer
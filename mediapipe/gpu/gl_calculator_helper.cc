@@ -20,6 +20,7 @@
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/gpu/gpu_buffer.h"
 #include "mediapipe/gpu/gpu_service.h"
 
@@ -107,6 +108,38 @@ absl::Status GlCalculatorHelper::RunInGlContext(
   return RunInGlContext(gl_func, calculator_context);
 }
 
+absl::Status GlCalculatorHelper::RunInGlContextWithoutWaiting(
+    std::function<absl::Status(void)> gl_func) {
+  if (!Initialized()) return absl::InternalError("helper not initialized");
+  auto calculator_context =
+      LegacyCalculatorSupport::Scoped<CalculatorContext>::current();
+  int node_id = -1;
+  Timestamp input_timestamp = Timestamp::Unset();
+  if (calculator_context) {
+    node_id = calculator_context->NodeId();
+    input_timestamp = calculator_context->InputTimestamp();
+  }
+  gl_context_->RunWithoutWaiting(
+      [gl_func = std::move(gl_func), pending_status = pending_status_] {
+        absl::Status status = gl_func();
+        if (!status.ok()) {
+          absl::MutexLock lock(&pending_status->mutex);
+          pending_status->status.Update(status);
+        }
+      },
+      node_id, input_timestamp);
+  absl::MutexLock lock(&pending_status_->mutex);
+  return pending_status_->status;
+}
+
+absl::Status GlCalculatorHelper::WaitForPendingGlWork() {
+  // Nothing can have been queued before the helper was initialized.
+  if (!Initialized()) return absl::OkStatus();
+  MP_RETURN_IF_ERROR(RunInGlContext([] { return absl::OkStatus(); }));
+  absl::MutexLock lock(&pending_status_->mutex);
+  return pending_status_->status;
+}
+
 GLuint GlCalculatorHelper::framebuffer() const { return framebuffer_; }
 
 void GlCalculatorHelper::CreateFramebuffer() {
@@ -201,11 +234,18 @@ void GlCalculatorHelper::GetGpuBufferDimensions(const GpuBuffer& pixel_buffer,
 }
 
 GlTexture GlCalculatorHelper::CreateDestinationTexture(int width, int height,
-                                                       GpuBufferFormat format) {
+                                                       GpuBufferFormat format,
+                                                       TextureUse use) {
   if (!framebuffer_) {
     CreateFramebuffer();
   }
 
+  if (use == TextureUse::kIntermediate &&
+      gpu_resources_->half_float_intermediates() &&
+      gl_context_->CanRenderToHalfFloatTextures()) {
+    format = HalfFloatGpuBufferFormat(format);
+  }
+
   GpuBuffer gpu_buffer =
       gpu_resources_->gpu_buffer_pool().GetBuffer(width, height, format);
   return MapGpuBuffer(gpu_buffer, gpu_buffer.GetWriteView<GlTextureView>(0));
@@ -19,6 +19,7 @@
 
 #include "absl/base/attributes.h"
 #include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_contract.h"
 #include "mediapipe/framework/formats/image.h"
@@ -106,6 +107,25 @@ class GlCalculatorHelper {
     }).IgnoreError();
   }
 
+  // Like RunInGlContext, but returns as soon as the function has been queued
+  // on the GL context, so that the calculator thread can go on while the GPU
+  // work is submitted. Functions run in the order they are queued, before any
+  // function passed to RunInGlContext later. Textures released by the function
+  // get a producer sync point, which readers in other contexts wait on in the
+  // GPU command stream, so no glFinish is needed to hand them off.
+  //
+  // This is meant for GPU work whose results do not return to the calculator,
+  // e.g. rendering to a surface. The function must own or share everything it
+  // uses, since it may run after Process returns. An error returned by the
+  // function is reported by the next call to this method, or by
+  // WaitForPendingGlWork.
+  absl::Status RunInGlContextWithoutWaiting(
+      std::function<absl::Status(void)> gl_func);
+
+  // Waits for the functions queued by RunInGlContextWithoutWaiting to run, and
+  // returns the first error returned by any of them.
+  absl::Status WaitForPendingGlWork();
+
   // Use CreateSourceTexture and CreateDestinationTexture to set up textures
   // for input and output frames. They are not just a convenience; on platforms
   // where it is supported (iOS, for now) they take advantage of memory sharing
@@ -150,11 +170,23 @@ class GlCalculatorHelper {
   void GetGpuBufferDimensions(const GpuBuffer& pixel_buffer, int* width,
                               int* height);
 
+  // What a destination texture is used for.
+  enum class TextureUse {
+    // The texture may leave the calculator, e.g. in an output packet, and
+    // keeps the requested format.
+    kOutput,
+    // The texture is only read by the calculator's own GL passes. Float
+    // formats are replaced by their half-float counterparts when the graph's
+    // GpuResources enable half-float intermediates.
+    kIntermediate,
+  };
+
   // Gives access to an OpenGL texture for writing (rendering) a new frame.
   // TODO: This should either return errors or a status.
   GlTexture CreateDestinationTexture(
       int output_width, int output_height,
-      GpuBufferFormat format = GpuBufferFormat::kBGRA32);
+      GpuBufferFormat format = GpuBufferFormat::kBGRA32,
+      TextureUse use = TextureUse::kOutput);
 
   // The OpenGL name of the output framebuffer.
   GLuint framebuffer() const;
@@ -187,6 +219,15 @@ class GlCalculatorHelper {
   GLuint framebuffer_ = 0;
 
   GpuResources* gpu_resources_ = nullptr;
+
+  // The first error returned by a function queued without waiting. Shared
+  // with the queued functions, which may outlive the helper.
+  struct PendingStatus {
+    absl::Mutex mutex;
+    absl::Status status ABSL_GUARDED_BY(mutex);
+  };
+  std::shared_ptr<PendingStatus> pending_status_ =
+      std::make_shared<PendingStatus>();
 };
 
 // Represents an OpenGL texture, and is a 'view' into the memory pool.
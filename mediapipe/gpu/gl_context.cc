@@ -25,6 +25,7 @@
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/platform_specific_tracepoints.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
@@ -354,9 +355,19 @@ absl::Status GlContext::FinishInitialization(bool create_thread) {
     can_linear_filter_float_textures_ =
         HasGlExtension("OES_texture_float_linear") ||
         HasGlExtension("GL_OES_texture_float_linear");
+    // Half-float color buffers are core from GLES 3.2. Before, they need an
+    // extension, and GLES 2 lacks the sized half-float formats altogether.
+    can_render_to_half_float_textures_ =
+        gl_major_version_ >= 3 &&
+        (gl_major_version_ > 3 || gl_minor_version_ >= 2 ||
+         HasGlExtension("EXT_color_buffer_half_float") ||
+         HasGlExtension("GL_EXT_color_buffer_half_float") ||
+         HasGlExtension("EXT_color_buffer_float") ||
+         HasGlExtension("GL_EXT_color_buffer_float"));
 #else
     // Desktop GL should always allow linear filtering.
     can_linear_filter_float_textures_ = true;
+    can_render_to_half_float_textures_ = gl_major_version_ >= 3;
 #endif  // GL_ES_VERSION_2_0
 
     return absl::OkStatus();
@@ -438,6 +449,8 @@ absl::Status GlContext::Run(GlStatusFunction gl_func, int node_id,
     };
   }
   if (thread_) {
+    MEDIAPIPE_TRACEPOINT(gpu_task_submitted, "gl_context", node_id,
+                         input_timestamp.Value());
     bool had_gl_errors = false;
     status = thread_->Run([this, gl_func, &had_gl_errors] {
       auto status = gl_func();
@@ -451,8 +464,20 @@ absl::Status GlContext::Run(GlStatusFunction gl_func, int node_id,
   return status;
 }
 
-void GlContext::RunWithoutWaiting(GlVoidFunction gl_func) {
+void GlContext::RunWithoutWaiting(GlVoidFunction gl_func, int node_id,
+                                  Timestamp input_timestamp) {
+  if (profiling_helper_) {
+    gl_func = [=] {
+      profiling_helper_->MarkTimestamp(node_id, input_timestamp,
+                                       /*is_finish=*/false);
+      gl_func();
+      profiling_helper_->MarkTimestamp(node_id, input_timestamp,
+                                       /*is_finish=*/true);
+    };
+  }
   if (thread_) {
+    MEDIAPIPE_TRACEPOINT(gpu_task_submitted, "gl_context", node_id,
+                         input_timestamp.Value());
     // Add ref to keep the context alive while the task is executing.
     auto context = shared_from_this();
     thread_->RunWithoutWaiting([this, context, gl_func] {
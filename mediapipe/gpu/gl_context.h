@@ -166,6 +166,17 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
   static StatusOrGlContext Create(EAGLSharegroup* sharegroup,
                                   bool create_thread);
 #endif  // HAS_EAGL
+#if HAS_EGL && !defined(__EMSCRIPTEN__)
+  // Returns the number of EGL devices (GPUs) available through
+  // EGL_EXT_device_enumeration, or 0 if the extension is not supported.
+  static int GetEglDeviceCount();
+
+  // Creates a GlContext on EGL device `device_index`, in the order returned by
+  // eglQueryDevicesEXT, instead of on EGL_DEFAULT_DISPLAY. Contexts created
+  // with this one as share_context live on the same device.
+  static StatusOrGlContext CreateOnEglDevice(int device_index,
+                                             bool create_thread);
+#endif  // HAS_EGL && !defined(__EMSCRIPTEN__)
 
   // Returns the GlContext that is current on this thread. May return nullptr.
   static std::shared_ptr<GlContext> GetCurrent();
@@ -187,7 +198,8 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
                    Timestamp input_timestamp = Timestamp::Unset());
 
   // Like Run, but does not wait.
-  void RunWithoutWaiting(GlVoidFunction gl_func);
+  void RunWithoutWaiting(GlVoidFunction gl_func, int node_id = -1,
+                         Timestamp input_timestamp = Timestamp::Unset());
 
   // Returns a synchronization token.
   // This should not be called outside of the GlContext thread.
@@ -254,6 +266,13 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
   // finished its initialization successfully.
   bool HasGlExtension(absl::string_view extension) const;
 
+  // Whether half-float textures can be rendered to, e.g. kRGBAHalf64 and
+  // kGrayHalf16 destination textures. Only valid after GlContext has finished
+  // its initialization successfully.
+  bool CanRenderToHalfFloatTextures() const {
+    return can_render_to_half_float_textures_;
+  }
+
   int64_t gl_finish_count() { return gl_finish_count_; }
 
   // Used by GlFinishSyncPoint. The count_to_pass cannot exceed the current
@@ -447,6 +466,7 @@ class GlContext : public std::enable_shared_from_this<GlContext> {
   // Used by SetStandardTextureParams. Do we want several of these bools, or a
   // better mechanism?
   bool can_linear_filter_float_textures_;
+  bool can_render_to_half_float_textures_ = false;
 
   absl::flat_hash_map<const AttachmentBase*, internal::AttachmentPtr<void>>
       attachments_;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
@@ -24,6 +25,10 @@
 #include "mediapipe/gpu/gl_context.h"
 #include "mediapipe/gpu/gl_context_internal.h"
 
+#if HAS_EGL
+#include <EGL/eglext.h>
+#endif  // HAS_EGL
+
 #ifndef EGL_OPENGL_ES3_BIT_KHR
 #define EGL_OPENGL_ES3_BIT_KHR 0x00000040
 #endif
@@ -71,12 +76,7 @@ static void EnsureEglThreadRelease() {
                       reinterpret_cast<void*>(0xDEADBEEF));
 }
 
-static absl::StatusOr<EGLDisplay> GetInitializedDefaultEglDisplay() {
-  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
-  RET_CHECK(display != EGL_NO_DISPLAY)
-      << "eglGetDisplay() returned error " << std::showbase << std::hex
-      << eglGetError();
-
+static absl::StatusOr<EGLDisplay> InitializeEglDisplay(EGLDisplay display) {
   EGLint major = 0;
   EGLint minor = 0;
   EGLBoolean egl_initialized = eglInitialize(display, &major, &minor);
@@ -87,11 +87,63 @@ static absl::StatusOr<EGLDisplay> GetInitializedDefaultEglDisplay() {
   return display;
 }
 
+static absl::StatusOr<EGLDisplay> GetInitializedDefaultEglDisplay() {
+  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  RET_CHECK(display != EGL_NO_DISPLAY)
+      << "eglGetDisplay() returned error " << std::showbase << std::hex
+      << eglGetError();
+  return InitializeEglDisplay(display);
+}
+
 static absl::StatusOr<EGLDisplay> GetInitializedEglDisplay() {
   auto status_or_display = GetInitializedDefaultEglDisplay();
   return status_or_display;
 }
 
+#if defined(EGL_EXT_device_enumeration) && defined(EGL_EXT_platform_device)
+// The extension functions are looked up at runtime, since not all EGL
+// implementations provide them.
+static std::vector<EGLDeviceEXT> QueryEglDevices() {
+  static const auto query_devices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(
+      eglGetProcAddress("eglQueryDevicesEXT"));
+  if (!query_devices) return {};
+  EGLint num_devices = 0;
+  if (!query_devices(0, nullptr, &num_devices) || num_devices <= 0) return {};
+  std::vector<EGLDeviceEXT> devices(num_devices);
+  if (!query_devices(num_devices, devices.data(), &num_devices)) return {};
+  devices.resize(num_devices);
+  return devices;
+}
+
+static absl::StatusOr<EGLDisplay> GetInitializedEglDeviceDisplay(
+    int device_index) {
+  std::vector<EGLDeviceEXT> devices = QueryEglDevices();
+  RET_CHECK(device_index >= 0 && device_index < devices.size())
+      << "EGL device " << device_index << " does not exist; "
+      << devices.size() << " devices are available";
+  static const auto get_platform_display =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+          eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  RET_CHECK(get_platform_display)
+      << "eglGetPlatformDisplayEXT is not available";
+  EGLDisplay display = get_platform_display(
+      EGL_PLATFORM_DEVICE_EXT, devices[device_index], nullptr);
+  RET_CHECK(display != EGL_NO_DISPLAY)
+      << "eglGetPlatformDisplayEXT() returned error " << std::showbase
+      << std::hex << eglGetError();
+  return InitializeEglDisplay(display);
+}
+#else
+static std::vector<void*> QueryEglDevices() { return {}; }
+
+static absl::StatusOr<EGLDisplay> GetInitializedEglDeviceDisplay(
+    int device_index) {
+  return absl::UnimplementedError(
+      "EGL device enumeration is not supported on this platform");
+}
+#endif  // defined(EGL_EXT_device_enumeration) &&
+        // defined(EGL_EXT_platform_device)
+
 }  // namespace
 
 GlContext::StatusOrGlContext GlContext::Create(std::nullptr_t nullp,
@@ -101,7 +153,25 @@ GlContext::StatusOrGlContext GlContext::Create(std::nullptr_t nullp,
 
 GlContext::StatusOrGlContext GlContext::Create(const GlContext& share_context,
                                                bool create_thread) {
-  return Create(share_context.context_, create_thread);
+  std::shared_ptr<GlContext> context(new GlContext());
+  // A shared context must be on the same display, which may not be the
+  // default one.
+  context->display_ = share_context.display_;
+  MP_RETURN_IF_ERROR(context->CreateContext(share_context.context_));
+  MP_RETURN_IF_ERROR(context->FinishInitialization(create_thread));
+  return std::move(context);
+}
+
+int GlContext::GetEglDeviceCount() { return QueryEglDevices().size(); }
+
+GlContext::StatusOrGlContext GlContext::CreateOnEglDevice(int device_index,
+                                                          bool create_thread) {
+  std::shared_ptr<GlContext> context(new GlContext());
+  ASSIGN_OR_RETURN(context->display_,
+                   GetInitializedEglDeviceDisplay(device_index));
+  MP_RETURN_IF_ERROR(context->CreateContext(EGL_NO_CONTEXT));
+  MP_RETURN_IF_ERROR(context->FinishInitialization(create_thread));
+  return std::move(context);
 }
 
 GlContext::StatusOrGlContext GlContext::Create(EGLContext share_context,
@@ -176,7 +246,9 @@ absl::Status GlContext::CreateContextInternal(EGLContext share_context,
 }
 
 absl::Status GlContext::CreateContext(EGLContext share_context) {
-  ASSIGN_OR_RETURN(display_, GetInitializedEglDisplay());
+  if (display_ == EGL_NO_DISPLAY) {
+    ASSIGN_OR_RETURN(display_, GetInitializedEglDisplay());
+  }
 
   auto status = CreateContextInternal(share_context, 3);
   if (!status.ok()) {
@@ -0,0 +1,137 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/sink.h"
+#include "mediapipe/gpu/gl_calculator_helper.h"
+#include "mediapipe/gpu/gl_context.h"
+#include "mediapipe/gpu/gpu_test_base.h"
+
+namespace mediapipe {
+namespace {
+
+// Only platforms with dedicated GL threads have a GL context pool, see
+// kGlContextUseDedicatedThread.
+#if defined(__APPLE__) || defined(__EMSCRIPTEN__)
+constexpr bool kHasGlContextPool = false;
+#else
+constexpr bool kHasGlContextPool = true;
+#endif
+
+// Outputs the GL context it runs on for every input packet.
+class GlContextCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).Set<const GlContext*>();
+    return GlCalculatorHelper::UpdateContract(cc);
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    return helper_.Open(cc);
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<const GlContext*>(&helper_.GetGlContext())
+            .At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+
+ private:
+  GlCalculatorHelper helper_;
+};
+REGISTER_CALCULATOR(GlContextCalculator);
+
+class GlContextPoolTest : public GpuTestBase {
+ protected:
+  // Runs `num_nodes` independent GlContextCalculators `num_runs` times and
+  // returns the contexts used by each node in each run.
+  std::vector<std::vector<const GlContext*>> RunNodes(int num_nodes,
+                                                      int gl_context_pool_size,
+                                                      int num_runs) {
+    CalculatorGraphConfig config;
+    config.add_input_stream("in");
+    config.set_gl_context_pool_size(gl_context_pool_size);
+    std::vector<std::vector<Packet>> outputs(num_nodes);
+    for (int i = 0; i < num_nodes; ++i) {
+      auto* node = config.add_node();
+      node->set_calculator("GlContextCalculator");
+      node->add_input_stream("in");
+      node->add_output_stream(absl::StrCat("context_", i));
+      tool::AddVectorSink(absl::StrCat("context_", i), &config, &outputs[i]);
+    }
+    CalculatorGraph graph;
+    MP_EXPECT_OK(graph.SetGpuResources(gpu_resources_));
+    MP_EXPECT_OK(graph.Initialize(config));
+    std::vector<std::vector<const GlContext*>> contexts(num_runs);
+    for (int run = 0; run < num_runs; ++run) {
+      for (auto& packets : outputs) packets.clear();
+      MP_EXPECT_OK(graph.StartRun({}));
+      MP_EXPECT_OK(graph.AddPacketToInputStream(
+          "in", MakePacket<int>(0).At(Timestamp(0))));
+      MP_EXPECT_OK(graph.CloseAllInputStreams());
+      MP_EXPECT_OK(graph.WaitUntilDone());
+      for (const auto& packets : outputs) {
+        EXPECT_EQ(packets.size(), 1);
+        contexts[run].push_back(
+            packets.empty() ? nullptr : packets[0].Get<const GlContext*>());
+      }
+    }
+    return contexts;
+  }
+};
+
+TEST_F(GlContextPoolTest, SharesDefaultContextWithoutPool) {
+  auto contexts = RunNodes(/*num_nodes=*/3, /*gl_context_pool_size=*/0,
+                           /*num_runs=*/1);
+  EXPECT_THAT(contexts[0], testing::Each(gpu_resources_->gl_context().get()));
+}
+
+TEST_F(GlContextPoolTest, ReusesContextsUpToPoolSize) {
+  if (!kHasGlContextPool) {
+    GTEST_SKIP() << "No GL context pool without dedicated GL threads.";
+  }
+  auto contexts = RunNodes(/*num_nodes=*/5, /*gl_context_pool_size=*/2,
+                           /*num_runs=*/1);
+  std::map<const GlContext*, int> node_counts;
+  for (const GlContext* context : contexts[0]) ++node_counts[context];
+  // The first context of the pool is the default context, and the nodes are
+  // assigned round-robin.
+  EXPECT_THAT(node_counts,
+              testing::UnorderedElementsAre(
+                  testing::Pair(gpu_resources_->gl_context().get(), 3),
+                  testing::Pair(testing::Ne(nullptr), 2)));
+}
+
+TEST_F(GlContextPoolTest, KeepsContextsAcrossRuns) {
+  if (!kHasGlContextPool) {
+    GTEST_SKIP() << "No GL context pool without dedicated GL threads.";
+  }
+  auto contexts = RunNodes(/*num_nodes=*/3, /*gl_context_pool_size=*/2,
+                           /*num_runs=*/2);
+  EXPECT_EQ(contexts[1], contexts[0]);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -57,6 +57,7 @@ class GlSurfaceSinkCalculator : public Node {
 
   absl::Status Open(CalculatorContext* cc) final;
   absl::Status Process(CalculatorContext* cc) final;
+  absl::Status Close(CalculatorContext* cc) final;
 
  private:
   mediapipe::GlCalculatorHelper helper_;
@@ -91,7 +92,15 @@ absl::Status GlSurfaceSinkCalculator::Open(CalculatorContext* cc) {
 }
 
 absl::Status GlSurfaceSinkCalculator::Process(CalculatorContext* cc) {
-  return helper_.RunInGlContext([this, &cc]() -> absl::Status {
+  mediapipe::Packet packet;
+  if (kInVideo(cc).IsConnected())
+    packet = kInVideo(cc).packet();
+  else
+    packet = kIn(cc).packet();
+
+  // Nothing comes back from rendering to the surface, so the calculator does
+  // not wait for it. Close waits for the queued frames.
+  return helper_.RunInGlContextWithoutWaiting([this, packet]() -> absl::Status {
     absl::MutexLock lock(&surface_holder_->mutex);
     EGLSurface surface = surface_holder_->surface;
     if (surface == EGL_NO_SURFACE) {
@@ -99,12 +108,6 @@ absl::Status GlSurfaceSinkCalculator::Process(CalculatorContext* cc) {
       return absl::OkStatus();
     }
 
-    mediapipe::Packet packet;
-    if (kInVideo(cc).IsConnected())
-      packet = kInVideo(cc).packet();
-    else
-      packet = kIn(cc).packet();
-
     mediapipe::GpuBuffer input;
     if (packet.ValidateAsType<mediapipe::GpuBuffer>().ok())
       input = packet.Get<mediapipe::GpuBuffer>();
@@ -162,6 +165,10 @@ absl::Status GlSurfaceSinkCalculator::Process(CalculatorContext* cc) {
   });
 }
 
+absl::Status GlSurfaceSinkCalculator::Close(CalculatorContext* cc) {
+  return helper_.WaitForPendingGlWork();
+}
+
 GlSurfaceSinkCalculator::~GlSurfaceSinkCalculator() {
   if (renderer_) {
     // TODO: use move capture when we have C++14 or better.
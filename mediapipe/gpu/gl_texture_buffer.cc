@@ -14,7 +14,11 @@
 
 #include "mediapipe/gpu/gl_texture_buffer.h"
 
+#include <cstring>
+
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port.h"
+#include "mediapipe/framework/port/logging.h"
 #include "mediapipe/gpu/gl_context.h"
 #include "mediapipe/gpu/gl_texture_view.h"
 #include "mediapipe/gpu/gpu_buffer_storage_image_frame.h"
@@ -378,6 +382,83 @@ static std::shared_ptr<GlTextureBuffer> ConvertFromImageFrame(
   return GlTextureBuffer::Create(*frame->image_frame());
 }
 
+#if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30 && \
+    !defined(__EMSCRIPTEN__)
+// A readback into a pixel pack buffer, which the GPU performs asynchronously.
+struct PendingReadback {
+  ~PendingReadback() {
+    if (pbo) {
+      context->RunWithoutWaiting([pbo = pbo] { glDeleteBuffers(1, &pbo); });
+    }
+  }
+
+  std::shared_ptr<GlContext> context;
+  GLuint pbo = 0;
+  std::shared_ptr<GlSyncPoint> done;
+};
+
+// Issues the readback into a pixel pack buffer and returns immediately. The
+// returned function waits for the fence only if the GPU has not reached it
+// yet, then maps the buffer and copies it into the ImageFrame.
+static internal::GpuBufferStorageRegistry::PendingConversion
+StartConvertToImageFrame(std::shared_ptr<GlTextureBuffer> buf) {
+  auto ctx = GlContext::GetCurrent();
+  if (!ctx) ctx = buf->GetProducerContext();
+  if (ctx->gl_major_version() < 3) {
+    // Pixel pack buffers require OpenGL ES 3.0.
+    return [buf] { return ConvertToImageFrame(buf); };
+  }
+  ImageFormat::Format image_format =
+      ImageFormatForGpuBufferFormat(buf->format());
+  std::shared_ptr<ImageFrame> output =
+      std::make_shared<ImageFrame>(image_format, buf->width(), buf->height(),
+                                   ImageFrame::kGlDefaultAlignmentBoundary);
+  const size_t size = output->PixelDataSize();
+  auto readback = std::make_shared<PendingReadback>();
+  readback->context = ctx;
+  ctx->Run([buf, size, &readback, &ctx] {
+    auto view = buf->GetReadView(internal::types<GlTextureView>{}, /*plane=*/0);
+    glGenBuffers(1, &readback->pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    // With a pack buffer bound, the output pointer is an offset into it.
+    ReadTexture(*ctx, view, buf->format(), nullptr, size);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback->done = ctx->CreateSyncToken();
+    glFlush();
+  });
+  return [buf, output, readback, size]() {
+    // Returns immediately if the GPU has already reached the sync point.
+    readback->done->Wait();
+    readback->context->Run([&] {
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+      const void* data =
+          glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+      if (data) {
+        std::memcpy(output->MutablePixelData(), data, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      }
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      if (!data) {
+        LOG(WARNING) << "Mapping the readback buffer failed; reading the "
+                        "texture synchronously.";
+        auto view =
+            buf->GetReadView(internal::types<GlTextureView>{}, /*plane=*/0);
+        ReadTexture(*readback->context, view, buf->format(),
+                    output->MutablePixelData(), size);
+      }
+    });
+    return std::make_shared<GpuBufferStorageImageFrame>(output);
+  };
+}
+
+static auto kAsyncConverterRegistration =
+    internal::GpuBufferStorageRegistry::Get()
+        .RegisterAsyncConverter<GlTextureBuffer, GpuBufferStorageImageFrame>(
+            StartConvertToImageFrame);
+#endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30 &&
+        // !defined(__EMSCRIPTEN__)
+
 static auto kConverterRegistration =
     internal::GpuBufferStorageRegistry::Get()
         .RegisterConverter<GlTextureBuffer, GpuBufferStorageImageFrame>(
@@ -61,6 +61,7 @@ class GlTextureView {
   friend class GlTextureBuffer;
   friend class GpuBufferStorageCvPixelBuffer;
   friend class GpuBufferStorageAhwb;
+  friend class GpuBufferStorageVulkan;
   GlTextureView(GlContext* context, GLenum target, GLuint name, int width,
                 int height, int plane, DetachFn detach,
                 DoneWritingFn done_writing)
@@ -1,11 +1,13 @@
 #include "mediapipe/gpu/gpu_buffer.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
 #include "absl/functional/bind_front.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "mediapipe/framework/packet_size.h"
 #include "mediapipe/framework/port/logging.h"
 
 #if MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
@@ -23,8 +25,46 @@ struct StorageTypeFormatter {
   }
 };
 
+int BitsPerPixel(GpuBufferFormat format) {
+  switch (format) {
+    case GpuBufferFormat::kOneComponent8:
+    case GpuBufferFormat::kOneComponent8Red:
+      return 8;
+    case GpuBufferFormat::kBiPlanar420YpCbCr8VideoRange:
+    case GpuBufferFormat::kBiPlanar420YpCbCr8FullRange:
+      return 12;
+    case GpuBufferFormat::kGrayHalf16:
+    case GpuBufferFormat::kTwoComponent8:
+      return 16;
+    case GpuBufferFormat::kRGB24:
+      return 24;
+    case GpuBufferFormat::kBGRA32:
+    case GpuBufferFormat::kRGBA32:
+    case GpuBufferFormat::kGrayFloat32:
+    case GpuBufferFormat::kTwoComponentHalf16:
+      return 32;
+    case GpuBufferFormat::kTwoComponentFloat32:
+    case GpuBufferFormat::kRGBAHalf64:
+      return 64;
+    case GpuBufferFormat::kRGBAFloat128:
+      return 128;
+    case GpuBufferFormat::kUnknown:
+      return 0;
+  }
+  return 0;
+}
+
+// The size of one copy of the pixels, although a GpuBuffer may hold both a
+// CPU and a GPU copy.
+int64 EstimateGpuBufferSize(const GpuBuffer& buffer) {
+  return static_cast<int64>(buffer.width()) * buffer.height() *
+         BitsPerPixel(buffer.format()) / 8;
+}
+
 }  // namespace
 
+MEDIAPIPE_REGISTER_PACKET_SIZE_ESTIMATOR(GpuBuffer, EstimateGpuBufferSize);
+
 std::string GpuBuffer::DebugString() const {
   return holder_ ? absl::StrCat("GpuBuffer[", width(), "x", height(), " ",
                                 format(), " as ", holder_->DebugString(), "]")
@@ -40,6 +80,7 @@ internal::GpuBufferStorage* GpuBuffer::StorageHolder::GetStorageForView(
     TypeId view_provider_type, bool for_writing) const {
   std::shared_ptr<internal::GpuBufferStorage> chosen_storage;
   std::function<std::shared_ptr<internal::GpuBufferStorage>()> conversion;
+  std::shared_ptr<PendingStorage> pending;
 
   {
     absl::MutexLock lock(&mutex_);
@@ -51,9 +92,20 @@ internal::GpuBufferStorage* GpuBuffer::StorageHolder::GetStorageForView(
       }
     }
 
+    // Then see if a prefetch has already started the conversion.
+    if (!chosen_storage) {
+      for (const auto& p : pending_) {
+        if (p->view_provider_type == view_provider_type) {
+          pending = p;
+          conversion = [p] { return p->Get(); };
+          break;
+        }
+      }
+    }
+
     // Then try to convert existing storages to one that does.
     // TODO: choose best conversion.
-    if (!chosen_storage) {
+    if (!chosen_storage && !conversion) {
       for (const auto& s : storages_) {
         if (auto converter = internal::GpuBufferStorageRegistry::Get()
                                  .StorageConverterForViewProvider(
@@ -90,17 +142,23 @@ internal::GpuBufferStorage* GpuBuffer::StorageHolder::GetStorageForView(
       storages_.push_back(std::move(new_storage));
       chosen_storage = storages_.back();
     }
+    if (pending) {
+      pending_.erase(std::remove(pending_.begin(), pending_.end(), pending),
+                     pending_.end());
+    }
   }
 
   if (for_writing) {
     // This will temporarily hold storages to be released, and do so while the
     // lock is not held (see above).
     decltype(storages_) old_storages;
+    decltype(pending_) old_pending;
     using std::swap;
     if (chosen_storage) {
-      // Discard all other storages.
+      // Discard all other storages, and conversions of the old contents.
       absl::MutexLock lock(&mutex_);
       swap(old_storages, storages_);
+      swap(old_pending, pending_);
       storages_ = {chosen_storage};
     } else {
       // Allocate a new storage supporting the requested view.
@@ -110,6 +168,7 @@ internal::GpuBufferStorage* GpuBuffer::StorageHolder::GetStorageForView(
         if (auto new_storage = factory(width_, height_, format_)) {
           absl::MutexLock lock(&mutex_);
           swap(old_storages, storages_);
+          swap(old_pending, pending_);
           storages_ = {std::move(new_storage)};
           chosen_storage = storages_.back();
         }
@@ -123,6 +182,57 @@ internal::GpuBufferStorage* GpuBuffer::StorageHolder::GetStorageForView(
   return chosen_storage ? chosen_storage.get() : nullptr;
 }
 
+void GpuBuffer::StorageHolder::Prefetch(TypeId view_provider_type) const {
+  internal::GpuBufferStorageRegistry::PendingConversion finish;
+  {
+    std::function<internal::GpuBufferStorageRegistry::PendingConversion()>
+        start;
+    {
+      absl::MutexLock lock(&mutex_);
+      for (const auto& s : storages_) {
+        if (s->can_down_cast_to(view_provider_type)) return;
+      }
+      for (const auto& p : pending_) {
+        if (p->view_provider_type == view_provider_type) return;
+      }
+      for (const auto& s : storages_) {
+        if (auto converter = internal::GpuBufferStorageRegistry::Get()
+                                 .AsyncStorageConverterForViewProvider(
+                                     view_provider_type, s->storage_type())) {
+          start = absl::bind_front(converter, s);
+          break;
+        }
+      }
+    }
+    if (!start) return;
+    // As in GetStorageForView, the converter may use a GL context, so it is
+    // not invoked while holding the mutex.
+    finish = start();
+  }
+
+  auto pending =
+      std::make_shared<PendingStorage>(view_provider_type, std::move(finish));
+  absl::MutexLock lock(&mutex_);
+  // Another prefetch or reader may have raced us. In that case the new
+  // conversion is dropped once the lock is released.
+  for (const auto& s : storages_) {
+    if (s->can_down_cast_to(view_provider_type)) return;
+  }
+  for (const auto& p : pending_) {
+    if (p->view_provider_type == view_provider_type) return;
+  }
+  pending_.push_back(std::move(pending));
+}
+
+std::shared_ptr<internal::GpuBufferStorage>
+GpuBuffer::StorageHolder::PendingStorage::Get() {
+  absl::call_once(finished, [this] {
+    storage = finish();
+    finish = nullptr;
+  });
+  return storage;
+}
+
 internal::GpuBufferStorage& GpuBuffer::GetStorageForViewOrDie(
     TypeId view_provider_type, bool for_writing) const {
   auto* chosen_storage =
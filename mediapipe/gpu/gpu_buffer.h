@@ -19,7 +19,9 @@
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/base/call_once.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/gpu/gpu_buffer_format.h"
@@ -91,6 +93,10 @@ class GpuBuffer {
     return holder_ ? holder_->format() : GpuBufferFormat::kUnknown;
   }
 
+  // Returns true if other GpuBuffers, such as copies of this one, refer to the
+  // same contents.
+  bool IsShared() const { return holder_.use_count() > 1; }
+
   // Converts to true iff valid.
   explicit operator bool() const { return operator!=(nullptr); }
 
@@ -120,6 +126,17 @@ class GpuBuffer {
         internal::types<View>{}, std::forward<Args>(args)...);
   }
 
+  // Starts converting the contents to a storage that provides the specified
+  // view, without waiting for the transfer to finish. A later GetReadView for
+  // that view only blocks if the transfer is still in progress. A producer can
+  // call this before emitting the buffer, to overlap e.g. a GPU to CPU
+  // readback with other work. Does nothing if a storage already provides the
+  // view, or if no asynchronous converter is registered for it.
+  template <class View>
+  void PrefetchReadView() const {
+    if (holder_) holder_->Prefetch(kTypeId<internal::ViewProvider<View>>);
+  }
+
   // Attempts to access an underlying storage object of the specified type.
   // This method is meant for internal use: user code should access the contents
   // using views.
@@ -168,6 +185,8 @@ class GpuBuffer {
     internal::GpuBufferStorage* GetStorageForView(TypeId view_provider_type,
                                                   bool for_writing) const;
 
+    void Prefetch(TypeId view_provider_type) const;
+
     template <class T>
     std::shared_ptr<T> internal_storage() const {
       absl::MutexLock lock(&mutex_);
@@ -179,6 +198,23 @@ class GpuBuffer {
     std::string DebugString() const;
 
    private:
+    // A storage that is being converted asynchronously. It is shared by the
+    // readers that need it, and the conversion is finished by the first one.
+    struct PendingStorage {
+      PendingStorage(
+          TypeId view_provider_type,
+          internal::GpuBufferStorageRegistry::PendingConversion finish)
+          : view_provider_type(view_provider_type),
+            finish(std::move(finish)) {}
+
+      TypeId view_provider_type;
+      internal::GpuBufferStorageRegistry::PendingConversion finish;
+      absl::once_flag finished;
+      std::shared_ptr<internal::GpuBufferStorage> storage;
+
+      std::shared_ptr<internal::GpuBufferStorage> Get();
+    };
+
     int width_ = 0;
     int height_ = 0;
     GpuBufferFormat format_ = GpuBufferFormat::kUnknown;
@@ -187,6 +223,8 @@ class GpuBuffer {
     mutable absl::Mutex mutex_;
     mutable std::vector<std::shared_ptr<internal::GpuBufferStorage>> storages_
         ABSL_GUARDED_BY(mutex_);
+    mutable std::vector<std::shared_ptr<PendingStorage>> pending_
+        ABSL_GUARDED_BY(mutex_);
   };
 
   std::shared_ptr<StorageHolder> holder_;
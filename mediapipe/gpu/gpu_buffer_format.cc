@@ -239,4 +239,17 @@ GpuBufferFormat GpuBufferFormatForImageFormat(ImageFormat::Format format) {
   }
 }
 
+GpuBufferFormat HalfFloatGpuBufferFormat(GpuBufferFormat format) {
+  switch (format) {
+    case GpuBufferFormat::kGrayFloat32:
+      return GpuBufferFormat::kGrayHalf16;
+    case GpuBufferFormat::kTwoComponentFloat32:
+      return GpuBufferFormat::kTwoComponentHalf16;
+    case GpuBufferFormat::kRGBAFloat128:
+      return GpuBufferFormat::kRGBAHalf64;
+    default:
+      return format;
+  }
+}
+
 }  // namespace mediapipe
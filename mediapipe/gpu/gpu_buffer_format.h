@@ -79,6 +79,10 @@ const GlTextureInfo& GlTextureInfoForGpuBufferFormat(GpuBufferFormat format,
 ImageFormat::Format ImageFormatForGpuBufferFormat(GpuBufferFormat format);
 GpuBufferFormat GpuBufferFormatForImageFormat(ImageFormat::Format format);
 
+// Returns the half-float format with the channels of the float format
+// "format", or "format" itself if it is not a 32-bit float format.
+GpuBufferFormat HalfFloatGpuBufferFormat(GpuBufferFormat format);
+
 #ifdef __APPLE__
 
 inline OSType CVPixelFormatForGpuBufferFormat(GpuBufferFormat format) {
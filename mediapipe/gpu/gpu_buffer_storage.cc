@@ -5,6 +5,7 @@ namespace internal {
 
 using StorageFactory = GpuBufferStorageRegistry::StorageFactory;
 using StorageConverter = GpuBufferStorageRegistry::StorageConverter;
+using AsyncStorageConverter = GpuBufferStorageRegistry::AsyncStorageConverter;
 using RegistryToken = GpuBufferStorageRegistry::RegistryToken;
 
 StorageFactory GpuBufferStorageRegistry::StorageFactoryForViewProvider(
@@ -23,6 +24,16 @@ StorageConverter GpuBufferStorageRegistry::StorageConverterForViewProvider(
   return it->second;
 }
 
+AsyncStorageConverter
+GpuBufferStorageRegistry::AsyncStorageConverterForViewProvider(
+    TypeId view_provider_type, TypeId existing_storage_type) {
+  auto it = async_converter_for_view_provider_and_existing_storage_.find(
+      {view_provider_type, existing_storage_type});
+  if (it == async_converter_for_view_provider_and_existing_storage_.end())
+    return nullptr;
+  return it->second;
+}
+
 RegistryToken GpuBufferStorageRegistry::Register(
     StorageFactory factory, std::vector<TypeId> provider_hashes) {
   // TODO: choose between multiple factories for same provider type.
@@ -43,5 +54,15 @@ RegistryToken GpuBufferStorageRegistry::Register(
   return {};
 }
 
+RegistryToken GpuBufferStorageRegistry::RegisterAsync(
+    AsyncStorageConverter converter, std::vector<TypeId> provider_hashes,
+    TypeId source_storage) {
+  for (const auto p : provider_hashes) {
+    async_converter_for_view_provider_and_existing_storage_[{
+        p, source_storage}] = converter;
+  }
+  return {};
+}
+
 }  // namespace internal
 }  // namespace mediapipe
@@ -101,6 +101,14 @@ class GpuBufferStorageRegistry {
       int, int, GpuBufferFormat)>;
   using StorageConverter = std::function<std::shared_ptr<GpuBufferStorage>(
       std::shared_ptr<GpuBufferStorage>)>;
+  // A conversion that has been started but may not have finished yet.
+  // Calling it waits for the transfer to complete, if necessary, and returns
+  // the new storage. It is called at most once.
+  using PendingConversion = std::function<std::shared_ptr<GpuBufferStorage>()>;
+  // Starts converting the given storage, e.g. by issuing an asynchronous GPU
+  // readback, and returns without waiting for the result.
+  using AsyncStorageConverter =
+      std::function<PendingConversion(std::shared_ptr<GpuBufferStorage>)>;
 
   static GpuBufferStorageRegistry& Get() {
     static NoDestructor<GpuBufferStorageRegistry> registry;
@@ -142,6 +150,22 @@ class GpuBufferStorageRegistry {
         StorageTo::GetProviderTypes(), kTypeId<StorageFrom>);
   }
 
+  // Registers an asynchronous converter from storage type StorageFrom to
+  // StorageTo. The converter takes a std::shared_ptr<StorageFrom> and returns
+  // a callable that finishes the conversion and returns the StorageTo.
+  template <class StorageFrom, class StorageTo, class F>
+  RegistryToken RegisterAsyncConverter(F&& converter) {
+    if constexpr (kDisableRegistration<StorageTo>) {
+      return {};
+    }
+    return RegisterAsync(
+        [converter](
+            std::shared_ptr<GpuBufferStorage> source) -> PendingConversion {
+          return converter(std::static_pointer_cast<StorageFrom>(source));
+        },
+        StorageTo::GetProviderTypes(), kTypeId<StorageFrom>);
+  }
+
   // Returns a factory function for a storage that implements
   // view_provider_type.
   StorageFactory StorageFactoryForViewProvider(TypeId view_provider_type);
@@ -152,6 +176,12 @@ class GpuBufferStorageRegistry {
   StorageConverter StorageConverterForViewProvider(
       TypeId view_provider_type, TypeId existing_storage_type);
 
+  // Returns a function that starts converting a storage of
+  // existing_storage_type to a new storage that implements
+  // view_provider_type, or nullptr if there is no asynchronous converter.
+  AsyncStorageConverter AsyncStorageConverterForViewProvider(
+      TypeId view_provider_type, TypeId existing_storage_type);
+
  private:
   template <class Storage, class... Args>
   static auto CreateStorage(overload_priority<1>, Args... args)
@@ -176,10 +206,15 @@ class GpuBufferStorageRegistry {
   RegistryToken Register(StorageConverter converter,
                          std::vector<TypeId> provider_hashes,
                          TypeId source_storage);
+  RegistryToken RegisterAsync(AsyncStorageConverter converter,
+                              std::vector<TypeId> provider_hashes,
+                              TypeId source_storage);
 
   absl::flat_hash_map<TypeId, StorageFactory> factory_for_view_provider_;
   absl::flat_hash_map<std::pair<TypeId, TypeId>, StorageConverter>
       converter_for_view_provider_and_existing_storage_;
+  absl::flat_hash_map<std::pair<TypeId, TypeId>, AsyncStorageConverter>
+      async_converter_for_view_provider_and_existing_storage_;
 };
 
 // Putting this outside the class body to work around a GCC bug.
@@ -0,0 +1,226 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/gpu/gpu_buffer_storage_ahwb.h"
+
+#if MEDIAPIPE_GPU_BUFFER_USE_AHWB
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/gpu/gl_base.h"
+
+namespace mediapipe {
+
+namespace {
+
+PFNEGLGETNATIVECLIENTBUFFERANDROIDPROC eglGetNativeClientBufferANDROID;
+PFNEGLCREATEIMAGEKHRPROC eglCreateImageKHR;
+PFNEGLDESTROYIMAGEKHRPROC eglDestroyImageKHR;
+PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES;
+
+bool LoadEglImageFunctions() {
+  static const bool loaded = [] {
+    eglGetNativeClientBufferANDROID =
+        reinterpret_cast<PFNEGLGETNATIVECLIENTBUFFERANDROIDPROC>(
+            eglGetProcAddress("eglGetNativeClientBufferANDROID"));
+    eglCreateImageKHR = reinterpret_cast<PFNEGLCREATEIMAGEKHRPROC>(
+        eglGetProcAddress("eglCreateImageKHR"));
+    eglDestroyImageKHR = reinterpret_cast<PFNEGLDESTROYIMAGEKHRPROC>(
+        eglGetProcAddress("eglDestroyImageKHR"));
+    glEGLImageTargetTexture2DOES =
+        reinterpret_cast<PFNGLEGLIMAGETARGETTEXTURE2DOESPROC>(
+            eglGetProcAddress("glEGLImageTargetTexture2DOES"));
+    return eglGetNativeClientBufferANDROID && eglCreateImageKHR &&
+           eglDestroyImageKHR && glEGLImageTargetTexture2DOES;
+  }();
+  return loaded;
+}
+
+// Returns the AHardwareBuffer format with the same memory layout as the
+// ImageFrame of a GpuBufferFormat, or 0 if there is none.
+uint32_t AhwbFormatForGpuBufferFormat(GpuBufferFormat format) {
+  switch (format) {
+    // Like GlTextureBuffer on Android, kBGRA32 is stored as RGBA.
+    case GpuBufferFormat::kBGRA32:
+    case GpuBufferFormat::kRGBA32:
+      return AHARDWAREBUFFER_FORMAT_R8G8B8A8_UNORM;
+    case GpuBufferFormat::kRGB24:
+      return AHARDWAREBUFFER_FORMAT_R8G8B8_UNORM;
+    case GpuBufferFormat::kRGBAHalf64:
+      return AHARDWAREBUFFER_FORMAT_R16G16B16A16_FLOAT;
+    default:
+      return 0;
+  }
+}
+
+GpuBufferFormat GpuBufferFormatForAhwbFormat(uint32_t format) {
+  switch (format) {
+    case AHARDWAREBUFFER_FORMAT_R8G8B8A8_UNORM:
+    case AHARDWAREBUFFER_FORMAT_R8G8B8X8_UNORM:
+      return GpuBufferFormat::kRGBA32;
+    case AHARDWAREBUFFER_FORMAT_R8G8B8_UNORM:
+      return GpuBufferFormat::kRGB24;
+    case AHARDWAREBUFFER_FORMAT_R16G16B16A16_FLOAT:
+      return GpuBufferFormat::kRGBAHalf64;
+    default:
+      return GpuBufferFormat::kUnknown;
+  }
+}
+
+}  // namespace
+
+GpuBufferStorageAhwb::GpuBufferStorageAhwb(int width, int height,
+                                           GpuBufferFormat format)
+    : width_(width), height_(height), format_(format) {
+  const uint32_t ahwb_format = AhwbFormatForGpuBufferFormat(format);
+  CHECK_NE(ahwb_format, 0) << "unsupported pixel format";
+  AHardwareBuffer_Desc desc = {};
+  desc.width = width;
+  desc.height = height;
+  desc.layers = 1;
+  desc.format = ahwb_format;
+  desc.usage = AHARDWAREBUFFER_USAGE_GPU_SAMPLED_IMAGE |
+               AHARDWAREBUFFER_USAGE_GPU_COLOR_OUTPUT |
+               AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN |
+               AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN;
+  const int err = AHardwareBuffer_allocate(&desc, &buffer_);
+  CHECK_EQ(err, 0) << absl::StrFormat(
+      "Error allocating %dx%d hardware buffer: %d", width, height, err);
+}
+
+GpuBufferStorageAhwb::GpuBufferStorageAhwb(AHardwareBuffer* buffer)
+    : buffer_(buffer) {
+  CHECK(buffer_);
+  AHardwareBuffer_acquire(buffer_);
+  AHardwareBuffer_Desc desc = {};
+  AHardwareBuffer_describe(buffer_, &desc);
+  width_ = desc.width;
+  height_ = desc.height;
+  format_ = GpuBufferFormatForAhwbFormat(desc.format);
+  CHECK(format_ != GpuBufferFormat::kUnknown)
+      << "unsupported hardware buffer format: " << desc.format;
+}
+
+GpuBufferStorageAhwb::~GpuBufferStorageAhwb() {
+  if (buffer_) AHardwareBuffer_release(buffer_);
+}
+
+GlTextureView GpuBufferStorageAhwb::GetTexture(
+    int plane, GlTextureView::DoneWritingFn done_writing) const {
+  auto gl_context = GlContext::GetCurrent();
+  CHECK(gl_context);
+  CHECK_EQ(plane, 0) << "hardware buffers have a single plane";
+  CHECK(LoadEglImageFunctions())
+      << "EGL extensions to bind an AHardwareBuffer to a texture are missing";
+  {
+    absl::MutexLock lock(&mutex_);
+    if (producer_sync_) producer_sync_->WaitOnGpu();
+  }
+  const EGLDisplay display = gl_context->egl_display();
+  const EGLint attributes[] = {EGL_IMAGE_PRESERVED_KHR, EGL_TRUE, EGL_NONE};
+  EGLImageKHR image = eglCreateImageKHR(
+      display, EGL_NO_CONTEXT, EGL_NATIVE_BUFFER_ANDROID,
+      eglGetNativeClientBufferANDROID(buffer_), attributes);
+  CHECK(image != EGL_NO_IMAGE_KHR)
+      << "eglCreateImageKHR failed: " << eglGetError();
+  GLuint name;
+  glGenTextures(1, &name);
+  glBindTexture(GL_TEXTURE_2D, name);
+  glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, image);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return GlTextureView(
+      gl_context.get(), GL_TEXTURE_2D, name, width(), height(), plane,
+      [gl_context, display, image](GlTextureView& view) {
+        // The texture only references the buffer through the EGLImage, so
+        // both are deleted when the view is released.
+        gl_context->Run([name = view.name(), display, image] {
+          glDeleteTextures(1, &name);
+          eglDestroyImageKHR(display, image);
+        });
+      },
+      std::move(done_writing));
+}
+
+GlTextureView GpuBufferStorageAhwb::GetReadView(internal::types<GlTextureView>,
+                                                int plane) const {
+  return GetTexture(plane, nullptr);
+}
+
+GlTextureView GpuBufferStorageAhwb::GetWriteView(
+    internal::types<GlTextureView>, int plane) {
+  return GetTexture(plane, [this](const GlTextureView& view) {
+    auto sync = view.gl_context()->CreateSyncToken();
+    glFlush();
+    absl::MutexLock lock(&mutex_);
+    producer_sync_ = std::move(sync);
+  });
+}
+
+void GpuBufferStorageAhwb::WaitForGpuWrites() const {
+  std::shared_ptr<GlSyncPoint> sync;
+  {
+    absl::MutexLock lock(&mutex_);
+    sync = std::move(producer_sync_);
+  }
+  if (sync) sync->Wait();
+}
+
+std::shared_ptr<ImageFrame> GpuBufferStorageAhwb::LockImageFrame(
+    uint64_t usage) const {
+  WaitForGpuWrites();
+  void* data = nullptr;
+  const int err = AHardwareBuffer_lock(buffer_, usage, /*fence=*/-1,
+                                       /*rect=*/nullptr, &data);
+  CHECK_EQ(err, 0) << "AHardwareBuffer_lock failed: " << err;
+  AHardwareBuffer_Desc desc = {};
+  AHardwareBuffer_describe(buffer_, &desc);
+  const ImageFormat::Format image_format =
+      ImageFormatForGpuBufferFormat(format_);
+  const int pixel_size = ImageFrame::NumberOfChannelsForFormat(image_format) *
+                         ImageFrame::ByteDepthForFormat(image_format);
+  // The buffer is acquired by the deleter so that it outlives the view.
+  AHardwareBuffer_acquire(buffer_);
+  return std::make_shared<ImageFrame>(
+      image_format, width_, height_, desc.stride * pixel_size,
+      static_cast<uint8*>(data), [buffer = buffer_](uint8*) {
+        AHardwareBuffer_unlock(buffer, /*fence=*/nullptr);
+        AHardwareBuffer_release(buffer);
+      });
+}
+
+std::shared_ptr<const ImageFrame> GpuBufferStorageAhwb::GetReadView(
+    internal::types<ImageFrame>) const {
+  return LockImageFrame(AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN);
+}
+
+std::shared_ptr<ImageFrame> GpuBufferStorageAhwb::GetWriteView(
+    internal::types<ImageFrame>) {
+  return LockImageFrame(AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN |
+                        AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN);
+}
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_GPU_BUFFER_USE_AHWB
@@ -0,0 +1,125 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_GPU_GPU_BUFFER_STORAGE_AHWB_H_
+#define MEDIAPIPE_GPU_GPU_BUFFER_STORAGE_AHWB_H_
+
+#include "mediapipe/framework/port.h"
+
+#if !MEDIAPIPE_DISABLE_GPU && \
+    (__ANDROID_API__ >= 26 || defined(__ANDROID_UNAVAILABLE_SYMBOLS_ARE_WEAK__))
+#define MEDIAPIPE_GPU_BUFFER_USE_AHWB 1
+#endif  // !MEDIAPIPE_DISABLE_GPU && __ANDROID_API__ >= 26
+
+#if MEDIAPIPE_GPU_BUFFER_USE_AHWB
+
+#include <android/hardware_buffer.h>
+
+#include <memory>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/gpu/gl_context.h"
+#include "mediapipe/gpu/gl_texture_view.h"
+#include "mediapipe/gpu/gpu_buffer_format.h"
+#include "mediapipe/gpu/gpu_buffer_storage.h"
+#include "mediapipe/gpu/image_frame_view.h"
+
+namespace mediapipe {
+namespace internal {
+
+// Gives access to the underlying AHardwareBuffer, e.g. to hand it to NNAPI or
+// to a TFLite delegate. The handle is only valid while the GpuBuffer is alive;
+// callers that need it longer must acquire it.
+template <>
+class ViewProvider<AHardwareBuffer*> {
+ public:
+  virtual ~ViewProvider() = default;
+  virtual AHardwareBuffer* GetReadView(types<AHardwareBuffer*>) const = 0;
+  virtual AHardwareBuffer* GetWriteView(types<AHardwareBuffer*>) = 0;
+};
+
+}  // namespace internal
+
+// A GpuBuffer storage backed by an AHardwareBuffer. The same memory is exposed
+// as a GL texture (through an EGLImage), as an ImageFrame (by locking the
+// buffer for CPU access) and as the AHardwareBuffer itself, so a pipeline that
+// mixes GPU, CPU and accelerator stages does not copy frames between them.
+//
+// This storage is never picked by the GpuBuffer registry; buffers are created
+// explicitly, e.g. by wrapping the AHardwareBuffers of an AImageReader.
+class GpuBufferStorageAhwb
+    : public internal::GpuBufferStorageImpl<
+          GpuBufferStorageAhwb, internal::ViewProvider<GlTextureView>,
+          internal::ViewProvider<ImageFrame>,
+          internal::ViewProvider<AHardwareBuffer*>> {
+ public:
+  // Keeps the registry from using this storage in place of the default GL and
+  // ImageFrame storages.
+  static constexpr bool kDisableGpuBufferRegistration = true;
+
+  // Allocates a buffer that can be sampled and rendered to by the GPU and read
+  // and written by the CPU.
+  GpuBufferStorageAhwb(int width, int height, GpuBufferFormat format);
+  // Wraps an existing buffer, which is acquired until the storage is
+  // destroyed.
+  explicit GpuBufferStorageAhwb(AHardwareBuffer* buffer);
+  ~GpuBufferStorageAhwb() override;
+
+  int width() const override { return width_; }
+  int height() const override { return height_; }
+  GpuBufferFormat format() const override { return format_; }
+
+  GlTextureView GetReadView(internal::types<GlTextureView>,
+                            int plane) const override;
+  GlTextureView GetWriteView(internal::types<GlTextureView>,
+                             int plane) override;
+  std::shared_ptr<const ImageFrame> GetReadView(
+      internal::types<ImageFrame>) const override;
+  std::shared_ptr<ImageFrame> GetWriteView(
+      internal::types<ImageFrame>) override;
+  AHardwareBuffer* GetReadView(
+      internal::types<AHardwareBuffer*>) const override {
+    WaitForGpuWrites();
+    return buffer_;
+  }
+  AHardwareBuffer* GetWriteView(internal::types<AHardwareBuffer*>) override {
+    WaitForGpuWrites();
+    return buffer_;
+  }
+
+ private:
+  GlTextureView GetTexture(int plane,
+                           GlTextureView::DoneWritingFn done_writing) const;
+  std::shared_ptr<ImageFrame> LockImageFrame(uint64_t usage) const;
+  // Blocks until the GL commands of the last texture write view are complete,
+  // so that the buffer can be accessed outside of OpenGL.
+  void WaitForGpuWrites() const;
+
+  AHardwareBuffer* buffer_ = nullptr;
+  int width_ = 0;
+  int height_ = 0;
+  GpuBufferFormat format_ = GpuBufferFormat::kUnknown;
+
+  mutable absl::Mutex mutex_;
+  // Signaled when the last texture write view is done.
+  mutable std::shared_ptr<GlSyncPoint> producer_sync_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_GPU_BUFFER_USE_AHWB
+
+#endif  // MEDIAPIPE_GPU_GPU_BUFFER_STORAGE_AHWB_H_
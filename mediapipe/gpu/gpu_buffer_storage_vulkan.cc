@@ -0,0 +1,280 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/gpu/gpu_buffer_storage_vulkan.h"
+
+#if MEDIAPIPE_GPU_BUFFER_USE_VULKAN
+
+#include <EGL/egl.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/gpu/gl_base.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr VkExternalMemoryHandleTypeFlagBits kHandleType =
+    VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+
+PFNGLCREATEMEMORYOBJECTSEXTPROC glCreateMemoryObjectsEXT;
+PFNGLDELETEMEMORYOBJECTSEXTPROC glDeleteMemoryObjectsEXT;
+PFNGLIMPORTMEMORYFDEXTPROC glImportMemoryFdEXT;
+PFNGLTEXSTORAGEMEM2DEXTPROC glTexStorageMem2DEXT;
+
+bool LoadMemoryObjectFunctions() {
+  static const bool loaded = [] {
+    glCreateMemoryObjectsEXT =
+        reinterpret_cast<PFNGLCREATEMEMORYOBJECTSEXTPROC>(
+            eglGetProcAddress("glCreateMemoryObjectsEXT"));
+    glDeleteMemoryObjectsEXT =
+        reinterpret_cast<PFNGLDELETEMEMORYOBJECTSEXTPROC>(
+            eglGetProcAddress("glDeleteMemoryObjectsEXT"));
+    glImportMemoryFdEXT = reinterpret_cast<PFNGLIMPORTMEMORYFDEXTPROC>(
+        eglGetProcAddress("glImportMemoryFdEXT"));
+    glTexStorageMem2DEXT = reinterpret_cast<PFNGLTEXSTORAGEMEM2DEXTPROC>(
+        eglGetProcAddress("glTexStorageMem2DEXT"));
+    return glCreateMemoryObjectsEXT && glDeleteMemoryObjectsEXT &&
+           glImportMemoryFdEXT && glTexStorageMem2DEXT;
+  }();
+  return loaded;
+}
+
+// Returns the Vulkan format with the same layout as the GL texture of a
+// GpuBufferFormat, or VK_FORMAT_UNDEFINED if there is none.
+VkFormat VkFormatForGpuBufferFormat(GpuBufferFormat format) {
+  switch (format) {
+    // Like GlTextureBuffer outside of Apple platforms, kBGRA32 is stored as
+    // RGBA.
+    case GpuBufferFormat::kBGRA32:
+    case GpuBufferFormat::kRGBA32:
+      return VK_FORMAT_R8G8B8A8_UNORM;
+    case GpuBufferFormat::kOneComponent8:
+      return VK_FORMAT_R8_UNORM;
+    case GpuBufferFormat::kGrayFloat32:
+      return VK_FORMAT_R32_SFLOAT;
+    case GpuBufferFormat::kRGBAHalf64:
+      return VK_FORMAT_R16G16B16A16_SFLOAT;
+    case GpuBufferFormat::kRGBAFloat128:
+      return VK_FORMAT_R32G32B32A32_SFLOAT;
+    default:
+      return VK_FORMAT_UNDEFINED;
+  }
+}
+
+uint32_t DeviceLocalMemoryType(VkPhysicalDevice physical_device,
+                               uint32_t type_bits) {
+  VkPhysicalDeviceMemoryProperties properties;
+  vkGetPhysicalDeviceMemoryProperties(physical_device, &properties);
+  for (uint32_t i = 0; i < properties.memoryTypeCount; ++i) {
+    if ((type_bits & (1u << i)) &&
+        (properties.memoryTypes[i].propertyFlags &
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+      return i;
+    }
+  }
+  LOG(FATAL) << "No device-local memory type for the image";
+  return 0;
+}
+
+VulkanDevice& DefaultDevice() {
+  static VulkanDevice device;
+  return device;
+}
+
+}  // namespace
+
+void GpuBufferStorageVulkan::SetDefaultDevice(const VulkanDevice& device) {
+  DefaultDevice() = device;
+}
+
+std::shared_ptr<GpuBufferStorageVulkan> GpuBufferStorageVulkan::Create(
+    int width, int height, GpuBufferFormat format) {
+  CHECK(DefaultDevice().device != VK_NULL_HANDLE)
+      << "SetDefaultDevice must be called before creating Vulkan buffers";
+  return std::make_shared<GpuBufferStorageVulkan>(DefaultDevice(), width,
+                                                  height, format);
+}
+
+GpuBufferStorageVulkan::GpuBufferStorageVulkan(const VulkanDevice& device,
+                                               int width, int height,
+                                               GpuBufferFormat format)
+    : device_(device),
+      vk_format_(VkFormatForGpuBufferFormat(format)),
+      width_(width),
+      height_(height),
+      format_(format) {
+  CHECK_NE(vk_format_, VK_FORMAT_UNDEFINED) << "unsupported pixel format";
+
+  VkExternalMemoryImageCreateInfo external_info = {};
+  external_info.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO;
+  external_info.handleTypes = kHandleType;
+  VkImageCreateInfo image_info = {};
+  image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  image_info.pNext = &external_info;
+  image_info.imageType = VK_IMAGE_TYPE_2D;
+  image_info.format = vk_format_;
+  image_info.extent = {static_cast<uint32_t>(width),
+                       static_cast<uint32_t>(height), 1};
+  image_info.mipLevels = 1;
+  image_info.arrayLayers = 1;
+  image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+  image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+  image_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
+                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                     VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                     VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+  image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  VkResult result =
+      vkCreateImage(device_.device, &image_info, nullptr, &image_);
+  CHECK_EQ(result, VK_SUCCESS) << absl::StrFormat(
+      "Error creating %dx%d Vulkan image: %d", width, height, result);
+
+  VkMemoryRequirements requirements;
+  vkGetImageMemoryRequirements(device_.device, image_, &requirements);
+  memory_size_ = requirements.size;
+  VkExportMemoryAllocateInfo export_info = {};
+  export_info.sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO;
+  export_info.handleTypes = kHandleType;
+  VkMemoryAllocateInfo allocate_info = {};
+  allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocate_info.pNext = &export_info;
+  allocate_info.allocationSize = requirements.size;
+  allocate_info.memoryTypeIndex = DeviceLocalMemoryType(
+      device_.physical_device, requirements.memoryTypeBits);
+  result = vkAllocateMemory(device_.device, &allocate_info, nullptr, &memory_);
+  CHECK_EQ(result, VK_SUCCESS) << "vkAllocateMemory failed: " << result;
+  result = vkBindImageMemory(device_.device, image_, memory_, 0);
+  CHECK_EQ(result, VK_SUCCESS) << "vkBindImageMemory failed: " << result;
+}
+
+GpuBufferStorageVulkan::~GpuBufferStorageVulkan() {
+  // Views hold the storage, so nothing but a pending Vulkan write can still
+  // use the image here.
+  WaitForVulkanWrites();
+  vkDestroyImage(device_.device, image_, nullptr);
+  vkFreeMemory(device_.device, memory_, nullptr);
+}
+
+GlTextureView GpuBufferStorageVulkan::GetTexture(
+    int plane, GlTextureView::DoneWritingFn done_writing) const {
+  auto gl_context = GlContext::GetCurrent();
+  CHECK(gl_context);
+  CHECK_EQ(plane, 0) << "Vulkan buffers have a single plane";
+  CHECK(LoadMemoryObjectFunctions())
+      << "GL_EXT_memory_object_fd is needed to import Vulkan memory";
+  WaitForVulkanWrites();
+  {
+    absl::MutexLock lock(&mutex_);
+    if (gl_write_sync_) gl_write_sync_->WaitOnGpu();
+  }
+
+  auto get_memory_fd = reinterpret_cast<PFN_vkGetMemoryFdKHR>(
+      vkGetDeviceProcAddr(device_.device, "vkGetMemoryFdKHR"));
+  CHECK(get_memory_fd) << "VK_KHR_external_memory_fd is not enabled";
+  VkMemoryGetFdInfoKHR fd_info = {};
+  fd_info.sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR;
+  fd_info.memory = memory_;
+  fd_info.handleType = kHandleType;
+  int fd = -1;
+  const VkResult result = get_memory_fd(device_.device, &fd_info, &fd);
+  CHECK_EQ(result, VK_SUCCESS) << "vkGetMemoryFdKHR failed: " << result;
+
+  // GL takes ownership of the file descriptor.
+  GLuint memory_object;
+  glCreateMemoryObjectsEXT(1, &memory_object);
+  glImportMemoryFdEXT(memory_object, memory_size_, GL_HANDLE_TYPE_OPAQUE_FD_EXT,
+                      fd);
+  const GlTextureInfo& info = GlTextureInfoForGpuBufferFormat(
+      format_, plane, gl_context->GetGlVersion());
+  GLuint name;
+  glGenTextures(1, &name);
+  glBindTexture(GL_TEXTURE_2D, name);
+  glTexStorageMem2DEXT(GL_TEXTURE_2D, 1, info.gl_internal_format, width_,
+                       height_, memory_object, 0);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return GlTextureView(
+      gl_context.get(), GL_TEXTURE_2D, name, width(), height(), plane,
+      [gl_context, memory_object](GlTextureView& view) {
+        gl_context->Run([name = view.name(), memory_object] {
+          glDeleteTextures(1, &name);
+          glDeleteMemoryObjectsEXT(1, &memory_object);
+        });
+      },
+      std::move(done_writing));
+}
+
+GlTextureView GpuBufferStorageVulkan::GetReadView(
+    internal::types<GlTextureView>, int plane) const {
+  return GetTexture(plane, nullptr);
+}
+
+GlTextureView GpuBufferStorageVulkan::GetWriteView(
+    internal::types<GlTextureView>, int plane) {
+  return GetTexture(plane, [this](const GlTextureView& view) {
+    auto sync = view.gl_context()->CreateSyncToken();
+    glFlush();
+    absl::MutexLock lock(&mutex_);
+    gl_write_sync_ = std::move(sync);
+  });
+}
+
+VulkanImage GpuBufferStorageVulkan::GetReadView(
+    internal::types<VulkanImage>) const {
+  WaitForGlWrites();
+  return {image_, vk_format_, width_, height_};
+}
+
+VulkanImage GpuBufferStorageVulkan::GetWriteView(internal::types<VulkanImage>,
+                                                 VkFence write_fence) {
+  WaitForGlWrites();
+  absl::MutexLock lock(&mutex_);
+  vulkan_write_fence_ = write_fence;
+  return {image_, vk_format_, width_, height_};
+}
+
+void GpuBufferStorageVulkan::WaitForGlWrites() const {
+  std::shared_ptr<GlSyncPoint> sync;
+  {
+    absl::MutexLock lock(&mutex_);
+    sync = std::move(gl_write_sync_);
+  }
+  if (sync) sync->Wait();
+}
+
+void GpuBufferStorageVulkan::WaitForVulkanWrites() const {
+  VkFence fence;
+  {
+    absl::MutexLock lock(&mutex_);
+    fence = vulkan_write_fence_;
+    vulkan_write_fence_ = VK_NULL_HANDLE;
+  }
+  if (fence != VK_NULL_HANDLE) {
+    vkWaitForFences(device_.device, 1, &fence, VK_TRUE, UINT64_MAX);
+  }
+}
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_GPU_BUFFER_USE_VULKAN
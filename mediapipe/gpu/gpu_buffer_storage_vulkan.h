@@ -0,0 +1,143 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_GPU_GPU_BUFFER_STORAGE_VULKAN_H_
+#define MEDIAPIPE_GPU_GPU_BUFFER_STORAGE_VULKAN_H_
+
+#include "mediapipe/framework/port.h"
+
+// Vulkan support is opt-in: build with --define MEDIAPIPE_USE_VULKAN=1.
+#if !MEDIAPIPE_DISABLE_GPU && defined(MEDIAPIPE_USE_VULKAN) && \
+    defined(__linux__)
+#define MEDIAPIPE_GPU_BUFFER_USE_VULKAN 1
+#endif
+
+#if MEDIAPIPE_GPU_BUFFER_USE_VULKAN
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/gpu/gl_context.h"
+#include "mediapipe/gpu/gl_texture_view.h"
+#include "mediapipe/gpu/gpu_buffer_format.h"
+#include "mediapipe/gpu/gpu_buffer_storage.h"
+
+namespace mediapipe {
+
+// The Vulkan device that owns a buffer's memory. The device must have been
+// created with the VK_KHR_external_memory_fd extension enabled.
+struct VulkanDevice {
+  VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+  VkDevice device = VK_NULL_HANDLE;
+};
+
+// A Vulkan view of a GpuBuffer. The image is 2D, has a single mip level and
+// layer, and is kept in VK_IMAGE_LAYOUT_GENERAL between accesses: work that
+// transitions it to another layout must transition it back before the
+// buffer is accessed through another API.
+struct VulkanImage {
+  VkImage image = VK_NULL_HANDLE;
+  VkFormat format = VK_FORMAT_UNDEFINED;
+  int width = 0;
+  int height = 0;
+};
+
+namespace internal {
+
+// Read views wait for pending GL writes. Write views take the fence that the
+// caller's submission writing the image signals; GL views wait for it before
+// reading. Ordering between Vulkan submissions is up to the caller.
+template <>
+class ViewProvider<VulkanImage> {
+ public:
+  virtual ~ViewProvider() = default;
+  virtual VulkanImage GetReadView(types<VulkanImage>) const = 0;
+  virtual VulkanImage GetWriteView(types<VulkanImage>, VkFence write_fence) = 0;
+};
+
+}  // namespace internal
+
+// A GpuBuffer storage backed by a Vulkan image. Its memory is exported as an
+// opaque file descriptor and imported into OpenGL with
+// GL_EXT_memory_object_fd, so the same image can be used by Vulkan compute
+// passes and by GL calculators without copies.
+//
+// Synchronization between the APIs is explicit but coarse: switching from
+// one API to the other waits on the CPU for the other API's last write.
+//
+// This storage is never picked by the GpuBuffer registry; buffers are created
+// explicitly.
+class GpuBufferStorageVulkan
+    : public internal::GpuBufferStorageImpl<
+          GpuBufferStorageVulkan, internal::ViewProvider<GlTextureView>,
+          internal::ViewProvider<VulkanImage>> {
+ public:
+  static constexpr bool kDisableGpuBufferRegistration = true;
+
+  // Sets the device used by Create. Must be called before Create, and the
+  // device must outlive all buffers created by it.
+  static void SetDefaultDevice(const VulkanDevice& device);
+
+  // Allocates a buffer on the default device.
+  static std::shared_ptr<GpuBufferStorageVulkan> Create(
+      int width, int height, GpuBufferFormat format);
+
+  // Allocates an image that can be sampled, used as a storage image and as a
+  // color attachment, and copied to and from.
+  GpuBufferStorageVulkan(const VulkanDevice& device, int width, int height,
+                         GpuBufferFormat format);
+  ~GpuBufferStorageVulkan() override;
+
+  int width() const override { return width_; }
+  int height() const override { return height_; }
+  GpuBufferFormat format() const override { return format_; }
+
+  GlTextureView GetReadView(internal::types<GlTextureView>,
+                            int plane) const override;
+  GlTextureView GetWriteView(internal::types<GlTextureView>,
+                             int plane) override;
+  VulkanImage GetReadView(internal::types<VulkanImage>) const override;
+  VulkanImage GetWriteView(internal::types<VulkanImage>,
+                           VkFence write_fence) override;
+
+ private:
+  GlTextureView GetTexture(int plane,
+                           GlTextureView::DoneWritingFn done_writing) const;
+  // Blocks until the last GL write view's commands are complete.
+  void WaitForGlWrites() const;
+  // Blocks until the last Vulkan write view's submission is complete.
+  void WaitForVulkanWrites() const;
+
+  VulkanDevice device_;
+  VkImage image_ = VK_NULL_HANDLE;
+  VkDeviceMemory memory_ = VK_NULL_HANDLE;
+  VkDeviceSize memory_size_ = 0;
+  VkFormat vk_format_ = VK_FORMAT_UNDEFINED;
+  int width_ = 0;
+  int height_ = 0;
+  GpuBufferFormat format_ = GpuBufferFormat::kUnknown;
+
+  mutable absl::Mutex mutex_;
+  mutable std::shared_ptr<GlSyncPoint> gl_write_sync_ ABSL_GUARDED_BY(mutex_);
+  mutable VkFence vulkan_write_fence_ ABSL_GUARDED_BY(mutex_) =
+      VK_NULL_HANDLE;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_GPU_BUFFER_USE_VULKAN
+
+#endif  // MEDIAPIPE_GPU_GPU_BUFFER_STORAGE_VULKAN_H_
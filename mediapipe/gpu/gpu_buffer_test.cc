@@ -250,5 +250,72 @@ TEST_F(GpuBufferTest, CopiesShareConversions) {
             buffer.internal_storage<GlTextureBuffer>());
 }
 
+TEST_F(GpuBufferTest, PrefetchedImageFrame) {
+  GpuBuffer buffer(300, 200, GpuBufferFormat::kBGRA32);
+  RunInGlContext([&buffer] {
+    TempGlFramebuffer fb;
+    auto view = buffer.GetWriteView<GlTextureView>(0);
+    FillGlTextureRgba(view, 0.0, 1.0, 0.0, 1.0);
+    glFlush();
+    buffer.PrefetchReadView<ImageFrame>();
+  });
+  // Prefetching again is a no-op while the transfer is pending.
+  buffer.PrefetchReadView<ImageFrame>();
+
+  std::shared_ptr<const ImageFrame> view = buffer.GetReadView<ImageFrame>();
+  ImageFrame green(ImageFormat::SRGBA, 300, 200);
+  FillImageFrameRGBA(green, 0, 255, 0, 255);
+  EXPECT_TRUE(CompareImageFrames(*view, green, 0.0, 0.0));
+}
+
+TEST_F(GpuBufferTest, WriteDiscardsPrefetch) {
+  GpuBuffer buffer(300, 200, GpuBufferFormat::kBGRA32);
+  RunInGlContext([&buffer] {
+    TempGlFramebuffer fb;
+    auto view = buffer.GetWriteView<GlTextureView>(0);
+    FillGlTextureRgba(view, 0.0, 1.0, 0.0, 1.0);
+    glFlush();
+  });
+  buffer.PrefetchReadView<ImageFrame>();
+  RunInGlContext([&buffer] {
+    TempGlFramebuffer fb;
+    auto view = buffer.GetWriteView<GlTextureView>(0);
+    FillGlTextureRgba(view, 0.0, 0.0, 1.0, 1.0);
+    glFlush();
+  });
+
+  // The stale readback of the green contents must not be used.
+  std::shared_ptr<const ImageFrame> view = buffer.GetReadView<ImageFrame>();
+  ImageFrame blue(ImageFormat::SRGBA, 300, 200);
+  FillImageFrameRGBA(blue, 0, 0, 255, 255);
+  EXPECT_TRUE(CompareImageFrames(*view, blue, 0.0, 0.0));
+}
+
+TEST_F(GpuBufferTest, RunInGlContextWithoutWaiting) {
+  GpuBuffer buffer(300, 200, GpuBufferFormat::kBGRA32);
+  MP_ASSERT_OK(helper_.RunInGlContextWithoutWaiting([buffer]() mutable {
+    TempGlFramebuffer fb;
+    auto view = buffer.GetWriteView<GlTextureView>(0);
+    FillGlTextureRgba(view, 0.0, 0.0, 1.0, 1.0);
+    glFlush();
+    return absl::OkStatus();
+  }));
+  // Queued functions run before the ones run with waiting.
+  RunInGlContext([&buffer] {
+    auto view = buffer.GetReadView<GlTextureView>(0);
+  });
+  MP_EXPECT_OK(helper_.WaitForPendingGlWork());
+
+  std::shared_ptr<const ImageFrame> view = buffer.GetReadView<ImageFrame>();
+  ImageFrame blue(ImageFormat::SRGBA, 300, 200);
+  FillImageFrameRGBA(blue, 0, 0, 255, 255);
+  EXPECT_TRUE(CompareImageFrames(*view, blue, 0.0, 0.0));
+
+  MP_EXPECT_OK(helper_.RunInGlContextWithoutWaiting(
+      [] { return absl::InternalError("queued failure"); }));
+  EXPECT_EQ(helper_.WaitForPendingGlWork().code(),
+            absl::StatusCode::kInternal);
+}
+
 }  // anonymous namespace
 }  // namespace mediapipe
@@ -14,6 +14,11 @@
 
 #include "mediapipe/gpu/gpu_shared_data_internal.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/gpu/gl_context.h"
@@ -61,6 +66,43 @@ class GlContextExecutor : public Executor {
   GlContext* const gl_context_;
 };
 
+#if HAS_EGL && !defined(__EMSCRIPTEN__)
+// Counts the GpuResources on each EGL device, to balance new ones.
+class EglDeviceUsage {
+ public:
+  static EglDeviceUsage& Get() {
+    static NoDestructor<EglDeviceUsage> usage;
+    return *usage;
+  }
+
+  // Returns the device with the fewest users, and adds a user to it.
+  int AcquireLeastUsed(int device_count) {
+    absl::MutexLock lock(&mutex_);
+    if (users_.size() < device_count) users_.resize(device_count);
+    const int device =
+        std::min_element(users_.begin(), users_.begin() + device_count) -
+        users_.begin();
+    ++users_[device];
+    return device;
+  }
+
+  void Acquire(int device) {
+    absl::MutexLock lock(&mutex_);
+    if (users_.size() <= device) users_.resize(device + 1);
+    ++users_[device];
+  }
+
+  void Release(int device) {
+    absl::MutexLock lock(&mutex_);
+    --users_[device];
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<int> users_ ABSL_GUARDED_BY(mutex_);
+};
+#endif  // HAS_EGL && !defined(__EMSCRIPTEN__)
+
 static const std::string& SharedContextKey() {
   static const mediapipe::NoDestructor<std::string> kSharedContextKey("");
   return *kSharedContextKey;
@@ -80,6 +122,37 @@ GpuResources::StatusOrGpuResources GpuResources::Create(
   return gpu_resources;
 }
 
+GpuResources::StatusOrGpuResources GpuResources::CreateOnEglDevice(
+    int egl_device) {
+#if HAS_EGL && !defined(__EMSCRIPTEN__)
+  if (egl_device == kLeastUsedEglDevice) {
+    const int device_count = GlContext::GetEglDeviceCount();
+    if (device_count == 0) return Create();
+    egl_device = EglDeviceUsage::Get().AcquireLeastUsed(device_count);
+  } else if (egl_device == kDefaultEglDevice) {
+    return Create();
+  } else {
+    RET_CHECK_GE(egl_device, 0) << "invalid EGL device";
+    EglDeviceUsage::Get().Acquire(egl_device);
+  }
+  auto context =
+      GlContext::CreateOnEglDevice(egl_device, kGlContextUseDedicatedThread);
+  if (!context.ok()) {
+    EglDeviceUsage::Get().Release(egl_device);
+    return context.status();
+  }
+  std::shared_ptr<GpuResources> gpu_resources(
+      new GpuResources(std::move(context).value()));
+  gpu_resources->egl_device_ = egl_device;
+  return gpu_resources;
+#else
+  RET_CHECK(egl_device == kDefaultEglDevice ||
+            egl_device == kLeastUsedEglDevice)
+      << "EGL devices are not supported on this platform";
+  return Create();
+#endif  // HAS_EGL && !defined(__EMSCRIPTEN__)
+}
+
 GpuResources::GpuResources(std::shared_ptr<GlContext> gl_context)
 #if MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
     : texture_caches_(std::make_shared<CvTextureCacheManager>()),
@@ -114,6 +187,11 @@ GpuResources::~GpuResources() {
   }
 #endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
 #endif  // __APPLE__
+#if HAS_EGL && !defined(__EMSCRIPTEN__)
+  if (egl_device_ != kDefaultEglDevice) {
+    EglDeviceUsage::Get().Release(egl_device_);
+  }
+#endif  // HAS_EGL && !defined(__EMSCRIPTEN__)
 }
 
 absl::Status GpuResources::PrepareGpuNode(CalculatorNode* node) {
@@ -131,12 +209,24 @@ absl::Status GpuResources::PrepareGpuNode(CalculatorNode* node) {
 
   const auto& options =
       node->GetCalculatorState().Options<mediapipe::GlContextOptions>();
-  if (options.has_gl_context_name() && !options.gl_context_name().empty()) {
+  auto prepared_key = node_key_.find(node_id);
+  if (prepared_key != node_key_.end() &&
+      absl::StartsWith(node->Executor(), kGpuExecutorName)) {
+    // The node was prepared by an earlier run of its graph, and keeps its
+    // context rather than taking the next one of the pool.
+    context_key = prepared_key->second;
+  } else if (options.has_gl_context_name() &&
+             !options.gl_context_name().empty()) {
     context_key = absl::StrCat("user:", options.gl_context_name());
   } else if (gets_own_context) {
     context_key = absl::StrCat("auto:", node_type);
+  } else if (kGlContextUseDedicatedThread && !node->Executor().empty()) {
+    // GL calculators run on the thread of their context, so a node assigned
+    // to an executor, e.g. a branch of a graph meant to run concurrently with
+    // the others, gets a context shared by the nodes of that executor.
+    context_key = absl::StrCat("executor:", node->Executor());
   } else if (kGlCalculatorShareContext) {
-    context_key = SharedContextKey();
+    context_key = NextPoolContextKey();
   } else {
     context_key = absl::StrCat("auto:", node_id);
   }
@@ -164,6 +254,31 @@ absl::Status GpuResources::PrepareGpuNode(CalculatorNode* node) {
   return OkStatus();
 }
 
+void GpuResources::TrimMemory(MemoryTrimLevel level) {
+  // Both levels free everything: the buffers are only kept for reuse.
+  gpu_buffer_pool_.Clear();
+#ifdef MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+  texture_caches_->FlushTextureCaches();
+#endif  // MEDIAPIPE_GPU_BUFFER_USE_CV_PIXEL_BUFFER
+}
+
+void GpuResources::SetGlContextPoolSize(int size) {
+  CHECK_GE(size, 1);
+  gl_context_pool_size_ = size;
+}
+
+std::string GpuResources::NextPoolContextKey() {
+  // Without dedicated threads, calculators run on the scheduler's threads
+  // anyway, and extra contexts would only add synchronization.
+  if (!kGlContextUseDedicatedThread || gl_context_pool_size_ <= 1) {
+    return SharedContextKey();
+  }
+  const int index = next_pool_context_++ % gl_context_pool_size_;
+  // The first member of the pool is the shared context itself.
+  if (index == 0) return SharedContextKey();
+  return absl::StrCat("pool:", index);
+}
+
 // TODO: expose and use an actual ID instead of using the
 // canonicalized name.
 const std::shared_ptr<GlContext>& GpuResources::gl_context(
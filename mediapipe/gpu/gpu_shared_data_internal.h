@@ -24,6 +24,7 @@
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/memory_trimmer.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/gpu/gl_base.h"
 #include "mediapipe/gpu/gl_context.h"
@@ -47,6 +48,20 @@ class GpuResources {
   static StatusOrGpuResources Create();
   static StatusOrGpuResources Create(PlatformGlContext external_context);
 
+  // Values for CreateOnEglDevice besides a device index.
+  // Uses EGL_DEFAULT_DISPLAY, like Create().
+  static constexpr int kDefaultEglDevice = -1;
+  // Uses the EGL device with the fewest GpuResources in this process, to
+  // spread graphs across the GPUs of the host.
+  static constexpr int kLeastUsedEglDevice = -2;
+
+  // Creates resources whose GL contexts all live on one EGL device, for hosts
+  // with multiple GPUs. Set the result on a graph with
+  // CalculatorGraph::SetGpuResources to choose the GPU the graph runs on.
+  // Falls back to the default display if EGL devices cannot be enumerated and
+  // kLeastUsedEglDevice is requested.
+  static StatusOrGpuResources CreateOnEglDevice(int egl_device);
+
   // The destructor must be defined in the implementation file so that on iOS
   // the correct ARC release calls are generated.
   ~GpuResources();
@@ -62,10 +77,43 @@ class GpuResources {
   // Shared buffer pool.
   GpuBufferMultiPool& gpu_buffer_pool() { return gpu_buffer_pool_; }
 
+  // Frees the buffers kept by the buffer pool and, on Apple platforms, the
+  // textures kept by the CoreVideo texture caches. Called by
+  // CalculatorGraph::TrimMemory.
+  void TrimMemory(MemoryTrimLevel level);
+
+  // The EGL device of the GL contexts, or kDefaultEglDevice.
+  int egl_device() const { return egl_device_; }
+
 #ifdef __APPLE__
   MetalSharedResources& metal_shared() { return *metal_shared_; }
 #endif  // defined(__APPLE__)§
 
+  // Spreads the calculators that would share the default GL context over
+  // `size` contexts in its share group, each with its own GL thread, so that
+  // independent GL calculators submit their commands in parallel. Textures
+  // passed between these contexts are synchronized with GL fences, which the
+  // GPU waits on without blocking the calculator threads. Calculators are
+  // assigned round-robin when the graph is initialized; calculators that set
+  // GlContextOptions.gl_context_name still get the named context, so that a
+  // chain of calculators can be kept on one context. Must be called before
+  // the resources are used by a graph, or set with
+  // CalculatorGraphConfig.gl_context_pool_size. Has no effect on platforms
+  // without dedicated GL threads (Apple and Emscripten).
+  void SetGlContextPoolSize(int size);
+
+  // Lets GL calculators store their float intermediate textures, e.g. the
+  // passes of multi-pass filters, in half-float formats such as kRGBAHalf64
+  // and kGrayHalf16, halving the memory bandwidth they use. Textures that
+  // leave a calculator keep their formats. Intermediates are requested with
+  // GlCalculatorHelper::TextureUse::kIntermediate, and stay in float formats
+  // on contexts that cannot render to half floats. Must be called before the
+  // resources are used by a graph.
+  void SetHalfFloatIntermediates(bool enable) {
+    half_float_intermediates_ = enable;
+  }
+  bool half_float_intermediates() const { return half_float_intermediates_; }
+
   absl::Status PrepareGpuNode(CalculatorNode* node);
 
   // If the node requires custom GPU executors in the current configuration,
@@ -80,6 +128,8 @@ class GpuResources {
 
   GlContext::StatusOrGlContext GetOrCreateGlContext(const std::string& key);
   const std::string& ContextKey(const std::string& canonical_node_name);
+  // Returns the key of the next context in the shared context pool.
+  std::string NextPoolContextKey();
 
   std::map<std::string, std::string> node_key_;
   std::map<std::string, std::shared_ptr<GlContext>> gl_key_context_;
@@ -97,6 +147,13 @@ class GpuResources {
 #endif  // defined(__APPLE__)
 
   std::map<std::string, std::shared_ptr<Executor>> named_executors_;
+
+  int egl_device_ = kDefaultEglDevice;
+
+  int gl_context_pool_size_ = 1;
+  int next_pool_context_ = 0;
+
+  bool half_float_intermediates_ = false;
 };
 
 // Legacy struct to keep existing client code happy.
@@ -0,0 +1,36 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/gpu/multi_pool.h"
+
+#include <functional>
+#include <utility>
+
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace internal {
+
+void ScheduleMultiPoolTrim(std::function<void()> trim) {
+  // A single thread is enough: trims are cheap and coalesced per pool.
+  static ThreadPool* trimmer = [] {
+    auto* pool = new ThreadPool("multi_pool_trim", 1);
+    pool->StartWorkers();
+    return pool;
+  }();
+  trimmer->Schedule(std::move(trim));
+}
+
+}  // namespace internal
+}  // namespace mediapipe
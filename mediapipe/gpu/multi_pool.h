@@ -15,6 +15,19 @@
 #ifndef MEDIAPIPE_GPU_MULTI_POOL_H_
 #define MEDIAPIPE_GPU_MULTI_POOL_H_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/hash/hash.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/util/resource_cache.h"
 
 namespace mediapipe {
@@ -33,10 +46,26 @@ struct MultiPoolOptions {
   int min_requests_before_pool = 2;
   // Do a deeper flush every this many requests.
   int request_count_scrub_interval = 50;
+  // Spread BufferSpecs over this many independently locked shards. The two
+  // limits above are divided evenly between the shards.
+  int shard_count = 1;
+  // Let each thread remember the pools for the last few BufferSpecs it
+  // requested, so that repeated requests do not take a shard lock. Those
+  // requests are still counted, in batches.
+  bool use_thread_cache = true;
+  // Evict pools on a shared background thread instead of during Get.
+  bool trim_in_background = true;
 };
 
 static constexpr MultiPoolOptions kDefaultMultiPoolOptions;
 
+namespace internal {
+
+// Runs `trim` on a background thread shared by all MultiPools.
+void ScheduleMultiPoolTrim(std::function<void()> trim);
+
+}  // namespace internal
+
 // MultiPool is a generic class for vending reusable resources of type Item,
 // which are assumed to be relatively expensive to create, so that reusing them
 // is beneficial.
@@ -58,54 +87,218 @@ class MultiPool {
 
   MultiPool(SimplePoolFactory factory = DefaultMakeSimplePool,
             MultiPoolOptions options = kDefaultMultiPoolOptions)
-      : create_simple_pool_(factory), options_(options) {}
+      : create_simple_pool_(factory),
+        options_(options),
+        shards_(std::make_shared<ShardSet>(options)) {}
   explicit MultiPool(MultiPoolOptions options)
       : MultiPool(DefaultMakeSimplePool, options) {}
 
   // Obtains an item. May either be reused or created anew.
   Item Get(const Spec& spec);
 
+  // Drops all pools, releasing the items they keep for reuse, e.g. when the
+  // system is low on memory. Items in use are released when they are done
+  // with. Pools are created anew as items are requested again.
+  void Clear() { shards_->Clear(); }
+
  private:
   static std::shared_ptr<SimplePool> DefaultMakeSimplePool(
       const Spec& spec, const MultiPoolOptions& options) {
     return SimplePool::Create(spec, options);
   }
 
-  // Requests a simple buffer pool for the given spec. This may return nullptr
-  // if we have not yet reached a sufficient number of requests to allocate a
-  // pool, in which case the caller should invoke CreateBufferWithoutPool.
-  std::shared_ptr<SimplePool> RequestPool(const Spec& spec);
+  struct Shard {
+    absl::Mutex mutex;
+    mediapipe::ResourceCache<Spec, std::shared_ptr<SimplePool>> cache
+        ABSL_GUARDED_BY(mutex);
+  };
+
+  // Shared with the background trimmer, which must not keep the MultiPool
+  // alive.
+  struct ShardSet {
+    explicit ShardSet(const MultiPoolOptions& options);
+    Shard& ShardFor(const Spec& spec);
+    // Evicts surplus pools from all shards.
+    void Trim();
+    // Evicts all pools from all shards.
+    void Clear();
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    int max_pool_count;
+    int request_count_scrub_interval;
+    std::atomic<bool> trim_scheduled{false};
+  };
+
+  // An entry in the per-thread cache of recently requested pools.
+  struct ThreadCacheEntry {
+    uint64_t owner_id = 0;
+    std::optional<Spec> spec;
+    std::weak_ptr<SimplePool> pool;
+    int unreported_requests = 0;
+  };
+  static constexpr int kThreadCacheSize = 4;
+  // Requests served from the thread cache are reported every this many.
+  static constexpr int kThreadCacheReportInterval = 16;
+  using ThreadCache = std::array<ThreadCacheEntry, kThreadCacheSize>;
+
+  static ThreadCache& GetThreadCache() {
+    thread_local ThreadCache cache;
+    return cache;
+  }
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> next_id{1};
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Like RequestPool, but serves repeated requests from the thread cache.
+  std::shared_ptr<SimplePool> RequestPoolThroughThreadCache(const Spec& spec);
+
+  // Requests a simple buffer pool for the given spec, counting
+  // `request_count` requests. This may return nullptr if we have not yet
+  // reached a sufficient number of requests to allocate a pool, in which case
+  // the caller should invoke CreateBufferWithoutPool.
+  std::shared_ptr<SimplePool> RequestPool(const Spec& spec,
+                                          int request_count = 1);
+
+  void ScheduleTrim();
 
-  absl::Mutex mutex_;
-  mediapipe::ResourceCache<Spec, std::shared_ptr<SimplePool>> cache_
-      ABSL_GUARDED_BY(mutex_);
   SimplePoolFactory create_simple_pool_ = DefaultMakeSimplePool;
   MultiPoolOptions options_;
+  std::shared_ptr<ShardSet> shards_;
+  // Identifies this pool's entries in thread caches.
+  const uint64_t id_ = NextId();
 };
 
+template <class SimplePool, class Spec, class Item>
+MultiPool<SimplePool, Spec, Item>::ShardSet::ShardSet(
+    const MultiPoolOptions& options) {
+  const int shard_count = std::max(options.shard_count, 1);
+  for (int i = 0; i < shard_count; ++i) {
+    shards.push_back(std::make_unique<Shard>());
+  }
+  max_pool_count = (options.max_pool_count + shard_count - 1) / shard_count;
+  request_count_scrub_interval =
+      (options.request_count_scrub_interval + shard_count - 1) / shard_count;
+}
+
+template <class SimplePool, class Spec, class Item>
+typename MultiPool<SimplePool, Spec, Item>::Shard&
+MultiPool<SimplePool, Spec, Item>::ShardSet::ShardFor(const Spec& spec) {
+  if (shards.size() == 1) return *shards.front();
+  return *shards[absl::Hash<Spec>{}(spec) % shards.size()];
+}
+
+template <class SimplePool, class Spec, class Item>
+void MultiPool<SimplePool, Spec, Item>::ShardSet::Trim() {
+  trim_scheduled.store(false, std::memory_order_release);
+  for (auto& shard : shards) {
+    std::vector<std::shared_ptr<SimplePool>> evicted;
+    {
+      absl::MutexLock lock(&shard->mutex);
+      evicted = shard->cache.Evict(max_pool_count,
+                                   request_count_scrub_interval);
+    }
+    // Evicted pools, and their buffers, will be released without holding the
+    // lock.
+  }
+}
+
+template <class SimplePool, class Spec, class Item>
+void MultiPool<SimplePool, Spec, Item>::ShardSet::Clear() {
+  for (auto& shard : shards) {
+    std::vector<std::shared_ptr<SimplePool>> evicted;
+    {
+      absl::MutexLock lock(&shard->mutex);
+      evicted = shard->cache.Clear();
+    }
+  }
+}
+
+template <class SimplePool, class Spec, class Item>
+void MultiPool<SimplePool, Spec, Item>::ScheduleTrim() {
+  if (shards_->trim_scheduled.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  internal::ScheduleMultiPoolTrim(
+      [weak_shards = std::weak_ptr<ShardSet>(shards_)] {
+        if (auto shards = weak_shards.lock()) shards->Trim();
+      });
+}
+
 template <class SimplePool, class Spec, class Item>
 std::shared_ptr<SimplePool> MultiPool<SimplePool, Spec, Item>::RequestPool(
-    const Spec& spec) {
+    const Spec& spec, int request_count) {
+  Shard& shard = shards_->ShardFor(spec);
   std::shared_ptr<SimplePool> pool;
   std::vector<std::shared_ptr<SimplePool>> evicted;
+  bool needs_eviction;
   {
-    absl::MutexLock lock(&mutex_);
-    pool = cache_.Lookup(spec, [this](const Spec& spec, int request_count) {
-      return (request_count >= options_.min_requests_before_pool)
-                 ? create_simple_pool_(spec, options_)
-                 : nullptr;
-    });
-    evicted = cache_.Evict(options_.max_pool_count,
-                           options_.request_count_scrub_interval);
+    absl::MutexLock lock(&shard.mutex);
+    pool = shard.cache.Lookup(
+        spec,
+        [this](const Spec& spec, int request_count) {
+          return (request_count >= options_.min_requests_before_pool)
+                     ? create_simple_pool_(spec, options_)
+                     : nullptr;
+        },
+        request_count);
+    needs_eviction = shard.cache.NeedsEviction(
+        shards_->max_pool_count, shards_->request_count_scrub_interval);
+    if (needs_eviction && !options_.trim_in_background) {
+      evicted = shard.cache.Evict(shards_->max_pool_count,
+                                  shards_->request_count_scrub_interval);
+    }
   }
+  if (needs_eviction && options_.trim_in_background) ScheduleTrim();
   // Evicted pools, and their buffers, will be released without holding the
   // lock.
   return pool;
 }
 
 template <class SimplePool, class Spec, class Item>
-Item MultiPool<SimplePool, Spec, Item>::Get(const Spec& spec) {
+std::shared_ptr<SimplePool>
+MultiPool<SimplePool, Spec, Item>::RequestPoolThroughThreadCache(
+    const Spec& spec) {
+  ThreadCache& cache = GetThreadCache();
+  auto it = std::find_if(cache.begin(), cache.end(),
+                         [this, &spec](const ThreadCacheEntry& entry) {
+                           return entry.owner_id == id_ && *entry.spec == spec;
+                         });
+  if (it != cache.end()) {
+    // Keep the most recently used entry in front.
+    std::rotate(cache.begin(), it, it + 1);
+    ThreadCacheEntry& entry = cache.front();
+    std::shared_ptr<SimplePool> pool = entry.pool.lock();
+    ++entry.unreported_requests;
+    if (pool && entry.unreported_requests < kThreadCacheReportInterval) {
+      return pool;
+    }
+    // Report the requests, and pick up a new pool if ours was evicted.
+    pool = RequestPool(spec, entry.unreported_requests);
+    entry.pool = pool;
+    entry.unreported_requests = 0;
+    return pool;
+  }
+
   std::shared_ptr<SimplePool> pool = RequestPool(spec);
+  if (pool) {
+    // Replace the least recently used entry. Its unreported requests are
+    // dropped.
+    std::rotate(cache.begin(), cache.end() - 1, cache.end());
+    ThreadCacheEntry& entry = cache.front();
+    entry.owner_id = id_;
+    entry.spec = spec;
+    entry.pool = pool;
+    entry.unreported_requests = 0;
+  }
+  return pool;
+}
+
+template <class SimplePool, class Spec, class Item>
+Item MultiPool<SimplePool, Spec, Item>::Get(const Spec& spec) {
+  std::shared_ptr<SimplePool> pool = options_.use_thread_cache
+                                         ? RequestPoolThroughThreadCache(spec)
+                                         : RequestPool(spec);
   if (pool) {
     // Note: we release our multipool lock before accessing the simple pool.
     return Item(pool->GetBuffer());
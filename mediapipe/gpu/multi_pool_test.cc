@@ -0,0 +1,126 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/gpu/multi_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/gpu/reusable_pool.h"
+
+namespace mediapipe {
+namespace {
+
+struct FakeItem {
+  explicit FakeItem(int spec) : spec(spec) { ++live_count; }
+  ~FakeItem() { --live_count; }
+  void Reuse() {}
+  int spec;
+
+  static inline std::atomic<int> live_count{0};
+};
+
+class FakeItemPool : public ReusablePool<FakeItem> {
+ public:
+  static std::shared_ptr<FakeItemPool> Create(const int& spec,
+                                              const MultiPoolOptions& options) {
+    return std::shared_ptr<FakeItemPool>(new FakeItemPool(spec, options));
+  }
+
+  static std::shared_ptr<FakeItem> CreateBufferWithoutPool(const int& spec) {
+    return std::make_shared<FakeItem>(spec);
+  }
+
+ private:
+  FakeItemPool(int spec, const MultiPoolOptions& options)
+      : ReusablePool<FakeItem>(
+            [spec] { return std::make_unique<FakeItem>(spec); },
+            options) {}
+};
+
+using FakeMultiPool =
+    MultiPool<FakeItemPool, int, std::shared_ptr<FakeItem>>;
+
+TEST(ReusablePoolTest, KeepsAtMostKeepCountItems) {
+  auto pool = FakeItemPool::Create(0, {.keep_count = 2});
+  std::vector<std::shared_ptr<FakeItem>> items;
+  for (int i = 0; i < 3; ++i) items.push_back(pool->GetBuffer());
+  EXPECT_EQ(pool->GetInUseAndAvailableCounts(), std::make_pair(3, 0));
+
+  FakeItem* kept = items[2].get();
+  items.pop_back();
+  // Two items are still in use, so the returned one is not kept.
+  EXPECT_EQ(pool->GetInUseAndAvailableCounts(), std::make_pair(2, 0));
+  items.clear();
+  EXPECT_EQ(pool->GetInUseAndAvailableCounts(), std::make_pair(0, 2));
+
+  std::shared_ptr<FakeItem> item = pool->GetBuffer();
+  EXPECT_NE(item.get(), kept);
+  EXPECT_EQ(pool->GetInUseAndAvailableCounts(), std::make_pair(1, 1));
+}
+
+TEST(MultiPoolTest, ReusesItemsThroughThreadCache) {
+  FakeMultiPool pool(MultiPoolOptions{.keep_count = 1});
+  // The first request does not create a pool.
+  pool.Get(1);
+  FakeItem* reused = pool.Get(1).get();
+  // Enough requests to report the thread cache's counts several times.
+  for (int i = 0; i < 100; ++i) {
+    std::shared_ptr<FakeItem> item = pool.Get(1);
+    EXPECT_EQ(item.get(), reused);
+    EXPECT_EQ(item->spec, 1);
+  }
+}
+
+TEST(MultiPoolTest, ClearReleasesKeptItems) {
+  FakeMultiPool pool(MultiPoolOptions{.keep_count = 1});
+  pool.Get(1);
+  pool.Get(1);
+  // The second request created a pool, which keeps the returned item.
+  EXPECT_EQ(FakeItem::live_count, 1);
+
+  pool.Clear();
+  EXPECT_EQ(FakeItem::live_count, 0);
+
+  // The pool is created anew as requests come in again.
+  pool.Get(1);
+  pool.Get(1);
+  EXPECT_EQ(FakeItem::live_count, 1);
+}
+
+TEST(MultiPoolTest, ServesConcurrentRequests) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumSpecs = 8;
+  FakeMultiPool pool(MultiPoolOptions{.shard_count = 4});
+  std::atomic<int> mismatches{0};
+  {
+    ThreadPool threads(kNumThreads);
+    threads.StartWorkers();
+    for (int t = 0; t < kNumThreads; ++t) {
+      threads.Schedule([&pool, &mismatches, t] {
+        for (int i = 0; i < 1000; ++i) {
+          const int spec = (t + i) % kNumSpecs;
+          if (pool.Get(spec)->spec != spec) ++mismatches;
+        }
+      });
+    }
+  }
+  EXPECT_EQ(mismatches, 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
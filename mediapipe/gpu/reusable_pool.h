@@ -18,15 +18,20 @@
 #ifndef MEDIAPIPE_GPU_REUSABLE_POOL_H_
 #define MEDIAPIPE_GPU_REUSABLE_POOL_H_
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <utility>
-#include <vector>
 
 #include "absl/functional/any_invocable.h"
-#include "absl/synchronization/mutex.h"
+#include "absl/memory/memory.h"
 #include "mediapipe/gpu/multi_pool.h"
 
 namespace mediapipe {
 
+// Available items are kept in a fixed array of keep_count slots, which are
+// claimed and filled with atomic exchanges, so getting and returning buffers
+// never takes a lock.
 template <class Item>
 class ReusablePool : public std::enable_shared_from_this<ReusablePool<Item>> {
  public:
@@ -42,6 +47,8 @@ class ReusablePool : public std::enable_shared_from_this<ReusablePool<Item>> {
         new ReusablePool<Item>(std::move(item_factory), options));
   }
 
+  ~ReusablePool();
+
   // Obtains a buffer. May either be reused or created anew.
   // A GlContext must be current when this is called.
   std::shared_ptr<Item> GetBuffer();
@@ -52,49 +59,58 @@ class ReusablePool : public std::enable_shared_from_this<ReusablePool<Item>> {
  protected:
   ReusablePool(ItemFactory item_factory, const MultiPoolOptions& options)
       : item_factory_(std::move(item_factory)),
-        keep_count_(options.keep_count) {}
+        keep_count_(std::max(options.keep_count, 0)),
+        available_(new std::atomic<Item*>[keep_count_]) {
+    for (int i = 0; i < keep_count_; ++i) {
+      available_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
 
  private:
-  // Return a buffer to the pool.
+  // Return a buffer to the pool. If the total number of buffers would be
+  // greater than keep_count, the buffer is destroyed instead.
   void Return(std::unique_ptr<Item> buf);
 
-  // If the total number of buffers is greater than keep_count, destroys any
-  // surplus buffers that are no longer in use.
-  void TrimAvailable(std::vector<std::unique_ptr<Item>>* trimmed)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Takes an available buffer, or returns nullptr if there is none.
+  std::unique_ptr<Item> TakeAvailable();
 
   const ItemFactory item_factory_;
   const int keep_count_;
 
-  absl::Mutex mutex_;
-  int in_use_count_ ABSL_GUARDED_BY(mutex_) = 0;
-  std::vector<std::unique_ptr<Item>> available_ ABSL_GUARDED_BY(mutex_);
+  std::atomic<int> in_use_count_{0};
+  std::unique_ptr<std::atomic<Item*>[]> available_;
 };
 
 template <class Item>
-inline std::shared_ptr<Item> ReusablePool<Item>::GetBuffer() {
-  std::unique_ptr<Item> buffer;
-  bool reuse = false;
-
-  {
-    absl::MutexLock lock(&mutex_);
-    if (available_.empty()) {
-      buffer = item_factory_();
-      if (!buffer) return nullptr;
-    } else {
-      buffer = std::move(available_.back());
-      available_.pop_back();
-      reuse = true;
-    }
+ReusablePool<Item>::~ReusablePool() {
+  for (int i = 0; i < keep_count_; ++i) {
+    delete available_[i].load(std::memory_order_acquire);
+  }
+}
 
-    ++in_use_count_;
+template <class Item>
+std::unique_ptr<Item> ReusablePool<Item>::TakeAvailable() {
+  for (int i = 0; i < keep_count_; ++i) {
+    // Only write to slots that look full, to avoid bouncing empty ones
+    // between cores.
+    if (available_[i].load(std::memory_order_relaxed) == nullptr) continue;
+    Item* item = available_[i].exchange(nullptr, std::memory_order_acquire);
+    if (item) return absl::WrapUnique(item);
   }
+  return nullptr;
+}
 
-  // This needs to wait on consumer sync points, therefore it should not be
-  // done while holding the mutex.
-  if (reuse) {
+template <class Item>
+inline std::shared_ptr<Item> ReusablePool<Item>::GetBuffer() {
+  std::unique_ptr<Item> buffer = TakeAvailable();
+  if (buffer) {
+    // This needs to wait on consumer sync points.
     buffer->Reuse();
+  } else {
+    buffer = item_factory_();
+    if (!buffer) return nullptr;
   }
+  in_use_count_.fetch_add(1, std::memory_order_relaxed);
 
   // Return a shared_ptr with a custom deleter that adds the buffer back
   // to our available list.
@@ -111,33 +127,31 @@ inline std::shared_ptr<Item> ReusablePool<Item>::GetBuffer() {
 
 template <class Item>
 inline std::pair<int, int> ReusablePool<Item>::GetInUseAndAvailableCounts() {
-  absl::MutexLock lock(&mutex_);
-  return {in_use_count_, available_.size()};
-}
-
-template <class Item>
-void ReusablePool<Item>::Return(std::unique_ptr<Item> buf) {
-  std::vector<std::unique_ptr<Item>> trimmed;
-  {
-    absl::MutexLock lock(&mutex_);
-    --in_use_count_;
-    available_.emplace_back(std::move(buf));
-    TrimAvailable(&trimmed);
+  int available = 0;
+  for (int i = 0; i < keep_count_; ++i) {
+    if (available_[i].load(std::memory_order_acquire)) ++available;
   }
-  // The trimmed buffers will be released without holding the lock.
+  return {in_use_count_.load(std::memory_order_acquire), available};
 }
 
 template <class Item>
-void ReusablePool<Item>::TrimAvailable(
-    std::vector<std::unique_ptr<Item>>* trimmed) {
-  int keep = std::max(keep_count_ - in_use_count_, 0);
-  if (available_.size() > keep) {
-    auto trim_it = std::next(available_.begin(), keep);
-    if (trimmed) {
-      std::move(trim_it, available_.end(), std::back_inserter(*trimmed));
+void ReusablePool<Item>::Return(std::unique_ptr<Item> buf) {
+  const int in_use =
+      in_use_count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  // Buffers still in use take up their share of keep_count first. Under
+  // concurrent returns this is approximate, but never keeps more than
+  // keep_count buffers available.
+  const int keep = std::max(keep_count_ - in_use, 0);
+  for (int i = 0; i < keep; ++i) {
+    Item* expected = nullptr;
+    if (available_[i].compare_exchange_strong(expected, buf.get(),
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+      buf.release();
+      return;
     }
-    available_.erase(trim_it, available_.end());
   }
+  // The surplus buffer is released here, as no lock is held.
 }
 
 }  // namespace mediapipe
@@ -16,8 +16,22 @@
 
 #include <stdlib.h>
 
+#include <cstdint>
+#include <cstring>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/logging.h"
 
+#if defined(GL_PROGRAM_BINARY_LENGTH) && !defined(__EMSCRIPTEN__)
+#define MEDIAPIPE_GL_PROGRAM_BINARY 1
+#endif
+
 #if DEBUG
 #define GL_DEBUG_LOG(type, object, action)                        \
   do {                                                            \
@@ -50,6 +64,188 @@ namespace mediapipe {
 
 constexpr int kMaxShaderInfoLength = 1024;
 
+namespace {
+
+struct ProgramBinary {
+  GLenum format = 0;
+  std::string data;
+};
+
+struct ProgramBinaryCache {
+  absl::Mutex mutex;
+  bool enabled ABSL_GUARDED_BY(mutex) = false;
+  std::string directory ABSL_GUARDED_BY(mutex);
+  absl::flat_hash_map<std::string, ProgramBinary> binaries
+      ABSL_GUARDED_BY(mutex);
+};
+
+ProgramBinaryCache& GetProgramBinaryCache() {
+  static ProgramBinaryCache* cache = new ProgramBinaryCache;
+  return *cache;
+}
+
+#if MEDIAPIPE_GL_PROGRAM_BINARY
+
+// FNV-1a, which unlike absl::Hash is stable across processes.
+uint64_t Fingerprint(absl::string_view data) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : data) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+  }
+  return hash;
+}
+
+bool ProgramBinaryCacheEnabled() {
+  {
+    ProgramBinaryCache& cache = GetProgramBinaryCache();
+    absl::MutexLock lock(&cache.mutex);
+    if (!cache.enabled) return false;
+  }
+  if (!SymbolAvailable(&glProgramBinary) ||
+      !SymbolAvailable(&glGetProgramBinary) ||
+      !SymbolAvailable(&glProgramParameteri)) {
+    return false;
+  }
+  GLint num_formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+  // OpenGL ES 2.0 contexts don't know the enum.
+  if (num_formats == 0) glGetError();
+  return num_formats > 0;
+}
+
+std::string ProgramBinaryKey(const GLchar* vert_src, const GLchar* frag_src,
+                             GLsizei attr_count,
+                             const GLchar* const* attr_names,
+                             const GLint* attr_locations) {
+  std::string key;
+  for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+    const GLubyte* value = glGetString(name);
+    absl::StrAppend(&key, value ? reinterpret_cast<const char*>(value) : "",
+                    "\n");
+  }
+  for (int i = 0; i < attr_count; i++) {
+    absl::StrAppend(&key, attr_names[i], "=", attr_locations[i], "\n");
+  }
+  absl::StrAppend(&key, vert_src, "\n", frag_src);
+  return key;
+}
+
+// Files hold the key size, the key, the binary format and the binary.
+std::string SerializeProgramBinary(const std::string& key,
+                                   const ProgramBinary& binary) {
+  const uint32_t key_size = key.size();
+  const uint32_t format = binary.format;
+  std::string contents(reinterpret_cast<const char*>(&key_size),
+                       sizeof(key_size));
+  absl::StrAppend(&contents, key);
+  contents.append(reinterpret_cast<const char*>(&format), sizeof(format));
+  absl::StrAppend(&contents, binary.data);
+  return contents;
+}
+
+bool ParseProgramBinary(absl::string_view contents, const std::string& key,
+                        ProgramBinary* binary) {
+  uint32_t key_size = 0;
+  uint32_t format = 0;
+  if (contents.size() < sizeof(key_size)) return false;
+  std::memcpy(&key_size, contents.data(), sizeof(key_size));
+  contents.remove_prefix(sizeof(key_size));
+  // Guards against fingerprint collisions.
+  if (contents.size() < key_size + sizeof(format) ||
+      contents.substr(0, key_size) != key) {
+    return false;
+  }
+  contents.remove_prefix(key_size);
+  std::memcpy(&format, contents.data(), sizeof(format));
+  contents.remove_prefix(sizeof(format));
+  binary->format = format;
+  binary->data = std::string(contents);
+  return true;
+}
+
+std::string ProgramBinaryPath(const std::string& directory,
+                              const std::string& key) {
+  return file::JoinPath(directory,
+                        absl::StrCat("program_", Fingerprint(key), ".bin"));
+}
+
+// Loads the cached binary of the program into `program`. A binary rejected
+// by the driver, for instance after a driver update, leaves a new program to
+// be compiled in `program`.
+bool LoadProgramBinary(const std::string& key, GLuint* program) {
+  ProgramBinaryCache& cache = GetProgramBinaryCache();
+  ProgramBinary binary;
+  bool found = false;
+  std::string directory;
+  {
+    absl::MutexLock lock(&cache.mutex);
+    auto it = cache.binaries.find(key);
+    if (it != cache.binaries.end()) {
+      binary = it->second;
+      found = true;
+    }
+    directory = cache.directory;
+  }
+  if (!found && !directory.empty()) {
+    std::string contents;
+    found = file::GetContents(ProgramBinaryPath(directory, key), &contents)
+                .ok() &&
+            ParseProgramBinary(contents, key, &binary);
+  }
+  if (!found) return false;
+
+  glProgramBinary(*program, binary.format, binary.data.data(),
+                  binary.data.size());
+  GLint linked = GL_FALSE;
+  glGetProgramiv(*program, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE) {
+    VLOG(1) << "Cached program binary was rejected.";
+    glDeleteProgram(*program);
+    *program = glCreateProgram();
+    return false;
+  }
+  absl::MutexLock lock(&cache.mutex);
+  cache.binaries.emplace(key, std::move(binary));
+  return true;
+}
+
+void SaveProgramBinary(const std::string& key, GLuint program) {
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+  ProgramBinary binary;
+  binary.data.resize(length);
+  glGetProgramBinary(program, length, &length, &binary.format,
+                     &binary.data[0]);
+  binary.data.resize(length);
+
+  ProgramBinaryCache& cache = GetProgramBinaryCache();
+  std::string directory;
+  {
+    absl::MutexLock lock(&cache.mutex);
+    directory = cache.directory;
+  }
+  if (!directory.empty()) {
+    const std::string path = ProgramBinaryPath(directory, key);
+    auto status = file::SetContents(path, SerializeProgramBinary(key, binary));
+    LOG_IF(WARNING, !status.ok())
+        << "Failed to store program binary " << path << ": " << status;
+  }
+  absl::MutexLock lock(&cache.mutex);
+  cache.binaries[key] = std::move(binary);
+}
+
+#endif  // MEDIAPIPE_GL_PROGRAM_BINARY
+
+}  // namespace
+
+void EnableGlProgramBinaryCache(const std::string& directory) {
+  ProgramBinaryCache& cache = GetProgramBinaryCache();
+  absl::MutexLock lock(&cache.mutex);
+  cache.enabled = true;
+  cache.directory = directory;
+}
+
 GLint GlhCompileShader(GLenum target, const GLchar* source, GLuint* shader,
                        bool force_log_errors) {
   *shader = glCreateShader(target);
@@ -126,6 +322,21 @@ GLint GlhCreateProgram(const GLchar* vert_src, const GLchar* frag_src,
     return GL_FALSE;
   }
 
+#if MEDIAPIPE_GL_PROGRAM_BINARY
+  std::string cache_key;
+  if (ProgramBinaryCacheEnabled()) {
+    cache_key = ProgramBinaryKey(vert_src, frag_src, attr_count, attr_names,
+                                 attr_locations);
+    if (LoadProgramBinary(cache_key, program)) {
+      return GL_TRUE;
+    }
+    if (*program == 0) {
+      return GL_FALSE;
+    }
+    glProgramParameteri(*program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+#endif  // MEDIAPIPE_GL_PROGRAM_BINARY
+
   ok = ok && GlhCompileShader(GL_VERTEX_SHADER, vert_src, &vert_shader,
                               force_log_errors);
   ok = ok && GlhCompileShader(GL_FRAGMENT_SHADER, frag_src, &frag_shader,
@@ -143,6 +354,12 @@ GLint GlhCreateProgram(const GLchar* vert_src, const GLchar* frag_src,
     ok = GlhLinkProgram(*program);
   }
 
+#if MEDIAPIPE_GL_PROGRAM_BINARY
+  if (ok && !cache_key.empty()) {
+    SaveProgramBinary(cache_key, *program);
+  }
+#endif  // MEDIAPIPE_GL_PROGRAM_BINARY
+
   if (vert_shader) glDeleteShader(vert_shader);
   if (frag_shader) glDeleteShader(frag_shader);
 
@@ -44,6 +44,14 @@ GLint GlhCreateProgram(const GLchar* vert_src, const GLchar* frag_src,
                        const GLint* attr_locations, GLuint* program,
                        bool force_log_errors = false);
 
+// Enables a process-wide cache of the programs created by GlhCreateProgram,
+// keyed by their shaders, their attribute locations and the GL driver. Linked
+// program binaries are reused by later programs with the same key, in any GL
+// context. They are also stored in `directory`, if not empty, for the next
+// processes. Programs are compiled as usual when the context doesn't support
+// program binaries (OpenGL ES 3.0 or OpenGL 4.1).
+void EnableGlProgramBinaryCache(const std::string& directory);
+
 // Compiles a shader specified by shader_source. Returns true on success.
 bool CompileShader(GLenum shader_type, const std::string& shader_source,
                    GLuint* shader);
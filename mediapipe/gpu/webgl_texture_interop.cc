@@ -0,0 +1,57 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/gpu/webgl_texture_interop.h"
+
+#include <emscripten.h>
+
+#include <utility>
+
+#include "mediapipe/gpu/gl_texture_buffer.h"
+#include "mediapipe/gpu/gl_texture_view.h"
+
+namespace mediapipe {
+
+GpuBuffer WrapWebGlTexture(GLuint name, int width, int height,
+                           std::shared_ptr<GlContext> context) {
+  return GpuBuffer(GlTextureBuffer::Wrap(
+      GL_TEXTURE_2D, name, width, height, GpuBufferFormat::kBGRA32,
+      std::move(context), [name](std::shared_ptr<GlSyncPoint> sync_token) {
+        // WebGL runs commands in order on the one context, so the caller can
+        // reuse the texture without waiting on the sync token.
+        // clang-format off
+        EM_ASM({ GL.textures[$0] = null; }, name);
+        // clang-format on
+      }));
+}
+
+absl::Status CallWebGlTextureListener(const std::string& stream_name,
+                                      const GpuBuffer& buffer,
+                                      GlContext& context) {
+  return context.Run([&stream_name, &buffer]() -> absl::Status {
+    GlTextureView view = buffer.GetReadView<GlTextureView>(0);
+    // clang-format off
+    EM_ASM({
+      const listener = Module.simpleListeners &&
+          Module.simpleListeners[UTF8ToString($0)];
+      if (listener) {
+        listener({texture: GL.textures[$1], width: $2, height: $3});
+      }
+    }, stream_name.c_str(), view.name(), view.width(), view.height());
+    // clang-format on
+    return absl::OkStatus();
+  });
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,49 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Helpers for passing WebGL textures between JavaScript and a graph without
+// copying them through the CPU. Emscripten only.
+
+#ifndef MEDIAPIPE_GPU_WEBGL_TEXTURE_INTEROP_H_
+#define MEDIAPIPE_GPU_WEBGL_TEXTURE_INTEROP_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "mediapipe/gpu/gl_base.h"
+#include "mediapipe/gpu/gl_context.h"
+#include "mediapipe/gpu/gpu_buffer.h"
+
+namespace mediapipe {
+
+// Wraps a JavaScript-owned WebGL texture as a GpuBuffer, without copying it.
+// `name` is the texture's id in Emscripten's GL.textures table, and the
+// texture must belong to `context`'s WebGL context. The id is removed from
+// the table when the GpuBuffer is released; the texture itself is not
+// deleted, and remains owned by the caller.
+GpuBuffer WrapWebGlTexture(GLuint name, int width, int height,
+                           std::shared_ptr<GlContext> context);
+
+// Calls the JavaScript listener registered in Module.simpleListeners for
+// `stream_name` with {texture, width, height}, where `texture` is the
+// WebGLTexture holding `buffer`. The buffer is converted to a texture on
+// `context` if needed. The texture is only valid during the call.
+absl::Status CallWebGlTextureListener(const std::string& stream_name,
+                                      const GpuBuffer& buffer,
+                                      GlContext& context);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_GPU_WEBGL_TEXTURE_INTEROP_H_
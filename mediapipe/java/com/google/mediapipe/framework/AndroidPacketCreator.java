@@ -15,6 +15,9 @@
 package com.google.mediapipe.framework;
 
 import android.graphics.Bitmap;
+import android.hardware.HardwareBuffer;
+import android.os.Build;
+import androidx.annotation.RequiresApi;
 import com.google.mediapipe.framework.image.BitmapExtractor;
 import com.google.mediapipe.framework.image.ByteBufferExtractor;
 import com.google.mediapipe.framework.image.MPImage;
@@ -103,6 +106,25 @@ public class AndroidPacketCreator extends PacketCreator {
         "Unsupported Image container type: " + properties.getStorageType());
   }
 
+  /**
+   * Creates a packet of a vector holding one float32 Tensor of the given shape, that uses the
+   * memory of a {@link HardwareBuffer} without copying it, e.g. as the input of an
+   * InferenceCalculator.
+   *
+   * <p>The buffer must have the {@link HardwareBuffer#BLOB} format and hold the tensor data. The
+   * packet keeps a reference to the buffer, which must not be written until all the packets
+   * referencing it are released.
+   */
+  @RequiresApi(Build.VERSION_CODES.O)
+  public Packet createFloat32TensorVector(HardwareBuffer buffer, int[] shape) {
+    if (buffer.getFormat() != HardwareBuffer.BLOB) {
+      throw new IllegalArgumentException("The buffer must have the BLOB format.");
+    }
+    return Packet.create(
+        nativeCreateFloat32TensorVectorFromHardwareBuffer(
+            mediapipeGraph.getNativeHandle(), buffer, shape));
+  }
+
   /**
    * Returns the native handle of a new internal::PacketWithContext object on success. Returns 0 on
    * failure.
@@ -120,4 +142,7 @@ public class AndroidPacketCreator extends PacketCreator {
    * failure.
    */
   private native long nativeCreateRgbaImage(long context, Bitmap bitmap);
+
+  private native long nativeCreateFloat32TensorVectorFromHardwareBuffer(
+      long context, HardwareBuffer buffer, int[] shape);
 }
@@ -33,6 +33,9 @@ import java.util.Map;
 public class Graph {
   private static final FluentLogger logger = FluentLogger.forEnclosingClass();
   private static final int MAX_BUFFER_SIZE = 20;
+  // Levels of android.content.ComponentCallbacks2#onTrimMemory.
+  private static final int TRIM_MEMORY_RUNNING_MODERATE = 5;
+  private static final int TRIM_MEMORY_RUNNING_CRITICAL = 15;
   private long nativeGraphHandle;
   // Hold the references to callbacks (PacketCallback and PacketListCallback).
   private final List<Object> callbacks = new ArrayList<>();
@@ -552,6 +555,24 @@ public class Graph {
     nativeCancelGraph(nativeGraphHandle);
   }
 
+  /**
+   * Gives memory back to the system, to be called from {@code ComponentCallbacks2.onTrimMemory}.
+   *
+   * <p>From {@code TRIM_MEMORY_RUNNING_MODERATE} on, frees the buffers the graph keeps for reuse.
+   * From {@code TRIM_MEMORY_RUNNING_CRITICAL} on, also frees the working memory of calculators,
+   * such as the arenas of TFLite interpreters. Everything is allocated again when next needed.
+   *
+   * @param level the level passed to {@code onTrimMemory}.
+   */
+  public synchronized void trimMemory(int level) {
+    Preconditions.checkState(
+        nativeGraphHandle != 0, "Invalid context, tearDown() might have been called already.");
+    if (level < TRIM_MEMORY_RUNNING_MODERATE) {
+      return;
+    }
+    nativeTrimMemory(nativeGraphHandle, level >= TRIM_MEMORY_RUNNING_CRITICAL);
+  }
+
   /** Returns {@link GraphProfiler}. */
   public GraphProfiler getProfiler() {
     Preconditions.checkState(
@@ -680,5 +701,7 @@ public class Graph {
 
   private native void nativeCancelGraph(long context);
 
+  private native void nativeTrimMemory(long context, boolean complete);
+
   private native long nativeGetProfiler(long context);
 }
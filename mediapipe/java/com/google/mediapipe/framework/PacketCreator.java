@@ -390,6 +390,28 @@ public class PacketCreator {
             mediapipeGraph.getNativeHandle(), buffer, width, height, widthStep, numChannels));
   }
 
+  /**
+   * Creates a 1, 3, or 4 channel 8-bit Image packet that uses the pixels of a U8, RGB, or RGBA
+   * byte buffer without copying them.
+   *
+   * <p>The buffer must be direct, and rows must be tightly packed. The packet keeps a reference to
+   * the buffer, which must not be modified until all the packets referencing it are released.
+   */
+  public Packet wrapImage(ByteBuffer buffer, int width, int height, int numChannels) {
+    if (numChannels != 1 && numChannels != 3 && numChannels != 4) {
+      throw new IllegalArgumentException("Channels should be: 1, 3, or 4, but is " + numChannels);
+    }
+    int widthStep = width * numChannels;
+    int expectedSize = widthStep * height;
+    if (buffer.capacity() != expectedSize) {
+      throw new IllegalArgumentException(
+          "The size of the buffer should be: " + expectedSize + " but is " + buffer.capacity());
+    }
+    return Packet.create(
+        nativeWrapCpuImage(
+            mediapipeGraph.getNativeHandle(), buffer, width, height, widthStep, numChannels));
+  }
+
   /** Helper callback adaptor to create the Java {@link GlSyncToken}. This is called by JNI code. */
   private void releaseWithSyncToken(long nativeSyncToken, TextureReleaseCallback releaseCallback) {
     releaseCallback.release(new GraphGlSyncToken(nativeSyncToken));
@@ -447,6 +469,9 @@ public class PacketCreator {
   private native long nativeCreateCpuImage(
       long context, ByteBuffer buffer, int width, int height, int rowBytes, int numChannels);
 
+  private native long nativeWrapCpuImage(
+      long context, ByteBuffer buffer, int width, int height, int rowBytes, int numChannels);
+
   private native long nativeCreateInt32Array(long context, int[] data);
 
   private native long nativeCreateFloat32Array(long context, float[] data);
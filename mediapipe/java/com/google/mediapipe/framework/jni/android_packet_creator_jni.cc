@@ -15,17 +15,23 @@
 #include "mediapipe/java/com/google/mediapipe/framework/jni/android_packet_creator_jni.h"
 
 #include <android/bitmap.h>
+#include <android/hardware_buffer_jni.h>
 
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/java/com/google/mediapipe/framework/jni/colorspace.h"
 #include "mediapipe/java/com/google/mediapipe/framework/jni/graph.h"
+#include "mediapipe/java/com/google/mediapipe/framework/jni/jni_util.h"
 
 namespace {
 
@@ -148,3 +154,40 @@ JNIEXPORT jlong JNICALL ANDROID_PACKET_CREATOR_METHOD(nativeCreateRgbaImage)(
       mediapipe::MakePacket<mediapipe::Image>(std::move(image_frame));
   return CreatePacketWithContext(context, packet);
 }
+
+JNIEXPORT jlong JNICALL ANDROID_PACKET_CREATOR_METHOD(
+    nativeCreateFloat32TensorVectorFromHardwareBuffer)(JNIEnv* env,
+                                                       jobject thiz,
+                                                       jlong context,
+                                                       jobject hardware_buffer,
+                                                       jintArray shape) {
+#ifdef MEDIAPIPE_TENSOR_USE_AHWB
+  if (__builtin_available(android 26, *)) {
+    const jsize num_dims = env->GetArrayLength(shape);
+    std::vector<int> dims(num_dims);
+    env->GetIntArrayRegion(shape, 0, num_dims, dims.data());
+    AHardwareBuffer* handle =
+        AHardwareBuffer_fromHardwareBuffer(env, hardware_buffer);
+    // The Java object stays alive as long as the tensor uses its buffer.
+    jobject buffer_ref = env->NewGlobalRef(hardware_buffer);
+    auto tensor_or = mediapipe::Tensor::CreateFromAHardwareBuffer(
+        mediapipe::Tensor::ElementType::kFloat32, mediapipe::Tensor::Shape(dims),
+        handle, [buffer_ref] {
+          mediapipe::java::GetJNIEnv()->DeleteGlobalRef(buffer_ref);
+        });
+    if (!tensor_or.ok()) {
+      env->DeleteGlobalRef(buffer_ref);
+      mediapipe::android::ThrowIfError(env, tensor_or.status());
+      return 0L;
+    }
+    auto tensors = std::make_unique<std::vector<mediapipe::Tensor>>();
+    tensors->push_back(*std::move(tensor_or));
+    mediapipe::Packet packet = mediapipe::Adopt(tensors.release());
+    return CreatePacketWithContext(context, packet);
+  }
+#endif  // MEDIAPIPE_TENSOR_USE_AHWB
+  mediapipe::android::ThrowIfError(
+      env, absl::UnavailableError(
+               "Tensors backed by a HardwareBuffer require Android API 26."));
+  return 0L;
+}
@@ -35,6 +35,13 @@ JNIEXPORT jlong JNICALL ANDROID_PACKET_CREATOR_METHOD(
 JNIEXPORT jlong JNICALL ANDROID_PACKET_CREATOR_METHOD(nativeCreateRgbaImage)(
     JNIEnv* env, jobject thiz, jlong context, jobject bitmap);
 
+JNIEXPORT jlong JNICALL ANDROID_PACKET_CREATOR_METHOD(
+    nativeCreateFloat32TensorVectorFromHardwareBuffer)(JNIEnv* env,
+                                                       jobject thiz,
+                                                       jlong context,
+                                                       jobject hardware_buffer,
+                                                       jintArray shape);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
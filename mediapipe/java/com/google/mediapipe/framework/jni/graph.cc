@@ -604,6 +604,18 @@ void Graph::CancelGraph() {
   }
 }
 
+void Graph::TrimMemory(MemoryTrimLevel level) {
+  if (running_graph_) {
+    running_graph_->TrimMemory(level);
+    return;
+  }
+#if !MEDIAPIPE_DISABLE_GPU
+  if (gpu_resources_) {
+    gpu_resources_->TrimMemory(level);
+  }
+#endif  // !MEDIAPIPE_DISABLE_GPU
+}
+
 std::map<std::string, Packet> Graph::CreateCombinedSidePackets() {
   std::map<std::string, Packet> combined_side_packets = side_packets_callbacks_;
   combined_side_packets.insert(side_packets_.begin(), side_packets_.end());
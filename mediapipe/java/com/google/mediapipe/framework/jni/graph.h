@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/memory_trimmer.h"
 #if !MEDIAPIPE_DISABLE_GPU
 #include "mediapipe/gpu/gl_calculator_helper.h"
 #include "mediapipe/gpu/gpu_shared_data_internal.h"
@@ -145,6 +146,10 @@ class Graph {
   // Cancels the currently running graph.
   void CancelGraph();
 
+  // Trims the memory of the running graph, or of the GPU resources when no
+  // graph is running.
+  void TrimMemory(MemoryTrimLevel level);
+
   // Returns false if not in the context.
   static bool RemovePacket(int64_t packet_handle);
 
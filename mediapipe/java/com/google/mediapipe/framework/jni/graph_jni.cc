@@ -361,6 +361,16 @@ JNIEXPORT void JNICALL GRAPH_METHOD(nativeCancelGraph)(JNIEnv* env,
   mediapipe_graph->CancelGraph();
 }
 
+JNIEXPORT void JNICALL GRAPH_METHOD(nativeTrimMemory)(JNIEnv* env,
+                                                      jobject thiz,
+                                                      jlong context,
+                                                      jboolean complete) {
+  mediapipe::android::Graph* mediapipe_graph =
+      reinterpret_cast<mediapipe::android::Graph*>(context);
+  mediapipe_graph->TrimMemory(complete ? mediapipe::MemoryTrimLevel::kComplete
+                                       : mediapipe::MemoryTrimLevel::kModerate);
+}
+
 JNIEXPORT jlong JNICALL GRAPH_METHOD(nativeGetProfiler)(JNIEnv* env,
                                                         jobject thiz,
                                                         jlong context) {
@@ -33,6 +33,11 @@ JNIEXPORT void JNICALL GRAPH_METHOD(nativeReleaseGraph)(JNIEnv* env,
                                                         jobject thiz,
                                                         jlong context);
 
+JNIEXPORT void JNICALL GRAPH_METHOD(nativeTrimMemory)(JNIEnv* env,
+                                                      jobject thiz,
+                                                      jlong context,
+                                                      jboolean complete);
+
 // Loads a binary mediapipe graph into the context.
 JNIEXPORT void JNICALL GRAPH_METHOD(nativeLoadBinaryGraph)(JNIEnv* env,
                                                            jobject thiz,
@@ -29,6 +29,7 @@
 #include "mediapipe/framework/formats/video_stream_header.h"
 #include "mediapipe/framework/port/core_proto_inc.h"
 #include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/java/com/google/mediapipe/framework/jni/colorspace.h"
 #include "mediapipe/java/com/google/mediapipe/framework/jni/graph.h"
 #include "mediapipe/java/com/google/mediapipe/framework/jni/jni_util.h"
@@ -107,37 +108,71 @@ absl::StatusOr<mediapipe::GpuBuffer> CreateGpuBuffer(
 }
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
-// Create a 1, 3, or 4 channel 8-bit ImageFrame shared pointer from a Java
-// ByteBuffer.
-absl::StatusOr<std::unique_ptr<mediapipe::ImageFrame>>
-CreateImageFrameFromByteBuffer(JNIEnv* env, jobject byte_buffer, jint width,
-                               jint height, jint width_step,
-                               mediapipe::ImageFormat::Format format) {
+// Returns the data of a direct Java ByteBuffer of `expected_size` bytes.
+absl::StatusOr<uint8*> GetDirectBufferData(JNIEnv* env, jobject byte_buffer,
+                                           int64_t expected_size) {
   const int64_t buffer_size = env->GetDirectBufferCapacity(byte_buffer);
-  const void* buffer_data = env->GetDirectBufferAddress(byte_buffer);
+  void* buffer_data = env->GetDirectBufferAddress(byte_buffer);
   if (buffer_data == nullptr || buffer_size < 0) {
     return absl::InvalidArgumentError(
         "Cannot get direct access to the input buffer. It should be created "
         "using allocateDirect.");
   }
-
-  const int expected_buffer_size = height * width_step;
-  RET_CHECK_EQ(buffer_size, expected_buffer_size)
-      << "Input buffer size should be " << expected_buffer_size
+  RET_CHECK_EQ(buffer_size, expected_size)
+      << "Input buffer size should be " << expected_size
       << " but is: " << buffer_size;
+  return static_cast<uint8*>(buffer_data);
+}
 
+// Create a 1, 3, or 4 channel 8-bit ImageFrame shared pointer from a Java
+// ByteBuffer.
+absl::StatusOr<std::unique_ptr<mediapipe::ImageFrame>>
+CreateImageFrameFromByteBuffer(JNIEnv* env, jobject byte_buffer, jint width,
+                               jint height, jint width_step,
+                               mediapipe::ImageFormat::Format format) {
+  ASSIGN_OR_RETURN(const uint8* buffer_data,
+                   GetDirectBufferData(env, byte_buffer, height * width_step));
   auto image_frame = std::make_unique<mediapipe::ImageFrame>();
-  // TODO: we could retain the buffer with a special deleter and use
-  // the data directly without a copy. May need a new Java API since existing
-  // code might expect to be able to overwrite the buffer after creating an
-  // ImageFrame from it.
+  // Existing code may overwrite the buffer after creating an ImageFrame from
+  // it, see WrapByteBufferInImageFrame for the zero-copy variant.
   image_frame->CopyPixelData(
-      format, width, height, width_step, static_cast<const uint8*>(buffer_data),
+      format, width, height, width_step, buffer_data,
       mediapipe::ImageFrame::kGlDefaultAlignmentBoundary);
 
   return image_frame;
 }
 
+// Creates an ImageFrame that uses the data of a direct Java ByteBuffer without
+// copying it. A global reference keeps the buffer alive until the ImageFrame
+// is destroyed.
+absl::StatusOr<std::unique_ptr<mediapipe::ImageFrame>>
+WrapByteBufferInImageFrame(JNIEnv* env, jobject byte_buffer, jint width,
+                           jint height, jint width_step,
+                           mediapipe::ImageFormat::Format format) {
+  ASSIGN_OR_RETURN(uint8* buffer_data,
+                   GetDirectBufferData(env, byte_buffer, height * width_step));
+  jobject buffer_ref = env->NewGlobalRef(byte_buffer);
+  return std::make_unique<mediapipe::ImageFrame>(
+      format, width, height, width_step, buffer_data, [buffer_ref](uint8*) {
+        mediapipe::java::GetJNIEnv()->DeleteGlobalRef(buffer_ref);
+      });
+}
+
+absl::StatusOr<mediapipe::ImageFormat::Format> ImageFormatForChannels(
+    int num_channels) {
+  switch (num_channels) {
+    case 4:
+      return mediapipe::ImageFormat::SRGBA;
+    case 3:
+      return mediapipe::ImageFormat::SRGB;
+    case 1:
+      return mediapipe::ImageFormat::GRAY8;
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Channels must be either 1, 3, or 4, but are ", num_channels));
+  }
+}
+
 }  // namespace
 
 JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateReferencePacket)(
@@ -372,26 +407,26 @@ JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateMatrix)(
 JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeCreateCpuImage)(
     JNIEnv* env, jobject thiz, jlong context, jobject byte_buffer, jint width,
     jint height, jint width_step, jint num_channels) {
-  mediapipe::ImageFormat::Format format;
-  switch (num_channels) {
-    case 4:
-      format = mediapipe::ImageFormat::SRGBA;
-      break;
-    case 3:
-      format = mediapipe::ImageFormat::SRGB;
-      break;
-    case 1:
-      format = mediapipe::ImageFormat::GRAY8;
-      break;
-    default:
-      ThrowIfError(env, absl::InvalidArgumentError(absl::StrCat(
-                            "Channels must be either 1, 3, or 4, but are ",
-                            num_channels)));
-      return 0L;
-  }
+  auto format_or = ImageFormatForChannels(num_channels);
+  if (ThrowIfError(env, format_or.status())) return 0L;
 
   auto image_frame_or = CreateImageFrameFromByteBuffer(
-      env, byte_buffer, width, height, width_step, format);
+      env, byte_buffer, width, height, width_step, *format_or);
+  if (ThrowIfError(env, image_frame_or.status())) return 0L;
+
+  mediapipe::Packet packet =
+      mediapipe::MakePacket<mediapipe::Image>(*std::move(image_frame_or));
+  return CreatePacketWithContext(context, packet);
+}
+
+JNIEXPORT jlong JNICALL PACKET_CREATOR_METHOD(nativeWrapCpuImage)(
+    JNIEnv* env, jobject thiz, jlong context, jobject byte_buffer, jint width,
+    jint height, jint width_step, jint num_channels) {
+  auto format_or = ImageFormatForChannels(num_channels);
+  if (ThrowIfError(env, format_or.status())) return 0L;
+
+  auto image_frame_or = WrapByteBufferInImageFrame(
+      env, byte_buffer, width, height, width_step, *format_or);
   if (ThrowIfError(env, image_frame_or.status())) return 0L;
 
   mediapipe::Packet packet =
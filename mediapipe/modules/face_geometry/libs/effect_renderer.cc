@@ -14,6 +14,7 @@
 
 #include "mediapipe/modules/face_geometry/libs/effect_renderer.h"
 
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <limits>
@@ -104,6 +105,86 @@ struct RenderableMesh3d {
   std::vector<uint16_t> index_buffer;
 };
 
+// GL vertex and index buffer objects holding one or more meshes, so that the
+// mesh data isn't uploaded from client memory with every draw call.
+class MeshBuffers {
+ public:
+  static absl::StatusOr<std::unique_ptr<MeshBuffers>> Create() {
+    GLuint handles[2] = {0, 0};
+    glGenBuffers(2, handles);
+    RET_CHECK(handles[0] && handles[1])
+        << "Failed to initialize OpenGL buffers!";
+
+    return absl::WrapUnique(new MeshBuffers(handles[0], handles[1]));
+  }
+
+  static absl::StatusOr<std::unique_ptr<MeshBuffers>> CreateFromMesh(
+      const RenderableMesh3d& mesh_3d) {
+    ASSIGN_OR_RETURN(std::unique_ptr<MeshBuffers> buffers, Create());
+    buffers->UploadVertices(mesh_3d.vertex_buffer, GL_STATIC_DRAW);
+    buffers->UploadIndices(mesh_3d.index_buffer, GL_STATIC_DRAW);
+    return buffers;
+  }
+
+  ~MeshBuffers() {
+    const GLuint handles[2] = {vertex_buffer_handle_, index_buffer_handle_};
+    glDeleteBuffers(2, handles);
+  }
+
+  // Uploads the vertices, reusing the existing buffer storage if it is large
+  // enough.
+  void UploadVertices(const std::vector<float>& vertex_buffer, GLenum usage) {
+    Upload(GL_ARRAY_BUFFER, vertex_buffer_handle_, vertex_buffer.data(),
+           vertex_buffer.size() * sizeof(float), usage,
+           vertex_buffer_capacity_);
+  }
+
+  // Uploads the indices, reusing the existing buffer storage if it is large
+  // enough.
+  void UploadIndices(const std::vector<uint16_t>& index_buffer, GLenum usage) {
+    Upload(GL_ELEMENT_ARRAY_BUFFER, index_buffer_handle_, index_buffer.data(),
+           index_buffer.size() * sizeof(uint16_t), usage,
+           index_buffer_capacity_);
+  }
+
+  GLuint vertex_buffer_handle() const { return vertex_buffer_handle_; }
+  GLuint index_buffer_handle() const { return index_buffer_handle_; }
+
+ private:
+  MeshBuffers(GLuint vertex_buffer_handle, GLuint index_buffer_handle)
+      : vertex_buffer_handle_(vertex_buffer_handle),
+        index_buffer_handle_(index_buffer_handle) {}
+
+  static void Upload(GLenum target, GLuint handle, const void* data,
+                     size_t size, GLenum usage, size_t& capacity) {
+    if (size == 0) return;
+    glBindBuffer(target, handle);
+    if (size > capacity) {
+      glBufferData(target, size, data, usage);
+      capacity = size;
+    } else {
+      glBufferSubData(target, 0, size, data);
+    }
+    glBindBuffer(target, 0);
+  }
+
+  GLuint vertex_buffer_handle_;
+  GLuint index_buffer_handle_;
+  size_t vertex_buffer_capacity_ = 0;
+  size_t index_buffer_capacity_ = 0;
+};
+
+// A mesh stored in `MeshBuffers`, drawn with the given model matrix.
+struct MeshDraw {
+  // Provides the vertex layout, the primitive type and the number of indices.
+  const RenderableMesh3d* mesh_3d;
+  const MeshBuffers* buffers;
+  // Offsets of the mesh data in the buffers, in elements.
+  uint32_t vertex_buffer_offset;
+  uint32_t index_buffer_offset;
+  const std::array<float, 16>* model_mat;
+};
+
 class Texture {
  public:
   static absl::StatusOr<std::unique_ptr<Texture>> WrapExternalTexture(
@@ -346,11 +427,12 @@ class Renderer {
 
   ~Renderer() { glDeleteProgram(program_handle_); }
 
+  // Renders all `draws` in a single pass: the program, the GL state, the
+  // texture and the projection matrix are set up once for all of them.
   absl::Status Render(const RenderTarget& render_target, const Texture& texture,
-                      const RenderableMesh3d& mesh_3d,
                       const std::array<float, 16>& projection_mat,
-                      const std::array<float, 16>& model_mat,
-                      RenderMode render_mode) const {
+                      RenderMode render_mode,
+                      const std::vector<MeshDraw>& draws) const {
     glUseProgram(program_handle_);
     // Set up the GL state.
     glEnable(GL_BLEND);
@@ -376,16 +458,7 @@ class Renderer {
     }
 
     render_target.Bind();
-    // Set up vertex attributes.
-    glVertexAttribPointer(
-        ATTRIB_VERTEX, mesh_3d.vertex_position_size, GL_FLOAT, 0,
-        mesh_3d.vertex_size * sizeof(float),
-        mesh_3d.vertex_buffer.data() + mesh_3d.vertex_position_offset);
     glEnableVertexAttribArray(ATTRIB_VERTEX);
-    glVertexAttribPointer(
-        ATTRIB_TEXTURE_POSITION, mesh_3d.tex_coord_position_size, GL_FLOAT, 0,
-        mesh_3d.vertex_size * sizeof(float),
-        mesh_3d.vertex_buffer.data() + mesh_3d.tex_coord_position_offset);
     glEnableVertexAttribArray(ATTRIB_TEXTURE_POSITION);
     // Set up textures and uniforms.
     glActiveTexture(GL_TEXTURE1);
@@ -393,10 +466,38 @@ class Renderer {
     glUniform1i(texture_uniform_, 1);
     glUniformMatrix4fv(projection_mat_uniform_, 1, GL_FALSE,
                        projection_mat.data());
-    glUniformMatrix4fv(model_mat_uniform_, 1, GL_FALSE, model_mat.data());
-    // Draw the mesh.
-    glDrawElements(mesh_3d.primitive_type, mesh_3d.index_buffer.size(),
-                   GL_UNSIGNED_SHORT, mesh_3d.index_buffer.data());
+
+    const MeshBuffers* bound_buffers = nullptr;
+    for (const MeshDraw& draw : draws) {
+      const RenderableMesh3d& mesh_3d = *draw.mesh_3d;
+      if (draw.buffers != bound_buffers) {
+        glBindBuffer(GL_ARRAY_BUFFER, draw.buffers->vertex_buffer_handle());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                     draw.buffers->index_buffer_handle());
+        bound_buffers = draw.buffers;
+      }
+      // Set up vertex attributes.
+      glVertexAttribPointer(
+          ATTRIB_VERTEX, mesh_3d.vertex_position_size, GL_FLOAT, 0,
+          mesh_3d.vertex_size * sizeof(float),
+          BufferOffset<float>(draw.vertex_buffer_offset +
+                              mesh_3d.vertex_position_offset));
+      glVertexAttribPointer(
+          ATTRIB_TEXTURE_POSITION, mesh_3d.tex_coord_position_size, GL_FLOAT,
+          0, mesh_3d.vertex_size * sizeof(float),
+          BufferOffset<float>(draw.vertex_buffer_offset +
+                              mesh_3d.tex_coord_position_offset));
+      glUniformMatrix4fv(model_mat_uniform_, 1, GL_FALSE,
+                         draw.model_mat->data());
+      // Draw the mesh.
+      glDrawElements(mesh_3d.primitive_type, mesh_3d.index_buffer.size(),
+                     GL_UNSIGNED_SHORT,
+                     BufferOffset<uint16_t>(draw.index_buffer_offset));
+    }
+
+    // Unbind buffers.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     // Unbind textures and uniforms.
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(texture.target(), 0);
@@ -418,6 +519,14 @@ class Renderer {
  private:
   enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 
+  // Returns the pointer argument addressing element `offset` of type `T` in
+  // the bound buffer object.
+  template <typename T>
+  static const void* BufferOffset(uint32_t offset) {
+    return reinterpret_cast<const void*>(
+        static_cast<uintptr_t>(offset * sizeof(T)));
+  }
+
   Renderer(GLuint program_handle, GLint projection_mat_uniform,
            GLint model_mat_uniform, GLint texture_uniform)
       : program_handle_(program_handle),
@@ -438,14 +547,20 @@ class EffectRendererImpl : public EffectRenderer {
       std::unique_ptr<RenderTarget> render_target,
       std::unique_ptr<Renderer> renderer,
       RenderableMesh3d&& renderable_quad_mesh_3d,
+      std::unique_ptr<MeshBuffers> quad_mesh_buffers,
       absl::optional<RenderableMesh3d>&& renderable_effect_mesh_3d,
+      std::unique_ptr<MeshBuffers> effect_mesh_buffers,
+      std::unique_ptr<MeshBuffers> face_mesh_buffers,
       std::unique_ptr<Texture> empty_color_texture,
       std::unique_ptr<Texture> effect_texture)
       : environment_(environment),
         render_target_(std::move(render_target)),
         renderer_(std::move(renderer)),
         renderable_quad_mesh_3d_(std::move(renderable_quad_mesh_3d)),
+        quad_mesh_buffers_(std::move(quad_mesh_buffers)),
         renderable_effect_mesh_3d_(std::move(renderable_effect_mesh_3d)),
+        effect_mesh_buffers_(std::move(effect_mesh_buffers)),
+        face_mesh_buffers_(std::move(face_mesh_buffers)),
         empty_color_texture_(std::move(empty_color_texture)),
         effect_texture_(std::move(effect_texture)),
         identity_matrix_(Create4x4IdentityMatrix()) {}
@@ -493,8 +608,11 @@ class EffectRendererImpl : public EffectRenderer {
     // Render the source texture on top of the quad mesh (i.e. make a copy)
     // into the render target.
     MP_RETURN_IF_ERROR(renderer_->Render(
-        *render_target_, *src_texture, renderable_quad_mesh_3d_,
-        identity_matrix_, identity_matrix_, Renderer::RenderMode::OVERDRAW))
+        *render_target_, *src_texture, identity_matrix_,
+        Renderer::RenderMode::OVERDRAW,
+        {{&renderable_quad_mesh_3d_, quad_mesh_buffers_.get(),
+          /*vertex_buffer_offset*/ 0, /*index_buffer_offset*/ 0,
+          &identity_matrix_}}))
         << "Failed to render the source texture on top of the quad mesh!";
 
     // Extract pose transform matrices and meshes from the face geometry data;
@@ -502,6 +620,12 @@ class EffectRendererImpl : public EffectRenderer {
 
     std::vector<std::array<float, 16>> face_pose_transform_matrices(num_faces);
     std::vector<RenderableMesh3d> renderable_face_meshes(num_faces);
+    // The meshes of all faces are packed into the same buffers, which are
+    // uploaded once for all render passes.
+    std::vector<uint32_t> face_vertex_buffer_offsets(num_faces);
+    std::vector<uint32_t> face_index_buffer_offsets(num_faces);
+    face_vertex_buffer_.clear();
+    face_index_buffer_.clear();
     for (int i = 0; i < num_faces; ++i) {
       const FaceGeometry& face_geometry = multi_face_geometry[i];
 
@@ -517,52 +641,67 @@ class EffectRendererImpl : public EffectRenderer {
           renderable_face_meshes[i],
           RenderableMesh3d::CreateFromProtoMesh3d(face_geometry.mesh()),
           _ << "Failed to extract a renderable face mesh!");
+
+      const RenderableMesh3d& renderable_face_mesh = renderable_face_meshes[i];
+      face_vertex_buffer_offsets[i] = face_vertex_buffer_.size();
+      face_index_buffer_offsets[i] = face_index_buffer_.size();
+      face_vertex_buffer_.insert(face_vertex_buffer_.end(),
+                                 renderable_face_mesh.vertex_buffer.begin(),
+                                 renderable_face_mesh.vertex_buffer.end());
+      face_index_buffer_.insert(face_index_buffer_.end(),
+                                renderable_face_mesh.index_buffer.begin(),
+                                renderable_face_mesh.index_buffer.end());
+    }
+
+    face_mesh_buffers_->UploadVertices(face_vertex_buffer_, GL_STREAM_DRAW);
+    // Face meshes usually share the canonical face mesh topology, so their
+    // indices rarely change between frames.
+    if (face_index_buffer_ != uploaded_face_index_buffer_) {
+      face_mesh_buffers_->UploadIndices(face_index_buffer_, GL_DYNAMIC_DRAW);
+      uploaded_face_index_buffer_ = face_index_buffer_;
     }
 
     // Create a perspective matrix using the frame aspect ratio.
     std::array<float, 16> perspective_matrix = CreatePerspectiveMatrix(
         /*aspect_ratio*/ static_cast<float>(frame_width) / frame_height);
 
-    // Render a face mesh occluder for each face.
+    // Render a face mesh occluder for each face, using the empty color
+    // texture.
+    //
+    // For occlusion, the pose transformation is moved ~1mm away from camera
+    // in order to allow the face mesh texture to be rendered without failing
+    // the depth test.
+    std::vector<std::array<float, 16>> occlusion_face_pose_transform_matrices(
+        face_pose_transform_matrices);
+    std::vector<MeshDraw> draws(num_faces);
     for (int i = 0; i < num_faces; ++i) {
-      const std::array<float, 16>& face_pose_transform_matrix =
-          face_pose_transform_matrices[i];
-      const RenderableMesh3d& renderable_face_mesh = renderable_face_meshes[i];
-
-      // Render the face mesh using the empty color texture, i.e. the face
-      // mesh occluder.
-      //
-      // For occlusion, the pose transformation is moved ~1mm away from camera
-      // in order to allow the face mesh texture to be rendered without
-      // failing the depth test.
-      std::array<float, 16> occlusion_face_pose_transform_matrix =
-          face_pose_transform_matrix;
-      occlusion_face_pose_transform_matrix[14] -= 0.1f;  // ~ 1mm
-      MP_RETURN_IF_ERROR(renderer_->Render(
-          *render_target_, *empty_color_texture_, renderable_face_mesh,
-          perspective_matrix, occlusion_face_pose_transform_matrix,
-          Renderer::RenderMode::OCCLUSION))
-          << "Failed to render the face mesh occluder!";
+      occlusion_face_pose_transform_matrices[i][14] -= 0.1f;  // ~ 1mm
+      draws[i] = {&renderable_face_meshes[i], face_mesh_buffers_.get(),
+                  face_vertex_buffer_offsets[i], face_index_buffer_offsets[i],
+                  &occlusion_face_pose_transform_matrices[i]};
     }
+    MP_RETURN_IF_ERROR(renderer_->Render(
+        *render_target_, *empty_color_texture_, perspective_matrix,
+        Renderer::RenderMode::OCCLUSION, draws))
+        << "Failed to render the face mesh occluder!";
 
     // Render the main face mesh effect component for each face.
     for (int i = 0; i < num_faces; ++i) {
-      const std::array<float, 16>& face_pose_transform_matrix =
-          face_pose_transform_matrices[i];
-
       // If there is no effect 3D mesh provided, then the face mesh itself is
       // used as a topology for rendering (for example, this can be used for
       // facepaint effects or AR makeup).
-      const RenderableMesh3d& main_effect_mesh_3d =
-          renderable_effect_mesh_3d_ ? *renderable_effect_mesh_3d_
-                                     : renderable_face_meshes[i];
-
-      MP_RETURN_IF_ERROR(renderer_->Render(
-          *render_target_, *effect_texture_, main_effect_mesh_3d,
-          perspective_matrix, face_pose_transform_matrix,
-          Renderer::RenderMode::OPAQUE))
-          << "Failed to render the main effect pass!";
+      if (renderable_effect_mesh_3d_) {
+        draws[i] = {&*renderable_effect_mesh_3d_, effect_mesh_buffers_.get(),
+                    /*vertex_buffer_offset*/ 0, /*index_buffer_offset*/ 0,
+                    &face_pose_transform_matrices[i]};
+      } else {
+        draws[i].model_mat = &face_pose_transform_matrices[i];
+      }
     }
+    MP_RETURN_IF_ERROR(renderer_->Render(
+        *render_target_, *effect_texture_, perspective_matrix,
+        Renderer::RenderMode::OPAQUE, draws))
+        << "Failed to render the main effect pass!";
 
     // At this point in the code, the destination texture must contain the
     // correctly renderer effect, so we should just return.
@@ -637,7 +776,15 @@ class EffectRendererImpl : public EffectRenderer {
   std::unique_ptr<Renderer> renderer_;
 
   RenderableMesh3d renderable_quad_mesh_3d_;
+  std::unique_ptr<MeshBuffers> quad_mesh_buffers_;
   absl::optional<RenderableMesh3d> renderable_effect_mesh_3d_;
+  // Null if there is no effect mesh.
+  std::unique_ptr<MeshBuffers> effect_mesh_buffers_;
+  std::unique_ptr<MeshBuffers> face_mesh_buffers_;
+  // The face meshes data of the current frame, and the last uploaded indices.
+  std::vector<float> face_vertex_buffer_;
+  std::vector<uint16_t> face_index_buffer_;
+  std::vector<uint16_t> uploaded_face_index_buffer_;
 
   std::unique_ptr<Texture> empty_color_texture_;
   std::unique_ptr<Texture> effect_texture_;
@@ -707,12 +854,22 @@ absl::StatusOr<std::unique_ptr<EffectRenderer>> CreateEffectRenderer(
   ASSIGN_OR_RETURN(RenderableMesh3d renderable_quad_mesh_3d,
                    RenderableMesh3d::CreateFromProtoMesh3d(CreateQuadMesh3d()),
                    _ << "Failed to create a renderable quad mesh!");
+  ASSIGN_OR_RETURN(std::unique_ptr<MeshBuffers> quad_mesh_buffers,
+                   MeshBuffers::CreateFromMesh(renderable_quad_mesh_3d),
+                   _ << "Failed to create quad mesh buffers!");
   absl::optional<RenderableMesh3d> renderable_effect_mesh_3d;
+  std::unique_ptr<MeshBuffers> effect_mesh_buffers;
   if (effect_mesh_3d) {
     ASSIGN_OR_RETURN(renderable_effect_mesh_3d,
                      RenderableMesh3d::CreateFromProtoMesh3d(*effect_mesh_3d),
                      _ << "Failed to create a renderable effect mesh!");
+    ASSIGN_OR_RETURN(effect_mesh_buffers,
+                     MeshBuffers::CreateFromMesh(*renderable_effect_mesh_3d),
+                     _ << "Failed to create effect mesh buffers!");
   }
+  ASSIGN_OR_RETURN(std::unique_ptr<MeshBuffers> face_mesh_buffers,
+                   MeshBuffers::Create(),
+                   _ << "Failed to create face mesh buffers!");
   ASSIGN_OR_RETURN(std::unique_ptr<Texture> empty_color_gl_texture,
                    Texture::CreateFromImageFrame(CreateEmptyColorTexture()),
                    _ << "Failed to create an empty color texture!");
@@ -723,9 +880,10 @@ absl::StatusOr<std::unique_ptr<EffectRenderer>> CreateEffectRenderer(
   std::unique_ptr<EffectRenderer> result =
       absl::make_unique<EffectRendererImpl>(
           environment, std::move(render_target), std::move(renderer),
-          std::move(renderable_quad_mesh_3d),
-          std::move(renderable_effect_mesh_3d),
-          std::move(empty_color_gl_texture), std::move(effect_gl_texture));
+          std::move(renderable_quad_mesh_3d), std::move(quad_mesh_buffers),
+          std::move(renderable_effect_mesh_3d), std::move(effect_mesh_buffers),
+          std::move(face_mesh_buffers), std::move(empty_color_gl_texture),
+          std::move(effect_gl_texture));
 
   return result;
 }
@@ -69,18 +69,24 @@ struct PerspectiveCameraFrustum {
   float far;
 };
 
+// Landmark matrices used by `ScreenToMetricSpaceConverter::Convert()`. They
+// are kept across calls so that converting the faces of a frame reuses their
+// memory instead of allocating it for each face.
+struct ConversionWorkspace {
+  Eigen::Matrix3Xf screen_landmarks;
+  Eigen::Matrix3Xf intermediate_landmarks;
+};
+
 class ScreenToMetricSpaceConverter {
  public:
   ScreenToMetricSpaceConverter(
       OriginPointLocation origin_point_location,      //
       InputSource input_source,                       //
       Eigen::Matrix3Xf&& canonical_metric_landmarks,  //
-      Eigen::VectorXf&& landmark_weights,             //
-      std::unique_ptr<ProcrustesSolver> procrustes_solver)
+      std::unique_ptr<FixedSourceProcrustesSolver> procrustes_solver)
       : origin_point_location_(origin_point_location),
         input_source_(input_source),
         canonical_metric_landmarks_(std::move(canonical_metric_landmarks)),
-        landmark_weights_(std::move(landmark_weights)),
         procrustes_solver_(std::move(procrustes_solver)) {}
 
   // Converts `screen_landmark_list` into `metric_landmark_list` and estimates
@@ -120,8 +126,12 @@ class ScreenToMetricSpaceConverter {
   //
   //       To keep the logic correct, the landmark set handedness is changed any
   //       time the screen-to-metric semantic barrier is passed.
+  //
+  // `workspace` holds the intermediate landmark matrices and can be reused
+  // across calls.
   absl::Status Convert(const NormalizedLandmarkList& screen_landmark_list,  //
                        const PerspectiveCameraFrustum& pcf,                 //
+                       ConversionWorkspace& workspace,                      //
                        LandmarkList& metric_landmark_list,                  //
                        Eigen::Matrix4f& pose_transform_mat) const {
     RET_CHECK_EQ(screen_landmark_list.landmark_size(),
@@ -129,7 +139,7 @@ class ScreenToMetricSpaceConverter {
         << "The number of landmarks doesn't match the number passed upon "
            "initialization!";
 
-    Eigen::Matrix3Xf screen_landmarks;
+    Eigen::Matrix3Xf& screen_landmarks = workspace.screen_landmarks;
     ConvertLandmarkListToEigenMatrix(screen_landmark_list, screen_landmarks);
 
     ProjectXY(pcf, screen_landmarks);
@@ -139,7 +149,8 @@ class ScreenToMetricSpaceConverter {
     //                the relative nature of the Z coordinate. Instead, run the
     //                first estimation on the projected XY and use that scale to
     //                unproject for the 2nd iteration.
-    Eigen::Matrix3Xf intermediate_landmarks(screen_landmarks);
+    Eigen::Matrix3Xf& intermediate_landmarks = workspace.intermediate_landmarks;
+    intermediate_landmarks = screen_landmarks;
     ChangeHandedness(intermediate_landmarks);
 
     ASSIGN_OR_RETURN(const float first_iteration_scale,
@@ -158,14 +169,11 @@ class ScreenToMetricSpaceConverter {
     if (input_source_ == InputSource::FACE_DETECTION_PIPELINE) {
       Eigen::Matrix4f intermediate_pose_transform_mat;
       MP_RETURN_IF_ERROR(procrustes_solver_->SolveWeightedOrthogonalProblem(
-          canonical_metric_landmarks_, intermediate_landmarks,
-          landmark_weights_, intermediate_pose_transform_mat))
+          intermediate_landmarks, intermediate_pose_transform_mat))
           << "Failed to estimate pose transform matrix!";
 
-      intermediate_landmarks.row(2) =
-          (intermediate_pose_transform_mat *
-           canonical_metric_landmarks_.colwise().homogeneous())
-              .row(2);
+      SetTransformedCanonicalZ(intermediate_pose_transform_mat,
+                               intermediate_landmarks);
     }
     ASSIGN_OR_RETURN(const float second_iteration_scale,
                      EstimateScale(intermediate_landmarks),
@@ -181,32 +189,34 @@ class ScreenToMetricSpaceConverter {
     Eigen::Matrix3Xf& metric_landmarks = screen_landmarks;
 
     MP_RETURN_IF_ERROR(procrustes_solver_->SolveWeightedOrthogonalProblem(
-        canonical_metric_landmarks_, metric_landmarks, landmark_weights_,
-        pose_transform_mat))
+        metric_landmarks, pose_transform_mat))
         << "Failed to estimate pose transform matrix!";
 
     // For face detection input landmarks, re-write Z-coord from the canonical
     // landmarks and run the pose transform estimation again.
     if (input_source_ == InputSource::FACE_DETECTION_PIPELINE) {
-      metric_landmarks.row(2) =
-          (pose_transform_mat *
-           canonical_metric_landmarks_.colwise().homogeneous())
-              .row(2);
+      SetTransformedCanonicalZ(pose_transform_mat, metric_landmarks);
 
       MP_RETURN_IF_ERROR(procrustes_solver_->SolveWeightedOrthogonalProblem(
-          canonical_metric_landmarks_, metric_landmarks, landmark_weights_,
-          pose_transform_mat))
+          metric_landmarks, pose_transform_mat))
           << "Failed to estimate pose transform matrix!";
     }
 
     // Multiply each of the metric landmarks by the inverse pose
     // transformation matrix to align the runtime metric face landmarks with
-    // the canonical metric face landmarks.
-    metric_landmarks = (pose_transform_mat.inverse() *
-                        metric_landmarks.colwise().homogeneous())
-                           .topRows(3);
-
-    ConvertEigenMatrixToLandmarkList(metric_landmarks, metric_landmark_list);
+    // the canonical metric face landmarks. The matrix is affine, so it's
+    // applied as its 3x3 linear part and translation, into the no longer
+    // needed intermediate landmarks to avoid a temporary.
+    const Eigen::Matrix4f inverse_pose_transform_mat =
+        pose_transform_mat.inverse();
+    Eigen::Matrix3Xf& aligned_metric_landmarks = intermediate_landmarks;
+    aligned_metric_landmarks.noalias() =
+        inverse_pose_transform_mat.topLeftCorner<3, 3>() * metric_landmarks;
+    aligned_metric_landmarks.colwise() +=
+        inverse_pose_transform_mat.topRightCorner<3, 1>();
+
+    ConvertEigenMatrixToLandmarkList(aligned_metric_landmarks,
+                                     metric_landmark_list);
 
     return absl::OkStatus();
   }
@@ -230,14 +240,23 @@ class ScreenToMetricSpaceConverter {
 
   absl::StatusOr<float> EstimateScale(Eigen::Matrix3Xf& landmarks) const {
     Eigen::Matrix4f transform_mat;
-    MP_RETURN_IF_ERROR(procrustes_solver_->SolveWeightedOrthogonalProblem(
-        canonical_metric_landmarks_, landmarks, landmark_weights_,
-        transform_mat))
+    MP_RETURN_IF_ERROR(
+        procrustes_solver_->SolveWeightedOrthogonalProblem(landmarks,
+                                                           transform_mat))
         << "Failed to estimate canonical-to-runtime landmark set transform!";
 
     return transform_mat.col(0).norm();
   }
 
+  // Replaces the Z coordinates of `landmarks` with those of the canonical
+  // landmarks transformed by `transform_mat`.
+  void SetTransformedCanonicalZ(const Eigen::Matrix4f& transform_mat,
+                                Eigen::Matrix3Xf& landmarks) const {
+    landmarks.row(2).noalias() =
+        transform_mat.block<1, 3>(2, 0) * canonical_metric_landmarks_;
+    landmarks.row(2).array() += transform_mat(2, 3);
+  }
+
   static void MoveAndRescaleZ(const PerspectiveCameraFrustum& pcf,
                               float depth_offset, float scale,
                               Eigen::Matrix3Xf& landmarks) {
@@ -260,7 +279,7 @@ class ScreenToMetricSpaceConverter {
   static void ConvertLandmarkListToEigenMatrix(
       const NormalizedLandmarkList& landmark_list,
       Eigen::Matrix3Xf& eigen_matrix) {
-    eigen_matrix = Eigen::Matrix3Xf(3, landmark_list.landmark_size());
+    eigen_matrix.resize(3, landmark_list.landmark_size());
     for (int i = 0; i < landmark_list.landmark_size(); ++i) {
       const auto& landmark = landmark_list.landmark(i);
       eigen_matrix(0, i) = landmark.x();
@@ -284,9 +303,8 @@ class ScreenToMetricSpaceConverter {
   const OriginPointLocation origin_point_location_;
   const InputSource input_source_;
   Eigen::Matrix3Xf canonical_metric_landmarks_;
-  Eigen::VectorXf landmark_weights_;
 
-  std::unique_ptr<ProcrustesSolver> procrustes_solver_;
+  std::unique_ptr<FixedSourceProcrustesSolver> procrustes_solver_;
 };
 
 class GeometryPipelineImpl : public GeometryPipeline {
@@ -318,6 +336,10 @@ class GeometryPipelineImpl : public GeometryPipeline {
                                  frame_height);
 
     std::vector<FaceGeometry> multi_face_geometry;
+    multi_face_geometry.reserve(multi_face_landmarks.size());
+    // Shared by all faces so that the landmark matrices are only allocated
+    // once per call.
+    ConversionWorkspace workspace;
 
     // From this point, the meaning of "face landmarks" is clarified further as
     // "screen face landmarks". This is done do distinguish from "metric face
@@ -334,9 +356,9 @@ class GeometryPipelineImpl : public GeometryPipeline {
       // transformation matrix.
       LandmarkList metric_face_landmarks;
       Eigen::Matrix4f pose_transform_mat;
-      MP_RETURN_IF_ERROR(space_converter_->Convert(screen_face_landmarks, pcf,
-                                                   metric_face_landmarks,
-                                                   pose_transform_mat))
+      MP_RETURN_IF_ERROR(space_converter_->Convert(
+          screen_face_landmarks, pcf, workspace, metric_face_landmarks,
+          pose_transform_mat))
           << "Failed to convert landmarks from the screen to the metric space!";
 
       // Pack geometry data for this face.
@@ -360,7 +382,7 @@ class GeometryPipelineImpl : public GeometryPipeline {
       mediapipe::MatrixDataProtoFromMatrix(
           pose_transform_mat, face_geometry.mutable_pose_transform_matrix());
 
-      multi_face_geometry.push_back(face_geometry);
+      multi_face_geometry.push_back(std::move(face_geometry));
     }
 
     return multi_face_geometry;
@@ -446,6 +468,12 @@ absl::StatusOr<std::unique_ptr<GeometryPipeline>> CreateGeometryPipeline(
     landmark_weights(landmark_id) = wlr.weight();
   }
 
+  ASSIGN_OR_RETURN(
+      std::unique_ptr<FixedSourceProcrustesSolver> procrustes_solver,
+      CreateFloatPrecisionFixedSourceProcrustesSolver(
+          canonical_metric_landmarks, landmark_weights),
+      _ << "Failed to create the Procrustes solver for the canonical mesh!");
+
   std::unique_ptr<GeometryPipeline> result =
       absl::make_unique<GeometryPipelineImpl>(
           environment.perspective_camera(), canonical_mesh,
@@ -457,8 +485,7 @@ absl::StatusOr<std::unique_ptr<GeometryPipeline>> CreateGeometryPipeline(
                   ? InputSource::FACE_LANDMARK_PIPELINE
                   : metadata.input_source(),
               std::move(canonical_metric_landmarks),
-              std::move(landmark_weights),
-              CreateFloatPrecisionProcrustesSolver()));
+              std::move(procrustes_solver)));
 
   return result;
 }
@@ -16,6 +16,8 @@
 
 #include <cmath>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "Eigen/Dense"
 #include "absl/memory/memory.h"
@@ -28,6 +30,75 @@ namespace mediapipe {
 namespace face_geometry {
 namespace {
 
+constexpr float kAbsoluteErrorEps = 1e-9f;
+
+absl::Status ValidatePointWeights(int num_points,
+                                  const Eigen::VectorXf& point_weights) {
+  RET_CHECK_GT(point_weights.size(), 0)
+      << "The number of point weights must be positive!";
+
+  RET_CHECK_EQ(point_weights.size(), num_points)
+      << "The number of points and point weights must be equal!";
+
+  float total_weight = 0.f;
+  for (int i = 0; i < num_points; ++i) {
+    RET_CHECK_GE(point_weights(i), 0.f)
+        << "Each point weight must be non-negative!";
+
+    total_weight += point_weights(i);
+  }
+
+  RET_CHECK_GT(total_weight, kAbsoluteErrorEps)
+      << "The total point weight is too small!";
+
+  return absl::OkStatus();
+}
+
+// Combines a 3x3 rotation-and-scale matrix and a 3x1 translation vector into
+// a single 4x4 transformation matrix.
+Eigen::Matrix4f CombineTransformMatrix(const Eigen::Matrix3f& r_and_s,
+                                       const Eigen::Vector3f& t) {
+  Eigen::Matrix4f result = Eigen::Matrix4f::Identity();
+  result.leftCols(3).topRows(3) = r_and_s;
+  result.col(3).topRows(3) = t;
+
+  return result;
+}
+
+// `design_matrix` is a transposed LHS of (51) in the paper referenced by
+// `FloatPrecisionProcrustesSolver::InternalSolveWeightedOrthogonalProblem()`.
+//
+// Note: the output `rotation` argument is used instead of `StatusOr<>`
+// return type in order to avoid Eigen memory alignment issues. Details:
+// https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
+absl::Status ComputeOptimalRotation(const Eigen::Matrix3f& design_matrix,
+                                    Eigen::Matrix3f& rotation) {
+  RET_CHECK_GT(design_matrix.norm(), kAbsoluteErrorEps)
+      << "Design matrix norm is too small!";
+
+  Eigen::JacobiSVD<Eigen::Matrix3f> svd(
+      design_matrix, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+  Eigen::Matrix3f postrotation = svd.matrixU();
+  Eigen::Matrix3f prerotation = svd.matrixV().transpose();
+
+  // Disallow reflection by ensuring that det(`rotation`) = +1 (and not -1),
+  // see "4.6 Constrained orthogonal Procrustes problems"
+  // in the Gower & Dijksterhuis's book "Procrustes Analysis".
+  // We flip the sign of the least singular value along with a column in W.
+  //
+  // Note that now the sum of singular values doesn't work for scale
+  // estimation due to this sign flip.
+  if (postrotation.determinant() * prerotation.determinant() <
+      static_cast<float>(0)) {
+    postrotation.col(2) *= static_cast<float>(-1);
+  }
+
+  // Transposed (52) from the paper.
+  rotation = postrotation * prerotation;
+  return absl::OkStatus();
+}
+
 class FloatPrecisionProcrustesSolver : public ProcrustesSolver {
  public:
   FloatPrecisionProcrustesSolver() = default;
@@ -56,8 +127,6 @@ class FloatPrecisionProcrustesSolver : public ProcrustesSolver {
   }
 
  private:
-  static constexpr float kAbsoluteErrorEps = 1e-9f;
-
   static absl::Status ValidateInputPoints(
       const Eigen::Matrix3Xf& source_points,
       const Eigen::Matrix3Xf& target_points) {
@@ -70,28 +139,6 @@ class FloatPrecisionProcrustesSolver : public ProcrustesSolver {
     return absl::OkStatus();
   }
 
-  static absl::Status ValidatePointWeights(
-      int num_points, const Eigen::VectorXf& point_weights) {
-    RET_CHECK_GT(point_weights.size(), 0)
-        << "The number of point weights must be positive!";
-
-    RET_CHECK_EQ(point_weights.size(), num_points)
-        << "The number of points and point weights must be equal!";
-
-    float total_weight = 0.f;
-    for (int i = 0; i < num_points; ++i) {
-      RET_CHECK_GE(point_weights(i), 0.f)
-          << "Each point weight must be non-negative!";
-
-      total_weight += point_weights(i);
-    }
-
-    RET_CHECK_GT(total_weight, kAbsoluteErrorEps)
-        << "The total point weight is too small!";
-
-    return absl::OkStatus();
-  }
-
   static Eigen::VectorXf ExtractSquareRoot(
       const Eigen::VectorXf& point_weights) {
     Eigen::VectorXf sqrt_weights(point_weights);
@@ -102,17 +149,6 @@ class FloatPrecisionProcrustesSolver : public ProcrustesSolver {
     return sqrt_weights;
   }
 
-  // Combines a 3x3 rotation-and-scale matrix and a 3x1 translation vector into
-  // a single 4x4 transformation matrix.
-  static Eigen::Matrix4f CombineTransformMatrix(const Eigen::Matrix3f& r_and_s,
-                                                const Eigen::Vector3f& t) {
-    Eigen::Matrix4f result = Eigen::Matrix4f::Identity();
-    result.leftCols(3).topRows(3) = r_and_s;
-    result.col(3).topRows(3) = t;
-
-    return result;
-  }
-
   // The weighted problem is thoroughly addressed in Section 2.4 of:
   // D. Akca, Generalized Procrustes analysis and its applications
   // in photogrammetry, 2003, https://doi.org/10.3929/ethz-a-004656648
@@ -198,39 +234,6 @@ class FloatPrecisionProcrustesSolver : public ProcrustesSolver {
     return absl::OkStatus();
   }
 
-  // `design_matrix` is a transposed LHS of (51) in the paper.
-  //
-  // Note: the output `rotation` argument is used instead of `StatusOr<>`
-  // return type in order to avoid Eigen memory alignment issues. Details:
-  // https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
-  static absl::Status ComputeOptimalRotation(
-      const Eigen::Matrix3f& design_matrix, Eigen::Matrix3f& rotation) {
-    RET_CHECK_GT(design_matrix.norm(), kAbsoluteErrorEps)
-        << "Design matrix norm is too small!";
-
-    Eigen::JacobiSVD<Eigen::Matrix3f> svd(
-        design_matrix, Eigen::ComputeFullU | Eigen::ComputeFullV);
-
-    Eigen::Matrix3f postrotation = svd.matrixU();
-    Eigen::Matrix3f prerotation = svd.matrixV().transpose();
-
-    // Disallow reflection by ensuring that det(`rotation`) = +1 (and not -1),
-    // see "4.6 Constrained orthogonal Procrustes problems"
-    // in the Gower & Dijksterhuis's book "Procrustes Analysis".
-    // We flip the sign of the least singular value along with a column in W.
-    //
-    // Note that now the sum of singular values doesn't work for scale
-    // estimation due to this sign flip.
-    if (postrotation.determinant() * prerotation.determinant() <
-        static_cast<float>(0)) {
-      postrotation.col(2) *= static_cast<float>(-1);
-    }
-
-    // Transposed (52) from the paper.
-    rotation = postrotation * prerotation;
-    return absl::OkStatus();
-  }
-
   static absl::StatusOr<float> ComputeOptimalScale(
       const Eigen::Matrix3Xf& centered_weighted_sources,
       const Eigen::Matrix3Xf& weighted_sources,
@@ -256,11 +259,125 @@ class FloatPrecisionProcrustesSolver : public ProcrustesSolver {
   }
 };
 
+// Solves the same problem as `FloatPrecisionProcrustesSolver`, but expands
+// all of its sums over the points so that only those that involve the target
+// points are left for each solve. With C, c_w and w as defined there and
+// a_i, b_i and w_i the i-th source point, target point and weight:
+//
+//   * The design matrix is sum(w_i b_i tranposed(a_i - c_w)).
+//   * The scale numerator is trace(tranposed(T) * design matrix), and the
+//     denominator sum(w_i tranposed(a_i - c_w) a_i) only depends on sources.
+//   * The translation is (sum(w_i b_i) - R sum(w_i a_i)) / w.
+//
+// Points with a zero weight don't contribute to any of the sums, so they are
+// dropped upon creation.
+class FloatPrecisionFixedSourceProcrustesSolver
+    : public FixedSourceProcrustesSolver {
+ public:
+  FloatPrecisionFixedSourceProcrustesSolver(
+      int num_points, std::vector<int>&& point_ids,
+      std::vector<float>&& point_weights, Eigen::Matrix3Xf&& centered_sources,
+      const Eigen::Vector3f& weighted_source_sum, float total_weight,
+      float scale_denominator)
+      : num_points_(num_points),
+        point_ids_(std::move(point_ids)),
+        point_weights_(std::move(point_weights)),
+        centered_sources_(std::move(centered_sources)),
+        weighted_source_sum_(weighted_source_sum),
+        total_weight_(total_weight),
+        scale_denominator_(scale_denominator) {}
+
+  absl::Status SolveWeightedOrthogonalProblem(
+      const Eigen::Matrix3Xf& target_points,
+      Eigen::Matrix4f& transform_mat) const override {
+    RET_CHECK_EQ(target_points.cols(), num_points_)
+        << "The number of source and target points must be equal!";
+
+    Eigen::Vector3f weighted_target_sum = Eigen::Vector3f::Zero();
+    Eigen::Matrix3f design_matrix = Eigen::Matrix3f::Zero();
+    for (int i = 0; i < point_ids_.size(); ++i) {
+      const Eigen::Vector3f weighted_target =
+          point_weights_[i] * target_points.col(point_ids_[i]);
+      weighted_target_sum += weighted_target;
+      design_matrix.noalias() +=
+          weighted_target * centered_sources_.col(i).transpose();
+    }
+
+    Eigen::Matrix3f rotation;
+    MP_RETURN_IF_ERROR(ComputeOptimalRotation(design_matrix, rotation))
+        << "Failed to compute the optimal rotation!";
+
+    const float scale =
+        rotation.cwiseProduct(design_matrix).sum() / scale_denominator_;
+    RET_CHECK_GT(scale, kAbsoluteErrorEps)
+        << "Failed to compute the optimal scale! Scale is too small!";
+
+    const Eigen::Matrix3f rotation_and_scale = scale * rotation;
+    const Eigen::Vector3f translation =
+        (weighted_target_sum - rotation_and_scale * weighted_source_sum_) /
+        total_weight_;
+
+    transform_mat = CombineTransformMatrix(rotation_and_scale, translation);
+
+    return absl::OkStatus();
+  }
+
+ private:
+  const int num_points_;
+  // The ids and weights of the points with a positive weight.
+  const std::vector<int> point_ids_;
+  const std::vector<float> point_weights_;
+  // a_i - c_w for each of the points above.
+  const Eigen::Matrix3Xf centered_sources_;
+  const Eigen::Vector3f weighted_source_sum_;
+  const float total_weight_;
+  const float scale_denominator_;
+};
+
 }  // namespace
 
 std::unique_ptr<ProcrustesSolver> CreateFloatPrecisionProcrustesSolver() {
   return absl::make_unique<FloatPrecisionProcrustesSolver>();
 }
 
+absl::StatusOr<std::unique_ptr<FixedSourceProcrustesSolver>>
+CreateFloatPrecisionFixedSourceProcrustesSolver(
+    const Eigen::Matrix3Xf& source_points,
+    const Eigen::VectorXf& point_weights) {
+  RET_CHECK_GT(source_points.cols(), 0)
+      << "The number of source points must be positive!";
+  MP_RETURN_IF_ERROR(ValidatePointWeights(source_points.cols(), point_weights))
+      << "Failed to validate weighted orthogonal problem point weights!";
+
+  std::vector<int> point_ids;
+  std::vector<float> weights;
+  float total_weight = 0.f;
+  Eigen::Vector3f weighted_source_sum = Eigen::Vector3f::Zero();
+  for (int i = 0; i < point_weights.size(); ++i) {
+    if (point_weights(i) <= 0.f) continue;
+    point_ids.push_back(i);
+    weights.push_back(point_weights(i));
+    total_weight += point_weights(i);
+    weighted_source_sum += point_weights(i) * source_points.col(i);
+  }
+
+  const Eigen::Vector3f source_center_of_mass =
+      weighted_source_sum / total_weight;
+  Eigen::Matrix3Xf centered_sources(3, point_ids.size());
+  float scale_denominator = 0.f;
+  for (int i = 0; i < point_ids.size(); ++i) {
+    const auto source = source_points.col(point_ids[i]);
+    centered_sources.col(i) = source - source_center_of_mass;
+    scale_denominator += weights[i] * centered_sources.col(i).dot(source);
+  }
+  RET_CHECK_GT(scale_denominator, kAbsoluteErrorEps)
+      << "Scale expression denominator is too small!";
+
+  return absl::make_unique<FloatPrecisionFixedSourceProcrustesSolver>(
+      source_points.cols(), std::move(point_ids), std::move(weights),
+      std::move(centered_sources), weighted_source_sum, total_weight,
+      scale_denominator);
+}
+
 }  // namespace face_geometry
 }  // namespace mediapipe
@@ -19,6 +19,7 @@
 
 #include "Eigen/Dense"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe::face_geometry {
 
@@ -65,6 +66,36 @@ class ProcrustesSolver {
 
 std::unique_ptr<ProcrustesSolver> CreateFloatPrecisionProcrustesSolver();
 
+// Solves the same problem as `ProcrustesSolver`, for source points and point
+// weights that are fixed upon creation, such as the canonical face mesh
+// landmarks and their Procrustes basis weights.
+//
+// Everything that only depends on the source points is computed once, and
+// points with a zero weight are skipped, so each solve only accumulates a few
+// 3x3 sums over the weighted target points, without any memory allocation.
+class FixedSourceProcrustesSolver {
+ public:
+  virtual ~FixedSourceProcrustesSolver() = default;
+
+  // Solves the WEOP problem for the source points and point weights passed
+  // upon creation. `target_points` must define the same number of points.
+  //
+  // Note: the output `transform_mat` argument is used instead of `StatusOr<>`
+  // return type in order to avoid Eigen memory alignment issues. Details:
+  // https://eigen.tuxfamily.org/dox/group__TopicStructHavingEigenMembers.html
+  virtual absl::Status SolveWeightedOrthogonalProblem(
+      const Eigen::Matrix3Xf& target_points,
+      Eigen::Matrix4f& transform_mat) const = 0;
+};
+
+// Returns an error status if `source_points` or `point_weights` are invalid,
+// as defined in `ProcrustesSolver`, or if the source point cloud is too
+// compact.
+absl::StatusOr<std::unique_ptr<FixedSourceProcrustesSolver>>
+CreateFloatPrecisionFixedSourceProcrustesSolver(
+    const Eigen::Matrix3Xf& source_points,
+    const Eigen::VectorXf& point_weights);
+
 }  // namespace mediapipe::face_geometry
 
 #endif  // MEDIAPIPE_FACE_GEOMETRY_LIBS_PROCRUSTES_SOLVER_H_
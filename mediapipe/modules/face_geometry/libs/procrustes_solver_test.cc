@@ -0,0 +1,140 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/modules/face_geometry/libs/procrustes_solver.h"
+
+#include <memory>
+#include <random>
+
+#include "Eigen/Dense"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe::face_geometry {
+namespace {
+
+using ::testing::HasSubstr;
+
+constexpr int kNumPoints = 100;
+constexpr int kNumClouds = 20;
+
+// Returns a random transform made of a uniform scale, a rotation and a
+// translation, as estimated by the solvers.
+Eigen::Matrix4f RandomTransform(std::mt19937& rng) {
+  std::uniform_real_distribution<float> unit(-1.f, 1.f);
+  std::uniform_real_distribution<float> scale(0.5f, 2.f);
+  const Eigen::Quaternionf rotation =
+      Eigen::Quaternionf(unit(rng), unit(rng), unit(rng), unit(rng))
+          .normalized();
+  Eigen::Matrix4f transform = Eigen::Matrix4f::Identity();
+  transform.topLeftCorner<3, 3>() = scale(rng) * rotation.toRotationMatrix();
+  transform.topRightCorner<3, 1>() =
+      Eigen::Vector3f(unit(rng), unit(rng), unit(rng)) * 10.f;
+  return transform;
+}
+
+// Compares the fixed source solver with the general one on random clouds,
+// where about a third of the points have a zero weight and the targets of
+// those points are far off.
+TEST(FixedSourceProcrustesSolverTest, MatchesGeneralSolverOnRandomClouds) {
+  std::mt19937 rng(/*seed=*/1);
+  std::uniform_real_distribution<float> unit(-1.f, 1.f);
+  std::uniform_real_distribution<float> weight(0.f, 1.f);
+  std::uniform_real_distribution<float> noise(-0.01f, 0.01f);
+  const std::unique_ptr<ProcrustesSolver> general_solver =
+      CreateFloatPrecisionProcrustesSolver();
+
+  for (int cloud = 0; cloud < kNumClouds; ++cloud) {
+    Eigen::Matrix3Xf sources(3, kNumPoints);
+    Eigen::VectorXf weights(kNumPoints);
+    for (int i = 0; i < kNumPoints; ++i) {
+      sources.col(i) = Eigen::Vector3f(unit(rng), unit(rng), unit(rng)) * 5.f;
+      weights(i) = i % 3 == 0 ? 0.f : weight(rng);
+    }
+    const Eigen::Matrix4f transform = RandomTransform(rng);
+    Eigen::Matrix3Xf targets =
+        (transform * sources.colwise().homogeneous()).topRows(3);
+    for (int i = 0; i < kNumPoints; ++i) {
+      if (weights(i) == 0.f) {
+        targets.col(i) += Eigen::Vector3f(100.f, -100.f, 100.f);
+      } else {
+        targets.col(i) += Eigen::Vector3f(noise(rng), noise(rng), noise(rng));
+      }
+    }
+
+    MP_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<FixedSourceProcrustesSolver> fixed_solver,
+        CreateFloatPrecisionFixedSourceProcrustesSolver(sources, weights));
+    Eigen::Matrix4f expected;
+    MP_ASSERT_OK(general_solver->SolveWeightedOrthogonalProblem(
+        sources, targets, weights, expected));
+    Eigen::Matrix4f actual;
+    MP_ASSERT_OK(fixed_solver->SolveWeightedOrthogonalProblem(targets, actual));
+
+    EXPECT_TRUE(actual.isApprox(expected, 1e-4f))
+        << "cloud " << cloud << "\nexpected:\n"
+        << expected << "\nactual:\n"
+        << actual;
+    // The far off targets of the zero weight points don't matter.
+    EXPECT_TRUE(actual.isApprox(transform, 1e-2f))
+        << "cloud " << cloud << "\ntransform:\n"
+        << transform << "\nactual:\n"
+        << actual;
+  }
+}
+
+TEST(FixedSourceProcrustesSolverTest, TooCompactSourceIsAnError) {
+  // All the weight is on points at the same position.
+  Eigen::Matrix3Xf sources(3, 4);
+  sources << 1.f, 1.f, 1.f, 5.f,  //
+      2.f, 2.f, 2.f, 6.f,         //
+      3.f, 3.f, 3.f, 7.f;
+  Eigen::VectorXf weights(4);
+  weights << 0.5f, 1.f, 2.f, 0.f;
+
+  const absl::Status status =
+      CreateFloatPrecisionFixedSourceProcrustesSolver(sources, weights)
+          .status();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInternal);
+  EXPECT_THAT(status.message(),
+              HasSubstr("Scale expression denominator is too small!"));
+}
+
+TEST(FixedSourceProcrustesSolverTest, InvalidPointsAreErrors) {
+  Eigen::Matrix3Xf sources = Eigen::Matrix3Xf::Random(3, 4);
+  Eigen::VectorXf weights = Eigen::VectorXf::Ones(4);
+
+  EXPECT_FALSE(CreateFloatPrecisionFixedSourceProcrustesSolver(
+                   sources, Eigen::VectorXf::Ones(3))
+                   .ok());
+  EXPECT_FALSE(CreateFloatPrecisionFixedSourceProcrustesSolver(
+                   sources, Eigen::VectorXf::Zero(4))
+                   .ok());
+  EXPECT_FALSE(CreateFloatPrecisionFixedSourceProcrustesSolver(
+                   sources, -Eigen::VectorXf::Ones(4))
+                   .ok());
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FixedSourceProcrustesSolver> solver,
+      CreateFloatPrecisionFixedSourceProcrustesSolver(sources, weights));
+  Eigen::Matrix4f transform;
+  EXPECT_FALSE(solver
+                   ->SolveWeightedOrthogonalProblem(
+                       Eigen::Matrix3Xf::Random(3, 5), transform)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace mediapipe::face_geometry
@@ -24,10 +24,12 @@
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/modules/objectron/calculators/annotation_data.pb.h"
 #include "mediapipe/modules/objectron/calculators/box.h"
 #include "mediapipe/modules/objectron/calculators/epnp.h"
 #include "mediapipe/modules/objectron/calculators/types.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 
 namespace mediapipe {
 
@@ -42,6 +44,48 @@ inline void SetPoint3d(const Eigen::Vector3f& point_vec, Point3D* point_3d) {
   point_3d->set_z(point_vec.z());
 }
 
+absl::Status LiftAnnotation(const Eigen::Matrix4f& projection_matrix,
+                            bool portrait, ObjectAnnotation* annotation) {
+  CHECK_EQ(kNumKeypoints, annotation->keypoints_size());
+
+  // Fill input 2D Points;
+  std::vector<Vector2f> input_points_2d;
+  input_points_2d.reserve(kNumKeypoints);
+  for (const auto& keypoint : annotation->keypoints()) {
+    input_points_2d.emplace_back(keypoint.point_2d().x(),
+                                 keypoint.point_2d().y());
+  }
+
+  // Run EPnP.
+  std::vector<Vector3f> output_points_3d;
+  output_points_3d.reserve(kNumKeypoints);
+  MP_RETURN_IF_ERROR(SolveEpnp(projection_matrix, portrait, input_points_2d,
+                               &output_points_3d));
+
+  // Fill 3D keypoints;
+  for (int i = 0; i < kNumKeypoints; ++i) {
+    SetPoint3d(output_points_3d[i],
+               annotation->mutable_keypoints(i)->mutable_point_3d());
+  }
+
+  // Fit a box to the 3D points to get box scale, rotation, translation.
+  Box box("category");
+  box.Fit(output_points_3d);
+  const Eigen::Matrix<float, 3, 3, Eigen::RowMajor> rotation =
+      box.GetRotation();
+  const Eigen::Vector3f translation = box.GetTranslation();
+  const Eigen::Vector3f scale = box.GetScale();
+  // Fill box rotation.
+  *annotation->mutable_rotation() = {rotation.data(),
+                                     rotation.data() + rotation.size()};
+  // Fill box translation.
+  *annotation->mutable_translation() = {
+      translation.data(), translation.data() + translation.size()};
+  // Fill box scale.
+  *annotation->mutable_scale() = {scale.data(), scale.data() + scale.size()};
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 FrameAnnotation Decoder::DecodeBoundingBoxKeypoints(
@@ -104,7 +148,7 @@ void Decoder::DecodeByVoting(const cv::Mat& heatmap, const cv::Mat& offsetmap,
   // Votes at the center.
   const auto& center_offset = offsetmap.at<cv::Vec<float, kNumOffsetmaps>>(
       /*row*/ center_y, /*col*/ center_x);
-  std::vector<float> center_votes(kNumOffsetmaps, 0.f);
+  float center_votes[kNumOffsetmaps];
   for (int i = 0; i < kNumOffsetmaps / 2; ++i) {
     center_votes[2 * i] = center_x + center_offset[2 * i] * offset_scale_x;
     center_votes[2 * i + 1] =
@@ -120,36 +164,39 @@ void Decoder::DecodeByVoting(const cv::Mat& heatmap, const cv::Mat& offsetmap,
   cv::Mat heat = heatmap(rect);
   cv::Mat offset = offsetmap(rect);
 
-  for (int i = 0; i < kNumOffsetmaps / 2; ++i) {
-    float x_sum = 0.f;
-    float y_sum = 0.f;
-    float votes = 0.f;
-    for (int r = 0; r < heat.rows; ++r) {
-      for (int c = 0; c < heat.cols; ++c) {
-        const float belief = heat.at<float>(r, c);
-        if (belief < config_.voting_threshold()) {
-          continue;
-        }
-        float offset_x =
-            offset.at<cv::Vec<float, kNumOffsetmaps>>(r, c)[2 * i] *
-            offset_scale_x;
-        float offset_y =
-            offset.at<cv::Vec<float, kNumOffsetmaps>>(r, c)[2 * i + 1] *
-            offset_scale_y;
-        float vote_x = c + rect.x + offset_x;
-        float vote_y = r + rect.y + offset_y;
-        float x_diff = std::abs(vote_x - center_votes[2 * i]);
-        float y_diff = std::abs(vote_y - center_votes[2 * i + 1]);
-        if (x_diff > config_.voting_allowance() ||
-            y_diff > config_.voting_allowance()) {
+  // Accumulates the votes of all keypoints in one pass over the window.
+  constexpr int kNumVotedKeypoints = kNumOffsetmaps / 2;
+  float x_sums[kNumVotedKeypoints] = {0.f};
+  float y_sums[kNumVotedKeypoints] = {0.f};
+  float votes[kNumVotedKeypoints] = {0.f};
+  const float voting_threshold = config_.voting_threshold();
+  const float voting_allowance = config_.voting_allowance();
+  for (int r = 0; r < heat.rows; ++r) {
+    const float* heat_row = heat.ptr<float>(r);
+    const float* offset_row = offset.ptr<float>(r);
+    const float y = r + rect.y;
+    for (int c = 0; c < heat.cols; ++c) {
+      const float belief = heat_row[c];
+      if (belief < voting_threshold) {
+        continue;
+      }
+      const float* pixel_offset = offset_row + c * kNumOffsetmaps;
+      const float x = c + rect.x;
+      for (int i = 0; i < kNumVotedKeypoints; ++i) {
+        const float vote_x = x + pixel_offset[2 * i] * offset_scale_x;
+        const float vote_y = y + pixel_offset[2 * i + 1] * offset_scale_y;
+        if (std::abs(vote_x - center_votes[2 * i]) > voting_allowance ||
+            std::abs(vote_y - center_votes[2 * i + 1]) > voting_allowance) {
           continue;
         }
-        x_sum += vote_x * belief;
-        y_sum += vote_y * belief;
-        votes += belief;
+        x_sums[i] += vote_x * belief;
+        y_sums[i] += vote_y * belief;
+        votes[i] += belief;
       }
     }
-    box->box_2d.emplace_back(x_sum / votes, y_sum / votes);
+  }
+  for (int i = 0; i < kNumVotedKeypoints; ++i) {
+    box->box_2d.emplace_back(x_sums[i] / votes[i], y_sums[i] / votes[i]);
   }
 }
 
@@ -203,48 +250,24 @@ absl::Status Decoder::Lift2DTo3D(
     bool portrait, FrameAnnotation* estimated_box) const {
   CHECK(estimated_box != nullptr);
 
-  for (auto& annotation : *estimated_box->mutable_annotations()) {
-    CHECK_EQ(kNumKeypoints, annotation.keypoints_size());
-
-    // Fill input 2D Points;
-    std::vector<Vector2f> input_points_2d;
-    input_points_2d.reserve(kNumKeypoints);
-    for (const auto& keypoint : annotation.keypoints()) {
-      input_points_2d.emplace_back(keypoint.point_2d().x(),
-                                   keypoint.point_2d().y());
-    }
-
-    // Run EPnP.
-    std::vector<Vector3f> output_points_3d;
-    output_points_3d.reserve(kNumKeypoints);
-    auto status = SolveEpnp(projection_matrix, portrait, input_points_2d,
-                            &output_points_3d);
+  const Eigen::Matrix4f projection = projection_matrix;
+  auto* annotations = estimated_box->mutable_annotations();
+  const int num_annotations = annotations->size();
+  // The objects are lifted independently, so crowded scenes are spread over
+  // the parallel invoker threads.
+  std::vector<absl::Status> statuses(num_annotations);
+  ParallelFor(0, num_annotations, /*grain_size=*/1,
+              [&](const BlockedRange& range) {
+                for (int i = range.begin(); i < range.end(); ++i) {
+                  statuses[i] = LiftAnnotation(projection, portrait,
+                                               annotations->Mutable(i));
+                }
+              });
+  for (const auto& status : statuses) {
     if (!status.ok()) {
       LOG(ERROR) << status;
       return status;
     }
-
-    // Fill 3D keypoints;
-    for (int i = 0; i < kNumKeypoints; ++i) {
-      SetPoint3d(output_points_3d[i],
-                 annotation.mutable_keypoints(i)->mutable_point_3d());
-    }
-
-    // Fit a box to the 3D points to get box scale, rotation, translation.
-    Box box("category");
-    box.Fit(output_points_3d);
-    const Eigen::Matrix<float, 3, 3, Eigen::RowMajor> rotation =
-        box.GetRotation();
-    const Eigen::Vector3f translation = box.GetTranslation();
-    const Eigen::Vector3f scale = box.GetScale();
-    // Fill box rotation.
-    *annotation.mutable_rotation() = {rotation.data(),
-                                      rotation.data() + rotation.size()};
-    // Fill box translation.
-    *annotation.mutable_translation() = {
-        translation.data(), translation.data() + translation.size()};
-    // Fill box scale.
-    *annotation.mutable_scale() = {scale.data(), scale.data() + scale.size()};
   }
   return absl::OkStatus();
 }
@@ -0,0 +1,308 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/modules/objectron/calculators/decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Eigen/Dense"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/modules/objectron/calculators/annotation_data.pb.h"
+#include "mediapipe/modules/objectron/calculators/belief_decoder_config.pb.h"
+#include "mediapipe/modules/objectron/calculators/epnp.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
+
+namespace mediapipe {
+namespace {
+
+using Eigen::AngleAxisf;
+using Eigen::Vector2f;
+using Eigen::Vector3f;
+using ProjectionMatrix = Eigen::Matrix<float, 4, 4, Eigen::RowMajor>;
+
+constexpr int kNumKeypoints = 9;
+constexpr int kNumOffsetmaps = 16;
+constexpr int kRows = 30;
+constexpr int kCols = 40;
+
+// Object centers and half sizes in heatmap pixels. The last object is close
+// to the bottom border, so that its voting window is clipped.
+constexpr int kNumObjects = 3;
+constexpr float kObjects[kNumObjects][4] = {
+    {12.f, 10.f, 5.f, 4.f},
+    {28.f, 16.f, 6.f, 5.f},
+    {6.f, 27.f, 3.f, 2.f},
+};
+
+// clang-format off
+constexpr float kUnitBox[kNumKeypoints][3] = {{ 0.0f,  0.0f,  0.0f},
+                                              {-0.5f, -0.5f, -0.5f},
+                                              {-0.5f, -0.5f,  0.5f},
+                                              {-0.5f,  0.5f, -0.5f},
+                                              {-0.5f,  0.5f,  0.5f},
+                                              { 0.5f, -0.5f, -0.5f},
+                                              { 0.5f, -0.5f,  0.5f},
+                                              { 0.5f,  0.5f, -0.5f},
+                                              { 0.5f,  0.5f,  0.5f}};
+// clang-format on
+
+BeliefDecoderConfig VotingConfig() {
+  BeliefDecoderConfig config;
+  config.set_heatmap_threshold(0.6f);
+  config.set_local_max_distance(2.f);
+  config.set_voting_radius(3);
+  config.set_voting_allowance(1);
+  config.set_voting_threshold(0.2f);
+  return config;
+}
+
+// Returns the pixel position of the given box vertex of an object.
+Vector2f VertexPosition(const float* object, int vertex) {
+  return Vector2f(object[0] + 2.f * kUnitBox[vertex][0] * object[2],
+                  object[1] + 2.f * kUnitBox[vertex][1] * object[3]);
+}
+
+// Fills a heatmap with a blob per object, and an offset map in which the
+// pixels around each object point at its vertices, off by up to 1.5 pixels
+// so that some of their votes are rejected.
+void MakeMaps(cv::Mat* heatmap, cv::Mat* offsetmap) {
+  *heatmap = cv::Mat(kRows, kCols, CV_32FC1);
+  *offsetmap = cv::Mat(kRows, kCols, CV_32FC(kNumOffsetmaps));
+  const float offset_scale = std::min(kRows, kCols);
+  std::mt19937 rng(/*seed=*/3);
+  std::uniform_real_distribution<float> noise(-1.5f, 1.5f);
+  for (int r = 0; r < kRows; ++r) {
+    float* heat_row = heatmap->ptr<float>(r);
+    float* offset_row = offsetmap->ptr<float>(r);
+    for (int c = 0; c < kCols; ++c) {
+      // Each pixel belongs to its nearest object.
+      int nearest = 0;
+      float nearest_distance = 0.f;
+      for (int k = 0; k < kNumObjects; ++k) {
+        const float distance = (Vector2f(c, r) - VertexPosition(kObjects[k], 0))
+                                   .squaredNorm();
+        if (k == 0 || distance < nearest_distance) {
+          nearest = k;
+          nearest_distance = distance;
+        }
+      }
+      heat_row[c] = std::exp(-nearest_distance / 8.f);
+      float* pixel_offset = offset_row + c * kNumOffsetmaps;
+      for (int i = 0; i < kNumOffsetmaps / 2; ++i) {
+        const Vector2f vertex = VertexPosition(kObjects[nearest], i + 1);
+        pixel_offset[2 * i] = (vertex.x() - c + noise(rng)) / offset_scale;
+        pixel_offset[2 * i + 1] = (vertex.y() - r + noise(rng)) / offset_scale;
+      }
+    }
+  }
+}
+
+// Votes for the box vertices around a center one keypoint at a time, as the
+// decoder used to.
+std::vector<Vector2f> PerKeypointVotes(const BeliefDecoderConfig& config,
+                                       const cv::Mat& heatmap,
+                                       const cv::Mat& offsetmap, int center_x,
+                                       int center_y) {
+  const float offset_scale = std::min(offsetmap.cols, offsetmap.rows);
+  const auto& center_offset =
+      offsetmap.at<cv::Vec<float, kNumOffsetmaps>>(center_y, center_x);
+  const int x_min = std::max(0, center_x - config.voting_radius());
+  const int y_min = std::max(0, center_y - config.voting_radius());
+  const cv::Rect rect(
+      x_min, y_min,
+      std::min(heatmap.cols - x_min, config.voting_radius() * 2 + 1),
+      std::min(heatmap.rows - y_min, config.voting_radius() * 2 + 1));
+  const cv::Mat heat = heatmap(rect);
+  const cv::Mat offset = offsetmap(rect);
+
+  std::vector<Vector2f> votes;
+  for (int i = 0; i < kNumOffsetmaps / 2; ++i) {
+    const float center_vote_x =
+        center_x + center_offset[2 * i] * offset_scale;
+    const float center_vote_y =
+        center_y + center_offset[2 * i + 1] * offset_scale;
+    float x_sum = 0.f;
+    float y_sum = 0.f;
+    float belief_sum = 0.f;
+    for (int r = 0; r < heat.rows; ++r) {
+      for (int c = 0; c < heat.cols; ++c) {
+        const float belief = heat.at<float>(r, c);
+        if (belief < config.voting_threshold()) {
+          continue;
+        }
+        const auto& pixel_offset =
+            offset.at<cv::Vec<float, kNumOffsetmaps>>(r, c);
+        const float vote_x = c + rect.x + pixel_offset[2 * i] * offset_scale;
+        const float vote_y =
+            r + rect.y + pixel_offset[2 * i + 1] * offset_scale;
+        if (std::abs(vote_x - center_vote_x) > config.voting_allowance() ||
+            std::abs(vote_y - center_vote_y) > config.voting_allowance()) {
+          continue;
+        }
+        x_sum += vote_x * belief;
+        y_sum += vote_y * belief;
+        belief_sum += belief;
+      }
+    }
+    votes.emplace_back(x_sum / belief_sum, y_sum / belief_sum);
+  }
+  return votes;
+}
+
+TEST(DecoderTest, VotingMatchesPerKeypointVoting) {
+  const BeliefDecoderConfig config = VotingConfig();
+  cv::Mat heatmap, offsetmap;
+  MakeMaps(&heatmap, &offsetmap);
+
+  const Decoder decoder(config);
+  const FrameAnnotation frame =
+      decoder.DecodeBoundingBoxKeypoints(heatmap, offsetmap);
+  ASSERT_EQ(frame.annotations_size(), kNumObjects);
+
+  const float x_scale = 1.0f / kCols;
+  const float y_scale = 1.0f / kRows;
+  for (const auto& annotation : frame.annotations()) {
+    ASSERT_EQ(annotation.keypoints_size(), kNumKeypoints);
+    const int center_x = static_cast<int>(
+        std::round(annotation.keypoints(0).point_2d().x() * kCols));
+    const int center_y = static_cast<int>(
+        std::round(annotation.keypoints(0).point_2d().y() * kRows));
+    SCOPED_TRACE(testing::Message() << center_x << "," << center_y);
+    const float* object = nullptr;
+    for (const auto& candidate : kObjects) {
+      if (candidate[0] == center_x && candidate[1] == center_y) {
+        object = candidate;
+      }
+    }
+    ASSERT_NE(object, nullptr);
+
+    const std::vector<Vector2f> expected =
+        PerKeypointVotes(config, heatmap, offsetmap, center_x, center_y);
+    for (int i = 0; i < kNumOffsetmaps / 2; ++i) {
+      const auto& point_2d = annotation.keypoints(i + 1).point_2d();
+      EXPECT_FLOAT_EQ(point_2d.x(), expected[i].x() * x_scale) << i;
+      EXPECT_FLOAT_EQ(point_2d.y(), expected[i].y() * y_scale) << i;
+      // The accepted votes are within the allowance of the true vertices.
+      const Vector2f vertex = VertexPosition(object, i + 1);
+      EXPECT_NEAR(point_2d.x() * kCols, vertex.x(), 2.6f) << i;
+      EXPECT_NEAR(point_2d.y() * kRows, vertex.y(), 2.6f) << i;
+    }
+  }
+}
+
+class DecoderLiftTest
+    : public ::testing::TestWithParam<PARALLEL_INVOKER_MODE> {
+ protected:
+  void SetUp() override {
+    saved_mode_ = flags_parallel_invoker_mode;
+    flags_parallel_invoker_mode = GetParam();
+    // clang-format off
+    projection_matrix_ << 1.5f, 0.0f,  0.0f, 0.0f,
+                          0.0f, 2.0f,  0.0f, 0.0f,
+                          0.0f, 0.0f, -1.0f, 0.0f,
+                          0.0f, 0.0f, -1.0f, 0.0f;
+    // clang-format on
+  }
+
+  void TearDown() override { flags_parallel_invoker_mode = saved_mode_; }
+
+  // Returns a frame of boxes at various poses, projected to normalized
+  // pixel coordinates.
+  FrameAnnotation ProjectedBoxes(int num_boxes) const {
+    FrameAnnotation frame;
+    for (int k = 0; k < num_boxes; ++k) {
+      const Eigen::Matrix3f rotation =
+          (AngleAxisf(0.1f * k, Vector3f::UnitZ()) *
+           AngleAxisf(0.4f + 0.2f * k, Vector3f::UnitX()) *
+           AngleAxisf(0.3f * k, Vector3f::UnitY()))
+              .toRotationMatrix();
+      const Vector3f scale(0.5f + 0.1f * k, 0.7f, 0.4f + 0.05f * k);
+      const Vector3f translation(0.3f * (k % 3) - 0.3f, 0.2f * (k % 2),
+                                 -3.f - 0.5f * k);
+      auto* annotation = frame.add_annotations();
+      for (int i = 0; i < kNumKeypoints; ++i) {
+        const Vector3f point =
+            rotation * Vector3f(kUnitBox[i][0], kUnitBox[i][1],
+                                kUnitBox[i][2])
+                           .cwiseProduct(scale) +
+            translation;
+        const float x_ndc =
+            -projection_matrix_(0, 0) * point.x() / point.z();
+        const float y_ndc =
+            -projection_matrix_(1, 1) * point.y() / point.z();
+        auto* point_2d = annotation->add_keypoints()->mutable_point_2d();
+        point_2d->set_x((1.f + x_ndc) / 2.f);
+        point_2d->set_y((1.f - y_ndc) / 2.f);
+      }
+    }
+    return frame;
+  }
+
+  ProjectionMatrix projection_matrix_;
+
+ private:
+  int saved_mode_;
+};
+
+TEST_P(DecoderLiftTest, LiftsObjectsLikeOneAtATime) {
+  constexpr int kNumBoxes = 7;
+  const Decoder decoder(VotingConfig());
+  FrameAnnotation frame = ProjectedBoxes(kNumBoxes);
+  const FrameAnnotation input = frame;
+  MP_ASSERT_OK(
+      decoder.Lift2DTo3D(projection_matrix_, /*portrait=*/false, &frame));
+  ASSERT_EQ(frame.annotations_size(), kNumBoxes);
+
+  for (int k = 0; k < kNumBoxes; ++k) {
+    SCOPED_TRACE(testing::Message() << "box " << k);
+    FrameAnnotation single;
+    *single.add_annotations() = input.annotations(k);
+    MP_ASSERT_OK(
+        decoder.Lift2DTo3D(projection_matrix_, /*portrait=*/false, &single));
+    EXPECT_EQ(frame.annotations(k).SerializeAsString(),
+              single.annotations(0).SerializeAsString());
+
+    // The 3D keypoints are the EPnP solution of the 2D ones.
+    std::vector<Vector2f> points_2d;
+    for (const auto& keypoint : input.annotations(k).keypoints()) {
+      points_2d.emplace_back(keypoint.point_2d().x(), keypoint.point_2d().y());
+    }
+    std::vector<Vector3f> points_3d;
+    MP_ASSERT_OK(SolveEpnp(Eigen::Matrix4f(projection_matrix_),
+                           /*portrait=*/false, points_2d, &points_3d));
+    const auto& annotation = frame.annotations(k);
+    ASSERT_EQ(annotation.keypoints_size(), kNumKeypoints);
+    for (int i = 0; i < kNumKeypoints; ++i) {
+      const auto& point_3d = annotation.keypoints(i).point_3d();
+      EXPECT_EQ(point_3d.x(), points_3d[i].x()) << i;
+      EXPECT_EQ(point_3d.y(), points_3d[i].y()) << i;
+      EXPECT_EQ(point_3d.z(), points_3d[i].z()) << i;
+    }
+    EXPECT_EQ(annotation.rotation_size(), 9);
+    EXPECT_EQ(annotation.translation_size(), 3);
+    EXPECT_EQ(annotation.scale_size(), 3);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ParallelModes, DecoderLiftTest,
+                         ::testing::Values(PARALLEL_INVOKER_NONE,
+                                           PARALLEL_INVOKER_THREAD_POOL));
+
+}  // namespace
+}  // namespace mediapipe
@@ -132,7 +132,7 @@ absl::Status SolveEpnp(const float focal_x, const float focal_y,
   // only! If you use other Eigen Solvers, it's not guaranteed to be in
   // increasing order. Here, we just take the eigen vector corresponding
   // to first/smallest eigen value, since we used SelfAdjointEigenSolver.
-  Eigen::VectorXf eigen_vec = eigen_solver.eigenvectors().col(0);
+  Matrix<float, 12, 1> eigen_vec = eigen_solver.eigenvectors().col(0);
   Map<Matrix<float, 4, 3, Eigen::RowMajor>> control_matrix(eigen_vec.data());
 
   // All 3D points should be in front of camera (z < 0).
@@ -16,6 +16,9 @@
 
 #import <AVFoundation/AVFoundation.h>
 #import <Accelerate/Accelerate.h>
+#if TARGET_OS_IPHONE
+#import <UIKit/UIKit.h>
+#endif  // TARGET_OS_IPHONE
 
 #include <atomic>
 
@@ -24,6 +27,7 @@
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/memory_trimmer.h"
 #include "mediapipe/gpu/gl_base.h"
 #include "mediapipe/gpu/gpu_shared_data_internal.h"
 #include "mediapipe/objc/util.h"
@@ -64,10 +68,27 @@
     [[[NSThread alloc] init] start];
     _graph = absl::make_unique<mediapipe::CalculatorGraph>();
     _config = config;
+#if TARGET_OS_IPHONE
+    [[NSNotificationCenter defaultCenter]
+        addObserver:self
+           selector:@selector(didReceiveMemoryWarning:)
+               name:UIApplicationDidReceiveMemoryWarningNotification
+             object:nil];
+#endif  // TARGET_OS_IPHONE
   }
   return self;
 }
 
+- (void)dealloc {
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+/// Frees the buffers kept by the graph and the working memory of its calculators, which are
+/// allocated again when next needed.
+- (void)didReceiveMemoryWarning:(NSNotification*)notification {
+  _graph->TrimMemory(mediapipe::MemoryTrimLevel::kComplete);
+}
+
 - (mediapipe::ProfilingContext*)getProfiler {
   return _graph->profiler();
 }
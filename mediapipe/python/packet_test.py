@@ -210,6 +210,14 @@ class PacketTest(absltest.TestCase):
     self.assertAlmostEqual(output_list[2], 0.3)
     self.assertEqual(p.timestamp, 100)
 
+  def test_float_vector_packet_view(self):
+    p = packet_creator.create_float_vector([0.1, 0.2, 0.3]).at(100)
+    output_array = packet_getter.get_float_list_view(p)
+    del p
+    self.assertEqual(output_array.dtype, np.float32)
+    self.assertFalse(output_array.flags.writeable)
+    np.testing.assert_allclose(output_array, [0.1, 0.2, 0.3])
+
   def test_image_vector_packet(self):
     w, h, offset = 80, 40, 10
     mat = np.random.randint(2**8 - 1, size=(h, w, 3), dtype=np.uint8)
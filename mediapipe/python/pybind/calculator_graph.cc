@@ -18,6 +18,7 @@
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/output_stream_poller.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/map_util.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -61,6 +62,61 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
       .value("ADD_IF_NOT_FULL", GraphInputStreamAddMode::ADD_IF_NOT_FULL)
       .export_values();
 
+  py::class_<OutputStreamPoller> output_stream_poller(
+      m, "OutputStreamPoller",
+      R"doc(A synchronous, polling API for accessing an output stream of a graph.
+
+  Unlike the output stream observer callbacks, the graph doesn't take the GIL
+  to deliver the packets. They are queued until next() is called.)doc");
+
+  output_stream_poller.def(
+      "next",
+      [](OutputStreamPoller* self) -> py::object {
+        Packet packet;
+        bool has_packet;
+        {
+          py::gil_scoped_release gil_release;
+          has_packet = self->Next(&packet);
+        }
+        if (!has_packet) {
+          return py::none();
+        }
+        return py::cast(std::move(packet));
+      },
+      R"doc(Get the next packet of the output stream.
+
+  Blocks until a packet is available or the stream is done, without holding
+  the GIL.
+
+  Returns:
+    The next packet, or None if the stream is done.
+
+  Examples:
+    poller = graph.add_output_stream_poller('out')
+    graph.start_run()
+    graph.add_packet_to_input_stream(
+        stream='in', packet=packet_creator.create_int(0), timestamp=0)
+    graph.close_all_packet_sources()
+    while (packet := poller.next()) is not None:
+      print(packet_getter.get_int(packet))
+
+)doc");
+
+  output_stream_poller.def(
+      "queue_size", [](OutputStreamPoller* self) { return self->QueueSize(); },
+      R"doc(Returns the number of packets waiting in the queue of the poller.)doc");
+
+  output_stream_poller.def(
+      "set_max_queue_size",
+      [](OutputStreamPoller* self, int queue_size) {
+        self->SetMaxQueueSize(queue_size);
+      },
+      R"doc(Limits the number of packets queued by the poller.
+
+  The graph is throttled when the queue is full. A queue size of -1 means
+  unlimited.)doc",
+      py::arg("queue_size"));
+
   // Calculator Graph
   py::class_<CalculatorGraph> calculator_graph(
       m, "CalculatorGraph", R"doc(The primary API for the MediaPipe Framework.
@@ -442,6 +498,40 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
       py::arg("stream_name"), py::arg("callback_fn"),
       py::arg("observe_timestamp_bounds") = false);
 
+  calculator_graph.def(
+      "add_output_stream_poller",
+      [](CalculatorGraph* self, const std::string& stream_name,
+         bool observe_timestamp_bounds) {
+        auto status_or_poller =
+            self->AddOutputStreamPoller(stream_name, observe_timestamp_bounds);
+        RaisePyErrorIfNotOk(status_or_poller.status());
+        return std::move(status_or_poller).value();
+      },
+      R"doc(Add an OutputStreamPoller for the named output stream.
+
+  The poller queues the packets of the stream until they are polled. This
+  method can only be called before start_run().
+
+  Args:
+    stream_name: The name of the output stream.
+    observe_timestamp_bounds: If true, emits an empty packet at
+      timestamp_bound -1 when timestamp bound changes.
+
+  Returns:
+    An OutputStreamPoller, which keeps the graph alive.
+
+  Raises:
+    RuntimeError: If the calculator graph isn't initialized or the stream
+      doesn't exist.
+
+  Examples:
+    graph = mp.CalculatorGraph(graph_config=graph_config)
+    poller = graph.add_output_stream_poller('out')
+
+)doc",
+      py::arg("stream_name"), py::arg("observe_timestamp_bounds") = false,
+      py::return_value_policy::move, py::keep_alive<0, 1>());
+
   calculator_graph.def(
       "close",
       [](CalculatorGraph* self) {
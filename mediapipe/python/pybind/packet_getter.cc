@@ -14,15 +14,20 @@
 
 #include "mediapipe/python/pybind/packet_getter.h"
 
+#include <array>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/timestamp.h"
 #include "mediapipe/python/pybind/image_frame_util.h"
 #include "mediapipe/python/pybind/util.h"
 #include "pybind11/eigen.h"
+#include "pybind11/numpy.h"
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
 
@@ -30,15 +35,50 @@ namespace mediapipe {
 namespace python {
 namespace {
 
+namespace py = pybind11;
+
 template <typename T>
 const T& GetContent(const Packet& packet) {
   RaisePyErrorIfNotOk(packet.ValidateAsType<T>());
   return packet.Get<T>();
 }
 
-}  // namespace
+// Returns a read-only numpy array over `data`, which is owned by `owner`. The
+// array takes ownership of `owner`, so that the data outlives both the Python
+// packet object and the graph.
+template <typename Owner>
+py::array MakeReadOnlyArray(const py::dtype& dtype,
+                            const std::vector<py::ssize_t>& shape,
+                            const void* data, Owner* owner) {
+  py::capsule base(owner,
+                   [](void* owner) { delete static_cast<Owner*>(owner); });
+  py::array array(dtype, shape, data, base);
+  py::detail::array_proxy(array.ptr())->flags &=
+      ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+  return array;
+}
 
-namespace py = pybind11;
+py::dtype TensorDtype(Tensor::ElementType element_type) {
+  switch (element_type) {
+    case Tensor::ElementType::kFloat16:
+      return py::dtype("float16");
+    case Tensor::ElementType::kFloat32:
+      return py::dtype::of<float>();
+    case Tensor::ElementType::kUInt8:
+      return py::dtype::of<uint8>();
+    case Tensor::ElementType::kInt8:
+    case Tensor::ElementType::kChar:
+      return py::dtype::of<int8>();
+    case Tensor::ElementType::kInt32:
+      return py::dtype::of<int32>();
+    case Tensor::ElementType::kBool:
+      return py::dtype::of<bool>();
+    default:
+      throw RaisePyError(PyExc_ValueError, "Unsupported tensor element type.");
+  }
+}
+
+}  // namespace
 
 void PublicPacketGetters(pybind11::module* m) {
   m->def("get_str", &GetContent<std::string>,
@@ -279,6 +319,48 @@ void PublicPacketGetters(pybind11::module* m) {
     data = packet_getter.get_float_list(packet)
 )doc");
 
+  m->def(
+      "get_float_list_view",
+      [](const Packet& packet) {
+        const float* data;
+        py::ssize_t size;
+        if (packet.ValidateAsType<std::vector<float>>().ok()) {
+          const auto& floats = packet.Get<std::vector<float>>();
+          data = floats.data();
+          size = floats.size();
+        } else if (packet.ValidateAsType<std::array<float, 16>>().ok()) {
+          data = packet.Get<std::array<float, 16>>().data();
+          size = 16;
+        } else if (packet.ValidateAsType<std::array<float, 4>>().ok()) {
+          data = packet.Get<std::array<float, 4>>().data();
+          size = 4;
+        } else {
+          throw RaisePyError(PyExc_ValueError,
+                             "Packet doesn't contain std::vector<float> or "
+                             "std::array<float, 4 / 16> containers.");
+        }
+        return MakeReadOnlyArray(py::dtype::of<float>(), {size}, data,
+                                 new Packet(packet));
+      },
+      R"doc(Get the content of a MediaPipe float vector Packet as a numpy view.
+
+  Unlike get_float_list, the data isn't copied. The returned read-only numpy 1d
+  float ndarray refers to the packet content and keeps it alive.
+
+  Args:
+    packet: A MediaPipe Packet that holds std:vector<float>.
+
+  Returns:
+    A read-only numpy 1d float ndarray.
+
+  Raises:
+    ValueError: If the Packet doesn't contain std:vector<float>.
+
+  Examples:
+    packet = packet_creator.create_float_vector([0.1, 0.2, 0.3])
+    data = packet_getter.get_float_list_view(packet)
+)doc");
+
   m->def(
       "get_str_list", &GetContent<std::vector<std::string>>,
       R"doc(Get the content of a MediaPipe string vector Packet as a str list.
@@ -418,6 +500,35 @@ void PublicPacketGetters(pybind11::module* m) {
     data = mp.packet_getter.get_matrix(packet)
 )doc",
       py::return_value_policy::reference_internal);
+
+  m->def(
+      "get_tensor_view",
+      [](const Packet& packet) {
+        const Tensor& tensor = GetContent<Tensor>(packet);
+        const std::vector<py::ssize_t> shape(tensor.shape().dims.begin(),
+                                             tensor.shape().dims.end());
+        const py::dtype dtype = TensorDtype(tensor.element_type());
+        // The read view makes the CPU storage valid, reading the tensor back
+        // from the GPU if needed. The view is released right away as it holds
+        // the tensor's lock. The storage stays valid as long as the packet
+        // lives, since the content of a packet isn't written to anymore.
+        const void* data = tensor.GetCpuReadView().buffer<void>();
+        return MakeReadOnlyArray(dtype, shape, data, new Packet(packet));
+      },
+      R"doc(Get the content of a MediaPipe Tensor Packet as a numpy view.
+
+  The data isn't copied. The returned read-only numpy ndarray refers to the CPU
+  storage of the tensor and keeps the packet alive.
+
+  Args:
+    packet: A MediaPipe Tensor Packet.
+
+  Returns:
+    A read-only numpy ndarray with the shape and element type of the tensor.
+
+  Raises:
+    ValueError: If the Packet doesn't contain Tensor.
+)doc");
 }
 
 void InternalPacketGetters(pybind11::module* m) {
@@ -21,10 +21,12 @@ users can easily create new MediaPipe Solution APIs on top of the SolutionBase
 class.
 """
 
+import asyncio
 import collections
 import enum
 import os
-from typing import Any, Iterable, List, Mapping, NamedTuple, Optional, Union
+from typing import (Any, AsyncIterator, Iterable, Iterator, List, Mapping,
+                    NamedTuple, Optional, Union)
 
 import numpy as np
 
@@ -221,7 +223,8 @@ class SolutionBase:
       graph_options: Optional[message.Message] = None,
       side_inputs: Optional[Mapping[str, Any]] = None,
       outputs: Optional[List[str]] = None,
-      stream_type_hints: Optional[Mapping[str, PacketDataType]] = None):
+      stream_type_hints: Optional[Mapping[str, PacketDataType]] = None,
+      streaming: bool = False):
     """Initializes the SolutionBase object.
 
     Args:
@@ -236,6 +239,9 @@ class SolutionBase:
         is empty, all the output streams listed in the graph config will be
         automatically observed by default.
       stream_type_hints: A mapping from the stream name to its packet type hint.
+      streaming: If true, the outputs are read from output stream pollers
+        instead of per-packet callbacks, which don't take the GIL in the graph
+        threads, and the inputs can be pipelined with submit() and results().
 
     Raises:
       FileNotFoundError: If the binary graph file can't be found.
@@ -279,12 +285,22 @@ class SolutionBase:
         graph_config=canonical_graph_config_proto)
     self._simulated_timestamp = 0
     self._graph_outputs = {}
+    self._streaming = streaming
+    # The timestamps of the submitted inputs whose outputs aren't read yet.
+    self._pending_timestamps = collections.deque()
+    self._output_stream_pollers = {}
+    # The packets read ahead of the pending timestamps, by stream name.
+    self._next_packets = {}
 
     def callback(stream_name: str, output_packet: packet.Packet) -> None:
       self._graph_outputs[stream_name] = output_packet
 
     for stream_name in self._output_stream_type_info.keys():
-      self._graph.observe_output_stream(stream_name, callback, True)
+      if streaming:
+        self._output_stream_pollers[stream_name] = (
+            self._graph.add_output_stream_poller(stream_name, True))
+      else:
+        self._graph.observe_output_stream(stream_name, callback, True)
 
     self._input_side_packets = {
         name: self._make_packet(self._side_input_type_info[name], data)
@@ -309,7 +325,8 @@ class SolutionBase:
     Raises:
       NotImplementedError: If input_data contains audio data or a list of proto
         objects.
-      RuntimeError: If the underlying graph occurs any error.
+      RuntimeError: If the underlying graph occurs any error, or if the outputs
+        of submitted inputs are still pending.
       ValueError: If the input image data is not three channel RGB.
 
     Returns:
@@ -325,8 +342,94 @@ class SolutionBase:
           {'video_in' : cv2.imread('/tmp/hand1.png')[:, :, ::-1]})
       print(results.hand_landmarks)
     """
+    if self._streaming:
+      if self._pending_timestamps:
+        raise RuntimeError(
+            'process() can\'t be called while the outputs of submitted inputs '
+            'are pending.')
+      self.submit(input_data)
+      return self._next_result()
+
     self._graph_outputs.clear()
+    self._add_inputs(input_data)
+    self._graph.wait_until_idle()
+    return self._make_solution_outputs(self._graph_outputs)
+
+  def submit(
+      self, input_data: Union[np.ndarray, Mapping[str, Union[np.ndarray,
+                                                             message.Message]]]
+  ) -> int:
+    """Sends a set of input data to the graph without waiting for the outputs.
+
+    Only available if the solution is created with streaming=True. The outputs
+    are read in the submission order from results() or results_async(), so that
+    the graph can process several inputs at once.
+
+    Args:
+      input_data: Either a single numpy ndarray object representing the solo
+        image input of a graph or a mapping from the stream name to the image or
+        proto data that represents every input streams of a graph.
+
+    Raises:
+      NotImplementedError: If input_data contains audio data or a list of proto
+        objects.
+      RuntimeError: If the solution isn't streaming or the underlying graph
+        occurs any error.
+      ValueError: If the input image data is not three channel RGB.
+
+    Returns:
+      The timestamp of the inputs in microseconds.
 
+    Examples:
+      solution = solution_base.SolutionBase(
+          graph_config=hand_landmark_graph, streaming=True)
+      for frame in frames:
+        solution.submit(frame)
+      for results in solution.results():
+        print(results.hand_landmarks)
+    """
+    if not self._streaming:
+      raise RuntimeError('submit() requires a streaming solution.')
+    timestamp = self._add_inputs(input_data)
+    self._pending_timestamps.append(timestamp)
+    return timestamp
+
+  def results(self) -> Iterator[NamedTuple]:
+    """Yields the outputs of the submitted inputs in the submission order.
+
+    Blocks until the outputs of each input are available, without holding the
+    GIL, and stops once the outputs of all the submitted inputs are read.
+
+    Yields:
+      A NamedTuple object that contains the output data of a graph run, as
+      returned by process().
+    """
+    while self._pending_timestamps:
+      yield self._next_result()
+
+  async def results_async(self) -> AsyncIterator[NamedTuple]:
+    """Asynchronously yields the outputs of the submitted inputs in order.
+
+    Like results(), but waits for the outputs in the default executor of the
+    running event loop.
+
+    Yields:
+      A NamedTuple object that contains the output data of a graph run, as
+      returned by process().
+    """
+    loop = asyncio.get_running_loop()
+    while self._pending_timestamps:
+      yield await loop.run_in_executor(None, self._next_result)
+
+  def _add_inputs(
+      self, input_data: Union[np.ndarray, Mapping[str, Union[np.ndarray,
+                                                             message.Message]]]
+  ) -> int:
+    """Adds a set of input data to the graph input streams.
+
+    Returns:
+      The timestamp of the inputs in microseconds.
+    """
     if isinstance(input_data, np.ndarray):
       if len(self._input_stream_type_info.keys()) != 1:
         raise ValueError(
@@ -361,18 +464,40 @@ class SolutionBase:
             stream=stream_name,
             packet=self._make_packet(input_stream_type,
                                      data).at(self._simulated_timestamp))
+    return self._simulated_timestamp
+
+  def _next_result(self) -> NamedTuple:
+    """Reads the outputs of the oldest pending inputs from the pollers."""
+    timestamp = self._pending_timestamps.popleft()
+    output_packets = {}
+    for stream_name, poller in self._output_stream_pollers.items():
+      output_packet = self._next_packets.pop(stream_name, None)
+      if output_packet is None:
+        output_packet = poller.next()
+      # With timestamp bounds observed, every stream emits either a packet or
+      # an empty packet at each timestamp or past it.
+      while output_packet is not None and output_packet.timestamp < timestamp:
+        output_packet = poller.next()
+      if output_packet is None:
+        continue
+      if output_packet.timestamp == timestamp:
+        output_packets[stream_name] = output_packet
+      else:
+        self._next_packets[stream_name] = output_packet
+    return self._make_solution_outputs(output_packets)
 
-    self._graph.wait_until_idle()
+  def _make_solution_outputs(
+      self, output_packets: Mapping[str, packet.Packet]) -> NamedTuple:
     # Create a NamedTuple object where the field names are mapping to the graph
     # output stream names.
     solution_outputs = collections.namedtuple(
         'SolutionOutputs', self._output_stream_type_info.keys())
     for stream_name in self._output_stream_type_info.keys():
-      if stream_name in self._graph_outputs:
+      if stream_name in output_packets:
         setattr(
             solution_outputs, stream_name,
             self._get_packet_content(self._output_stream_type_info[stream_name],
-                                     self._graph_outputs[stream_name]))
+                                     output_packets[stream_name]))
       else:
         setattr(solution_outputs, stream_name, None)
 
@@ -389,6 +514,8 @@ class SolutionBase:
     """Resets the graph for another run."""
     if self._graph:
       self._graph.close()
+      self._pending_timestamps.clear()
+      self._next_packets.clear()
       self._graph.start_run(self._input_side_packets)
 
   def _initialize_graph_interface(
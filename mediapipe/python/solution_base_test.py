@@ -14,6 +14,8 @@
 
 """Tests for mediapipe.python.solution_base."""
 
+import asyncio
+
 from absl.testing import absltest
 from absl.testing import parameterized
 import numpy as np
@@ -377,6 +379,41 @@ class SolutionBaseTest(parameterized.TestCase):
         outputs = solution2.process(input_image)
         self.assertTrue(np.array_equal(input_image, outputs.image_type_out))
 
+  def test_solution_streaming(self):
+    text_config = """
+      input_stream: 'image_in'
+      output_stream: 'image_out'
+      node {
+        calculator: 'ImageTransformationCalculator'
+        input_stream: 'IMAGE:image_in'
+        output_stream: 'IMAGE:image_out'
+      }
+    """
+    config_proto = text_format.Parse(text_config,
+                                     calculator_pb2.CalculatorGraphConfig())
+    input_images = [np.full((3, 3, 3), i, dtype=np.uint8) for i in range(10)]
+    with solution_base.SolutionBase(
+        graph_config=config_proto, streaming=True) as solution:
+      outputs = solution.process(input_images[0])
+      self.assertTrue(np.array_equal(input_images[0], outputs.image_out))
+      for input_image in input_images:
+        solution.submit(input_image)
+      results = list(solution.results())
+      self.assertLen(results, len(input_images))
+      for input_image, outputs in zip(input_images, results):
+        self.assertTrue(np.array_equal(input_image, outputs.image_out))
+
+      for input_image in input_images:
+        solution.submit(input_image)
+
+      async def read_results():
+        return [outputs async for outputs in solution.results_async()]
+
+      results = asyncio.run(read_results())
+      self.assertLen(results, len(input_images))
+      for input_image, outputs in zip(input_images, results):
+        self.assertTrue(np.array_equal(input_image, outputs.image_out))
+
   def _process_and_verify(self,
                           config_proto,
                           side_inputs=None,
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/tasks/cc/audio/core/audio_clip.h"
 #include "mediapipe/tasks/cc/audio/core/base_audio_task_api.h"
 #include "mediapipe/tasks/cc/audio/core/running_mode.h"
 #include "mediapipe/tasks/cc/components/containers/classification_result.h"
@@ -48,12 +49,14 @@ struct AudioClassifierOptions {
   components::processors::ClassifierOptions classifier_options;
 
   // The running mode of the audio classifier. Default to the audio clips mode.
-  // Audio classifier has two running modes:
+  // Audio classifier has three running modes:
   // 1) The audio clips mode for running classification on independent audio
   //    clips.
   // 2) The audio stream mode for running classification on the audio stream,
   //    such as from microphone. In this mode, the "result_callback" below must
   //    be specified to receive the classification results asynchronously.
+  // 3) The audio clip batches mode for running classification on many
+  //    independent audio clips at once.
   core::RunningMode running_mode = core::RunningMode::AUDIO_CLIPS;
 
   // The user-defined result callback for processing audio stream data.
@@ -73,7 +76,9 @@ struct AudioClassifierOptions {
 // Input tensor:
 //   (kTfLiteFloat32)
 //    - input audio buffer of size `[batch * samples]`.
-//    - batch inference is not supported (`batch` is required to be 1).
+//    - `batch` is required to be 1, unless `base_options.inference_batch_size`
+//      is set in the audio clip batches mode, in which case the input must
+//      have the shape `[1 x samples]` and support resizing `batch`.
 //    - for multi-channel models, the channels need be interleaved.
 // At least one output tensor with:
 //   (kTfLiteFloat32)
@@ -92,6 +97,10 @@ class AudioClassifier : tasks::audio::core::BaseAudioTaskApi {
  public:
   using BaseAudioTaskApi::BaseAudioTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates an AudioClassifier to process either audio clips (e.g., audio
   // files) or audio stream data (e.g., microphone live input). Audio classifier
   // can be created with one of following two running modes:
@@ -148,6 +157,18 @@ class AudioClassifier : tasks::audio::core::BaseAudioTaskApi {
   absl::StatusOr<std::vector<AudioClassifierResult>> Classify(
       mediapipe::Matrix audio_clip, double audio_sample_rate);
 
+  // Performs audio classification on a batch of independent audio clips, e.g.
+  // for indexing many audio files. Only use this method when the
+  // AudioClassifier is created with the audio clip batches running mode.
+  //
+  // The clips are pipelined through the classifier: a clip is resampled and
+  // framed while the model runs on the previous ones. If
+  // `base_options.inference_batch_size` is greater than 1, the model runs on
+  // that many chunks at once, taken from any of the clips. Returns the results
+  // of each clip in input order, in the same form as `Classify`.
+  absl::StatusOr<std::vector<std::vector<AudioClassifierResult>>>
+  ClassifyClips(std::vector<core::AudioClip> audio_clips);
+
   // Sends audio data (a block in a continuous audio stream) to perform audio
   // classification. Only use this method when the AudioClassifier is created
   // with the audio stream running mode.
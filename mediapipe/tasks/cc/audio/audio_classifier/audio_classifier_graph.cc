@@ -20,10 +20,13 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/types/optional.h"
 #include "flatbuffers/flatbuffers.h"
 #include "mediapipe/calculators/core/constant_side_packet_calculator.pb.h"
+#include "mediapipe/calculators/core/split_vector_calculator.pb.h"
 #include "mediapipe/calculators/tensor/audio_to_tensor_calculator.pb.h"
+#include "mediapipe/calculators/tensor/feedback_tensors_calculator.pb.h"
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator.pb.h"
@@ -59,6 +62,11 @@ using ::mediapipe::tasks::components::containers::proto::ClassificationResult;
 constexpr char kAtPrestreamTag[] = "AT_PRESTREAM";
 constexpr char kAudioTag[] = "AUDIO";
 constexpr char kClassificationsTag[] = "CLASSIFICATIONS";
+constexpr char kFeedbackTensorsTag[] = "FEEDBACK_TENSORS";
+constexpr char kInputTensorsTag[] = "INPUT_TENSORS";
+constexpr char kLoopTag[] = "LOOP";
+constexpr char kMainTag[] = "MAIN";
+constexpr char kPrevLoopTag[] = "PREV_LOOP";
 constexpr char kTimestampedClassificationsTag[] = "TIMESTAMPED_CLASSIFICATIONS";
 constexpr char kPacketTag[] = "PACKET";
 constexpr char kSampleRateTag[] = "SAMPLE_RATE";
@@ -73,8 +81,10 @@ struct AudioClassifierOutputStreams {
 };
 
 // Builds an AudioTensorSpecs for configuring the preprocessing calculators.
+// The audio is the first model input, followed by `num_state_tensors` state
+// inputs for streaming models.
 absl::StatusOr<AudioTensorSpecs> BuildPreprocessingSpecs(
-    const core::ModelResources& model_resources) {
+    const core::ModelResources& model_resources, int num_state_tensors) {
   const tflite::Model& model = *model_resources.GetTfLiteModel();
   if (model.subgraphs()->size() != 1) {
     return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument,
@@ -83,11 +93,13 @@ absl::StatusOr<AudioTensorSpecs> BuildPreprocessingSpecs(
                                    MediaPipeTasksStatus::kInvalidArgumentError);
   }
   const auto* primary_subgraph = (*model.subgraphs())[0];
-  if (primary_subgraph->inputs()->size() != 1) {
-    return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument,
-                                   "Audio classification tflite models are "
-                                   "assumed to have a single input.",
-                                   MediaPipeTasksStatus::kInvalidArgumentError);
+  if (primary_subgraph->inputs()->size() != 1 + num_state_tensors) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrFormat("Audio classification tflite models are assumed to "
+                        "have a single audio input and %d state inputs.",
+                        num_state_tensors),
+        MediaPipeTasksStatus::kInvalidArgumentError);
   }
   const auto* input_tensor =
       (*primary_subgraph->tensors())[(*primary_subgraph->inputs())[0]];
@@ -97,6 +109,39 @@ absl::StatusOr<AudioTensorSpecs> BuildPreprocessingSpecs(
   return BuildInputAudioTensorSpecs(*input_tensor, audio_tensor_metadata);
 }
 
+// Returns the shape shared by the state inputs of a streaming model, which
+// seeds the state with zeros before the first hop.
+absl::StatusOr<std::vector<int>> GetStateTensorShape(
+    const core::ModelResources& model_resources, int num_state_tensors) {
+  const auto* primary_subgraph =
+      (*model_resources.GetTfLiteModel()->subgraphs())[0];
+  std::vector<int> shape;
+  for (int i = 1; i <= num_state_tensors; ++i) {
+    const auto* state_tensor =
+        (*primary_subgraph->tensors())[(*primary_subgraph->inputs())[i]];
+    if (state_tensor->type() != tflite::TensorType_FLOAT32) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          absl::StrFormat("Expected state input %d to have type FLOAT32, "
+                          "found %s instead.",
+                          i, tflite::EnumNameTensorType(state_tensor->type())),
+          MediaPipeTasksStatus::kInvalidInputTensorTypeError);
+    }
+    std::vector<int> dims(state_tensor->shape()->begin(),
+                          state_tensor->shape()->end());
+    if (i == 1) {
+      shape = std::move(dims);
+    } else if (dims != shape) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "All the state inputs of a streaming model must have the same "
+          "shape.",
+          MediaPipeTasksStatus::kInvalidInputTensorDimensionsError);
+    }
+  }
+  return shape;
+}
+
 // Fills in the AudioToTensorCalculatorOptions based on the AudioTensorSpecs.
 void ConfigureAudioToTensorCalculator(
     const AudioTensorSpecs& audio_tensor_specs, bool use_stream_mode,
@@ -189,6 +234,13 @@ class AudioClassifierGraph : public core::ModelTaskGraph {
       const core::ModelResources& model_resources, Source<Matrix> audio_in,
       absl::optional<Source<double>> sample_rate_in, Graph& graph) {
     const bool use_stream_mode = task_options.base_options().use_stream_mode();
+    const int num_state_tensors = task_options.num_streaming_state_tensors();
+    if (num_state_tensors > 0 && !use_stream_mode) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "Streaming models with state tensors require the stream mode.",
+          MediaPipeTasksStatus::kInvalidArgumentError);
+    }
     const auto* metadata_extractor = model_resources.GetMetadataExtractor();
     // Checks that metadata is available.
     if (metadata_extractor->GetModelMetadata() == nullptr ||
@@ -203,7 +255,8 @@ class AudioClassifierGraph : public core::ModelTaskGraph {
 
     // Adds AudioToTensorCalculator and connects it to the graph input streams.
     ASSIGN_OR_RETURN(auto audio_tensor_specs,
-                     BuildPreprocessingSpecs(model_resources));
+                     BuildPreprocessingSpecs(model_resources,
+                                             num_state_tensors));
     auto& audio_to_tensor = graph.AddNode("AudioToTensorCalculator");
     ConfigureAudioToTensorCalculator(
         audio_tensor_specs, use_stream_mode,
@@ -227,13 +280,9 @@ class AudioClassifierGraph : public core::ModelTaskGraph {
           audio_to_tensor.In(kSampleRateTag);
     }
 
-    // Adds inference subgraph and connects its input stream to the output
-    // tensors produced by the AudioToTensorCalculator.
+    // Adds inference subgraph and postprocessing calculators.
     auto& inference = AddInference(
-        model_resources, task_options.base_options().acceleration(), graph);
-    audio_to_tensor.Out(kTensorsTag) >> inference.In(kTensorsTag);
-
-    // Adds postprocessing calculators and connects them to the graph output.
+        model_resources, task_options.base_options(), graph);
     auto& postprocessing = graph.AddNode(
         "mediapipe.tasks.components.processors."
         "ClassificationPostprocessingGraph");
@@ -242,8 +291,50 @@ class AudioClassifierGraph : public core::ModelTaskGraph {
             model_resources, task_options.classifier_options(),
             &postprocessing
                  .GetOptions<components::processors::proto::
-                                 ClassificationPostprocessingGraphOptions>()));
-    inference.Out(kTensorsTag) >> postprocessing.In(kTensorsTag);
+                                 ClassificationPostprocessingGraphOptions>(),
+            num_state_tensors));
+
+    if (num_state_tensors == 0) {
+      audio_to_tensor.Out(kTensorsTag) >> inference.In(kTensorsTag);
+      inference.Out(kTensorsTag) >> postprocessing.In(kTensorsTag);
+    } else {
+      // Streaming models only see each hop of audio once: the AudioToTensor
+      // frames don't overlap, and the state output for the previous frame is
+      // appended to the audio tensor of the next one instead.
+      ASSIGN_OR_RETURN(auto state_shape,
+                       GetStateTensorShape(model_resources, num_state_tensors));
+      auto& previous_state = graph.AddNode("PreviousLoopbackCalculator");
+      auto& feedback = graph.AddNode("FeedbackTensorsCalculator");
+      auto& feedback_options =
+          feedback.GetOptions<FeedbackTensorsCalculatorOptions>();
+      feedback_options.set_num_feedback_tensors(num_state_tensors);
+      feedback_options.set_location(FeedbackTensorsCalculatorOptions::APPENDED);
+      for (int dim : state_shape) {
+        feedback_options.mutable_feedback_tensor_shape()->add_dims(dim);
+      }
+      audio_to_tensor.Out(kTensorsTag) >> previous_state.In(kMainTag);
+      audio_to_tensor.Out(kTensorsTag) >> feedback.In(kInputTensorsTag);
+      previous_state.Out(kPrevLoopTag) >> feedback.In(kFeedbackTensorsTag);
+      feedback.Out(kTensorsTag) >> inference.In(kTensorsTag);
+
+      // Splits the state outputs from the classification heads and loops them
+      // back.
+      const int num_model_outputs =
+          (*model_resources.GetTfLiteModel()->subgraphs())[0]
+              ->outputs()
+              ->size();
+      auto& split = graph.AddNode("SplitTensorVectorCalculator");
+      auto& split_options = split.GetOptions<SplitVectorCalculatorOptions>();
+      auto* heads_range = split_options.add_ranges();
+      heads_range->set_begin(0);
+      heads_range->set_end(num_model_outputs - num_state_tensors);
+      auto* state_range = split_options.add_ranges();
+      state_range->set_begin(num_model_outputs - num_state_tensors);
+      state_range->set_end(num_model_outputs);
+      inference.Out(kTensorsTag) >> split.In(0);
+      split.Out(0) >> postprocessing.In(kTensorsTag);
+      split.Out(1) >> previous_state.In(kLoopTag).AsBackEdge();
+    }
 
     // Time aggregation is only needed for performing audio classification on
     // audio files. Disables timestamp aggregation by not connecting the
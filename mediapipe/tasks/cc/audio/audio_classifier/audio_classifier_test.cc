@@ -466,6 +466,66 @@ TEST_F(ClassifyTest, SucceedsWithCategoryDenylist) {
   }
 }
 
+class ClassifyClipsTest : public tflite_shims::testing::Test {};
+
+TEST_F(ClassifyClipsTest, Succeeds) {
+  auto options = std::make_unique<AudioClassifierOptions>();
+  options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kModelWithMetadata);
+  options->running_mode = core::RunningMode::AUDIO_CLIP_BATCHES;
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AudioClassifier> audio_classifier,
+                          AudioClassifier::Create(std::move(options)));
+  std::vector<core::AudioClip> clips;
+  clips.push_back({GetAudioData(k16kTestWavFilename), 16000});
+  clips.push_back({GetAudioData(k48kTestWavFilename), 48000});
+  clips.push_back({GetAudioData(k16kTestWavFilename), 16000});
+  MP_ASSERT_OK_AND_ASSIGN(auto results,
+                          audio_classifier->ClassifyClips(std::move(clips)));
+  ASSERT_EQ(results.size(), 3);
+  for (const auto& result : results) {
+    CheckSpeechResult(result);
+  }
+  // The timestamps of a batch follow those of the previous one.
+  clips.clear();
+  clips.push_back({GetAudioData(k48kTestWavFilename), 48000});
+  MP_ASSERT_OK_AND_ASSIGN(results,
+                          audio_classifier->ClassifyClips(std::move(clips)));
+  ASSERT_EQ(results.size(), 1);
+  CheckSpeechResult(results[0]);
+  MP_ASSERT_OK(audio_classifier->Close());
+}
+
+TEST_F(ClassifyClipsTest, FailsWithEmptyClip) {
+  auto options = std::make_unique<AudioClassifierOptions>();
+  options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kModelWithMetadata);
+  options->running_mode = core::RunningMode::AUDIO_CLIP_BATCHES;
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AudioClassifier> audio_classifier,
+                          AudioClassifier::Create(std::move(options)));
+  std::vector<core::AudioClip> clips;
+  clips.push_back({GetAudioData(k16kTestWavFilename), 16000});
+  clips.push_back({Matrix(1, 0), 16000});
+  auto results = audio_classifier->ClassifyClips(std::move(clips));
+  EXPECT_EQ(results.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(results.status().message(), HasSubstr("Audio clip 1 is empty"));
+  MP_ASSERT_OK(audio_classifier->Close());
+}
+
+TEST_F(ClassifyClipsTest, FailsInAudioClipsMode) {
+  auto options = std::make_unique<AudioClassifierOptions>();
+  options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kModelWithMetadata);
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AudioClassifier> audio_classifier,
+                          AudioClassifier::Create(std::move(options)));
+  std::vector<core::AudioClip> clips;
+  clips.push_back({GetAudioData(k16kTestWavFilename), 16000});
+  auto results = audio_classifier->ClassifyClips(std::move(clips));
+  EXPECT_EQ(results.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(results.status().message(),
+              HasSubstr("not initialized with the audio clip batches mode"));
+  MP_ASSERT_OK(audio_classifier->Close());
+}
+
 class ClassifyAsyncTest : public tflite_shims::testing::Test {};
 
 TEST_F(ClassifyAsyncTest, Succeeds) {
@@ -137,6 +137,21 @@ absl::StatusOr<std::vector<AudioEmbedderResult>> AudioEmbedder::Embed(
        {kSampleRateName, MakePacket<double>(audio_sample_rate)}}));
 }
 
+absl::StatusOr<std::vector<std::vector<AudioEmbedderResult>>>
+AudioEmbedder::EmbedClips(std::vector<core::AudioClip> audio_clips) {
+  ASSIGN_OR_RETURN(auto clip_outputs,
+                   ProcessAudioClips(std::move(audio_clips), kAudioStreamName,
+                                     kSampleRateName));
+  std::vector<std::vector<AudioEmbedderResult>> results;
+  results.reserve(clip_outputs.size());
+  for (auto& outputs : clip_outputs) {
+    ASSIGN_OR_RETURN(auto clip_results,
+                     ConvertOutputPackets(std::move(outputs)));
+    results.push_back(std::move(clip_results));
+  }
+  return results;
+}
+
 absl::Status AudioEmbedder::EmbedAsync(Matrix audio_block,
                                        double audio_sample_rate,
                                        int64 timestamp_ms) {
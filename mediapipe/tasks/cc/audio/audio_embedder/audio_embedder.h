@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/tasks/cc/audio/core/audio_clip.h"
 #include "mediapipe/tasks/cc/audio/core/base_audio_task_api.h"
 #include "mediapipe/tasks/cc/audio/core/running_mode.h"
 #include "mediapipe/tasks/cc/components/containers/embedding_result.h"
@@ -44,11 +45,13 @@ struct AudioEmbedderOptions {
   components::processors::EmbedderOptions embedder_options;
 
   // The running mode of the audio embedder. Default to the audio clips mode.
-  // Audio embedder has two running modes:
+  // Audio embedder has three running modes:
   // 1) The audio clips mode for running embedding on independent audio clips.
   // 2) The audio stream mode for running embedding on the audio stream,
   //    such as from microphone. In this mode, the "result_callback" below must
   //    be specified to receive the embedding results asynchronously.
+  // 3) The audio clip batches mode for running embedding on many independent
+  //    audio clips at once.
   core::RunningMode running_mode = core::RunningMode::AUDIO_CLIPS;
 
   // The user-defined result callback for processing audio stream data.
@@ -68,7 +71,9 @@ struct AudioEmbedderOptions {
 // Input tensor:
 //   (kTfLiteFloat32)
 //    - input audio buffer of size `[batch * samples]`.
-//    - batch inference is not supported (`batch` is required to be 1).
+//    - `batch` is required to be 1, unless `base_options.inference_batch_size`
+//      is set in the audio clip batches mode, in which case the input must
+//      have the shape `[1 x samples]` and support resizing `batch`.
 //    - for multi-channel models, the channels need be interleaved.
 // At least one output tensor with:
 //   (kTfLiteUInt8/kTfLiteFloat32)
@@ -79,6 +84,10 @@ class AudioEmbedder : core::BaseAudioTaskApi {
  public:
   using BaseAudioTaskApi::BaseAudioTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates an AudioEmbedder from the provided options. A non-default
   // OpResolver can be specified in the BaseOptions in order to support custom
   // Ops or specify a subset of built-in Ops.
@@ -103,6 +112,18 @@ class AudioEmbedder : core::BaseAudioTaskApi {
   absl::StatusOr<std::vector<AudioEmbedderResult>> Embed(
       Matrix audio_clip, double audio_sample_rate);
 
+  // Performs embedding extraction on a batch of independent audio clips, e.g.
+  // for indexing many audio files. Only use this method when the AudioEmbedder
+  // is created with the audio clip batches running mode.
+  //
+  // The clips are pipelined through the embedder: a clip is resampled and
+  // framed while the model runs on the previous ones. If
+  // `base_options.inference_batch_size` is greater than 1, the model runs on
+  // that many chunks at once, taken from any of the clips. Returns the results
+  // of each clip in input order, in the same form as `Embed`.
+  absl::StatusOr<std::vector<std::vector<AudioEmbedderResult>>> EmbedClips(
+      std::vector<core::AudioClip> audio_clips);
+
   // Sends audio stream data to embedder, and the results will be available via
   // the "result_callback" provided in the AudioEmbedderOptions. Only use this
   // method when the AudioEmbedder is created with the audio stream running
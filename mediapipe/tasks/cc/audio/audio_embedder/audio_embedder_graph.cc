@@ -192,7 +192,7 @@ class AudioEmbedderGraph : public core::ModelTaskGraph {
     // Adds inference subgraph and connects its input stream to the output
     // tensors produced by the AudioToTensorCalculator.
     auto& inference = AddInference(
-        model_resources, task_options.base_options().acceleration(), graph);
+        model_resources, task_options.base_options(), graph);
     audio_to_tensor.Out(kTensorsTag) >> inference.In(kTensorsTag);
     // Adds postprocessing calculators and connects its input stream to the
     // inference results.
@@ -199,6 +199,65 @@ TEST_F(EmbedTest, SucceedsWithDifferentAudios) {
   MP_EXPECT_OK(audio_embedder->Close());
 }
 
+class EmbedClipsTest : public tflite_shims::testing::Test {};
+
+TEST_F(EmbedClipsTest, SucceedsWithSameResultsAsEmbed) {
+  auto options = std::make_unique<AudioEmbedderOptions>();
+  options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kModelWithMetadata);
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AudioEmbedder> audio_embedder,
+                          AudioEmbedder::Create(std::move(options)));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto expected1,
+      audio_embedder->Embed(GetAudioData(k16kTestWavFilename), 16000));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto expected2,
+      audio_embedder->Embed(GetAudioData(k48kTestWavFilename), 48000));
+  MP_EXPECT_OK(audio_embedder->Close());
+
+  options = std::make_unique<AudioEmbedderOptions>();
+  options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kModelWithMetadata);
+  options->running_mode = core::RunningMode::AUDIO_CLIP_BATCHES;
+  MP_ASSERT_OK_AND_ASSIGN(audio_embedder,
+                          AudioEmbedder::Create(std::move(options)));
+  std::vector<core::AudioClip> clips;
+  clips.push_back({GetAudioData(k16kTestWavFilename), 16000});
+  clips.push_back({GetAudioData(k48kTestWavFilename), 48000});
+  MP_ASSERT_OK_AND_ASSIGN(auto results,
+                          audio_embedder->EmbedClips(std::move(clips)));
+  ASSERT_EQ(results.size(), 2);
+  for (const auto& [result, expected] :
+       {std::make_pair(results[0], expected1),
+        std::make_pair(results[1], expected2)}) {
+    ASSERT_EQ(result.size(), expected.size());
+    for (int i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(result[i].timestamp_ms, expected[i].timestamp_ms);
+      MP_ASSERT_OK_AND_ASSIGN(double similarity,
+                              AudioEmbedder::CosineSimilarity(
+                                  result[i].embeddings[0],
+                                  expected[i].embeddings[0]));
+      EXPECT_NEAR(similarity, 1.0, 1e-6);
+    }
+  }
+  MP_EXPECT_OK(audio_embedder->Close());
+}
+
+TEST_F(EmbedClipsTest, FailsWithIllegalCallback) {
+  auto options = std::make_unique<AudioEmbedderOptions>();
+  options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kModelWithMetadata);
+  options->running_mode = core::RunningMode::AUDIO_CLIP_BATCHES;
+  options->result_callback = [](absl::StatusOr<AudioEmbedderResult>) {};
+  auto audio_embedder = AudioEmbedder::Create(std::move(options));
+  EXPECT_EQ(audio_embedder.status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(audio_embedder.status().message(),
+              HasSubstr("The audio task is in audio clip batches mode, a "
+                        "user-defined result callback shouldn't be "
+                        "provided."));
+}
+
 class EmbedAsyncTest : public tflite_shims::testing::Test {
  protected:
   void RunAudioEmbedderInStreamMode(std::string audio_file_name,
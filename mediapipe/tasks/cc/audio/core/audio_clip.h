@@ -0,0 +1,41 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_AUDIO_CORE_AUDIO_CLIP_H_
+#define MEDIAPIPE_TASKS_CC_AUDIO_CORE_AUDIO_CLIP_H_
+
+#include "mediapipe/framework/formats/matrix.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace audio {
+namespace core {
+
+// An independent audio clip, e.g. the contents of an audio file.
+struct AudioClip {
+  // The audio data, with the number of channels rows and the number of
+  // samples per channel columns.
+  Matrix audio;
+
+  // The sample rate of the audio data.
+  double sample_rate = 0;
+};
+
+}  // namespace core
+}  // namespace audio
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_AUDIO_CORE_AUDIO_CLIP_H_
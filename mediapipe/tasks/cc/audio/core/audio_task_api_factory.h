@@ -50,6 +50,8 @@ class AudioTaskApiFactory {
       std::unique_ptr<tflite::OpResolver> resolver, RunningMode running_mode,
       tasks::core::PacketsCallback packets_callback = nullptr) {
     bool found_task_subgraph = false;
+    bool load_model_asynchronously = false;
+    bool enable_profiler = false;
     for (const auto& node : graph_config.node()) {
       if (node.calculator() == "FlowLimiterCalculator") {
         continue;
@@ -68,8 +70,19 @@ class AudioTaskApiFactory {
               MediaPipeTasksStatus::kInvalidTaskGraphConfigError);
         }
         found_task_subgraph = true;
+        load_model_asynchronously = node.options()
+                                        .GetExtension(Options::ext)
+                                        .base_options()
+                                        .load_model_asynchronously();
+        enable_profiler = node.options()
+                              .GetExtension(Options::ext)
+                              .base_options()
+                              .enable_profiler();
       }
     }
+    if (enable_profiler) {
+      graph_config.mutable_profiler_config()->set_enable_profiler(true);
+    }
     if (running_mode == RunningMode::AUDIO_STREAM) {
       if (packets_callback == nullptr) {
         return CreateStatusWithPayload(
@@ -81,15 +94,28 @@ class AudioTaskApiFactory {
     } else if (packets_callback) {
       return CreateStatusWithPayload(
           absl::StatusCode::kInvalidArgument,
-          "The audio task is in audio clips mode, a user-defined result "
-          "callback shouldn't be provided.",
+          absl::StrCat("The audio task is in ",
+                       GetRunningModeName(running_mode),
+                       ", a user-defined result callback shouldn't be "
+                       "provided."),
           MediaPipeTasksStatus::kInvalidTaskGraphConfigError);
     }
+    std::shared_ptr<AudioClipBatchCollector> clip_batch_collector;
+    if (running_mode == RunningMode::AUDIO_CLIP_BATCHES) {
+      clip_batch_collector = std::make_shared<AudioClipBatchCollector>();
+      packets_callback =
+          [clip_batch_collector](
+              absl::StatusOr<tasks::core::PacketMap> status_or_packets) {
+            clip_batch_collector->OnOutputPackets(std::move(status_or_packets));
+          };
+    }
     ASSIGN_OR_RETURN(auto runner,
                      tasks::core::TaskRunner::Create(
                          std::move(graph_config), std::move(resolver),
-                         std::move(packets_callback)));
-    return std::make_unique<T>(std::move(runner), running_mode);
+                         std::move(packets_callback),
+                         load_model_asynchronously));
+    return std::make_unique<T>(std::move(runner), running_mode,
+                               std::move(clip_batch_collector));
   }
 };
 
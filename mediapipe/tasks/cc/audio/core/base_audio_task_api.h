@@ -16,13 +16,21 @@ limitations under the License.
 #ifndef MEDIAPIPE_TASKS_CC_AUDIO_CORE_BASE_AUDIO_TASK_API_H_
 #define MEDIAPIPE_TASKS_CC_AUDIO_CORE_BASE_AUDIO_TASK_API_H_
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/timestamp.h"
+#include "mediapipe/tasks/cc/audio/core/audio_clip.h"
 #include "mediapipe/tasks/cc/audio/core/running_mode.h"
 #include "mediapipe/tasks/cc/core/base_task_api.h"
 #include "mediapipe/tasks/cc/core/task_runner.h"
@@ -32,13 +40,65 @@ namespace tasks {
 namespace audio {
 namespace core {
 
+// Scatters the outputs of the task runner back to the audio clips of a batch
+// in the audio clip batches mode. Each clip is sent at a timestamp past the
+// end of the previous clip, so the outputs of a clip are those at or after
+// its timestamp and before the timestamp of the next one.
+class AudioClipBatchCollector {
+ public:
+  // Starts collecting the outputs of clips sent at `clip_timestamps`, in
+  // increasing order.
+  void Start(std::vector<Timestamp> clip_timestamps) {
+    absl::MutexLock lock(&mutex_);
+    outputs_.assign(clip_timestamps.size(), {});
+    clip_timestamps_ = std::move(clip_timestamps);
+    status_ = absl::OkStatus();
+  }
+
+  // The packets callback of the task runner.
+  void OnOutputPackets(absl::StatusOr<tasks::core::PacketMap> packets) {
+    absl::MutexLock lock(&mutex_);
+    if (!packets.ok()) {
+      status_.Update(packets.status());
+      return;
+    }
+    for (auto& [stream_name, packet] : *packets) {
+      // Settled timestamp bounds come as empty packets.
+      if (packet.IsEmpty()) continue;
+      auto it = std::upper_bound(clip_timestamps_.begin(),
+                                 clip_timestamps_.end(), packet.Timestamp());
+      if (it == clip_timestamps_.begin()) continue;
+      outputs_[std::distance(clip_timestamps_.begin(), it) - 1][stream_name] =
+          std::move(packet);
+    }
+  }
+
+  // Returns the outputs of each clip, or the first error of the graph.
+  absl::StatusOr<std::vector<tasks::core::PacketMap>> Finish() {
+    absl::MutexLock lock(&mutex_);
+    clip_timestamps_.clear();
+    MP_RETURN_IF_ERROR(status_);
+    return std::move(outputs_);
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<Timestamp> clip_timestamps_ ABSL_GUARDED_BY(mutex_);
+  std::vector<tasks::core::PacketMap> outputs_ ABSL_GUARDED_BY(mutex_);
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+};
+
 // The base class of the user-facing mediapipe audio task api classes.
 class BaseAudioTaskApi : public tasks::core::BaseTaskApi {
  public:
-  // Constructor.
-  explicit BaseAudioTaskApi(std::unique_ptr<tasks::core::TaskRunner> runner,
-                            RunningMode running_mode)
-      : BaseTaskApi(std::move(runner)), running_mode_(running_mode) {}
+  // Constructor. In the audio clip batches mode, the runner must deliver its
+  // outputs to `clip_batch_collector`.
+  explicit BaseAudioTaskApi(
+      std::unique_ptr<tasks::core::TaskRunner> runner, RunningMode running_mode,
+      std::shared_ptr<AudioClipBatchCollector> clip_batch_collector = nullptr)
+      : BaseTaskApi(std::move(runner)),
+        running_mode_(running_mode),
+        clip_batch_collector_(std::move(clip_batch_collector)) {}
 
  protected:
   // A synchronous method to process independent audio clips.
@@ -58,6 +118,59 @@ class BaseAudioTaskApi : public tasks::core::BaseTaskApi {
     return runner_->Process(std::move(inputs));
   }
 
+  // A synchronous method to process a batch of independent audio clips, which
+  // are sent to `audio_stream_name` and `sample_rate_stream_name` without
+  // waiting for the previous clips to complete. The call blocks the current
+  // thread until the outputs of all the clips are returned in input order, or
+  // a failure status.
+  absl::StatusOr<std::vector<tasks::core::PacketMap>> ProcessAudioClips(
+      std::vector<AudioClip> clips, const std::string& audio_stream_name,
+      const std::string& sample_rate_stream_name) {
+    if (running_mode_ != RunningMode::AUDIO_CLIP_BATCHES) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          absl::StrCat("Task is not initialized with the audio clip batches "
+                       "mode. Current running mode:",
+                       GetRunningModeName(running_mode_)),
+          MediaPipeTasksStatus::kRunnerApiCalledInWrongModeError);
+    }
+    for (int i = 0; i < clips.size(); ++i) {
+      if (clips[i].audio.cols() == 0 || clips[i].sample_rate <= 0) {
+        return CreateStatusWithPayload(
+            absl::StatusCode::kInvalidArgument,
+            absl::StrCat("Audio clip ", i,
+                         " is empty or has an invalid sample rate."),
+            MediaPipeTasksStatus::kInvalidArgumentError);
+      }
+    }
+    absl::MutexLock lock(&clip_batch_mutex_);
+    // The outputs of a clip, e.g. one per model window, are at timestamps
+    // from the timestamp of the clip to its end, so the next clip is sent a
+    // second after that.
+    std::vector<Timestamp> clip_timestamps;
+    clip_timestamps.reserve(clips.size());
+    for (const AudioClip& clip : clips) {
+      clip_timestamps.push_back(next_clip_timestamp_);
+      const int64_t duration = std::ceil(clip.audio.cols() / clip.sample_rate *
+                                         Timestamp::kTimestampUnitsPerSecond);
+      next_clip_timestamp_ += duration + Timestamp::kTimestampUnitsPerSecond;
+    }
+    clip_batch_collector_->Start(clip_timestamps);
+    absl::Status status;
+    for (int i = 0; i < clips.size() && status.ok(); ++i) {
+      status = runner_->Send(
+          {{audio_stream_name, MakePacket<Matrix>(std::move(clips[i].audio))
+                                   .At(clip_timestamps[i])},
+           {sample_rate_stream_name,
+            MakePacket<double>(clips[i].sample_rate).At(clip_timestamps[i])}});
+    }
+    // Waits for the clips that were sent, even if a later one failed.
+    status.Update(runner_->WaitForPendingRequests());
+    auto outputs = clip_batch_collector_->Finish();
+    MP_RETURN_IF_ERROR(status);
+    return outputs;
+  }
+
   // An asynchronous method to send audio stream data to the runner. The results
   // will be available in the user-defined results callback.
   absl::Status SendAudioStreamData(tasks::core::PacketMap inputs) {
@@ -105,6 +218,11 @@ class BaseAudioTaskApi : public tasks::core::BaseTaskApi {
  private:
   RunningMode running_mode_;
   double default_sample_rate_ = -1.0;
+  std::shared_ptr<AudioClipBatchCollector> clip_batch_collector_;
+  // Batches of audio clips are processed one at a time.
+  absl::Mutex clip_batch_mutex_;
+  Timestamp next_clip_timestamp_ ABSL_GUARDED_BY(clip_batch_mutex_) =
+      Timestamp(0);
 };
 
 }  // namespace core
@@ -30,6 +30,12 @@ enum RunningMode {
 
   // Run the audio task on an audio stream, such as from microphone.
   AUDIO_STREAM = 2,
+
+  // Run the audio task on batches of independent audio clips, such as for
+  // indexing many audio files. The clips of a batch are pipelined through the
+  // task, so that the preprocessing of a clip overlaps with the inference of
+  // the previous ones, and the model windows of all clips can be batched.
+  AUDIO_CLIP_BATCHES = 3,
 };
 
 inline std::string GetRunningModeName(RunningMode mode) {
@@ -38,6 +44,8 @@ inline std::string GetRunningModeName(RunningMode mode) {
       return "audio clips mode";
     case AUDIO_STREAM:
       return "audio stream mode";
+    case AUDIO_CLIP_BATCHES:
+      return "audio clip batches mode";
     default:
       return "unknown mode";
   }
@@ -0,0 +1,800 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Measures the end-to-end latency of a MediaPipe Tasks C++ API in each of its
+// running modes, on the inputs of a directory, and reports the latency
+// percentiles, the throughput, the peak memory and the runtimes of the
+// calculators of the task graph.
+//
+// Example:
+//   task_benchmark --task=object_detector --model_path=/path/to/model.tflite \
+//     --input_dir=/path/to/images --running_modes=image,live_stream \
+//     --output_json=/tmp/object_detector.json
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/audio/audio_classifier/audio_classifier.h"
+#include "mediapipe/tasks/cc/core/base_options.h"
+#include "mediapipe/tasks/cc/text/text_classifier/text_classifier.h"
+#include "mediapipe/tasks/cc/vision/hand_landmarker/hand_landmarker.h"
+#include "mediapipe/tasks/cc/vision/image_segmenter/image_segmenter.h"
+#include "mediapipe/tasks/cc/vision/object_detector/object_detector.h"
+#include "mediapipe/tasks/cc/vision/utils/image_utils.h"
+
+ABSL_FLAG(std::string, task, "",
+          "The task to benchmark: object_detector, hand_landmarker, "
+          "image_segmenter, text_classifier or audio_classifier.");
+ABSL_FLAG(std::string, model_path, "", "Path to the model asset of the task.");
+ABSL_FLAG(std::string, delegate, "cpu",
+          "The delegate running the model: cpu or gpu.");
+ABSL_FLAG(std::string, input_dir, "",
+          "Directory of the inputs, which are cycled through: .jpg and .png "
+          "images for the vision tasks, .txt files for text_classifier and "
+          ".wav files (16-bit PCM or 32-bit float) for audio_classifier.");
+ABSL_FLAG(std::string, running_modes, "",
+          "Comma-separated running modes to benchmark: image, video and "
+          "live_stream for the vision tasks, audio_clips and audio_stream for "
+          "audio_classifier. Defaults to all the running modes of the task.");
+ABSL_FLAG(int, warmup_iterations, 10,
+          "Number of inputs processed before measuring, in each running mode.");
+ABSL_FLAG(int, iterations, 100,
+          "Number of inputs measured in each running mode.");
+ABSL_FLAG(bool, enable_profiler, true,
+          "Whether to report the runtimes of the calculators of the task "
+          "graph.");
+ABSL_FLAG(std::string, output_json, "",
+          "If set, the file the results are written to, in JSON.");
+
+namespace mediapipe {
+namespace tasks {
+namespace {
+
+using ::mediapipe::tasks::audio::audio_classifier::AudioClassifier;
+using ::mediapipe::tasks::audio::audio_classifier::AudioClassifierOptions;
+using ::mediapipe::tasks::audio::audio_classifier::AudioClassifierResult;
+using ::mediapipe::tasks::core::BaseOptions;
+using ::mediapipe::tasks::text::text_classifier::TextClassifier;
+using ::mediapipe::tasks::text::text_classifier::TextClassifierOptions;
+using ::mediapipe::tasks::vision::ObjectDetector;
+using ::mediapipe::tasks::vision::ObjectDetectorOptions;
+using ::mediapipe::tasks::vision::hand_landmarker::HandLandmarker;
+using ::mediapipe::tasks::vision::hand_landmarker::HandLandmarkerOptions;
+using ::mediapipe::tasks::vision::image_segmenter::ImageSegmenter;
+using ::mediapipe::tasks::vision::image_segmenter::ImageSegmenterOptions;
+
+// The interval between the timestamps of the frames of the video and live
+// stream running modes.
+constexpr int64_t kFrameIntervalMs = 33;
+// How long a warm-up input of a streaming running mode is waited for.
+constexpr absl::Duration kWarmupResultTimeout = absl::Seconds(1);
+// How long the results of the measured inputs of a streaming running mode are
+// waited for.
+constexpr absl::Duration kResultTimeout = absl::Seconds(30);
+
+// An audio clip read from a WAV file.
+struct AudioClip {
+  // The samples, with one row per channel.
+  Matrix samples;
+  double sample_rate = 0;
+};
+
+// The inputs of the benchmark, of which only those of the task are set.
+struct Inputs {
+  std::vector<Image> images;
+  std::vector<std::string> texts;
+  std::vector<AudioClip> audio_clips;
+
+  int size() const {
+    return images.size() + texts.size() + audio_clips.size();
+  }
+};
+
+// Runs the inputs through a task created in a given running mode.
+struct ModeRunner {
+  // Processes the input at `index` and returns once its results are
+  // available. Set in the synchronous running modes.
+  std::function<absl::Status(int index, int64_t timestamp_ms)> process;
+  // Sends the input at `index` to the task, whose results are reported to the
+  // callback the runner was created with. Set in the streaming running modes.
+  std::function<absl::Status(int index, int64_t timestamp_ms)> send;
+  // The duration of the input at `index`, which separates its timestamp from
+  // the timestamp of the next input.
+  std::function<int64_t(int index)> duration_ms;
+  std::function<absl::StatusOr<std::vector<CalculatorProfile>>()>
+      get_calculator_profiles;
+  std::function<absl::Status()> close;
+};
+
+// Reports a result of a streaming running mode, with the timestamp of the
+// result, or the error of the task.
+using ResultCallback =
+    std::function<void(const absl::Status& status, int64_t timestamp_ms)>;
+
+// Records the latencies of the results of a streaming running mode, from the
+// time the input of the result was sent.
+class StreamLatencyRecorder {
+ public:
+  void OnSend(int64_t timestamp_ms) {
+    absl::MutexLock lock(&mutex_);
+    send_times_[timestamp_ms] = absl::Now();
+  }
+
+  void OnResult(const absl::Status& status, int64_t timestamp_ms) {
+    const absl::Time now = absl::Now();
+    absl::MutexLock lock(&mutex_);
+    ++num_results_;
+    if (!status.ok()) {
+      if (status_.ok()) status_ = status;
+      return;
+    }
+    // A result is matched with the latest input sent at or before its
+    // timestamp, as an audio block may yield several results.
+    auto it = send_times_.upper_bound(timestamp_ms);
+    if (it == send_times_.begin()) return;
+    --it;
+    latencies_ms_.push_back(absl::ToDoubleMilliseconds(now - it->second));
+    last_result_time_ = now;
+  }
+
+  // Waits until `num_results` results were received in total, or `timeout`.
+  // Returns whether they were.
+  bool WaitForResults(int num_results, absl::Duration timeout) {
+    absl::MutexLock lock(&mutex_);
+    auto done = [this, num_results]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+      return num_results_ >= num_results;
+    };
+    return mutex_.AwaitWithTimeout(absl::Condition(&done), timeout);
+  }
+
+  int num_results() {
+    absl::MutexLock lock(&mutex_);
+    return num_results_;
+  }
+
+  // Discards what was recorded so far, e.g. during warm-up.
+  void Reset() {
+    absl::MutexLock lock(&mutex_);
+    send_times_.clear();
+    latencies_ms_.clear();
+    num_results_ = 0;
+    last_result_time_ = absl::InfinitePast();
+  }
+
+  absl::Status status() {
+    absl::MutexLock lock(&mutex_);
+    return status_;
+  }
+
+  std::vector<double> latencies_ms() {
+    absl::MutexLock lock(&mutex_);
+    return latencies_ms_;
+  }
+
+  absl::Time last_result_time() {
+    absl::MutexLock lock(&mutex_);
+    return last_result_time_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::map<int64_t, absl::Time> send_times_ ABSL_GUARDED_BY(mutex_);
+  std::vector<double> latencies_ms_ ABSL_GUARDED_BY(mutex_);
+  int num_results_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::Time last_result_time_ ABSL_GUARDED_BY(mutex_) =
+      absl::InfinitePast();
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+};
+
+// The runtime of a calculator of the task graph.
+struct NodeRuntime {
+  std::string name;
+  int64_t calls = 0;
+  int64_t total_us = 0;
+};
+
+// The results of the benchmark of a running mode.
+struct ModeReport {
+  std::string running_mode;
+  int num_inputs = 0;
+  int num_results = 0;
+  double mean_ms = 0;
+  double p50_ms = 0;
+  double p90_ms = 0;
+  double p99_ms = 0;
+  double max_ms = 0;
+  double throughput = 0;
+  int64_t peak_rss_kb = 0;
+  std::vector<NodeRuntime> node_runtimes;
+};
+
+BaseOptions CreateBaseOptions() {
+  BaseOptions base_options;
+  base_options.model_asset_path = absl::GetFlag(FLAGS_model_path);
+  base_options.delegate = absl::GetFlag(FLAGS_delegate) == "gpu"
+                              ? BaseOptions::Delegate::GPU
+                              : BaseOptions::Delegate::CPU;
+  base_options.enable_profiler = absl::GetFlag(FLAGS_enable_profiler);
+  return base_options;
+}
+
+// Creates the runner of a vision task, whose per-mode methods are called by
+// `detect_image`, `detect_video` and `detect_async`.
+template <typename Task, typename Options>
+absl::StatusOr<ModeRunner> CreateVisionRunner(
+    const std::string& running_mode, const Inputs& inputs,
+    ResultCallback callback,
+    std::function<absl::Status(Task&, Image)> detect_image,
+    std::function<absl::Status(Task&, Image, int64_t)> detect_video,
+    std::function<absl::Status(Task&, Image, int64_t)> detect_async) {
+  auto options = std::make_unique<Options>();
+  options->base_options = CreateBaseOptions();
+  if (running_mode == "image") {
+    options->running_mode = vision::core::RunningMode::IMAGE;
+  } else if (running_mode == "video") {
+    options->running_mode = vision::core::RunningMode::VIDEO;
+  } else if (running_mode == "live_stream") {
+    options->running_mode = vision::core::RunningMode::LIVE_STREAM;
+    options->result_callback = [callback](auto result, const Image&,
+                                          int64_t timestamp_ms) {
+      callback(result.status(), timestamp_ms);
+    };
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported running mode: ", running_mode));
+  }
+  ASSIGN_OR_RETURN(std::unique_ptr<Task> created_task,
+                   Task::Create(std::move(options)));
+  std::shared_ptr<Task> task = std::move(created_task);
+  const std::vector<Image>* images = &inputs.images;
+
+  ModeRunner runner;
+  if (running_mode == "image") {
+    runner.process = [task, images, detect_image](int index, int64_t) {
+      return detect_image(*task, (*images)[index]);
+    };
+  } else if (running_mode == "video") {
+    runner.process = [task, images, detect_video](int index,
+                                                  int64_t timestamp_ms) {
+      return detect_video(*task, (*images)[index], timestamp_ms);
+    };
+  } else {
+    runner.send = [task, images, detect_async](int index,
+                                               int64_t timestamp_ms) {
+      return detect_async(*task, (*images)[index], timestamp_ms);
+    };
+  }
+  runner.duration_ms = [](int) { return kFrameIntervalMs; };
+  runner.get_calculator_profiles = [task]() {
+    return task->GetCalculatorProfiles();
+  };
+  runner.close = [task]() { return task->Close(); };
+  return runner;
+}
+
+absl::StatusOr<ModeRunner> CreateTextClassifierRunner(
+    const std::string& running_mode, const Inputs& inputs) {
+  RET_CHECK_EQ(running_mode, "text")
+      << "text_classifier only has the text running mode.";
+  auto options = std::make_unique<TextClassifierOptions>();
+  options->base_options = CreateBaseOptions();
+  ASSIGN_OR_RETURN(std::unique_ptr<TextClassifier> created_task,
+                   TextClassifier::Create(std::move(options)));
+  std::shared_ptr<TextClassifier> task = std::move(created_task);
+  const std::vector<std::string>* texts = &inputs.texts;
+
+  ModeRunner runner;
+  runner.process = [task, texts](int index, int64_t) {
+    return task->Classify((*texts)[index]).status();
+  };
+  runner.duration_ms = [](int) { return kFrameIntervalMs; };
+  runner.get_calculator_profiles = [task]() {
+    return task->GetCalculatorProfiles();
+  };
+  runner.close = [task]() { return task->Close(); };
+  return runner;
+}
+
+absl::StatusOr<ModeRunner> CreateAudioClassifierRunner(
+    const std::string& running_mode, const Inputs& inputs,
+    ResultCallback callback) {
+  auto options = std::make_unique<AudioClassifierOptions>();
+  options->base_options = CreateBaseOptions();
+  if (running_mode == "audio_clips") {
+    options->running_mode = audio::core::RunningMode::AUDIO_CLIPS;
+  } else if (running_mode == "audio_stream") {
+    options->running_mode = audio::core::RunningMode::AUDIO_STREAM;
+    options->result_callback =
+        [callback](absl::StatusOr<AudioClassifierResult> result) {
+          callback(result.status(),
+                   result.ok() ? result->timestamp_ms.value_or(0) : -1);
+        };
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported running mode: ", running_mode));
+  }
+  ASSIGN_OR_RETURN(std::unique_ptr<AudioClassifier> created_task,
+                   AudioClassifier::Create(std::move(options)));
+  std::shared_ptr<AudioClassifier> task = std::move(created_task);
+  const std::vector<AudioClip>* clips = &inputs.audio_clips;
+
+  ModeRunner runner;
+  if (running_mode == "audio_clips") {
+    runner.process = [task, clips](int index, int64_t) {
+      const AudioClip& clip = (*clips)[index];
+      return task->Classify(clip.samples, clip.sample_rate).status();
+    };
+  } else {
+    runner.send = [task, clips](int index, int64_t timestamp_ms) {
+      const AudioClip& clip = (*clips)[index];
+      return task->ClassifyAsync(clip.samples, clip.sample_rate,
+                                 timestamp_ms);
+    };
+  }
+  runner.duration_ms = [clips](int index) {
+    const AudioClip& clip = (*clips)[index];
+    return std::max<int64_t>(
+        1, std::ceil(clip.samples.cols() * 1000 / clip.sample_rate));
+  };
+  runner.get_calculator_profiles = [task]() {
+    return task->GetCalculatorProfiles();
+  };
+  runner.close = [task]() { return task->Close(); };
+  return runner;
+}
+
+absl::StatusOr<ModeRunner> CreateRunner(const std::string& task,
+                                        const std::string& running_mode,
+                                        const Inputs& inputs,
+                                        ResultCallback callback) {
+  if (task == "object_detector") {
+    return CreateVisionRunner<ObjectDetector, ObjectDetectorOptions>(
+        running_mode, inputs, std::move(callback),
+        [](ObjectDetector& detector, Image image) {
+          return detector.Detect(std::move(image)).status();
+        },
+        [](ObjectDetector& detector, Image image, int64_t timestamp_ms) {
+          return detector.DetectForVideo(std::move(image), timestamp_ms)
+              .status();
+        },
+        [](ObjectDetector& detector, Image image, int64_t timestamp_ms) {
+          return detector.DetectAsync(std::move(image), timestamp_ms);
+        });
+  }
+  if (task == "hand_landmarker") {
+    return CreateVisionRunner<HandLandmarker, HandLandmarkerOptions>(
+        running_mode, inputs, std::move(callback),
+        [](HandLandmarker& landmarker, Image image) {
+          return landmarker.Detect(std::move(image)).status();
+        },
+        [](HandLandmarker& landmarker, Image image, int64_t timestamp_ms) {
+          return landmarker.DetectForVideo(std::move(image), timestamp_ms)
+              .status();
+        },
+        [](HandLandmarker& landmarker, Image image, int64_t timestamp_ms) {
+          return landmarker.DetectAsync(std::move(image), timestamp_ms);
+        });
+  }
+  if (task == "image_segmenter") {
+    return CreateVisionRunner<ImageSegmenter, ImageSegmenterOptions>(
+        running_mode, inputs, std::move(callback),
+        [](ImageSegmenter& segmenter, Image image) {
+          return segmenter.Segment(std::move(image)).status();
+        },
+        [](ImageSegmenter& segmenter, Image image, int64_t timestamp_ms) {
+          return segmenter.SegmentForVideo(std::move(image), timestamp_ms)
+              .status();
+        },
+        [](ImageSegmenter& segmenter, Image image, int64_t timestamp_ms) {
+          return segmenter.SegmentAsync(std::move(image), timestamp_ms);
+        });
+  }
+  if (task == "text_classifier") {
+    return CreateTextClassifierRunner(running_mode, inputs);
+  }
+  if (task == "audio_classifier") {
+    return CreateAudioClassifierRunner(running_mode, inputs,
+                                       std::move(callback));
+  }
+  return absl::InvalidArgumentError(absl::StrCat("Unsupported task: ", task));
+}
+
+std::vector<std::string> DefaultRunningModes(const std::string& task) {
+  if (task == "text_classifier") return {"text"};
+  if (task == "audio_classifier") return {"audio_clips", "audio_stream"};
+  return {"image", "video", "live_stream"};
+}
+
+// Reads a little-endian value at `offset` of `data`.
+template <typename T>
+T ReadLittleEndian(const std::string& data, size_t offset) {
+  T value;
+  std::memcpy(&value, data.data() + offset, sizeof(T));
+  return value;
+}
+
+// Reads a RIFF WAV file of 16-bit PCM or 32-bit float samples. Assumes a
+// little-endian host.
+absl::StatusOr<AudioClip> ReadWavFile(const std::string& path) {
+  std::string contents;
+  MP_RETURN_IF_ERROR(file::GetContents(path, &contents));
+  RET_CHECK(contents.size() >= 12 && contents.compare(0, 4, "RIFF") == 0 &&
+            contents.compare(8, 4, "WAVE") == 0)
+      << path << " is not a WAV file.";
+  int format = 0;
+  int num_channels = 0;
+  int bits_per_sample = 0;
+  uint32_t sample_rate = 0;
+  size_t data_offset = 0;
+  size_t data_size = 0;
+  for (size_t offset = 12; offset + 8 <= contents.size();) {
+    const std::string chunk_id = contents.substr(offset, 4);
+    const uint32_t chunk_size =
+        ReadLittleEndian<uint32_t>(contents, offset + 4);
+    offset += 8;
+    if (chunk_id == "fmt ") {
+      RET_CHECK(chunk_size >= 16 && offset + 16 <= contents.size())
+          << "Invalid fmt chunk in " << path;
+      format = ReadLittleEndian<uint16_t>(contents, offset);
+      num_channels = ReadLittleEndian<uint16_t>(contents, offset + 2);
+      sample_rate = ReadLittleEndian<uint32_t>(contents, offset + 4);
+      bits_per_sample = ReadLittleEndian<uint16_t>(contents, offset + 14);
+    } else if (chunk_id == "data") {
+      data_offset = offset;
+      data_size = std::min<size_t>(chunk_size, contents.size() - offset);
+    }
+    // Chunks are padded to an even size.
+    offset += chunk_size + (chunk_size & 1);
+  }
+  RET_CHECK(num_channels > 0 && sample_rate > 0 && data_offset > 0)
+      << "Missing fmt or data chunk in " << path;
+  RET_CHECK((format == 1 && bits_per_sample == 16) ||
+            (format == 3 && bits_per_sample == 32))
+      << "Only 16-bit PCM and 32-bit float WAV files are supported: " << path;
+
+  const int sample_size = bits_per_sample / 8;
+  const int num_samples = data_size / (sample_size * num_channels);
+  AudioClip clip;
+  clip.sample_rate = sample_rate;
+  clip.samples.resize(num_channels, num_samples);
+  for (int i = 0; i < num_samples; ++i) {
+    for (int c = 0; c < num_channels; ++c) {
+      const size_t offset =
+          data_offset + (i * num_channels + c) * sample_size;
+      clip.samples(c, i) =
+          format == 1
+              ? ReadLittleEndian<int16_t>(contents, offset) / 32768.0f
+              : ReadLittleEndian<float>(contents, offset);
+    }
+  }
+  return clip;
+}
+
+absl::StatusOr<Inputs> ReadInputs(const std::string& task,
+                                  const std::string& input_dir) {
+  std::vector<std::string> paths;
+  MP_RETURN_IF_ERROR(file::MatchFileTypeInDirectory(input_dir, "", &paths));
+  std::sort(paths.begin(), paths.end());
+  Inputs inputs;
+  for (const std::string& path : paths) {
+    if (task == "text_classifier") {
+      if (!absl::EndsWith(path, ".txt")) continue;
+      std::string text;
+      MP_RETURN_IF_ERROR(file::GetContents(path, &text));
+      inputs.texts.push_back(std::move(text));
+    } else if (task == "audio_classifier") {
+      if (!absl::EndsWith(path, ".wav")) continue;
+      ASSIGN_OR_RETURN(AudioClip clip, ReadWavFile(path));
+      inputs.audio_clips.push_back(std::move(clip));
+    } else {
+      if (!absl::EndsWith(path, ".jpg") && !absl::EndsWith(path, ".jpeg") &&
+          !absl::EndsWith(path, ".png")) {
+        continue;
+      }
+      ASSIGN_OR_RETURN(Image image, vision::DecodeImageFromFile(path));
+      inputs.images.push_back(std::move(image));
+    }
+  }
+  RET_CHECK_GT(inputs.size(), 0) << "No input for " << task << " found in "
+                                 << input_dir;
+  return inputs;
+}
+
+// Returns the nearest-rank percentile `p` of the sorted `values`.
+double Percentile(const std::vector<double>& values, double p) {
+  if (values.empty()) return 0;
+  const int rank = std::ceil(p / 100 * values.size());
+  return values[std::clamp(rank - 1, 0, static_cast<int>(values.size()) - 1)];
+}
+
+// Returns the runtimes of the calculators, summed over their profiles.
+std::map<std::string, NodeRuntime> GetNodeRuntimes(
+    const std::vector<CalculatorProfile>& profiles) {
+  std::map<std::string, NodeRuntime> runtimes;
+  for (const CalculatorProfile& profile : profiles) {
+    NodeRuntime& runtime = runtimes[profile.name()];
+    runtime.name = profile.name();
+    for (int64_t count : profile.process_runtime().count()) {
+      runtime.calls += count;
+    }
+    runtime.total_us += profile.process_runtime().total();
+  }
+  return runtimes;
+}
+
+int64_t GetPeakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+absl::StatusOr<ModeReport> BenchmarkRunningMode(const std::string& task,
+                                                const std::string& running_mode,
+                                                const Inputs& inputs) {
+  auto recorder = std::make_shared<StreamLatencyRecorder>();
+  ASSIGN_OR_RETURN(
+      ModeRunner runner,
+      CreateRunner(task, running_mode, inputs,
+                   [recorder](const absl::Status& status,
+                              int64_t timestamp_ms) {
+                     recorder->OnResult(status, timestamp_ms);
+                   }));
+  const bool enable_profiler = absl::GetFlag(FLAGS_enable_profiler);
+  const int num_inputs = inputs.size();
+  int64_t timestamp_ms = 0;
+  int input_index = 0;
+  // Returns the next input index and advances the timestamp past it.
+  auto next_input = [&]() {
+    const int index = input_index;
+    input_index = (input_index + 1) % num_inputs;
+    timestamp_ms += runner.duration_ms(index);
+    return index;
+  };
+
+  // Warms up, waiting for every input of a streaming running mode not to
+  // measure the queueing of the warm-up inputs.
+  for (int i = 0; i < absl::GetFlag(FLAGS_warmup_iterations); ++i) {
+    const int64_t input_timestamp_ms = timestamp_ms;
+    const int index = next_input();
+    if (runner.process) {
+      MP_RETURN_IF_ERROR(runner.process(index, input_timestamp_ms));
+    } else {
+      const int num_results = recorder->num_results();
+      MP_RETURN_IF_ERROR(runner.send(index, input_timestamp_ms));
+      recorder->WaitForResults(num_results + 1, kWarmupResultTimeout);
+    }
+  }
+  MP_RETURN_IF_ERROR(recorder->status());
+  std::map<std::string, NodeRuntime> warmup_runtimes;
+  if (enable_profiler) {
+    ASSIGN_OR_RETURN(auto profiles, runner.get_calculator_profiles());
+    warmup_runtimes = GetNodeRuntimes(profiles);
+  }
+  recorder->Reset();
+
+  // Measures the synchronous running modes call by call, and the streaming
+  // running modes from the send time of every input to its results, with the
+  // inputs sent as fast as the task accepts them.
+  ModeReport report;
+  report.running_mode = running_mode;
+  report.num_inputs = absl::GetFlag(FLAGS_iterations);
+  std::vector<double> latencies_ms;
+  const absl::Time start_time = absl::Now();
+  absl::Time end_time;
+  for (int i = 0; i < report.num_inputs; ++i) {
+    const int64_t input_timestamp_ms = timestamp_ms;
+    const int index = next_input();
+    if (runner.process) {
+      const absl::Time call_time = absl::Now();
+      MP_RETURN_IF_ERROR(runner.process(index, input_timestamp_ms));
+      latencies_ms.push_back(
+          absl::ToDoubleMilliseconds(absl::Now() - call_time));
+    } else {
+      recorder->OnSend(input_timestamp_ms);
+      MP_RETURN_IF_ERROR(runner.send(index, input_timestamp_ms));
+    }
+  }
+  if (runner.process) {
+    end_time = absl::Now();
+    report.num_results = report.num_inputs;
+  } else {
+    // The live stream running mode drops the inputs sent while the graph is
+    // busy, so only the results received are waited for.
+    recorder->WaitForResults(report.num_inputs, kResultTimeout);
+    MP_RETURN_IF_ERROR(recorder->status());
+    latencies_ms = recorder->latencies_ms();
+    report.num_results = latencies_ms.size();
+    end_time = latencies_ms.empty() ? absl::Now()
+                                    : recorder->last_result_time();
+  }
+
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  if (!latencies_ms.empty()) {
+    double sum_ms = 0;
+    for (double latency_ms : latencies_ms) sum_ms += latency_ms;
+    report.mean_ms = sum_ms / latencies_ms.size();
+    report.max_ms = latencies_ms.back();
+  }
+  report.p50_ms = Percentile(latencies_ms, 50);
+  report.p90_ms = Percentile(latencies_ms, 90);
+  report.p99_ms = Percentile(latencies_ms, 99);
+  const double elapsed_s = absl::ToDoubleSeconds(end_time - start_time);
+  report.throughput = elapsed_s > 0 ? report.num_results / elapsed_s : 0;
+
+  if (enable_profiler) {
+    ASSIGN_OR_RETURN(auto profiles, runner.get_calculator_profiles());
+    for (auto& [name, runtime] : GetNodeRuntimes(profiles)) {
+      const NodeRuntime& warmup_runtime = warmup_runtimes[name];
+      runtime.calls -= warmup_runtime.calls;
+      runtime.total_us -= warmup_runtime.total_us;
+      report.node_runtimes.push_back(std::move(runtime));
+    }
+    std::sort(report.node_runtimes.begin(), report.node_runtimes.end(),
+              [](const NodeRuntime& a, const NodeRuntime& b) {
+                return a.total_us > b.total_us;
+              });
+  }
+  MP_RETURN_IF_ERROR(runner.close());
+  report.peak_rss_kb = GetPeakRssKb();
+  return report;
+}
+
+void PrintReport(const ModeReport& report) {
+  std::cout << absl::StrFormat(
+      "%s: %d inputs, %d results\n"
+      "  latency (ms): mean %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n"
+      "  throughput: %.2f results/s\n"
+      "  peak RSS: %d KB\n",
+      report.running_mode, report.num_inputs, report.num_results,
+      report.mean_ms, report.p50_ms, report.p90_ms, report.p99_ms,
+      report.max_ms, report.throughput, report.peak_rss_kb);
+  for (const NodeRuntime& runtime : report.node_runtimes) {
+    std::cout << absl::StrFormat("  %-60s %8d calls %12.3f ms\n",
+                                 runtime.name, runtime.calls,
+                                 runtime.total_us / 1000.0);
+  }
+}
+
+std::string JsonString(absl::string_view value) {
+  std::string json = "\"";
+  for (char c : value) {
+    switch (c) {
+      case '"':
+        json += "\\\"";
+        break;
+      case '\\':
+        json += "\\\\";
+        break;
+      case '\n':
+        json += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(&json, "\\u%04x", c);
+        } else {
+          json += c;
+        }
+    }
+  }
+  return json + "\"";
+}
+
+std::string ToJson(const std::string& task,
+                   const std::vector<ModeReport>& reports) {
+  std::vector<std::string> json_reports;
+  for (const ModeReport& report : reports) {
+    std::vector<std::string> json_runtimes;
+    for (const NodeRuntime& runtime : report.node_runtimes) {
+      json_runtimes.push_back(absl::StrFormat(
+          "{\"name\": %s, \"calls\": %d, \"total_us\": %d}",
+          JsonString(runtime.name), runtime.calls, runtime.total_us));
+    }
+    json_reports.push_back(absl::StrFormat(
+        "{\"running_mode\": %s, \"num_inputs\": %d, \"num_results\": %d, "
+        "\"latency_ms\": {\"mean\": %f, \"p50\": %f, \"p90\": %f, "
+        "\"p99\": %f, \"max\": %f}, \"throughput\": %f, "
+        "\"peak_rss_kb\": %d, \"calculators\": [%s]}",
+        JsonString(report.running_mode), report.num_inputs,
+        report.num_results, report.mean_ms, report.p50_ms, report.p90_ms,
+        report.p99_ms, report.max_ms, report.throughput, report.peak_rss_kb,
+        absl::StrJoin(json_runtimes, ", ")));
+  }
+  return absl::StrFormat(
+      "{\"task\": %s, \"model_path\": %s, \"delegate\": %s, "
+      "\"warmup_iterations\": %d, \"running_modes\": [%s]}\n",
+      JsonString(task), JsonString(absl::GetFlag(FLAGS_model_path)),
+      JsonString(absl::GetFlag(FLAGS_delegate)),
+      absl::GetFlag(FLAGS_warmup_iterations),
+      absl::StrJoin(json_reports, ", "));
+}
+
+absl::Status RunBenchmark() {
+  const std::string task = absl::GetFlag(FLAGS_task);
+  RET_CHECK(!absl::GetFlag(FLAGS_model_path).empty())
+      << "--model_path must be set.";
+  RET_CHECK(!absl::GetFlag(FLAGS_input_dir).empty())
+      << "--input_dir must be set.";
+  RET_CHECK_GT(absl::GetFlag(FLAGS_iterations), 0);
+  const std::string delegate = absl::GetFlag(FLAGS_delegate);
+  RET_CHECK(delegate == "cpu" || delegate == "gpu")
+      << "Unsupported delegate: " << delegate;
+
+  std::vector<std::string> running_modes =
+      absl::StrSplit(absl::GetFlag(FLAGS_running_modes), ',',
+                     absl::SkipWhitespace());
+  if (running_modes.empty()) running_modes = DefaultRunningModes(task);
+  ASSIGN_OR_RETURN(Inputs inputs,
+                   ReadInputs(task, absl::GetFlag(FLAGS_input_dir)));
+  LOG(INFO) << "Benchmarking " << task << " on " << inputs.size()
+            << " inputs.";
+
+  std::vector<ModeReport> reports;
+  for (const std::string& running_mode : running_modes) {
+    ASSIGN_OR_RETURN(ModeReport report,
+                     BenchmarkRunningMode(task, running_mode, inputs));
+    PrintReport(report);
+    reports.push_back(std::move(report));
+  }
+  const std::string output_json = absl::GetFlag(FLAGS_output_json);
+  if (!output_json.empty()) {
+    MP_RETURN_IF_ERROR(file::SetContents(output_json, ToJson(task, reports)));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace tasks
+}  // namespace mediapipe
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status status = mediapipe::tasks::RunBenchmark();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << status.message();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
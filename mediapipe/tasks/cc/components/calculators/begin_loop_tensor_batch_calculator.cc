@@ -0,0 +1,104 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe::tasks {
+
+// A BeginLoopCalculator over the batch of a vector of tensors, e.g. the output
+// of a model run on the crops of several regions at once: it emits, for each
+// index of their first dimension, the vector of the slices of the tensors at
+// that index, with a first dimension of 1. The slices share the storage of the
+// input tensors, so the batch is not copied.
+//
+// All the tensors must have the same first dimension. The loop timestamps and
+// the BATCH_END packet are those of BeginLoopCalculator, so the loop is closed
+// by an EndLoopCalculator.
+//
+// Example:
+// node {
+//   calculator: "mediapipe.tasks.BeginLoopTensorBatchCalculator"
+//   input_stream: "ITERABLE:batched_tensors"  # std::vector<Tensor>
+//   output_stream: "ITEM:tensors"             # std::vector<Tensor>
+//   output_stream: "BATCH_END:timestamp"
+// }
+class BeginLoopTensorBatchCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    // Processes the timestamp bound updates of ITERABLE, for the
+    // EndLoopCalculator to propagate them.
+    cc->SetProcessTimestampBounds(true);
+    cc->Inputs().Tag("ITERABLE").Set<std::vector<Tensor>>();
+    cc->Outputs().Tag("ITEM").Set<std::vector<Tensor>>();
+    cc->Outputs().Tag("BATCH_END").Set<Timestamp>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    const Timestamp last_timestamp = loop_internal_timestamp_;
+    if (!cc->Inputs().Tag("ITERABLE").IsEmpty()) {
+      const Packet& packet = cc->Inputs().Tag("ITERABLE").Value();
+      auto tensors = SharedPtrWithPacket<std::vector<Tensor>>(packet);
+      const int batch_size =
+          tensors->empty() ? 0 : (*tensors)[0].shape().dims[0];
+      for (const Tensor& tensor : *tensors) {
+        RET_CHECK(!tensor.shape().dims.empty() &&
+                  tensor.shape().dims[0] == batch_size)
+            << "The tensors must have the same batch size.";
+      }
+      for (int i = 0; i < batch_size; ++i) {
+        auto item = std::make_unique<std::vector<Tensor>>();
+        item->reserve(tensors->size());
+        for (const Tensor& tensor : *tensors) {
+          ASSIGN_OR_RETURN(
+              Tensor slice,
+              Tensor::CreateSlice(
+                  std::shared_ptr<const Tensor>(tensors, &tensor), i, i + 1));
+          item->push_back(std::move(slice));
+        }
+        cc->Outputs().Tag("ITEM").Add(item.release(),
+                                      loop_internal_timestamp_);
+        ++loop_internal_timestamp_;
+      }
+    }
+
+    // The batch was empty and nothing was emitted.
+    if (last_timestamp == loop_internal_timestamp_) {
+      ++loop_internal_timestamp_;
+      cc->Outputs().Tag("ITEM").SetNextTimestampBound(loop_internal_timestamp_);
+    }
+
+    cc->Outputs().Tag("BATCH_END").AddPacket(
+        MakePacket<Timestamp>(cc->InputTimestamp())
+            .At(Timestamp(loop_internal_timestamp_ - 1)));
+    return absl::OkStatus();
+  }
+
+ private:
+  // The next loop timestamp.
+  Timestamp loop_internal_timestamp_ = Timestamp(0);
+};
+REGISTER_CALCULATOR(::mediapipe::tasks::BeginLoopTensorBatchCalculator);
+
+}  // namespace mediapipe::tasks
@@ -0,0 +1,117 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace {
+
+using ::mediapipe::ParseTextProtoOrDie;
+using ::testing::HasSubstr;
+using Node = ::mediapipe::CalculatorGraphConfig::Node;
+
+constexpr char kNodeConfig[] = R"pb(
+  calculator: "mediapipe.tasks.BeginLoopTensorBatchCalculator"
+  input_stream: "ITERABLE:tensors"
+  output_stream: "ITEM:tensor"
+  output_stream: "BATCH_END:timestamp"
+)pb";
+
+// Returns a float tensor of the given shape filled with 0, 1, 2...
+Tensor MakeTensor(const Tensor::Shape& shape) {
+  Tensor tensor(Tensor::ElementType::kFloat32, shape);
+  auto view = tensor.GetCpuWriteView();
+  float* buffer = view.buffer<float>();
+  for (int i = 0; i < shape.num_elements(); ++i) {
+    buffer[i] = i;
+  }
+  return tensor;
+}
+
+void AddTensors(CalculatorRunner* runner, std::vector<Tensor::Shape> shapes,
+                int64_t timestamp) {
+  auto tensors = std::make_unique<std::vector<Tensor>>();
+  for (const Tensor::Shape& shape : shapes) {
+    tensors->push_back(MakeTensor(shape));
+  }
+  runner->MutableInputs()->Tag("ITERABLE").packets.push_back(
+      Adopt(tensors.release()).At(Timestamp(timestamp)));
+}
+
+TEST(BeginLoopTensorBatchCalculatorTest, SplitsBatch) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(kNodeConfig));
+  AddTensors(&runner, {Tensor::Shape{3, 2}, Tensor::Shape{3, 1}}, 10);
+  AddTensors(&runner, {Tensor::Shape{1, 2}, Tensor::Shape{1, 1}}, 20);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& items = runner.Outputs().Tag("ITEM").packets;
+  ASSERT_EQ(items.size(), 4);
+  for (int i = 0; i < items.size(); ++i) {
+    EXPECT_EQ(items[i].Timestamp(), Timestamp(i));
+    const auto& tensors = items[i].Get<std::vector<Tensor>>();
+    ASSERT_EQ(tensors.size(), 2);
+    EXPECT_EQ(tensors[0].shape().dims, (std::vector<int>{1, 2}));
+    EXPECT_EQ(tensors[1].shape().dims, (std::vector<int>{1, 1}));
+    // The first three items are the rows of the first batch.
+    const int row = i < 3 ? i : 0;
+    auto view = tensors[0].GetCpuReadView();
+    EXPECT_EQ(view.buffer<float>()[0], 2 * row);
+    EXPECT_EQ(view.buffer<float>()[1], 2 * row + 1);
+    EXPECT_EQ(tensors[1].GetCpuReadView().buffer<float>()[0], row);
+  }
+
+  const auto& batch_ends = runner.Outputs().Tag("BATCH_END").packets;
+  ASSERT_EQ(batch_ends.size(), 2);
+  EXPECT_EQ(batch_ends[0].Timestamp(), Timestamp(2));
+  EXPECT_EQ(batch_ends[0].Get<Timestamp>(), Timestamp(10));
+  EXPECT_EQ(batch_ends[1].Timestamp(), Timestamp(3));
+  EXPECT_EQ(batch_ends[1].Get<Timestamp>(), Timestamp(20));
+}
+
+TEST(BeginLoopTensorBatchCalculatorTest, HandlesEmptyBatch) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(kNodeConfig));
+  AddTensors(&runner, {}, 10);
+  AddTensors(&runner, {Tensor::Shape{1, 2}}, 20);
+  MP_ASSERT_OK(runner.Run());
+
+  // The empty batch still consumes a loop timestamp.
+  const auto& items = runner.Outputs().Tag("ITEM").packets;
+  ASSERT_EQ(items.size(), 1);
+  EXPECT_EQ(items[0].Timestamp(), Timestamp(1));
+  const auto& batch_ends = runner.Outputs().Tag("BATCH_END").packets;
+  ASSERT_EQ(batch_ends.size(), 2);
+  EXPECT_EQ(batch_ends[0].Timestamp(), Timestamp(0));
+  EXPECT_EQ(batch_ends[1].Timestamp(), Timestamp(1));
+}
+
+TEST(BeginLoopTensorBatchCalculatorTest, FailsOnMismatchingBatchSizes) {
+  CalculatorRunner runner(ParseTextProtoOrDie<Node>(kNodeConfig));
+  AddTensors(&runner, {Tensor::Shape{3, 2}, Tensor::Shape{2, 1}}, 10);
+  auto status = runner.Run();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInternal);
+  EXPECT_THAT(status.message(), HasSubstr("same batch size"));
+}
+
+}  // namespace
+}  // namespace mediapipe
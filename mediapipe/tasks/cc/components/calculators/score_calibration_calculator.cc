@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -54,6 +56,21 @@ float ClampedLog(float x, float threshold) {
   }
   return std::log(static_cast<double>(x));
 }
+
+// Applies the score transformation of the options to a score.
+template <ScoreCalibrationCalculatorOptions::ScoreTransformation
+              kTransformation>
+float TransformScore(float x) {
+  if constexpr (kTransformation == ScoreCalibrationCalculatorOptions::LOG) {
+    return ClampedLog(x, kLogScoreMinimum);
+  } else if constexpr (kTransformation ==
+                       ScoreCalibrationCalculatorOptions::INVERSE_LOGISTIC) {
+    return (ClampedLog(x, kLogScoreMinimum) -
+            ClampedLog(1.0 - x, kLogScoreMinimum));
+  } else {
+    return x;
+  }
+}
 }  // namespace
 
 // Applies score calibration to a tensor of score predictions, typically applied
@@ -90,14 +107,40 @@ class ScoreCalibrationCalculator : public Node {
   absl::Status Process(CalculatorContext* cc) override;
 
  private:
+  // The parameters of a sigmoid of the options, read once in Open() rather
+  // than through the proto accessors for each score.
+  struct Sigmoid {
+    // Scores are calibrated to the default score if the sigmoid lacks one of
+    // scale, offset and slope.
+    bool is_empty;
+    float scale;
+    float slope;
+    float offset;
+    // Scores below are calibrated to the default score, -infinity if unset.
+    float min_score;
+  };
+
   ScoreCalibrationCalculatorOptions options_;
-  std::function<float(float)> score_transformation_;
+  std::vector<Sigmoid> sigmoids_;
+
+  // Calibrates the `num_scores` scores with the sigmoids at `indices`, or at
+  // the positions of the scores if `indices` is null.
+  absl::Status CalibrateScores(const float* scores, const float* indices,
+                               int num_scores, float* calibrated_scores);
+  // Same as above, with the score transformation as a template parameter so
+  // that the loop has no indirect call per score.
+  template <ScoreCalibrationCalculatorOptions::ScoreTransformation
+                kTransformation>
+  absl::Status CalibrateScores(const float* scores, const float* indices,
+                               int num_scores, float* calibrated_scores);
 
   // Computes the calibrated score for the provided index. Does not check for
   // out-of-bounds index.
+  template <ScoreCalibrationCalculatorOptions::ScoreTransformation
+                kTransformation>
   float ComputeCalibratedScore(int index, float score);
-  // Same as above, but does check for out-of-bounds index.
-  absl::StatusOr<float> SafeComputeCalibratedScore(int index, float score);
+  // Checks that the provided index is in bounds.
+  absl::Status CheckSigmoidIndex(int index);
 };
 
 absl::Status ScoreCalibrationCalculator::Open(CalculatorContext* cc) {
@@ -118,21 +161,18 @@ absl::Status ScoreCalibrationCalculator::Open(CalculatorContext* cc) {
           MediaPipeTasksStatus::kInvalidArgumentError);
     }
   }
-  // Set score transformation function once and for all.
+  sigmoids_.reserve(options_.sigmoids_size());
+  for (const auto& sigmoid : options_.sigmoids()) {
+    sigmoids_.push_back(
+        {!sigmoid.has_scale() || !sigmoid.has_offset() || !sigmoid.has_slope(),
+         sigmoid.scale(), sigmoid.slope(), sigmoid.offset(),
+         sigmoid.has_min_score() ? sigmoid.min_score()
+                                 : -std::numeric_limits<float>::infinity()});
+  }
   switch (options_.score_transformation()) {
     case tasks::ScoreCalibrationCalculatorOptions::IDENTITY:
-      score_transformation_ = [](float x) { return x; };
-      break;
     case tasks::ScoreCalibrationCalculatorOptions::LOG:
-      score_transformation_ = [](float x) {
-        return ClampedLog(x, kLogScoreMinimum);
-      };
-      break;
     case tasks::ScoreCalibrationCalculatorOptions::INVERSE_LOGISTIC:
-      score_transformation_ = [](float x) {
-        return (ClampedLog(x, kLogScoreMinimum) -
-                ClampedLog(1.0 - x, kLogScoreMinimum));
-      };
       break;
     default:
       return CreateStatusWithPayload(
@@ -175,13 +215,8 @@ absl::Status ScoreCalibrationCalculator::Process(CalculatorContext* cc) {
     }
     auto indices_view = indices.GetCpuReadView();
     const float* raw_indices = indices_view.buffer<float>();
-    for (int i = 0; i < num_scores; ++i) {
-      // Use the "safe" flavor as we need to check that the externally provided
-      // indices are not out-of-bounds.
-      ASSIGN_OR_RETURN(raw_calibrated_scores[i],
-                       SafeComputeCalibratedScore(
-                           static_cast<int>(raw_indices[i]), raw_scores[i]));
-    }
+    MP_RETURN_IF_ERROR(CalibrateScores(raw_scores, raw_indices, num_scores,
+                                       raw_calibrated_scores));
   } else {
     if (num_scores != options_.sigmoids_size()) {
       return CreateStatusWithPayload(
@@ -191,58 +226,91 @@ absl::Status ScoreCalibrationCalculator::Process(CalculatorContext* cc) {
                           options_.sigmoids_size(), num_scores),
           MediaPipeTasksStatus::kMetadataInconsistencyError);
     }
+    MP_RETURN_IF_ERROR(CalibrateScores(raw_scores, /*indices=*/nullptr,
+                                       num_scores, raw_calibrated_scores));
+  }
+  kScoresOut(cc).Send(std::move(output_tensors));
+  return absl::OkStatus();
+}
+
+absl::Status ScoreCalibrationCalculator::CalibrateScores(
+    const float* scores, const float* indices, int num_scores,
+    float* calibrated_scores) {
+  switch (options_.score_transformation()) {
+    case ScoreCalibrationCalculatorOptions::LOG:
+      return CalibrateScores<ScoreCalibrationCalculatorOptions::LOG>(
+          scores, indices, num_scores, calibrated_scores);
+    case ScoreCalibrationCalculatorOptions::INVERSE_LOGISTIC:
+      return CalibrateScores<
+          ScoreCalibrationCalculatorOptions::INVERSE_LOGISTIC>(
+          scores, indices, num_scores, calibrated_scores);
+    default:
+      return CalibrateScores<ScoreCalibrationCalculatorOptions::IDENTITY>(
+          scores, indices, num_scores, calibrated_scores);
+  }
+}
+
+template <ScoreCalibrationCalculatorOptions::ScoreTransformation
+              kTransformation>
+absl::Status ScoreCalibrationCalculator::CalibrateScores(
+    const float* scores, const float* indices, int num_scores,
+    float* calibrated_scores) {
+  if (indices == nullptr) {
+    // The number of sigmoids was checked against the number of scores.
     for (int i = 0; i < num_scores; ++i) {
-      // Use the "unsafe" flavor as we have already checked for out-of-bounds
-      // issues.
-      raw_calibrated_scores[i] = ComputeCalibratedScore(i, raw_scores[i]);
+      calibrated_scores[i] =
+          ComputeCalibratedScore<kTransformation>(i, scores[i]);
     }
+    return absl::OkStatus();
+  }
+  for (int i = 0; i < num_scores; ++i) {
+    // The externally provided indices need to be checked.
+    const int index = static_cast<int>(indices[i]);
+    MP_RETURN_IF_ERROR(CheckSigmoidIndex(index));
+    calibrated_scores[i] =
+        ComputeCalibratedScore<kTransformation>(index, scores[i]);
   }
-  kScoresOut(cc).Send(std::move(output_tensors));
   return absl::OkStatus();
 }
 
+template <ScoreCalibrationCalculatorOptions::ScoreTransformation
+              kTransformation>
 float ScoreCalibrationCalculator::ComputeCalibratedScore(int index,
                                                          float score) {
-  const auto& sigmoid = options_.sigmoids(index);
-
-  bool is_empty =
-      !sigmoid.has_scale() || !sigmoid.has_offset() || !sigmoid.has_slope();
-  bool is_below_min_score =
-      sigmoid.has_min_score() && score < sigmoid.min_score();
-  if (is_empty || is_below_min_score) {
+  const Sigmoid& sigmoid = sigmoids_[index];
+  if (sigmoid.is_empty || score < sigmoid.min_score) {
     return options_.default_score();
   }
 
-  float transformed_score = score_transformation_(score);
+  float transformed_score = TransformScore<kTransformation>(score);
   float scale_shifted_score =
-      transformed_score * sigmoid.slope() + sigmoid.offset();
+      transformed_score * sigmoid.slope + sigmoid.offset;
   // For numerical stability use 1 / (1+exp(-x)) when scale_shifted_score >= 0
   // and exp(x) / (1+exp(x)) when scale_shifted_score < 0.
   float calibrated_score;
   if (scale_shifted_score >= 0.0) {
     calibrated_score =
-        sigmoid.scale() /
+        sigmoid.scale /
         (1.0 + std::exp(static_cast<double>(-scale_shifted_score)));
   } else {
     float score_exp = std::exp(static_cast<double>(scale_shifted_score));
-    calibrated_score = sigmoid.scale() * score_exp / (1.0 + score_exp);
+    calibrated_score = sigmoid.scale * score_exp / (1.0 + score_exp);
   }
   // Scale is non-negative (checked in SigmoidFromLabelAndLine),
   // thus calibrated_score should be in the range of [0, scale]. However, due to
   // numberical stability issue, it may fall out of the boundary. Cap the value
   // to [0, scale] instead.
-  return std::max(std::min(calibrated_score, sigmoid.scale()), 0.0f);
+  return std::max(std::min(calibrated_score, sigmoid.scale), 0.0f);
 }
 
-absl::StatusOr<float> ScoreCalibrationCalculator::SafeComputeCalibratedScore(
-    int index, float score) {
+absl::Status ScoreCalibrationCalculator::CheckSigmoidIndex(int index) {
   if (index < 0) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
         absl::StrFormat("Expected positive indices, found %d.", index),
         MediaPipeTasksStatus::kInvalidArgumentError);
   }
-  if (index > options_.sigmoids_size()) {
+  if (index >= static_cast<int>(sigmoids_.size())) {
     return CreateStatusWithPayload(
         StatusCode::kInvalidArgument,
         absl::StrFormat("Unable to get score calibration parameters for index "
@@ -250,7 +318,7 @@ absl::StatusOr<float> ScoreCalibrationCalculator::SafeComputeCalibratedScore(
                         index, options_.sigmoids_size()),
         MediaPipeTasksStatus::kMetadataInconsistencyError);
   }
-  return ComputeCalibratedScore(index, score);
+  return absl::OkStatus();
 }
 
 MEDIAPIPE_REGISTER_NODE(ScoreCalibrationCalculator);
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "mediapipe/framework/formats/detection.pb.h"
 #include "mediapipe/tasks/cc/components/containers/category.h"
+#include "mediapipe/tasks/cc/components/containers/classification_result.h"
 #include "mediapipe/tasks/cc/components/containers/rect.h"
 
 namespace mediapipe::tasks::components::containers {
@@ -32,6 +33,9 @@ struct Detection {
   std::vector<Category> categories;
   // The bounding box location.
   Rect bounding_box;
+  // The classifications of the bounding box by a second-stage classifier, for
+  // each head of its model. Empty unless such a classifier is configured.
+  std::vector<Classifications> classifications;
 };
 
 // Detection results of a model.
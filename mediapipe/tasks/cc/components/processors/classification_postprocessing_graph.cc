@@ -111,9 +111,10 @@ struct ClassificationHeadsProperties {
 };
 
 // Identifies the number of classification heads and whether they are quantized
-// or not.
+// or not. The last `num_state_tensors` outputs of the model hold the state of a
+// streaming model and are not classification heads.
 absl::StatusOr<ClassificationHeadsProperties> GetClassificationHeadsProperties(
-    const ModelResources& model_resources) {
+    const ModelResources& model_resources, int num_state_tensors) {
   const tflite::Model& model = *model_resources.GetTfLiteModel();
   if (model.subgraphs()->size() != 1) {
     return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument,
@@ -122,7 +123,16 @@ absl::StatusOr<ClassificationHeadsProperties> GetClassificationHeadsProperties(
                                    MediaPipeTasksStatus::kInvalidArgumentError);
   }
   const auto* primary_subgraph = (*model.subgraphs())[0];
-  int num_output_tensors = primary_subgraph->outputs()->size();
+  const int num_model_outputs = primary_subgraph->outputs()->size();
+  if (num_state_tensors < 0 || num_state_tensors >= num_model_outputs) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrFormat("Expected fewer state tensors than the %d model "
+                        "outputs, found %d.",
+                        num_model_outputs, num_state_tensors),
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  const int num_output_tensors = num_model_outputs - num_state_tensors;
   // Sanity check tensor types and check if model outputs are quantized or not.
   int num_quantized_tensors = 0;
   for (int i = 0; i < num_output_tensors; ++i) {
@@ -153,11 +163,13 @@ absl::StatusOr<ClassificationHeadsProperties> GetClassificationHeadsProperties(
             num_quantized_tensors, num_output_tensors),
         MediaPipeTasksStatus::kInvalidOutputTensorTypeError);
   }
-  // Check if metadata is consistent with model topology.
+  // Check if metadata is consistent with model topology. Metadata may or may
+  // not describe the state outputs.
   const auto* output_tensors_metadata =
       model_resources.GetMetadataExtractor()->GetOutputTensorMetadata();
   if (output_tensors_metadata != nullptr &&
-      num_output_tensors != output_tensors_metadata->size()) {
+      num_output_tensors != output_tensors_metadata->size() &&
+      num_model_outputs != output_tensors_metadata->size()) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
         absl::StrFormat("Mismatch between number of output tensors (%d) and "
@@ -291,14 +303,14 @@ absl::Status ConfigureScoreCalibrationIfAny(
 }
 
 void ConfigureClassificationAggregationCalculator(
-    const ModelMetadataExtractor& metadata_extractor,
+    const ModelMetadataExtractor& metadata_extractor, int num_heads,
     mediapipe::ClassificationAggregationCalculatorOptions* options) {
   auto* output_tensors_metadata = metadata_extractor.GetOutputTensorMetadata();
   if (output_tensors_metadata == nullptr) {
     return;
   }
-  for (const auto& metadata : *output_tensors_metadata) {
-    options->add_head_names(metadata->name()->str());
+  for (int i = 0; i < num_heads; ++i) {
+    options->add_head_names(output_tensors_metadata->Get(i)->name()->str());
   }
 }
 
@@ -358,10 +370,12 @@ absl::Status ConfigureTensorsToClassificationCalculator(
 absl::Status ConfigureClassificationPostprocessingGraph(
     const ModelResources& model_resources,
     const proto::ClassifierOptions& classifier_options,
-    proto::ClassificationPostprocessingGraphOptions* options) {
+    proto::ClassificationPostprocessingGraphOptions* options,
+    int num_state_tensors) {
   MP_RETURN_IF_ERROR(SanityCheckClassifierOptions(classifier_options));
   ASSIGN_OR_RETURN(const auto heads_properties,
-                   GetClassificationHeadsProperties(model_resources));
+                   GetClassificationHeadsProperties(model_resources,
+                                                    num_state_tensors));
   for (int i = 0; i < heads_properties.num_heads; ++i) {
     MP_RETURN_IF_ERROR(ConfigureScoreCalibrationIfAny(
         *model_resources.GetMetadataExtractor(), i, options));
@@ -370,7 +384,7 @@ absl::Status ConfigureClassificationPostprocessingGraph(
         options->add_tensors_to_classifications_options()));
   }
   ConfigureClassificationAggregationCalculator(
-      *model_resources.GetMetadataExtractor(),
+      *model_resources.GetMetadataExtractor(), heads_properties.num_heads,
       options->mutable_classification_aggregation_options());
   options->set_has_quantized_outputs(heads_properties.quantized);
   return absl::OkStatus();
@@ -58,10 +58,15 @@ namespace processors {
 //     The classification result aggregated by timestamp, then by head. Must be
 //     connected if the TIMESTAMPS input is connected, as it signals that
 //     timestamp aggregation is required.
+//
+// For streaming models, `num_state_tensors` is the number of trailing model
+// outputs that carry the model state rather than classification scores. These
+// must be split off the TENSORS input before it reaches the graph.
 absl::Status ConfigureClassificationPostprocessingGraph(
     const tasks::core::ModelResources& model_resources,
     const proto::ClassifierOptions& classifier_options,
-    proto::ClassificationPostprocessingGraphOptions* options);
+    proto::ClassificationPostprocessingGraphOptions* options,
+    int num_state_tensors = 0);
 
 // Utility function to fill in the TensorsToClassificationCalculatorOptions
 // based on the classifier options and the (optional) output tensor metadata.
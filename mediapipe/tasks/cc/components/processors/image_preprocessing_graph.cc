@@ -36,6 +36,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/processors/proto/image_preprocessing_graph_options.pb.h"
 #include "mediapipe/tasks/cc/core/model_resources.h"
 #include "mediapipe/tasks/cc/core/proto/acceleration.pb.h"
+#include "mediapipe/tasks/cc/core/proto/base_options.pb.h"
 #include "mediapipe/tasks/cc/vision/utils/image_tensor_specs.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -162,6 +163,19 @@ absl::Status ConfigureImagePreprocessingGraph(
   return absl::OkStatus();
 }
 
+absl::Status ConfigureImagePreprocessingGraph(
+    const ModelResources& model_resources,
+    const core::proto::BaseOptions& base_options,
+    proto::ImagePreprocessingGraphOptions* options) {
+  MP_RETURN_IF_ERROR(ConfigureImagePreprocessingGraph(
+      model_resources,
+      DetermineImagePreprocessingGpuBackend(base_options.acceleration()),
+      options));
+  options->mutable_image_to_tensor_options()->set_share_output(
+      base_options.share_preprocessing());
+  return absl::OkStatus();
+}
+
 Source<Image> AddDataConverter(Source<Image> image_in, Graph& graph,
                                bool output_on_gpu) {
   auto& image_converter = graph.AddNode("ImageCloneCalculator");
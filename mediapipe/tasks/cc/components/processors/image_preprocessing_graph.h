@@ -20,6 +20,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/processors/proto/image_preprocessing_graph_options.pb.h"
 #include "mediapipe/tasks/cc/core/model_resources.h"
 #include "mediapipe/tasks/cc/core/proto/acceleration.pb.h"
+#include "mediapipe/tasks/cc/core/proto/base_options.pb.h"
 
 namespace mediapipe {
 namespace tasks {
@@ -66,6 +67,16 @@ absl::Status ConfigureImagePreprocessingGraph(
     const core::ModelResources& model_resources, bool use_gpu,
     proto::ImagePreprocessingGraphOptions* options);
 
+// Configures an ImagePreprocessingGraph as above, with the backend determined
+// from the acceleration of the task's base options. If the base options set
+// share_preprocessing, the conversions of the input image are shared with the
+// other tasks in the process that set it (see
+// ImageToTensorCalculatorOptions.share_output).
+absl::Status ConfigureImagePreprocessingGraph(
+    const core::ModelResources& model_resources,
+    const core::proto::BaseOptions& base_options,
+    proto::ImagePreprocessingGraphOptions* options);
+
 // Determine if the image preprocessing graph should use GPU as the backend
 // according to the given acceleration setting.
 bool DetermineImagePreprocessingGpuBackend(
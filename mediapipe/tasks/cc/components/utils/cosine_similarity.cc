@@ -15,13 +15,18 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/components/utils/cosine_similarity.h"
 
+#include <cmath>
 #include <cstdint>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/components/containers/embedding_result.h"
+#include "mediapipe/tasks/cc/components/utils/dot_product.h"
 
 namespace mediapipe {
 namespace tasks {
@@ -58,6 +63,85 @@ absl::StatusOr<double> ComputeCosineSimilarity(const T& u, const T& v,
   return dot_product / std::sqrt(norm_u * norm_v);
 }
 
+// An embedding with its precomputed inverse L2-norm.
+struct NormalizedEmbedding {
+  const float* float_values = nullptr;
+  const int8_t* quantized_values = nullptr;
+  int size = 0;
+  double inverse_norm = 0.0;
+};
+
+absl::StatusOr<NormalizedEmbedding> Normalize(const Embedding& embedding) {
+  NormalizedEmbedding result;
+  if (!embedding.float_embedding.empty()) {
+    result.float_values = embedding.float_embedding.data();
+    result.size = embedding.float_embedding.size();
+  } else {
+    result.quantized_values =
+        reinterpret_cast<const int8_t*>(embedding.quantized_embedding.data());
+    result.size = embedding.quantized_embedding.size();
+  }
+  if (result.size == 0) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Cannot compute cosine similarity on empty embeddings",
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  const double squared_norm =
+      result.float_values
+          ? DotProduct(result.float_values, result.float_values, result.size)
+          : DotProduct(result.quantized_values, result.quantized_values,
+                       result.size);
+  if (squared_norm <= 0.0) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Cannot compute cosine similarity on embedding with 0 norm",
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  result.inverse_norm = 1.0 / std::sqrt(squared_norm);
+  return result;
+}
+
+absl::StatusOr<std::vector<NormalizedEmbedding>> NormalizeAll(
+    absl::Span<const Embedding> embeddings) {
+  std::vector<NormalizedEmbedding> results;
+  results.reserve(embeddings.size());
+  for (const Embedding& embedding : embeddings) {
+    ASSIGN_OR_RETURN(auto result, Normalize(embedding));
+    results.push_back(result);
+  }
+  return results;
+}
+
+absl::Status CheckCompatible(const NormalizedEmbedding& u,
+                             const NormalizedEmbedding& v) {
+  if ((u.float_values == nullptr) != (v.float_values == nullptr)) {
+    return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument,
+                                   "Cannot compute cosine similarity between "
+                                   "quantized and float embeddings",
+                                   MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  if (u.size != v.size) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrFormat("Cannot compute cosine similarity between embeddings "
+                        "of different sizes (%d vs. %d)",
+                        u.size, v.size),
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  return absl::OkStatus();
+}
+
+// Expects embeddings checked by CheckCompatible().
+double NormalizedCosineSimilarity(const NormalizedEmbedding& u,
+                                  const NormalizedEmbedding& v) {
+  const double dot_product =
+      u.float_values
+          ? DotProduct(u.float_values, v.float_values, u.size)
+          : DotProduct(u.quantized_values, v.quantized_values, u.size);
+  return dot_product * u.inverse_norm * v.inverse_norm;
+}
+
 }  // namespace
 
 // Utility function to compute cosine similarity [1] between two embedding
@@ -102,6 +186,47 @@ absl::StatusOr<double> CosineSimilarity(const Embedding& u,
       MediaPipeTasksStatus::kInvalidArgumentError);
 }
 
+absl::StatusOr<std::vector<double>> CosineSimilarityMany(
+    const Embedding& query, absl::Span<const Embedding> candidates) {
+  ASSIGN_OR_RETURN(auto normalized_query, Normalize(query));
+  std::vector<double> results;
+  results.reserve(candidates.size());
+  for (const Embedding& candidate : candidates) {
+    ASSIGN_OR_RETURN(auto normalized_candidate, Normalize(candidate));
+    MP_RETURN_IF_ERROR(CheckCompatible(normalized_query, normalized_candidate));
+    results.push_back(
+        NormalizedCosineSimilarity(normalized_query, normalized_candidate));
+  }
+  return results;
+}
+
+absl::StatusOr<std::vector<std::vector<double>>> CosineSimilarityMatrix(
+    absl::Span<const Embedding> queries,
+    absl::Span<const Embedding> candidates) {
+  ASSIGN_OR_RETURN(auto normalized_queries, NormalizeAll(queries));
+  ASSIGN_OR_RETURN(auto normalized_candidates, NormalizeAll(candidates));
+  if (normalized_queries.empty() || normalized_candidates.empty()) {
+    return std::vector<std::vector<double>>(normalized_queries.size());
+  }
+  // Compatibility is transitive, so checking against one embedding suffices.
+  const NormalizedEmbedding& reference = normalized_queries[0];
+  for (const NormalizedEmbedding& embedding : normalized_queries) {
+    MP_RETURN_IF_ERROR(CheckCompatible(reference, embedding));
+  }
+  for (const NormalizedEmbedding& embedding : normalized_candidates) {
+    MP_RETURN_IF_ERROR(CheckCompatible(reference, embedding));
+  }
+  std::vector<std::vector<double>> results(normalized_queries.size());
+  for (int i = 0; i < normalized_queries.size(); ++i) {
+    results[i].reserve(normalized_candidates.size());
+    for (const NormalizedEmbedding& candidate : normalized_candidates) {
+      results[i].push_back(
+          NormalizedCosineSimilarity(normalized_queries[i], candidate));
+    }
+  }
+  return results;
+}
+
 }  // namespace utils
 }  // namespace components
 }  // namespace tasks
@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_COSINE_SIMILARITY_H_
 #define MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_COSINE_SIMILARITY_H_
 
+#include <vector>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "mediapipe/tasks/cc/components/containers/embedding_result.h"
 
 namespace mediapipe {
@@ -32,6 +35,22 @@ namespace utils {
 absl::StatusOr<double> CosineSimilarity(const containers::Embedding& u,
                                         const containers::Embedding& v);
 
+// Computes the cosine similarity between `query` and each of `candidates`,
+// e.g. to re-rank search results. The norm of the query is computed once, and
+// the dot products use SIMD kernels with float32 or int8 arithmetic, so the
+// results may differ from CosineSimilarity() by rounding. Fails like
+// CosineSimilarity() if any of the candidates doesn't match the query.
+absl::StatusOr<std::vector<double>> CosineSimilarityMany(
+    const containers::Embedding& query,
+    absl::Span<const containers::Embedding> candidates);
+
+// Computes the cosine similarity between each of `queries` and each of
+// `candidates`, where result[i][j] compares queries[i] and candidates[j]. The
+// norm of each embedding is computed once.
+absl::StatusOr<std::vector<std::vector<double>>> CosineSimilarityMatrix(
+    absl::Span<const containers::Embedding> queries,
+    absl::Span<const containers::Embedding> candidates);
+
 }  // namespace utils
 }  // namespace components
 }  // namespace tasks
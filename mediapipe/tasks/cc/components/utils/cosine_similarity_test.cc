@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/components/utils/cosine_similarity.h"
 
+#include <cmath>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -31,7 +32,9 @@ namespace utils {
 namespace {
 
 using ::mediapipe::tasks::components::containers::Embedding;
+using ::testing::DoubleNear;
 using ::testing::HasSubstr;
+using ::testing::Pointwise;
 
 // Helper function to generate float Embedding.
 Embedding BuildFloatEmbedding(std::vector<float> values) {
@@ -102,6 +105,72 @@ TEST(CosineSimilarity, SucceedsWithQuantizedEntries) {
   EXPECT_EQ(result, -1);
 }
 
+TEST(CosineSimilarityMany, MatchesCosineSimilarity) {
+  auto query = BuildFloatEmbedding({1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0,
+                                    9.0, 10.0, 11.0, 12.0, 13.0, 14.0, 15.0,
+                                    16.0, 17.0});
+  std::vector<Embedding> candidates;
+  for (int i = 0; i < 10; ++i) {
+    std::vector<float> values(17);
+    for (int j = 0; j < values.size(); ++j) {
+      values[j] = (i * 7 + j * 3) % 11 - 5.0f;
+    }
+    candidates.push_back(BuildFloatEmbedding(values));
+  }
+
+  MP_ASSERT_OK_AND_ASSIGN(auto results,
+                          CosineSimilarityMany(query, candidates));
+
+  ASSERT_EQ(results.size(), candidates.size());
+  for (int i = 0; i < candidates.size(); ++i) {
+    MP_ASSERT_OK_AND_ASSIGN(auto expected,
+                            CosineSimilarity(query, candidates[i]));
+    EXPECT_NEAR(results[i], expected, 1e-6);
+  }
+}
+
+TEST(CosineSimilarityMany, FailsWithMismatchingCandidate) {
+  auto query = BuildQuantizedEmbedding({1, 2});
+  std::vector<Embedding> candidates = {BuildQuantizedEmbedding({3, 4}),
+                                       BuildQuantizedEmbedding({3, 4, 5})};
+
+  auto status = CosineSimilarityMany(query, candidates);
+
+  EXPECT_EQ(status.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.status().message(),
+              HasSubstr("Cannot compute cosine similarity between embeddings "
+                        "of different sizes"));
+}
+
+TEST(CosineSimilarityMatrix, SucceedsWithQuantizedEntries) {
+  std::vector<Embedding> queries = {BuildQuantizedEmbedding({127, 0}),
+                                    BuildQuantizedEmbedding({0, -128})};
+  std::vector<Embedding> candidates = {BuildQuantizedEmbedding({-128, 0}),
+                                       BuildQuantizedEmbedding({0, 5}),
+                                       BuildQuantizedEmbedding({3, 3})};
+
+  MP_ASSERT_OK_AND_ASSIGN(auto results,
+                          CosineSimilarityMatrix(queries, candidates));
+
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_THAT(results[0],
+              Pointwise(DoubleNear(1e-9), {-1.0, 0.0, std::sqrt(0.5)}));
+  EXPECT_THAT(results[1],
+              Pointwise(DoubleNear(1e-9), {0.0, -1.0, -std::sqrt(0.5)}));
+}
+
+TEST(CosineSimilarityMatrix, FailsWithQuantizedAndFloatEmbeddings) {
+  std::vector<Embedding> queries = {BuildFloatEmbedding({0.1, 0.2})};
+  std::vector<Embedding> candidates = {BuildQuantizedEmbedding({0, 1})};
+
+  auto status = CosineSimilarityMatrix(queries, candidates);
+
+  EXPECT_EQ(status.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.status().message(),
+              HasSubstr("Cannot compute cosine similarity between quantized "
+                        "and float embeddings"));
+}
+
 }  // namespace
 }  // namespace utils
 }  // namespace components
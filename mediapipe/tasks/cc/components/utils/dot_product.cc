@@ -0,0 +1,38 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/components/utils/dot_product.h"
+
+#include <cstdint>
+
+#include "mediapipe/util/simd/simd.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+
+float DotProduct(const float* u, const float* v, int size) {
+  return simd::DotProduct(u, v, size);
+}
+
+int32_t DotProduct(const int8_t* u, const int8_t* v, int size) {
+  return simd::DotProduct(u, v, size);
+}
+
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
@@ -0,0 +1,41 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_DOT_PRODUCT_H_
+#define MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_DOT_PRODUCT_H_
+
+#include <cstdint>
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+
+// Dot product kernels for comparing embeddings, from mediapipe/util/simd,
+// which picks AVX2, AVX-512 or NEON at runtime where the CPU supports them.
+
+// Returns the dot product of the float vectors `u` and `v` of size `size`.
+float DotProduct(const float* u, const float* v, int size);
+
+// Returns the dot product of the int8 vectors `u` and `v` of size `size`,
+// accumulated exactly in 32 bits, which holds for fewer than 2^17 elements.
+int32_t DotProduct(const int8_t* u, const int8_t* v, int size);
+
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_DOT_PRODUCT_H_
@@ -0,0 +1,71 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/components/utils/dot_product.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+namespace {
+
+// Sizes around the vector widths, to cover the tails of the SIMD loops.
+constexpr int kSizes[] = {0, 1, 7, 8, 15, 16, 17, 31, 33, 100, 1024};
+
+TEST(DotProduct, MatchesScalarFloatDotProduct) {
+  for (int size : kSizes) {
+    std::vector<float> u(size);
+    std::vector<float> v(size);
+    double expected = 0.0;
+    for (int i = 0; i < size; ++i) {
+      u[i] = (i % 13) * 0.25f - 1.5f;
+      v[i] = (i % 7) * -0.5f + 1.0f;
+      expected += u[i] * v[i];
+    }
+    EXPECT_NEAR(DotProduct(u.data(), v.data(), size), expected, 1e-3)
+        << "size " << size;
+  }
+}
+
+TEST(DotProduct, MatchesScalarInt8DotProduct) {
+  for (int size : kSizes) {
+    std::vector<int8_t> u(size);
+    std::vector<int8_t> v(size);
+    int32_t expected = 0;
+    for (int i = 0; i < size; ++i) {
+      u[i] = (i * 37) % 256 - 128;
+      v[i] = (i * 101 + 5) % 256 - 128;
+      expected += u[i] * v[i];
+    }
+    EXPECT_EQ(DotProduct(u.data(), v.data(), size), expected)
+        << "size " << size;
+  }
+}
+
+TEST(DotProduct, HandlesExtremeInt8Values) {
+  const std::vector<int8_t> u(64, -128);
+  EXPECT_EQ(DotProduct(u.data(), u.data(), u.size()), 64 * 128 * 128);
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
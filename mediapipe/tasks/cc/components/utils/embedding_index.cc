@@ -0,0 +1,311 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/components/utils/embedding_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/common.h"
+#include "mediapipe/tasks/cc/components/containers/embedding_result.h"
+#include "mediapipe/tasks/cc/components/utils/dot_product.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+
+namespace {
+
+using ::mediapipe::tasks::components::containers::Embedding;
+
+// Orders results by decreasing similarity, then by increasing id.
+bool IsMoreSimilar(const EmbeddingIndex::SearchResult& a,
+                   const EmbeddingIndex::SearchResult& b) {
+  if (a.similarity != b.similarity) return a.similarity > b.similarity;
+  return a.id < b.id;
+}
+
+// Keeps the k most similar results seen so far in a heap, whose top is the
+// least similar of them.
+class TopK {
+ public:
+  explicit TopK(int k) : k_(k) { results_.reserve(k); }
+
+  void Add(EmbeddingIndex::SearchResult result) {
+    if (results_.size() < k_) {
+      results_.push_back(result);
+      std::push_heap(results_.begin(), results_.end(), IsMoreSimilar);
+    } else if (IsMoreSimilar(result, results_.front())) {
+      std::pop_heap(results_.begin(), results_.end(), IsMoreSimilar);
+      results_.back() = result;
+      std::push_heap(results_.begin(), results_.end(), IsMoreSimilar);
+    }
+  }
+
+  std::vector<EmbeddingIndex::SearchResult> Finish() && {
+    std::sort_heap(results_.begin(), results_.end(), IsMoreSimilar);
+    return std::move(results_);
+  }
+
+ private:
+  const int k_;
+  std::vector<EmbeddingIndex::SearchResult> results_;
+};
+
+absl::Status CreateInvalidArgumentError(const std::string& message) {
+  return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument, message,
+                                 MediaPipeTasksStatus::kInvalidArgumentError);
+}
+
+}  // namespace
+
+EmbeddingIndex::EmbeddingIndex() : EmbeddingIndex(Options()) {}
+
+EmbeddingIndex::EmbeddingIndex(Options options) : options_(options) {}
+
+absl::Status EmbeddingIndex::Prepare(const Embedding& embedding,
+                                     std::vector<float>* float_values,
+                                     std::vector<int8_t>* quantized_values,
+                                     float* inverse_norm) const {
+  const bool quantized = embedding.float_embedding.empty();
+  const int dimension = quantized ? embedding.quantized_embedding.size()
+                                  : embedding.float_embedding.size();
+  if (dimension == 0) {
+    return CreateInvalidArgumentError(
+        "Cannot index or search empty embeddings");
+  }
+  if (!ids_.empty() && quantized != quantized_) {
+    return CreateInvalidArgumentError(
+        "Cannot mix quantized and float embeddings in an index");
+  }
+  if (!ids_.empty() && dimension != dimension_) {
+    return CreateInvalidArgumentError(absl::StrFormat(
+        "Embedding size doesn't match the index (%d vs. %d)", dimension,
+        dimension_));
+  }
+  double squared_norm = 0.0;
+  if (quantized) {
+    const auto* data =
+        reinterpret_cast<const int8_t*>(embedding.quantized_embedding.data());
+    quantized_values->assign(data, data + dimension);
+    for (int8_t value : *quantized_values) {
+      squared_norm += value * value;
+    }
+  } else {
+    *float_values = embedding.float_embedding;
+    for (float value : *float_values) {
+      squared_norm += value * value;
+    }
+  }
+  if (squared_norm <= 0.0) {
+    return CreateInvalidArgumentError(
+        "Cannot index or search embeddings with 0 norm");
+  }
+  *inverse_norm = 1.0 / std::sqrt(squared_norm);
+  if (quantized) {
+    // Float values are only needed to pick partitions.
+    if (!centroids_.empty()) {
+      float_values->resize(dimension);
+      for (int i = 0; i < dimension; ++i) {
+        (*float_values)[i] = (*quantized_values)[i] * *inverse_norm;
+      }
+    }
+  } else {
+    for (float& value : *float_values) {
+      value *= *inverse_norm;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status EmbeddingIndex::Add(int64_t id, const Embedding& embedding) {
+  std::vector<float> float_values;
+  std::vector<int8_t> quantized_values;
+  float inverse_norm;
+  MP_RETURN_IF_ERROR(
+      Prepare(embedding, &float_values, &quantized_values, &inverse_norm));
+  if (ids_.empty()) {
+    quantized_ = embedding.float_embedding.empty();
+    dimension_ = quantized_ ? quantized_values.size() : float_values.size();
+  }
+  if (!centroids_.empty()) {
+    partitions_[NearestPartition(float_values)].push_back(ids_.size());
+  }
+  ids_.push_back(id);
+  if (quantized_) {
+    quantized_values_.insert(quantized_values_.end(), quantized_values.begin(),
+                             quantized_values.end());
+    inverse_norms_.push_back(inverse_norm);
+  } else {
+    float_values_.insert(float_values_.end(), float_values.begin(),
+                         float_values.end());
+  }
+  return absl::OkStatus();
+}
+
+std::vector<float> EmbeddingIndex::Normalized(int index) const {
+  if (!quantized_) {
+    const float* values = float_values_.data() + Offset(index);
+    return std::vector<float>(values, values + dimension_);
+  }
+  const int8_t* quantized_values = quantized_values_.data() + Offset(index);
+  std::vector<float> values(dimension_);
+  for (int i = 0; i < dimension_; ++i) {
+    values[i] = quantized_values[i] * inverse_norms_[index];
+  }
+  return values;
+}
+
+int EmbeddingIndex::NearestPartition(const std::vector<float>& values) const {
+  int nearest = 0;
+  float max_similarity = -2.0f;
+  for (int p = 0; p < partitions_.size(); ++p) {
+    const float similarity = DotProduct(
+        values.data(), centroids_.data() + p * dimension_, dimension_);
+    if (similarity > max_similarity) {
+      max_similarity = similarity;
+      nearest = p;
+    }
+  }
+  return nearest;
+}
+
+absl::Status EmbeddingIndex::Build() {
+  centroids_.clear();
+  partitions_.clear();
+  const int num_partitions = options_.num_partitions;
+  if (num_partitions <= 0 || size() < num_partitions) {
+    return absl::OkStatus();
+  }
+  // Spherical k-means, starting from embeddings spread over the index.
+  std::vector<float> centroids(num_partitions * dimension_);
+  for (int p = 0; p < num_partitions; ++p) {
+    const std::vector<float> values =
+        Normalized(static_cast<int64_t>(p) * size() / num_partitions);
+    std::copy(values.begin(), values.end(),
+              centroids.begin() + p * dimension_);
+  }
+  std::vector<int> assignments(size(), -1);
+  const int num_iterations = std::max(options_.num_iterations, 1);
+  for (int iteration = 0; iteration < num_iterations; ++iteration) {
+    centroids_ = std::move(centroids);
+    partitions_.assign(num_partitions, {});
+    bool changed = false;
+    centroids.assign(num_partitions * dimension_, 0.0f);
+    for (int i = 0; i < size(); ++i) {
+      const std::vector<float> values = Normalized(i);
+      const int p = NearestPartition(values);
+      changed |= assignments[i] != p;
+      assignments[i] = p;
+      for (int d = 0; d < dimension_; ++d) {
+        centroids[p * dimension_ + d] += values[d];
+      }
+    }
+    if (!changed) break;
+    for (int p = 0; p < num_partitions; ++p) {
+      float* centroid = centroids.data() + p * dimension_;
+      const float norm = std::sqrt(DotProduct(centroid, centroid, dimension_));
+      if (norm > 0.0f) {
+        for (int d = 0; d < dimension_; ++d) centroid[d] /= norm;
+      } else {
+        // Keeps the previous centroid of an empty cluster.
+        std::copy(centroids_.begin() + p * dimension_,
+                  centroids_.begin() + (p + 1) * dimension_, centroid);
+      }
+    }
+  }
+  // The partitions match the centroids of the last iteration.
+  partitions_.assign(num_partitions, {});
+  for (int i = 0; i < size(); ++i) {
+    partitions_[assignments[i]].push_back(i);
+  }
+  return absl::OkStatus();
+}
+
+float EmbeddingIndex::Similarity(const std::vector<float>& float_query,
+                                 const std::vector<int8_t>& quantized_query,
+                                 float query_inverse_norm, int index) const {
+  if (quantized_) {
+    return DotProduct(quantized_query.data(),
+                      quantized_values_.data() + Offset(index),
+                      dimension_) *
+           query_inverse_norm * inverse_norms_[index];
+  }
+  return DotProduct(float_query.data(),
+                    float_values_.data() + Offset(index), dimension_);
+}
+
+absl::StatusOr<std::vector<EmbeddingIndex::SearchResult>>
+EmbeddingIndex::Search(const Embedding& query, int k) const {
+  if (k <= 0) {
+    return CreateInvalidArgumentError(
+        absl::StrFormat("Expected k > 0, got %d", k));
+  }
+  if (ids_.empty()) {
+    return std::vector<SearchResult>();
+  }
+  std::vector<float> float_query;
+  std::vector<int8_t> quantized_query;
+  float query_inverse_norm;
+  MP_RETURN_IF_ERROR(
+      Prepare(query, &float_query, &quantized_query, &query_inverse_norm));
+  TopK top_k(k);
+  auto add = [&](int index) {
+    top_k.Add({ids_[index], Similarity(float_query, quantized_query,
+                                       query_inverse_norm, index)});
+  };
+  if (centroids_.empty()) {
+    for (int i = 0; i < size(); ++i) add(i);
+    return std::move(top_k).Finish();
+  }
+  // Scans the partitions whose centroids are the most similar to the query.
+  TopK top_partitions(std::clamp<int>(options_.num_probes, 1,
+                                      partitions_.size()));
+  for (int p = 0; p < partitions_.size(); ++p) {
+    top_partitions.Add(
+        {p, DotProduct(float_query.data(), centroids_.data() + p * dimension_,
+                       dimension_)});
+  }
+  for (const SearchResult& partition : std::move(top_partitions).Finish()) {
+    for (int index : partitions_[partition.id]) add(index);
+  }
+  return std::move(top_k).Finish();
+}
+
+absl::StatusOr<std::vector<std::vector<EmbeddingIndex::SearchResult>>>
+EmbeddingIndex::SearchBatch(const std::vector<Embedding>& queries,
+                            int k) const {
+  std::vector<std::vector<SearchResult>> results;
+  results.reserve(queries.size());
+  for (const Embedding& query : queries) {
+    ASSIGN_OR_RETURN(auto query_results, Search(query, k));
+    results.push_back(std::move(query_results));
+  }
+  return results;
+}
+
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
@@ -0,0 +1,134 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_EMBEDDING_INDEX_H_
+#define MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_EMBEDDING_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "mediapipe/tasks/cc/components/containers/embedding_result.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+
+// An in-memory index of embeddings, e.g. as returned by the ImageEmbedder or
+// TextEmbedder tasks, that finds the embeddings most similar to a query by
+// cosine similarity.
+//
+// All the embeddings of an index must have the same size, and be either float
+// or scalar-quantized embeddings. Quantized embeddings are kept and compared
+// as int8 values.
+//
+// By default, queries are compared against all the embeddings. For large
+// indexes, Build() can partition the embeddings into clusters by k-means, so
+// that queries only scan the clusters closest to them, at the cost of
+// possibly missing some of the nearest embeddings.
+//
+// Add() and Build() may not be called concurrently with any other method, but
+// Search() and SearchBatch() may be called from multiple threads.
+class EmbeddingIndex {
+ public:
+  struct Options {
+    // The number of clusters that Build() partitions the embeddings into. If
+    // 0, or if the index has fewer embeddings, the search is exhaustive.
+    int num_partitions = 0;
+    // The number of clusters closest to the query that are scanned.
+    int num_probes = 1;
+    // The number of k-means iterations run by Build().
+    int num_iterations = 10;
+  };
+
+  struct SearchResult {
+    // The id the embedding was added with.
+    int64_t id;
+    // The cosine similarity between the query and the embedding.
+    float similarity;
+  };
+
+  EmbeddingIndex();
+  explicit EmbeddingIndex(Options options);
+
+  // Adds an embedding with the given id. Ids are not required to be unique.
+  // Returns an error if the embedding has a zero norm, or doesn't match the
+  // size or type of the embeddings already added.
+  absl::Status Add(int64_t id, const containers::Embedding& embedding);
+
+  // Partitions the embeddings added so far according to the options.
+  // Embeddings added afterwards are assigned to the existing clusters.
+  absl::Status Build();
+
+  // Returns the (up to) `k` embeddings most similar to `query`, by decreasing
+  // similarity.
+  absl::StatusOr<std::vector<SearchResult>> Search(
+      const containers::Embedding& query, int k) const;
+
+  // Searches the `k` most similar embeddings of each query.
+  absl::StatusOr<std::vector<std::vector<SearchResult>>> SearchBatch(
+      const std::vector<containers::Embedding>& queries, int k) const;
+
+  // The number of embeddings in the index.
+  int size() const { return ids_.size(); }
+
+ private:
+  // Checks that the embedding matches the index, and returns it as a
+  // normalized float vector, or as an int8 vector with its inverse norm.
+  absl::Status Prepare(const containers::Embedding& embedding,
+                       std::vector<float>* float_values,
+                       std::vector<int8_t>* quantized_values,
+                       float* inverse_norm) const;
+
+  // Returns the similarity between a prepared query and embedding `index`.
+  float Similarity(const std::vector<float>& float_query,
+                   const std::vector<int8_t>& quantized_query,
+                   float query_inverse_norm, int index) const;
+
+  // Returns the offset of embedding `index` in the contiguous values.
+  size_t Offset(int index) const {
+    return static_cast<size_t>(index) * dimension_;
+  }
+
+  // Returns the embedding `index` as a normalized float vector.
+  std::vector<float> Normalized(int index) const;
+
+  // Returns the cluster whose centroid is closest to `values`.
+  int NearestPartition(const std::vector<float>& values) const;
+
+  const Options options_;
+  int dimension_ = 0;
+  bool quantized_ = false;
+  std::vector<int64_t> ids_;
+  // The normalized float embeddings, or the int8 embeddings and their inverse
+  // norms, laid out contiguously.
+  std::vector<float> float_values_;
+  std::vector<int8_t> quantized_values_;
+  std::vector<float> inverse_norms_;
+  // The normalized cluster centroids, laid out contiguously, and the
+  // embeddings of each cluster. Empty unless Build() partitioned the index.
+  std::vector<float> centroids_;
+  std::vector<std::vector<int>> partitions_;
+};
+
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_COMPONENTS_UTILS_EMBEDDING_INDEX_H_
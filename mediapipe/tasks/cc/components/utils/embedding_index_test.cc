@@ -0,0 +1,150 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/components/utils/embedding_index.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/tasks/cc/components/containers/embedding_result.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace components {
+namespace utils {
+namespace {
+
+using ::mediapipe::tasks::components::containers::Embedding;
+using ::testing::HasSubstr;
+
+Embedding BuildFloatEmbedding(std::vector<float> values) {
+  Embedding embedding;
+  embedding.float_embedding = values;
+  return embedding;
+}
+
+Embedding BuildQuantizedEmbedding(std::vector<int8_t> values) {
+  Embedding embedding;
+  uint8_t* data = reinterpret_cast<uint8_t*>(values.data());
+  embedding.quantized_embedding = {data, data + values.size()};
+  return embedding;
+}
+
+// Returns a unit embedding at the given angle.
+Embedding BuildAngleEmbedding(float angle) {
+  return BuildFloatEmbedding({std::cos(angle), std::sin(angle)});
+}
+
+TEST(EmbeddingIndex, SearchesMostSimilarFloatEmbeddings) {
+  EmbeddingIndex index;
+  MP_ASSERT_OK(index.Add(1, BuildFloatEmbedding({1.0, 0.0, 0.0})));
+  MP_ASSERT_OK(index.Add(2, BuildFloatEmbedding({0.0, 2.0, 0.0})));
+  MP_ASSERT_OK(index.Add(3, BuildFloatEmbedding({1.0, 1.0, 0.0})));
+
+  MP_ASSERT_OK_AND_ASSIGN(auto results,
+                          index.Search(BuildFloatEmbedding({0.0, 3.0, 0.1}),
+                                       /*k=*/2));
+
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].id, 2);
+  EXPECT_NEAR(results[0].similarity, 0.99944, 1e-4);
+  EXPECT_EQ(results[1].id, 3);
+  EXPECT_NEAR(results[1].similarity, 0.70671, 1e-4);
+}
+
+TEST(EmbeddingIndex, SearchesMostSimilarQuantizedEmbeddings) {
+  EmbeddingIndex index;
+  MP_ASSERT_OK(index.Add(1, BuildQuantizedEmbedding({127, 0})));
+  MP_ASSERT_OK(index.Add(2, BuildQuantizedEmbedding({0, -128})));
+  MP_ASSERT_OK(index.Add(3, BuildQuantizedEmbedding({-100, -100})));
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto results, index.Search(BuildQuantizedEmbedding({-1, -1}), /*k=*/5));
+
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(results[0].id, 3);
+  EXPECT_NEAR(results[0].similarity, 1.0, 1e-5);
+  EXPECT_EQ(results[1].id, 2);
+  EXPECT_NEAR(results[1].similarity, std::sqrt(0.5), 1e-5);
+  EXPECT_EQ(results[2].id, 1);
+  EXPECT_NEAR(results[2].similarity, -std::sqrt(0.5), 1e-5);
+}
+
+TEST(EmbeddingIndex, SearchesBatch) {
+  EmbeddingIndex index;
+  for (int i = 0; i < 8; ++i) {
+    MP_ASSERT_OK(index.Add(i, BuildAngleEmbedding(i * M_PI / 4)));
+  }
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto results,
+      index.SearchBatch({BuildAngleEmbedding(0.1), BuildAngleEmbedding(3.1)},
+                        /*k=*/1));
+
+  ASSERT_EQ(results.size(), 2);
+  ASSERT_EQ(results[0].size(), 1);
+  EXPECT_EQ(results[0][0].id, 0);
+  ASSERT_EQ(results[1].size(), 1);
+  EXPECT_EQ(results[1][0].id, 4);
+}
+
+TEST(EmbeddingIndex, SearchesPartitionedIndex) {
+  EmbeddingIndex::Options options;
+  options.num_partitions = 4;
+  options.num_probes = 1;
+  EmbeddingIndex index(options);
+  for (int i = 0; i < 64; ++i) {
+    MP_ASSERT_OK(index.Add(i, BuildAngleEmbedding(i * M_PI / 32)));
+  }
+  MP_ASSERT_OK(index.Build());
+  // Assigned to the existing partitions.
+  MP_ASSERT_OK(index.Add(64, BuildAngleEmbedding(0.05)));
+
+  MP_ASSERT_OK_AND_ASSIGN(auto results,
+                          index.Search(BuildAngleEmbedding(0.04), /*k=*/2));
+
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].id, 64);
+  EXPECT_EQ(results[1].id, 0);
+}
+
+TEST(EmbeddingIndex, FailsWithMismatchingEmbeddings) {
+  EmbeddingIndex index;
+  MP_ASSERT_OK(index.Add(1, BuildFloatEmbedding({0.1, 0.2})));
+
+  auto status = index.Add(2, BuildFloatEmbedding({0.1, 0.2, 0.3}));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(),
+              HasSubstr("Embedding size doesn't match the index"));
+
+  status = index.Search(BuildQuantizedEmbedding({1, 2}), /*k=*/1).status();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(),
+              HasSubstr("Cannot mix quantized and float embeddings"));
+
+  status = index.Add(3, BuildFloatEmbedding({0.0, 0.0}));
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(status.message(), HasSubstr("0 norm"));
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace components
+}  // namespace tasks
+}  // namespace mediapipe
@@ -50,6 +50,15 @@ proto::BaseOptions ConvertBaseOptionsToProto(BaseOptions* base_options) {
           base_options->model_asset_descriptor_meta.offset);
     }
   }
+  base_options_proto.set_share_model(base_options->share_model);
+  base_options_proto.set_load_model_asynchronously(
+      base_options->load_model_asynchronously);
+  base_options_proto.set_warm_up(base_options->warm_up);
+  base_options_proto.set_share_preprocessing(
+      base_options->share_preprocessing);
+  base_options_proto.set_enable_profiler(base_options->enable_profiler);
+  base_options_proto.set_inference_batch_size(
+      base_options->inference_batch_size);
   switch (base_options->delegate) {
     case BaseOptions::Delegate::CPU:
       base_options_proto.mutable_acceleration()->mutable_tflite();
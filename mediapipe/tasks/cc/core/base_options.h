@@ -65,6 +65,32 @@ struct BaseOptions {
   // built-in Ops.
   std::unique_ptr<tflite::OpResolver> op_resolver =
       absl::make_unique<MediaPipeBuiltinOpResolver>();
+
+  // Whether the model is shared with the other tasks in the process that run
+  // a model with the same contents, instead of being loaded by every task.
+  bool share_model = false;
+
+  // Whether the task is returned before its models are loaded. The first call
+  // that processes data then waits for them to be loaded.
+  bool load_model_asynchronously = false;
+
+  // Whether the models run once on zero-filled inputs when they are loaded, so
+  // that the first data processed runs at the steady-state latency.
+  bool warm_up = false;
+
+  // Whether the input image is converted to a tensor once for all the tasks
+  // in the process that set this option and need the same conversion of the
+  // same image, e.g. several tasks run on one camera frame.
+  bool share_preprocessing = false;
+
+  // Whether the runtimes of the calculators of the task graph are profiled,
+  // for the task to report them in GetCalculatorProfiles().
+  bool enable_profiler = false;
+
+  // The number of model inputs that run as one batched inference, for tasks
+  // that process many inputs at once. Requires a model whose inputs have a
+  // leading batch dimension of size 1.
+  int inference_batch_size = 1;
 };
 
 // Converts a BaseOptions to a BaseOptionsProto.
@@ -20,6 +20,13 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/core/task_runner.h"
 
 namespace mediapipe {
@@ -36,7 +43,62 @@ class BaseTaskApi {
   BaseTaskApi(const BaseTaskApi&) = delete;
   BaseTaskApi& operator=(const BaseTaskApi&) = delete;
 
+  // Returns the runtime profiles of the calculators of the task graph, e.g.
+  // for benchmarking. They are empty unless `enable_profiler` is set in the
+  // BaseOptions of the task.
+  absl::StatusOr<std::vector<CalculatorProfile>> GetCalculatorProfiles() {
+    return runner_->GetCalculatorProfiles();
+  }
+
  protected:
+  // A synchronous method to process a batch of independent inputs.
+  // All the inputs are sent to the graph without waiting for the previous
+  // ones to complete, so that e.g. the preprocessing of an input overlaps with
+  // the inference on the previous one. The call blocks the current thread
+  // until all the results are available, which are returned in input order,
+  // or the first failure status.
+  absl::StatusOr<std::vector<PacketMap>> ProcessBatch(
+      std::vector<PacketMap> inputs) {
+    // Shared with the callbacks, which run on graph threads.
+    struct BatchState {
+      absl::Mutex mutex;
+      std::vector<PacketMap> outputs ABSL_GUARDED_BY(mutex);
+      absl::Status status ABSL_GUARDED_BY(mutex);
+      int num_completed ABSL_GUARDED_BY(mutex) = 0;
+    };
+    auto state = std::make_shared<BatchState>();
+    {
+      absl::MutexLock lock(&state->mutex);
+      state->outputs.resize(inputs.size());
+    }
+    absl::Status status;
+    for (int i = 0; i < inputs.size() && status.ok(); ++i) {
+      status = runner_->ProcessAsync(
+          std::move(inputs[i]),
+          [state, i](absl::StatusOr<PacketMap> status_or_packets) {
+            absl::MutexLock lock(&state->mutex);
+            ++state->num_completed;
+            if (status_or_packets.ok()) {
+              state->outputs[i] = std::move(status_or_packets).value();
+            } else {
+              state->status.Update(status_or_packets.status());
+            }
+          });
+    }
+    // Waits for the requests that were sent, even if a later one failed.
+    status.Update(runner_->WaitForPendingRequests());
+    absl::MutexLock lock(&state->mutex);
+    status.Update(state->status);
+    MP_RETURN_IF_ERROR(status);
+    if (state->num_completed != state->outputs.size()) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInternal,
+          "The graph went idle before completing the batch.",
+          MediaPipeTasksStatus::kRunnerUnexpectedOutputError);
+    }
+    return std::move(state->outputs);
+  }
+
   // The task runner of the task api.
   std::unique_ptr<TaskRunner> runner_;
 };
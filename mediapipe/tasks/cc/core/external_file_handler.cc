@@ -37,11 +37,13 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
+#include "mediapipe/util/resource_util.h"
 
 namespace mediapipe {
 namespace tasks {
@@ -114,13 +116,30 @@ absl::Status ExternalFileHandler::MapExternalFile() {
         "'file_name', 'file_pointer_meta' or 'file_descriptor_meta'.",
         MediaPipeTasksStatus::kInvalidArgumentError);
   }
+  std::string file_name = external_file_.file_name();
+#ifdef __ANDROID__
+  if (!file_name.empty() && !absl::StartsWith(file_name, "/")) {
+    // Maps the asset from the APK instead of copying it to the cache directory
+    // to open it as a file.
+    auto resource = GetResource(file_name);
+    if (resource.ok()) {
+      resource_ = *std::move(resource);
+      return SetResourceContent();
+    }
+    // Falls back to the other locations searched by PathToResourceAsFile.
+    auto path_to_resource = PathToResourceAsFile(file_name);
+    if (path_to_resource.ok()) {
+      file_name = *path_to_resource;
+    }
+  }
+#endif
   // Obtain file descriptor, offset and size.
   int fd = -1;
-  if (!external_file_.file_name().empty()) {
-    owned_fd_ = open(external_file_.file_name().c_str(), O_RDONLY);
+  if (!file_name.empty()) {
+    owned_fd_ = open(file_name.c_str(), O_RDONLY);
     if (owned_fd_ < 0) {
-      const std::string error_message = absl::StrFormat(
-          "Unable to open file at %s", external_file_.file_name());
+      const std::string error_message =
+          absl::StrFormat("Unable to open file at %s", file_name);
       switch (errno) {
         case ENOENT:
           return CreateStatusWithPayload(
@@ -155,9 +174,10 @@ absl::Status ExternalFileHandler::MapExternalFile() {
           absl::StrFormat("Provided file descriptor is invalid: %d < 0", fd),
           MediaPipeTasksStatus::kInvalidArgumentError);
     }
-    buffer_offset_ = external_file_.file_descriptor_meta().offset();
-    buffer_size_ = external_file_.file_descriptor_meta().length();
   }
+  // The region of the file to map, also for a file given by name.
+  buffer_offset_ = external_file_.file_descriptor_meta().offset();
+  buffer_size_ = external_file_.file_descriptor_meta().length();
   // Get actual file size. Always use 0 as offset to lseek(2) to get the actual
   // file size, as SEEK_END returns the size of the file *plus* offset.
   size_t file_size = lseek(fd, /*offset=*/0, SEEK_END);
@@ -206,9 +226,39 @@ absl::Status ExternalFileHandler::MapExternalFile() {
 #endif
 }
 
+absl::Status ExternalFileHandler::SetResourceContent() {
+  const absl::string_view content = resource_->data();
+  const int64 content_size = content.size();
+  const int64 offset = external_file_.file_descriptor_meta().offset();
+  int64 length = external_file_.file_descriptor_meta().length();
+  if (offset < 0 || content_size <= offset) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Provided file offset (%d) exceeds or matches actual "
+                        "file length (%d)",
+                        offset, content_size),
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  if (length <= 0) {
+    length = content_size - offset;
+  }
+  if (content_size < offset + length) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Provided file length + offset (%d) exceeds actual "
+                        "file length (%d)",
+                        offset + length, content_size),
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  resource_content_ = content.substr(offset, length);
+  return absl::OkStatus();
+}
+
 absl::string_view ExternalFileHandler::GetFileContent() {
   if (!external_file_.file_content().empty()) {
     return external_file_.file_content();
+  } else if (resource_ != nullptr) {
+    return resource_content_;
   } else if (external_file_.has_file_pointer_meta()) {
     void* ptr =
         reinterpret_cast<void*>(external_file_.file_pointer_meta().pointer());
@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
+#include "mediapipe/util/resource_util.h"
 
 namespace mediapipe {
 namespace tasks {
@@ -33,6 +34,9 @@ namespace core {
 // proto fields) of opening and/or mapping the file in memory at creation time,
 // as well as closing and/or unmapping at destruction time.
 //
+// On Android, a relative file name refers to an asset, which is mapped from
+// the APK with GetResource() rather than copied to a file.
+//
 // [1]: support/c/task/core/proto/external_file.proto
 class ExternalFileHandler {
  public:
@@ -62,9 +66,19 @@ class ExternalFileHandler {
   // contents are already loaded in memory.
   absl::Status MapExternalFile();
 
+  // Keeps the region of resource_ given by the file descriptor meta of the
+  // ExternalFile as the file content.
+  absl::Status SetResourceContent();
+
   // Reference to the input ExternalFile.
   const proto::ExternalFile& external_file_;
 
+  // The resource the ExternalFile was loaded from, if it is provided by a
+  // file name that doesn't name a file, e.g. an Android asset.
+  std::unique_ptr<Resource> resource_;
+  // The region of resource_ that is the content of the ExternalFile.
+  absl::string_view resource_content_;
+
   // The file descriptor of the ExternalFile if provided by path, as it is
   // opened and owned by this class. Set to -1 otherwise.
   int owned_fd_{-1};
@@ -57,6 +57,9 @@ ModelAssetBundleResources::Create(
 
 absl::Status
 ModelAssetBundleResources::ExtractModelFilesFromExternalFileProto() {
+#ifndef __ANDROID__
+  // On Android, ExternalFileHandler maps the asset a relative path names
+  // instead.
   if (model_asset_bundle_file_->has_file_name()) {
     // If the model asset bundle file name is a relative path, searches the file
     // in a platform-specific location and returns the absolute path on success.
@@ -65,6 +68,7 @@ ModelAssetBundleResources::ExtractModelFilesFromExternalFileProto() {
         mediapipe::PathToResourceAsFile(model_asset_bundle_file_->file_name()));
     model_asset_bundle_file_->set_file_name(path_to_resource);
   }
+#endif  // !__ANDROID__
   ASSIGN_OR_RETURN(model_asset_bundle_file_handler_,
                    ExternalFileHandler::CreateFromExternalFile(
                        model_asset_bundle_file_.get()));
@@ -94,6 +98,29 @@ absl::StatusOr<absl::string_view> ModelAssetBundleResources::GetModelFile(
   return it->second;
 }
 
+absl::Status ModelAssetBundleResources::SetModelExternalFile(
+    const std::string& filename, proto::ExternalFile* model_file,
+    bool is_copy) const {
+  ASSIGN_OR_RETURN(absl::string_view model_file_content,
+                   GetModelFile(filename));
+  // The file contents take precedence over the file name.
+  if (!is_copy || !model_asset_bundle_file_->file_content().empty() ||
+      !model_asset_bundle_file_->has_file_name()) {
+    metadata::SetExternalFile(model_file_content, model_file, is_copy);
+    return absl::OkStatus();
+  }
+  // The model files are stored uncompressed, at their offset in the bundle.
+  const absl::string_view bundle_content =
+      model_asset_bundle_file_handler_->GetFileContent();
+  model_file->set_file_name(model_asset_bundle_file_->file_name());
+  auto* file_region = model_file->mutable_file_descriptor_meta();
+  file_region->set_offset(
+      model_asset_bundle_file_->file_descriptor_meta().offset() +
+      (model_file_content.data() - bundle_content.data()));
+  file_region->set_length(model_file_content.size());
+  return absl::OkStatus();
+}
+
 std::vector<std::string> ModelAssetBundleResources::ListModelFiles() const {
   std::vector<std::string> model_names;
   for (const auto& [model_name, _] : model_files_) {
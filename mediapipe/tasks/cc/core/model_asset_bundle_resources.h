@@ -56,6 +56,16 @@ class ModelAssetBundleResources {
   absl::StatusOr<absl::string_view> GetModelFile(
       const std::string& filename) const;
 
+  // Sets `model_file` to the model file with the provided name. By default,
+  // `model_file` points to the model file in memory, so this object must
+  // outlive it. With `is_copy`, `model_file` stays valid on its own: if the
+  // model asset bundle is given by file name, `model_file` refers to the
+  // region of that file storing the model file, which is mapped rather than
+  // copied; otherwise the contents of the model file are copied into it.
+  absl::Status SetModelExternalFile(const std::string& filename,
+                                    proto::ExternalFile* model_file,
+                                    bool is_copy = false) const;
+
   // Lists all the model file names in the model asset model.
   std::vector<std::string> ListModelFiles() const;
 
@@ -209,6 +209,46 @@ TEST(ModelAssetBundleResourcesTest, ExtractInvalidModelFile) {
                   absl::StrCat(MediaPipeTasksStatus::kFileNotFoundError))));
 }
 
+TEST(ModelAssetBundleResourcesTest, SetModelExternalFileFromFileRegion) {
+  auto model_file = std::make_unique<proto::ExternalFile>();
+  model_file->set_file_name(kTestModelBundlePath);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto model_bundle_resources,
+      ModelAssetBundleResources::Create(kTestModelBundleResourcesTag,
+                                        std::move(model_file)));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto hand_landmarker_file_content,
+      model_bundle_resources->GetModelFile("dummy_hand_landmarker.task"));
+  const std::string expected_content(hand_landmarker_file_content);
+  auto hand_landmarker_model_file = std::make_unique<proto::ExternalFile>();
+  MP_ASSERT_OK(model_bundle_resources->SetModelExternalFile(
+      "dummy_hand_landmarker.task", hand_landmarker_model_file.get(),
+      /*is_copy=*/true));
+  // The model file refers to its region of the bundle file.
+  EXPECT_FALSE(hand_landmarker_model_file->has_file_content());
+  EXPECT_FALSE(hand_landmarker_model_file->file_name().empty());
+  EXPECT_EQ(hand_landmarker_model_file->file_descriptor_meta().length(),
+            static_cast<int64_t>(expected_content.size()));
+  model_bundle_resources.reset();
+
+  // The region of a nested bundle file is offset by the nested bundle offset.
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto hand_landmarker_model_bundle_resources,
+      ModelAssetBundleResources::Create(kTestModelBundleResourcesTag,
+                                        std::move(hand_landmarker_model_file)));
+  auto hand_detector_model_file = std::make_unique<proto::ExternalFile>();
+  MP_ASSERT_OK(hand_landmarker_model_bundle_resources->SetModelExternalFile(
+      "dummy_hand_detector.tflite", hand_detector_model_file.get(),
+      /*is_copy=*/true));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto hand_detector_model_resources,
+      ModelResources::Create(kTestModelResourcesTag,
+                             std::move(hand_detector_model_file)));
+  Packet model_packet = hand_detector_model_resources->GetModelPacket();
+  ASSERT_FALSE(model_packet.IsEmpty());
+  EXPECT_TRUE(model_packet.Get<ModelResources::ModelPtr>()->initialized());
+}
+
 TEST(ModelAssetBundleResourcesTest, ListModelFiles) {
   // Creates top-level model asset bundle resources.
   auto model_file = std::make_unique<proto::ExternalFile>();
@@ -20,13 +20,18 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/core/external_file_handler.h"
@@ -56,11 +61,8 @@ bool ModelResources::Verifier::Verify(const char* data, int length,
 }
 
 ModelResources::ModelResources(const std::string& tag,
-                               std::unique_ptr<proto::ExternalFile> model_file,
                                Packet<tflite::OpResolver> op_resolver_packet)
-    : tag_(tag),
-      model_file_(std::move(model_file)),
-      op_resolver_packet_(op_resolver_packet) {}
+    : tag_(tag), op_resolver_packet_(op_resolver_packet) {}
 
 /* static */
 absl::StatusOr<std::unique_ptr<ModelResources>> ModelResources::Create(
@@ -73,7 +75,7 @@ absl::StatusOr<std::unique_ptr<ModelResources>> ModelResources::Create(
 /* static */
 absl::StatusOr<std::unique_ptr<ModelResources>> ModelResources::Create(
     const std::string& tag, std::unique_ptr<proto::ExternalFile> model_file,
-    Packet<tflite::OpResolver> op_resolver_packet) {
+    Packet<tflite::OpResolver> op_resolver_packet, bool share_model) {
   if (model_file == nullptr) {
     return CreateStatusWithPayload(StatusCode::kInvalidArgument,
                                    "The model file proto cannot be nullptr.",
@@ -84,59 +86,99 @@ absl::StatusOr<std::unique_ptr<ModelResources>> ModelResources::Create(
                                    "The op resolver packet must be non-empty.",
                                    MediaPipeTasksStatus::kInvalidArgumentError);
   }
-  auto model_resources = absl::WrapUnique(
-      new ModelResources(tag, std::move(model_file), op_resolver_packet));
-  MP_RETURN_IF_ERROR(model_resources->BuildModelFromExternalFileProto());
+  auto model_resources =
+      absl::WrapUnique(new ModelResources(tag, op_resolver_packet));
+  MP_RETURN_IF_ERROR(model_resources->BuildModelFromExternalFileProto(
+      std::move(model_file), share_model));
   return model_resources;
 }
 
 const tflite::Model* ModelResources::GetTfLiteModel() const {
 #if !TFLITE_IN_GMSCORE
-  return model_packet_.Get()->GetModel();
+  return model_->model_packet.Get()->GetModel();
 #else
-  return tflite::GetModel(model_file_handler_->GetFileContent().data());
+  return tflite::GetModel(model_->model_file_handler->GetFileContent().data());
 #endif
 }
 
-absl::Status ModelResources::BuildModelFromExternalFileProto() {
-  if (model_file_->has_file_name()) {
+absl::Status ModelResources::BuildModelFromExternalFileProto(
+    std::unique_ptr<proto::ExternalFile> model_file, bool share_model) {
+  if (model_file->has_file_name()) {
     if (HasCustomGlobalResourceProvider()) {
       // If the model contents are provided via a custom ResourceProviderFn, the
       // open() method may not work. Thus, loads the model content from the
       // model file path in advance with the help of GetResourceContents.
       MP_RETURN_IF_ERROR(GetResourceContents(
-          model_file_->file_name(), model_file_->mutable_file_content()));
-      model_file_->clear_file_name();
+          model_file->file_name(), model_file->mutable_file_content()));
+      model_file->clear_file_name();
+      if (model_file->has_file_descriptor_meta()) {
+        // Keeps the region of the file storing the model, as for a model file
+        // of a model asset bundle.
+        const auto& file_region = model_file->file_descriptor_meta();
+        std::string& content = *model_file->mutable_file_content();
+        const int64_t size = content.size();
+        RET_CHECK(file_region.offset() >= 0 && file_region.offset() < size);
+        content.erase(0, file_region.offset());
+        if (file_region.length() > 0) {
+          RET_CHECK_LE(file_region.length(), size - file_region.offset());
+          content.resize(file_region.length());
+        }
+        model_file->clear_file_descriptor_meta();
+      }
     } else {
+#ifndef __ANDROID__
       // If the model file name is a relative path, searches the file in a
       // platform-specific location and returns the absolute path on success.
+      // On Android, ExternalFileHandler maps the asset the relative path names
+      // instead.
       ASSIGN_OR_RETURN(std::string path_to_resource,
-                       PathToResourceAsFile(model_file_->file_name()));
-      model_file_->set_file_name(path_to_resource);
+                       PathToResourceAsFile(model_file->file_name()));
+      model_file->set_file_name(path_to_resource);
+#endif  // !__ANDROID__
     }
   }
+  auto model = std::make_unique<Model>();
+  model->model_file = std::move(model_file);
   ASSIGN_OR_RETURN(
-      model_file_handler_,
-      ExternalFileHandler::CreateFromExternalFile(model_file_.get()));
-  const char* buffer_data = model_file_handler_->GetFileContent().data();
-  size_t buffer_size = model_file_handler_->GetFileContent().size();
+      model->model_file_handler,
+      ExternalFileHandler::CreateFromExternalFile(model->model_file.get()));
+  if (share_model) {
+    // If the contents are shared already, this copy of the file is released.
+    model_ = FindSharedModel(model->model_file_handler->GetFileContent());
+    if (model_ != nullptr) {
+      return absl::OkStatus();
+    }
+  }
+  MP_RETURN_IF_ERROR(BuildModel(*model));
+  model_ = std::move(model);
+  if (share_model) {
+    model_ = AddSharedModel(std::move(model_));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ModelResources::BuildModel(Model& model) {
+  const char* buffer_data = model.model_file_handler->GetFileContent().data();
+  size_t buffer_size = model.model_file_handler->GetFileContent().size();
   // Verifies that the supplied buffer refers to a valid flatbuffer model,
   // and that it uses only operators that are supported by the OpResolver
   // that was passed to the ModelResources constructor, and then builds
   // the model from the buffer.
-  auto model = tflite_shims::FlatBufferModel::VerifyAndBuildFromBuffer(
-      buffer_data, buffer_size, &verifier_, &error_reporter_);
-  if (model == nullptr) {
+  auto tflite_model = tflite_shims::FlatBufferModel::VerifyAndBuildFromBuffer(
+      buffer_data, buffer_size, &verifier_, &model.error_reporter);
+  if (tflite_model == nullptr) {
+    mediapipe::util::tflite::ErrorReporter& error_reporter =
+        model.error_reporter;
     static constexpr char kInvalidFlatbufferMessage[] =
         "The model is not a valid Flatbuffer";
     // To be replaced with a proper switch-case when TFLite model builder
     // returns a `MediaPipeTasksStatus` code capturing this type of error.
-    if (absl::StrContains(error_reporter_.message(),
+    if (absl::StrContains(error_reporter.message(),
                           kInvalidFlatbufferMessage)) {
       return CreateStatusWithPayload(
-          StatusCode::kInvalidArgument, error_reporter_.message(),
+          StatusCode::kInvalidArgument, error_reporter.message(),
           MediaPipeTasksStatus::kInvalidFlatBufferError);
-    } else if (absl::StrContains(error_reporter_.message(),
+    } else if (absl::StrContains(error_reporter.message(),
                                  "Error loading model from buffer")) {
       return CreateStatusWithPayload(
           StatusCode::kInvalidArgument, kInvalidFlatbufferMessage,
@@ -146,21 +188,88 @@ absl::Status ModelResources::BuildModelFromExternalFileProto() {
           StatusCode::kUnknown,
           absl::StrCat(
               "Could not build model from the provided pre-loaded flatbuffer: ",
-              error_reporter_.message()));
+              error_reporter.message()));
     }
   }
 
-  model_packet_ = MakePacket<ModelPtr>(
-      model.release(),
+  model.model_packet = MakePacket<ModelPtr>(
+      tflite_model.release(),
       [](tflite_shims::FlatBufferModel* model) { delete model; });
   ASSIGN_OR_RETURN(auto model_metadata_extractor,
                    metadata::ModelMetadataExtractor::CreateFromModelBuffer(
                        buffer_data, buffer_size));
-  metadata_extractor_packet_ = PacketAdopting<metadata::ModelMetadataExtractor>(
-      std::move(model_metadata_extractor));
+  model.metadata_extractor_packet =
+      PacketAdopting<metadata::ModelMetadataExtractor>(
+          std::move(model_metadata_extractor));
   return absl::OkStatus();
 }
 
+namespace {
+
+// The models shared by ModelResources across the process, by the hash of the
+// model file contents. Entries expire with the last ModelResources using the
+// model.
+template <typename Model>
+struct SharedModels {
+  absl::Mutex mutex;
+  absl::flat_hash_map<size_t, std::weak_ptr<const Model>> models
+      ABSL_GUARDED_BY(mutex);
+};
+
+template <typename Model>
+SharedModels<Model>& GetSharedModels() {
+  static NoDestructor<SharedModels<Model>> shared_models;
+  return *shared_models;
+}
+
+size_t HashFileContent(absl::string_view file_content) {
+  return absl::Hash<absl::string_view>()(file_content);
+}
+
+}  // namespace
+
+/* static */
+std::shared_ptr<const ModelResources::Model> ModelResources::FindSharedModel(
+    absl::string_view file_content) {
+  auto& shared_models = GetSharedModels<Model>();
+  absl::MutexLock lock(&shared_models.mutex);
+  auto it = shared_models.models.find(HashFileContent(file_content));
+  if (it == shared_models.models.end()) return nullptr;
+  std::shared_ptr<const Model> model = it->second.lock();
+  // Compares the contents, to not share the model on a hash collision.
+  if (model == nullptr ||
+      model->model_file_handler->GetFileContent() != file_content) {
+    return nullptr;
+  }
+  return model;
+}
+
+/* static */
+std::shared_ptr<const ModelResources::Model> ModelResources::AddSharedModel(
+    std::shared_ptr<const Model> model) {
+  auto& shared_models = GetSharedModels<Model>();
+  absl::MutexLock lock(&shared_models.mutex);
+  absl::erase_if(shared_models.models, [](const auto& entry) {
+    return entry.second.expired();
+  });
+  const absl::string_view file_content =
+      model->model_file_handler->GetFileContent();
+  auto [it, inserted] =
+      shared_models.models.try_emplace(HashFileContent(file_content), model);
+  if (inserted) return model;
+  // Another ModelResources shared a model with the same hash meanwhile, which
+  // may have expired since.
+  std::shared_ptr<const Model> shared_model = it->second.lock();
+  if (shared_model == nullptr) {
+    it->second = model;
+    return model;
+  }
+  if (shared_model->model_file_handler->GetFileContent() == file_content) {
+    return shared_model;
+  }
+  return model;
+}
+
 }  // namespace core
 }  // namespace tasks
 }  // namespace mediapipe
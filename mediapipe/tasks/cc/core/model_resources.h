@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/core/external_file_handler.h"
@@ -69,9 +70,17 @@ class ModelResources {
   // ModelResourcesCacheService. The op resolver packet, usually prvoided by a
   // ModelResourcesCacheService object, contains the TFLite op resolvers
   // required by the model.
+  //
+  // If share_model is true, the flatbuffer model, the model metadata extractor
+  // and the model file are shared, process-wide, with all other
+  // ModelResources created with share_model from a file with the same
+  // contents, e.g. by the task instances of multiple graphs running the same
+  // model. The shared resources are released with the last ModelResources
+  // using them.
   static absl::StatusOr<std::unique_ptr<ModelResources>> Create(
       const std::string& tag, std::unique_ptr<proto::ExternalFile> model_file,
-      api2::Packet<tflite::OpResolver> op_resolver_packet);
+      api2::Packet<tflite::OpResolver> op_resolver_packet,
+      bool share_model = false);
 
   // ModelResources is neither copyable nor movable.
   ModelResources(const ModelResources&) = delete;
@@ -80,19 +89,22 @@ class ModelResources {
   // Returns the model resources tag.
   std::string GetTag() const { return tag_; }
 
-  // Returns a copy of the model file proto.
-  proto::ExternalFile GetModelFile() const { return *model_file_; }
+  // Returns a copy of the model file proto. For a shared model, this is the
+  // file that the model was first built from, which has the same contents.
+  proto::ExternalFile GetModelFile() const { return *model_->model_file; }
 
   // Returns a pointer to tflite::model.
   const tflite::Model* GetTfLiteModel() const;
 
   // Returns a const pointer to the model metadata extractor.
   const metadata::ModelMetadataExtractor* GetMetadataExtractor() const {
-    return &metadata_extractor_packet_.Get();
+    return &model_->metadata_extractor_packet.Get();
   }
 
   // Returns a shallow copy of the TFLite model packet.
-  api2::Packet<ModelPtr> GetModelPacket() const { return model_packet_; }
+  api2::Packet<ModelPtr> GetModelPacket() const {
+    return model_->model_packet;
+  }
 
   // Returns a shallow copy of the TFLite op reslover packet.
   api2::Packet<tflite::OpResolver> GetOpResolverPacket() const {
@@ -102,7 +114,7 @@ class ModelResources {
   // Returns a shallow copy of the model metadata extractor packet.
   api2::Packet<metadata::ModelMetadataExtractor> GetMetadataExtractorPacket()
       const {
-    return metadata_extractor_packet_;
+    return model_->metadata_extractor_packet;
   }
 
  private:
@@ -114,33 +126,54 @@ class ModelResources {
                 tflite::ErrorReporter* reporter) override;
   };
 
+  // The model file and the resources built from it, which may be shared by
+  // several ModelResources.
+  struct Model {
+    // The model file.
+    std::unique_ptr<proto::ExternalFile> model_file;
+    // The ExternalFileHandler for the model.
+    std::unique_ptr<ExternalFileHandler> model_file_handler;
+    // The packet stores the TFLite model for actual inference.
+    api2::Packet<ModelPtr> model_packet;
+    // The packet stores the TFLite Metadata extractor built from the model.
+    api2::Packet<metadata::ModelMetadataExtractor> metadata_extractor_packet;
+    // Error reporter that captures and prints to stderr low-level TFLite
+    // error messages.
+    mediapipe::util::tflite::ErrorReporter error_reporter;
+  };
+
   // Constructor.
   ModelResources(const std::string& tag,
-                 std::unique_ptr<proto::ExternalFile> model_file,
                  api2::Packet<tflite::OpResolver> op_resolver_packet);
 
-  // Builds the TFLite model from the ExternalFile proto.
-  absl::Status BuildModelFromExternalFileProto();
+  // Builds the TFLite model from the ExternalFile proto, or looks up the
+  // shared model with the same contents if share_model is true.
+  absl::Status BuildModelFromExternalFileProto(
+      std::unique_ptr<proto::ExternalFile> model_file, bool share_model);
+
+  // Builds the TFLite model and the metadata extractor of the model, whose
+  // file handler is already created.
+  absl::Status BuildModel(Model& model);
+
+  // Returns the shared model built from a file with the given contents, or
+  // nullptr if there is none.
+  static std::shared_ptr<const Model> FindSharedModel(
+      absl::string_view file_content);
+
+  // Shares the model, or returns the model shared meanwhile by another
+  // ModelResources for the same contents.
+  static std::shared_ptr<const Model> AddSharedModel(
+      std::shared_ptr<const Model> model);
 
   // The model resources tag.
   const std::string tag_;
-  // The model file.
-  std::unique_ptr<proto::ExternalFile> model_file_;
   // The packet stores the TFLite op resolver.
   api2::Packet<tflite::OpResolver> op_resolver_packet_;
-
-  // The ExternalFileHandler for the model.
-  std::unique_ptr<ExternalFileHandler> model_file_handler_;
-  // The packet stores the TFLite model for actual inference.
-  api2::Packet<ModelPtr> model_packet_;
-  // The packet stores the TFLite Metadata extractor built from the model.
-  api2::Packet<metadata::ModelMetadataExtractor> metadata_extractor_packet_;
+  // The model, owned or shared.
+  std::shared_ptr<const Model> model_;
 
   // Extra verifier for FlatBuffer input data.
   Verifier verifier_;
-  // Error reporter that captures and prints to stderr low-level TFLite
-  // error messages.
-  mediapipe::util::tflite::ErrorReporter error_reporter_;
 };
 
 }  // namespace core
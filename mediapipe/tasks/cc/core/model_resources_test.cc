@@ -283,6 +283,49 @@ TEST_F(ModelResourcesTest, CreateSuccessWithCustomOpsPacket) {
                                ->custom_name);
 }
 
+TEST_F(ModelResourcesTest, SharesModelWithSameContents) {
+  auto op_resolver_packet = api2::PacketAdopting<tflite::OpResolver>(
+      absl::make_unique<tflite_shims::ops::builtin::BuiltinOpResolver>());
+  auto model_file = std::make_unique<proto::ExternalFile>();
+  model_file->set_file_name(kTestModelPath);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto model_resources,
+      ModelResources::Create(kTestModelResourcesTag, std::move(model_file),
+                             op_resolver_packet, /*share_model=*/true));
+  CheckModelResourcesPackets(model_resources.get());
+
+  // The same contents, loaded from a buffer, share the model.
+  model_file = std::make_unique<proto::ExternalFile>();
+  model_file->set_file_content(LoadBinaryContent(kTestModelPath));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto shared_model_resources,
+      ModelResources::Create(kTestModelResourcesTag, std::move(model_file),
+                             op_resolver_packet, /*share_model=*/true));
+  CheckModelResourcesPackets(shared_model_resources.get());
+  EXPECT_EQ(shared_model_resources->GetModelPacket().Get().get(),
+            model_resources->GetModelPacket().Get().get());
+  EXPECT_EQ(shared_model_resources->GetMetadataExtractor(),
+            model_resources->GetMetadataExtractor());
+
+  // Models are not shared by default, or across different contents.
+  model_file = std::make_unique<proto::ExternalFile>();
+  model_file->set_file_name(kTestModelPath);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto unshared_model_resources,
+      ModelResources::Create(kTestModelResourcesTag, std::move(model_file),
+                             op_resolver_packet));
+  EXPECT_NE(unshared_model_resources->GetModelPacket().Get().get(),
+            model_resources->GetModelPacket().Get().get());
+  model_file = std::make_unique<proto::ExternalFile>();
+  model_file->set_file_name(kTestModelWithMetadataPath);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto other_model_resources,
+      ModelResources::Create(kTestModelResourcesTag, std::move(model_file),
+                             op_resolver_packet, /*share_model=*/true));
+  EXPECT_NE(other_model_resources->GetModelPacket().Get().get(),
+            model_resources->GetModelPacket().Get().get());
+}
+
 }  // namespace core
 }  // namespace tasks
 }  // namespace mediapipe
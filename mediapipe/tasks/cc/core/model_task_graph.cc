@@ -28,6 +28,7 @@ limitations under the License.
 #include "absl/strings/str_split.h"
 #include "mediapipe/calculators/tensor/inference_calculator.pb.h"
 #include "mediapipe/framework/api2/builder.h"
+#include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/port/logging.h"
@@ -60,6 +61,7 @@ constexpr char kMetadataExtractorTag[] = "METADATA_EXTRACTOR";
 constexpr char kModelTag[] = "MODEL";
 constexpr char kOpResolverTag[] = "OP_RESOLVER";
 constexpr char kTensorsTag[] = "TENSORS";
+constexpr char kDefaultBatchingKey[] = "inference_subgraph";
 
 std::string CreateModelResourcesTag(const CalculatorGraphConfig::Node& node) {
   std::vector<std::string> names = absl::StrSplit(node.name(), "__");
@@ -109,15 +111,40 @@ class InferenceSubgraph : public Subgraph {
         graph.SideOut(kMetadataExtractorTag);
 
     auto& inference_node = graph.AddNode("InferenceCalculator");
-    inference_node.GetOptions<mediapipe::InferenceCalculatorOptions>()
-        .mutable_delegate()
-        ->CopyFrom(inference_delegate);
+    auto& inference_opts =
+        inference_node.GetOptions<mediapipe::InferenceCalculatorOptions>();
+    inference_opts.mutable_delegate()->CopyFrom(inference_delegate);
+    if (subgraph_options->base_options().warm_up()) {
+      inference_opts.set_warm_up(true);
+    }
+    const int batch_size =
+        subgraph_options->base_options().inference_batch_size();
+    if (batch_size > 1) {
+      // The inputs are batched through the InferenceBatcher of the task
+      // runner, which only serves this task.
+      auto* batching = inference_opts.mutable_batching();
+      batching->set_key(subgraph_options->model_resources_tag().empty()
+                            ? kDefaultBatchingKey
+                            : subgraph_options->model_resources_tag());
+      batching->set_max_batch_size(batch_size);
+    }
     model_resources_node.SideOut(kModelTag) >> inference_node.SideIn(kModelTag);
     model_resources_node.SideOut(kOpResolverTag) >>
         inference_node.SideIn(kOpResolverTag);
     graph.In(kTensorsTag) >> inference_node.In(kTensorsTag);
     inference_node.Out(kTensorsTag) >> graph.Out(kTensorsTag);
-    return graph.GetConfig();
+    CalculatorGraphConfig config = graph.GetConfig();
+    if (batch_size > 1) {
+      // A batch fills up with the inputs of concurrent Process() calls, whose
+      // outputs are kept in timestamp order.
+      for (auto& node : *config.mutable_node()) {
+        if (node.calculator() != "InferenceCalculator") continue;
+        node.set_max_in_flight(batch_size);
+        node.mutable_output_stream_handler()->set_output_stream_handler(
+            "InOrderOutputStreamHandler");
+      }
+    }
+    return config;
   }
 
  private:
@@ -157,11 +184,17 @@ absl::StatusOr<CalculatorGraphConfig> ModelTaskGraph::GetConfig(
 
 absl::StatusOr<const ModelResources*> ModelTaskGraph::CreateModelResources(
     SubgraphContext* sc, std::unique_ptr<proto::ExternalFile> external_file,
-    const std::string tag_suffix) {
+    const std::string tag_suffix, bool share_model) {
   auto model_resources_cache_service = sc->Service(kModelResourcesCacheService);
   if (!model_resources_cache_service.IsAvailable()) {
-    ASSIGN_OR_RETURN(auto local_model_resource,
-                     ModelResources::Create("", std::move(external_file)));
+    ASSIGN_OR_RETURN(
+        auto local_model_resource,
+        ModelResources::Create(
+            "", std::move(external_file),
+            api2::PacketAdopting<tflite::OpResolver>(
+                std::make_unique<
+                    tflite_shims::ops::builtin::BuiltinOpResolver>()),
+            share_model));
     LOG(WARNING)
         << "A local ModelResources object is created. Please consider using "
            "ModelResourcesCacheService to cache the created ModelResources "
@@ -176,7 +209,7 @@ absl::StatusOr<const ModelResources*> ModelTaskGraph::CreateModelResources(
       absl::StrCat(CreateModelResourcesTag(sc->OriginalNode()), tag_suffix);
   ASSIGN_OR_RETURN(auto model_resources,
                    ModelResources::Create(tag, std::move(external_file),
-                                          op_resolver_packet));
+                                          op_resolver_packet, share_model));
   MP_RETURN_IF_ERROR(
       model_resources_cache_service.GetObject().AddModelResources(
           std::move(model_resources)));
@@ -243,6 +276,24 @@ GenericNode& ModelTaskGraph::AddInference(
   return inference_subgraph;
 }
 
+GenericNode& ModelTaskGraph::AddInference(
+    const ModelResources& model_resources,
+    const proto::BaseOptions& base_options, Graph& graph) const {
+  auto& inference_subgraph =
+      AddInference(model_resources, base_options.acceleration(), graph);
+  if (base_options.warm_up()) {
+    inference_subgraph.GetOptions<InferenceSubgraphOptions>()
+        .mutable_base_options()
+        ->set_warm_up(true);
+  }
+  if (base_options.inference_batch_size() > 1) {
+    inference_subgraph.GetOptions<InferenceSubgraphOptions>()
+        .mutable_base_options()
+        ->set_inference_batch_size(base_options.inference_batch_size());
+  }
+  return inference_subgraph;
+}
+
 }  // namespace core
 }  // namespace tasks
 }  // namespace mediapipe
@@ -61,14 +61,15 @@ class ModelTaskGraph : public Subgraph {
   // authors with the access to the metadata extractor and the tflite model.
   // If more than one model resources are created in a graph, the model
   // resources graph service add the tag_suffix to support multiple resources.
+  // The model is shared across graphs if the base options set share_model.
   template <typename Options>
   absl::StatusOr<const ModelResources*> CreateModelResources(
       SubgraphContext* sc, std::string tag_suffix = "") {
+    auto* base_options = sc->MutableOptions<Options>()->mutable_base_options();
     auto external_file = std::make_unique<proto::ExternalFile>();
-    external_file->Swap(sc->MutableOptions<Options>()
-                            ->mutable_base_options()
-                            ->mutable_model_asset());
-    return CreateModelResources(sc, std::move(external_file), tag_suffix);
+    external_file->Swap(base_options->mutable_model_asset());
+    return CreateModelResources(sc, std::move(external_file), tag_suffix,
+                                base_options->share_model());
   }
 
   // If the model resources graph service is available, creates a model
@@ -82,10 +83,12 @@ class ModelTaskGraph : public Subgraph {
   // available, a tag is generated internally asscoiated with the created model
   // resource. If more than one model resources are created in a graph, the
   // model resources graph service add the tag_suffix to support multiple
-  // resources.
+  // resources. If share_model is true, the model is shared with the other
+  // graphs of the process that run a model with the same contents, see
+  // ModelResources::Create().
   absl::StatusOr<const ModelResources*> CreateModelResources(
       SubgraphContext* sc, std::unique_ptr<proto::ExternalFile> external_file,
-      std::string tag_suffix = "");
+      std::string tag_suffix = "", bool share_model = false);
 
   // If the model resources graph service is available, creates a model asset
   // bundle resources object from the subgraph context, and caches the created
@@ -136,6 +139,14 @@ class ModelTaskGraph : public Subgraph {
       const proto::Acceleration& acceleration,
       api2::builder::Graph& graph) const;
 
+  // Same as above, with the acceleration settings of the given base options,
+  // which also tell whether the model is warmed up when the graph starts and
+  // how many inputs run as one batched inference.
+  api2::builder::GenericNode& AddInference(
+      const ModelResources& model_resources,
+      const proto::BaseOptions& base_options,
+      api2::builder::Graph& graph) const;
+
  private:
   std::vector<std::unique_ptr<ModelResources>> local_model_resources_;
 
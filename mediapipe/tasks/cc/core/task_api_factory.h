@@ -54,6 +54,8 @@ class TaskApiFactory {
       std::unique_ptr<tflite::OpResolver> resolver,
       PacketsCallback packets_callback = nullptr) {
     bool found_task_subgraph = false;
+    bool load_model_asynchronously = false;
+    bool enable_profiler = false;
     for (const auto& node : graph_config.node()) {
       if (node.calculator() == "FlowLimiterCalculator") {
         continue;
@@ -72,12 +74,24 @@ class TaskApiFactory {
               MediaPipeTasksStatus::kInvalidTaskGraphConfigError);
         }
         found_task_subgraph = true;
+        load_model_asynchronously = node.options()
+                                        .GetExtension(Options::ext)
+                                        .base_options()
+                                        .load_model_asynchronously();
+        enable_profiler = node.options()
+                              .GetExtension(Options::ext)
+                              .base_options()
+                              .enable_profiler();
       }
     }
+    if (enable_profiler) {
+      graph_config.mutable_profiler_config()->set_enable_profiler(true);
+    }
     ASSIGN_OR_RETURN(
         auto runner,
         core::TaskRunner::Create(std::move(graph_config), std::move(resolver),
-                                 std::move(packets_callback)));
+                                 std::move(packets_callback),
+                                 load_model_asynchronously));
     return std::make_unique<T>(std::move(runner));
   }
 };
@@ -31,6 +31,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/tensor/inference_batcher.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/tool/name_util.h"
@@ -89,8 +90,12 @@ absl::StatusOr<PacketMap> GenerateOutputPacketMap(
 absl::StatusOr<std::unique_ptr<TaskRunner>> TaskRunner::Create(
     CalculatorGraphConfig config,
     std::unique_ptr<tflite::OpResolver> op_resolver,
-    PacketsCallback packets_callback) {
+    PacketsCallback packets_callback, bool start_asynchronously) {
   auto task_runner = absl::WrapUnique(new TaskRunner(packets_callback));
+  if (start_asynchronously) {
+    task_runner->StartAsynchronously(std::move(config), std::move(op_resolver));
+    return task_runner;
+  }
   MP_RETURN_IF_ERROR(
       task_runner->Initialize(std::move(config), std::move(op_resolver)));
   MP_RETURN_IF_ERROR(task_runner->Start());
@@ -138,8 +143,7 @@ absl::Status TaskRunner::Initialize(
     mediapipe::tool::AddMultiStreamCallback(
         output_stream_names_,
         [this](const std::vector<Packet>& packets) {
-          status_or_output_packets_ =
-              GenerateOutputPacketMap(packets, output_stream_names_);
+          OnOutputPackets(packets);
           return;
         },
         &config, &input_side_packets, /*observe_timestamp_bounds=*/true);
@@ -151,6 +155,9 @@ absl::Status TaskRunner::Initialize(
                                          model_resources_cache),
                  "ModelResourcesCacheService is not set up successfully.",
                  MediaPipeTasksStatus::kRunnerModelResourcesCacheServiceError));
+  // Serves the InferenceCalculators of the task configured with batching.
+  MP_RETURN_IF_ERROR(graph_.SetServiceObject(
+      kInferenceBatcherService, std::make_shared<InferenceBatcher>()));
   MP_RETURN_IF_ERROR(
       AddPayload(graph_.Initialize(std::move(config), input_side_packets),
                  "MediaPipe CalculatorGraph is not successfully initialized.",
@@ -188,7 +195,33 @@ absl::Status TaskRunner::Start() {
   return absl::OkStatus();
 }
 
+void TaskRunner::StartAsynchronously(
+    CalculatorGraphConfig config,
+    std::unique_ptr<tflite::OpResolver> op_resolver) {
+  pending_config_ = std::move(config);
+  pending_op_resolver_ = std::move(op_resolver);
+  starter_ = std::make_unique<ThreadPool>("mediapipe_task_runner_start", 1);
+  starter_->StartWorkers();
+  starter_->Schedule([this] {
+    start_status_ = Initialize(std::move(pending_config_),
+                               std::move(pending_op_resolver_));
+    if (start_status_.ok()) {
+      start_status_ = Start();
+    }
+    started_.Notify();
+  });
+}
+
+absl::Status TaskRunner::WaitUntilStarted() {
+  if (starter_ == nullptr) {
+    return absl::OkStatus();
+  }
+  started_.WaitForNotification();
+  return start_status_;
+}
+
 absl::StatusOr<PacketMap> TaskRunner::Process(PacketMap inputs) {
+  MP_RETURN_IF_ERROR(WaitUntilStarted());
   if (!is_running_) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
@@ -250,7 +283,132 @@ absl::StatusOr<PacketMap> TaskRunner::Process(PacketMap inputs) {
   return status_or_output_packets_;
 }
 
+absl::Status TaskRunner::ProcessAsync(PacketMap inputs,
+                                      PacketsCallback callback) {
+  MP_RETURN_IF_ERROR(WaitUntilStarted());
+  if (!is_running_) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Task runner is currently not running.",
+        MediaPipeTasksStatus::kRunnerNotStartedError);
+  }
+  if (packets_callback_) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Calling TaskRunner::ProcessAsync method is illegal when the result "
+        "callback is provided.",
+        MediaPipeTasksStatus::kRunnerApiCalledInWrongModeError);
+  }
+  if (!callback) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "TaskRunner::ProcessAsync requires a callback.",
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  ASSIGN_OR_RETURN(auto input_timestamp, ValidateAndGetPacketTimestamp(inputs));
+  absl::MutexLock lock(&mutex_);
+  if (graph_.HasError()) {
+    absl::Status graph_status;
+    graph_.GetCombinedErrors(&graph_status);
+    FailPendingRequests(graph_status);
+    return graph_status;
+  }
+  // Assigns a synthetic timestamp like Process().
+  if (input_timestamp == Timestamp::Unset()) {
+    input_timestamp = last_seen_ == Timestamp::Unset()
+                          ? Timestamp(0)
+                          : last_seen_ + Timestamp::kTimestampUnitsPerSecond;
+  } else if (input_timestamp <= last_seen_) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Input timestamp must be monotonically increasing.",
+        MediaPipeTasksStatus::kRunnerInvalidTimestampError);
+  }
+  {
+    absl::MutexLock pending_lock(&pending_mutex_);
+    pending_requests_.emplace(input_timestamp, std::move(callback));
+  }
+  last_seen_ = input_timestamp;
+  for (auto& [stream_name, packet] : inputs) {
+    absl::Status status = graph_.AddPacketToInputStream(
+        stream_name, std::move(packet).At(input_timestamp));
+    if (!status.ok()) {
+      // The graph may already have received some of the packets, so the
+      // timestamp is not reused.
+      absl::MutexLock pending_lock(&pending_mutex_);
+      pending_requests_.erase(input_timestamp);
+      return AddPayload(
+          status,
+          absl::StrCat("Failed to add packet to the graph input stream: ",
+                       stream_name),
+          MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status TaskRunner::WaitForPendingRequests() {
+  MP_RETURN_IF_ERROR(WaitUntilStarted());
+  if (!is_running_) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Task runner is currently not running.",
+        MediaPipeTasksStatus::kRunnerNotStartedError);
+  }
+  absl::MutexLock lock(&mutex_);
+  absl::Status status = graph_.WaitUntilIdle();
+  if (!status.ok()) {
+    FailPendingRequests(status);
+  }
+  return status;
+}
+
+void TaskRunner::OnOutputPackets(const std::vector<Packet>& packets) {
+  // Empty packets observing a timestamp bound carry the settled timestamp.
+  Timestamp timestamp = Timestamp::Unset();
+  for (const Packet& packet : packets) {
+    timestamp = std::max(timestamp, packet.Timestamp());
+  }
+  std::vector<std::pair<Timestamp, PacketsCallback>> completed_requests;
+  {
+    absl::MutexLock lock(&pending_mutex_);
+    auto end = pending_requests_.upper_bound(timestamp);
+    for (auto it = pending_requests_.begin(); it != end; ++it) {
+      completed_requests.emplace_back(it->first, std::move(it->second));
+    }
+    pending_requests_.erase(pending_requests_.begin(), end);
+  }
+  bool is_async_request = false;
+  for (auto& [request_timestamp, callback] : completed_requests) {
+    if (request_timestamp == timestamp) {
+      is_async_request = true;
+      callback(GenerateOutputPacketMap(packets, output_stream_names_));
+    } else {
+      // The graph settled the request timestamp without any output.
+      std::vector<Packet> empty_packets(packets.size(),
+                                        Packet().At(request_timestamp));
+      callback(GenerateOutputPacketMap(empty_packets, output_stream_names_));
+    }
+  }
+  if (!is_async_request) {
+    status_or_output_packets_ =
+        GenerateOutputPacketMap(packets, output_stream_names_);
+  }
+}
+
+void TaskRunner::FailPendingRequests(const absl::Status& status) {
+  std::map<Timestamp, PacketsCallback> failed_requests;
+  {
+    absl::MutexLock lock(&pending_mutex_);
+    failed_requests.swap(pending_requests_);
+  }
+  for (auto& [timestamp, callback] : failed_requests) {
+    callback(status);
+  }
+}
+
 absl::Status TaskRunner::Send(PacketMap inputs) {
+  MP_RETURN_IF_ERROR(WaitUntilStarted());
   if (!is_running_) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
@@ -293,6 +451,7 @@ absl::Status TaskRunner::Send(PacketMap inputs) {
 }
 
 absl::Status TaskRunner::Close() {
+  MP_RETURN_IF_ERROR(WaitUntilStarted());
   if (!is_running_) {
     return CreateStatusWithPayload(
         absl::StatusCode::kInvalidArgument,
@@ -300,13 +459,21 @@ absl::Status TaskRunner::Close() {
         MediaPipeTasksStatus::kRunnerFailsToCloseError);
   }
   is_running_ = false;
-  MP_RETURN_IF_ERROR(
+  absl::Status status =
       AddPayload(graph_.CloseAllInputStreams(), "Fail to close intput streams",
-                 MediaPipeTasksStatus::kRunnerFailsToCloseError));
-  MP_RETURN_IF_ERROR(AddPayload(
-      graph_.WaitUntilDone(), "Fail to shutdown the MediaPipe graph.",
-      MediaPipeTasksStatus::kRunnerFailsToCloseError));
-  return absl::OkStatus();
+                 MediaPipeTasksStatus::kRunnerFailsToCloseError);
+  if (status.ok()) {
+    status = AddPayload(graph_.WaitUntilDone(),
+                        "Fail to shutdown the MediaPipe graph.",
+                        MediaPipeTasksStatus::kRunnerFailsToCloseError);
+  }
+  FailPendingRequests(
+      status.ok() ? CreateStatusWithPayload(
+                        absl::StatusCode::kCancelled,
+                        "Task runner closed before the request completed.",
+                        MediaPipeTasksStatus::kRunnerUnexpectedOutputError)
+                  : status);
+  return status;
 }
 
 absl::Status TaskRunner::Restart() {
@@ -314,6 +481,14 @@ absl::Status TaskRunner::Restart() {
   return Start();
 }
 
+absl::StatusOr<std::vector<CalculatorProfile>>
+TaskRunner::GetCalculatorProfiles() {
+  MP_RETURN_IF_ERROR(WaitUntilStarted());
+  std::vector<CalculatorProfile> profiles;
+  MP_RETURN_IF_ERROR(graph_.profiler()->GetCalculatorProfiles(&profiles));
+  return profiles;
+}
+
 }  // namespace core
 }  // namespace tasks
 }  // namespace mediapipe
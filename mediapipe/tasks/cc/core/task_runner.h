@@ -32,9 +32,12 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
 #include "mediapipe/framework/calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
 #include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/tasks/cc/core/model_resources.h"
 #include "mediapipe/tasks/cc/core/model_resources_cache.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
@@ -70,10 +73,15 @@ class TaskRunner {
   // asynchronous method, Send(), to provide the input packets. If the packets
   // callback is absent, clients must use the synchronous method, Process(), to
   // provide the input packets and receive the output packets.
+  // If `start_asynchronously` is true, the graph is initialized and started,
+  // which loads the models, on a background thread and the runner is returned
+  // right away. The first call to any other method then blocks until the
+  // graph is started, and returns the error if it failed to start.
   static absl::StatusOr<std::unique_ptr<TaskRunner>> Create(
       CalculatorGraphConfig config,
       std::unique_ptr<tflite::OpResolver> op_resolver = nullptr,
-      PacketsCallback packets_callback = nullptr);
+      PacketsCallback packets_callback = nullptr,
+      bool start_asynchronously = false);
 
   // TaskRunner is neither copyable nor movable.
   TaskRunner(const TaskRunner&) = delete;
@@ -92,6 +100,25 @@ class TaskRunner {
   // timestamps are in order.
   absl::StatusOr<PacketMap> Process(PacketMap inputs);
 
+  // A non-blocking version of Process() for pipelining batch or offline
+  // streaming data: adds the input packets to the graph and returns, and the
+  // outputs, or an error status, are delivered to `callback` later on a graph
+  // thread. Many requests may be in flight at once. Input packets without a
+  // timestamp are assigned an internal timestamp like in Process(). Otherwise
+  // the timestamps must be greater than those of all previous requests. The
+  // request is completed by the output packets at its timestamp, or by empty
+  // packets if the graph settles the timestamp without any output. Requests
+  // still pending when the graph fails or the runner is closed receive the
+  // error. Like Process(), only available if no PacketsCallback was provided
+  // at construction. May be called from multiple threads, and may be mixed
+  // with Process(), which still runs one invocation at a time.
+  absl::Status ProcessAsync(PacketMap inputs, PacketsCallback callback);
+
+  // Blocks until the graph is idle, so that all the ProcessAsync() requests
+  // made before the call have completed. If the graph fails, the pending
+  // requests receive the error, which is also returned.
+  absl::Status WaitForPendingRequests();
+
   // An asynchronous method that is designed for handling live streaming data
   // such as live camera and microphone data. A user-defined PacketsCallback
   // function must be provided in the constructor to receive the output packets.
@@ -111,7 +138,14 @@ class TaskRunner {
   absl::Status Restart();
 
   // Returns the canonicalized CalculatorGraphConfig of the underlying graph.
-  const CalculatorGraphConfig& GetGraphConfig() { return graph_.Config(); }
+  const CalculatorGraphConfig& GetGraphConfig() {
+    WaitUntilStarted().IgnoreError();
+    return graph_.Config();
+  }
+
+  // Returns the runtime profiles of the calculators of the underlying graph,
+  // which are empty unless its profiler is enabled.
+  absl::StatusOr<std::vector<CalculatorProfile>> GetCalculatorProfiles();
 
  private:
   // Constructor.
@@ -132,6 +166,21 @@ class TaskRunner {
   // indicate that the runner isn't started successfully.
   absl::Status Start();
 
+  // Initializes and starts the task runner on the starter_ thread.
+  void StartAsynchronously(CalculatorGraphConfig config,
+                           std::unique_ptr<tflite::OpResolver> op_resolver);
+
+  // Blocks until the task runner started asynchronously is started, and
+  // returns the status of its start. Returns right away otherwise.
+  absl::Status WaitUntilStarted();
+
+  // Receives the output packets of a timestamp, and completes the
+  // ProcessAsync() requests up to that timestamp.
+  void OnOutputPackets(const std::vector<Packet>& packets);
+
+  // Completes all pending ProcessAsync() requests with the error status.
+  void FailPendingRequests(const absl::Status& status);
+
   PacketsCallback packets_callback_;
   std::vector<std::string> output_stream_names_;
   CalculatorGraph graph_;
@@ -141,6 +190,23 @@ class TaskRunner {
   absl::StatusOr<PacketMap> status_or_output_packets_;
   Timestamp last_seen_ ABSL_GUARDED_BY(mutex_);
   absl::Mutex mutex_;
+
+  // The callbacks of the pending ProcessAsync() requests, by input timestamp.
+  // Guarded separately from mutex_, which Process() holds until the graph is
+  // idle.
+  std::map<Timestamp, PacketsCallback> pending_requests_
+      ABSL_GUARDED_BY(pending_mutex_);
+  absl::Mutex pending_mutex_;
+
+  // The inputs and the result of the asynchronous start, which happens before
+  // started_ is notified.
+  CalculatorGraphConfig pending_config_;
+  std::unique_ptr<tflite::OpResolver> pending_op_resolver_;
+  absl::Status start_status_;
+  absl::Notification started_;
+  // Runs the asynchronous start. Declared last to be joined first on
+  // destruction, while the graph is still alive.
+  std::unique_ptr<ThreadPool> starter_;
 };
 
 }  // namespace core
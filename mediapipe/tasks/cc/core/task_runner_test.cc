@@ -22,10 +22,12 @@ limitations under the License.
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -228,6 +230,40 @@ TEST_F(TaskRunnerTest, OneThreadSyncAPICalls) {
   MP_ASSERT_OK(runner->Close());
 }
 
+TEST_F(TaskRunnerTest, StartAsynchronously) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner, TaskRunner::Create(GetPassThroughGraphConfig(),
+                                      /*op_resolver=*/nullptr,
+                                      /*packets_callback=*/nullptr,
+                                      /*start_asynchronously=*/true));
+  // The first call waits for the graph to be started.
+  auto status_or_result = runner->Process({{"in", MakePacket<int>(1)}});
+  ASSERT_TRUE(status_or_result.ok());
+  EXPECT_EQ(1, status_or_result.value()["out"].Get<int>());
+  MP_ASSERT_OK(runner->Close());
+}
+
+TEST_F(TaskRunnerTest, ReportStartErrorAfterStartingAsynchronously) {
+  CalculatorGraphConfig proto = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: 'in'
+    output_stream: 'out'
+    node {
+      calculator: 'UnregisteredCalculator'
+      input_stream: 'in'
+      output_stream: 'out'
+    })pb");
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      TaskRunner::Create(proto, /*op_resolver=*/nullptr,
+                         /*packets_callback=*/nullptr,
+                         /*start_asynchronously=*/true));
+  auto status_or_result = runner->Process({{"in", MakePacket<int>(1)}});
+  ASSERT_FALSE(status_or_result.ok());
+  EXPECT_THAT(status_or_result.status().message(),
+              testing::HasSubstr("not successfully initialized"));
+  EXPECT_FALSE(runner->Close().ok());
+}
+
 TEST_F(TaskRunnerTest, MultiThreadSyncAPICallsWithoutTimestamp) {
   MP_ASSERT_OK_AND_ASSIGN(auto runner,
                           TaskRunner::Create(GetPassThroughGraphConfig()));
@@ -275,6 +311,48 @@ TEST_F(TaskRunnerTest, AsyncAPICalls) {
   MP_ASSERT_OK(runner->Close());
 }
 
+TEST_F(TaskRunnerTest, ProcessAsyncAPICalls) {
+  MP_ASSERT_OK_AND_ASSIGN(auto runner,
+                          TaskRunner::Create(GetPassThroughGraphConfig()));
+  absl::Mutex mutex;
+  std::vector<int> results;
+  for (int i = 0; i < 100; ++i) {
+    MP_ASSERT_OK(runner->ProcessAsync(
+        {{"in", MakePacket<int>(i)}},
+        [i, &mutex, &results](absl::StatusOr<PacketMap> status_or_packets) {
+          ASSERT_TRUE(status_or_packets.ok());
+          EXPECT_EQ(i, status_or_packets.value()["out"].Get<int>());
+          absl::MutexLock lock(&mutex);
+          results.push_back(i);
+        }));
+  }
+  // Synchronous calls can be mixed in.
+  auto status_or_result = runner->Process({{"in", MakePacket<int>(100)}});
+  ASSERT_TRUE(status_or_result.ok());
+  EXPECT_EQ(100, status_or_result.value()["out"].Get<int>());
+  MP_ASSERT_OK(runner->Close());
+  absl::MutexLock lock(&mutex);
+  ASSERT_EQ(results.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, results[i]);
+  }
+}
+
+TEST_F(TaskRunnerTest, ReportErrorInProcessAsyncAPICall) {
+  MP_ASSERT_OK_AND_ASSIGN(auto runner,
+                          TaskRunner::Create(GetErrorCalculatorGraphConfig()));
+  absl::Status callback_status;
+  MP_ASSERT_OK(runner->ProcessAsync(
+      {{"in", MakePacket<int>(0)}},
+      [&callback_status](absl::StatusOr<PacketMap> status_or_packets) {
+        callback_status = status_or_packets.status();
+      }));
+  auto status = runner->Close();
+  ASSERT_FALSE(status.ok());
+  ASSERT_THAT(callback_status.message(),
+              testing::HasSubstr("An intended error for testing"));
+}
+
 TEST_F(TaskRunnerTest, ReportErrorInSyncAPICall) {
   MP_ASSERT_OK_AND_ASSIGN(auto runner,
                           TaskRunner::Create(GetErrorCalculatorGraphConfig()));
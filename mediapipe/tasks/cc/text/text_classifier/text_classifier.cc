@@ -19,7 +19,9 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/framework/api2/builder.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/containers/proto/classifications.pb.h"
 #include "mediapipe/tasks/cc/components/processors/proto/classifier_options.pb.h"
 #include "mediapipe/tasks/cc/core/task_api_factory.h"
+#include "mediapipe/tasks/cc/core/task_runner.h"
 #include "mediapipe/tasks/cc/text/text_classifier/proto/text_classifier_graph_options.pb.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
 
@@ -40,6 +43,7 @@ namespace {
 
 using ::mediapipe::tasks::components::containers::ConvertToClassificationResult;
 using ::mediapipe::tasks::components::containers::proto::ClassificationResult;
+using ::mediapipe::tasks::core::PacketMap;
 
 constexpr char kTextStreamName[] = "text_in";
 constexpr char kTextTag[] = "TEXT";
@@ -61,6 +65,27 @@ CalculatorGraphConfig CreateGraphConfig(
   return graph.GetConfig();
 }
 
+// Returns an estimate of the memory used by "result", for the result cache.
+size_t EstimateResultBytes(const TextClassifierResult& result) {
+  size_t bytes = sizeof(result);
+  for (const auto& classifications : result.classifications) {
+    bytes += sizeof(classifications);
+    if (classifications.head_name.has_value()) {
+      bytes += classifications.head_name->size();
+    }
+    for (const auto& category : classifications.categories) {
+      bytes += sizeof(category);
+      if (category.category_name.has_value()) {
+        bytes += category.category_name->size();
+      }
+      if (category.display_name.has_value()) {
+        bytes += category.display_name->size();
+      }
+    }
+  }
+  return bytes;
+}
+
 // Converts the user-facing TextClassifierOptions struct to the internal
 // TextClassifierGraphOptions proto.
 std::unique_ptr<proto::TextClassifierGraphOptions>
@@ -83,20 +108,77 @@ ConvertTextClassifierOptionsToProto(TextClassifierOptions* options) {
 absl::StatusOr<std::unique_ptr<TextClassifier>> TextClassifier::Create(
     std::unique_ptr<TextClassifierOptions> options) {
   auto options_proto = ConvertTextClassifierOptionsToProto(options.get());
-  return core::TaskApiFactory::Create<TextClassifier,
-                                      proto::TextClassifierGraphOptions>(
-      CreateGraphConfig(std::move(options_proto)),
-      std::move(options->base_options.op_resolver));
+  const uint64_t model_fingerprint =
+      options->result_cache
+          ? absl::Hash<std::string>()(options_proto->SerializeAsString())
+          : 0;
+  ASSIGN_OR_RETURN(
+      std::unique_ptr<TextClassifier> classifier,
+      (core::TaskApiFactory::Create<TextClassifier,
+                                    proto::TextClassifierGraphOptions>(
+          CreateGraphConfig(std::move(options_proto)),
+          std::move(options->base_options.op_resolver))));
+  classifier->result_cache_ = std::move(options->result_cache);
+  classifier->model_fingerprint_ = model_fingerprint;
+  return classifier;
 }
 
 absl::StatusOr<TextClassifierResult> TextClassifier::Classify(
     absl::string_view text) {
+  if (result_cache_) {
+    auto cached = result_cache_->Lookup(model_fingerprint_, text);
+    if (cached.has_value()) return *std::move(cached);
+  }
   ASSIGN_OR_RETURN(
       auto output_packets,
       runner_->Process(
           {{kTextStreamName, MakePacket<std::string>(std::string(text))}}));
-  return ConvertToClassificationResult(
+  TextClassifierResult result = ConvertToClassificationResult(
       output_packets[kClassificationsStreamName].Get<ClassificationResult>());
+  if (result_cache_) {
+    result_cache_->Insert(model_fingerprint_, text, result,
+                          EstimateResultBytes(result));
+  }
+  return result;
+}
+
+absl::StatusOr<std::vector<TextClassifierResult>> TextClassifier::ClassifyBatch(
+    std::vector<std::string> texts) {
+  std::vector<TextClassifierResult> results(texts.size());
+  // Indices of the texts to run through the graph.
+  std::vector<int> missing;
+  missing.reserve(texts.size());
+  for (int i = 0; i < texts.size(); ++i) {
+    if (result_cache_) {
+      auto cached = result_cache_->Lookup(model_fingerprint_, texts[i]);
+      if (cached.has_value()) {
+        results[i] = *std::move(cached);
+        continue;
+      }
+    }
+    missing.push_back(i);
+  }
+  if (missing.empty()) return results;
+
+  std::vector<PacketMap> inputs;
+  inputs.reserve(missing.size());
+  for (int i : missing) {
+    // The texts are still needed as cache keys.
+    std::string text = result_cache_ ? texts[i] : std::move(texts[i]);
+    inputs.push_back(
+        {{kTextStreamName, MakePacket<std::string>(std::move(text))}});
+  }
+  ASSIGN_OR_RETURN(auto outputs, ProcessBatch(std::move(inputs)));
+  for (int j = 0; j < outputs.size(); ++j) {
+    TextClassifierResult& result = results[missing[j]];
+    result = ConvertToClassificationResult(
+        outputs[j][kClassificationsStreamName].Get<ClassificationResult>());
+    if (result_cache_) {
+      result_cache_->Insert(model_fingerprint_, texts[missing[j]], result,
+                            EstimateResultBytes(result));
+    }
+  }
+  return results;
 }
 
 }  // namespace text_classifier
@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef MEDIAPIPE_TASKS_CC_TEXT_TEXT_CLASSIFIER_TEXT_CLASSIFIER_H_
 #define MEDIAPIPE_TASKS_CC_TEXT_TEXT_CLASSIFIER_TEXT_CLASSIFIER_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -25,6 +28,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/processors/classifier_options.h"
 #include "mediapipe/tasks/cc/core/base_options.h"
 #include "mediapipe/tasks/cc/core/base_task_api.h"
+#include "mediapipe/tasks/cc/text/utils/text_result_cache.h"
 
 namespace mediapipe {
 namespace tasks {
@@ -35,6 +39,11 @@ namespace text_classifier {
 using TextClassifierResult =
     ::mediapipe::tasks::components::containers::ClassificationResult;
 
+// A cache of classification results, which may be shared by several text
+// classifiers.
+using TextClassifierResultCache =
+    ::mediapipe::tasks::text::utils::TextResultCache<TextClassifierResult>;
+
 // The options for configuring a MediaPipe text classifier task.
 struct TextClassifierOptions {
   // Base options for configuring MediaPipe Tasks, such as specifying the model
@@ -44,6 +53,11 @@ struct TextClassifierOptions {
   // Options for configuring the classifier behavior, such as score threshold,
   // number of results, etc.
   components::processors::ClassifierOptions classifier_options;
+
+  // Optional cache of the results for recent texts. Texts found there, after
+  // whitespace normalization, are not run through the model again. Results are
+  // keyed by model and options too, so the cache may be shared by classifiers.
+  std::shared_ptr<TextClassifierResultCache> result_cache;
 };
 
 // Performs classification on text.
@@ -80,6 +94,10 @@ class TextClassifier : core::BaseTaskApi {
  public:
   using BaseTaskApi::BaseTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates a TextClassifier from the provided `options`.
   static absl::StatusOr<std::unique_ptr<TextClassifier>> Create(
       std::unique_ptr<TextClassifierOptions> options);
@@ -87,8 +105,21 @@ class TextClassifier : core::BaseTaskApi {
   // Performs classification on the input `text`.
   absl::StatusOr<TextClassifierResult> Classify(absl::string_view text);
 
+  // Performs classification on each of the input `texts`, and returns the
+  // results in input order. The texts are all sent to the underlying graph
+  // before waiting for results, so that the tokenization of a text overlaps
+  // with the inference on the previous one. Only the texts missing from the
+  // result cache, if any, are sent.
+  absl::StatusOr<std::vector<TextClassifierResult>> ClassifyBatch(
+      std::vector<std::string> texts);
+
   // Shuts down the TextClassifier when all the work is done.
   absl::Status Close() { return runner_->Close(); }
+
+ private:
+  std::shared_ptr<TextClassifierResultCache> result_cache_;
+  // Fingerprint of the model and options, which keys the cached results.
+  uint64_t model_fingerprint_ = 0;
 };
 
 }  // namespace text_classifier
@@ -125,7 +125,7 @@ class TextClassifierGraph : public core::ModelTaskGraph {
 
     // Adds both InferenceCalculator and ModelResourcesCalculator.
     auto& inference = AddInference(
-        model_resources, task_options.base_options().acceleration(), graph);
+        model_resources, task_options.base_options(), graph);
     // The metadata extractor side-output comes from the
     // ModelResourcesCalculator.
     inference.SideOut(kMetadataExtractorTag) >>
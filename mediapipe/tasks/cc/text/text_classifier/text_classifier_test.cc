@@ -21,6 +21,7 @@ limitations under the License.
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
@@ -45,6 +46,7 @@ using ::mediapipe::file::JoinPath;
 using ::mediapipe::tasks::kMediaPipeTasksPayload;
 using ::mediapipe::tasks::components::containers::Category;
 using ::mediapipe::tasks::components::containers::Classifications;
+using ::mediapipe::tasks::text::utils::TextResultCacheStats;
 using ::testing::HasSubstr;
 using ::testing::Optional;
 
@@ -194,6 +196,53 @@ TEST_F(TextClassifierTest, TextClassifierWithIntInputs) {
   MP_ASSERT_OK(classifier->Close());
 }
 
+TEST_F(TextClassifierTest, TextClassifierWithBatch) {
+  auto options = std::make_unique<TextClassifierOptions>();
+  options->base_options.model_asset_path = GetFullPath(kTestRegexModelPath);
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TextClassifier> classifier,
+                          TextClassifier::Create(std::move(options)));
+  const std::vector<std::string> texts = {
+      "What a waste of my time.",
+      "This is the best movie I’ve seen in recent years."
+      "Strongly recommend it!"};
+
+  MP_ASSERT_OK_AND_ASSIGN(std::vector<TextClassifierResult> results,
+                          classifier->ClassifyBatch(texts));
+
+  ASSERT_EQ(results.size(), texts.size());
+  for (int i = 0; i < texts.size(); ++i) {
+    MP_ASSERT_OK_AND_ASSIGN(TextClassifierResult expected,
+                            classifier->Classify(texts[i]));
+    ExpectApproximatelyEqual(results[i], expected);
+  }
+
+  MP_ASSERT_OK(classifier->Close());
+}
+
+TEST_F(TextClassifierTest, TextClassifierWithResultCache) {
+  auto cache = std::make_shared<TextClassifierResultCache>();
+  auto options = std::make_unique<TextClassifierOptions>();
+  options->base_options.model_asset_path = GetFullPath(kTestRegexModelPath);
+  options->result_cache = cache;
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TextClassifier> classifier,
+                          TextClassifier::Create(std::move(options)));
+
+  MP_ASSERT_OK_AND_ASSIGN(TextClassifierResult expected,
+                          classifier->Classify("What a waste of my time."));
+  MP_ASSERT_OK_AND_ASSIGN(
+      std::vector<TextClassifierResult> results,
+      classifier->ClassifyBatch({"What a  waste of my time. ",
+                                 "What a great and fantastic trip."}));
+  ASSERT_EQ(results.size(), 2);
+  ExpectApproximatelyEqual(results[0], expected);
+  TextResultCacheStats stats = cache->GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.entries, 2);
+
+  MP_ASSERT_OK(classifier->Close());
+}
+
 TEST_F(TextClassifierTest, TextClassifierWithStringToBool) {
   auto options = std::make_unique<TextClassifierOptions>();
   options->base_options.model_asset_path = GetFullPath(kStringToBoolModelPath);
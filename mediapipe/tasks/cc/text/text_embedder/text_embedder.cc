@@ -16,7 +16,10 @@ limitations under the License.
 #include "mediapipe/tasks/cc/text/text_embedder/text_embedder.h"
 
 #include <memory>
+#include <string>
+#include <utility>
 
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "mediapipe/calculators/tensor/inference_calculator.pb.h"
 #include "mediapipe/framework/api2/builder.h"
@@ -58,6 +61,18 @@ CalculatorGraphConfig CreateGraphConfig(
   return graph.GetConfig();
 }
 
+// Returns an estimate of the memory used by "result", for the result cache.
+size_t EstimateResultBytes(const TextEmbedderResult& result) {
+  size_t bytes = sizeof(result);
+  for (const auto& embedding : result.embeddings) {
+    bytes += sizeof(embedding) +
+             embedding.float_embedding.size() * sizeof(float) +
+             embedding.quantized_embedding.size();
+    if (embedding.head_name.has_value()) bytes += embedding.head_name->size();
+  }
+  return bytes;
+}
+
 // Converts the user-facing TextEmbedderOptions struct to the internal
 // TextEmbedderGraphOptions proto.
 std::unique_ptr<proto::TextEmbedderGraphOptions>
@@ -80,19 +95,37 @@ absl::StatusOr<std::unique_ptr<TextEmbedder>> TextEmbedder::Create(
     std::unique_ptr<TextEmbedderOptions> options) {
   std::unique_ptr<proto::TextEmbedderGraphOptions> options_proto =
       ConvertTextEmbedderOptionsToProto(options.get());
-  return core::TaskApiFactory::Create<TextEmbedder,
-                                      proto::TextEmbedderGraphOptions>(
-      CreateGraphConfig(std::move(options_proto)),
-      std::move(options->base_options.op_resolver));
+  const uint64_t model_fingerprint =
+      options->result_cache
+          ? absl::Hash<std::string>()(options_proto->SerializeAsString())
+          : 0;
+  ASSIGN_OR_RETURN(
+      std::unique_ptr<TextEmbedder> embedder,
+      (core::TaskApiFactory::Create<TextEmbedder,
+                                    proto::TextEmbedderGraphOptions>(
+          CreateGraphConfig(std::move(options_proto)),
+          std::move(options->base_options.op_resolver))));
+  embedder->result_cache_ = std::move(options->result_cache);
+  embedder->model_fingerprint_ = model_fingerprint;
+  return embedder;
 }
 
 absl::StatusOr<TextEmbedderResult> TextEmbedder::Embed(absl::string_view text) {
+  if (result_cache_) {
+    auto cached = result_cache_->Lookup(model_fingerprint_, text);
+    if (cached.has_value()) return *std::move(cached);
+  }
   ASSIGN_OR_RETURN(
       auto output_packets,
       runner_->Process(
           {{kTextInStreamName, MakePacket<std::string>(std::string(text))}}));
-  return ConvertToEmbeddingResult(
+  TextEmbedderResult result = ConvertToEmbeddingResult(
       output_packets[kEmbeddingsStreamName].Get<EmbeddingResult>());
+  if (result_cache_) {
+    result_cache_->Insert(model_fingerprint_, text, result,
+                          EstimateResultBytes(result));
+  }
+  return result;
 }
 
 absl::StatusOr<double> TextEmbedder::CosineSimilarity(
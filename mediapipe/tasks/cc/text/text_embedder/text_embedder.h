@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef MEDIAPIPE_TASKS_CC_TEXT_TEXT_EMBEDDER_TEXT_EMBEDDER_H_
 #define MEDIAPIPE_TASKS_CC_TEXT_TEXT_EMBEDDER_TEXT_EMBEDDER_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "absl/status/status.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/components/processors/embedder_options.h"
 #include "mediapipe/tasks/cc/core/base_options.h"
 #include "mediapipe/tasks/cc/core/base_task_api.h"
+#include "mediapipe/tasks/cc/text/utils/text_result_cache.h"
 
 namespace mediapipe::tasks::text::text_embedder {
 
@@ -32,6 +34,10 @@ namespace mediapipe::tasks::text::text_embedder {
 using TextEmbedderResult =
     ::mediapipe::tasks::components::containers::EmbeddingResult;
 
+// A cache of embeddings, which may be shared by several text embedders.
+using TextEmbedderResultCache =
+    ::mediapipe::tasks::text::utils::TextResultCache<TextEmbedderResult>;
+
 // Options for configuring a MediaPipe text embedder task.
 struct TextEmbedderOptions {
   // Base options for configuring MediaPipe Tasks, such as specifying the model
@@ -41,6 +47,11 @@ struct TextEmbedderOptions {
   // Options for configuring the embedder behavior, such as L2-normalization or
   // scalar-quantization.
   components::processors::EmbedderOptions embedder_options;
+
+  // Optional cache of the embeddings of recent texts. Texts found there, after
+  // whitespace normalization, are not run through the model again. Results are
+  // keyed by model and options too, so the cache may be shared by embedders.
+  std::shared_ptr<TextEmbedderResultCache> result_cache;
 };
 
 // Performs embedding extraction on text.
@@ -68,6 +79,10 @@ class TextEmbedder : core::BaseTaskApi {
  public:
   using BaseTaskApi::BaseTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates a TextEmbedder from the provided `options`. A non-default
   // OpResolver can be specified in the BaseOptions in order to support custom
   // Ops or specify a subset of built-in Ops.
@@ -89,6 +104,11 @@ class TextEmbedder : core::BaseTaskApi {
   static absl::StatusOr<double> CosineSimilarity(
       const components::containers::Embedding& u,
       const components::containers::Embedding& v);
+
+ private:
+  std::shared_ptr<TextEmbedderResultCache> result_cache_;
+  // Fingerprint of the model and options, which keys the cached results.
+  uint64_t model_fingerprint_ = 0;
 };
 
 }  // namespace mediapipe::tasks::text::text_embedder
@@ -117,7 +117,7 @@ class TextEmbedderGraph : public core::ModelTaskGraph {
 
     // Adds both InferenceCalculator and ModelResourcesCalculator.
     auto& inference = AddInference(
-        model_resources, task_options.base_options().acceleration(), graph);
+        model_resources, task_options.base_options(), graph);
     // The metadata extractor side-output comes from the
     // ModelResourcesCalculator.
     inference.SideOut(kMetadataExtractorTag) >>
@@ -139,5 +139,45 @@ TEST_F(EmbedderTest, SucceedsWithQuantization) {
   MP_ASSERT_OK(text_embedder->Close());
 }
 
+TEST(EmbedTest, SucceedsWithResultCache) {
+  auto cache = std::make_shared<TextEmbedderResultCache>();
+  auto options = std::make_unique<TextEmbedderOptions>();
+  options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kRegexOneEmbeddingModel);
+  options->result_cache = cache;
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TextEmbedder> text_embedder,
+                          TextEmbedder::Create(std::move(options)));
+
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto result0,
+      text_embedder->Embed("it's a charming and often affecting journey"));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto result1,
+      text_embedder->Embed(" it's a charming  and often affecting journey"));
+  EXPECT_EQ(cache->GetStats().hits, 1);
+  EXPECT_EQ(cache->GetStats().misses, 1);
+  ASSERT_EQ(result1.embeddings.size(), 1);
+  EXPECT_EQ(result1.embeddings[0].float_embedding,
+            result0.embeddings[0].float_embedding);
+
+  // Another model does not get the results of the first one.
+  auto quantized_options = std::make_unique<TextEmbedderOptions>();
+  quantized_options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kRegexOneEmbeddingModel);
+  quantized_options->embedder_options.quantize = true;
+  quantized_options->result_cache = cache;
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TextEmbedder> quantized_embedder,
+                          TextEmbedder::Create(std::move(quantized_options)));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto result2,
+      quantized_embedder->Embed("it's a charming and often affecting journey"));
+  EXPECT_EQ(cache->GetStats().misses, 2);
+  ASSERT_EQ(result2.embeddings.size(), 1);
+  EXPECT_EQ(result2.embeddings[0].quantized_embedding.size(), 16);
+
+  MP_ASSERT_OK(text_embedder->Close());
+  MP_ASSERT_OK(quantized_embedder->Close());
+}
+
 }  // namespace
 }  // namespace mediapipe::tasks::text::text_embedder
@@ -15,6 +15,13 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/text/tokenizers/bert_tokenizer.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "tensorflow_text/core/kernels/regex_split.h"
 
@@ -103,6 +110,75 @@ WordpieceTokenizerResult BertTokenizer::TokenizeWordpiece(
   return result;
 }
 
+int BertTokenizer::TokenizeWordpieceIds(absl::string_view input,
+                                        absl::Span<int32_t> ids) const {
+  if (options_.split_unknown_chars) {
+    // Unknown characters are split into subwords of their own, which the trie
+    // doesn't handle.
+    WordpieceTokenizerResult result = TokenizeWordpiece(std::string(input));
+    const int num_ids = std::min<int>(result.subwords.size(), ids.size());
+    for (int i = 0; i < num_ids; ++i) {
+      int id = 0;
+      LookupId(result.subwords[i], &id);
+      ids[i] = id;
+    }
+    return num_ids;
+  }
+
+  std::vector<absl::string_view> tokens;
+  std::vector<long long> begin_offsets;
+  std::vector<long long> end_offsets;
+  tensorflow::text::RegexSplit(input, delim_re_, true, include_delim_re_,
+                               &tokens, &begin_offsets, &end_offsets);
+  int num_ids = 0;
+  for (absl::string_view token : tokens) {
+    if (num_ids == ids.size()) break;
+    num_ids += TokenizeTokenIds(token, ids.subspan(num_ids));
+  }
+  return num_ids;
+}
+
+int BertTokenizer::TokenizeTokenIds(absl::string_view token,
+                                    absl::Span<int32_t> ids) const {
+  // Like tensorflow::text::WordpieceTokenize, a token is a single unknown
+  // token if it is too long or any of its pieces is not in the vocab.
+  bool found = token.size() <= options_.max_bytes_per_token;
+  int num_ids = 0;
+  for (int start = 0; found && start < token.size();) {
+    int id;
+    const int end = trie_.LongestMatch(
+        token, start, options_.max_chars_per_subtoken, &id);
+    if (end < 0) {
+      found = false;
+    } else {
+      if (num_ids < ids.size()) ids[num_ids++] = id;
+      start = end;
+    }
+  }
+  if (found) return num_ids;
+  int id = 0;
+  if (options_.use_unknown_token) {
+    id = unknown_token_id_;
+  } else {
+    // The token itself is the subword.
+    LookupId(token, &id);
+  }
+  ids[0] = id;
+  return 1;
+}
+
+std::vector<int> BertTokenizer::TokenizeBatch(
+    absl::Span<const std::string> inputs, int row_size,
+    absl::Span<int32_t> ids) const {
+  std::vector<int> num_ids(inputs.size());
+  std::fill(ids.begin(), ids.end(), 0);
+  for (int i = 0; i < inputs.size(); ++i) {
+    num_ids[i] = TokenizeWordpieceIds(
+        inputs[i], ids.subspan(static_cast<size_t>(i) * row_size, row_size));
+  }
+  return num_ids;
+}
+
 }  // namespace tokenizers
 }  // namespace text
 }  // namespace tasks
@@ -17,13 +17,16 @@ limitations under the License.
 #define MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_BERT_TOKENIZER_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "mediapipe/tasks/cc/text/tokenizers/tokenizer.h"
+#include "mediapipe/tasks/cc/text/tokenizers/wordpiece_trie.h"
 #include "mediapipe/tasks/cc/text/utils/vocab_utils.h"
 #include "re2/re2.h"
 #include "tensorflow_text/core/kernels/wordpiece_tokenizer.h"
@@ -93,9 +96,12 @@ class BertTokenizer : public mediapipe::tasks::text::tokenizers::Tokenizer {
   explicit BertTokenizer(const std::vector<std::string>& vocab,
                          const BertTokenizerOptions& options = {})
       : vocab_{FlatHashMapBackedWordpiece(vocab)},
+        trie_{vocab, options.suffix_indicator},
         options_{options},
         delim_re_{options.delim_str},
-        include_delim_re_{options.include_delim_str} {}
+        include_delim_re_{options.include_delim_str} {
+    vocab_.LookupId(options_.unknown_token, &unknown_token_id_);
+  }
 
   // Initialize the tokenizer from file path to vocab and tokenizer configs.
   explicit BertTokenizer(const std::string& path_to_vocab,
@@ -118,6 +124,29 @@ class BertTokenizer : public mediapipe::tasks::text::tokenizers::Tokenizer {
   // subwords and offsets
   WordpieceTokenizerResult TokenizeWordpiece(const std::string& input) const;
 
+  // Perform tokenization and write the ids of the subwords to `ids`. See
+  // TokenizeWordpieceIds().
+  int TokenizeIds(const std::string& input, absl::Span<int32_t> ids) override {
+    return TokenizeWordpieceIds(input, ids);
+  }
+
+  // Perform tokenization and write the ids of the subwords to `ids`, until it
+  // is full. Returns the number of ids written. Produces the ids of the
+  // subwords of TokenizeWordpiece(), where subwords that are not in the vocab,
+  // e.g. a missing unknown token, get id 0. The subwords are matched with a
+  // trie of the vocab and never built as strings, except with
+  // split_unknown_chars. Input that is not valid UTF-8 may be split
+  // differently than by TokenizeWordpiece().
+  int TokenizeWordpieceIds(absl::string_view input,
+                           absl::Span<int32_t> ids) const;
+
+  // Tokenizes each of `inputs` into a row of `ids`, which holds
+  // inputs.size() rows of `row_size` ids, e.g. the buffer of an int32 tensor
+  // of shape [batch, row_size]. The rows are padded with id 0. Returns the
+  // number of ids of each input.
+  std::vector<int> TokenizeBatch(absl::Span<const std::string> inputs,
+                                 int row_size, absl::Span<int32_t> ids) const;
+
   // Check if a certain key is included in the vocab.
   tensorflow::text::LookupStatus Contains(const absl::string_view key,
                                           bool* value) const {
@@ -137,10 +166,16 @@ class BertTokenizer : public mediapipe::tasks::text::tokenizers::Tokenizer {
   int VocabularySize() const { return vocab_.VocabularySize(); }
 
  private:
+  // Writes the ids of the wordpieces of a single token to `ids`, until it is
+  // full, and returns the number of ids written.
+  int TokenizeTokenIds(absl::string_view token, absl::Span<int32_t> ids) const;
+
   mediapipe::tasks::text::tokenizers::FlatHashMapBackedWordpiece vocab_;
+  WordpieceTrie trie_;
   BertTokenizerOptions options_;
   RE2 delim_re_;
   RE2 include_delim_re_;
+  int unknown_token_id_ = 0;
 };
 
 }  // namespace tokenizers
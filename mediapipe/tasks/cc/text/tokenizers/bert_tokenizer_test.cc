@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/text/tokenizers/bert_tokenizer.h"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/tasks/cc/core/utils.h"
@@ -94,6 +99,79 @@ TEST(TokenizerTest, TestTokenizerUnknownTokens) {
   EXPECT_THAT(results.row_lengths, ElementsAre(1, 1, 1, 1));
 }
 
+// Returns the ids of the subwords of TokenizeWordpiece().
+std::vector<int32_t> LookupSubwordIds(const BertTokenizer& tokenizer,
+                                      const std::string& input) {
+  std::vector<int32_t> ids;
+  for (const std::string& subword :
+       tokenizer.TokenizeWordpiece(input).subwords) {
+    int id = 0;
+    tokenizer.LookupId(subword, &id);
+    ids.push_back(id);
+  }
+  return ids;
+}
+
+TEST(TokenizerTest, TestTokenizeWordpieceIdsMatchesSubwords) {
+  BertTokenizer tokenizer(kTestVocabPath);
+  for (const std::string input :
+       {"i'm questionansweraskask", "", "  hello, world!  ",
+        "supercalifragilisticexpialidocious", "naïve café 中文 ##ing",
+        "i'm xqzvwk qqqqqqqqqqq"}) {
+    std::vector<int32_t> ids(64, -1);
+    const int num_ids =
+        tokenizer.TokenizeWordpieceIds(input, absl::MakeSpan(ids));
+    ids.resize(num_ids);
+    EXPECT_EQ(ids, LookupSubwordIds(tokenizer, input)) << input;
+  }
+}
+
+TEST(TokenizerTest, TestTokenizeWordpieceIdsUnknownTokens) {
+  std::vector<std::string> vocab = {"i", "'", "m", "question", "[UNK]"};
+  BertTokenizer tokenizer(vocab);
+
+  std::vector<int32_t> ids(8);
+  const int num_ids = tokenizer.TokenizeWordpieceIds(
+      "i'm questionansweraskask", absl::MakeSpan(ids));
+
+  EXPECT_EQ(num_ids, 4);
+  EXPECT_THAT(ids, ElementsAre(0, 1, 2, 4, 0, 0, 0, 0));
+}
+
+TEST(TokenizerTest, TestTokenizeWordpieceIdsClipsToBuffer) {
+  BertTokenizer tokenizer(kTestVocabPath);
+  const std::string input = "i'm questionansweraskask";
+  const std::vector<int32_t> expected_ids = LookupSubwordIds(tokenizer, input);
+
+  std::vector<int32_t> ids(5);
+  const int num_ids =
+      tokenizer.TokenizeWordpieceIds(input, absl::MakeSpan(ids));
+
+  EXPECT_EQ(num_ids, 5);
+  EXPECT_EQ(ids, std::vector<int32_t>(expected_ids.begin(),
+                                      expected_ids.begin() + 5));
+}
+
+TEST(TokenizerTest, TestTokenizeBatch) {
+  BertTokenizer tokenizer(kTestVocabPath);
+  const std::vector<std::string> inputs = {"i'm question",
+                                           "i'm questionansweraskask"};
+  constexpr int kRowSize = 6;
+
+  std::vector<int32_t> ids(inputs.size() * kRowSize, -1);
+  const std::vector<int> num_ids =
+      tokenizer.TokenizeBatch(inputs, kRowSize, absl::MakeSpan(ids));
+
+  EXPECT_THAT(num_ids, ElementsAre(4, 6));
+  std::vector<int32_t> expected_ids = LookupSubwordIds(tokenizer, inputs[0]);
+  expected_ids.resize(kRowSize, 0);
+  const std::vector<int32_t> second_ids =
+      LookupSubwordIds(tokenizer, inputs[1]);
+  expected_ids.insert(expected_ids.end(), second_ids.begin(),
+                      second_ids.begin() + kRowSize);
+  EXPECT_EQ(ids, expected_ids);
+}
+
 TEST(TokenizerTest, TestLookupId) {
   std::vector<std::string> vocab;
   vocab.emplace_back("i");
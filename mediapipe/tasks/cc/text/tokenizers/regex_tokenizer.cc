@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/text/tokenizers/regex_tokenizer.h"
 
+#include <cstdint>
 #include <iostream>
+#include <string>
 
+#include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/types/span.h"
 #include "mediapipe/tasks/cc/text/utils/vocab_utils.h"
 
 namespace mediapipe {
@@ -42,6 +46,35 @@ void buildIndexTokenMap(
   }
 }
 
+// Calls `callback` with each non-empty token of `input` split by `delim_re`,
+// until it returns false.
+template <typename Callback>
+void ForEachToken(absl::string_view input, const RE2& delim_re,
+                  Callback callback) {
+  absl::string_view leftover = input;
+  absl::string_view last_end = leftover;
+
+  // Keep looking for split points until we have reached the end of the input.
+  absl::string_view extracted_delim_token;
+  while (RE2::FindAndConsume(&leftover, delim_re, &extracted_delim_token)) {
+    absl::string_view token(last_end.data(),
+                            extracted_delim_token.data() - last_end.data());
+    bool has_non_empty_token = token.length() > 0;
+
+    last_end = leftover;
+
+    // Mark the end of the previous token, only if there was something.
+    if (has_non_empty_token && !callback(token)) {
+      return;
+    }
+  }
+
+  // Close the last token.
+  if (!leftover.empty()) {
+    callback(leftover);
+  }
+}
+
 }  // namespace
 
 // RE2::FindAndConsume requires the delim_re_ to have a matching group in order
@@ -53,6 +86,7 @@ RegexTokenizer::RegexTokenizer(const std::string& regex_pattern,
     : delim_re_{absl::Substitute("($0)", regex_pattern)},
       token_index_map_{LoadVocabAndIndexFromFile(path_to_vocab)} {
   buildIndexTokenMap(token_index_map_, &index_token_map_);
+  GetUnknownToken(&unknown_token_id_);
 }
 
 RegexTokenizer::RegexTokenizer(const std::string& regex_pattern,
@@ -62,37 +96,31 @@ RegexTokenizer::RegexTokenizer(const std::string& regex_pattern,
       token_index_map_{
           LoadVocabAndIndexFromBuffer(vocab_buffer_data, vocab_buffer_size)} {
   buildIndexTokenMap(token_index_map_, &index_token_map_);
+  GetUnknownToken(&unknown_token_id_);
 }
 
 TokenizerResult RegexTokenizer::Tokenize(const std::string& input) {
-  absl::string_view leftover(input.data());
-  absl::string_view last_end = leftover;
-
   TokenizerResult result;
-
-  // Keep looking for split points until we have reached the end of the input.
-  absl::string_view extracted_delim_token;
-  while (RE2::FindAndConsume(&leftover, delim_re_, &extracted_delim_token)) {
-    absl::string_view token(last_end.data(),
-                            extracted_delim_token.data() - last_end.data());
-    bool has_non_empty_token = token.length() > 0;
-
-    last_end = leftover;
-
-    // Mark the end of the previous token, only if there was something.
-    if (has_non_empty_token) {
-      result.subwords.push_back(std::string(token));
-    }
-  }
-
-  // Close the last token.
-  if (!leftover.empty()) {
-    result.subwords.push_back(std::string(leftover));
-  }
-
+  ForEachToken(input.data(), delim_re_, [&result](absl::string_view token) {
+    result.subwords.push_back(std::string(token));
+    return true;
+  });
   return result;
 }
 
+int RegexTokenizer::TokenizeIds(const std::string& input,
+                                absl::Span<int32_t> ids) {
+  int num_ids = 0;
+  if (ids.empty()) return num_ids;
+  ForEachToken(input.data(), delim_re_, [&](absl::string_view token) {
+    auto it = token_index_map_.find(token);
+    ids[num_ids++] =
+        it == token_index_map_.end() ? unknown_token_id_ : it->second;
+    return num_ids < ids.size();
+  });
+  return num_ids;
+}
+
 bool RegexTokenizer::LookupId(absl::string_view key, int* result) const {
   auto it = token_index_map_.find(key);
   if (it == token_index_map_.end()) {
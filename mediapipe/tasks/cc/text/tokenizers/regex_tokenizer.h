@@ -17,10 +17,12 @@ limitations under the License.
 #define MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_REGEX_TOKENIZER_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
 
 #include "absl/container/node_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "mediapipe/tasks/cc/text/tokenizers/tokenizer.h"
 #include "re2/re2.h"
 
@@ -41,6 +43,11 @@ class RegexTokenizer : public Tokenizer {
 
   TokenizerResult Tokenize(const std::string& input) override;
 
+  // Looks up the tokens in place as they are split, without copying them.
+  // Tokens that are not in the vocab get the id of the <UNKNOWN> token, or 0 if
+  // the vocab has none.
+  int TokenizeIds(const std::string& input, absl::Span<int32_t> ids) override;
+
   bool LookupId(absl::string_view key, int* result) const override;
 
   bool LookupWord(int vocab_id, absl::string_view* result) const override;
@@ -53,6 +60,7 @@ class RegexTokenizer : public Tokenizer {
   RE2 delim_re_;
   absl::node_hash_map<std::string, int> token_index_map_;
   absl::node_hash_map<int, absl::string_view> index_token_map_;
+  int unknown_token_id_ = 0;
 };
 
 }  // namespace tokenizers
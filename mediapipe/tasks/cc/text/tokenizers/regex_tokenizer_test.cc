@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "mediapipe/tasks/cc/text/tokenizers/regex_tokenizer.h"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/tasks/cc/core/utils.h"
@@ -55,6 +60,23 @@ TEST(RegexTokenizerTest, TestTokenizeFromFileBuffer) {
               ElementsAre("good", "morning", "i'm", "your", "teacher"));
 }
 
+TEST(RegexTokenizerTest, TestTokenizeIds) {
+  auto tokenizer =
+      absl::make_unique<RegexTokenizer>(kRegex, kTestRegexVocabPath);
+  std::vector<int32_t> ids(8, -1);
+  int num_ids = tokenizer->TokenizeIds(
+      "good    morning, i'm your xqzvwk teacher.\n", absl::MakeSpan(ids));
+  EXPECT_EQ(num_ids, 6);
+  // Out-of-vocab tokens get the id of <UNKNOWN>.
+  EXPECT_THAT(ids, ElementsAre(52, 1972, 146, 129, 2, 1750, -1, -1));
+
+  // Tokenization stops when the ids are full.
+  num_ids = tokenizer->TokenizeIds("good morning, i'm your teacher.",
+                                   absl::MakeSpan(ids).first(2));
+  EXPECT_EQ(num_ids, 2);
+  EXPECT_THAT(ids, ElementsAre(52, 1972, 146, 129, 2, 1750, -1, -1));
+}
+
 TEST(RegexTokenizerTest, TestLookupId) {
   auto tokenizer =
       absl::make_unique<RegexTokenizer>(kRegex, kTestRegexVocabPath);
@@ -16,11 +16,14 @@ limitations under the License.
 #ifndef MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_TOKENIZER_H_
 #define MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_TOKENIZER_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <string>
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace mediapipe {
 namespace tasks {
@@ -37,6 +40,22 @@ class Tokenizer {
   // Perform tokenization to get tokenized results.
   virtual TokenizerResult Tokenize(const std::string& input) = 0;
 
+  // Perform tokenization and write the ids of the tokens to `ids`, until it is
+  // full. Returns the number of ids written. Tokens that are not in the vocab
+  // get the id of the unknown token of the tokenizer, which is 0 by default.
+  // Implementations may override this to avoid building the strings of the
+  // tokens.
+  virtual int TokenizeIds(const std::string& input, absl::Span<int32_t> ids) {
+    TokenizerResult result = Tokenize(input);
+    const int num_ids = std::min<int>(result.subwords.size(), ids.size());
+    for (int i = 0; i < num_ids; ++i) {
+      int id = 0;
+      LookupId(result.subwords[i], &id);
+      ids[i] = id;
+    }
+    return num_ids;
+  }
+
   // Find the id of a string token.
   virtual bool LookupId(absl::string_view key, int* result) const = 0;
 
@@ -0,0 +1,115 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/tokenizers/wordpiece_trie.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace tokenizers {
+
+namespace {
+
+// Whether a UTF-8 character starts at byte `pos` of `word`, or `pos` is the
+// end of `word`.
+bool IsCharBoundary(absl::string_view word, int pos) {
+  return pos == word.size() ||
+         (static_cast<uint8_t>(word[pos]) & 0xC0) != 0x80;
+}
+
+}  // namespace
+
+WordpieceTrie::WordpieceTrie(const std::vector<std::string>& vocab,
+                             absl::string_view suffix_indicator) {
+  // Builds a pointer-based trie first, then lays out the edges of each node
+  // contiguously.
+  std::vector<std::map<uint8_t, int>> children(2);
+  std::vector<int> ids(2, -1);
+  auto insert = [&](int root, absl::string_view word, int id) {
+    if (word.empty()) return;
+    int node = root;
+    for (char c : word) {
+      const auto [it, inserted] =
+          children[node].emplace(static_cast<uint8_t>(c), children.size());
+      const int child = it->second;
+      if (inserted) {
+        children.emplace_back();
+        ids.push_back(-1);
+      }
+      node = child;
+    }
+    ids[node] = id;
+  };
+  for (int i = 0; i < vocab.size(); ++i) {
+    absl::string_view word = vocab[i];
+    insert(/*root=*/0, word, i);
+    if (!suffix_indicator.empty() &&
+        absl::ConsumePrefix(&word, suffix_indicator)) {
+      insert(/*root=*/1, word, i);
+    }
+  }
+  nodes_.resize(children.size());
+  for (int node = 0; node < children.size(); ++node) {
+    nodes_[node].first_edge = edges_.size();
+    nodes_[node].num_edges = children[node].size();
+    nodes_[node].id = ids[node];
+    for (const auto& [byte, child] : children[node]) {
+      edges_.push_back({byte, child});
+    }
+  }
+  word_root_ = 0;
+  suffix_root_ = 1;
+}
+
+int WordpieceTrie::Child(int node, uint8_t byte) const {
+  const Edge* begin = edges_.data() + nodes_[node].first_edge;
+  const Edge* end = begin + nodes_[node].num_edges;
+  const Edge* edge = std::lower_bound(
+      begin, end, byte, [](const Edge& e, uint8_t b) { return e.byte < b; });
+  return edge != end && edge->byte == byte ? edge->child : -1;
+}
+
+int WordpieceTrie::LongestMatch(absl::string_view word, int start,
+                                int max_chars, int* id) const {
+  int node = start > 0 ? suffix_root_ : word_root_;
+  int match_end = -1;
+  int num_chars = 0;
+  for (int pos = start; pos < word.size();) {
+    node = Child(node, static_cast<uint8_t>(word[pos]));
+    if (node < 0) break;
+    ++pos;
+    if (!IsCharBoundary(word, pos)) continue;
+    if (nodes_[node].id >= 0) {
+      match_end = pos;
+      *id = nodes_[node].id;
+    }
+    if (++num_chars == max_chars) break;
+  }
+  return match_end;
+}
+
+}  // namespace tokenizers
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
@@ -0,0 +1,81 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_WORDPIECE_TRIE_H_
+#define MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_WORDPIECE_TRIE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace tokenizers {
+
+// A byte trie of a wordpiece vocabulary. Greedy longest-match-first wordpiece
+// tokenization, as done by tensorflow::text::WordpieceTokenize, looks up every
+// prefix of the remaining word from the longest to the shortest. The trie
+// finds the longest match in a single walk instead, without building or
+// hashing candidate strings.
+class WordpieceTrie {
+ public:
+  // Builds the trie of `vocab`, where the id of a word is its index. Words
+  // starting with `suffix_indicator` are also matched without it by pieces
+  // that continue a word. For duplicate words, the last id wins.
+  WordpieceTrie(const std::vector<std::string>& vocab,
+                absl::string_view suffix_indicator);
+
+  // Returns the end of the longest vocabulary word that matches `word` from
+  // byte `start`, sets `id` to its id, and returns -1 if there is none. Pieces
+  // with `start` > 0 are matched against the suffix words. Matches end at
+  // UTF-8 character boundaries and span at most `max_chars` characters, if
+  // positive.
+  int LongestMatch(absl::string_view word, int start, int max_chars,
+                   int* id) const;
+
+ private:
+  struct Node {
+    // The children of a node are edges_[first_edge, first_edge + num_edges),
+    // sorted by byte.
+    int first_edge = 0;
+    int num_edges = 0;
+    // The id of the word ending at the node, or -1.
+    int id = -1;
+  };
+
+  struct Edge {
+    uint8_t byte;
+    int child;
+  };
+
+  // Returns the child of `node` for `byte`, or -1.
+  int Child(int node, uint8_t byte) const;
+
+  std::vector<Node> nodes_;
+  std::vector<Edge> edges_;
+  // The roots of the tries of the words and of the suffix words.
+  int word_root_ = 0;
+  int suffix_root_ = 0;
+};
+
+}  // namespace tokenizers
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_TASKS_CC_TEXT_TOKENIZERS_WORDPIECE_TRIE_H_
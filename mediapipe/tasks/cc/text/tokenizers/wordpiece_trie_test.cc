@@ -0,0 +1,74 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/tokenizers/wordpiece_trie.h"
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace text {
+namespace tokenizers {
+namespace {
+
+const std::vector<std::string> kVocab = {"[UNK]", "question", "quest", "##ion",
+                                         "##s",   "a",        "##ab", "é",
+                                         "##é",   "##ée"};
+
+TEST(WordpieceTrieTest, MatchesLongestWord) {
+  WordpieceTrie trie(kVocab, "##");
+  int id = -1;
+  EXPECT_EQ(trie.LongestMatch("questions", 0, 100, &id), 8);
+  EXPECT_EQ(id, 1);
+  EXPECT_EQ(trie.LongestMatch("quests", 0, 100, &id), 5);
+  EXPECT_EQ(id, 2);
+  EXPECT_EQ(trie.LongestMatch("ques", 0, 100, &id), -1);
+}
+
+TEST(WordpieceTrieTest, MatchesSuffixWordsAfterStart) {
+  WordpieceTrie trie(kVocab, "##");
+  int id = -1;
+  EXPECT_EQ(trie.LongestMatch("questions", 8, 100, &id), 9);
+  EXPECT_EQ(id, 4);
+  EXPECT_EQ(trie.LongestMatch("xion", 1, 100, &id), 4);
+  EXPECT_EQ(id, 3);
+  // Words are not matched as suffixes, nor suffixes as words.
+  EXPECT_EQ(trie.LongestMatch("xa", 1, 100, &id), -1);
+  EXPECT_EQ(trie.LongestMatch("ion", 0, 100, &id), -1);
+  // Suffix words still match literally at the start.
+  EXPECT_EQ(trie.LongestMatch("##ion", 0, 100, &id), 5);
+  EXPECT_EQ(id, 3);
+}
+
+TEST(WordpieceTrieTest, LimitsMatchesToMaxChars) {
+  WordpieceTrie trie(kVocab, "##");
+  int id = -1;
+  EXPECT_EQ(trie.LongestMatch("question", 0, 7, &id), 5);
+  EXPECT_EQ(id, 2);
+  // "ée" is three bytes but two characters.
+  EXPECT_EQ(trie.LongestMatch("aée", 1, 2, &id), 4);
+  EXPECT_EQ(id, 9);
+  EXPECT_EQ(trie.LongestMatch("aée", 1, 1, &id), 3);
+  EXPECT_EQ(id, 8);
+}
+
+}  // namespace
+}  // namespace tokenizers
+}  // namespace text
+}  // namespace tasks
+}  // namespace mediapipe
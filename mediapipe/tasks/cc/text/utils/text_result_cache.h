@@ -0,0 +1,206 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef MEDIAPIPE_TASKS_CC_TEXT_UTILS_TEXT_RESULT_CACHE_H_
+#define MEDIAPIPE_TASKS_CC_TEXT_UTILS_TEXT_RESULT_CACHE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/util/resource_cache.h"
+
+namespace mediapipe::tasks::text::utils {
+
+// Returns "text" with leading and trailing whitespace removed, and inner runs
+// of whitespace collapsed to one space, which the text models' tokenizers do
+// not distinguish.
+std::string NormalizeTextForCache(absl::string_view text);
+
+struct TextResultCacheOptions {
+  // Maximum total size of the cached entries, in bytes, as estimated by the
+  // callers of Insert, plus the size of their keys.
+  size_t max_bytes = 64 << 20;
+
+  // Number of independently locked parts of the cache, so that concurrent
+  // callers rarely contend. Each part gets an equal share of max_bytes.
+  int num_shards = 16;
+
+  // Every this many requests to a shard, the request counts of its entries are
+  // halved, and the entries that were not requested since the previous time
+  // are removed, so that formerly popular texts do not stay forever.
+  int request_count_scrub_interval = 1 << 14;
+};
+
+struct TextResultCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  // Entries removed to stay within max_bytes, or by scrubbing.
+  int64_t evictions = 0;
+  int64_t entries = 0;
+  size_t bytes = 0;
+};
+
+// A bounded, thread-safe cache of the results of a text task, such as the
+// embeddings computed by TextEmbedder, so that popular inputs are not
+// tokenized and run through the model again.
+//
+// Results are keyed by the normalized text (see NormalizeTextForCache) and
+// a fingerprint of the model and task options that produced them, so that a
+// cache may be shared by several tasks. Each shard keeps its entries in a
+// ResourceCache ordered by request count, and evicts the least requested ones
+// when it exceeds its share of the byte budget.
+template <typename Result>
+class TextResultCache {
+ public:
+  explicit TextResultCache(const TextResultCacheOptions& options = {})
+      : shard_max_bytes_(options.max_bytes /
+                         std::max(options.num_shards, 1)),
+        request_count_scrub_interval_(options.request_count_scrub_interval),
+        shards_(std::max(options.num_shards, 1)) {}
+
+  TextResultCache(const TextResultCache&) = delete;
+  TextResultCache& operator=(const TextResultCache&) = delete;
+
+  // Returns the result cached for "text" under "model_fingerprint", if any.
+  // A miss is expected to be followed by an Insert of the computed result.
+  std::optional<Result> Lookup(uint64_t model_fingerprint,
+                               absl::string_view text) {
+    Key key(model_fingerprint, NormalizeTextForCache(text));
+    Shard& shard = ShardFor(key);
+    std::shared_ptr<const CachedResult> cached;
+    {
+      absl::MutexLock lock(&shard.mutex);
+      cached = shard.cache.Lookup(
+          key, [](const Key&, int) { return std::shared_ptr<CachedResult>(); });
+      if (cached) {
+        ++shard.hits;
+      } else {
+        ++shard.misses;
+      }
+      ScrubLocked(shard);
+    }
+    if (!cached) return std::nullopt;
+    return cached->result;
+  }
+
+  // Caches "result" for "text" under "model_fingerprint", unless a result is
+  // already cached for them. "bytes" estimates the memory used by "result".
+  // Results larger than the share of a shard are not cached.
+  void Insert(uint64_t model_fingerprint, absl::string_view text,
+              Result result, size_t bytes) {
+    Key key(model_fingerprint, NormalizeTextForCache(text));
+    bytes += sizeof(CachedResult) + key.second.size();
+    if (bytes > shard_max_bytes_) return;
+    auto cached = std::make_shared<CachedResult>(
+        CachedResult{std::move(result), bytes});
+    Shard& shard = ShardFor(key);
+    absl::MutexLock lock(&shard.mutex);
+    // Makes room first, so that the new result is cached even if it was
+    // requested less than the others.
+    while (shard.bytes + bytes > shard_max_bytes_ && shard.cache.size() > 0) {
+      RemoveLocked(shard, shard.cache.EvictLeastRequested());
+    }
+    bool inserted = false;
+    // The insertion counts as a request for the text.
+    shard.cache.Lookup(key, [&](const Key&, int) {
+      inserted = true;
+      return cached;
+    });
+    if (!inserted) return;
+    shard.bytes += bytes;
+    ++shard.entries;
+  }
+
+  TextResultCacheStats GetStats() {
+    TextResultCacheStats stats;
+    for (Shard& shard : shards_) {
+      absl::MutexLock lock(&shard.mutex);
+      stats.hits += shard.hits;
+      stats.misses += shard.misses;
+      stats.evictions += shard.evictions;
+      stats.entries += shard.entries;
+      stats.bytes += shard.bytes;
+    }
+    return stats;
+  }
+
+ private:
+  using Key = std::pair<uint64_t, std::string>;
+
+  struct CachedResult {
+    Result result;
+    size_t bytes;
+  };
+
+  struct Shard {
+    absl::Mutex mutex;
+    ResourceCache<Key, std::shared_ptr<const CachedResult>> cache
+        ABSL_GUARDED_BY(mutex);
+    size_t bytes ABSL_GUARDED_BY(mutex) = 0;
+    int64_t entries ABSL_GUARDED_BY(mutex) = 0;
+    int64_t hits ABSL_GUARDED_BY(mutex) = 0;
+    int64_t misses ABSL_GUARDED_BY(mutex) = 0;
+    int64_t evictions ABSL_GUARDED_BY(mutex) = 0;
+  };
+
+  // Uses another hash than the shards' maps, whose buckets would otherwise
+  // all share the bits that chose the shard.
+  Shard& ShardFor(const Key& key) {
+    const size_t hash =
+        std::hash<std::string>()(key.second) ^ (key.first * 0x9e3779b97f4a7c15);
+    return shards_[hash % shards_.size()];
+  }
+
+  // Accounts for an entry removed from the cache of "shard". Entries without
+  // a result are misses whose result was never inserted.
+  void RemoveLocked(Shard& shard,
+                    const std::shared_ptr<const CachedResult>& removed)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex) {
+    if (!removed) return;
+    shard.bytes -= removed->bytes;
+    --shard.entries;
+    ++shard.evictions;
+  }
+
+  void ScrubLocked(Shard& shard) ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex) {
+    if (!shard.cache.NeedsEviction(std::numeric_limits<int>::max(),
+                                   request_count_scrub_interval_)) {
+      return;
+    }
+    for (const auto& removed : shard.cache.Evict(
+             std::numeric_limits<int>::max(), request_count_scrub_interval_)) {
+      RemoveLocked(shard, removed);
+    }
+  }
+
+  const size_t shard_max_bytes_;
+  const int request_count_scrub_interval_;
+  std::vector<Shard> shards_;
+};
+
+}  // namespace mediapipe::tasks::text::utils
+
+#endif  // MEDIAPIPE_TASKS_CC_TEXT_UTILS_TEXT_RESULT_CACHE_H_
@@ -0,0 +1,130 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "mediapipe/tasks/cc/text/utils/text_result_cache.h"
+
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe::tasks::text::utils {
+namespace {
+
+using ::testing::Optional;
+
+constexpr uint64_t kModel = 1234;
+
+TEST(NormalizeTextForCacheTest, CollapsesWhitespace) {
+  EXPECT_EQ(NormalizeTextForCache("  hello \t\n world  "), "hello world");
+  EXPECT_EQ(NormalizeTextForCache("Hello"), "Hello");
+  EXPECT_EQ(NormalizeTextForCache(" \n "), "");
+}
+
+TEST(TextResultCacheTest, CachesByNormalizedTextAndModel) {
+  TextResultCache<int> cache;
+  EXPECT_EQ(cache.Lookup(kModel, "hello world"), std::nullopt);
+  cache.Insert(kModel, "hello world", 42, sizeof(int));
+
+  EXPECT_THAT(cache.Lookup(kModel, "hello world"), Optional(42));
+  EXPECT_THAT(cache.Lookup(kModel, " hello  world\n"), Optional(42));
+  EXPECT_EQ(cache.Lookup(kModel + 1, "hello world"), std::nullopt);
+  EXPECT_EQ(cache.Lookup(kModel, "Hello world"), std::nullopt);
+
+  TextResultCacheStats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 3);
+  EXPECT_EQ(stats.entries, 1);
+  EXPECT_GT(stats.bytes, 0);
+}
+
+TEST(TextResultCacheTest, KeepsFirstInsertedResult) {
+  TextResultCache<int> cache;
+  cache.Insert(kModel, "text", 1, sizeof(int));
+  cache.Insert(kModel, "text", 2, sizeof(int));
+  EXPECT_THAT(cache.Lookup(kModel, "text"), Optional(1));
+  EXPECT_EQ(cache.GetStats().entries, 1);
+}
+
+TEST(TextResultCacheTest, EvictsLeastRequestedOverByteLimit) {
+  TextResultCache<std::string> cache(
+      {/*max_bytes=*/4096, /*num_shards=*/1,
+       /*request_count_scrub_interval=*/1 << 20});
+  const std::string large(1000, 'x');
+  cache.Insert(kModel, "a", large, large.size());
+  cache.Insert(kModel, "b", large, large.size());
+  cache.Insert(kModel, "c", large, large.size());
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(cache.Lookup(kModel, "a").has_value());
+    ASSERT_TRUE(cache.Lookup(kModel, "c").has_value());
+  }
+  cache.Insert(kModel, "d", large, large.size());
+
+  EXPECT_EQ(cache.Lookup(kModel, "b"), std::nullopt);
+  EXPECT_TRUE(cache.Lookup(kModel, "a").has_value());
+  EXPECT_TRUE(cache.Lookup(kModel, "c").has_value());
+  TextResultCacheStats stats = cache.GetStats();
+  EXPECT_EQ(stats.evictions, 1);
+  EXPECT_EQ(stats.entries, 3);
+  EXPECT_LE(stats.bytes, 4096);
+}
+
+TEST(TextResultCacheTest, SkipsResultsLargerThanShard) {
+  TextResultCache<std::string> cache({/*max_bytes=*/1024, /*num_shards=*/1});
+  cache.Insert(kModel, "text", std::string(2000, 'x'), 2000);
+  EXPECT_EQ(cache.Lookup(kModel, "text"), std::nullopt);
+  EXPECT_EQ(cache.GetStats().entries, 0);
+}
+
+TEST(TextResultCacheTest, ScrubsRarelyRequestedEntries) {
+  TextResultCache<int> cache({/*max_bytes=*/1 << 20, /*num_shards=*/1,
+                              /*request_count_scrub_interval=*/8});
+  cache.Insert(kModel, "once", 1, sizeof(int));
+  cache.Insert(kModel, "often", 2, sizeof(int));
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_TRUE(cache.Lookup(kModel, "often").has_value());
+  }
+  EXPECT_EQ(cache.Lookup(kModel, "once"), std::nullopt);
+  EXPECT_THAT(cache.Lookup(kModel, "often"), Optional(2));
+  EXPECT_EQ(cache.GetStats().evictions, 1);
+}
+
+TEST(TextResultCacheTest, ConcurrentCallers) {
+  TextResultCache<int> cache({/*max_bytes=*/1 << 16, /*num_shards=*/4});
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&cache] {
+      for (int i = 0; i < 1000; ++i) {
+        const std::string text = std::to_string(i % 50);
+        std::optional<int> result = cache.Lookup(kModel, text);
+        if (result.has_value()) {
+          EXPECT_EQ(*result, i % 50);
+        } else {
+          cache.Insert(kModel, text, i % 50, sizeof(int));
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  TextResultCacheStats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits + stats.misses, 4000);
+  EXPECT_EQ(stats.entries, 50);
+}
+
+}  // namespace
+}  // namespace mediapipe::tasks::text::utils
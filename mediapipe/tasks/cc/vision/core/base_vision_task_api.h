@@ -21,6 +21,7 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -62,6 +63,21 @@ class BaseVisionTaskApi : public tasks::core::BaseTaskApi {
     return runner_->Process(std::move(inputs));
   }
 
+  // A synchronous method to process a batch of single image inputs, see
+  // BaseTaskApi::ProcessBatch.
+  absl::StatusOr<std::vector<tasks::core::PacketMap>> ProcessImageDataBatch(
+      std::vector<tasks::core::PacketMap> inputs) {
+    if (running_mode_ != RunningMode::IMAGE) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          absl::StrCat("Task is not initialized with the image mode. Current "
+                       "running mode:",
+                       GetRunningModeName(running_mode_)),
+          MediaPipeTasksStatus::kRunnerApiCalledInWrongModeError);
+    }
+    return ProcessBatch(std::move(inputs));
+  }
+
   // A synchronous method to process continuous video frames.
   // The call blocks the current thread until a failure status or a successful
   // result is returned.
@@ -50,6 +50,8 @@ class VisionTaskApiFactory {
       std::unique_ptr<tflite::OpResolver> resolver, RunningMode running_mode,
       tasks::core::PacketsCallback packets_callback = nullptr) {
     bool found_task_subgraph = false;
+    bool load_model_asynchronously = false;
+    bool enable_profiler = false;
     for (const auto& node : graph_config.node()) {
       if (node.calculator() == "FlowLimiterCalculator") {
         continue;
@@ -68,8 +70,19 @@ class VisionTaskApiFactory {
               MediaPipeTasksStatus::kInvalidTaskGraphConfigError);
         }
         found_task_subgraph = true;
+        load_model_asynchronously = node.options()
+                                        .GetExtension(Options::ext)
+                                        .base_options()
+                                        .load_model_asynchronously();
+        enable_profiler = node.options()
+                              .GetExtension(Options::ext)
+                              .base_options()
+                              .enable_profiler();
       }
     }
+    if (enable_profiler) {
+      graph_config.mutable_profiler_config()->set_enable_profiler(true);
+    }
     if (running_mode == RunningMode::LIVE_STREAM) {
       if (packets_callback == nullptr) {
         return CreateStatusWithPayload(
@@ -88,7 +101,8 @@ class VisionTaskApiFactory {
     ASSIGN_OR_RETURN(auto runner,
                      tasks::core::TaskRunner::Create(
                          std::move(graph_config), std::move(resolver),
-                         std::move(packets_callback)));
+                         std::move(packets_callback),
+                         load_model_asynchronously));
     return std::make_unique<T>(std::move(runner), running_mode);
   }
 };
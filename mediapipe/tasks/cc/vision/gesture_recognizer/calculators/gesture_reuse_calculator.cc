@@ -0,0 +1,267 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/gesture_reuse_calculator.pb.h"
+
+namespace mediapipe {
+namespace api2 {
+namespace {
+
+// Returns the largest displacement along x or y between the landmarks of the
+// two lists, or infinity if they don't have the same number of landmarks.
+float MaxLandmarkDelta(const NormalizedLandmarkList& a,
+                       const NormalizedLandmarkList& b) {
+  if (a.landmark_size() != b.landmark_size()) {
+    return std::numeric_limits<float>::infinity();
+  }
+  float max_delta = 0.0f;
+  for (int i = 0; i < a.landmark_size(); ++i) {
+    max_delta = std::max(
+        {max_delta, std::abs(a.landmark(i).x() - b.landmark(i).x()),
+         std::abs(a.landmark(i).y() - b.landmark(i).y())});
+  }
+  return max_delta;
+}
+
+}  // namespace
+
+// Selects the hands whose gestures need to be recognized again, and provides
+// the previous gestures of the other ones, so that the gesture models can be
+// skipped for hands that barely moved.
+//
+// The gestures of a hand are reused while its landmarks stay within
+// landmark_delta_threshold of the landmarks its gestures were last recognized
+// on, for at most max_reuse_frames consecutive frames. Comparing with the
+// landmarks of the last recognition, rather than of the previous frame, also
+// catches slow motions.
+//
+// The previous gestures are the final gestures of the previous frame, looped
+// back with a PreviousLoopbackCalculator. Hands are recognized again whenever
+// they are missing.
+//
+// Inputs:
+//   LANDMARKS - std::vector<NormalizedLandmarkList>
+//     The landmarks of the hands.
+//   HAND_TRACKING_IDS - std::vector<int>
+//     The tracking ids of the hands, which index the LANDMARKS.
+//   PREV_HAND_GESTURES - std::vector<ClassificationList> @Optional
+//     The gestures of the hands of the previous frame.
+//
+// Outputs:
+//   HAND_TRACKING_IDS - std::vector<int>
+//     The tracking ids of the hands to recognize the gestures of, in input
+//     order.
+//   REUSED_HAND_GESTURES - std::vector<ClassificationList>
+//     For each input tracking id, the reused gestures, or an empty list if the
+//     gestures are recognized again.
+//
+// Example:
+// node {
+//   calculator: "GestureReuseCalculator"
+//   input_stream: "LANDMARKS:landmarks"
+//   input_stream: "HAND_TRACKING_IDS:hand_tracking_ids"
+//   input_stream: "PREV_HAND_GESTURES:prev_hand_gestures"
+//   output_stream: "HAND_TRACKING_IDS:recognized_hand_tracking_ids"
+//   output_stream: "REUSED_HAND_GESTURES:reused_hand_gestures"
+//   options {
+//     [mediapipe.GestureReuseCalculatorOptions.ext] {
+//       landmark_delta_threshold: 0.01
+//       max_reuse_frames: 10
+//     }
+//   }
+// }
+class GestureReuseCalculator : public Node {
+ public:
+  static constexpr Input<std::vector<NormalizedLandmarkList>> kLandmarksIn{
+      "LANDMARKS"};
+  static constexpr Input<std::vector<int>> kHandTrackingIdsIn{
+      "HAND_TRACKING_IDS"};
+  static constexpr Input<std::vector<ClassificationList>>::Optional
+      kPrevHandGesturesIn{"PREV_HAND_GESTURES"};
+  static constexpr Output<std::vector<int>> kHandTrackingIdsOut{
+      "HAND_TRACKING_IDS"};
+  static constexpr Output<std::vector<ClassificationList>>
+      kReusedHandGesturesOut{"REUSED_HAND_GESTURES"};
+
+  MEDIAPIPE_NODE_CONTRACT(kLandmarksIn, kHandTrackingIdsIn,
+                          kPrevHandGesturesIn, kHandTrackingIdsOut,
+                          kReusedHandGesturesOut);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<GestureReuseCalculatorOptions>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kLandmarksIn(cc).IsEmpty() || kHandTrackingIdsIn(cc).IsEmpty()) {
+      hands_.clear();
+      prev_hand_tracking_ids_.clear();
+      return absl::OkStatus();
+    }
+    const auto& landmarks = *kLandmarksIn(cc);
+    const auto& hand_tracking_ids = *kHandTrackingIdsIn(cc);
+
+    // The previous gestures are indexed like the previous tracking ids.
+    absl::flat_hash_map<int, const ClassificationList*> prev_gestures;
+    if (!kPrevHandGesturesIn(cc).IsEmpty() &&
+        kPrevHandGesturesIn(cc)->size() == prev_hand_tracking_ids_.size()) {
+      for (int i = 0; i < prev_hand_tracking_ids_.size(); ++i) {
+        prev_gestures[prev_hand_tracking_ids_[i]] =
+            &(*kPrevHandGesturesIn(cc))[i];
+      }
+    }
+
+    absl::flat_hash_map<int, HandState> hands;
+    std::vector<int> recognized_ids;
+    std::vector<ClassificationList> reused_gestures(hand_tracking_ids.size());
+    for (int i = 0; i < hand_tracking_ids.size(); ++i) {
+      const int id = hand_tracking_ids[i];
+      RET_CHECK(id >= 0 && id < landmarks.size())
+          << "Invalid hand tracking id: " << id;
+      const auto hand_it = hands_.find(id);
+      const auto gestures_it = prev_gestures.find(id);
+      if (hand_it != hands_.end() && gestures_it != prev_gestures.end() &&
+          hand_it->second.reuse_count < options_.max_reuse_frames() &&
+          MaxLandmarkDelta(hand_it->second.landmarks, landmarks[id]) <=
+              options_.landmark_delta_threshold()) {
+        reused_gestures[i] = *gestures_it->second;
+        HandState& hand = hands[id];
+        hand.landmarks = std::move(hand_it->second.landmarks);
+        hand.reuse_count = hand_it->second.reuse_count + 1;
+      } else {
+        recognized_ids.push_back(id);
+        hands[id].landmarks = landmarks[id];
+      }
+    }
+    // Hands that are gone are forgotten.
+    hands_ = std::move(hands);
+    prev_hand_tracking_ids_ = hand_tracking_ids;
+
+    kHandTrackingIdsOut(cc).Send(std::move(recognized_ids));
+    kReusedHandGesturesOut(cc).Send(std::move(reused_gestures));
+    return absl::OkStatus();
+  }
+
+ private:
+  struct HandState {
+    // The landmarks the gestures were last recognized on.
+    NormalizedLandmarkList landmarks;
+    // The number of consecutive frames the gestures were reused for.
+    int reuse_count = 0;
+  };
+
+  GestureReuseCalculatorOptions options_;
+  absl::flat_hash_map<int, HandState> hands_;
+  std::vector<int> prev_hand_tracking_ids_;
+};
+MEDIAPIPE_REGISTER_NODE(GestureReuseCalculator);
+
+// Merges the gestures recognized for the hands selected by a
+// GestureReuseCalculator with the gestures it reused for the other ones.
+//
+// Inputs:
+//   HAND_TRACKING_IDS - std::vector<int>
+//     The tracking ids of all the hands.
+//   RECOGNIZED_HAND_TRACKING_IDS - std::vector<int>
+//     The tracking ids of the hands whose gestures were recognized, in the
+//     order of HAND_TRACKING_IDS.
+//   REUSED_HAND_GESTURES - std::vector<ClassificationList>
+//     For each tracking id, the reused gestures.
+//   RECOGNIZED_HAND_GESTURES - std::vector<ClassificationList>
+//     For each recognized tracking id, the recognized gestures. May be missing
+//     when no hand was recognized.
+//
+// Outputs:
+//   HAND_GESTURES - std::vector<ClassificationList>
+//     For each tracking id, the gestures of the hand.
+//
+// Example:
+// node {
+//   calculator: "GestureReuseMergeCalculator"
+//   input_stream: "HAND_TRACKING_IDS:hand_tracking_ids"
+//   input_stream: "RECOGNIZED_HAND_TRACKING_IDS:recognized_hand_tracking_ids"
+//   input_stream: "REUSED_HAND_GESTURES:reused_hand_gestures"
+//   input_stream: "RECOGNIZED_HAND_GESTURES:recognized_hand_gestures"
+//   output_stream: "HAND_GESTURES:hand_gestures"
+// }
+class GestureReuseMergeCalculator : public Node {
+ public:
+  static constexpr Input<std::vector<int>> kHandTrackingIdsIn{
+      "HAND_TRACKING_IDS"};
+  static constexpr Input<std::vector<int>> kRecognizedHandTrackingIdsIn{
+      "RECOGNIZED_HAND_TRACKING_IDS"};
+  static constexpr Input<std::vector<ClassificationList>>
+      kReusedHandGesturesIn{"REUSED_HAND_GESTURES"};
+  static constexpr Input<std::vector<ClassificationList>>
+      kRecognizedHandGesturesIn{"RECOGNIZED_HAND_GESTURES"};
+  static constexpr Output<std::vector<ClassificationList>> kHandGesturesOut{
+      "HAND_GESTURES"};
+
+  MEDIAPIPE_NODE_CONTRACT(kHandTrackingIdsIn, kRecognizedHandTrackingIdsIn,
+                          kReusedHandGesturesIn, kRecognizedHandGesturesIn,
+                          kHandGesturesOut);
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kHandTrackingIdsIn(cc).IsEmpty() ||
+        kRecognizedHandTrackingIdsIn(cc).IsEmpty() ||
+        kReusedHandGesturesIn(cc).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    const auto& hand_tracking_ids = *kHandTrackingIdsIn(cc);
+    const auto& recognized_ids = *kRecognizedHandTrackingIdsIn(cc);
+    const auto& reused_gestures = *kReusedHandGesturesIn(cc);
+    static const auto* const kNoGestures =
+        new std::vector<ClassificationList>();
+    const auto& recognized_gestures = kRecognizedHandGesturesIn(cc).IsEmpty()
+                                          ? *kNoGestures
+                                          : *kRecognizedHandGesturesIn(cc);
+    RET_CHECK_EQ(reused_gestures.size(), hand_tracking_ids.size());
+    RET_CHECK_EQ(recognized_gestures.size(), recognized_ids.size());
+
+    std::vector<ClassificationList> hand_gestures;
+    hand_gestures.reserve(hand_tracking_ids.size());
+    int next_recognized = 0;
+    for (int i = 0; i < hand_tracking_ids.size(); ++i) {
+      if (next_recognized < recognized_ids.size() &&
+          recognized_ids[next_recognized] == hand_tracking_ids[i]) {
+        hand_gestures.push_back(recognized_gestures[next_recognized++]);
+      } else {
+        hand_gestures.push_back(reused_gestures[i]);
+      }
+    }
+    RET_CHECK_EQ(next_recognized, recognized_ids.size())
+        << "Recognized hand tracking ids are not in input order.";
+    kHandGesturesOut(cc).Send(std::move(hand_gestures));
+    return absl::OkStatus();
+  }
+};
+MEDIAPIPE_REGISTER_NODE(GestureReuseMergeCalculator);
+
+}  // namespace api2
+}  // namespace mediapipe
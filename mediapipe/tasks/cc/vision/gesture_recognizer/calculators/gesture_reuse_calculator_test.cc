@@ -0,0 +1,182 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kHandTrackingIdsTag[] = "HAND_TRACKING_IDS";
+constexpr char kReusedHandGesturesTag[] = "REUSED_HAND_GESTURES";
+
+NormalizedLandmarkList MakeLandmarks(float x, float y) {
+  NormalizedLandmarkList landmarks;
+  auto* landmark = landmarks.add_landmark();
+  landmark->set_x(x);
+  landmark->set_y(y);
+  return landmarks;
+}
+
+ClassificationList MakeGestures(const std::string& label) {
+  ClassificationList gestures;
+  gestures.add_classification()->set_label(label);
+  return gestures;
+}
+
+class GestureReuseCalculatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    runner_ = std::make_unique<CalculatorRunner>(
+        ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+          calculator: "GestureReuseCalculator"
+          input_stream: "LANDMARKS:landmarks"
+          input_stream: "HAND_TRACKING_IDS:hand_tracking_ids"
+          input_stream: "PREV_HAND_GESTURES:prev_hand_gestures"
+          output_stream: "HAND_TRACKING_IDS:recognized_hand_tracking_ids"
+          output_stream: "REUSED_HAND_GESTURES:reused_hand_gestures"
+          options {
+            [mediapipe.GestureReuseCalculatorOptions.ext] {
+              landmark_delta_threshold: 0.01
+              max_reuse_frames: 2
+            }
+          }
+        )pb"));
+  }
+
+  // Adds the landmarks of two hands, with tracking ids 0 and 1, at the given
+  // timestamp. The previous gestures are "zero" and "one".
+  void AddFrame(float x0, float x1, int64 timestamp) {
+    runner_->MutableInputs()->Tag("LANDMARKS").packets.push_back(
+        MakePacket<std::vector<NormalizedLandmarkList>>(
+            std::vector<NormalizedLandmarkList>{MakeLandmarks(x0, 0.5f),
+                                                MakeLandmarks(x1, 0.5f)})
+            .At(Timestamp(timestamp)));
+    runner_->MutableInputs()
+        ->Tag(kHandTrackingIdsTag)
+        .packets.push_back(MakePacket<std::vector<int>>(std::vector<int>{0, 1})
+                               .At(Timestamp(timestamp)));
+    if (timestamp > 0) {
+      runner_->MutableInputs()
+          ->Tag("PREV_HAND_GESTURES")
+          .packets.push_back(MakePacket<std::vector<ClassificationList>>(
+                                 std::vector<ClassificationList>{
+                                     MakeGestures("zero"), MakeGestures("one")})
+                                 .At(Timestamp(timestamp)));
+    }
+  }
+
+  std::vector<int> RecognizedIds(int frame) {
+    return runner_->Outputs()
+        .Tag(kHandTrackingIdsTag)
+        .packets[frame]
+        .Get<std::vector<int>>();
+  }
+
+  std::unique_ptr<CalculatorRunner> runner_;
+};
+
+TEST_F(GestureReuseCalculatorTest, ReusesGesturesOfStillHands) {
+  AddFrame(0.5f, 0.5f, 0);
+  // Hand 0 stays still, hand 1 moves.
+  AddFrame(0.505f, 0.6f, 1);
+  MP_ASSERT_OK(runner_->Run());
+
+  ASSERT_EQ(runner_->Outputs().Tag(kHandTrackingIdsTag).packets.size(), 2);
+  EXPECT_EQ(RecognizedIds(0), std::vector<int>({0, 1}));
+  EXPECT_EQ(RecognizedIds(1), std::vector<int>({1}));
+  const auto& reused_gestures = runner_->Outputs()
+                                    .Tag(kReusedHandGesturesTag)
+                                    .packets[1]
+                                    .Get<std::vector<ClassificationList>>();
+  ASSERT_EQ(reused_gestures.size(), 2);
+  EXPECT_EQ(reused_gestures[0].classification(0).label(), "zero");
+  EXPECT_EQ(reused_gestures[1].classification_size(), 0);
+}
+
+TEST_F(GestureReuseCalculatorTest, ComparesWithLastRecognizedLandmarks) {
+  AddFrame(0.5f, 0.5f, 0);
+  // Hand 0 drifts slowly, hand 1 stays still.
+  AddFrame(0.508f, 0.5f, 1);
+  AddFrame(0.516f, 0.5f, 2);
+  MP_ASSERT_OK(runner_->Run());
+
+  EXPECT_EQ(RecognizedIds(1), std::vector<int>());
+  EXPECT_EQ(RecognizedIds(2), std::vector<int>({0}));
+}
+
+TEST_F(GestureReuseCalculatorTest, LimitsReuseFrames) {
+  for (int t = 0; t < 5; ++t) AddFrame(0.5f, 0.5f, t);
+  MP_ASSERT_OK(runner_->Run());
+
+  EXPECT_EQ(RecognizedIds(1), std::vector<int>());
+  EXPECT_EQ(RecognizedIds(2), std::vector<int>());
+  EXPECT_EQ(RecognizedIds(3), std::vector<int>({0, 1}));
+  EXPECT_EQ(RecognizedIds(4), std::vector<int>());
+}
+
+TEST(GestureReuseMergeCalculatorTest, MergesRecognizedAndReusedGestures) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "GestureReuseMergeCalculator"
+    input_stream: "HAND_TRACKING_IDS:hand_tracking_ids"
+    input_stream: "RECOGNIZED_HAND_TRACKING_IDS:recognized_hand_tracking_ids"
+    input_stream: "REUSED_HAND_GESTURES:reused_hand_gestures"
+    input_stream: "RECOGNIZED_HAND_GESTURES:recognized_hand_gestures"
+    output_stream: "HAND_GESTURES:hand_gestures"
+  )pb"));
+  runner.MutableInputs()
+      ->Tag(kHandTrackingIdsTag)
+      .packets.push_back(MakePacket<std::vector<int>>(std::vector<int>{0, 1, 2})
+                             .At(Timestamp(0)));
+  runner.MutableInputs()
+      ->Tag("RECOGNIZED_HAND_TRACKING_IDS")
+      .packets.push_back(
+          MakePacket<std::vector<int>>(std::vector<int>{1}).At(Timestamp(0)));
+  runner.MutableInputs()
+      ->Tag(kReusedHandGesturesTag)
+      .packets.push_back(MakePacket<std::vector<ClassificationList>>(
+                             std::vector<ClassificationList>{
+                                 MakeGestures("zero"), ClassificationList(),
+                                 MakeGestures("two")})
+                             .At(Timestamp(0)));
+  runner.MutableInputs()
+      ->Tag("RECOGNIZED_HAND_GESTURES")
+      .packets.push_back(MakePacket<std::vector<ClassificationList>>(
+                             std::vector<ClassificationList>{
+                                 MakeGestures("one")})
+                             .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag("HAND_GESTURES").packets;
+  ASSERT_EQ(packets.size(), 1);
+  const auto& hand_gestures = packets[0].Get<std::vector<ClassificationList>>();
+  ASSERT_EQ(hand_gestures.size(), 3);
+  EXPECT_EQ(hand_gestures[0].classification(0).label(), "zero");
+  EXPECT_EQ(hand_gestures[1].classification(0).label(), "one");
+  EXPECT_EQ(hand_gestures[2].classification(0).label(), "two");
+}
+
+}  // namespace
+
+}  // namespace mediapipe
@@ -109,6 +109,10 @@ class GestureRecognizer : tasks::vision::core::BaseVisionTaskApi {
  public:
   using BaseVisionTaskApi::BaseVisionTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates a GestureRecognizer from a GestureRecognizerhOptions to process
   // image data or streaming data. Gesture recognizer can be created with one of
   // the following three running modes:
@@ -31,7 +31,6 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/model_resources_cache.h"
 #include "mediapipe/tasks/cc/core/model_task_graph.h"
 #include "mediapipe/tasks/cc/core/utils.h"
-#include "mediapipe/tasks/cc/metadata/utils/zip_utils.h"
 #include "mediapipe/tasks/cc/vision/gesture_recognizer/proto/gesture_recognizer_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/gesture_recognizer/proto/hand_gesture_recognizer_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/hand_detector/proto/hand_detector_graph_options.pb.h"
@@ -51,7 +50,6 @@ using ::mediapipe::api2::Output;
 using ::mediapipe::api2::builder::Graph;
 using ::mediapipe::api2::builder::Source;
 using ::mediapipe::tasks::core::ModelAssetBundleResources;
-using ::mediapipe::tasks::metadata::SetExternalFile;
 using ::mediapipe::tasks::vision::gesture_recognizer::proto::
     GestureRecognizerGraphOptions;
 using ::mediapipe::tasks::vision::gesture_recognizer::proto::
@@ -83,29 +81,28 @@ struct GestureRecognizerOutputs {
 absl::Status SetSubTaskBaseOptions(const ModelAssetBundleResources& resources,
                                    GestureRecognizerGraphOptions* options,
                                    bool is_copy) {
-  ASSIGN_OR_RETURN(const auto hand_landmarker_file,
-                   resources.GetModelFile(kHandLandmarkerBundleAssetName));
   auto* hand_landmarker_graph_options =
       options->mutable_hand_landmarker_graph_options();
-  SetExternalFile(hand_landmarker_file,
-                  hand_landmarker_graph_options->mutable_base_options()
-                      ->mutable_model_asset(),
-                  is_copy);
+  MP_RETURN_IF_ERROR(resources.SetModelExternalFile(
+      kHandLandmarkerBundleAssetName,
+      hand_landmarker_graph_options->mutable_base_options()
+          ->mutable_model_asset(),
+      is_copy));
   hand_landmarker_graph_options->mutable_base_options()
       ->mutable_acceleration()
       ->CopyFrom(options->base_options().acceleration());
   hand_landmarker_graph_options->mutable_base_options()->set_use_stream_mode(
       options->base_options().use_stream_mode());
+  hand_landmarker_graph_options->mutable_base_options()->set_warm_up(
+      options->base_options().warm_up());
 
-  ASSIGN_OR_RETURN(
-      const auto hand_gesture_recognizer_file,
-      resources.GetModelFile(kHandGestureRecognizerBundleAssetName));
   auto* hand_gesture_recognizer_graph_options =
       options->mutable_hand_gesture_recognizer_graph_options();
-  SetExternalFile(hand_gesture_recognizer_file,
-                  hand_gesture_recognizer_graph_options->mutable_base_options()
-                      ->mutable_model_asset(),
-                  is_copy);
+  MP_RETURN_IF_ERROR(resources.SetModelExternalFile(
+      kHandGestureRecognizerBundleAssetName,
+      hand_gesture_recognizer_graph_options->mutable_base_options()
+          ->mutable_model_asset(),
+      is_copy));
   hand_gesture_recognizer_graph_options->mutable_base_options()
       ->mutable_acceleration()
       ->CopyFrom(options->base_options().acceleration());
@@ -123,6 +120,8 @@ absl::Status SetSubTaskBaseOptions(const ModelAssetBundleResources& resources,
   }
   hand_gesture_recognizer_graph_options->mutable_base_options()
       ->set_use_stream_mode(options->base_options().use_stream_mode());
+  hand_gesture_recognizer_graph_options->mutable_base_options()->set_warm_up(
+      options->base_options().warm_up());
   return absl::OkStatus();
 }
 
@@ -200,7 +199,7 @@ class GestureRecognizerGraph : public core::ModelTaskGraph {
           CreateModelAssetBundleResources<GestureRecognizerGraphOptions>(sc));
       // When the model resources cache service is available, filling in
       // the file pointer meta in the subtasks' base options. Otherwise,
-      // providing the file contents instead.
+      // providing the region of the bundle file or the file contents instead.
       MP_RETURN_IF_ERROR(SetSubTaskBaseOptions(
           *model_asset_bundle_resources,
           sc->MutableOptions<GestureRecognizerGraphOptions>(),
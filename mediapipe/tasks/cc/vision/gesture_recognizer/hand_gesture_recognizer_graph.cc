@@ -37,8 +37,8 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/proto/external_file.pb.h"
 #include "mediapipe/tasks/cc/core/proto/inference_subgraph.pb.h"
 #include "mediapipe/tasks/cc/core/utils.h"
-#include "mediapipe/tasks/cc/metadata/utils/zip_utils.h"
 #include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/combined_prediction_calculator.pb.h"
+#include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/gesture_reuse_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/gesture_recognizer/calculators/landmarks_to_matrix_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/gesture_recognizer/proto/gesture_classifier_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/gesture_recognizer/proto/gesture_embedder_graph_options.pb.h"
@@ -54,13 +54,13 @@ namespace {
 
 using ::mediapipe::api2::Input;
 using ::mediapipe::api2::Output;
+using ::mediapipe::api2::builder::GenericNode;
 using ::mediapipe::api2::builder::Graph;
 using ::mediapipe::api2::builder::Source;
 using ::mediapipe::tasks::components::processors::
     ConfigureTensorsToClassificationCalculator;
 using ::mediapipe::tasks::core::ModelAssetBundleResources;
 using ::mediapipe::tasks::core::proto::BaseOptions;
-using ::mediapipe::tasks::metadata::SetExternalFile;
 using ::mediapipe::tasks::vision::gesture_recognizer::proto::
     HandGestureRecognizerGraphOptions;
 
@@ -81,6 +81,11 @@ constexpr char kIndexTag[] = "INDEX";
 constexpr char kIterableTag[] = "ITERABLE";
 constexpr char kBatchEndTag[] = "BATCH_END";
 constexpr char kPredictionTag[] = "PREDICTION";
+constexpr char kReusedHandGesturesTag[] = "REUSED_HAND_GESTURES";
+constexpr char kRecognizedHandTrackingIdsTag[] =
+    "RECOGNIZED_HAND_TRACKING_IDS";
+constexpr char kRecognizedHandGesturesTag[] = "RECOGNIZED_HAND_GESTURES";
+constexpr char kPreviousLoopbackCalculatorName[] = "PreviousLoopbackCalculator";
 constexpr char kBackgroundLabel[] = "None";
 constexpr char kGestureEmbedderTFLiteName[] = "gesture_embedder.tflite";
 constexpr char kCannedGestureClassifierTFLiteName[] =
@@ -116,6 +121,7 @@ void PopulateAccelerationAndUseStreamMode(
       parent_base_options.acceleration());
   sub_task_base_options->set_use_stream_mode(
       parent_base_options.use_stream_mode());
+  sub_task_base_options->set_warm_up(parent_base_options.warm_up());
 }
 
 }  // namespace
@@ -177,7 +183,7 @@ class SingleHandGestureRecognizerGraph : public core::ModelTaskGraph {
               sc));
       // When the model resources cache service is available, filling in
       // the file pointer meta in the subtasks' base options. Otherwise,
-      // providing the file contents instead.
+      // providing the region of the bundle file or the file contents instead.
       MP_RETURN_IF_ERROR(SetSubTaskBaseOptions(
           *model_asset_bundle_resources,
           sc->MutableOptions<HandGestureRecognizerGraphOptions>(),
@@ -205,43 +211,37 @@ class SingleHandGestureRecognizerGraph : public core::ModelTaskGraph {
   absl::Status SetSubTaskBaseOptions(const ModelAssetBundleResources& resources,
                                      HandGestureRecognizerGraphOptions* options,
                                      bool is_copy) {
-    ASSIGN_OR_RETURN(const auto gesture_embedder_file,
-                     resources.GetModelFile(kGestureEmbedderTFLiteName));
     auto* gesture_embedder_graph_options =
         options->mutable_gesture_embedder_graph_options();
-    SetExternalFile(gesture_embedder_file,
-                    gesture_embedder_graph_options->mutable_base_options()
-                        ->mutable_model_asset(),
-                    is_copy);
+    MP_RETURN_IF_ERROR(resources.SetModelExternalFile(
+        kGestureEmbedderTFLiteName,
+        gesture_embedder_graph_options->mutable_base_options()
+            ->mutable_model_asset(),
+        is_copy));
     PopulateAccelerationAndUseStreamMode(
         options->base_options(),
         gesture_embedder_graph_options->mutable_base_options());
 
-    ASSIGN_OR_RETURN(
-        const auto canned_gesture_classifier_file,
-        resources.GetModelFile(kCannedGestureClassifierTFLiteName));
     auto* canned_gesture_classifier_graph_options =
         options->mutable_canned_gesture_classifier_graph_options();
-    SetExternalFile(
-        canned_gesture_classifier_file,
+    MP_RETURN_IF_ERROR(resources.SetModelExternalFile(
+        kCannedGestureClassifierTFLiteName,
         canned_gesture_classifier_graph_options->mutable_base_options()
             ->mutable_model_asset(),
-        is_copy);
+        is_copy));
     PopulateAccelerationAndUseStreamMode(
         options->base_options(),
         canned_gesture_classifier_graph_options->mutable_base_options());
 
-    const auto custom_gesture_classifier_file =
-        resources.GetModelFile(kCustomGestureClassifierTFLiteName);
-    if (custom_gesture_classifier_file.ok()) {
+    if (resources.GetModelFile(kCustomGestureClassifierTFLiteName).ok()) {
       has_custom_gesture_classifier = true;
       auto* custom_gesture_classifier_graph_options =
           options->mutable_custom_gesture_classifier_graph_options();
-      SetExternalFile(
-          custom_gesture_classifier_file.value(),
+      MP_RETURN_IF_ERROR(resources.SetModelExternalFile(
+          kCustomGestureClassifierTFLiteName,
           custom_gesture_classifier_graph_options->mutable_base_options()
               ->mutable_model_asset(),
-          is_copy);
+          is_copy));
       PopulateAccelerationAndUseStreamMode(
           options->base_options(),
           custom_gesture_classifier_graph_options->mutable_base_options());
@@ -358,8 +358,7 @@ class SingleHandGestureRecognizerGraph : public core::ModelTaskGraph {
     auto& gesture_embedder_inference =
         AddInference(*sub_task_model_resources.gesture_embedder_model_resource,
                      graph_options.gesture_embedder_graph_options()
-                         .base_options()
-                         .acceleration(),
+                         .base_options(),
                      graph);
     concatenated_tensors >> gesture_embedder_inference.In(kTensorsTag);
     auto embedding_tensors =
@@ -402,7 +401,7 @@ class SingleHandGestureRecognizerGraph : public core::ModelTaskGraph {
       const proto::GestureClassifierGraphOptions& options,
       Source<Tensor>& embedding_tensors, Graph& graph) {
     auto& gesture_classifier_inference = AddInference(
-        *model_resources, options.base_options().acceleration(), graph);
+        *model_resources, options.base_options(), graph);
     embedding_tensors >> gesture_classifier_inference.In(kTensorsTag);
     auto gesture_inference_out_tensors =
         gesture_classifier_inference.Out(kTensorsTag);
@@ -452,6 +451,10 @@ REGISTER_MEDIAPIPE_GRAPH(
 //     A vector of recognized hand gestures. Each vector element is the
 //     ClassificationList of the hand in input vector.
 //
+// When gesture_reuse_options are set in stream mode, the gestures of the hands
+// whose landmarks barely moved are reused from the previous frame instead of
+// being recognized again.
+//
 //
 // Example:
 // node {
@@ -492,7 +495,19 @@ class MultipleHandGestureRecognizerGraph : public core::ModelTaskGraph {
             graph[Input<std::vector<int>>(kHandTrackingIdsTag)], graph));
     multi_hand_gestures >>
         graph[Output<std::vector<ClassificationList>>(kHandGesturesTag)];
-    return graph.GetConfig();
+
+    // TODO remove when support is fixed.
+    // As mediapipe GraphBuilder currently doesn't support configuring
+    // InputStreamInfo, modifying the CalculatorGraphConfig proto directly.
+    CalculatorGraphConfig config = graph.GetConfig();
+    for (int i = 0; i < config.node_size(); ++i) {
+      if (config.node(i).calculator() == kPreviousLoopbackCalculatorName) {
+        auto* info = config.mutable_node(i)->add_input_stream_info();
+        info->set_tag_index("LOOP");
+        info->set_back_edge(true);
+      }
+    }
+    return config;
   }
 
  private:
@@ -504,13 +519,33 @@ class MultipleHandGestureRecognizerGraph : public core::ModelTaskGraph {
       Source<std::vector<LandmarkList>> multi_hand_world_landmarks,
       Source<std::pair<int, int>> image_size, Source<NormalizedRect> norm_rect,
       Source<std::vector<int>> multi_hand_tracking_ids, Graph& graph) {
+    // Selects the hands to recognize the gestures of, and reuses the previous
+    // gestures of the others.
+    Source<std::vector<int>> recognized_hand_tracking_ids =
+        multi_hand_tracking_ids;
+    GenericNode* gesture_reuse = nullptr;
+    if (graph_options.has_gesture_reuse_options() &&
+        graph_options.base_options().use_stream_mode()) {
+      gesture_reuse = &graph.AddNode("GestureReuseCalculator");
+      auto& reuse_options =
+          gesture_reuse->GetOptions<GestureReuseCalculatorOptions>();
+      reuse_options.set_landmark_delta_threshold(
+          graph_options.gesture_reuse_options().landmark_delta_threshold());
+      reuse_options.set_max_reuse_frames(
+          graph_options.gesture_reuse_options().max_reuse_frames());
+      multi_hand_landmarks >> gesture_reuse->In(kLandmarksTag);
+      multi_hand_tracking_ids >> gesture_reuse->In(kHandTrackingIdsTag);
+      recognized_hand_tracking_ids =
+          gesture_reuse->Out(kHandTrackingIdsTag).Cast<std::vector<int>>();
+    }
+
     auto& begin_loop_int = graph.AddNode("BeginLoopIntCalculator");
     image_size >> begin_loop_int.In(kCloneTag)[0];
     norm_rect >> begin_loop_int.In(kCloneTag)[1];
     multi_handedness >> begin_loop_int.In(kCloneTag)[2];
     multi_hand_landmarks >> begin_loop_int.In(kCloneTag)[3];
     multi_hand_world_landmarks >> begin_loop_int.In(kCloneTag)[4];
-    multi_hand_tracking_ids >> begin_loop_int.In(kIterableTag);
+    recognized_hand_tracking_ids >> begin_loop_int.In(kIterableTag);
     auto image_size_clone = begin_loop_int.Out(kCloneTag)[0];
     auto norm_rect_clone = begin_loop_int.Out(kCloneTag)[1];
     auto multi_handedness_clone = begin_loop_int.Out(kCloneTag)[2];
@@ -560,6 +595,26 @@ class MultipleHandGestureRecognizerGraph : public core::ModelTaskGraph {
         end_loop_classification_lists[Output<std::vector<ClassificationList>>(
             kIterableTag)];
 
+    if (gesture_reuse != nullptr) {
+      auto& gesture_reuse_merge = graph.AddNode("GestureReuseMergeCalculator");
+      multi_hand_tracking_ids >> gesture_reuse_merge.In(kHandTrackingIdsTag);
+      recognized_hand_tracking_ids >>
+          gesture_reuse_merge.In(kRecognizedHandTrackingIdsTag);
+      gesture_reuse->Out(kReusedHandGesturesTag) >>
+          gesture_reuse_merge.In(kReusedHandGesturesTag);
+      multi_hand_gestures >> gesture_reuse_merge.In(kRecognizedHandGesturesTag);
+      multi_hand_gestures =
+          gesture_reuse_merge[Output<std::vector<ClassificationList>>(
+              kHandGesturesTag)];
+
+      // Loops the gestures back, to be reused on the next frame.
+      auto& previous_loopback = graph.AddNode(kPreviousLoopbackCalculatorName);
+      multi_hand_tracking_ids >> previous_loopback.In("MAIN");
+      multi_hand_gestures >> previous_loopback.In("LOOP");
+      previous_loopback.Out("PREV_LOOP") >>
+          gesture_reuse->In("PREV_HAND_GESTURES");
+    }
+
     return multi_hand_gestures;
   }
 };
@@ -251,7 +251,7 @@ class HandDetectorGraph : public core::ModelTaskGraph {
 
     // Adds SSD palm detection model.
     auto& inference = AddInference(
-        model_resources, subgraph_options.base_options().acceleration(), graph);
+        model_resources, subgraph_options.base_options(), graph);
     preprocessed_tensors >> inference.In("TENSORS");
     auto model_output_tensors = inference.Out("TENSORS");
 
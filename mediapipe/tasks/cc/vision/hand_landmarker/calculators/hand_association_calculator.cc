@@ -86,6 +86,10 @@ class HandAssociationCalculator : public CalculatorBase {
   absl::StatusOr<std::vector<NormalizedRect>> GetNonOverlappingElements(
       CalculatorContext* cc) {
     std::vector<NormalizedRect> result;
+    std::vector<Rectangle_f> result_rectangles;
+    // Indexes the kept rects, so that each rect is only compared with the
+    // kept rects it intersects.
+    RectangleIndex index;
 
     for (const auto& input_stream : cc->Inputs()) {
       if (input_stream.IsEmpty()) {
@@ -93,15 +97,22 @@ class HandAssociationCalculator : public CalculatorBase {
       }
 
       for (auto rect : input_stream.Get<std::vector<NormalizedRect>>()) {
-        ASSIGN_OR_RETURN(
-            bool is_overlapping,
-            mediapipe::DoesRectOverlap(rect, result,
-                                       options_.min_similarity_threshold()));
+        ASSIGN_OR_RETURN(Rectangle_f rectangle, ToRectangle(rect));
+        bool is_overlapping = false;
+        for (int i : index.Query(rectangle)) {
+          if (CalculateIou(result_rectangles[i], rectangle) >
+              options_.min_similarity_threshold()) {
+            is_overlapping = true;
+            break;
+          }
+        }
         if (!is_overlapping) {
           if (!rect.has_rect_id()) {
             rect.set_rect_id(GetNextRectId());
           }
+          index.Insert(result.size(), rectangle);
           result.push_back(rect);
+          result_rectangles.push_back(rectangle);
         }
       }
     }
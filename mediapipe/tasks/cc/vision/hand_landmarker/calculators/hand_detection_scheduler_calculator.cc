@@ -0,0 +1,170 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/tasks/cc/vision/hand_landmarker/calculators/hand_detection_scheduler_calculator.pb.h"
+
+namespace mediapipe::api2 {
+
+namespace {
+
+constexpr int kNumCorners = 4;
+
+// Returns the `corner`-th corner of `rect`, in clockwise order from the top
+// left, with `size` times its width and height.
+NormalizedRect GetCornerRect(const NormalizedRect& rect, int corner,
+                             float size,
+                             const std::pair<int, int>& image_size) {
+  const float offset = (1.0f - size) / 2;
+  const float local_x =
+      (corner == 0 || corner == 3 ? -offset : offset) * rect.width();
+  const float local_y = (corner < 2 ? -offset : offset) * rect.height();
+  // The offset is rotated in pixels, since the rect is rotated on the image.
+  const float width = image_size.first;
+  const float height = image_size.second;
+  const float cos_angle = std::cos(rect.rotation());
+  const float sin_angle = std::sin(rect.rotation());
+  NormalizedRect corner_rect = rect;
+  corner_rect.set_x_center(
+      rect.x_center() +
+      (cos_angle * local_x * width - sin_angle * local_y * height) / width);
+  corner_rect.set_y_center(
+      rect.y_center() +
+      (sin_angle * local_x * width + cos_angle * local_y * height) / height);
+  corner_rect.set_width(rect.width() * size);
+  corner_rect.set_height(rect.height() * size);
+  return corner_rect;
+}
+
+}  // namespace
+
+// Decides when the hand detector runs while hands are tracked, and on which
+// region of the image. It runs on the whole region of interest whenever
+// fewer than `num_hands` hands are tracked, at most every `detection_interval`
+// frames, and as soon as the presence score of a tracked hand falls below
+// `min_tracked_presence_score`. Optionally, on the frames in between, it runs
+// on a corner of the region in turn, where new hands are likely to come in.
+//
+// Inputs:
+//   NORM_RECT - NormalizedRect
+//     The region of interest of the frame.
+//   IMAGE_SIZE - std::pair<int, int>
+//     The size of the frame.
+//   PREV_HAND_RECTS - std::vector<NormalizedRect> @Optional
+//     The rects of the hands tracked from the previous frame.
+//   PREV_PRESENCE_SCORES - std::vector<float> @Optional
+//     The presence scores of the hands tracked from the previous frame.
+//
+// Outputs:
+//   DETECT - bool
+//     Whether the hand detector runs on the frame.
+//   DETECTION_RECT - NormalizedRect
+//     The region to run the hand detector on, only sent when it runs.
+//
+// Example:
+// node {
+//   calculator: "HandDetectionSchedulerCalculator"
+//   input_stream: "NORM_RECT:norm_rect"
+//   input_stream: "IMAGE_SIZE:image_size"
+//   input_stream: "PREV_HAND_RECTS:prev_hand_rects"
+//   input_stream: "PREV_PRESENCE_SCORES:prev_presence_scores"
+//   output_stream: "DETECT:detect"
+//   output_stream: "DETECTION_RECT:detection_rect"
+//   options {
+//     [mediapipe.HandDetectionSchedulerCalculatorOptions.ext] {
+//       num_hands: 2
+//       detection_interval: 5
+//       corner_region_size: 0.5
+//     }
+//   }
+// }
+class HandDetectionSchedulerCalculator : public Node {
+ public:
+  static constexpr Input<NormalizedRect> kInNormRect{"NORM_RECT"};
+  static constexpr Input<std::pair<int, int>> kInImageSize{"IMAGE_SIZE"};
+  static constexpr Input<std::vector<NormalizedRect>>::Optional
+      kInPrevHandRects{"PREV_HAND_RECTS"};
+  static constexpr Input<std::vector<float>>::Optional kInPrevPresenceScores{
+      "PREV_PRESENCE_SCORES"};
+  static constexpr Output<bool> kOutDetect{"DETECT"};
+  static constexpr Output<NormalizedRect> kOutDetectionRect{"DETECTION_RECT"};
+  MEDIAPIPE_NODE_CONTRACT(kInNormRect, kInImageSize, kInPrevHandRects,
+                          kInPrevPresenceScores, kOutDetect,
+                          kOutDetectionRect);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<HandDetectionSchedulerCalculatorOptions>();
+    RET_CHECK_GT(options_.num_hands(), 0);
+    RET_CHECK_GT(options_.detection_interval(), 0);
+    RET_CHECK(options_.corner_region_size() >= 0 &&
+              options_.corner_region_size() <= 1);
+    // The first frame runs the detector on the whole region.
+    frames_since_detection_ = options_.detection_interval();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kInNormRect(cc).IsEmpty() || kInImageSize(cc).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    const int num_tracked_hands =
+        kInPrevHandRects(cc).IsEmpty() ? 0 : kInPrevHandRects(cc)->size();
+    bool presence_dropped = false;
+    if (!kInPrevPresenceScores(cc).IsEmpty()) {
+      for (float score : *kInPrevPresenceScores(cc)) {
+        presence_dropped |= score < options_.min_tracked_presence_score();
+      }
+    }
+
+    frames_since_detection_ =
+        std::min(frames_since_detection_ + 1, options_.detection_interval());
+    const bool missing_hands = num_tracked_hands < options_.num_hands();
+    if (presence_dropped ||
+        (missing_hands &&
+         frames_since_detection_ >= options_.detection_interval())) {
+      frames_since_detection_ = 0;
+      kOutDetect(cc).Send(true);
+      kOutDetectionRect(cc).Send(*kInNormRect(cc));
+    } else if (missing_hands && options_.corner_region_size() > 0) {
+      kOutDetect(cc).Send(true);
+      kOutDetectionRect(cc).Send(
+          GetCornerRect(*kInNormRect(cc), next_corner_,
+                        options_.corner_region_size(), *kInImageSize(cc)));
+      next_corner_ = (next_corner_ + 1) % kNumCorners;
+    } else {
+      kOutDetect(cc).Send(false);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  HandDetectionSchedulerCalculatorOptions options_;
+  int frames_since_detection_ = 0;
+  int next_corner_ = 0;
+};
+
+MEDIAPIPE_REGISTER_NODE(HandDetectionSchedulerCalculator);
+
+}  // namespace mediapipe::api2
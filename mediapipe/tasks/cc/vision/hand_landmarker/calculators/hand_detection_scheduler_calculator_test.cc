@@ -0,0 +1,135 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+CalculatorGraphConfig::Node BuildNode(int detection_interval,
+                                      float corner_region_size) {
+  return ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::StrFormat(
+      R"pb(
+        calculator: "HandDetectionSchedulerCalculator"
+        input_stream: "NORM_RECT:norm_rect"
+        input_stream: "IMAGE_SIZE:image_size"
+        input_stream: "PREV_HAND_RECTS:prev_hand_rects"
+        input_stream: "PREV_PRESENCE_SCORES:prev_presence_scores"
+        output_stream: "DETECT:detect"
+        output_stream: "DETECTION_RECT:detection_rect"
+        options {
+          [mediapipe.HandDetectionSchedulerCalculatorOptions.ext] {
+            num_hands: 2
+            detection_interval: %d
+            min_tracked_presence_score: 0.5
+            corner_region_size: %f
+          }
+        }
+      )pb",
+      detection_interval, corner_region_size));
+}
+
+// Adds a frame with `num_tracked_hands` hands tracked from the previous frame,
+// with the given presence score.
+void AddFrame(int frame, int num_tracked_hands, float presence_score,
+              CalculatorRunner* runner) {
+  NormalizedRect norm_rect;
+  norm_rect.set_x_center(0.5);
+  norm_rect.set_y_center(0.5);
+  norm_rect.set_width(1);
+  norm_rect.set_height(1);
+  auto* inputs = runner->MutableInputs();
+  inputs->Tag("NORM_RECT").packets.push_back(
+      MakePacket<NormalizedRect>(norm_rect).At(Timestamp(frame)));
+  inputs->Tag("IMAGE_SIZE").packets.push_back(
+      MakePacket<std::pair<int, int>>(200, 100).At(Timestamp(frame)));
+  inputs->Tag("PREV_HAND_RECTS").packets.push_back(
+      MakePacket<std::vector<NormalizedRect>>(num_tracked_hands, norm_rect)
+          .At(Timestamp(frame)));
+  inputs->Tag("PREV_PRESENCE_SCORES").packets.push_back(
+      MakePacket<std::vector<float>>(num_tracked_hands, presence_score)
+          .At(Timestamp(frame)));
+}
+
+std::vector<bool> GetDetectFlags(const CalculatorRunner& runner) {
+  std::vector<bool> flags;
+  for (const Packet& packet : runner.Outputs().Tag("DETECT").packets) {
+    flags.push_back(packet.Get<bool>());
+  }
+  return flags;
+}
+
+TEST(HandDetectionSchedulerCalculatorTest, DetectsEveryIntervalWhileMissing) {
+  CalculatorRunner runner(BuildNode(/*detection_interval=*/3,
+                                    /*corner_region_size=*/0));
+  AddFrame(0, /*num_tracked_hands=*/0, 1.0, &runner);
+  AddFrame(1, /*num_tracked_hands=*/1, 1.0, &runner);
+  AddFrame(2, /*num_tracked_hands=*/2, 1.0, &runner);
+  AddFrame(3, /*num_tracked_hands=*/1, 1.0, &runner);
+  AddFrame(4, /*num_tracked_hands=*/1, 1.0, &runner);
+  AddFrame(5, /*num_tracked_hands=*/1, 1.0, &runner);
+  MP_ASSERT_OK(runner.Run());
+
+  EXPECT_THAT(GetDetectFlags(runner),
+              testing::ElementsAre(true, false, false, true, false, false));
+  EXPECT_EQ(runner.Outputs().Tag("DETECTION_RECT").packets.size(), 2);
+}
+
+TEST(HandDetectionSchedulerCalculatorTest, DetectsOnPresenceDrop) {
+  CalculatorRunner runner(BuildNode(/*detection_interval=*/10,
+                                    /*corner_region_size=*/0));
+  AddFrame(0, /*num_tracked_hands=*/0, 1.0, &runner);
+  AddFrame(1, /*num_tracked_hands=*/2, 0.9, &runner);
+  AddFrame(2, /*num_tracked_hands=*/2, 0.4, &runner);
+  MP_ASSERT_OK(runner.Run());
+
+  EXPECT_THAT(GetDetectFlags(runner), testing::ElementsAre(true, false, true));
+}
+
+TEST(HandDetectionSchedulerCalculatorTest, DetectsCornersInBetween) {
+  CalculatorRunner runner(BuildNode(/*detection_interval=*/10,
+                                    /*corner_region_size=*/0.5));
+  for (int frame = 0; frame < 3; ++frame) {
+    AddFrame(frame, /*num_tracked_hands=*/0, 1.0, &runner);
+  }
+  MP_ASSERT_OK(runner.Run());
+
+  EXPECT_THAT(GetDetectFlags(runner), testing::ElementsAre(true, true, true));
+  const auto& rects = runner.Outputs().Tag("DETECTION_RECT").packets;
+  ASSERT_EQ(rects.size(), 3);
+  EXPECT_FLOAT_EQ(rects[0].Get<NormalizedRect>().width(), 1);
+  // The top left corner, then the top right one.
+  const auto& top_left = rects[1].Get<NormalizedRect>();
+  EXPECT_FLOAT_EQ(top_left.x_center(), 0.25);
+  EXPECT_FLOAT_EQ(top_left.y_center(), 0.25);
+  EXPECT_FLOAT_EQ(top_left.width(), 0.5);
+  EXPECT_FLOAT_EQ(top_left.height(), 0.5);
+  const auto& top_right = rects[2].Get<NormalizedRect>();
+  EXPECT_FLOAT_EQ(top_right.x_center(), 0.75);
+  EXPECT_FLOAT_EQ(top_right.y_center(), 0.25);
+}
+
+}  // namespace
+}  // namespace mediapipe
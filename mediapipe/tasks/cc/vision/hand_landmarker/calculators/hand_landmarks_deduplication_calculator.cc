@@ -34,9 +34,11 @@ limitations under the License.
 #include "mediapipe/framework/formats/classification.pb.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
 #include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/rectangle.h"
 #include "mediapipe/tasks/cc/components/containers/rect.h"
 #include "mediapipe/tasks/cc/vision/utils/landmarks_duplicates_finder.h"
 #include "mediapipe/tasks/cc/vision/utils/landmarks_utils.h"
+#include "mediapipe/util/rectangle_util.h"
 
 namespace mediapipe::api2 {
 namespace {
@@ -150,6 +152,11 @@ RectF CalculateBound(const NormalizedLandmarkList& list) {
                /*bottom=*/bounding_box_bottom};
 }
 
+Rectangle_f BoundToRectangle(const RectF& rect) {
+  return Rectangle_f(rect.left, rect.top, rect.right - rect.left,
+                     rect.bottom - rect.top);
+}
+
 // Uses IoU and distance of some corresponding hand landmarks to detect
 // duplicate / similar hands. IoU, distance thresholds, number of landmarks to
 // match are found experimentally. Evaluated:
@@ -166,7 +173,6 @@ class HandDuplicatesFinder : public DuplicatesFinder {
   absl::StatusOr<absl::flat_hash_set<int>> FindDuplicates(
       const std::vector<NormalizedLandmarkList>& multi_landmarks,
       int input_width, int input_height) override {
-    absl::flat_hash_set<int> retained_indices;
     absl::flat_hash_set<int> suppressed_indices;
 
     const int num = multi_landmarks.size();
@@ -180,12 +186,16 @@ class HandDuplicatesFinder : public DuplicatesFinder {
       baseline_distances.push_back(baseline_distance);
       bounds.push_back(CalculateBound(list));
     }
+    // Indexes the bounds of the retained hands. Suppressing a hand requires a
+    // positive IoU, so only the retained hands intersecting it are compared.
+    RectangleIndex retained_index;
 
     for (int index = 0; index < num; ++index) {
       const int i = start_from_the_end_ ? num - index - 1 : index;
       const float stable_distance_i = baseline_distances[i];
+      const Rectangle_f bound_i = BoundToRectangle(bounds[i]);
       bool suppressed = false;
-      for (int j : retained_indices) {
+      for (int j : retained_index.Query(bound_i)) {
         const float stable_distance_j = baseline_distances[j];
 
         constexpr float kAllowedBaselineDistanceRatio = 0.2f;
@@ -214,7 +224,7 @@ class HandDuplicatesFinder : public DuplicatesFinder {
       if (suppressed) {
         suppressed_indices.insert(i);
       } else {
-        retained_indices.insert(i);
+        retained_index.Insert(i, bound_i);
       }
     }
     return suppressed_indices;
@@ -0,0 +1,259 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/vision/hand_landmarker/calculators/tensors_to_hand_landmarks_calculator.pb.h"
+
+namespace mediapipe::api2 {
+
+namespace {
+
+constexpr int kNumTensors = 4;
+constexpr int kNumDimensions = 3;
+// The handedness score is the probability of the first label.
+constexpr char kLeftLabel[] = "Left";
+constexpr char kRightLabel[] = "Right";
+
+// Checks that `tensor` holds `values_per_item` float values for each of
+// `num_items` items.
+absl::Status CheckTensor(const Tensor& tensor, int num_items,
+                         int values_per_item) {
+  RET_CHECK(tensor.element_type() == Tensor::ElementType::kFloat32);
+  RET_CHECK_EQ(tensor.shape().num_elements(), num_items * values_per_item);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// Decodes the output tensors of the hand landmark model run on a batch of hand
+// crops, e.g. as produced by ImageToTensorCalculator with NORM_RECTS. This does
+// for all hands at once what TensorsToLandmarksCalculator,
+// LandmarkLetterboxRemovalCalculator, LandmarkProjectionCalculator,
+// WorldLandmarkProjectionCalculator, TensorsToFloatsCalculator,
+// ThresholdingCalculator and TensorsToClassificationCalculator do for a single
+// hand, with the same results.
+//
+// Inputs:
+//   TENSORS - std::vector<Tensor>
+//     The landmarks, presence score, handedness and world landmarks tensors of
+//     the model, each with a leading dimension of the number of hands.
+//   NORM_RECTS - std::vector<NormalizedRect>
+//     The hand rects the crops were extracted from.
+//   LETTERBOX_PADDINGS - std::vector<std::array<float, 4>>
+//     The letterbox paddings of the crops.
+//
+// Outputs:
+//   LANDMARKS - std::vector<NormalizedLandmarkList>
+//     The landmarks of the present hands, projected onto the image.
+//   WORLD_LANDMARKS - std::vector<LandmarkList> @Optional
+//     The world landmarks of the present hands.
+//   HANDEDNESS - std::vector<ClassificationList> @Optional
+//     The handedness of the present hands.
+//   PRESENCE - std::vector<bool> @Optional
+//     Whether each hand is present.
+//   PRESENCE_SCORE - std::vector<float> @Optional
+//     The presence score of each hand.
+//
+// The outputs of the present hands are not sent when no hand is present.
+//
+// Example:
+// node {
+//   calculator: "TensorsToHandLandmarksCalculator"
+//   input_stream: "TENSORS:tensors"
+//   input_stream: "NORM_RECTS:hand_rects"
+//   input_stream: "LETTERBOX_PADDINGS:letterbox_paddings"
+//   output_stream: "LANDMARKS:landmarks"
+//   output_stream: "WORLD_LANDMARKS:world_landmarks"
+//   output_stream: "HANDEDNESS:handedness"
+//   output_stream: "PRESENCE:presences"
+//   output_stream: "PRESENCE_SCORE:presence_scores"
+//   options {
+//     [mediapipe.TensorsToHandLandmarksCalculatorOptions.ext] {
+//       input_image_width: 224
+//       input_image_height: 224
+//       normalize_z: 0.4
+//       min_detection_confidence: 0.5
+//     }
+//   }
+// }
+class TensorsToHandLandmarksCalculator : public Node {
+ public:
+  static constexpr Input<std::vector<Tensor>> kInTensors{"TENSORS"};
+  static constexpr Input<std::vector<NormalizedRect>> kInRects{"NORM_RECTS"};
+  static constexpr Input<std::vector<std::array<float, 4>>>
+      kInLetterboxPaddings{"LETTERBOX_PADDINGS"};
+  static constexpr Output<std::vector<NormalizedLandmarkList>> kOutLandmarks{
+      "LANDMARKS"};
+  static constexpr Output<std::vector<LandmarkList>>::Optional
+      kOutWorldLandmarks{"WORLD_LANDMARKS"};
+  static constexpr Output<std::vector<ClassificationList>>::Optional
+      kOutHandedness{"HANDEDNESS"};
+  static constexpr Output<std::vector<bool>>::Optional kOutPresence{
+      "PRESENCE"};
+  static constexpr Output<std::vector<float>>::Optional kOutPresenceScore{
+      "PRESENCE_SCORE"};
+  MEDIAPIPE_NODE_CONTRACT(kInTensors, kInRects, kInLetterboxPaddings,
+                          kOutLandmarks, kOutWorldLandmarks, kOutHandedness,
+                          kOutPresence, kOutPresenceScore);
+
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<TensorsToHandLandmarksCalculatorOptions>();
+    RET_CHECK_GT(options_.num_landmarks(), 0);
+    RET_CHECK(options_.input_image_width() > 0 &&
+              options_.input_image_height() > 0)
+        << "Must provide input width/height for normalized landmarks.";
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kInTensors(cc).IsEmpty() || kInRects(cc).IsEmpty() ||
+        kInLetterboxPaddings(cc).IsEmpty()) {
+      return absl::OkStatus();
+    }
+    const auto& tensors = *kInTensors(cc);
+    const auto& rects = *kInRects(cc);
+    const auto& paddings = *kInLetterboxPaddings(cc);
+    RET_CHECK_EQ(tensors.size(), kNumTensors);
+    RET_CHECK_EQ(paddings.size(), rects.size());
+    const int num_hands = rects.size();
+    const int num_values = options_.num_landmarks() * kNumDimensions;
+
+    MP_RETURN_IF_ERROR(CheckTensor(tensors[0], num_hands, num_values));
+    MP_RETURN_IF_ERROR(CheckTensor(tensors[1], num_hands, 1));
+    MP_RETURN_IF_ERROR(CheckTensor(tensors[2], num_hands, 1));
+    MP_RETURN_IF_ERROR(CheckTensor(tensors[3], num_hands, num_values));
+    auto landmarks_view = tensors[0].GetCpuReadView();
+    auto presence_view = tensors[1].GetCpuReadView();
+    auto handedness_view = tensors[2].GetCpuReadView();
+    auto world_landmarks_view = tensors[3].GetCpuReadView();
+    const float* raw_landmarks = landmarks_view.buffer<float>();
+    const float* raw_presence = presence_view.buffer<float>();
+    const float* raw_handedness = handedness_view.buffer<float>();
+    const float* raw_world_landmarks = world_landmarks_view.buffer<float>();
+
+    auto presences = std::make_unique<std::vector<bool>>(num_hands);
+    auto landmark_lists =
+        std::make_unique<std::vector<NormalizedLandmarkList>>();
+    auto world_landmark_lists = std::make_unique<std::vector<LandmarkList>>();
+    auto handednesses = std::make_unique<std::vector<ClassificationList>>();
+    for (int i = 0; i < num_hands; ++i) {
+      (*presences)[i] = raw_presence[i] > options_.min_detection_confidence();
+      if (!(*presences)[i]) continue;
+      const float* values = raw_landmarks + i * num_values;
+      DecodeLandmarks(values, rects[i], paddings[i],
+                      &landmark_lists->emplace_back());
+      if (kOutWorldLandmarks(cc).IsConnected()) {
+        DecodeWorldLandmarks(raw_world_landmarks + i * num_values, rects[i],
+                             &world_landmark_lists->emplace_back());
+      }
+      if (kOutHandedness(cc).IsConnected()) {
+        DecodeHandedness(raw_handedness[i], &handednesses->emplace_back());
+      }
+    }
+
+    if (!landmark_lists->empty()) {
+      kOutLandmarks(cc).Send(std::move(landmark_lists));
+      if (kOutWorldLandmarks(cc).IsConnected()) {
+        kOutWorldLandmarks(cc).Send(std::move(world_landmark_lists));
+      }
+      if (kOutHandedness(cc).IsConnected()) {
+        kOutHandedness(cc).Send(std::move(handednesses));
+      }
+    }
+    if (kOutPresence(cc).IsConnected()) {
+      kOutPresence(cc).Send(std::move(presences));
+    }
+    if (kOutPresenceScore(cc).IsConnected()) {
+      kOutPresenceScore(cc).Send(std::make_unique<std::vector<float>>(
+          raw_presence, raw_presence + num_hands));
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Normalizes the landmarks by the model input size, removes the letterbox
+  // padding and projects them from the hand rect onto the image.
+  void DecodeLandmarks(const float* values, const NormalizedRect& rect,
+                       const std::array<float, 4>& padding,
+                       NormalizedLandmarkList* landmarks) const {
+    const float width = options_.input_image_width();
+    const float height = options_.input_image_height();
+    const float left = padding[0];
+    const float top = padding[1];
+    const float left_and_right = padding[0] + padding[2];
+    const float top_and_bottom = padding[1] + padding[3];
+    const float cos_angle = std::cos(rect.rotation());
+    const float sin_angle = std::sin(rect.rotation());
+    for (int j = 0; j < options_.num_landmarks(); ++j) {
+      const float* value = values + j * kNumDimensions;
+      const float x =
+          (value[0] / width - left) / (1.0f - left_and_right) - 0.5f;
+      const float y =
+          (value[1] / height - top) / (1.0f - top_and_bottom) - 0.5f;
+      const float z = value[2] / width / options_.normalize_z() /
+                      (1.0f - left_and_right);
+      NormalizedLandmark* landmark = landmarks->add_landmark();
+      landmark->set_x((cos_angle * x - sin_angle * y) * rect.width() +
+                      rect.x_center());
+      landmark->set_y((sin_angle * x + cos_angle * y) * rect.height() +
+                      rect.y_center());
+      landmark->set_z(z * rect.width());
+    }
+  }
+
+  // Rotates the world landmarks by the rotation of the hand rect.
+  void DecodeWorldLandmarks(const float* values, const NormalizedRect& rect,
+                            LandmarkList* landmarks) const {
+    const float cos_angle = std::cos(rect.rotation());
+    const float sin_angle = std::sin(rect.rotation());
+    for (int j = 0; j < options_.num_landmarks(); ++j) {
+      const float* value = values + j * kNumDimensions;
+      Landmark* landmark = landmarks->add_landmark();
+      landmark->set_x(cos_angle * value[0] - sin_angle * value[1]);
+      landmark->set_y(sin_angle * value[0] + cos_angle * value[1]);
+      landmark->set_z(value[2]);
+    }
+  }
+
+  // Keeps the more likely of the two handedness labels.
+  static void DecodeHandedness(float score, ClassificationList* handedness) {
+    Classification* classification = handedness->add_classification();
+    const bool is_left = score >= 1.0f - score;
+    classification->set_index(is_left ? 0 : 1);
+    classification->set_score(is_left ? score : 1.0f - score);
+    classification->set_label(is_left ? kLeftLabel : kRightLabel);
+    classification->set_display_name(is_left ? kLeftLabel : kRightLabel);
+  }
+
+  TensorsToHandLandmarksCalculatorOptions options_;
+};
+
+MEDIAPIPE_REGISTER_NODE(TensorsToHandLandmarksCalculator);
+
+}  // namespace mediapipe::api2
@@ -0,0 +1,163 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumHands = 2;
+constexpr int kNumLandmarks = 2;
+
+Tensor MakeTensor(const std::vector<float>& values, int num_values) {
+  Tensor tensor(Tensor::ElementType::kFloat32, {kNumHands, num_values});
+  auto view = tensor.GetCpuWriteView();
+  std::copy(values.begin(), values.end(), view.buffer<float>());
+  return tensor;
+}
+
+class TensorsToHandLandmarksCalculatorTest : public testing::Test {
+ protected:
+  TensorsToHandLandmarksCalculatorTest()
+      : runner_(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+          calculator: "TensorsToHandLandmarksCalculator"
+          input_stream: "TENSORS:tensors"
+          input_stream: "NORM_RECTS:rects"
+          input_stream: "LETTERBOX_PADDINGS:paddings"
+          output_stream: "LANDMARKS:landmarks"
+          output_stream: "WORLD_LANDMARKS:world_landmarks"
+          output_stream: "HANDEDNESS:handedness"
+          output_stream: "PRESENCE:presence"
+          output_stream: "PRESENCE_SCORE:presence_score"
+          options {
+            [mediapipe.TensorsToHandLandmarksCalculatorOptions.ext] {
+              num_landmarks: 2
+              input_image_width: 100
+              input_image_height: 200
+              normalize_z: 0.5
+              min_detection_confidence: 0.5
+            }
+          }
+        )pb")) {}
+
+  void Run(const std::vector<float>& presence_scores) {
+    auto tensors = std::make_unique<std::vector<Tensor>>();
+    // The first hand has landmarks (50, 100, 10) and (25, 50, 0), the second
+    // one has all zeros.
+    tensors->push_back(
+        MakeTensor({50, 100, 10, 25, 50, 0, 0, 0, 0, 0, 0, 0},
+                   kNumLandmarks * 3));
+    tensors->push_back(MakeTensor(presence_scores, 1));
+    tensors->push_back(MakeTensor({0.2, 0.9}, 1));
+    tensors->push_back(MakeTensor({1, 2, 3, 4, 5, 6, 0, 0, 0, 0, 0, 0},
+                                  kNumLandmarks * 3));
+
+    auto rects = std::make_unique<std::vector<NormalizedRect>>(kNumHands);
+    (*rects)[0].set_x_center(0.5);
+    (*rects)[0].set_y_center(0.5);
+    (*rects)[0].set_width(0.4);
+    (*rects)[0].set_height(0.2);
+    (*rects)[0].set_rotation(M_PI / 2);
+    (*rects)[1] = (*rects)[0];
+    auto paddings = std::make_unique<std::vector<std::array<float, 4>>>(
+        kNumHands, std::array<float, 4>{0.25, 0, 0.25, 0});
+
+    runner_.MutableInputs()->Tag("TENSORS").packets.push_back(
+        Adopt(tensors.release()).At(Timestamp(0)));
+    runner_.MutableInputs()->Tag("NORM_RECTS").packets.push_back(
+        Adopt(rects.release()).At(Timestamp(0)));
+    runner_.MutableInputs()->Tag("LETTERBOX_PADDINGS").packets.push_back(
+        Adopt(paddings.release()).At(Timestamp(0)));
+    MP_ASSERT_OK(runner_.Run());
+  }
+
+  CalculatorRunner runner_;
+};
+
+TEST_F(TensorsToHandLandmarksCalculatorTest, DecodesPresentHands) {
+  Run({0.8, 0.3});
+
+  const auto& presence = runner_.Outputs().Tag("PRESENCE").packets;
+  ASSERT_EQ(presence.size(), 1);
+  EXPECT_THAT(presence[0].Get<std::vector<bool>>(),
+              testing::ElementsAre(true, false));
+  const auto& presence_score = runner_.Outputs().Tag("PRESENCE_SCORE").packets;
+  ASSERT_EQ(presence_score.size(), 1);
+  EXPECT_THAT(presence_score[0].Get<std::vector<float>>(),
+              testing::ElementsAre(0.8f, 0.3f));
+
+  const auto& landmarks = runner_.Outputs().Tag("LANDMARKS").packets;
+  ASSERT_EQ(landmarks.size(), 1);
+  const auto& landmark_lists =
+      landmarks[0].Get<std::vector<NormalizedLandmarkList>>();
+  ASSERT_EQ(landmark_lists.size(), 1);
+  ASSERT_EQ(landmark_lists[0].landmark_size(), kNumLandmarks);
+  // The center of the crop stays at the center of the rect.
+  EXPECT_NEAR(landmark_lists[0].landmark(0).x(), 0.5, 1e-6);
+  EXPECT_NEAR(landmark_lists[0].landmark(0).y(), 0.5, 1e-6);
+  // z is 10 / 100 / 0.5, unpadded to 0.4 and scaled by the rect width.
+  EXPECT_NEAR(landmark_lists[0].landmark(0).z(), 0.16, 1e-6);
+  // (0.25, 0.25) on the crop is (-0.5, -0.25) from the center once unpadded,
+  // and is rotated by 90 degrees to (0.25, -0.5).
+  EXPECT_NEAR(landmark_lists[0].landmark(1).x(), 0.5 + 0.25 * 0.4, 1e-6);
+  EXPECT_NEAR(landmark_lists[0].landmark(1).y(), 0.5 - 0.5 * 0.2, 1e-6);
+
+  const auto& world_landmarks =
+      runner_.Outputs().Tag("WORLD_LANDMARKS").packets;
+  ASSERT_EQ(world_landmarks.size(), 1);
+  const auto& world_landmark_lists =
+      world_landmarks[0].Get<std::vector<LandmarkList>>();
+  ASSERT_EQ(world_landmark_lists.size(), 1);
+  EXPECT_NEAR(world_landmark_lists[0].landmark(0).x(), -2, 1e-6);
+  EXPECT_NEAR(world_landmark_lists[0].landmark(0).y(), 1, 1e-6);
+  EXPECT_NEAR(world_landmark_lists[0].landmark(0).z(), 3, 1e-6);
+
+  const auto& handedness = runner_.Outputs().Tag("HANDEDNESS").packets;
+  ASSERT_EQ(handedness.size(), 1);
+  const auto& handednesses =
+      handedness[0].Get<std::vector<ClassificationList>>();
+  ASSERT_EQ(handednesses.size(), 1);
+  ASSERT_EQ(handednesses[0].classification_size(), 1);
+  EXPECT_EQ(handednesses[0].classification(0).index(), 1);
+  EXPECT_EQ(handednesses[0].classification(0).label(), "Right");
+  EXPECT_NEAR(handednesses[0].classification(0).score(), 0.8, 1e-6);
+}
+
+TEST_F(TensorsToHandLandmarksCalculatorTest, SendsNoLandmarksWithoutHands) {
+  Run({0.1, 0.3});
+
+  EXPECT_EQ(runner_.Outputs().Tag("PRESENCE").packets.size(), 1);
+  EXPECT_EQ(runner_.Outputs().Tag("PRESENCE_SCORE").packets.size(), 1);
+  EXPECT_TRUE(runner_.Outputs().Tag("LANDMARKS").packets.empty());
+  EXPECT_TRUE(runner_.Outputs().Tag("WORLD_LANDMARKS").packets.empty());
+  EXPECT_TRUE(runner_.Outputs().Tag("HANDEDNESS").packets.empty());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -96,6 +96,10 @@ class HandLandmarker : tasks::vision::core::BaseVisionTaskApi {
  public:
   using BaseVisionTaskApi::BaseVisionTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates a HandLandmarker from a HandLandmarkerOptions to process image data
   // or streaming data. Hand landmarker can be created with one of the following
   // three running modes:
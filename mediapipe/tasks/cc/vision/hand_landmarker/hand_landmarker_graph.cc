@@ -20,7 +20,6 @@ limitations under the License.
 
 #include "mediapipe/calculators/core/clip_vector_size_calculator.pb.h"
 #include "mediapipe/calculators/core/gate_calculator.pb.h"
-#include "mediapipe/calculators/util/collection_has_min_size_calculator.pb.h"
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/formats/classification.pb.h"
@@ -36,9 +35,9 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/model_resources_cache.h"
 #include "mediapipe/tasks/cc/core/model_task_graph.h"
 #include "mediapipe/tasks/cc/core/utils.h"
-#include "mediapipe/tasks/cc/metadata/utils/zip_utils.h"
 #include "mediapipe/tasks/cc/vision/hand_detector/proto/hand_detector_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/hand_landmarker/calculators/hand_association_calculator.pb.h"
+#include "mediapipe/tasks/cc/vision/hand_landmarker/calculators/hand_detection_scheduler_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/hand_landmarker/proto/hand_landmarker_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/hand_landmarker/proto/hand_landmarks_detector_graph_options.pb.h"
 
@@ -51,11 +50,11 @@ namespace {
 
 using ::mediapipe::api2::Input;
 using ::mediapipe::api2::Output;
+using ::mediapipe::api2::builder::GenericNode;
 using ::mediapipe::api2::builder::Graph;
 using ::mediapipe::api2::builder::Source;
-using ::mediapipe::tasks::components::utils::DisallowIf;
+using ::mediapipe::tasks::components::utils::AllowIf;
 using ::mediapipe::tasks::core::ModelAssetBundleResources;
-using ::mediapipe::tasks::metadata::SetExternalFile;
 using ::mediapipe::tasks::vision::hand_detector::proto::
     HandDetectorGraphOptions;
 using ::mediapipe::tasks::vision::hand_landmarker::proto::
@@ -90,32 +89,34 @@ struct HandLandmarkerOutputs {
 absl::Status SetSubTaskBaseOptions(const ModelAssetBundleResources& resources,
                                    HandLandmarkerGraphOptions* options,
                                    bool is_copy) {
-  ASSIGN_OR_RETURN(const auto hand_detector_file,
-                   resources.GetModelFile(kHandDetectorTFLiteName));
   auto* hand_detector_graph_options =
       options->mutable_hand_detector_graph_options();
-  SetExternalFile(hand_detector_file,
-                  hand_detector_graph_options->mutable_base_options()
-                      ->mutable_model_asset(),
-                  is_copy);
+  MP_RETURN_IF_ERROR(resources.SetModelExternalFile(
+      kHandDetectorTFLiteName,
+      hand_detector_graph_options->mutable_base_options()
+          ->mutable_model_asset(),
+      is_copy));
   hand_detector_graph_options->mutable_base_options()
       ->mutable_acceleration()
       ->CopyFrom(options->base_options().acceleration());
   hand_detector_graph_options->mutable_base_options()->set_use_stream_mode(
       options->base_options().use_stream_mode());
-  ASSIGN_OR_RETURN(const auto hand_landmarks_detector_file,
-                   resources.GetModelFile(kHandLandmarksDetectorTFLiteName));
+  hand_detector_graph_options->mutable_base_options()->set_warm_up(
+      options->base_options().warm_up());
   auto* hand_landmarks_detector_graph_options =
       options->mutable_hand_landmarks_detector_graph_options();
-  SetExternalFile(hand_landmarks_detector_file,
-                  hand_landmarks_detector_graph_options->mutable_base_options()
-                      ->mutable_model_asset(),
-                  is_copy);
+  MP_RETURN_IF_ERROR(resources.SetModelExternalFile(
+      kHandLandmarksDetectorTFLiteName,
+      hand_landmarks_detector_graph_options->mutable_base_options()
+          ->mutable_model_asset(),
+      is_copy));
   hand_landmarks_detector_graph_options->mutable_base_options()
       ->mutable_acceleration()
       ->CopyFrom(options->base_options().acceleration());
   hand_landmarks_detector_graph_options->mutable_base_options()
       ->set_use_stream_mode(options->base_options().use_stream_mode());
+  hand_landmarks_detector_graph_options->mutable_base_options()->set_warm_up(
+      options->base_options().warm_up());
   return absl::OkStatus();
 }
 
@@ -128,7 +129,8 @@ absl::Status SetSubTaskBaseOptions(const ModelAssetBundleResources& resources,
 // produced by HandDetectorGraph. HandLandmarkerGraph tracks the landmarks over
 // time, and skips the HandDetectorGraph. If the tracking is lost or the detectd
 // hands are less than configured max number hands, HandDetectorGraph would be
-// triggered to detect hands.
+// triggered to detect hands, at most every `detection_interval` frames and
+// optionally on the corners of the image in between.
 //
 // Accepts CPU input images and outputs Landmarks on CPU.
 //
@@ -209,8 +211,9 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
       ASSIGN_OR_RETURN(
           const auto* model_asset_bundle_resources,
           CreateModelAssetBundleResources<HandLandmarkerGraphOptions>(sc));
-      // Copies the file content instead of passing the pointer of file in
-      // memory if the subgraph model resource service is not available.
+      // Refers to the model files by their region of the bundle file, or
+      // copies them, instead of passing the pointer of file in memory if the
+      // subgraph model resource service is not available.
       MP_RETURN_IF_ERROR(SetSubTaskBaseOptions(
           *model_asset_bundle_resources,
           sc->MutableOptions<HandLandmarkerGraphOptions>(),
@@ -245,7 +248,6 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
         auto* info = config.mutable_node(i)->add_input_stream_info();
         info->set_tag_index("LOOP");
         info->set_back_edge(true);
-        break;
       }
     }
     return config;
@@ -269,12 +271,9 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
     auto prev_hand_rects_from_landmarks =
         previous_loopback[Output<std::vector<NormalizedRect>>("PREV_LOOP")];
 
-    auto& min_size_node =
-        graph.AddNode("NormalizedRectVectorHasMinSizeCalculator");
-    prev_hand_rects_from_landmarks >> min_size_node.In("ITERABLE");
-    min_size_node.GetOptions<CollectionHasMinSizeCalculatorOptions>()
-        .set_min_size(max_num_hands);
-    auto has_enough_hands = min_size_node.Out("").Cast<bool>();
+    auto& image_property = graph.AddNode("ImagePropertiesCalculator");
+    image_in >> image_property.In("IMAGE");
+    auto image_size = image_property.Out("SIZE");
 
     auto& hand_detector =
         graph.AddNode("mediapipe.tasks.vision.hand_detector.HandDetectorGraph");
@@ -285,15 +284,39 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
     clip_hand_rects.GetOptions<ClipVectorSizeCalculatorOptions>()
         .set_max_vec_size(max_num_hands);
 
+    // Loops the presence scores of the tracked hands back in stream mode.
+    GenericNode* previous_presence_loopback = nullptr;
     if (tasks_options.base_options().use_stream_mode()) {
       // While in stream mode, skip hand detector graph when we successfully
-      // track the hands from the last frame.
+      // track the hands from the last frame, and otherwise run it as
+      // scheduled by the options.
+      previous_presence_loopback =
+          &graph.AddNode(kPreviousLoopbackCalculatorName);
+      image_in >> previous_presence_loopback->In("MAIN");
+      auto& detection_scheduler =
+          graph.AddNode("HandDetectionSchedulerCalculator");
+      auto& scheduler_options =
+          detection_scheduler
+              .GetOptions<HandDetectionSchedulerCalculatorOptions>();
+      scheduler_options.set_num_hands(max_num_hands);
+      scheduler_options.set_detection_interval(
+          tasks_options.detection_interval());
+      scheduler_options.set_min_tracked_presence_score(
+          tasks_options.min_tracked_presence_score());
+      scheduler_options.set_corner_region_size(
+          tasks_options.corner_detection_region_size());
+      norm_rect_in >> detection_scheduler.In("NORM_RECT");
+      image_size >> detection_scheduler.In("IMAGE_SIZE");
+      prev_hand_rects_from_landmarks >>
+          detection_scheduler.In("PREV_HAND_RECTS");
+      previous_presence_loopback->Out("PREV_LOOP") >>
+          detection_scheduler.In("PREV_PRESENCE_SCORES");
+      auto run_hand_detector = detection_scheduler[Output<bool>("DETECT")];
       auto image_for_hand_detector =
-          DisallowIf(image_in, has_enough_hands, graph);
-      auto norm_rect_in_for_hand_detector =
-          DisallowIf(norm_rect_in, has_enough_hands, graph);
+          AllowIf(image_in, run_hand_detector, graph);
       image_for_hand_detector >> hand_detector.In("IMAGE");
-      norm_rect_in_for_hand_detector >> hand_detector.In("NORM_RECT");
+      detection_scheduler.Out("DETECTION_RECT") >>
+          hand_detector.In("NORM_RECT");
       auto hand_rects_from_hand_detector = hand_detector.Out("HAND_RECTS");
       auto& hand_association = graph.AddNode("HandAssociationCalculator");
       hand_association.GetOptions<HandAssociationCalculatorOptions>()
@@ -332,10 +355,6 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
         hand_landmarks_detector_graph.Out(kHandRectNextFrameTag);
     auto handedness = hand_landmarks_detector_graph.Out(kHandednessTag);
 
-    auto& image_property = graph.AddNode("ImagePropertiesCalculator");
-    image_in >> image_property.In("IMAGE");
-    auto image_size = image_property.Out("SIZE");
-
     auto& deduplicate = graph.AddNode("HandLandmarksDeduplicationCalculator");
     landmarks >> deduplicate.In("MULTI_LANDMARKS");
     world_landmarks >> deduplicate.In("MULTI_WORLD_LANDMARKS");
@@ -354,8 +373,12 @@ class HandLandmarkerGraph : public core::ModelTaskGraph {
         deduplicate[Output<std::vector<ClassificationList>>(
             "MULTI_CLASSIFICATIONS")];
 
-    // Back edge.
+    // Back edges.
     filtered_hand_rects_for_next_frame >> previous_loopback.In("LOOP");
+    if (previous_presence_loopback != nullptr) {
+      hand_landmarks_detector_graph.Out("PRESENCE_SCORE") >>
+          previous_presence_loopback->In("LOOP");
+    }
 
     // TODO: Replace PassThroughCalculator with a calculator that
     // converts the pixel data to be stored on the target storage (CPU vs GPU).
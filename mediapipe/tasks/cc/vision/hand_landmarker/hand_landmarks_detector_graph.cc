@@ -21,6 +21,8 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "mediapipe/calculators/core/split_vector_calculator.pb.h"
+#include "mediapipe/calculators/image/image_clone_calculator.pb.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/calculators/tensor/tensors_to_classification_calculator.pb.h"
 #include "mediapipe/calculators/tensor/tensors_to_landmarks_calculator.pb.h"
 #include "mediapipe/calculators/util/rect_transformation_calculator.pb.h"
@@ -34,12 +36,14 @@ limitations under the License.
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/components/processors/image_preprocessing_graph.h"
+#include "mediapipe/tasks/cc/components/processors/proto/image_preprocessing_graph_options.pb.h"
 #include "mediapipe/tasks/cc/components/utils/gate.h"
 #include "mediapipe/tasks/cc/core/model_resources.h"
 #include "mediapipe/tasks/cc/core/model_task_graph.h"
 #include "mediapipe/tasks/cc/core/proto/inference_subgraph.pb.h"
 #include "mediapipe/tasks/cc/core/utils.h"
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
+#include "mediapipe/tasks/cc/vision/hand_landmarker/calculators/tensors_to_hand_landmarks_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/hand_landmarker/proto/hand_landmarks_detector_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/utils/image_tensor_specs.h"
 #include "mediapipe/tasks/metadata/metadata_schema_generated.h"
@@ -298,7 +302,7 @@ class SingleHandLandmarksDetectorGraph : public core::ModelTaskGraph {
                      BuildImageTensorSpecs(model_resources));
 
     auto& inference = AddInference(
-        model_resources, subgraph_options.base_options().acceleration(), graph);
+        model_resources, subgraph_options.base_options(), graph);
     preprocessing.Out("TENSORS") >> inference.In("TENSORS");
 
     // Split model output tensors to multiple streams.
@@ -434,6 +438,9 @@ REGISTER_MEDIAPIPE_GRAPH(
 //   multiple hands landmarks enclosed by the RoIs. Output vectors of
 //   hand landmarks related results, where each element in the vectors
 //   corrresponds to the result of the same hand.
+// - Without GPU acceleration, runs the model once for all the hands, with the
+//   hand crops as one batch. Otherwise, runs the
+//   SingleHandLandmarksDetectorGraph for each hand.
 //
 // Inputs:
 //   IMAGE - Image
@@ -487,12 +494,28 @@ class MultipleHandLandmarksDetectorGraph : public core::ModelTaskGraph {
   absl::StatusOr<CalculatorGraphConfig> GetConfig(
       SubgraphContext* sc) override {
     Graph graph;
+    const auto& subgraph_options =
+        sc->Options<HandLandmarksDetectorGraphOptions>();
+    auto image_in = graph[Input<Image>(kImageTag)];
+    auto multi_hand_rects =
+        graph[Input<std::vector<NormalizedRect>>(kHandRectTag)];
+    // The hands are batched on CPU and looped over on GPU.
+    const bool use_gpu =
+        components::processors::DetermineImagePreprocessingGpuBackend(
+            subgraph_options.base_options().acceleration());
+    const core::ModelResources* model_resources = nullptr;
+    if (!use_gpu) {
+      ASSIGN_OR_RETURN(
+          model_resources,
+          CreateModelResources<HandLandmarksDetectorGraphOptions>(sc));
+    }
     ASSIGN_OR_RETURN(
         auto hand_landmark_detection_outputs,
-        BuildHandLandmarksDetectorGraph(
-            sc->Options<HandLandmarksDetectorGraphOptions>(),
-            graph[Input<Image>(kImageTag)],
-            graph[Input<std::vector<NormalizedRect>>(kHandRectTag)], graph));
+        use_gpu ? BuildHandLandmarksDetectorGraph(subgraph_options, image_in,
+                                                  multi_hand_rects, graph)
+                : BuildBatchedHandLandmarksDetectorGraph(
+                      subgraph_options, *model_resources, image_in,
+                      multi_hand_rects, graph));
     hand_landmark_detection_outputs.landmark_lists >>
         graph[Output<std::vector<NormalizedLandmarkList>>(kLandmarksTag)];
     hand_landmark_detection_outputs.world_landmark_lists >>
@@ -510,6 +533,112 @@ class MultipleHandLandmarksDetectorGraph : public core::ModelTaskGraph {
   }
 
  private:
+  // Runs the hand landmark model once for all the hands, with the crops of the
+  // hands as one batch, and decodes the results of all the hands at once.
+  // Only used on CPU, where the interpreter can resize the batch dimension of
+  // the model input for each frame.
+  absl::StatusOr<HandLandmarkerOutputs> BuildBatchedHandLandmarksDetectorGraph(
+      const HandLandmarksDetectorGraphOptions& subgraph_options,
+      const core::ModelResources& model_resources, Source<Image> image_in,
+      Source<std::vector<NormalizedRect>> multi_hand_rects, Graph& graph) {
+    MP_RETURN_IF_ERROR(SanityCheckOptions(subgraph_options));
+
+    // Extracts the crops of all the hands into a single tensor. This is the
+    // ImagePreprocessingGraph on CPU, with the hand rects as a batch.
+    tasks::components::processors::proto::ImagePreprocessingGraphOptions
+        preprocessing_options;
+    MP_RETURN_IF_ERROR(components::processors::ConfigureImagePreprocessingGraph(
+        model_resources, /*use_gpu=*/false, &preprocessing_options));
+    auto& image_converter = graph.AddNode("ImageCloneCalculator");
+    image_converter.GetOptions<mediapipe::ImageCloneCalculatorOptions>()
+        .set_output_on_gpu(false);
+    image_in >> image_converter.In("");
+    auto& image_to_tensor = graph.AddNode("ImageToTensorCalculator");
+    image_to_tensor.GetOptions<mediapipe::ImageToTensorCalculatorOptions>()
+        .CopyFrom(preprocessing_options.image_to_tensor_options());
+    image_converter.Out("") >> image_to_tensor.In("IMAGE");
+    multi_hand_rects >> image_to_tensor.In("NORM_RECTS");
+
+    auto& image_properties = graph.AddNode("ImagePropertiesCalculator");
+    image_in >> image_properties.In("IMAGE");
+    auto image_size = image_properties[Output<std::pair<int, int>>("SIZE")];
+
+    ASSIGN_OR_RETURN(auto image_tensor_specs,
+                     BuildImageTensorSpecs(model_resources));
+
+    auto& inference = AddInference(
+        model_resources, subgraph_options.base_options(), graph);
+    image_to_tensor.Out("TENSORS") >> inference.In("TENSORS");
+
+    // Decodes the landmarks, world landmarks, presence and handedness of all
+    // the hands.
+    auto& tensors_to_hand_landmarks =
+        graph.AddNode("TensorsToHandLandmarksCalculator");
+    auto& decoder_options =
+        tensors_to_hand_landmarks
+            .GetOptions<mediapipe::TensorsToHandLandmarksCalculatorOptions>();
+    decoder_options.set_num_landmarks(kLandmarksNum);
+    decoder_options.set_input_image_width(image_tensor_specs.image_width);
+    decoder_options.set_input_image_height(image_tensor_specs.image_height);
+    decoder_options.set_normalize_z(kLandmarksNormalizeZ);
+    decoder_options.set_min_detection_confidence(
+        subgraph_options.min_detection_confidence());
+    inference.Out("TENSORS") >> tensors_to_hand_landmarks.In("TENSORS");
+    multi_hand_rects >> tensors_to_hand_landmarks.In("NORM_RECTS");
+    image_to_tensor.Out("LETTERBOX_PADDINGS") >>
+        tensors_to_hand_landmarks.In("LETTERBOX_PADDINGS");
+    auto landmark_lists =
+        tensors_to_hand_landmarks[Output<std::vector<NormalizedLandmarkList>>(
+            "LANDMARKS")];
+
+    // Computes the rects of the present hands for the next frame, which is
+    // cheap compared to the model and is left to the existing calculators.
+    auto& begin_loop_landmarks =
+        graph.AddNode("BeginLoopNormalizedLandmarkListVectorCalculator");
+    landmark_lists >> begin_loop_landmarks.In("ITERABLE");
+    image_size >> begin_loop_landmarks.In("CLONE");
+    auto batch_end = begin_loop_landmarks.Out("BATCH_END");
+
+    auto& hand_landmarks_to_rect =
+        graph.AddNode("HandLandmarksToRectCalculator");
+    begin_loop_landmarks.Out("CLONE") >>
+        hand_landmarks_to_rect.In("IMAGE_SIZE");
+    begin_loop_landmarks.Out("ITEM") >>
+        hand_landmarks_to_rect.In("NORM_LANDMARKS");
+
+    auto& hand_rect_transformation =
+        graph.AddNode("RectTransformationCalculator");
+    ConfigureHandRectTransformationCalculator(
+        &hand_rect_transformation
+             .GetOptions<mediapipe::RectTransformationCalculatorOptions>());
+    begin_loop_landmarks.Out("CLONE") >>
+        hand_rect_transformation.In("IMAGE_SIZE");
+    hand_landmarks_to_rect.Out("NORM_RECT") >>
+        hand_rect_transformation.In("NORM_RECT");
+
+    auto& end_loop_rects_next_frame =
+        graph.AddNode("EndLoopNormalizedRectCalculator");
+    batch_end >> end_loop_rects_next_frame.In("BATCH_END");
+    hand_rect_transformation.Out("") >> end_loop_rects_next_frame.In("ITEM");
+
+    return {{
+        /* landmark_lists= */ landmark_lists,
+        /* world_landmark_lists= */
+        tensors_to_hand_landmarks[Output<std::vector<LandmarkList>>(
+            "WORLD_LANDMARKS")],
+        /* hand_rects_next_frame= */
+        end_loop_rects_next_frame[Output<std::vector<NormalizedRect>>(
+            "ITERABLE")],
+        /* presences= */
+        tensors_to_hand_landmarks[Output<std::vector<bool>>("PRESENCE")],
+        /* presence_scores= */
+        tensors_to_hand_landmarks[Output<std::vector<float>>("PRESENCE_SCORE")],
+        /* handednesses= */
+        tensors_to_hand_landmarks[Output<std::vector<ClassificationList>>(
+            "HANDEDNESS")],
+    }};
+  }
+
   absl::StatusOr<HandLandmarkerOutputs> BuildHandLandmarksDetectorGraph(
       const HandLandmarksDetectorGraphOptions& subgraph_options,
       Source<Image> image_in,
@@ -0,0 +1,201 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "mediapipe/calculators/image/image_clone_calculator.pb.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
+#include "mediapipe/framework/api2/builder.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/components/containers/proto/classifications.pb.h"
+#include "mediapipe/tasks/cc/components/processors/classification_postprocessing_graph.h"
+#include "mediapipe/tasks/cc/components/processors/image_preprocessing_graph.h"
+#include "mediapipe/tasks/cc/components/processors/proto/classification_postprocessing_graph_options.pb.h"
+#include "mediapipe/tasks/cc/components/processors/proto/image_preprocessing_graph_options.pb.h"
+#include "mediapipe/tasks/cc/core/model_resources.h"
+#include "mediapipe/tasks/cc/core/model_task_graph.h"
+#include "mediapipe/tasks/cc/vision/image_classifier/proto/image_classifier_graph_options.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace vision {
+namespace image_classifier {
+
+namespace {
+
+using ::mediapipe::api2::Input;
+using ::mediapipe::api2::Output;
+using ::mediapipe::api2::builder::Graph;
+using ::mediapipe::api2::builder::Source;
+using ::mediapipe::tasks::components::containers::proto::ClassificationResult;
+
+constexpr char kBatchEndTag[] = "BATCH_END";
+constexpr char kClassificationsTag[] = "CLASSIFICATIONS";
+constexpr char kDetectionsTag[] = "DETECTIONS";
+constexpr char kImageSizeTag[] = "IMAGE_SIZE";
+constexpr char kImageTag[] = "IMAGE";
+constexpr char kItemTag[] = "ITEM";
+constexpr char kIterableTag[] = "ITERABLE";
+constexpr char kNormRectsTag[] = "NORM_RECTS";
+constexpr char kRelativeDetectionsTag[] = "RELATIVE_DETECTIONS";
+constexpr char kTensorsTag[] = "TENSORS";
+
+}  // namespace
+
+// A "DetectionsClassifierGraph" classifies the bounding boxes of detections,
+// e.g. the output of an ObjectDetectorGraph, with an image classification
+// model.
+// - The crops of all the boxes of an image are extracted into one batched
+//   tensor and classified with a single inference on CPU, so the cost of a
+//   frame doesn't grow with one interpreter invocation per box.
+// - Accepts CPU or GPU input images and outputs classifications on CPU.
+//
+// Inputs:
+//   IMAGE - Image
+//     Image the detections were made on.
+//   DETECTIONS - std::vector<Detection>
+//     Detections with bounding boxes in pixel units.
+// Outputs:
+//   CLASSIFICATIONS - std::vector<ClassificationResult>
+//     The classification result of the bounding box of every detection, in the
+//     order of DETECTIONS. No packet is output when there are no detections.
+//
+// Example:
+// node {
+//   calculator:
+//     "mediapipe.tasks.vision.image_classifier.DetectionsClassifierGraph"
+//   input_stream: "IMAGE:image_in"
+//   input_stream: "DETECTIONS:detections_in"
+//   output_stream: "CLASSIFICATIONS:classifications_out"
+//   options {
+//     [mediapipe.tasks.vision.image_classifier.proto.ImageClassifierGraphOptions.ext]
+//     {
+//       base_options {
+//         model_asset {
+//           file_name: "/path/to/model.tflite"
+//         }
+//       }
+//       classifier_options {
+//         max_results: 3
+//       }
+//     }
+//   }
+// }
+class DetectionsClassifierGraph : public core::ModelTaskGraph {
+ public:
+  absl::StatusOr<CalculatorGraphConfig> GetConfig(
+      SubgraphContext* sc) override {
+    ASSIGN_OR_RETURN(
+        const auto* model_resources,
+        CreateModelResources<proto::ImageClassifierGraphOptions>(sc));
+    Graph graph;
+    ASSIGN_OR_RETURN(
+        auto classifications,
+        BuildDetectionsClassificationTask(
+            sc->Options<proto::ImageClassifierGraphOptions>(), *model_resources,
+            graph[Input<Image>(kImageTag)],
+            graph[Input<std::vector<Detection>>(kDetectionsTag)], graph));
+    classifications >>
+        graph[Output<std::vector<ClassificationResult>>(kClassificationsTag)];
+    return graph.GetConfig();
+  }
+
+ private:
+  // Adds a pipeline classifying the bounding boxes of `detections_in` with one
+  // batched inference into the provided builder::Graph instance.
+  //
+  // task_options: the mediapipe tasks ImageClassifierGraphOptions.
+  // model_resources: the ModelSources object initialized from an image
+  // classification model file with model metadata.
+  // image_in: (mediapipe::Image) stream the detections were made on.
+  // detections_in: (std::vector<Detection>) detections in pixel units.
+  // graph: the mediapipe builder::Graph instance to be updated.
+  absl::StatusOr<Source<std::vector<ClassificationResult>>>
+  BuildDetectionsClassificationTask(
+      const proto::ImageClassifierGraphOptions& task_options,
+      const core::ModelResources& model_resources, Source<Image> image_in,
+      Source<std::vector<Detection>> detections_in, Graph& graph) {
+    // Converts the bounding boxes to the regions to crop.
+    auto& image_properties = graph.AddNode("ImagePropertiesCalculator");
+    image_in >> image_properties.In("IMAGE");
+    auto& detection_transformation =
+        graph.AddNode("DetectionTransformationCalculator");
+    detections_in >> detection_transformation.In(kDetectionsTag);
+    image_properties.Out("SIZE") >> detection_transformation.In(kImageSizeTag);
+    auto& detections_to_rects = graph.AddNode("DetectionsToRectsCalculator");
+    detection_transformation.Out(kRelativeDetectionsTag) >>
+        detections_to_rects.In(kDetectionsTag);
+    auto norm_rects =
+        detections_to_rects[Output<std::vector<NormalizedRect>>(kNormRectsTag)];
+
+    // Extracts the crops of all the regions into a single batched tensor on
+    // CPU, as only the CPU inference runners resize the model input to the
+    // batch size.
+    tasks::components::processors::proto::ImagePreprocessingGraphOptions
+        preprocessing_options;
+    MP_RETURN_IF_ERROR(components::processors::ConfigureImagePreprocessingGraph(
+        model_resources, /*use_gpu=*/false, &preprocessing_options));
+    auto& image_converter = graph.AddNode("ImageCloneCalculator");
+    image_converter.GetOptions<mediapipe::ImageCloneCalculatorOptions>()
+        .set_output_on_gpu(false);
+    image_in >> image_converter.In("");
+    auto& image_to_tensor = graph.AddNode("ImageToTensorCalculator");
+    image_to_tensor.GetOptions<mediapipe::ImageToTensorCalculatorOptions>()
+        .CopyFrom(preprocessing_options.image_to_tensor_options());
+    image_converter.Out("") >> image_to_tensor.In(kImageTag);
+    norm_rects >> image_to_tensor.In(kNormRectsTag);
+
+    auto& inference = AddInference(
+        model_resources, task_options.base_options(), graph);
+    image_to_tensor.Out(kTensorsTag) >> inference.In(kTensorsTag);
+
+    // Splits the batched output tensors and postprocesses the scores of every
+    // box, as the classification postprocessing expects a batch of 1.
+    auto& begin_loop =
+        graph.AddNode("mediapipe.tasks.BeginLoopTensorBatchCalculator");
+    inference.Out(kTensorsTag) >> begin_loop.In(kIterableTag);
+    auto& postprocessing = graph.AddNode(
+        "mediapipe.tasks.components.processors."
+        "ClassificationPostprocessingGraph");
+    MP_RETURN_IF_ERROR(
+        components::processors::ConfigureClassificationPostprocessingGraph(
+            model_resources, task_options.classifier_options(),
+            &postprocessing
+                 .GetOptions<components::processors::proto::
+                                 ClassificationPostprocessingGraphOptions>()));
+    begin_loop.Out(kItemTag) >> postprocessing.In(kTensorsTag);
+    auto& end_loop =
+        graph.AddNode("mediapipe.tasks.EndLoopClassificationResultCalculator");
+    postprocessing.Out(kClassificationsTag) >> end_loop.In(kItemTag);
+    begin_loop.Out(kBatchEndTag) >> end_loop.In(kBatchEndTag);
+
+    return end_loop[Output<std::vector<ClassificationResult>>(kIterableTag)];
+  }
+};
+REGISTER_MEDIAPIPE_GRAPH(
+    ::mediapipe::tasks::vision::image_classifier::DetectionsClassifierGraph);
+
+}  // namespace image_classifier
+}  // namespace vision
+}  // namespace tasks
+}  // namespace mediapipe
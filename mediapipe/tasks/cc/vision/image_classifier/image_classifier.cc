@@ -165,6 +165,36 @@ absl::StatusOr<ImageClassifierResult> ImageClassifier::Classify(
       output_packets[kClassificationsStreamName].Get<ClassificationResult>());
 }
 
+absl::StatusOr<std::vector<ImageClassifierResult>>
+ImageClassifier::ClassifyBatch(
+    std::vector<Image> images,
+    std::optional<core::ImageProcessingOptions> image_processing_options) {
+  ASSIGN_OR_RETURN(NormalizedRect norm_rect,
+                   ConvertToNormalizedRect(image_processing_options));
+  std::vector<PacketMap> inputs;
+  inputs.reserve(images.size());
+  for (Image& image : images) {
+    if (image.UsesGpu()) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "GPU input images are currently not supported.",
+          MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+    }
+    inputs.push_back(
+        {{kImageInStreamName, MakePacket<Image>(std::move(image))},
+         {kNormRectName, MakePacket<NormalizedRect>(norm_rect)}});
+  }
+  ASSIGN_OR_RETURN(auto outputs, ProcessImageDataBatch(std::move(inputs)));
+  std::vector<ImageClassifierResult> results;
+  results.reserve(outputs.size());
+  for (auto& output_packets : outputs) {
+    results.push_back(ConvertToClassificationResult(
+        output_packets[kClassificationsStreamName]
+            .Get<ClassificationResult>()));
+  }
+  return results;
+}
+
 absl::StatusOr<ImageClassifierResult> ImageClassifier::ClassifyForVideo(
     Image image, int64 timestamp_ms,
     std::optional<core::ImageProcessingOptions> image_processing_options) {
@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/image.h"
@@ -102,6 +103,10 @@ class ImageClassifier : tasks::vision::core::BaseVisionTaskApi {
  public:
   using BaseVisionTaskApi::BaseVisionTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates an ImageClassifier from the provided options. A non-default
   // OpResolver can be specified in the BaseOptions in order to support custom
   // Ops or specify a subset of built-in Ops.
@@ -130,6 +135,20 @@ class ImageClassifier : tasks::vision::core::BaseVisionTaskApi {
       std::optional<core::ImageProcessingOptions> image_processing_options =
           std::nullopt);
 
+  // Performs classification on a batch of images, e.g. for offline processing,
+  // and returns the results in the order of the images. Unlike calling
+  // Classify() for each image, the images are pipelined through the graph, so
+  // that the preprocessing of an image runs in parallel with the inference on
+  // the previous one. The same 'image_processing_options' apply to all the
+  // images.
+  //
+  // Only use this method when the ImageClassifier is created with the image
+  // running mode.
+  absl::StatusOr<std::vector<ImageClassifierResult>> ClassifyBatch(
+      std::vector<mediapipe::Image> images,
+      std::optional<core::ImageProcessingOptions> image_processing_options =
+          std::nullopt);
+
   // Performs image classification on the provided video frame.
   //
   // The optional 'image_processing_options' parameter can be used to specify:
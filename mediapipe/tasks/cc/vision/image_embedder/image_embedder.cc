@@ -161,6 +161,35 @@ absl::StatusOr<ImageEmbedderResult> ImageEmbedder::Embed(
       output_packets[kEmbeddingsStreamName].Get<EmbeddingResult>());
 }
 
+absl::StatusOr<std::vector<ImageEmbedderResult>>
+ImageEmbedder::EmbedBatch(
+    std::vector<Image> images,
+    std::optional<core::ImageProcessingOptions> image_processing_options) {
+  ASSIGN_OR_RETURN(NormalizedRect norm_rect,
+                   ConvertToNormalizedRect(image_processing_options));
+  std::vector<PacketMap> inputs;
+  inputs.reserve(images.size());
+  for (Image& image : images) {
+    if (image.UsesGpu()) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "GPU input images are currently not supported.",
+          MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+    }
+    inputs.push_back(
+        {{kImageInStreamName, MakePacket<Image>(std::move(image))},
+         {kNormRectStreamName, MakePacket<NormalizedRect>(norm_rect)}});
+  }
+  ASSIGN_OR_RETURN(auto outputs, ProcessImageDataBatch(std::move(inputs)));
+  std::vector<ImageEmbedderResult> results;
+  results.reserve(outputs.size());
+  for (auto& output_packets : outputs) {
+    results.push_back(ConvertToEmbeddingResult(
+        output_packets[kEmbeddingsStreamName].Get<EmbeddingResult>()));
+  }
+  return results;
+}
+
 absl::StatusOr<ImageEmbedderResult> ImageEmbedder::EmbedForVideo(
     Image image, int64 timestamp_ms,
     std::optional<core::ImageProcessingOptions> image_processing_options) {
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/image.h"
@@ -84,6 +85,10 @@ class ImageEmbedder : core::BaseVisionTaskApi {
  public:
   using BaseVisionTaskApi::BaseVisionTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates an ImageEmbedder from the provided options. A non-default
   // OpResolver can be specified in the BaseOptions in order to support custom
   // Ops or specify a subset of built-in Ops.
@@ -111,6 +116,20 @@ class ImageEmbedder : core::BaseVisionTaskApi {
       std::optional<core::ImageProcessingOptions> image_processing_options =
           std::nullopt);
 
+  // Performs embedding extraction on a batch of images, e.g. for offline
+  // processing, and returns the results in the order of the images. Unlike
+  // calling Embed() for each image, the images are pipelined through the graph,
+  // so that the preprocessing of an image runs in parallel with the inference
+  // on the previous one. The same 'image_processing_options' apply to all the
+  // images.
+  //
+  // Only use this method when the ImageEmbedder is created with the image
+  // running mode.
+  absl::StatusOr<std::vector<ImageEmbedderResult>> EmbedBatch(
+      std::vector<mediapipe::Image> images,
+      std::optional<core::ImageProcessingOptions> image_processing_options =
+          std::nullopt);
+
   // Performs embedding extraction on the provided video frame.
   //
   // The optional 'image_processing_options' parameter can be used to specify:
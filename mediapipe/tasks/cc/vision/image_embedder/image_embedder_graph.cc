@@ -132,11 +132,8 @@ class ImageEmbedderGraph : public core::ModelTaskGraph {
     // stream.
     auto& preprocessing = graph.AddNode(
         "mediapipe.tasks.components.processors.ImagePreprocessingGraph");
-    bool use_gpu =
-        components::processors::DetermineImagePreprocessingGpuBackend(
-            task_options.base_options().acceleration());
     MP_RETURN_IF_ERROR(components::processors::ConfigureImagePreprocessingGraph(
-        model_resources, use_gpu,
+        model_resources, task_options.base_options(),
         &preprocessing.GetOptions<tasks::components::processors::proto::
                                       ImagePreprocessingGraphOptions>()));
     image_in >> preprocessing.In(kImageTag);
@@ -145,7 +142,7 @@ class ImageEmbedderGraph : public core::ModelTaskGraph {
     // Adds inference subgraph and connects its input stream to the outoput
     // tensors produced by the ImageToTensorCalculator.
     auto& inference = AddInference(
-        model_resources, task_options.base_options().acceleration(), graph);
+        model_resources, task_options.base_options(), graph);
     preprocessing.Out(kTensorsTag) >> inference.In(kTensorsTag);
 
     // Adds postprocessing calculators and connects its input stream to the
@@ -0,0 +1,149 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/api2/port.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/tasks/cc/vision/image_segmenter/calculators/segmentation_tiles_calculator.pb.h"
+
+namespace mediapipe {
+namespace tasks {
+namespace {
+
+using ::mediapipe::api2::Input;
+using ::mediapipe::api2::Node;
+using ::mediapipe::api2::Output;
+
+// Returns the offsets of the tiles of size `tile_size` that cover an image
+// dimension of size `size`, evenly spaced with at least `overlap` of a tile
+// shared between neighbours. A dimension no larger than a tile is covered by
+// a single tile, which the caller scales to the dimension.
+std::vector<int> ComputeTileOffsets(int size, int tile_size, float overlap) {
+  if (size <= tile_size) {
+    return {0};
+  }
+  const float stride = tile_size * (1.0f - overlap);
+  const int num_tiles =
+      static_cast<int>(std::ceil((size - tile_size) / stride)) + 1;
+  std::vector<int> offsets(num_tiles);
+  for (int i = 0; i < num_tiles; ++i) {
+    offsets[i] = std::lround(static_cast<double>(size - tile_size) * i /
+                             (num_tiles - 1));
+  }
+  return offsets;
+}
+
+}  // namespace
+
+// Splits an image into overlapping tiles of the model input size, so that a
+// high resolution image can be segmented at full resolution with one batched
+// inference over the tiles. Tiles are evenly spaced along each dimension and
+// always cover the whole image.
+//
+// Inputs:
+//   IMAGE_SIZE: std::pair<int, int>. Width and height of the image.
+//   NORM_RECT (optional): NormalizedRect. The region of the image to segment,
+//     which must be the whole image without rotation.
+//
+// Outputs:
+//   NORM_RECTS: std::vector<NormalizedRect>. The tiles, in row-major order.
+//
+// Usage example:
+//  node {
+//    calculator: "mediapipe.tasks.SegmentationTilesCalculator"
+//    input_stream: "IMAGE_SIZE:image_size"
+//    output_stream: "NORM_RECTS:tiles"
+//    options {
+//      [mediapipe.tasks.SegmentationTilesCalculatorOptions.ext] {
+//        tile_width: 256
+//        tile_height: 256
+//        tile_overlap: 0.25
+//      }
+//    }
+//  }
+class SegmentationTilesCalculator : public Node {
+ public:
+  static constexpr Input<std::pair<int, int>> kImageSizeIn{"IMAGE_SIZE"};
+  static constexpr Input<NormalizedRect>::Optional kNormRectIn{"NORM_RECT"};
+  static constexpr Output<std::vector<NormalizedRect>> kNormRectsOut{
+      "NORM_RECTS"};
+  MEDIAPIPE_NODE_CONTRACT(kImageSizeIn, kNormRectIn, kNormRectsOut);
+
+  absl::Status Open(CalculatorContext* cc);
+  absl::Status Process(CalculatorContext* cc);
+
+ private:
+  SegmentationTilesCalculatorOptions options_;
+};
+
+absl::Status SegmentationTilesCalculator::Open(CalculatorContext* cc) {
+  options_ = cc->Options<SegmentationTilesCalculatorOptions>();
+  RET_CHECK(options_.tile_width() > 0 && options_.tile_height() > 0)
+      << "tile_width and tile_height must be positive.";
+  RET_CHECK(options_.tile_overlap() >= 0 && options_.tile_overlap() < 1)
+      << "tile_overlap must be in [0, 1).";
+  return absl::OkStatus();
+}
+
+absl::Status SegmentationTilesCalculator::Process(CalculatorContext* cc) {
+  if (kImageSizeIn(cc).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  if (!kNormRectIn(cc).IsEmpty()) {
+    const NormalizedRect& rect = kNormRectIn(cc).Get();
+    RET_CHECK(rect.rotation() == 0 && rect.x_center() == 0.5f &&
+              rect.y_center() == 0.5f && rect.width() == 1.0f &&
+              rect.height() == 1.0f)
+        << "Tiled segmentation only supports the whole image without "
+           "rotation.";
+  }
+  const auto& [width, height] = kImageSizeIn(cc).Get();
+  RET_CHECK(width > 0 && height > 0);
+  const int tile_width = std::min(options_.tile_width(), width);
+  const int tile_height = std::min(options_.tile_height(), height);
+  const std::vector<int> lefts =
+      ComputeTileOffsets(width, tile_width, options_.tile_overlap());
+  const std::vector<int> tops =
+      ComputeTileOffsets(height, tile_height, options_.tile_overlap());
+
+  std::vector<NormalizedRect> tiles;
+  tiles.reserve(lefts.size() * tops.size());
+  for (int top : tops) {
+    for (int left : lefts) {
+      NormalizedRect& tile = tiles.emplace_back();
+      tile.set_x_center((left + tile_width / 2.0f) / width);
+      tile.set_y_center((top + tile_height / 2.0f) / height);
+      tile.set_width(static_cast<float>(tile_width) / width);
+      tile.set_height(static_cast<float>(tile_height) / height);
+      tile.set_rotation(0);
+    }
+  }
+  kNormRectsOut(cc).Send(std::move(tiles));
+  return absl::OkStatus();
+}
+
+MEDIAPIPE_REGISTER_NODE(::mediapipe::tasks::SegmentationTilesCalculator);
+
+}  // namespace tasks
+}  // namespace mediapipe
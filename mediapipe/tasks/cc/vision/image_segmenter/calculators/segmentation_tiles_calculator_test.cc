@@ -0,0 +1,114 @@
+/* Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::HasSubstr;
+
+constexpr char kNodeConfig[] = R"pb(
+  calculator: "mediapipe.tasks.SegmentationTilesCalculator"
+  input_stream: "IMAGE_SIZE:image_size"
+  input_stream: "NORM_RECT:norm_rect"
+  output_stream: "NORM_RECTS:tiles"
+  options {
+    [mediapipe.tasks.SegmentationTilesCalculatorOptions.ext] {
+      tile_width: 256
+      tile_height: 256
+      tile_overlap: 0.25
+    }
+  }
+)pb";
+
+void AddImage(int width, int height, float rotation,
+              CalculatorRunner* runner) {
+  NormalizedRect norm_rect;
+  norm_rect.set_x_center(0.5);
+  norm_rect.set_y_center(0.5);
+  norm_rect.set_width(1);
+  norm_rect.set_height(1);
+  norm_rect.set_rotation(rotation);
+  auto* inputs = runner->MutableInputs();
+  inputs->Tag("IMAGE_SIZE").packets.push_back(
+      MakePacket<std::pair<int, int>>(width, height).At(Timestamp(0)));
+  inputs->Tag("NORM_RECT").packets.push_back(
+      MakePacket<NormalizedRect>(norm_rect).At(Timestamp(0)));
+}
+
+TEST(SegmentationTilesCalculatorTest, SplitsImageIntoOverlappingTiles) {
+  CalculatorRunner runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(kNodeConfig));
+  AddImage(/*width=*/600, /*height=*/300, /*rotation=*/0, &runner);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag("NORM_RECTS").packets;
+  ASSERT_EQ(packets.size(), 1);
+  const auto& tiles = packets[0].Get<std::vector<NormalizedRect>>();
+  // Tiles start at x = 0, 172, 344 and y = 0, 44.
+  ASSERT_EQ(tiles.size(), 6);
+  EXPECT_FLOAT_EQ(tiles[0].x_center(), 128.0f / 600);
+  EXPECT_FLOAT_EQ(tiles[0].y_center(), 128.0f / 300);
+  EXPECT_FLOAT_EQ(tiles[1].x_center(), 300.0f / 600);
+  EXPECT_FLOAT_EQ(tiles[5].x_center(), 472.0f / 600);
+  EXPECT_FLOAT_EQ(tiles[5].y_center(), 172.0f / 300);
+  for (const NormalizedRect& tile : tiles) {
+    EXPECT_FLOAT_EQ(tile.width(), 256.0f / 600);
+    EXPECT_FLOAT_EQ(tile.height(), 256.0f / 300);
+  }
+}
+
+TEST(SegmentationTilesCalculatorTest, UsesSingleTileForSmallImage) {
+  CalculatorRunner runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(kNodeConfig));
+  AddImage(/*width=*/200, /*height=*/100, /*rotation=*/0, &runner);
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& tiles = runner.Outputs()
+                          .Tag("NORM_RECTS")
+                          .packets[0]
+                          .Get<std::vector<NormalizedRect>>();
+  ASSERT_EQ(tiles.size(), 1);
+  EXPECT_FLOAT_EQ(tiles[0].x_center(), 0.5);
+  EXPECT_FLOAT_EQ(tiles[0].y_center(), 0.5);
+  EXPECT_FLOAT_EQ(tiles[0].width(), 1);
+  EXPECT_FLOAT_EQ(tiles[0].height(), 1);
+}
+
+TEST(SegmentationTilesCalculatorTest, FailsWithRotation) {
+  CalculatorRunner runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(kNodeConfig));
+  AddImage(/*width=*/600, /*height=*/300, /*rotation=*/0.5, &runner);
+
+  absl::Status status = runner.Run();
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.message(),
+              HasSubstr("only supports the whole image without rotation"));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -22,18 +24,21 @@ limitations under the License.
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/tensors_to_segmentation_utils.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/packet.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
-#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
+#include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
-#include "mediapipe/framework/port/opencv_core_inc.h"
-#include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/tasks/cc/vision/image_segmenter/calculators/tensors_to_segmentation_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/image_segmenter/proto/segmenter_options.pb.h"
 #include "mediapipe/tasks/cc/vision/utils/image_utils.h"
@@ -46,6 +51,7 @@ namespace {
 
 using ::mediapipe::Image;
 using ::mediapipe::ImageFrameSharedPtr;
+using ::mediapipe::NormalizedRect;
 using ::mediapipe::api2::Input;
 using ::mediapipe::api2::Node;
 using ::mediapipe::api2::Output;
@@ -54,25 +60,88 @@ using ::mediapipe::tasks::vision::GetImageLikeTensorShape;
 using ::mediapipe::tasks::vision::Shape;
 using ::mediapipe::tasks::vision::image_segmenter::proto::SegmenterOptions;
 
-void StableSoftmax(absl::Span<const float> values,
-                   absl::Span<float> activated_values) {
-  float max_value = *std::max_element(values.begin(), values.end());
-  float denominator = 0.f;
-  std::transform(values.begin(), values.end(), activated_values.begin(),
-                 [&](float val) {
-                   float exp_val = std::exp(val - max_value);
-                   denominator += exp_val;
-                   return exp_val;
-                 });
-  std::transform(activated_values.begin(), activated_values.end(),
-                 activated_values.begin(),
-                 [&denominator](float val) { return val / denominator; });
+// Number of confidence masks of each channel kept around for reuse.
+constexpr int kMaskPoolKeepCount = 2;
+
+// The bounds of a region of the output image, in pixels.
+struct RegionBounds {
+  int left;
+  int top;
+  int width;
+  int height;
+};
+
+RegionBounds GetRegionBounds(const NormalizedRect& rect, int image_width,
+                             int image_height) {
+  RegionBounds bounds;
+  bounds.width =
+      std::max(1, static_cast<int>(std::lround(rect.width() * image_width)));
+  bounds.height =
+      std::max(1, static_cast<int>(std::lround(rect.height() * image_height)));
+  bounds.left =
+      std::lround(rect.x_center() * image_width - bounds.width / 2.0f);
+  bounds.top =
+      std::lround(rect.y_center() * image_height - bounds.height / 2.0f);
+  return bounds;
+}
+
+SegmentationActivation GetActivation(const SegmenterOptions& options) {
+  switch (options.activation()) {
+    case SegmenterOptions::SIGMOID:
+      return SegmentationActivation::kSigmoid;
+    case SegmenterOptions::SOFTMAX:
+      return SegmentationActivation::kSoftmax;
+    default:
+      return SegmentationActivation::kNone;
+  }
 }
 
-void Sigmoid(absl::Span<const float> values,
-             absl::Span<float> activated_values) {
-  std::transform(values.begin(), values.end(), activated_values.begin(),
-                 [](float value) { return 1. / (1 + std::exp(-value)); });
+// Runs `task` for every index in [0, num_tasks), spread over `thread_pool` if
+// not null, and returns the first error.
+absl::Status RunInParallel(int num_tasks, ThreadPool* thread_pool,
+                           const std::function<absl::Status(int)>& task) {
+  if (thread_pool == nullptr || num_tasks <= 1) {
+    for (int i = 0; i < num_tasks; ++i) {
+      MP_RETURN_IF_ERROR(task(i));
+    }
+    return absl::OkStatus();
+  }
+  std::vector<absl::Status> statuses(num_tasks);
+  absl::BlockingCounter counter(num_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    thread_pool->Schedule([&task, &statuses, &counter, i] {
+      statuses[i] = task(i);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (const absl::Status& status : statuses) {
+    MP_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+// Adds the pixels of a tile, weighted by their distance to the closest tile
+// border so that the seams between tiles fade out, to the `width` x `height`
+// buffer `sums`. Adds the weights themselves if `tile_mask` is null.
+void AccumulateTile(const RegionBounds& tile, const ImageFrame* tile_mask,
+                    int width, int height, float* sums) {
+  const int y_begin = std::max(0, -tile.top);
+  const int y_end = std::min(tile.height, height - tile.top);
+  const int x_begin = std::max(0, -tile.left);
+  const int x_end = std::min(tile.width, width - tile.left);
+  for (int y = y_begin; y < y_end; ++y) {
+    const float* tile_row =
+        tile_mask ? reinterpret_cast<const float*>(tile_mask->PixelData() +
+                                                   y * tile_mask->WidthStep())
+                  : nullptr;
+    float* sums_row = sums + (tile.top + y) * width + tile.left;
+    const int y_weight = std::min(y + 1, tile.height - y);
+    for (int x = x_begin; x < x_end; ++x) {
+      const float weight = std::min(y_weight, std::min(x + 1, tile.width - x));
+      sums_row[x] += tile_row ? weight * tile_row[x] : weight;
+    }
+  }
 }
 
 }  // namespace
@@ -82,14 +151,27 @@ void Sigmoid(absl::Span<const float> values,
 // Performs optional resizing to OUTPUT_SIZE dimension if provided,
 // otherwise the segmented masks is the same size as input tensor.
 //
+// If NORM_RECTS is provided, the tensor holds a batch with the segmentation of
+// every rect, and the masks of the rects are computed in parallel. They are
+// either output per rect to REGION_SEGMENTATION, each at the size of its rect
+// in the output image, or, if REGION_SEGMENTATION is not connected, stitched
+// into full size SEGMENTATION masks. Overlapping rects, such as the tiles of
+// SegmentationTilesCalculator, are blended with weights that decrease towards
+// the rect borders.
+//
 // Inputs:
 //   TENSORS: Vector containing a single KTfLiteFloat32 Tensor to be converted
 //            to segmentation masks.
 //   OUTPUT_SIZE(optional): std::pair<int, int>. Height and Width, if provided,
 //            the size to resize masks to.
+//   NORM_RECTS(optional): std::vector<NormalizedRect>. The regions of the
+//            output image the batch of the tensor was extracted from. Stitched
+//            regions must not be rotated.
 //
 // Output:
-//   Segmentation: Segmentation proto.
+//   SEGMENTATION: Segmentation masks of the whole image.
+//   REGION_SEGMENTATION(optional): std::vector<std::vector<Image>>. The
+//            segmentation masks of every rect of NORM_RECTS.
 //
 // Options:
 //   See tensors_to_segmentation_calculator.proto
@@ -115,18 +197,34 @@ class TensorsToSegmentationCalculator : public Node {
   static constexpr Input<std::vector<Tensor>> kTensorsIn{"TENSORS"};
   static constexpr Input<std::pair<int, int>>::Optional kOutputSizeIn{
       "OUTPUT_SIZE"};
+  static constexpr Input<std::vector<NormalizedRect>>::Optional kNormRectsIn{
+      "NORM_RECTS"};
   static constexpr Output<Image>::Multiple kSegmentationOut{"SEGMENTATION"};
-  MEDIAPIPE_NODE_CONTRACT(kTensorsIn, kOutputSizeIn, kSegmentationOut);
+  static constexpr Output<std::vector<std::vector<Image>>>::Optional
+      kRegionSegmentationOut{"REGION_SEGMENTATION"};
+  MEDIAPIPE_NODE_CONTRACT(kTensorsIn, kOutputSizeIn, kNormRectsIn,
+                          kSegmentationOut, kRegionSegmentationOut);
 
   absl::Status Open(CalculatorContext* cc);
   absl::Status Process(CalculatorContext* cc);
 
  private:
-  std::vector<Image> GetSegmentationResult(const Shape& input_shape,
-                                           const Shape& output_shape,
-                                           const float* tensors_buffer);
+  absl::StatusOr<std::vector<Image>> GetSegmentationResult(
+      const Shape& input_shape, const Shape& output_shape,
+      const float* tensors_buffer);
+  absl::StatusOr<std::vector<std::vector<Image>>> GetRegionSegmentationResults(
+      const Shape& input_shape, const Shape& output_shape,
+      absl::Span<const RegionBounds> regions, const float* tensors_buffer);
+  absl::StatusOr<std::vector<Image>> GetStitchedSegmentationResult(
+      const Shape& input_shape, const Shape& output_shape,
+      absl::Span<const RegionBounds> tiles, const float* tensors_buffer);
 
   TensorsToSegmentationCalculatorOptions options_;
+  // Confidence masks, reallocated when the output shape changes.
+  std::shared_ptr<ImageFramePool> confidence_mask_pool_;
+  // Splits the computation of confidence masks, or of the masks of the
+  // regions, between threads, if num_threads > 1.
+  std::unique_ptr<ThreadPool> thread_pool_;
 };
 
 absl::Status TensorsToSegmentationCalculator::Open(
@@ -135,11 +233,20 @@ absl::Status TensorsToSegmentationCalculator::Open(
   RET_CHECK_NE(options_.segmenter_options().output_type(),
                SegmenterOptions::UNSPECIFIED)
       << "Must specify output_type as one of [CONFIDENCE_MASK|CATEGORY_MASK].";
+  if (options_.num_threads() > 1) {
+    thread_pool_ = std::make_unique<ThreadPool>("TensorsToSegmentation",
+                                                options_.num_threads());
+    thread_pool_->StartWorkers();
+  }
   return absl::OkStatus();
 }
 
 absl::Status TensorsToSegmentationCalculator::Process(
     mediapipe::CalculatorContext* cc) {
+  // No tensors are produced for an empty batch of regions.
+  if (kTensorsIn(cc).IsEmpty()) {
+    return absl::OkStatus();
+  }
   RET_CHECK_EQ(kTensorsIn(cc).Get().size(), 1)
       << "Expect a vector of single Tensor.";
   const auto& input_tensor = kTensorsIn(cc).Get()[0];
@@ -167,90 +274,232 @@ absl::Status TensorsToSegmentationCalculator::Process(
           ? 1
           : input_shape.channels};
 
-  std::vector<Image> segmented_masks = GetSegmentationResult(
-      input_shape, output_shape, input_tensor.GetCpuReadView().buffer<float>());
+  auto input_view = input_tensor.GetCpuReadView();
+  const float* tensors_buffer = input_view.buffer<float>();
+  std::vector<Image> segmented_masks;
+  if (kNormRectsIn(cc).IsConnected()) {
+    RET_CHECK(!kNormRectsIn(cc).IsEmpty());
+    const std::vector<NormalizedRect>& rects = kNormRectsIn(cc).Get();
+    const auto& dims = input_tensor.shape().dims;
+    RET_CHECK(dims.size() == 4 && dims[0] == static_cast<int>(rects.size()))
+        << "Expect a tensor with a batch of " << rects.size() << " regions.";
+    std::vector<RegionBounds> regions;
+    regions.reserve(rects.size());
+    for (const NormalizedRect& rect : rects) {
+      regions.push_back(GetRegionBounds(rect, output_width, output_height));
+    }
+    if (kRegionSegmentationOut(cc).IsConnected()) {
+      ASSIGN_OR_RETURN(std::vector<std::vector<Image>> region_masks,
+                       GetRegionSegmentationResults(input_shape, output_shape,
+                                                    regions, tensors_buffer));
+      kRegionSegmentationOut(cc).Send(std::move(region_masks));
+      return absl::OkStatus();
+    }
+    for (const NormalizedRect& rect : rects) {
+      RET_CHECK_EQ(rect.rotation(), 0)
+          << "Stitched regions must not be rotated.";
+    }
+    ASSIGN_OR_RETURN(segmented_masks,
+                     GetStitchedSegmentationResult(input_shape, output_shape,
+                                                   regions, tensors_buffer));
+  } else {
+    ASSIGN_OR_RETURN(segmented_masks,
+                     GetSegmentationResult(input_shape, output_shape,
+                                           tensors_buffer));
+  }
   for (int i = 0; i < segmented_masks.size(); ++i) {
     kSegmentationOut(cc)[i].Send(std::move(segmented_masks[i]));
   }
   return absl::OkStatus();
 }
 
-std::vector<Image> TensorsToSegmentationCalculator::GetSegmentationResult(
+absl::StatusOr<std::vector<Image>>
+TensorsToSegmentationCalculator::GetSegmentationResult(
     const Shape& input_shape, const Shape& output_shape,
     const float* tensors_buffer) {
-  std::function<void(absl::Span<const float> values,
-                     absl::Span<float> activated_values)>
-      activation_fn;
-  switch (options_.segmenter_options().activation()) {
-    case SegmenterOptions::SIGMOID:
-      activation_fn = &Sigmoid;
-      break;
-    case SegmenterOptions::SOFTMAX:
-      activation_fn = &StableSoftmax;
-      break;
-    case SegmenterOptions::NONE:
-      // Just copying for NONE activation.
-      activation_fn = [](absl::Span<const float> values,
-                         absl::Span<float> activated_values) {
-        std::copy(values.begin(), values.end(), activated_values.begin());
-      };
-      break;
+  std::vector<Image> segmented_masks;
+  segmented_masks.reserve(output_shape.channels);
+
+  if (options_.segmenter_options().output_type() ==
+      SegmenterOptions::CONFIDENCE_MASK) {
+    const SegmentationActivation activation =
+        GetActivation(options_.segmenter_options());
+    // Activates and resizes the tensor straight into the output masks.
+    if (!confidence_mask_pool_ ||
+        confidence_mask_pool_->width() != output_shape.width ||
+        confidence_mask_pool_->height() != output_shape.height) {
+      confidence_mask_pool_ = ImageFramePool::Create(
+          output_shape.width, output_shape.height, ImageFormat::VEC32F1,
+          kMaskPoolKeepCount * output_shape.channels);
+    }
+    std::vector<int> channels(output_shape.channels);
+    std::vector<ImageFrameSharedPtr> mask_frames(output_shape.channels);
+    std::vector<ImageFrame*> masks(output_shape.channels);
+    for (int i = 0; i < output_shape.channels; ++i) {
+      channels[i] = i;
+      mask_frames[i] = confidence_mask_pool_->GetBuffer();
+      masks[i] = mask_frames[i].get();
+    }
+    MP_RETURN_IF_ERROR(ComputeSegmentationMasks(
+        tensors_buffer, input_shape.height, input_shape.width,
+        input_shape.channels, activation, channels, masks,
+        thread_pool_.get()));
+    for (ImageFrameSharedPtr& mask_frame : mask_frames) {
+      segmented_masks.push_back(Image(std::move(mask_frame)));
+    }
+    return segmented_masks;
   }
 
-  const bool is_category_mask = options_.segmenter_options().output_type() ==
-                                SegmenterOptions::CATEGORY_MASK;
-  const int cv_mat_type = is_category_mask ? CV_8UC1 : CV_32FC1;
-  const int output_masks_num = output_shape.channels;
-
-  // TODO Use libyuv for resizing instead.
-  std::vector<cv::Mat> segmented_mask_mats;
-  segmented_mask_mats.reserve(output_masks_num);
-  for (int i = 0; i < output_masks_num; ++i) {
-    segmented_mask_mats.push_back(
-        cv::Mat(input_shape.height, input_shape.width, cv_mat_type));
+  // Takes the argmax of the raw scores straight into the output mask.
+  ImageFrameSharedPtr image_frame_ptr = std::make_shared<ImageFrame>(
+      ImageFormat::GRAY8, output_shape.width, output_shape.height, 1);
+  MP_RETURN_IF_ERROR(ComputeCategoryMask(
+      tensors_buffer, input_shape.height, input_shape.width,
+      input_shape.channels, image_frame_ptr.get(), thread_pool_.get()));
+  segmented_masks.push_back(Image(image_frame_ptr));
+  return segmented_masks;
+}
+
+absl::StatusOr<std::vector<std::vector<Image>>>
+TensorsToSegmentationCalculator::GetRegionSegmentationResults(
+    const Shape& input_shape, const Shape& output_shape,
+    absl::Span<const RegionBounds> regions, const float* tensors_buffer) {
+  const int tensor_size =
+      input_shape.height * input_shape.width * input_shape.channels;
+  const bool category_mask = options_.segmenter_options().output_type() ==
+                             SegmenterOptions::CATEGORY_MASK;
+  const SegmentationActivation activation =
+      GetActivation(options_.segmenter_options());
+  // Region masks vary in size, so they are not pooled. The thread pool goes to
+  // the regions if there are several, and to the rows of the masks otherwise.
+  ThreadPool* mask_thread_pool =
+      regions.size() > 1 ? nullptr : thread_pool_.get();
+  std::vector<std::vector<Image>> region_masks(regions.size());
+  MP_RETURN_IF_ERROR(RunInParallel(
+      regions.size(), thread_pool_.get(), [&](int r) -> absl::Status {
+        const float* region_buffer = tensors_buffer + r * tensor_size;
+        if (category_mask) {
+          auto mask = std::make_shared<ImageFrame>(
+              ImageFormat::GRAY8, regions[r].width, regions[r].height, 1);
+          MP_RETURN_IF_ERROR(ComputeCategoryMask(
+              region_buffer, input_shape.height, input_shape.width,
+              input_shape.channels, mask.get(), mask_thread_pool));
+          region_masks[r].push_back(Image(std::move(mask)));
+          return absl::OkStatus();
+        }
+        std::vector<int> channels(output_shape.channels);
+        std::vector<ImageFrameSharedPtr> mask_frames(output_shape.channels);
+        std::vector<ImageFrame*> masks(output_shape.channels);
+        for (int i = 0; i < output_shape.channels; ++i) {
+          channels[i] = i;
+          mask_frames[i] = std::make_shared<ImageFrame>(
+              ImageFormat::VEC32F1, regions[r].width, regions[r].height);
+          masks[i] = mask_frames[i].get();
+        }
+        MP_RETURN_IF_ERROR(ComputeSegmentationMasks(
+            region_buffer, input_shape.height, input_shape.width,
+            input_shape.channels, activation, channels, masks,
+            mask_thread_pool));
+        for (ImageFrameSharedPtr& mask_frame : mask_frames) {
+          region_masks[r].push_back(Image(std::move(mask_frame)));
+        }
+        return absl::OkStatus();
+      }));
+  return region_masks;
+}
+
+absl::StatusOr<std::vector<Image>>
+TensorsToSegmentationCalculator::GetStitchedSegmentationResult(
+    const Shape& input_shape, const Shape& output_shape,
+    absl::Span<const RegionBounds> tiles, const float* tensors_buffer) {
+  const int tensor_size =
+      input_shape.height * input_shape.width * input_shape.channels;
+  const int num_pixels = output_shape.width * output_shape.height;
+  const bool category_mask = options_.segmenter_options().output_type() ==
+                             SegmenterOptions::CATEGORY_MASK;
+  // Category masks take the highest scoring channel of the stitched raw
+  // scores, one channel at a time to bound the memory used.
+  const SegmentationActivation activation =
+      category_mask ? SegmentationActivation::kNone
+                    : GetActivation(options_.segmenter_options());
+  const int num_channels = category_mask ? input_shape.channels
+                                         : output_shape.channels;
+
+  std::vector<float> inverse_weights(num_pixels, 0.0f);
+  for (const RegionBounds& tile : tiles) {
+    AccumulateTile(tile, /*tile_mask=*/nullptr, output_shape.width,
+                   output_shape.height, inverse_weights.data());
+  }
+  for (float& weight : inverse_weights) {
+    RET_CHECK_GT(weight, 0) << "Tiles must cover the whole output image.";
+    weight = 1.0f / weight;
   }
 
-  // Applies activation function.
-  const int tensor_size = input_shape.height * input_shape.width;
-  if (is_category_mask) {
-    for (int i = 0; i < tensor_size; ++i) {
-      absl::Span<const float> confidence_scores(
-          &tensors_buffer[i * input_shape.channels], input_shape.channels);
-      const int maximum_category_idx =
-          std::max_element(confidence_scores.begin(), confidence_scores.end()) -
-          confidence_scores.begin();
-      segmented_mask_mats[0].at<uint8_t>(
-          i / input_shape.width, i % input_shape.width) = maximum_category_idx;
+  std::vector<ImageFrameSharedPtr> tile_masks(tiles.size());
+  for (int t = 0; t < tiles.size(); ++t) {
+    tile_masks[t] = std::make_shared<ImageFrame>(
+        ImageFormat::VEC32F1, tiles[t].width, tiles[t].height);
+  }
+  if (!category_mask &&
+      (!confidence_mask_pool_ ||
+       confidence_mask_pool_->width() != output_shape.width ||
+       confidence_mask_pool_->height() != output_shape.height)) {
+    confidence_mask_pool_ = ImageFramePool::Create(
+        output_shape.width, output_shape.height, ImageFormat::VEC32F1,
+        kMaskPoolKeepCount * output_shape.channels);
+  }
+  std::vector<Image> segmented_masks;
+  std::vector<float> sums(num_pixels);
+  std::vector<float> max_scores;
+  ImageFrameSharedPtr category_frame;
+  if (category_mask) {
+    max_scores.resize(num_pixels);
+    category_frame = std::make_shared<ImageFrame>(
+        ImageFormat::GRAY8, output_shape.width, output_shape.height, 1);
+  }
+  for (int channel = 0; channel < num_channels; ++channel) {
+    // The masks of the tiles are computed in parallel, then blended.
+    MP_RETURN_IF_ERROR(RunInParallel(
+        tiles.size(), thread_pool_.get(), [&](int t) -> absl::Status {
+          ImageFrame* tile_mask = tile_masks[t].get();
+          return ComputeSegmentationMasks(
+              tensors_buffer + t * tensor_size, input_shape.height,
+              input_shape.width, input_shape.channels, activation, {channel},
+              absl::MakeConstSpan(&tile_mask, 1), /*thread_pool=*/nullptr);
+        }));
+    std::fill(sums.begin(), sums.end(), 0.0f);
+    for (int t = 0; t < tiles.size(); ++t) {
+      AccumulateTile(tiles[t], tile_masks[t].get(), output_shape.width,
+                     output_shape.height, sums.data());
     }
-  } else {
-    std::vector<float> activated_values(input_shape.channels);
-    absl::Span<float> activated_values_span(activated_values);
-    for (int i = 0; i < tensor_size; ++i) {
-      activation_fn(
-          absl::MakeConstSpan(&tensors_buffer[i * input_shape.channels],
-                              input_shape.channels),
-          activated_values_span);
-      for (int j = 0; j < input_shape.channels; ++j) {
-        segmented_mask_mats[j].at<float>(
-            i / input_shape.width, i % input_shape.width) = activated_values[j];
+    for (int i = 0; i < num_pixels; ++i) {
+      sums[i] *= inverse_weights[i];
+    }
+
+    if (category_mask) {
+      for (int y = 0; y < output_shape.height; ++y) {
+        uint8_t* category_row = category_frame->MutablePixelData() +
+                                y * category_frame->WidthStep();
+        for (int x = 0; x < output_shape.width; ++x) {
+          const int i = y * output_shape.width + x;
+          if (channel == 0 || sums[i] > max_scores[i]) {
+            max_scores[i] = sums[i];
+            category_row[x] = channel;
+          }
+        }
       }
+      continue;
     }
+    ImageFrameSharedPtr mask_frame = confidence_mask_pool_->GetBuffer();
+    for (int y = 0; y < output_shape.height; ++y) {
+      std::copy_n(sums.data() + y * output_shape.width, output_shape.width,
+                  reinterpret_cast<float*>(mask_frame->MutablePixelData() +
+                                           y * mask_frame->WidthStep()));
+    }
+    segmented_masks.push_back(Image(std::move(mask_frame)));
   }
-
-  std::vector<Image> segmented_masks;
-  segmented_masks.reserve(output_masks_num);
-  // Resizes segmented masks to required output size.
-  for (int i = 0; i < segmented_mask_mats.size(); i++) {
-    // Pre-allocates ImageFrame memory to avoid copying from cv::Mat afterward.
-    ImageFrameSharedPtr image_frame_ptr = std::make_shared<ImageFrame>(
-        is_category_mask ? ImageFormat::GRAY8 : ImageFormat::VEC32F1,
-        output_shape.width, output_shape.height, 1);
-    cv::Mat resized_mask_mat_view =
-        mediapipe::formats::MatView(image_frame_ptr.get());
-    cv::resize(segmented_mask_mats[i], resized_mask_mat_view,
-               resized_mask_mat_view.size(), 0, 0,
-               cv_mat_type == CV_8UC1 ? cv::INTER_NEAREST : cv::INTER_LINEAR);
-    segmented_masks.push_back(Image(image_frame_ptr));
+  if (category_mask) {
+    segmented_masks.push_back(Image(std::move(category_frame)));
   }
   return segmented_masks;
 }
@@ -27,6 +27,7 @@ limitations under the License.
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/gmock.h"
@@ -76,6 +77,48 @@ void PushTensorsToRunner(int tensor_height, int tensor_width,
       mediapipe::Adopt(tensors.release()).At(Timestamp(0)));
 }
 
+// Pushes a batch of tensors where every pixel of batch entry `i` holds
+// `test_values[i]`.
+void PushBatchedTensorsToRunner(
+    int tensor_height, int tensor_width,
+    const std::vector<std::vector<float>>& test_values,
+    CalculatorRunner* runner) {
+  const int batch = test_values.size();
+  const int channels = test_values[0].size();
+  auto tensors = absl::make_unique<std::vector<Tensor>>();
+  tensors->emplace_back(
+      Tensor::ElementType::kFloat32,
+      Tensor::Shape{batch, tensor_height, tensor_width, channels});
+  auto view = tensors->back().GetCpuWriteView();
+  float* tensor_buffer = view.buffer<float>();
+  ASSERT_NE(tensor_buffer, nullptr);
+  for (int b = 0; b < batch; ++b) {
+    for (int i = 0; i < tensor_height * tensor_width; ++i) {
+      std::copy(test_values[b].begin(), test_values[b].end(),
+                tensor_buffer + (b * tensor_height * tensor_width + i) *
+                                    channels);
+    }
+  }
+  runner->MutableInputs()->Tag("TENSORS").packets.push_back(
+      mediapipe::Adopt(tensors.release()).At(Timestamp(0)));
+}
+
+NormalizedRect MakeRect(float x_center, float y_center, float width,
+                        float height) {
+  NormalizedRect rect;
+  rect.set_x_center(x_center);
+  rect.set_y_center(y_center);
+  rect.set_width(width);
+  rect.set_height(height);
+  return rect;
+}
+
+float GetPixel(const Image& mask, int x, int y) {
+  auto image_frame_ptr = mask.GetImageFrameSharedPtr();
+  return reinterpret_cast<const float*>(image_frame_ptr->PixelData() +
+                                        y * image_frame_ptr->WidthStep())[x];
+}
+
 std::vector<Packet> GetPackets(const CalculatorRunner& runner) {
   std::vector<Packet> mask_packets;
   for (int i = 0; i < runner.Outputs().NumEntries(); ++i) {
@@ -295,6 +338,59 @@ TEST(TensorsToSegmentationCalculatorTest, SucceedsConfidenceMaskWithSigmoid) {
                                    kExpectedSigmoidValues[3], buffer_indices)));
 }
 
+TEST(TensorsToSegmentationCalculatorTest,
+     SucceedsConfidenceMaskResizeWithThreads) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
+          R"pb(
+            calculator: "mediapipe.tasks.TensorsToSegmentationCalculator"
+            input_stream: "TENSORS:tensors"
+            input_stream: "OUTPUT_SIZE:size"
+            output_stream: "SEGMENTATION:0:segmented_mask_0"
+            output_stream: "SEGMENTATION:1:segmented_mask_1"
+            output_stream: "SEGMENTATION:2:segmented_mask_2"
+            output_stream: "SEGMENTATION:3:segmented_mask_3"
+            options {
+              [mediapipe.tasks.TensorsToSegmentationCalculatorOptions.ext] {
+                segmenter_options {
+                  activation: SIGMOID
+                  output_type: CONFIDENCE_MASK
+                }
+                num_threads: 2
+              }
+            }
+          )pb"));
+
+  const int input_height = 3;
+  const int input_width = 4;
+  const int output_height = 50;
+  const int output_width = 40;
+
+  PushTensorsToRunner(
+      input_height, input_width,
+      std::vector<float>(kTestValues.begin(), kTestValues.end()), &runner);
+  runner.MutableInputs()
+      ->Tag("OUTPUT_SIZE")
+      .packets.push_back(mediapipe::MakePacket<std::pair<int, int>>(
+                             std::make_pair(output_width, output_height))
+                             .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  // All pixels of the tensor are equal, so are all pixels of the masks.
+  const std::vector<int> buffer_indices = {0, 1, output_width - 1};
+  std::vector<Packet> packets = GetPackets(runner);
+  EXPECT_THAT(packets,
+              testing::ElementsAre(
+                  FloatImagePacket(output_height, output_width,
+                                   kExpectedSigmoidValues[0], buffer_indices),
+                  FloatImagePacket(output_height, output_width,
+                                   kExpectedSigmoidValues[1], buffer_indices),
+                  FloatImagePacket(output_height, output_width,
+                                   kExpectedSigmoidValues[2], buffer_indices),
+                  FloatImagePacket(output_height, output_width,
+                                   kExpectedSigmoidValues[3], buffer_indices)));
+}
+
 TEST(TensorsToSegmentationCalculatorTest, SucceedsCategoryMask) {
   CalculatorRunner runner(
       mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
@@ -373,4 +469,107 @@ TEST(TensorsToSegmentationCalculatorTest, SucceedsCategoryMaskResize) {
                                             expected_index, buffer_indices)));
 }
 
+TEST(TensorsToSegmentationCalculatorTest, SucceedsRegionConfidenceMasks) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
+          R"pb(
+            calculator: "mediapipe.tasks.TensorsToSegmentationCalculator"
+            input_stream: "TENSORS:tensors"
+            input_stream: "OUTPUT_SIZE:size"
+            input_stream: "NORM_RECTS:rects"
+            output_stream: "REGION_SEGMENTATION:region_segmentation"
+            options {
+              [mediapipe.tasks.TensorsToSegmentationCalculatorOptions.ext] {
+                segmenter_options {
+                  activation: SOFTMAX
+                  output_type: CONFIDENCE_MASK
+                }
+                num_threads: 2
+              }
+            }
+          )pb"));
+
+  const std::vector<float> test_values(kTestValues.begin(), kTestValues.end());
+  std::vector<float> reversed_values(test_values.rbegin(),
+                                     test_values.rend());
+  PushBatchedTensorsToRunner(/*tensor_height=*/2, /*tensor_width=*/2,
+                             {test_values, reversed_values}, &runner);
+  runner.MutableInputs()->Tag("NORM_RECTS").packets.push_back(
+      mediapipe::MakePacket<std::vector<NormalizedRect>>(
+          std::vector<NormalizedRect>{MakeRect(0.25, 0.25, 0.5, 0.5),
+                                      MakeRect(0.5, 0.5, 0.2, 0.1)})
+          .At(Timestamp(0)));
+  runner.MutableInputs()->Tag("OUTPUT_SIZE").packets.push_back(
+      mediapipe::MakePacket<std::pair<int, int>>(std::make_pair(100, 80))
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& packets = runner.Outputs().Tag("REGION_SEGMENTATION").packets;
+  ASSERT_EQ(packets.size(), 1);
+  const auto& region_masks = packets[0].Get<std::vector<std::vector<Image>>>();
+  ASSERT_EQ(region_masks.size(), 2);
+  ASSERT_EQ(region_masks[0].size(), 4);
+  ASSERT_EQ(region_masks[1].size(), 4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(region_masks[0][i].width(), 50);
+    EXPECT_EQ(region_masks[0][i].height(), 40);
+    EXPECT_NEAR(GetPixel(region_masks[0][i], 10, 10),
+                kExpectedSoftmaxValues[i], 1e-5);
+    EXPECT_EQ(region_masks[1][i].width(), 20);
+    EXPECT_EQ(region_masks[1][i].height(), 8);
+    EXPECT_NEAR(GetPixel(region_masks[1][i], 10, 5),
+                kExpectedSoftmaxValues[3 - i], 1e-5);
+  }
+}
+
+TEST(TensorsToSegmentationCalculatorTest, SucceedsStitchedTiles) {
+  CalculatorRunner runner(
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(
+          R"pb(
+            calculator: "mediapipe.tasks.TensorsToSegmentationCalculator"
+            input_stream: "TENSORS:tensors"
+            input_stream: "OUTPUT_SIZE:size"
+            input_stream: "NORM_RECTS:rects"
+            output_stream: "SEGMENTATION:segmentation"
+            options {
+              [mediapipe.tasks.TensorsToSegmentationCalculatorOptions.ext] {
+                segmenter_options {
+                  activation: NONE
+                  output_type: CONFIDENCE_MASK
+                }
+              }
+            }
+          )pb"));
+
+  // Two tiles of width 5 overlapping over x = 3 and x = 4 of an 8x4 image.
+  PushBatchedTensorsToRunner(/*tensor_height=*/4, /*tensor_width=*/4,
+                             {{1.0}, {3.0}}, &runner);
+  runner.MutableInputs()->Tag("NORM_RECTS").packets.push_back(
+      mediapipe::MakePacket<std::vector<NormalizedRect>>(
+          std::vector<NormalizedRect>{MakeRect(2.5 / 8, 0.5, 5.0 / 8, 1),
+                                      MakeRect(5.5 / 8, 0.5, 5.0 / 8, 1)})
+          .At(Timestamp(0)));
+  runner.MutableInputs()->Tag("OUTPUT_SIZE").packets.push_back(
+      mediapipe::MakePacket<std::pair<int, int>>(std::make_pair(8, 4))
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  std::vector<Packet> packets = GetPackets(runner);
+  ASSERT_EQ(packets.size(), 1);
+  const Image& mask = packets[0].Get<Image>();
+  EXPECT_EQ(mask.width(), 8);
+  EXPECT_EQ(mask.height(), 4);
+  for (int y = 0; y < 4; ++y) {
+    EXPECT_NEAR(GetPixel(mask, 0, y), 1.0, 1e-5);
+    EXPECT_NEAR(GetPixel(mask, 2, y), 1.0, 1e-5);
+    EXPECT_NEAR(GetPixel(mask, 5, y), 3.0, 1e-5);
+    EXPECT_NEAR(GetPixel(mask, 7, y), 3.0, 1e-5);
+  }
+  // At x = 3, the first tile is 2 pixels from its border and the second one
+  // 1 pixel, which gives the first tile twice the weight away from the top
+  // and bottom rows.
+  EXPECT_NEAR(GetPixel(mask, 3, 1), (2 * 1.0 + 3.0) / 3, 1e-5);
+  EXPECT_NEAR(GetPixel(mask, 4, 1), (1.0 + 2 * 3.0) / 3, 1e-5);
+}
+
 }  // namespace mediapipe
@@ -33,11 +33,15 @@ namespace {
 
 constexpr char kSegmentationStreamName[] = "segmented_mask_out";
 constexpr char kGroupedSegmentationTag[] = "GROUPED_SEGMENTATION";
+constexpr char kRegionSegmentationStreamName[] = "region_segmented_masks_out";
+constexpr char kRegionSegmentationTag[] = "REGION_SEGMENTATION";
 constexpr char kImageInStreamName[] = "image_in";
 constexpr char kImageOutStreamName[] = "image_out";
 constexpr char kImageTag[] = "IMAGE";
 constexpr char kNormRectStreamName[] = "norm_rect_in";
 constexpr char kNormRectTag[] = "NORM_RECT";
+constexpr char kNormRectsStreamName[] = "norm_rects_in";
+constexpr char kNormRectsTag[] = "NORM_RECTS";
 constexpr char kSubgraphTypeName[] =
     "mediapipe.tasks.vision.image_segmenter.ImageSegmenterGraph";
 constexpr int kMicroSecondsPerMilliSecond = 1000;
@@ -55,8 +59,22 @@ CalculatorGraphConfig CreateGraphConfig(
     bool enable_flow_limiting) {
   api2::builder::Graph graph;
   auto& task_subgraph = graph.AddNode(kSubgraphTypeName);
+  const bool segment_regions =
+      options->inference_mode() == ImageSegmenterGraphOptionsProto::REGIONS;
   task_subgraph.GetOptions<ImageSegmenterGraphOptionsProto>().Swap(
       options.get());
+  if (segment_regions) {
+    graph.In(kImageTag).SetName(kImageInStreamName) >>
+        task_subgraph.In(kImageTag);
+    graph.In(kNormRectsTag).SetName(kNormRectsStreamName) >>
+        task_subgraph.In(kNormRectsTag);
+    task_subgraph.Out(kRegionSegmentationTag)
+            .SetName(kRegionSegmentationStreamName) >>
+        graph.Out(kRegionSegmentationTag);
+    task_subgraph.Out(kImageTag).SetName(kImageOutStreamName) >>
+        graph.Out(kImageTag);
+    return graph.GetConfig();
+  }
   graph.In(kImageTag).SetName(kImageInStreamName);
   graph.In(kNormRectTag).SetName(kNormRectStreamName);
   task_subgraph.Out(kGroupedSegmentationTag).SetName(kSegmentationStreamName) >>
@@ -108,6 +126,20 @@ ConvertImageSegmenterOptionsToProto(ImageSegmenterOptions* options) {
           SegmenterOptions::SOFTMAX);
       break;
   }
+  switch (options->inference_mode) {
+    case ImageSegmenterOptions::InferenceMode::FULL_IMAGE:
+      options_proto->set_inference_mode(
+          ImageSegmenterGraphOptionsProto::FULL_IMAGE);
+      break;
+    case ImageSegmenterOptions::InferenceMode::REGIONS:
+      options_proto->set_inference_mode(
+          ImageSegmenterGraphOptionsProto::REGIONS);
+      break;
+    case ImageSegmenterOptions::InferenceMode::TILES:
+      options_proto->set_inference_mode(ImageSegmenterGraphOptionsProto::TILES);
+      break;
+  }
+  options_proto->set_tile_overlap(options->tile_overlap);
   return options_proto;
 }
 
@@ -115,6 +147,15 @@ ConvertImageSegmenterOptionsToProto(ImageSegmenterOptions* options) {
 
 absl::StatusOr<std::unique_ptr<ImageSegmenter>> ImageSegmenter::Create(
     std::unique_ptr<ImageSegmenterOptions> options) {
+  if (options->inference_mode ==
+          ImageSegmenterOptions::InferenceMode::REGIONS &&
+      options->running_mode != core::RunningMode::IMAGE) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "The REGIONS inference mode is only supported in the image running "
+        "mode.",
+        MediaPipeTasksStatus::kInvalidTaskGraphConfigError);
+  }
   auto options_proto = ConvertImageSegmenterOptionsToProto(options.get());
   tasks::core::PacketsCallback packets_callback = nullptr;
   if (options->result_callback) {
@@ -169,6 +210,36 @@ absl::StatusOr<std::vector<Image>> ImageSegmenter::Segment(
   return output_packets[kSegmentationStreamName].Get<std::vector<Image>>();
 }
 
+absl::StatusOr<std::vector<std::vector<Image>>> ImageSegmenter::SegmentRegions(
+    mediapipe::Image image,
+    const std::vector<core::ImageProcessingOptions>& regions) {
+  if (image.UsesGpu()) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrCat("GPU input images are currently not supported."),
+        MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+  }
+  // Nothing is segmented, nor output, for an empty batch.
+  if (regions.empty()) {
+    return std::vector<std::vector<Image>>();
+  }
+  std::vector<NormalizedRect> norm_rects;
+  norm_rects.reserve(regions.size());
+  for (const core::ImageProcessingOptions& region : regions) {
+    ASSIGN_OR_RETURN(NormalizedRect norm_rect,
+                     ConvertToNormalizedRect(region, /*roi_allowed=*/true));
+    norm_rects.push_back(std::move(norm_rect));
+  }
+  ASSIGN_OR_RETURN(
+      auto output_packets,
+      ProcessImageData(
+          {{kImageInStreamName, mediapipe::MakePacket<Image>(std::move(image))},
+           {kNormRectsStreamName, MakePacket<std::vector<NormalizedRect>>(
+                                      std::move(norm_rects))}}));
+  return output_packets[kRegionSegmentationStreamName]
+      .Get<std::vector<std::vector<Image>>>();
+}
+
 absl::StatusOr<std::vector<Image>> ImageSegmenter::SegmentForVideo(
     mediapipe::Image image, int64 timestamp_ms,
     std::optional<core::ImageProcessingOptions> image_processing_options) {
@@ -73,6 +73,25 @@ struct ImageSegmenterOptions {
 
   Activation activation = Activation::NONE;
 
+  // How the image is fed to the segmentation model.
+  enum InferenceMode {
+    // Segments the whole image, resized to the model input size.
+    FULL_IMAGE = 0,
+    // Segments the regions of interest passed to SegmentRegions() with one
+    // batched inference. Only supported in the image running mode, on CPU.
+    REGIONS = 1,
+    // Segments overlapping tiles of the model input size with one batched
+    // inference, and stitches them into full resolution masks. Only supported
+    // on CPU.
+    TILES = 2,
+  };
+
+  InferenceMode inference_mode = InferenceMode::FULL_IMAGE;
+
+  // The minimum fraction of a tile that overlaps with its neighbours in the
+  // TILES inference mode, in [0, 1).
+  float tile_overlap = 0.25;
+
   // The user-defined result callback for processing live stream data.
   // The result callback should only be specified when the running mode is set
   // to RunningMode::LIVE_STREAM.
@@ -106,6 +125,10 @@ class ImageSegmenter : tasks::vision::core::BaseVisionTaskApi {
  public:
   using BaseVisionTaskApi::BaseVisionTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates an ImageSegmenter from the provided options. A non-default
   // OpResolver can be specified in the BaseOptions of ImageSegmenterOptions,
   // to support custom Ops of the segmentation model.
@@ -133,6 +156,22 @@ class ImageSegmenter : tasks::vision::core::BaseVisionTaskApi {
       std::optional<core::ImageProcessingOptions> image_processing_options =
           std::nullopt);
 
+  // Performs image segmentation on several regions of the provided single
+  // image, with one batched inference. Only use this method when the
+  // ImageSegmenter is created with the image running mode and the REGIONS
+  // inference mode.
+  //
+  // Each of the 'regions' specifies a region-of-interest through its
+  // 'region_of_interest' field, and optionally its rotation through its
+  // 'rotation_degrees' field.
+  //
+  // Returns the segmented masks of every region, in the same order as
+  // 'regions', as described for Segment(). The masks of a region have the
+  // size of the region in the image.
+  absl::StatusOr<std::vector<std::vector<mediapipe::Image>>> SegmentRegions(
+      mediapipe::Image image,
+      const std::vector<core::ImageProcessingOptions>& regions);
+
   // Performs image segmentation on the provided video frame.
   // Only use this method when the ImageSegmenter is created with the video
   // running mode.
@@ -15,15 +15,19 @@ limitations under the License.
 
 #include <memory>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "mediapipe/calculators/image/image_clone_calculator.pb.h"
+#include "mediapipe/calculators/tensor/image_to_tensor_calculator.pb.h"
 #include "mediapipe/framework/api2/builder.h"
 #include "mediapipe/framework/api2/port.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/components/processors/image_preprocessing_graph.h"
@@ -33,6 +37,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/proto/acceleration.pb.h"
 #include "mediapipe/tasks/cc/core/proto/inference_subgraph.pb.h"
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
+#include "mediapipe/tasks/cc/vision/image_segmenter/calculators/segmentation_tiles_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/image_segmenter/calculators/tensors_to_segmentation_calculator.pb.h"
 #include "mediapipe/tasks/cc/vision/image_segmenter/proto/image_segmenter_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/image_segmenter/proto/segmenter_options.pb.h"
@@ -64,8 +69,10 @@ using LabelItems = mediapipe::proto_ns::Map<int64, ::mediapipe::LabelMapItem>;
 
 constexpr char kSegmentationTag[] = "SEGMENTATION";
 constexpr char kGroupedSegmentationTag[] = "GROUPED_SEGMENTATION";
+constexpr char kRegionSegmentationTag[] = "REGION_SEGMENTATION";
 constexpr char kImageTag[] = "IMAGE";
 constexpr char kNormRectTag[] = "NORM_RECT";
+constexpr char kNormRectsTag[] = "NORM_RECTS";
 constexpr char kTensorsTag[] = "TENSORS";
 constexpr char kOutputSizeTag[] = "OUTPUT_SIZE";
 
@@ -77,6 +84,15 @@ struct ImageSegmenterOutputs {
   Source<Image> image;
 };
 
+// Struct holding the output streams produced by the image segmenter subgraph
+// in the REGIONS inference mode.
+struct RegionSegmenterOutputs {
+  // The segmented masks of every region.
+  Source<std::vector<std::vector<Image>>> region_masks;
+  // The same as the input image.
+  Source<Image> image;
+};
+
 }  // namespace
 
 absl::Status SanityCheckOptions(const ImageSegmenterGraphOptions& options) {
@@ -86,6 +102,19 @@ absl::Status SanityCheckOptions(const ImageSegmenterGraphOptions& options) {
                                    "`output_type` must not be UNSPECIFIED",
                                    MediaPipeTasksStatus::kInvalidArgumentError);
   }
+  if (options.inference_mode() != ImageSegmenterGraphOptions::FULL_IMAGE &&
+      components::processors::DetermineImagePreprocessingGpuBackend(
+          options.base_options().acceleration())) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "The REGIONS and TILES inference modes are only supported on CPU.",
+        MediaPipeTasksStatus::kInvalidArgumentError);
+  }
+  if (options.tile_overlap() < 0 || options.tile_overlap() >= 1) {
+    return CreateStatusWithPayload(absl::StatusCode::kInvalidArgument,
+                                   "`tile_overlap` must be in [0, 1).",
+                                   MediaPipeTasksStatus::kInvalidArgumentError);
+  }
   return absl::OkStatus();
 }
 
@@ -160,20 +189,34 @@ absl::StatusOr<const Tensor*> GetOutputTensor(
 // GROUPED_SEGMENTATION.
 // - Accepts CPU input images and outputs segmented masks on CPU.
 //
+// With the REGIONS inference mode, the graph instead segments several regions
+// of the image with one batched inference, and with the TILES inference mode,
+// it segments overlapping model size tiles of the image with one batched
+// inference and stitches them into full resolution masks. Both modes require
+// CPU inference, whose input batch size follows the number of regions.
+//
 // Inputs:
 //   IMAGE - Image
 //     Image to perform segmentation on.
 //   NORM_RECT - NormalizedRect @Optional
 //     Describes image rotation and region of image to perform detection
-//     on.
+//     on. In the TILES mode, it must cover the whole image without rotation.
+//     Not used in the REGIONS mode.
 //     @Optional: rect covering the whole image is used if not specified.
+//   NORM_RECTS - std::vector<NormalizedRect>
+//     The regions of the image to segment. Only used in the REGIONS mode.
 //
 // Outputs:
 //   SEGMENTATION - mediapipe::Image @Multiple
 //     Segmented masks for individual category. Segmented mask of single
-//     category can be accessed by index based output stream.
+//     category can be accessed by index based output stream. Not produced in
+//     the REGIONS mode.
 //   GROUPED_SEGMENTATION - std::vector<mediapipe::Image>
-//     The output segmented masks grouped in a vector.
+//     The output segmented masks grouped in a vector. Not produced in the
+//     REGIONS mode.
+//   REGION_SEGMENTATION - std::vector<std::vector<mediapipe::Image>>
+//     The segmented masks of every region of NORM_RECTS, each at the size of
+//     its region in the image. Only produced in the REGIONS mode.
 //   IMAGE - mediapipe::Image
 //     The image that image segmenter runs on.
 //
@@ -204,6 +247,21 @@ class ImageSegmenterGraph : public core::ModelTaskGraph {
     ASSIGN_OR_RETURN(const auto* model_resources,
                      CreateModelResources<ImageSegmenterGraphOptions>(sc));
     Graph graph;
+    if (sc->Options<ImageSegmenterGraphOptions>().inference_mode() ==
+        ImageSegmenterGraphOptions::REGIONS) {
+      ASSIGN_OR_RETURN(
+          auto region_output_streams,
+          BuildRegionSegmentationTask(
+              sc->Options<ImageSegmenterGraphOptions>(), *model_resources,
+              graph[Input<Image>(kImageTag)],
+              graph[Input<std::vector<NormalizedRect>>(kNormRectsTag)],
+              graph));
+      region_output_streams.region_masks >>
+          graph[Output<std::vector<std::vector<Image>>>(
+              kRegionSegmentationTag)];
+      region_output_streams.image >> graph[Output<Image>(kImageTag)];
+      return graph.GetConfig();
+    }
     ASSIGN_OR_RETURN(
         auto output_streams,
         BuildSegmentationTask(
@@ -241,26 +299,6 @@ class ImageSegmenterGraph : public core::ModelTaskGraph {
       Source<NormalizedRect> norm_rect_in, Graph& graph) {
     MP_RETURN_IF_ERROR(SanityCheckOptions(task_options));
 
-    // Adds preprocessing calculators and connects them to the graph input image
-    // stream.
-    auto& preprocessing = graph.AddNode(
-        "mediapipe.tasks.components.processors.ImagePreprocessingGraph");
-    bool use_gpu =
-        components::processors::DetermineImagePreprocessingGpuBackend(
-            task_options.base_options().acceleration());
-    MP_RETURN_IF_ERROR(components::processors::ConfigureImagePreprocessingGraph(
-        model_resources, use_gpu,
-        &preprocessing.GetOptions<tasks::components::processors::proto::
-                                      ImagePreprocessingGraphOptions>()));
-    image_in >> preprocessing.In(kImageTag);
-    norm_rect_in >> preprocessing.In(kNormRectTag);
-
-    // Adds inference subgraph and connects its input stream to the output
-    // tensors produced by the ImageToTensorCalculator.
-    auto& inference = AddInference(
-        model_resources, task_options.base_options().acceleration(), graph);
-    preprocessing.Out(kTensorsTag) >> inference.In(kTensorsTag);
-
     // Adds segmentation calculators for output streams.
     auto& tensor_to_images =
         graph.AddNode("mediapipe.tasks.TensorsToSegmentationCalculator");
@@ -268,12 +306,66 @@ class ImageSegmenterGraph : public core::ModelTaskGraph {
         task_options, model_resources,
         &tensor_to_images
              .GetOptions<TensorsToSegmentationCalculatorOptions>()));
-    inference.Out(kTensorsTag) >> tensor_to_images.In(kTensorsTag);
 
     // Adds image property calculator for output size.
     auto& image_properties = graph.AddNode("ImagePropertiesCalculator");
     image_in >> image_properties.In("IMAGE");
-    image_properties.Out("SIZE") >> tensor_to_images.In(kOutputSizeTag);
+    auto image_size = image_properties[Output<std::pair<int, int>>("SIZE")];
+    image_size >> tensor_to_images.In(kOutputSizeTag);
+
+    Source<Image> image_out = image_in;
+    if (task_options.inference_mode() == ImageSegmenterGraphOptions::TILES) {
+      // Splits the image into overlapping tiles of the model input size,
+      // segments all of them with one inference, and stitches their masks.
+      tasks::components::processors::proto::ImagePreprocessingGraphOptions
+          preprocessing_options;
+      MP_RETURN_IF_ERROR(
+          components::processors::ConfigureImagePreprocessingGraph(
+              model_resources, /*use_gpu=*/false, &preprocessing_options));
+      const auto& image_to_tensor_options =
+          preprocessing_options.image_to_tensor_options();
+      auto& tiles =
+          graph.AddNode("mediapipe.tasks.SegmentationTilesCalculator");
+      auto& tiles_options =
+          tiles.GetOptions<SegmentationTilesCalculatorOptions>();
+      tiles_options.set_tile_width(
+          image_to_tensor_options.output_tensor_width());
+      tiles_options.set_tile_height(
+          image_to_tensor_options.output_tensor_height());
+      tiles_options.set_tile_overlap(task_options.tile_overlap());
+      image_size >> tiles.In("IMAGE_SIZE");
+      norm_rect_in >> tiles.In(kNormRectTag);
+      auto tile_rects =
+          tiles[Output<std::vector<NormalizedRect>>(kNormRectsTag)];
+
+      auto& inference = AddInference(
+          model_resources, task_options.base_options(), graph);
+      AddBatchedPreprocessing(preprocessing_options, image_in, tile_rects,
+                              graph) >>
+          inference.In(kTensorsTag);
+      inference.Out(kTensorsTag) >> tensor_to_images.In(kTensorsTag);
+      tile_rects >> tensor_to_images.In(kNormRectsTag);
+    } else {
+      // Adds preprocessing calculators and connects them to the graph input
+      // image stream.
+      auto& preprocessing = graph.AddNode(
+          "mediapipe.tasks.components.processors.ImagePreprocessingGraph");
+      MP_RETURN_IF_ERROR(
+          components::processors::ConfigureImagePreprocessingGraph(
+              model_resources, task_options.base_options(),
+              &preprocessing.GetOptions<tasks::components::processors::proto::
+                                            ImagePreprocessingGraphOptions>()));
+      image_in >> preprocessing.In(kImageTag);
+      norm_rect_in >> preprocessing.In(kNormRectTag);
+
+      // Adds inference subgraph and connects its input stream to the output
+      // tensors produced by the ImageToTensorCalculator.
+      auto& inference = AddInference(
+          model_resources, task_options.base_options(), graph);
+      preprocessing.Out(kTensorsTag) >> inference.In(kTensorsTag);
+      inference.Out(kTensorsTag) >> tensor_to_images.In(kTensorsTag);
+      image_out = preprocessing[Output<Image>(kImageTag)];
+    }
 
     // Exports multiple segmented masks.
     std::vector<Source<Image>> segmented_masks;
@@ -290,9 +382,72 @@ class ImageSegmenterGraph : public core::ModelTaskGraph {
             tensor_to_images[Output<Image>::Multiple(kSegmentationTag)][i]));
       }
     }
-    return ImageSegmenterOutputs{
-        /*segmented_masks=*/segmented_masks,
-        /*image=*/preprocessing[Output<Image>(kImageTag)]};
+    return ImageSegmenterOutputs{/*segmented_masks=*/segmented_masks,
+                                 /*image=*/image_out};
+  }
+
+  // Adds a pipeline segmenting several regions of the image with one batched
+  // inference into the provided builder::Graph instance. The masks of every
+  // region are output at the size of the region in the image.
+  //
+  // task_options: the mediapipe tasks ImageSegmenterGraphOptions proto.
+  // model_resources: the ModelSources object initialized from a segmentation
+  // model file with model metadata.
+  // image_in: (mediapipe::Image) stream to run segmentation on.
+  // norm_rects_in: (std::vector<NormalizedRect>) the regions to segment.
+  // graph: the mediapipe builder::Graph instance to be updated.
+  absl::StatusOr<RegionSegmenterOutputs> BuildRegionSegmentationTask(
+      const ImageSegmenterGraphOptions& task_options,
+      const core::ModelResources& model_resources, Source<Image> image_in,
+      Source<std::vector<NormalizedRect>> norm_rects_in, Graph& graph) {
+    MP_RETURN_IF_ERROR(SanityCheckOptions(task_options));
+
+    tasks::components::processors::proto::ImagePreprocessingGraphOptions
+        preprocessing_options;
+    MP_RETURN_IF_ERROR(components::processors::ConfigureImagePreprocessingGraph(
+        model_resources, /*use_gpu=*/false, &preprocessing_options));
+    auto& inference = AddInference(
+        model_resources, task_options.base_options(), graph);
+    AddBatchedPreprocessing(preprocessing_options, image_in, norm_rects_in,
+                            graph) >>
+        inference.In(kTensorsTag);
+
+    auto& tensor_to_images =
+        graph.AddNode("mediapipe.tasks.TensorsToSegmentationCalculator");
+    RET_CHECK_OK(ConfigureTensorsToSegmentationCalculator(
+        task_options, model_resources,
+        &tensor_to_images
+             .GetOptions<TensorsToSegmentationCalculatorOptions>()));
+    inference.Out(kTensorsTag) >> tensor_to_images.In(kTensorsTag);
+    norm_rects_in >> tensor_to_images.In(kNormRectsTag);
+    auto& image_properties = graph.AddNode("ImagePropertiesCalculator");
+    image_in >> image_properties.In("IMAGE");
+    image_properties.Out("SIZE") >> tensor_to_images.In(kOutputSizeTag);
+
+    return RegionSegmenterOutputs{
+        /*region_masks=*/tensor_to_images[Output<
+            std::vector<std::vector<Image>>>(kRegionSegmentationTag)],
+        /*image=*/image_in};
+  }
+
+  // Extracts the crops of `norm_rects` from the image into a single batched
+  // tensor on CPU. This is the ImagePreprocessingGraph with the rects as a
+  // batch.
+  Source<std::vector<mediapipe::Tensor>> AddBatchedPreprocessing(
+      const tasks::components::processors::proto::
+          ImagePreprocessingGraphOptions& preprocessing_options,
+      Source<Image> image_in, Source<std::vector<NormalizedRect>> norm_rects,
+      Graph& graph) {
+    auto& image_converter = graph.AddNode("ImageCloneCalculator");
+    image_converter.GetOptions<mediapipe::ImageCloneCalculatorOptions>()
+        .set_output_on_gpu(false);
+    image_in >> image_converter.In("");
+    auto& image_to_tensor = graph.AddNode("ImageToTensorCalculator");
+    image_to_tensor.GetOptions<mediapipe::ImageToTensorCalculatorOptions>()
+        .CopyFrom(preprocessing_options.image_to_tensor_options());
+    image_converter.Out("") >> image_to_tensor.In(kImageTag);
+    norm_rects >> image_to_tensor.In(kNormRectsTag);
+    return image_to_tensor[Output<std::vector<mediapipe::Tensor>>(kTensorsTag)];
   }
 };
 
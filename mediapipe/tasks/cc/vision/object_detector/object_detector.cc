@@ -30,10 +30,14 @@ limitations under the License.
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/tasks/cc/common.h"
+#include "mediapipe/tasks/cc/components/containers/classification_result.h"
 #include "mediapipe/tasks/cc/components/containers/detection_result.h"
+#include "mediapipe/tasks/cc/components/containers/proto/classifications.pb.h"
+#include "mediapipe/tasks/cc/components/processors/classifier_options.h"
 #include "mediapipe/tasks/cc/core/base_options.h"
 #include "mediapipe/tasks/cc/core/proto/base_options.pb.h"
 #include "mediapipe/tasks/cc/core/proto/inference_subgraph.pb.h"
+#include "mediapipe/tasks/cc/core/task_runner.h"
 #include "mediapipe/tasks/cc/core/utils.h"
 #include "mediapipe/tasks/cc/vision/core/image_processing_options.h"
 #include "mediapipe/tasks/cc/vision/core/running_mode.h"
@@ -46,6 +50,8 @@ namespace tasks {
 namespace vision {
 namespace {
 
+constexpr char kClassificationsOutStreamName[] = "classifications_out";
+constexpr char kClassificationsTag[] = "CLASSIFICATIONS";
 constexpr char kDetectionsOutStreamName[] = "detections_out";
 constexpr char kDetectionsTag[] = "DETECTIONS";
 constexpr char kImageInStreamName[] = "image_in";
@@ -57,7 +63,10 @@ constexpr char kSubgraphTypeName[] =
     "mediapipe.tasks.vision.ObjectDetectorGraph";
 constexpr int kMicroSecondsPerMilliSecond = 1000;
 
+using ::mediapipe::tasks::components::containers::ConvertToClassificationResult;
 using ::mediapipe::tasks::components::containers::ConvertToDetectionResult;
+using ClassificationResultProto =
+    ::mediapipe::tasks::components::containers::proto::ClassificationResult;
 using ObjectDetectorOptionsProto =
     object_detector::proto::ObjectDetectorOptions;
 
@@ -72,12 +81,18 @@ CalculatorGraphConfig CreateGraphConfig(
   graph.In(kImageTag).SetName(kImageInStreamName);
   graph.In(kNormRectTag).SetName(kNormRectName);
   auto& task_subgraph = graph.AddNode(kSubgraphTypeName);
+  const bool classify_boxes = options_proto->has_box_classifier_options();
   task_subgraph.GetOptions<ObjectDetectorOptionsProto>().Swap(
       options_proto.get());
   task_subgraph.Out(kDetectionsTag).SetName(kDetectionsOutStreamName) >>
       graph.Out(kDetectionsTag);
   task_subgraph.Out(kImageTag).SetName(kImageOutStreamName) >>
       graph.Out(kImageTag);
+  if (classify_boxes) {
+    task_subgraph.Out(kClassificationsTag)
+            .SetName(kClassificationsOutStreamName) >>
+        graph.Out(kClassificationsTag);
+  }
   if (enable_flow_limiting) {
     return tasks::core::AddFlowLimiterCalculator(
         graph, task_subgraph, {kImageTag, kNormRectTag}, kDetectionsTag);
@@ -106,9 +121,40 @@ std::unique_ptr<ObjectDetectorOptionsProto> ConvertObjectDetectorOptionsToProto(
   for (const std::string& category : options->category_denylist) {
     options_proto->add_category_denylist(category);
   }
+  if (options->box_classifier_options.has_value()) {
+    auto* box_classifier_options =
+        options_proto->mutable_box_classifier_options();
+    *box_classifier_options->mutable_base_options() =
+        tasks::core::ConvertBaseOptionsToProto(
+            &options->box_classifier_options->base_options);
+    *box_classifier_options->mutable_classifier_options() =
+        components::processors::ConvertClassifierOptionsToProto(
+            &options->box_classifier_options->classifier_options);
+  }
   return options_proto;
 }
 
+// Converts the output packets of the graph to an ObjectDetectorResult, with
+// the classifications of the boxes if a box classifier is set.
+ObjectDetectorResult ConvertToObjectDetectorResult(
+    tasks::core::PacketMap& output_packets) {
+  ObjectDetectorResult result = ConvertToDetectionResult(
+      output_packets[kDetectionsOutStreamName].Get<std::vector<Detection>>());
+  auto it = output_packets.find(kClassificationsOutStreamName);
+  // There is no packet when there are no detections.
+  if (it == output_packets.end() || it->second.IsEmpty()) {
+    return result;
+  }
+  const auto& classifications =
+      it->second.Get<std::vector<ClassificationResultProto>>();
+  for (int i = 0; i < result.detections.size() && i < classifications.size();
+       ++i) {
+    result.detections[i].classifications =
+        ConvertToClassificationResult(classifications[i]).classifications;
+  }
+  return result;
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<ObjectDetector>> ObjectDetector::Create(
@@ -131,8 +177,7 @@ absl::StatusOr<std::unique_ptr<ObjectDetector>> ObjectDetector::Create(
           Packet detections_packet =
               status_or_packets.value()[kDetectionsOutStreamName];
           Packet image_packet = status_or_packets.value()[kImageOutStreamName];
-          result_callback(ConvertToDetectionResult(
-                              detections_packet.Get<std::vector<Detection>>()),
+          result_callback(ConvertToObjectDetectorResult(*status_or_packets),
                           image_packet.Get<Image>(),
                           detections_packet.Timestamp().Value() /
                               kMicroSecondsPerMilliSecond);
@@ -164,8 +209,36 @@ absl::StatusOr<ObjectDetectorResult> ObjectDetector::Detect(
       ProcessImageData(
           {{kImageInStreamName, MakePacket<Image>(std::move(image))},
            {kNormRectName, MakePacket<NormalizedRect>(std::move(norm_rect))}}));
-  return ConvertToDetectionResult(
-      output_packets[kDetectionsOutStreamName].Get<std::vector<Detection>>());
+  return ConvertToObjectDetectorResult(output_packets);
+}
+
+absl::StatusOr<std::vector<ObjectDetectorResult>>
+ObjectDetector::DetectBatch(
+    std::vector<Image> images,
+    std::optional<core::ImageProcessingOptions> image_processing_options) {
+  ASSIGN_OR_RETURN(
+      NormalizedRect norm_rect,
+      ConvertToNormalizedRect(image_processing_options, /*roi_allowed=*/false));
+  std::vector<tasks::core::PacketMap> inputs;
+  inputs.reserve(images.size());
+  for (Image& image : images) {
+    if (image.UsesGpu()) {
+      return CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          "GPU input images are currently not supported.",
+          MediaPipeTasksStatus::kRunnerUnexpectedInputError);
+    }
+    inputs.push_back(
+        {{kImageInStreamName, MakePacket<Image>(std::move(image))},
+         {kNormRectName, MakePacket<NormalizedRect>(norm_rect)}});
+  }
+  ASSIGN_OR_RETURN(auto outputs, ProcessImageDataBatch(std::move(inputs)));
+  std::vector<ObjectDetectorResult> results;
+  results.reserve(outputs.size());
+  for (auto& output_packets : outputs) {
+    results.push_back(ConvertToObjectDetectorResult(output_packets));
+  }
+  return results;
 }
 
 absl::StatusOr<ObjectDetectorResult> ObjectDetector::DetectForVideo(
@@ -189,8 +262,7 @@ absl::StatusOr<ObjectDetectorResult> ObjectDetector::DetectForVideo(
            {kNormRectName,
             MakePacket<NormalizedRect>(std::move(norm_rect))
                 .At(Timestamp(timestamp_ms * kMicroSecondsPerMilliSecond))}}));
-  return ConvertToDetectionResult(
-      output_packets[kDetectionsOutStreamName].Get<std::vector<Detection>>());
+  return ConvertToObjectDetectorResult(output_packets);
 }
 
 absl::Status ObjectDetector::DetectAsync(
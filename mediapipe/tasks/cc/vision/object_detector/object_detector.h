@@ -28,6 +28,7 @@ limitations under the License.
 #include "mediapipe/framework/formats/detection.pb.h"
 #include "mediapipe/framework/formats/image.h"
 #include "mediapipe/tasks/cc/components/containers/detection_result.h"
+#include "mediapipe/tasks/cc/components/processors/classifier_options.h"
 #include "mediapipe/tasks/cc/core/base_options.h"
 #include "mediapipe/tasks/cc/vision/core/base_vision_task_api.h"
 #include "mediapipe/tasks/cc/vision/core/image_processing_options.h"
@@ -81,6 +82,24 @@ struct ObjectDetectorOptions {
   // category names are ignored. Mutually exclusive with category_allowlist.
   std::vector<std::string> category_denylist = {};
 
+  // The options of a second-stage image classifier run on the bounding boxes of
+  // the detections.
+  struct BoxClassifierOptions {
+    // The image classification model. Only the model asset and the CPU
+    // acceleration settings are used: the crops of all the boxes of an image
+    // are classified with one batched inference, which is only supported on
+    // CPU. The op resolver of the detector is used for both models.
+    tasks::core::BaseOptions base_options;
+
+    // Options for configuring the classifier behavior, such as score threshold,
+    // number of results, etc.
+    components::processors::ClassifierOptions classifier_options;
+  };
+
+  // If set, every detection is classified by this classifier, and its results
+  // are returned in the `classifications` field of the detection.
+  std::optional<BoxClassifierOptions> box_classifier_options;
+
   // The user-defined result callback for processing live stream data.
   // The result callback should only be specified when the running mode is set
   // to RunningMode::LIVE_STREAM.
@@ -134,6 +153,10 @@ class ObjectDetector : tasks::vision::core::BaseVisionTaskApi {
  public:
   using BaseVisionTaskApi::BaseVisionTaskApi;
 
+  // Returns the runtime profiles of the calculators of the task graph, which
+  // requires `base_options.enable_profiler`.
+  using BaseTaskApi::GetCalculatorProfiles;
+
   // Creates an ObjectDetector from an ObjectDetectorOptions to process image
   // data or streaming data. Object detector can be created with one of the
   // following three running modes:
@@ -174,6 +197,20 @@ class ObjectDetector : tasks::vision::core::BaseVisionTaskApi {
       std::optional<core::ImageProcessingOptions> image_processing_options =
           std::nullopt);
 
+  // Performs object detection on a batch of images, e.g. for offline
+  // processing, and returns the results in the order of the images. Unlike
+  // calling Detect() for each image, the images are pipelined through the
+  // graph, so that the preprocessing of an image runs in parallel with the
+  // inference on the previous one. The same 'image_processing_options' apply to
+  // all the images.
+  //
+  // Only use this method when the ObjectDetector is created with the image
+  // running mode.
+  absl::StatusOr<std::vector<ObjectDetectorResult>> DetectBatch(
+      std::vector<mediapipe::Image> images,
+      std::optional<core::ImageProcessingOptions> image_processing_options =
+          std::nullopt);
+
   // Performs object detection on the provided video frame.
   // Only use this method when the ObjectDetector is created with the video
   // running mode.
@@ -33,6 +33,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/common.h"
 #include "mediapipe/tasks/cc/components/calculators/score_calibration_calculator.pb.h"
 #include "mediapipe/tasks/cc/components/calculators/score_calibration_utils.h"
+#include "mediapipe/tasks/cc/components/containers/proto/classifications.pb.h"
 #include "mediapipe/tasks/cc/components/processors/image_preprocessing_graph.h"
 #include "mediapipe/tasks/cc/components/utils/source_or_node_output.h"
 #include "mediapipe/tasks/cc/core/model_resources.h"
@@ -41,6 +42,7 @@ limitations under the License.
 #include "mediapipe/tasks/cc/core/proto/inference_subgraph.pb.h"
 #include "mediapipe/tasks/cc/core/utils.h"
 #include "mediapipe/tasks/cc/metadata/metadata_extractor.h"
+#include "mediapipe/tasks/cc/vision/image_classifier/proto/image_classifier_graph_options.pb.h"
 #include "mediapipe/tasks/cc/vision/object_detector/proto/object_detector_options.pb.h"
 #include "mediapipe/tasks/metadata/metadata_schema_generated.h"
 #include "mediapipe/util/label_map.pb.h"
@@ -56,6 +58,7 @@ using ::mediapipe::api2::Input;
 using ::mediapipe::api2::Output;
 using ::mediapipe::api2::builder::Graph;
 using ::mediapipe::api2::builder::Source;
+using ::mediapipe::tasks::components::containers::proto::ClassificationResult;
 using ::mediapipe::tasks::metadata::ModelMetadataExtractor;
 using ::tflite::BoundingBoxProperties;
 using ::tflite::ContentProperties;
@@ -83,6 +86,7 @@ constexpr char kScoreTensorName[] = "score";
 constexpr char kNumberOfDetectionsTensorName[] = "number of detections";
 
 constexpr char kCalibratedScoresTag[] = "CALIBRATED_SCORES";
+constexpr char kClassificationsTag[] = "CLASSIFICATIONS";
 constexpr char kDetectionsTag[] = "DETECTIONS";
 constexpr char kImageSizeTag[] = "IMAGE_SIZE";
 constexpr char kImageTag[] = "IMAGE";
@@ -99,6 +103,8 @@ constexpr char kTensorTag[] = "TENSORS";
 struct ObjectDetectionOutputStreams {
   Source<std::vector<Detection>> detections;
   Source<Image> image;
+  // The classifications of the detections, if a box classifier is set.
+  std::optional<Source<std::vector<ClassificationResult>>> classifications;
 };
 
 // Parameters used for configuring the post-processing calculators.
@@ -469,6 +475,10 @@ void ConfigureTensorsToDetectionsCalculator(
 //     Detected objects with bounding box in pixel units.
 //   IMAGE - mediapipe::Image
 //     The image that object detection runs on.
+//   CLASSIFICATIONS - std::vector<ClassificationResult> @Optional
+//     The classification result of the bounding box of every detection, in the
+//     order of DETECTIONS. Requires `box_classifier_options`, and no packet is
+//     output when there are no detections.
 // All returned coordinates are in the unrotated and uncropped input image
 // coordinates system.
 //
@@ -509,6 +519,11 @@ class ObjectDetectorGraph : public core::ModelTaskGraph {
     output_streams.detections >>
         graph[Output<std::vector<Detection>>(kDetectionsTag)];
     output_streams.image >> graph[Output<Image>(kImageTag)];
+    if (output_streams.classifications.has_value()) {
+      *output_streams.classifications >>
+          graph[Output<std::vector<ClassificationResult>>(
+              kClassificationsTag)];
+    }
     return graph.GetConfig();
   }
 
@@ -562,11 +577,8 @@ class ObjectDetectorGraph : public core::ModelTaskGraph {
     // stream.
     auto& preprocessing = graph.AddNode(
         "mediapipe.tasks.components.processors.ImagePreprocessingGraph");
-    bool use_gpu =
-        components::processors::DetermineImagePreprocessingGpuBackend(
-            task_options.base_options().acceleration());
     MP_RETURN_IF_ERROR(components::processors::ConfigureImagePreprocessingGraph(
-        model_resources, use_gpu,
+        model_resources, task_options.base_options(),
         &preprocessing.GetOptions<tasks::components::processors::proto::
                                       ImagePreprocessingGraphOptions>()));
     image_in >> preprocessing.In(kImageTag);
@@ -575,7 +587,7 @@ class ObjectDetectorGraph : public core::ModelTaskGraph {
     // Adds inference subgraph and connects its input stream to the output
     // tensors produced by the ImageToTensorCalculator.
     auto& inference = AddInference(
-        model_resources, task_options.base_options().acceleration(), graph);
+        model_resources, task_options.base_options(), graph);
     preprocessing.Out(kTensorTag) >> inference.In(kTensorTag);
 
     // Adds post processing calculators.
@@ -667,12 +679,33 @@ class ObjectDetectorGraph : public core::ModelTaskGraph {
         graph.AddNode("DetectionsDeduplicateCalculator");
     detection_label_id_to_text.Out("") >> detections_deduplicate.In("");
 
+    auto detections =
+        detections_deduplicate[Output<std::vector<Detection>>("")];
+
+    // Classifies the bounding boxes of the detections, if specified.
+    std::optional<Source<std::vector<ClassificationResult>>> classifications;
+    if (task_options.has_box_classifier_options()) {
+      auto& box_classifier = graph.AddNode(
+          "mediapipe.tasks.vision.image_classifier.DetectionsClassifierGraph");
+      auto& box_classifier_options =
+          box_classifier.GetOptions<
+              image_classifier::proto::ImageClassifierGraphOptions>();
+      box_classifier_options.CopyFrom(task_options.box_classifier_options());
+      box_classifier_options.mutable_base_options()->set_use_stream_mode(
+          task_options.base_options().use_stream_mode());
+      image_in >> box_classifier.In(kImageTag);
+      detections >> box_classifier.In(kDetectionsTag);
+      classifications =
+          box_classifier[Output<std::vector<ClassificationResult>>(
+              kClassificationsTag)];
+    }
+
     // Outputs the labeled detections and the processed image as the subgraph
     // output streams.
     return {{
-        /* detections= */
-        detections_deduplicate[Output<std::vector<Detection>>("")],
+        /* detections= */ detections,
         /* image= */ preprocessing[Output<Image>(kImageTag)],
+        /* classifications= */ classifications,
     }};
   }
 };
@@ -84,6 +84,7 @@ constexpr char kMobileSsdWithDummyScoreCalibration[] =
 // The model has different output tensor order.
 constexpr char kEfficientDetWithMetadata[] =
     "coco_efficientdet_lite0_v1_1.0_quant_2021_09_06.tflite";
+constexpr char kMobileNetFloatWithMetadata[] = "mobilenet_v2_1.0_224.tflite";
 
 // Checks that the two provided `Detection` proto vectors are equal, with a
 // tolerancy on floating-point scores to account for numerical instabilities.
@@ -500,6 +501,34 @@ TEST_F(ImageModeTest, SucceedsWithMaxResultsOption) {
                    {full_expected_results[0], full_expected_results[1]}));
 }
 
+TEST_F(ImageModeTest, SucceedsWithBoxClassifier) {
+  MP_ASSERT_OK_AND_ASSIGN(Image image, DecodeImageFromFile(JoinPath(
+                                           "./", kTestDataDirectory,
+                                           "cats_and_dogs_no_resizing.jpg")));
+  auto options = std::make_unique<ObjectDetectorOptions>();
+  options->max_results = 2;
+  options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kMobileSsdWithMetadata);
+  options->box_classifier_options.emplace();
+  options->box_classifier_options->base_options.model_asset_path =
+      JoinPath("./", kTestDataDirectory, kMobileNetFloatWithMetadata);
+  options->box_classifier_options->classifier_options.max_results = 1;
+  MP_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectDetector> object_detector,
+                          ObjectDetector::Create(std::move(options)));
+  MP_ASSERT_OK_AND_ASSIGN(auto results, object_detector->Detect(image));
+  MP_ASSERT_OK(object_detector->Close());
+  // The boxes are the same as without the classifier.
+  std::vector<DetectionProto> full_expected_results =
+      GenerateMobileSsdNoImageResizingFullExpectedResults();
+  ExpectApproximatelyEqual(
+      results, ConvertToDetectionResult(
+                   {full_expected_results[0], full_expected_results[1]}));
+  for (const Detection& detection : results.detections) {
+    ASSERT_EQ(detection.classifications.size(), 1);
+    EXPECT_EQ(detection.classifications[0].categories.size(), 1);
+  }
+}
+
 TEST_F(ImageModeTest, SucceedsWithAllowlistOption) {
   MP_ASSERT_OK_AND_ASSIGN(Image image, DecodeImageFromFile(JoinPath(
                                            "./", kTestDataDirectory,
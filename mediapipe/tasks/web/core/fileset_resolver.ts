@@ -43,9 +43,27 @@ async function isSimdSupported(): Promise<boolean> {
   return supportsSimd;
 }
 
+/**
+ * Returns whether the Wasm module can run threads, which requires a
+ * SharedArrayBuffer and thus a cross-origin isolated page.
+ */
+function isThreadingSupported(): boolean {
+  return typeof SharedArrayBuffer !== 'undefined' &&
+      (self as {crossOriginIsolated?: boolean}).crossOriginIsolated === true;
+}
+
 async function createFileset(
-    taskName: string, basePath: string = '.'): Promise<WasmFileset> {
-  if (await isSimdSupported()) {
+    taskName: string, basePath: string = '.',
+    useThreads = false): Promise<WasmFileset> {
+  const simd = await isSimdSupported();
+  if (useThreads && simd && isThreadingSupported()) {
+    return {
+      wasmLoaderPath:
+          `${basePath}/${taskName}_wasm_threads_internal.js`,
+      wasmBinaryPath:
+          `${basePath}/${taskName}_wasm_threads_internal.wasm`,
+    };
+  } else if (simd) {
     return {
       wasmLoaderPath:
           `${basePath}/${taskName}_wasm_internal.js`,
@@ -87,6 +105,17 @@ export class FilesetResolver {
     return isSimdSupported();
   }
 
+  /**
+   * Returns whether the current environment can run the multithreaded Wasm
+   * files. This requires SIMD support, and a cross-origin isolated page (see
+   * `crossOriginIsolated`) so that threads can share memory.
+   *
+   * @return Whether the threaded Wasm files can be used.
+   */
+  static async isThreadingSupported(): Promise<boolean> {
+    return isThreadingSupported() && await isSimdSupported();
+  }
+
   /**
    * Creates a fileset for the MediaPipe Audio tasks.
    *
@@ -119,11 +148,15 @@ export class FilesetResolver {
    * @param basePath An optional base path to specify the directory the Wasm
    *    files should be loaded from. If not specified, the Wasm files are
    *    loaded from the host's root directory.
+   * @param useThreads Whether to load the SIMD and pthreads build, which runs
+   *    the graph's calculators on a thread pool, if the environment supports
+   *    it. Falls back to the single-threaded files otherwise.
    * @return A `WasmFileset` that can be used to initialize MediaPipe Vision
    *    tasks.
    */
-  static forVisionTasks(basePath?: string): Promise<WasmFileset> {
-    return createFileset('vision', basePath);
+  static forVisionTasks(basePath?: string, useThreads?: boolean):
+      Promise<WasmFileset> {
+    return createFileset('vision', basePath, useThreads);
   }
 }
 
@@ -18,7 +18,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <vector>
 
+#include "absl/synchronization/blocking_counter.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/vector.h"
 #include "mediapipe/util/color.pb.h"
@@ -37,12 +39,100 @@ using Oval = RenderAnnotation::Oval;
 using Rectangle = RenderAnnotation::Rectangle;
 using RoundedRectangle = RenderAnnotation::RoundedRectangle;
 using Text = RenderAnnotation::Text;
+using annotation_renderer_internal::Canvas;
+using annotation_renderer_internal::RowSpan;
+
+// The minimum number of rows of a band drawn by a thread.
+constexpr int kMinBandRows = 64;
 
 int ClampThickness(int thickness) {
   constexpr int kMaxThickness = 32767;  // OpenCV MAX_THICKNESS
   return std::clamp(thickness, 1, kMaxThickness);
 }
 
+// Adds the rows [first, last] of a measuring canvas to the rows it touches.
+void AddRows(const Canvas& canvas, int first, int last) {
+  canvas.rows->first = std::min(canvas.rows->first, canvas.top + first);
+  canvas.rows->last = std::max(canvas.rows->last, canvas.top + last);
+}
+
+// The functions below draw on the canvas like their OpenCV counterparts, or
+// add a bound of the rows they would touch to a measuring canvas.
+
+void CanvasLine(const Canvas& canvas, cv::Point start, cv::Point end,
+                const cv::Scalar& color, int thickness, int line_type = 8) {
+  if (canvas.rows) {
+    AddRows(canvas, std::min(start.y, end.y) - thickness - 1,
+            std::max(start.y, end.y) + thickness + 1);
+    return;
+  }
+  cv::line(canvas.image, start, end, color, thickness, line_type);
+}
+
+void CanvasRectangle(const Canvas& canvas, const cv::Rect& rect,
+                     const cv::Scalar& color, int thickness,
+                     int line_type = 8) {
+  if (canvas.rows) {
+    const int margin = std::max(thickness, 0) + 1;
+    AddRows(canvas, std::min(rect.y, rect.y + rect.height) - margin,
+            std::max(rect.y, rect.y + rect.height) + margin);
+    return;
+  }
+  cv::rectangle(canvas.image, rect, color, thickness, line_type);
+}
+
+void CanvasFillConvexPoly(const Canvas& canvas, const cv::Point* points,
+                          int num_points, const cv::Scalar& color) {
+  if (canvas.rows) {
+    for (int i = 0; i < num_points; ++i) {
+      AddRows(canvas, points[i].y - 1, points[i].y + 1);
+    }
+    return;
+  }
+  cv::fillConvexPoly(canvas.image, points, num_points, color);
+}
+
+void CanvasEllipse(const Canvas& canvas, cv::Point center, cv::Size axes,
+                   double angle, double start_angle, double end_angle,
+                   const cv::Scalar& color, int thickness, int line_type = 8) {
+  if (canvas.rows) {
+    const int radius = std::max(std::abs(axes.width), std::abs(axes.height)) +
+                       std::max(thickness, 0) + 1;
+    AddRows(canvas, center.y - radius, center.y + radius);
+    return;
+  }
+  cv::ellipse(canvas.image, center, axes, angle, start_angle, end_angle,
+              color, thickness, line_type);
+}
+
+void CanvasCircle(const Canvas& canvas, cv::Point center, int radius,
+                  const cv::Scalar& color, int thickness) {
+  if (canvas.rows) {
+    const int margin = radius + std::max(thickness, 0) + 1;
+    AddRows(canvas, center.y - margin, center.y + margin);
+    return;
+  }
+  cv::circle(canvas.image, center, radius, color, thickness);
+}
+
+void CanvasPutText(const Canvas& canvas, const std::string& text,
+                   cv::Point origin, int font_face, double font_scale,
+                   const cv::Scalar& color, int thickness,
+                   bool bottom_left_origin) {
+  if (canvas.rows) {
+    // Glyphs such as brackets reach beyond the cap and base lines, so the
+    // bound is twice the text size on either side of the origin.
+    int baseline = 0;
+    const cv::Size size =
+        cv::getTextSize(text, font_face, font_scale, thickness, &baseline);
+    const int margin = 2 * (size.height + baseline) + thickness + 1;
+    AddRows(canvas, origin.y - margin, origin.y + margin);
+    return;
+  }
+  cv::putText(canvas.image, text, origin, font_face, font_scale, color,
+              thickness, /*lineType=*/8, bottom_left_origin);
+}
+
 bool NormalizedtoPixelCoordinates(double normalized_x, double normalized_y,
                                   int image_width, int image_height, int* x_px,
                                   int* y_px) {
@@ -66,6 +156,10 @@ cv::Scalar MediapipeColorToOpenCVColor(const Color& color) {
   return cv::Scalar(color.r(), color.g(), color.b());
 }
 
+cv::Scalar RgbToOpenCVColor(const RenderCommands::Rgb& color) {
+  return cv::Scalar(color.r, color.g, color.b);
+}
+
 cv::RotatedRect RectangleToOpenCVRotatedRect(int left, int top, int right,
                                              int bottom, double rotation) {
   return cv::RotatedRect(
@@ -73,49 +167,240 @@ cv::RotatedRect RectangleToOpenCVRotatedRect(int left, int top, int right,
       cv::Size2f(right - left, bottom - top), rotation / M_PI * 180.f);
 }
 
-void cv_line2(cv::Mat& img, const cv::Point& start, const cv::Point& end,
-              const cv::Scalar& color1, const cv::Scalar& color2,
-              int thickness) {
-  cv::LineIterator iter(img, start, end, /*cv::LINE_4=*/4);
+void DrawRectangleOutline(const Canvas& canvas, int left, int top, int right,
+                          int bottom, double rotation, const cv::Scalar& color,
+                          int thickness) {
+  if (rotation != 0.0) {
+    const auto& rect =
+        RectangleToOpenCVRotatedRect(left, top, right, bottom, rotation);
+    const int kNumVertices = 4;
+    cv::Point2f vertices[kNumVertices];
+    rect.points(vertices);
+    for (int i = 0; i < kNumVertices; i++) {
+      CanvasLine(canvas, vertices[i], vertices[(i + 1) % kNumVertices], color,
+                 thickness);
+    }
+  } else {
+    cv::Rect rect(left, top, right - left, bottom - top);
+    CanvasRectangle(canvas, rect, color, thickness);
+  }
+}
+
+void FillRectangle(const Canvas& canvas, int left, int top, int right,
+                   int bottom, double rotation, const cv::Scalar& color) {
+  if (rotation != 0.0) {
+    const auto& rect =
+        RectangleToOpenCVRotatedRect(left, top, right, bottom, rotation);
+    const int kNumVertices = 4;
+    cv::Point2f vertices2f[kNumVertices];
+    rect.points(vertices2f);
+    // Convert cv::Point2f[] to cv::Point[].
+    cv::Point vertices[kNumVertices];
+    for (int i = 0; i < kNumVertices; ++i) {
+      vertices[i] = vertices2f[i];
+    }
+    CanvasFillConvexPoly(canvas, vertices, kNumVertices, color);
+  } else {
+    cv::Rect rect(left, top, right - left, bottom - top);
+    CanvasRectangle(canvas, rect, color, -1);
+  }
+}
+
+void cv_line2(const Canvas& canvas, const cv::Point& start,
+              const cv::Point& end, const cv::Scalar& color1,
+              const cv::Scalar& color2, int thickness) {
+  if (canvas.rows) {
+    AddRows(canvas, std::min(start.y, end.y) - 1,
+            std::max(start.y, end.y) + thickness + 1);
+    return;
+  }
+  cv::LineIterator iter(canvas.image, start, end, /*cv::LINE_4=*/4);
   for (int i = 0; i < iter.count; i++, iter++) {
     const double alpha = static_cast<double>(i) / iter.count;
     const cv::Scalar new_color(color1 * (1.0 - alpha) + color2 * alpha);
     const cv::Rect rect(iter.pos(), cv::Size(thickness, thickness));
-    cv::rectangle(img, rect, new_color, /*cv::FILLED=*/-1, /*cv::LINE_4=*/4);
+    cv::rectangle(canvas.image, rect, new_color, /*cv::FILLED=*/-1,
+                  /*cv::LINE_4=*/4);
   }
 }
 
 }  // namespace
 
 void AnnotationRenderer::RenderDataOnImage(const RenderData& render_data) {
-  for (const auto& annotation : render_data.render_annotations()) {
-    if (annotation.data_case() == RenderAnnotation::kRectangle) {
-      DrawRectangle(annotation);
-    } else if (annotation.data_case() == RenderAnnotation::kRoundedRectangle) {
-      DrawRoundedRectangle(annotation);
-    } else if (annotation.data_case() == RenderAnnotation::kFilledRectangle) {
-      DrawFilledRectangle(annotation);
-    } else if (annotation.data_case() ==
-               RenderAnnotation::kFilledRoundedRectangle) {
-      DrawFilledRoundedRectangle(annotation);
-    } else if (annotation.data_case() == RenderAnnotation::kOval) {
-      DrawOval(annotation);
-    } else if (annotation.data_case() == RenderAnnotation::kFilledOval) {
-      DrawFilledOval(annotation);
-    } else if (annotation.data_case() == RenderAnnotation::kText) {
-      DrawText(annotation);
-    } else if (annotation.data_case() == RenderAnnotation::kPoint) {
-      DrawPoint(annotation);
-    } else if (annotation.data_case() == RenderAnnotation::kLine) {
-      DrawLine(annotation);
-    } else if (annotation.data_case() == RenderAnnotation::kGradientLine) {
-      DrawGradientLine(annotation);
-    } else if (annotation.data_case() == RenderAnnotation::kArrow) {
-      DrawArrow(annotation);
-    } else {
-      LOG(FATAL) << "Unknown annotation type: " << annotation.data_case();
+  RenderOnCanvases(render_data.render_annotations_size(),
+                   [this, &render_data](int i, const Canvas& canvas) {
+                     DrawAnnotation(render_data.render_annotations(i), canvas);
+                   });
+}
+
+void AnnotationRenderer::RenderCommandsOnImage(const RenderCommands& commands) {
+  RenderOnCanvases(static_cast<int>(commands.size()),
+                   [this, &commands](int i, const Canvas& canvas) {
+                     DrawCommand(commands, commands.commands()[i], canvas);
+                   });
+}
+
+void AnnotationRenderer::RenderOnCanvases(
+    int size, absl::FunctionRef<void(int, const Canvas&)> render) {
+  const Canvas image_canvas = {mat_image_, 0};
+  int num_bands = 1;
+  if (thread_pool_ && size > 0) {
+    num_bands =
+        std::min(thread_pool_->num_threads(), mat_image_.rows / kMinBandRows);
+  }
+  if (num_bands <= 1) {
+    for (int i = 0; i < size; ++i) render(i, image_canvas);
+    return;
+  }
+
+  // OpenCV rasterizes a shape clipped by the image edge differently than the
+  // unclipped shape, so a shape is only drawn in a band if it lies within it.
+  std::vector<int> band_tops(num_bands + 1);
+  for (int band = 0; band <= num_bands; ++band) {
+    band_tops[band] = mat_image_.rows * band / num_bands;
+  }
+  const auto band_of = [&band_tops](int row) {
+    return static_cast<int>(
+        std::upper_bound(band_tops.begin(), band_tops.end(), row) -
+        band_tops.begin() - 1);
+  };
+  // The band of each annotation, or -1 to draw it on the whole image.
+  std::vector<int> bands(size, -1);
+  for (int i = 0; i < size; ++i) {
+    RowSpan rows;
+    render(i, {cv::Mat(), 0, &rows});
+    if (rows.first >= 0 && rows.last < mat_image_.rows &&
+        rows.first <= rows.last && band_of(rows.first) == band_of(rows.last)) {
+      bands[i] = band_of(rows.first);
     }
   }
+
+  for (int begin = 0; begin < size;) {
+    if (bands[begin] < 0) {
+      render(begin++, image_canvas);
+      continue;
+    }
+    int end = begin;
+    while (end < size && bands[end] >= 0) ++end;
+    // Annotations in different bands touch different rows, so every thread
+    // draws the annotations of its band in order.
+    absl::BlockingCounter counter(num_bands);
+    for (int band = 0; band < num_bands; ++band) {
+      thread_pool_->Schedule(
+          [this, render, &bands, &band_tops, &counter, band, begin, end] {
+            const int top = band_tops[band];
+            const Canvas canvas = {
+                mat_image_.rowRange(top, band_tops[band + 1]), top};
+            for (int i = begin; i < end; ++i) {
+              if (bands[i] == band) render(i, canvas);
+            }
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    begin = end;
+  }
+}
+
+void AnnotationRenderer::DrawAnnotation(const RenderAnnotation& annotation,
+                                        const Canvas& canvas) {
+  if (annotation.data_case() == RenderAnnotation::kRectangle) {
+    DrawRectangle(annotation, canvas);
+  } else if (annotation.data_case() == RenderAnnotation::kRoundedRectangle) {
+    DrawRoundedRectangle(annotation, canvas);
+  } else if (annotation.data_case() == RenderAnnotation::kFilledRectangle) {
+    DrawFilledRectangle(annotation, canvas);
+  } else if (annotation.data_case() ==
+             RenderAnnotation::kFilledRoundedRectangle) {
+    DrawFilledRoundedRectangle(annotation, canvas);
+  } else if (annotation.data_case() == RenderAnnotation::kOval) {
+    DrawOval(annotation, canvas);
+  } else if (annotation.data_case() == RenderAnnotation::kFilledOval) {
+    DrawFilledOval(annotation, canvas);
+  } else if (annotation.data_case() == RenderAnnotation::kText) {
+    DrawText(annotation, canvas);
+  } else if (annotation.data_case() == RenderAnnotation::kPoint) {
+    DrawPoint(annotation, canvas);
+  } else if (annotation.data_case() == RenderAnnotation::kLine) {
+    DrawLine(annotation, canvas);
+  } else if (annotation.data_case() == RenderAnnotation::kGradientLine) {
+    DrawGradientLine(annotation, canvas);
+  } else if (annotation.data_case() == RenderAnnotation::kArrow) {
+    DrawArrow(annotation, canvas);
+  } else {
+    LOG(FATAL) << "Unknown annotation type: " << annotation.data_case();
+  }
+}
+
+void AnnotationRenderer::DrawCommand(const RenderCommands& commands,
+                                     const RenderCommands::Command& command,
+                                     const Canvas& canvas) {
+  using Shape = RenderCommands::Shape;
+  const cv::Point offset(0, canvas.top);
+  const RenderCommands::Style& style = commands.style(command);
+  const cv::Point start = ToPixels(command.x0, command.y0, style.normalized);
+  const cv::Point end = ToPixels(command.x1, command.y1, style.normalized);
+  const cv::Scalar color = RgbToOpenCVColor(style.color);
+  const int thickness = ClampThickness(round(style.thickness * scale_factor_));
+  switch (command.shape) {
+    case Shape::kPoint:
+      CanvasCircle(canvas, start - offset, thickness, color, -1);
+      break;
+    case Shape::kLine:
+      CanvasLine(canvas, start - offset, end - offset, color, thickness);
+      break;
+    case Shape::kGradientLine:
+      cv_line2(canvas, start - offset, end - offset, color,
+               RgbToOpenCVColor(style.color2), thickness);
+      break;
+    case Shape::kRectangle:
+      DrawRectangleOutline(canvas, start.x, start.y - canvas.top, end.x,
+                           end.y - canvas.top, command.rotation, color,
+                           thickness);
+      break;
+    case Shape::kFilledRectangle:
+      FillRectangle(canvas, start.x, start.y - canvas.top, end.x,
+                    end.y - canvas.top, command.rotation, color);
+      break;
+    case Shape::kOval:
+    case Shape::kFilledOval: {
+      const bool filled = command.shape == Shape::kFilledOval;
+      const cv::Point center((start.x + end.x) / 2,
+                             (start.y + end.y) / 2 - canvas.top);
+      cv::Size size((end.x - start.x) / 2, (end.y - start.y) / 2);
+      if (filled) {
+        size = cv::Size(std::max(0, size.width), std::max(0, size.height));
+      }
+      CanvasEllipse(canvas, center, size, command.rotation / M_PI * 180.f, 0,
+                    360, color, filled ? -1 : thickness);
+      break;
+    }
+    case Shape::kText: {
+      const RenderCommands::Text& text = commands.texts()[command.text];
+      const int font_size =
+          style.normalized
+              ? static_cast<int>(round(text.font_height * image_height_))
+              : static_cast<int>(text.font_height * scale_factor_);
+      DrawText(text.display_text, start - offset, font_size, text.font_face,
+               text.center_horizontally, text.center_vertically, color,
+               style.thickness, text.outline_thickness,
+               RgbToOpenCVColor(text.outline_color), canvas);
+      break;
+    }
+  }
+}
+
+cv::Point AnnotationRenderer::ToPixels(double x, double y,
+                                       bool normalized) const {
+  cv::Point point;
+  if (normalized) {
+    CHECK(NormalizedtoPixelCoordinates(x, y, image_width_, image_height_,
+                                       &point.x, &point.y));
+  } else {
+    point.x = static_cast<int>(x * scale_factor_);
+    point.y = static_cast<int>(y * scale_factor_);
+  }
+  return point;
 }
 
 void AnnotationRenderer::AdoptImage(cv::Mat* input_image) {
@@ -133,11 +418,16 @@ void AnnotationRenderer::SetFlipTextVertically(bool flip) {
   flip_text_vertically_ = flip;
 }
 
+void AnnotationRenderer::SetThreadPool(ThreadPool* thread_pool) {
+  thread_pool_ = thread_pool;
+}
+
 void AnnotationRenderer::SetScaleFactor(float scale_factor) {
   if (scale_factor > 0.0f) scale_factor_ = std::min(scale_factor, 1.0f);
 }
 
-void AnnotationRenderer::DrawRectangle(const RenderAnnotation& annotation) {
+void AnnotationRenderer::DrawRectangle(const RenderAnnotation& annotation,
+                                       const Canvas& canvas) {
   int left = -1;
   int top = -1;
   int right = -1;
@@ -156,24 +446,14 @@ void AnnotationRenderer::DrawRectangle(const RenderAnnotation& annotation) {
     right = static_cast<int>(rectangle.right() * scale_factor_);
     bottom = static_cast<int>(rectangle.bottom() * scale_factor_);
   }
+  top -= canvas.top;
+  bottom -= canvas.top;
 
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
-  if (rectangle.rotation() != 0.0) {
-    const auto& rect = RectangleToOpenCVRotatedRect(left, top, right, bottom,
-                                                    rectangle.rotation());
-    const int kNumVertices = 4;
-    cv::Point2f vertices[kNumVertices];
-    rect.points(vertices);
-    for (int i = 0; i < kNumVertices; i++) {
-      cv::line(mat_image_, vertices[i], vertices[(i + 1) % kNumVertices], color,
-               thickness);
-    }
-  } else {
-    cv::Rect rect(left, top, right - left, bottom - top);
-    cv::rectangle(mat_image_, rect, color, thickness);
-  }
+  DrawRectangleOutline(canvas, left, top, right, bottom,
+                       rectangle.rotation(), color, thickness);
   if (rectangle.has_top_left_thickness()) {
     const auto& rect = RectangleToOpenCVRotatedRect(left, top, right, bottom,
                                                     rectangle.rotation());
@@ -182,14 +462,14 @@ void AnnotationRenderer::DrawRectangle(const RenderAnnotation& annotation) {
     rect.points(vertices);
     const int top_left_thickness =
         ClampThickness(round(rectangle.top_left_thickness() * scale_factor_));
-    cv::ellipse(mat_image_, vertices[1],
-                cv::Size(top_left_thickness, top_left_thickness), 0.0, 0, 360,
-                color, -1);
+    CanvasEllipse(canvas, vertices[1],
+                  cv::Size(top_left_thickness, top_left_thickness), 0.0, 0,
+                  360, color, -1);
   }
 }
 
-void AnnotationRenderer::DrawFilledRectangle(
-    const RenderAnnotation& annotation) {
+void AnnotationRenderer::DrawFilledRectangle(const RenderAnnotation& annotation,
+                                             const Canvas& canvas) {
   int left = -1;
   int top = -1;
   int right = -1;
@@ -208,28 +488,16 @@ void AnnotationRenderer::DrawFilledRectangle(
     right = static_cast<int>(rectangle.right() * scale_factor_);
     bottom = static_cast<int>(rectangle.bottom() * scale_factor_);
   }
+  top -= canvas.top;
+  bottom -= canvas.top;
 
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
-  if (rectangle.rotation() != 0.0) {
-    const auto& rect = RectangleToOpenCVRotatedRect(left, top, right, bottom,
-                                                    rectangle.rotation());
-    const int kNumVertices = 4;
-    cv::Point2f vertices2f[kNumVertices];
-    rect.points(vertices2f);
-    // Convert cv::Point2f[] to cv::Point[].
-    cv::Point vertices[kNumVertices];
-    for (int i = 0; i < kNumVertices; ++i) {
-      vertices[i] = vertices2f[i];
-    }
-    cv::fillConvexPoly(mat_image_, vertices, kNumVertices, color);
-  } else {
-    cv::Rect rect(left, top, right - left, bottom - top);
-    cv::rectangle(mat_image_, rect, color, -1);
-  }
+  FillRectangle(canvas, left, top, right, bottom, rectangle.rotation(),
+                color);
 }
 
 void AnnotationRenderer::DrawRoundedRectangle(
-    const RenderAnnotation& annotation) {
+    const RenderAnnotation& annotation, const Canvas& canvas) {
   int left = -1;
   int top = -1;
   int right = -1;
@@ -248,6 +516,8 @@ void AnnotationRenderer::DrawRoundedRectangle(
     right = static_cast<int>(rectangle.right() * scale_factor_);
     bottom = static_cast<int>(rectangle.bottom() * scale_factor_);
   }
+  top -= canvas.top;
+  bottom -= canvas.top;
 
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int thickness =
@@ -255,13 +525,13 @@ void AnnotationRenderer::DrawRoundedRectangle(
   const int corner_radius =
       round(annotation.rounded_rectangle().corner_radius() * scale_factor_);
   const int line_type = annotation.rounded_rectangle().line_type();
-  DrawRoundedRectangle(mat_image_, cv::Point(left, top),
+  DrawRoundedRectangle(canvas, cv::Point(left, top),
                        cv::Point(right, bottom), color, thickness, line_type,
                        corner_radius);
 }
 
 void AnnotationRenderer::DrawFilledRoundedRectangle(
-    const RenderAnnotation& annotation) {
+    const RenderAnnotation& annotation, const Canvas& canvas) {
   int left = -1;
   int top = -1;
   int right = -1;
@@ -281,17 +551,20 @@ void AnnotationRenderer::DrawFilledRoundedRectangle(
     right = static_cast<int>(rectangle.right() * scale_factor_);
     bottom = static_cast<int>(rectangle.bottom() * scale_factor_);
   }
+  top -= canvas.top;
+  bottom -= canvas.top;
 
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int corner_radius =
       annotation.rounded_rectangle().corner_radius() * scale_factor_;
   const int line_type = annotation.rounded_rectangle().line_type();
-  DrawRoundedRectangle(mat_image_, cv::Point(left, top),
+  DrawRoundedRectangle(canvas, cv::Point(left, top),
                        cv::Point(right, bottom), color, -1, line_type,
                        corner_radius);
 }
 
-void AnnotationRenderer::DrawRoundedRectangle(cv::Mat src, cv::Point top_left,
+void AnnotationRenderer::DrawRoundedRectangle(const Canvas& canvas,
+                                              cv::Point top_left,
                                               cv::Point bottom_right,
                                               const cv::Scalar& line_color,
                                               int thickness, int line_type,
@@ -306,35 +579,33 @@ void AnnotationRenderer::DrawRoundedRectangle(cv::Mat src, cv::Point top_left,
   cv::Point p4 = cv::Point(top_left.x, bottom_right.y);
 
   // Draw edges of the rectangle
-  cv::line(src, cv::Point(p1.x + corner_radius, p1.y),
-           cv::Point(p2.x - corner_radius, p2.y), line_color, thickness,
-           line_type);
-  cv::line(src, cv::Point(p2.x, p2.y + corner_radius),
-           cv::Point(p3.x, p3.y - corner_radius), line_color, thickness,
-           line_type);
-  cv::line(src, cv::Point(p4.x + corner_radius, p4.y),
-           cv::Point(p3.x - corner_radius, p3.y), line_color, thickness,
-           line_type);
-  cv::line(src, cv::Point(p1.x, p1.y + corner_radius),
-           cv::Point(p4.x, p4.y - corner_radius), line_color, thickness,
-           line_type);
+  CanvasLine(canvas, cv::Point(p1.x + corner_radius, p1.y),
+             cv::Point(p2.x - corner_radius, p2.y), line_color, thickness,
+             line_type);
+  CanvasLine(canvas, cv::Point(p2.x, p2.y + corner_radius),
+             cv::Point(p3.x, p3.y - corner_radius), line_color, thickness,
+             line_type);
+  CanvasLine(canvas, cv::Point(p4.x + corner_radius, p4.y),
+             cv::Point(p3.x - corner_radius, p3.y), line_color, thickness,
+             line_type);
+  CanvasLine(canvas, cv::Point(p1.x, p1.y + corner_radius),
+             cv::Point(p4.x, p4.y - corner_radius), line_color, thickness,
+             line_type);
 
   // Draw arcs at corners.
-  cv::ellipse(src, p1 + cv::Point(corner_radius, corner_radius),
-              cv::Size(corner_radius, corner_radius), 180.0, 0, 90, line_color,
-              thickness, line_type);
-  cv::ellipse(src, p2 + cv::Point(-corner_radius, corner_radius),
-              cv::Size(corner_radius, corner_radius), 270.0, 0, 90, line_color,
-              thickness, line_type);
-  cv::ellipse(src, p3 + cv::Point(-corner_radius, -corner_radius),
-              cv::Size(corner_radius, corner_radius), 0.0, 0, 90, line_color,
-              thickness, line_type);
-  cv::ellipse(src, p4 + cv::Point(corner_radius, -corner_radius),
-              cv::Size(corner_radius, corner_radius), 90.0, 0, 90, line_color,
-              thickness, line_type);
-}
-
-void AnnotationRenderer::DrawOval(const RenderAnnotation& annotation) {
+  const cv::Size corner(corner_radius, corner_radius);
+  CanvasEllipse(canvas, p1 + cv::Point(corner_radius, corner_radius), corner,
+                180.0, 0, 90, line_color, thickness, line_type);
+  CanvasEllipse(canvas, p2 + cv::Point(-corner_radius, corner_radius), corner,
+                270.0, 0, 90, line_color, thickness, line_type);
+  CanvasEllipse(canvas, p3 + cv::Point(-corner_radius, -corner_radius), corner,
+                0.0, 0, 90, line_color, thickness, line_type);
+  CanvasEllipse(canvas, p4 + cv::Point(corner_radius, -corner_radius), corner,
+                90.0, 0, 90, line_color, thickness, line_type);
+}
+
+void AnnotationRenderer::DrawOval(const RenderAnnotation& annotation,
+                                  const Canvas& canvas) {
   int left = -1;
   int top = -1;
   int right = -1;
@@ -354,16 +625,17 @@ void AnnotationRenderer::DrawOval(const RenderAnnotation& annotation) {
     bottom = static_cast<int>(enclosing_rectangle.bottom() * scale_factor_);
   }
 
-  cv::Point center((left + right) / 2, (top + bottom) / 2);
+  cv::Point center((left + right) / 2, (top + bottom) / 2 - canvas.top);
   cv::Size size((right - left) / 2, (bottom - top) / 2);
   const double rotation = enclosing_rectangle.rotation() / M_PI * 180.f;
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
-  cv::ellipse(mat_image_, center, size, rotation, 0, 360, color, thickness);
+  CanvasEllipse(canvas, center, size, rotation, 0, 360, color, thickness);
 }
 
-void AnnotationRenderer::DrawFilledOval(const RenderAnnotation& annotation) {
+void AnnotationRenderer::DrawFilledOval(const RenderAnnotation& annotation,
+                                        const Canvas& canvas) {
   int left = -1;
   int top = -1;
   int right = -1;
@@ -383,15 +655,16 @@ void AnnotationRenderer::DrawFilledOval(const RenderAnnotation& annotation) {
     bottom = static_cast<int>(enclosing_rectangle.bottom() * scale_factor_);
   }
 
-  cv::Point center((left + right) / 2, (top + bottom) / 2);
+  cv::Point center((left + right) / 2, (top + bottom) / 2 - canvas.top);
   cv::Size size(std::max(0, (right - left) / 2),
                 std::max(0, (bottom - top) / 2));
   const double rotation = enclosing_rectangle.rotation() / M_PI * 180.f;
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
-  cv::ellipse(mat_image_, center, size, rotation, 0, 360, color, -1);
+  CanvasEllipse(canvas, center, size, rotation, 0, 360, color, -1);
 }
 
-void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation) {
+void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation,
+                                   const Canvas& canvas) {
   int x_start = -1;
   int y_start = -1;
   int x_end = -1;
@@ -412,6 +685,9 @@ void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation) {
     y_end = static_cast<int>(arrow.y_end() * scale_factor_);
   }
 
+  // The arrow tip is computed in image coordinates, and shifted to the canvas
+  // when drawn.
+  const cv::Point offset(0, canvas.top);
   cv::Point arrow_start(x_start, y_start);
   cv::Point arrow_end(x_end, y_end);
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
@@ -419,7 +695,8 @@ void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation) {
       ClampThickness(round(annotation.thickness() * scale_factor_));
 
   // Draw the main arrow line.
-  cv::line(mat_image_, arrow_start, arrow_end, color, thickness);
+  CanvasLine(canvas, arrow_start - offset, arrow_end - offset, color,
+             thickness);
 
   // Compute the arrowtip left and right vectors.
   Vector2_d L_start(static_cast<double>(x_start), static_cast<double>(y_start));
@@ -437,11 +714,14 @@ void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation) {
                                 static_cast<int>(round(arrowtip_left[1])));
   cv::Point arrowtip_right_start(static_cast<int>(round(arrowtip_right[0])),
                                  static_cast<int>(round(arrowtip_right[1])));
-  cv::line(mat_image_, arrowtip_left_start, arrow_end, color, thickness);
-  cv::line(mat_image_, arrowtip_right_start, arrow_end, color, thickness);
+  CanvasLine(canvas, arrowtip_left_start - offset, arrow_end - offset, color,
+             thickness);
+  CanvasLine(canvas, arrowtip_right_start - offset, arrow_end - offset, color,
+             thickness);
 }
 
-void AnnotationRenderer::DrawPoint(const RenderAnnotation& annotation) {
+void AnnotationRenderer::DrawPoint(const RenderAnnotation& annotation,
+                                   const Canvas& canvas) {
   const auto& point = annotation.point();
   int x = -1;
   int y = -1;
@@ -452,15 +732,17 @@ void AnnotationRenderer::DrawPoint(const RenderAnnotation& annotation) {
     x = static_cast<int>(point.x() * scale_factor_);
     y = static_cast<int>(point.y() * scale_factor_);
   }
+  y -= canvas.top;
 
   cv::Point point_to_draw(x, y);
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
-  cv::circle(mat_image_, point_to_draw, thickness, color, -1);
+  CanvasCircle(canvas, point_to_draw, thickness, color, -1);
 }
 
-void AnnotationRenderer::DrawLine(const RenderAnnotation& annotation) {
+void AnnotationRenderer::DrawLine(const RenderAnnotation& annotation,
+                                  const Canvas& canvas) {
   int x_start = -1;
   int y_start = -1;
   int x_end = -1;
@@ -479,16 +761,19 @@ void AnnotationRenderer::DrawLine(const RenderAnnotation& annotation) {
     x_end = static_cast<int>(line.x_end() * scale_factor_);
     y_end = static_cast<int>(line.y_end() * scale_factor_);
   }
+  y_start -= canvas.top;
+  y_end -= canvas.top;
 
   cv::Point start(x_start, y_start);
   cv::Point end(x_end, y_end);
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
-  cv::line(mat_image_, start, end, color, thickness);
+  CanvasLine(canvas, start, end, color, thickness);
 }
 
-void AnnotationRenderer::DrawGradientLine(const RenderAnnotation& annotation) {
+void AnnotationRenderer::DrawGradientLine(const RenderAnnotation& annotation,
+                                          const Canvas& canvas) {
   int x_start = -1;
   int y_start = -1;
   int x_end = -1;
@@ -508,16 +793,17 @@ void AnnotationRenderer::DrawGradientLine(const RenderAnnotation& annotation) {
     y_end = static_cast<int>(line.y_end() * scale_factor_);
   }
 
-  const cv::Point start(x_start, y_start);
-  const cv::Point end(x_end, y_end);
+  const cv::Point start(x_start, y_start - canvas.top);
+  const cv::Point end(x_end, y_end - canvas.top);
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
   const cv::Scalar color1 = MediapipeColorToOpenCVColor(line.color1());
   const cv::Scalar color2 = MediapipeColorToOpenCVColor(line.color2());
-  cv_line2(mat_image_, start, end, color1, color2, thickness);
+  cv_line2(canvas, start, end, color1, color2, thickness);
 }
 
-void AnnotationRenderer::DrawText(const RenderAnnotation& annotation) {
+void AnnotationRenderer::DrawText(const RenderAnnotation& annotation,
+                                  const Canvas& canvas) {
   int left = -1;
   int baseline = -1;
   int font_size = -1;
@@ -533,38 +819,49 @@ void AnnotationRenderer::DrawText(const RenderAnnotation& annotation) {
     baseline = static_cast<int>(text.baseline() * scale_factor_);
     font_size = static_cast<int>(text.font_height() * scale_factor_);
   }
+  baseline -= canvas.top;
+
+  DrawText(text.display_text(), cv::Point(left, baseline), font_size,
+           text.font_face(), text.center_horizontally(),
+           text.center_vertically(),
+           MediapipeColorToOpenCVColor(annotation.color()),
+           annotation.thickness(), text.outline_thickness(),
+           MediapipeColorToOpenCVColor(text.outline_color()), canvas);
+}
 
-  cv::Point origin(left, baseline);
-  const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
-  const int thickness =
-      ClampThickness(round(annotation.thickness() * scale_factor_));
-  const int font_face = text.font_face();
-
-  const double font_scale = ComputeFontScale(font_face, font_size, thickness);
+void AnnotationRenderer::DrawText(const std::string& display_text,
+                                  cv::Point origin, int font_size,
+                                  int font_face, bool center_horizontally,
+                                  bool center_vertically,
+                                  const cv::Scalar& color, double thickness,
+                                  double outline_thickness,
+                                  const cv::Scalar& outline_color,
+                                  const Canvas& canvas) {
+  const int scaled_thickness =
+      ClampThickness(round(thickness * scale_factor_));
+  const double font_scale =
+      ComputeFontScale(font_face, font_size, scaled_thickness);
   int text_baseline = 0;
-  cv::Size text_size = cv::getTextSize(text.display_text(), font_face,
-                                       font_scale, thickness, &text_baseline);
+  cv::Size text_size = cv::getTextSize(display_text, font_face, font_scale,
+                                       scaled_thickness, &text_baseline);
 
-  if (text.center_horizontally()) {
+  if (center_horizontally) {
     origin.x -= text_size.width / 2;
   }
-  if (text.center_vertically()) {
+  if (center_vertically) {
     origin.y += text_size.height / 2;
   }
 
-  if (text.outline_thickness() > 0.0) {
+  if (outline_thickness > 0.0) {
     const int background_thickness = ClampThickness(
-        round((annotation.thickness() + 2.0 * text.outline_thickness()) *
-              scale_factor_));
-    const cv::Scalar outline_color =
-        MediapipeColorToOpenCVColor(text.outline_color());
-    cv::putText(mat_image_, text.display_text(), origin, font_face, font_scale,
-                outline_color, background_thickness, /*lineType=*/8,
-                /*bottomLeftOrigin=*/flip_text_vertically_);
-  }
-  cv::putText(mat_image_, text.display_text(), origin, font_face, font_scale,
-              color, thickness, /*lineType=*/8,
-              /*bottomLeftOrigin=*/flip_text_vertically_);
+        round((thickness + 2.0 * outline_thickness) * scale_factor_));
+    CanvasPutText(canvas, display_text, origin, font_face, font_scale,
+                  outline_color, background_thickness,
+                  /*bottom_left_origin=*/flip_text_vertically_);
+  }
+  CanvasPutText(canvas, display_text, origin, font_face, font_scale, color,
+                scaled_thickness,
+                /*bottom_left_origin=*/flip_text_vertically_);
 }
 
 double AnnotationRenderer::ComputeFontScale(int font_face, int font_size,
@@ -15,13 +15,35 @@
 #ifndef MEDIAPIPE_UTIL_ANNOTATION_RENDERER_H_
 #define MEDIAPIPE_UTIL_ANNOTATION_RENDERER_H_
 
+#include <limits>
 #include <string>
 
+#include "absl/functional/function_ref.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/util/render_commands.h"
 #include "mediapipe/util/render_data.pb.h"
 
 namespace mediapipe {
+namespace annotation_renderer_internal {
+
+// Rows [first, last] of the image that drawing may touch.
+struct RowSpan {
+  int first = std::numeric_limits<int>::max();
+  int last = std::numeric_limits<int>::min();
+};
+
+// Rows of the image that annotations are drawn into. Drawing is clipped to
+// the rows, and y coordinates are relative to the first row, top. If "rows" is
+// set, drawing on the canvas only adds the rows it would touch to "rows".
+struct Canvas {
+  cv::Mat image;
+  int top = 0;
+  RowSpan* rows = nullptr;
+};
+
+}  // namespace annotation_renderer_internal
 
 // The renderer library for rendering data on images.
 //
@@ -57,6 +79,10 @@ class AnnotationRenderer {
   // Renders the image with the input render data.
   void RenderDataOnImage(const RenderData& render_data);
 
+  // Renders the image with the input render commands. Draws the same as
+  // RenderDataOnImage with the render data of AppendToRenderData(commands).
+  void RenderCommandsOnImage(const RenderCommands& commands);
+
   // Resets the renderer with a new image. Does not own input_image. input_image
   // must not be modified by caller during rendering.
   void AdoptImage(cv::Mat* input_image);
@@ -78,46 +104,87 @@ class AnnotationRenderer {
   void SetScaleFactor(float scale_factor);
   float GetScaleFactor() { return scale_factor_; }
 
+  // Sets a thread pool, not owned, to render with. Rendering then splits the
+  // image into horizontal bands, one per thread, and every thread draws the
+  // annotations that lie within its band. Annotations that cross a band
+  // boundary are drawn on the whole image in between, so the result is the
+  // same as without the thread pool. Pass nullptr to render on the calling
+  // thread.
+  void SetThreadPool(ThreadPool* thread_pool);
+
  private:
+  using Canvas = annotation_renderer_internal::Canvas;
+
+  // Calls "render" for each of the "size" annotations with the whole image as
+  // canvas, or with the band of the image the annotation lies within if a
+  // thread pool is set.
+  void RenderOnCanvases(int size,
+                        absl::FunctionRef<void(int, const Canvas&)> render);
+
+  // Draws the annotation on the canvas.
+  void DrawAnnotation(const RenderAnnotation& annotation,
+                      const Canvas& canvas);
+
+  // Draws the render command on the canvas.
+  void DrawCommand(const RenderCommands& commands,
+                   const RenderCommands::Command& command,
+                   const Canvas& canvas);
+
+  // Returns the pixel coordinates in the image of the point (x, y), in
+  // normalized or unscaled pixel coordinates.
+  cv::Point ToPixels(double x, double y, bool normalized) const;
+
   // Draws a rectangle on the image as described in the annotation.
-  void DrawRectangle(const RenderAnnotation& annotation);
+  void DrawRectangle(const RenderAnnotation& annotation, const Canvas& canvas);
 
   // Draws a filled rectangle on the image as described in the annotation.
-  void DrawFilledRectangle(const RenderAnnotation& annotation);
+  void DrawFilledRectangle(const RenderAnnotation& annotation,
+                           const Canvas& canvas);
 
   // Draws an oval on the image as described in the annotation.
-  void DrawOval(const RenderAnnotation& annotation);
+  void DrawOval(const RenderAnnotation& annotation, const Canvas& canvas);
 
   // Draws a filled oval on the image as described in the annotation.
-  void DrawFilledOval(const RenderAnnotation& annotation);
+  void DrawFilledOval(const RenderAnnotation& annotation, const Canvas& canvas);
 
   // Draws an arrow on the image as described in the annotation.
-  void DrawArrow(const RenderAnnotation& annotation);
+  void DrawArrow(const RenderAnnotation& annotation, const Canvas& canvas);
 
   // Draws a point on the image as described in the annotation.
-  void DrawPoint(const RenderAnnotation& annotation);
+  void DrawPoint(const RenderAnnotation& annotation, const Canvas& canvas);
 
   // Draws a line segment on the image as described in the annotation.
-  void DrawLine(const RenderAnnotation& annotation);
+  void DrawLine(const RenderAnnotation& annotation, const Canvas& canvas);
 
   // Draws a 2-tone line segment on the image as described in the annotation.
-  void DrawGradientLine(const RenderAnnotation& annotation);
+  void DrawGradientLine(const RenderAnnotation& annotation,
+                        const Canvas& canvas);
 
   // Draws a text on the image as described in the annotation.
-  void DrawText(const RenderAnnotation& annotation);
+  void DrawText(const RenderAnnotation& annotation, const Canvas& canvas);
+
+  // Draws the text at "origin" in the canvas. "font_size" is in pixels and
+  // "thickness" and "outline_thickness" are unscaled.
+  void DrawText(const std::string& display_text, cv::Point origin,
+                int font_size, int font_face, bool center_horizontally,
+                bool center_vertically, const cv::Scalar& color,
+                double thickness, double outline_thickness,
+                const cv::Scalar& outline_color, const Canvas& canvas);
 
   // Draws a rounded rectangle on the image as described in the annotation.
-  void DrawRoundedRectangle(const RenderAnnotation& annotation);
+  void DrawRoundedRectangle(const RenderAnnotation& annotation,
+                            const Canvas& canvas);
 
   // Draws a filled rounded rectangle on the image as described in the
   // annotation.
-  void DrawFilledRoundedRectangle(const RenderAnnotation& annotation);
+  void DrawFilledRoundedRectangle(const RenderAnnotation& annotation,
+                                  const Canvas& canvas);
 
   // Helper function for drawing a rectangle with rounded corners. The
   // parameters are the same as in the OpenCV function rectangle().
   // corner_radius: A positive int value defining the radius of the round
   // corners.
-  void DrawRoundedRectangle(cv::Mat src, cv::Point top_left,
+  void DrawRoundedRectangle(const Canvas& canvas, cv::Point top_left,
                             cv::Point bottom_right,
                             const cv::Scalar& line_color, int thickness = 1,
                             int line_type = 8, int corner_radius = 0);
@@ -137,6 +204,9 @@ class AnnotationRenderer {
 
   // See SetScaleFactor(float)
   float scale_factor_ = 1.0;
+
+  // See SetThreadPool(ThreadPool*).
+  ThreadPool* thread_pool_ = nullptr;
 };
 }  // namespace mediapipe
 
@@ -0,0 +1,231 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/annotation_renderer.h"
+
+#include <functional>
+#include <random>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/render_commands.h"
+#include "mediapipe/util/render_data.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 640;
+constexpr int kHeight = 480;
+// With 4 threads the image is split into bands starting at rows 0, 120, 240
+// and 360.
+constexpr int kNumThreads = 4;
+constexpr int kBandEdges[] = {120, 240, 360};
+
+// Returns the image rendered by "render" on the calling thread, or in the
+// bands of a thread pool if "threaded".
+cv::Mat Render(bool threaded,
+               const std::function<void(AnnotationRenderer*)>& render) {
+  cv::Mat image(kHeight, kWidth, CV_8UC3, cv::Scalar(0, 0, 0));
+  AnnotationRenderer renderer;
+  renderer.AdoptImage(&image);
+  ThreadPool pool("annotation_renderer_test", kNumThreads);
+  pool.StartWorkers();
+  if (threaded) {
+    renderer.SetThreadPool(&pool);
+  }
+  render(&renderer);
+  return image;
+}
+
+void ExpectSameBandedRendering(
+    const std::function<void(AnnotationRenderer*)>& render) {
+  const cv::Mat expected = Render(/*threaded=*/false, render);
+  const cv::Mat actual = Render(/*threaded=*/true, render);
+  ASSERT_GT(cv::norm(expected, cv::NORM_INF), 0);
+  EXPECT_EQ(cv::norm(expected, actual, cv::NORM_INF), 0);
+}
+
+void SetColor(int r, int g, int b, Color* color) {
+  color->set_r(r);
+  color->set_g(g);
+  color->set_b(b);
+}
+
+RenderAnnotation* AddAnnotation(int thickness, RenderData* render_data) {
+  RenderAnnotation* annotation = render_data->add_render_annotations();
+  SetColor(255, 40 * render_data->render_annotations_size() % 256, 0,
+           annotation->mutable_color());
+  annotation->set_thickness(thickness);
+  return annotation;
+}
+
+void SetRectangle(int left, int top, int right, int bottom, double rotation,
+                  RenderAnnotation::Rectangle* rectangle) {
+  rectangle->set_left(left);
+  rectangle->set_top(top);
+  rectangle->set_right(right);
+  rectangle->set_bottom(bottom);
+  rectangle->set_rotation(rotation);
+}
+
+void AddLine(int x_start, int y_start, int x_end, int y_end, int thickness,
+             RenderData* render_data) {
+  auto* line = AddAnnotation(thickness, render_data)->mutable_line();
+  line->set_x_start(x_start);
+  line->set_y_start(y_start);
+  line->set_x_end(x_end);
+  line->set_y_end(y_end);
+}
+
+// Adds every kind of annotation across the band edge at row "y", with a
+// filled rectangle within the band above and below it to check that the
+// drawing order is kept.
+void AddAnnotationsAcrossEdge(int y, RenderData* render_data) {
+  SetRectangle(20, y - 30, 600, y - 2, 0.0,
+               AddAnnotation(1, render_data)
+                   ->mutable_filled_rectangle()
+                   ->mutable_rectangle());
+  AddLine(10, y - 50, 630, y + 45, 1, render_data);
+  AddLine(30, y + 3, 600, y - 4, 1, render_data);
+  AddLine(50, y - 20, 90, y + 20, 5, render_data);
+  SetRectangle(100, y - 15, 160, y + 25, 0.3,
+               AddAnnotation(1, render_data)->mutable_rectangle());
+  SetRectangle(170, y - 25, 230, y + 5, 0.0,
+               AddAnnotation(3, render_data)->mutable_rectangle());
+  SetRectangle(240, y - 10, 300, y + 30, 0.6,
+               AddAnnotation(1, render_data)
+                   ->mutable_filled_rectangle()
+                   ->mutable_rectangle());
+  SetRectangle(
+      310, y - 20, 370, y + 10, 0.4,
+      AddAnnotation(2, render_data)->mutable_oval()->mutable_rectangle());
+  SetRectangle(380, y - 8, 420, y + 22, 0.0,
+               AddAnnotation(1, render_data)
+                   ->mutable_filled_oval()
+                   ->mutable_oval()
+                   ->mutable_rectangle());
+  auto* rounded_rectangle =
+      AddAnnotation(2, render_data)->mutable_rounded_rectangle();
+  rounded_rectangle->set_corner_radius(6);
+  SetRectangle(430, y - 18, 490, y + 12, 0.0,
+               rounded_rectangle->mutable_rectangle());
+  auto* filled_rounded_rectangle = AddAnnotation(1, render_data)
+                                       ->mutable_filled_rounded_rectangle()
+                                       ->mutable_rounded_rectangle();
+  filled_rounded_rectangle->set_corner_radius(5);
+  SetRectangle(500, y - 6, 540, y + 16, 0.0,
+               filled_rounded_rectangle->mutable_rectangle());
+  auto* arrow = AddAnnotation(1, render_data)->mutable_arrow();
+  arrow->set_x_start(550);
+  arrow->set_y_start(y - 30);
+  arrow->set_x_end(600);
+  arrow->set_y_end(y + 3);
+  auto* point = AddAnnotation(4, render_data)->mutable_point();
+  point->set_x(610);
+  point->set_y(y);
+  auto* gradient_line = AddAnnotation(2, render_data)->mutable_gradient_line();
+  gradient_line->set_x_start(15);
+  gradient_line->set_y_start(y + 40);
+  gradient_line->set_x_end(200);
+  gradient_line->set_y_end(y - 13);
+  SetColor(0, 0, 255, gradient_line->mutable_color1());
+  SetColor(0, 255, 0, gradient_line->mutable_color2());
+  auto* text = AddAnnotation(2, render_data)->mutable_text();
+  text->set_display_text("Band(y)");
+  text->set_left(200);
+  text->set_baseline(y + 8);
+  text->set_font_height(24);
+  text->set_outline_thickness(1);
+  SetColor(0, 0, 255, text->mutable_outline_color());
+  SetRectangle(20, y + 2, 600, y + 30, 0.0,
+               AddAnnotation(1, render_data)
+                   ->mutable_filled_rectangle()
+                   ->mutable_rectangle());
+  AddLine(25, y + 28, 595, y + 4, 1, render_data);
+}
+
+TEST(AnnotationRendererTest, BandedRenderDataIsPixelIdentical) {
+  RenderData render_data;
+  for (int y : kBandEdges) {
+    AddAnnotationsAcrossEdge(y, &render_data);
+  }
+  // Lines of width 1 change the most when clipped to a band.
+  std::mt19937 rng(/*seed=*/11);
+  std::uniform_int_distribution<int> x(0, kWidth - 1);
+  std::uniform_int_distribution<int> y(0, kHeight - 1);
+  for (int i = 0; i < 200; ++i) {
+    AddLine(x(rng), y(rng), x(rng), y(rng), 1, &render_data);
+  }
+
+  ExpectSameBandedRendering([&render_data](AnnotationRenderer* renderer) {
+    renderer->RenderDataOnImage(render_data);
+  });
+}
+
+TEST(AnnotationRendererTest, BandedFlippedTextIsPixelIdentical) {
+  RenderData render_data;
+  for (int y : kBandEdges) {
+    auto* text = AddAnnotation(1, &render_data)->mutable_text();
+    text->set_display_text("[flipped]");
+    text->set_left(100);
+    text->set_baseline(y - 6);
+    text->set_font_height(30);
+    text->set_center_vertically(true);
+  }
+
+  ExpectSameBandedRendering([&render_data](AnnotationRenderer* renderer) {
+    renderer->SetFlipTextVertically(true);
+    renderer->RenderDataOnImage(render_data);
+  });
+}
+
+TEST(AnnotationRendererTest, BandedRenderCommandsArePixelIdentical) {
+  RenderCommands commands;
+  RenderCommands::Style style;
+  style.color = {255, 0, 0};
+  style.color2 = {0, 0, 255};
+  for (int y : kBandEdges) {
+    style.thickness = 1.f;
+    commands.SetStyle(style);
+    commands.AddRectangle(20, y - 30, 600, y - 2, /*rotation=*/0.f,
+                          /*filled=*/true);
+    commands.AddLine(10, y - 50, 630, y + 45);
+    commands.AddGradientLine(15, y + 40, 200, y - 13);
+    commands.AddRectangle(100, y - 15, 160, y + 25, /*rotation=*/0.3f);
+    commands.AddRectangle(240, y - 10, 300, y + 30, /*rotation=*/0.6f,
+                          /*filled=*/true);
+    commands.AddOval(310, y - 20, 370, y + 10, /*rotation=*/0.4f);
+    commands.AddOval(380, y - 8, 420, y + 22, /*rotation=*/0.f,
+                     /*filled=*/true);
+    style.thickness = 3.f;
+    commands.SetStyle(style);
+    commands.AddPoint(610, y);
+    commands.AddLine(50, y - 20, 90, y + 20);
+    RenderCommands::Text text;
+    text.display_text = "Band(y)";
+    text.font_height = 24.f;
+    text.outline_thickness = 1.f;
+    commands.AddText(text, 430, y + 8);
+    commands.AddLine(25, y + 28, 595, y + 4);
+  }
+
+  ExpectSameBandedRendering([&commands](AnnotationRenderer* renderer) {
+    renderer->RenderCommandsOnImage(commands);
+  });
+}
+
+}  // namespace
+}  // namespace mediapipe
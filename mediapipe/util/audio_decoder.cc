@@ -19,6 +19,8 @@
 #include <cstdlib>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "Eigen/Core"
 #include "absl/base/internal/endian.h"
@@ -38,7 +40,9 @@ extern "C" {
 #include "libavformat/avformat.h"
 #include "libavutil/avutil.h"
 #include "libavutil/mem.h"
+#include "libavutil/channel_layout.h"
 #include "libavutil/samplefmt.h"
+#include "libswresample/swresample.h"
 }
 
 ABSL_FLAG(int64_t, media_decoder_allowed_audio_gap_merge, 5,
@@ -338,6 +342,12 @@ AudioPacketProcessor::AudioPacketProcessor(const AudioStreamOptions& options)
   DCHECK(absl::little_endian::IsLittleEndian());
 }
 
+AudioPacketProcessor::~AudioPacketProcessor() {
+  if (swr_ctx_) {
+    swr_free(&swr_ctx_);
+  }
+}
+
 absl::Status AudioPacketProcessor::Open(int id, AVStream* stream) {
   id_ = id;
   avcodec_ = avcodec_find_decoder(stream->codecpar->codec_id);
@@ -369,15 +379,71 @@ absl::Status AudioPacketProcessor::Open(int id, AVStream* stream) {
 
   sample_time_base_ = {1, static_cast<int>(sample_rate_)};
 
+  output_num_channels_ = options_.has_target_num_channels()
+                             ? options_.target_num_channels()
+                             : num_channels_;
+  output_sample_rate_ = options_.has_target_sample_rate()
+                            ? options_.target_sample_rate()
+                            : sample_rate_;
+  if (output_num_channels_ <= 0) {
+    return absl::InvalidArgumentError(
+        "target_num_channels must be strictly positive.");
+  }
+  if (output_sample_rate_ <= 0) {
+    return absl::InvalidArgumentError(
+        "target_sample_rate must be strictly positive.");
+  }
+  if (output_num_channels_ != num_channels_ ||
+      output_sample_rate_ != sample_rate_) {
+    MP_RETURN_IF_ERROR(OpenResampler());
+  }
+
   VLOG(0) << absl::Substitute(
       "Opened audio stream (id: $0, channels: $1, sample rate: $2, time base: "
-      "$3/$4).",
+      "$3/$4, output channels: $5, output sample rate: $6).",
       id_, num_channels_, sample_rate_, source_time_base_.num,
-      source_time_base_.den);
+      source_time_base_.den, output_num_channels_, output_sample_rate_);
 
   return absl::OkStatus();
 }
 
+absl::Status AudioPacketProcessor::OpenResampler() {
+  int64 input_channel_layout = avcodec_ctx_->channel_layout;
+  if (av_get_channel_layout_nb_channels(input_channel_layout) !=
+      num_channels_) {
+    input_channel_layout = av_get_default_channel_layout(num_channels_);
+  }
+  const int64 output_channel_layout =
+      av_get_default_channel_layout(output_num_channels_);
+  RET_CHECK(input_channel_layout && output_channel_layout)
+      << "No channel layout for " << num_channels_ << " or "
+      << output_num_channels_ << " channels.";
+  // Packed float samples have the memory layout of a column-major Matrix with
+  // a row per channel, so the resampler writes the output packets directly.
+  swr_ctx_ = swr_alloc_set_opts(
+      nullptr, output_channel_layout, AV_SAMPLE_FMT_FLT, output_sample_rate_,
+      input_channel_layout, avcodec_ctx_->sample_fmt, sample_rate_,
+      /*log_offset=*/0, /*log_ctx=*/nullptr);
+  RET_CHECK(swr_ctx_) << "swr_alloc_set_opts() failed.";
+  if (output_num_channels_ == 1 && num_channels_ > 1) {
+    // The default mix levels of libswresample depend on the channel layout,
+    // whereas the audio calculators mix down by averaging.
+    const std::vector<double> matrix(num_channels_, 1.0 / num_channels_);
+    const int error =
+        swr_set_matrix(swr_ctx_, matrix.data(), /*stride=*/num_channels_);
+    if (error < 0) {
+      return UnknownError(absl::StrCat("swr_set_matrix() failed: ",
+                                       AvErrorToString(error)));
+    }
+  }
+  const int error = swr_init(swr_ctx_);
+  if (error < 0) {
+    return UnknownError(
+        absl::StrCat("swr_init() failed: ", AvErrorToString(error)));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status AudioPacketProcessor::ValidateSampleFormat() {
   switch (avcodec_ctx_->sample_fmt) {
     case AV_SAMPLE_FMT_S16:
@@ -464,10 +530,16 @@ absl::Status AudioPacketProcessor::ProcessDecodedFrame(const AVPacket& packet) {
     }
   }
 
-  MP_RETURN_IF_ERROR(AddAudioDataToBuffer(
-      Timestamp(av_rescale_q(expected_sample_number_, sample_time_base_,
-                             output_time_base_)),
-      data_ptr, buf_size_bytes));
+  if (swr_ctx_) {
+    MP_RETURN_IF_ERROR(AddResampledAudioToBuffer(
+        const_cast<const uint8**>(decoded_frame_->extended_data),
+        decoded_frame_->nb_samples));
+  } else {
+    MP_RETURN_IF_ERROR(AddAudioDataToBuffer(
+        Timestamp(av_rescale_q(expected_sample_number_, sample_time_base_,
+                               output_time_base_)),
+        data_ptr, buf_size_bytes));
+  }
 
   ++num_frames_processed_;
   return absl::OkStatus();
@@ -548,10 +620,57 @@ absl::Status AudioPacketProcessor::AddAudioDataToBuffer(
              << "sample_fmt = " << avcodec_ctx_->sample_fmt;
   }
 
+  AddPacketToBuffer(Adopt(current_frame.release()).At(output_timestamp));
+  expected_sample_number_ += num_samples;
+
+  return absl::OkStatus();
+}
+
+absl::Status AudioPacketProcessor::AddResampledAudioToBuffer(
+    const uint8** raw_audio, int num_samples) {
+  // The resampler holds back some input samples, which are output first.
+  const int64 first_sample_number =
+      expected_sample_number_ - swr_get_delay(swr_ctx_, sample_rate_);
+  const int max_output_samples = swr_get_out_samples(swr_ctx_, num_samples);
+  if (max_output_samples < 0) {
+    return UnknownError(absl::StrCat("swr_get_out_samples() failed: ",
+                                     AvErrorToString(max_output_samples)));
+  }
+  expected_sample_number_ += num_samples;
+  if (max_output_samples == 0) {
+    return absl::OkStatus();
+  }
+
+  auto current_frame =
+      absl::make_unique<Matrix>(output_num_channels_, max_output_samples);
+  uint8* output = reinterpret_cast<uint8*>(current_frame->data());
+  const int num_output_samples = swr_convert(
+      swr_ctx_, &output, max_output_samples, raw_audio, num_samples);
+  if (num_output_samples < 0) {
+    return UnknownError(absl::StrCat("swr_convert() failed: ",
+                                     AvErrorToString(num_output_samples)));
+  }
+  if (num_output_samples == 0) {
+    return absl::OkStatus();
+  }
+  if (num_output_samples < max_output_samples) {
+    current_frame->conservativeResize(Eigen::NoChange, num_output_samples);
+  }
+  VLOG(3) << "Adding " << num_output_samples << " resampled audio samples in "
+          << output_num_channels_ << " channels to output.";
+  AddPacketToBuffer(Adopt(current_frame.release())
+                        .At(Timestamp(av_rescale_q(first_sample_number,
+                                                   sample_time_base_,
+                                                   output_time_base_))));
+  return absl::OkStatus();
+}
+
+void AudioPacketProcessor::AddPacketToBuffer(Packet packet) {
+  const Timestamp output_timestamp = packet.Timestamp();
   if (options_.output_regressing_timestamps() ||
       last_timestamp_ == Timestamp::Unset() ||
       output_timestamp > last_timestamp_) {
-    buffer_.push_back(Adopt(current_frame.release()).At(output_timestamp));
+    buffer_.push_back(std::move(packet));
     last_timestamp_ = output_timestamp;
     if (last_frame_time_regression_detected_) {
       last_frame_time_regression_detected_ = false;
@@ -564,15 +683,20 @@ absl::Status AudioPacketProcessor::AddAudioDataToBuffer(
                   "regressed.  Was "
                << last_timestamp_ << " but got " << output_timestamp;
   }
-  expected_sample_number_ += num_samples;
+}
 
+absl::Status AudioPacketProcessor::Flush() {
+  MP_RETURN_IF_ERROR(BasePacketProcessor::Flush());
+  if (swr_ctx_) {
+    MP_RETURN_IF_ERROR(AddResampledAudioToBuffer(nullptr, 0));
+  }
   return absl::OkStatus();
 }
 
 absl::Status AudioPacketProcessor::FillHeader(TimeSeriesHeader* header) const {
   CHECK(header);
-  header->set_sample_rate(sample_rate_);
-  header->set_num_channels(num_channels_);
+  header->set_sample_rate(output_sample_rate_);
+  header->set_num_channels(output_num_channels_);
   return absl::OkStatus();
 }
 
@@ -34,6 +34,7 @@ extern "C" {
 #include "libavformat/avformat.h"
 #include "libavutil/avutil.h"
 #include "libavutil/dict.h"
+#include "libswresample/swresample.h"
 #include "mediapipe/util/audio_decoder.pb.h"
 }
 
@@ -65,7 +66,7 @@ class BasePacketProcessor {
 
   // Once no more AVPackets are available in the file, each stream must
   // be flushed to get any remaining frames which the codec is buffering.
-  absl::Status Flush();
+  virtual absl::Status Flush();
 
   // Closes the Processor, this does not close the file.  You may not
   // call ProcessPacket() after calling Close().  Close() may be called
@@ -131,11 +132,15 @@ class BasePacketProcessor {
 class AudioPacketProcessor : public BasePacketProcessor {
  public:
   explicit AudioPacketProcessor(const AudioStreamOptions& options);
+  ~AudioPacketProcessor() override;
 
   absl::Status Open(int id, AVStream* stream) override;
 
   absl::Status ProcessPacket(AVPacket* packet) override;
 
+  // Also outputs the samples held back by the resampler, if any.
+  absl::Status Flush() override;
+
   absl::Status FillHeader(TimeSeriesHeader* header) const;
 
  private:
@@ -144,6 +149,17 @@ class AudioPacketProcessor : public BasePacketProcessor {
                                     uint8* const* raw_audio,
                                     int buf_size_bytes);
 
+  // Resamples and remixes num_samples input samples and appends the output
+  // to buffer_. Drains the resampler if raw_audio is null.
+  absl::Status AddResampledAudioToBuffer(const uint8** raw_audio,
+                                         int num_samples);
+
+  // Appends a packet of audio to buffer_ unless its timestamp regressed.
+  void AddPacketToBuffer(Packet packet);
+
+  // Sets up swr_ctx_ to convert the decoded audio to the output format.
+  absl::Status OpenResampler();
+
   // Converts a number of samples into an approximate stream timestamp value.
   int64 SampleNumberToTimestamp(const int64 sample_number);
   int64 TimestampToSampleNumber(const int64 timestamp);
@@ -176,6 +192,15 @@ class AudioPacketProcessor : public BasePacketProcessor {
   // The time base of audio samples (i.e. the reciprocal of the sample rate).
   AVRational sample_time_base_;
 
+  // The number of channels and the sample rate of the output packets, which
+  // differ from the decoded ones when the decoder resamples or remixes.
+  int output_num_channels_ = -1;
+  int64 output_sample_rate_ = -1;
+
+  // Converts the decoded audio to the output sample rate and channels, or is
+  // null if they match the decoded ones.
+  SwrContext* swr_ctx_ = nullptr;
+
   // The timestamp of the last packet added to the buffer.
   Timestamp last_timestamp_;
 
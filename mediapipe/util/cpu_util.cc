@@ -24,12 +24,18 @@
 #include <unistd.h>
 #endif
 #include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/flags/flag.h"
 #include "absl/strings/match.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -39,6 +45,10 @@ ABSL_FLAG(std::string, system_cpu_max_freq_file,
           "/sys/devices/system/cpu/cpu$0/cpufreq/cpuinfo_max_freq",
           "The file pattern for CPU max frequencies, where $0 will be replaced "
           "with the CPU id.");
+ABSL_FLAG(std::string, system_numa_node_cpu_list_file,
+          "/sys/devices/system/node/node$0/cpulist",
+          "The file pattern for the CPU lists of NUMA nodes, where $0 will be "
+          "replaced with the NUMA node id.");
 
 namespace mediapipe {
 namespace {
@@ -136,4 +146,37 @@ std::set<int> InferHigherCoreIds() {
   return InferLowerOrHigherCoreIds(/* lower= */ false);
 }
 
+absl::StatusOr<std::set<int>> GetNumaNodeCpuIds(int numa_node) {
+  const std::string& pattern =
+      absl::GetFlag(FLAGS_system_numa_node_cpu_list_file);
+  if (numa_node < 0 || !absl::StrContains(pattern, "$0")) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid NUMA node ", numa_node, " or CPU list file: ", pattern));
+  }
+  const std::string path = absl::Substitute(pattern, numa_node);
+  std::ifstream file(path);
+  std::string cpu_list;
+  if (!file.is_open() || !std::getline(file, cpu_list)) {
+    return absl::NotFoundError(absl::StrCat("Couldn't read ", path));
+  }
+  // The list is made of comma-separated CPU ids and ranges, e.g. "0-3,8-11".
+  std::set<int> cpus;
+  for (absl::string_view range :
+       absl::StrSplit(absl::StripAsciiWhitespace(cpu_list), ',',
+                      absl::SkipEmpty())) {
+    const std::vector<absl::string_view> bounds =
+        absl::StrSplit(range, absl::MaxSplits('-', 1));
+    int first, last;
+    if (!absl::SimpleAtoi(bounds.front(), &first) ||
+        !absl::SimpleAtoi(bounds.back(), &last) || first < 0 || first > last) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid CPU list in ", path, ": ", cpu_list));
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.insert(cpu);
+    }
+  }
+  return cpus;
+}
+
 }  // namespace mediapipe.
@@ -0,0 +1,98 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/cpu_util.h"
+
+#include <string>
+
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+ABSL_DECLARE_FLAG(std::string, system_numa_node_cpu_list_file);
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class NumaNodeCpuIdsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    absl::SetFlag(&FLAGS_system_numa_node_cpu_list_file,
+                  absl::StrCat(::testing::TempDir(), "/node$0_cpulist"));
+  }
+
+  // Writes the CPU list of `numa_node`.
+  void SetCpuList(int numa_node, absl::string_view cpu_list) {
+    MP_ASSERT_OK(file::SetContents(
+        absl::StrCat(::testing::TempDir(), "/node", numa_node, "_cpulist"),
+        cpu_list));
+  }
+
+ private:
+  absl::FlagSaver flag_saver_;
+};
+
+TEST_F(NumaNodeCpuIdsTest, ParsesIdsAndRanges) {
+  SetCpuList(0, "0-3,8,10-11\n");
+  MP_ASSERT_OK_AND_ASSIGN(auto cpus, GetNumaNodeCpuIds(0));
+  EXPECT_THAT(cpus, ElementsAre(0, 1, 2, 3, 8, 10, 11));
+}
+
+TEST_F(NumaNodeCpuIdsTest, ReadsFileOfRequestedNode) {
+  SetCpuList(0, "0-1");
+  SetCpuList(1, "2,3");
+  MP_ASSERT_OK_AND_ASSIGN(auto cpus, GetNumaNodeCpuIds(1));
+  EXPECT_THAT(cpus, ElementsAre(2, 3));
+}
+
+TEST_F(NumaNodeCpuIdsTest, ParsesEmptyList) {
+  // A memory-only NUMA node has no CPUs.
+  SetCpuList(0, "\n");
+  MP_ASSERT_OK_AND_ASSIGN(auto cpus, GetNumaNodeCpuIds(0));
+  EXPECT_THAT(cpus, IsEmpty());
+}
+
+TEST_F(NumaNodeCpuIdsTest, RejectsMalformedLists) {
+  for (absl::string_view cpu_list :
+       {"a", "0-", "-3", "3-1", "0-3-5", "0,,x", "1.5"}) {
+    SetCpuList(0, cpu_list);
+    EXPECT_EQ(GetNumaNodeCpuIds(0).status().code(),
+              absl::StatusCode::kInvalidArgument)
+        << cpu_list;
+  }
+}
+
+TEST_F(NumaNodeCpuIdsTest, FailsWithoutFile) {
+  EXPECT_EQ(GetNumaNodeCpuIds(7).status().code(), absl::StatusCode::kNotFound);
+}
+
+TEST_F(NumaNodeCpuIdsTest, RejectsInvalidNodeOrPattern) {
+  EXPECT_EQ(GetNumaNodeCpuIds(-1).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  absl::SetFlag(&FLAGS_system_numa_node_cpu_list_file, "/cpulist");
+  EXPECT_EQ(GetNumaNodeCpuIds(0).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace mediapipe
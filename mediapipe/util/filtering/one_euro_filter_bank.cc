@@ -0,0 +1,112 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr double kEpsilon = 0.000001;
+
+// LowPassFilter::Apply, with the same mix of float and double arithmetic.
+inline float LowPass(float alpha, float value, float stored_value) {
+  return alpha * value + (1.0 - alpha) * stored_value;
+}
+
+// Whether LowPassFilter accepts @alpha; it keeps its last alpha otherwise.
+inline bool IsValidAlpha(float alpha) { return alpha >= 0.0f && alpha <= 1.0f; }
+
+}  // namespace
+
+OneEuroFilterBank::OneEuroFilterBank(int size, double frequency,
+                                     double min_cutoff, double beta,
+                                     double derivate_cutoff)
+    : frequency_(frequency),
+      min_cutoff_(min_cutoff),
+      beta_(beta),
+      derivate_cutoff_(derivate_cutoff),
+      raw_values_(size),
+      values_(size),
+      derivatives_(size) {
+  LOG_IF(ERROR, frequency <= kEpsilon) << "frequency should be > 0";
+  LOG_IF(ERROR, min_cutoff <= kEpsilon) << "min_cutoff should be > 0";
+  LOG_IF(ERROR, derivate_cutoff <= kEpsilon)
+      << "derivate_cutoff should be > 0";
+  alphas_.assign(size, GetAlpha(min_cutoff));
+  derivative_alpha_ = GetAlpha(derivate_cutoff);
+}
+
+void OneEuroFilterBank::Apply(absl::Duration timestamp, double value_scale,
+                              const float* values, float* filtered) {
+  const int64_t new_timestamp = absl::ToInt64Nanoseconds(timestamp);
+  if (last_time_ >= new_timestamp) {
+    // Results are unpredictable in this case, so nothing to do but
+    // return same values.
+    LOG(WARNING) << "New timestamp is equal or less than the last one.";
+    std::copy_n(values, size(), filtered);
+    return;
+  }
+
+  // Updates the sampling frequency based on timestamps.
+  if (last_time_ != 0 && new_timestamp != 0) {
+    static constexpr double kNanoSecondsToSecond = 1e-9;
+    frequency_ = 1.0 / ((new_timestamp - last_time_) * kNanoSecondsToSecond);
+  }
+  last_time_ = new_timestamp;
+
+  const float derivative_alpha = GetAlpha(derivate_cutoff_);
+  if (IsValidAlpha(derivative_alpha)) derivative_alpha_ = derivative_alpha;
+  const double te = 1.0 / frequency_;
+  for (int i = 0; i < size(); ++i) {
+    const double value = values[i];
+    // Estimates the current variation per second.
+    const float dvalue =
+        initialized_ ? (value - raw_values_[i]) * value_scale * frequency_
+                     : 0.0;
+    const float edvalue = initialized_
+                              ? LowPass(derivative_alpha_, dvalue,
+                                        derivatives_[i])
+                              : dvalue;
+    // Uses it to update the cutoff frequency.
+    const double cutoff = min_cutoff_ + beta_ * std::fabs(edvalue);
+    const double tau = 1.0 / (2 * M_PI * cutoff);
+    const float alpha = 1.0 / (1.0 + tau / te);
+    if (IsValidAlpha(alpha)) alphas_[i] = alpha;
+    // Filters the given value.
+    const float result =
+        initialized_ ? LowPass(alphas_[i], values[i], values_[i]) : values[i];
+
+    raw_values_[i] = values[i];
+    values_[i] = result;
+    derivatives_[i] = edvalue;
+    filtered[i] = result;
+  }
+  initialized_ = true;
+}
+
+double OneEuroFilterBank::GetAlpha(double cutoff) const {
+  double te = 1.0 / frequency_;
+  double tau = 1.0 / (2 * M_PI * cutoff);
+  return 1.0 / (1.0 + tau / te);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,65 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
+#define MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+
+namespace mediapipe {
+
+// A bank of OneEuroFilters that always filter values of the same timestamps,
+// such as all coordinates of a set of landmarks. Produces the same results as
+// one OneEuroFilter per value, but keeps the state of all filters in
+// contiguous arrays, shares the timing state, and updates all values in one
+// loop that the compiler can vectorize.
+class OneEuroFilterBank {
+ public:
+  OneEuroFilterBank(int size, double frequency, double min_cutoff, double beta,
+                    double derivate_cutoff);
+
+  int size() const { return raw_values_.size(); }
+
+  // Filters @values, of size() elements, into @filtered, which may be the
+  // same array. See OneEuroFilter::Apply.
+  void Apply(absl::Duration timestamp, double value_scale, const float* values,
+             float* filtered);
+
+ private:
+  double GetAlpha(double cutoff) const;
+
+  double frequency_;
+  double min_cutoff_;
+  double beta_;
+  double derivate_cutoff_;
+  int64_t last_time_ = 0;
+  // Whether the low pass filters have seen a value.
+  bool initialized_ = false;
+
+  // Low pass filter state of the values: the last raw and filtered values,
+  // and the last valid alpha.
+  std::vector<float> raw_values_;
+  std::vector<float> values_;
+  std::vector<float> alphas_;
+  // Low pass filter state of the value derivatives, whose alpha is shared.
+  std::vector<float> derivatives_;
+  float derivative_alpha_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
@@ -0,0 +1,80 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/filtering/one_euro_filter.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(OneEuroFilterBankTest, MatchesOneFilterPerValue) {
+  constexpr int kSize = 21;
+  OneEuroFilterBank bank(kSize, /*frequency=*/30.0, /*min_cutoff=*/0.05,
+                         /*beta=*/80.0, /*derivate_cutoff=*/1.0);
+  std::vector<OneEuroFilter> filters;
+  for (int i = 0; i < kSize; ++i) {
+    filters.emplace_back(/*frequency=*/30.0, /*min_cutoff=*/0.05,
+                         /*beta=*/80.0, /*derivate_cutoff=*/1.0);
+  }
+
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> value_distribution(0.0f, 1.0f);
+  std::uniform_int_distribution<int64_t> duration_distribution(10, 60);
+  std::vector<float> values(kSize);
+  std::vector<float> filtered(kSize);
+  int64_t timestamp_ms = 0;
+  for (int step = 0; step < 50; ++step) {
+    // Repeats a timestamp once, which both ignore.
+    if (step != 20) timestamp_ms += duration_distribution(rng);
+    const double value_scale = 1.0 + step % 3;
+    for (float& value : values) value = value_distribution(rng);
+
+    bank.Apply(absl::Milliseconds(timestamp_ms), value_scale, values.data(),
+               filtered.data());
+
+    for (int i = 0; i < kSize; ++i) {
+      const float expected = filters[i].Apply(absl::Milliseconds(timestamp_ms),
+                                              value_scale, values[i]);
+      EXPECT_EQ(filtered[i], expected) << "step " << step << ", value " << i;
+    }
+  }
+}
+
+TEST(OneEuroFilterBankTest, FiltersInPlace) {
+  OneEuroFilterBank bank(2, /*frequency=*/30.0, /*min_cutoff=*/1.0,
+                         /*beta=*/0.0, /*derivate_cutoff=*/1.0);
+  OneEuroFilter filter(/*frequency=*/30.0, /*min_cutoff=*/1.0, /*beta=*/0.0,
+                       /*derivate_cutoff=*/1.0);
+
+  std::vector<float> values = {1.0f, 1.0f};
+  bank.Apply(absl::Milliseconds(10), 1.0, values.data(), values.data());
+  filter.Apply(absl::Milliseconds(10), 1.0, 1.0f);
+  values = {2.0f, 2.0f};
+  bank.Apply(absl::Milliseconds(40), 1.0, values.data(), values.data());
+  const float expected = filter.Apply(absl::Milliseconds(40), 1.0, 2.0f);
+
+  EXPECT_EQ(values[0], expected);
+  EXPECT_EQ(values[1], expected);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,127 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/relative_velocity_filter_bank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+RelativeVelocityFilterBank::RelativeVelocityFilterBank(
+    int size, size_t window_size, float velocity_scale,
+    DistanceEstimationMode distance_mode)
+    : window_size_(window_size),
+      velocity_scale_(velocity_scale),
+      distance_mode_(distance_mode),
+      last_values_(size),
+      window_distances_(window_size * size),
+      window_durations_(window_size),
+      filtered_values_(size),
+      distances_(size),
+      cumulative_distances_(size) {}
+
+void RelativeVelocityFilterBank::Apply(absl::Duration timestamp,
+                                       float value_scale, const float* values,
+                                       float* filtered) {
+  const int64_t new_timestamp = absl::ToInt64Nanoseconds(timestamp);
+  if (last_timestamp_ >= new_timestamp) {
+    // Results are unpredictable in this case, so nothing to do but
+    // return same values.
+    LOG(WARNING) << "New timestamp is equal or less than the last one.";
+    std::copy_n(values, size(), filtered);
+    return;
+  }
+
+  if (last_timestamp_ == -1) {
+    // The first values pass through the low pass filters as is.
+    std::copy_n(values, size(), filtered_values_.data());
+  } else {
+    DCHECK(distance_mode_ == DistanceEstimationMode::kLegacyTransition ||
+           distance_mode_ == DistanceEstimationMode::kForceCurrentScale);
+    if (distance_mode_ == DistanceEstimationMode::kLegacyTransition) {
+      for (int i = 0; i < size(); ++i) {
+        distances_[i] =
+            values[i] * value_scale - last_values_[i] * last_value_scale_;
+      }
+    } else {
+      // Translation invariant.
+      for (int i = 0; i < size(); ++i) {
+        distances_[i] = value_scale * (values[i] - last_values_[i]);
+      }
+    }
+
+    const int64_t duration = new_timestamp - last_timestamp_;
+
+    // Finds the window rows to accumulate, which only depends on durations.
+    // Max cumulative duration assumes 30 values per second, as in
+    // RelativeVelocityFilter.
+    constexpr int64_t kAssumedMaxDuration = 1000000000 / 30;
+    const int64_t max_cumulative_duration =
+        (1 + window_size_) * kAssumedMaxDuration;
+    int64_t cumulative_duration = duration;
+    int num_rows = 0;
+    for (; num_rows < window_size_; ++num_rows) {
+      const int64_t row_duration =
+          window_durations_[(window_start_ + num_rows) % window_size_];
+      if (cumulative_duration + row_duration > max_cumulative_duration) {
+        break;
+      }
+      cumulative_duration += row_duration;
+    }
+
+    // Accumulates distances from the most recent row on, like
+    // RelativeVelocityFilter does.
+    std::copy(distances_.begin(), distances_.end(),
+              cumulative_distances_.begin());
+    for (int row = 0; row < num_rows; ++row) {
+      const float* row_distances =
+          &window_distances_[((window_start_ + row) % window_size_) * size()];
+      for (int i = 0; i < size(); ++i) {
+        cumulative_distances_[i] += row_distances[i];
+      }
+    }
+
+    constexpr double kNanoSecondsToSecond = 1e-9;
+    const double cumulative_seconds =
+        cumulative_duration * kNanoSecondsToSecond;
+    for (int i = 0; i < size(); ++i) {
+      const float velocity = cumulative_distances_[i] / cumulative_seconds;
+      const float alpha =
+          1.0f - 1.0f / (1.0f + velocity_scale_ * std::abs(velocity));
+      // LowPassFilter::Apply, with the same mix of float and double.
+      filtered_values_[i] =
+          alpha * values[i] + (1.0 - alpha) * filtered_values_[i];
+    }
+
+    // The oldest row becomes the most recent one.
+    if (window_size_ > 0) {
+      window_start_ = (window_start_ + window_size_ - 1) % window_size_;
+      std::copy(distances_.begin(), distances_.end(),
+                &window_distances_[window_start_ * size()]);
+      window_durations_[window_start_] = duration;
+    }
+  }
+
+  std::copy_n(values, size(), last_values_.data());
+  last_value_scale_ = value_scale;
+  last_timestamp_ = new_timestamp;
+  std::copy(filtered_values_.begin(), filtered_values_.end(), filtered);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,78 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_FILTERING_RELATIVE_VELOCITY_FILTER_BANK_H_
+#define MEDIAPIPE_UTIL_FILTERING_RELATIVE_VELOCITY_FILTER_BANK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/util/filtering/relative_velocity_filter.h"
+
+namespace mediapipe {
+
+// A bank of RelativeVelocityFilters that always filter values of the same
+// timestamps, such as all coordinates of a set of landmarks. Produces the same
+// results as one RelativeVelocityFilter per value.
+//
+// As all filters see the same durations, they also use the same number of
+// window elements, so the window is kept as a ring buffer of rows of
+// distances, one per filter, with one shared duration per row. All values are
+// updated in loops over contiguous arrays that the compiler can vectorize.
+class RelativeVelocityFilterBank {
+ public:
+  using DistanceEstimationMode = RelativeVelocityFilter::DistanceEstimationMode;
+
+  RelativeVelocityFilterBank(
+      int size, size_t window_size, float velocity_scale,
+      DistanceEstimationMode distance_mode = DistanceEstimationMode::kDefault);
+
+  int size() const { return last_values_.size(); }
+
+  // Filters @values, of size() elements, into @filtered, which may be the
+  // same array. See RelativeVelocityFilter::Apply.
+  void Apply(absl::Duration timestamp, float value_scale, const float* values,
+             float* filtered);
+
+ private:
+  int window_size_;
+  float velocity_scale_;
+  DistanceEstimationMode distance_mode_;
+
+  float last_value_scale_ = 1.0f;
+  int64_t last_timestamp_ = -1;
+  std::vector<float> last_values_;
+
+  // Row r of the window holds the distances of all filters at
+  // window_distances_[r * size()], and their duration at window_durations_[r].
+  // Row window_start_ is the most recent, and rows get older from there,
+  // wrapping around. Like RelativeVelocityFilter's window, it starts out
+  // filled with zero distances and durations.
+  std::vector<float> window_distances_;
+  std::vector<int64_t> window_durations_;
+  int window_start_ = 0;
+
+  // Low pass filter state.
+  std::vector<float> filtered_values_;
+
+  // Scratch arrays of the current distances and their cumulative sums.
+  std::vector<float> distances_;
+  std::vector<float> cumulative_distances_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_FILTERING_RELATIVE_VELOCITY_FILTER_BANK_H_
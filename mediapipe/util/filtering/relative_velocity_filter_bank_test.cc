@@ -0,0 +1,83 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "mediapipe/util/filtering/relative_velocity_filter_bank.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/filtering/relative_velocity_filter.h"
+
+namespace mediapipe {
+namespace {
+
+using DistanceEstimationMode = RelativeVelocityFilter::DistanceEstimationMode;
+
+void ExpectSameAsOneFilterPerValue(size_t window_size,
+                                   DistanceEstimationMode distance_mode) {
+  constexpr int kSize = 21;
+  constexpr float kVelocityScale = 10.0f;
+  RelativeVelocityFilterBank bank(kSize, window_size, kVelocityScale,
+                                  distance_mode);
+  std::vector<RelativeVelocityFilter> filters;
+  for (int i = 0; i < kSize; ++i) {
+    filters.emplace_back(window_size, kVelocityScale, distance_mode);
+  }
+
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> value_distribution(0.0f, 1.0f);
+  // Includes durations long enough to cut the window short.
+  std::uniform_int_distribution<int64_t> duration_distribution(10, 120);
+  std::vector<float> values(kSize);
+  std::vector<float> filtered(kSize);
+  int64_t timestamp_ms = 0;
+  for (int step = 0; step < 50; ++step) {
+    // Repeats a timestamp once, which both ignore.
+    if (step != 20) timestamp_ms += duration_distribution(rng);
+    const float value_scale = 1.0f + step % 3;
+    for (float& value : values) value = value_distribution(rng);
+
+    bank.Apply(absl::Milliseconds(timestamp_ms), value_scale, values.data(),
+               filtered.data());
+
+    for (int i = 0; i < kSize; ++i) {
+      const float expected = filters[i].Apply(absl::Milliseconds(timestamp_ms),
+                                              value_scale, values[i]);
+      EXPECT_EQ(filtered[i], expected) << "step " << step << ", value " << i;
+    }
+  }
+}
+
+TEST(RelativeVelocityFilterBankTest, MatchesOneFilterPerValue) {
+  ExpectSameAsOneFilterPerValue(/*window_size=*/5,
+                                DistanceEstimationMode::kLegacyTransition);
+}
+
+TEST(RelativeVelocityFilterBankTest,
+     MatchesOneFilterPerValueWithForceCurrentScale) {
+  ExpectSameAsOneFilterPerValue(/*window_size=*/5,
+                                DistanceEstimationMode::kForceCurrentScale);
+}
+
+TEST(RelativeVelocityFilterBankTest, MatchesOneFilterPerValueWithoutWindow) {
+  ExpectSameAsOneFilterPerValue(/*window_size=*/0,
+                                DistanceEstimationMode::kLegacyTransition);
+}
+
+}  // namespace
+}  // namespace mediapipe
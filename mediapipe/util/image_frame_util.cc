@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -32,6 +33,7 @@
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/yuv_image.h"
+#include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/aligned_malloc_and_free.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
@@ -320,5 +322,17 @@ void LinearRgb16ToSrgb(const cv::Mat& source, cv::Mat* destination) {
   }
 }
 
+absl::StatusOr<std::unique_ptr<ImageFrame>> ConsumeOrCopyImageFrame(
+    Packet* packet, int alignment_boundary) {
+  MP_RETURN_IF_ERROR(packet->ValidateAsType<ImageFrame>());
+  auto consumed = packet->Consume<ImageFrame>();
+  if (consumed.ok()) return consumed;
+  // ImageFrame isn't copyable, so Packet::ConsumeOrCopy can't be used.
+  auto copy = std::make_unique<ImageFrame>();
+  copy->CopyFrom(packet->Get<ImageFrame>(), alignment_boundary);
+  *packet = Packet();
+  return copy;
+}
+
 }  // namespace image_frame_util
 }  // namespace mediapipe
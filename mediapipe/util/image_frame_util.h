@@ -16,8 +16,10 @@
 #ifndef MEDIAPIPE_UTIL_IMAGE_FRAME_UTIL_H_
 #define MEDIAPIPE_UTIL_IMAGE_FRAME_UTIL_H_
 
+#include <memory>
 #include <string>
 
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -26,6 +28,7 @@
 
 namespace mediapipe {
 class ImageFrame;
+class Packet;
 class YUVImage;
 }  // namespace mediapipe
 
@@ -88,6 +91,14 @@ void MpegYCbCrToSrgb(const uint8 y, const uint8 cb, const uint8 cr,  //
 void SrgbToLinearRgb16(const cv::Mat& source, cv::Mat* destination);
 void LinearRgb16ToSrgb(const cv::Mat& source, cv::Mat* destination);
 
+// Returns the ImageFrame held by `packet` for modification, moved out of the
+// packet if the packet is its sole owner, and otherwise copied with rows
+// aligned to `alignment_boundary`. `packet` is empty afterwards. This lets a
+// calculator draw onto its input frame instead of copying it whenever no other
+// calculator reads the frame.
+absl::StatusOr<std::unique_ptr<ImageFrame>> ConsumeOrCopyImageFrame(
+    Packet* packet, int alignment_boundary);
+
 }  // namespace image_frame_util
 }  // namespace mediapipe
 
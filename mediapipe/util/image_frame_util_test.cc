@@ -0,0 +1,71 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/image_frame_util.h"
+
+#include <memory>
+
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace image_frame_util {
+namespace {
+
+Packet MakeFramePacket() {
+  auto frame = std::make_unique<ImageFrame>(ImageFormat::SRGB, 5, 3);
+  frame->SetToZero();
+  return Adopt(frame.release());
+}
+
+TEST(ConsumeOrCopyImageFrameTest, MovesFrameOfSoleOwner) {
+  Packet packet = MakeFramePacket();
+  const ImageFrame* held_frame = &packet.Get<ImageFrame>();
+
+  MP_ASSERT_OK_AND_ASSIGN(auto frame, ConsumeOrCopyImageFrame(&packet, 4));
+  EXPECT_EQ(frame.get(), held_frame);
+  EXPECT_TRUE(packet.IsEmpty());
+}
+
+TEST(ConsumeOrCopyImageFrameTest, CopiesSharedFrame) {
+  const Packet upstream = MakeFramePacket();
+  const ImageFrame& upstream_frame = upstream.Get<ImageFrame>();
+  Packet packet = upstream;
+
+  MP_ASSERT_OK_AND_ASSIGN(auto frame, ConsumeOrCopyImageFrame(&packet, 4));
+  EXPECT_TRUE(packet.IsEmpty());
+  EXPECT_NE(frame.get(), &upstream_frame);
+  EXPECT_EQ(frame->Width(), 5);
+  EXPECT_EQ(frame->Height(), 3);
+  EXPECT_EQ(frame->Format(), ImageFormat::SRGB);
+  EXPECT_EQ(frame->WidthStep() % 4, 0);
+
+  // The upstream packet is never modified.
+  frame->MutablePixelData()[0] = 7;
+  EXPECT_EQ(&upstream.Get<ImageFrame>(), &upstream_frame);
+  EXPECT_EQ(upstream_frame.PixelData()[0], 0);
+}
+
+TEST(ConsumeOrCopyImageFrameTest, RejectsOtherTypes) {
+  Packet packet = MakePacket<int>(1);
+  EXPECT_FALSE(ConsumeOrCopyImageFrame(&packet, 4).ok());
+  EXPECT_FALSE(packet.IsEmpty());
+}
+
+}  // namespace
+}  // namespace image_frame_util
+}  // namespace mediapipe
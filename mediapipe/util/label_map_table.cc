@@ -0,0 +1,99 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/label_map_table.h"
+
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/no_destructor.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Returns a hash of the contents of "label_map" that does not depend on its
+// iteration order.
+size_t HashLabelMap(const proto_ns::Map<int64, LabelMapItem>& label_map) {
+  size_t hash = label_map.size();
+  for (const auto& [id, item] : label_map) {
+    hash += absl::HashOf(id, item.name(), item.has_display_name(),
+                         item.display_name());
+  }
+  return hash;
+}
+
+// The tables shared across the process, by hash of their contents. Entries
+// expire with the last user of the table.
+struct SharedTables {
+  absl::Mutex mutex;
+  absl::flat_hash_map<size_t, std::weak_ptr<const LabelMapTable>> tables
+      ABSL_GUARDED_BY(mutex);
+};
+
+}  // namespace
+
+LabelMapTable::LabelMapTable(
+    const proto_ns::Map<int64, LabelMapItem>& label_map) {
+  labels_.reserve(label_map.size());
+  for (const auto& [id, item] : label_map) {
+    Label& label = labels_[id];
+    label.name = item.name();
+    if (item.has_display_name()) label.display_name = item.display_name();
+  }
+}
+
+LabelMapTablePtr InternLabelMapTable(
+    const proto_ns::Map<int64, LabelMapItem>& label_map) {
+  static NoDestructor<SharedTables> shared_tables;
+  auto table = std::make_shared<const LabelMapTable>(label_map);
+  absl::MutexLock lock(&shared_tables->mutex);
+  std::weak_ptr<const LabelMapTable>& entry =
+      shared_tables->tables[HashLabelMap(label_map)];
+  LabelMapTablePtr existing = entry.lock();
+  // Compares the contents, to not share the table on a hash collision.
+  if (existing != nullptr && *existing == *table) return existing;
+  entry = table;
+  return table;
+}
+
+bool AddDetectionLabels(const LabelMapTable& table, Detection* detection) {
+  bool found = false;
+  for (const int32 label_id : detection->label_id()) {
+    const LabelMapTable::Label* label = table.Find(label_id);
+    if (label == nullptr) continue;
+    detection->add_label(label->name);
+    if (label->display_name.has_value()) {
+      detection->add_display_name(*label->display_name);
+    }
+    found = true;
+  }
+  return found;
+}
+
+void SetClassificationLabels(const LabelMapTable& table,
+                             ClassificationList* list) {
+  for (Classification& classification : *list->mutable_classification()) {
+    const LabelMapTable::Label* label = table.Find(classification.index());
+    if (label == nullptr) continue;
+    classification.set_label(label->name);
+    if (label->display_name.has_value()) {
+      classification.set_display_name(*label->display_name);
+    }
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,89 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_LABEL_MAP_TABLE_H_
+#define MEDIAPIPE_UTIL_LABEL_MAP_TABLE_H_
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/proto_ns.h"
+#include "mediapipe/util/label_map.pb.h"
+
+namespace mediapipe {
+
+// An immutable table of the labels of the classes of a model, by class id.
+//
+// Calculators share one table, through a LabelMapTablePtr side packet, instead
+// of each keeping a copy of the LabelMapItem protos. They may also output class
+// ids only, leaving the lookup of the labels to the consumers of the results,
+// e.g. for the few results that reach the user.
+class LabelMapTable {
+ public:
+  struct Label {
+    std::string name;
+    std::optional<std::string> display_name;
+
+    bool operator==(const Label& other) const {
+      return name == other.name && display_name == other.display_name;
+    }
+  };
+
+  explicit LabelMapTable(const proto_ns::Map<int64, LabelMapItem>& label_map);
+
+  LabelMapTable(const LabelMapTable&) = delete;
+  LabelMapTable& operator=(const LabelMapTable&) = delete;
+
+  // Returns the label of class "id", or nullptr if there is none.
+  const Label* Find(int64 id) const {
+    auto it = labels_.find(id);
+    return it == labels_.end() ? nullptr : &it->second;
+  }
+
+  size_t size() const { return labels_.size(); }
+
+  bool operator==(const LabelMapTable& other) const {
+    return labels_ == other.labels_;
+  }
+
+ private:
+  absl::flat_hash_map<int64, Label> labels_;
+};
+
+using LabelMapTablePtr = std::shared_ptr<const LabelMapTable>;
+
+// Returns a table of "label_map". Tables with the same contents are shared
+// while any of them is in use, so that graphs running the same model, or the
+// several calculators of one graph, keep a single copy of its labels.
+LabelMapTablePtr InternLabelMapTable(
+    const proto_ns::Map<int64, LabelMapItem>& label_map);
+
+// Adds the labels, and display names if any, of the label ids of "detection"
+// found in "table". Returns whether any was found.
+bool AddDetectionLabels(const LabelMapTable& table, Detection* detection);
+
+// Sets the label, and display name if any, of each classification in "list"
+// from the label of its index in "table".
+void SetClassificationLabels(const LabelMapTable& table,
+                             ClassificationList* list);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_LABEL_MAP_TABLE_H_
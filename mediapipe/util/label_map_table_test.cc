@@ -0,0 +1,85 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/label_map_table.h"
+
+#include "mediapipe/framework/formats/classification.pb.h"
+#include "mediapipe/framework/formats/detection.pb.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/label_map.pb.h"
+
+namespace mediapipe {
+namespace {
+
+proto_ns::Map<int64, LabelMapItem> MakeLabelMap() {
+  proto_ns::Map<int64, LabelMapItem> label_map;
+  label_map[0].set_name("/m/01");
+  label_map[0].set_display_name("cat");
+  label_map[3].set_name("/m/02");
+  return label_map;
+}
+
+TEST(LabelMapTableTest, FindsLabels) {
+  LabelMapTable table(MakeLabelMap());
+  EXPECT_EQ(table.size(), 2);
+  ASSERT_NE(table.Find(0), nullptr);
+  EXPECT_EQ(table.Find(0)->name, "/m/01");
+  EXPECT_EQ(table.Find(0)->display_name, "cat");
+  ASSERT_NE(table.Find(3), nullptr);
+  EXPECT_EQ(table.Find(3)->display_name, std::nullopt);
+  EXPECT_EQ(table.Find(1), nullptr);
+}
+
+TEST(LabelMapTableTest, InternsEqualTables) {
+  LabelMapTablePtr table = InternLabelMapTable(MakeLabelMap());
+  EXPECT_EQ(InternLabelMapTable(MakeLabelMap()), table);
+
+  proto_ns::Map<int64, LabelMapItem> other_map = MakeLabelMap();
+  other_map[3].set_display_name("dog");
+  LabelMapTablePtr other = InternLabelMapTable(other_map);
+  EXPECT_NE(other, table);
+  EXPECT_EQ(other->Find(3)->display_name, "dog");
+}
+
+TEST(LabelMapTableTest, AddsDetectionLabels) {
+  LabelMapTable table(MakeLabelMap());
+  Detection detection;
+  detection.add_label_id(3);
+  detection.add_label_id(0);
+  EXPECT_TRUE(AddDetectionLabels(table, &detection));
+  ASSERT_EQ(detection.label_size(), 2);
+  EXPECT_EQ(detection.label(0), "/m/02");
+  EXPECT_EQ(detection.label(1), "/m/01");
+  ASSERT_EQ(detection.display_name_size(), 1);
+  EXPECT_EQ(detection.display_name(0), "cat");
+
+  Detection unknown;
+  unknown.add_label_id(7);
+  EXPECT_FALSE(AddDetectionLabels(table, &unknown));
+  EXPECT_EQ(unknown.label_size(), 0);
+}
+
+TEST(LabelMapTableTest, SetsClassificationLabels) {
+  LabelMapTable table(MakeLabelMap());
+  ClassificationList list;
+  list.add_classification()->set_index(0);
+  list.add_classification()->set_index(5);
+  SetClassificationLabels(table, &list);
+  EXPECT_EQ(list.classification(0).label(), "/m/01");
+  EXPECT_EQ(list.classification(0).display_name(), "cat");
+  EXPECT_FALSE(list.classification(1).has_label());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,308 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/message_socket.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+
+#ifndef _WIN32
+#define MEDIAPIPE_HAS_MESSAGE_SOCKET 1
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace mediapipe {
+
+#ifdef MEDIAPIPE_HAS_MESSAGE_SOCKET
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif  // MSG_NOSIGNAL
+
+constexpr size_t kHeaderSize = sizeof(uint32_t);
+constexpr size_t kReceiveSize = 1 << 16;
+
+absl::Status SocketError(absl::string_view what) {
+  return absl::UnavailableError(absl::StrCat(what, ": ", std::strerror(errno)));
+}
+
+// Configures a connected socket.
+void SetUpConnection(int fd) {
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif  // SO_NOSIGPIPE
+}
+
+// Waits up to `timeout` for `fd` to be readable, and returns whether it is.
+absl::StatusOr<bool> WaitReadable(int fd, absl::Duration timeout) {
+  const absl::Time deadline = absl::Now() + timeout;
+  while (true) {
+    int timeout_ms = -1;
+    if (timeout != absl::InfiniteDuration()) {
+      timeout_ms = static_cast<int>(std::ceil(absl::ToDoubleMilliseconds(
+          std::max(deadline - absl::Now(), absl::ZeroDuration()))));
+    }
+    pollfd poll_fd = {fd, POLLIN, 0};
+    const int result = poll(&poll_fd, 1, timeout_ms);
+    if (result >= 0) return result > 0;
+    if (errno != EINTR) return SocketError("poll failed");
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<MessageSocket>> MessageSocket::Listen(
+    int port) {
+  // Listens on both IPv6 and IPv4 where possible, and on IPv4 otherwise.
+  int fd = socket(AF_INET6, SOCK_STREAM, 0);
+  int zero = 0;
+  int one = 1;
+  if (fd >= 0) {
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+    sockaddr_in6 address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_addr = in6addr_any;
+    address.sin6_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) !=
+        0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  if (fd < 0) {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return SocketError("socket failed");
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) !=
+        0) {
+      absl::Status status = SocketError(absl::StrCat("bind to ", port));
+      close(fd);
+      return status;
+    }
+  }
+  if (listen(fd, /*backlog=*/16) != 0) {
+    absl::Status status = SocketError("listen failed");
+    close(fd);
+    return status;
+  }
+  return std::unique_ptr<MessageSocket>(new MessageSocket(fd));
+}
+
+absl::StatusOr<std::unique_ptr<MessageSocket>> MessageSocket::Connect(
+    const std::string& address) {
+  const size_t colon = address.rfind(':');
+  int port;
+  if (colon == std::string::npos ||
+      !absl::SimpleAtoi(address.substr(colon + 1), &port)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Expected \"host:port\", got \"", address, "\"."));
+  }
+  std::string host = address.substr(0, colon);
+  if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+    host = host.substr(1, host.size() - 2);
+  }
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  const int error = getaddrinfo(host.c_str(), absl::StrCat(port).c_str(),
+                                &hints, &addresses);
+  if (error != 0) {
+    return absl::UnavailableError(absl::StrCat(
+        "Failed to resolve ", host, ": ", gai_strerror(error)));
+  }
+  absl::Status status =
+      absl::UnavailableError(absl::StrCat("No address for ", address));
+  int fd = -1;
+  for (addrinfo* info = addresses; info != nullptr; info = info->ai_next) {
+    fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+    if (fd < 0) {
+      status = SocketError("socket failed");
+      continue;
+    }
+    if (connect(fd, info->ai_addr, info->ai_addrlen) == 0) break;
+    status = SocketError(absl::StrCat("Failed to connect to ", address));
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(addresses);
+  if (fd < 0) return status;
+  SetUpConnection(fd);
+  return std::unique_ptr<MessageSocket>(new MessageSocket(fd));
+}
+
+MessageSocket::MessageSocket(int fd) : fd_(fd) {}
+
+MessageSocket::~MessageSocket() { close(fd_); }
+
+int MessageSocket::port() const {
+  sockaddr_storage address = {};
+  socklen_t size = sizeof(address);
+  if (getsockname(fd_, reinterpret_cast<sockaddr*>(&address), &size) != 0) {
+    return 0;
+  }
+  if (address.ss_family == AF_INET6) {
+    return ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+  }
+  return ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+}
+
+absl::StatusOr<std::unique_ptr<MessageSocket>> MessageSocket::Accept(
+    absl::Duration timeout) {
+  absl::StatusOr<bool> readable = WaitReadable(fd_, timeout);
+  if (!readable.ok()) return readable.status();
+  if (!*readable) return nullptr;
+  const int fd = accept(fd_, nullptr, nullptr);
+  if (fd < 0) {
+    if (errno == EINTR || errno == EAGAIN || errno == ECONNABORTED) {
+      return nullptr;
+    }
+    return SocketError("accept failed");
+  }
+  SetUpConnection(fd);
+  return std::unique_ptr<MessageSocket>(new MessageSocket(fd));
+}
+
+absl::Status MessageSocket::Send(absl::string_view message) {
+  if (message.size() > kMaxMessageSize) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("A message of ", message.size(), " bytes is too large."));
+  }
+  const uint32_t size = message.size();
+  uint8_t header[kHeaderSize];
+  for (int i = 0; i < kHeaderSize; ++i) header[i] = (size >> (8 * i)) & 0xff;
+  for (absl::string_view data :
+       {absl::string_view(reinterpret_cast<char*>(header), kHeaderSize),
+        message}) {
+    while (!data.empty()) {
+      const ssize_t sent = send(fd_, data.data(), data.size(), kSendFlags);
+      if (sent < 0) {
+        if (errno == EINTR) continue;
+        return SocketError("send failed");
+      }
+      data.remove_prefix(sent);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> MessageSocket::Receive(absl::Duration timeout,
+                                            std::string* message) {
+  const absl::Time deadline = absl::Now() + timeout;
+  char chunk[kReceiveSize];
+  while (true) {
+    absl::StatusOr<bool> taken = TakeMessage(message);
+    if (!taken.ok() || *taken) return taken;
+    absl::StatusOr<bool> readable = WaitReadable(
+        fd_, timeout == absl::InfiniteDuration() ? timeout
+                                                 : deadline - absl::Now());
+    if (!readable.ok()) return readable.status();
+    if (!*readable) return false;
+    const ssize_t received = recv(fd_, chunk, sizeof(chunk), 0);
+    if (received < 0) {
+      if (errno == EINTR || errno == EAGAIN) continue;
+      return SocketError("recv failed");
+    }
+    if (received == 0) {
+      if (!buffer_.empty()) {
+        return absl::DataLossError("The connection closed within a message.");
+      }
+      return absl::OutOfRangeError("The connection is closed.");
+    }
+    buffer_.append(chunk, received);
+  }
+}
+
+absl::StatusOr<bool> MessageSocket::TakeMessage(std::string* message) {
+  if (buffer_.size() < kHeaderSize) return false;
+  uint32_t size = 0;
+  for (int i = 0; i < kHeaderSize; ++i) {
+    size |= static_cast<uint32_t>(static_cast<uint8_t>(buffer_[i])) << (8 * i);
+  }
+  if (size > kMaxMessageSize) {
+    return absl::DataLossError(
+        absl::StrCat("Received the size of a message of ", size, " bytes."));
+  }
+  if (buffer_.size() < kHeaderSize + size) {
+    buffer_.reserve(kHeaderSize + size);
+    return false;
+  }
+  message->assign(buffer_, kHeaderSize, size);
+  buffer_.erase(0, kHeaderSize + size);
+  return true;
+}
+
+#else  // MEDIAPIPE_HAS_MESSAGE_SOCKET
+
+absl::StatusOr<std::unique_ptr<MessageSocket>> MessageSocket::Listen(
+    int port) {
+  return absl::UnimplementedError("MessageSocket is unsupported.");
+}
+
+absl::StatusOr<std::unique_ptr<MessageSocket>> MessageSocket::Connect(
+    const std::string& address) {
+  return absl::UnimplementedError("MessageSocket is unsupported.");
+}
+
+MessageSocket::MessageSocket(int fd) : fd_(fd) {}
+
+MessageSocket::~MessageSocket() {}
+
+int MessageSocket::port() const { return 0; }
+
+absl::StatusOr<std::unique_ptr<MessageSocket>> MessageSocket::Accept(
+    absl::Duration timeout) {
+  return absl::UnimplementedError("MessageSocket is unsupported.");
+}
+
+absl::Status MessageSocket::Send(absl::string_view message) {
+  return absl::UnimplementedError("MessageSocket is unsupported.");
+}
+
+absl::StatusOr<bool> MessageSocket::Receive(absl::Duration timeout,
+                                            std::string* message) {
+  return absl::UnimplementedError("MessageSocket is unsupported.");
+}
+
+absl::StatusOr<bool> MessageSocket::TakeMessage(std::string* message) {
+  return false;
+}
+
+#endif  // MEDIAPIPE_HAS_MESSAGE_SOCKET
+
+}  // namespace mediapipe
@@ -0,0 +1,82 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_MESSAGE_SOCKET_H_
+#define MEDIAPIPE_UTIL_MESSAGE_SOCKET_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace mediapipe {
+
+// A TCP socket exchanging messages, each sent as its uint32 little-endian
+// size followed by its bytes.
+//
+// Sending blocks while the peer doesn't receive, once the kernel buffers are
+// full, which lets a receiver that falls behind hold back the sender.
+//
+// Unimplemented on Windows.
+class MessageSocket {
+ public:
+  // The largest message size.
+  static constexpr size_t kMaxMessageSize = 1 << 30;
+
+  // Returns a socket listening on `port` of all interfaces, or on a free
+  // port if `port` is 0.
+  static absl::StatusOr<std::unique_ptr<MessageSocket>> Listen(int port);
+
+  // Connects to `address`, as "host:port". Returns an Unavailable error if
+  // nothing listens there yet.
+  static absl::StatusOr<std::unique_ptr<MessageSocket>> Connect(
+      const std::string& address);
+
+  ~MessageSocket();
+  MessageSocket(const MessageSocket&) = delete;
+  MessageSocket& operator=(const MessageSocket&) = delete;
+
+  // The local port of the socket.
+  int port() const;
+
+  // Accepts a connection on a listening socket, waiting up to `timeout` for
+  // one. Returns null if there is none.
+  absl::StatusOr<std::unique_ptr<MessageSocket>> Accept(
+      absl::Duration timeout);
+
+  // Sends `message` on a connected socket.
+  absl::Status Send(absl::string_view message);
+
+  // Receives the next message on a connected socket into `message`, waiting
+  // up to `timeout` for it. Returns false if it didn't arrive in time, and
+  // an OutOfRange error if the peer closed the connection.
+  absl::StatusOr<bool> Receive(absl::Duration timeout, std::string* message);
+
+ private:
+  explicit MessageSocket(int fd);
+
+  // Moves the next message out of buffer_, if it was received completely.
+  absl::StatusOr<bool> TakeMessage(std::string* message);
+
+  const int fd_;
+  // The bytes received after the last message returned.
+  std::string buffer_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_MESSAGE_SOCKET_H_
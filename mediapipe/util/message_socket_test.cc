@@ -0,0 +1,96 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/message_socket.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(MessageSocketTest, ExchangesMessages) {
+  MP_ASSERT_OK_AND_ASSIGN(auto listener, MessageSocket::Listen(0));
+  ASSERT_GT(listener->port(), 0);
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto client,
+      MessageSocket::Connect(absl::StrCat("localhost:", listener->port())));
+  MP_ASSERT_OK_AND_ASSIGN(auto server, listener->Accept(absl::Seconds(10)));
+  ASSERT_NE(server, nullptr);
+
+  const std::string large(3 << 20, 'x');
+  std::thread sender([&client, &large] {
+    MP_EXPECT_OK(client->Send("first"));
+    MP_EXPECT_OK(client->Send(""));
+    MP_EXPECT_OK(client->Send(large));
+  });
+  std::string message;
+  for (const std::string& expected : {std::string("first"), std::string(),
+                                      large}) {
+    MP_ASSERT_OK_AND_ASSIGN(bool received,
+                            server->Receive(absl::Seconds(10), &message));
+    EXPECT_TRUE(received);
+    EXPECT_EQ(message, expected);
+  }
+  sender.join();
+
+  MP_ASSERT_OK(server->Send("reply"));
+  MP_ASSERT_OK_AND_ASSIGN(bool received,
+                          client->Receive(absl::Seconds(10), &message));
+  EXPECT_TRUE(received);
+  EXPECT_EQ(message, "reply");
+}
+
+TEST(MessageSocketTest, ReceiveTimesOutAndReportsClosing) {
+  MP_ASSERT_OK_AND_ASSIGN(auto listener, MessageSocket::Listen(0));
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto client,
+      MessageSocket::Connect(absl::StrCat("localhost:", listener->port())));
+  MP_ASSERT_OK_AND_ASSIGN(auto server, listener->Accept(absl::Seconds(10)));
+  ASSERT_NE(server, nullptr);
+
+  std::string message;
+  MP_ASSERT_OK_AND_ASSIGN(bool received,
+                          server->Receive(absl::Milliseconds(10), &message));
+  EXPECT_FALSE(received);
+
+  client = nullptr;
+  EXPECT_EQ(server->Receive(absl::Seconds(10), &message).status().code(),
+            absl::StatusCode::kOutOfRange);
+}
+
+TEST(MessageSocketTest, AcceptTimesOutAndConnectFailsWithoutListener) {
+  MP_ASSERT_OK_AND_ASSIGN(auto listener, MessageSocket::Listen(0));
+  MP_ASSERT_OK_AND_ASSIGN(auto server, listener->Accept(absl::Milliseconds(1)));
+  EXPECT_EQ(server, nullptr);
+
+  const int port = listener->port();
+  listener = nullptr;
+  EXPECT_EQ(MessageSocket::Connect(absl::StrCat("localhost:", port))
+                .status()
+                .code(),
+            absl::StatusCode::kUnavailable);
+  EXPECT_EQ(MessageSocket::Connect("localhost").status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,221 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/rect_batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "mediapipe/framework/formats/rect.pb.h"
+
+namespace mediapipe {
+namespace {
+
+template <class R>
+RectBatch PackRectsImpl(const std::vector<R>& rects) {
+  RectBatch batch;
+  batch.Resize(rects.size());
+  for (int i = 0; i < rects.size(); ++i) {
+    batch.x_center[i] = rects[i].x_center();
+    batch.y_center[i] = rects[i].y_center();
+    batch.width[i] = rects[i].width();
+    batch.height[i] = rects[i].height();
+    batch.rotation[i] = rects[i].rotation();
+  }
+  return batch;
+}
+
+}  // namespace
+
+void RectBatch::Resize(int size) {
+  for (auto* values : {&x_center, &y_center, &width, &height, &rotation}) {
+    values->resize(size);
+  }
+}
+
+RectBatch PackRects(const std::vector<NormalizedRect>& rects) {
+  return PackRectsImpl(rects);
+}
+
+RectBatch PackRects(const std::vector<Rect>& rects) {
+  return PackRectsImpl(rects);
+}
+
+void UnpackRects(const RectBatch& batch, std::vector<NormalizedRect>* rects) {
+  rects->resize(batch.size());
+  for (int i = 0; i < batch.size(); ++i) {
+    NormalizedRect& rect = (*rects)[i];
+    rect.set_x_center(batch.x_center[i]);
+    rect.set_y_center(batch.y_center[i]);
+    rect.set_width(batch.width[i]);
+    rect.set_height(batch.height[i]);
+    if (batch.rotation[i] != 0 || rect.has_rotation()) {
+      rect.set_rotation(batch.rotation[i]);
+    }
+  }
+}
+
+void UnpackRects(const RectBatch& batch, std::vector<Rect>* rects) {
+  rects->resize(batch.size());
+  for (int i = 0; i < batch.size(); ++i) {
+    Rect& rect = (*rects)[i];
+    rect.set_x_center(static_cast<int>(batch.x_center[i]));
+    rect.set_y_center(static_cast<int>(batch.y_center[i]));
+    rect.set_width(static_cast<int>(batch.width[i]));
+    rect.set_height(static_cast<int>(batch.height[i]));
+    if (batch.rotation[i] != 0 || rect.has_rotation()) {
+      rect.set_rotation(batch.rotation[i]);
+    }
+  }
+}
+
+void SetRotationsFromPoints(const float* x, const float* y, int num_points,
+                            int start_index, int end_index, float image_width,
+                            float image_height, float target_angle,
+                            RectBatch* rects) {
+  const int size = rects->size();
+  float* rotation = rects->rotation.data();
+  for (int i = 0; i < size; ++i) {
+    const int start = i * num_points + start_index;
+    const int end = i * num_points + end_index;
+    rotation[i] = RotationFromPoints(
+        x[start] * image_width, y[start] * image_height, x[end] * image_width,
+        y[end] * image_height, target_angle);
+  }
+}
+
+void ComputePointBounds(const float* x, const float* y, int num_points,
+                        int num_sets, float* xmin, float* ymin, float* xmax,
+                        float* ymax) {
+  std::fill(xmin, xmin + num_sets, std::numeric_limits<float>::max());
+  std::fill(ymin, ymin + num_sets, std::numeric_limits<float>::max());
+  std::fill(xmax, xmax + num_sets, std::numeric_limits<float>::lowest());
+  std::fill(ymax, ymax + num_sets, std::numeric_limits<float>::lowest());
+  for (int i = 0; i < num_sets; ++i) {
+    const float* set_x = x + i * num_points;
+    const float* set_y = y + i * num_points;
+    for (int j = 0; j < num_points; ++j) {
+      xmin[i] = std::min(xmin[i], set_x[j]);
+      ymin[i] = std::min(ymin[i], set_y[j]);
+      xmax[i] = std::max(xmax[i], set_x[j]);
+      ymax[i] = std::max(ymax[i], set_y[j]);
+    }
+  }
+}
+
+void SetRectsFromPointBounds(const float* x, const float* y, int num_points,
+                             RectBatch* rects) {
+  const int size = rects->size();
+  std::vector<float> xmin(size), ymin(size), xmax(size), ymax(size);
+  ComputePointBounds(x, y, num_points, size, xmin.data(), ymin.data(),
+                     xmax.data(), ymax.data());
+  for (int i = 0; i < size; ++i) {
+    rects->x_center[i] = (xmin[i] + xmax[i]) / 2;
+    rects->y_center[i] = (ymin[i] + ymax[i]) / 2;
+    rects->width[i] = xmax[i] - xmin[i];
+    rects->height[i] = ymax[i] - ymin[i];
+  }
+}
+
+void SetRectsFromAlignmentPoints(const float* x, const float* y,
+                                 int num_points, int center_index,
+                                 int scale_index, float image_width,
+                                 float image_height, RectBatch* rects) {
+  const int size = rects->size();
+  for (int i = 0; i < size; ++i) {
+    const int center = i * num_points + center_index;
+    const int scale = i * num_points + scale_index;
+    const float x_center = x[center] * image_width;
+    const float y_center = y[center] * image_height;
+    const float x_scale = x[scale] * image_width;
+    const float y_scale = y[scale] * image_height;
+    // The side is twice the distance from the center to the scale point.
+    const float box_size =
+        std::sqrt((x_scale - x_center) * (x_scale - x_center) +
+                  (y_scale - y_center) * (y_scale - y_center)) *
+        2.0f;
+    rects->x_center[i] = x_center / image_width;
+    rects->y_center[i] = y_center / image_height;
+    rects->width[i] = box_size / image_width;
+    rects->height[i] = box_size / image_height;
+  }
+}
+
+void TransformRects(const RectTransform& transform, float image_width,
+                    float image_height, RectBatch* rects) {
+  const int size = rects->size();
+  float* x_center = rects->x_center.data();
+  float* y_center = rects->y_center.data();
+  float* width = rects->width.data();
+  float* height = rects->height.data();
+
+  for (int i = 0; i < size; ++i) {
+    const float rotation =
+        transform.rotate
+            ? NormalizeRadians(rects->rotation[i] + transform.rotation)
+            : rects->rotation[i];
+    // Unrotated rects are shifted without going through pixels, which would
+    // round differently.
+    if (rotation == 0.f) {
+      x_center[i] += width[i] * transform.shift_x;
+      y_center[i] += height[i] * transform.shift_y;
+    } else {
+      const float cos = std::cos(rotation);
+      const float sin = std::sin(rotation);
+      x_center[i] += (image_width * width[i] * transform.shift_x * cos -
+                      image_height * height[i] * transform.shift_y * sin) /
+                     image_width;
+      y_center[i] += (image_width * width[i] * transform.shift_x * sin +
+                      image_height * height[i] * transform.shift_y * cos) /
+                     image_height;
+    }
+  }
+  if (transform.square != RectTransform::Square::kNone) {
+    const bool square_long = transform.square == RectTransform::Square::kLong;
+    for (int i = 0; i < size; ++i) {
+      const float side =
+          square_long
+              ? std::max(width[i] * image_width, height[i] * image_height)
+              : std::min(width[i] * image_width, height[i] * image_height);
+      width[i] = side / image_width;
+      height[i] = side / image_height;
+    }
+  }
+  for (int i = 0; i < size; ++i) {
+    width[i] *= transform.scale_x;
+    height[i] *= transform.scale_y;
+  }
+}
+
+void ProjectRects(const NormalizedRect& reference, RectBatch* rects) {
+  const int size = rects->size();
+  const float angle = reference.rotation();
+  const float cos = std::cos(angle);
+  const float sin = std::sin(angle);
+  for (int i = 0; i < size; ++i) {
+    const float x = rects->x_center[i] - 0.5f;
+    const float y = rects->y_center[i] - 0.5f;
+    rects->x_center[i] = (cos * x - sin * y) * reference.width() +
+                         reference.x_center();
+    rects->y_center[i] = (sin * x + cos * y) * reference.height() +
+                         reference.y_center();
+    rects->width[i] *= reference.width();
+    rects->height[i] *= reference.height();
+    rects->rotation[i] += reference.rotation();
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,129 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_RECT_BATCH_H_
+#define MEDIAPIPE_UTIL_RECT_BATCH_H_
+
+#include <cmath>
+#include <vector>
+
+#include "mediapipe/framework/formats/rect.pb.h"
+
+namespace mediapipe {
+
+// Rotated rects in structure-of-arrays layout, and the geometry that the
+// detection-to-ROI calculators apply to them.
+//
+// The operations are loops over contiguous arrays, so that compilers vectorize
+// them, and are shared by the calculators so that they agree to the bit. The
+// rects of a graph usually stay NormalizedRect protos between calculators;
+// they are packed into a batch for the computation only.
+struct RectBatch {
+  // Centers, sizes and counterclockwise rotations in radians of the rects.
+  // All of them have size() elements.
+  std::vector<float> x_center;
+  std::vector<float> y_center;
+  std::vector<float> width;
+  std::vector<float> height;
+  std::vector<float> rotation;
+
+  int size() const { return x_center.size(); }
+  bool empty() const { return x_center.empty(); }
+
+  // Resizes the arrays to `size` rects.
+  void Resize(int size);
+};
+
+// Conversions from and to rect protos. Unpacking keeps the other fields of
+// existing rects, and leaves zero rotations unset unless they were set.
+// Absolute rects are truncated to integers, like when setting their fields.
+RectBatch PackRects(const std::vector<NormalizedRect>& rects);
+RectBatch PackRects(const std::vector<Rect>& rects);
+void UnpackRects(const RectBatch& batch, std::vector<NormalizedRect>* rects);
+void UnpackRects(const RectBatch& batch, std::vector<Rect>* rects);
+
+// Wraps around an angle in radians to within -M_PI and M_PI.
+inline float NormalizeRadians(float angle) {
+  return angle - 2 * M_PI * std::floor((angle - (-M_PI)) / (2 * M_PI));
+}
+
+// Returns the rotation that turns the vector from (x0, y0) to (x1, y1), in
+// pixels, to `target_angle`. The y axis points down.
+inline float RotationFromPoints(float x0, float y0, float x1, float y1,
+                                float target_angle) {
+  return NormalizeRadians(target_angle - std::atan2(-(y1 - y0), x1 - x0));
+}
+
+// Sets the rotation of each rect from its points: `num_points` points of
+// relative coordinates `x` and `y` per rect, those of rect i at
+// [i * num_points, (i + 1) * num_points). The rotation turns the vector from
+// point `start_index` to point `end_index` to `target_angle`, in an image of
+// the given size.
+void SetRotationsFromPoints(const float* x, const float* y, int num_points,
+                            int start_index, int end_index, float image_width,
+                            float image_height, float target_angle,
+                            RectBatch* rects);
+
+// Computes the bounds of each set of `num_points` points of coordinates `x`
+// and `y`, for `num_sets` sets laid out like in SetRotationsFromPoints.
+void ComputePointBounds(const float* x, const float* y, int num_points,
+                        int num_sets, float* xmin, float* ymin, float* xmax,
+                        float* ymax);
+
+// Sets each rect to the unrotated bounds of its points, laid out like in
+// SetRotationsFromPoints. Rotations are left unchanged.
+void SetRectsFromPointBounds(const float* x, const float* y, int num_points,
+                             RectBatch* rects);
+
+// Sets each rect to the square centered on point `center_index` of its points,
+// with a side of twice the distance to point `scale_index`, in an image of the
+// given size. Points are laid out like in SetRotationsFromPoints. Rotations
+// are left unchanged.
+void SetRectsFromAlignmentPoints(const float* x, const float* y,
+                                 int num_points, int center_index,
+                                 int scale_index, float image_width,
+                                 float image_height, RectBatch* rects);
+
+// A transformation of rects in their own frame, as done by
+// RectTransformationCalculator.
+struct RectTransform {
+  enum class Square { kNone, kLong, kShort };
+
+  // Whether to add `rotation`, counterclockwise in radians, to the rotations
+  // of the rects when orienting the shift. Like in the calculator, the
+  // rotations of the rects are left unchanged.
+  bool rotate = false;
+  double rotation = 0;
+  // Shift along the sides of the rotated rects, relative to their lengths.
+  float shift_x = 0;
+  float shift_y = 0;
+  // Turns the rects into squares of their long or short side.
+  Square square = Square::kNone;
+  // Scale of the sides, after squaring.
+  float scale_x = 1;
+  float scale_y = 1;
+};
+
+// Applies `transform` to normalized rects in an image of the given size. For
+// absolute rects, the image size is 1 x 1.
+void TransformRects(const RectTransform& transform, float image_width,
+                    float image_height, RectBatch* rects);
+
+// Projects rects defined in the coordinate system of `reference`, a
+// normalized rect, to the coordinate system in which `reference` is defined.
+void ProjectRects(const NormalizedRect& reference, RectBatch* rects);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_RECT_BATCH_H_
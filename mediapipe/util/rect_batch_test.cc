@@ -0,0 +1,167 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/rect_batch.h"
+
+#include <cmath>
+#include <vector>
+
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatNear;
+
+constexpr float kEpsilon = 1e-5f;
+
+RectBatch MakeBatch(float x_center, float y_center, float width, float height,
+                    float rotation) {
+  RectBatch batch;
+  batch.x_center = {x_center};
+  batch.y_center = {y_center};
+  batch.width = {width};
+  batch.height = {height};
+  batch.rotation = {rotation};
+  return batch;
+}
+
+TEST(RectBatchTest, PacksAndUnpacksRects) {
+  std::vector<NormalizedRect> rects(2);
+  rects[0].set_x_center(0.25f);
+  rects[0].set_height(0.5f);
+  rects[1].set_width(0.75f);
+  rects[1].set_rotation(1.f);
+  const RectBatch batch = PackRects(rects);
+  EXPECT_THAT(batch.x_center, ElementsAre(0.25f, 0.f));
+  EXPECT_THAT(batch.height, ElementsAre(0.5f, 0.f));
+  EXPECT_THAT(batch.width, ElementsAre(0.f, 0.75f));
+  EXPECT_THAT(batch.rotation, ElementsAre(0.f, 1.f));
+
+  std::vector<NormalizedRect> unpacked;
+  UnpackRects(batch, &unpacked);
+  ASSERT_EQ(unpacked.size(), 2);
+  EXPECT_EQ(unpacked[0].x_center(), 0.25f);
+  EXPECT_EQ(unpacked[1].rotation(), 1.f);
+
+  std::vector<Rect> absolute;
+  UnpackRects(MakeBatch(10.7f, 20.2f, 30.5f, 40.f, 0.5f), &absolute);
+  ASSERT_EQ(absolute.size(), 1);
+  EXPECT_EQ(absolute[0].x_center(), 10);
+  EXPECT_EQ(absolute[0].y_center(), 20);
+  EXPECT_EQ(absolute[0].width(), 30);
+  EXPECT_EQ(absolute[0].height(), 40);
+  EXPECT_EQ(absolute[0].rotation(), 0.5f);
+}
+
+TEST(RectBatchTest, SetsRotationsFromPoints) {
+  // Two rects with three points each, rotated with points 0 and 2.
+  const std::vector<float> x = {0.1f, 0.f, 0.1f, 0.5f, 0.f, 0.6f};
+  const std::vector<float> y = {0.2f, 0.f, 0.1f, 0.5f, 0.f, 0.5f};
+  RectBatch rects;
+  rects.Resize(2);
+  SetRotationsFromPoints(x.data(), y.data(), /*num_points=*/3,
+                         /*start_index=*/0, /*end_index=*/2,
+                         /*image_width=*/100, /*image_height=*/100,
+                         /*target_angle=*/M_PI / 2, &rects);
+  // The first vector points up, the second one to the right.
+  EXPECT_THAT(rects.rotation, ElementsAre(FloatNear(0, kEpsilon),
+                                          FloatNear(M_PI / 2, kEpsilon)));
+}
+
+TEST(RectBatchTest, SetsRectsFromPointBounds) {
+  const std::vector<float> x = {-0.2f, -0.4f, 0.5f, 0.9f};
+  const std::vector<float> y = {-0.1f, -0.3f, 0.2f, 0.4f};
+  RectBatch rects;
+  rects.Resize(2);
+  SetRectsFromPointBounds(x.data(), y.data(), /*num_points=*/2, &rects);
+  EXPECT_THAT(rects.x_center, ElementsAre(FloatNear(-0.3f, kEpsilon),
+                                          FloatNear(0.7f, kEpsilon)));
+  EXPECT_THAT(rects.y_center, ElementsAre(FloatNear(-0.2f, kEpsilon),
+                                          FloatNear(0.3f, kEpsilon)));
+  EXPECT_THAT(rects.width, ElementsAre(FloatNear(0.2f, kEpsilon),
+                                       FloatNear(0.4f, kEpsilon)));
+  EXPECT_THAT(rects.height, ElementsAre(FloatNear(0.2f, kEpsilon),
+                                        FloatNear(0.2f, kEpsilon)));
+}
+
+TEST(RectBatchTest, SetsRectsFromAlignmentPoints) {
+  const std::vector<float> x = {0.5f, 0.5f};
+  const std::vector<float> y = {0.5f, 0.6f};
+  RectBatch rects;
+  rects.Resize(1);
+  SetRectsFromAlignmentPoints(x.data(), y.data(), /*num_points=*/2,
+                              /*center_index=*/0, /*scale_index=*/1,
+                              /*image_width=*/200, /*image_height=*/100,
+                              &rects);
+  EXPECT_THAT(rects.x_center, ElementsAre(FloatNear(0.5f, kEpsilon)));
+  EXPECT_THAT(rects.y_center, ElementsAre(FloatNear(0.5f, kEpsilon)));
+  EXPECT_THAT(rects.width, ElementsAre(FloatNear(0.1f, kEpsilon)));
+  EXPECT_THAT(rects.height, ElementsAre(FloatNear(0.2f, kEpsilon)));
+}
+
+TEST(RectBatchTest, TransformsRects) {
+  RectTransform transform;
+  transform.rotate = true;
+  transform.rotation = M_PI / 2;
+  transform.shift_x = 0.5f;
+  transform.square = RectTransform::Square::kLong;
+  transform.scale_x = 2;
+  RectBatch rects = MakeBatch(0.5f, 0.5f, 0.2f, 0.1f, 0);
+  TransformRects(transform, /*image_width=*/100, /*image_height=*/200,
+                 &rects);
+  // The shift along the rotated x axis of 10 pixels moves the center down.
+  EXPECT_THAT(rects.x_center, ElementsAre(FloatNear(0.5f, kEpsilon)));
+  EXPECT_THAT(rects.y_center, ElementsAre(FloatNear(0.55f, kEpsilon)));
+  EXPECT_THAT(rects.width, ElementsAre(FloatNear(0.4f, kEpsilon)));
+  EXPECT_THAT(rects.height, ElementsAre(FloatNear(0.1f, kEpsilon)));
+  EXPECT_THAT(rects.rotation, ElementsAre(0.f));
+}
+
+TEST(RectBatchTest, ShiftsAlongRotatedSides) {
+  RectTransform transform;
+  transform.rotate = true;
+  transform.rotation = M_PI;
+  transform.shift_y = 1;
+  RectBatch rects = MakeBatch(0.5f, 0.5f, 0.2f, 0.1f, M_PI / 2);
+  TransformRects(transform, /*image_width=*/1, /*image_height=*/1, &rects);
+  // The shift is oriented by a rotation of -M_PI / 2, which is left out of
+  // the rects.
+  EXPECT_THAT(rects.x_center, ElementsAre(FloatNear(0.6f, kEpsilon)));
+  EXPECT_THAT(rects.y_center, ElementsAre(FloatNear(0.5f, kEpsilon)));
+  EXPECT_THAT(rects.rotation, ElementsAre(FloatNear(M_PI / 2, kEpsilon)));
+}
+
+TEST(RectBatchTest, ProjectsRects) {
+  NormalizedRect reference;
+  reference.set_x_center(0.5f);
+  reference.set_y_center(0.5f);
+  reference.set_width(0.5f);
+  reference.set_height(0.5f);
+  reference.set_rotation(M_PI / 2);
+  RectBatch rects = MakeBatch(1.f, 0.5f, 0.2f, 0.4f, 0.1f);
+  ProjectRects(reference, &rects);
+  EXPECT_THAT(rects.x_center, ElementsAre(FloatNear(0.5f, kEpsilon)));
+  EXPECT_THAT(rects.y_center, ElementsAre(FloatNear(0.75f, kEpsilon)));
+  EXPECT_THAT(rects.width, ElementsAre(FloatNear(0.1f, kEpsilon)));
+  EXPECT_THAT(rects.height, ElementsAre(FloatNear(0.2f, kEpsilon)));
+  EXPECT_THAT(rects.rotation,
+              ElementsAre(FloatNear(0.1f + M_PI / 2, kEpsilon)));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -14,7 +14,11 @@
 
 #include "mediapipe/util/rectangle_util.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/rectangle.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/statusor.h"
@@ -70,4 +74,86 @@ float CalculateIou(const Rectangle_f& rect1, const Rectangle_f& rect2) {
   return normalization > 0.0f ? intersection_area / normalization : 0.0f;
 }
 
+namespace {
+
+// Rectangles covering more cells are tested linearly.
+constexpr int kMaxCellsPerRectangle = 64;
+// Keeps far away coordinates within int range; they share the border cells.
+constexpr float kMaxCell = 1 << 20;
+
+int ToCell(float coordinate, float cell_size) {
+  return static_cast<int>(
+      std::clamp(std::floor(coordinate / cell_size), -kMaxCell, kMaxCell));
+}
+
+}  // namespace
+
+bool RectangleIndex::GetCellRange(const Rectangle_f& rect,
+                                  CellRange* range) const {
+  if (!std::isfinite(rect.xmin()) || !std::isfinite(rect.xmax()) ||
+      !std::isfinite(rect.ymin()) || !std::isfinite(rect.ymax())) {
+    return false;
+  }
+  range->x_begin = ToCell(rect.xmin(), cell_size_);
+  range->x_end = ToCell(rect.xmax(), cell_size_) + 1;
+  range->y_begin = ToCell(rect.ymin(), cell_size_);
+  range->y_end = ToCell(rect.ymax(), cell_size_) + 1;
+  const int64 num_cells =
+      static_cast<int64>(range->x_end - range->x_begin) *
+      (range->y_end - range->y_begin);
+  return num_cells <= kMaxCellsPerRectangle;
+}
+
+void RectangleIndex::Insert(int id, const Rectangle_f& rect) {
+  const int entry = entries_.size();
+  entries_.emplace_back(id, rect);
+  if (rect.IsEmpty()) return;
+  CellRange range;
+  if (!GetCellRange(rect, &range)) {
+    large_entries_.push_back(entry);
+    return;
+  }
+  for (int y = range.y_begin; y < range.y_end; ++y) {
+    for (int x = range.x_begin; x < range.x_end; ++x) {
+      cells_[{x, y}].push_back(entry);
+    }
+  }
+}
+
+std::vector<int> RectangleIndex::Query(const Rectangle_f& rect) const {
+  std::vector<int> ids;
+  if (rect.IsEmpty()) return ids;
+  CellRange range;
+  if (!GetCellRange(rect, &range)) {
+    for (const auto& [id, indexed_rect] : entries_) {
+      if (rect.Intersects(indexed_rect)) ids.push_back(id);
+    }
+    return ids;
+  }
+  std::vector<int> candidates = large_entries_;
+  for (int y = range.y_begin; y < range.y_end; ++y) {
+    for (int x = range.x_begin; x < range.x_end; ++x) {
+      auto it = cells_.find({x, y});
+      if (it == cells_.end()) continue;
+      candidates.insert(candidates.end(), it->second.begin(),
+                        it->second.end());
+    }
+  }
+  // An entry is listed once per shared cell.
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+  for (int entry : candidates) {
+    const auto& [id, indexed_rect] = entries_[entry];
+    if (rect.Intersects(indexed_rect)) ids.push_back(id);
+  }
+  return ids;
+}
+
+void RectangleIndex::Clear() {
+  entries_.clear();
+  cells_.clear();
+  large_entries_.clear();
+}
+
 }  // namespace mediapipe
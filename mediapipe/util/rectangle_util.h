@@ -15,6 +15,10 @@
 #ifndef MEDIAPIPE_RECTANGLE_UTIL_H_
 #define MEDIAPIPE_RECTANGLE_UTIL_H_
 
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "mediapipe/framework/formats/rect.pb.h"
@@ -35,6 +39,51 @@ absl::StatusOr<bool> DoesRectOverlap(
 // Computes the Intersection over Union (IoU) between two rectangles.
 float CalculateIou(const Rectangle_f& rect1, const Rectangle_f& rect2);
 
+// Indexes rectangles in a uniform grid, so that the rectangles intersecting a
+// query rectangle are found without testing all of them. Rectangles with a
+// positive IoU intersect, so association and deduplication of n rectangles
+// need O(n) IoU computations on sparse scenes instead of O(n^2).
+//
+//   RectangleIndex index;
+//   for (int i = 0; i < rects.size(); ++i) {
+//     for (int j : index.Query(rects[i])) {
+//       if (CalculateIou(rects[i], rects[j]) > threshold) ...
+//     }
+//     index.Insert(i, rects[i]);
+//   }
+class RectangleIndex {
+ public:
+  // `cell_size` is the side of the grid cells, in the units of the
+  // rectangles. The default suits normalized coordinates.
+  explicit RectangleIndex(float cell_size = 0.1f) : cell_size_(cell_size) {}
+
+  // Adds a rectangle with a caller-defined id.
+  void Insert(int id, const Rectangle_f& rect);
+
+  // Returns the ids of the rectangles intersecting `rect`, in the order they
+  // were inserted.
+  std::vector<int> Query(const Rectangle_f& rect) const;
+
+  int size() const { return entries_.size(); }
+
+  void Clear();
+
+ private:
+  struct CellRange {
+    int x_begin, x_end, y_begin, y_end;
+  };
+
+  // Returns false if the rectangle covers too many cells to be indexed.
+  bool GetCellRange(const Rectangle_f& rect, CellRange* range) const;
+
+  const float cell_size_;
+  std::vector<std::pair<int, Rectangle_f>> entries_;
+  // Maps grid cells to the entries overlapping them.
+  absl::flat_hash_map<std::pair<int, int>, std::vector<int>> cells_;
+  // Entries too large for the grid, tested by every query.
+  std::vector<int> large_entries_;
+};
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_RECTANGLE_UTIL_H_
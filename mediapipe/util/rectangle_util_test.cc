@@ -14,13 +14,18 @@
 
 #include "mediapipe/util/rectangle_util.h"
 
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/status_matchers.h"
 
 namespace mediapipe {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::FloatNear;
+using ::testing::IsEmpty;
 
 class RectangleUtilTest : public testing::Test {
  protected:
@@ -176,5 +181,36 @@ TEST_F(RectangleUtilTest, NormRectToRectangleFail) {
   EXPECT_THAT(ToRectangle(invalid_nr), testing::Not(IsOk()));
 }
 
+TEST_F(RectangleUtilTest, RectangleIndexQueriesIntersectingRects) {
+  const std::vector<NormalizedRect> rects = {nr_0, nr_1, nr_2,
+                                             nr_3, nr_4, nr_5};
+  RectangleIndex index;
+  for (int i = 0; i < rects.size(); ++i) {
+    MP_ASSERT_OK_AND_ASSIGN(Rectangle_f rect, ToRectangle(rects[i]));
+    index.Insert(i, rect);
+  }
+  EXPECT_EQ(index.size(), 6);
+
+  MP_ASSERT_OK_AND_ASSIGN(Rectangle_f rect_3, ToRectangle(nr_3));
+  EXPECT_THAT(index.Query(rect_3), ElementsAre(0, 1, 3, 5));
+  MP_ASSERT_OK_AND_ASSIGN(Rectangle_f rect_4, ToRectangle(nr_4));
+  EXPECT_THAT(index.Query(rect_4), ElementsAre(2, 4));
+  EXPECT_THAT(index.Query(Rectangle_f(0.6, 0.6, 0.1, 0.1)), IsEmpty());
+
+  index.Clear();
+  EXPECT_THAT(index.Query(rect_3), IsEmpty());
+}
+
+TEST(RectangleIndexTest, QueriesRectsLargerThanTheGrid) {
+  RectangleIndex index(/*cell_size=*/0.01f);
+  index.Insert(7, Rectangle_f(0.0, 0.0, 1.0, 1.0));
+  index.Insert(3, Rectangle_f(0.5, 0.5, 0.01, 0.01));
+  index.Insert(5, Rectangle_f(2.0, 2.0, 0.01, 0.01));
+  EXPECT_THAT(index.Query(Rectangle_f(0.5, 0.5, 0.001, 0.001)),
+              ElementsAre(7, 3));
+  EXPECT_THAT(index.Query(Rectangle_f(-10.0, -10.0, 20.0, 20.0)),
+              ElementsAre(7, 3, 5));
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -0,0 +1,190 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/render_commands.h"
+
+#include <algorithm>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+using Shape = RenderCommands::Shape;
+
+void SetColor(const RenderCommands::Rgb& rgb, Color* color) {
+  color->set_r(rgb.r);
+  color->set_g(rgb.g);
+  color->set_b(rgb.b);
+}
+
+void SetRectangle(const RenderCommands::Command& command, bool normalized,
+                  RenderAnnotation::Rectangle* rectangle) {
+  rectangle->set_left(command.x0);
+  rectangle->set_top(command.y0);
+  rectangle->set_right(command.x1);
+  rectangle->set_bottom(command.y1);
+  rectangle->set_normalized(normalized);
+  if (command.rotation != 0.f) rectangle->set_rotation(command.rotation);
+}
+
+}  // namespace
+
+void RenderCommands::SetStyle(const Style& style) {
+  if (!styles_.empty() && styles_.back() == style) return;
+  styles_.push_back(style);
+}
+
+void RenderCommands::Add(Shape shape, float x0, float y0, float x1, float y1,
+                         float rotation, uint32_t text) {
+  CHECK(!styles_.empty()) << "SetStyle() must be called before adding "
+                             "commands.";
+  commands_.push_back({shape, static_cast<uint32_t>(styles_.size() - 1), x0,
+                       y0, x1, y1, rotation, text});
+}
+
+void RenderCommands::AddPoint(float x, float y) {
+  Add(Shape::kPoint, x, y, x, y);
+}
+
+void RenderCommands::AddLine(float x_start, float y_start, float x_end,
+                             float y_end) {
+  Add(Shape::kLine, x_start, y_start, x_end, y_end);
+}
+
+void RenderCommands::AddGradientLine(float x_start, float y_start,
+                                     float x_end, float y_end) {
+  Add(Shape::kGradientLine, x_start, y_start, x_end, y_end);
+}
+
+void RenderCommands::AddRectangle(float left, float top, float right,
+                                  float bottom, float rotation, bool filled) {
+  Add(filled ? Shape::kFilledRectangle : Shape::kRectangle, left, top, right,
+      bottom, rotation);
+}
+
+void RenderCommands::AddOval(float left, float top, float right, float bottom,
+                             float rotation, bool filled) {
+  Add(filled ? Shape::kFilledOval : Shape::kOval, left, top, right, bottom,
+      rotation);
+}
+
+void RenderCommands::AddText(Text text, float left, float baseline) {
+  texts_.push_back(std::move(text));
+  Add(Shape::kText, left, baseline, left, baseline, 0.f,
+      static_cast<uint32_t>(texts_.size() - 1));
+}
+
+RenderCommands::Rgb ToRgb(const Color& color) {
+  return {static_cast<uint8_t>(std::clamp(color.r(), 0, 255)),
+          static_cast<uint8_t>(std::clamp(color.g(), 0, 255)),
+          static_cast<uint8_t>(std::clamp(color.b(), 0, 255))};
+}
+
+RenderCommands::Text ToRenderCommandsText(const RenderAnnotation::Text& text) {
+  RenderCommands::Text result;
+  result.display_text = text.display_text();
+  result.font_height = text.font_height();
+  result.font_face = text.font_face();
+  result.center_horizontally = text.center_horizontally();
+  result.center_vertically = text.center_vertically();
+  result.outline_thickness = text.outline_thickness();
+  result.outline_color = ToRgb(text.outline_color());
+  return result;
+}
+
+void AppendToRenderData(const RenderCommands& commands,
+                        RenderData* render_data) {
+  if (!commands.scene_class().empty()) {
+    render_data->set_scene_class(commands.scene_class());
+  }
+  for (const RenderCommands::Command& command : commands.commands()) {
+    const RenderCommands::Style& style = commands.style(command);
+    RenderAnnotation* annotation = render_data->add_render_annotations();
+    SetColor(style.color, annotation->mutable_color());
+    annotation->set_thickness(style.thickness);
+    switch (command.shape) {
+      case Shape::kPoint: {
+        auto* point = annotation->mutable_point();
+        point->set_x(command.x0);
+        point->set_y(command.y0);
+        point->set_normalized(style.normalized);
+        break;
+      }
+      case Shape::kLine: {
+        auto* line = annotation->mutable_line();
+        line->set_x_start(command.x0);
+        line->set_y_start(command.y0);
+        line->set_x_end(command.x1);
+        line->set_y_end(command.y1);
+        line->set_normalized(style.normalized);
+        break;
+      }
+      case Shape::kGradientLine: {
+        auto* line = annotation->mutable_gradient_line();
+        line->set_x_start(command.x0);
+        line->set_y_start(command.y0);
+        line->set_x_end(command.x1);
+        line->set_y_end(command.y1);
+        line->set_normalized(style.normalized);
+        SetColor(style.color, line->mutable_color1());
+        SetColor(style.color2, line->mutable_color2());
+        break;
+      }
+      case Shape::kRectangle:
+        SetRectangle(command, style.normalized,
+                     annotation->mutable_rectangle());
+        break;
+      case Shape::kFilledRectangle: {
+        auto* filled_rectangle = annotation->mutable_filled_rectangle();
+        SetRectangle(command, style.normalized,
+                     filled_rectangle->mutable_rectangle());
+        SetColor(style.color, filled_rectangle->mutable_fill_color());
+        break;
+      }
+      case Shape::kOval:
+        SetRectangle(command, style.normalized,
+                     annotation->mutable_oval()->mutable_rectangle());
+        break;
+      case Shape::kFilledOval: {
+        auto* filled_oval = annotation->mutable_filled_oval();
+        SetRectangle(command, style.normalized,
+                     filled_oval->mutable_oval()->mutable_rectangle());
+        SetColor(style.color, filled_oval->mutable_fill_color());
+        break;
+      }
+      case Shape::kText: {
+        const RenderCommands::Text& text = commands.texts()[command.text];
+        auto* annotation_text = annotation->mutable_text();
+        annotation_text->set_display_text(text.display_text);
+        annotation_text->set_left(command.x0);
+        annotation_text->set_baseline(command.y0);
+        annotation_text->set_font_height(text.font_height);
+        annotation_text->set_normalized(style.normalized);
+        annotation_text->set_font_face(text.font_face);
+        annotation_text->set_center_horizontally(text.center_horizontally);
+        annotation_text->set_center_vertically(text.center_vertically);
+        if (text.outline_thickness > 0.f) {
+          annotation_text->set_outline_thickness(text.outline_thickness);
+          SetColor(text.outline_color,
+                   annotation_text->mutable_outline_color());
+        }
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace mediapipe
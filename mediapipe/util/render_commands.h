@@ -0,0 +1,175 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_RENDER_COMMANDS_H_
+#define MEDIAPIPE_UTIL_RENDER_COMMANDS_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/render_data.pb.h"
+
+namespace mediapipe {
+
+// A packed list of drawing commands, the compact counterpart of RenderData for
+// the annotations drawn on every frame, e.g. the hundreds of points and lines
+// of a face mesh.
+//
+// Each command is a small fixed-size struct in a single array, kept in drawing
+// order. The colors, thickness and coordinate space are shared by consecutive
+// commands through a table of styles, and the strings of the texts are kept
+// aside, so that no allocation is made per command. AnnotationRenderer draws
+// the commands directly (see RenderCommandsOnImage), and
+// AppendToRenderData converts them for the consumers of RenderData.
+//
+// Example usage:
+//
+// RenderCommands::Style style;
+// style.color = {255, 0, 0};
+// style.normalized = true;
+//
+// RenderCommands commands;
+// commands.SetStyle(style);
+// commands.AddLine(0.1f, 0.1f, 0.5f, 0.5f);
+// commands.AddPoint(0.5f, 0.5f);
+class RenderCommands {
+ public:
+  struct Rgb {
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+
+    bool operator==(const Rgb& other) const {
+      return r == other.r && g == other.g && b == other.b;
+    }
+    bool operator!=(const Rgb& other) const { return !(*this == other); }
+  };
+
+  struct Style {
+    Rgb color;
+    // The end color of gradient lines.
+    Rgb color2;
+    float thickness = 1.f;
+    // Whether the coordinates are in [0, 1] relative to the image size, or
+    // in pixels.
+    bool normalized = false;
+
+    bool operator==(const Style& other) const {
+      return color == other.color && color2 == other.color2 &&
+             thickness == other.thickness && normalized == other.normalized;
+    }
+  };
+
+  enum class Shape : uint8_t {
+    kPoint,
+    kLine,
+    kGradientLine,
+    kRectangle,
+    kFilledRectangle,
+    kOval,
+    kFilledOval,
+    kText,
+  };
+
+  // A text, with the fields of RenderAnnotation::Text other than its
+  // location.
+  struct Text {
+    std::string display_text;
+    float font_height = 8.f;
+    int font_face = 0;
+    bool center_horizontally = false;
+    bool center_vertically = false;
+    float outline_thickness = 0.f;
+    Rgb outline_color;
+  };
+
+  struct Command {
+    Shape shape;
+    // Index of the style in styles().
+    uint32_t style;
+    // The point in (x0, y0), the ends of lines, the left, top, right and
+    // bottom of rectangles and of the rectangles enclosing ovals, and the
+    // left and baseline of texts.
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+    // The rotation of rectangles and ovals, in radians.
+    float rotation;
+    // Index of the text in texts(), for kText.
+    uint32_t text;
+  };
+
+  // Sets the style of the commands added next. Must be called before adding
+  // the first command.
+  void SetStyle(const Style& style);
+
+  void AddPoint(float x, float y);
+  void AddLine(float x_start, float y_start, float x_end, float y_end);
+  // Draws a line with a color interpolated from the color of the style at
+  // the start to its color2 at the end.
+  void AddGradientLine(float x_start, float y_start, float x_end, float y_end);
+  void AddRectangle(float left, float top, float right, float bottom,
+                    float rotation = 0.f, bool filled = false);
+  // Draws the oval enclosed in the rectangle.
+  void AddOval(float left, float top, float right, float bottom,
+               float rotation = 0.f, bool filled = false);
+  void AddText(Text text, float left, float baseline);
+
+  const std::vector<Command>& commands() const { return commands_; }
+  const std::vector<Style>& styles() const { return styles_; }
+  const std::vector<Text>& texts() const { return texts_; }
+
+  const Style& style(const Command& command) const {
+    return styles_[command.style];
+  }
+
+  bool empty() const { return commands_.empty(); }
+  size_t size() const { return commands_.size(); }
+
+  void Reserve(size_t num_commands) { commands_.reserve(num_commands); }
+
+  // See RenderData::scene_class.
+  const std::string& scene_class() const { return scene_class_; }
+  void set_scene_class(std::string scene_class) {
+    scene_class_ = std::move(scene_class);
+  }
+
+ private:
+  void Add(Shape shape, float x0, float y0, float x1, float y1,
+           float rotation = 0.f, uint32_t text = 0);
+
+  std::vector<Command> commands_;
+  std::vector<Style> styles_;
+  std::vector<Text> texts_;
+  std::string scene_class_;
+};
+
+// Returns the color, saturated to 8 bits per channel.
+RenderCommands::Rgb ToRgb(const Color& color);
+
+// Returns the text, without its location.
+RenderCommands::Text ToRenderCommandsText(const RenderAnnotation::Text& text);
+
+// Appends the commands to "render_data" as render annotations, in order, and
+// sets its scene class if "commands" has one.
+void AppendToRenderData(const RenderCommands& commands,
+                        RenderData* render_data);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_RENDER_COMMANDS_H_
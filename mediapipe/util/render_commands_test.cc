@@ -0,0 +1,143 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/render_commands.h"
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/render_data.pb.h"
+
+namespace mediapipe {
+namespace {
+
+RenderCommands::Style MakeStyle(RenderCommands::Rgb color, float thickness,
+                                bool normalized) {
+  RenderCommands::Style style;
+  style.color = color;
+  style.thickness = thickness;
+  style.normalized = normalized;
+  return style;
+}
+
+TEST(RenderCommandsTest, SharesConsecutiveEqualStyles) {
+  RenderCommands commands;
+  commands.SetStyle(MakeStyle({255, 0, 0}, 2.f, true));
+  commands.AddPoint(0.1f, 0.2f);
+  commands.SetStyle(MakeStyle({255, 0, 0}, 2.f, true));
+  commands.AddPoint(0.3f, 0.4f);
+  commands.SetStyle(MakeStyle({0, 255, 0}, 2.f, true));
+  commands.AddLine(0.1f, 0.2f, 0.3f, 0.4f);
+
+  ASSERT_EQ(commands.size(), 3);
+  EXPECT_EQ(commands.styles().size(), 2);
+  EXPECT_EQ(commands.commands()[0].style, 0);
+  EXPECT_EQ(commands.commands()[1].style, 0);
+  EXPECT_EQ(commands.commands()[2].style, 1);
+  EXPECT_EQ(commands.commands()[2].shape, RenderCommands::Shape::kLine);
+  EXPECT_EQ(commands.style(commands.commands()[2]).color.g, 255);
+}
+
+TEST(RenderCommandsTest, SaturatesColors) {
+  Color color;
+  color.set_r(300);
+  color.set_g(-5);
+  color.set_b(7);
+  const RenderCommands::Rgb rgb = ToRgb(color);
+  EXPECT_EQ(rgb.r, 255);
+  EXPECT_EQ(rgb.g, 0);
+  EXPECT_EQ(rgb.b, 7);
+}
+
+TEST(RenderCommandsTest, AppendsToRenderData) {
+  RenderCommands commands;
+  commands.set_scene_class("scene");
+  RenderCommands::Style style = MakeStyle({1, 2, 3}, 4.f, false);
+  style.color2 = {4, 5, 6};
+  commands.SetStyle(style);
+  commands.AddGradientLine(1.f, 2.f, 3.f, 4.f);
+  commands.AddRectangle(10.f, 20.f, 30.f, 40.f, /*rotation=*/0.5f,
+                        /*filled=*/true);
+  commands.SetStyle(MakeStyle({1, 2, 3}, 1.f, true));
+  RenderCommands::Text text;
+  text.display_text = "label";
+  text.font_height = 0.1f;
+  commands.AddText(text, 0.25f, 0.5f);
+  commands.AddOval(0.f, 0.25f, 0.5f, 0.75f);
+
+  RenderData render_data;
+  AppendToRenderData(commands, &render_data);
+  EXPECT_THAT(render_data, EqualsProto(ParseTextProtoOrDie<RenderData>(R"pb(
+                scene_class: "scene"
+                render_annotations {
+                  color { r: 1 g: 2 b: 3 }
+                  thickness: 4
+                  gradient_line {
+                    x_start: 1
+                    y_start: 2
+                    x_end: 3
+                    y_end: 4
+                    normalized: false
+                    color1 { r: 1 g: 2 b: 3 }
+                    color2 { r: 4 g: 5 b: 6 }
+                  }
+                }
+                render_annotations {
+                  color { r: 1 g: 2 b: 3 }
+                  thickness: 4
+                  filled_rectangle {
+                    rectangle {
+                      left: 10
+                      top: 20
+                      right: 30
+                      bottom: 40
+                      normalized: false
+                      rotation: 0.5
+                    }
+                    fill_color { r: 1 g: 2 b: 3 }
+                  }
+                }
+                render_annotations {
+                  color { r: 1 g: 2 b: 3 }
+                  thickness: 1
+                  text {
+                    display_text: "label"
+                    left: 0.25
+                    baseline: 0.5
+                    font_height: 0.10000000149011612
+                    normalized: true
+                    font_face: 0
+                    center_horizontally: false
+                    center_vertically: false
+                  }
+                }
+                render_annotations {
+                  color { r: 1 g: 2 b: 3 }
+                  thickness: 1
+                  oval {
+                    rectangle {
+                      left: 0
+                      top: 0.25
+                      right: 0.5
+                      bottom: 0.75
+                      normalized: true
+                    }
+                  }
+                }
+              )pb")));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -31,9 +31,13 @@ template <typename Key, typename Value,
           typename KeyHash = typename absl::flat_hash_map<Key, int>::hasher>
 class ResourceCache {
  public:
+  // Counts `request_count_increment` requests for `key`, and returns its
+  // resource. `create` is called if the resource is unset. A value above 1
+  // lets callers report requests they have served on their own.
   Value Lookup(
       const Key& key,
-      absl::FunctionRef<Value(const Key& key, int request_count)> create) {
+      absl::FunctionRef<Value(const Key& key, int request_count)> create,
+      int request_count_increment = 1) {
     auto map_it = map_.find(key);
     Entry* entry;
     if (map_it == map_.end()) {
@@ -41,12 +45,12 @@ class ResourceCache {
           map_.try_emplace(key, std::make_unique<Entry>(key));
       entry = map_it->second.get();
       CHECK_EQ(entry->request_count, 0);
-      entry->request_count = 1;
+      entry->request_count = request_count_increment;
       entry_list_.Append(entry);
       if (entry->prev != nullptr) CHECK_GE(entry->prev->request_count, 1);
     } else {
       entry = map_it->second.get();
-      ++entry->request_count;
+      entry->request_count += request_count_increment;
       Entry* larger = entry->prev;
       while (larger != nullptr &&
              larger->request_count < entry->request_count) {
@@ -60,10 +64,43 @@ class ResourceCache {
     if (!entry->value) {
       entry->value = create(entry->key, entry->request_count);
     }
-    ++total_request_count_;
+    total_request_count_ += request_count_increment;
     return entry->value;
   }
 
+  // Returns true if Evict would currently remove or rescale any entries.
+  bool NeedsEviction(int max_count, int request_count_scrub_interval) const {
+    return entry_list_.size() > max_count ||
+           total_request_count_ >= request_count_scrub_interval;
+  }
+
+  // Returns the number of entries, including those with unset values.
+  size_t size() const { return entry_list_.size(); }
+
+  // Removes the least requested entry, which must exist, and returns its
+  // value. Lets callers evict by a measure of their own, such as bytes.
+  Value EvictLeastRequested() {
+    Entry* victim = entry_list_.tail();
+    CHECK(victim != nullptr);
+    Value value = std::move(victim->value);
+    entry_list_.Remove(victim);
+    map_.erase(victim->key);
+    return value;
+  }
+
+  // Removes all entries and returns their values.
+  std::vector<Value> Clear() {
+    std::vector<Value> evicted;
+    evicted.reserve(entry_list_.size());
+    while (Entry* victim = entry_list_.tail()) {
+      evicted.emplace_back(std::move(victim->value));
+      entry_list_.Remove(victim);
+      map_.erase(victim->key);
+    }
+    total_request_count_ = 0;
+    return evicted;
+  }
+
   std::vector<Value> Evict(int max_count, int request_count_scrub_interval) {
     std::vector<Value> evicted;
 
@@ -164,7 +201,7 @@ class ResourceCache {
 
     Entry* head() { return head_; }
     Entry* tail() { return tail_; }
-    size_t size() { return size_; }
+    size_t size() const { return size_; }
 
    private:
     Entry* head_ = nullptr;
@@ -110,6 +110,28 @@ TEST(ResourceCacheTest, EvictToMaxSize) {
   }
 }
 
+TEST(ResourceCacheTest, EvictLeastRequested) {
+  IntCache cache;
+  MockCreate create;
+
+  EXPECT_CALL(create, Call(_, _))
+      .WillRepeatedly([](int key, int request_count) {
+        return std::make_shared<int>(key);
+      });
+
+  EXPECT_NE(nullptr, cache.Lookup(1, create.AsStdFunction()));
+  EXPECT_NE(nullptr, cache.Lookup(2, create.AsStdFunction()));
+  EXPECT_NE(nullptr, cache.Lookup(2, create.AsStdFunction()));
+  EXPECT_NE(nullptr, cache.Lookup(3, create.AsStdFunction()));
+  EXPECT_NE(nullptr, cache.Lookup(3, create.AsStdFunction()));
+  EXPECT_NE(nullptr, cache.Lookup(3, create.AsStdFunction()));
+  ASSERT_EQ(3, cache.size());
+
+  EXPECT_EQ(1, *cache.EvictLeastRequested());
+  EXPECT_EQ(2, *cache.EvictLeastRequested());
+  EXPECT_EQ(1, cache.size());
+}
+
 TEST(ResourceCacheTest, EvictWithScrub) {
   IntCache cache;
   MockCreate create;
@@ -146,5 +168,26 @@ TEST(ResourceCacheTest, EvictWithScrub) {
   EXPECT_EQ(1, *evicted[0]);
 }
 
+TEST(ResourceCacheTest, CountsRequestIncrements) {
+  IntCache cache;
+  MockCreate create;
+
+  EXPECT_CALL(create, Call(1, 3)).WillOnce(Return(nullptr));
+  EXPECT_CALL(create, Call(1, 8)).WillOnce(Return(nullptr));
+
+  EXPECT_EQ(nullptr, cache.Lookup(1, create.AsStdFunction(),
+                                  /*request_count_increment=*/3));
+  EXPECT_FALSE(
+      cache.NeedsEviction(/*max_count=*/1, /*request_count_scrub_interval=*/4));
+  EXPECT_EQ(nullptr, cache.Lookup(1, create.AsStdFunction(),
+                                  /*request_count_increment=*/5));
+  EXPECT_TRUE(
+      cache.NeedsEviction(/*max_count=*/1, /*request_count_scrub_interval=*/4));
+  EXPECT_TRUE(cache.Evict(/*max_count=*/1, /*request_count_scrub_interval=*/4)
+                  .empty());
+  EXPECT_FALSE(
+      cache.NeedsEviction(/*max_count=*/1, /*request_count_scrub_interval=*/4));
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -15,6 +15,9 @@
 #include "mediapipe/util/resource_util.h"
 
 #include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
 
 #include "absl/strings/str_split.h"
 #include "mediapipe/framework/deps/file_path.h"
@@ -27,6 +30,17 @@ namespace mediapipe {
 
 namespace {
 ResourceProviderFn resource_provider_ = nullptr;
+
+class StringResource : public Resource {
+ public:
+  explicit StringResource(std::string contents)
+      : contents_(std::move(contents)) {}
+
+  absl::string_view data() const override { return contents_; }
+
+ private:
+  std::string contents_;
+};
 }  // namespace
 
 absl::Status GetResourceContents(const std::string& path, std::string* output,
@@ -37,6 +51,20 @@ absl::Status GetResourceContents(const std::string& path, std::string* output,
   return internal::DefaultGetResourceContents(path, output, read_as_binary);
 }
 
+absl::StatusOr<std::unique_ptr<Resource>> GetResource(
+    const std::string& path) {
+  if (resource_provider_) {
+    std::string contents;
+    MP_RETURN_IF_ERROR(resource_provider_(path, &contents));
+    return MakeStringResource(std::move(contents));
+  }
+  return internal::DefaultGetResource(path);
+}
+
+std::unique_ptr<Resource> MakeStringResource(std::string contents) {
+  return std::make_unique<StringResource>(std::move(contents));
+}
+
 bool HasCustomGlobalResourceProvider() { return resource_provider_ != nullptr; }
 
 void SetCustomGlobalResourceProvider(ResourceProviderFn fn) {
@@ -15,8 +15,10 @@
 #ifndef MEDIAPIPE_UTIL_RESOURCE_UTIL_H_
 #define MEDIAPIPE_UTIL_RESOURCE_UTIL_H_
 
+#include <memory>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe {
@@ -45,6 +47,24 @@ absl::StatusOr<std::string> PathToResourceAsFile(const std::string& path);
 absl::Status GetResourceContents(const std::string& path, std::string* output,
                                  bool read_as_binary = true);
 
+// The contents of a resource, which stay valid as long as the Resource is
+// alive.
+class Resource {
+ public:
+  virtual ~Resource() = default;
+
+  virtual absl::string_view data() const = 0;
+};
+
+// Returns the contents of a resource, without copying them into memory when
+// the platform allows it, e.g. for an uncompressed Android asset, which is
+// memory-mapped from the APK. Otherwise, the contents are read as with
+// GetResourceContents. The search path is as in PathToResourceAsFile.
+absl::StatusOr<std::unique_ptr<Resource>> GetResource(const std::string& path);
+
+// Returns a Resource holding @contents.
+std::unique_ptr<Resource> MakeStringResource(std::string contents);
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_UTIL_RESOURCE_UTIL_H_
@@ -12,15 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <android/asset_manager.h>
+
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/singleton.h"
 #include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/util/android/asset_manager_util.h"
 #include "mediapipe/util/android/file/base/helpers.h"
+#include "mediapipe/util/resource_util.h"
+#include "mediapipe/util/resource_util_internal.h"
 
 namespace mediapipe {
 
@@ -29,6 +37,48 @@ absl::StatusOr<std::string> PathToResourceAsFileInternal(
     const std::string& path) {
   return Singleton<AssetManager>::get()->CachedFileFromAsset(path);
 }
+
+// Returns the path of a resource in the test environment.
+std::string TestPath(const std::string& path) {
+  absl::string_view workspace = "mediapipe";
+  const char* test_srcdir = std::getenv("TEST_SRCDIR");
+  return file::JoinPath(test_srcdir ? test_srcdir : "", workspace, path);
+}
+
+// An asset opened in buffer mode. The buffer of an uncompressed asset is
+// mapped from the APK, and the buffer of a compressed one is the decompressed
+// asset, so neither is copied again.
+class AssetResource : public Resource {
+ public:
+  explicit AssetResource(AAsset* asset) : asset_(asset) {}
+  ~AssetResource() override { AAsset_close(asset_); }
+
+  absl::string_view data() const override {
+    return absl::string_view(static_cast<const char*>(AAsset_getBuffer(asset_)),
+                             AAsset_getLength(asset_));
+  }
+
+ private:
+  AAsset* asset_;
+};
+
+absl::StatusOr<std::unique_ptr<Resource>> GetAssetResource(
+    const std::string& path) {
+  AAssetManager* asset_manager =
+      Singleton<AssetManager>::get()->GetAssetManager();
+  RET_CHECK(asset_manager) << "Asset manager was not initialized from JNI";
+  AAsset* asset =
+      AAssetManager_open(asset_manager, path.c_str(), AASSET_MODE_BUFFER);
+  RET_CHECK(asset) << "could not read asset: " << path;
+  auto resource = std::make_unique<AssetResource>(asset);
+  // Maps or decompresses the asset.
+  RET_CHECK(AAsset_getBuffer(asset)) << "could not read asset: " << path;
+  if (AAsset_isAllocated(asset)) {
+    VLOG(1) << "Asset " << path
+            << " is compressed and was decompressed into memory.";
+  }
+  return resource;
+}
 }  // namespace
 
 namespace internal {
@@ -50,11 +100,7 @@ absl::Status DefaultGetResourceContents(const std::string& path,
   }
 
   // Try the test environment.
-  absl::string_view workspace = "mediapipe";
-  const char* test_srcdir = std::getenv("TEST_SRCDIR");
-  auto test_path =
-      file::JoinPath(test_srcdir ? test_srcdir : "", workspace, path);
-  if (file::Exists(test_path).ok()) {
+  if (file::Exists(TestPath(path)).ok()) {
     return file::GetContents(path, output, file::Defaults());
   }
 
@@ -62,6 +108,19 @@ absl::Status DefaultGetResourceContents(const std::string& path,
       << "could not read asset: " << path;
   return absl::OkStatus();
 }
+
+absl::StatusOr<std::unique_ptr<Resource>> DefaultGetResource(
+    const std::string& path) {
+  // Only assets are accessed without a copy.
+  if (absl::StartsWith(path, "/") || absl::StartsWith(path, "content://") ||
+      file::Exists(TestPath(path)).ok()) {
+    std::string contents;
+    MP_RETURN_IF_ERROR(DefaultGetResourceContents(path, &contents,
+                                                  /*read_as_binary=*/true));
+    return MakeStringResource(std::move(contents));
+  }
+  return GetAssetResource(path);
+}
 }  // namespace internal
 
 absl::StatusOr<std::string> PathToResourceAsFile(const std::string& path) {
@@ -15,13 +15,16 @@
 #import <Foundation/Foundation.h>
 
 #include <fstream>
+#include <memory>
 #include <sstream>
+#include <utility>
 
 #include "absl/strings/match.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/util/resource_util.h"
+#include "mediapipe/util/resource_util_internal.h"
 
 namespace mediapipe {
 
@@ -51,6 +54,14 @@ absl::Status DefaultGetResourceContents(const std::string& path,
   ASSIGN_OR_RETURN(std::string full_path, PathToResourceAsFile(path));
   return file::GetContents(full_path, output, read_as_binary);
 }
+
+absl::StatusOr<std::unique_ptr<Resource>> DefaultGetResource(
+    const std::string& path) {
+  std::string contents;
+  MP_RETURN_IF_ERROR(DefaultGetResourceContents(path, &contents,
+                                                /*read_as_binary=*/true));
+  return MakeStringResource(std::move(contents));
+}
 }  // namespace internal
 
 absl::StatusOr<std::string> PathToResourceAsFile(const std::string& path) {
@@ -13,11 +13,17 @@
 // limitations under the License.
 
 #include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
 
 #include "absl/flags/flag.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/status_macros.h"
 #include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/util/resource_util.h"
+#include "mediapipe/util/resource_util_internal.h"
 
 ABSL_FLAG(
     std::string, resource_root_dir, "",
@@ -36,6 +42,14 @@ absl::Status DefaultGetResourceContents(const std::string& path,
                                         bool read_as_binary) {
   return GetContents(path, output, read_as_binary);
 }
+
+absl::StatusOr<std::unique_ptr<Resource>> DefaultGetResource(
+    const std::string& path) {
+  std::string contents;
+  MP_RETURN_IF_ERROR(DefaultGetResourceContents(path, &contents,
+                                                /*read_as_binary=*/true));
+  return MakeStringResource(std::move(contents));
+}
 }  // namespace internal
 
 absl::StatusOr<std::string> PathToResourceAsFile(const std::string& path) {
@@ -1,9 +1,12 @@
 #ifndef MEDIAPIPE_UTIL_RESOURCE_UTIL_INTERNAL_H_
 #define MEDIAPIPE_UTIL_RESOURCE_UTIL_INTERNAL_H_
 
+#include <memory>
 #include <string>
 
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/util/resource_util.h"
 
 namespace mediapipe {
 namespace internal {
@@ -14,6 +17,11 @@ absl::Status DefaultGetResourceContents(const std::string& path,
                                         std::string* output,
                                         bool read_as_binary);
 
+// Tries to return the contents of a file given the path, without copying them
+// if possible. Implementation is platform-dependent.
+absl::StatusOr<std::unique_ptr<Resource>> DefaultGetResource(
+    const std::string& path);
+
 }  // namespace internal
 }  // namespace mediapipe
 #endif  // MEDIAPIPE_UTIL_RESOURCE_UTIL_INTERNAL_H_
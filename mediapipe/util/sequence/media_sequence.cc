@@ -14,9 +14,14 @@
 
 #include "mediapipe/util/sequence/media_sequence.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <map>
+#include <string>
+#include <utility>
 
+#include "absl/strings/match.h"
 #include "absl/strings/str_split.h"
 #include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -556,5 +561,128 @@ absl::Status ReconcileMetadata(bool reconcile_bbox_annotations,
   return absl::OkStatus();
 }
 
+absl::StatusOr<std::vector<tensorflow::SequenceExample>> ShardSequenceByTime(
+    const tensorflow::SequenceExample& sequence, int num_shards,
+    int64 alignment_usec) {
+  RET_CHECK_GT(num_shards, 0);
+  RET_CHECK_GT(alignment_usec, 0);
+  RET_CHECK(HasClipEndTimestamp(sequence))
+      << "Sharding requires the clip end timestamp.";
+  const int64 start =
+      HasClipStartTimestamp(sequence) ? GetClipStartTimestamp(sequence) : 0;
+  const int64 end = GetClipEndTimestamp(sequence);
+  RET_CHECK_LE(start, end);
+
+  // Rounds the shard length up to whole alignment periods; long alignments
+  // give fewer shards.
+  const int64 num_periods = (end - start + alignment_usec - 1) / alignment_usec;
+  const int64 periods_per_shard =
+      std::max<int64>(1, (num_periods + num_shards - 1) / num_shards);
+  std::vector<tensorflow::SequenceExample> shards;
+  for (int64 shard_start = start; shard_start < end || shards.empty();
+       shard_start += periods_per_shard * alignment_usec) {
+    tensorflow::SequenceExample shard = sequence;
+    SetClipStartTimestamp(shard_start, &shard);
+    SetClipEndTimestamp(
+        std::min(end, shard_start + periods_per_shard * alignment_usec),
+        &shard);
+    shards.push_back(std::move(shard));
+  }
+  return shards;
+}
+
+namespace {
+
+// Returns the key of the timestamps of a feature list key, e.g.
+// "PREFIX/feature/timestamp" for "PREFIX/feature/floats", or "" if there are
+// none.
+std::string TimestampKey(const std::string& key,
+                         const tensorflow::FeatureLists& feature_lists) {
+  std::string::size_type end = key.rfind('/');
+  while (end != std::string::npos) {
+    std::string timestamp_key = key.substr(0, end + 1) + "timestamp";
+    if (feature_lists.feature_list().count(timestamp_key)) {
+      return timestamp_key;
+    }
+    end = end == 0 ? std::string::npos : key.rfind('/', end - 1);
+  }
+  return feature_lists.feature_list().count("timestamp") ? "timestamp" : "";
+}
+
+}  // namespace
+
+absl::Status MergeSequenceShards(
+    const std::vector<tensorflow::SequenceExample>& shards,
+    tensorflow::SequenceExample* merged) {
+  RET_CHECK(!shards.empty());
+  RET_CHECK(merged);
+  merged->Clear();
+  // The last timestamp merged for each timestamp key.
+  std::map<std::string, int64> last_timestamps;
+  for (const auto& shard : shards) {
+    for (const auto& key_value : shard.context().feature()) {
+      auto* context = merged->mutable_context()->mutable_feature();
+      if (!context->count(key_value.first)) {
+        (*context)[key_value.first] = key_value.second;
+      }
+    }
+
+    // Counts the leading entries of each timestamp key that the previous
+    // shards already cover.
+    std::map<std::string, int> num_repeated;
+    const auto& feature_lists = shard.feature_lists();
+    for (const auto& key_value : feature_lists.feature_list()) {
+      auto last_timestamp = last_timestamps.find(key_value.first);
+      if (last_timestamp == last_timestamps.end()) continue;
+      int count = 0;
+      for (const auto& feature : key_value.second.feature()) {
+        RET_CHECK_EQ(feature.int64_list().value_size(), 1)
+            << "Timestamp feature " << key_value.first
+            << " must have one value per entry.";
+        if (feature.int64_list().value(0) > last_timestamp->second) break;
+        ++count;
+      }
+      num_repeated[key_value.first] = count;
+    }
+
+    for (const auto& key_value : feature_lists.feature_list()) {
+      const std::string timestamp_key =
+          absl::EndsWith(key_value.first, "timestamp")
+              ? key_value.first
+              : TimestampKey(key_value.first, feature_lists);
+      const int skip = timestamp_key.empty() ? 0 : num_repeated[timestamp_key];
+      auto* merged_features = (*merged->mutable_feature_lists()
+                                    ->mutable_feature_list())[key_value.first]
+                                  .mutable_feature();
+      for (int i = skip; i < key_value.second.feature_size(); ++i) {
+        *merged_features->Add() = key_value.second.feature(i);
+      }
+    }
+
+    for (const auto& key_value : feature_lists.feature_list()) {
+      if (!absl::EndsWith(key_value.first, "timestamp") ||
+          key_value.second.feature_size() == 0) {
+        continue;
+      }
+      const auto& last_feature =
+          key_value.second.feature(key_value.second.feature_size() - 1);
+      if (last_feature.int64_list().value_size() != 1) continue;
+      const int64 timestamp = last_feature.int64_list().value(0);
+      auto inserted = last_timestamps.emplace(key_value.first, timestamp);
+      if (!inserted.second) {
+        inserted.first->second = std::max(inserted.first->second, timestamp);
+      }
+    }
+  }
+
+  if (HasClipStartTimestamp(shards.front())) {
+    SetClipStartTimestamp(GetClipStartTimestamp(shards.front()), merged);
+  }
+  if (HasClipEndTimestamp(shards.back())) {
+    SetClipEndTimestamp(GetClipEndTimestamp(shards.back()), merged);
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace mediasequence
 }  // namespace mediapipe
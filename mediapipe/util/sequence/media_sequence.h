@@ -162,6 +162,7 @@
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/port/proto_ns.h"
@@ -207,6 +208,10 @@ const char kClipLabelConfidenceKey[] = "clip/label/confidence";
 const char kClipLabelStartTimestampKey[] = "clip/label/start/timestamp";
 // A list of label end timestamps for this clip.
 const char kClipLabelEndTimestampKey[] = "clip/label/end/timestamp";
+// For a clip written as several SequenceExample chunks, the first and last
+// feature list timestamps, in microseconds, within this chunk.
+const char kChunkStartTimestampKey[] = "chunk/start/timestamp";
+const char kChunkEndTimestampKey[] = "chunk/end/timestamp";
 
 BYTES_CONTEXT_FEATURE(ExampleId, kExampleIdKey);
 BYTES_CONTEXT_FEATURE(ExampleDatasetName, kExampleDatasetNameKey);
@@ -227,6 +232,8 @@ VECTOR_FLOAT_CONTEXT_FEATURE(ClipLabelConfidence, kClipLabelConfidenceKey);
 VECTOR_INT64_CONTEXT_FEATURE(ClipLabelStartTimestamp,
                              kClipLabelStartTimestampKey);
 VECTOR_INT64_CONTEXT_FEATURE(ClipLabelEndTimestamp, kClipLabelEndTimestampKey);
+INT64_CONTEXT_FEATURE(ChunkStartTimestamp, kChunkStartTimestampKey);
+INT64_CONTEXT_FEATURE(ChunkEndTimestamp, kChunkEndTimestampKey);
 
 // ***********************    SEGMENTS    *************************************
 // Context Keys:
@@ -746,6 +753,29 @@ PREFIXED_FLOAT_CONTEXT_FEATURE(FeatureAudioSampleRate,
 absl::Status ReconcileMetadata(bool reconcile_bbox_annotations,
                                bool reconcile_region_annotations,
                                tensorflow::SequenceExample* sequence);
+
+// Splits the clip of a sequence into up to num_shards consecutive clips of
+// about equal length, e.g. to extract the features of a long video with
+// several graphs in parallel. The sequences of the shards are copies of the
+// sequence with their own clip start and end timestamps. The boundaries
+// between shards are multiples of alignment_usec after the clip start, e.g.
+// the sampling period of the graph or the keyframe interval of the video, so
+// that each shard samples the same frames as the whole clip would. The
+// sequence must have a clip end timestamp; the clip start defaults to 0.
+absl::StatusOr<std::vector<tensorflow::SequenceExample>> ShardSequenceByTime(
+    const tensorflow::SequenceExample& sequence, int num_shards,
+    int64 alignment_usec);
+
+// Merges the sequences computed from consecutive shards of a clip, such as
+// those from ShardSequenceByTime(), into one sequence. Feature lists are
+// concatenated in shard order. Where a feature list has timestamps (e.g.
+// "image/timestamp" for "image/encoded", or "PREFIX/feature/timestamp" for
+// "PREFIX/feature/floats"), the entries a shard repeats from the end of the
+// previous shard are dropped. Context features are taken from the first shard
+// that has them, and the clip spans from the first to the last shard.
+absl::Status MergeSequenceShards(
+    const std::vector<tensorflow::SequenceExample>& shards,
+    tensorflow::SequenceExample* merged);
 }  // namespace mediasequence
 }  // namespace mediapipe
 
@@ -192,6 +192,10 @@ CLIP_LABEL_CONFIDENCE_KEY = "clip/label/confidence"
 CLIP_LABEL_START_TIMESTAMP_KEY = "clip/label/start/timestamp"
 # A list of label end timestamps for this clip.
 CLIP_LABEL_END_TIMESTAMP_KEY = "clip/label/end/timestamp"
+# For a clip written as several SequenceExample chunks, the first and last
+# feature list timestamps, in microseconds, within this chunk.
+CHUNK_START_TIMESTAMP_KEY = "chunk/start/timestamp"
+CHUNK_END_TIMESTAMP_KEY = "chunk/end/timestamp"
 msu.create_bytes_context_feature(
     "example_id", EXAMPLE_ID_KEY, module_dict=globals())
 msu.create_bytes_context_feature(
@@ -230,6 +234,10 @@ msu.create_int_list_context_feature(
     "clip_label_end_timestamp",
     CLIP_LABEL_END_TIMESTAMP_KEY,
     module_dict=globals())
+msu.create_int_context_feature(
+    "chunk_start_timestamp", CHUNK_START_TIMESTAMP_KEY, module_dict=globals())
+msu.create_int_context_feature(
+    "chunk_end_timestamp", CHUNK_END_TIMESTAMP_KEY, module_dict=globals())
 
 ##################################  SEGMENTS  #################################
 # A list of segment start times in microseconds.
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "mediapipe/framework/formats/location.h"
 #include "mediapipe/framework/port/gmock.h"
@@ -1231,6 +1232,62 @@ TEST(MediaSequenceTest, ReconcileMetadataRegionAnnotations) {
   ASSERT_EQ(GetUnmodifiedBBoxTimestampAt("PREFIX", sequence, 0), 9);
   ASSERT_EQ(GetUnmodifiedBBoxTimestampAt("PREFIX", sequence, 1), 22);
 }
+
+TEST(MediaSequenceTest, ShardSequenceByTimeAlignsBoundaries) {
+  tensorflow::SequenceExample sequence;
+  SetClipStartTimestamp(1000000, &sequence);
+  SetClipEndTimestamp(11500000, &sequence);
+  MP_ASSERT_OK_AND_ASSIGN(auto shards,
+                          ShardSequenceByTime(sequence, 3, 1000000));
+  ASSERT_EQ(shards.size(), 3);
+  ASSERT_EQ(GetClipStartTimestamp(shards[0]), 1000000);
+  ASSERT_EQ(GetClipEndTimestamp(shards[0]), 5000000);
+  ASSERT_EQ(GetClipStartTimestamp(shards[1]), 5000000);
+  ASSERT_EQ(GetClipEndTimestamp(shards[1]), 9000000);
+  ASSERT_EQ(GetClipStartTimestamp(shards[2]), 9000000);
+  ASSERT_EQ(GetClipEndTimestamp(shards[2]), 11500000);
+}
+
+TEST(MediaSequenceTest, ShardSequenceByTimeRequiresClipEnd) {
+  tensorflow::SequenceExample sequence;
+  ASSERT_FALSE(ShardSequenceByTime(sequence, 2, 1000000).ok());
+}
+
+TEST(MediaSequenceTest, MergeSequenceShardsDropsRepeatedEntries) {
+  std::vector<tensorflow::SequenceExample> shards(2);
+  SetClipStartTimestamp(0, &shards[0]);
+  SetClipEndTimestamp(3000000, &shards[0]);
+  SetClipMediaId("media", &shards[0]);
+  AddFeatureTimestamp("RGB", 0, &shards[0]);
+  AddFeatureFloats("RGB", {0.0f}, &shards[0]);
+  AddFeatureTimestamp("RGB", 1000000, &shards[0]);
+  AddFeatureFloats("RGB", {1.0f}, &shards[0]);
+
+  SetClipStartTimestamp(2000000, &shards[1]);
+  SetClipEndTimestamp(4000000, &shards[1]);
+  SetClipMediaId("media", &shards[1]);
+  // Repeats the last entry of the first shard.
+  AddFeatureTimestamp("RGB", 1000000, &shards[1]);
+  AddFeatureFloats("RGB", {1.0f}, &shards[1]);
+  AddFeatureTimestamp("RGB", 2000000, &shards[1]);
+  AddFeatureFloats("RGB", {2.0f}, &shards[1]);
+  AddFeatureTimestamp("AUDIO", 2000000, &shards[1]);
+  AddFeatureFloats("AUDIO", {3.0f}, &shards[1]);
+
+  tensorflow::SequenceExample merged;
+  MP_ASSERT_OK(MergeSequenceShards(shards, &merged));
+  ASSERT_EQ(GetClipStartTimestamp(merged), 0);
+  ASSERT_EQ(GetClipEndTimestamp(merged), 4000000);
+  ASSERT_EQ(GetClipMediaId(merged), "media");
+  ASSERT_EQ(GetFeatureTimestampSize("RGB", merged), 3);
+  ASSERT_EQ(GetFeatureFloatsSize("RGB", merged), 3);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(GetFeatureTimestampAt("RGB", merged, i), i * 1000000);
+    ASSERT_EQ(GetFeatureFloatsAt("RGB", merged, i)[0], i);
+  }
+  ASSERT_EQ(GetFeatureTimestampSize("AUDIO", merged), 1);
+  ASSERT_EQ(GetFeatureFloatsSize("AUDIO", merged), 1);
+}
 }  // namespace
 }  // namespace mediasequence
 }  // namespace mediapipe
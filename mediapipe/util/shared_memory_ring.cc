@@ -0,0 +1,391 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/shared_memory_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "mediapipe/framework/port/logging.h"
+
+#if !defined(_WIN32) && !defined(__ANDROID__)
+#define MEDIAPIPE_HAS_SHARED_MEMORY_RING 1
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mediapipe {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x4d505352;  // "MPSR"
+constexpr size_t kSlotAlignment = 64;
+constexpr size_t kDataAlignment = 4096;
+// How long waits sleep between polls.
+constexpr absl::Duration kPollInterval = absl::Microseconds(200);
+// How often a waiting writer checks for killed readers.
+constexpr absl::Duration kLivenessInterval = absl::Milliseconds(100);
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared memory requires lock-free atomics.");
+
+// The states of a reader in the ring.
+enum ReaderStateValue : uint32_t {
+  kFree = 0,
+  kBlocking = 1,
+  kLatestOnly = 2,
+  // Being set up by AddReader(), or dropped by the writer.
+  kBusy = 3,
+};
+
+size_t AlignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+bool IsProcessAlive(int32_t pid) {
+#ifdef MEDIAPIPE_HAS_SHARED_MEMORY_RING
+  return pid == 0 || kill(pid, 0) == 0 || errno != ESRCH;
+#else
+  return true;
+#endif  // MEDIAPIPE_HAS_SHARED_MEMORY_RING
+}
+
+}  // namespace
+
+struct SharedMemoryRing::Header {
+  struct Reader {
+    std::atomic<uint32_t> state;
+    std::atomic<int32_t> pid;
+    // The sequence number of the next entry to read.
+    std::atomic<uint64_t> read_sequence;
+    std::atomic<uint32_t> pins[kMaxSlots];
+  };
+
+  struct alignas(kSlotAlignment) Slot {
+    // One more than the sequence number of the entry in the slot, or 0 while
+    // the slot is written.
+    std::atomic<uint64_t> sequence;
+    int32_t kind;
+    int64_t timestamp;
+    uint64_t size;
+  };
+
+  // Set last when the header is initialized.
+  std::atomic<uint32_t> magic;
+  uint32_t num_slots;
+  uint64_t slot_size;
+  uint64_t slot_stride;
+  uint64_t data_offset;
+  std::atomic<int32_t> writer_pid;
+  std::atomic<uint32_t> closed;
+  // The number of entries written.
+  std::atomic<uint64_t> write_sequence;
+  Reader readers[kMaxReaders];
+  Slot slots[kMaxSlots];
+};
+
+absl::StatusOr<std::shared_ptr<SharedMemoryRing>> SharedMemoryRing::Create(
+    const std::string& name, int num_slots, size_t slot_size) {
+#ifdef MEDIAPIPE_HAS_SHARED_MEMORY_RING
+  if (num_slots < 1 || num_slots > kMaxSlots) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("num_slots must be in [1, ", kMaxSlots, "]."));
+  }
+  const std::string path = absl::StrCat("/", name);
+  const size_t data_offset = AlignUp(sizeof(Header), kDataAlignment);
+  const size_t slot_stride = AlignUp(slot_size, kSlotAlignment);
+  const size_t size = data_offset + num_slots * slot_stride;
+  // A ring left by a killed writer is replaced; its readers keep it mapped.
+  shm_unlink(path.c_str());
+  const int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    return absl::InternalError(
+        absl::StrCat("shm_open failed for ", path, ", errno ", errno));
+  }
+  void* memory = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  const int error = errno;
+  close(fd);
+  if (memory == MAP_FAILED) {
+    shm_unlink(path.c_str());
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Can't map ", size, " bytes of shared memory, errno ", error));
+  }
+  // The new memory is zeroed, which initializes all the atomics to 0.
+  auto* header = static_cast<Header*>(memory);
+  header->num_slots = num_slots;
+  header->slot_size = slot_size;
+  header->slot_stride = slot_stride;
+  header->data_offset = data_offset;
+  header->writer_pid.store(getpid(), std::memory_order_relaxed);
+  header->magic.store(kMagic, std::memory_order_release);
+  return std::shared_ptr<SharedMemoryRing>(
+      new SharedMemoryRing(path, /*owner=*/true, memory, size));
+#else
+  return absl::UnimplementedError(
+      "Shared memory rings are not supported on this platform.");
+#endif  // MEDIAPIPE_HAS_SHARED_MEMORY_RING
+}
+
+absl::StatusOr<std::shared_ptr<SharedMemoryRing>> SharedMemoryRing::Open(
+    const std::string& name) {
+#ifdef MEDIAPIPE_HAS_SHARED_MEMORY_RING
+  const std::string path = absl::StrCat("/", name);
+  const int fd = shm_open(path.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return absl::NotFoundError(absl::StrCat("No shared memory ", path));
+    }
+    return absl::InternalError(
+        absl::StrCat("shm_open failed for ", path, ", errno ", errno));
+  }
+  struct stat stat_buffer;
+  void* memory = MAP_FAILED;
+  size_t size = 0;
+  if (fstat(fd, &stat_buffer) == 0 &&
+      stat_buffer.st_size >= static_cast<off_t>(sizeof(Header))) {
+    size = stat_buffer.st_size;
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (memory == MAP_FAILED) {
+    return absl::UnavailableError(absl::StrCat(path, " is not ready."));
+  }
+  auto* header = static_cast<Header*>(memory);
+  if (header->magic.load(std::memory_order_acquire) != kMagic ||
+      header->data_offset + header->num_slots * header->slot_stride > size) {
+    munmap(memory, size);
+    return absl::UnavailableError(absl::StrCat(path, " is not ready."));
+  }
+  return std::shared_ptr<SharedMemoryRing>(
+      new SharedMemoryRing(path, /*owner=*/false, memory, size));
+#else
+  return absl::UnimplementedError(
+      "Shared memory rings are not supported on this platform.");
+#endif  // MEDIAPIPE_HAS_SHARED_MEMORY_RING
+}
+
+SharedMemoryRing::SharedMemoryRing(std::string name, bool owner, void* memory,
+                                   size_t size)
+    : name_(std::move(name)),
+      owner_(owner),
+      memory_(memory),
+      size_(size),
+      header_(static_cast<Header*>(memory)) {}
+
+SharedMemoryRing::~SharedMemoryRing() {
+#ifdef MEDIAPIPE_HAS_SHARED_MEMORY_RING
+  if (owner_) {
+    CloseWriter();
+    shm_unlink(name_.c_str());
+  }
+  munmap(memory_, size_);
+#endif  // MEDIAPIPE_HAS_SHARED_MEMORY_RING
+}
+
+int SharedMemoryRing::num_slots() const { return header_->num_slots; }
+
+size_t SharedMemoryRing::slot_size() const { return header_->slot_size; }
+
+uint8_t* SharedMemoryRing::SlotData(int slot) const {
+  return static_cast<uint8_t*>(memory_) + header_->data_offset +
+         slot * header_->slot_stride;
+}
+
+bool SharedMemoryRing::BlockingReadersDone(uint64_t sequence) {
+  for (Header::Reader& reader : header_->readers) {
+    if (reader.state.load(std::memory_order_acquire) == kBlocking &&
+        sequence - reader.read_sequence.load(std::memory_order_acquire) >=
+            header_->num_slots) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SharedMemoryRing::SlotUnpinned(int slot) {
+  for (Header::Reader& reader : header_->readers) {
+    if (reader.pins[slot].load() != 0) return false;
+  }
+  return true;
+}
+
+void SharedMemoryRing::DropDeadReaders() {
+  for (Header::Reader& reader : header_->readers) {
+    const int32_t pid = reader.pid.load(std::memory_order_acquire);
+    if (IsProcessAlive(pid)) continue;
+    // Claiming the reader keeps AddReader() from reusing it meanwhile.
+    uint32_t state = reader.state.load(std::memory_order_acquire);
+    if (state == kBusy ||
+        !reader.state.compare_exchange_strong(state, kBusy)) {
+      continue;
+    }
+    LOG(WARNING) << "Dropping reader of " << name_ << " from killed process "
+                 << pid;
+    for (std::atomic<uint32_t>& pins : reader.pins) pins.store(0);
+    reader.pid.store(0, std::memory_order_relaxed);
+    reader.state.store(kFree, std::memory_order_release);
+  }
+}
+
+absl::StatusOr<absl::Span<uint8_t>> SharedMemoryRing::BeginWrite(
+    absl::Duration timeout) {
+  CHECK(owner_) << "Only the creator of " << name_ << " can write it.";
+  const absl::Time deadline = absl::Now() + timeout;
+  absl::Time liveness_time = absl::Now() + kLivenessInterval;
+  // Waits for `done`, checking for killed readers now and then.
+  auto wait = [&](auto done) {
+    while (!done()) {
+      const absl::Time now = absl::Now();
+      if (now >= deadline) return false;
+      if (now >= liveness_time) {
+        DropDeadReaders();
+        liveness_time = now + kLivenessInterval;
+      }
+      absl::SleepFor(std::min(kPollInterval, deadline - now));
+    }
+    return true;
+  };
+  if (!wait([this] { return BlockingReadersDone(write_sequence_); })) {
+    return absl::DeadlineExceededError(
+        absl::StrCat("Readers of ", name_, " are behind."));
+  }
+  const int slot = write_sequence_ % header_->num_slots;
+  Header::Slot& slot_header = header_->slots[slot];
+  // Readers pin a slot before checking its sequence, and the writer clears
+  // the sequence before checking the pins, so that either the reader sees
+  // the slot is being written or the writer sees the pin.
+  const uint64_t sequence = slot_header.sequence.exchange(0);
+  if (!wait([this, slot] { return SlotUnpinned(slot); })) {
+    slot_header.sequence.store(sequence);
+    return absl::DeadlineExceededError(
+        absl::StrCat("A reader of ", name_, " holds an entry."));
+  }
+  return absl::MakeSpan(SlotData(slot), header_->slot_size);
+}
+
+void SharedMemoryRing::EndWrite(const EntryInfo& info) {
+  CHECK_LE(info.size, header_->slot_size);
+  Header::Slot& slot_header =
+      header_->slots[write_sequence_ % header_->num_slots];
+  slot_header.kind = info.kind;
+  slot_header.timestamp = info.timestamp;
+  slot_header.size = info.size;
+  ++write_sequence_;
+  slot_header.sequence.store(write_sequence_, std::memory_order_release);
+  header_->write_sequence.store(write_sequence_, std::memory_order_release);
+}
+
+void SharedMemoryRing::CloseWriter() {
+  header_->closed.store(1, std::memory_order_release);
+}
+
+int SharedMemoryRing::NumReaders() const {
+  int num_readers = 0;
+  for (const Header::Reader& reader : header_->readers) {
+    const uint32_t state = reader.state.load(std::memory_order_acquire);
+    if (state == kBlocking || state == kLatestOnly) ++num_readers;
+  }
+  return num_readers;
+}
+
+absl::StatusOr<int> SharedMemoryRing::AddReader(ReadPolicy policy) {
+  for (int i = 0; i < kMaxReaders; ++i) {
+    Header::Reader& reader = header_->readers[i];
+    uint32_t state = kFree;
+    if (!reader.state.compare_exchange_strong(state, kBusy)) continue;
+#ifdef MEDIAPIPE_HAS_SHARED_MEMORY_RING
+    reader.pid.store(getpid(), std::memory_order_relaxed);
+#endif  // MEDIAPIPE_HAS_SHARED_MEMORY_RING
+    reader.read_sequence.store(
+        header_->write_sequence.load(std::memory_order_acquire),
+        std::memory_order_relaxed);
+    reader.state.store(
+        policy == ReadPolicy::kBlocking ? kBlocking : kLatestOnly,
+        std::memory_order_release);
+    return i;
+  }
+  return absl::ResourceExhaustedError(
+      absl::StrCat(name_, " has ", kMaxReaders, " readers already."));
+}
+
+void SharedMemoryRing::RemoveReader(int reader) {
+  header_->readers[reader].state.store(kFree, std::memory_order_release);
+}
+
+bool SharedMemoryRing::Read(int reader_index, absl::Duration timeout,
+                            Entry* entry) {
+  Header::Reader& reader = header_->readers[reader_index];
+  const bool latest_only =
+      reader.state.load(std::memory_order_relaxed) == kLatestOnly;
+  const uint64_t num_slots = header_->num_slots;
+  const absl::Time deadline = absl::Now() + timeout;
+  while (true) {
+    const uint64_t written =
+        header_->write_sequence.load(std::memory_order_acquire);
+    uint64_t next = reader.read_sequence.load(std::memory_order_relaxed);
+    if (next < written) {
+      if (latest_only) {
+        next = written - 1;
+      } else if (written - next > num_slots) {
+        // Only after the reader was dropped as killed.
+        next = written - num_slots;
+      }
+      const int slot = next % num_slots;
+      reader.pins[slot].fetch_add(1);
+      const Header::Slot& slot_header = header_->slots[slot];
+      // The reader moves on even if the entry was overwritten meanwhile.
+      reader.read_sequence.store(next + 1, std::memory_order_release);
+      if (slot_header.sequence.load() == next + 1) {
+        entry->info.kind = slot_header.kind;
+        entry->info.timestamp = slot_header.timestamp;
+        entry->info.size = slot_header.size;
+        entry->data = SlotData(slot);
+        entry->slot = slot;
+        return true;
+      }
+      reader.pins[slot].fetch_sub(1);
+      continue;
+    }
+    const absl::Time now = absl::Now();
+    if (now >= deadline || IsDone(reader_index)) return false;
+    absl::SleepFor(std::min(kPollInterval, deadline - now));
+  }
+}
+
+void SharedMemoryRing::Release(int reader, const Entry& entry) {
+  header_->readers[reader].pins[entry.slot].fetch_sub(
+      1, std::memory_order_release);
+}
+
+bool SharedMemoryRing::IsDone(int reader) const {
+  const bool writer_done =
+      header_->closed.load(std::memory_order_acquire) != 0 ||
+      !IsProcessAlive(header_->writer_pid.load(std::memory_order_relaxed));
+  return writer_done &&
+         header_->readers[reader].read_sequence.load(
+             std::memory_order_relaxed) >=
+             header_->write_sequence.load(std::memory_order_acquire);
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,148 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_SHARED_MEMORY_RING_H_
+#define MEDIAPIPE_UTIL_SHARED_MEMORY_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+
+namespace mediapipe {
+
+// A ring of fixed-size slots in named POSIX shared memory, written by one
+// process and read by several others, possibly with the writer itself.
+//
+// Each entry written takes one slot and is read in place: a reader pins the
+// slot of the entry it reads until it releases it, and the writer doesn't
+// reuse a slot while any reader pins it. Readers either make the writer wait
+// until they have read each entry (kBlocking), or skip to the most recent
+// entry each time they read (kLatestOnly), in which case the writer never
+// waits for them besides their pins.
+//
+// A reader killed while registered is detected by the writer and dropped,
+// along with its pins. Waits poll rather than use process-shared condition
+// variables, which a killed process could leave locked.
+//
+// Unimplemented on Windows and Android, which lack named shared memory.
+class SharedMemoryRing {
+ public:
+  // The most slots and readers of a ring.
+  static constexpr int kMaxSlots = 64;
+  static constexpr int kMaxReaders = 16;
+
+  enum class ReadPolicy { kBlocking, kLatestOnly };
+
+  // The description of an entry, stored with it.
+  struct EntryInfo {
+    // What the entry holds, defined by the user of the ring.
+    int32_t kind = 0;
+    int64_t timestamp = 0;
+    // The number of bytes of the slot used by the entry.
+    size_t size = 0;
+  };
+
+  // An entry pinned by a reader, until passed to Release().
+  struct Entry {
+    EntryInfo info;
+    const uint8_t* data = nullptr;
+    int slot = -1;
+  };
+
+  // Creates the ring `name`, replacing any ring left with this name, and
+  // returns it for writing. `name` is a single path component. The name is
+  // removed when the returned ring is destroyed; readers that already opened
+  // the ring keep it.
+  static absl::StatusOr<std::shared_ptr<SharedMemoryRing>> Create(
+      const std::string& name, int num_slots, size_t slot_size);
+
+  // Opens the existing ring `name` for reading. Returns a NotFound error if
+  // it doesn't exist yet, or an Unavailable error if it isn't initialized
+  // yet.
+  static absl::StatusOr<std::shared_ptr<SharedMemoryRing>> Open(
+      const std::string& name);
+
+  ~SharedMemoryRing();
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+  int num_slots() const;
+  size_t slot_size() const;
+
+  // Writing, only for a ring returned by Create(). Not thread-safe.
+
+  // Returns the slot to write the next entry into, once the blocking readers
+  // have read the entry it holds and no reader pins it. Returns a
+  // DeadlineExceeded error if that takes more than `timeout`.
+  absl::StatusOr<absl::Span<uint8_t>> BeginWrite(absl::Duration timeout);
+
+  // Publishes the entry written into the slot returned by BeginWrite().
+  void EndWrite(const EntryInfo& info);
+
+  // Marks the end of the entries, for readers to stop once they read them.
+  void CloseWriter();
+
+  // Returns the number of registered readers.
+  int NumReaders() const;
+
+  // Reading. Thread-safe, but each reader must be used by one thread at a
+  // time.
+
+  // Registers a reader, which reads the entries written from now on, and
+  // returns its index. Returns a ResourceExhausted error if the ring has
+  // kMaxReaders readers already.
+  absl::StatusOr<int> AddReader(ReadPolicy policy);
+
+  // Unregisters `reader`. Its pinned entries can still be released.
+  void RemoveReader(int reader);
+
+  // Reads and pins the next entry for `reader`, waiting up to `timeout` for
+  // one. Returns false if there is none.
+  bool Read(int reader, absl::Duration timeout, Entry* entry);
+
+  // Unpins an entry returned by Read().
+  void Release(int reader, const Entry& entry);
+
+  // Whether the writer closed the ring, or was killed, and `reader` read all
+  // the entries.
+  bool IsDone(int reader) const;
+
+ private:
+  struct Header;
+
+  SharedMemoryRing(std::string name, bool owner, void* memory, size_t size);
+
+  uint8_t* SlotData(int slot) const;
+  bool BlockingReadersDone(uint64_t sequence);
+  bool SlotUnpinned(int slot);
+  void DropDeadReaders();
+
+  const std::string name_;
+  const bool owner_;
+  void* const memory_;
+  const size_t size_;
+  Header* const header_;
+  // The next sequence number to write, for the writer.
+  uint64_t write_sequence_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_SHARED_MEMORY_RING_H_
@@ -0,0 +1,217 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/shared_memory_ring.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ReadPolicy = SharedMemoryRing::ReadPolicy;
+using ::testing::ElementsAre;
+
+std::string RingName(const std::string& test_name) {
+  return absl::StrCat("shared_memory_ring_test_", getpid(), "_", test_name);
+}
+
+absl::Status Write(SharedMemoryRing* ring, int value,
+                   absl::Duration timeout = absl::Milliseconds(10)) {
+  ASSIGN_OR_RETURN(absl::Span<uint8_t> slot, ring->BeginWrite(timeout));
+  std::memcpy(slot.data(), &value, sizeof(value));
+  SharedMemoryRing::EntryInfo info;
+  info.kind = 1;
+  info.timestamp = value;
+  info.size = sizeof(value);
+  ring->EndWrite(info);
+  return absl::OkStatus();
+}
+
+// Reads an entry and returns its value, or -1 if there is none.
+int Read(SharedMemoryRing* ring, int reader, bool release = true) {
+  SharedMemoryRing::Entry entry;
+  if (!ring->Read(reader, absl::ZeroDuration(), &entry)) return -1;
+  int value;
+  std::memcpy(&value, entry.data, sizeof(value));
+  EXPECT_EQ(entry.info.timestamp, value);
+  if (release) ring->Release(reader, entry);
+  return value;
+}
+
+TEST(SharedMemoryRingTest, ReadsEntriesInOrder) {
+  MP_ASSERT_OK_AND_ASSIGN(auto writer,
+                          SharedMemoryRing::Create(RingName("order"), 4, 64));
+  MP_ASSERT_OK_AND_ASSIGN(auto ring, SharedMemoryRing::Open(RingName("order")));
+  EXPECT_EQ(ring->num_slots(), 4);
+  EXPECT_EQ(ring->slot_size(), 64);
+  MP_ASSERT_OK_AND_ASSIGN(int reader, ring->AddReader(ReadPolicy::kBlocking));
+  EXPECT_EQ(writer->NumReaders(), 1);
+  for (int i = 0; i < 3; ++i) MP_ASSERT_OK(Write(writer.get(), i));
+  EXPECT_EQ(Read(ring.get(), reader), 0);
+  EXPECT_EQ(Read(ring.get(), reader), 1);
+  EXPECT_EQ(Read(ring.get(), reader), 2);
+  EXPECT_EQ(Read(ring.get(), reader), -1);
+  EXPECT_FALSE(ring->IsDone(reader));
+
+  writer->CloseWriter();
+  EXPECT_TRUE(ring->IsDone(reader));
+}
+
+TEST(SharedMemoryRingTest, OpenFailsWithoutWriter) {
+  EXPECT_EQ(SharedMemoryRing::Open(RingName("missing")).status().code(),
+            absl::StatusCode::kNotFound);
+}
+
+TEST(SharedMemoryRingTest, WriterWaitsForBlockingReader) {
+  MP_ASSERT_OK_AND_ASSIGN(
+      auto ring, SharedMemoryRing::Create(RingName("blocking"), 2, 64));
+  MP_ASSERT_OK_AND_ASSIGN(int reader, ring->AddReader(ReadPolicy::kBlocking));
+  MP_ASSERT_OK(Write(ring.get(), 0));
+  MP_ASSERT_OK(Write(ring.get(), 1));
+  EXPECT_EQ(Write(ring.get(), 2).code(), absl::StatusCode::kDeadlineExceeded);
+
+  EXPECT_EQ(Read(ring.get(), reader), 0);
+  MP_EXPECT_OK(Write(ring.get(), 2));
+  EXPECT_EQ(Read(ring.get(), reader), 1);
+  EXPECT_EQ(Read(ring.get(), reader), 2);
+
+  // A removed reader doesn't hold the writer.
+  ring->RemoveReader(reader);
+  EXPECT_EQ(ring->NumReaders(), 0);
+  for (int i = 3; i < 10; ++i) MP_EXPECT_OK(Write(ring.get(), i));
+}
+
+TEST(SharedMemoryRingTest, LatestOnlyReaderSkipsEntries) {
+  MP_ASSERT_OK_AND_ASSIGN(auto ring,
+                          SharedMemoryRing::Create(RingName("latest"), 2, 64));
+  MP_ASSERT_OK_AND_ASSIGN(int reader,
+                          ring->AddReader(ReadPolicy::kLatestOnly));
+  for (int i = 0; i < 5; ++i) MP_ASSERT_OK(Write(ring.get(), i));
+  EXPECT_EQ(Read(ring.get(), reader), 4);
+  EXPECT_EQ(Read(ring.get(), reader), -1);
+  MP_ASSERT_OK(Write(ring.get(), 5));
+  EXPECT_EQ(Read(ring.get(), reader), 5);
+}
+
+TEST(SharedMemoryRingTest, WriterKeepsPinnedEntries) {
+  MP_ASSERT_OK_AND_ASSIGN(auto ring,
+                          SharedMemoryRing::Create(RingName("pinned"), 2, 64));
+  MP_ASSERT_OK_AND_ASSIGN(int reader,
+                          ring->AddReader(ReadPolicy::kLatestOnly));
+  MP_ASSERT_OK(Write(ring.get(), 0));
+  SharedMemoryRing::Entry entry;
+  ASSERT_TRUE(ring->Read(reader, absl::ZeroDuration(), &entry));
+  MP_ASSERT_OK(Write(ring.get(), 1));
+  // The next entry would overwrite the pinned one.
+  EXPECT_EQ(Write(ring.get(), 2).code(), absl::StatusCode::kDeadlineExceeded);
+  int value;
+  std::memcpy(&value, entry.data, sizeof(value));
+  EXPECT_EQ(value, 0);
+
+  ring->Release(reader, entry);
+  MP_EXPECT_OK(Write(ring.get(), 2));
+  EXPECT_EQ(Read(ring.get(), reader), 2);
+}
+
+TEST(SharedMemoryRingTest, ReadsEntriesOfOtherProcess) {
+  const std::string name = RingName("process");
+  int created_pipe[2];
+  int registered_pipe[2];
+  ASSERT_EQ(pipe(created_pipe), 0);
+  ASSERT_EQ(pipe(registered_pipe), 0);
+  const pid_t pid = fork();
+  if (pid == 0) {
+    auto ring = SharedMemoryRing::Create(name, 2, 64);
+    if (!ring.ok()) _exit(1);
+    char byte = 0;
+    if (write(created_pipe[1], &byte, 1) != 1) _exit(2);
+    if (read(registered_pipe[0], &byte, 1) != 1) _exit(3);
+    for (int i = 0; i < 10; ++i) {
+      if (!Write(ring->get(), i, absl::Seconds(10)).ok()) _exit(4);
+    }
+    // Closes and removes the ring, which the reader keeps mapped.
+    *ring = nullptr;
+    _exit(0);
+  }
+  ASSERT_GT(pid, 0);
+  char byte;
+  ASSERT_EQ(read(created_pipe[0], &byte, 1), 1);
+  MP_ASSERT_OK_AND_ASSIGN(auto ring, SharedMemoryRing::Open(name));
+  MP_ASSERT_OK_AND_ASSIGN(int reader, ring->AddReader(ReadPolicy::kBlocking));
+  ASSERT_EQ(write(registered_pipe[1], &byte, 1), 1);
+
+  std::vector<int> values;
+  SharedMemoryRing::Entry entry;
+  while (ring->Read(reader, absl::Seconds(10), &entry)) {
+    int value;
+    std::memcpy(&value, entry.data, sizeof(value));
+    values.push_back(value);
+    ring->Release(reader, entry);
+  }
+  EXPECT_THAT(values, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+  EXPECT_TRUE(ring->IsDone(reader));
+  int status;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  for (int fd : {created_pipe[0], created_pipe[1], registered_pipe[0],
+                 registered_pipe[1]}) {
+    close(fd);
+  }
+}
+
+TEST(SharedMemoryRingTest, DropsReadersOfKilledProcesses) {
+  const std::string name = RingName("killed");
+  MP_ASSERT_OK_AND_ASSIGN(auto ring, SharedMemoryRing::Create(name, 2, 64));
+  const pid_t pid = fork();
+  if (pid == 0) {
+    // Registers a blocking reader, and exits holding an entry.
+    auto child_ring = SharedMemoryRing::Open(name);
+    if (!child_ring.ok()) _exit(1);
+    auto reader = (*child_ring)->AddReader(ReadPolicy::kBlocking);
+    if (!reader.ok()) _exit(2);
+    SharedMemoryRing::Entry entry;
+    if (!(*child_ring)->Read(*reader, absl::Seconds(10), &entry)) _exit(3);
+    _exit(0);
+  }
+  ASSERT_GT(pid, 0);
+  // Writes until the child pinned an entry and exited. Until then, the
+  // writes can wait for the child.
+  int status;
+  int value = 0;
+  while (waitpid(pid, &status, WNOHANG) == 0) {
+    Write(ring.get(), value++, absl::Milliseconds(1)).IgnoreError();
+  }
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  // The writer would wait forever for the killed reader otherwise.
+  for (int i = 0; i < 4; ++i) {
+    MP_EXPECT_OK(Write(ring.get(), value++, absl::Seconds(10)));
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
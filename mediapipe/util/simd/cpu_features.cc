@@ -0,0 +1,66 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/simd/cpu_features.h"
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+namespace mediapipe {
+namespace simd {
+
+namespace {
+
+CpuFeatures DetectCpuFeatures() {
+  CpuFeatures features;
+#if defined(__x86_64__) || defined(__i386__)
+#if defined(__GNUC__) || defined(__clang__)
+  // These also check that the OS saves the AVX registers.
+  __builtin_cpu_init();
+  features.avx2 = __builtin_cpu_supports("avx2");
+  features.fma = __builtin_cpu_supports("fma");
+  features.avx512f = __builtin_cpu_supports("avx512f");
+#endif
+#if defined(__AVX2__)
+  features.avx2 = true;
+#endif
+#if defined(__FMA__)
+  features.fma = true;
+#endif
+#if defined(__AVX512F__)
+  features.avx512f = true;
+#endif
+#endif  // __x86_64__ || __i386__
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  features.neon = true;
+#endif
+#if defined(__ARM_FEATURE_SVE)
+  features.sve = true;
+#elif defined(__aarch64__) && defined(__linux__) && defined(HWCAP_SVE)
+  features.sve = (getauxval(AT_HWCAP) & HWCAP_SVE) != 0;
+#endif
+  return features;
+}
+
+}  // namespace
+
+const CpuFeatures& GetCpuFeatures() {
+  static const CpuFeatures features = DetectCpuFeatures();
+  return features;
+}
+
+}  // namespace simd
+}  // namespace mediapipe
@@ -0,0 +1,40 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_SIMD_CPU_FEATURES_H_
+#define MEDIAPIPE_UTIL_SIMD_CPU_FEATURES_H_
+
+namespace mediapipe {
+namespace simd {
+
+// The instruction set extensions that the CPU and the OS support, as far as
+// the SIMD kernels are concerned.
+struct CpuFeatures {
+  // x86.
+  bool avx2 = false;
+  bool fma = false;
+  bool avx512f = false;
+  // ARM.
+  bool neon = false;
+  bool sve = false;
+};
+
+// Returns the features of the CPU running the process, detected on the first
+// call. Features the binary is compiled for are always reported.
+const CpuFeatures& GetCpuFeatures();
+
+}  // namespace simd
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_SIMD_CPU_FEATURES_H_
@@ -0,0 +1,75 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The per-target implementations behind simd.h. Not for use outside of
+// mediapipe/util/simd, except by tests comparing the targets.
+
+#ifndef MEDIAPIPE_UTIL_SIMD_KERNELS_H_
+#define MEDIAPIPE_UTIL_SIMD_KERNELS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "mediapipe/util/simd/simd.h"
+
+// x86 targets are compiled with function target attributes, which GCC and
+// Clang support.
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define MEDIAPIPE_SIMD_X86 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MEDIAPIPE_SIMD_NEON 1
+#endif
+
+namespace mediapipe {
+namespace simd {
+namespace internal {
+
+// The implementations of the primitives of simd.h for one target.
+struct Kernels {
+  const char* name;
+  float (*dot_product_f32)(const float* u, const float* v, int size);
+  int32_t (*dot_product_i8)(const int8_t* u, const int8_t* v, int size);
+  void (*scale_and_bias_u8)(const uint8_t* src, int size, float scale,
+                            float bias, float* dst);
+  void (*scale_and_bias_f32)(const float* src, int size, float scale,
+                             float bias, float* dst);
+  void (*blend_rows)(const float* a, const float* b, float weight_a,
+                     float weight_b, float offset, int size, float* out);
+  void (*sigmoid)(float* values, int size);
+  // Writes exp(src[i] - shift) to dst[i], and returns their sum.
+  float (*exp_and_sum)(const float* src, int size, float shift, float* dst);
+  void (*box_iou)(const Box& box, const BoxArrays& boxes, int size,
+                  float* ious);
+};
+
+// The kernels of each target, or nullptr for the targets that are not
+// compiled in. Targets may reuse the kernels of a lesser one where they have
+// nothing better.
+const Kernels& ScalarKernels();
+const Kernels* Avx2Kernels();
+const Kernels* Avx512Kernels();
+const Kernels* NeonKernels();
+
+// Returns the kernels that the CPU can run, from the portable ones to the
+// best ones.
+std::vector<const Kernels*> SupportedKernels();
+
+}  // namespace internal
+}  // namespace simd
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_SIMD_KERNELS_H_
@@ -0,0 +1,250 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The NEON kernels, compiled in when the target has NEON. They keep to the
+// ARMv7 instructions, with AArch64 divisions and dot products where the
+// target has them.
+
+#include "mediapipe/util/simd/kernels.h"
+
+#if MEDIAPIPE_SIMD_NEON
+
+#include <arm_neon.h>
+
+#include <cstdint>
+
+#include "mediapipe/util/simd/scalar_inl.h"
+#include "mediapipe/util/simd/simd.h"
+
+namespace mediapipe {
+namespace simd {
+namespace internal {
+
+namespace {
+
+inline float HorizontalSum(float32x4_t v) {
+  return vgetq_lane_f32(v, 0) + vgetq_lane_f32(v, 1) + vgetq_lane_f32(v, 2) +
+         vgetq_lane_f32(v, 3);
+}
+
+inline int32_t HorizontalSum(int32x4_t v) {
+  return vgetq_lane_s32(v, 0) + vgetq_lane_s32(v, 1) + vgetq_lane_s32(v, 2) +
+         vgetq_lane_s32(v, 3);
+}
+
+// Returns numerator / denominator. ARMv7 has no division, so the reciprocal
+// is refined twice from its estimate there.
+inline float32x4_t Divide(float32x4_t numerator, float32x4_t denominator) {
+#if defined(__aarch64__)
+  return vdivq_f32(numerator, denominator);
+#else
+  float32x4_t inverse = vrecpeq_f32(denominator);
+  inverse = vmulq_f32(vrecpsq_f32(denominator, inverse), inverse);
+  inverse = vmulq_f32(vrecpsq_f32(denominator, inverse), inverse);
+  return vmulq_f32(numerator, inverse);
+#endif
+}
+
+// The approximation of Exp() in scalar_inl.h.
+inline float32x4_t Exp4(float32x4_t value) {
+  const float32x4_t x =
+      vminq_f32(vmaxq_f32(value, vdupq_n_f32(kExpMin)), vdupq_n_f32(kExpMax));
+  // floor(t) from the truncation, corrected for negative t.
+  const float32x4_t t = vmlaq_n_f32(vdupq_n_f32(0.5f), x, kLog2e);
+  int32x4_t n_int = vcvtq_s32_f32(t);
+  n_int = vsubq_s32(n_int, vreinterpretq_s32_u32(vshrq_n_u32(
+                               vcgtq_f32(vcvtq_f32_s32(n_int), t), 31)));
+  const float32x4_t n = vcvtq_f32_s32(n_int);
+  float32x4_t r = vmlsq_n_f32(x, n, kLn2Hi);
+  r = vmlsq_n_f32(r, n, kLn2Lo);
+  float32x4_t p = vdupq_n_f32(kExpP0);
+  p = vmlaq_f32(vdupq_n_f32(kExpP1), p, r);
+  p = vmlaq_f32(vdupq_n_f32(kExpP2), p, r);
+  p = vmlaq_f32(vdupq_n_f32(kExpP3), p, r);
+  p = vmlaq_f32(vdupq_n_f32(kExpP4), p, r);
+  p = vmlaq_f32(vdupq_n_f32(kExpP5), p, r);
+  p = vaddq_f32(vmlaq_f32(r, vmulq_f32(p, r), r), vdupq_n_f32(1.0f));
+  const float32x4_t pow2n = vreinterpretq_f32_s32(
+      vshlq_n_s32(vaddq_s32(n_int, vdupq_n_s32(127)), 23));
+  return vmulq_f32(p, pow2n);
+}
+
+float DotProductF32Neon(const float* u, const float* v, int size) {
+  float32x4_t sum0 = vdupq_n_f32(0.0f);
+  float32x4_t sum1 = vdupq_n_f32(0.0f);
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    sum0 = vmlaq_f32(sum0, vld1q_f32(u + i), vld1q_f32(v + i));
+    sum1 = vmlaq_f32(sum1, vld1q_f32(u + i + 4), vld1q_f32(v + i + 4));
+  }
+  float result = HorizontalSum(vaddq_f32(sum0, sum1));
+  for (; i < size; ++i) result += u[i] * v[i];
+  return result;
+}
+
+int32_t DotProductI8Neon(const int8_t* u, const int8_t* v, int size) {
+  int32x4_t sum = vdupq_n_s32(0);
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const int8x16_t a = vld1q_s8(u + i);
+    const int8x16_t b = vld1q_s8(v + i);
+#if defined(__ARM_FEATURE_DOTPROD)
+    sum = vdotq_s32(sum, a, b);
+#else
+    // The products of int8 values fit in 16 bits.
+    sum = vpadalq_s16(sum, vmull_s8(vget_low_s8(a), vget_low_s8(b)));
+    sum = vpadalq_s16(sum, vmull_s8(vget_high_s8(a), vget_high_s8(b)));
+#endif  // __ARM_FEATURE_DOTPROD
+  }
+  int32_t result = HorizontalSum(sum);
+  for (; i < size; ++i) {
+    result += static_cast<int32_t>(u[i]) * static_cast<int32_t>(v[i]);
+  }
+  return result;
+}
+
+void ScaleAndBiasU8Neon(const uint8_t* src, int size, float scale, float bias,
+                        float* dst) {
+  const float32x4_t b = vdupq_n_f32(bias);
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const uint16x8_t v = vmovl_u8(vld1_u8(src + i));
+    const float32x4_t lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(v)));
+    const float32x4_t hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(v)));
+    vst1q_f32(dst + i, vmlaq_n_f32(b, lo, scale));
+    vst1q_f32(dst + i + 4, vmlaq_n_f32(b, hi, scale));
+  }
+  for (; i < size; ++i) dst[i] = src[i] * scale + bias;
+}
+
+void ScaleAndBiasF32Neon(const float* src, int size, float scale, float bias,
+                         float* dst) {
+  const float32x4_t b = vdupq_n_f32(bias);
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    vst1q_f32(dst + i, vmlaq_n_f32(b, vld1q_f32(src + i), scale));
+  }
+  for (; i < size; ++i) dst[i] = src[i] * scale + bias;
+}
+
+void BlendRowsNeon(const float* a, const float* b, float weight_a,
+                   float weight_b, float offset, int size, float* out) {
+  const float32x4_t off = vdupq_n_f32(offset);
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    float32x4_t v = vmlaq_n_f32(off, vld1q_f32(a + i), weight_a);
+    v = vmlaq_n_f32(v, vld1q_f32(b + i), weight_b);
+    vst1q_f32(out + i, v);
+  }
+  for (; i < size; ++i) out[i] = a[i] * weight_a + b[i] * weight_b + offset;
+}
+
+void SigmoidNeon(float* values, int size) {
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const float32x4_t e = Exp4(vnegq_f32(vld1q_f32(values + i)));
+    vst1q_f32(values + i, Divide(one, vaddq_f32(one, e)));
+  }
+  for (; i < size; ++i) values[i] = Sigmoid(values[i]);
+}
+
+float ExpAndSumNeon(const float* src, int size, float shift, float* dst) {
+  const float32x4_t s = vdupq_n_f32(shift);
+  float32x4_t sum = vdupq_n_f32(0.0f);
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const float32x4_t e = Exp4(vsubq_f32(vld1q_f32(src + i), s));
+    vst1q_f32(dst + i, e);
+    sum = vaddq_f32(sum, e);
+  }
+  float result = HorizontalSum(sum);
+  for (; i < size; ++i) {
+    dst[i] = Exp(src[i] - shift);
+    result += dst[i];
+  }
+  return result;
+}
+
+void BoxIoUNeon(const Box& box, const BoxArrays& boxes, int size,
+                float* ious) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t xmin = vdupq_n_f32(box.xmin);
+  const float32x4_t ymin = vdupq_n_f32(box.ymin);
+  const float32x4_t xmax = vdupq_n_f32(box.xmax);
+  const float32x4_t ymax = vdupq_n_f32(box.ymax);
+  const float32x4_t area = vmulq_f32(vmaxq_f32(vsubq_f32(xmax, xmin), zero),
+                                     vmaxq_f32(vsubq_f32(ymax, ymin), zero));
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const float32x4_t other_xmin = vld1q_f32(boxes.xmin + i);
+    const float32x4_t other_ymin = vld1q_f32(boxes.ymin + i);
+    const float32x4_t other_xmax = vld1q_f32(boxes.xmax + i);
+    const float32x4_t other_ymax = vld1q_f32(boxes.ymax + i);
+    const float32x4_t other_area =
+        vmulq_f32(vmaxq_f32(vsubq_f32(other_xmax, other_xmin), zero),
+                  vmaxq_f32(vsubq_f32(other_ymax, other_ymin), zero));
+    const float32x4_t width = vmaxq_f32(
+        vsubq_f32(vminq_f32(xmax, other_xmax), vmaxq_f32(xmin, other_xmin)),
+        zero);
+    const float32x4_t height = vmaxq_f32(
+        vsubq_f32(vminq_f32(ymax, other_ymax), vmaxq_f32(ymin, other_ymin)),
+        zero);
+    const float32x4_t intersection = vmulq_f32(width, height);
+    const float32x4_t union_area =
+        vsubq_f32(vaddq_f32(area, other_area), intersection);
+    // Masks out the quotients of empty unions, which may be NaN.
+    const uint32x4_t non_empty = vcgtq_f32(union_area, zero);
+    vst1q_f32(ious + i, vreinterpretq_f32_u32(vandq_u32(
+                            non_empty, vreinterpretq_u32_f32(Divide(
+                                           intersection, union_area)))));
+  }
+  for (; i < size; ++i) {
+    ious[i] = IoU(box, boxes.xmin[i], boxes.ymin[i], boxes.xmax[i],
+                  boxes.ymax[i]);
+  }
+}
+
+}  // namespace
+
+const Kernels* NeonKernels() {
+  static const Kernels kernels = {"neon",
+                                  DotProductF32Neon,
+                                  DotProductI8Neon,
+                                  ScaleAndBiasU8Neon,
+                                  ScaleAndBiasF32Neon,
+                                  BlendRowsNeon,
+                                  SigmoidNeon,
+                                  ExpAndSumNeon,
+                                  BoxIoUNeon};
+  return &kernels;
+}
+
+}  // namespace internal
+}  // namespace simd
+}  // namespace mediapipe
+
+#else  // MEDIAPIPE_SIMD_NEON
+
+namespace mediapipe {
+namespace simd {
+namespace internal {
+
+const Kernels* NeonKernels() { return nullptr; }
+
+}  // namespace internal
+}  // namespace simd
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_SIMD_NEON
@@ -0,0 +1,93 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+
+#include "mediapipe/util/simd/kernels.h"
+#include "mediapipe/util/simd/scalar_inl.h"
+#include "mediapipe/util/simd/simd.h"
+
+namespace mediapipe {
+namespace simd {
+namespace internal {
+
+namespace {
+
+float DotProductF32(const float* u, const float* v, int size) {
+  float result = 0.0f;
+  for (int i = 0; i < size; ++i) result += u[i] * v[i];
+  return result;
+}
+
+int32_t DotProductI8(const int8_t* u, const int8_t* v, int size) {
+  int32_t result = 0;
+  for (int i = 0; i < size; ++i) {
+    result += static_cast<int32_t>(u[i]) * static_cast<int32_t>(v[i]);
+  }
+  return result;
+}
+
+template <typename T>
+void ScaleAndBias(const T* src, int size, float scale, float bias,
+                  float* dst) {
+  for (int i = 0; i < size; ++i) {
+    dst[i] = static_cast<float>(src[i]) * scale + bias;
+  }
+}
+
+void BlendRows(const float* a, const float* b, float weight_a, float weight_b,
+               float offset, int size, float* out) {
+  for (int i = 0; i < size; ++i) {
+    out[i] = a[i] * weight_a + b[i] * weight_b + offset;
+  }
+}
+
+void SigmoidInPlace(float* values, int size) {
+  for (int i = 0; i < size; ++i) values[i] = Sigmoid(values[i]);
+}
+
+float ExpAndSum(const float* src, int size, float shift, float* dst) {
+  float sum = 0.0f;
+  for (int i = 0; i < size; ++i) {
+    dst[i] = Exp(src[i] - shift);
+    sum += dst[i];
+  }
+  return sum;
+}
+
+void BoxIoU(const Box& box, const BoxArrays& boxes, int size, float* ious) {
+  for (int i = 0; i < size; ++i) {
+    ious[i] = IoU(box, boxes.xmin[i], boxes.ymin[i], boxes.xmax[i],
+                  boxes.ymax[i]);
+  }
+}
+
+}  // namespace
+
+const Kernels& ScalarKernels() {
+  static const Kernels kernels = {"scalar",
+                                   DotProductF32,
+                                   DotProductI8,
+                                   ScaleAndBias<uint8_t>,
+                                   ScaleAndBias<float>,
+                                   BlendRows,
+                                   SigmoidInPlace,
+                                   ExpAndSum,
+                                   BoxIoU};
+  return kernels;
+}
+
+}  // namespace internal
+}  // namespace simd
+}  // namespace mediapipe
@@ -0,0 +1,338 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The AVX2 and AVX-512 kernels. Each function is compiled for its target with
+// a target attribute, so that this file needs no special flags, and is only
+// called once the CPU is known to support the target. Helpers carry the same
+// attribute, which lets them be inlined.
+
+#include "mediapipe/util/simd/kernels.h"
+
+#if MEDIAPIPE_SIMD_X86
+
+#include <immintrin.h>
+
+#include <cstdint>
+
+#include "mediapipe/util/simd/scalar_inl.h"
+#include "mediapipe/util/simd/simd.h"
+
+#define MEDIAPIPE_SIMD_AVX2 __attribute__((target("avx2,fma")))
+#define MEDIAPIPE_SIMD_AVX512 __attribute__((target("avx512f,avx2,fma")))
+
+namespace mediapipe {
+namespace simd {
+namespace internal {
+
+namespace {
+
+// AVX2 with FMA.
+
+MEDIAPIPE_SIMD_AVX2 inline float HorizontalSum(__m256 v) {
+  __m128 sum =
+      _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+  return _mm_cvtss_f32(sum);
+}
+
+MEDIAPIPE_SIMD_AVX2 inline int32_t HorizontalSum(__m256i v) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v),
+                              _mm256_extracti128_si256(v, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+// The approximation of Exp() in scalar_inl.h.
+MEDIAPIPE_SIMD_AVX2 inline __m256 Exp8(__m256 value) {
+  const __m256 x = _mm256_min_ps(_mm256_max_ps(value, _mm256_set1_ps(kExpMin)),
+                                 _mm256_set1_ps(kExpMax));
+  const __m256 n = _mm256_floor_ps(_mm256_add_ps(
+      _mm256_mul_ps(x, _mm256_set1_ps(kLog2e)), _mm256_set1_ps(0.5f)));
+  __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(kLn2Hi), x);
+  r = _mm256_fnmadd_ps(n, _mm256_set1_ps(kLn2Lo), r);
+  __m256 p = _mm256_set1_ps(kExpP0);
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP1));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP2));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP3));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP4));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(kExpP5));
+  p = _mm256_fmadd_ps(_mm256_mul_ps(p, r), r,
+                      _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+  const __m256 pow2n = _mm256_castsi256_ps(_mm256_slli_epi32(
+      _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23));
+  return _mm256_mul_ps(p, pow2n);
+}
+
+MEDIAPIPE_SIMD_AVX2 float DotProductF32Avx2(const float* u, const float* v,
+                                            int size) {
+  // Two accumulators hide the latency of the multiply-adds.
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(u + i), _mm256_loadu_ps(v + i),
+                           sum0);
+    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(u + i + 8),
+                           _mm256_loadu_ps(v + i + 8), sum1);
+  }
+  float result = HorizontalSum(_mm256_add_ps(sum0, sum1));
+  for (; i < size; ++i) result += u[i] * v[i];
+  return result;
+}
+
+MEDIAPIPE_SIMD_AVX2 int32_t DotProductI8Avx2(const int8_t* u, const int8_t* v,
+                                             int size) {
+  __m256i sum = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    // Sign-extends to 16 bits, then multiplies and adds adjacent pairs.
+    const __m256i a = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i)));
+    const __m256i b = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i)));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, b));
+  }
+  int32_t result = HorizontalSum(sum);
+  for (; i < size; ++i) {
+    result += static_cast<int32_t>(u[i]) * static_cast<int32_t>(v[i]);
+  }
+  return result;
+}
+
+MEDIAPIPE_SIMD_AVX2 void ScaleAndBiasU8Avx2(const uint8_t* src, int size,
+                                            float scale, float bias,
+                                            float* dst) {
+  const __m256 s = _mm256_set1_ps(scale);
+  const __m256 b = _mm256_set1_ps(bias);
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i))));
+    _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(v, s, b));
+  }
+  for (; i < size; ++i) dst[i] = src[i] * scale + bias;
+}
+
+MEDIAPIPE_SIMD_AVX2 void ScaleAndBiasF32Avx2(const float* src, int size,
+                                             float scale, float bias,
+                                             float* dst) {
+  const __m256 s = _mm256_set1_ps(scale);
+  const __m256 b = _mm256_set1_ps(bias);
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    _mm256_storeu_ps(dst + i,
+                     _mm256_fmadd_ps(_mm256_loadu_ps(src + i), s, b));
+  }
+  for (; i < size; ++i) dst[i] = src[i] * scale + bias;
+}
+
+MEDIAPIPE_SIMD_AVX2 void BlendRowsAvx2(const float* a, const float* b,
+                                       float weight_a, float weight_b,
+                                       float offset, int size, float* out) {
+  const __m256 wa = _mm256_set1_ps(weight_a);
+  const __m256 wb = _mm256_set1_ps(weight_b);
+  const __m256 off = _mm256_set1_ps(offset);
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256 v = _mm256_fmadd_ps(_mm256_loadu_ps(b + i), wb, off);
+    _mm256_storeu_ps(out + i, _mm256_fmadd_ps(_mm256_loadu_ps(a + i), wa, v));
+  }
+  for (; i < size; ++i) out[i] = a[i] * weight_a + b[i] * weight_b + offset;
+}
+
+MEDIAPIPE_SIMD_AVX2 void SigmoidAvx2(float* values, int size) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256 e = Exp8(_mm256_xor_ps(_mm256_loadu_ps(values + i), sign));
+    _mm256_storeu_ps(values + i, _mm256_div_ps(one, _mm256_add_ps(one, e)));
+  }
+  for (; i < size; ++i) values[i] = Sigmoid(values[i]);
+}
+
+MEDIAPIPE_SIMD_AVX2 float ExpAndSumAvx2(const float* src, int size,
+                                        float shift, float* dst) {
+  const __m256 s = _mm256_set1_ps(shift);
+  __m256 sum = _mm256_setzero_ps();
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256 e = Exp8(_mm256_sub_ps(_mm256_loadu_ps(src + i), s));
+    _mm256_storeu_ps(dst + i, e);
+    sum = _mm256_add_ps(sum, e);
+  }
+  float result = HorizontalSum(sum);
+  for (; i < size; ++i) {
+    dst[i] = Exp(src[i] - shift);
+    result += dst[i];
+  }
+  return result;
+}
+
+MEDIAPIPE_SIMD_AVX2 void BoxIoUAvx2(const Box& box, const BoxArrays& boxes,
+                                    int size, float* ious) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 xmin = _mm256_set1_ps(box.xmin);
+  const __m256 ymin = _mm256_set1_ps(box.ymin);
+  const __m256 xmax = _mm256_set1_ps(box.xmax);
+  const __m256 ymax = _mm256_set1_ps(box.ymax);
+  const __m256 area =
+      _mm256_mul_ps(_mm256_max_ps(_mm256_sub_ps(xmax, xmin), zero),
+                    _mm256_max_ps(_mm256_sub_ps(ymax, ymin), zero));
+  int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    const __m256 other_xmin = _mm256_loadu_ps(boxes.xmin + i);
+    const __m256 other_ymin = _mm256_loadu_ps(boxes.ymin + i);
+    const __m256 other_xmax = _mm256_loadu_ps(boxes.xmax + i);
+    const __m256 other_ymax = _mm256_loadu_ps(boxes.ymax + i);
+    const __m256 other_area = _mm256_mul_ps(
+        _mm256_max_ps(_mm256_sub_ps(other_xmax, other_xmin), zero),
+        _mm256_max_ps(_mm256_sub_ps(other_ymax, other_ymin), zero));
+    const __m256 width = _mm256_max_ps(
+        _mm256_sub_ps(_mm256_min_ps(xmax, other_xmax),
+                      _mm256_max_ps(xmin, other_xmin)),
+        zero);
+    const __m256 height = _mm256_max_ps(
+        _mm256_sub_ps(_mm256_min_ps(ymax, other_ymax),
+                      _mm256_max_ps(ymin, other_ymin)),
+        zero);
+    const __m256 intersection = _mm256_mul_ps(width, height);
+    const __m256 union_area =
+        _mm256_sub_ps(_mm256_add_ps(area, other_area), intersection);
+    // Masks out the quotients of empty unions, which may be NaN.
+    _mm256_storeu_ps(
+        ious + i,
+        _mm256_and_ps(_mm256_cmp_ps(union_area, zero, _CMP_GT_OQ),
+                      _mm256_div_ps(intersection, union_area)));
+  }
+  for (; i < size; ++i) {
+    ious[i] = IoU(box, boxes.xmin[i], boxes.ymin[i], boxes.xmax[i],
+                  boxes.ymax[i]);
+  }
+}
+
+// AVX-512. Only the kernels bound by streaming through memory are widened;
+// the others gain little over AVX2, and the int8 ones would need AVX-512BW.
+
+MEDIAPIPE_SIMD_AVX512 float DotProductF32Avx512(const float* u,
+                                                const float* v, int size) {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+  int i = 0;
+  for (; i + 32 <= size; i += 32) {
+    sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(u + i), _mm512_loadu_ps(v + i),
+                           sum0);
+    sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(u + i + 16),
+                           _mm512_loadu_ps(v + i + 16), sum1);
+  }
+  if (i + 16 <= size) {
+    sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(u + i), _mm512_loadu_ps(v + i),
+                           sum0);
+    i += 16;
+  }
+  float result = _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+  for (; i < size; ++i) result += u[i] * v[i];
+  return result;
+}
+
+MEDIAPIPE_SIMD_AVX512 void ScaleAndBiasU8Avx512(const uint8_t* src, int size,
+                                                float scale, float bias,
+                                                float* dst) {
+  const __m512 s = _mm512_set1_ps(scale);
+  const __m512 b = _mm512_set1_ps(bias);
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m512 v = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+    _mm512_storeu_ps(dst + i, _mm512_fmadd_ps(v, s, b));
+  }
+  for (; i < size; ++i) dst[i] = src[i] * scale + bias;
+}
+
+MEDIAPIPE_SIMD_AVX512 void ScaleAndBiasF32Avx512(const float* src, int size,
+                                                 float scale, float bias,
+                                                 float* dst) {
+  const __m512 s = _mm512_set1_ps(scale);
+  const __m512 b = _mm512_set1_ps(bias);
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    _mm512_storeu_ps(dst + i,
+                     _mm512_fmadd_ps(_mm512_loadu_ps(src + i), s, b));
+  }
+  for (; i < size; ++i) dst[i] = src[i] * scale + bias;
+}
+
+MEDIAPIPE_SIMD_AVX512 void BlendRowsAvx512(const float* a, const float* b,
+                                           float weight_a, float weight_b,
+                                           float offset, int size,
+                                           float* out) {
+  const __m512 wa = _mm512_set1_ps(weight_a);
+  const __m512 wb = _mm512_set1_ps(weight_b);
+  const __m512 off = _mm512_set1_ps(offset);
+  int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m512 v = _mm512_fmadd_ps(_mm512_loadu_ps(b + i), wb, off);
+    _mm512_storeu_ps(out + i, _mm512_fmadd_ps(_mm512_loadu_ps(a + i), wa, v));
+  }
+  for (; i < size; ++i) out[i] = a[i] * weight_a + b[i] * weight_b + offset;
+}
+
+}  // namespace
+
+const Kernels* Avx2Kernels() {
+  static const Kernels kernels = {"avx2",
+                                  DotProductF32Avx2,
+                                  DotProductI8Avx2,
+                                  ScaleAndBiasU8Avx2,
+                                  ScaleAndBiasF32Avx2,
+                                  BlendRowsAvx2,
+                                  SigmoidAvx2,
+                                  ExpAndSumAvx2,
+                                  BoxIoUAvx2};
+  return &kernels;
+}
+
+const Kernels* Avx512Kernels() {
+  static const Kernels kernels = [] {
+    Kernels kernels = *Avx2Kernels();
+    kernels.name = "avx512";
+    kernels.dot_product_f32 = DotProductF32Avx512;
+    kernels.scale_and_bias_u8 = ScaleAndBiasU8Avx512;
+    kernels.scale_and_bias_f32 = ScaleAndBiasF32Avx512;
+    kernels.blend_rows = BlendRowsAvx512;
+    return kernels;
+  }();
+  return &kernels;
+}
+
+}  // namespace internal
+}  // namespace simd
+}  // namespace mediapipe
+
+#else  // MEDIAPIPE_SIMD_X86
+
+namespace mediapipe {
+namespace simd {
+namespace internal {
+
+const Kernels* Avx2Kernels() { return nullptr; }
+const Kernels* Avx512Kernels() { return nullptr; }
+
+}  // namespace internal
+}  // namespace simd
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_SIMD_X86
@@ -0,0 +1,87 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Scalar versions of the kernels' element-wise operations, used by the
+// portable kernels and for the remainders of the vector ones. The vector
+// kernels compute the same approximations.
+
+#ifndef MEDIAPIPE_UTIL_SIMD_SCALAR_INL_H_
+#define MEDIAPIPE_UTIL_SIMD_SCALAR_INL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "mediapipe/util/simd/simd.h"
+
+namespace mediapipe {
+namespace simd {
+namespace internal {
+
+// exp(x) is computed as 2^n * exp(r), with n = round(x / ln(2)) and
+// |r| <= ln(2) / 2, and exp(r) approximated by a polynomial (as in Cephes'
+// expf), to about 2 ulp. Arguments are clamped so that 2^n stays a normal
+// float, or becomes +inf above kExpMax.
+constexpr float kExpMin = -87.3f;
+constexpr float kExpMax = 89.0f;
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kLn2Hi = 0.693359375f;
+constexpr float kLn2Lo = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500e-4f;
+constexpr float kExpP1 = 1.3981999507e-3f;
+constexpr float kExpP2 = 8.3334519073e-3f;
+constexpr float kExpP3 = 4.1665795894e-2f;
+constexpr float kExpP4 = 1.6666665459e-1f;
+constexpr float kExpP5 = 5.0000001201e-1f;
+
+inline float Exp(float value) {
+  const float x = std::clamp(value, kExpMin, kExpMax);
+  const float n = std::floor(x * kLog2e + 0.5f);
+  const float r = x - n * kLn2Hi - n * kLn2Lo;
+  float p = kExpP0;
+  p = p * r + kExpP1;
+  p = p * r + kExpP2;
+  p = p * r + kExpP3;
+  p = p * r + kExpP4;
+  p = p * r + kExpP5;
+  p = p * r * r + r + 1.0f;
+  const uint32_t bits = static_cast<uint32_t>(static_cast<int32_t>(n) + 127)
+                        << 23;
+  float pow2n;
+  std::memcpy(&pow2n, &bits, sizeof(pow2n));
+  return p * pow2n;
+}
+
+// Gives exactly 0 for values below -kExpMax, where Exp(-value) is +inf.
+inline float Sigmoid(float value) { return 1.0f / (1.0f + Exp(-value)); }
+
+inline float IoU(const Box& a, float xmin, float ymin, float xmax,
+                 float ymax) {
+  const float area_a =
+      std::max(a.xmax - a.xmin, 0.0f) * std::max(a.ymax - a.ymin, 0.0f);
+  const float area_b =
+      std::max(xmax - xmin, 0.0f) * std::max(ymax - ymin, 0.0f);
+  const float intersection =
+      std::max(std::min(a.xmax, xmax) - std::max(a.xmin, xmin), 0.0f) *
+      std::max(std::min(a.ymax, ymax) - std::max(a.ymin, ymin), 0.0f);
+  const float union_area = area_a + area_b - intersection;
+  return union_area > 0.0f ? intersection / union_area : 0.0f;
+}
+
+}  // namespace internal
+}  // namespace simd
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_SIMD_SCALAR_INL_H_
@@ -0,0 +1,97 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/simd/simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "mediapipe/util/simd/cpu_features.h"
+#include "mediapipe/util/simd/kernels.h"
+
+namespace mediapipe {
+namespace simd {
+
+namespace internal {
+
+std::vector<const Kernels*> SupportedKernels() {
+  const CpuFeatures& features = GetCpuFeatures();
+  std::vector<const Kernels*> kernels = {&ScalarKernels()};
+  if (NeonKernels() && features.neon) {
+    kernels.push_back(NeonKernels());
+  }
+  if (Avx2Kernels() && features.avx2 && features.fma) {
+    kernels.push_back(Avx2Kernels());
+    if (Avx512Kernels() && features.avx512f) {
+      kernels.push_back(Avx512Kernels());
+    }
+  }
+  return kernels;
+}
+
+}  // namespace internal
+
+namespace {
+
+const internal::Kernels& Active() {
+  static const internal::Kernels* const kernels =
+      internal::SupportedKernels().back();
+  return *kernels;
+}
+
+}  // namespace
+
+const char* ActiveTarget() { return Active().name; }
+
+float DotProduct(const float* u, const float* v, int size) {
+  return Active().dot_product_f32(u, v, size);
+}
+
+int32_t DotProduct(const int8_t* u, const int8_t* v, int size) {
+  return Active().dot_product_i8(u, v, size);
+}
+
+void ScaleAndBias(const uint8_t* src, int size, float scale, float bias,
+                  float* dst) {
+  Active().scale_and_bias_u8(src, size, scale, bias, dst);
+}
+
+void ScaleAndBias(const float* src, int size, float scale, float bias,
+                  float* dst) {
+  Active().scale_and_bias_f32(src, size, scale, bias, dst);
+}
+
+void BlendRows(const float* a, const float* b, float weight_a, float weight_b,
+               float offset, int size, float* out) {
+  Active().blend_rows(a, b, weight_a, weight_b, offset, size, out);
+}
+
+void Sigmoid(float* values, int size) { Active().sigmoid(values, size); }
+
+void Softmax(const float* src, int size, float* dst) {
+  if (size <= 0) return;
+  const internal::Kernels& kernels = Active();
+  const float max = *std::max_element(src, src + size);
+  // The sum is at least 1, from the maximum.
+  const float sum = kernels.exp_and_sum(src, size, max, dst);
+  kernels.scale_and_bias_f32(dst, size, 1.0f / sum, 0.0f, dst);
+}
+
+void BoxIoU(const Box& box, const BoxArrays& boxes, int size, float* ious) {
+  Active().box_iou(box, boxes, size, ious);
+}
+
+}  // namespace simd
+}  // namespace mediapipe
@@ -0,0 +1,93 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Vectorized primitives shared by the CPU kernels of the calculators and
+// tasks, with the instruction set chosen at runtime.
+//
+// Every primitive has a portable implementation, and faster ones for some of
+// AVX2 (with FMA), AVX-512 and NEON. The first call picks the best one the CPU
+// supports (see cpu_features.h), so that a single binary built for the x86-64
+// baseline still uses AVX2 or AVX-512 where available. x86 targets are built
+// with function target attributes, and need no special compiler flags. NEON
+// is used when the binary is compiled for it, as on all arm64 targets.
+//
+// The implementations compute the same approximations and differ by rounding
+// only: float sums may be accumulated in a different order, multiply-adds may
+// be fused, and 32-bit ARM divides through refined reciprocal estimates.
+
+#ifndef MEDIAPIPE_UTIL_SIMD_SIMD_H_
+#define MEDIAPIPE_UTIL_SIMD_SIMD_H_
+
+#include <cstdint>
+
+namespace mediapipe {
+namespace simd {
+
+// Returns the name of the implementation in use, e.g. "avx2", for logging.
+const char* ActiveTarget();
+
+// Returns the dot product of the float vectors `u` and `v` of size `size`.
+float DotProduct(const float* u, const float* v, int size);
+
+// Returns the dot product of the int8 vectors `u` and `v` of size `size`,
+// accumulated exactly in 32 bits, which holds for fewer than 2^17 elements.
+int32_t DotProduct(const int8_t* u, const int8_t* v, int size);
+
+// Writes src[i] * scale + bias to dst[i], e.g. to normalize image values into
+// a tensor. `dst` may be `src` for floats.
+void ScaleAndBias(const uint8_t* src, int size, float scale, float bias,
+                  float* dst);
+void ScaleAndBias(const float* src, int size, float scale, float bias,
+                  float* dst);
+
+// Writes a[i] * weight_a + b[i] * weight_b + offset to out[i]: the vertical
+// pass of bilinear resampling, where `a` and `b` are two horizontally
+// resampled source rows, with a normalization folded in.
+void BlendRows(const float* a, const float* b, float weight_a, float weight_b,
+               float offset, int size, float* out);
+
+// Replaces values[i] by 1 / (1 + exp(-values[i])). exp is approximated to
+// about 2 ulp, and large negative values give exactly 0.
+void Sigmoid(float* values, int size);
+
+// Writes the softmax of `src` to `dst`, which may be `src`: exp(src[i] - max)
+// normalized to sum to 1, with the exp of Sigmoid().
+void Softmax(const float* src, int size, float* dst);
+
+// An axis-aligned box.
+struct Box {
+  float xmin;
+  float ymin;
+  float xmax;
+  float ymax;
+};
+
+// Boxes as parallel arrays of their coordinates, so that several can be
+// loaded at once.
+struct BoxArrays {
+  const float* xmin;
+  const float* ymin;
+  const float* xmax;
+  const float* ymax;
+};
+
+// Writes the intersection over union of `box` and each of the `size` boxes
+// to ious[i]. Boxes without area count as empty, and the IoU of two empty
+// boxes is 0.
+void BoxIoU(const Box& box, const BoxArrays& boxes, int size, float* ious);
+
+}  // namespace simd
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_SIMD_SIMD_H_
@@ -0,0 +1,245 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/simd/simd.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/simd/kernels.h"
+
+namespace mediapipe {
+namespace simd {
+namespace {
+
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+// Sizes covering empty inputs, remainders, and several vector iterations of
+// every target.
+constexpr int kSizes[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 100};
+
+std::vector<float> RandomFloats(int size, float min, float max,
+                                std::mt19937* rng) {
+  std::uniform_real_distribution<float> distribution(min, max);
+  std::vector<float> values(size);
+  for (float& value : values) value = distribution(*rng);
+  return values;
+}
+
+// Compares the kernels of every target the CPU supports to the scalar ones.
+class SimdKernelsTest : public ::testing::Test {
+ protected:
+  const internal::Kernels& scalar_ = internal::ScalarKernels();
+  const std::vector<const internal::Kernels*> targets_ =
+      internal::SupportedKernels();
+  std::mt19937 rng_{42};
+};
+
+TEST_F(SimdKernelsTest, DotProductF32) {
+  for (const internal::Kernels* target : targets_) {
+    SCOPED_TRACE(target->name);
+    for (int size : kSizes) {
+      const std::vector<float> u = RandomFloats(size, -1.0f, 1.0f, &rng_);
+      const std::vector<float> v = RandomFloats(size, -1.0f, 1.0f, &rng_);
+      EXPECT_NEAR(target->dot_product_f32(u.data(), v.data(), size),
+                  scalar_.dot_product_f32(u.data(), v.data(), size), 1e-4f)
+          << size;
+    }
+  }
+}
+
+TEST_F(SimdKernelsTest, DotProductI8IsExact) {
+  std::uniform_int_distribution<int> distribution(-128, 127);
+  for (const internal::Kernels* target : targets_) {
+    SCOPED_TRACE(target->name);
+    for (int size : kSizes) {
+      std::vector<int8_t> u(size);
+      std::vector<int8_t> v(size);
+      for (int i = 0; i < size; ++i) {
+        u[i] = distribution(rng_);
+        v[i] = distribution(rng_);
+      }
+      EXPECT_EQ(target->dot_product_i8(u.data(), v.data(), size),
+                scalar_.dot_product_i8(u.data(), v.data(), size))
+          << size;
+    }
+    // The extreme products.
+    const std::vector<int8_t> min(32, -128);
+    EXPECT_EQ(target->dot_product_i8(min.data(), min.data(), 32),
+              32 * 128 * 128);
+  }
+}
+
+TEST_F(SimdKernelsTest, ScaleAndBias) {
+  for (const internal::Kernels* target : targets_) {
+    SCOPED_TRACE(target->name);
+    for (int size : kSizes) {
+      std::vector<uint8_t> bytes(size);
+      for (int i = 0; i < size; ++i) bytes[i] = (i * 37) % 256;
+      std::vector<float> expected(size);
+      std::vector<float> actual(size);
+      scalar_.scale_and_bias_u8(bytes.data(), size, 1.0f / 127.5f, -1.0f,
+                                expected.data());
+      target->scale_and_bias_u8(bytes.data(), size, 1.0f / 127.5f, -1.0f,
+                                actual.data());
+      EXPECT_THAT(actual, Pointwise(FloatNear(1e-6f), expected)) << size;
+
+      // In place.
+      const std::vector<float> src = RandomFloats(size, -10.0f, 10.0f, &rng_);
+      scalar_.scale_and_bias_f32(src.data(), size, 0.5f, 2.0f,
+                                 expected.data());
+      actual = src;
+      target->scale_and_bias_f32(actual.data(), size, 0.5f, 2.0f,
+                                 actual.data());
+      EXPECT_THAT(actual, Pointwise(FloatNear(1e-5f), expected)) << size;
+    }
+  }
+}
+
+TEST_F(SimdKernelsTest, BlendRows) {
+  for (const internal::Kernels* target : targets_) {
+    SCOPED_TRACE(target->name);
+    for (int size : kSizes) {
+      const std::vector<float> a = RandomFloats(size, 0.0f, 255.0f, &rng_);
+      const std::vector<float> b = RandomFloats(size, 0.0f, 255.0f, &rng_);
+      std::vector<float> expected(size);
+      std::vector<float> actual(size);
+      scalar_.blend_rows(a.data(), b.data(), 0.3f, 0.7f, -1.0f, size,
+                         expected.data());
+      target->blend_rows(a.data(), b.data(), 0.3f, 0.7f, -1.0f, size,
+                         actual.data());
+      EXPECT_THAT(actual, Pointwise(FloatNear(1e-4f), expected)) << size;
+    }
+  }
+}
+
+TEST_F(SimdKernelsTest, Sigmoid) {
+  for (const internal::Kernels* target : targets_) {
+    SCOPED_TRACE(target->name);
+    for (int size : kSizes) {
+      std::vector<float> values = RandomFloats(size, -20.0f, 20.0f, &rng_);
+      std::vector<float> expected = values;
+      scalar_.sigmoid(expected.data(), size);
+      target->sigmoid(values.data(), size);
+      EXPECT_THAT(values, Pointwise(FloatNear(1e-6f), expected)) << size;
+    }
+    // Saturates without NaNs.
+    std::vector<float> extremes = {-1000.0f, -100.0f, -88.0f, 0.0f,
+                                   88.0f,    100.0f,  1000.0f, 0.0f};
+    target->sigmoid(extremes.data(), extremes.size());
+    EXPECT_THAT(extremes, Pointwise(FloatNear(1e-6f),
+                                    std::vector<float>{0.0f, 0.0f, 0.0f, 0.5f,
+                                                       1.0f, 1.0f, 1.0f,
+                                                       0.5f}));
+  }
+}
+
+TEST_F(SimdKernelsTest, ExpAndSum) {
+  for (const internal::Kernels* target : targets_) {
+    SCOPED_TRACE(target->name);
+    for (int size : kSizes) {
+      const std::vector<float> src = RandomFloats(size, -30.0f, 10.0f, &rng_);
+      std::vector<float> expected(size);
+      std::vector<float> actual(size);
+      const float expected_sum =
+          scalar_.exp_and_sum(src.data(), size, 10.0f, expected.data());
+      const float actual_sum =
+          target->exp_and_sum(src.data(), size, 10.0f, actual.data());
+      EXPECT_NEAR(actual_sum, expected_sum, 1e-5f * (1.0f + expected_sum))
+          << size;
+      for (int i = 0; i < size; ++i) {
+        EXPECT_NEAR(actual[i], expected[i], 1e-6f * expected[i]) << i;
+        EXPECT_NEAR(actual[i], std::exp(src[i] - 10.0f),
+                    4e-7f * expected[i])
+            << i;
+      }
+    }
+  }
+}
+
+TEST_F(SimdKernelsTest, BoxIoU) {
+  for (const internal::Kernels* target : targets_) {
+    SCOPED_TRACE(target->name);
+    for (int size : kSizes) {
+      const std::vector<float> x = RandomFloats(size, 0.0f, 1.0f, &rng_);
+      const std::vector<float> y = RandomFloats(size, 0.0f, 1.0f, &rng_);
+      const std::vector<float> w = RandomFloats(size, -0.1f, 0.5f, &rng_);
+      const std::vector<float> h = RandomFloats(size, -0.1f, 0.5f, &rng_);
+      std::vector<float> xmax(size);
+      std::vector<float> ymax(size);
+      for (int i = 0; i < size; ++i) {
+        xmax[i] = x[i] + w[i];
+        ymax[i] = y[i] + h[i];
+      }
+      const BoxArrays boxes = {x.data(), y.data(), xmax.data(), ymax.data()};
+      const Box box = {0.25f, 0.25f, 0.75f, 0.75f};
+      std::vector<float> expected(size);
+      std::vector<float> actual(size);
+      scalar_.box_iou(box, boxes, size, expected.data());
+      target->box_iou(box, boxes, size, actual.data());
+      EXPECT_THAT(actual, Pointwise(FloatNear(1e-6f), expected)) << size;
+    }
+  }
+}
+
+TEST(SimdTest, UsesBestSupportedTarget) {
+  EXPECT_EQ(std::string(ActiveTarget()),
+            internal::SupportedKernels().back()->name);
+}
+
+TEST(SimdTest, Softmax) {
+  std::vector<float> values = {1.0f, 2.0f, 3.0f, 1000.0f, -1000.0f,
+                               3.0f, 2.0f, 1.0f, 0.0f};
+  Softmax(values.data(), values.size(), values.data());
+  EXPECT_NEAR(values[3], 1.0f, 1e-6f);
+  EXPECT_NEAR(values[0], 0.0f, 1e-6f);
+
+  std::vector<float> logits = {1.0f, 2.0f, 3.0f, 4.0f, 1.0f,
+                               2.0f, 3.0f, 4.0f, 0.5f};
+  std::vector<float> probabilities(logits.size());
+  Softmax(logits.data(), logits.size(), probabilities.data());
+  double sum = 0.0;
+  for (float logit : logits) sum += std::exp(logit);
+  for (int i = 0; i < logits.size(); ++i) {
+    EXPECT_NEAR(probabilities[i], std::exp(logits[i]) / sum, 1e-6f) << i;
+  }
+}
+
+TEST(SimdTest, BoxIoU) {
+  const std::vector<float> xmin = {0.0f, 0.5f, 2.0f, 0.0f};
+  const std::vector<float> ymin = {0.0f, 0.0f, 2.0f, 0.0f};
+  const std::vector<float> xmax = {1.0f, 1.5f, 3.0f, 0.0f};
+  const std::vector<float> ymax = {1.0f, 1.0f, 3.0f, 0.0f};
+  std::vector<float> ious(4);
+  BoxIoU({0.0f, 0.0f, 1.0f, 1.0f},
+         {xmin.data(), ymin.data(), xmax.data(), ymax.data()}, 4, ious.data());
+  EXPECT_THAT(ious, Pointwise(FloatNear(1e-6f),
+                              std::vector<float>{1.0f, 1.0f / 3, 0.0f, 0.0f}));
+
+  // Two empty boxes.
+  BoxIoU({0.0f, 0.0f, 0.0f, 0.0f},
+         {xmin.data() + 3, ymin.data() + 3, xmax.data() + 3, ymax.data() + 3},
+         1, ious.data());
+  EXPECT_EQ(ious[0], 0.0f);
+}
+
+}  // namespace
+}  // namespace simd
+}  // namespace mediapipe
@@ -17,6 +17,12 @@
 // indices. Details of the modification is marked below in the code.
 #include "mediapipe/util/tflite/operations/max_pool_argmax.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/padding.h"
@@ -29,70 +35,81 @@ constexpr int kDataInputTensor = 0;
 constexpr int kOutputTensor = 0;
 constexpr int kIndicesTensor = 1;
 
+// Output rows below this many per thread are not worth a thread.
+constexpr int kMinOutputRowsPerTask = 4;
+
 // These functions were copied from the following places:
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/kernels/internal/reference/reference_ops.h
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/kernels/pooling.cc
 
-inline void MaxPoolArgmax(const ::tflite::PoolParams& params,
-                          const ::tflite::RuntimeShape& input_shape,
-                          const float* input_data,
-                          const ::tflite::RuntimeShape& output_shape,
-                          float* output_data, float* indices_data) {
+struct MaxPoolArgmaxArgs {
+  ::tflite::PoolParams params;
+  ::tflite::RuntimeShape input_shape;
+  const float* input_data;
+  ::tflite::RuntimeShape output_shape;
+  float* output_data;
+  float* indices_data;
+};
+
+// Computes the output rows [output_y_begin, output_y_end).
+inline void MaxPoolArgmaxRows(const MaxPoolArgmaxArgs& args,
+                              int output_y_begin, int output_y_end) {
   // Start of copy from
   // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/kernels/internal/reference/reference_ops.h
   // Start of MediaPipe modificiation.
-  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
-  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const ::tflite::PoolParams& params = args.params;
+  const ::tflite::RuntimeShape& input_shape = args.input_shape;
+  const ::tflite::RuntimeShape& output_shape = args.output_shape;
   const int batches = MatchingDim(input_shape, 0, output_shape, 0);
   const int depth = MatchingDim(input_shape, 3, output_shape, 3);
   const int input_height = input_shape.Dims(1);
   const int input_width = input_shape.Dims(2);
-  const int output_height = output_shape.Dims(1);
   const int output_width = output_shape.Dims(2);
   const int stride_height = params.stride_height;
   const int stride_width = params.stride_width;
   for (int batch = 0; batch < batches; ++batch) {
-    for (int out_y = 0; out_y < output_height; ++out_y) {
+    for (int out_y = output_y_begin; out_y < output_y_end; ++out_y) {
       for (int out_x = 0; out_x < output_width; ++out_x) {
-        for (int channel = 0; channel < depth; ++channel) {
-          const int in_x_origin =
-              (out_x * stride_width) - params.padding_values.width;
-          const int in_y_origin =
-              (out_y * stride_height) - params.padding_values.height;
-          // Compute the boundaries of the filter region clamped so as to
-          // ensure that the filter window fits in the input array.
-          const int filter_x_start = std::max(0, -in_x_origin);
-          const int filter_x_end =
-              std::min(params.filter_width, input_width - in_x_origin);
-          const int filter_y_start = std::max(0, -in_y_origin);
-          const int filter_y_end =
-              std::min(params.filter_height, input_height - in_y_origin);
-          float max = std::numeric_limits<float>::lowest();
-          int max_x = 0;
-          int max_y = 0;
-          for (int filter_y = filter_y_start; filter_y < filter_y_end;
-               ++filter_y) {
-            for (int filter_x = filter_x_start; filter_x < filter_x_end;
-                 ++filter_x) {
-              const int in_x = in_x_origin + filter_x;
-              const int in_y = in_y_origin + filter_y;
-              float cur =
-                  input_data[Offset(input_shape, batch, in_y, in_x, channel)];
-              if (cur > max) {
-                max = cur;
-                max_x = filter_x;
-                max_y = filter_y;
-              }
+        const int in_x_origin =
+            (out_x * stride_width) - params.padding_values.width;
+        const int in_y_origin =
+            (out_y * stride_height) - params.padding_values.height;
+        // Compute the boundaries of the filter region clamped so as to
+        // ensure that the filter window fits in the input array.
+        const int filter_x_start = std::max(0, -in_x_origin);
+        const int filter_x_end =
+            std::min(params.filter_width, input_width - in_x_origin);
+        const int filter_y_start = std::max(0, -in_y_origin);
+        const int filter_y_end =
+            std::min(params.filter_height, input_height - in_y_origin);
+        // All channels of a pixel are reduced at once, over contiguous
+        // memory, so that the compiler vectorizes the channel loops.
+        const int output_offset = Offset(output_shape, batch, out_y, out_x, 0);
+        float* max = args.output_data + output_offset;
+        float* index = args.indices_data + output_offset;
+        std::fill(max, max + depth, std::numeric_limits<float>::lowest());
+        std::fill(index, index + depth, 0.1f);
+        for (int filter_y = filter_y_start; filter_y < filter_y_end;
+             ++filter_y) {
+          for (int filter_x = filter_x_start; filter_x < filter_x_end;
+               ++filter_x) {
+            const int in_x = in_x_origin + filter_x;
+            const int in_y = in_y_origin + filter_y;
+            const float* cur =
+                args.input_data + Offset(input_shape, batch, in_y, in_x, 0);
+            const float cur_index =
+                filter_y * params.filter_width + filter_x + 0.1f;
+            for (int channel = 0; channel < depth; ++channel) {
+              const bool is_max = cur[channel] > max[channel];
+              max[channel] = is_max ? cur[channel] : max[channel];
+              index[channel] = is_max ? cur_index : index[channel];
             }
           }
-          output_data[Offset(output_shape, batch, out_y, out_x, channel)] =
-              ::tflite::ActivationFunctionWithMinMax(
-                  max, params.float_activation_min,
-                  params.float_activation_max);
-          if (indices_data) {
-            indices_data[Offset(output_shape, batch, out_y, out_x, channel)] =
-                max_y * params.filter_width + max_x + 0.1f;
-          }
+        }
+        for (int channel = 0; channel < depth; ++channel) {
+          max[channel] = ::tflite::ActivationFunctionWithMinMax(
+              max[channel], params.float_activation_min,
+              params.float_activation_max);
         }
       }
     }
@@ -101,6 +118,44 @@ inline void MaxPoolArgmax(const ::tflite::PoolParams& params,
   // End of copy.
 }
 
+class MaxPoolArgmaxTask : public ::tflite::cpu_backend_threadpool::Task {
+ public:
+  MaxPoolArgmaxTask(const MaxPoolArgmaxArgs& args, int output_y_begin,
+                    int output_y_end)
+      : args_(args),
+        output_y_begin_(output_y_begin),
+        output_y_end_(output_y_end) {}
+
+  void Run() override {
+    MaxPoolArgmaxRows(args_, output_y_begin_, output_y_end_);
+  }
+
+ private:
+  const MaxPoolArgmaxArgs& args_;
+  const int output_y_begin_;
+  const int output_y_end_;
+};
+
+// Splits the output rows between the threads of the TFLite CPU backend.
+void MaxPoolArgmax(TfLiteContext* context, const MaxPoolArgmaxArgs& args) {
+  TFLITE_DCHECK_EQ(args.input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(args.output_shape.DimensionsCount(), 4);
+  const int output_height = args.output_shape.Dims(1);
+  ::tflite::CpuBackendContext* cpu_backend_context =
+      ::tflite::CpuBackendContext::GetFromContext(context);
+  const int thread_count =
+      std::max(1, std::min(cpu_backend_context->max_num_threads(),
+                           output_height / kMinOutputRowsPerTask));
+  std::vector<MaxPoolArgmaxTask> tasks;
+  tasks.reserve(thread_count);
+  for (int i = 0; i < thread_count; ++i) {
+    tasks.emplace_back(args, output_height * i / thread_count,
+                       output_height * (i + 1) / thread_count);
+  }
+  ::tflite::cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                            cpu_backend_context);
+}
+
 // Start of copy from
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/kernels/pooling.cc
 // Start of MediaPipe modificiation.
@@ -190,11 +245,13 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   op_params.padding_values.width = data_padding->width;
   op_params.float_activation_min = activation_min;
   op_params.float_activation_max = activation_max;
-  MaxPoolArgmax(op_params, ::tflite::GetTensorShape(input),
-                ::tflite::GetTensorData<float>(input),
-                ::tflite::GetTensorShape(output),
-                ::tflite::GetTensorData<float>(output),
-                ::tflite::GetTensorData<float>(indices));
+  MaxPoolArgmaxArgs args{op_params,
+                         ::tflite::GetTensorShape(input),
+                         ::tflite::GetTensorData<float>(input),
+                         ::tflite::GetTensorShape(output),
+                         ::tflite::GetTensorData<float>(output),
+                         ::tflite::GetTensorData<float>(indices)};
+  MaxPoolArgmax(context, args);
   return kTfLiteOk;
 }
 // End of MediaPipe modification.
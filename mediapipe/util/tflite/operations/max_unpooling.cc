@@ -14,6 +14,12 @@
 
 #include "mediapipe/util/tflite/operations/max_unpooling.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/padding.h"
@@ -26,41 +32,97 @@ constexpr int kDataInputTensor = 0;
 constexpr int kIndicesTensor = 1;
 constexpr int kOutputTensor = 0;
 
-inline void MaxUnpooling(const ::tflite::PoolParams& params,
-                         const ::tflite::RuntimeShape& input_shape,
-                         const float* input_data, const float* indices_data,
-                         const ::tflite::RuntimeShape& output_shape,
-                         float* output_data) {
-  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
-  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+// Input rows below this many per thread are not worth a thread.
+constexpr int kMinInputRowsPerTask = 4;
+
+struct MaxUnpoolingArgs {
+  ::tflite::PoolParams params;
+  ::tflite::RuntimeShape input_shape;
+  const float* input_data;
+  const float* indices_data;
+  ::tflite::RuntimeShape output_shape;
+  float* output_data;
+};
+
+// Scatters the input rows [input_y_begin, input_y_end) to the output, which
+// must be zeroed beforehand.
+inline void MaxUnpoolingRows(const MaxUnpoolingArgs& args, int input_y_begin,
+                             int input_y_end) {
+  const ::tflite::PoolParams& params = args.params;
+  const ::tflite::RuntimeShape& input_shape = args.input_shape;
+  const ::tflite::RuntimeShape& output_shape = args.output_shape;
   const int batches = MatchingDim(input_shape, 0, output_shape, 0);
   const int depth = MatchingDim(input_shape, 3, output_shape, 3);
-  const int input_height = input_shape.Dims(1);
   const int input_width = input_shape.Dims(2);
+  const int output_width = output_shape.Dims(2);
   const int stride_height = params.stride_height;
   const int stride_width = params.stride_width;
-  std::memset(output_data, 0, output_shape.FlatSize() * sizeof(float));
   for (int batch = 0; batch < batches; ++batch) {
-    for (int in_y = 0; in_y < input_height; ++in_y) {
+    float* output_batch =
+        args.output_data + Offset(output_shape, batch, 0, 0, 0);
+    for (int in_y = input_y_begin; in_y < input_y_end; ++in_y) {
       for (int in_x = 0; in_x < input_width; ++in_x) {
+        const int input_offset = Offset(input_shape, batch, in_y, in_x, 0);
+        const float* input = args.input_data + input_offset;
+        const float* indices = args.indices_data + input_offset;
+        const int out_x_origin =
+            in_x * stride_width - params.padding_values.width;
+        const int out_y_origin =
+            in_y * stride_height - params.padding_values.height;
         for (int channel = 0; channel < depth; ++channel) {
-          const auto input_offset =
-              Offset(input_shape, batch, in_y, in_x, channel);
-          int idx = indices_data[input_offset];
+          int idx = indices[channel];
           const int max_x = idx % params.filter_width;
           const int max_y = idx / params.filter_width;
-          const int out_x =
-              in_x * stride_width - params.padding_values.width + max_x;
-          const int out_y =
-              in_y * stride_height - params.padding_values.height + max_y;
-          output_data[Offset(output_shape, batch, out_y, out_x, channel)] =
-              input_data[input_offset];
+          const int out_x = out_x_origin + max_x;
+          const int out_y = out_y_origin + max_y;
+          output_batch[(out_y * output_width + out_x) * depth + channel] =
+              input[channel];
         }
       }
     }
   }
 }
 
+class MaxUnpoolingTask : public ::tflite::cpu_backend_threadpool::Task {
+ public:
+  MaxUnpoolingTask(const MaxUnpoolingArgs& args, int input_y_begin,
+                   int input_y_end)
+      : args_(args), input_y_begin_(input_y_begin), input_y_end_(input_y_end) {}
+
+  void Run() override { MaxUnpoolingRows(args_, input_y_begin_, input_y_end_); }
+
+ private:
+  const MaxUnpoolingArgs& args_;
+  const int input_y_begin_;
+  const int input_y_end_;
+};
+
+// Splits the input rows between the threads of the TFLite CPU backend, when
+// the pooling windows of different input rows don't overlap, so that the
+// threads write disjoint output rows.
+inline void MaxUnpooling(TfLiteContext* context, const MaxUnpoolingArgs& args) {
+  TFLITE_DCHECK_EQ(args.input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(args.output_shape.DimensionsCount(), 4);
+  std::memset(args.output_data, 0,
+              args.output_shape.FlatSize() * sizeof(float));
+  const int input_height = args.input_shape.Dims(1);
+  ::tflite::CpuBackendContext* cpu_backend_context =
+      ::tflite::CpuBackendContext::GetFromContext(context);
+  int thread_count = 1;
+  if (args.params.stride_height >= args.params.filter_height) {
+    thread_count = std::max(1, std::min(cpu_backend_context->max_num_threads(),
+                                        input_height / kMinInputRowsPerTask));
+  }
+  std::vector<MaxUnpoolingTask> tasks;
+  tasks.reserve(thread_count);
+  for (int i = 0; i < thread_count; ++i) {
+    tasks.emplace_back(args, input_height * i / thread_count,
+                       input_height * (i + 1) / thread_count);
+  }
+  ::tflite::cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                            cpu_backend_context);
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   auto* params =
       reinterpret_cast<const TfLitePoolParams*>(node->custom_initial_data);
@@ -130,11 +192,13 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   op_params.padding_values.width = data_padding->width;
   op_params.float_activation_min = activation_min;
   op_params.float_activation_max = activation_max;
-  MaxUnpooling(op_params, ::tflite::GetTensorShape(input),
-               ::tflite::GetTensorData<float>(input),
-               ::tflite::GetTensorData<float>(indices),
-               ::tflite::GetTensorShape(output),
-               ::tflite::GetTensorData<float>(output));
+  MaxUnpoolingArgs args{op_params,
+                        ::tflite::GetTensorShape(input),
+                        ::tflite::GetTensorData<float>(input),
+                        ::tflite::GetTensorData<float>(indices),
+                        ::tflite::GetTensorShape(output),
+                        ::tflite::GetTensorData<float>(output)};
+  MaxUnpooling(context, args);
   return kTfLiteOk;
 }
 
@@ -0,0 +1,104 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks the CPU kernels of the MediaPipe custom TFLite ops, each as the
+// only node of an interpreter, with state.range(0) threads.
+
+#include <vector>
+
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/util/tflite/operations/max_pool_argmax.h"
+#include "mediapipe/util/tflite/operations/max_unpooling.h"
+#include "mediapipe/util/tflite/operations/operations_test_util.h"
+#include "mediapipe/util/tflite/operations/transpose_conv_bias.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+namespace tflite_operations {
+namespace {
+
+// Shapes like those of the segmentation models.
+constexpr int kHeight = 64;
+constexpr int kWidth = 64;
+constexpr int kChannels = 32;
+
+void RunInterpreter(benchmark::State& state, tflite::Interpreter* interpreter) {
+  for (auto _ : state) {
+    CHECK_EQ(interpreter->Invoke(), kTfLiteOk);
+  }
+}
+
+void BM_MaxPoolingWithArgmax2D(benchmark::State& state) {
+  TfLitePoolParams params = {};
+  params.padding = kTfLitePaddingSame;
+  params.stride_width = 2;
+  params.stride_height = 2;
+  params.filter_width = 2;
+  params.filter_height = 2;
+  auto interpreter = MakeInterpreter(
+      *RegisterMaxPoolingWithArgmax2D(),
+      "MaxPoolingWithArgmax2D", &params, sizeof(params),
+      {{{1, kHeight, kWidth, kChannels}}},
+      {{{1, kHeight / 2, kWidth / 2, kChannels}},
+       {{1, kHeight / 2, kWidth / 2, kChannels}}},
+      state.range(0));
+  FillInputs(interpreter.get(), [](int i) { return (i * 7919) % 1000; });
+  RunInterpreter(state, interpreter.get());
+}
+BENCHMARK(BM_MaxPoolingWithArgmax2D)->Arg(1)->Arg(2)->Arg(4);
+
+void BM_MaxUnpooling2D(benchmark::State& state) {
+  TfLitePoolParams params = {};
+  params.padding = kTfLitePaddingSame;
+  params.stride_width = 2;
+  params.stride_height = 2;
+  params.filter_width = 2;
+  params.filter_height = 2;
+  auto interpreter = MakeInterpreter(
+      *RegisterMaxUnpooling2D(), "MaxUnpooling2D", &params,
+      sizeof(params),
+      {{{1, kHeight / 2, kWidth / 2, kChannels}},
+       {{1, kHeight / 2, kWidth / 2, kChannels}}},
+      {{{1, kHeight, kWidth, kChannels}}}, state.range(0));
+  // Valid argmax indices for the 2x2 windows, and values for the data.
+  FillInputs(interpreter.get(), [](int i) { return i % 4 + 0.1f; });
+  RunInterpreter(state, interpreter.get());
+}
+BENCHMARK(BM_MaxUnpooling2D)->Arg(1)->Arg(2)->Arg(4);
+
+void BM_Convolution2DTransposeBias(benchmark::State& state) {
+  TfLiteTransposeConvParams params = {};
+  params.padding = kTfLitePaddingSame;
+  params.stride_width = 2;
+  params.stride_height = 2;
+  const std::vector<float> weights(kChannels * 2 * 2 * kChannels, 0.01f);
+  const std::vector<float> bias(kChannels, 0.5f);
+  auto interpreter = MakeInterpreter(
+      *RegisterConvolution2DTransposeBias(),
+      "Convolution2DTransposeBias", &params, sizeof(params),
+      {{{1, kHeight / 2, kWidth / 2, kChannels}},
+       {{kChannels, 2, 2, kChannels}, &weights},
+       {{kChannels}, &bias}},
+      {{{1, kHeight, kWidth, kChannels}}}, state.range(0));
+  FillInputs(interpreter.get(), [](int i) { return (i % 100) * 0.01f; });
+  RunInterpreter(state, interpreter.get());
+}
+BENCHMARK(BM_Convolution2DTransposeBias)->Arg(1)->Arg(2)->Arg(4);
+
+}  // namespace
+}  // namespace tflite_operations
+}  // namespace mediapipe
+
+BENCHMARK_MAIN();
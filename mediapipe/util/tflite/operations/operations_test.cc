@@ -0,0 +1,572 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the CPU kernels of the MediaPipe custom TFLite ops with the
+// single-threaded reference loops they replaced, on odd shapes, both
+// paddings and several threads.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/tflite/operations/max_pool_argmax.h"
+#include "mediapipe/util/tflite/operations/max_unpooling.h"
+#include "mediapipe/util/tflite/operations/operations_test_util.h"
+#include "mediapipe/util/tflite/operations/transform_tensor_bilinear.h"
+#include "mediapipe/util/tflite/operations/transpose_conv_bias.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/padding.h"
+
+namespace mediapipe {
+namespace tflite_operations {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+// A reference output with its dimensions.
+struct Tensor {
+  std::vector<int> dims;
+  std::vector<float> data;
+};
+
+int FlatSize(const std::vector<int>& dims) {
+  int size = 1;
+  for (int dim : dims) size *= dim;
+  return size;
+}
+
+::tflite::RuntimeShape Shape(const std::vector<int>& dims) {
+  return ::tflite::RuntimeShape(dims.size(), dims.data());
+}
+
+// Values with many ties and both signs, in [-1, 1].
+std::vector<float> MakeValues(int size, int seed) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) {
+    values[i] = ((i * 7919 + seed * 104729) % 23 - 11) / 11.0f;
+  }
+  return values;
+}
+
+void SetInput(tflite::Interpreter* interpreter, int input,
+              const std::vector<float>& data) {
+  TfLiteTensor* tensor = interpreter->input_tensor(input);
+  ASSERT_EQ(tensor->bytes, data.size() * sizeof(float));
+  std::memcpy(tensor->data.f, data.data(), tensor->bytes);
+}
+
+Tensor GetOutput(const tflite::Interpreter& interpreter, int output) {
+  const TfLiteTensor* tensor = interpreter.output_tensor(output);
+  Tensor result;
+  result.dims.assign(tensor->dims->data,
+                     tensor->dims->data + tensor->dims->size);
+  result.data.assign(tensor->data.f,
+                     tensor->data.f + tensor->bytes / sizeof(float));
+  return result;
+}
+
+// The reference loops below are those of the kernels before they were
+// vectorized and split between threads, with the output sizes and padding
+// their Prepare computed.
+
+void ReferenceMaxPoolArgmax(const TfLitePoolParams& params,
+                            const std::vector<int>& input_dims,
+                            const std::vector<float>& input_data,
+                            Tensor* output, Tensor* indices) {
+  const int batches = input_dims[0];
+  const int input_height = input_dims[1];
+  const int input_width = input_dims[2];
+  const int depth = input_dims[3];
+  auto compute_out_size = [&params](int image_size, int filter_size,
+                                    int stride) -> int {
+    return params.padding == kTfLitePaddingSame
+               ? (image_size + stride - 1) / stride
+               : (image_size - filter_size + stride) / stride;
+  };
+  const int output_height = compute_out_size(
+      input_height, params.filter_height, params.stride_height);
+  const int output_width =
+      compute_out_size(input_width, params.filter_width, params.stride_width);
+  const int pad_height =
+      ::tflite::ComputePadding(params.stride_height, 1, input_height,
+                               params.filter_height, output_height);
+  const int pad_width =
+      ::tflite::ComputePadding(params.stride_width, 1, input_width,
+                               params.filter_width, output_width);
+  float activation_min, activation_max;
+  ::tflite::CalculateActivationRange(params.activation, &activation_min,
+                                     &activation_max);
+
+  output->dims = {batches, output_height, output_width, depth};
+  output->data.assign(FlatSize(output->dims), 0.0f);
+  indices->dims = output->dims;
+  indices->data.assign(FlatSize(indices->dims), 0.0f);
+  const ::tflite::RuntimeShape input_shape = Shape(input_dims);
+  const ::tflite::RuntimeShape output_shape = Shape(output->dims);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int channel = 0; channel < depth; ++channel) {
+          const int in_x_origin = (out_x * params.stride_width) - pad_width;
+          const int in_y_origin = (out_y * params.stride_height) - pad_height;
+          const int filter_x_start = std::max(0, -in_x_origin);
+          const int filter_x_end =
+              std::min(params.filter_width, input_width - in_x_origin);
+          const int filter_y_start = std::max(0, -in_y_origin);
+          const int filter_y_end =
+              std::min(params.filter_height, input_height - in_y_origin);
+          float max = std::numeric_limits<float>::lowest();
+          int max_x = 0;
+          int max_y = 0;
+          for (int filter_y = filter_y_start; filter_y < filter_y_end;
+               ++filter_y) {
+            for (int filter_x = filter_x_start; filter_x < filter_x_end;
+                 ++filter_x) {
+              const int in_x = in_x_origin + filter_x;
+              const int in_y = in_y_origin + filter_y;
+              float cur = input_data[::tflite::Offset(input_shape, batch, in_y,
+                                                      in_x, channel)];
+              if (cur > max) {
+                max = cur;
+                max_x = filter_x;
+                max_y = filter_y;
+              }
+            }
+          }
+          const int offset =
+              ::tflite::Offset(output_shape, batch, out_y, out_x, channel);
+          output->data[offset] = ::tflite::ActivationFunctionWithMinMax(
+              max, activation_min, activation_max);
+          indices->data[offset] = max_y * params.filter_width + max_x + 0.1f;
+        }
+      }
+    }
+  }
+}
+
+Tensor ReferenceMaxUnpooling(const TfLitePoolParams& params,
+                             const std::vector<int>& input_dims,
+                             const std::vector<float>& input_data,
+                             const std::vector<float>& indices_data) {
+  const int batches = input_dims[0];
+  const int input_height = input_dims[1];
+  const int input_width = input_dims[2];
+  const int depth = input_dims[3];
+  const int output_height = input_height * params.filter_height;
+  const int output_width = input_width * params.filter_width;
+  const int pad_height =
+      ::tflite::ComputePadding(params.stride_height, 1, output_height,
+                               params.filter_height, input_height);
+  const int pad_width =
+      ::tflite::ComputePadding(params.stride_width, 1, output_width,
+                               params.filter_width, input_width);
+
+  Tensor output;
+  output.dims = {batches, output_height, output_width, depth};
+  output.data.assign(FlatSize(output.dims), 0.0f);
+  const ::tflite::RuntimeShape input_shape = Shape(input_dims);
+  const ::tflite::RuntimeShape output_shape = Shape(output.dims);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int in_y = 0; in_y < input_height; ++in_y) {
+      for (int in_x = 0; in_x < input_width; ++in_x) {
+        for (int channel = 0; channel < depth; ++channel) {
+          const int input_offset =
+              ::tflite::Offset(input_shape, batch, in_y, in_x, channel);
+          int idx = indices_data[input_offset];
+          const int max_x = idx % params.filter_width;
+          const int max_y = idx / params.filter_width;
+          const int out_x = in_x * params.stride_width - pad_width + max_x;
+          const int out_y = in_y * params.stride_height - pad_height + max_y;
+          output.data[::tflite::Offset(output_shape, batch, out_y, out_x,
+                                       channel)] = input_data[input_offset];
+        }
+      }
+    }
+  }
+  return output;
+}
+
+Tensor ReferenceTransposeConvBias(const TfLiteTransposeConvParams& params,
+                                  const std::vector<int>& input_dims,
+                                  const std::vector<float>& input_data,
+                                  const std::vector<int>& filter_dims,
+                                  const std::vector<float>& filter_data,
+                                  const std::vector<float>& bias_data) {
+  const int batches = input_dims[0];
+  const int input_height = input_dims[1];
+  const int input_width = input_dims[2];
+  const int input_depth = input_dims[3];
+  const int output_depth = filter_dims[0];
+  const int filter_height = filter_dims[1];
+  const int filter_width = filter_dims[2];
+  int padding_height = 0;
+  int padding_width = 0;
+  if (params.padding == kTfLitePaddingSame) {
+    padding_height = std::max(
+        0, filter_height - (input_height - 1) % params.stride_height - 1);
+    padding_width = std::max(
+        0, filter_width - (input_width - 1) % params.stride_width - 1);
+  }
+  const int output_height =
+      params.stride_height * (input_height - 1) + filter_height -
+      padding_height;
+  const int output_width =
+      params.stride_width * (input_width - 1) + filter_width - padding_width;
+  const int pad_height = padding_height / 2;
+  const int pad_width = padding_width / 2;
+
+  Tensor output;
+  output.dims = {batches, output_height, output_width, output_depth};
+  output.data.assign(FlatSize(output.dims), 0.0f);
+  const ::tflite::RuntimeShape input_shape = Shape(input_dims);
+  const ::tflite::RuntimeShape filter_shape = Shape(filter_dims);
+  const ::tflite::RuntimeShape output_shape = Shape(output.dims);
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; out_y++) {
+      for (int out_x = 0; out_x < output_width; out_x++) {
+        for (int out_channel = 0; out_channel < output_depth; out_channel++) {
+          output.data[::tflite::Offset(output_shape, batch, out_y, out_x,
+                                       out_channel)] = bias_data[out_channel];
+        }
+      }
+    }
+    for (int in_y = 0; in_y < input_height; ++in_y) {
+      for (int in_x = 0; in_x < input_width; ++in_x) {
+        for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
+          const int out_x_origin = (in_x * params.stride_width) - pad_width;
+          const int out_y_origin = (in_y * params.stride_height) - pad_height;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              for (int out_channel = 0; out_channel < output_depth;
+                   ++out_channel) {
+                const int out_x = out_x_origin + filter_x;
+                const int out_y = out_y_origin + filter_y;
+                if ((out_x >= 0) && (out_x < output_width) && (out_y >= 0) &&
+                    (out_y < output_height)) {
+                  float input_value = input_data[::tflite::Offset(
+                      input_shape, batch, in_y, in_x, in_channel)];
+                  float filter_value = filter_data[::tflite::Offset(
+                      filter_shape, out_channel, filter_y, filter_x,
+                      in_channel)];
+                  output.data[::tflite::Offset(output_shape, batch, out_y,
+                                               out_x, out_channel)] +=
+                      input_value * filter_value;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return output;
+}
+
+float DotProduct(const float* l, const float* r) {
+  return l[0] * r[0] + l[1] * r[1] + l[2] * r[2] + l[3] * r[3];
+}
+
+Tensor ReferenceTransformTensorBilinear(const std::vector<int>& input_dims,
+                                        const std::vector<float>& input_data,
+                                        const std::vector<float>& matrix,
+                                        const std::vector<int>& output_dims,
+                                        bool align_corners) {
+  const int input_height = input_dims[1];
+  const int input_width = input_dims[2];
+  const int output_height = output_dims[1];
+  const int output_width = output_dims[2];
+  const int output_channels = output_dims[3];
+  float x_transform[4] = {matrix[0], matrix[1], matrix[2], matrix[3]};
+  float y_transform[4] = {matrix[4], matrix[5], matrix[6], matrix[7]};
+  if (align_corners) {
+    x_transform[3] += x_transform[0] * 0.5 + x_transform[1] * 0.5 - 0.5;
+    y_transform[3] += y_transform[0] * 0.5 + y_transform[1] * 0.5 - 0.5;
+  }
+
+  Tensor output;
+  output.dims = output_dims;
+  output.data.assign(FlatSize(output.dims), 0.0f);
+  const ::tflite::RuntimeShape input_shape = Shape(input_dims);
+  const ::tflite::RuntimeShape output_shape = Shape(output.dims);
+  for (int out_y = 0; out_y < output_height; ++out_y) {
+    for (int out_x = 0; out_x < output_width; ++out_x) {
+      const float coord[4] = {static_cast<float>(out_x),
+                              static_cast<float>(out_y), 0.0f, 1.0f};
+      const float tc_x = DotProduct(x_transform, coord);
+      const float tc_y = DotProduct(y_transform, coord);
+      bool out_of_bound = tc_x < 0.0 || tc_x > input_width - 1 ||
+                          tc_y < 0.0 || tc_y > input_height - 1;
+      for (int out_z = 0; out_z < output_channels; ++out_z) {
+        float result = 0;
+        if (!out_of_bound) {
+          auto ReadValue = [&](int h, int w) -> float {
+            return h < 0 || w < 0 || h >= input_height || w >= input_width
+                       ? 0
+                       : input_data[::tflite::Offset(input_shape, 0, h, w,
+                                                     out_z)];
+          };
+          float q_11 = ReadValue(floor(tc_y), floor(tc_x));
+          float q_21 = ReadValue(floor(tc_y), floor(tc_x) + 1);
+          float q_12 = ReadValue(floor(tc_y) + 1, floor(tc_x));
+          float q_22 = ReadValue(floor(tc_y) + 1, floor(tc_x) + 1);
+          float right_contrib = tc_x - floor(tc_x);
+          float lower_contrib = tc_y - floor(tc_y);
+          float upper = (1.0 - right_contrib) * q_11 + right_contrib * q_21;
+          float lower = (1.0 - right_contrib) * q_12 + right_contrib * q_22;
+          result = lower_contrib * lower + (1.0 - lower_contrib) * upper;
+        }
+        output.data[::tflite::Offset(output_shape, 0, out_y, out_x, out_z)] =
+            result;
+      }
+    }
+  }
+  return output;
+}
+
+// The tests are parameterized by the number of CPU threads of the
+// interpreter. The shapes are tall enough for the kernels to split them
+// unevenly between up to 4 threads.
+class OperationsTest : public ::testing::TestWithParam<int> {};
+
+struct PoolCase {
+  std::vector<int> input_dims;
+  TfLitePadding padding;
+  int filter_height;
+  int filter_width;
+  int stride_height;
+  int stride_width;
+  TfLiteFusedActivation activation;
+};
+
+TEST_P(OperationsTest, MaxPoolingWithArgmax2DMatchesReference) {
+  const std::vector<PoolCase> cases = {
+      {{2, 17, 13, 5}, kTfLitePaddingSame, 3, 3, 2, 2, kTfLiteActNone},
+      {{1, 16, 16, 8}, kTfLitePaddingSame, 2, 2, 2, 2, kTfLiteActNone},
+      {{2, 19, 11, 3}, kTfLitePaddingValid, 2, 2, 2, 2, kTfLiteActNone},
+      {{1, 21, 9, 7}, kTfLitePaddingSame, 3, 2, 1, 2, kTfLiteActRelu6},
+      {{1, 18, 15, 4}, kTfLitePaddingValid, 3, 3, 2, 1, kTfLiteActRelu},
+  };
+  for (const PoolCase& c : cases) {
+    TfLitePoolParams params = {};
+    params.padding = c.padding;
+    params.filter_height = c.filter_height;
+    params.filter_width = c.filter_width;
+    params.stride_height = c.stride_height;
+    params.stride_width = c.stride_width;
+    params.activation = c.activation;
+    const std::vector<float> input =
+        MakeValues(FlatSize(c.input_dims), /*seed=*/0);
+    Tensor expected_output;
+    Tensor expected_indices;
+    ReferenceMaxPoolArgmax(params, c.input_dims, input, &expected_output,
+                           &expected_indices);
+
+    auto interpreter = MakeInterpreter(
+        *RegisterMaxPoolingWithArgmax2D(), "MaxPoolingWithArgmax2D", &params,
+        sizeof(params), {{c.input_dims}},
+        {{expected_output.dims}, {expected_indices.dims}}, GetParam());
+    SetInput(interpreter.get(), 0, input);
+    ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+
+    const Tensor output = GetOutput(*interpreter, 0);
+    const Tensor indices = GetOutput(*interpreter, 1);
+    EXPECT_EQ(output.dims, expected_output.dims);
+    EXPECT_THAT(output.data, ElementsAreArray(expected_output.data));
+    EXPECT_EQ(indices.dims, expected_indices.dims);
+    EXPECT_THAT(indices.data, ElementsAreArray(expected_indices.data));
+  }
+}
+
+TEST_P(OperationsTest, MaxUnpooling2DMatchesReference) {
+  // The unpooling windows tile the output, as in the segmentation models.
+  const std::vector<PoolCase> cases = {
+      {{2, 9, 7, 3}, kTfLitePaddingSame, 2, 2, 2, 2, kTfLiteActNone},
+      {{1, 17, 5, 4}, kTfLitePaddingSame, 3, 3, 3, 3, kTfLiteActNone},
+      {{1, 16, 13, 6}, kTfLitePaddingValid, 2, 3, 2, 3, kTfLiteActNone},
+  };
+  for (const PoolCase& c : cases) {
+    TfLitePoolParams params = {};
+    params.padding = c.padding;
+    params.filter_height = c.filter_height;
+    params.filter_width = c.filter_width;
+    params.stride_height = c.stride_height;
+    params.stride_width = c.stride_width;
+    params.activation = c.activation;
+    const int size = FlatSize(c.input_dims);
+    const std::vector<float> input = MakeValues(size, /*seed=*/1);
+    std::vector<float> indices(size);
+    for (int i = 0; i < size; ++i) {
+      indices[i] = (i * 31) % (c.filter_height * c.filter_width) + 0.1f;
+    }
+    const Tensor expected =
+        ReferenceMaxUnpooling(params, c.input_dims, input, indices);
+
+    auto interpreter = MakeInterpreter(
+        *RegisterMaxUnpooling2D(), "MaxUnpooling2D", &params, sizeof(params),
+        {{c.input_dims}, {c.input_dims}}, {{expected.dims}}, GetParam());
+    SetInput(interpreter.get(), 0, input);
+    SetInput(interpreter.get(), 1, indices);
+    ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+
+    const Tensor output = GetOutput(*interpreter, 0);
+    EXPECT_EQ(output.dims, expected.dims);
+    EXPECT_THAT(output.data, ElementsAreArray(expected.data));
+  }
+}
+
+struct TransposeConvCase {
+  std::vector<int> input_dims;
+  std::vector<int> filter_dims;
+  TfLitePadding padding;
+  int stride_height;
+  int stride_width;
+  bool constant_weights;
+};
+
+TEST_P(OperationsTest, Convolution2DTransposeBiasMatchesReference) {
+  const std::vector<TransposeConvCase> cases = {
+      {{2, 9, 7, 5}, {3, 3, 3, 5}, kTfLitePaddingSame, 2, 2, true},
+      {{1, 8, 8, 16}, {8, 4, 4, 16}, kTfLitePaddingSame, 2, 2, true},
+      {{1, 11, 6, 3}, {4, 3, 2, 3}, kTfLitePaddingValid, 2, 1, true},
+      {{1, 10, 9, 7}, {2, 2, 2, 7}, kTfLitePaddingValid, 2, 2, false},
+  };
+  for (const TransposeConvCase& c : cases) {
+    TfLiteTransposeConvParams params = {};
+    params.padding = c.padding;
+    params.stride_height = c.stride_height;
+    params.stride_width = c.stride_width;
+    const std::vector<float> weights =
+        MakeValues(FlatSize(c.filter_dims), /*seed=*/2);
+    const std::vector<float> bias = MakeValues(c.filter_dims[0], /*seed=*/3);
+    const Tensor first_expected = ReferenceTransposeConvBias(
+        params, c.input_dims, MakeValues(FlatSize(c.input_dims), 4),
+        c.filter_dims, weights, bias);
+
+    auto interpreter = MakeInterpreter(
+        *RegisterConvolution2DTransposeBias(), "Convolution2DTransposeBias",
+        &params, sizeof(params),
+        {{c.input_dims},
+         {c.filter_dims, c.constant_weights ? &weights : nullptr},
+         {{c.filter_dims[0]}, &bias}},
+        {{first_expected.dims}}, GetParam());
+
+    // The second invocation reuses the repacked weights if they are
+    // constant, and must repack them otherwise.
+    for (int seed : {4, 5}) {
+      const std::vector<float> input =
+          MakeValues(FlatSize(c.input_dims), seed);
+      const std::vector<float> invocation_weights =
+          c.constant_weights ? weights
+                             : MakeValues(FlatSize(c.filter_dims), seed);
+      const Tensor expected =
+          ReferenceTransposeConvBias(params, c.input_dims, input,
+                                     c.filter_dims, invocation_weights, bias);
+      SetInput(interpreter.get(), 0, input);
+      if (!c.constant_weights) {
+        SetInput(interpreter.get(), 1, invocation_weights);
+      }
+      ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+
+      // The kernel sums the products in a different order.
+      const Tensor output = GetOutput(*interpreter, 0);
+      EXPECT_EQ(output.dims, expected.dims);
+      EXPECT_THAT(output.data, Pointwise(FloatNear(1e-4), expected.data));
+    }
+  }
+}
+
+struct TransformCase {
+  std::vector<int> input_dims;
+  std::vector<int> output_dims;
+  std::vector<float> matrix;
+};
+
+std::vector<uint8_t> TransformTensorBilinearOptions(int output_height,
+                                                    int output_width,
+                                                    bool align_corners) {
+  flexbuffers::Builder builder;
+  builder.Map([&]() {
+    builder.String("mode", "bilinear");
+    builder.TypedVector("output_size", [&]() {
+      builder.Int(output_height);
+      builder.Int(output_width);
+    });
+    if (align_corners) builder.Bool("align_corners", true);
+  });
+  builder.Finish();
+  return builder.GetBuffer();
+}
+
+TEST_P(OperationsTest, TransformTensorBilinearMatchesReference) {
+  const float cos30 = std::sqrt(3.0f) / 2;
+  const float sin30 = 0.5f;
+  const std::vector<TransformCase> cases = {
+      // Downscaling, which samples the last input row and column.
+      {{1, 13, 11, 5},
+       {1, 19, 17, 5},
+       {0.625f, 0, 0, 0, 0, 0.666f, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}},
+      // A rotation, with corners out of the input.
+      {{1, 16, 16, 3},
+       {1, 17, 15, 3},
+       {0.8f * cos30, -0.8f * sin30, 0, 4.5f, 0.8f * sin30, 0.8f * cos30, 0,
+        -2.25f, 0, 0, 1, 0, 0, 0, 0, 1}},
+      // The identity into a larger output, which is zero beyond the input.
+      {{1, 9, 7, 4},
+       {1, 18, 10, 4},
+       {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}},
+  };
+  for (const bool align_corners : {false, true}) {
+    const TfLiteRegistration& registration =
+        align_corners ? *RegisterTransformTensorBilinearV2()
+                      : *RegisterTransformTensorBilinearV1();
+    for (const TransformCase& c : cases) {
+      const std::vector<float> input =
+          MakeValues(FlatSize(c.input_dims), /*seed=*/6);
+      const Tensor expected = ReferenceTransformTensorBilinear(
+          c.input_dims, input, c.matrix, c.output_dims, align_corners);
+      const std::vector<uint8_t> options = TransformTensorBilinearOptions(
+          c.output_dims[1], c.output_dims[2], align_corners);
+
+      auto interpreter = MakeInterpreter(
+          registration, registration.custom_name, options.data(),
+          options.size(), {{c.input_dims}, {{1, 1, 4, 4}}}, {{c.output_dims}},
+          GetParam());
+      SetInput(interpreter.get(), 0, input);
+      SetInput(interpreter.get(), 1, c.matrix);
+      ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+
+      // The kernel computes the weights in float rather than double.
+      const Tensor output = GetOutput(*interpreter, 0);
+      EXPECT_EQ(output.dims, expected.dims);
+      EXPECT_THAT(output.data, Pointwise(FloatNear(1e-5), expected.data));
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, OperationsTest, ::testing::Values(1, 2, 4));
+
+}  // namespace
+}  // namespace tflite_operations
+}  // namespace mediapipe
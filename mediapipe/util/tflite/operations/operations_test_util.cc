@@ -0,0 +1,79 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tflite/operations/operations_test_util.h"
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/port/logging.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace mediapipe {
+namespace tflite_operations {
+
+std::unique_ptr<tflite::Interpreter> MakeInterpreter(
+    const TfLiteRegistration& registration, const char* name,
+    const void* params, size_t params_size,
+    const std::vector<TensorSpec>& inputs,
+    const std::vector<TensorSpec>& outputs, int num_threads) {
+  auto interpreter = std::make_unique<tflite::Interpreter>();
+  CHECK_EQ(interpreter->AddTensors(inputs.size() + outputs.size()),
+           kTfLiteOk);
+  std::vector<int> input_indices;
+  std::vector<int> variable_input_indices;
+  std::vector<int> output_indices;
+  for (int i = 0; i < inputs.size(); ++i) {
+    const TensorSpec& input = inputs[i];
+    if (input.constant_data == nullptr) {
+      CHECK_EQ(interpreter->SetTensorParametersReadWrite(
+                   i, kTfLiteFloat32, "", input.dims, TfLiteQuantization()),
+               kTfLiteOk);
+      variable_input_indices.push_back(i);
+    } else {
+      CHECK_EQ(interpreter->SetTensorParametersReadOnly(
+                   i, kTfLiteFloat32, "", input.dims, TfLiteQuantization(),
+                   reinterpret_cast<const char*>(input.constant_data->data()),
+                   input.constant_data->size() * sizeof(float)),
+               kTfLiteOk);
+    }
+    input_indices.push_back(i);
+  }
+  for (int i = 0; i < outputs.size(); ++i) {
+    const int index = inputs.size() + i;
+    CHECK_EQ(interpreter->SetTensorParametersReadWrite(
+                 index, kTfLiteFloat32, "", outputs[i].dims,
+                 TfLiteQuantization()),
+             kTfLiteOk);
+    output_indices.push_back(index);
+  }
+  CHECK_EQ(interpreter->SetInputs(variable_input_indices), kTfLiteOk);
+  CHECK_EQ(interpreter->SetOutputs(output_indices), kTfLiteOk);
+
+  // The node only gets its custom data as a custom op.
+  TfLiteRegistration custom_registration = registration;
+  custom_registration.builtin_code = tflite::BuiltinOperator_CUSTOM;
+  custom_registration.custom_name = name;
+  CHECK_EQ(interpreter->AddNodeWithParameters(
+               input_indices, output_indices,
+               reinterpret_cast<const char*>(params), params_size,
+               /*builtin_data=*/nullptr, &custom_registration),
+           kTfLiteOk);
+  CHECK_EQ(interpreter->SetNumThreads(num_threads), kTfLiteOk);
+  CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  return interpreter;
+}
+
+}  // namespace tflite_operations
+}  // namespace mediapipe
@@ -0,0 +1,59 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_TFLITE_OPERATIONS_OPERATIONS_TEST_UTIL_H_
+#define MEDIAPIPE_UTIL_TFLITE_OPERATIONS_OPERATIONS_TEST_UTIL_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+namespace tflite_operations {
+
+// The inputs and outputs of a custom op under test. Constant inputs have
+// data, which must outlive the interpreter.
+struct TensorSpec {
+  std::vector<int> dims;
+  const std::vector<float>* constant_data = nullptr;
+};
+
+// Returns an interpreter running the custom op `registration` once, with
+// `params` as its custom data and `num_threads` CPU threads. `params` must
+// outlive the interpreter. The variable inputs are the interpreter inputs,
+// in order.
+std::unique_ptr<tflite::Interpreter> MakeInterpreter(
+    const TfLiteRegistration& registration, const char* name,
+    const void* params, size_t params_size,
+    const std::vector<TensorSpec>& inputs,
+    const std::vector<TensorSpec>& outputs, int num_threads);
+
+// Fills the variable inputs of `interpreter` with `value(i)` for element i.
+template <typename ValueFn>
+void FillInputs(tflite::Interpreter* interpreter, ValueFn value) {
+  for (int index : interpreter->inputs()) {
+    TfLiteTensor* tensor = interpreter->tensor(index);
+    float* data = interpreter->typed_tensor<float>(index);
+    for (int i = 0; i < tensor->bytes / sizeof(float); ++i) {
+      data[i] = value(i);
+    }
+  }
+}
+
+}  // namespace tflite_operations
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TFLITE_OPERATIONS_OPERATIONS_TEST_UTIL_H_
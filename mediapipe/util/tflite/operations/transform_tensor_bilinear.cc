@@ -14,8 +14,15 @@
 
 #include "mediapipe/util/tflite/operations/transform_tensor_bilinear.h"
 
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/lite/delegates/gpu/common/mediapipe/transform_tensor_bilinear.h"
 #include "tensorflow/lite/delegates/gpu/common/types.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
@@ -33,9 +40,137 @@ constexpr int kOutputTensor = 0;
 float DotProduct(const tflite::gpu::float4& l, const tflite::gpu::float4& r) {
   return l.x * r.x + l.y * r.y + l.z * r.z + l.w * r.w;
 }
+
+// Output rows below this many per thread are not worth a thread.
+constexpr int kMinOutputRowsPerTask = 4;
+
+struct TransformTensorBilinearArgs {
+  // The first two rows of the transformation matrix.
+  tflite::gpu::float4 x_transform;
+  tflite::gpu::float4 y_transform;
+  tflite::RuntimeShape input_shape;
+  const float* input_data;
+  tflite::RuntimeShape output_shape;
+  float* output_data;
+};
+
+// Computes the output rows [output_y_begin, output_y_end). The corners and
+// weights are computed once per output pixel, and all the channels of the
+// pixel are then interpolated over contiguous memory, so that the compiler
+// vectorizes the channel loop.
+void TransformTensorBilinearRows(const TransformTensorBilinearArgs& args,
+                                 int output_y_begin, int output_y_end) {
+  const int output_width = args.output_shape.Dims(2);
+  const int output_channels = args.output_shape.Dims(3);
+  const int input_height = args.input_shape.Dims(1);
+  const int input_width = args.input_shape.Dims(2);
+  const int input_channels = args.input_shape.Dims(3);
+
+  for (int out_y = output_y_begin; out_y < output_y_end; ++out_y) {
+    for (int out_x = 0; out_x < output_width; ++out_x) {
+      tflite::gpu::float4 coord(
+          static_cast<float>(out_x), static_cast<float>(out_y),
+          static_cast<float>(0.0), static_cast<float>(1.0));
+
+      // Transformed coordinates.
+      tflite::gpu::float2 tc(DotProduct(args.x_transform, coord),
+                             DotProduct(args.y_transform, coord));
+
+      bool out_of_bound = tc.x < 0.0 || tc.x > input_width - 1 || tc.y < 0.0 ||
+                          tc.y > input_height - 1;
+
+      float* output =
+          args.output_data + Offset(args.output_shape, 0, out_y, out_x, 0);
+      if (out_of_bound) {
+        std::fill(output, output + output_channels, 0.0f);
+        continue;
+      }
+
+      // Corners position:
+      // q_11 --- q_21
+      // ----     ----
+      // q_12 --- q_22
+      const int x = static_cast<int>(std::floor(tc.x));
+      const int y = static_cast<int>(std::floor(tc.y));
+      const float right_contrib = tc.x - x;
+      const float lower_contrib = tc.y - y;
+
+      if (x + 1 < input_width && y + 1 < input_height) {
+        const float* q_11 =
+            args.input_data + Offset(args.input_shape, 0, y, x, 0);
+        const float* q_21 = q_11 + input_channels;
+        const float* q_12 = q_11 + input_width * input_channels;
+        const float* q_22 = q_12 + input_channels;
+        for (int out_z = 0; out_z < output_channels; ++out_z) {
+          float upper = (1.0f - right_contrib) * q_11[out_z] +
+                        right_contrib * q_21[out_z];
+          float lower = (1.0f - right_contrib) * q_12[out_z] +
+                        right_contrib * q_22[out_z];
+          output[out_z] =
+              lower_contrib * lower + (1.0f - lower_contrib) * upper;
+        }
+        continue;
+      }
+
+      // On the last input row or column, the corners beyond it read as zero.
+      auto ReadValue = [&](int h, int w, int z) -> float {
+        return h >= input_height || w >= input_width
+                   ? 0
+                   : args.input_data[Offset(args.input_shape, 0, h, w, z)];
+      };
+      for (int out_z = 0; out_z < output_channels; ++out_z) {
+        float upper = (1.0f - right_contrib) * ReadValue(y, x, out_z) +
+                      right_contrib * ReadValue(y, x + 1, out_z);
+        float lower = (1.0f - right_contrib) * ReadValue(y + 1, x, out_z) +
+                      right_contrib * ReadValue(y + 1, x + 1, out_z);
+        output[out_z] = lower_contrib * lower + (1.0f - lower_contrib) * upper;
+      }
+    }
+  }
+}
+
+class TransformTensorBilinearTask
+    : public tflite::cpu_backend_threadpool::Task {
+ public:
+  TransformTensorBilinearTask(const TransformTensorBilinearArgs& args,
+                              int output_y_begin, int output_y_end)
+      : args_(args),
+        output_y_begin_(output_y_begin),
+        output_y_end_(output_y_end) {}
+
+  void Run() override {
+    TransformTensorBilinearRows(args_, output_y_begin_, output_y_end_);
+  }
+
+ private:
+  const TransformTensorBilinearArgs& args_;
+  const int output_y_begin_;
+  const int output_y_end_;
+};
+
+// Splits the output rows between the threads of the TFLite CPU backend.
+void TransformTensorBilinear(TfLiteContext* context,
+                             const TransformTensorBilinearArgs& args) {
+  const int output_height = args.output_shape.Dims(1);
+  tflite::CpuBackendContext* cpu_backend_context =
+      tflite::CpuBackendContext::GetFromContext(context);
+  const int thread_count =
+      std::max(1, std::min(cpu_backend_context->max_num_threads(),
+                           output_height / kMinOutputRowsPerTask));
+  std::vector<TransformTensorBilinearTask> tasks;
+  tasks.reserve(thread_count);
+  for (int i = 0; i < thread_count; ++i) {
+    tasks.emplace_back(args, output_height * i / thread_count,
+                       output_height * (i + 1) / thread_count);
+  }
+  tflite::cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                          cpu_backend_context);
+}
+
 namespace v1 {
 
 inline void TransformTensor(
+    TfLiteContext* context,
     const tflite::gpu::TransformTensorBilinearAttributes& params,
     const tflite::RuntimeShape& input0_shape,
     const float* input_data_0,  // data
@@ -63,55 +198,9 @@ inline void TransformTensor(
   tflite::gpu::float4 y_transform(input_data_1[4], input_data_1[5],
                                   input_data_1[6], input_data_1[7]);
 
-  for (int out_y = 0; out_y < output_height; ++out_y) {
-    for (int out_x = 0; out_x < output_width; ++out_x) {
-      tflite::gpu::float4 coord(
-          static_cast<float>(out_x), static_cast<float>(out_y),
-          static_cast<float>(0.0), static_cast<float>(1.0));
-
-      // Transformed coordinates.
-      tflite::gpu::float2 tc(DotProduct(x_transform, coord),
-                             DotProduct(y_transform, coord));
-
-      bool out_of_bound = tc.x < 0.0 || tc.x > input_width - 1 || tc.y < 0.0 ||
-                          tc.y > input_height - 1;
-
-      for (int out_z = 0; out_z < output_channels; ++out_z) {
-        float result = 0;
-        if (!out_of_bound) {
-          // Corners position:
-          // q_11 --- q_21
-          // ----     ----
-          // q_12 --- q_22
-
-          auto ReadValue = [&](int h, int w) -> float {
-            return h < 0 || w < 0 || h >= input_height || w >= input_width
-                       ? 0
-                       : input_data_0[Offset(input_shape_with_batch, 0, h, w,
-                                             out_z)];
-          };
-
-          float q_11 = ReadValue(floor(tc.y), floor(tc.x));
-          float q_21 = ReadValue(floor(tc.y), floor(tc.x) + 1);
-          float q_12 = ReadValue(floor(tc.y) + 1, floor(tc.x));
-          float q_22 = ReadValue(floor(tc.y) + 1, floor(tc.x) + 1);
-
-          float right_contrib = tc.x - floor(tc.x);
-          float lower_contrib = tc.y - floor(tc.y);
-
-          float upper = (1.0 - right_contrib) * q_11 + right_contrib * q_21;
-          float lower = (1.0 - right_contrib) * q_12 + right_contrib * q_22;
-
-          result = lower_contrib * lower + (1.0 - lower_contrib) * upper;
-        }
-
-        const int out_offset =
-            Offset(output_shape_with_batch, 0, out_y, out_x, out_z);
-
-        output_data[out_offset] = result;
-      }
-    }
-  }
+  TransformTensorBilinear(
+      context, {x_transform, y_transform, std::move(input_shape_with_batch),
+                input_data_0, std::move(output_shape_with_batch), output_data});
 }
 
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
@@ -151,7 +240,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, output != nullptr);
 
   TransformTensor(
-      op_params, tflite::GetTensorShape(input0),
+      context, op_params, tflite::GetTensorShape(input0),
       tflite::GetTensorData<float>(input0), tflite::GetTensorShape(input1),
       tflite::GetTensorData<float>(input1), tflite::GetTensorShape(output),
       tflite::GetTensorData<float>(output));
@@ -162,6 +251,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 namespace v2 {
 
 inline void TransformTensorBilinearV2(
+    TfLiteContext* context,
     const tflite::gpu::TransformTensorBilinearAttributes& params,
     const tflite::RuntimeShape& input0_shape,
     const float* input_data_0,  // data
@@ -202,55 +292,9 @@ inline void TransformTensorBilinearV2(
   x_transform[3] += x_transform[0] * 0.5 + x_transform[1] * 0.5 - 0.5;
   y_transform[3] += y_transform[0] * 0.5 + y_transform[1] * 0.5 - 0.5;
 
-  for (int out_y = 0; out_y < output_height; ++out_y) {
-    for (int out_x = 0; out_x < output_width; ++out_x) {
-      tflite::gpu::float4 coord(
-          static_cast<float>(out_x), static_cast<float>(out_y),
-          static_cast<float>(0.0), static_cast<float>(1.0));
-
-      // Transformed coordinates.
-      tflite::gpu::float2 tc(DotProduct(x_transform, coord),
-                             DotProduct(y_transform, coord));
-
-      bool out_of_bound = tc.x < 0.0 || tc.x > input_width - 1 || tc.y < 0.0 ||
-                          tc.y > input_height - 1;
-
-      for (int out_z = 0; out_z < output_channels; ++out_z) {
-        float result = 0;
-        if (!out_of_bound) {
-          // Corners position:
-          // q_11 --- q_21
-          // ----     ----
-          // q_12 --- q_22
-
-          auto ReadValue = [&](int h, int w) -> float {
-            return h < 0 || w < 0 || h >= input_height || w >= input_width
-                       ? 0
-                       : input_data_0[Offset(input_shape_with_batch, 0, h, w,
-                                             out_z)];
-          };
-
-          float q_11 = ReadValue(floor(tc.y), floor(tc.x));
-          float q_21 = ReadValue(floor(tc.y), floor(tc.x) + 1);
-          float q_12 = ReadValue(floor(tc.y) + 1, floor(tc.x));
-          float q_22 = ReadValue(floor(tc.y) + 1, floor(tc.x) + 1);
-
-          float right_contrib = tc.x - floor(tc.x);
-          float lower_contrib = tc.y - floor(tc.y);
-
-          float upper = (1.0 - right_contrib) * q_11 + right_contrib * q_21;
-          float lower = (1.0 - right_contrib) * q_12 + right_contrib * q_22;
-
-          result = lower_contrib * lower + (1.0 - lower_contrib) * upper;
-        }
-
-        const int out_offset =
-            Offset(output_shape_with_batch, 0, out_y, out_x, out_z);
-
-        output_data[out_offset] = result;
-      }
-    }
-  }
+  TransformTensorBilinear(
+      context, {x_transform, y_transform, std::move(input_shape_with_batch),
+                input_data_0, std::move(output_shape_with_batch), output_data});
 }
 
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
@@ -290,7 +334,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, output != nullptr);
 
   TransformTensorBilinearV2(
-      op_params, tflite::GetTensorShape(input0),
+      context, op_params, tflite::GetTensorShape(input0),
       tflite::GetTensorData<float>(input0), tflite::GetTensorShape(input1),
       tflite::GetTensorData<float>(input1), tflite::GetTensorShape(output),
       tflite::GetTensorData<float>(output));
@@ -18,7 +18,13 @@
 
 #include "mediapipe/util/tflite/operations/transpose_conv_bias.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
+#include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/padding.h"
 
 namespace mediapipe {
@@ -30,30 +36,62 @@ constexpr int kBiasTensor = 2;
 constexpr int kDataInputTensor = 0;
 constexpr int kOutputTensor = 0;
 
-// These functions were copied from the following places:
-// https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/kernels/internal/reference/reference_ops.h
-// https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/kernels/transpose_conv.cc
+// Output rows below this many per thread are not worth a thread.
+constexpr int kMinOutputRowsPerTask = 4;
+
+// The filter reordered from OHWI to HWOI, so that the filter of each tap is a
+// contiguous output_depth x input_depth matrix. Kept in node->user_data and
+// reused while the weights are constant.
+struct OpData {
+  std::vector<float> packed_filter;
+  bool filter_packed = false;
+};
+
+void PackFilter(const ::tflite::RuntimeShape& filter_shape,
+                const float* filter_data, std::vector<float>* packed_filter) {
+  const int output_depth = filter_shape.Dims(0);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int input_depth = filter_shape.Dims(3);
+  packed_filter->resize(filter_shape.FlatSize());
+  float* packed = packed_filter->data();
+  for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+    for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+      for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+        const float* filter = filter_data + Offset(filter_shape, out_channel,
+                                                   filter_y, filter_x, 0);
+        std::copy(filter, filter + input_depth, packed);
+        packed += input_depth;
+      }
+    }
+  }
+}
 
-inline void TransposeConvBias(
-    const ::tflite::ConvParams& params,
-    const ::tflite::RuntimeShape& input_shape, const float* input_data,
-    const ::tflite::RuntimeShape& filter_shape, const float* filter_data,
-    const ::tflite::RuntimeShape& bias_shape, const float* bias_data,
-    const ::tflite::RuntimeShape& output_shape, float* output_data,
-    const ::tflite::RuntimeShape& im2col_shape, float* im2col_data) {
-  // Start of copy from
-  // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/kernels/internal/reference/reference_ops.h
-  const int stride_width = params.stride_width;
-  const int stride_height = params.stride_height;
-  const int pad_width = params.padding_values.width;
-  const int pad_height = params.padding_values.height;
-
-  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
-  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
-  TFLITE_DCHECK_EQ(bias_shape.DimensionsCount(), 1);
-  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
-  (void)im2col_data;   // only used in optimized code.
-  (void)im2col_shape;  // only used in optimized code.
+struct TransposeConvBiasArgs {
+  ::tflite::ConvParams params;
+  ::tflite::RuntimeShape input_shape;
+  const float* input_data;
+  ::tflite::RuntimeShape filter_shape;
+  const float* packed_filter_data;
+  const float* bias_data;
+  ::tflite::RuntimeShape output_shape;
+  float* output_data;
+};
+
+// Computes the output rows [output_y_begin, output_y_end). Each input pixel
+// is scattered to the output pixels it influences as one matrix-vector
+// product per filter tap, with the optimized tensor_utils kernels. This is
+// the reference TransposeConv with bias of the original MediaPipe version,
+// summed in a different order.
+void TransposeConvBiasRows(const TransposeConvBiasArgs& args,
+                           int output_y_begin, int output_y_end) {
+  const ::tflite::RuntimeShape& input_shape = args.input_shape;
+  const ::tflite::RuntimeShape& filter_shape = args.filter_shape;
+  const ::tflite::RuntimeShape& output_shape = args.output_shape;
+  const int stride_width = args.params.stride_width;
+  const int stride_height = args.params.stride_height;
+  const int pad_width = args.params.padding_values.width;
+  const int pad_height = args.params.padding_values.height;
 
   const int batches = MatchingDim(input_shape, 0, output_shape, 0);
   const int input_depth = MatchingDim(input_shape, 3, filter_shape, 3);
@@ -62,55 +100,85 @@ inline void TransposeConvBias(
   const int input_width = input_shape.Dims(2);
   const int filter_height = filter_shape.Dims(1);
   const int filter_width = filter_shape.Dims(2);
-  const int output_height = output_shape.Dims(1);
   const int output_width = output_shape.Dims(2);
-
-  // Start of MediaPipe modificiation.
+  const int tap_size = output_depth * input_depth;
 
   for (int batch = 0; batch < batches; ++batch) {
-    for (int out_y = 0; out_y < output_height; out_y++) {
-      for (int out_x = 0; out_x < output_width; out_x++) {
-        for (int out_channel = 0; out_channel < output_depth; out_channel++) {
-          output_data[Offset(output_shape, batch, out_y, out_x, out_channel)] =
-              bias_data[out_channel];
-        }
+    for (int out_y = output_y_begin; out_y < output_y_end; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        std::copy(args.bias_data, args.bias_data + output_depth,
+                  args.output_data +
+                      Offset(output_shape, batch, out_y, out_x, 0));
       }
     }
 
     for (int in_y = 0; in_y < input_height; ++in_y) {
-      for (int in_x = 0; in_x < input_width; ++in_x) {
-        for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
-          // Loop through the output elements it will influence
+      const int out_y_origin = (in_y * stride_height) - pad_height;
+      for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+        const int out_y = out_y_origin + filter_y;
+        // Only accumulate into the rows of this task.
+        if (out_y < output_y_begin || out_y >= output_y_end) continue;
+        for (int in_x = 0; in_x < input_width; ++in_x) {
           const int out_x_origin = (in_x * stride_width) - pad_width;
-          const int out_y_origin = (in_y * stride_height) - pad_height;
-          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
-            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
-              for (int out_channel = 0; out_channel < output_depth;
-                   ++out_channel) {
-                // Compute output element location
-                const int out_x = out_x_origin + filter_x;
-                const int out_y = out_y_origin + filter_y;
-                // We cannot accumulate out of bounds
-                if ((out_x >= 0) && (out_x < output_width) && (out_y >= 0) &&
-                    (out_y < output_height)) {
-                  float input_value = input_data[Offset(
-                      input_shape, batch, in_y, in_x, in_channel)];
-                  float filter_value =
-                      filter_data[Offset(filter_shape, out_channel, filter_y,
-                                         filter_x, in_channel)];
-                  output_data[Offset(output_shape, batch, out_y, out_x,
-                                     out_channel)] +=
-                      input_value * filter_value;
-                }
-              }
-            }
+          const float* input =
+              args.input_data + Offset(input_shape, batch, in_y, in_x, 0);
+          for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+            const int out_x = out_x_origin + filter_x;
+            // We cannot accumulate out of bounds
+            if (out_x < 0 || out_x >= output_width) continue;
+            const float* filter =
+                args.packed_filter_data +
+                (filter_y * filter_width + filter_x) * tap_size;
+            ::tflite::tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+                filter, output_depth, input_depth, input, /*n_batch=*/1,
+                args.output_data +
+                    Offset(output_shape, batch, out_y, out_x, 0));
           }
         }
       }
     }
   }
-  // End of MediaPipe modification.
-  // End of copy.
+}
+
+class TransposeConvBiasTask : public ::tflite::cpu_backend_threadpool::Task {
+ public:
+  TransposeConvBiasTask(const TransposeConvBiasArgs& args, int output_y_begin,
+                        int output_y_end)
+      : args_(args),
+        output_y_begin_(output_y_begin),
+        output_y_end_(output_y_end) {}
+
+  void Run() override {
+    TransposeConvBiasRows(args_, output_y_begin_, output_y_end_);
+  }
+
+ private:
+  const TransposeConvBiasArgs& args_;
+  const int output_y_begin_;
+  const int output_y_end_;
+};
+
+// Splits the output rows between the threads of the TFLite CPU backend. The
+// threads write disjoint output rows, so they need no synchronization.
+void TransposeConvBias(TfLiteContext* context,
+                       const TransposeConvBiasArgs& args) {
+  TFLITE_DCHECK_EQ(args.input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(args.filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(args.output_shape.DimensionsCount(), 4);
+  const int output_height = args.output_shape.Dims(1);
+  ::tflite::CpuBackendContext* cpu_backend_context =
+      ::tflite::CpuBackendContext::GetFromContext(context);
+  const int thread_count =
+      std::max(1, std::min(cpu_backend_context->max_num_threads(),
+                           output_height / kMinOutputRowsPerTask));
+  std::vector<TransposeConvBiasTask> tasks;
+  tasks.reserve(thread_count);
+  for (int i = 0; i < thread_count; ++i) {
+    tasks.emplace_back(args, output_height * i / thread_count,
+                       output_height * (i + 1) / thread_count);
+  }
+  ::tflite::cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                            cpu_backend_context);
 }
 
 // Start of copy from
@@ -163,6 +231,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   const int in_width = ::tflite::SizeOfDimension(input, 2);
   const int in_height = ::tflite::SizeOfDimension(input, 1);
 
+  // The weights may have been resized.
+  reinterpret_cast<OpData*>(node->user_data)->filter_packed = false;
+
   // Get height and width of the output image.
   TfLiteIntArray* output_shape_array = TfLiteIntArrayCreate(4);
   output_shape_array->data[0] = ::tflite::SizeOfDimension(input, 0);
@@ -227,21 +298,23 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       op_params.stride_width = stride_width;
       op_params.stride_height = stride_height;
 
-      TransposeConvBias(
-          op_params, ::tflite::GetTensorShape(input),
-          ::tflite::GetTensorData<float>(input),
-          ::tflite::GetTensorShape(weights),
-          ::tflite::GetTensorData<float>(weights),
-          ::tflite::GetTensorShape(bias), ::tflite::GetTensorData<float>(bias),
-          ::tflite::GetTensorShape(output),
-          ::tflite::GetTensorData<float>(output),
-          // Last two args specify im2col which reference_ops ignores.
-          // (Note this does not lead to a performance regression, as the
-          // previous optimized version was just a copy of the reference code.)
-          // TODO: Allocate im2col tensors and switch to
-          // optimized_ops.
-          ::tflite::GetTensorShape(output),
-          ::tflite::GetTensorData<float>(output));
+      auto* op_data = reinterpret_cast<OpData*>(node->user_data);
+      if (!op_data->filter_packed) {
+        PackFilter(::tflite::GetTensorShape(weights),
+                   ::tflite::GetTensorData<float>(weights),
+                   &op_data->packed_filter);
+        op_data->filter_packed = ::tflite::IsConstantTensor(weights);
+      }
+
+      TransposeConvBiasArgs args{op_params,
+                                 ::tflite::GetTensorShape(input),
+                                 ::tflite::GetTensorData<float>(input),
+                                 ::tflite::GetTensorShape(weights),
+                                 op_data->packed_filter.data(),
+                                 ::tflite::GetTensorData<float>(bias),
+                                 ::tflite::GetTensorShape(output),
+                                 ::tflite::GetTensorData<float>(output)};
+      TransposeConvBias(context, args);
       break;
     }
     default:
@@ -259,7 +332,14 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace
 
 TfLiteRegistration* RegisterConvolution2DTransposeBias() {
-  static TfLiteRegistration reg = {nullptr, nullptr, Prepare, Eval};
+  static TfLiteRegistration reg = {
+      [](TfLiteContext*, const char*, size_t) -> void* {
+        return new OpData();
+      },
+      [](TfLiteContext*, void* buffer) -> void {
+        delete reinterpret_cast<OpData*>(buffer);
+      },
+      Prepare, Eval};
   return &reg;
 }
 
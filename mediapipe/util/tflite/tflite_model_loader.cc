@@ -14,6 +14,10 @@
 
 #include "mediapipe/util/tflite/tflite_model_loader.h"
 
+#include <memory>
+#include <utility>
+
+#include "absl/strings/string_view.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/resource_util.h"
 
@@ -23,27 +27,30 @@ absl::StatusOr<api2::Packet<TfLiteModelPtr>> TfLiteModelLoader::LoadFromPath(
     const std::string& path) {
   std::string model_path = path;
 
-  std::string model_blob;
-  auto status_or_content =
-      mediapipe::GetResourceContents(model_path, &model_blob);
+  // Maps the model in memory instead of copying it when the platform allows
+  // it, e.g. for an uncompressed Android asset.
+  auto status_or_resource = mediapipe::GetResource(model_path);
   // TODO: get rid of manual resolving with PathToResourceAsFile
-  // as soon as it's incorporated into GetResourceContents.
-  if (!status_or_content.ok()) {
+  // as soon as it's incorporated into GetResource.
+  if (!status_or_resource.ok()) {
     ASSIGN_OR_RETURN(auto resolved_path,
                      mediapipe::PathToResourceAsFile(model_path));
     VLOG(2) << "Loading the model from " << resolved_path;
-    MP_RETURN_IF_ERROR(
-        mediapipe::GetResourceContents(resolved_path, &model_blob));
+    status_or_resource = mediapipe::GetResource(resolved_path);
   }
+  ASSIGN_OR_RETURN(std::shared_ptr<Resource> model_resource,
+                   std::move(status_or_resource));
 
+  const absl::string_view model_blob = model_resource->data();
   auto model = tflite::FlatBufferModel::VerifyAndBuildFromBuffer(
       model_blob.data(), model_blob.size());
   RET_CHECK(model) << "Failed to load model from path " << model_path;
   return api2::MakePacket<TfLiteModelPtr>(
       model.release(),
-      [model_blob = std::move(model_blob)](tflite::FlatBufferModel* model) {
-        // It's required that model_blob is deleted only after
-        // model is deleted, hence capturing model_blob.
+      [model_resource = std::move(model_resource)](
+          tflite::FlatBufferModel* model) {
+        // It's required that model_resource is deleted only after
+        // model is deleted, hence capturing model_resource.
         delete model;
       });
 }
@@ -16,6 +16,7 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 
@@ -131,5 +132,81 @@ double SamplesToSeconds(int64 num_samples, double sample_rate) {
   return (num_samples / sample_rate);
 }
 
+void TimeSeriesRingBuffer::Reset(int num_channels) {
+  num_channels_ = num_channels;
+  storage_.resize(num_channels, 0);
+  head_ = 0;
+  size_ = 0;
+}
+
+int TimeSeriesRingBuffer::Reserve(int num_samples) {
+  const int capacity = storage_.cols();
+  if (size_ + num_samples > capacity) {
+    // Grow geometrically, moving the buffered samples to the front.
+    Matrix grown(num_channels_, std::max(size_ + num_samples, 2 * capacity));
+    const int first_part = std::min(size_, capacity - head_);
+    grown.leftCols(first_part) = storage_.middleCols(head_, first_part);
+    grown.middleCols(first_part, size_ - first_part) =
+        storage_.leftCols(size_ - first_part);
+    storage_.swap(grown);
+    head_ = 0;
+  }
+  return (head_ + size_) % storage_.cols();
+}
+
+void TimeSeriesRingBuffer::Push(const Matrix& samples) {
+  CHECK_EQ(samples.rows(), num_channels_);
+  const int num_samples = samples.cols();
+  if (num_samples == 0) return;
+  const int start = Reserve(num_samples);
+  const int first_part = std::min<int>(num_samples, storage_.cols() - start);
+  storage_.middleCols(start, first_part) = samples.leftCols(first_part);
+  storage_.leftCols(num_samples - first_part) =
+      samples.rightCols(num_samples - first_part);
+  size_ += num_samples;
+}
+
+void TimeSeriesRingBuffer::PushZeros(int num_samples) {
+  CHECK_GE(num_samples, 0);
+  if (num_samples == 0) return;
+  const int start = Reserve(num_samples);
+  const int first_part = std::min<int>(num_samples, storage_.cols() - start);
+  storage_.middleCols(start, first_part).setZero();
+  storage_.leftCols(num_samples - first_part).setZero();
+  size_ += num_samples;
+}
+
+void TimeSeriesRingBuffer::Pop(int num_samples) {
+  num_samples = std::min(num_samples, size_);
+  if (num_samples <= 0) return;
+  size_ -= num_samples;
+  // Restarting at the first column keeps later frames contiguous for longer.
+  head_ = size_ == 0 ? 0 : (head_ + num_samples) % storage_.cols();
+}
+
+Eigen::Map<const Matrix> TimeSeriesRingBuffer::GetFrame(
+    int offset, int num_samples, Matrix* scratch) const {
+  CHECK_GE(offset, 0);
+  CHECK_GE(num_samples, 0);
+  CHECK_LE(offset + num_samples, size_);
+  if (num_samples == 0) {
+    return Eigen::Map<const Matrix>(storage_.data(), num_channels_, 0);
+  }
+  const int capacity = storage_.cols();
+  const int start = (head_ + offset) % capacity;
+  if (start + num_samples <= capacity) {
+    return Eigen::Map<const Matrix>(
+        storage_.data() + static_cast<int64>(start) * num_channels_,
+        num_channels_, num_samples);
+  }
+  const int first_part = capacity - start;
+  scratch->resize(num_channels_, num_samples);
+  scratch->leftCols(first_part) = storage_.middleCols(start, first_part);
+  scratch->rightCols(num_samples - first_part) =
+      storage_.leftCols(num_samples - first_part);
+  return Eigen::Map<const Matrix>(scratch->data(), num_channels_,
+                                  num_samples);
+}
+
 }  // namespace time_series_util
 }  // namespace mediapipe
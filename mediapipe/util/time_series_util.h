@@ -116,6 +116,49 @@ int64 SecondsToSamples(double time_in_seconds, double sample_rate);
 // spanned by the samples.
 double SamplesToSeconds(int64 num_samples, double sample_rate);
 
+// A FIFO of multichannel samples for framing time series, stored as the
+// columns of a circular Matrix. Frames are returned as views into the
+// buffer, and are only copied when they wrap around its end.
+class TimeSeriesRingBuffer {
+ public:
+  explicit TimeSeriesRingBuffer(int num_channels = 0)
+      : num_channels_(num_channels), storage_(num_channels, 0) {}
+
+  int num_channels() const { return num_channels_; }
+  // The number of buffered samples.
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Clears the buffer and sets the number of channels of future samples.
+  void Reset(int num_channels);
+
+  // Appends the columns of `samples`, which must have num_channels() rows.
+  void Push(const Matrix& samples);
+  // Appends `num_samples` samples of zeros.
+  void PushZeros(int num_samples);
+  // Removes the oldest `num_samples` samples, or all of them if fewer are
+  // buffered.
+  void Pop(int num_samples);
+
+  // Returns `num_samples` samples starting `offset` samples after the oldest
+  // one. The view stays valid until the buffer is modified. If the samples
+  // wrap around the end of the buffer, they are copied into `scratch` and the
+  // view refers to it.
+  Eigen::Map<const Matrix> GetFrame(int offset, int num_samples,
+                                    Matrix* scratch) const;
+
+ private:
+  // Makes room for `num_samples` more samples, and returns the column at
+  // which they start.
+  int Reserve(int num_samples);
+
+  int num_channels_;
+  Matrix storage_;
+  // Column of storage_ holding the oldest sample.
+  int head_ = 0;
+  int size_ = 0;
+};
+
 }  // namespace time_series_util
 }  // namespace mediapipe
 
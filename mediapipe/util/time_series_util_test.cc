@@ -14,6 +14,8 @@
 
 #include "mediapipe/util/time_series_util.h"
 
+#include <algorithm>
+
 #include "Eigen/Core"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/time_series_header.pb.h"
@@ -191,6 +193,59 @@ TEST(TimeSeriesUtilTest, SamplesToSeconds) {
             SamplesToSeconds(num_samples, sample_rate));
 }
 
+// Returns a matrix whose entries encode their sample and channel.
+Matrix TestSamples(int num_channels, int first_sample, int num_samples) {
+  Matrix samples(num_channels, num_samples);
+  for (int i = 0; i < num_samples; ++i) {
+    for (int c = 0; c < num_channels; ++c) {
+      samples(c, i) = 10 * (first_sample + i) + c;
+    }
+  }
+  return samples;
+}
+
+TEST(TimeSeriesRingBufferTest, ReturnsFramesAcrossWrapAround) {
+  TimeSeriesRingBuffer buffer(2);
+  buffer.Push(TestSamples(2, 0, 6));
+  buffer.Pop(4);
+  // Appending fewer samples than were popped reuses the freed columns, so
+  // the buffered samples wrap around.
+  buffer.Push(TestSamples(2, 6, 3));
+  ASSERT_EQ(buffer.size(), 5);
+
+  Matrix scratch;
+  const Eigen::Map<const Matrix> contiguous = buffer.GetFrame(0, 2, &scratch);
+  EXPECT_EQ(contiguous, TestSamples(2, 4, 2));
+  EXPECT_EQ(scratch.size(), 0);
+  const Eigen::Map<const Matrix> wrapped = buffer.GetFrame(1, 4, &scratch);
+  EXPECT_EQ(wrapped, TestSamples(2, 5, 4));
+  EXPECT_EQ(wrapped.data(), scratch.data());
+}
+
+TEST(TimeSeriesRingBufferTest, GrowsAndKeepsOrder) {
+  TimeSeriesRingBuffer buffer(3);
+  int pushed = 0;
+  int popped = 0;
+  Matrix scratch;
+  for (int step = 0; step < 20; ++step) {
+    const int num_pushed = step % 7 + 1;
+    buffer.Push(TestSamples(3, pushed, num_pushed));
+    pushed += num_pushed;
+    if (step % 3 == 0) {
+      buffer.PushZeros(0);
+    }
+    EXPECT_EQ(buffer.GetFrame(0, buffer.size(), &scratch),
+              TestSamples(3, popped, pushed - popped));
+    buffer.Pop(step % 5);
+    popped = std::min(popped + step % 5, pushed);
+  }
+  buffer.PushZeros(2);
+  EXPECT_EQ(buffer.GetFrame(buffer.size() - 2, 2, &scratch),
+            Matrix::Zero(3, 2));
+  buffer.Pop(buffer.size() + 1);
+  EXPECT_TRUE(buffer.empty());
+}
+
 }  // namespace
 }  // namespace time_series_util
 }  // namespace mediapipe
@@ -92,10 +92,36 @@ class BoxDetectorOpencvBfImpl : public BoxDetectorInterface {
   cv::BFMatcher bf_matcher_;
 };
 
+// Matches features with a FLANN k-d tree per box. Like the cross check of
+// BoxDetectorOpencvBfImpl, only the closest frame feature is kept for each
+// index feature, but among the frame features whose nearest neighbor it is.
+class BoxDetectorOpencvFlannImpl : public BoxDetectorInterface {
+ public:
+  explicit BoxDetectorOpencvFlannImpl(const BoxDetectorOptions &options)
+      : BoxDetectorInterface(options) {}
+
+ private:
+  std::vector<FeatureCorrespondence> MatchFeatureDescriptors(
+      const std::vector<Vector2_f> &features, const cv::Mat &descriptors,
+      int box_idx) override;
+
+  struct BoxIndex {
+    // The descriptors the index was built from. Holding them also keeps
+    // their data from being reused by the next descriptors of the box.
+    cv::Mat descriptors;
+    std::unique_ptr<cv::flann::Index> index;
+  };
+
+  // Keyed by box id, as box indices shift when boxes are canceled.
+  absl::flat_hash_map<int, BoxIndex> box_indexes_;
+};
+
 std::unique_ptr<BoxDetectorInterface> BoxDetectorInterface::Create(
     const BoxDetectorOptions &options) {
   if (options.index_type() == BoxDetectorOptions::OPENCV_BF) {
     return absl::make_unique<BoxDetectorOpencvBfImpl>(options);
+  } else if (options.index_type() == BoxDetectorOptions::OPENCV_FLANN) {
+    return absl::make_unique<BoxDetectorOpencvFlannImpl>(options);
   } else {
     LOG(FATAL) << "index type undefined.";
   }
@@ -746,4 +772,63 @@ BoxDetectorOpencvBfImpl::MatchFeatureDescriptors(
   return correspondence_result;
 }
 
+std::vector<FeatureCorrespondence>
+BoxDetectorOpencvFlannImpl::MatchFeatureDescriptors(
+    const std::vector<Vector2_f> &features, const cv::Mat &descriptors,
+    int box_idx) {
+  CHECK_EQ(features.size(), descriptors.rows);
+
+  std::vector<FeatureCorrespondence> correspondence_result(
+      frame_box_[box_idx].size());
+  const cv::Mat &box_descriptors = feature_descriptors_[box_idx];
+  if (features.empty() || descriptors.rows == 0 || descriptors.cols == 0 ||
+      box_descriptors.rows == 0) {
+    return correspondence_result;
+  }
+
+  BoxIndex &box_index = box_indexes_[box_idx_to_id_[box_idx]];
+  // Descriptors are replaced rather than modified when features are added to
+  // the box, so the index is up to date if they share the data.
+  if (!box_index.index || box_index.descriptors.data != box_descriptors.data) {
+    box_index.descriptors = box_descriptors;
+    box_index.index = absl::make_unique<cv::flann::Index>(
+        box_index.descriptors,
+        cv::flann::KDTreeIndexParams(options_.flann_settings().num_trees()));
+  }
+
+  cv::Mat query = descriptors;
+  if (query.type() != CV_32F) descriptors.convertTo(query, CV_32F);
+  cv::Mat indices;
+  cv::Mat squared_distances;
+  box_index.index->knnSearch(
+      query, indices, squared_distances, /*knn=*/1,
+      cv::flann::SearchParams(options_.flann_settings().checks()));
+
+  // The closest frame feature of each matched index feature.
+  absl::flat_hash_map<int, int> best_query_for_train;
+  const float max_squared_distance =
+      options_.max_match_distance() * options_.max_match_distance();
+  for (int query_idx = 0; query_idx < query.rows; ++query_idx) {
+    const int train_idx = indices.at<int>(query_idx, 0);
+    const float squared_distance = squared_distances.at<float>(query_idx, 0);
+    if (train_idx < 0 || squared_distance > max_squared_distance) continue;
+    auto [it, inserted] = best_query_for_train.emplace(train_idx, query_idx);
+    if (!inserted &&
+        squared_distance < squared_distances.at<float>(it->second, 0)) {
+      it->second = query_idx;
+    }
+  }
+
+  for (const auto &[train_idx, query_idx] : best_query_for_train) {
+    const int match_idx = feature_to_frame_[box_idx][train_idx];
+    correspondence_result[match_idx].points_frame.push_back(
+        cv::Point2f(features[query_idx].x(), features[query_idx].y()));
+    correspondence_result[match_idx].points_index.push_back(
+        cv::Point2f(feature_keypoints_[box_idx][train_idx].x(),
+                    feature_keypoints_[box_idx][train_idx].y()));
+  }
+
+  return correspondence_result;
+}
+
 }  // namespace mediapipe
@@ -0,0 +1,203 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/box_detector.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/vector.h"
+#include "mediapipe/util/tracking/box_detector.pb.h"
+#include "mediapipe/util/tracking/box_tracker.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFeatures = 1000;
+constexpr int kNumDistractors = 200;
+constexpr int kDescriptorDims = 40;
+constexpr float kShiftX = 0.05f;
+constexpr float kShiftY = 0.02f;
+
+struct Frame {
+  std::vector<Vector2_f> features;
+  cv::Mat descriptors;
+};
+
+// Returns features spread over the frame, each with its own random
+// descriptor.
+Frame RandomFrame(int num_features, std::mt19937* rng) {
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  Frame frame;
+  frame.descriptors = cv::Mat(num_features, kDescriptorDims, CV_32F);
+  for (int i = 0; i < num_features; ++i) {
+    frame.features.emplace_back(unit(*rng), unit(*rng));
+    float* descriptor = frame.descriptors.ptr<float>(i);
+    for (int d = 0; d < kDescriptorDims; ++d) {
+      descriptor[d] = unit(*rng);
+    }
+  }
+  return frame;
+}
+
+// Returns the features of `frame` shifted by (kShiftX, kShiftY) with slightly
+// perturbed descriptors, followed by unrelated distractor features.
+Frame ShiftedFrame(const Frame& frame, std::mt19937* rng) {
+  std::uniform_real_distribution<float> noise(-0.01f, 0.01f);
+  const Frame distractors = RandomFrame(kNumDistractors, rng);
+  Frame shifted;
+  for (const auto& feature : frame.features) {
+    shifted.features.push_back(feature + Vector2_f(kShiftX, kShiftY));
+  }
+  shifted.features.insert(shifted.features.end(),
+                          distractors.features.begin(),
+                          distractors.features.end());
+  cv::vconcat(frame.descriptors, distractors.descriptors, shifted.descriptors);
+  for (int i = 0; i < frame.descriptors.rows; ++i) {
+    float* descriptor = shifted.descriptors.ptr<float>(i);
+    for (int d = 0; d < kDescriptorDims; ++d) {
+      descriptor[d] += noise(*rng);
+    }
+  }
+  return shifted;
+}
+
+TimedBoxProto ReacquisitionBox(int id, float left, float top, float right,
+                               float bottom) {
+  TimedBoxProto box;
+  box.set_id(id);
+  box.set_left(left);
+  box.set_top(top);
+  box.set_right(right);
+  box.set_bottom(bottom);
+  box.set_reacquisition(true);
+  return box;
+}
+
+TimedBoxProtoList IndexedBoxes() {
+  TimedBoxProtoList boxes;
+  *boxes.add_box() = ReacquisitionBox(1, 0.1f, 0.1f, 0.4f, 0.4f);
+  *boxes.add_box() = ReacquisitionBox(2, 0.55f, 0.5f, 0.9f, 0.85f);
+  return boxes;
+}
+
+std::unique_ptr<BoxDetectorInterface> CreateDetector(
+    BoxDetectorOptions::IndexType index_type) {
+  BoxDetectorOptions options;
+  options.set_index_type(index_type);
+  return BoxDetectorInterface::Create(options);
+}
+
+// Adds the boxes of IndexedBoxes() from `frame` to the index of `detector`.
+void AddBoxes(const Frame& frame, BoxDetectorInterface* detector) {
+  TimedBoxProtoList detected;
+  detector->DetectAndAddBoxFromFeatures(
+      frame.features, frame.descriptors, IndexedBoxes(), /*timestamp_msec=*/0,
+      /*scale_x=*/1.f, /*scale_y=*/1.f, &detected);
+  EXPECT_EQ(detected.box_size(), 0);
+}
+
+// Detects all the indexed boxes, none of which is tracked.
+TimedBoxProtoList Detect(const Frame& frame, BoxDetectorInterface* detector) {
+  TimedBoxProtoList detected;
+  detector->DetectAndAddBoxFromFeatures(
+      frame.features, frame.descriptors, TimedBoxProtoList(),
+      /*timestamp_msec=*/1000, /*scale_x=*/1.f, /*scale_y=*/1.f, &detected);
+  return detected;
+}
+
+void ExpectSameBoxes(const TimedBoxProtoList& expected,
+                     const TimedBoxProtoList& actual, float tolerance) {
+  ASSERT_EQ(actual.box_size(), expected.box_size());
+  for (int i = 0; i < expected.box_size(); ++i) {
+    SCOPED_TRACE(testing::Message() << "box " << expected.box(i).id());
+    EXPECT_EQ(actual.box(i).id(), expected.box(i).id());
+    EXPECT_NEAR(actual.box(i).left(), expected.box(i).left(), tolerance);
+    EXPECT_NEAR(actual.box(i).top(), expected.box(i).top(), tolerance);
+    EXPECT_NEAR(actual.box(i).right(), expected.box(i).right(), tolerance);
+    EXPECT_NEAR(actual.box(i).bottom(), expected.box(i).bottom(), tolerance);
+    EXPECT_NEAR(actual.box(i).rotation(), expected.box(i).rotation(),
+                tolerance);
+  }
+}
+
+class BoxDetectorFlannTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::mt19937 rng(/*seed=*/7);
+    frame_ = RandomFrame(kNumFeatures, &rng);
+    shifted_frame_ = ShiftedFrame(frame_, &rng);
+
+    bf_detector_ = CreateDetector(BoxDetectorOptions::OPENCV_BF);
+    AddBoxes(frame_, bf_detector_.get());
+  }
+
+  Frame frame_;
+  Frame shifted_frame_;
+  std::unique_ptr<BoxDetectorInterface> bf_detector_;
+};
+
+TEST_F(BoxDetectorFlannTest, BruteForceFindsShiftedBoxes) {
+  TimedBoxProtoList expected;
+  for (const auto& box : IndexedBoxes().box()) {
+    *expected.add_box() =
+        ReacquisitionBox(box.id(), box.left() + kShiftX, box.top() + kShiftY,
+                         box.right() + kShiftX, box.bottom() + kShiftY);
+  }
+  ExpectSameBoxes(expected, Detect(shifted_frame_, bf_detector_.get()), 1e-3f);
+}
+
+TEST_F(BoxDetectorFlannTest, DetectsSameBoxesAsBruteForce) {
+  const TimedBoxProtoList expected =
+      Detect(shifted_frame_, bf_detector_.get());
+  ASSERT_EQ(expected.box_size(), 2);
+
+  auto flann_detector = CreateDetector(BoxDetectorOptions::OPENCV_FLANN);
+  AddBoxes(frame_, flann_detector.get());
+  ExpectSameBoxes(expected, Detect(shifted_frame_, flann_detector.get()),
+                  1e-4f);
+  // The second query reuses the k-d trees built by the first one.
+  ExpectSameBoxes(expected, Detect(shifted_frame_, flann_detector.get()),
+                  1e-4f);
+}
+
+TEST_F(BoxDetectorFlannTest, DetectsSameBoxesFromLoadedIndex) {
+  auto flann_detector = CreateDetector(BoxDetectorOptions::OPENCV_FLANN);
+  flann_detector->AddBoxDetectorIndex(bf_detector_->ObtainBoxDetectorIndex());
+  ExpectSameBoxes(Detect(shifted_frame_, bf_detector_.get()),
+                  Detect(shifted_frame_, flann_detector.get()), 1e-4f);
+}
+
+TEST_F(BoxDetectorFlannTest, DetectsSameBoxesAfterCancellation) {
+  auto flann_detector = CreateDetector(BoxDetectorOptions::OPENCV_FLANN);
+  AddBoxes(frame_, flann_detector.get());
+  // Builds the k-d trees of both boxes.
+  ASSERT_EQ(Detect(shifted_frame_, flann_detector.get()).box_size(), 2);
+
+  // Canceling the first box shifts the index of the second one.
+  bf_detector_->CancelBoxDetection(1);
+  flann_detector->CancelBoxDetection(1);
+  const TimedBoxProtoList expected =
+      Detect(shifted_frame_, bf_detector_.get());
+  ASSERT_EQ(expected.box_size(), 1);
+  EXPECT_EQ(expected.box(0).id(), 2);
+  ExpectSameBoxes(expected, Detect(shifted_frame_, flann_detector.get()),
+                  1e-4f);
+}
+
+}  // namespace
+}  // namespace mediapipe
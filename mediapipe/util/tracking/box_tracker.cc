@@ -27,6 +27,7 @@
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/util/tracking/measure_time.h"
 #include "mediapipe/util/tracking/tracking.pb.h"
+#include "mediapipe/util/tracking/tracking_data_cache.h"
 
 namespace mediapipe {
 
@@ -636,7 +637,16 @@ std::unique_ptr<TrackingDataChunk> BoxTracker::ReadChunkFromCache(
   in.read(&data[0], data.size());
   in.close();
 
-  chunk_data->ParseFromString(data);
+  if (IsTrackingDataCache(data)) {
+    TrackingDataCacheView view;
+    if (!view.Init(data)) {
+      LOG(ERROR) << "Invalid tracking data cache: " << chunk_file;
+      return nullptr;
+    }
+    view.DecodeChunk(0, view.num_frames(), chunk_data.get());
+  } else {
+    chunk_data->ParseFromString(data);
+  }
 
   VLOG(1) << "Read success";
   return chunk_data;
@@ -271,7 +271,26 @@ class MotionEstimationThreadStorage {
     return grid_cell_weights_;
   }
 
-  // Creates copy of current thread storage, caller takes ownership.
+  // Workspace for the least squares solvers of homographies and mixtures.
+  // Sized by the first IRLS round of a frame and reused by the following
+  // rounds, which solve systems of the same size.
+  struct SolverWorkspace {
+    Eigen::Matrix<float, Eigen::Dynamic, 8> homography_matrix;
+    Eigen::Matrix<float, Eigen::Dynamic, 1> homography_rhs;
+    Eigen::ColPivHouseholderQR<Eigen::Matrix<float, Eigen::Dynamic, 8>>
+        homography_qr;
+
+    Eigen::MatrixXf mixture_matrix;
+    Eigen::MatrixXf mixture_solution;
+    Eigen::VectorXf mixture_rhs;
+    Eigen::ColPivHouseholderQR<Eigen::MatrixXf> mixture_qr;
+    std::vector<float> mixture_solution_unpacked;
+  };
+
+  SolverWorkspace* GetSolverWorkspace() { return &solver_workspace_; }
+
+  // Creates copy of current thread storage, caller takes ownership. The solver
+  // workspace is not copied.
   std::unique_ptr<MotionEstimationThreadStorage> Copy() const {
     std::unique_ptr<MotionEstimationThreadStorage> copy(
         new MotionEstimationThreadStorage);
@@ -286,6 +305,7 @@ class MotionEstimationThreadStorage {
 
   std::vector<std::vector<float>> grid_coverage_irls_mask_;
   std::vector<float> grid_cell_weights_;
+  SolverWorkspace solver_workspace_;
 };
 
 // Holds all the data for a clip (multiple frames) of single-frame tracks.
@@ -3758,8 +3778,12 @@ bool HomographyL2QRSolve(
     const Homography* prev_solution,  // optional.
     float perspective_regularizer,
     Eigen::Matrix<T, Eigen::Dynamic, 8>* matrix,  // tmp matrix
+    Eigen::Matrix<T, Eigen::Dynamic, 1>* rhs,     // tmp rhs
+    Eigen::ColPivHouseholderQR<Eigen::Matrix<T, Eigen::Dynamic, 8>>* qr,
     Eigen::Matrix<T, 8, 1>* solution) {
   CHECK(matrix);
+  CHECK(rhs);
+  CHECK(qr);
   CHECK(solution);
   CHECK_EQ(8, matrix->cols());
   const int num_rows =
@@ -3769,9 +3793,8 @@ bool HomographyL2QRSolve(
   CHECK_EQ(8, solution->rows());
 
   // Compute homography from features (H * location = prev_location).
-  *matrix = Eigen::Matrix<T, Eigen::Dynamic, 8>::Zero(matrix->rows(), 8);
-  Eigen::Matrix<T, Eigen::Dynamic, 1> rhs =
-      Eigen::Matrix<T, Eigen::Dynamic, 1>::Zero(matrix->rows(), 1);
+  matrix->setZero();
+  rhs->setZero(matrix->rows());
 
   if (RegionFlowFeatureIRLSSum(feature_list) > kMaxCondition) {
     return false;
@@ -3810,7 +3833,7 @@ bool HomographyL2QRSolve(
     // Entry 3 .. 5 equal zero.
     (*matrix)(feature_row, 6) = -pt_w.x() * prev_pt.x();
     (*matrix)(feature_row, 7) = -pt_w.y() * prev_pt.x();
-    rhs(feature_row, 0) = prev_pt.x() * w;
+    (*rhs)(feature_row, 0) = prev_pt.x() * w;
 
     // Row 2 of above J:
     // Entry 0 .. 2 equal zero.
@@ -3820,7 +3843,7 @@ bool HomographyL2QRSolve(
 
     (*matrix)(feature_row + 1, 6) = -pt_w.x() * prev_pt.y();
     (*matrix)(feature_row + 1, 7) = -pt_w.y() * prev_pt.y();
-    rhs(feature_row + 1, 0) = prev_pt.y() * w;
+    (*rhs)(feature_row + 1, 0) = prev_pt.y() * w;
   }
 
   if (perspective_regularizer > 0) {
@@ -3830,8 +3853,9 @@ bool HomographyL2QRSolve(
   }
 
   // TODO: Consider a faster function?
-  *solution = matrix->colPivHouseholderQr().solve(rhs);
-  return ((*matrix) * (*solution)).isApprox(rhs, kPrecision);
+  qr->compute(*matrix);
+  *solution = qr->solve(*rhs);
+  return ((*matrix) * (*solution)).isApprox(*rhs, kPrecision);
 }
 
 // Same as function above, but solves for homography via normal equations,
@@ -3852,11 +3876,34 @@ Homography HomographyL2NormalEquationSolve(
   CHECK(rhs != nullptr);
   CHECK(solution != nullptr);
 
-  *matrix = Eigen::Matrix<T, 8, 8>::Zero();
-  *rhs = Eigen::Matrix<T, 8, 1>::Zero();
-
-  // Matrix multiplications are hand-coded for speed improvements vs.
-  // opencv's cvGEMM calls.
+  // Jacobian
+  // double J[2 * 8] = {x, y, 1,  0,  0,   0, -x * m_x, -y * m_x,
+  //                   {0, 0, 0,  x,  y,   1, -x * m_y, -y * m_y}
+  //
+  // // Compute J^t * J * w =
+  // ( xx        xy    x      0       0    0    -xx*mx  -xy*mx    )
+  // ( xy        yy    y      0       0    0    -xy*mx  -yy*mx    )
+  // ( x         y     1      0       0    0     -x*mx   -y*mx    )
+  // ( 0         0     0     xx      xy    x    -xx*my  -xy*my    )
+  // ( 0         0     0     xy      yy    y    -xy*my  -yy*my    )
+  // ( 0         0     0      x      y     1     -x*my   -y*my    )
+  // ( -xx*mx -xy*mx -x*mx -xx*my -xy*my -x*my xx*mxxyy  xy*mxxyy )
+  // ( -xy*mx -yy*mx -y*mx -xy*my -yy*my -y*my xy*mxxyy  yy*mxxyy  ) * w
+  //
+  // Right hand side:
+  // b = ( x
+  //       y )
+  // Compute J^t * b  * w =
+  // ( x*mx  y*mx  mx  x*my  y*my  my  -x*mxxyy -y*mxxyy ) * w
+  //
+  // Every entry above is the product of one of the 6 terms
+  // t = (xx, xy, x, yy, y, 1) * w with one of the 4 factors
+  // f = (1, mx, my, mxxyy). Instead of updating the 64 + 8 entries per
+  // feature, we accumulate the 6x4 outer products t * f^T, which vectorizes
+  // well, and assemble the system from their sum afterwards.
+  Eigen::Matrix<T, 6, 4> sums = Eigen::Matrix<T, 6, 4>::Zero();
+  Eigen::Matrix<T, 6, 1> terms;
+  Eigen::Matrix<T, 1, 4> factors;
   for (const auto& feature : feature_list.feature()) {
     T scale = 1.0;
     if (prev_solution) {
@@ -3871,114 +3918,43 @@ Homography HomographyL2NormalEquationSolve(
     const T w = feature.irls_weight() * scale;
     const T x = feature.x();
     const T y = feature.y();
-    const T xw = x * w;
-    const T yw = y * w;
-    const T xxw = x * x * w;
-    const T yyw = y * y * w;
-    const T xyw = x * y * w;
     const T mx = feature.x() + feature.dx();
     const T my = feature.y() + feature.dy();
 
-    const T mxxyy = mx * mx + my * my;
-    // Jacobian
-    // double J[2 * 8] = {x, y, 1,  0,  0,   0, -x * m_x, -y * m_x,
-    //                   {0, 0, 0,  x,  y,   1, -x * m_y, -y * m_y}
-    //
-    // // Compute J^t * J * w =
-    // ( xx        xy    x      0       0    0    -xx*mx  -xy*mx    )
-    // ( xy        yy    y      0       0    0    -xy*mx  -yy*mx    )
-    // ( x         y     1      0       0    0     -x*mx   -y*mx    )
-    // ( 0         0     0     xx      xy    x    -xx*my  -xy*my    )
-    // ( 0         0     0     xy      yy    y    -xy*my  -yy*my    )
-    // ( 0         0     0      x      y     1     -x*my   -y*my    )
-    // ( -xx*mx -xy*mx -x*mx -xx*my -xy*my -x*my xx*mxxyy  xy*mxxyy )
-    // ( -xy*mx -yy*mx -y*mx -xy*my -yy*my -y*my xy*mxxyy  yy*mxxyy  ) * w
-
-    // 1st row:  xx        xy    x      0       0    0    -xx*mx  -xy*mx
-    T* matrix_ptr = matrix->data();
-    matrix_ptr[0] += xxw;
-    matrix_ptr[1] += xyw;
-    matrix_ptr[2] += xw;
-    matrix_ptr[6] += -xxw * mx;
-    matrix_ptr[7] += -xyw * mx;
-
-    // 2nd row:  xy       yy   y      0       0    0    -xy*mx  -yy*mx
-    matrix_ptr += 8;
-    matrix_ptr[0] += xyw;
-    matrix_ptr[1] += yyw;
-    matrix_ptr[2] += yw;
-    matrix_ptr[6] += -xyw * mx;
-    matrix_ptr[7] += -yyw * mx;
-
-    // 3rd row: x         y     1      0       0    0     -x*mx   -y*mx
-    matrix_ptr += 8;
-    matrix_ptr[0] += xw;
-    matrix_ptr[1] += yw;
-    matrix_ptr[2] += w;
-    matrix_ptr[6] += -xw * mx;
-    matrix_ptr[7] += -yw * mx;
-
-    // 4th row: 0         0     0     xx      xy    x    -xx*my  -xy*my
-    matrix_ptr += 8;
-    matrix_ptr[3] += xxw;
-    matrix_ptr[4] += xyw;
-    matrix_ptr[5] += xw;
-    matrix_ptr[6] += -xxw * my;
-    matrix_ptr[7] += -xyw * my;
-
-    // 5th row: 0         0     0     xy      yy    y    -xy*my  -yy*my
-    matrix_ptr += 8;
-    matrix_ptr[3] += xyw;
-    matrix_ptr[4] += yyw;
-    matrix_ptr[5] += yw;
-    matrix_ptr[6] += -xyw * my;
-    matrix_ptr[7] += -yyw * my;
-
-    // 6th row:  0         0     0     x     y     1      -x*my    -y*my
-    matrix_ptr += 8;
-    matrix_ptr[3] += xw;
-    matrix_ptr[4] += yw;
-    matrix_ptr[5] += w;
-    matrix_ptr[6] += -xw * my;
-    matrix_ptr[7] += -yw * my;
-
-    // 7th row:  -xx*mx -xy*mx -x*mx -xx*my -xy*my -x*my xx*mxxyy  xy*mxxyy
-    matrix_ptr += 8;
-    matrix_ptr[0] += -xxw * mx;
-    matrix_ptr[1] += -xyw * mx;
-    matrix_ptr[2] += -xw * mx;
-    matrix_ptr[3] += -xxw * my;
-    matrix_ptr[4] += -xyw * my;
-    matrix_ptr[5] += -xw * my;
-    matrix_ptr[6] += xxw * mxxyy;
-    matrix_ptr[7] += xyw * mxxyy;
-
-    // 8th row: -xy*mx -yy*mx -y*mx -xy*my -yy*my -y*my xy*mxxyy  yy*mxxyy
-    matrix_ptr += 8;
-    matrix_ptr[0] += -xyw * mx;
-    matrix_ptr[1] += -yyw * mx;
-    matrix_ptr[2] += -yw * mx;
-    matrix_ptr[3] += -xyw * my;
-    matrix_ptr[4] += -yyw * my;
-    matrix_ptr[5] += -yw * my;
-    matrix_ptr[6] += xyw * mxxyy;
-    matrix_ptr[7] += yyw * mxxyy;
-
-    // Right hand side:
-    // b = ( x
-    //       y )
-    // Compute J^t * b  * w =
-    // ( x*mx  y*mx  mx  x*my  y*my  my  -x*mxxyy -y*mxxyy ) * w
-    T* rhs_ptr = rhs->data();
-    rhs_ptr[0] += xw * mx;
-    rhs_ptr[1] += yw * mx;
-    rhs_ptr[2] += mx * w;
-    rhs_ptr[3] += xw * my;
-    rhs_ptr[4] += yw * my;
-    rhs_ptr[5] += my * w;
-    rhs_ptr[6] += -xw * mxxyy;
-    rhs_ptr[7] += -yw * mxxyy;
-  }
+    terms << x * x * w, x * y * w, x * w, y * y * w, y * w, w;
+    factors << 1, mx, my, mx * mx + my * my;
+    sums.noalias() += terms * factors;
+  }
+
+  // Rows and columns of terms in sums.
+  enum { XX = 0, XY = 1, X = 2, YY = 3, Y = 4, W = 5 };
+  enum { ONE = 0, MX = 1, MY = 2, MXXYY = 3 };
+
+  // Upper left and center 3x3 blocks are identical.
+  Eigen::Matrix<T, 3, 3> block;
+  block << sums(XX, ONE), sums(XY, ONE), sums(X, ONE),  //
+      sums(XY, ONE), sums(YY, ONE), sums(Y, ONE),       //
+      sums(X, ONE), sums(Y, ONE), sums(W, ONE);
+  matrix->setZero();
+  matrix->template block<3, 3>(0, 0) = block;
+  matrix->template block<3, 3>(3, 3) = block;
+
+  // Last two columns, mirrored to last two rows.
+  Eigen::Matrix<T, 6, 2> cols;
+  cols << -sums(XX, MX), -sums(XY, MX),  //
+      -sums(XY, MX), -sums(YY, MX),      //
+      -sums(X, MX), -sums(Y, MX),        //
+      -sums(XX, MY), -sums(XY, MY),      //
+      -sums(XY, MY), -sums(YY, MY),      //
+      -sums(X, MY), -sums(Y, MY);
+  matrix->template block<6, 2>(0, 6) = cols;
+  matrix->template block<2, 6>(6, 0) = cols.transpose();
+  (*matrix)(6, 6) = sums(XX, MXXYY);
+  (*matrix)(6, 7) = (*matrix)(7, 6) = sums(XY, MXXYY);
+  (*matrix)(7, 7) = sums(YY, MXXYY);
+
+  *rhs << sums(X, MX), sums(Y, MX), sums(W, MX), sums(X, MY), sums(Y, MY),
+      sums(W, MY), -sums(X, MXXYY), -sums(Y, MXXYY);
 
   if (perspective_regularizer > 0) {
     // Additional constraint:
@@ -4053,8 +4029,12 @@ bool MixtureHomographyL2DLTSolve(
     const RegionFlowFeatureList& feature_list, int num_models,
     const MixtureRowWeights& row_weights, float regularizer_lambda,
     Eigen::MatrixXf* matrix,  // least squares matrix
+    Eigen::VectorXf* rhs,     // least squares rhs
+    Eigen::ColPivHouseholderQR<Eigen::MatrixXf>* qr,
     Eigen::MatrixXf* solution) {
   CHECK(matrix);
+  CHECK(rhs);
+  CHECK(qr);
   CHECK(solution);
 
   // cv::solve can hang for really bad conditioned systems.
@@ -4073,9 +4053,8 @@ bool MixtureHomographyL2DLTSolve(
   CHECK_EQ(solution->rows(), num_dof);
 
   // Compute homography from features. (H * location = prev_location)
-  *matrix = Eigen::MatrixXf::Zero(matrix->rows(), matrix->cols());
-  Eigen::Matrix<float, Eigen::Dynamic, 1> rhs =
-      Eigen::MatrixXf::Zero(matrix->rows(), 1);
+  matrix->setZero();
+  rhs->setZero(matrix->rows());
 
   // Normalize feature sum to 1.
   float irls_denom = 1.0 / (feature_irls_sum + 1e-6);
@@ -4086,8 +4065,8 @@ bool MixtureHomographyL2DLTSolve(
        feature != feature_list.feature().end(); ++feature, ++feature_idx) {
     float* mat_row_1 = matrix->row(2 * feature_idx).data();
     float* mat_row_2 = matrix->row(2 * feature_idx + 1).data();
-    float* rhs_row_1 = rhs.row(2 * feature_idx).data();
-    float* rhs_row_2 = rhs.row(2 * feature_idx + 1).data();
+    float* rhs_row_1 = rhs->row(2 * feature_idx).data();
+    float* rhs_row_2 = rhs->row(2 * feature_idx + 1).data();
 
     Vector2_f pt = FeatureLocation(*feature);
     Vector2_f prev_pt = FeatureMatchLocation(*feature);
@@ -4137,8 +4116,9 @@ bool MixtureHomographyL2DLTSolve(
   }
 
   // TODO: Consider a faster function?
-  *solution = matrix->colPivHouseholderQr().solve(rhs);
-  return ((*matrix) * (*solution)).isApprox(rhs, kPrecision);
+  qr->compute(*matrix);
+  *solution = qr->solve(*rhs);
+  return ((*matrix) * (*solution)).isApprox(*rhs, kPrecision);
 }
 
 // Constraint mixture homography model.
@@ -4149,8 +4129,12 @@ bool TransMixtureHomographyL2DLTSolve(
     const RegionFlowFeatureList& feature_list, int num_models,
     const MixtureRowWeights& row_weights, float regularizer_lambda,
     Eigen::MatrixXf* matrix,  // least squares matrix
+    Eigen::VectorXf* rhs,     // least squares rhs
+    Eigen::ColPivHouseholderQR<Eigen::MatrixXf>* qr,
     Eigen::MatrixXf* solution) {
   CHECK(matrix);
+  CHECK(rhs);
+  CHECK(qr);
   CHECK(solution);
 
   // cv::solve can hang for really bad conditioned systems.
@@ -4169,9 +4153,8 @@ bool TransMixtureHomographyL2DLTSolve(
   CHECK_EQ(solution->rows(), num_dof);
 
   // Compute homography from features. (H * location = prev_location)
-  *matrix = Eigen::MatrixXf::Zero(matrix->rows(), matrix->cols());
-  Eigen::Matrix<float, Eigen::Dynamic, 1> rhs =
-      Eigen::MatrixXf::Zero(matrix->rows(), 1);
+  matrix->setZero();
+  rhs->setZero(matrix->rows());
 
   // Create matrix for DLT.
   int feature_idx = 0;
@@ -4183,8 +4166,8 @@ bool TransMixtureHomographyL2DLTSolve(
        feature != feature_list.feature().end(); ++feature, ++feature_idx) {
     float* mat_row_1 = matrix->row(2 * feature_idx).data();
     float* mat_row_2 = matrix->row(2 * feature_idx + 1).data();
-    float* rhs_row_1 = rhs.row(2 * feature_idx).data();
-    float* rhs_row_2 = rhs.row(2 * feature_idx + 1).data();
+    float* rhs_row_1 = rhs->row(2 * feature_idx).data();
+    float* rhs_row_2 = rhs->row(2 * feature_idx + 1).data();
 
     Vector2_f pt = FeatureLocation(*feature);
     Vector2_f prev_pt = FeatureMatchLocation(*feature);
@@ -4236,8 +4219,9 @@ bool TransMixtureHomographyL2DLTSolve(
   }
 
   // TODO: Consider a faster function
-  *solution = matrix->colPivHouseholderQr().solve(rhs);
-  return ((*matrix) * (*solution)).isApprox(rhs, kPrecision);
+  qr->compute(*matrix);
+  *solution = qr->solve(*rhs);
+  return ((*matrix) * (*solution)).isApprox(*rhs, kPrecision);
 }
 
 // Constraint mixture homography model.
@@ -4248,8 +4232,12 @@ bool SkewRotMixtureHomographyL2DLTSolve(
     const RegionFlowFeatureList& feature_list, int num_models,
     const MixtureRowWeights& row_weights, float regularizer_lambda,
     Eigen::MatrixXf* matrix,  // least squares matrix
+    Eigen::VectorXf* rhs,     // least squares rhs
+    Eigen::ColPivHouseholderQR<Eigen::MatrixXf>* qr,
     Eigen::MatrixXf* solution) {
   CHECK(matrix);
+  CHECK(rhs);
+  CHECK(qr);
   CHECK(solution);
 
   // cv::solve can hang for really bad conditioned systems.
@@ -4268,9 +4256,8 @@ bool SkewRotMixtureHomographyL2DLTSolve(
   CHECK_EQ(solution->rows(), num_dof);
 
   // Compute homography from features. (H * location = prev_location)
-  *matrix = Eigen::MatrixXf::Zero(matrix->rows(), matrix->cols());
-  Eigen::Matrix<float, Eigen::Dynamic, 1> rhs =
-      Eigen::MatrixXf::Zero(matrix->rows(), 1);
+  matrix->setZero();
+  rhs->setZero(matrix->rows());
 
   // Create matrix for DLT.
   int feature_idx = 0;
@@ -4308,8 +4295,8 @@ bool SkewRotMixtureHomographyL2DLTSolve(
     (*matrix)(feature_row + 1, 3) = -pt_w.y() * prev_pt.x();
 
     // Weights sum to one (-> take out of loop).
-    rhs(feature_row, 0) = -prev_pt.y() * f_w;
-    rhs(feature_row + 1, 0) = prev_pt.x() * f_w;
+    (*rhs)(feature_row, 0) = -prev_pt.y() * f_w;
+    (*rhs)(feature_row + 1, 0) = prev_pt.x() * f_w;
 
     // Is this right?
     for (int m = 0; m < num_models; ++m) {
@@ -4338,8 +4325,9 @@ bool SkewRotMixtureHomographyL2DLTSolve(
   }
 
   // TODO: Consider a faster function?
-  *solution = matrix->colPivHouseholderQr().solve(rhs);
-  return ((*matrix) * (*solution)).isApprox(rhs, kPrecision);
+  qr->compute(*matrix);
+  *solution = qr->solve(*rhs);
+  return ((*matrix) * (*solution)).isApprox(*rhs, kPrecision);
 }
 
 }  // namespace.
@@ -4890,9 +4878,7 @@ bool MotionEstimation::EstimateHomographyIRLS(
 
   bool use_float = true;
   // Just declaring does not use memory
-  Eigen::Matrix<float, Eigen::Dynamic, 8> matrix_e;
   Eigen::Matrix<float, 8, 1> solution_e;
-  Eigen::Matrix<float, 8, 1> rhs_e;
   Eigen::Matrix<double, 8, 8> matrix_d;
   Eigen::Matrix<double, 8, 1> solution_d;
   Eigen::Matrix<double, 8, 1> rhs_d;
@@ -4904,8 +4890,8 @@ bool MotionEstimation::EstimateHomographyIRLS(
     const int num_rows =
         2 * feature_list->feature_size() +
         (options_.homography_perspective_regularizer() == 0 ? 0 : 1);
-    matrix_e = Eigen::Matrix<float, Eigen::Dynamic, 8>::Zero(num_rows, 8);
-    rhs_e = Eigen::Matrix<float, 8, 1>::Zero(8, 1);
+    thread_storage->GetSolverWorkspace()->homography_matrix.resize(num_rows,
+                                                                   8);
     solution_e = Eigen::Matrix<float, 8, 1>::Zero(8, 1);
   } else {
     if (options_.use_highest_accuracy_for_normal_equations()) {
@@ -4945,10 +4931,13 @@ bool MotionEstimation::EstimateHomographyIRLS(
     if (options_.use_exact_homography_estimation()) {
       bool success = false;
 
+      MotionEstimationThreadStorage::SolverWorkspace* workspace =
+          thread_storage->GetSolverWorkspace();
       success = HomographyL2QRSolve<float>(
           *feature_list, prev_solution,
-          options_.homography_perspective_regularizer(), &matrix_e,
-          &solution_e);
+          options_.homography_perspective_regularizer(),
+          &workspace->homography_matrix, &workspace->homography_rhs,
+          &workspace->homography_qr, &solution_e);
       if (!success) {
         VLOG(1) << "Could not solve for homography.";
         *camera_motion->mutable_homography() = Homography();
@@ -5075,6 +5064,7 @@ bool MotionEstimation::EstimateHomographyIRLS(
 bool MotionEstimation::MixtureHomographyFromFeature(
     const TranslationModel& camera_translation, int irls_rounds,
     float regularizer, const PriorFeatureWeights* prior_weights,
+    MotionEstimationThreadStorage* thread_storage,
     RegionFlowFeatureList* feature_list,
     MixtureHomography* mix_homography) const {
   if (prior_weights && !prior_weights->HasCorrectDimension(
@@ -5112,9 +5102,21 @@ bool MotionEstimation::MixtureHomographyFromFeature(
       LOG(FATAL) << "Unknown MixtureModelMode specified.";
   }
 
-  Eigen::MatrixXf matrix(
-      2 * feature_list->feature_size() + adjacency_constraints, num_dof);
-  Eigen::MatrixXf solution(num_dof, 1);
+  std::unique_ptr<MotionEstimationThreadStorage> local_storage;
+  if (thread_storage == nullptr) {
+    local_storage.reset(new MotionEstimationThreadStorage(options_, this));
+    thread_storage = local_storage.get();
+  }
+  MotionEstimationThreadStorage::SolverWorkspace* workspace =
+      thread_storage->GetSolverWorkspace();
+  Eigen::MatrixXf& matrix = workspace->mixture_matrix;
+  Eigen::MatrixXf& solution = workspace->mixture_solution;
+  matrix.resize(2 * feature_list->feature_size() + adjacency_constraints,
+                num_dof);
+  solution.resize(num_dof, 1);
+  // Unpacked solution to mixture homographies, if not full model.
+  std::vector<float>& solution_unpacked = workspace->mixture_solution_unpacked;
+  solution_unpacked.resize(8 * num_mixtures);
 
   // Multiple rounds of weighting based L2 optimization.
   MixtureHomography norm_model;
@@ -5135,15 +5137,14 @@ bool MotionEstimation::MixtureHomographyFromFeature(
   }
 
   for (int r = 0; r < irls_rounds; ++r) {
-    // Unpack solution to mixture homographies, if not full model.
-    std::vector<float> solution_unpacked(8 * num_mixtures);
     const float* solution_pointer = &solution_unpacked[0];
 
     switch (mixture_mode) {
       case MotionEstimationOptions::FULL_MIXTURE:
         if (!MixtureHomographyL2DLTSolve(*feature_list, num_mixtures,
                                          *row_weights_, regularizer, &matrix,
-                                         &solution)) {
+                                         &workspace->mixture_rhs,
+                                         &workspace->mixture_qr, &solution)) {
           return false;
         }
         // No need to unpack solution.
@@ -5153,7 +5154,9 @@ bool MotionEstimation::MixtureHomographyFromFeature(
       case MotionEstimationOptions::TRANSLATION_MIXTURE:
         if (!TransMixtureHomographyL2DLTSolve(*feature_list, num_mixtures,
                                               *row_weights_, regularizer,
-                                              &matrix, &solution)) {
+                                              &matrix, &workspace->mixture_rhs,
+                                              &workspace->mixture_qr,
+                                              &solution)) {
           return false;
         }
         {
@@ -5175,7 +5178,10 @@ bool MotionEstimation::MixtureHomographyFromFeature(
       case MotionEstimationOptions::SKEW_ROTATION_MIXTURE:
         if (!SkewRotMixtureHomographyL2DLTSolve(*feature_list, num_mixtures,
                                                 *row_weights_, regularizer,
-                                                &matrix, &solution)) {
+                                                &matrix,
+                                                &workspace->mixture_rhs,
+                                                &workspace->mixture_qr,
+                                                &solution)) {
           return false;
         }
         {
@@ -5307,8 +5313,8 @@ bool MotionEstimation::EstimateMixtureHomographyIRLS(
 
   MixtureHomography mix_homography;
   if (!MixtureHomographyFromFeature(camera_motion->translation(), irls_rounds,
-                                    regularizer, prior_weights, feature_list,
-                                    &mix_homography)) {
+                                    regularizer, prior_weights, thread_storage,
+                                    feature_list, &mix_homography)) {
     VLOG(1) << "Non-rigid homography estimated. "
             << "CameraMotion flagged as unstable.";
     camera_motion->set_flags(camera_motion->flags() |
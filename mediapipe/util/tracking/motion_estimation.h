@@ -563,7 +563,8 @@ class MotionEstimation {
   // from features and returns true if estimation was non-degenerate.
   bool MixtureHomographyFromFeature(
       const TranslationModel& translation, int irls_rounds, float regularizer,
-      const PriorFeatureWeights* prior_weights,  // optional.
+      const PriorFeatureWeights* prior_weights,      // optional.
+      MotionEstimationThreadStorage* thread_storage,  // optional.
       RegionFlowFeatureList* feature_list,
       MixtureHomography* mix_homography) const;
 
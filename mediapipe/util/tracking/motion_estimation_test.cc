@@ -0,0 +1,278 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/motion_estimation.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/tracking/camera_motion.pb.h"
+#include "mediapipe/util/tracking/motion_estimation.pb.h"
+#include "mediapipe/util/tracking/motion_models.h"
+#include "mediapipe/util/tracking/motion_models.pb.h"
+#include "mediapipe/util/tracking/region_flow.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kFrameWidth = 640;
+constexpr int kFrameHeight = 360;
+
+// Number of features per frame. They differ, so that the solver workspaces are
+// resized between frames.
+constexpr int kNumFeatures[] = {200, 120, 300, 150};
+constexpr int kNumFrames = sizeof(kNumFeatures) / sizeof(kNumFeatures[0]);
+
+// Returns a homography close to identity for "frame", as between consecutive
+// frames of a camera in motion.
+Homography FrameHomography(int frame) {
+  return HomographyAdapter::FromArgs(
+      1.01f + 0.005f * frame, 0.02f, 4.0f + frame,  //
+      -0.015f, 0.99f, -3.0f + 0.5f * frame,         //
+      2e-5f, -1e-5f * frame);
+}
+
+// Returns features randomly placed on the frame and matched through
+// "homography" up to noise. Every fifth feature is an outlier with an
+// unrelated match.
+RegionFlowFeatureList MakeFeatures(int num_features,
+                                   const Homography& homography,
+                                   std::mt19937* rng) {
+  std::uniform_real_distribution<float> x_dist(0.0f, kFrameWidth);
+  std::uniform_real_distribution<float> y_dist(0.0f, kFrameHeight);
+  std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+  std::uniform_real_distribution<float> outlier(-40.0f, 40.0f);
+  RegionFlowFeatureList features;
+  features.set_frame_width(kFrameWidth);
+  features.set_frame_height(kFrameHeight);
+  for (int i = 0; i < num_features; ++i) {
+    const Vector2_f location(x_dist(*rng), y_dist(*rng));
+    Vector2_f match = HomographyAdapter::TransformPoint(homography, location);
+    if (i % 5 == 0) {
+      match += Vector2_f(outlier(*rng), outlier(*rng));
+    } else {
+      match += Vector2_f(noise(*rng), noise(*rng));
+    }
+    RegionFlowFeature* feature = features.add_feature();
+    feature->set_x(location.x());
+    feature->set_y(location.y());
+    feature->set_dx(match.x() - location.x());
+    feature->set_dy(match.y() - location.y());
+    feature->set_track_id(i);
+    // Textured patch, described by color means and covariances.
+    for (int d = 0; d < 9; ++d) {
+      feature->mutable_feature_descriptor()->add_data(d < 3 ? 128.0f : 400.0f);
+    }
+  }
+  return features;
+}
+
+std::vector<RegionFlowFeatureList> MakeClip() {
+  std::mt19937 rng(/*seed=*/5);
+  std::vector<RegionFlowFeatureList> clip;
+  for (int f = 0; f < kNumFrames; ++f) {
+    clip.push_back(MakeFeatures(kNumFeatures[f], FrameHomography(f), &rng));
+  }
+  return clip;
+}
+
+// Estimates the motions of "clip" in one call, which reuses the thread
+// storage and its solver workspaces across frames.
+std::vector<CameraMotion> EstimateClip(
+    const MotionEstimationOptions& options,
+    std::vector<RegionFlowFeatureList>* clip) {
+  MotionEstimation motion_estimation(options, kFrameWidth, kFrameHeight);
+  std::vector<RegionFlowFeatureList*> feature_lists;
+  for (auto& features : *clip) {
+    feature_lists.push_back(&features);
+  }
+  std::vector<CameraMotion> camera_motions;
+  motion_estimation.EstimateMotionsParallel(
+      /*post_irls_weight_smoothing=*/false, &feature_lists, &camera_motions);
+  return camera_motions;
+}
+
+MotionEstimationOptions HomographyOptions(bool exact, bool highest_accuracy) {
+  MotionEstimationOptions options;
+  options.set_homography_estimation(
+      MotionEstimationOptions::ESTIMATION_HOMOG_IRLS);
+  options.set_use_exact_homography_estimation(exact);
+  options.set_use_highest_accuracy_for_normal_equations(highest_accuracy);
+  return options;
+}
+
+// Number of leading features whose irls weights are compared.
+constexpr int kNumComparedWeights = 10;
+
+struct ExpectedFrame {
+  float homography[8];
+  float irls_weights[kNumComparedWeights];
+};
+
+// Homographies and irls weights of MakeClip() as estimated with the solvers
+// allocating their systems in each IRLS round and accumulating the normal
+// equations entry by entry, before the solver workspaces were reused.
+
+// Through QR decomposition of the full system.
+constexpr ExpectedFrame kExpectedExactQr[kNumFrames] = {
+    {{1.0107764f, 0.019353282f, 3.9752166f,  //
+      -0.014774663f, 0.99023461f, -3.1030436f,  //
+      2.0986839e-05f, -1.1844277e-06f},
+     {0.033840563f, 2.1956789f, 9.8952417f, 56.098461f, 3.3481479f,  //
+      0.042417675f, 3.2647743f, 3.9595935f, 2.9140501f, 13.341903f}},
+    {{1.0131021f, 0.020175116f, 5.3857222f,  //
+      -0.015274666f, 0.99104393f, -2.5101962f,  //
+      1.6680149e-05f, -5.9848512e-06f},
+     {0.03990702f, 3.9628165f, 1.8477385f, 2.8213909f, 6.2522287f,  //
+      0.046994999f, 2.9953752f, 3.0270343f, 7.2413297f, 3.1872656f}},
+    {{1.0210221f, 0.019527059f, 5.957727f,  //
+      -0.014715211f, 0.99103373f, -2.1984653f,  //
+      2.1874286e-05f, -2.1676127e-05f},
+     {0.03597004f, 4.2991786f, 2.430742f, 9.8657532f, 3.4371734f,  //
+      0.04676247f, 3.6633396f, 9124.2314f, 12.472022f, 7.1505613f}},
+    {{1.0247405f, 0.021865008f, 6.9242253f,  //
+      -0.015365668f, 0.99249399f, -1.6718071f,  //
+      1.7974984e-05f, -2.3582592e-05f},
+     {0.15471904f, 2.847229f, 15.880519f, 4.5885906f, 9.2425423f,  //
+      0.10683505f, 8.5066395f, 4.2511363f, 6.0767822f, 2.6877089f}},
+};
+
+// Through normal equations in double precision.
+constexpr ExpectedFrame kExpectedNormalEquationsDouble[kNumFrames] = {
+    {{1.0104779f, 0.019223548f, 4.0122185f,  //
+      -0.01479872f, 0.98994797f, -3.097966f,  //
+      2.062479e-05f, -2.0834746e-06f},
+     {0.033843841f, 2.1513348f, 8.7684746f, 36.182087f, 3.6294532f,  //
+      0.042392433f, 3.3652182f, 3.8708968f, 3.0022979f, 11.710522f}},
+    {{1.014308f, 0.020969996f, 5.057426f,  //
+      -0.0153129f, 0.9909237f, -2.469192f,  //
+      1.7767523e-05f, -5.1356024e-06f},
+     {0.039858151f, 3.2714236f, 2.9071922f, 3.4066827f, 3.6015196f,  //
+      0.047435489f, 3.3664606f, 3.0456238f, 3.9159532f, 3.621063f}},
+    {{1.0203365f, 0.019574691f, 6.0138559f,  //
+      -0.014663614f, 0.98997939f, -2.0945828f,  //
+      2.0952511e-05f, -2.1706435e-05f},
+     {0.036059394f, 3.6710351f, 2.8502538f, 8.6173277f, 3.3411121f,  //
+      0.046772256f, 3.3116059f, 19.171705f, 18.127968f, 6.8118401f}},
+    {{1.0227182f, 0.01983319f, 7.2462664f,  //
+      -0.015480842f, 0.98847598f, -1.2386982f,  //
+      1.6743947e-05f, -3.1244424e-05f},
+     {0.15541801f, 3.4647732f, 9.5533714f, 4.6745391f, 27.260578f,  //
+      0.10704084f, 5.2322612f, 4.4820013f, 5.3383727f, 6.2891822f}},
+};
+
+// Through normal equations in float precision.
+constexpr ExpectedFrame kExpectedNormalEquationsFloat[kNumFrames] = {
+    {{1.0105017f, 0.019232366f, 4.0092902f,  //
+      -0.014795395f, 0.98996055f, -3.0986979f,  //
+      2.0653937e-05f, -2.0531274e-06f},
+     {0.033843059f, 2.1547282f, 8.8007832f, 35.76321f, 3.6197512f,  //
+      0.042394958f, 3.3663423f, 3.8689978f, 2.9990349f, 11.580463f}},
+    {{1.0143069f, 0.020956323f, 5.0594063f,  //
+      -0.015312815f, 0.99091321f, -2.4684031f,  //
+      1.777133e-05f, -5.1610841e-06f},
+     {0.039857958f, 3.2705152f, 2.9112575f, 3.406215f, 3.6125553f,  //
+      0.047436748f, 3.3701794f, 3.0474083f, 3.9069352f, 3.6171455f}},
+    {{1.020329f, 0.019580904f, 6.0149999f,  //
+      -0.014664368f, 0.98998606f, -2.0951631f,  //
+      2.0936028e-05f, -2.1669237e-05f},
+     {0.036058936f, 3.6687906f, 2.8599937f, 8.6681967f, 3.3568208f,  //
+      0.046774019f, 3.3114915f, 19.108454f, 17.839766f, 6.7955661f}},
+    {{1.022707f, 0.019835411f, 7.2471447f,  //
+      -0.01548532f, 0.98847055f, -1.2373872f,  //
+      1.6726006e-05f, -3.1245148e-05f},
+     {0.15540345f, 3.4626472f, 9.5822086f, 4.6789536f, 27.104563f,  //
+      0.10704169f, 5.2326436f, 4.4857798f, 5.3355832f, 6.291079f}},
+};
+
+// Compares with a tolerance relative to the magnitude of the expected value.
+void ExpectRelativeNear(float expected, float actual) {
+  constexpr float kTolerance = 1e-3f;
+  EXPECT_NEAR(expected, actual, kTolerance * std::abs(expected));
+}
+
+void ExpectFramesNear(const ExpectedFrame (&expected)[kNumFrames],
+                      const std::vector<RegionFlowFeatureList>& clip,
+                      const std::vector<CameraMotion>& camera_motions) {
+  ASSERT_EQ(camera_motions.size(), kNumFrames);
+  for (int f = 0; f < kNumFrames; ++f) {
+    SCOPED_TRACE(testing::Message() << "frame " << f);
+    const Homography& homography = camera_motions[f].homography();
+    for (int i = 0; i < 8; ++i) {
+      SCOPED_TRACE(testing::Message() << "parameter " << i);
+      ExpectRelativeNear(expected[f].homography[i],
+                         HomographyAdapter::GetParameter(homography, i));
+    }
+    for (int i = 0; i < kNumComparedWeights; ++i) {
+      SCOPED_TRACE(testing::Message() << "feature " << i);
+      ExpectRelativeNear(expected[f].irls_weights[i],
+                         clip[f].feature(i).irls_weight());
+    }
+  }
+}
+
+TEST(MotionEstimationTest, ExactHomographyMatchesPerRoundAllocation) {
+  std::vector<RegionFlowFeatureList> clip = MakeClip();
+  const std::vector<CameraMotion> camera_motions = EstimateClip(
+      HomographyOptions(/*exact=*/true, /*highest_accuracy=*/false), &clip);
+  ExpectFramesNear(kExpectedExactQr, clip, camera_motions);
+}
+
+TEST(MotionEstimationTest, NormalEquationsMatchEntrywiseAccumulation) {
+  std::vector<RegionFlowFeatureList> clip = MakeClip();
+  std::vector<CameraMotion> camera_motions = EstimateClip(
+      HomographyOptions(/*exact=*/false, /*highest_accuracy=*/true), &clip);
+  ExpectFramesNear(kExpectedNormalEquationsDouble, clip, camera_motions);
+
+  clip = MakeClip();
+  camera_motions = EstimateClip(
+      HomographyOptions(/*exact=*/false, /*highest_accuracy=*/false), &clip);
+  ExpectFramesNear(kExpectedNormalEquationsFloat, clip, camera_motions);
+}
+
+// Estimating a clip at once reuses the solver workspaces of the previous
+// frames, which must not change the result of any frame.
+TEST(MotionEstimationTest, ReusedWorkspacesMatchFreshOnes) {
+  MotionEstimationOptions options =
+      HomographyOptions(/*exact=*/true, /*highest_accuracy=*/false);
+  options.set_mix_homography_estimation(
+      MotionEstimationOptions::ESTIMATION_HOMOG_MIX_IRLS);
+  std::vector<RegionFlowFeatureList> clip = MakeClip();
+  const std::vector<CameraMotion> camera_motions = EstimateClip(options, &clip);
+  ASSERT_EQ(camera_motions.size(), kNumFrames);
+
+  const std::vector<RegionFlowFeatureList> original_clip = MakeClip();
+  for (int f = 0; f < kNumFrames; ++f) {
+    SCOPED_TRACE(testing::Message() << "frame " << f);
+    std::vector<RegionFlowFeatureList> frame = {original_clip[f]};
+    const std::vector<CameraMotion> frame_motions =
+        EstimateClip(options, &frame);
+    ASSERT_EQ(frame_motions.size(), 1);
+    EXPECT_GT(camera_motions[f].mixture_homography().model_size(), 0);
+    EXPECT_EQ(frame_motions[0].homography().SerializeAsString(),
+              camera_motions[f].homography().SerializeAsString());
+    EXPECT_EQ(frame_motions[0].mixture_homography().SerializeAsString(),
+              camera_motions[f].mixture_homography().SerializeAsString());
+    ASSERT_EQ(frame[0].feature_size(), clip[f].feature_size());
+    for (int i = 0; i < clip[f].feature_size(); ++i) {
+      EXPECT_EQ(frame[0].feature(i).irls_weight(),
+                clip[f].feature(i).irls_weight());
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
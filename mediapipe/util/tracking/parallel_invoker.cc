@@ -14,6 +14,14 @@
 
 #include "mediapipe/util/tracking/parallel_invoker.h"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/executor.h"
+
 // Choose between ThreadPool, OpenMP and serial execution.
 // Note only one parallel_using_* directive can be active.
 int flags_parallel_invoker_mode = PARALLEL_INVOKER_MAX_VALUE;
@@ -21,6 +29,16 @@ int flags_parallel_invoker_max_threads = 4;
 
 namespace mediapipe {
 
+namespace {
+
+std::atomic<Executor*> parallel_invoker_executor{nullptr};
+
+}  // namespace
+
+void SetParallelInvokerExecutor(Executor* executor) {
+  parallel_invoker_executor.store(executor);
+}
+
 #if defined(PARALLEL_INVOKER_ACTIVE)
 ThreadPool* ParallelInvokerThreadPool() {
   static ThreadPool* pool = []() -> ThreadPool* {
@@ -31,6 +49,58 @@ ThreadPool* ParallelInvokerThreadPool() {
   }();
   return pool;
 }
+
+void ParallelInvokerRun(int num_tasks, const std::function<void(int)>& task) {
+  // Shared with the scheduled workers, which may only start running after the
+  // loop completed.
+  struct Loop {
+    std::atomic<int> next_task{0};
+    int num_tasks = 0;
+    const std::function<void(int)>* task = nullptr;
+    absl::Mutex mutex;
+    absl::CondVar completed;
+    int tasks_remain ABSL_GUARDED_BY(mutex) = 0;
+  };
+  auto loop = std::make_shared<Loop>();
+  loop->num_tasks = num_tasks;
+  loop->task = &task;
+  {
+    absl::MutexLock lock(&loop->mutex);
+    loop->tasks_remain = num_tasks;
+  }
+
+  // Claims and runs tasks until none are left. `task` is only accessed for
+  // claimed tasks, i.e. before the loop completes.
+  auto worker = [loop]() {
+    for (int i = loop->next_task++; i < loop->num_tasks;
+         i = loop->next_task++) {
+      (*loop->task)(i);
+      absl::MutexLock lock(&loop->mutex);
+      if (--loop->tasks_remain == 0) {
+        loop->completed.SignalAll();
+      }
+    }
+  };
+
+  // The calling thread is one of the workers.
+  const int num_workers =
+      std::min(num_tasks, std::max(1, flags_parallel_invoker_max_threads));
+  Executor* executor = parallel_invoker_executor.load();
+  for (int w = 1; w < num_workers; ++w) {
+    if (executor != nullptr) {
+      executor->Schedule(worker);
+    } else {
+      ParallelInvokerThreadPool()->Schedule(worker);
+    }
+  }
+  worker();
+
+  // Wait on termination of the tasks claimed by other workers.
+  absl::MutexLock lock(&loop->mutex);
+  while (loop->tasks_remain > 0) {
+    loop->completed.Wait(&loop->mutex);
+  }
+}
 #endif
 
 }  // namespace mediapipe
@@ -69,9 +69,9 @@
 
 #include <stddef.h>
 
+#include <functional>
 #include <memory>
 
-#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/logging.h"
 
 #ifdef PARALLEL_INVOKER_ACTIVE
@@ -101,6 +101,15 @@ extern int flags_parallel_invoker_max_threads;
 
 namespace mediapipe {
 
+class Executor;
+
+// Sets the executor that runs ParallelFor and ParallelFor2D iterations in
+// PARALLEL_INVOKER_THREAD_POOL mode, e.g. the executor of the calculator graph
+// so that parallel loops and calculators share the same threads. The executor
+// must outlive all parallel loops using it. Passing nullptr restores the
+// default ThreadPool of flags_parallel_invoker_max_threads threads.
+void SetParallelInvokerExecutor(Executor* executor);
+
 // Partitions the range [begin, end) into equal blocks of size grain_size each
 // (except last one, might be less than grain_size).
 class BlockedRange {
@@ -140,6 +149,13 @@ class BlockedRange2D {
 // Singleton ThreadPool for parallel invoker.
 ThreadPool* ParallelInvokerThreadPool();
 
+// Runs task(i) for all i in [0, num_tasks) on the executor set by
+// SetParallelInvokerExecutor, or the singleton ThreadPool, and returns when all
+// of them completed. The calling thread runs tasks as well, so the loop
+// completes even if no thread of the executor is available, as happens for
+// nested loops or an executor that is busy running calculators.
+void ParallelInvokerRun(int num_tasks, const std::function<void(int)>& task);
+
 #ifdef __APPLE__
 // Enable to allow GCD as an option beside ThreadPool.
 #define USE_PARALLEL_INVOKER_GCD 1
@@ -329,42 +345,13 @@ void ParallelFor(size_t start, size_t end, size_t grain_size,
         break;
       }
 
-      struct {
-        absl::Mutex mutex;
-        absl::CondVar completed;
-        int iterations_remain ABSL_GUARDED_BY(mutex);
-      } loop;
-      {
-        absl::MutexLock lock(&loop.mutex);
-        loop.iterations_remain = iterations_remain;
-      }
-
-      for (int x = start; x < end; x += grain_size) {
-        auto loop_func = [x, end, grain_size, &loop, invoker]() {
-          // Execute invoker.
-          invoker(BlockedRange(x, std::min(end, x + grain_size), 1));
-
-          // Decrement counter.
-          absl::MutexLock lock(&loop.mutex);
-          --loop.iterations_remain;
-          if (loop.iterations_remain == 0) {
-            loop.completed.SignalAll();
-          }
-        };
-
-        // Attempt to run in parallel, if busy run serial to avoid deadlocking.
-        // This can happen during nested invocation of ParallelFor, as if the
-        // loop iteration itself is calling ParallelFor we might deadlock if
-        // we can not guarantee for the iteration to be scheduled.
-        ParallelInvokerThreadPool()->Schedule(loop_func);
-      }
-
-      // Wait on termination of all iterations.
-      loop.mutex.Lock();
-      while (loop.iterations_remain > 0) {
-        loop.completed.Wait(&loop.mutex);
-      }
-      loop.mutex.Unlock();
+      ParallelInvokerRun(
+          iterations_remain, [start, end, grain_size, &invoker](int i) {
+            const size_t x = start + i * grain_size;
+            // Each iteration runs on its own copy of invoker.
+            Invoker local_invoker(invoker);
+            local_invoker(BlockedRange(x, std::min(end, x + grain_size), 1));
+          });
       break;
     }
 
@@ -435,7 +422,7 @@ void ParallelFor2D(size_t start_row, size_t end_row, size_t start_col,
 #endif  // __APPLE__
 
     case PARALLEL_INVOKER_THREAD_POOL: {
-      int iterations_remain = end_row - start_row;  // Guarded by loop_mutex
+      const int iterations_remain = end_row - start_row;
       CHECK_GT(iterations_remain, 0);
       if (iterations_remain == 1) {
         // Execute invoker serially.
@@ -444,34 +431,14 @@ void ParallelFor2D(size_t start_row, size_t end_row, size_t start_col,
         break;
       }
 
-      absl::Mutex loop_mutex;
-      absl::CondVar loop_completed;
-
-      for (int y = start_row; y < end_row; ++y) {
-        auto loop_func = [y, start_col, end_col, &loop_mutex, &loop_completed,
-                          &iterations_remain, invoker]() {
-          // Execute invoker.
-          invoker(BlockedRange2D(BlockedRange(y, y + 1, 1),
-                                 BlockedRange(start_col, end_col, 1)));
-
-          // Decrement counter.
-          absl::MutexLock lock(&loop_mutex);
-          --iterations_remain;
-          if (iterations_remain == 0) {
-            loop_completed.Signal();
-          }
-        };
-
-        // Attempt to run in parallel, if busy run serial to avoid deadlocking.
-        ParallelInvokerThreadPool()->Schedule(loop_func);
-      }
-
-      // Wait on termination of all iterations.
-      loop_mutex.Lock();
-      while (iterations_remain > 0) {
-        loop_completed.Wait(&loop_mutex);
-      }
-      loop_mutex.Unlock();
+      ParallelInvokerRun(
+          iterations_remain, [start_row, start_col, end_col, &invoker](int i) {
+            const int y = start_row + i;
+            // Each iteration runs on its own copy of invoker.
+            Invoker local_invoker(invoker);
+            local_invoker(BlockedRange2D(BlockedRange(y, y + 1, 1),
+                                         BlockedRange(start_col, end_col, 1)));
+          });
       break;
     }
 
@@ -15,9 +15,12 @@
 #include "mediapipe/util/tracking/parallel_invoker.h"
 
 #include <algorithm>
+#include <functional>
 #include <numeric>
+#include <vector>
 
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/gtest.h"
 
 namespace mediapipe {
@@ -56,5 +59,36 @@ TEST(ParallelInvokerTest, ThreadPoolTest) {
   RunParallelTest();
 }
 
+// Executor that only queues its tasks, as an executor whose threads are all
+// busy would.
+class QueueingExecutor : public Executor {
+ public:
+  void Schedule(std::function<void()> task) override {
+    tasks_.push_back(std::move(task));
+  }
+
+  void RunQueuedTasks() {
+    for (auto& task : tasks_) {
+      task();
+    }
+    tasks_.clear();
+  }
+
+ private:
+  std::vector<std::function<void()>> tasks_;
+};
+
+TEST(ParallelInvokerTest, CompletesWithBusyExecutor) {
+  flags_parallel_invoker_mode = PARALLEL_INVOKER_THREAD_POOL;
+  QueueingExecutor executor;
+  SetParallelInvokerExecutor(&executor);
+
+  RunParallelTest();
+  // Tasks that start after the loop completed find no work left.
+  executor.RunQueuedTasks();
+
+  SetParallelInvokerExecutor(nullptr);
+}
+
 }  // namespace
 }  // namespace mediapipe
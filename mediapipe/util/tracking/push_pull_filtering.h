@@ -35,12 +35,16 @@
 
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/util/tracking/image_util.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 #include "mediapipe/util/tracking/push_pull_filtering.pb.h"
 
 namespace mediapipe {
 
 const float kBilateralEps = 1e-6f;
 
+// Rows of a mip map level are filtered in parallel in bands of this many rows.
+const int kPushPullBandRows = 16;
+
 // Push Pull algorithm can be decorated with mip-map visualizers,
 // per-level weight adjusters and per-filter element weight multipliers.
 // Implemented by default as no-ops below.
@@ -98,6 +102,8 @@ class PushPullMipMapVisualizer {
 // // Function is called once for every neighbor (filter_ptr) of a pixel
 // // (anchor_ptr). Location (x,y) of the pixel pointed to by anchor pointer is
 // // also passed if needed for more complex operations.
+// // Rows of a level are filtered in parallel, so the function may be called
+// // concurrently and must be thread-safe.
 // float WeightMultiplier(const float* anchor_ptr,    // Points to anchor.
 //                        const float* filter_ptr,    // Offset element.
 //                        const uint_8t* img_ptr,     // NULL if not bilateral.
@@ -987,86 +993,94 @@ void PushPullFiltering<C, FilterWeightMultiplier>::PullDownSampling(
     const float bilateral_scale =
         std::pow(options_.pull_bilateral_scale(), l - 1);
 
-    // Filter odd pixels (downsample).
-    for (int i = 0; i < height; ++i) {
-      float* dst_ptr = mip_map[l]->ptr<float>(i + border) + border * channels;
-      const float* src_ptr =
-          mip_map[l - 1]->ptr<float>(2 * i + border) + border * channels;
-      const uint8* img_ptr =
-          use_bilateral_ ? (input_frame_pyramid_[l - 1].template ptr<uint8>(
-                                2 * i + border) +
-                            border * 3)
-                         : NULL;
-
-      for (int j = 0; j < width; ++j, dst_ptr += channels,
-               src_ptr += 2 * channels, img_ptr += 2 * 3) {
-        float weight_sum = 0;
-        float val_sum[C];
-        memset(val_sum, 0, C * sizeof(val_sum[0]));
-
-        const int i2 = i * 2;
-        const int j2 = j * 2;
-        if (use_bilateral_) {
-          for (int k = 0; k < num_filter_elems; ++k) {
-            const float* cur_ptr = PtrOffset(src_ptr, filter_offsets[k]);
-
-            // If neighbor is not important, skip further evaluation.
-            if (cur_ptr[C] < kBilateralEps * kBilateralEps) {
-              continue;
+    const float prop_scale = options_.pull_propagation_scale();
+
+    // Filter odd pixels (downsample). Each row only reads from the previous
+    // level, so bands of rows are filtered in parallel.
+    const int num_bands = (height + kPushPullBandRows - 1) / kPushPullBandRows;
+    ParallelFor(0, num_bands, 1, [&](const BlockedRange& range) {
+      for (int i = range.begin() * kPushPullBandRows,
+               end = std::min(height, range.end() * kPushPullBandRows);
+           i < end; ++i) {
+        float* dst_ptr = mip_map[l]->ptr<float>(i + border) + border * channels;
+        const float* src_ptr =
+            mip_map[l - 1]->ptr<float>(2 * i + border) + border * channels;
+        const uint8* img_ptr =
+            use_bilateral_ ? (input_frame_pyramid_[l - 1].template ptr<uint8>(
+                                  2 * i + border) +
+                              border * 3)
+                           : NULL;
+
+        for (int j = 0; j < width; ++j, dst_ptr += channels,
+                 src_ptr += 2 * channels, img_ptr += 2 * 3) {
+          float weight_sum = 0;
+          float val_sum[C];
+          memset(val_sum, 0, C * sizeof(val_sum[0]));
+
+          const int i2 = i * 2;
+          const int j2 = j * 2;
+          if (use_bilateral_) {
+            for (int k = 0; k < num_filter_elems; ++k) {
+              const float* cur_ptr = PtrOffset(src_ptr, filter_offsets[k]);
+
+              // If neighbor is not important, skip further evaluation.
+              if (cur_ptr[C] < kBilateralEps * kBilateralEps) {
+                continue;
+              }
+
+              const uint8* match_ptr = PtrOffset(img_ptr, (*space_offsets)[k]);
+
+              float bilateral_w =
+                  bilateral_lut_[ColorDiffL1(img_ptr, match_ptr) *
+                                 bilateral_scale];
+
+              const float multiplier = weight_multiplier_->GetWeight(
+                  src_ptr, cur_ptr, img_ptr, j2, i2);
+
+              const float w = filter_weights[k] * bilateral_w * multiplier;
+
+              // cur_ptr is already pre-multiplied with importance
+              // weight cur_ptr[C].
+              for (int c = 0; c < C; ++c) {
+                val_sum[c] += cur_ptr[c] * w;
+              }
+              weight_sum += w * cur_ptr[C];
             }
+          } else {
+            for (int k = 0; k < num_filter_elems; ++k) {
+              const float* cur_ptr = PtrOffset(src_ptr, filter_offsets[k]);
+              const float multiplier =
+                  weight_multiplier_->GetWeight(src_ptr, cur_ptr, NULL, j2, i2);
+              const float w = filter_weights[k] * multiplier;
+
+              // cur_ptr is already pre-multiplied with importance
+              // weight cur_ptr[C].
+              for (int c = 0; c < C; ++c) {
+                val_sum[c] += cur_ptr[c] * w;
+              }
+
+              weight_sum += w * cur_ptr[C];
+            }
+          }
 
-            const uint8* match_ptr = PtrOffset(img_ptr, (*space_offsets)[k]);
-
-            float bilateral_w = bilateral_lut_[ColorDiffL1(img_ptr, match_ptr) *
-                                               bilateral_scale];
-
-            const float multiplier = weight_multiplier_->GetWeight(
-                src_ptr, cur_ptr, img_ptr, j2, i2);
-
-            const float w = filter_weights[k] * bilateral_w * multiplier;
+          DCHECK_GE(weight_sum, 0);
 
-            // cur_ptr is already pre-multiplied with importance
-            // weight cur_ptr[C].
+          if (weight_sum >= kBilateralEps * kBilateralEps) {
+            const float inv_weight_sum = 1.f / weight_sum;
             for (int c = 0; c < C; ++c) {
-              val_sum[c] += cur_ptr[c] * w;
+              dst_ptr[c] = val_sum[c] * inv_weight_sum;
             }
-            weight_sum += w * cur_ptr[C];
-          }
-        } else {
-          for (int k = 0; k < num_filter_elems; ++k) {
-            const float* cur_ptr = PtrOffset(src_ptr, filter_offsets[k]);
-            const float multiplier =
-                weight_multiplier_->GetWeight(src_ptr, cur_ptr, NULL, j2, i2);
-            const float w = filter_weights[k] * multiplier;
-
-            // cur_ptr is already pre-multiplied with importance
-            // weight cur_ptr[C].
-            for (int c = 0; c < C; ++c) {
-              val_sum[c] += cur_ptr[c] * w;
+          } else {
+            for (int c = 0; c <= C; ++c) {
+              dst_ptr[c] = 0;
             }
-
-            weight_sum += w * cur_ptr[C];
           }
-        }
 
-        DCHECK_GE(weight_sum, 0);
-
-        if (weight_sum >= kBilateralEps * kBilateralEps) {
-          const float inv_weight_sum = 1.f / weight_sum;
-          for (int c = 0; c < C; ++c) {
-            dst_ptr[c] = val_sum[c] * inv_weight_sum;
-          }
-        } else {
-          for (int c = 0; c <= C; ++c) {
-            dst_ptr[c] = 0;
-          }
+          weight_sum *= prop_scale;
+          dst_ptr[C] = std::min<float>(1.0f, weight_sum);
         }
-
-        const float prop_scale = options_.pull_propagation_scale();
-        weight_sum *= prop_scale;
-        dst_ptr[C] = std::min<float>(1.0f, weight_sum);
       }
-    }
+    });
 
     if (weight_adjuster_) {
       CopyNecessaryBorder<float, C + 1>(mip_map[l]);
@@ -1142,118 +1156,126 @@ void PushPullFiltering<C, FilterWeightMultiplier>::PushUpSampling(
     const float bilateral_scale =
         std::pow(options_.push_bilateral_scale(), l + 1);
 
-    // Apply filter.
-    // List of zero positions that need to be smoothed.
-    std::vector<float*> zero_pos;
-
-    for (int i = 0; i < height; ++i) {
-      float* dst_ptr = mip_map[l]->ptr<float>(i + border) + border * channels;
-      const float* src_ptr =
-          mip_map[l + 1]->ptr<float>(i / 2 + border) + border * channels;
-      const uint8* img_ptr =
-          use_bilateral_
-              ? (input_frame_pyramid_[l].template ptr<uint8>(i + border) +
-                 border * 3)
-              : NULL;
-
-      // Select tap offset.
-      const int tap_kind_row = 2 * (i % 2);  // odd row, case 2 & 3.
-
-      for (int j = 0; j < width;
-           // Increase src_ptr only for even rows (i.e. previous one was odd).
-           src_ptr += channels * (j % 2),
-               ++j, dst_ptr += channels, img_ptr += 3) {
-        if (dst_ptr[C] >= 1) {  // Skip if already saturated.
-          continue;
-        }
-
-        const int tap_kind = tap_kind_row + j % 2;
-        const std::vector<float>& tap_weight = tap_weights[tap_kind];
-        const std::vector<int>& tap_offset = tap_offsets[tap_kind];
-        const int tap_size = tap_weight.size();
-
-        float weight_sum = 0;
-        float val_sum[C];
-        memset(val_sum, 0, C * sizeof(val_sum[0]));
-
-        if (use_bilateral_) {
-          const std::vector<int>& tap_space_offset =
-              tap_space_offsets[tap_kind];
-          for (int k = 0; k < tap_size; ++k) {
-            const float* cur_ptr = PtrOffset(src_ptr, tap_offset[k]);
+    const float prop_scale = options_.push_propagation_scale();
+
+    // Apply filter. Each row only reads from the coarser level and itself, so
+    // bands of rows are filtered in parallel.
+    // List of zero positions that need to be smoothed, per band.
+    const int num_bands = (height + kPushPullBandRows - 1) / kPushPullBandRows;
+    std::vector<std::vector<float*>> band_zero_pos(num_bands);
+    ParallelFor(0, num_bands, 1, [&](const BlockedRange& range) {
+      for (int i = range.begin() * kPushPullBandRows,
+               end = std::min(height, range.end() * kPushPullBandRows);
+           i < end; ++i) {
+        std::vector<float*>& zero_pos = band_zero_pos[i / kPushPullBandRows];
+        float* dst_ptr = mip_map[l]->ptr<float>(i + border) + border * channels;
+        const float* src_ptr =
+            mip_map[l + 1]->ptr<float>(i / 2 + border) + border * channels;
+        const uint8* img_ptr =
+            use_bilateral_
+                ? (input_frame_pyramid_[l].template ptr<uint8>(i + border) +
+                   border * 3)
+                : NULL;
+
+        // Select tap offset.
+        const int tap_kind_row = 2 * (i % 2);  // odd row, case 2 & 3.
+
+        for (int j = 0; j < width;
+             // Increase src_ptr only for even rows (i.e. previous one was odd).
+             src_ptr += channels * (j % 2),
+                 ++j, dst_ptr += channels, img_ptr += 3) {
+          if (dst_ptr[C] >= 1) {  // Skip if already saturated.
+            continue;
+          }
 
-            // If neighbor is not important, skip further evaluation.
-            if (cur_ptr[C] < kBilateralEps * kBilateralEps) {
-              continue;
+          const int tap_kind = tap_kind_row + j % 2;
+          const std::vector<float>& tap_weight = tap_weights[tap_kind];
+          const std::vector<int>& tap_offset = tap_offsets[tap_kind];
+          const int tap_size = tap_weight.size();
+
+          float weight_sum = 0;
+          float val_sum[C];
+          memset(val_sum, 0, C * sizeof(val_sum[0]));
+
+          if (use_bilateral_) {
+            const std::vector<int>& tap_space_offset =
+                tap_space_offsets[tap_kind];
+            for (int k = 0; k < tap_size; ++k) {
+              const float* cur_ptr = PtrOffset(src_ptr, tap_offset[k]);
+
+              // If neighbor is not important, skip further evaluation.
+              if (cur_ptr[C] < kBilateralEps * kBilateralEps) {
+                continue;
+              }
+
+              const uint8* match_ptr = PtrOffset(img_ptr, tap_space_offset[k]);
+              float bilateral_w =
+                  bilateral_lut_[ColorDiffL1(img_ptr, match_ptr) *
+                                 bilateral_scale];
+
+              const float multiplier = weight_multiplier_->GetWeight(
+                  src_ptr, cur_ptr, img_ptr, j, i);
+
+              const float w = tap_weight[k] * bilateral_w * multiplier;
+
+              // Values in above mip map level are pre-multiplied by
+              // importance weight cur_ptr[C].
+              for (int c = 0; c < C; ++c) {
+                val_sum[c] += cur_ptr[c] * w;
+              }
+              weight_sum += w * cur_ptr[C];
             }
+          } else {
+            for (int k = 0; k < tap_size; ++k) {
+              const float* cur_ptr = PtrOffset(src_ptr, tap_offset[k]);
+              const float multiplier =
+                  weight_multiplier_->GetWeight(src_ptr, cur_ptr, NULL, j, i);
 
-            const uint8* match_ptr = PtrOffset(img_ptr, tap_space_offset[k]);
-            float bilateral_w = bilateral_lut_[ColorDiffL1(img_ptr, match_ptr) *
-                                               bilateral_scale];
+              const float w = tap_weight[k] * multiplier;
 
-            const float multiplier =
-                weight_multiplier_->GetWeight(src_ptr, cur_ptr, img_ptr, j, i);
+              // Values in above mip map level are pre-multiplied by weight
+              // cur_ptr[C].
+              for (int c = 0; c < C; ++c) {
+                val_sum[c] += cur_ptr[c] * w;
+              }
 
-            const float w = tap_weight[k] * bilateral_w * multiplier;
-
-            // Values in above mip map level are pre-multiplied by
-            // importance weight cur_ptr[C].
-            for (int c = 0; c < C; ++c) {
-              val_sum[c] += cur_ptr[c] * w;
+              weight_sum += w * cur_ptr[C];
             }
-            weight_sum += w * cur_ptr[C];
           }
-        } else {
-          for (int k = 0; k < tap_size; ++k) {
-            const float* cur_ptr = PtrOffset(src_ptr, tap_offset[k]);
-            const float multiplier =
-                weight_multiplier_->GetWeight(src_ptr, cur_ptr, NULL, j, i);
-
-            const float w = tap_weight[k] * multiplier;
 
-            // Values in above mip map level are pre-multiplied by weight
-            // cur_ptr[C].
+          if (weight_sum >= kBilateralEps * kBilateralEps) {
+            const float inv_weight_sum = 1.f / weight_sum;
             for (int c = 0; c < C; ++c) {
-              val_sum[c] += cur_ptr[c] * w;
+              val_sum[c] *= inv_weight_sum;
+            }
+          } else {
+            weight_sum = 0;
+            for (int c = 0; c < C; ++c) {
+              val_sum[c] = 0;
             }
 
-            weight_sum += w * cur_ptr[C];
+            zero_pos.push_back(dst_ptr);
           }
-        }
 
-        if (weight_sum >= kBilateralEps * kBilateralEps) {
-          const float inv_weight_sum = 1.f / weight_sum;
-          for (int c = 0; c < C; ++c) {
-            val_sum[c] *= inv_weight_sum;
-          }
-        } else {
-          weight_sum = 0;
-          for (int c = 0; c < C; ++c) {
-            val_sum[c] = 0;
-          }
+          weight_sum *= prop_scale;
 
-          zero_pos.push_back(dst_ptr);
-        }
+          // Maximum influence of pushed result on current pixel.
+          const float alpha_inv = std::min(1.0f - dst_ptr[C], weight_sum);
+          const float denom =
+              1.0f / (dst_ptr[C] + alpha_inv + kBilateralEps * kBilateralEps);
 
-        const float prop_scale = options_.push_propagation_scale();
-        weight_sum *= prop_scale;
-
-        // Maximum influence of pushed result on current pixel.
-        const float alpha_inv = std::min(1.0f - dst_ptr[C], weight_sum);
-        const float denom =
-            1.0f / (dst_ptr[C] + alpha_inv + kBilateralEps * kBilateralEps);
+          // Blend (dst_ptr is premultiplied with weight dst_ptr[C],
+          //        val_sum is normalized).
+          for (int c = 0; c < C; ++c) {
+            dst_ptr[c] = (dst_ptr[c] + val_sum[c] * alpha_inv) * denom;
+          }
 
-        // Blend (dst_ptr is premultiplied with weight dst_ptr[C],
-        //        val_sum is normalized).
-        for (int c = 0; c < C; ++c) {
-          dst_ptr[c] = (dst_ptr[c] + val_sum[c] * alpha_inv) * denom;
+          // Increase current confidence by above sample.
+          dst_ptr[C] =
+              std::min(1.0f, dst_ptr[C] + std::min(weight_sum, alpha_inv));
         }
-
-        // Increase current confidence by above sample.
-        dst_ptr[C] =
-            std::min(1.0f, dst_ptr[C] + std::min(weight_sum, alpha_inv));
       }
-    }
+    });
 
     if (weight_adjuster_) {
       CopyNecessaryBorder<float, C + 1>(mip_map[l]);
@@ -1284,6 +1306,10 @@ void PushPullFiltering<C, FilterWeightMultiplier>::PushUpSampling(
         }
       }
     } else {
+      std::vector<float*> zero_pos;
+      for (const auto& band : band_zero_pos) {
+        zero_pos.insert(zero_pos.end(), band.begin(), band.end());
+      }
       CopyNecessaryBorder<float, C + 1>(mip_map[l]);
       FillInZeros<C>(zero_pos, num_filter_elems, filter_weights, border_,
                      mip_map[l]);
@@ -0,0 +1,107 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/push_pull_filtering.h"
+
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/vector.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
+
+namespace mediapipe {
+namespace {
+
+// Domain sizes as {width, height}. The heights of most levels are not a
+// multiple of kPushPullBandRows, so that their last band is partial.
+constexpr int kDomainSizes[][2] = {
+    {64, 4 * kPushPullBandRows},
+    {75, 3 * kPushPullBandRows + 5},
+    {40, kPushPullBandRows - 3},
+};
+
+struct PushPullParam {
+  PushPullFilteringC2::FilterType filter_type;
+  bool use_bilateral;
+};
+
+class PushPullFilteringBandTest
+    : public ::testing::TestWithParam<PushPullParam> {
+ protected:
+  void SetUp() override { saved_mode_ = flags_parallel_invoker_mode; }
+
+  void TearDown() override { flags_parallel_invoker_mode = saved_mode_; }
+
+  // Runs push pull on sparse random data over a domain of the given size,
+  // filtering each level in parallel bands in the given parallel invoker mode.
+  cv::Mat PushPull(int width, int height, int mode) {
+    flags_parallel_invoker_mode = mode;
+    const PushPullParam& param = GetParam();
+    PushPullFilteringC2 push_pull(cv::Size(width, height), param.filter_type,
+                                  param.use_bilateral, nullptr, nullptr,
+                                  nullptr);
+
+    std::mt19937 rng(/*seed=*/width * height);
+    std::uniform_real_distribution<float> x_dist(0.0f, width - 1);
+    std::uniform_real_distribution<float> y_dist(0.0f, height - 1);
+    std::uniform_real_distribution<float> value_dist(-5.0f, 5.0f);
+    std::vector<Vector2_f> locations;
+    std::vector<cv::Vec<float, 2>> values;
+    for (int k = 0; k < width * height / 20; ++k) {
+      locations.push_back(Vector2_f(x_dist(rng), y_dist(rng)));
+      values.push_back(cv::Vec<float, 2>(value_dist(rng), value_dist(rng)));
+    }
+
+    cv::Mat input_frame(height, width, CV_8UC3);
+    cv::RNG(width * height).fill(input_frame, cv::RNG::UNIFORM, 0, 256);
+
+    const cv::Size result_size = push_pull.NthPyramidDomain(0);
+    cv::Mat results(result_size.height, result_size.width, CV_32FC3);
+    push_pull.PerformPushPull(locations, values, 1.0f, cv::Point2i(0, 0),
+                              /*readout_level=*/0, /*data_weights=*/nullptr,
+                              param.use_bilateral ? &input_frame : nullptr,
+                              &results);
+    return results;
+  }
+
+ private:
+  int saved_mode_;
+};
+
+TEST_P(PushPullFilteringBandTest, ParallelBandsMatchSerialRows) {
+  for (const auto& size : kDomainSizes) {
+    SCOPED_TRACE(testing::Message() << size[0] << "x" << size[1]);
+    // Without parallelism, each level is filtered in a single pass over its
+    // rows.
+    const cv::Mat serial = PushPull(size[0], size[1], PARALLEL_INVOKER_NONE);
+    const cv::Mat banded =
+        PushPull(size[0], size[1], PARALLEL_INVOKER_THREAD_POOL);
+    ASSERT_EQ(serial.size(), banded.size());
+    EXPECT_GT(cv::norm(serial, cv::NORM_INF), 0);
+    EXPECT_EQ(cv::norm(serial, banded, cv::NORM_INF), 0);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    FilterTypes, PushPullFilteringBandTest,
+    ::testing::Values(
+        PushPullParam{PushPullFilteringC2::BINOMIAL_3X3, false},
+        PushPullParam{PushPullFilteringC2::GAUSSIAN_5X5, false},
+        PushPullParam{PushPullFilteringC2::BINOMIAL_5X5, true},
+        PushPullParam{PushPullFilteringC2::GAUSSIAN_3X3, true}));
+
+}  // namespace
+}  // namespace mediapipe
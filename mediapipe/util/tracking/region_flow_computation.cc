@@ -1479,6 +1479,125 @@ void RegionFlowComputation::Reset() {
 
 namespace {
 
+// Number of image rows per band when computing corner responses in parallel.
+constexpr int kCornerResponseBandRows = 128;
+// Extra rows computed above and below each band, so that the filters of the
+// corner response see the same neighborhood as on the full image.
+constexpr int kCornerResponseBandMargin = 8;
+
+// Computes the corner response of image into response (CV_32F, same size),
+// either the minimum eigenvalue of the 2nd moment matrix or the Harris
+// response. Horizontal bands of the image are processed in parallel, with
+// results identical to processing the whole image at once.
+void ComputeCornerResponse(const cv::Mat& image, bool use_harris,
+                           int block_size, double harris_k,
+                           cv::Mat* response) {
+  const int rows = image.rows;
+  const int num_bands =
+      (rows + kCornerResponseBandRows - 1) / kCornerResponseBandRows;
+  if (num_bands <= 1) {
+    if (use_harris) {
+      cv::cornerHarris(image, *response, block_size, block_size, harris_k);
+    } else {
+      cv::cornerMinEigenVal(image, *response, block_size);
+    }
+    return;
+  }
+
+  CHECK_EQ(response->rows, rows);
+  CHECK_EQ(response->cols, image.cols);
+  CHECK_EQ(response->type(), CV_32F);
+  ParallelFor(0, num_bands, 1, [&](const BlockedRange& range) {
+    for (int band = range.begin(); band < range.end(); ++band) {
+      const int begin = band * kCornerResponseBandRows;
+      const int end = min(rows, begin + kCornerResponseBandRows);
+      const int margin_begin = max(0, begin - kCornerResponseBandMargin);
+      const int margin_end = min(rows, end + kCornerResponseBandMargin);
+      // Filters of an image view read the pixels around it, so only the
+      // borders of the band response are extrapolated.
+      const cv::Mat band_image = image.rowRange(margin_begin, margin_end);
+      cv::Mat band_response;
+      if (use_harris) {
+        cv::cornerHarris(band_image, band_response, block_size, block_size,
+                         harris_k);
+      } else {
+        cv::cornerMinEigenVal(band_image, band_response, block_size);
+      }
+      band_response.rowRange(begin - margin_begin, end - margin_begin)
+          .copyTo(response->rowRange(begin, end));
+    }
+  });
+}
+
+#if CV_MAJOR_VERSION >= 3
+// Number of features tracked per call of cv::calcOpticalFlowPyrLK when
+// tracking in parallel.
+constexpr int kFeaturesPerTrackingChunk = 256;
+
+// Same as cv::calcOpticalFlowPyrLK, but tracks chunks of the features in
+// parallel. Features are tracked independently of each other, so the results
+// are identical to a single call. Inputs that are images rather than pyramids
+// are turned into pyramids once, instead of once per chunk.
+void CalcOpticalFlowPyrLKParallel(
+    cv::_InputArray prev, cv::_InputArray next,
+    const std::vector<cv::Point2f>& prev_points,
+    std::vector<cv::Point2f>* next_points, std::vector<uint8>* status,
+    std::vector<float>* error, const cv::Size& window_size, int max_level,
+    const cv::TermCriteria& criteria, int flags) {
+  const int num_points = prev_points.size();
+  const int num_chunks =
+      (num_points + kFeaturesPerTrackingChunk - 1) / kFeaturesPerTrackingChunk;
+  if (num_chunks <= 1) {
+    cv::calcOpticalFlowPyrLK(prev, next, prev_points, *next_points, *status,
+                             *error, window_size, max_level, criteria, flags);
+    return;
+  }
+
+  // Builds the pyramids like cv::calcOpticalFlowPyrLK does for images.
+  std::vector<cv::Mat> prev_pyramid;
+  if (prev.kind() != cv::_InputArray::STD_VECTOR_MAT) {
+    max_level = cv::buildOpticalFlowPyramid(prev, prev_pyramid, window_size,
+                                            max_level, false);
+    prev = cv::_InputArray(prev_pyramid);
+  }
+  std::vector<cv::Mat> next_pyramid;
+  if (next.kind() != cv::_InputArray::STD_VECTOR_MAT) {
+    max_level = cv::buildOpticalFlowPyramid(next, next_pyramid, window_size,
+                                            max_level, false);
+    next = cv::_InputArray(next_pyramid);
+  }
+
+  const bool use_initial_flow = flags & cv::OPTFLOW_USE_INITIAL_FLOW;
+  next_points->resize(num_points);
+  status->resize(num_points);
+  error->resize(num_points);
+  ParallelFor(0, num_chunks, 1, [&](const BlockedRange& range) {
+    for (int chunk = range.begin(); chunk < range.end(); ++chunk) {
+      const int begin = chunk * kFeaturesPerTrackingChunk;
+      const int end = min(num_points, begin + kFeaturesPerTrackingChunk);
+      const std::vector<cv::Point2f> chunk_prev_points(
+          prev_points.begin() + begin, prev_points.begin() + end);
+      std::vector<cv::Point2f> chunk_next_points;
+      if (use_initial_flow) {
+        chunk_next_points.assign(next_points->begin() + begin,
+                                 next_points->begin() + end);
+      }
+      std::vector<uint8> chunk_status;
+      std::vector<float> chunk_error;
+      cv::calcOpticalFlowPyrLK(prev, next, chunk_prev_points,
+                               chunk_next_points, chunk_status, chunk_error,
+                               window_size, max_level, criteria, flags);
+      std::copy(chunk_next_points.begin(), chunk_next_points.end(),
+                next_points->begin() + begin);
+      std::copy(chunk_status.begin(), chunk_status.end(),
+                status->begin() + begin);
+      std::copy(chunk_error.begin(), chunk_error.end(),
+                error->begin() + begin);
+    }
+  });
+}
+#endif  // CV_MAJOR_VERSION >= 3
+
 struct FloatPointerComparator {
   bool operator()(const float* lhs, const float* rhs) const {
     return *lhs > *rhs;
@@ -1708,10 +1827,9 @@ void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
 
       if (use_fast) {
         fast_detector->detect(image, fast_keypoints);
-      } else if (use_harris) {
-        cv::cornerHarris(image, *eig_image, kBlockSize, kBlockSize, kHarrisK);
       } else {
-        cv::cornerMinEigenVal(image, *eig_image, kBlockSize);
+        ComputeCornerResponse(image, use_harris, kBlockSize, kHarrisK,
+                              eig_image);
       }
     } else {
       // Compute corner response on a down-scaled image and upsample.
@@ -1730,11 +1848,8 @@ void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
         // Use tmp_image to compute eigen-values on resized images.
         cv::Mat eig_view(*tmp_image, cv::Range(0, rows), cv::Range(0, cols));
 
-        if (use_harris) {
-          cv::cornerHarris(image, eig_view, kBlockSize, kBlockSize, kHarrisK);
-        } else {
-          cv::cornerMinEigenVal(image, eig_view, kBlockSize);
-        }
+        ComputeCornerResponse(image, use_harris, kBlockSize, kHarrisK,
+                              &eig_view);
 
         // Upsample (without interpolation) eig_view to match frame size.
         eig_image->setTo(0);
@@ -2606,10 +2721,11 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
 
     if (options_.tracking_options().klt_tracker_implementation() ==
         TrackingOptions::KLT_OPENCV) {
-      cv::calcOpticalFlowPyrLK(input_frame1, input_frame2, features1, features2,
-                               feature_status_, feature_track_error_,
-                               cv_window_size, pyramid_levels_, cv_criteria,
-                               tracking_flags);
+      CalcOpticalFlowPyrLKParallel(input_frame1, input_frame2, features1,
+                                   &features2, &feature_status_,
+                                   &feature_track_error_, cv_window_size,
+                                   pyramid_levels_, cv_criteria,
+                                   tracking_flags);
     } else {
       LOG(ERROR) << "Tracking method unspecified.";
       return;
@@ -2785,10 +2901,11 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
 
     if (use_cv_tracking_) {
 #if CV_MAJOR_VERSION >= 3
-      cv::calcOpticalFlowPyrLK(input_frame2, input_frame1, verify_features,
-                               verify_features_tracked, feature_status_,
-                               verify_track_error, cv_window_size,
-                               pyramid_levels_, cv_criteria, tracking_flags);
+      CalcOpticalFlowPyrLKParallel(input_frame2, input_frame1,
+                                   verify_features, &verify_features_tracked,
+                                   &feature_status_, &verify_track_error,
+                                   cv_window_size, pyramid_levels_,
+                                   cv_criteria, tracking_flags);
 #endif
     } else {
       LOG(ERROR) << "only cv tracking is supported.";
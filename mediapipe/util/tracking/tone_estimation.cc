@@ -151,17 +151,32 @@ void ToneEstimation::IntensityPercentiles(const cv::Mat& frame,
   cv::Mat intensity(frame.rows, frame.cols, CV_8UC1);
   cv::cvtColor(frame, intensity, cv::COLOR_RGB2GRAY);
 
-  std::vector<float> histogram(256, 0.0f);
-
-  for (int i = 0; i < intensity.rows; ++i) {
-    const uint8* intensity_ptr = intensity.ptr<uint8>(i);
-    const uint8* clip_ptr = clip_mask.ptr<uint8>(i);
-
-    for (int j = 0; j < intensity.cols; ++j) {
-      if (!clip_ptr[j]) {
-        ++histogram[intensity_ptr[j]];
+  // Histograms of bands of rows are computed in parallel and summed.
+  const int num_bands =
+      (intensity.rows + kToneEstimationBandRows - 1) / kToneEstimationBandRows;
+  std::vector<std::vector<int>> band_histograms(num_bands,
+                                                std::vector<int>(256, 0));
+  ParallelFor(0, num_bands, 1, [&](const BlockedRange& range) {
+    for (int band = range.begin(); band < range.end(); ++band) {
+      std::vector<int>& band_histogram = band_histograms[band];
+      const int end_row =
+          std::min(intensity.rows, (band + 1) * kToneEstimationBandRows);
+      for (int i = band * kToneEstimationBandRows; i < end_row; ++i) {
+        const uint8* intensity_ptr = intensity.ptr<uint8>(i);
+        const uint8* clip_ptr = clip_mask.ptr<uint8>(i);
+
+        for (int j = 0; j < intensity.cols; ++j) {
+          band_histogram[intensity_ptr[j]] += clip_ptr[j] == 0;
+        }
       }
     }
+  });
+
+  std::vector<float> histogram(256, 0.0f);
+  for (const auto& band_histogram : band_histograms) {
+    for (int k = 0; k < 256; ++k) {
+      histogram[k] += band_histogram[k];
+    }
   }
 
   // Construct cumulative histogram.
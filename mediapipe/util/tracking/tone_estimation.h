@@ -30,6 +30,7 @@
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/vector.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 #include "mediapipe/util/tracking/region_flow.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
 #include "mediapipe/util/tracking/tone_estimation.pb.h"
@@ -45,6 +46,10 @@ typedef std::deque<PatchToneMatch> PatchToneMatches;
 // Each vector element presents its own channel.
 typedef std::vector<PatchToneMatches> ColorToneMatches;
 
+// Per-pixel passes over a frame are run in parallel in bands of this many
+// rows.
+const int kToneEstimationBandRows = 32;
+
 // Clip mask for C channels.
 template <int C>
 struct ClipMask {
@@ -161,9 +166,6 @@ void ToneEstimation::ComputeClipMask(const ClipMaskOptions& options,
   const float max_exposure_thresh = options.max_exposure() * 255.0f;
   const int max_clipped_channels = options.max_clipped_channels();
 
-  std::vector<cv::Mat> planes;
-  cv::split(frame, planes);
-  CHECK_EQ(C, planes.size());
   float min_exposure[C];
   float max_exposure[C];
   for (int c = 0; c < C; ++c) {
@@ -176,27 +178,32 @@ void ToneEstimation::ComputeClipMask(const ClipMaskOptions& options,
     clip_mask->max_exposure_threshold[c] = max_exposure[c];
   }
 
-  for (int i = 0; i < frame.rows; ++i) {
-    const uint8* img_ptr = frame.ptr<uint8>(i);
-    uint8* clip_ptr = clip_mask->mask.template ptr<uint8>(i);
-
-    for (int j = 0; j < frame.cols; ++j) {
-      const int idx = C * j;
-      int clipped_channels = 0;  // Count clipped channels.
-
-      for (int p = 0; p < C; ++p) {
-        clipped_channels +=
-            static_cast<int>(img_ptr[idx + p] < min_exposure[p] ||
-                             img_ptr[idx + p] > max_exposure[p]);
-      }
+  // Lookup table of clipped intensities per channel.
+  uint8 clipped[C][256];
+  for (int p = 0; p < C; ++p) {
+    for (int v = 0; v < 256; ++v) {
+      clipped[p][v] = v < min_exposure[p] || v > max_exposure[p];
+    }
+  }
 
-      if (clipped_channels > max_clipped_channels) {
-        clip_ptr[j] = 1;
-      } else {
-        clip_ptr[j] = 0;
+  const int num_bands =
+      (frame.rows + kToneEstimationBandRows - 1) / kToneEstimationBandRows;
+  ParallelFor(0, num_bands, 1, [&](const BlockedRange& range) {
+    const int end_row =
+        std::min(frame.rows, range.end() * kToneEstimationBandRows);
+    for (int i = range.begin() * kToneEstimationBandRows; i < end_row; ++i) {
+      const uint8* img_ptr = frame.ptr<uint8>(i);
+      uint8* clip_ptr = clip_mask->mask.template ptr<uint8>(i);
+
+      for (int j = 0; j < frame.cols; ++j, img_ptr += C) {
+        int clipped_channels = 0;  // Count clipped channels.
+        for (int p = 0; p < C; ++p) {
+          clipped_channels += clipped[p][img_ptr[p]];
+        }
+        clip_ptr[j] = clipped_channels > max_clipped_channels ? 1 : 0;
       }
     }
-  }
+  });
 
   // Dilate to address blooming.
   const int dilate_diam = options.clip_mask_diameter();
@@ -0,0 +1,174 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/tone_estimation.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
+#include "mediapipe/util/tracking/region_flow.pb.h"
+#include "mediapipe/util/tracking/tone_estimation.pb.h"
+
+namespace mediapipe {
+namespace {
+
+// Frame sizes as {rows, cols}. Most row counts are not a multiple of
+// kToneEstimationBandRows, so that the last band is partial.
+constexpr int kFrameSizes[][2] = {
+    {2 * kToneEstimationBandRows, 40},
+    {3 * kToneEstimationBandRows + 11, 57},
+    {kToneEstimationBandRows - 1, 23},
+    {1, 9},
+};
+
+// Returns a frame of random colors, a fraction of which are over- or
+// under-exposed. The first pixel is white and the last one black.
+cv::Mat RandomFrame(int rows, int cols) {
+  cv::Mat frame(rows, cols, CV_8UC3);
+  cv::RNG rng(rows * cols);
+  rng.fill(frame, cv::RNG::UNIFORM, 0, 256);
+  frame.at<cv::Vec3b>(0, 0) = cv::Vec3b(255, 255, 255);
+  frame.at<cv::Vec3b>(rows - 1, cols - 1) = cv::Vec3b(0, 0, 0);
+  return frame;
+}
+
+// Computes the clip mask row by row, without dilation.
+cv::Mat SerialClipMask(const ClipMaskOptions& options, const cv::Mat& frame) {
+  const float min_exposure = options.min_exposure() * 255.0f;
+  const float max_exposure = options.max_exposure() * 255.0f;
+  cv::Mat mask(frame.rows, frame.cols, CV_8U);
+  for (int i = 0; i < frame.rows; ++i) {
+    const uint8* img_ptr = frame.ptr<uint8>(i);
+    uint8* mask_ptr = mask.ptr<uint8>(i);
+    for (int j = 0; j < frame.cols; ++j) {
+      int clipped_channels = 0;
+      for (int c = 0; c < 3; ++c) {
+        const uint8 value = img_ptr[3 * j + c];
+        clipped_channels += value < min_exposure || value > max_exposure;
+      }
+      mask_ptr[j] = clipped_channels > options.max_clipped_channels() ? 1 : 0;
+    }
+  }
+  return mask;
+}
+
+// Returns the unclipped intensity bins below which the given fractions of
+// the unclipped intensities lie, counted row by row.
+std::vector<int> SerialPercentileBins(const cv::Mat& frame,
+                                      const cv::Mat& clip_mask,
+                                      const std::vector<float>& fractions) {
+  cv::Mat intensity;
+  cv::cvtColor(frame, intensity, cv::COLOR_RGB2GRAY);
+  std::vector<float> histogram(256, 0.0f);
+  for (int i = 0; i < intensity.rows; ++i) {
+    const uint8* intensity_ptr = intensity.ptr<uint8>(i);
+    const uint8* clip_ptr = clip_mask.ptr<uint8>(i);
+    for (int j = 0; j < intensity.cols; ++j) {
+      if (!clip_ptr[j]) {
+        ++histogram[intensity_ptr[j]];
+      }
+    }
+  }
+  std::partial_sum(histogram.begin(), histogram.end(), histogram.begin());
+  const float denom = 1.0f / histogram.back();
+  for (auto& entry : histogram) {
+    entry *= denom;
+  }
+  std::vector<int> bins;
+  for (const float fraction : fractions) {
+    bins.push_back(
+        std::lower_bound(histogram.begin(), histogram.end(), fraction) -
+        histogram.begin());
+  }
+  return bins;
+}
+
+class ToneEstimationBandTest
+    : public ::testing::TestWithParam<PARALLEL_INVOKER_MODE> {
+ protected:
+  void SetUp() override {
+    saved_mode_ = flags_parallel_invoker_mode;
+    flags_parallel_invoker_mode = GetParam();
+  }
+
+  void TearDown() override { flags_parallel_invoker_mode = saved_mode_; }
+
+ private:
+  int saved_mode_;
+};
+
+TEST_P(ToneEstimationBandTest, ClipMaskMatchesSerialComputation) {
+  ClipMaskOptions options;
+  // A diameter of one leaves the mask undilated.
+  options.set_clip_mask_diameter(1);
+  options.set_max_clipped_channels(0);
+  for (const auto& size : kFrameSizes) {
+    SCOPED_TRACE(testing::Message() << size[0] << "x" << size[1]);
+    const cv::Mat frame = RandomFrame(size[0], size[1]);
+    ClipMask<3> clip_mask;
+    ToneEstimation::ComputeClipMask<3>(options, frame, &clip_mask);
+    const cv::Mat expected = SerialClipMask(options, frame);
+    ASSERT_EQ(clip_mask.mask.rows, expected.rows);
+    ASSERT_EQ(clip_mask.mask.cols, expected.cols);
+    EXPECT_EQ(cv::countNonZero(clip_mask.mask != expected), 0);
+    EXPECT_GT(cv::countNonZero(expected), 0);
+  }
+}
+
+TEST_P(ToneEstimationBandTest, PercentilesMatchSerialHistogram) {
+  ToneEstimationOptions options;
+  options.set_downsample_mode(ToneEstimationOptions::DOWNSAMPLE_NONE);
+  options.mutable_tone_match_options()->set_log_domain(false);
+  const std::vector<float> fractions = {
+      options.stats_low_percentile(), options.stats_low_mid_percentile(),
+      options.stats_mid_percentile(), options.stats_high_mid_percentile(),
+      options.stats_high_percentile()};
+  for (const auto& size : kFrameSizes) {
+    SCOPED_TRACE(testing::Message() << size[0] << "x" << size[1]);
+    const cv::Mat frame = RandomFrame(size[0], size[1]);
+    ToneEstimation tone_estimation(options, frame.cols, frame.rows);
+    ToneChange tone_change;
+    tone_estimation.EstimateToneChange(RegionFlowFeatureList(), frame,
+                                       /*prev_frame_input=*/nullptr,
+                                       &tone_change);
+
+    ClipMask<3> clip_mask;
+    ToneEstimation::ComputeClipMask<3>(options.clip_mask_options(), frame,
+                                       &clip_mask);
+    if (cv::countNonZero(clip_mask.mask) == frame.rows * frame.cols) {
+      // Fully clipped frames keep the default percentiles.
+      continue;
+    }
+    const std::vector<int> bins =
+        SerialPercentileBins(frame, clip_mask.mask, fractions);
+    EXPECT_EQ(tone_change.low_percentile(), bins[0] * (1.0f / 255.0f));
+    EXPECT_EQ(tone_change.low_mid_percentile(), bins[1] * (1.0f / 255.0f));
+    EXPECT_EQ(tone_change.mid_percentile(), bins[2] * (1.0f / 255.0f));
+    EXPECT_EQ(tone_change.high_mid_percentile(), bins[3] * (1.0f / 255.0f));
+    EXPECT_EQ(tone_change.high_percentile(), bins[4] * (1.0f / 255.0f));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(ParallelModes, ToneEstimationBandTest,
+                         ::testing::Values(PARALLEL_INVOKER_NONE,
+                                           PARALLEL_INVOKER_THREAD_POOL));
+
+}  // namespace
+}  // namespace mediapipe
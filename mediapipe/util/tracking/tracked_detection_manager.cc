@@ -14,6 +14,8 @@
 
 #include "mediapipe/util/tracking/tracked_detection_manager.h"
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 #include "mediapipe/framework/formats/rect.pb.h"
@@ -43,6 +45,73 @@ bool AreCornersOutOfView(const TrackedDetection& object) {
 
 namespace mediapipe {
 
+std::vector<const TrackedDetection*>
+TrackedDetectionManager::GetAllTrackedDetections() const {
+  std::vector<const TrackedDetection*> detections;
+  detections.reserve(id_to_slot_.size());
+  for (const auto& detection : detections_) {
+    if (detection) {
+      detections.push_back(detection.get());
+    }
+  }
+  return detections;
+}
+
+bool TrackedDetectionManager::MayBeSame(const TrackedDetection& detection,
+                                        int slot) const {
+  // IsSameAs() can only hold without overlap for negative overlap ratios.
+  if (config_.is_same_detection_min_overlap_ratio() < 0.f) {
+    return true;
+  }
+  return std::min(detection.right(), right_[slot]) >
+             std::max(detection.left(), left_[slot]) &&
+         std::min(detection.bottom(), bottom_[slot]) >
+             std::max(detection.top(), top_[slot]);
+}
+
+int TrackedDetectionManager::Insert(
+    std::unique_ptr<TrackedDetection> detection) {
+  // A detection replaces any detection with the same id.
+  Remove(detection->unique_id());
+  int slot;
+  if (free_slots_.empty()) {
+    slot = detections_.size();
+    detections_.emplace_back();
+    left_.emplace_back();
+    right_.emplace_back();
+    top_.emplace_back();
+    bottom_.emplace_back();
+    last_updated_timestamps_.emplace_back();
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  }
+  id_to_slot_[detection->unique_id()] = slot;
+  detections_[slot] = std::move(detection);
+  UpdateBounds(slot);
+  return slot;
+}
+
+void TrackedDetectionManager::Remove(int id) {
+  auto slot_ptr = id_to_slot_.find(id);
+  if (slot_ptr == id_to_slot_.end()) {
+    return;
+  }
+  const int slot = slot_ptr->second;
+  id_to_slot_.erase(slot_ptr);
+  detections_[slot].reset();
+  free_slots_.push_back(slot);
+}
+
+void TrackedDetectionManager::UpdateBounds(int slot) {
+  const TrackedDetection& detection = *detections_[slot];
+  left_[slot] = detection.left();
+  right_[slot] = detection.right();
+  top_[slot] = detection.top();
+  bottom_[slot] = detection.bottom();
+  last_updated_timestamps_[slot] = detection.last_updated_timestamp();
+}
+
 std::vector<int> TrackedDetectionManager::AddDetection(
     std::unique_ptr<TrackedDetection> detection) {
   std::vector<int> ids_to_remove;
@@ -51,8 +120,11 @@ std::vector<int> TrackedDetectionManager::AddDetection(
   // TODO: All detections should be fastforwarded to the current
   // timestamp before adding the detection manager. E.g. only check they are the
   // same if the timestamp are the same.
-  for (auto& existing_detection_ptr : detections_) {
-    const auto& existing_detection = *existing_detection_ptr.second;
+  for (int slot = 0; slot < detections_.size(); ++slot) {
+    if (!detections_[slot] || !MayBeSame(*detection, slot)) {
+      continue;
+    }
+    const auto& existing_detection = *detections_[slot];
     if (detection->IsSameAs(existing_detection,
                             config_.is_same_detection_max_area_ratio(),
                             config_.is_same_detection_min_overlap_ratio())) {
@@ -72,28 +144,28 @@ std::vector<int> TrackedDetectionManager::AddDetection(
           detection->set_previous_id(existing_detection.previous_id());
         }
       }
-      ids_to_remove.push_back(existing_detection_ptr.first);
+      ids_to_remove.push_back(existing_detection.unique_id());
     }
   }
   // Erase old detections.
   for (auto id : ids_to_remove) {
-    detections_.erase(id);
+    Remove(id);
   }
-  const int id = detection->unique_id();
-  detections_[id] = std::move(detection);
+  Insert(std::move(detection));
   return ids_to_remove;
 }
 
 std::vector<int> TrackedDetectionManager::UpdateDetectionLocation(
     int id, const NormalizedRect& bounding_box, int64 timestamp) {
   // TODO: Remove all boxes that are not updating.
-  auto detection_ptr = detections_.find(id);
-  if (detection_ptr == detections_.end()) {
+  auto slot_ptr = id_to_slot_.find(id);
+  if (slot_ptr == id_to_slot_.end()) {
     return std::vector<int>();
   }
-  auto& detection = *detection_ptr->second;
+  auto& detection = *detections_[slot_ptr->second];
   detection.set_bounding_box(bounding_box);
   detection.set_last_updated_timestamp(timestamp);
+  UpdateBounds(slot_ptr->second);
 
   // It's required to do this here in addition to in AddDetection because during
   // fast motion, two or more detections of the same object could coexist since
@@ -105,73 +177,71 @@ std::vector<int> TrackedDetectionManager::UpdateDetectionLocation(
 std::vector<int> TrackedDetectionManager::RemoveObsoleteDetections(
     int64 timestamp) {
   std::vector<int> ids_to_remove;
-  for (auto& existing_detection : detections_) {
-    if (existing_detection.second->last_updated_timestamp() < timestamp) {
-      ids_to_remove.push_back(existing_detection.first);
+  for (int slot = 0; slot < detections_.size(); ++slot) {
+    if (detections_[slot] && last_updated_timestamps_[slot] < timestamp) {
+      ids_to_remove.push_back(detections_[slot]->unique_id());
     }
   }
   for (auto idx : ids_to_remove) {
-    detections_.erase(idx);
+    Remove(idx);
   }
   return ids_to_remove;
 }
 
 std::vector<int> TrackedDetectionManager::RemoveOutOfViewDetections() {
   std::vector<int> ids_to_remove;
-  for (auto& existing_detection : detections_) {
-    if (AreCornersOutOfView(*existing_detection.second)) {
-      ids_to_remove.push_back(existing_detection.first);
+  for (const auto& detection : detections_) {
+    if (detection && AreCornersOutOfView(*detection)) {
+      ids_to_remove.push_back(detection->unique_id());
     }
   }
   for (auto idx : ids_to_remove) {
-    detections_.erase(idx);
+    Remove(idx);
   }
   return ids_to_remove;
 }
 
 std::vector<int> TrackedDetectionManager::RemoveDuplicatedDetections(int id) {
   std::vector<int> ids_to_remove;
-  auto detection_ptr = detections_.find(id);
-  if (detection_ptr == detections_.end()) {
+  auto slot_ptr = id_to_slot_.find(id);
+  if (slot_ptr == id_to_slot_.end()) {
     return ids_to_remove;
   }
-  auto& detection = *detection_ptr->second;
+  const int detection_slot = slot_ptr->second;
+  auto& detection = *detections_[detection_slot];
 
   // For duplciated detections, we keep the one that's added most recently.
-  auto latest_detection = detection_ptr->second.get();
+  auto latest_detection = &detection;
   // For setting up the |previous_id| of the latest detection. For now, if there
   // are multiple duplicated detections at the same timestamp, we will use the
   // one that has the second latest initial timestamp
   const TrackedDetection* previous_detection = nullptr;
-  for (auto& existing_detection : detections_) {
-    auto other = *(existing_detection.second);
-    if (detection.unique_id() != other.unique_id()) {
-      // Only check if they are updated at the same timestamp. Comparing
-      // locations of detections at different timestamp is not correct.
-      if (detection.last_updated_timestamp() ==
-          other.last_updated_timestamp()) {
-        if (detection.IsSameAs(other,
-                               config_.is_same_detection_max_area_ratio(),
-                               config_.is_same_detection_min_overlap_ratio())) {
-          const TrackedDetection* detection_to_remove = nullptr;
-          if (latest_detection->initial_timestamp() >=
-              other.initial_timestamp()) {
-            // Removes the earlier one.
-            ids_to_remove.push_back(other.unique_id());
-            detection_to_remove = existing_detection.second.get();
-            latest_detection->MergeLabelScore(other);
-          } else {
-            ids_to_remove.push_back(latest_detection->unique_id());
-            detection_to_remove = latest_detection;
-            existing_detection.second->MergeLabelScore(*latest_detection);
-            latest_detection = existing_detection.second.get();
-          }
-          if (!previous_detection ||
-              previous_detection->initial_timestamp() <
-                  detection_to_remove->initial_timestamp()) {
-            previous_detection = detection_to_remove;
-          }
-        }
+  for (int slot = 0; slot < detections_.size(); ++slot) {
+    // Only check if they are updated at the same timestamp. Comparing
+    // locations of detections at different timestamp is not correct.
+    if (slot == detection_slot || !detections_[slot] ||
+        last_updated_timestamps_[slot] != detection.last_updated_timestamp() ||
+        !MayBeSame(detection, slot)) {
+      continue;
+    }
+    auto& other = *detections_[slot];
+    if (detection.IsSameAs(other, config_.is_same_detection_max_area_ratio(),
+                           config_.is_same_detection_min_overlap_ratio())) {
+      const TrackedDetection* detection_to_remove = nullptr;
+      if (latest_detection->initial_timestamp() >= other.initial_timestamp()) {
+        // Removes the earlier one.
+        ids_to_remove.push_back(other.unique_id());
+        detection_to_remove = &other;
+        latest_detection->MergeLabelScore(other);
+      } else {
+        ids_to_remove.push_back(latest_detection->unique_id());
+        detection_to_remove = latest_detection;
+        other.MergeLabelScore(*latest_detection);
+        latest_detection = &other;
+      }
+      if (!previous_detection || previous_detection->initial_timestamp() <
+                                     detection_to_remove->initial_timestamp()) {
+        previous_detection = detection_to_remove;
       }
     }
   }
@@ -187,7 +257,7 @@ std::vector<int> TrackedDetectionManager::RemoveDuplicatedDetections(int id) {
   }
 
   for (auto idx : ids_to_remove) {
-    detections_.erase(idx);
+    Remove(idx);
   }
   return ids_to_remove;
 }
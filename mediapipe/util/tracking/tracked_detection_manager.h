@@ -15,8 +15,12 @@
 #ifndef MEDIAPIPE_UTIL_TRACKING_DETECTION_MANAGER_H_
 #define MEDIAPIPE_UTIL_TRACKING_DETECTION_MANAGER_H_
 
-#include "absl/container/node_hash_map.h"
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/util/tracking/tracked_detection.h"
 #include "mediapipe/util/tracking/tracked_detection_manager_config.pb.h"
 
@@ -53,21 +57,19 @@ class TrackedDetectionManager {
   // detections that are removed.
   std::vector<int> RemoveOutOfViewDetections();
 
-  int GetNumDetections() const { return detections_.size(); }
+  int GetNumDetections() const { return id_to_slot_.size(); }
 
   // Get TrackedDetection by its unique id.
   const TrackedDetection* GetTrackedDetection(int id) const {
-    auto detection_ptr = detections_.find(id);
-    if (detection_ptr == detections_.end()) {
+    auto slot_ptr = id_to_slot_.find(id);
+    if (slot_ptr == id_to_slot_.end()) {
       return nullptr;
     }
-    return detection_ptr->second.get();
+    return detections_[slot_ptr->second].get();
   }
 
-  const absl::node_hash_map<int, std::unique_ptr<TrackedDetection>>&
-  GetAllTrackedDetections() const {
-    return detections_;
-  }
+  // Returns all detections, in no particular order.
+  std::vector<const TrackedDetection*> GetAllTrackedDetections() const;
 
   void SetConfig(const mediapipe::TrackedDetectionManagerConfig& config) {
     config_ = config;
@@ -79,7 +81,27 @@ class TrackedDetectionManager {
   // of the detections that are removed.
   std::vector<int> RemoveDuplicatedDetections(int id);
 
-  absl::node_hash_map<int, std::unique_ptr<TrackedDetection>> detections_;
+  // Returns whether the detection may be the same as the one in |slot|, i.e.
+  // their boxes overlap. Rejects most pairs before the IsSameAs() check.
+  bool MayBeSame(const TrackedDetection& detection, int slot) const;
+
+  // Stores a detection in a free slot and returns the slot.
+  int Insert(std::unique_ptr<TrackedDetection> detection);
+  void Remove(int id);
+  void UpdateBounds(int slot);
+
+  // The detections are stored in slots, with their bounds and update
+  // timestamps in contiguous arrays, so that duplicate and obsolete checks
+  // scan the arrays instead of the detections. Slots of removed detections
+  // are null and reused by later detections.
+  std::vector<std::unique_ptr<TrackedDetection>> detections_;
+  std::vector<float> left_;
+  std::vector<float> right_;
+  std::vector<float> top_;
+  std::vector<float> bottom_;
+  std::vector<int64> last_updated_timestamps_;
+  std::vector<int> free_slots_;
+  absl::flat_hash_map<int, int> id_to_slot_;
 
   mediapipe::TrackedDetectionManagerConfig config_;
 };
@@ -0,0 +1,106 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/tracked_detection_manager.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/tracking/tracked_detection.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+NormalizedRect MakeBox(float x_center, float y_center, float size) {
+  NormalizedRect box;
+  box.set_x_center(x_center);
+  box.set_y_center(y_center);
+  box.set_width(size);
+  box.set_height(size);
+  return box;
+}
+
+std::unique_ptr<TrackedDetection> MakeDetection(int id, int64 timestamp,
+                                                const NormalizedRect& box,
+                                                const std::string& label) {
+  auto detection = std::make_unique<TrackedDetection>(id, timestamp, box);
+  detection->AddLabel(label, 0.5f);
+  return detection;
+}
+
+TEST(TrackedDetectionManagerTest, AddDetectionReplacesDuplicates) {
+  TrackedDetectionManager manager;
+  EXPECT_THAT(manager.AddDetection(
+                  MakeDetection(1, 1, MakeBox(0.3f, 0.3f, 0.2f), "cat")),
+              IsEmpty());
+  EXPECT_THAT(manager.AddDetection(
+                  MakeDetection(2, 0, MakeBox(0.7f, 0.7f, 0.2f), "dog")),
+              IsEmpty());
+  EXPECT_THAT(manager.AddDetection(
+                  MakeDetection(3, 10, MakeBox(0.31f, 0.3f, 0.2f), "pet")),
+              ElementsAre(1));
+
+  EXPECT_EQ(manager.GetNumDetections(), 2);
+  EXPECT_EQ(manager.GetTrackedDetection(1), nullptr);
+  const TrackedDetection* detection = manager.GetTrackedDetection(3);
+  ASSERT_NE(detection, nullptr);
+  EXPECT_EQ(detection->previous_id(), 1);
+  EXPECT_EQ(detection->label_to_score_map().size(), 2);
+}
+
+TEST(TrackedDetectionManagerTest, UpdateLocationRemovesEarlierDuplicate) {
+  TrackedDetectionManager manager;
+  manager.AddDetection(MakeDetection(1, 0, MakeBox(0.3f, 0.3f, 0.2f), "cat"));
+  manager.AddDetection(MakeDetection(2, 5, MakeBox(0.7f, 0.7f, 0.2f), "cat"));
+
+  EXPECT_THAT(manager.UpdateDetectionLocation(1, MakeBox(0.5f, 0.5f, 0.2f), 20),
+              IsEmpty());
+  // Detection 2 moves onto detection 1 at the same timestamp.
+  EXPECT_THAT(manager.UpdateDetectionLocation(2, MakeBox(0.5f, 0.5f, 0.2f), 20),
+              ElementsAre(1));
+  EXPECT_EQ(manager.GetNumDetections(), 1);
+  ASSERT_NE(manager.GetTrackedDetection(2), nullptr);
+  EXPECT_EQ(manager.GetTrackedDetection(2)->previous_id(), 1);
+}
+
+TEST(TrackedDetectionManagerTest, RemovesObsoleteAndOutOfViewDetections) {
+  TrackedDetectionManager manager;
+  manager.AddDetection(MakeDetection(1, 0, MakeBox(0.2f, 0.2f, 0.1f), "a"));
+  manager.AddDetection(MakeDetection(2, 0, MakeBox(0.5f, 0.5f, 0.1f), "b"));
+  manager.AddDetection(MakeDetection(3, 0, MakeBox(0.8f, 0.8f, 0.1f), "c"));
+  manager.UpdateDetectionLocation(2, MakeBox(0.5f, 0.5f, 0.1f), 100);
+  manager.UpdateDetectionLocation(3, MakeBox(1.5f, 1.5f, 0.1f), 100);
+
+  EXPECT_THAT(manager.RemoveObsoleteDetections(50), ElementsAre(1));
+  EXPECT_THAT(manager.RemoveOutOfViewDetections(), ElementsAre(3));
+
+  // Removed slots are reused.
+  manager.AddDetection(MakeDetection(4, 100, MakeBox(0.2f, 0.8f, 0.1f), "d"));
+  manager.AddDetection(MakeDetection(5, 100, MakeBox(0.8f, 0.2f, 0.1f), "e"));
+  std::vector<int> ids;
+  for (const TrackedDetection* detection : manager.GetAllTrackedDetections()) {
+    ids.push_back(detection->unique_id());
+  }
+  EXPECT_THAT(ids, UnorderedElementsAre(2, 4, 5));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <random>
@@ -33,6 +34,7 @@
 #include "mediapipe/util/tracking/flow_packager.pb.h"
 #include "mediapipe/util/tracking/measure_time.h"
 #include "mediapipe/util/tracking/motion_models.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 
 namespace mediapipe {
 
@@ -1306,6 +1308,29 @@ void MotionBox::GetStartPosition(const MotionBoxState& curr_pos,
   *bottom_right += expand;
 }
 
+bool MotionBox::TrackStepRegion(int from_frame, float aspect_ratio,
+                                Vector2_f* top_left,
+                                Vector2_f* bottom_right) const {
+  CHECK(top_left);
+  CHECK(bottom_right);
+  if (!TrackableFromFrame(from_frame)) {
+    return false;
+  }
+
+  // Same normalization as in TrackStepImpl. Temporal scaling only affects the
+  // velocity, which is accounted for by the velocity independent bound of the
+  // expansion in GetStartPosition below.
+  MotionBoxState state = states_[from_frame - queue_start_];
+  ScaleStateAspect(aspect_ratio, false, &state);
+  MotionBoxBoundingBox(state, top_left, bottom_right);
+  const float expand_mag = std::max(options_.expansion_size(),
+                                    MotionBoxSize(state).Norm() * 0.25f);
+  const Vector2_f expand = Vector2_f(expand_mag, expand_mag);
+  *top_left -= expand;
+  *bottom_right += expand;
+  return true;
+}
+
 void MotionBox::GetSpatialGaussWeights(const MotionBoxState& box_state,
                                        const Vector2_f& inv_box_domain,
                                        float* spatial_gauss_x,
@@ -2896,7 +2921,6 @@ void MotionBox::TrackStepImplDeNormalized(
         [&motion_frame](int id) {
           return !motion_frame.actively_discarded_tracked_ids->contains(id);
         });
-    motion_frame.actively_discarded_tracked_ids->clear();
   }
   const int num_inliers = next_pos->inlier_ids_size();
   // Must be in [0, 1].
@@ -3162,6 +3186,15 @@ void MotionBox::TrackStepImplDeNormalized(
 
 void MotionVectorFrameFromTrackingData(const TrackingData& tracking_data,
                                        MotionVectorFrame* motion_vector_frame) {
+  constexpr float kMax = std::numeric_limits<float>::max();
+  MotionVectorFrameFromTrackingData(tracking_data, Vector2_f(-kMax, -kMax),
+                                    Vector2_f(kMax, kMax), motion_vector_frame);
+}
+
+void MotionVectorFrameFromTrackingData(const TrackingData& tracking_data,
+                                       const Vector2_f& top_left,
+                                       const Vector2_f& bottom_right,
+                                       MotionVectorFrame* motion_vector_frame) {
   CHECK(motion_vector_frame != nullptr);
 
   const auto& motion_data = tracking_data.motion_data();
@@ -3205,9 +3238,21 @@ void MotionVectorFrameFromTrackingData(const TrackingData& tracking_data,
   motion_vector_frame->motion_vectors.clear();
   const bool long_tracks = motion_data.track_id_size() > 0;
 
-  for (int c = 0; c < motion_data.col_starts_size() - 1; ++c) {
+  // Columns are stored in increasing x, only the ones overlapping the region
+  // are visited. Bounds are widened by one column against rounding, the exact
+  // test is on scaled_x below.
+  const int num_cols = std::max(motion_data.col_starts_size() - 1, 0);
+  const int col_begin = static_cast<int>(std::clamp<float>(
+      std::floor(top_left.x() / scale_x) - 1.0f, 0.0f, num_cols));
+  const int col_end = static_cast<int>(std::clamp<float>(
+      std::ceil(bottom_right.x() / scale_x) + 2.0f, 0.0f, num_cols));
+
+  for (int c = col_begin; c < col_end; ++c) {
     const float x = c;
     const float scaled_x = x * scale_x;
+    if (scaled_x < top_left.x() || scaled_x > bottom_right.x()) {
+      continue;
+    }
 
     for (int r = motion_data.col_starts(c),
              r_end = motion_data.col_starts(c + 1);
@@ -3216,6 +3261,9 @@ void MotionVectorFrameFromTrackingData(const TrackingData& tracking_data,
 
       const float y = motion_data.row_indices(r);
       const float scaled_y = y * scale_y;
+      if (scaled_y < top_left.y() || scaled_y > bottom_right.y()) {
+        continue;
+      }
 
       const float dx = motion_data.vector_data(2 * r);
       const float dy = motion_data.vector_data(2 * r + 1);
@@ -3288,6 +3336,15 @@ void FeatureAndDescriptorFromTrackingData(
 
 void InvertMotionVectorFrame(const MotionVectorFrame& input,
                              MotionVectorFrame* output) {
+  constexpr float kMax = std::numeric_limits<float>::max();
+  InvertMotionVectorFrame(input, Vector2_f(-kMax, -kMax), Vector2_f(kMax, kMax),
+                          output);
+}
+
+void InvertMotionVectorFrame(const MotionVectorFrame& input,
+                             const Vector2_f& top_left,
+                             const Vector2_f& bottom_right,
+                             MotionVectorFrame* output) {
   CHECK(output != nullptr);
 
   output->background_model.CopyFrom(ModelInvert(input.background_model));
@@ -3318,6 +3375,13 @@ void InvertMotionVectorFrame(const MotionVectorFrame& input,
       continue;
     }
 
+    if (motion_vec.pos.x() < top_left.x() ||
+        motion_vec.pos.x() > bottom_right.x() ||
+        motion_vec.pos.y() < top_left.y() ||
+        motion_vec.pos.y() > bottom_right.y()) {
+      continue;
+    }
+
     // Approximately 40 - 60% of all inserts happen to be at the end.
     if (output->motion_vectors.empty() ||
         MotionVectorComparator()(output->motion_vectors.back(), motion_vec)) {
@@ -3332,6 +3396,32 @@ void InvertMotionVectorFrame(const MotionVectorFrame& input,
   }
 }
 
+std::vector<int> TrackStepBatch(int from_frame,
+                                const MotionVectorFrame& motion_vectors,
+                                bool forward,
+                                const std::vector<MotionBox*>& boxes) {
+  std::vector<int> failed;
+  if (boxes.empty()) {
+    return failed;
+  }
+
+  // Boxes only read motion_vectors and are tracked independently. One byte per
+  // box, as concurrent writes to std::vector<bool> would race.
+  std::vector<char> tracked(boxes.size());
+  ParallelFor(0, boxes.size(), 1, [&](const BlockedRange& range) {
+    for (int k = range.begin(); k < range.end(); ++k) {
+      tracked[k] = boxes[k]->TrackStep(from_frame, motion_vectors, forward);
+    }
+  });
+
+  for (int k = 0; k < boxes.size(); ++k) {
+    if (!tracked[k]) {
+      failed.push_back(k);
+    }
+  }
+  return failed;
+}
+
 float TrackingDataDurationMs(const TrackingDataChunk::Item& item) {
   return (item.timestamp_usec() - item.prev_timestamp_usec()) * 1e-3f;
 }
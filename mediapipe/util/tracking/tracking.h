@@ -222,7 +222,8 @@ struct MotionVectorFrame {
   float aspect_ratio = 1.0f;
 
   // Stores the tracked ids that have been discarded actively. This information
-  // will be used to avoid misjudgement on tracking continuity.
+  // will be used to avoid misjudgement on tracking continuity. Only read during
+  // tracking, the owner clears it once all boxes have been tracked.
   absl::flat_hash_set<int>* actively_discarded_tracked_ids = nullptr;
 };
 
@@ -231,6 +232,14 @@ struct MotionVectorFrame {
 void MotionVectorFrameFromTrackingData(const TrackingData& tracking_data,
                                        MotionVectorFrame* motion_vector_frame);
 
+// Same as above, but only keeps the motion vectors positioned within
+// [top_left, bottom_right] (in the denormalized domain), skipping the
+// conversion of all other columns and rows.
+void MotionVectorFrameFromTrackingData(const TrackingData& tracking_data,
+                                       const Vector2_f& top_left,
+                                       const Vector2_f& bottom_right,
+                                       MotionVectorFrame* motion_vector_frame);
+
 // Transform TrackingData to feature positions and descriptors, ready to be used
 // by detection (re-acquisition) algorithm (so the "features" is denomalized).
 // Descriptors with all 0s will be discarded.
@@ -243,6 +252,13 @@ void FeatureAndDescriptorFromTrackingData(
 void InvertMotionVectorFrame(const MotionVectorFrame& input,
                              MotionVectorFrame* output);
 
+// Same as above, but only keeps the inverted motion vectors positioned within
+// [top_left, bottom_right].
+void InvertMotionVectorFrame(const MotionVectorFrame& input,
+                             const Vector2_f& top_left,
+                             const Vector2_f& bottom_right,
+                             MotionVectorFrame* output);
+
 // Returns duration in ms for this chunk item.
 float TrackingDataDurationMs(const TrackingDataChunk::Item& item);
 
@@ -311,6 +327,13 @@ class MotionBox {
   bool TrackStep(int from_frame, const MotionVectorFrame& motion_vectors,
                  bool forward);
 
+  // Returns the region [top_left, bottom_right] of motion vector positions
+  // that TrackStep from from_frame may use for motion vectors of frames with
+  // the given aspect ratio. Motion vectors outside of it can be left out of
+  // the MotionVectorFrame. Returns false if from_frame is not trackable.
+  bool TrackStepRegion(int from_frame, float aspect_ratio, Vector2_f* top_left,
+                       Vector2_f* bottom_right) const;
+
   MotionBoxState StateAtFrame(int frame) const {
     if (frame < queue_start_ ||
         frame >= queue_start_ + static_cast<int>(states_.size())) {
@@ -643,6 +666,14 @@ class MotionBox {
   MotionBoxState initial_state_;
 };
 
+// Tracks all boxes by one frame from from_frame as MotionBox::TrackStep does,
+// distributing the boxes over the parallel invoker's threads. Returns the
+// indices of the boxes for which tracking failed, in increasing order.
+std::vector<int> TrackStepBatch(int from_frame,
+                                const MotionVectorFrame& motion_vectors,
+                                bool forward,
+                                const std::vector<MotionBox*>& boxes);
+
 }  // namespace mediapipe.
 
 #endif  // MEDIAPIPE_UTIL_TRACKING_TRACKING_H_
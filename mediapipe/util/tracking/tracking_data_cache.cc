@@ -0,0 +1,324 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/tracking_data_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/util/tracking/motion_models.pb.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'P', 'T', 'C'};
+constexpr uint32 kVersion = 1;
+constexpr int kHeaderSize = 16;
+constexpr int kIndexEntrySize = 32;
+constexpr int kFrameHeaderSize = 76;
+
+template <typename T>
+void Append(T value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T Read(const char* data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+void PadToWord(std::string* out) { out->resize((out->size() + 3) & ~3, 0); }
+
+void EncodeFrame(const TrackingData& tracking_data, std::string* out) {
+  const TrackingData::MotionData& motion_data = tracking_data.motion_data();
+  const int num_vectors = motion_data.num_elements();
+  CHECK_EQ(motion_data.vector_data_size(), 2 * num_vectors);
+  CHECK_EQ(motion_data.row_indices_size(), num_vectors);
+  const int num_track_ids = motion_data.track_id_size();
+  CHECK(num_track_ids == 0 || num_track_ids == num_vectors);
+
+  float max_vector_value = 0;
+  for (const float vector_value : motion_data.vector_data()) {
+    max_vector_value = std::max<float>(max_vector_value, fabs(vector_value));
+  }
+  const float scale = max_vector_value > 0 ? 32767.0f / max_vector_value : 1;
+
+  const Homography& model = tracking_data.background_model();
+  Append<int32>(tracking_data.frame_flags(), out);
+  Append<int32>(tracking_data.domain_width(), out);
+  Append<int32>(tracking_data.domain_height(), out);
+  Append<float>(tracking_data.frame_aspect(), out);
+  for (float h : {model.h_00(), model.h_01(), model.h_02(), model.h_10(),
+                  model.h_11(), model.h_12(), model.h_20(), model.h_21()}) {
+    Append<float>(h, out);
+  }
+  Append<uint32>(tracking_data.global_feature_count(), out);
+  Append<float>(tracking_data.average_motion_magnitude(), out);
+  Append<int32>(num_vectors, out);
+  Append<int32>(motion_data.col_starts_size(), out);
+  Append<int32>(num_track_ids, out);
+  Append<int32>(motion_data.actively_discarded_tracked_ids_size(), out);
+  Append<float>(scale, out);
+
+  for (const float vector_value : motion_data.vector_data()) {
+    Append<int16>(static_cast<int16>(std::round(vector_value * scale)), out);
+  }
+  for (const int row : motion_data.row_indices()) {
+    CHECK(row >= 0 && row <= 0xffff) << "Row index out of range: " << row;
+    Append<uint16>(row, out);
+  }
+  int prev_col_start = 0;
+  for (const int col_start : motion_data.col_starts()) {
+    const int delta = col_start - prev_col_start;
+    CHECK(delta >= 0 && delta <= 0xffff) << "Column too large: " << delta;
+    Append<uint16>(delta, out);
+    prev_col_start = col_start;
+  }
+  PadToWord(out);
+  for (const int track_id : motion_data.track_id()) {
+    Append<int32>(track_id, out);
+  }
+  for (const int id : motion_data.actively_discarded_tracked_ids()) {
+    Append<int32>(id, out);
+  }
+}
+
+}  // namespace
+
+void EncodeTrackingDataCache(const TrackingDataChunk& chunk,
+                             std::string* cache) {
+  CHECK(cache != nullptr);
+  const int num_frames = chunk.item_size();
+  cache->clear();
+  cache->append(kMagic, sizeof(kMagic));
+  Append<uint32>(kVersion, cache);
+  Append<uint32>(num_frames, cache);
+  Append<uint32>((chunk.first_chunk() ? 1 : 0) | (chunk.last_chunk() ? 2 : 0),
+                 cache);
+
+  // The index is filled in once the frame offsets are known.
+  cache->resize(kHeaderSize + num_frames * kIndexEntrySize, 0);
+  for (int k = 0; k < num_frames; ++k) {
+    const TrackingDataChunk::Item& item = chunk.item(k);
+    if (k > 0) {
+      CHECK_GE(item.timestamp_usec(), chunk.item(k - 1).timestamp_usec())
+          << "Items must be sorted by timestamp.";
+    }
+    const uint32 offset = cache->size();
+    EncodeFrame(item.tracking_data(), cache);
+    std::string entry;
+    Append<int64>(item.timestamp_usec(), &entry);
+    Append<int64>(item.prev_timestamp_usec(), &entry);
+    Append<int32>(item.frame_idx(), &entry);
+    Append<uint32>(offset, &entry);
+    Append<uint32>(cache->size() - offset, &entry);
+    Append<uint32>(0, &entry);
+    cache->replace(kHeaderSize + k * kIndexEntrySize, kIndexEntrySize, entry);
+  }
+}
+
+bool IsTrackingDataCache(absl::string_view data) {
+  return data.size() >= kHeaderSize &&
+         memcmp(data.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+bool TrackingDataCacheView::Init(absl::string_view data) {
+  if (!IsTrackingDataCache(data)) {
+    LOG(ERROR) << "Not a tracking data cache.";
+    return false;
+  }
+  const uint32 version = Read<uint32>(data.data() + 4);
+  if (version != kVersion) {
+    LOG(ERROR) << "Unsupported tracking data cache version: " << version;
+    return false;
+  }
+  const uint32 num_frames = Read<uint32>(data.data() + 8);
+  if ((data.size() - kHeaderSize) / kIndexEntrySize < num_frames) {
+    LOG(ERROR) << "Truncated tracking data cache index.";
+    return false;
+  }
+  data_ = data;
+  num_frames_ = num_frames;
+  chunk_flags_ = Read<uint32>(data.data() + 12);
+  // Only the index is checked here, so that the frames are only paged in
+  // when they are decoded.
+  for (int k = 0; k < num_frames_; ++k) {
+    const uint32 offset = Read<uint32>(IndexEntry(k) + 20);
+    const uint32 size = Read<uint32>(IndexEntry(k) + 24);
+    if (size < kFrameHeaderSize || offset > data.size() ||
+        size > data.size() - offset) {
+      LOG(ERROR) << "Invalid frame " << k << " in tracking data cache.";
+      data_ = absl::string_view();
+      num_frames_ = 0;
+      return false;
+    }
+  }
+  return true;
+}
+
+const char* TrackingDataCacheView::IndexEntry(int frame) const {
+  DCHECK(frame >= 0 && frame < num_frames_);
+  return data_.data() + kHeaderSize + frame * kIndexEntrySize;
+}
+
+int64 TrackingDataCacheView::TimestampUsec(int frame) const {
+  return Read<int64>(IndexEntry(frame));
+}
+
+int64 TrackingDataCacheView::PrevTimestampUsec(int frame) const {
+  return Read<int64>(IndexEntry(frame) + 8);
+}
+
+int TrackingDataCacheView::FrameIdx(int frame) const {
+  return Read<int32>(IndexEntry(frame) + 16);
+}
+
+int TrackingDataCacheView::FrameAtOrBefore(int64 timestamp_usec) const {
+  // Binary search for the first frame after timestamp_usec.
+  int begin = 0;
+  int end = num_frames_;
+  while (begin < end) {
+    const int mid = begin + (end - begin) / 2;
+    if (TimestampUsec(mid) <= timestamp_usec) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin - 1;
+}
+
+void TrackingDataCacheView::DecodeFrame(int frame,
+                                        TrackingData* tracking_data) const {
+  CHECK(tracking_data != nullptr);
+  const char* data = data_.data() + Read<uint32>(IndexEntry(frame) + 20);
+  const uint32 size = Read<uint32>(IndexEntry(frame) + 24);
+
+  tracking_data->Clear();
+  tracking_data->set_frame_flags(Read<int32>(data));
+  tracking_data->set_domain_width(Read<int32>(data + 4));
+  tracking_data->set_domain_height(Read<int32>(data + 8));
+  tracking_data->set_frame_aspect(Read<float>(data + 12));
+  Homography* model = tracking_data->mutable_background_model();
+  model->set_h_00(Read<float>(data + 16));
+  model->set_h_01(Read<float>(data + 20));
+  model->set_h_02(Read<float>(data + 24));
+  model->set_h_10(Read<float>(data + 28));
+  model->set_h_11(Read<float>(data + 32));
+  model->set_h_12(Read<float>(data + 36));
+  model->set_h_20(Read<float>(data + 40));
+  model->set_h_21(Read<float>(data + 44));
+  tracking_data->set_global_feature_count(Read<uint32>(data + 48));
+  tracking_data->set_average_motion_magnitude(Read<float>(data + 52));
+  const int num_vectors = Read<int32>(data + 56);
+  const int num_col_starts = Read<int32>(data + 60);
+  const int num_track_ids = Read<int32>(data + 64);
+  const int num_discarded_ids = Read<int32>(data + 68);
+  const float scale = Read<float>(data + 72);
+  CHECK(num_vectors >= 0 && num_col_starts >= 0 && num_track_ids >= 0 &&
+        num_discarded_ids >= 0 && size / 4 >= num_vectors + num_track_ids)
+      << "Invalid frame " << frame << " in tracking data cache.";
+
+  const char* vector_data = data + kFrameHeaderSize;
+  const char* row_indices = vector_data + 4 * num_vectors;
+  const char* col_starts = row_indices + 2 * num_vectors;
+  const char* track_ids =
+      data + ((col_starts + 2 * num_col_starts - data + 3) & ~3);
+  const char* discarded_ids = track_ids + 4 * num_track_ids;
+  CHECK_LE(discarded_ids + 4 * num_discarded_ids - data, size)
+      << "Invalid frame " << frame << " in tracking data cache.";
+
+  TrackingData::MotionData* motion_data = tracking_data->mutable_motion_data();
+  motion_data->set_num_elements(num_vectors);
+  motion_data->mutable_vector_data()->Resize(2 * num_vectors, 0);
+  float* vectors = motion_data->mutable_vector_data()->mutable_data();
+  const float inv_scale = 1.0f / scale;
+  for (int k = 0; k < 2 * num_vectors; ++k) {
+    vectors[k] = Read<int16>(vector_data + 2 * k) * inv_scale;
+  }
+  motion_data->mutable_row_indices()->Resize(num_vectors, 0);
+  int* rows = motion_data->mutable_row_indices()->mutable_data();
+  for (int k = 0; k < num_vectors; ++k) {
+    rows[k] = Read<uint16>(row_indices + 2 * k);
+  }
+  motion_data->mutable_col_starts()->Resize(num_col_starts, 0);
+  int* cols = motion_data->mutable_col_starts()->mutable_data();
+  int col_start = 0;
+  for (int k = 0; k < num_col_starts; ++k) {
+    col_start += Read<uint16>(col_starts + 2 * k);
+    cols[k] = col_start;
+  }
+  motion_data->mutable_track_id()->Resize(num_track_ids, 0);
+  memcpy(motion_data->mutable_track_id()->mutable_data(), track_ids,
+         4 * num_track_ids);
+  motion_data->mutable_actively_discarded_tracked_ids()->Resize(
+      num_discarded_ids, 0);
+  memcpy(motion_data->mutable_actively_discarded_tracked_ids()->mutable_data(),
+         discarded_ids, 4 * num_discarded_ids);
+}
+
+void TrackingDataCacheView::DecodeChunk(int begin, int end,
+                                        TrackingDataChunk* chunk) const {
+  CHECK(chunk != nullptr);
+  CHECK(begin >= 0 && begin <= end && end <= num_frames_);
+  chunk->Clear();
+  for (int k = begin; k < end; ++k) {
+    TrackingDataChunk::Item* item = chunk->add_item();
+    DecodeFrame(k, item->mutable_tracking_data());
+    item->set_frame_idx(FrameIdx(k));
+    item->set_timestamp_usec(TimestampUsec(k));
+    item->set_prev_timestamp_usec(PrevTimestampUsec(k));
+  }
+  chunk->set_first_chunk(begin == 0 && first_chunk());
+  chunk->set_last_chunk(end == num_frames_ && last_chunk());
+}
+
+MappedTrackingDataCache::~MappedTrackingDataCache() {
+  if (mapping_ != nullptr) munmap(mapping_, mapping_size_);
+}
+
+bool MappedTrackingDataCache::Open(const std::string& path) {
+  CHECK(mapping_ == nullptr) << "Already open.";
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG(ERROR) << "Could not open tracking data cache: " << path;
+    return false;
+  }
+  struct stat file_stat;
+  void* mapping = MAP_FAILED;
+  if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+    mapping = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    LOG(ERROR) << "Could not map tracking data cache: " << path;
+    return false;
+  }
+  mapping_ = mapping;
+  mapping_size_ = file_stat.st_size;
+  return view_.Init(absl::string_view(static_cast<const char*>(mapping_),
+                                      mapping_size_));
+}
+
+}  // namespace mediapipe
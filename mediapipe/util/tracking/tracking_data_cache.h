@@ -0,0 +1,142 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Fixed-layout binary format for cached tracking data, an alternative to
+// serialized TrackingDataChunk protos for large offline tracking caches.
+// A cache can be memory-mapped, and its frames are found by timestamp and
+// decoded individually, without parsing the rest of the cache.
+//
+// Layout (LITTLE ENDIAN encode, all sections 4 byte aligned):
+// {  magic              : 4 char "MPTC"
+//    version            : 32 bit uint
+//    num_frames         : 32 bit uint
+//    chunk_flags        : 32 bit uint  (1 = first_chunk, 2 = last_chunk)
+//
+//    index              : num_frames * 32 byte, sorted by timestamp
+//    {  timestamp_usec      : 64 bit int
+//       prev_timestamp_usec : 64 bit int
+//       frame_idx           : 32 bit int
+//       offset              : 32 bit uint  (of frame, w.r.t. start of cache)
+//       size                : 32 bit uint  (of frame)
+//       reserved            : 32 bit uint
+//    }
+//
+//    frames             : num_frames *
+//    {  frame_flags              : 32 bit int
+//       domain_width             : 32 bit int
+//       domain_height            : 32 bit int
+//       frame_aspect             : 32 bit float
+//       background_model         : 8 * 32 bit float  (h_00 ... h_21)
+//       global_feature_count     : 32 bit uint
+//       average_motion_magnitude : 32 bit float
+//       num_vectors              : 32 bit int
+//       num_col_starts           : 32 bit int
+//       num_track_ids            : 32 bit int  (0 or num_vectors)
+//       num_discarded_ids        : 32 bit int
+//       scale                    : 32 bit float
+//       vector_data              : 2 * num_vectors * 16 bit int
+//       row_indices              : num_vectors * 16 bit uint
+//       col_start_delta          : num_col_starts * 16 bit uint
+//       (padding to 4 bytes)
+//       track_ids                : num_track_ids * 32 bit int
+//       discarded_ids            : num_discarded_ids * 32 bit int
+//    }
+// }
+//
+// Vectors are quantized as in the baseline profile of BinaryTrackingData: the
+// maximum vector value is mapped to the highest 16 bit signed int, and values
+// are divided by scale when decoding. Column starts are delta encoded, the
+// first delta being the first column start. Unlike BinaryTrackingData, track
+// ids are kept, as the BoxTracker needs them; feature descriptors are not
+// stored.
+
+#ifndef MEDIAPIPE_UTIL_TRACKING_TRACKING_DATA_CACHE_H_
+#define MEDIAPIPE_UTIL_TRACKING_TRACKING_DATA_CACHE_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/util/tracking/flow_packager.pb.h"
+
+namespace mediapipe {
+
+// Encodes `chunk` to the tracking data cache format. The items of `chunk`
+// must be sorted by timestamp.
+void EncodeTrackingDataCache(const TrackingDataChunk& chunk,
+                             std::string* cache);
+
+// Returns true if `data` starts like a tracking data cache.
+bool IsTrackingDataCache(absl::string_view data);
+
+// Read access to a tracking data cache held in memory, such as a mapped
+// file. Does not copy nor own the data.
+class TrackingDataCacheView {
+ public:
+  // Returns false if `data` isn't a valid tracking data cache.
+  bool Init(absl::string_view data);
+
+  int num_frames() const { return num_frames_; }
+  bool first_chunk() const { return chunk_flags_ & kFirstChunk; }
+  bool last_chunk() const { return chunk_flags_ & kLastChunk; }
+
+  int64 TimestampUsec(int frame) const;
+  int64 PrevTimestampUsec(int frame) const;
+  int FrameIdx(int frame) const;
+
+  // Returns the index of the last frame at or before `timestamp_usec`, or -1
+  // if none.
+  int FrameAtOrBefore(int64 timestamp_usec) const;
+
+  // Decodes the tracking data of a single frame.
+  void DecodeFrame(int frame, TrackingData* tracking_data) const;
+
+  // Decodes the frames in [begin, end) as the items of `chunk`, and the
+  // chunk flags.
+  void DecodeChunk(int begin, int end, TrackingDataChunk* chunk) const;
+
+ private:
+  static constexpr uint32 kFirstChunk = 1;
+  static constexpr uint32 kLastChunk = 2;
+
+  const char* IndexEntry(int frame) const;
+
+  absl::string_view data_;
+  int num_frames_ = 0;
+  uint32 chunk_flags_ = 0;
+};
+
+// A tracking data cache file, memory-mapped for reading.
+class MappedTrackingDataCache {
+ public:
+  MappedTrackingDataCache() = default;
+  MappedTrackingDataCache(const MappedTrackingDataCache&) = delete;
+  MappedTrackingDataCache& operator=(const MappedTrackingDataCache&) = delete;
+  ~MappedTrackingDataCache();
+
+  // Maps the file at `path`. Returns false if it can't be mapped or isn't a
+  // valid tracking data cache.
+  bool Open(const std::string& path);
+
+  const TrackingDataCacheView& view() const { return view_; }
+
+ private:
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+  TrackingDataCacheView view_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TRACKING_TRACKING_DATA_CACHE_H_
@@ -0,0 +1,118 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/tracking_data_cache.h"
+
+#include <string>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Returns a chunk of `num_frames` frames, 40 ms apart, each with a few
+// vectors in a 4x4 domain.
+TrackingDataChunk MakeChunk(int num_frames) {
+  TrackingDataChunk chunk;
+  chunk.set_first_chunk(true);
+  for (int f = 0; f < num_frames; ++f) {
+    TrackingDataChunk::Item* item = chunk.add_item();
+    item->set_frame_idx(f);
+    item->set_timestamp_usec(40000 * f);
+    item->set_prev_timestamp_usec(40000 * (f - 1));
+    TrackingData* data = item->mutable_tracking_data();
+    data->set_domain_width(4);
+    data->set_domain_height(4);
+    data->set_frame_aspect(1.5f);
+    data->mutable_background_model()->set_h_02(f);
+    TrackingData::MotionData* motion = data->mutable_motion_data();
+    motion->set_num_elements(3);
+    for (float v : {0.5f, -1.0f, 2.0f, 0.25f, -3.0f, f * 1.0f}) {
+      motion->add_vector_data(v);
+    }
+    for (int row : {1, 3, 2}) motion->add_row_indices(row);
+    for (int col : {0, 2, 2, 3, 3}) motion->add_col_starts(col);
+    for (int id : {7, 8, 9 + f}) motion->add_track_id(id);
+    motion->add_actively_discarded_tracked_ids(5);
+  }
+  return chunk;
+}
+
+TEST(TrackingDataCacheTest, DecodesFrames) {
+  const TrackingDataChunk chunk = MakeChunk(3);
+  std::string cache;
+  EncodeTrackingDataCache(chunk, &cache);
+  ASSERT_TRUE(IsTrackingDataCache(cache));
+
+  TrackingDataCacheView view;
+  ASSERT_TRUE(view.Init(cache));
+  EXPECT_EQ(view.num_frames(), 3);
+  EXPECT_TRUE(view.first_chunk());
+  EXPECT_FALSE(view.last_chunk());
+  EXPECT_EQ(view.TimestampUsec(2), 80000);
+  EXPECT_EQ(view.PrevTimestampUsec(2), 40000);
+  EXPECT_EQ(view.FrameIdx(2), 2);
+
+  TrackingData data;
+  view.DecodeFrame(2, &data);
+  EXPECT_EQ(data.domain_width(), 4);
+  EXPECT_EQ(data.frame_aspect(), 1.5f);
+  EXPECT_EQ(data.background_model().h_02(), 2);
+  EXPECT_EQ(data.background_model().h_11(), 1);
+  const TrackingData::MotionData& motion = data.motion_data();
+  EXPECT_EQ(motion.num_elements(), 3);
+  ASSERT_EQ(motion.vector_data_size(), 6);
+  const TrackingData::MotionData& original =
+      chunk.item(2).tracking_data().motion_data();
+  for (int k = 0; k < 6; ++k) {
+    EXPECT_NEAR(motion.vector_data(k), original.vector_data(k), 1e-3);
+  }
+  EXPECT_THAT(motion.row_indices(), ElementsAre(1, 3, 2));
+  EXPECT_THAT(motion.col_starts(), ElementsAre(0, 2, 2, 3, 3));
+  EXPECT_THAT(motion.track_id(), ElementsAre(7, 8, 11));
+  EXPECT_THAT(motion.actively_discarded_tracked_ids(), ElementsAre(5));
+}
+
+TEST(TrackingDataCacheTest, FindsFramesByTimestamp) {
+  std::string cache;
+  EncodeTrackingDataCache(MakeChunk(10), &cache);
+  TrackingDataCacheView view;
+  ASSERT_TRUE(view.Init(cache));
+  EXPECT_EQ(view.FrameAtOrBefore(-1), -1);
+  EXPECT_EQ(view.FrameAtOrBefore(0), 0);
+  EXPECT_EQ(view.FrameAtOrBefore(119999), 2);
+  EXPECT_EQ(view.FrameAtOrBefore(120000), 3);
+  EXPECT_EQ(view.FrameAtOrBefore(1000000), 9);
+
+  TrackingDataChunk decoded;
+  view.DecodeChunk(3, 5, &decoded);
+  ASSERT_EQ(decoded.item_size(), 2);
+  EXPECT_EQ(decoded.item(0).frame_idx(), 3);
+  EXPECT_EQ(decoded.item(1).timestamp_usec(), 160000);
+  EXPECT_FALSE(decoded.first_chunk());
+}
+
+TEST(TrackingDataCacheTest, RejectsTruncatedCache) {
+  std::string cache;
+  EncodeTrackingDataCache(MakeChunk(2), &cache);
+  TrackingDataCacheView view;
+  EXPECT_FALSE(view.Init(absl::string_view(cache).substr(0, 40)));
+  EXPECT_FALSE(view.Init("not a cache"));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,260 @@
+// Copyright 2023 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/tracking.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/vector.h"
+#include "mediapipe/util/tracking/flow_packager.pb.h"
+#include "mediapipe/util/tracking/tracking.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFrames = 30;
+
+// Tracks each box on all motion vectors of "data", as BoxTracker does. Each
+// box sees its own copy of "discarded_ids".
+std::vector<int> TrackEachOnFullFrame(
+    const TrackingData& data, int from_frame, bool forward,
+    const absl::flat_hash_set<int>& discarded_ids,
+    const std::vector<MotionBox*>& boxes, int* num_vectors) {
+  MotionVectorFrame mvf;
+  MotionVectorFrameFromTrackingData(data, &mvf);
+  if (forward) {
+    MotionVectorFrame mvf_inverted;
+    InvertMotionVectorFrame(mvf, &mvf_inverted);
+    std::swap(mvf, mvf_inverted);
+  }
+  *num_vectors += mvf.motion_vectors.size();
+
+  std::vector<int> failed;
+  for (int k = 0; k < boxes.size(); ++k) {
+    absl::flat_hash_set<int> box_discarded_ids = discarded_ids;
+    mvf.actively_discarded_tracked_ids = &box_discarded_ids;
+    if (!boxes[k]->TrackStep(from_frame, mvf, forward)) {
+      failed.push_back(k);
+    }
+  }
+  return failed;
+}
+
+// Tracks all boxes in one batch on the motion vectors within the union of
+// their search regions, as BoxTrackerCalculator does.
+std::vector<int> TrackBatchInRegion(const TrackingData& data, int from_frame,
+                                    bool forward,
+                                    absl::flat_hash_set<int>* discarded_ids,
+                                    const std::vector<MotionBox*>& boxes,
+                                    int* num_vectors) {
+  Vector2_f region_top_left(std::numeric_limits<float>::max(),
+                            std::numeric_limits<float>::max());
+  Vector2_f region_bottom_right(std::numeric_limits<float>::lowest(),
+                                std::numeric_limits<float>::lowest());
+  for (const MotionBox* box : boxes) {
+    Vector2_f top_left, bottom_right;
+    if (box->TrackStepRegion(from_frame, data.frame_aspect(), &top_left,
+                             &bottom_right)) {
+      region_top_left = Vector2_f(std::min(region_top_left.x(), top_left.x()),
+                                  std::min(region_top_left.y(), top_left.y()));
+      region_bottom_right =
+          Vector2_f(std::max(region_bottom_right.x(), bottom_right.x()),
+                    std::max(region_bottom_right.y(), bottom_right.y()));
+    }
+  }
+
+  MotionVectorFrame mvf;
+  if (forward) {
+    MotionVectorFrame mvf_backward;
+    MotionVectorFrameFromTrackingData(data, &mvf_backward);
+    InvertMotionVectorFrame(mvf_backward, region_top_left, region_bottom_right,
+                            &mvf);
+  } else {
+    MotionVectorFrameFromTrackingData(data, region_top_left,
+                                      region_bottom_right, &mvf);
+  }
+  *num_vectors += mvf.motion_vectors.size();
+  mvf.actively_discarded_tracked_ids = discarded_ids;
+  return TrackStepBatch(from_frame, mvf, forward, boxes);
+}
+
+void ExpectSameStates(const std::vector<std::unique_ptr<MotionBox>>& expected,
+                      const std::vector<std::unique_ptr<MotionBox>>& actual,
+                      int frame) {
+  ASSERT_EQ(expected.size(), actual.size());
+  constexpr float kTolerance = 1e-5f;
+  for (int k = 0; k < expected.size(); ++k) {
+    const MotionBoxState expected_state = expected[k]->StateAtFrame(frame);
+    const MotionBoxState actual_state = actual[k]->StateAtFrame(frame);
+    SCOPED_TRACE(testing::Message() << "box " << k << " at frame " << frame);
+    EXPECT_EQ(expected_state.track_status(), actual_state.track_status());
+    EXPECT_NEAR(expected_state.pos_x(), actual_state.pos_x(), kTolerance);
+    EXPECT_NEAR(expected_state.pos_y(), actual_state.pos_y(), kTolerance);
+    EXPECT_NEAR(expected_state.width(), actual_state.width(), kTolerance);
+    EXPECT_NEAR(expected_state.height(), actual_state.height(), kTolerance);
+    EXPECT_NEAR(expected_state.dx(), actual_state.dx(), kTolerance);
+    EXPECT_NEAR(expected_state.dy(), actual_state.dy(), kTolerance);
+    EXPECT_NEAR(expected_state.tracking_confidence(),
+                actual_state.tracking_confidence(), kTolerance);
+    EXPECT_EQ(expected_state.inlier_ids_size(), actual_state.inlier_ids_size());
+  }
+}
+
+std::vector<MotionBox*> Pointers(
+    const std::vector<std::unique_ptr<MotionBox>>& boxes) {
+  std::vector<MotionBox*> pointers;
+  for (const auto& box : boxes) {
+    pointers.push_back(box.get());
+  }
+  return pointers;
+}
+
+class TrackStepBatchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::string data;
+    ASSERT_TRUE(file::GetContents(
+                    file::JoinPath("./",
+                                   "/mediapipe/util/tracking/testdata/"
+                                   "box_tracker/chunk_0000"),
+                    &data)
+                    .ok());
+    ASSERT_TRUE(chunk_.ParseFromString(data));
+    ASSERT_GT(chunk_.item_size(), kNumFrames);
+  }
+
+  // Returns boxes at "frame" on all, the top and the bottom of the overlay
+  // moving through the test video, so that their search regions overlap.
+  static std::vector<std::unique_ptr<MotionBox>> MakeBoxes(int frame) {
+    // The overlay moves down by 300 of 720 pixels over the first 72 frames.
+    const float offset_y = frame * 300.0f / 720.0f / 72.0f;
+    constexpr float kBoxes[][4] = {{0.04f, 0.14f, 0.17f, 0.35f},
+                                   {0.04f, 0.14f, 0.17f, 0.15f},
+                                   {0.08f, 0.35f, 0.12f, 0.14f}};
+    std::vector<std::unique_ptr<MotionBox>> boxes;
+    for (const auto& box : kBoxes) {
+      MotionBoxState state;
+      state.set_pos_x(box[0]);
+      state.set_pos_y(box[1] + offset_y);
+      state.set_width(box[2]);
+      state.set_height(box[3]);
+      boxes.push_back(std::make_unique<MotionBox>(TrackStepOptions()));
+      boxes.back()->ResetAtFrame(frame, state);
+    }
+    return boxes;
+  }
+
+  // Tracks over kNumFrames in the given direction, once box by box on all
+  // motion vectors and once in batches on the cropped motion vectors.
+  void TrackAndCompare(bool forward) {
+    const int start_frame = forward ? 0 : kNumFrames;
+    auto expected = MakeBoxes(start_frame);
+    auto actual = MakeBoxes(start_frame);
+    absl::flat_hash_set<int> discarded_ids;
+    int num_full_vectors = 0;
+    int num_cropped_vectors = 0;
+    for (int i = 0; i < kNumFrames; ++i) {
+      const int from_frame = forward ? i : kNumFrames - i;
+      const int to_frame = forward ? from_frame + 1 : from_frame - 1;
+      // TrackingData at frame f holds the motion from frame f to f - 1.
+      const TrackingData& data =
+          chunk_.item(forward ? to_frame : from_frame).tracking_data();
+      const std::vector<int> expected_failed =
+          TrackEachOnFullFrame(data, from_frame, forward, discarded_ids,
+                               Pointers(expected), &num_full_vectors);
+      const std::vector<int> actual_failed =
+          TrackBatchInRegion(data, from_frame, forward, &discarded_ids,
+                             Pointers(actual), &num_cropped_vectors);
+      EXPECT_EQ(expected_failed, actual_failed);
+      ExpectSameStates(expected, actual, to_frame);
+    }
+    // The boxes don't cover the frame, so cropping must leave vectors out.
+    EXPECT_LT(num_cropped_vectors, num_full_vectors);
+    for (const auto& box : expected) {
+      EXPECT_GE(box->StateAtFrame(start_frame + (forward ? 1 : -1) * kNumFrames)
+                    .track_status(),
+                MotionBoxState::BOX_TRACKED);
+    }
+  }
+
+  TrackingDataChunk chunk_;
+};
+
+TEST_F(TrackStepBatchTest, BatchInRegionMatchesEachOnFullFrameForward) {
+  TrackAndCompare(/*forward=*/true);
+}
+
+TEST_F(TrackStepBatchTest, BatchInRegionMatchesEachOnFullFrameBackward) {
+  TrackAndCompare(/*forward=*/false);
+}
+
+// The actively discarded ids of a frame are seen by every box, not only the
+// first one, and tracking leaves them for the owner to clear.
+TEST_F(TrackStepBatchTest, AllBoxesSeeActivelyDiscardedIds) {
+  constexpr int kDiscardFrame = 10;
+  auto tracked = MakeBoxes(0);
+  absl::flat_hash_set<int> discarded_ids;
+  int num_vectors = 0;
+  for (int f = 0; f < kDiscardFrame; ++f) {
+    TrackBatchInRegion(chunk_.item(f + 1).tracking_data(), f,
+                       /*forward=*/true, &discarded_ids, Pointers(tracked),
+                       &num_vectors);
+  }
+
+  // Restarts the boxes with tracking canceled as soon as some inliers don't
+  // continue, unless they were actively discarded. Discarding the inliers of
+  // every box then lets all of them continue.
+  TrackStepOptions options;
+  options.mutable_cancel_tracking_with_occlusion_options()->set_activated(true);
+  options.mutable_cancel_tracking_with_occlusion_options()
+      ->set_min_motion_continuity(0.99f);
+  std::vector<std::unique_ptr<MotionBox>> expected;
+  std::vector<std::unique_ptr<MotionBox>> actual;
+  for (const auto& box : tracked) {
+    const MotionBoxState state = box->StateAtFrame(kDiscardFrame);
+    ASSERT_GT(state.inlier_ids_size(), 0);
+    for (const int id : state.inlier_ids()) {
+      discarded_ids.insert(id);
+    }
+    expected.push_back(std::make_unique<MotionBox>(options));
+    expected.back()->ResetAtFrame(kDiscardFrame, state);
+    actual.push_back(std::make_unique<MotionBox>(options));
+    actual.back()->ResetAtFrame(kDiscardFrame, state);
+  }
+  const absl::flat_hash_set<int> all_discarded_ids = discarded_ids;
+
+  const TrackingData& data = chunk_.item(kDiscardFrame + 1).tracking_data();
+  const std::vector<int> expected_failed =
+      TrackEachOnFullFrame(data, kDiscardFrame, /*forward=*/true,
+                           all_discarded_ids, Pointers(expected), &num_vectors);
+  const std::vector<int> actual_failed =
+      TrackBatchInRegion(data, kDiscardFrame, /*forward=*/true, &discarded_ids,
+                         Pointers(actual), &num_vectors);
+  EXPECT_TRUE(expected_failed.empty());
+  EXPECT_EQ(expected_failed, actual_failed);
+  ExpectSameStates(expected, actual, kDiscardFrame + 1);
+  EXPECT_EQ(discarded_ids, all_discarded_ids);
+}
+
+}  // namespace
+}  // namespace mediapipe
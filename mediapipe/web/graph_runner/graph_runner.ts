@@ -325,6 +325,12 @@ export class GraphRunner {
     if ((imageSource as HTMLVideoElement).videoWidth) {
       width = (imageSource as HTMLVideoElement).videoWidth;
       height = (imageSource as HTMLVideoElement).videoHeight;
+    } else if ((imageSource as {displayWidth?: number}).displayWidth) {
+      // A WebCodecs VideoFrame, as transferred to a worker.
+      const frame =
+          imageSource as {displayWidth: number, displayHeight: number};
+      width = frame.displayWidth;
+      height = frame.displayHeight;
     } else if ((imageSource as HTMLImageElement).naturalWidth) {
       // TODO: Ensure this works with SVG images
       width = (imageSource as HTMLImageElement).naturalWidth;
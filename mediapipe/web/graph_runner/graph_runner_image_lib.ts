@@ -16,6 +16,26 @@ export declare interface WasmImageModule {
   _addBoundTextureAsImageToStream:
       (streamNamePtr: number, width: number, height: number,
        timestamp: number) => void;
+
+  // Emscripten's table of WebGL objects, indexed by GL name.
+  GL: {
+    textures: Array<WebGLTexture|null>;
+    getNewId: (table: unknown[]) => number;
+  };
+
+  // Require dependency ":gl_graph_runner_texture" (see
+  // mediapipe/gpu/webgl_texture_interop.h).
+  _addGLTextureAsImageToStream:
+      (textureId: number, width: number, height: number, streamNamePtr: number,
+       timestamp: number) => void;
+  _attachGLTextureListener: (streamNamePtr: number) => void;
+}
+
+/** A WebGL texture produced by the graph, with its dimensions. */
+export declare interface GLTextureResult {
+  texture: WebGLTexture;
+  width: number;
+  height: number;
 }
 
 /**
@@ -48,5 +68,68 @@ export function SupportImage<TBase extends LibConstructor>(Base: TBase) {
                 streamNamePtr, width, height, timestamp);
       });
     }
+
+    /**
+     * Returns the WebGL context the graph runs on. Textures passed to
+     * `addGLTextureAsImageToStream` must be created on this context.
+     */
+    getGLContext(): WebGL2RenderingContext|WebGLRenderingContext {
+      const canvas = this.wasmModule.canvas;
+      if (!canvas) {
+        throw new Error('No OpenGL canvas configured.');
+      }
+      const gl = (canvas.getContext('webgl2') ||
+                  canvas.getContext('webgl')) as WebGL2RenderingContext |
+          WebGLRenderingContext | null;
+      if (!gl) {
+        throw new Error('Graph has no WebGL context.');
+      }
+      return gl;
+    }
+
+    /**
+     * Passes a WebGL texture into the graph as a MediaPipe image, without
+     * copying it. The texture must have been created on `getGLContext()`, and
+     * hold RGBA data. It must not be modified or deleted until processing of
+     * this timestamp has finished (e.g. after `finishProcessing()`).
+     * @param texture The texture holding the input frame.
+     * @param width The width of the texture.
+     * @param height The height of the texture.
+     * @param streamName The name of the MediaPipe graph stream to add the frame
+     *     to.
+     * @param timestamp The timestamp of the input frame, in ms.
+     */
+    addGLTextureAsImageToStream(
+        texture: WebGLTexture, width: number, height: number,
+        streamName: string, timestamp: number): void {
+      const module = this.wasmModule as unknown as WasmImageModule;
+      // Registers the texture with Emscripten's GL layer, so C++ can refer to
+      // it by name. The graph unregisters it once it is done with the frame.
+      const textureId = module.GL.getNewId(module.GL.textures);
+      module.GL.textures[textureId] = texture;
+      this.wrapStringPtr(streamName, (streamNamePtr: number) => {
+        module._addGLTextureAsImageToStream(
+            textureId, width, height, streamNamePtr, timestamp);
+      });
+    }
+
+    /**
+     * Attaches a listener for images on the given output stream, received as
+     * WebGL textures on `getGLContext()`, so that results can be rendered
+     * without reading them back to the CPU. The texture is only valid for the
+     * duration of the callback; draw or copy it before returning.
+     * @param outputStreamName The name of the graph output stream.
+     * @param callbackFcn The function that will be called back with each
+     *     texture.
+     */
+    attachGLTextureListener(
+        outputStreamName: string,
+        callbackFcn: (result: GLTextureResult) => void): void {
+      this.setListener(outputStreamName, callbackFcn);
+      this.wrapStringPtr(outputStreamName, (outputStreamNamePtr: number) => {
+        (this.wasmModule as unknown as WasmImageModule)
+            ._attachGLTextureListener(outputStreamNamePtr);
+      });
+    }
   };
 }
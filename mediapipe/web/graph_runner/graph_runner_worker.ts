@@ -0,0 +1,292 @@
+/**
+ * Copyright 2023 The MediaPipe Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import {createMediaPipeLib, GraphRunner, ImageSource} from './graph_runner';
+import {SupportImage} from './graph_runner_image_lib';
+
+// Runs a MediaPipe graph inside a dedicated Worker, so that graph execution
+// (and, for threaded Wasm builds, the graph's own thread pool) never blocks the
+// main thread. Frames are sent to the worker as transferables, which moves
+// them without copying the pixel data.
+
+// tslint:disable-next-line:enforce-name-casing
+const WorkerGraphRunner = SupportImage(GraphRunner);
+
+/**
+ * A WebCodecs VideoFrame. Declared here as the TypeScript DOM library we build
+ * against does not include WebCodecs yet.
+ */
+export declare interface VideoFrame {
+  readonly displayWidth: number;
+  readonly displayHeight: number;
+  close(): void;
+}
+
+/** Image data that can be transferred to the graph worker. */
+export type TransferableImageSource = ImageBitmap|VideoFrame;
+
+/** Messages sent from the host to the graph worker. */
+export type GraphWorkerRequest = {
+  type: 'init',
+  wasmLoaderScript: string,
+  assetLoaderScript?: string,
+  graph: Uint8Array,
+  isBinary: boolean,
+}|{
+  type: 'attachProtoListener',
+  streamName: string,
+}|{
+  type: 'addImage',
+  image: TransferableImageSource,
+  streamName: string,
+  timestamp: number,
+}|{
+  type: 'addProto',
+  data: Uint8Array,
+  protoType: string,
+  streamName: string,
+  timestamp: number,
+}|{
+  type: 'finishProcessing',
+  id: number,
+};
+
+/** Messages sent from the graph worker to the host. */
+export type GraphWorkerResponse = {
+  type: 'initialized',
+}|{
+  type: 'proto',
+  streamName: string,
+  data: Uint8Array,
+}|{
+  type: 'finished',
+  id: number,
+}|{
+  type: 'error',
+  code: number,
+  message: string,
+};
+
+/**
+ * Worker-side entry point. Call from the worker script to serve the graph
+ * requested by a `GraphRunnerWorkerHost`.
+ */
+export function runGraphRunnerWorker(): void {
+  const scope = self as unknown as {
+    onmessage: ((event: MessageEvent<GraphWorkerRequest>) => void) | null;
+    postMessage(message: GraphWorkerResponse, transfer?: Transferable[]): void;
+  };
+  let graphRunner: InstanceType<typeof WorkerGraphRunner>|undefined;
+
+  // Requests that arrive while the Wasm module is loading are handled once it
+  // is ready, in order.
+  const pending: GraphWorkerRequest[] = [];
+
+  const handle = (request: GraphWorkerRequest) => {
+    if (!graphRunner) {
+      pending.push(request);
+      return;
+    }
+    switch (request.type) {
+      case 'attachProtoListener':
+        graphRunner.attachProtoListener(request.streamName, data => {
+          // The listener data is only valid for the duration of the callback,
+          // so it is copied into a buffer we can transfer to the host.
+          const copy = data.slice();
+          scope.postMessage(
+              {type: 'proto', streamName: request.streamName, data: copy},
+              [copy.buffer]);
+        });
+        break;
+      case 'addImage':
+        graphRunner.addGpuBufferAsImageToStream(
+            request.image as unknown as ImageSource, request.streamName,
+            request.timestamp);
+        // The frame is uploaded to a texture, so it can be released right away.
+        request.image.close();
+        break;
+      case 'addProto':
+        graphRunner.addProtoToStream(
+            request.data, request.protoType, request.streamName,
+            request.timestamp);
+        break;
+      case 'finishProcessing':
+        graphRunner.finishProcessing();
+        scope.postMessage({type: 'finished', id: request.id});
+        break;
+      default:
+        break;
+    }
+  };
+
+  scope.onmessage = async (event: MessageEvent<GraphWorkerRequest>) => {
+    const request = event.data;
+    if (request.type !== 'init') {
+      handle(request);
+      return;
+    }
+    const runner = await createMediaPipeLib(
+        WorkerGraphRunner, request.wasmLoaderScript, request.assetLoaderScript);
+    runner.attachErrorListener((code, message) => {
+      scope.postMessage({type: 'error', code, message});
+    });
+    runner.setGraph(request.graph, request.isBinary);
+    graphRunner = runner;
+    scope.postMessage({type: 'initialized'});
+    for (const queued of pending.splice(0)) {
+      handle(queued);
+    }
+  };
+}
+
+/**
+ * Main-thread proxy for a graph running in a worker that called
+ * `runGraphRunnerWorker()`. Mirrors the subset of the `GraphRunner` API used
+ * by the vision tasks: image and proto inputs, and proto outputs.
+ */
+export class GraphRunnerWorkerHost {
+  private readonly protoListeners =
+      new Map<string, (data: Uint8Array) => void>();
+  private readonly finishCallbacks = new Map<number, () => void>();
+  private nextFinishId = 0;
+  private errorListener?: (code: number, message: string) => void;
+  private initialized?: () => void;
+
+  constructor(private readonly worker: Worker) {
+    this.worker.onmessage = (event: MessageEvent<GraphWorkerResponse>) => {
+      this.handleResponse(event.data);
+    };
+  }
+
+  /**
+   * Loads the Wasm module in the worker and starts the graph.
+   * @param wasmLoaderScript Url for the wasm-runner script. For threaded builds
+   *     the page must be cross-origin isolated, so that the module can use a
+   *     SharedArrayBuffer.
+   * @param graph The graph config.
+   * @param isBinary Whether `graph` is a binary or a text proto.
+   * @param assetLoaderScript Optional url for the asset-loading script.
+   */
+  initialize(
+      wasmLoaderScript: string, graph: Uint8Array, isBinary: boolean,
+      assetLoaderScript?: string): Promise<void> {
+    const ready = new Promise<void>(resolve => {
+      this.initialized = resolve;
+    });
+    this.post({
+      type: 'init',
+      wasmLoaderScript,
+      assetLoaderScript,
+      graph,
+      isBinary,
+    });
+    return ready;
+  }
+
+  /**
+   * Attaches a listener for serialized protos on the given output stream. The
+   * data is owned by the callee.
+   */
+  attachProtoListener(
+      outputStreamName: string, callbackFcn: (data: Uint8Array) => void): void {
+    this.protoListeners.set(outputStreamName, callbackFcn);
+    this.post({type: 'attachProtoListener', streamName: outputStreamName});
+  }
+
+  /** Attaches a listener for errors reported by the graph. */
+  attachErrorListener(callbackFcn: (code: number, message: string) => void):
+      void {
+    this.errorListener = callbackFcn;
+  }
+
+  /**
+   * Sends a frame to the given stream as a MediaPipe image. The frame is
+   * transferred to the worker, and can no longer be used by the caller.
+   * @param image The frame to process.
+   * @param streamName The name of the graph input stream.
+   * @param timestamp The timestamp of the frame, in ms.
+   */
+  addImageToStream(
+      image: TransferableImageSource, streamName: string,
+      timestamp: number): void {
+    this.post(
+        {type: 'addImage', image, streamName, timestamp},
+        [image as unknown as Transferable]);
+  }
+
+  /**
+   * Sends a serialized proto to the given stream.
+   * @param data The binary proto data.
+   * @param protoType The fully qualified proto type name, e.g.
+   *     "mediapipe.NormalizedRect".
+   * @param streamName The name of the graph input stream.
+   * @param timestamp The timestamp of the packet, in ms.
+   */
+  addProtoToStream(
+      data: Uint8Array, protoType: string, streamName: string,
+      timestamp: number): void {
+    this.post({type: 'addProto', data, protoType, streamName, timestamp});
+  }
+
+  /**
+   * Processes all queued inputs. Resolves once the worker has delivered all
+   * outputs for them.
+   */
+  finishProcessing(): Promise<void> {
+    const id = this.nextFinishId++;
+    const finished = new Promise<void>(resolve => {
+      this.finishCallbacks.set(id, resolve);
+    });
+    this.post({type: 'finishProcessing', id});
+    return finished;
+  }
+
+  /** Stops the worker, and with it the graph. */
+  close(): void {
+    this.worker.terminate();
+  }
+
+  private post(request: GraphWorkerRequest, transfer: Transferable[] = []):
+      void {
+    this.worker.postMessage(request, transfer);
+  }
+
+  private handleResponse(response: GraphWorkerResponse): void {
+    switch (response.type) {
+      case 'initialized':
+        this.initialized?.();
+        this.initialized = undefined;
+        break;
+      case 'proto':
+        this.protoListeners.get(response.streamName)?.(response.data);
+        break;
+      case 'finished':
+        this.finishCallbacks.get(response.id)?.();
+        this.finishCallbacks.delete(response.id);
+        break;
+      case 'error':
+        if (this.errorListener) {
+          this.errorListener(response.code, response.message);
+        } else {
+          console.error(`MediaPipe graph error ${response.code}: ${
+              response.message}`);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}